@@ -67,13 +67,30 @@ namespace Hypertable {
   class ApplicationHandler {
 
   public:
+
+    /** Request priority lanes.
+     * Urgent requests are always executed before requests in any other lane
+     * and are executed even when the application queue is paused.  The
+     * remaining lanes are dequeued with configurable weights (see
+     * ApplicationQueue), so higher priority lanes get a proportionally
+     * larger share of the worker threads without starving the lower ones.
+     */
+    enum {
+      PRIORITY_URGENT = 0, //!< Urgent requests (METADATA operations)
+      PRIORITY_HIGH   = 1, //!< Latency-sensitive requests (point reads)
+      PRIORITY_NORMAL = 2, //!< Normal requests
+      PRIORITY_LOW    = 3, //!< Background requests (maintenance, dumps)
+      PRIORITY_COUNT  = 4  //!< Number of priority lanes
+    };
+
     /** Constructor initializing from an Event object.
      * Initializes #m_event to <code>event</code> and sets #m_urgent to
      * <i>true</i> if the CommHeader::FLAGS_BIT_URGENT is set in the
      * flags field of Event#header member of <code>event</code>.
      * @param event %Event that generated the request
      */
-    ApplicationHandler(EventPtr &event) : m_event(event) {
+    ApplicationHandler(EventPtr &event)
+      : m_event(event), m_priority(PRIORITY_NORMAL) {
       if (m_event)
         m_urgent = (bool)(m_event->header.flags & CommHeader::FLAGS_BIT_URGENT);
       else
@@ -83,7 +100,8 @@ namespace Hypertable {
     /** Default constructor with #m_urgent flag initialization.
      * @param urgent Handler should be marked as urgent
      */
-    ApplicationHandler(bool urgent=false) : m_urgent(urgent) { }
+    ApplicationHandler(bool urgent=false)
+      : m_urgent(urgent), m_priority(PRIORITY_NORMAL) { }
 
     /** Destructor */
     virtual ~ApplicationHandler() { }
@@ -92,6 +110,17 @@ namespace Hypertable {
      */
     virtual void run() = 0;
 
+    /** Attempts to carry out the request inline on the calling thread.
+     * Server connection handlers call this on the reactor thread before
+     * adding the request to the application queue, giving handlers that can
+     * sometimes complete a request without blocking (e.g. answering a scan
+     * from the query cache) a chance to respond immediately and skip the
+     * queue round trip.  Implementations must not block and must return
+     * <i>false</i> for any request they cannot fully carry out.
+     * @return <i>true</i> if the request was fully carried out
+     */
+    virtual bool run_inline() { return false; }
+
     /** Returns the <i>group ID</i> that this handler belongs to.  This
      * value is taken from the associated event object (see Event#group_id)
      * if it exists, otherwise the value is 0 indicating that the handler
@@ -102,11 +131,37 @@ namespace Hypertable {
       return (m_event) ?  m_event->group_id : 0;
     }
 
+    /** Returns the command code from the associated event's message header,
+     * or 0 if the handler was not initialized from a MESSAGE event.  Used
+     * for per-thread activity reporting (see ThreadActivity).
+     * @return Command code
+     */
+    uint64_t get_command() {
+      return (m_event && m_event->type == Event::MESSAGE)
+        ? m_event->header.command : 0;
+    }
+
     /** Returns <i>true</i> if request is urgent.
      * @return <i>true</i> if urgent
      */
     bool is_urgent() { return m_urgent; }
 
+    /** Returns the priority lane for this request.  Urgent requests always
+     * map to #PRIORITY_URGENT; other requests map to the lane set with
+     * #set_priority (#PRIORITY_NORMAL by default).
+     * @return Priority lane
+     */
+    int get_priority() { return m_urgent ? PRIORITY_URGENT : m_priority; }
+
+    /** Sets the priority lane for this request.
+     * @param priority Priority lane (#PRIORITY_HIGH, #PRIORITY_NORMAL, or
+     * #PRIORITY_LOW)
+     */
+    void set_priority(int priority) {
+      HT_ASSERT(priority > PRIORITY_URGENT && priority < PRIORITY_COUNT);
+      m_priority = priority;
+    }
+
     /** Returns <i>true</i> if request has expired.
      * @return <i>true</i> if request has expired.
      */
@@ -139,6 +194,7 @@ namespace Hypertable {
   protected:
     EventPtr m_event; //!< MESSAGE Event from which handler was initialized
     bool m_urgent;    //!< Flag indicating if handler is urgent
+    int m_priority;   //!< Priority lane for non-urgent handlers
   };
   /** @}*/
 } // namespace Hypertable
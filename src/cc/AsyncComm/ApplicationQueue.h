@@ -34,7 +34,10 @@
 #include <Common/Logger.h>
 #include <Common/StringExt.h>
 #include <Common/Thread.h>
+#include <Common/ThreadActivity.h>
+#include <Common/ThreadAffinity.h>
 
+#include <atomic>
 #include <cassert>
 #include <chrono>
 #include <condition_variable>
@@ -52,7 +55,7 @@ namespace Hypertable {
    */
 
   /**
-   * Application queue.  
+   * Application queue.
    * Helper class for use by server applications that are driven by messages
    * received over the network.  This class can be used in conjunction with the
    * ApplicationHandler class to implement an incoming request queue.  Worker
@@ -68,7 +71,7 @@ namespace Hypertable {
    * to a file in the FsBroker, or fetching scanner results from a scanner
    * using multiple readahead requests.  <i>Groups</i> are a way to give
    * applications the ability to serialize a set of requests.  Each request
-   * has a <i>group ID</i> that is returned by 
+   * has a <i>group ID</i> that is returned by
    * the ApplicationHandler#get_group_id method.  Requests that have the
    * same group ID will get executed in series, in the order in which they
    * arrived in the application queue.  Requests with group ID 0 don't belong to
@@ -85,6 +88,24 @@ namespace Hypertable {
    * deadlocks when the application queue gets paused due to low memory
    * condition in the RangeServer.  The ApplicationHandler#is_urgent
    * method is used to signal if a request is urgent.
+   *
+   * Below the urgent lane, requests are divided into <i>high</i>,
+   * <i>normal</i>, and <i>low</i> priority lanes (see
+   * ApplicationHandler#set_priority) that are dequeued with a weighted
+   * round-robin: each lane is assigned a weight and gets that many dequeues
+   * before yielding to the next lane, so latency-sensitive requests can be
+   * favored under load without starving bulk traffic.
+   *
+   * <b>Sharding</b>
+   *
+   * Internally the queue is sharded into one queue pair (plus group state
+   * map) per worker thread, each protected by its own mutex.  Requests that
+   * belong to a group are always routed to the same shard, which is what
+   * preserves the ordered-execution guarantee; ungrouped requests are
+   * distributed round-robin.  A worker that finds its own shard empty steals
+   * from the other shards, so a burst of requests on one shard is still
+   * drained by all workers and dispatch scales with the worker count instead
+   * of serializing on a single queue mutex.
    */
   class ApplicationQueue : public ApplicationQueueInterface {
 
@@ -103,59 +124,102 @@ namespace Hypertable {
     };
 
     /** Hash map of thread group ID to GroupState
-     */ 
+     */
     typedef std::unordered_map<uint64_t, GroupState *> GroupStateMap;
 
+    /** Queue shard.
+     * Holds the request queues and group state for one worker thread.
+     * Requests from the same group always land in the same shard, so the
+     * shard mutex is all that is needed to serialize them.
+     */
+    class QueueShard;
+
     /** Request record.
      */
     class RequestRec {
     public:
-      RequestRec(ApplicationHandler *arh) : handler(arh), group_state(0) { return; }
+      RequestRec(ApplicationHandler *arh) : handler(arh), group_state(0),
+                                            shard(0) { return; }
       ~RequestRec() { delete handler; }
       ApplicationHandler *handler; //!< Pointer to ApplicationHandler
       GroupState *group_state;     //!< Pointer to GroupState to which request belongs
+      QueueShard *shard;           //!< Pointer to shard holding request's group state
     };
 
     /** Individual request queue
      */
     typedef std::list<RequestRec *> RequestQueue;
 
+    class QueueShard {
+    public:
+      /// Request queues, one per priority lane
+      RequestQueue lanes[ApplicationHandler::PRIORITY_COUNT];
+
+      /// Remaining dequeues per lane in the current weighted round
+      int credits[ApplicationHandler::PRIORITY_COUNT];
+
+      /// Group ID to group state map
+      GroupStateMap group_state_map;
+
+      /// %Mutex for serializing concurrent access to shard
+      std::mutex mutex;
+    };
+
     /** Application queue state shared among worker threads.
      */
     class ApplicationQueueState {
     public:
-      ApplicationQueueState() : threads_available(0), shutdown(false),
-                                paused(false) { }
+      ApplicationQueueState() : next_shard(0), wake_generation(0),
+                                threads_available(0), threads_total(0),
+                                shutdown(false), paused(false) {
+        lane_weights[ApplicationHandler::PRIORITY_URGENT] = 0;
+        lane_weights[ApplicationHandler::PRIORITY_HIGH]   = 8;
+        lane_weights[ApplicationHandler::PRIORITY_NORMAL] = 4;
+        lane_weights[ApplicationHandler::PRIORITY_LOW]    = 1;
+      }
 
-      /// Normal request queue
-      RequestQueue queue;
+      ~ApplicationQueueState() {
+        for (QueueShard *shard : shards)
+          delete shard;
+      }
 
-      /// Urgent request queue
-      RequestQueue urgent_queue;
+      /// Queue shards, one per worker thread
+      std::vector<QueueShard *> shards;
 
-      /// Group ID to group state map
-      GroupStateMap group_state_map;
+      /// Round-robin shard counter for ungrouped requests
+      std::atomic<size_t> next_shard;
 
-      /// %Mutex for serializing concurrent access
-      std::mutex mutex;
+      /// %Mutex protecting sleep state (#wake_generation and
+      /// #threads_available)
+      std::mutex sleep_mutex;
 
-      /// Condition variable to signal pending handlers
-      std::condition_variable cond;
+      /// Condition variable on which idle workers sleep
+      std::condition_variable sleep_cond;
 
       /// Condition variable used to signal <i>quiesced</i> queue
       std::condition_variable quiesce_cond;
 
+      /** Dequeue weights per priority lane (the urgent lane is not
+       * weighted; it is always served first) */
+      int lane_weights[ApplicationHandler::PRIORITY_COUNT];
+
+      /** Bumped whenever a request becomes runnable; a worker that scanned
+       * the shards and came up empty only sleeps if the generation is
+       * unchanged since before its scan, which prevents lost wakeups without
+       * holding any shard mutex across the scan. */
+      uint64_t wake_generation;
+
       /// Idle thread count
       size_t threads_available;
-      
+
       /// Total initial threads
       size_t threads_total;
 
       /// Flag indicating if shutdown is in progress
-      bool shutdown;
+      std::atomic<bool> shutdown;
 
       /// Flag indicating if queue has been paused
-      bool paused;
+      std::atomic<bool> paused;
     };
 
     /** Application queue worker thread function (functor)
@@ -163,120 +227,150 @@ namespace Hypertable {
     class Worker {
 
     public:
-      Worker(ApplicationQueueState &qstate, bool one_shot=false) 
-      : m_state(qstate), m_one_shot(one_shot) { return; }
+      Worker(ApplicationQueueState &qstate, size_t shard, bool one_shot=false)
+      : m_state(qstate), m_shard(shard), m_one_shot(one_shot) { return; }
 
       /** Thread run method
        */
       void operator()() {
+        size_t shard_count = m_state.shards.size();
         RequestRec *rec = 0;
-        RequestQueue::iterator iter;
-
-        while (true) {
-          {
-            std::unique_lock<std::mutex> lock(m_state.mutex);
-
-            m_state.threads_available++;
-            while ((m_state.paused || m_state.queue.empty()) &&
-                   m_state.urgent_queue.empty()) {
-              if (m_state.shutdown) {
-                m_state.threads_available--;
-                return;
-              }
-              if (m_state.threads_available == m_state.threads_total)
-                m_state.quiesce_cond.notify_all();
-              m_state.cond.wait(lock);
-            }
-
-            if (m_state.shutdown) {
-              m_state.threads_available--;
-              return;
-            }
+        uint64_t generation;
 
-            rec = 0;
-
-            iter = m_state.urgent_queue.begin();
-            while (iter != m_state.urgent_queue.end()) {
-              rec = (*iter);
-              if (rec->group_state == 0 || !rec->group_state->running) {
-                if (rec->group_state)
-                  rec->group_state->running = true;
-                m_state.urgent_queue.erase(iter);
-                break;
-              }
-              if (!rec->handler || rec->handler->is_expired()) {
-                iter = m_state.urgent_queue.erase(iter);
-                remove_expired(rec);
-              }
-              rec = 0;
-              iter++;
-            }
-
-            if (rec == 0 && !m_state.paused) {
-              iter = m_state.queue.begin();
-              while (iter != m_state.queue.end()) {
-                rec = (*iter);
-                if (rec->group_state == 0 || !rec->group_state->running) {
-                  if (rec->group_state)
-                    rec->group_state->running = true;
-                  m_state.queue.erase(iter);
-                  break;
-                }
-                if (!rec->handler || rec->handler->is_expired()) {
-                  iter = m_state.queue.erase(iter);
-                  remove_expired(rec);
-                }
-                rec = 0;
-                iter++;
-              }
-            }
+        if (!m_one_shot) {
+          ThreadActivity::register_self("app-queue");
+          ThreadAffinity::bind_self("app-queue");
+        }
 
-            if (rec == 0 && !m_one_shot) {
-              if (m_state.shutdown) {
-                m_state.threads_available--;
-                return;
-              }
-              m_state.cond.wait(lock);
-              if (m_state.shutdown) {
-                m_state.threads_available--;
-                return;
-              }
-            }
+        while (!m_state.shutdown) {
 
-            m_state.threads_available--;
+          {
+            std::lock_guard<std::mutex> lock(m_state.sleep_mutex);
+            generation = m_state.wake_generation;
           }
 
+          // Pull from our own shard first, then try to steal from the others
+          rec = next_request(*m_state.shards[m_shard]);
+          for (size_t i=1; rec == 0 && i<shard_count; i++)
+            rec = next_request(*m_state.shards[(m_shard + i) % shard_count]);
+
           if (rec) {
-            if (rec->handler)
+            if (rec->handler) {
+              char detail[32];
+              snprintf(detail, sizeof(detail), "cmd=%llu",
+                       (unsigned long long)rec->handler->get_command());
+              ThreadActivity::set("request", detail);
               rec->handler->run();
+              ThreadActivity::clear();
+            }
             remove(rec);
             if (m_one_shot)
               return;
+            continue;
           }
-          else if (m_one_shot)
+
+          if (m_one_shot)
             return;
-        }
 
-        HT_INFO("thread exit");
+          std::unique_lock<std::mutex> lock(m_state.sleep_mutex);
+          m_state.threads_available++;
+          if (m_state.threads_available == m_state.threads_total)
+            m_state.quiesce_cond.notify_all();
+          if (m_state.wake_generation == generation && !m_state.shutdown)
+            m_state.sleep_cond.wait(lock);
+          m_state.threads_available--;
+        }
       }
 
     private:
 
+      /** Pulls the next executable request from <code>shard</code>.
+       * The urgent lane is scanned first, unconditionally.  If the queue is
+       * not paused, the remaining lanes are then dequeued weighted
+       * round-robin: a lane with credits remaining is served and charged one
+       * credit, and when every lane with queued requests is out of credits
+       * the credits are recharged from the configured weights.  Within a
+       * lane, the oldest request whose group is not already running is
+       * taken, marking the group <i>running</i> before returning.  Expired
+       * requests encountered during the scan are removed and deleted.
+       * @param shard Shard from which to pull
+       * @return Pointer to request record, or 0 if none is executable
+       */
+      RequestRec *next_request(QueueShard &shard) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        RequestRec *rec =
+          pull(shard.lanes[ApplicationHandler::PRIORITY_URGENT], shard);
+        if (rec || m_state.paused)
+          return rec;
+        for (int pass=0; pass<2; ++pass) {
+          for (int lane=ApplicationHandler::PRIORITY_HIGH;
+               lane<ApplicationHandler::PRIORITY_COUNT; ++lane) {
+            if (shard.credits[lane] > 0 && !shard.lanes[lane].empty() &&
+                (rec = pull(shard.lanes[lane], shard)) != 0) {
+              shard.credits[lane]--;
+              return rec;
+            }
+          }
+          for (int lane=ApplicationHandler::PRIORITY_HIGH;
+               lane<ApplicationHandler::PRIORITY_COUNT; ++lane)
+            shard.credits[lane] = m_state.lane_weights[lane];
+        }
+        return 0;
+      }
+
+      /** Scans <code>queue</code> for the oldest executable request.
+       * The shard mutex must be held by the caller.
+       * @param queue Request queue to scan
+       * @param shard Shard holding <code>queue</code>
+       * @return Pointer to request record, or 0 if none is executable
+       */
+      RequestRec *pull(RequestQueue &queue, QueueShard &shard) {
+        RequestQueue::iterator iter = queue.begin();
+        while (iter != queue.end()) {
+          RequestRec *rec = *iter;
+          if (rec->group_state == 0 || !rec->group_state->running) {
+            if (rec->group_state)
+              rec->group_state->running = true;
+            queue.erase(iter);
+            return rec;
+          }
+          if (!rec->handler || rec->handler->is_expired()) {
+            iter = queue.erase(iter);
+            remove_expired(rec, shard);
+            continue;
+          }
+          iter++;
+        }
+        return 0;
+      }
+
       /** Removes and deletes a request.  This method updates the group
        * state associated with <code>rec</code> by setting the running flag to
        * <i>false</i> and decrementing the outstanding count.  If the
        * outstanding count for the group drops to 0, the group state record
-       * is removed from ApplicationQueueState::group_state_map and is deleted.
+       * is removed from the shard's group state map and is deleted.  If
+       * requests remain outstanding, a sleeping worker is woken up since the
+       * oldest of them has just become runnable.
        * @param rec Request record to remove
        */
       void remove(RequestRec *rec) {
         if (rec->group_state) {
-          std::lock_guard<std::mutex> ulock(m_state.mutex);
-          rec->group_state->running = false;
-          rec->group_state->outstanding--;
-          if (rec->group_state->outstanding == 0) {
-            m_state.group_state_map.erase(rec->group_state->group_id);
-            delete rec->group_state;
+          bool unblocked = false;
+          {
+            std::lock_guard<std::mutex> ulock(rec->shard->mutex);
+            rec->group_state->running = false;
+            rec->group_state->outstanding--;
+            if (rec->group_state->outstanding == 0) {
+              rec->shard->group_state_map.erase(rec->group_state->group_id);
+              delete rec->group_state;
+            }
+            else
+              unblocked = true;
+          }
+          if (unblocked) {
+            std::lock_guard<std::mutex> lock(m_state.sleep_mutex);
+            m_state.wake_generation++;
+            m_state.sleep_cond.notify_one();
           }
         }
         delete rec;
@@ -285,15 +379,16 @@ namespace Hypertable {
       /** Removes and deletes an expired request.  This method updates the group
        * state associated with <code>rec</code> by decrementing the outstanding
        * count.  If the outstanding count for the group drops to 0, the group
-       * state record is removed from ApplicationQueueState::group_state_map and
-       * is deleted.
+       * state record is removed from the shard's group state map and is
+       * deleted.  The shard mutex must be held by the caller.
        * @param rec Request record to remove
+       * @param shard Shard holding the request's group state
        */
-      void remove_expired(RequestRec *rec) {
+      void remove_expired(RequestRec *rec, QueueShard &shard) {
         if (rec->group_state) {
           rec->group_state->outstanding--;
           if (rec->group_state->outstanding == 0) {
-            m_state.group_state_map.erase(rec->group_state->group_id);
+            shard.group_state_map.erase(rec->group_state->group_id);
             delete rec->group_state;
           }
         }
@@ -303,13 +398,16 @@ namespace Hypertable {
       /// Shared application queue state object
       ApplicationQueueState &m_state;
 
+      /// Index of this worker's home shard
+      size_t m_shard;
+
       /// Set to <i>true</i> if thread should exit after executing request
       bool m_one_shot;
     };
 
     /// Application queue state object
     ApplicationQueueState m_state;
-    
+
     /// Boost thread group for managing threads
     ThreadGroup m_threads;
 
@@ -333,18 +431,34 @@ namespace Hypertable {
     /**
      * Constructor initialized with worker thread count.
      * This constructor sets up the application queue with a number of worker
-     * threads specified by <code>worker_count</code>.
+     * threads specified by <code>worker_count</code>, creating one queue
+     * shard per worker.
      * @param worker_count Number of worker threads to create
      * @param dynamic_threads Dynamically create temporary thread to carry out
      * requests if none available.
+     * @param lane_weights Dequeue weights for the high, normal, and low
+     * priority lanes, in that order; lanes beyond the vector's size keep
+     * their default weights (8, 4, 1)
      */
-    ApplicationQueue(int worker_count, bool dynamic_threads=true) 
+    ApplicationQueue(int worker_count, bool dynamic_threads=true,
+                     const std::vector<int32_t> &lane_weights
+                     = std::vector<int32_t>())
       : joined(false), m_dynamic_threads(dynamic_threads) {
-      m_state.threads_total = worker_count;
-      Worker Worker(m_state);
       assert (worker_count > 0);
+      m_state.threads_total = worker_count;
+      for (size_t i=0; i<lane_weights.size()
+             && i<(size_t)ApplicationHandler::PRIORITY_COUNT-1; ++i)
+        m_state.lane_weights[ApplicationHandler::PRIORITY_HIGH + i]
+          = (lane_weights[i] > 0) ? lane_weights[i] : 1;
       for (int i=0; i<worker_count; ++i) {
-        m_thread_ids.push_back(m_threads.create_thread(Worker)->get_id());
+        QueueShard *shard = new QueueShard();
+        for (int lane=0; lane<ApplicationHandler::PRIORITY_COUNT; ++lane)
+          shard->credits[lane] = m_state.lane_weights[lane];
+        m_state.shards.push_back(shard);
+      }
+      for (int i=0; i<worker_count; ++i) {
+        Worker worker(m_state, (size_t)i);
+        m_thread_ids.push_back(m_threads.create_thread(worker)->get_id());
       }
       //threads
     }
@@ -373,7 +487,9 @@ namespace Hypertable {
      */
     void shutdown() {
       m_state.shutdown = true;
-      m_state.cond.notify_all();
+      std::lock_guard<std::mutex> lock(m_state.sleep_mutex);
+      m_state.wake_generation++;
+      m_state.sleep_cond.notify_all();
     }
 
     /** Wait for queue to become idle (with timeout).
@@ -385,7 +501,7 @@ namespace Hypertable {
      */
     bool wait_for_idle(std::chrono::time_point<std::chrono::steady_clock> deadline,
                        int reserve_threads=0) {
-      std::unique_lock<std::mutex> lock(m_state.mutex);
+      std::unique_lock<std::mutex> lock(m_state.sleep_mutex);
       return m_state.quiesce_cond.wait_until(lock, deadline,
 					     [this, reserve_threads](){ return m_state.threads_available >= (m_state.threads_total-reserve_threads); });
     }
@@ -404,9 +520,10 @@ namespace Hypertable {
     /** Starts application queue.
      */
     void start() {
-      std::lock_guard<std::mutex> lock(m_state.mutex);
       m_state.paused = false;
-      m_state.cond.notify_all();
+      std::lock_guard<std::mutex> lock(m_state.sleep_mutex);
+      m_state.wake_generation++;
+      m_state.sleep_cond.notify_all();
     }
 
     /** Stops (pauses) application queue, preventing non-urgent requests from
@@ -414,7 +531,6 @@ namespace Hypertable {
      * call are allowed to complete.
      */
     void stop() {
-      std::lock_guard<std::mutex> lock(m_state.mutex);
       m_state.paused = true;
     }
 
@@ -422,43 +538,56 @@ namespace Hypertable {
      * The request queue is designed to support the serialization of related
      * requests.  Requests are related by the thread group ID value in the
      * ApplicationHandler.  This thread group ID is constructed in the
-     * Event object.
+     * Event object.  Grouped requests are routed to the shard derived from
+     * their group ID so that requests from the same group serialize on a
+     * single shard; ungrouped requests are distributed round-robin.
      * @param app_handler Pointer to request to add
      */
     virtual void add(ApplicationHandler *app_handler) {
       GroupStateMap::iterator uiter;
       uint64_t group_id = app_handler->get_group_id();
       RequestRec *rec = new RequestRec(app_handler);
-      rec->group_state = 0;
+      size_t shard_index;
 
       HT_ASSERT(app_handler);
 
-      if (group_id != 0) {
-        std::lock_guard<std::mutex> ulock(m_state.mutex);
-        if ((uiter = m_state.group_state_map.find(group_id))
-            != m_state.group_state_map.end()) {
-          rec->group_state = (*uiter).second;
-          rec->group_state->outstanding++;
-        }
-        else {
-          rec->group_state = new GroupState();
-          rec->group_state->group_id = group_id;
-          m_state.group_state_map[group_id] = rec->group_state;
-        }
-      }
+      if (group_id != 0)
+        shard_index = group_id % m_state.shards.size();
+      else
+        shard_index = m_state.next_shard++ % m_state.shards.size();
+
+      QueueShard &shard = *m_state.shards[shard_index];
+      rec->shard = &shard;
 
       {
-        std::lock_guard<std::mutex> lock(m_state.mutex);
-        if (app_handler->is_urgent()) {
-          m_state.urgent_queue.push_back(rec);
-          if (m_dynamic_threads && m_state.threads_available == 0) {
-            Worker worker(m_state, true);
-            Thread t(worker);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        if (group_id != 0) {
+          if ((uiter = shard.group_state_map.find(group_id))
+              != shard.group_state_map.end()) {
+            rec->group_state = (*uiter).second;
+            rec->group_state->outstanding++;
+          }
+          else {
+            rec->group_state = new GroupState();
+            rec->group_state->group_id = group_id;
+            shard.group_state_map[group_id] = rec->group_state;
           }
         }
-        else
-          m_state.queue.push_back(rec);
-        m_state.cond.notify_one();
+        shard.lanes[app_handler->get_priority()].push_back(rec);
+      }
+
+      bool spawn_thread = false;
+      {
+        std::lock_guard<std::mutex> lock(m_state.sleep_mutex);
+        m_state.wake_generation++;
+        if (app_handler->is_urgent() && m_dynamic_threads &&
+            m_state.threads_available == 0)
+          spawn_thread = true;
+        m_state.sleep_cond.notify_one();
+      }
+      if (spawn_thread) {
+        Worker worker(m_state, shard_index, true);
+        Thread t(worker);
       }
     }
 
@@ -479,8 +608,13 @@ namespace Hypertable {
     /// the request queues for a thread to become available
     /// @return Request backlog
     size_t backlog() {
-      std::lock_guard<std::mutex> lock(m_state.mutex);
-      return m_state.queue.size() + m_state.urgent_queue.size();
+      size_t backlog = 0;
+      for (QueueShard *shard : m_state.shards) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        for (int lane=0; lane<ApplicationHandler::PRIORITY_COUNT; ++lane)
+          backlog += shard->lanes[lane].size();
+      }
+      return backlog;
     }
   };
 
@@ -83,7 +83,6 @@ Comm::Comm() {
 
   InetAddr::initialize(&m_local_addr, System::net_info().primary_addr.c_str(), 0);
 
-  ReactorFactory::get_timer_reactor(m_timer_reactor);
   m_handler_map = ReactorRunner::handler_map;
 }
 
@@ -246,51 +245,77 @@ Comm::listen(const CommAddress &addr, ConnectionHandlerFactoryPtr &chf,
 
   HT_ASSERT(addr.is_inet());
 
-  if ((sd = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP)) < 0)
-    HT_THROW(Error::COMM_SOCKET_ERROR, strerror(errno));
+  size_t listener_count = 1;
 
-  // Set to non-blocking
-  FileUtils::set_flags(sd, O_NONBLOCK);
+#if defined(__linux__) && defined(SO_REUSEPORT)
+  // Shard the listener with SO_REUSEPORT, one accept socket per normal
+  // reactor, so the kernel spreads incoming connections across all of
+  // the reactor threads instead of serializing accepts on one of them
+  if (ReactorFactory::ms_reactors.size() > 3)
+    listener_count = ReactorFactory::ms_reactors.size() - 2;
+#endif
+
+  for (size_t i=0; i<listener_count; i++) {
+
+    if ((sd = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP)) < 0)
+      HT_THROW(Error::COMM_SOCKET_ERROR, strerror(errno));
+
+    // Set to non-blocking
+    FileUtils::set_flags(sd, O_NONBLOCK);
 
 #if defined(__linux__)
-  if (setsockopt(sd, SOL_TCP, TCP_NODELAY, &one, sizeof(one)) < 0 && m_verbose)
-    HT_ERRORF("setting TCP_NODELAY: %s", strerror(errno));
+    if (setsockopt(sd, SOL_TCP, TCP_NODELAY, &one, sizeof(one)) < 0 && m_verbose)
+      HT_ERRORF("setting TCP_NODELAY: %s", strerror(errno));
 #elif defined(__sun__)
-  if (setsockopt(sd, IPPROTO_TCP, TCP_NODELAY, (char*)&one, sizeof(one)) < 0 && m_verbose)
-    HT_ERRORF("setting TCP_NODELAY: %s", strerror(errno));
+    if (setsockopt(sd, IPPROTO_TCP, TCP_NODELAY, (char*)&one, sizeof(one)) < 0 && m_verbose)
+      HT_ERRORF("setting TCP_NODELAY: %s", strerror(errno));
 #elif defined(__APPLE__) || defined(__FreeBSD__)
-  if (setsockopt(sd, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one)) < 0 && m_verbose)
-    HT_WARNF("setsockopt(SO_NOSIGPIPE) failure: %s", strerror(errno));
-  if (setsockopt(sd, SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one)) < 0 && m_verbose)
-    HT_WARNF("setsockopt(SO_REUSEPORT) failure: %s", strerror(errno));
+    if (setsockopt(sd, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one)) < 0 && m_verbose)
+      HT_WARNF("setsockopt(SO_NOSIGPIPE) failure: %s", strerror(errno));
+    if (setsockopt(sd, SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one)) < 0 && m_verbose)
+      HT_WARNF("setsockopt(SO_REUSEPORT) failure: %s", strerror(errno));
 #endif
 
-  if (setsockopt(sd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one)) < 0 && m_verbose)
-    HT_ERRORF("setting SO_REUSEADDR: %s", strerror(errno));
+#if defined(__linux__) && defined(SO_REUSEPORT)
+    if (listener_count > 1 &&
+        setsockopt(sd, SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one)) < 0) {
+      // Kernels older than 3.9 do not support SO_REUSEPORT; fall back
+      // to a single listener
+      if (m_verbose)
+        HT_WARNF("setsockopt(SO_REUSEPORT) failure: %s", strerror(errno));
+      listener_count = 1;
+    }
+#endif
 
-  int bind_attempts = 0;
-  while ((::bind(sd, (const sockaddr *)&addr.inet, sizeof(sockaddr_in))) < 0) {
-    if (bind_attempts == 24)
-      HT_THROWF(Error::COMM_BIND_ERROR, "binding to %s: %s",
-                addr.to_str().c_str(), strerror(errno));
-    if (m_verbose)
-      HT_INFOF("Unable to bind to %s: %s, will retry in 10 seconds...",
-               addr.to_str().c_str(), strerror(errno));
-    this_thread::sleep_for(chrono::milliseconds(10000));
-    bind_attempts++;
-  }
+    if (setsockopt(sd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one)) < 0 && m_verbose)
+      HT_ERRORF("setting SO_REUSEADDR: %s", strerror(errno));
+
+    int bind_attempts = 0;
+    while ((::bind(sd, (const sockaddr *)&addr.inet, sizeof(sockaddr_in))) < 0) {
+      if (bind_attempts == 24)
+        HT_THROWF(Error::COMM_BIND_ERROR, "binding to %s: %s",
+                  addr.to_str().c_str(), strerror(errno));
+      if (m_verbose)
+        HT_INFOF("Unable to bind to %s: %s, will retry in 10 seconds...",
+                 addr.to_str().c_str(), strerror(errno));
+      this_thread::sleep_for(chrono::milliseconds(10000));
+      bind_attempts++;
+    }
 
-  if (::listen(sd, 1000) < 0)
-    HT_THROWF(Error::COMM_LISTEN_ERROR, "listening: %s", strerror(errno));
+    if (::listen(sd, 1000) < 0)
+      HT_THROWF(Error::COMM_LISTEN_ERROR, "listening: %s", strerror(errno));
 
-  handler = new IOHandlerAccept(sd, default_handler, m_handler_map, chf);
-  m_handler_map->insert_handler(handler);
+    // Round-robin reactor assignment in the IOHandler constructor places
+    // each listener shard on a different reactor
+    handler = new IOHandlerAccept(sd, default_handler, m_handler_map, chf);
+    m_handler_map->insert_handler(handler);
 
-  int32_t error;
-  if ((error = handler->start_polling()) != Error::OK) {
-    delete handler;
-    HT_THROWF(error, "Problem polling on listen socket bound to %s",
-              addr.to_str().c_str());
+    int32_t error;
+    if ((error = handler->start_polling()) != Error::OK) {
+      delete handler;
+      HT_THROWF(error, "Problem polling on listen socket bound to %s",
+                addr.to_str().c_str());
+    }
   }
 }
 
@@ -464,9 +489,11 @@ Comm::send_datagram(const CommAddress &addr, const CommAddress &send_addr,
 
 int Comm::set_timer(uint32_t duration_millis, const DispatchHandlerPtr &handler) {
   ExpireTimer timer;
+  ReactorPtr reactor;
+  ReactorFactory::get_reactor(reactor);
   timer.expire_time = ClockT::now() + chrono::milliseconds(duration_millis);
   timer.handler = handler;
-  m_timer_reactor->add_timer(timer);
+  reactor->add_timer(timer);
   return Error::OK;
 }
 
@@ -474,14 +501,17 @@ int Comm::set_timer(uint32_t duration_millis, const DispatchHandlerPtr &handler)
 int
 Comm::set_timer_absolute(ClockT::time_point expire_time, const DispatchHandlerPtr &handler) {
   ExpireTimer timer;
+  ReactorPtr reactor;
+  ReactorFactory::get_reactor(reactor);
   timer.expire_time = expire_time;
   timer.handler = handler;
-  m_timer_reactor->add_timer(timer);
+  reactor->add_timer(timer);
   return Error::OK;
 }
 
 void Comm::cancel_timer(const DispatchHandlerPtr &handler) {
-  m_timer_reactor->cancel_timer(handler);
+  for (auto &reactor : ReactorFactory::ms_reactors)
+    reactor->cancel_timer(handler);
 }
 
 
@@ -496,8 +526,15 @@ void Comm::close_socket(const CommAddress &addr) {
     handler = data_handler;
   else if (m_handler_map->checkout_handler(addr, &datagram_handler) == Error::OK)
     handler = datagram_handler;
-  else if (m_handler_map->checkout_handler(addr, &accept_handler) == Error::OK)
-    handler = accept_handler;
+  else if (m_handler_map->checkout_handler(addr, &accept_handler) == Error::OK) {
+    // A listener may be sharded across multiple accept sockets bound to
+    // the same address, so decomission all of them
+    do {
+      m_handler_map->decomission_handler(accept_handler);
+      m_handler_map->decrement_reference_count(accept_handler);
+    } while (m_handler_map->checkout_handler(addr, &accept_handler) == Error::OK);
+    return;
+  }
   else if (m_handler_map->checkout_handler(addr, &raw_handler) == Error::OK)
     handler = raw_handler;
   else
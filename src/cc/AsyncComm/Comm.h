@@ -377,7 +377,9 @@ namespace Hypertable {
      * <code>handler</code> is the dispatch handler registered with the timer
      * to receive the Event::TIMER event.  This timer registration is
      * <i>one shot</i>.  To set up a periodic timer event, the timer must
-     * be re-registered each time it is handled.
+     * be re-registered each time it is handled.  Timers are distributed
+     * round-robin across the reactors so that heavy timer traffic does not
+     * contend on a single reactor.
      * @note This method sets a smart pointer to <code>handler</code>, so if
      * the reference count to <code>handler</code> is zero when this method
      * is called, it will be deleted after the event is delivered.  To prevent
@@ -410,7 +412,8 @@ namespace Hypertable {
     int set_timer_absolute(ClockT::time_point expire_time, const DispatchHandlerPtr &handler);
 
     /** Cancels all scheduled timers registered with the dispatch handler
-     * <code>handler</code>.
+     * <code>handler</code>.  Since timers are distributed across the
+     * reactors, each reactor's timer wheel is scanned.
      *
      * @param handler Dispatch handler for which all scheduled timer should
      *        be cancelled
@@ -506,12 +509,9 @@ namespace Hypertable {
     /// %Mutex for serializing access to #ms_instance
     static std::mutex ms_mutex;
     
-    /// Pointer to IOHandler map    
+    /// Pointer to IOHandler map
     HandlerMapPtr m_handler_map;
 
-    /// Pointer to dedicated reactor for handling timer events
-    ReactorPtr m_timer_reactor;
-
     /// Local address initialized to primary interface and empty port
     InetAddr m_local_addr;
 
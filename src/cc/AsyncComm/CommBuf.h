@@ -31,6 +31,7 @@
 
 #include "CommHeader.h"
 
+#include <Common/AllocationTracker.h>
 #include <Common/ByteString.h>
 #include <Common/InetAddr.h>
 #include <Common/Logger.h>
@@ -91,6 +92,7 @@ namespace Hypertable {
       data.set(new uint8_t [len], len, true);
       data_ptr = data.base + header.encoded_length();
       header.set_total_length(len);
+      track_allocation();
     }
 
     /** Constructor. This constructor initializes the CommBuf object by
@@ -110,6 +112,7 @@ namespace Hypertable {
       data_ptr = data.base + header.encoded_length();
       header.set_total_length(len+buffer.size);
       ext_ptr = ext.base;
+      track_allocation();
     }
 
 
@@ -135,6 +138,12 @@ namespace Hypertable {
       ext.own = false;
       header.set_total_length(len+ext_len);
       ext_ptr = ext.base;
+      track_allocation();
+    }
+
+    /** Destructor.  Retires the bytes recorded by track_allocation(). */
+    ~CommBuf() {
+      AllocationTracker::add(AllocationTracker::COMM_BUF, -m_tracked_bytes);
     }
 
     /** Encodes the header at the beginning of the primary buffer.
@@ -299,6 +308,20 @@ namespace Hypertable {
 
     /// Smart pointer to extended buffer memory
     boost::shared_array<uint8_t> ext_shared_array;
+
+  private:
+
+    /** Charges the buffers owned by this object to the CommBuf
+     * allocation subsystem.  Called at the end of each constructor, once
+     * buffer ownership has been established.
+     */
+    void track_allocation() {
+      m_tracked_bytes = data.size + (ext.own ? ext.size : 0);
+      AllocationTracker::add(AllocationTracker::COMM_BUF, m_tracked_bytes);
+    }
+
+    /// Bytes charged to the CommBuf allocation subsystem
+    int64_t m_tracked_bytes {};
   };
 
   /// Smart pointer to CommBuf
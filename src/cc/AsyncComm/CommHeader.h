@@ -52,6 +52,9 @@ namespace Hypertable {
       FLAGS_BIT_IGNORE_RESPONSE  = 0x0002, //!< Response should be ignored
       FLAGS_BIT_URGENT           = 0x0004, //!< Request is urgent
       FLAGS_BIT_PROFILE          = 0x0008, //!< Request should be profiled
+      FLAGS_BIT_SHM_PAYLOAD_OK   = 0x0010, //!< Sender accepts shared memory payload
+      FLAGS_BIT_SHM_PAYLOAD      = 0x0020, //!< Payload replaced by shared memory reference
+      FLAGS_BIT_TRACE            = 0x0040, //!< Request carries a trace ID
       FLAGS_BIT_PROXY_MAP_UPDATE = 0x4000, //!< ProxyMap update message
       FLAGS_BIT_PAYLOAD_CHECKSUM = 0x8000  //!< Payload checksumming is enabled
     };
@@ -63,6 +66,9 @@ namespace Hypertable {
       FLAGS_MASK_IGNORE_RESPONSE  = 0xFFFD, //!< Response should be ignored bit
       FLAGS_MASK_URGENT           = 0xFFFB, //!< Request is urgent bit
       FLAGS_MASK_PROFILE          = 0xFFF7, //!< Request should be profiled
+      FLAGS_MASK_SHM_PAYLOAD_OK   = 0xFFEF, //!< Sender accepts shared memory payload bit
+      FLAGS_MASK_SHM_PAYLOAD      = 0xFFDF, //!< Payload replaced by shared memory reference bit
+      FLAGS_MASK_TRACE            = 0xFFBF, //!< Request carries a trace ID bit
       FLAGS_MASK_PROXY_MAP_UPDATE = 0xBFFF, //!< ProxyMap update message bit
       FLAGS_MASK_PAYLOAD_CHECKSUM = 0x7FFF  //!< Payload checksumming is enabled bit
     };
@@ -120,6 +126,25 @@ namespace Hypertable {
      */
     void set_total_length(uint32_t len) { total_len = len; }
 
+    /** Attaches a trace context to the message.
+     * The trace ID is carried in the (otherwise unused) payload_checksum
+     * field, flagged by #FLAGS_BIT_TRACE, so the wire format is unchanged.
+     * Request handlers record span timings against the ID (see
+     * RequestTracer).
+     * @param id Trace ID (must be non-zero)
+     */
+    void set_trace_id(uint32_t id) {
+      payload_checksum = id;
+      flags |= FLAGS_BIT_TRACE;
+    }
+
+    /** Returns the trace ID carried by the message.
+     * @return Trace ID, or 0 if the message carries none
+     */
+    uint32_t trace_id() const {
+      return (flags & FLAGS_BIT_TRACE) ? payload_checksum : 0;
+    }
+
     /** Initializes header from <code>req_header</code>.
      * This method is typically used to initialize a response header
      * from a corresponding request header.
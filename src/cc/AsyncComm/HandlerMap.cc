@@ -38,9 +38,8 @@ using namespace std;
 
 void HandlerMap::insert_handler(IOHandlerAccept *handler) {
   lock_guard<mutex> lock(m_mutex);
-  HT_ASSERT(m_accept_handler_map.find(handler->get_address()) 
-            == m_accept_handler_map.end());
-  m_accept_handler_map[handler->get_local_address()] = handler;
+  m_accept_handler_map.insert(
+      make_pair(handler->get_local_address(), handler));
 }
 
 void HandlerMap::insert_handler(IOHandlerData *handler, bool checkout) {
@@ -166,7 +165,7 @@ int HandlerMap::set_alias(const InetAddr &addr, const InetAddr &alias) {
 }
 
 int HandlerMap::remove_handler_unlocked(IOHandler *handler) {
-  SockAddrMap<IOHandlerAccept *>::iterator aiter;
+  SockAddrMultiMap<IOHandlerAccept *>::iterator aiter;
   SockAddrMap<IOHandlerData *>::iterator diter;
   SockAddrMap<IOHandlerDatagram *>::iterator dgiter;
   SockAddrMap<IOHandlerRaw *>::iterator riter;
@@ -193,7 +192,13 @@ int HandlerMap::remove_handler_unlocked(IOHandler *handler) {
   }
   else if ((aiter = m_accept_handler_map.find(local_addr))
            != m_accept_handler_map.end()) {
-    HT_ASSERT(handler == aiter->second);
+    // Multiple listener shards can be bound to the same address, so
+    // search for the entry matching this handler
+    auto range = m_accept_handler_map.equal_range(local_addr);
+    for (aiter = range.first; aiter != range.second; ++aiter)
+      if (aiter->second == handler)
+        break;
+    HT_ASSERT(aiter != range.second);
     m_accept_handler_map.erase(aiter);
   }
   else if ((riter = m_raw_handler_map.find(remote_addr))
@@ -222,7 +227,7 @@ void HandlerMap::decomission_handler_unlocked(IOHandler *handler) {
 
 void HandlerMap::decomission_all() {
   lock_guard<mutex> lock(m_mutex);
-  SockAddrMap<IOHandlerAccept *>::iterator aiter;
+  SockAddrMultiMap<IOHandlerAccept *>::iterator aiter;
   SockAddrMap<IOHandlerData *>::iterator diter;
   SockAddrMap<IOHandlerDatagram *>::iterator dgiter;
   SockAddrMap<IOHandlerRaw *>::iterator riter;
@@ -437,7 +442,7 @@ int HandlerMap::translate_address(const CommAddress &addr, InetAddr *inet_addr)
 }
 
 IOHandlerAccept *HandlerMap::lookup_accept_handler(const InetAddr &addr) {
-  SockAddrMap<IOHandlerAccept *>::iterator iter = m_accept_handler_map.find(addr);
+  SockAddrMultiMap<IOHandlerAccept *>::iterator iter = m_accept_handler_map.find(addr);
   if (iter != m_accept_handler_map.end())
     return iter->second;
   return 0;
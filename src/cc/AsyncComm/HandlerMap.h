@@ -411,8 +411,9 @@ namespace Hypertable {
     /// Condition variable for signalling proxy map load
     std::condition_variable m_cond_proxy;
 
-    /// Accept map (InetAddr-to-IOHandlerAccept)
-    SockAddrMap<IOHandlerAccept *> m_accept_handler_map;
+    /// Accept map (InetAddr-to-IOHandlerAccept).  A listener sharded with
+    /// SO_REUSEPORT has multiple accept handlers bound to the same address.
+    SockAddrMultiMap<IOHandlerAccept *> m_accept_handler_map;
 
     /// Data (TCP) map (InetAddr-to-IOHandlerData)
     SockAddrMap<IOHandlerData *> m_data_handler_map;
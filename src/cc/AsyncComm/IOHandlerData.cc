@@ -29,6 +29,7 @@
 
 #include "IOHandlerData.h"
 #include "ReactorRunner.h"
+#include "TlsContext.h"
 
 #include <Common/Error.h>
 #include <Common/FileUtils.h>
@@ -39,6 +40,8 @@
 #include <chrono>
 #include <iostream>
 
+#include <openssl/err.h>
+
 extern "C" {
 #include <arpa/inet.h>
 #include <errno.h>
@@ -106,9 +109,150 @@ namespace {
     return nwritten;
   }
 
+  /**
+   * Dispatch handler for the deferred flush of coalesced messages.  The
+   * connection is checked out of the handler map by address when the timer
+   * pops so that a handler that has since been decomissioned and deleted is
+   * never touched.
+   */
+  class CoalesceFlushHandler : public DispatchHandler {
+  public:
+    CoalesceFlushHandler(const InetAddr &addr) : m_addr(addr) { }
+    virtual void handle(EventPtr &event) {
+      IOHandlerData *handler = 0;
+      if (ReactorRunner::handler_map->checkout_handler(m_addr, &handler)
+          == Error::OK) {
+        handler->flush_coalesced();
+        ReactorRunner::handler_map->decrement_reference_count(handler);
+      }
+    }
+  private:
+    InetAddr m_addr;
+  };
+
 } // local namespace
 
 
+IOHandlerData::~IOHandlerData() {
+  if (m_ssl)
+    SSL_free(m_ssl);
+}
+
+
+void IOHandlerData::start_tls(bool client) {
+  if (!ReactorFactory::ms_tls_ctx)
+    return;
+  m_ssl = ReactorFactory::ms_tls_ctx->create_session(m_sd, client, m_addr);
+  m_tls_client = client;
+}
+
+
+void IOHandlerData::maybe_cache_tls_session() {
+  if (m_ssl && m_tls_client && !m_tls_session_cached &&
+      SSL_is_init_finished(m_ssl)) {
+    ReactorFactory::ms_tls_ctx->cache_session(m_addr, m_ssl);
+    m_tls_session_cached = true;
+  }
+}
+
+
+ssize_t IOHandlerData::socket_read(void *vptr, size_t n, int *errnop,
+                                   bool *eofp) {
+  if (m_ssl == 0)
+    return et_socket_read(m_sd, vptr, n, errnop, eofp);
+
+  size_t nleft = n;
+  char *ptr = (char *)vptr;
+
+  while (nleft > 0) {
+    int nread = SSL_read(m_ssl, ptr, (int)nleft);
+    if (nread <= 0) {
+      int ssl_error = SSL_get_error(m_ssl, nread);
+      // WANT_READ/WANT_WRITE mean the record (or handshake) needs more
+      // socket readiness; report EAGAIN so the reactor waits for it
+      if (ssl_error == SSL_ERROR_WANT_READ ||
+          ssl_error == SSL_ERROR_WANT_WRITE) {
+        *errnop = EAGAIN;
+        break;
+      }
+      if (ssl_error == SSL_ERROR_ZERO_RETURN) {
+        *eofp = true;
+        break;
+      }
+      if (ssl_error == SSL_ERROR_SYSCALL && errno == EINTR)
+        continue;
+      *errnop = errno ? errno : EPROTO;
+      if (nleft < n)
+        break;
+      return -1;
+    }
+    nleft -= nread;
+    ptr += nread;
+  }
+  maybe_cache_tls_session();
+  return n - nleft;
+}
+
+
+ssize_t IOHandlerData::ssl_write_some(const uint8_t *ptr, ssize_t len) {
+  ssize_t total = 0;
+
+  while (total < len) {
+    int nwritten = SSL_write(m_ssl, ptr + total, (int)(len - total));
+    if (nwritten <= 0) {
+      int ssl_error = SSL_get_error(m_ssl, nwritten);
+      if (ssl_error == SSL_ERROR_WANT_READ ||
+          ssl_error == SSL_ERROR_WANT_WRITE)
+        break;
+      if (ssl_error == SSL_ERROR_SYSCALL && errno == EINTR)
+        continue;
+      if (ReactorFactory::verbose)
+        HT_WARNF("SSL_write(%d, len=%d) failed : %s", m_sd,
+                 (int)(len - total), ERR_error_string(ERR_get_error(), 0));
+      return -1;
+    }
+    total += nwritten;
+  }
+  return total;
+}
+
+
+int IOHandlerData::flush_ssl_send_queue() {
+  ssize_t nwritten, remaining;
+
+  while (!m_send_queue.empty()) {
+
+    CommBufPtr &cbp = m_send_queue.front();
+
+    remaining = cbp->data.size - (cbp->data_ptr - cbp->data.base);
+    if (remaining > 0) {
+      if ((nwritten = ssl_write_some(cbp->data_ptr, remaining)) == -1)
+        return Error::COMM_BROKEN_CONNECTION;
+      cbp->data_ptr += nwritten;
+      if (nwritten < remaining)
+        break;
+    }
+
+    if (cbp->ext.base != 0) {
+      remaining = cbp->ext.size - (cbp->ext_ptr - cbp->ext.base);
+      if (remaining > 0) {
+        if ((nwritten = ssl_write_some(cbp->ext_ptr, remaining)) == -1)
+          return Error::COMM_BROKEN_CONNECTION;
+        cbp->ext_ptr += nwritten;
+        if (nwritten < remaining)
+          break;
+      }
+    }
+
+    // buffer written successfully, now remove from queue (destroys buffer)
+    m_send_queue.pop_front();
+  }
+
+  maybe_cache_tls_session();
+  return Error::OK;
+}
+
+
 bool
 IOHandlerData::handle_event(struct pollfd *event,
                             ClockT::time_point arrival_time) {
@@ -125,11 +269,21 @@ IOHandlerData::handle_event(struct pollfd *event,
       }
     }
 
+    // With TLS, queued writes can be blocked waiting on handshake input,
+    // so retry the flush when the connection becomes readable
+    if (m_ssl && m_connected && (event->revents & POLLIN) &&
+        !m_send_queue.empty()) {
+      if (handle_write_readiness()) {
+        handle_disconnect();
+        return true;
+      }
+    }
+
     if (event->revents & POLLIN) {
       size_t nread;
       while (true) {
         if (!m_got_header) {
-          nread = et_socket_read(m_sd, m_message_header_ptr,
+          nread = socket_read(m_message_header_ptr,
                                  m_message_header_remaining, &error, &eof);
           if (nread == (size_t)-1) {
             if (errno != ECONNREFUSED) {
@@ -159,7 +313,7 @@ IOHandlerData::handle_event(struct pollfd *event,
             break;
         }
         else { // got header
-          nread = et_socket_read(m_sd, m_message_ptr, m_message_remaining,
+          nread = socket_read(m_message_ptr, m_message_remaining,
                                  &error, &eof);
           if (nread == (size_t)-1) {
             if (ReactorFactory::verbose)
@@ -237,11 +391,21 @@ IOHandlerData::handle_event(struct epoll_event *event,
       }
     }
 
+    // With TLS, queued writes can be blocked waiting on handshake input,
+    // so retry the flush when the connection becomes readable
+    if (m_ssl && m_connected && (event->events & EPOLLIN) &&
+        !m_send_queue.empty()) {
+      if (handle_write_readiness()) {
+        handle_disconnect();
+        return true;
+      }
+    }
+
     if (event->events & EPOLLIN) {
       size_t nread;
       while (true) {
         if (!m_got_header) {
-          nread = et_socket_read(m_sd, m_message_header_ptr,
+          nread = socket_read(m_message_header_ptr,
                                  m_message_header_remaining, &error, &eof);
           if (nread == (size_t)-1) {
             if (errno != ECONNREFUSED) {
@@ -271,7 +435,7 @@ IOHandlerData::handle_event(struct epoll_event *event,
             break;
         }
         else { // got header
-          nread = et_socket_read(m_sd, m_message_ptr, m_message_remaining,
+          nread = socket_read(m_message_ptr, m_message_remaining,
                                  &error, &eof);
           if (nread == (size_t)-1) {
             if (ReactorFactory::verbose)
@@ -362,7 +526,7 @@ bool IOHandlerData::handle_event(port_event_t *event,
       size_t nread;
       while (true) {
         if (!m_got_header) {
-          nread = et_socket_read(m_sd, m_message_header_ptr,
+          nread = socket_read(m_message_header_ptr,
                                  m_message_header_remaining, &error, &eof);
           if (nread == (size_t)-1) {
             if (errno != ECONNREFUSED) {
@@ -392,7 +556,7 @@ bool IOHandlerData::handle_event(port_event_t *event,
             break;
         }
         else { // got header
-          nread = et_socket_read(m_sd, m_message_ptr, m_message_remaining,
+          nread = socket_read(m_message_ptr, m_message_remaining,
                                  &error, &eof);
           if (nread == (size_t)-1) {
             if (ReactorFactory::verbose)
@@ -756,7 +920,21 @@ IOHandlerData::send_message(CommBufPtr &cbp, uint32_t timeout_ms,
   m_send_queue.push_back(cbp);
 
   if (m_connected) {
-    if ((error = flush_send_queue()) != Error::OK) {
+    // Nagle-style coalescing:  small messages are held on the send queue
+    // briefly so that other messages sent to this connection in the
+    // meantime get merged into a single writev by the deferred flush
+    if (ReactorFactory::ms_coalesce_limit > 0 &&
+        cbp->header.total_len <= ReactorFactory::ms_coalesce_limit) {
+      if (!m_coalesce_pending) {
+        ExpireTimer timer;
+        timer.expire_time = ClockT::now() +
+          chrono::milliseconds(ReactorFactory::ms_coalesce_delay);
+        timer.handler = make_shared<CoalesceFlushHandler>(m_addr);
+        m_reactor->add_timer(timer);
+        m_coalesce_pending = true;
+      }
+    }
+    else if ((error = flush_send_queue()) != Error::OK) {
       if (ReactorFactory::verbose)
         HT_WARNF("Problem flushing send queue - %s", Error::get_text(error));
       ReactorRunner::handler_map->decomission_handler(this);
@@ -785,35 +963,67 @@ IOHandlerData::send_message(CommBufPtr &cbp, uint32_t timeout_ms,
 }
 
 
+void IOHandlerData::flush_coalesced() {
+  lock_guard<mutex> lock(m_mutex);
+  int error;
+
+  m_coalesce_pending = false;
+
+  if (m_decomissioned || !m_connected || m_send_queue.empty())
+    return;
+
+  if ((error = flush_send_queue()) != Error::OK) {
+    if (ReactorFactory::verbose)
+      HT_WARNF("Problem flushing send queue - %s", Error::get_text(error));
+    ReactorRunner::handler_map->decomission_handler(this);
+    if (m_error == Error::OK)
+      m_error = error;
+    return;
+  }
+
+  if (m_send_queue.empty() &&
+      (error = remove_poll_interest(PollEvent::WRITE)) != Error::OK &&
+      m_error == Error::OK)
+    m_error = error;
+}
+
+
 #if defined(__linux__)
 
 int IOHandlerData::flush_send_queue() {
   ssize_t nwritten, towrite, remaining;
-  struct iovec vec[2];
+  struct iovec vec[64];
   int count;
   int error = 0;
 
-  while (!m_send_queue.empty()) {
+  if (m_ssl)
+    return flush_ssl_send_queue();
 
-    CommBufPtr &cbp = m_send_queue.front();
+  while (!m_send_queue.empty()) {
 
+    // Gather as many queued buffers as fit into the iovec array so that
+    // a backlog of messages is submitted with a single writev call
     count = 0;
     towrite = 0;
-    remaining = cbp->data.size - (cbp->data_ptr - cbp->data.base);
-    if (remaining > 0) {
-      vec[0].iov_base = (void *)cbp->data_ptr;
-      vec[0].iov_len = remaining;
-      towrite = remaining;
-      ++count;
-    }
-    if (cbp->ext.base != 0) {
-      remaining = cbp->ext.size - (cbp->ext_ptr - cbp->ext.base);
+    for (CommBufPtr &cbp : m_send_queue) {
+      if (count + 2 > (int)(sizeof(vec)/sizeof(vec[0])))
+        break;
+      remaining = cbp->data.size - (cbp->data_ptr - cbp->data.base);
       if (remaining > 0) {
-        vec[count].iov_base = (void *)cbp->ext_ptr;
+        vec[count].iov_base = (void *)cbp->data_ptr;
         vec[count].iov_len = remaining;
         towrite += remaining;
         ++count;
       }
+      if (cbp->ext.base != 0) {
+        remaining = cbp->ext.size - (cbp->ext_ptr - cbp->ext.base);
+        if (remaining > 0) {
+          vec[count].iov_base = (void *)cbp->ext_ptr;
+          vec[count].iov_len = remaining;
+          towrite += remaining;
+          ++count;
+        }
+      }
     }
 
     nwritten = et_socket_writev(m_sd, vec, count, &error);
@@ -825,43 +1035,38 @@ int IOHandlerData::flush_send_queue() {
                  strerror(errno));
       return Error::COMM_BROKEN_CONNECTION;
     }
-    else if (nwritten < towrite) {
-      if (nwritten == 0) {
-        if (error == EAGAIN)
-          break;
-        if (error) {
-          if (ReactorFactory::verbose)
-            HT_WARNF("FileUtils::writev(%d, len=%d) failed : %s", m_sd,
-                     (int)towrite, strerror(error));
-          return Error::COMM_BROKEN_CONNECTION;
-        }
-        continue;
-      }
+
+    // Advance the buffer pointers over the bytes written, removing fully
+    // written buffers from the front of the queue
+    while (nwritten > 0 && !m_send_queue.empty()) {
+      CommBufPtr &cbp = m_send_queue.front();
       remaining = cbp->data.size - (cbp->data_ptr - cbp->data.base);
       if (remaining > 0) {
         if (nwritten < remaining) {
           cbp->data_ptr += nwritten;
-          if (error == EAGAIN)
-            break;
-          error = 0;
-          continue;
-        }
-        else {
-          nwritten -= remaining;
-          cbp->data_ptr += remaining;
+          nwritten = 0;
+          break;
         }
+        cbp->data_ptr += remaining;
+        nwritten -= remaining;
       }
       if (cbp->ext.base != 0) {
-        cbp->ext_ptr += nwritten;
-        if (error == EAGAIN)
-          break;
-        error = 0;
-        continue;
+        remaining = cbp->ext.size - (cbp->ext_ptr - cbp->ext.base);
+        if (remaining > 0) {
+          if (nwritten < remaining) {
+            cbp->ext_ptr += nwritten;
+            nwritten = 0;
+            break;
+          }
+          cbp->ext_ptr += remaining;
+          nwritten -= remaining;
+        }
       }
+      // buffer written successfully, now remove from queue (destroys buffer)
+      m_send_queue.pop_front();
     }
 
-    // buffer written successfully, now remove from queue (destroys buffer)
-    m_send_queue.pop_front();
+    error = 0;
   }
 
   return Error::OK;
@@ -874,6 +1079,9 @@ int IOHandlerData::flush_send_queue() {
   struct iovec vec[2];
   int count;
 
+  if (m_ssl)
+    return flush_ssl_send_queue();
+
   while (!m_send_queue.empty()) {
 
     CommBufPtr &cbp = m_send_queue.front();
@@ -40,6 +40,8 @@ extern "C" {
 #include <string.h>
 }
 
+struct ssl_st;
+
 namespace Hypertable {
 
   /** @addtogroup AsyncComm
@@ -64,10 +66,13 @@ namespace Hypertable {
       memcpy(&m_addr, &addr, sizeof(InetAddr));
       m_connected = connected;
       reset_incoming_message_state();
+      // The accepting side is constructed connected, the connecting side
+      // is not, which determines the TLS handshake role
+      start_tls(!connected);
     }
 
     /** Destructor */
-    virtual ~IOHandlerData() { }
+    virtual ~IOHandlerData();
 
     /** Disconnects handler by delivering Event::DISCONNECT via default dispatch
      * handler.
@@ -135,6 +140,16 @@ namespace Hypertable {
      */
     int flush_send_queue();
 
+    /** Performs a deferred flush of coalesced messages.  When send
+     * coalescing is enabled (see ReactorFactory#ms_coalesce_limit), small
+     * messages are queued by #send_message without an immediate flush and a
+     * timer is set; this method is invoked when that timer pops and writes
+     * out everything that accumulated on the send queue in the interim with
+     * a single writev.  If a write error is encountered, the handler is
+     * decomissioned.
+     */
+    void flush_coalesced();
+
     /** Handle <code>poll()</code> interface events.
      * This method is called by its reactor thread to handle I/O events.
      * It handles <code>POLLOUT</code> events with a call to
@@ -295,9 +310,66 @@ namespace Hypertable {
      */
     void handle_disconnect();
 
+    /** Attaches a TLS session to the connection when TLS is enabled (see
+     * ReactorFactory#ms_tls_ctx), otherwise does nothing.  The handshake is
+     * not performed here; it proceeds incrementally under the reads and
+     * writes driven by the reactor, so reactor threads never block on
+     * handshake I/O.
+     * @param client <i>true</i> for the connecting side of the connection
+     */
+    void start_tls(bool client);
+
+    /** Reads data off the socket, transparently decrypting it when TLS is
+     * enabled.  Follows the same contract as the raw edge-triggered read:
+     * reads until <code>n</code> bytes are consumed or the operation would
+     * block (indicated by EAGAIN in <code>*errnop</code>).
+     * @param vptr Buffer to receive data
+     * @param n Number of bytes to read
+     * @param errnop Address of variable to hold <code>errno</code>
+     * @param eofp Address of variable set to <i>true</i> on end-of-stream
+     * @return Number of bytes read, or -1 on error with nothing read
+     */
+    ssize_t socket_read(void *vptr, size_t n, int *errnop, bool *eofp);
+
+    /** Writes as much of <code>[ptr,ptr+len)</code> as the connection will
+     * accept using <code>SSL_write</code>.
+     * @param ptr Buffer to write
+     * @param len Number of bytes to write
+     * @return Number of bytes written (less than <code>len</code> if the
+     * operation would block), or -1 on error
+     */
+    ssize_t ssl_write_some(const uint8_t *ptr, ssize_t len);
+
+    /** Flushes the send queue over a TLS connection.  Serves the same
+     * purpose as #flush_send_queue, which delegates here when TLS is
+     * enabled.
+     * @return Error::OK on success or would-block, or
+     * Error::COMM_BROKEN_CONNECTION if a write error was encountered
+     */
+    int flush_ssl_send_queue();
+
+    /** Caches the negotiated TLS session for this connection's peer once
+     * the handshake has completed, enabling session resumption on
+     * reconnect.  Only the connecting side caches; the accepting side's
+     * sessions are held in the shared context's internal cache.
+     */
+    void maybe_cache_tls_session();
+
     /// Flag indicating if socket connection has been completed
     bool m_connected {};
 
+    /// Flag indicating if a coalescing flush timer is outstanding
+    bool m_coalesce_pending {};
+
+    /// TLS session, non-null when TLS is enabled
+    ssl_st *m_ssl {};
+
+    /// Flag indicating if this is the connecting side of a TLS connection
+    bool m_tls_client {};
+
+    /// Flag indicating if the TLS session has been cached for resumption
+    bool m_tls_session_cached {};
+
     /// Flag indicating if message header has been completely received
     bool m_got_header {};
 
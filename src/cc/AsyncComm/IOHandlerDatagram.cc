@@ -117,58 +117,85 @@ IOHandlerDatagram::handle_event(struct pollfd *event,
 
 #if defined(__linux__)
 
-bool IOHandlerDatagram::handle_event(struct epoll_event *event,
-                                     ClockT::time_point arrival_time) {
-  int error;
+bool IOHandlerDatagram::receive_datagrams(ClockT::time_point arrival_time) {
+  struct mmsghdr msgvec[DATAGRAM_BATCH_SIZE];
+  struct iovec iov[DATAGRAM_BATCH_SIZE];
+  InetAddr addrs[DATAGRAM_BATCH_SIZE];
+  ssize_t payload_len;
+  int count;
+
+  while (true) {
+
+    for (int i=0; i<DATAGRAM_BATCH_SIZE; i++) {
+      iov[i].iov_base = m_message + (i * 65536);
+      iov[i].iov_len = 65536;
+      memset(&msgvec[i], 0, sizeof(struct mmsghdr));
+      msgvec[i].msg_hdr.msg_name = &addrs[i];
+      msgvec[i].msg_hdr.msg_namelen = sizeof(struct sockaddr_in);
+      msgvec[i].msg_hdr.msg_iov = &iov[i];
+      msgvec[i].msg_hdr.msg_iovlen = 1;
+    }
 
-  //DisplayEvent(event);
+    while ((count = recvmmsg(m_sd, msgvec, DATAGRAM_BATCH_SIZE, 0, 0)) < 0
+           && errno == EINTR)
+      ;
 
-  if (event->events & EPOLLOUT) {
-    if ((error = handle_write_readiness()) != Error::OK) {
-      EventPtr event_ptr = make_shared<Event>(Event::ERROR, m_addr, error);
+    if (count < 0) {
+      if (errno == EAGAIN || errno == EWOULDBLOCK)
+        return true;
+      HT_ERRORF("recvmmsg(%d) failure : %s", m_sd, strerror(errno));
+      EventPtr event_ptr = make_shared<Event>(Event::ERROR, m_addr,
+                                              Error::COMM_RECEIVE_ERROR);
       deliver_event(event_ptr);
       ReactorRunner::handler_map->decomission_handler(this);
-      return true;
+      return false;
     }
-  }
 
-  if (event->events & EPOLLIN) {
-    ssize_t nread, payload_len;
-    InetAddr addr;
-    socklen_t fromlen = sizeof(struct sockaddr_in);
+    for (int i=0; i<count; i++) {
+      uint8_t *message = (uint8_t *)iov[i].iov_base;
 
-    while ((nread = FileUtils::recvfrom(m_sd, m_message, 65536,
-            (struct sockaddr *)&addr, &fromlen)) != (ssize_t)-1) {
+      EventPtr event_ptr = make_shared<Event>(Event::MESSAGE, addrs[i],
+                                              Error::OK);
 
-      EventPtr event_ptr = make_shared<Event>(Event::MESSAGE, addr, Error::OK);
-      
       try {
-        event_ptr->load_message_header(m_message, (size_t)m_message[1]);
+        event_ptr->load_message_header(message, (size_t)message[1]);
       }
       catch (Hypertable::Exception &e) {
-        HT_ERROR_OUT << e << " - from " << addr.format() << HT_END;
+        HT_ERROR_OUT << e << " - from " << addrs[i].format() << HT_END;
         continue;
       }
 
-      payload_len = nread - (ssize_t)event_ptr->header.header_len;
+      payload_len = (ssize_t)msgvec[i].msg_len
+        - (ssize_t)event_ptr->header.header_len;
       event_ptr->payload_len = payload_len;
       event_ptr->payload = new uint8_t [payload_len];
       event_ptr->arrival_time = arrival_time;
-      memcpy((void *)event_ptr->payload, m_message + event_ptr->header.header_len,
-             payload_len);
-      deliver_event( event_ptr );
-      fromlen = sizeof(struct sockaddr_in);
+      memcpy((void *)event_ptr->payload,
+             message + event_ptr->header.header_len, payload_len);
+      deliver_event(event_ptr);
     }
+  }
+}
 
-    if (errno != EAGAIN) {
-      HT_ERRORF("FileUtils::recvfrom(%d) failure : %s", m_sd, strerror(errno));
-      EventPtr event_ptr = make_shared<Event>(Event::ERROR, addr,
-                                              Error::COMM_RECEIVE_ERROR);
+
+bool IOHandlerDatagram::handle_event(struct epoll_event *event,
+                                     ClockT::time_point arrival_time) {
+  int error;
+
+  //DisplayEvent(event);
+
+  if (event->events & EPOLLOUT) {
+    if ((error = handle_write_readiness()) != Error::OK) {
+      EventPtr event_ptr = make_shared<Event>(Event::ERROR, m_addr, error);
       deliver_event(event_ptr);
       ReactorRunner::handler_map->decomission_handler(this);
       return true;
     }
+  }
 
+  if (event->events & EPOLLIN) {
+    if (!receive_datagrams(arrival_time))
+      return true;
     return false;
   }
 
@@ -380,6 +407,61 @@ int IOHandlerDatagram::send_message(const InetAddr &addr, CommBufPtr &cbp) {
 }
 
 
+#if defined(__linux__)
+
+int IOHandlerDatagram::flush_send_queue() {
+  struct mmsghdr msgvec[DATAGRAM_BATCH_SIZE];
+  struct iovec iov[DATAGRAM_BATCH_SIZE];
+  ssize_t tosend;
+  int count, nsent;
+
+  while (!m_send_queue.empty()) {
+
+    count = 0;
+    for (auto &send_rec : m_send_queue) {
+      if (count == DATAGRAM_BATCH_SIZE)
+        break;
+      tosend = send_rec.second->data.size - (send_rec.second->data_ptr
+                                             - send_rec.second->data.base);
+      assert(tosend > 0);
+      assert(send_rec.second->ext.base == 0);
+      iov[count].iov_base = send_rec.second->data_ptr;
+      iov[count].iov_len = tosend;
+      memset(&msgvec[count], 0, sizeof(struct mmsghdr));
+      msgvec[count].msg_hdr.msg_name = &send_rec.first;
+      msgvec[count].msg_hdr.msg_namelen = sizeof(struct sockaddr_in);
+      msgvec[count].msg_hdr.msg_iov = &iov[count];
+      msgvec[count].msg_hdr.msg_iovlen = 1;
+      count++;
+    }
+
+    while ((nsent = sendmmsg(m_sd, msgvec, count, 0)) < 0 && errno == EINTR)
+      ;
+
+    if (nsent < 0) {
+      if (errno == EAGAIN || errno == EWOULDBLOCK || errno == ENOBUFS)
+        return Error::OK;
+      SendRec &send_rec = m_send_queue.front();
+      HT_WARNF("sendmmsg(%d, count=%d, addr=%s:%d) failed : %s", m_sd, count,
+               inet_ntoa(send_rec.first.sin_addr),
+               ntohs(send_rec.first.sin_port), strerror(errno));
+      return Error::COMM_SEND_ERROR;
+    }
+
+    // each datagram is sent in its entirety or not at all
+    for (int i=0; i<nsent; i++)
+      m_send_queue.pop_front();
+
+    // fewer than requested implies the send buffer is full
+    if (nsent < count)
+      break;
+  }
+
+  return Error::OK;
+}
+
+#else
+
 int IOHandlerDatagram::flush_send_queue() {
   ssize_t nsent, tosend;
 
@@ -416,3 +498,5 @@ int IOHandlerDatagram::flush_send_queue() {
 
   return Error::OK;
 }
+
+#endif
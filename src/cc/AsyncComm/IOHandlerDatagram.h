@@ -58,7 +58,11 @@ namespace Hypertable {
      */
     IOHandlerDatagram(int sd, const DispatchHandlerPtr &dhp,
                       Reactor::Priority rp) : IOHandler(sd, dhp, rp) {
+#if defined(__linux__)
+      m_message = new uint8_t [DATAGRAM_BATCH_SIZE * 65536];
+#else
       m_message = new uint8_t [65536];
+#endif
       memcpy(&m_addr, &m_local_addr, sizeof(InetAddr));
     }
 
@@ -76,11 +80,12 @@ namespace Hypertable {
     int send_message(const InetAddr &addr, CommBufPtr &cbp);
 
     /** Flushes send queue.  This method tries to write all messages on the
-     * send queue.  If a write succeeds, but writes fewer bytes than requested,
-     * that implies the send buffer is full.  The send queue holds a list of
-     * CommBuf objects (and associated destination addresses) that contain
-     * <i>next write</i> pointers that are updated by this method and allow it to
-     * pick up where it left off in the event of a short write.
+     * send queue.  On Linux, messages are sent in batches of up to
+     * #DATAGRAM_BATCH_SIZE datagrams per <code>sendmmsg</code> call;
+     * elsewhere each datagram is sent with an individual <code>sendto</code>
+     * call.  If the socket send buffer fills up, the remaining messages are
+     * left on the send queue to be flushed when the socket becomes writable
+     * again.
      * @return Error::OK on success, or Error::COMM_SEND_ERROR on send error
      */
     int flush_send_queue();
@@ -137,9 +142,10 @@ namespace Hypertable {
      * It handles <code>EPOLLOUT</code> events with a call to
      * #handle_write_readiness.  If #handle_write_readiness returns <i>true</i>
      * the handler is disconnected with a call to handle_disconnect() and
-     * <i>true</i> is returned.  <code>EPOLLIN</code> events are handled in
-     * a loop by reading messages off the socket in their entirety with a call
-     * to <code>recvfrom</code>.  The message buffer is 65536 bytes in size
+     * <i>true</i> is returned.  <code>EPOLLIN</code> events are handled with
+     * a call to #receive_datagrams, which reads messages off the socket in
+     * batches of up to #DATAGRAM_BATCH_SIZE datagrams per
+     * <code>recvmmsg</code> call.  Each receive buffer is 65536 bytes in size
      * and therefore this method can only handle messages of that size or
      * less.  Messages are delivered to the application by creating an Event
      * object, initializing it with the message header and
@@ -193,6 +199,24 @@ namespace Hypertable {
 
   private:
 
+#if defined(__linux__)
+    /// Maximum number of datagrams moved per recvmmsg/sendmmsg call
+    enum { DATAGRAM_BATCH_SIZE = 16 };
+
+    /** Receives and delivers datagrams in batches (Linux only).
+     * This method reads messages off the socket in batches of up to
+     * #DATAGRAM_BATCH_SIZE datagrams per <code>recvmmsg</code> call, looping
+     * until the socket is drained, and delivers each message to the
+     * application as described in #handle_event.  Receive errors are handled
+     * by decomissioning the handler and delivering an Event::ERROR event to
+     * the application.
+     * @param arrival_time Time of event arrival
+     * @return <i>true</i> on success, <i>false</i> if error encountered and
+     * handler was decomissioned
+     */
+    bool receive_datagrams(ClockT::time_point arrival_time);
+#endif
+
     /// Send queue message record
     typedef std::pair<struct sockaddr_in, CommBufPtr> SendRec;
 
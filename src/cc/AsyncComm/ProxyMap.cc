@@ -41,14 +41,17 @@ void ProxyMap::update_mapping(const String &proxy, const String &hostname,
   lock_guard<mutex> lock(m_mutex);
   ProxyMapT::iterator iter = m_forward_map.find(proxy);
   if (iter != m_forward_map.end() && (*iter).second.addr == addr) {
-    if ((*iter).second.hostname != hostname)
+    if ((*iter).second.hostname != hostname) {
       (*iter).second.hostname = hostname;
+      publish();
+    }
     return;
   }
   invalidate_old_mapping(proxy, addr, invalidated_map);
   new_map[proxy] = ProxyAddressInfo(hostname, addr);
   m_forward_map[proxy] = ProxyAddressInfo(hostname, addr);
   m_reverse_map[addr] = proxy;
+  publish();
 }
 
 
@@ -94,21 +97,23 @@ void ProxyMap::update_mappings(String &mappings, ProxyMapT &invalidated_map,
       m_reverse_map[addr] = proxy;
     }
   }
+  publish();
 }
 
 
 void ProxyMap::remove_mapping(const String &proxy, ProxyMapT &remove_map) {
   lock_guard<mutex> lock(m_mutex);
   invalidate(proxy, remove_map);
+  publish();
   return;
 }
 
 
 
 bool ProxyMap::get_mapping(const String &proxy, String &hostname, InetAddr &addr) {
-  lock_guard<mutex> lock(m_mutex);
-  ProxyMapT::iterator iter = m_forward_map.find(proxy);
-  if (iter == m_forward_map.end())
+  SnapshotPtr snap = snapshot();
+  ProxyMapT::const_iterator iter = snap->forward_map.find(proxy);
+  if (iter == snap->forward_map.end())
     return false;
   addr = (*iter).second.addr;
   hostname = (*iter).second.hostname;
@@ -116,20 +121,20 @@ bool ProxyMap::get_mapping(const String &proxy, String &hostname, InetAddr &addr
 }
 
 String ProxyMap::get_proxy(InetAddr &addr) {
-  lock_guard<mutex> lock(m_mutex);
-  SockAddrMap<String>::iterator iter = m_reverse_map.find(addr);
-  if (iter != m_reverse_map.end())
+  SnapshotPtr snap = snapshot();
+  SockAddrMap<String>::const_iterator iter = snap->reverse_map.find(addr);
+  if (iter != snap->reverse_map.end())
     return (*iter).second;
   return "";
 }
 
 
 CommBufPtr ProxyMap::create_update_message() {
-  lock_guard<mutex> lock(m_mutex);
+  SnapshotPtr snap = snapshot();
   String payload;
   CommHeader header;
   header.flags |= CommHeader::FLAGS_BIT_PROXY_MAP_UPDATE;
-  for (ProxyMapT::iterator iter = m_forward_map.begin(); iter != m_forward_map.end(); ++iter)
+  for (ProxyMapT::const_iterator iter = snap->forward_map.begin(); iter != snap->forward_map.end(); ++iter)
     payload += (*iter).first + "\t" + (*iter).second.hostname + "\t" + (*iter).second.addr.format() + "\n";
   CommBufPtr cbuf = make_shared<CommBuf>(header, payload.length());
   if (payload.length())
@@ -164,6 +169,14 @@ ProxyMap::invalidate_old_mapping(const String &proxy, const InetAddr &addr,
 
 }
 
+void ProxyMap::publish() {
+  std::shared_ptr<Snapshot> snap = make_shared<Snapshot>();
+  snap->forward_map = m_forward_map;
+  snap->reverse_map = m_reverse_map;
+  std::atomic_store_explicit(&m_snapshot, SnapshotPtr(snap),
+                             std::memory_order_release);
+}
+
 void ProxyMap::invalidate(const String &proxy, ProxyMapT &invalidated_map) {
   ProxyMapT::iterator iter;
   SockAddrMap<String>::iterator rev_iter;
@@ -187,10 +200,10 @@ void ProxyMap::invalidate(const String &proxy, ProxyMapT &invalidated_map) {
 }
 
 String ProxyMap::to_str() {
-  lock_guard<mutex> lock(m_mutex);
-  ProxyMapT::iterator iter;
+  SnapshotPtr snap = snapshot();
+  ProxyMapT::const_iterator iter;
   String str;
-  for (iter = m_forward_map.begin(); iter != m_forward_map.end(); ++iter)
+  for (iter = snap->forward_map.begin(); iter != snap->forward_map.end(); ++iter)
     str += format("(%s,%s,%s),", (*iter).first.c_str(),
                   (*iter).second.hostname.c_str(), (*iter).second.addr.format().c_str());
   return str;
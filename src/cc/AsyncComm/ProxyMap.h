@@ -31,10 +31,13 @@
 
 #include <AsyncComm/CommBuf.h>
 
+#include <Common/FlatHashMap.h>
 #include <Common/InetAddr.h>
 #include <Common/SockAddrMap.h>
 #include <Common/String.h>
 
+#include <atomic>
+#include <memory>
 #include <mutex>
 
 namespace Hypertable {
@@ -54,7 +57,7 @@ namespace Hypertable {
   };
 
   /// Forward mapping hash type from proxy name to ProxyAddressInfo
-  typedef std::unordered_map<String, ProxyAddressInfo> ProxyMapT;
+  typedef FlatHashMap<String, ProxyAddressInfo> ProxyMapT;
 
   /** Maps a set of proxy names to their associated IP addresses.
    * Hypertable uses <i>proxy names</i> (e.g. "rs1") to refer to servers so
@@ -80,6 +83,8 @@ namespace Hypertable {
 
   public:
 
+    ProxyMap() : m_snapshot(std::make_shared<Snapshot>()) { }
+
     /** Updates a proxy name mapping.  This method first checks to see if there
      * is already a mapping from <code>proxy</code> to <code>addr</code> in the
      * forawrd map.  If so, then it updates the hostname.  Otherwise, it
@@ -162,7 +167,7 @@ namespace Hypertable {
      * @param map Reference to return forward map
      */
     void get_map(ProxyMapT &map) {
-      map = m_forward_map;
+      map = snapshot()->forward_map;
     }
 
     /** Creates a proxy map update message.  This method is called by the proxy
@@ -183,6 +188,40 @@ namespace Hypertable {
 
   private:
 
+    /** Immutable snapshot of the forward and reverse maps.
+     * The proxy map is consulted on every message send and receive involving
+     * a proxy address but changes only when servers join or move, so readers
+     * fetch the current snapshot with an atomic load and perform their
+     * lookups without taking #m_mutex.  Writers mutate the authoritative
+     * maps under #m_mutex and publish a fresh snapshot afterwards (see
+     * #publish); snapshots already handed out to readers remain valid until
+     * the last reference drops.
+     */
+    struct Snapshot {
+      /// Forward map from proxy name to ProxyAddressInfo
+      ProxyMapT forward_map;
+      /// Reverse map from IP address to proxy name
+      SockAddrMap<String> reverse_map;
+    };
+
+    /// Smart pointer to const Snapshot
+    typedef std::shared_ptr<const Snapshot> SnapshotPtr;
+
+    /** Returns the current snapshot (lock free).
+     * @return Smart pointer to current snapshot
+     */
+    SnapshotPtr snapshot() const {
+      return std::atomic_load_explicit(&m_snapshot,
+                                       std::memory_order_acquire);
+    }
+
+    /** Publishes a new snapshot of the maps.
+     * Copies #m_forward_map and #m_reverse_map into a freshly allocated
+     * Snapshot and atomically installs it as #m_snapshot.  Assumes #m_mutex
+     * is locked by the caller.
+     */
+    void publish();
+
     /** Invalidates (removes) mapping, if changed, from forward and reverse maps.
      * This method looks up <code>proxy</code> in the forward map and removes
      * it if it exists but maps to an address different from <code>addr</code>.
@@ -210,14 +249,19 @@ namespace Hypertable {
      */
     void invalidate(const String &proxy, ProxyMapT &invalidated_mappings);
 
-    /// %Mutex for serializing concurrent access
+    /// %Mutex for serializing writers
     std::mutex m_mutex;
 
-    /// Forward map from proxy name to ProxyAddressInfo
+    /// Authoritative forward map from proxy name to ProxyAddressInfo
+    /// (modified under #m_mutex)
     ProxyMapT m_forward_map;
 
-    /// Reverse map from IP address to proxy name
+    /// Authoritative reverse map from IP address to proxy name (modified
+    /// under #m_mutex)
     SockAddrMap<String> m_reverse_map;
+
+    /// Currently published snapshot, accessed with atomic loads and stores
+    SnapshotPtr m_snapshot;
   };
 
   /** @}*/
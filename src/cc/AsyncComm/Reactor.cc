@@ -170,8 +170,7 @@ Reactor::Reactor() {
 void Reactor::handle_timeouts(PollTimeout &next_timeout) {
   vector<ExpireTimer> expired_timers;
   EventPtr event;
-  ClockT::time_point now, next_req_timeout;
-  ExpireTimer timer;
+  ClockT::time_point now, next_req_timeout, next_timer;
 
   while(true) {
     {
@@ -197,23 +196,14 @@ void Reactor::handle_timeouts(PollTimeout &next_timeout) {
         m_next_wakeup = ClockT::time_point();
       }
 
-      if (!m_timer_heap.empty()) {
-        ExpireTimer timer;
-
-        while (!m_timer_heap.empty()) {
-          timer = m_timer_heap.top();
-          if (timer.expire_time > now) {
-            if (next_req_timeout == ClockT::time_point() ||
-                timer.expire_time < next_req_timeout) {
-              next_timeout.set(now, timer.expire_time);
-              m_next_wakeup = timer.expire_time;
-            }
-            break;
-          }
-          expired_timers.push_back(timer);
-          m_timer_heap.pop();
-        }
+      m_timer_wheel.expire(now, expired_timers);
 
+      if (m_timer_wheel.next_expiration(next_timer)) {
+        if (next_req_timeout == ClockT::time_point() ||
+            next_timer < next_req_timeout) {
+          next_timeout.set(now, next_timer);
+          m_next_wakeup = next_timer;
+        }
       }
     }
 
@@ -229,16 +219,18 @@ void Reactor::handle_timeouts(PollTimeout &next_timeout) {
     {
       lock_guard<mutex> lock(m_mutex);
 
-      if (!m_timer_heap.empty()) {
-        timer = m_timer_heap.top();
+      if (m_timer_wheel.next_expiration(next_timer)) {
 
-        if (now > timer.expire_time)
+        // Timers armed during delivery may have already expired
+        if (now > next_timer) {
+          expired_timers.clear();
           continue;
+        }
 
         if (next_req_timeout == ClockT::time_point()
-            || timer.expire_time < next_req_timeout) {
-          next_timeout.set(now, timer.expire_time);
-          m_next_wakeup = timer.expire_time;
+            || next_timer < next_req_timeout) {
+          next_timeout.set(now, next_timer);
+          m_next_wakeup = next_timer;
         }
       }
 
@@ -32,12 +32,12 @@
 #include "PollTimeout.h"
 #include "RequestCache.h"
 #include "ExpireTimer.h"
+#include "TimerWheel.h"
 
 #include <boost/thread/thread.hpp>
 
 #include <memory>
 #include <mutex>
-#include <queue>
 #include <set>
 #include <vector>
 
@@ -128,13 +128,13 @@ namespace Hypertable {
     }
 
     /** Adds a timer.
-     * Pushes timer onto #m_timer_heap and interrupts the polling loop so that
-     * the poll timeout can be adjusted if necessary.
+     * Inserts timer into #m_timer_wheel and interrupts the polling loop so
+     * that the poll timeout can be adjusted if necessary.
      * @param timer Reference to ExpireTimer object
      */
     void add_timer(ExpireTimer &timer) {
       std::lock_guard<std::mutex> lock(m_mutex);
-      m_timer_heap.push(timer);
+      m_timer_wheel.insert(timer);
       poll_loop_interrupt();
     }
 
@@ -144,18 +144,7 @@ namespace Hypertable {
      */
     void cancel_timer(const DispatchHandlerPtr &handler) {
       std::lock_guard<std::mutex> lock(m_mutex);
-      typedef TimerHeap::container_type container_t;
-      container_t container;
-      container.reserve(m_timer_heap.size());
-      ExpireTimer timer;
-      while (!m_timer_heap.empty()) {
-        timer = m_timer_heap.top();
-        if (timer.handler.get() != handler.get())
-          container.push_back(timer);
-        m_timer_heap.pop();
-      }
-      for (const auto &t : container)
-        m_timer_heap.push(t);
+      m_timer_wheel.cancel(handler);
     }
 
     /** Schedules <code>handler</code> for removal.
@@ -174,7 +163,7 @@ namespace Hypertable {
       ExpireTimer timer;
       timer.expire_time = ClockT::now() + std::chrono::milliseconds(200);
       timer.handler = 0;
-      m_timer_heap.push(timer);
+      m_timer_wheel.insert(timer);
       poll_loop_interrupt();
     }
 
@@ -193,7 +182,7 @@ namespace Hypertable {
      * This method removes timed out requests from the request cache, delivering
      * ERROR events (with error == Error::REQUEST_TIMEOUT) via each request's
      * dispatch handler.  It also processes expired timers by removing them from
-     * #m_timer_heap and delivering a TIMEOUT event via the timer handler if
+     * #m_timer_wheel and delivering a TIMEOUT event via the timer handler if
      * it exsists.
      * @param next_timeout Set to next earliest timeout of active requests and
      * timers
@@ -266,15 +255,10 @@ namespace Hypertable {
 
   protected:
 
-    /** Priority queue for timers.
-     */
-    typedef std::priority_queue<ExpireTimer,
-      std::vector<ExpireTimer>, LtTimerHeap> TimerHeap;
-
     std::mutex m_mutex;           //!< Mutex to protect members
     std::mutex m_polldata_mutex;  //!< Mutex to protect #m_polldata member
     RequestCache m_request_cache; //!< Request cache
-    TimerHeap m_timer_heap;       //!< ExpireTimer heap
+    TimerWheel m_timer_wheel;     //!< Timing wheel holding armed timers
     int m_interrupt_sd;           //!< Interrupt socket
 
     /// Set to <i>true</i> if poll loop interrupt in progress
@@ -24,6 +24,7 @@
 #include "HandlerMap.h"
 #include "ReactorFactory.h"
 #include "ReactorRunner.h"
+#include "TlsContext.h"
 
 #include <Common/Config.h>
 #include <Common/SystemInfo.h>
@@ -44,6 +45,9 @@ mutex ReactorFactory::ms_mutex;
 atomic<int> ReactorFactory::ms_next_reactor(0);
 bool ReactorFactory::ms_epollet = true;
 bool ReactorFactory::use_poll = false;
+uint32_t ReactorFactory::ms_coalesce_limit = 0;
+uint32_t ReactorFactory::ms_coalesce_delay = 1;
+std::shared_ptr<TlsContext> ReactorFactory::ms_tls_ctx;
 bool ReactorFactory::proxy_master = false;
 bool ReactorFactory::verbose {};
 
@@ -58,14 +62,19 @@ void ReactorFactory::initialize(uint16_t reactor_count) {
   assert(reactor_count > 0);
 
 #if defined(__linux__)
+  // Compare the kernel version as a (major, minor, micro) tuple; comparing
+  // the components independently misclassifies 3.x and later kernels
+  // (e.g. 5.4 would disable edge-triggered epoll and 3.2 would fall all
+  // the way back to poll())
   if (System::os_info().version_major < 2 ||
-      System::os_info().version_minor < 6 ||
       (System::os_info().version_major == 2 &&
-       System::os_info().version_minor == 6 &&
-       System::os_info().version_micro < 17))
+       (System::os_info().version_minor < 6 ||
+        (System::os_info().version_minor == 6 &&
+         System::os_info().version_micro < 17))))
     ms_epollet = false;
   if (System::os_info().version_major < 2 ||
-      System::os_info().version_minor < 5)
+      (System::os_info().version_major == 2 &&
+       System::os_info().version_minor < 5))
     use_poll = true;
 #endif
 
@@ -73,6 +82,15 @@ void ReactorFactory::initialize(uint16_t reactor_count) {
       Config::properties->get_bool("Comm.UsePoll"))
     use_poll = true;
 
+  if (Config::properties->has("Comm.Coalesce.Limit"))
+    ms_coalesce_limit = Config::properties->get_i32("Comm.Coalesce.Limit");
+  if (Config::properties->has("Comm.Coalesce.Delay"))
+    ms_coalesce_delay = Config::properties->get_i32("Comm.Coalesce.Delay");
+
+  if (Config::properties->has("Comm.Tls.Enabled") &&
+      Config::properties->get_bool("Comm.Tls.Enabled"))
+    ms_tls_ctx = make_shared<TlsContext>(Config::properties);
+
   ms_reactors.reserve(reactor_count+2);
   for (uint16_t i=0; i<reactor_count+2; i++) {
     reactor = make_shared<Reactor>();
@@ -89,6 +107,7 @@ void ReactorFactory::destroy() {
   ms_threads.join_all();
   ms_reactors.clear();
   ReactorRunner::handler_map = 0;
+  ms_tls_ctx.reset();
 }
 
 void ReactorFactory::join() {
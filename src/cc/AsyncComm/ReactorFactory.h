@@ -35,6 +35,7 @@
 
 #include <atomic>
 #include <cassert>
+#include <memory>
 #include <mutex>
 #include <random>
 #include <set>
@@ -46,6 +47,8 @@ namespace Hypertable {
    *  @{
    */
 
+  class TlsContext;
+
   /** Static class used to setup and manage I/O reactors.  Since the I/O reactor
    * threads are a process-wide resource, the methods of this class are static.
    */
@@ -110,6 +113,17 @@ namespace Hypertable {
     // Use POSIX poll() as polling mechanism
     static bool use_poll;
 
+    /** Size limit (bytes) for messages eligible for send coalescing,
+     * 0 disables coalescing (see IOHandlerData#send_message) */
+    static uint32_t ms_coalesce_limit;
+
+    /// Milliseconds to hold small messages for send coalescing
+    static uint32_t ms_coalesce_delay;
+
+    /** Shared TLS state, non-null when <code>Comm.Tls.Enabled</code> is set,
+     * in which case all TCP connections are encrypted */
+    static std::shared_ptr<TlsContext> ms_tls_ctx;
+
     /// Set to <i>true</i> if this process is acting as "Proxy Master"
     static bool proxy_master;
 
@@ -39,6 +39,8 @@
 #include <Common/Config.h>
 #include <Common/FileUtils.h>
 #include <Common/Logger.h>
+#include <Common/ThreadActivity.h>
+#include <Common/ThreadAffinity.h>
 #include <Common/Time.h>
 
 #include <chrono>
@@ -75,6 +77,9 @@ void ReactorRunner::operator()() {
   std::vector<struct pollfd> pollfds;
   std::vector<IOHandler *> handlers;
 
+  ThreadActivity::register_self("comm-reactor");
+  ThreadAffinity::bind_self("comm-reactor");
+
   HT_EXPECT(Config::properties, Error::FAILED_EXPECTATION);
 
   uint32_t dispatch_delay {};
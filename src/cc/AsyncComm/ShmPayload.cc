@@ -0,0 +1,153 @@
+/*
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 3 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/** @file
+ * Definitions for shared memory payload transfer.
+ * This file contains definitions for helper functions that move large
+ * response payloads between colocated processes through POSIX shared
+ * memory instead of the kernel network stack.
+ */
+
+#include <Common/Compat.h>
+
+#include "ShmPayload.h"
+#include "CommHeader.h"
+
+#include <Common/Error.h>
+#include <Common/Logger.h>
+#include <Common/Serialization.h>
+#include <Common/String.h>
+
+#include <atomic>
+#include <cstring>
+
+extern "C" {
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+}
+
+using namespace Hypertable;
+
+namespace {
+  std::atomic<uint32_t> ms_next_segment {};
+}
+
+bool Hypertable::shm_payload_write(const uint8_t *data, size_t len,
+                                   uint8_t *ref) {
+  String name = format("/ht_payload_%d_%u", (int)getpid(),
+                       (unsigned)ms_next_segment++);
+  int fd;
+  void *base;
+
+  HT_ASSERT(name.length() < SHM_PAYLOAD_NAME_LENGTH);
+
+  if ((fd = shm_open(name.c_str(), O_CREAT|O_EXCL|O_RDWR, 0600)) < 0) {
+    HT_WARNF("shm_open(\"%s\") failure - %s", name.c_str(), strerror(errno));
+    return false;
+  }
+
+  if (ftruncate(fd, (off_t)len) < 0) {
+    HT_WARNF("ftruncate(\"%s\", %u) failure - %s", name.c_str(),
+             (unsigned)len, strerror(errno));
+    ::close(fd);
+    shm_unlink(name.c_str());
+    return false;
+  }
+
+  if ((base = mmap(0, len, PROT_WRITE, MAP_SHARED, fd, 0)) == MAP_FAILED) {
+    HT_WARNF("mmap(\"%s\", %u) failure - %s", name.c_str(), (unsigned)len,
+             strerror(errno));
+    ::close(fd);
+    shm_unlink(name.c_str());
+    return false;
+  }
+
+  memcpy(base, data, len);
+  munmap(base, len);
+  ::close(fd);
+
+  memset(ref, 0, SHM_PAYLOAD_NAME_LENGTH);
+  memcpy(ref, name.c_str(), name.length());
+  uint8_t *ptr = ref + SHM_PAYLOAD_NAME_LENGTH;
+  Serialization::encode_i64(&ptr, (uint64_t)len);
+
+  return true;
+}
+
+int Hypertable::shm_payload_translate(EventPtr &event) {
+
+  if ((event->header.flags & CommHeader::FLAGS_BIT_SHM_PAYLOAD) == 0)
+    return Error::OK;
+
+  if (event->payload_len < SHM_PAYLOAD_REF_LENGTH) {
+    HT_ERRORF("Truncated shared memory payload reference (payload_len=%u)",
+              (unsigned)event->payload_len);
+    return Error::BAD_FORMAT;
+  }
+
+  const uint8_t *ref = event->payload
+    + (event->payload_len - SHM_PAYLOAD_REF_LENGTH);
+  char name[SHM_PAYLOAD_NAME_LENGTH+1];
+  memcpy(name, ref, SHM_PAYLOAD_NAME_LENGTH);
+  name[SHM_PAYLOAD_NAME_LENGTH] = '\0';
+
+  const uint8_t *ptr = ref + SHM_PAYLOAD_NAME_LENGTH;
+  size_t remain = 8;
+  size_t ext_len = (size_t)Serialization::decode_i64(&ptr, &remain);
+
+  int fd;
+  void *base;
+
+  if ((fd = shm_open(name, O_RDONLY, 0)) < 0) {
+    HT_ERRORF("shm_open(\"%s\") failure - %s", name, strerror(errno));
+    return Error::BAD_FORMAT;
+  }
+
+  if ((base = mmap(0, ext_len, PROT_READ, MAP_SHARED, fd, 0)) == MAP_FAILED) {
+    HT_ERRORF("mmap(\"%s\", %u) failure - %s", name, (unsigned)ext_len,
+              strerror(errno));
+    ::close(fd);
+    shm_unlink(name);
+    return Error::BAD_FORMAT;
+  }
+
+  size_t head_len = event->payload_len - SHM_PAYLOAD_REF_LENGTH;
+  uint8_t *new_payload = new uint8_t [head_len + ext_len];
+  memcpy(new_payload, event->payload, head_len);
+  memcpy(new_payload + head_len, base, ext_len);
+
+  munmap(base, ext_len);
+  ::close(fd);
+  shm_unlink(name);
+
+  if (event->payload_aligned)
+    free((void *)event->payload);
+  else
+    delete [] event->payload;
+  event->payload = new_payload;
+  event->payload_len = head_len + ext_len;
+  event->payload_aligned = false;
+  event->header.flags &= ~CommHeader::FLAGS_BIT_SHM_PAYLOAD;
+
+  return Error::OK;
+}
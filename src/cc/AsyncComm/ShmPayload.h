@@ -0,0 +1,88 @@
+/* -*- c++ -*-
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 3 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/** @file
+ * Declarations for shared memory payload transfer.
+ * This file contains declarations for helper functions that move large
+ * response payloads between colocated processes through POSIX shared
+ * memory instead of the kernel network stack.  A requester that is on
+ * the same host as the responder sets CommHeader::FLAGS_BIT_SHM_PAYLOAD_OK
+ * in the request header; the responder may then replace the bulk portion
+ * of the response payload with a fixed-size shared memory reference and
+ * set CommHeader::FLAGS_BIT_SHM_PAYLOAD in the response header.  The
+ * requester reconstitutes the payload with shm_payload_translate() and
+ * unlinks the segment.
+ */
+
+#ifndef AsyncComm_ShmPayload_h
+#define AsyncComm_ShmPayload_h
+
+#include "Event.h"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Hypertable {
+
+  /** @addtogroup AsyncComm
+   *  @{
+   */
+
+  /// Length of the NUL-padded segment name within a payload reference
+  const size_t SHM_PAYLOAD_NAME_LENGTH = 64;
+
+  /// Encoded length of a shared memory payload reference
+  const size_t SHM_PAYLOAD_REF_LENGTH = SHM_PAYLOAD_NAME_LENGTH + 8;
+
+  /** Writes a payload into a freshly created POSIX shared memory segment.
+   * The segment is given a process-unique name and is created with mode
+   * 0600.  On success a reference (NUL-padded segment name followed by the
+   * payload length) is encoded into <code>ref</code>, which must point to
+   * at least #SHM_PAYLOAD_REF_LENGTH bytes.  The segment is unlinked by
+   * the receiving end after translation.
+   *
+   * @param data pointer to payload data
+   * @param len length of payload data
+   * @param ref pointer to buffer to hold the encoded reference
+   * @return <i>true</i> on success, <i>false</i> if the segment could not
+   *         be created (caller should fall back to an inline payload)
+   */
+  bool shm_payload_write(const uint8_t *data, size_t len, uint8_t *ref);
+
+  /** Reconstitutes an event payload delivered via shared memory.
+   * If <code>event</code> does not carry
+   * CommHeader::FLAGS_BIT_SHM_PAYLOAD this method does nothing.
+   * Otherwise the trailing #SHM_PAYLOAD_REF_LENGTH bytes of the payload
+   * are decoded as a segment reference, the segment contents are spliced
+   * into a reallocated payload in place of the reference, and the segment
+   * is unlinked.
+   *
+   * @param event event to translate
+   * @return Error::OK on success, or error code if the reference is
+   *         malformed or the segment could not be mapped
+   */
+  int shm_payload_translate(EventPtr &event);
+
+  /** @}*/
+
+}
+
+#endif // AsyncComm_ShmPayload_h
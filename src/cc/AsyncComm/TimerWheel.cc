@@ -0,0 +1,174 @@
+/*
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/** @file
+ * Definitions for TimerWheel.
+ * This file contains method definitions for TimerWheel, a hierarchical timing
+ * wheel used by Reactor to hold armed timers.
+ */
+
+#include <Common/Compat.h>
+
+#include "TimerWheel.h"
+
+#include <Common/Logger.h>
+
+#include <chrono>
+#include <cstring>
+
+using namespace Hypertable;
+using namespace std;
+
+TimerWheel::TimerWheel() : m_epoch(ClockT::now()) {
+  memset(m_level_count, 0, sizeof(m_level_count));
+}
+
+int64_t TimerWheel::tick_of(ClockT::time_point when) const {
+  return chrono::duration_cast<chrono::milliseconds>(when - m_epoch).count();
+}
+
+void TimerWheel::place(const ExpireTimer &timer) {
+  int64_t delta = tick_of(timer.expire_time) - m_current_tick;
+
+  // Already-expired timers fire on the next advance
+  if (delta < 1)
+    delta = 1;
+
+  int level = 0;
+  while (level < LEVELS-1 && delta >= ((int64_t)1 << (SLOT_BITS*(level+1))))
+    level++;
+
+  // Clamp timers beyond the wheel's range into the top level; they will
+  // cascade and be re-placed as the wheel advances
+  int64_t max_delta = ((int64_t)1 << (SLOT_BITS*LEVELS)) - 1;
+  if (delta > max_delta)
+    delta = max_delta;
+
+  size_t slot = (size_t)(((m_current_tick + delta) >> (SLOT_BITS*level))
+                         & SLOT_MASK);
+  m_slots[level][slot].push_back(timer);
+  m_level_count[level]++;
+}
+
+void TimerWheel::insert(const ExpireTimer &timer) {
+  place(timer);
+  m_count++;
+}
+
+void TimerWheel::cancel(const DispatchHandlerPtr &handler) {
+  for (int level = 0; level < LEVELS; level++) {
+    for (int64_t slot = 0; slot < SLOTS_PER_LEVEL; slot++) {
+      vector<ExpireTimer> &timers = m_slots[level][slot];
+      for (size_t i = 0; i < timers.size(); ) {
+        if (timers[i].handler.get() == handler.get()) {
+          timers.erase(timers.begin() + i);
+          m_level_count[level]--;
+          m_count--;
+        }
+        else
+          i++;
+      }
+    }
+  }
+}
+
+void TimerWheel::cascade(int level, size_t slot) {
+  vector<ExpireTimer> timers;
+  timers.swap(m_slots[level][slot]);
+  m_level_count[level] -= timers.size();
+  for (const auto &timer : timers)
+    place(timer);
+}
+
+void TimerWheel::expire(ClockT::time_point now, vector<ExpireTimer> &expired) {
+  int64_t now_tick = tick_of(now);
+
+  if (m_count == 0) {
+    m_current_tick = now_tick;
+    return;
+  }
+
+  while (m_current_tick < now_tick) {
+    m_current_tick++;
+
+    size_t slot = (size_t)(m_current_tick & SLOT_MASK);
+
+    // Crossing a level boundary; cascade the corresponding slot of each
+    // higher level whose boundary was crossed
+    if (slot == 0) {
+      for (int level = 1; level < LEVELS; level++) {
+        size_t upper = (size_t)((m_current_tick >> (SLOT_BITS*level))
+                                & SLOT_MASK);
+        cascade(level, upper);
+        if (upper != 0)
+          break;
+      }
+    }
+
+    if (!m_slots[0][slot].empty()) {
+      for (const auto &timer : m_slots[0][slot]) {
+        expired.push_back(timer);
+        m_count--;
+      }
+      m_level_count[0] -= m_slots[0][slot].size();
+      m_slots[0][slot].clear();
+    }
+  }
+}
+
+bool TimerWheel::next_expiration(ClockT::time_point &expiration) {
+
+  if (m_count == 0)
+    return false;
+
+  // Timers in the lowest level expire at their exact slot time
+  if (m_level_count[0] > 0) {
+    for (int64_t tick = m_current_tick+1;
+         tick <= m_current_tick + SLOT_MASK; tick++) {
+      if (!m_slots[0][tick & SLOT_MASK].empty()) {
+        expiration = m_epoch + chrono::milliseconds(tick);
+        return true;
+      }
+    }
+  }
+
+  // Timers parked in higher levels need a wakeup at the cascade that will
+  // bring them down; find the nearest such boundary
+  int64_t best_tick = 0;
+  for (int level = 1; level < LEVELS; level++) {
+    if (m_level_count[level] == 0)
+      continue;
+    int64_t base = m_current_tick >> (SLOT_BITS*level);
+    for (int64_t i = 1; i <= SLOTS_PER_LEVEL; i++) {
+      size_t slot = (size_t)((base + i) & SLOT_MASK);
+      if (!m_slots[level][slot].empty()) {
+        int64_t tick = (base + i) << (SLOT_BITS*level);
+        if (best_tick == 0 || tick < best_tick)
+          best_tick = tick;
+        break;
+      }
+    }
+  }
+
+  HT_ASSERT(best_tick != 0);
+  expiration = m_epoch + chrono::milliseconds(best_tick);
+  return true;
+}
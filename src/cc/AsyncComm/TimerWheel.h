@@ -0,0 +1,156 @@
+/* -*- c++ -*-
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/** @file
+ * Declarations for TimerWheel.
+ * This file contains type declarations for TimerWheel, a hierarchical timing
+ * wheel used by Reactor to hold armed timers.
+ */
+
+#ifndef AsyncComm_TimerWheel_h
+#define AsyncComm_TimerWheel_h
+
+#include "Clock.h"
+#include "ExpireTimer.h"
+
+#include <vector>
+
+namespace Hypertable {
+
+  /** @addtogroup AsyncComm
+   *  @{
+   */
+
+  /** Hierarchical timing wheel holding armed timers.
+   * This class replaces the timer heap formerly embedded in Reactor.  Timers
+   * are hashed into tick-indexed slots (one tick is one millisecond) across
+   * #LEVELS levels of #SLOTS_PER_LEVEL slots each, so arming a timer is O(1)
+   * regardless of how many timers are outstanding.  As the wheel advances
+   * past the end of a level's range, the timers in the corresponding slot of
+   * the next level up are <i>cascaded</i> back down into the lower levels.
+   * Cancellation scans the wheel and is O(armed timers); it is only used on
+   * shutdown paths so this trade was made in favor of a cheap arm/expire
+   * path.  This class performs no locking; the caller (Reactor) serializes
+   * access with its own mutex.
+   */
+  class TimerWheel {
+  public:
+
+    /** Constructor.
+     * Records the current time as the wheel epoch; all slot indexes are
+     * computed from millisecond ticks elapsed since the epoch.
+     */
+    TimerWheel();
+
+    /** Inserts a timer into the wheel.
+     * The timer is placed in the slot corresponding to its expiration tick.
+     * Timers whose expiration time has already passed are placed one tick in
+     * the future so that they fire on the next call to #expire.
+     * @param timer Timer to insert
+     */
+    void insert(const ExpireTimer &timer);
+
+    /** Removes all timers registered with <code>handler</code>.
+     * Scans every slot of the wheel, so this is O(armed timers); it is
+     * intended for the infrequent shutdown-time cancellation performed by
+     * Comm::cancel_timer.
+     * @param handler Dispatch handler for which associated timers are to be
+     * removed
+     */
+    void cancel(const DispatchHandlerPtr &handler);
+
+    /** Advances the wheel to <code>now</code>, collecting expired timers.
+     * Each slot passed over is drained into <code>expired</code>; slots of
+     * higher levels are cascaded down as their boundaries are crossed.
+     * Expired timers are appended in approximate expiration order.
+     * @param now Current time
+     * @param expired Vector to which expired timers are appended
+     */
+    void expire(ClockT::time_point now, std::vector<ExpireTimer> &expired);
+
+    /** Computes the next time at which #expire needs to be called.
+     * For timers residing in the lowest level this is their exact expiration
+     * time; for timers still parked in higher levels it is the time of the
+     * cascade that will bring them down, which is always at or before their
+     * expiration.
+     * @param expiration Filled in with next required wakeup time
+     * @return <i>true</i> if a timer is armed and <code>expiration</code> was
+     * filled in, <i>false</i> if the wheel is empty
+     */
+    bool next_expiration(ClockT::time_point &expiration);
+
+    /** Returns <i>true</i> if no timers are armed.
+     * @return <i>true</i> if wheel is empty
+     */
+    bool empty() const { return m_count == 0; }
+
+  private:
+
+    /// Number of bits of the tick consumed by each level
+    static const int SLOT_BITS = 8;
+
+    /// Number of slots in each level
+    static const int64_t SLOTS_PER_LEVEL = 1 << SLOT_BITS;
+
+    /// Mask for extracting a level's slot index from a tick
+    static const int64_t SLOT_MASK = SLOTS_PER_LEVEL - 1;
+
+    /// Number of levels (four levels at 1ms tick spans ~50 days)
+    static const int LEVELS = 4;
+
+    /** Converts an absolute time to a tick count relative to #m_epoch.
+     * @param when Absolute time
+     * @return Milliseconds elapsed between #m_epoch and <code>when</code>
+     */
+    int64_t tick_of(ClockT::time_point when) const;
+
+    /** Places a timer into the slot appropriate for its expiration tick.
+     * Used both by #insert and when cascading timers down from higher
+     * levels.  Does not modify #m_count.
+     * @param timer Timer to place
+     */
+    void place(const ExpireTimer &timer);
+
+    /** Re-places the timers of a higher-level slot into lower levels.
+     * @param level Level being cascaded (1 .. #LEVELS-1)
+     * @param slot Slot index within <code>level</code>
+     */
+    void cascade(int level, size_t slot);
+
+    /// Wheel epoch; ticks are milliseconds elapsed since this time
+    ClockT::time_point m_epoch;
+
+    /// Tick up to which the wheel has been advanced
+    int64_t m_current_tick {};
+
+    /// Total number of armed timers
+    size_t m_count {};
+
+    /// Number of armed timers per level
+    size_t m_level_count[LEVELS];
+
+    /// Timer slots
+    std::vector<ExpireTimer> m_slots[LEVELS][SLOTS_PER_LEVEL];
+  };
+  /** @}*/
+}
+
+#endif // AsyncComm_TimerWheel_h
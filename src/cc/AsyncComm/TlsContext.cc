@@ -0,0 +1,124 @@
+/*
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/** @file
+ * Definitions for TlsContext.
+ * This file contains method definitions for TlsContext, a class
+ * encapsulating the shared TLS state used to encrypt AsyncComm TCP
+ * connections.
+ */
+
+#include <Common/Compat.h>
+
+#include "TlsContext.h"
+
+#include <Common/Logger.h>
+
+#include <openssl/err.h>
+
+using namespace Hypertable;
+using namespace std;
+
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wdeprecated-declarations"
+
+TlsContext::TlsContext(PropertiesPtr &props) {
+  SSL_library_init();
+  SSL_load_error_strings();
+
+  m_ctx = SSL_CTX_new(SSLv23_method());
+  HT_ASSERT(m_ctx);
+
+  SSL_CTX_set_options(m_ctx, SSL_OP_NO_SSLv2 | SSL_OP_NO_SSLv3);
+
+  // The send path writes whatever prefix of a message the socket will
+  // accept, so partial writes and a moving write buffer must be allowed
+  SSL_CTX_set_mode(m_ctx, SSL_MODE_ENABLE_PARTIAL_WRITE |
+                   SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER);
+
+  String certificate = props->get_str("Comm.Tls.Certificate");
+  String private_key = props->get_str("Comm.Tls.PrivateKey");
+  String ca_certificate = props->get_str("Comm.Tls.CaCertificate");
+
+  if (!certificate.empty() &&
+      SSL_CTX_use_certificate_chain_file(m_ctx, certificate.c_str()) != 1)
+    HT_FATALF("Problem loading TLS certificate file '%s' - %s",
+              certificate.c_str(), ERR_error_string(ERR_get_error(), 0));
+
+  if (!private_key.empty() &&
+      (SSL_CTX_use_PrivateKey_file(m_ctx, private_key.c_str(),
+                                   SSL_FILETYPE_PEM) != 1 ||
+       SSL_CTX_check_private_key(m_ctx) != 1))
+    HT_FATALF("Problem loading TLS private key file '%s' - %s",
+              private_key.c_str(), ERR_error_string(ERR_get_error(), 0));
+
+  if (!ca_certificate.empty()) {
+    if (SSL_CTX_load_verify_locations(m_ctx, ca_certificate.c_str(), 0) != 1)
+      HT_FATALF("Problem loading TLS CA certificate file '%s' - %s",
+                ca_certificate.c_str(), ERR_error_string(ERR_get_error(), 0));
+    SSL_CTX_set_verify(m_ctx, SSL_VERIFY_PEER | SSL_VERIFY_FAIL_IF_NO_PEER_CERT,
+                       0);
+  }
+
+  // Cache sessions on both sides; the client-side cache feeds session
+  // resumption on reconnect (see cache_session)
+  SSL_CTX_set_session_cache_mode(m_ctx, SSL_SESS_CACHE_BOTH);
+}
+
+TlsContext::~TlsContext() {
+  for (auto &entry : m_session_map)
+    SSL_SESSION_free(entry.second);
+  SSL_CTX_free(m_ctx);
+}
+
+SSL *TlsContext::create_session(int sd, bool client, const InetAddr &addr) {
+  SSL *ssl = SSL_new(m_ctx);
+  HT_ASSERT(ssl);
+  SSL_set_fd(ssl, sd);
+  if (client) {
+    {
+      lock_guard<mutex> lock(m_mutex);
+      auto iter = m_session_map.find(addr);
+      if (iter != m_session_map.end())
+        SSL_set_session(ssl, iter->second);
+    }
+    SSL_set_connect_state(ssl);
+  }
+  else
+    SSL_set_accept_state(ssl);
+  return ssl;
+}
+
+void TlsContext::cache_session(const InetAddr &addr, SSL *ssl) {
+  SSL_SESSION *session = SSL_get1_session(ssl);
+  if (session == 0)
+    return;
+  lock_guard<mutex> lock(m_mutex);
+  auto iter = m_session_map.find(addr);
+  if (iter != m_session_map.end()) {
+    SSL_SESSION_free(iter->second);
+    iter->second = session;
+  }
+  else
+    m_session_map[addr] = session;
+}
+
+#pragma clang diagnostic pop
@@ -0,0 +1,114 @@
+/* -*- c++ -*-
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/** @file
+ * Declarations for TlsContext.
+ * This file contains type declarations for TlsContext, a class encapsulating
+ * the shared TLS state (certificates, keys, and cached sessions) used to
+ * encrypt AsyncComm TCP connections.
+ */
+
+#ifndef AsyncComm_TlsContext_h
+#define AsyncComm_TlsContext_h
+
+#include <Common/InetAddr.h>
+#include <Common/Properties.h>
+#include <Common/SockAddrMap.h>
+
+#include <memory>
+#include <mutex>
+
+#include <openssl/ssl.h>
+
+namespace Hypertable {
+
+  /** @addtogroup AsyncComm
+   *  @{
+   */
+
+  /** Shared TLS state for AsyncComm connections.
+   * Wraps a single <code>SSL_CTX</code> holding the certificate, private
+   * key, and peer verification configuration loaded from the
+   * <code>Comm.Tls</code> properties, and a cache of the most recent
+   * session negotiated with each peer address.  Connection handlers obtain
+   * a per-connection <code>SSL</code> object with #create_session;
+   * connecting handlers contribute established sessions back with
+   * #cache_session so that reconnects can use the abbreviated resumption
+   * handshake instead of a full key exchange.
+   */
+  class TlsContext {
+  public:
+
+    /** Constructor.
+     * Creates the <code>SSL_CTX</code>, disables SSLv2/SSLv3, loads the
+     * certificate chain, private key, and CA certificate named by the
+     * <code>Comm.Tls.Certificate</code>, <code>Comm.Tls.PrivateKey</code>,
+     * and <code>Comm.Tls.CaCertificate</code> properties (peer
+     * verification is required when a CA certificate is configured), and
+     * enables the client- and server-side session caches.  A failure to
+     * load any configured file is fatal.
+     * @param props Configuration properties
+     */
+    TlsContext(PropertiesPtr &props);
+
+    /** Destructor.  Frees cached sessions and the <code>SSL_CTX</code>. */
+    ~TlsContext();
+
+    /** Creates a per-connection <code>SSL</code> object.
+     * The object is bound to <code>sd</code> and placed in connect or
+     * accept state; no handshake I/O is performed here, it happens
+     * incrementally as the connection handler reads and writes.  For
+     * connecting handlers, a previously cached session for
+     * <code>addr</code> is applied so the handshake can be resumed.
+     * @param sd Socket descriptor
+     * @param client <i>true</i> for the connecting side, <i>false</i> for
+     * the accepting side
+     * @param addr Address of remote end of connection
+     * @return Newly allocated <code>SSL</code> object (owned by caller)
+     */
+    SSL *create_session(int sd, bool client, const InetAddr &addr);
+
+    /** Caches the session established on <code>ssl</code> for
+     * <code>addr</code>, replacing any previously cached session.
+     * @param addr Address of remote end of connection
+     * @param ssl Connection with completed handshake
+     */
+    void cache_session(const InetAddr &addr, SSL *ssl);
+
+  private:
+
+    /// OpenSSL context
+    SSL_CTX *m_ctx {};
+
+    /// %Mutex for serializing access to #m_session_map
+    std::mutex m_mutex;
+
+    /// Most recently established session per peer address
+    SockAddrMap<SSL_SESSION *> m_session_map;
+  };
+
+  /// Shared smart pointer to TlsContext
+  typedef std::shared_ptr<TlsContext> TlsContextPtr;
+
+  /** @}*/
+}
+
+#endif // AsyncComm_TlsContext_h
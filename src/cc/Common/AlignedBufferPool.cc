@@ -0,0 +1,89 @@
+/*
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/** @file
+ * Pool of aligned memory buffers.
+ * This file contains the definition of AlignedBufferPool, a pool that
+ * recycles buffers allocated with posix_memalign() for direct I/O.
+ */
+
+#include <Common/Compat.h>
+
+#include "AlignedBufferPool.h"
+
+#include <Common/Logger.h>
+
+#include <cstdlib>
+
+using namespace Hypertable;
+using namespace std;
+
+namespace {
+  /// Maximum bytes held on the free lists
+  const size_t MAX_CACHED_BYTES = 64 * 1024 * 1024;
+  /// Buffers larger than this are never cached
+  const size_t MAX_CACHEABLE_BUFFER = 8 * 1024 * 1024;
+}
+
+AlignedBufferPool &AlignedBufferPool::instance() {
+  static AlignedBufferPool *pool = new AlignedBufferPool();
+  return *pool;
+}
+
+void *AlignedBufferPool::allocate(size_t alignment, size_t len) {
+  size_t capacity = (len % alignment) == 0 ? len :
+    ((len / alignment) + 1) * alignment;
+  void *ptr = 0;
+
+  lock_guard<mutex> lock(m_mutex);
+
+  auto iter = m_free_buffers.find(make_pair(alignment, capacity));
+  if (iter != m_free_buffers.end() && !iter->second.empty()) {
+    ptr = iter->second.back();
+    iter->second.pop_back();
+    m_cached_bytes -= capacity;
+  }
+  else
+    HT_ASSERT(posix_memalign(&ptr, alignment, capacity) == 0);
+
+  m_outstanding[ptr] = { alignment, capacity };
+  return ptr;
+}
+
+void AlignedBufferPool::release(void *ptr) {
+  if (ptr == 0)
+    return;
+
+  lock_guard<mutex> lock(m_mutex);
+
+  auto iter = m_outstanding.find(ptr);
+  HT_ASSERT(iter != m_outstanding.end());
+  BufferInfo info = iter->second;
+  m_outstanding.erase(iter);
+
+  if (info.capacity <= MAX_CACHEABLE_BUFFER &&
+      m_cached_bytes + info.capacity <= MAX_CACHED_BYTES) {
+    m_free_buffers[make_pair(info.alignment, info.capacity)].push_back(ptr);
+    m_cached_bytes += info.capacity;
+  }
+  else
+    free(ptr);
+}
@@ -0,0 +1,103 @@
+/* -*- c++ -*-
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/** @file
+ * Pool of aligned memory buffers.
+ * This file contains the declaration of AlignedBufferPool, a pool that
+ * recycles buffers allocated with posix_memalign() for direct I/O.
+ */
+
+#ifndef Common_AlignedBufferPool_h
+#define Common_AlignedBufferPool_h
+
+#include <map>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace Hypertable {
+
+  /// @addtogroup Common
+  /// @{
+
+  /** Pool of aligned memory buffers.  Direct I/O requires buffers obtained
+   * with posix_memalign(), and the read and write paths that use direct I/O
+   * (FsBroker reads, CellStore block writes) allocate and release one such
+   * buffer per operation, mostly of a small number of distinct sizes.  This
+   * pool keeps a bounded free list per (alignment, capacity) pair so that
+   * steady-state direct I/O recycles buffers instead of hitting the
+   * allocator on every operation.
+   */
+  class AlignedBufferPool {
+  public:
+
+    /** Returns the process-wide pool instance.  The instance is
+     * intentionally never destroyed since buffers may be released during
+     * static destruction.
+     * @return Reference to pool instance
+     */
+    static AlignedBufferPool &instance();
+
+    /** Allocates a buffer aligned to <code>alignment</code> with capacity of
+     * at least <code>len</code> bytes, preferring a recycled buffer of
+     * matching alignment and capacity.  The buffer must be returned with
+     * release().
+     * @param alignment Buffer alignment in bytes
+     * @param len Minimum buffer capacity in bytes (rounded up to a multiple
+     * of <code>alignment</code>)
+     * @return Pointer to aligned buffer
+     */
+    void *allocate(size_t alignment, size_t len);
+
+    /** Returns a buffer obtained from allocate() to the pool.  The buffer is
+     * cached for reuse if the pool is below its cache limit, otherwise it is
+     * freed.
+     * @param ptr Pointer to buffer (may be nullptr)
+     */
+    void release(void *ptr);
+
+  private:
+
+    /// Alignment and capacity of an outstanding buffer
+    struct BufferInfo {
+      size_t alignment;
+      size_t capacity;
+    };
+
+    /// %Mutex for serializing access to pool state
+    std::mutex m_mutex;
+
+    /// Alignment and capacity of each outstanding buffer
+    std::unordered_map<void *, BufferInfo> m_outstanding;
+
+    /// Free lists keyed by (alignment, capacity)
+    std::map<std::pair<size_t, size_t>, std::vector<void *>> m_free_buffers;
+
+    /// Total bytes held on the free lists
+    size_t m_cached_bytes {};
+  };
+
+  /// @}
+
+}
+
+#endif // Common_AlignedBufferPool_h
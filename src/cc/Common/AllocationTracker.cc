@@ -0,0 +1,77 @@
+/*
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 3 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/** @file
+ * Definitions for AllocationTracker.
+ * This file contains definitions for AllocationTracker, a facility for
+ * per-subsystem allocation accounting.
+ */
+
+#include "Compat.h"
+
+#include "AllocationTracker.h"
+#include "Logger.h"
+
+#include <ostream>
+
+using namespace Hypertable;
+
+std::atomic<int64_t>
+AllocationTracker::ms_usage[AllocationTracker::SUBSYSTEM_COUNT];
+
+int64_t AllocationTracker::ms_last_usage[AllocationTracker::SUBSYSTEM_COUNT];
+
+int32_t AllocationTracker::ms_growth_streak[AllocationTracker::SUBSYSTEM_COUNT];
+
+namespace {
+  const char *subsystem_names[AllocationTracker::SUBSYSTEM_COUNT] = {
+    "CellCache",
+    "Scanner",
+    "CommBuf",
+    "MetaLog"
+  };
+}
+
+const char *AllocationTracker::subsystem_name(Subsystem subsystem) {
+  return subsystem_names[subsystem];
+}
+
+void AllocationTracker::dump(std::ostream &out) {
+  for (int i=0; i<SUBSYSTEM_COUNT; i++)
+    out << subsystem_names[i] << "\t" << usage((Subsystem)i) << "\n";
+}
+
+void AllocationTracker::leak_check() {
+  for (int i=0; i<SUBSYSTEM_COUNT; i++) {
+    int64_t current = usage((Subsystem)i);
+    if (current > ms_last_usage[i]) {
+      ms_growth_streak[i]++;
+      if (ms_growth_streak[i] >= GROWTH_STREAK_THRESHOLD &&
+          (ms_growth_streak[i] % GROWTH_STREAK_THRESHOLD) == 0)
+        HT_WARNF("Allocation leak watch: %s memory has grown for %d "
+                 "consecutive samples (now %lld bytes)", subsystem_names[i],
+                 (int)ms_growth_streak[i], (Lld)current);
+    }
+    else if (current < ms_last_usage[i])
+      ms_growth_streak[i] = 0;
+    ms_last_usage[i] = current;
+  }
+}
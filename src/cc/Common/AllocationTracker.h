@@ -0,0 +1,164 @@
+/* -*- c++ -*-
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 3 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/** @file
+ * Declarations for AllocationTracker.
+ * This file contains declarations for AllocationTracker, a facility for
+ * per-subsystem allocation accounting.
+ */
+
+#ifndef Common_AllocationTracker_h
+#define Common_AllocationTracker_h
+
+#include <atomic>
+#include <cstdint>
+#include <iosfwd>
+
+namespace Hypertable {
+
+  /** @addtogroup Common
+   *  @{
+   */
+
+  /** Per-subsystem allocation accounting.
+   * The process-wide MemoryTracker reports coarse totals, which is not
+   * enough to attribute RSS creep to a subsystem.  AllocationTracker
+   * maintains a small set of byte counters tagged by allocation origin.
+   * Subsystems report their allocations at the points where memory is
+   * acquired and released (typically via TrackedArenaUsage for
+   * arena-backed containers, or explicit add() calls in constructors
+   * and destructors), and the breakdown is included in the statistics
+   * and state reports.  A leak-watch pass (leak_check()) logs a warning
+   * for any subsystem whose usage has grown across many consecutive
+   * samples.
+   */
+  class AllocationTracker {
+  public:
+
+    /// Allocation origins tracked.
+    enum Subsystem {
+      /// CellCache arenas
+      CELL_CACHE = 0,
+      /// Scanner temporary buffers
+      SCANNER,
+      /// Comm layer message buffers
+      COMM_BUF,
+      /// MetaLog records queued for write
+      METALOG,
+      /// Number of subsystems
+      SUBSYSTEM_COUNT
+    };
+
+    /** Adjusts a subsystem's usage counter.
+     * @param subsystem Allocation origin
+     * @param amount Bytes to add (negative to subtract)
+     */
+    static void add(Subsystem subsystem, int64_t amount) {
+      ms_usage[subsystem].fetch_add(amount, std::memory_order_relaxed);
+    }
+
+    /** Returns a subsystem's current usage.
+     * @param subsystem Allocation origin
+     * @return Current usage in bytes
+     */
+    static int64_t usage(Subsystem subsystem) {
+      return ms_usage[subsystem].load(std::memory_order_relaxed);
+    }
+
+    /** Returns a subsystem's display name.
+     * @param subsystem Allocation origin
+     * @return Display name (e.g. "CellCache")
+     */
+    static const char *subsystem_name(Subsystem subsystem);
+
+    /** Writes the per-subsystem usage breakdown to <code>out</code>.
+     * @param out Output stream
+     */
+    static void dump(std::ostream &out);
+
+    /** Samples usage and logs subsystems that grow monotonically.
+     * Each call compares the current usage of every subsystem against
+     * the previous sample; a subsystem whose usage has grown for
+     * GROWTH_STREAK_THRESHOLD consecutive samples is logged as a leak
+     * suspect (and again on each further threshold multiple).  Must be
+     * called from a single thread (the statistics gathering thread).
+     */
+    static void leak_check();
+
+    /// Consecutive growing samples before a subsystem is reported
+    static const int32_t GROWTH_STREAK_THRESHOLD = 10;
+
+  private:
+
+    /// Current usage (bytes) per subsystem
+    static std::atomic<int64_t> ms_usage[SUBSYSTEM_COUNT];
+
+    /// Usage observed by the previous leak_check() call
+    static int64_t ms_last_usage[SUBSYSTEM_COUNT];
+
+    /// Count of consecutive leak_check() samples showing growth
+    static int32_t ms_growth_streak[SUBSYSTEM_COUNT];
+  };
+
+  /** Keeps a subsystem usage counter in sync with an arena.
+   * Arena-backed containers (CellCache, scanner buffers) grow their
+   * arenas incrementally; a TrackedArenaUsage member follows the arena's
+   * page total and forwards the deltas to AllocationTracker.  Call
+   * update() with the arena's total after operations that may grow it;
+   * the destructor retires whatever is still accounted.
+   */
+  class TrackedArenaUsage {
+  public:
+
+    /** Constructor.
+     * @param subsystem Allocation origin charged for the arena
+     */
+    TrackedArenaUsage(AllocationTracker::Subsystem subsystem)
+      : m_subsystem(subsystem) { }
+
+    ~TrackedArenaUsage() {
+      AllocationTracker::add(m_subsystem, -m_tracked);
+    }
+
+    /** Forwards arena growth (or shrinkage) since the last call.
+     * @param arena_total Arena page total in bytes
+     */
+    void update(int64_t arena_total) {
+      if (arena_total != m_tracked) {
+        AllocationTracker::add(m_subsystem, arena_total - m_tracked);
+        m_tracked = arena_total;
+      }
+    }
+
+  private:
+
+    /// Allocation origin charged for the arena
+    AllocationTracker::Subsystem m_subsystem;
+
+    /// Arena bytes currently accounted
+    int64_t m_tracked {};
+  };
+
+  /** @} */
+
+}
+
+#endif // Common_AllocationTracker_h
@@ -174,10 +174,67 @@ public:
     insert(key.c_str(), key.length());
   }
 
+  /** Maximum number of hash functions supported by the batched probe path */
+  static const size_t MAX_BATCHED_HASHES = 16;
+
+  /** Computes the bit positions for a key without touching the filter.
+   *
+   * The hash chain is computed up front so the subsequent bit tests are
+   * independent loads instead of each load waiting on the next hash.
+   *
+   * @param key Pointer to the key's data
+   * @param len Size of the data (in bytes)
+   * @param positions Array to receive the bit positions
+   * @return Number of positions written, or 0 if the filter uses more hash
+   * functions than the batched path supports
+   */
+  size_t hash_positions(const void *key, size_t len,
+                        size_t positions[MAX_BATCHED_HASHES]) const {
+    if (m_num_hash_functions > MAX_BATCHED_HASHES)
+      return 0;
+    uint32_t hash = len;
+    for (size_t i = 0; i < m_num_hash_functions; ++i) {
+      hash = m_hasher(key, len, hash) % m_num_bits;
+      positions[i] = hash;
+    }
+    return m_num_hash_functions;
+  }
+
+  /** Issues prefetches for the filter bytes covering the given positions.
+   *
+   * Can be called for several filters before testing any of them, so the
+   * cache misses of a multi-filter probe overlap instead of being taken
+   * one filter at a time.
+   *
+   * @param positions Bit positions computed by hash_positions()
+   * @param count Number of positions
+   */
+  void prefetch(const size_t *positions, size_t count) const {
+#ifdef __GNUC__
+    for (size_t i = 0; i < count; ++i)
+      __builtin_prefetch(&m_bloom_bits[positions[i] / CHAR_BIT], 0, 1);
+#endif
+  }
+
+  /** Tests previously computed bit positions.
+   *
+   * @param positions Bit positions computed by hash_positions()
+   * @param count Number of positions
+   * @return true if the key "may" be contained, otherwise false
+   */
+  bool may_contain(const size_t *positions, size_t count) const {
+    for (size_t i = 0; i < count; ++i) {
+      if ((m_bloom_bits[positions[i] / CHAR_BIT]
+           & (1 << (positions[i] % CHAR_BIT))) == 0)
+        return false;
+    }
+    return true;
+  }
+
   /** Checks if the data set "may" contain the key. This can return false
    * positives.
    *
-   * This function runs through all hash tables and checks if the hashed bit 
+   * This function runs through all hash tables and checks if the hashed bit
    * is set. If any of them is not set then the key is definitely not part of
    * the data set. If all bits are set then the key "may" be in the data set.
    *
@@ -186,6 +243,14 @@ public:
    * @return true if the key "may" be contained, otherwise false
    */
   bool may_contain(const void *key, size_t len) const {
+    size_t positions[MAX_BATCHED_HASHES];
+    size_t count = hash_positions(key, len, positions);
+
+    if (count) {
+      prefetch(positions, count);
+      return may_contain(positions, count);
+    }
+
     uint32_t hash = len;
     uint8_t byte_mask;
     uint8_t byte;
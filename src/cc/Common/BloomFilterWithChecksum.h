@@ -31,6 +31,7 @@
 
 #include <cmath>
 #include <limits.h>
+#include <sys/mman.h>
 #include "Common/Checksum.h"
 #include "Common/Filesystem.h"
 #include "Common/Logger.h"
@@ -73,9 +74,7 @@ public:
               (Lu)items_estimate, false_positive_prob);
     }
     m_num_bytes = (m_num_bits / CHAR_BIT) + (m_num_bits % CHAR_BIT ? 1 : 0);
-    m_bloom_base = new uint8_t[total_size()];
-    m_bloom_bits = m_bloom_base + 4;
-    memset(m_bloom_base, 0, total_size());
+    allocate_storage();
 
     HT_DEBUG_OUT << "num funcs=" << m_num_hash_functions << " num bits="
         << m_num_bits << " num bytes= " << m_num_bytes << " bits per element="
@@ -101,9 +100,7 @@ public:
               (Lu)items_estimate, bits_per_item);
     }
     m_num_bytes = (m_num_bits / CHAR_BIT) + (m_num_bits % CHAR_BIT ? 1 : 0);
-    m_bloom_base = new uint8_t[total_size()];
-    m_bloom_bits = m_bloom_base + 4;
-    memset(m_bloom_base, 0, total_size());
+    allocate_storage();
 
     HT_DEBUG_OUT << "num funcs=" << m_num_hash_functions << " num bits="
         << m_num_bits << " num bytes=" << m_num_bytes << " bits per element="
@@ -131,9 +128,7 @@ public:
               (Lu)items_estimate, (Lu)items_actual, (Lld)length, (Lu)num_hashes);
     }
     m_num_bytes = (m_num_bits / CHAR_BIT) + (m_num_bits % CHAR_BIT ? 1 : 0);
-    m_bloom_base = new uint8_t[total_size()];
-    m_bloom_bits = m_bloom_base + 4;
-    memset(m_bloom_base, 0, total_size());
+    allocate_storage();
 
     HT_DEBUG_OUT << "num funcs=" << m_num_hash_functions << " num bits="
         << m_num_bits << " num bytes=" << m_num_bytes << " bits per element="
@@ -142,7 +137,10 @@ public:
 
   /** Destructor; releases resources */
   ~BasicBloomFilterWithChecksum() {
-    delete[] m_bloom_base;
+    if (m_mmapped)
+      munmap(m_bloom_base, total_size());
+    else
+      delete[] m_bloom_base;
   }
 
   /* XXX/review static functions to expose the bloom filter parameters, given
@@ -177,10 +175,67 @@ public:
     insert(key.c_str(), key.length());
   }
 
+  /** Maximum number of hash functions supported by the batched probe path */
+  static const size_t MAX_BATCHED_HASHES = 16;
+
+  /** Computes the bit positions for a key without touching the filter.
+   *
+   * The hash chain is computed up front so the subsequent bit tests are
+   * independent loads instead of each load waiting on the next hash.
+   *
+   * @param key Pointer to the key's data
+   * @param len Size of the data (in bytes)
+   * @param positions Array to receive the bit positions
+   * @return Number of positions written, or 0 if the filter uses more hash
+   * functions than the batched path supports
+   */
+  size_t hash_positions(const void *key, size_t len,
+                        size_t positions[MAX_BATCHED_HASHES]) const {
+    if (m_num_hash_functions > MAX_BATCHED_HASHES)
+      return 0;
+    uint32_t hash = len;
+    for (size_t i = 0; i < m_num_hash_functions; ++i) {
+      hash = m_hasher(key, len, hash) % m_num_bits;
+      positions[i] = hash;
+    }
+    return m_num_hash_functions;
+  }
+
+  /** Issues prefetches for the filter bytes covering the given positions.
+   *
+   * Can be called for several filters before testing any of them, so the
+   * cache misses of a multi-filter probe overlap instead of being taken
+   * one filter at a time.
+   *
+   * @param positions Bit positions computed by hash_positions()
+   * @param count Number of positions
+   */
+  void prefetch(const size_t *positions, size_t count) const {
+#ifdef __GNUC__
+    for (size_t i = 0; i < count; ++i)
+      __builtin_prefetch(&m_bloom_bits[positions[i] / CHAR_BIT], 0, 1);
+#endif
+  }
+
+  /** Tests previously computed bit positions.
+   *
+   * @param positions Bit positions computed by hash_positions()
+   * @param count Number of positions
+   * @return true if the key "may" be contained, otherwise false
+   */
+  bool may_contain(const size_t *positions, size_t count) const {
+    for (size_t i = 0; i < count; ++i) {
+      if ((m_bloom_bits[positions[i] / CHAR_BIT]
+           & (1 << (positions[i] % CHAR_BIT))) == 0)
+        return false;
+    }
+    return true;
+  }
+
   /** Checks if the data set "may" contain the key. This can return false
    * positives.
    *
-   * This function runs through all hash tables and checks if the hashed bit 
+   * This function runs through all hash tables and checks if the hashed bit
    * is set. If any of them is not set then the key is definitely not part of
    * the data set. If all bits are set then the key "may" be in the data set.
    *
@@ -189,6 +244,14 @@ public:
    * @return true if the key "may" be contained, otherwise false
    */
   bool may_contain(const void *key, size_t len) const {
+    size_t positions[MAX_BATCHED_HASHES];
+    size_t count = hash_positions(key, len, positions);
+
+    if (count) {
+      prefetch(positions, count);
+      return may_contain(positions, count);
+    }
+
     uint32_t hash = len;
     uint8_t byte_mask;
     uint8_t byte;
@@ -287,6 +350,33 @@ public:
   size_t get_items_actual() { return m_items_actual; }
 
 private:
+
+  /// Large filters above this size are backed by anonymous mmap
+  static const size_t MMAP_THRESHOLD = 65536;
+
+  /** Allocates the filter storage.  Filters of MMAP_THRESHOLD bytes or
+   * more are backed by an anonymous memory mapping, keeping them off the
+   * malloc heap: pages are demand-zeroed rather than touched up front, and
+   * the full region is returned to the operating system when the filter is
+   * purged, so rarely-probed filters cost only the pages actually
+   * faulted in.  Smaller filters use plain heap allocation.
+   */
+  void allocate_storage() {
+    if (total_size() >= MMAP_THRESHOLD) {
+      void *addr = mmap(0, total_size(), PROT_READ|PROT_WRITE,
+                        MAP_PRIVATE|MAP_ANONYMOUS, -1, 0);
+      if (addr != MAP_FAILED) {
+        m_bloom_base = (uint8_t *)addr;  // pages are demand-zeroed
+        m_bloom_bits = m_bloom_base + 4;
+        m_mmapped = true;
+        return;
+      }
+    }
+    m_bloom_base = new uint8_t[total_size()];
+    m_bloom_bits = m_bloom_base + 4;
+    memset(m_bloom_base, 0, total_size());
+  }
+
   /** The hash function implementation */
   HasherT    m_hasher;
 
@@ -313,6 +403,9 @@ private:
 
   /** The serialized bloom filter data, including metadata and checksums */
   uint8_t   *m_bloom_base;
+
+  /** Set to <i>true</i> if storage is backed by an anonymous mapping */
+  bool       m_mmapped {};
 };
 
 typedef BasicBloomFilterWithChecksum<> BloomFilterWithChecksum;
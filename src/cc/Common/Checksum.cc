@@ -19,14 +19,23 @@
 
 /** @file
  * Implementation of checksum routines.
- * This file implements the fletcher32 checksum algorithm.
+ * This file implements the fletcher32 and CRC32C checksum algorithms.
  */
 
 #include "Compat.h"
 #include <arpa/inet.h>
 #include <zlib.h>
+#include <cstring>
 #include "Checksum.h"
 
+#if defined(__GNUC__) && defined(__x86_64__)
+#include <nmmintrin.h>
+#define HT_CRC32C_X86 1
+#elif defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#define HT_CRC32C_ARM 1
+#endif
+
 namespace Hypertable {
 
 #define HT_F32_DO1(buf,i) \
@@ -83,6 +92,89 @@ fletcher32(const void *data8, size_t len8) {
   return (sum2 << 16) | sum1;
 }
 
+namespace {
+
+  /* Table for the reflected Castagnoli polynomial (0x82F63B78), built
+   * lazily by the resolver before the software kernel is installed.
+   */
+  uint32_t crc32c_table[256];
+
+  uint32_t software_crc32c(const void *data, size_t len) {
+    const uint8_t *buf = (const uint8_t *)data;
+    uint32_t crc = 0xFFFFFFFF;
+    while (len--)
+      crc = crc32c_table[(crc ^ *buf++) & 0xFF] ^ (crc >> 8);
+    return crc ^ 0xFFFFFFFF;
+  }
+
+#ifdef HT_CRC32C_X86
+
+  __attribute__((target("sse4.2")))
+  uint32_t sse42_crc32c(const void *data, size_t len) {
+    const uint8_t *buf = (const uint8_t *)data;
+    uint64_t crc = 0xFFFFFFFF;
+    while (len >= 8) {
+      uint64_t chunk;
+      memcpy(&chunk, buf, 8);
+      crc = _mm_crc32_u64(crc, chunk);
+      buf += 8;
+      len -= 8;
+    }
+    uint32_t crc32 = (uint32_t)crc;
+    while (len--)
+      crc32 = _mm_crc32_u8(crc32, *buf++);
+    return crc32 ^ 0xFFFFFFFF;
+  }
+
+#endif // HT_CRC32C_X86
+
+#ifdef HT_CRC32C_ARM
+
+  uint32_t armv8_crc32c(const void *data, size_t len) {
+    const uint8_t *buf = (const uint8_t *)data;
+    uint32_t crc = 0xFFFFFFFF;
+    while (len >= 8) {
+      uint64_t chunk;
+      memcpy(&chunk, buf, 8);
+      crc = __crc32cd(crc, chunk);
+      buf += 8;
+      len -= 8;
+    }
+    while (len--)
+      crc = __crc32cb(crc, *buf++);
+    return crc ^ 0xFFFFFFFF;
+  }
+
+#endif // HT_CRC32C_ARM
+
+  /* First call probes the CPU, installs the best kernel and tail-calls it;
+   * all subsequent calls bypass this resolver entirely.
+   */
+  uint32_t resolve_crc32c(const void *data, size_t len) {
+#ifdef HT_CRC32C_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse4.2")) {
+      crc32c = sse42_crc32c;
+      return crc32c(data, len);
+    }
+#elif defined(HT_CRC32C_ARM)
+    crc32c = armv8_crc32c;
+    return crc32c(data, len);
+#endif
+    for (uint32_t i = 0; i < 256; i++) {
+      uint32_t crc = i;
+      for (int k = 0; k < 8; k++)
+        crc = (crc & 1) ? (crc >> 1) ^ 0x82F63B78 : crc >> 1;
+      crc32c_table[i] = crc;
+    }
+    crc32c = software_crc32c;
+    return crc32c(data, len);
+  }
+
+}
+
+uint32_t (*crc32c)(const void *data, size_t len) = resolve_crc32c;
+
 } // namespace Hypertable
 
 /* vim: et sw=2
@@ -41,6 +41,21 @@ namespace Hypertable {
    */
   extern uint32_t fletcher32(const void *data, size_t len);
 
+  /** Compute CRC32C (Castagnoli) checksum for arbitrary data.  This is a
+   * function pointer which initially points to a resolver that probes the
+   * CPU on first use and installs the best available kernel (the SSE4.2
+   * <code>crc32</code> instruction on x86-64, the ARMv8 CRC extension on
+   * AArch64, or a table-driven software implementation elsewhere).  CRC32C
+   * is considerably faster than fletcher32 on modern hardware and provides
+   * stronger error detection; it is used for block data checksums starting
+   * with block header version 2.
+   *
+   * @param data Pointer to the input data
+   * @param len Input data length in bytes
+   * @return The calculated checksum
+   */
+  extern uint32_t (*crc32c)(const void *data, size_t len);
+
   /** @}*/
 
 } // namespace Hypertable
@@ -170,6 +170,20 @@ void DefaultPolicy::init_options() {
     ("Comm.DispatchDelay", i32()->default_value(0), "[TESTING ONLY] "
         "Delay dispatching of read requests by this number of milliseconds")
     ("Comm.UsePoll", boo()->default_value(false), "Use POSIX poll() interface")
+    ("Comm.Coalesce.Limit", i32()->default_value(0),
+        "Coalesce messages of this size (bytes) or smaller into batched "
+        "socket writes (0 disables coalescing)")
+    ("Comm.Coalesce.Delay", i32()->default_value(1),
+        "Milliseconds to hold small messages for send coalescing")
+    ("Comm.Tls.Enabled", boo()->default_value(false),
+        "Encrypt TCP connections with TLS")
+    ("Comm.Tls.Certificate", str()->default_value(""),
+        "TLS certificate chain file (PEM)")
+    ("Comm.Tls.PrivateKey", str()->default_value(""),
+        "TLS private key file (PEM)")
+    ("Comm.Tls.CaCertificate", str()->default_value(""),
+        "CA certificate file (PEM); when set, peer certificates are "
+        "required and verified")
     ("Hypertable.Cluster.Name", str(),
      "Name of cluster used in Monitoring UI and admin notification messages")
     ("Hypertable.Verbose", boo()->default_value(false),
@@ -202,6 +216,10 @@ void DefaultPolicy::init_options() {
         "of old MetaLog files to retain for historical purposes")
     ("Hypertable.MetaLog.MaxFileSize", i64()->default_value(100*M), "Maximum "
         "size a MetaLog file can grow before it is compacted")
+    ("Hypertable.MetaLog.CompactionFactor", i32()->default_value(10),
+        "Roll the MetaLog into a fresh snapshot of the live entity map when "
+        "the current file exceeds this multiple of the live entity state; "
+        "bounds failover replay work under heavy entity churn (0 disables)")
     ("Hypertable.MetaLog.SkipErrors", boo()->default_value(false), "Skipping "
         "errors instead of throwing exceptions on metalog errors")
     ("Hypertable.MetaLog.WriteInterval", i32()->default_value(30),
@@ -255,10 +273,20 @@ void DefaultPolicy::init_options() {
     ("DfsBroker.Host", str(), "DEPRECATED: renamed to FsBroker.Host")
     ("DfsBroker.Port", i16(), "DEPRECATED: renamed to FsBroker.Port")
     ("DfsBroker.Timeout", i32(), "DEPRECATED: renamed to FsBroker.Timeout")
+    ("FsBroker.Client.HandleCacheSize", i32()->default_value(0),
+        "Maximum number of idle broker file handles retained by the client "
+        "for reuse by subsequent opens of the same file (zero disables "
+        "handle caching)")
+    ("FsBroker.Client.ShmReads", boo()->default_value(false),
+        "Request delivery of read payloads through POSIX shared memory when "
+        "the FS broker is on the local host")
     ("FsBroker.DisableFileRemoval", boo()->default_value(false),
         "Rename files with .deleted extension instead of removing (for testing)")
     ("FsBroker.Local.DirectIO", boo()->default_value(false),
         "Read and write files using direct i/o")
+    ("FsBroker.Local.MmapReads", boo()->default_value(false),
+        "Serve positioned reads of files opened read-only from a memory "
+        "mapping instead of pread (supersedes direct i/o for reads)")
     ("FsBroker.Local.Port", i16()->default_value(15863),
         "Port number on which to listen (read by LocalBroker only)")
     ("FsBroker.Local.Root", str(), "Root of file and directory "
@@ -275,14 +303,39 @@ void DefaultPolicy::init_options() {
     ("FsBroker.Timeout", i32(), "Length of time, "
         "in milliseconds, to wait before timing out FS Broker requests. This "
         "takes precedence over Hypertable.Request.Timeout")
+    ("FsBroker.SlowOpThreshold", i32()->default_value(0),
+        "Log broker operations slower than this threshold (milliseconds) "
+        "with their file/offset context (zero disables)")
+    ("FsBroker.ShmPayload.MinSize", i32()->default_value(4*KiB),
+        "Minimum read size (bytes) transferred via shared memory when the "
+        "requester is colocated")
+    ("FsBroker.ReadCache.MaxMemory", i64()->default_value(0),
+        "Maximum amount of broker memory (bytes) used to cache file regions "
+        "read from a remote file system (zero disables the cache)")
+    ("FsBroker.HedgedReads.Enabled", boo()->default_value(false),
+        "Issue a second positioned read when the first exceeds an adaptive "
+        "latency threshold and take the first to complete (qfs/ceph brokers)")
+    ("FsBroker.HedgedReads.Percentile", i32()->default_value(95),
+        "Percentile of recent read latencies used as the hedge threshold")
+    ("FsBroker.HedgedReads.MinTimeout", i32()->default_value(50),
+        "Lower bound (milliseconds) on the hedge threshold")
     ("Hyperspace.Timeout", i32()->default_value(30000), "Timeout (millisec) "
         "for hyperspace requests (preferred to Hypertable.Request.Timeout")
     ("Hyperspace.Maintenance.Interval", i32()->default_value(60000), "Hyperspace "
         " maintenance interval (checkpoint BerkeleyDB, log cleanup etc)")
     ("Hyperspace.Checkpoint.Size", i32()->default_value(1*M), "Run BerkeleyDB checkpoint"
         " when logs exceed this size limit")
+    ("Hyperspace.GroupCommit.Interval", i32()->default_value(0),
+        "Group commit window (milliseconds) for BerkeleyDB transaction log "
+        "flushes; zero flushes each transaction synchronously")
     ("Hyperspace.Client.Datagram.SendPort", i16()->default_value(0),
         "Client UDP send port for keepalive packets")
+    ("Hyperspace.Client.ReadCache", boo()->default_value(false),
+        "Cache attribute and directory reads in the client session, "
+        "invalidated by change notifications and a maximum age")
+    ("Hyperspace.Client.ReadCache.MaxAge", i32()->default_value(60000),
+        "Maximum age (milliseconds) of read cache entries; bounds staleness "
+        "for sessions holding no watched handles")
     ("Hyperspace.LogGc.Interval", i32()->default_value(60000), "Check for unused BerkeleyDB "
         "log files after this much time")
     ("Hyperspace.LogGc.MaxUnusedLogs", i32()->default_value(200), "Number of unused BerkeleyDB "
@@ -328,6 +381,10 @@ void DefaultPolicy::init_options() {
     ("Hypertable.LoadBalancer.LoadavgThreshold", f64()->default_value(0.25),
         "Servers with loadavg above this much above the mean will be considered by the "
         "load balancer to be overloaded")
+    ("Hypertable.LoadBalancer.LatencyThreshold", f64()->default_value(20.0),
+        "Servers whose request-weighted p99 latency (in milliseconds) is this much "
+        "above the mean will be considered by the 'latency' balance algorithm to "
+        "be overloaded")
     ("Hypertable.HqlInterpreter.Mutator.NoLogSync", boo()->default_value(false),
         "Suspends CommitLog sync operation on updates until command completion")
     ("Hypertable.RangeLocator.MetadataReadaheadCount", i32()->default_value(10),
@@ -346,18 +403,77 @@ void DefaultPolicy::init_options() {
     ("Hypertable.Mutator.ScatterBuffer.FlushLimit.Aggregate",
      i64()->default_value(50*M), "Amount of updates (bytes) accumulated for "
         "all servers to trigger a scatter buffer flush")
+    ("Hypertable.Mutator.PipelineDepth", i32()->default_value(4),
+        "Number of flushed scatter buffers (update RPCs per range server) "
+        "a synchronous mutator keeps in flight before blocking on "
+        "completions (1 = wait for each flush before sending the next)")
+    ("Hypertable.Mutator.AdaptiveBatching", boo()->default_value(false),
+        "Adaptively size the aggregate flush limit, growing it while "
+        "update round-trips stay under the latency target and shrinking "
+        "it on retries, timeouts, or over-target round-trips")
+    ("Hypertable.Mutator.AdaptiveBatching.LatencyTarget",
+     i32()->default_value(500), "Target update round-trip time "
+        "(milliseconds) for adaptive mutator batching")
+    ("Hypertable.Mutator.AdaptiveBatching.MinBytes",
+     i64()->default_value(1*M), "Floor of the adaptively sized aggregate "
+        "flush limit; the configured FlushLimit.Aggregate is the ceiling")
+    ("Hypertable.Mutator.Index.Async", boo()->default_value(false),
+        "Update secondary index tables concurrently with the primary table "
+        "instead of strictly before it; index entries lag the primary by at "
+        "most one flush and index scans verify results against the primary "
+        "table")
     ("Hypertable.Scanner.QueueSize",
      i32()->default_value(5), "Size of Scanner ScanBlock queue")
+    ("Hypertable.Scanner.ScanblockFormat", i32()->default_value(1),
+        "Scan block format requested from RangeServers; format 2 "
+        "delta-encodes repeated row keys and column qualifiers, format 1 is "
+        "the classic encoding (valid values: 1, 2)")
+    ("Hypertable.Scanner.StreamBufferBytes", i64()->default_value(32*M),
+        "Amount of scan results (bytes) buffered on the client by a "
+        "streaming scanner before response processing is throttled")
+    ("Hypertable.Scanner.RangeFanout", i32()->default_value(1),
+        "Number of range scans to keep in flight for each row interval "
+        "of a table scan (1 = walk ranges sequentially)")
+    ("Hypertable.Client.ShmScanResults", boo()->default_value(false),
+        "Request delivery of scan results through POSIX shared memory "
+        "when the RangeServer is on the local host")
+    ("Hypertable.Client.HedgedReads", boo()->default_value(false),
+        "Re-issue a create_scanner request that has not responded within "
+        "the 99th percentile read latency and take the first response")
     ("Hypertable.LocationCache.MaxEntries", i64()->default_value(1*M),
         "Size of range location cache in number of entries")
+    ("Hypertable.LocationCache.SnapshotFile", str()->default_value(""),
+        "File in which to persist the range location cache across process "
+        "runs; loaded at startup and written at shutdown (empty disables "
+        "persistence)")
+    ("Hypertable.LocationCache.Snapshot.MaxAge", i32()->default_value(86400),
+        "Maximum age (seconds) of a location cache snapshot to accept "
+        "on load")
     ("Hypertable.Master.Host", str(),
         "Host on which Hypertable Master is running")
     ("Hypertable.Master.Port", i16()->default_value(15864),
         "Port number on which Hypertable Master is or should be listening")
-    ("Hypertable.Master.Workers", i32()->default_value(100),
-        "Number of Hypertable Master worker threads created")
+    ("Hypertable.Master.Workers", i32()->default_value(200),
+        "Number of Hypertable Master worker threads created; workers spend "
+        "most of their time waiting on RangeServer RPCs, so large recoveries "
+        "benefit from a pool well above the server count")
     ("Hypertable.Master.Reactors", i32(),
         "Number of Hypertable Master communication reactor threads created")
+    ("Hypertable.Master.Admission.RecoveryLimit", i32()->default_value(0),
+        "Maximum number of recovery operations executing concurrently in the "
+        "Master (0 = unlimited)")
+    ("Hypertable.Master.Admission.MoveLimit", i32()->default_value(0),
+        "Maximum number of range move operations executing concurrently in "
+        "the Master (0 = 3/4 of Hypertable.Master.Workers)")
+    ("Hypertable.Master.Admission.BalanceLimit", i32()->default_value(0),
+        "Maximum number of balance operations executing concurrently in the "
+        "Master (0 = 3/4 of Hypertable.Master.Workers)")
+    ("Hypertable.Master.Admission.DdlLimit", i32()->default_value(0),
+        "Maximum number of schema (DDL) operations executing concurrently in "
+        "the Master (0 = 3/4 of Hypertable.Master.Workers)")
+    ("Hypertable.Master.Admission.OtherLimit", i32()->default_value(0),
+        "Maximum number of unclassified operations executing concurrently in "
+        "the Master (0 = 3/4 of Hypertable.Master.Workers)")
     ("Hypertable.Master.Gc.Interval", i32()->default_value(300000),
         "Garbage collection interval in milliseconds by Master")
     ("Hypertable.Master.Locations.IncludeMasterHash", boo()->default_value(false),
@@ -371,6 +487,9 @@ void DefaultPolicy::init_options() {
         "at a given time")
     ("Hypertable.Master.NotificationInterval", i32()->default_value(3600),
         "Notification interval (in seconds) of abnormal state")
+    ("Hypertable.Master.Gossip.Suspicion.Window", i32()->default_value(10000),
+        "Time window (milliseconds) within which gossip suspicion reports "
+        "for a server are aggregated toward a quorum")
     ("Hypertable.Master.RecordGraphvizStream", boo()->default_value(false),
      "Appends Graphviz output to run/op-graphviz-stream on each DAG change")
     ("Hypertable.Failover.GracePeriod", i32()->default_value(30000),
@@ -400,16 +519,51 @@ void DefaultPolicy::init_options() {
     ("Hypertable.RangeServer.MemoryLimit.EnsureUnused", i64(), "Amount of unused physical memory")
     ("Hypertable.RangeServer.MemoryLimit.EnsureUnused.Percentage", i32(),
      "Amount of unused physical memory specified as percentage of physical RAM")
+    ("Hypertable.RangeServer.MemoryLimit.EmergencyFloor.Percentage",
+     i32()->default_value(3), "Free physical memory floor, as percentage of "
+     "physical RAM, below which an emergency memory purge is scheduled "
+     "regardless of internal memory accounting (0 disables)")
     ("Hypertable.RangeServer.Port", i16()->default_value(15865),
         "Port number on which range servers are or should be listening")
+    ("Hypertable.RangeServer.Gossip.Enabled", boo()->default_value(false),
+        "Gossip liveness among range servers over UDP and report "
+        "unresponsive peers to the Master for fast failure suspicion")
+    ("Hypertable.RangeServer.Gossip.Interval", i32()->default_value(500),
+        "Interval (milliseconds) between liveness gossip pings")
+    ("Hypertable.RangeServer.Gossip.SuspectTimeout",
+        i32()->default_value(2000), "Report a peer to the Master as a "
+        "failure suspect after it has not answered gossip pings for this "
+        "many milliseconds")
     ("Hypertable.RangeServer.AccessGroup.CellCache.PageSize",
      i32()->default_value(512*KiB), "Page size for CellCache pool allocator")
+    ("Hypertable.RangeServer.Memory.HugePages", boo()->default_value(false),
+     "Request transparent huge page backing (madvise) for range server "
+     "cache pages to reduce TLB misses with large caches")
+    ("Hypertable.RangeServer.AccessGroup.CellCache.NumaLocalPages",
+     boo()->default_value(true), "Allocate CellCache pages with mmap so that "
+     "first touch places them on the NUMA node of the inserting thread")
+    ("Hypertable.RangeServer.AccessGroup.CellCache.SlabReuse",
+     boo()->default_value(false), "Round CellCache arena allocations to slab "
+     "size classes and recycle freed chunks instead of leaving them "
+     "unreachable until the cache is dropped")
+    ("Hypertable.RangeServer.AccessGroup.CellCache.ZeroCopyThreshold",
+     i32()->default_value(0), "Insert cells at least this many bytes long "
+     "into the CellCache by reference to the (pinned) update buffer instead "
+     "of copying them into the arena (0 disables)")
+    ("Hypertable.RangeServer.AccessGroup.CellCache.InlineThreshold",
+     i32()->default_value(128), "Store cells at most this many bytes long "
+     "inline in their CellCache skip list node, saving a separate arena "
+     "allocation and a pointer dereference per key comparison (0 disables)")
     ("Hypertable.RangeServer.AccessGroup.CellCache.ScannerCacheSize",
      i32()->default_value(1024), "CellCache scanner cache size")
     ("Hypertable.RangeServer.AccessGroup.ShadowCache",
      boo()->default_value(false), "Enable CellStore shadow caching")
     ("Hypertable.RangeServer.AccessGroup.MaxMemory", i64()->default_value(1*G),
         "Maximum bytes consumed by an Access Group")
+    ("Hypertable.RangeServer.AccessGroup.IncrementalCompaction.SliceSize",
+     i64()->default_value(0), "Perform major compactions of access groups "
+     "larger than 1.5 times this many bytes incrementally, one contiguous "
+     "row sub-interval of roughly this many bytes at a time (0 disables)")
     ("Hypertable.RangeServer.CellStore.TargetSize.Minimum",
         i64()->default_value(10*MiB),
      "Merging compaction target CellStore size during normal activity period")
@@ -423,6 +577,29 @@ void DefaultPolicy::init_options() {
         "Trigger a merge if an adjacent run of merge candidate CellStores exceeds this length")
     ("Hypertable.RangeServer.CellStore.DefaultBlockSize",
         i32()->default_value(64*KiB), "Default block size for cell stores")
+    ("Hypertable.RangeServer.CellStore.Preadv.BlockCount",
+        i32()->default_value(4), "Maximum number of blocks fetched from the "
+        "broker in a single vectored pread by the cell store scanner "
+        "(values below 2 disable vectored reads)")
+    ("Hypertable.RangeServer.CellStore.IndexLeafBlockSize",
+        i32()->default_value(64*KiB), "Target uncompressed size of block "
+        "index leaf blocks in version 8+ cell stores")
+    ("Hypertable.RangeServer.Scanner.ReadaheadBudget",
+        i64()->default_value(128*MiB), "Total readahead bytes allowed in "
+        "flight across all concurrent readahead scanners; 0 disables the "
+        "budget")
+    ("Hypertable.RangeServer.Scanner.DecompressionWorkers",
+        i32()->default_value(0), "Number of worker threads to which "
+        "scanners hand off cell store block decompression, capping the "
+        "number of blocks being decompressed concurrently; 0 decompresses "
+        "inline on the thread serving the scan")
+    ("Hypertable.RangeServer.CellStore.BlockRestartInterval",
+        i32()->default_value(16), "Number of keys between prefix compression "
+        "restart points in version 8+ cell store blocks")
+    ("Hypertable.RangeServer.CellStore.CompressionWorkers",
+        i32()->default_value(0), "Number of background threads used to "
+        "compress cell store blocks during compaction; 0 compresses "
+        "synchronously on the compaction thread")
     ("Hypertable.RangeServer.Data.DefaultReplication",
         i32()->default_value(-1), "Default replication for data")
     ("Hypertable.RangeServer.CellStore.DefaultCompressor",
@@ -437,12 +614,47 @@ void DefaultPolicy::init_options() {
         boo()->default_value(false), "Ignore clock skew errors")
     ("Hypertable.RangeServer.CommitInterval", i32()->default_value(50),
      "Default minimum group commit interval in milliseconds")
+    ("Hypertable.RangeServer.GroupCommit.MaxLatency", i32()->default_value(0),
+     "Upper bound in milliseconds for the adaptive group commit flush "
+     "interval derived from observed commit log sync latency; 0 disables "
+     "adaptive batching")
+    ("Hypertable.RangeServer.HotKeyDetector.TopK", i32()->default_value(10),
+     "Number of hottest row keys reported per load statistics period; "
+     "0 disables hot key detection")
     ("Hypertable.RangeServer.BlockCache.Compressed", boo()->default_value(true),
         "Controls whether or not block cache stores compressed blocks")
     ("Hypertable.RangeServer.BlockCache.MinMemory", i64()->default_value(0),
         "Minimum size of block cache")
     ("Hypertable.RangeServer.BlockCache.MaxMemory", i64()->default_value(-1),
         "Maximum (target) size of block cache")
+    ("Hypertable.RangeServer.BlockCache.CompressedTier.MaxMemory",
+     i64()->default_value(0),
+     "Maximum size of the second-tier cache holding compressed blocks, which "
+     "are re-inflated into the block cache on demand; only used when the "
+     "block cache itself stores uncompressed blocks (0 disables)")
+    ("Hypertable.RangeServer.BlockCache.FlashTier.Path", str()->default_value(""),
+     "Pathname of local flash file backing the flash tier of the block "
+     "cache; blocks evicted from the block cache are spilled here and "
+     "re-read on a miss (empty disables)")
+    ("Hypertable.RangeServer.BlockCache.FlashTier.MaxSize",
+     i64()->default_value(0),
+     "Maximum size of the flash tier cache file (0 disables)")
+    ("Hypertable.RangeServer.BlockCache.IndexPath", str()->default_value(""),
+     "Pathname of local file in which the block cache index is persisted "
+     "on clean shutdown; a restarted server re-reads the recorded blocks "
+     "in the background to re-warm its cache (empty disables)")
+    ("Hypertable.RangeServer.CellCache.CheckpointDirectory",
+     str()->default_value(""),
+     "Local directory in which each access group's cell cache is "
+     "serialized on clean shutdown; at startup the caches are restored "
+     "from these files and the restored cells are skipped during commit "
+     "log replay (empty disables)")
+    ("Hypertable.RangeServer.ScanAccessLog.Enable", boo()->default_value(false),
+     "Enable the sampled scan-request log; records can be replayed in "
+     "shadow mode with ht_scan_replay to warm a standby server's caches")
+    ("Hypertable.RangeServer.ScanAccessLog.SampleRate",
+     i32()->default_value(100),
+     "Log one of every this many scan requests to the scan access log")
     ("Hypertable.RangeServer.QueryCache.EnableMutexStatistics",
      boo()->default_value(true), "Enable query cache mutex statistics")
     ("Hypertable.RangeServer.QueryCache.MaxMemory", i64()->default_value(50*M),
@@ -485,6 +697,17 @@ void DefaultPolicy::init_options() {
         "TESTING:  After update, if range needs maintenance, pause for this number of milliseconds")
     ("Hypertable.RangeServer.UpdateCoalesceLimit", i64()->default_value(5*M),
         "Amount of update data to coalesce into single commit log sync")
+    ("Hypertable.RangeServer.UpdatePipeline.AddStageWorkers",
+     i32()->default_value(1), "Number of worker threads applying committed "
+        "updates to ranges in the final update pipeline stage")
+    ("Hypertable.RangeServer.UpdatePipeline.Throttle.Rate",
+     i64()->default_value(20*M), "Aggregate update admission rate (bytes/s) "
+        "shared evenly by active clients while throttling is engaged "
+        "(0 = never throttle)")
+    ("Hypertable.RangeServer.UpdatePipeline.Throttle.TableWeights",
+     strs()->default_value(std::vector<std::string>(), ""),
+     "Per-table update throttle weights (<table-id>:<weight>); updates to "
+        "higher weight tables consume proportionally fewer admission tokens")
     ("Hypertable.RangeServer.Failover.FlushLimit.PerRange",
      i32()->default_value(10*M), "Amount of updates (bytes) accumulated for a "
         "single range to trigger a replay buffer flush")
@@ -499,16 +722,57 @@ void DefaultPolicy::init_options() {
         "Roll commit log after this many bytes")
     ("Hypertable.CommitLog.Compressor", str()->default_value("quicklz"),
         "Commit log compressor to use (zlib, lzo, quicklz, snappy, bmz, none)")
+    ("Hypertable.CommitLog.Partitions", i32()->default_value(1),
+        "Number of independent fragment streams per commit log; writes are "
+        "routed by partition hint so concurrent writers append and sync in "
+        "parallel")
     ("Hypertable.CommitLog.SkipErrors", boo()->default_value(false),
         "Skip over any corruption encountered in the commit log")
+    ("Hypertable.CommitLog.Archive.Directory", str()->default_value(""),
+        "Root directory under which removed commit log fragments are "
+        "archived, mirroring their original pathname; the empty string "
+        "disables archival")
+    ("Hypertable.CommitLog.Archive.DfsBroker.Host", str(),
+        "Host of FS broker to use for the commit log archive; defaults to "
+        "the commit log broker")
+    ("Hypertable.CommitLog.Archive.DfsBroker.Port", i16(),
+        "Port of FS broker to use for the commit log archive")
+    ("Hypertable.CommitLog.Reader.ParallelReplay", i32()->default_value(0),
+        "Number of background threads used to read and inflate commit log "
+        "fragments ahead of replay; 0 replays sequentially")
     ("Hypertable.RangeServer.Scanner.Ttl", i32()->default_value(1800*K),
         "Number of milliseconds of inactivity before destroying scanners")
     ("Hypertable.RangeServer.Scanner.BufferSize", i64()->default_value(1*M),
         "Size of transfer buffer for scan results")
+    ("Hypertable.RangeServer.Scanner.SpillDelay", i32()->default_value(0),
+        "Number of milliseconds of inactivity before a scanner's remaining "
+        "results are spilled to a local file and its merge scanner "
+        "released; 0 disables spilling")
+    ("Hypertable.RangeServer.Scanner.SpillBudget",
+        i64()->default_value(128*MiB), "Maximum size, in bytes, of the "
+        "spill file written for a single stalled scanner")
+    ("Hypertable.RangeServer.Scanner.SpillDirectory",
+        str()->default_value("/tmp"), "Local directory in which scanner "
+        "spill files are created")
+    ("Hypertable.RangeServer.Root.PublishLocations",
+        boo()->default_value(true), "Publish the METADATA range locations "
+        "held in the root METADATA range to Hyperspace so clients can warm "
+        "their location cache without scanning the root range")
+    ("Hypertable.RangeServer.Scanner.ShmPayload.MinSize",
+     i32()->default_value(4*KiB), "Minimum scan block size (bytes) "
+        "transferred via shared memory when the requester is colocated")
     ("Hypertable.RangeServer.Timer.Interval", i32()->default_value(20000),
         "Timer interval in milliseconds (reaping scanners, purging commit logs, etc.)")
     ("Hypertable.RangeServer.Maintenance.Interval", i32()->default_value(30000),
         "Maintenance scheduling interval in milliseconds")
+    ("Hypertable.RangeServer.Maintenance.AdaptiveCellCacheBudget", boo()->default_value(false),
+        "Size each range's cell cache budget proportional to its observed "
+        "write rate instead of flushing every access group at "
+        "Hypertable.RangeServer.AccessGroup.MaxMemory")
+    ("Hypertable.RangeServer.Maintenance.CacheMemoryGovernor", boo()->default_value(false),
+        "Treat the block cache and query cache budgets as one pool, "
+        "shrinking them under memory pressure and shifting budget toward "
+        "the cache with the higher recent hits-per-byte")
     ("Hypertable.RangeServer.Maintenance.LowMemoryPrioritization", boo()->default_value(true),
         "Use low memory prioritization algorithm for freeing memory in low memory mode")
     ("Hypertable.RangeServer.Maintenance.MaxAppQueuePause", i32()->default_value(120000),
@@ -521,12 +785,69 @@ void DefaultPolicy::init_options() {
         "Limit on number of major compactions due to move per maintenance interval")
     ("Hypertable.RangeServer.Maintenance.InitializationPerInterval", i32(),
         "Limit on number of initialization tasks to create per maintenance interval")
+    ("Hypertable.RangeServer.Maintenance.FastLaneThreads",
+        i32()->default_value(1), "Number of maintenance threads reserved for "
+        "small flush compactions so they never queue behind long-running "
+        "compactions")
+    ("Hypertable.RangeServer.Maintenance.FastLaneMaxSize",
+        i64()->default_value(100*Property::MiB), "Maximum amount of cell "
+        "cache memory a compaction task may flush to be routed to the "
+        "fast lane maintenance threads")
+    ("Hypertable.RangeServer.Maintenance.Throttle.Enabled",
+        boo()->default_value(false), "Throttle maintenance byte rate in "
+        "response to foreground scan latency")
+    ("Hypertable.RangeServer.Maintenance.Throttle.Percentile",
+        i32()->default_value(99), "Scan latency percentile compared against "
+        "the latency threshold")
+    ("Hypertable.RangeServer.Maintenance.Throttle.ScanLatencyThreshold",
+        i32()->default_value(100), "Scan latency (milliseconds) above which "
+        "the maintenance byte rate budget shrinks")
+    ("Hypertable.RangeServer.Maintenance.Throttle.MinRate",
+        i64()->default_value(8*MiB), "Maintenance byte rate budget floor "
+        "(bytes/s)")
+    ("Hypertable.RangeServer.Maintenance.Throttle.MaxRate",
+        i64()->default_value(256*MiB), "Maintenance byte rate budget "
+        "ceiling (bytes/s); when scan latency is healthy the budget grows "
+        "past the ceiling and the throttle opens completely")
     ("Hypertable.RangeServer.Monitoring.DataDirectories", str()->default_value("/"),
         "Comma-separated list of directory mount points of disk volumes to monitor")
     ("Hypertable.RangeServer.Workers", i32()->default_value(50),
         "Number of Range Server worker threads created")
+    ("Hypertable.RangeServer.RangeLoadWorkers", i32()->default_value(16),
+        "Number of threads loading ranges concurrently during local recovery")
+    ("Hypertable.RangeServer.AppQueue.LaneWeight.High", i32()->default_value(8),
+        "Application queue dequeue weight for high priority requests")
+    ("Hypertable.RangeServer.AppQueue.LaneWeight.Normal", i32()->default_value(4),
+        "Application queue dequeue weight for normal priority requests")
+    ("Hypertable.RangeServer.AppQueue.LaneWeight.Low", i32()->default_value(1),
+        "Application queue dequeue weight for low priority requests")
+    ("Hypertable.RangeServer.Tracing.SamplingPeriod", i32()->default_value(256),
+        "Trace one request out of this many, recording per-request span "
+        "timings into an in-memory ring buffer (0 disables tracing)")
+    ("Hypertable.RangeServer.StartupSelfTest", boo()->default_value(false),
+        "Run a CellStore write/read/scan self-benchmark through the FS "
+        "broker on startup and report the measured rates in server "
+        "statistics")
+    ("Hypertable.RangeServer.StartupSelfTest.Size", i64()->default_value(256*MiB),
+        "Amount of cell data written by the startup self-test")
     ("Hypertable.RangeServer.Reactors", i32(),
         "Number of Range Server communication reactor threads created")
+    ("Hypertable.RangeServer.CpuAffinity.Reactor", str()->default_value(""),
+        "CPUs the communication reactor threads are pinned to, as a comma "
+        "separated list of CPU numbers and ranges, optionally split into "
+        "groups with ';' which are assigned to threads round robin (e.g. "
+        "'2;3' gives each of two reactors its own core).  Empty disables "
+        "pinning.")
+    ("Hypertable.RangeServer.CpuAffinity.Workers", str()->default_value(""),
+        "CPUs the application queue worker threads are pinned to (e.g. "
+        "'0-7;8-15' partitions the pool across two sockets).  Same syntax "
+        "as CpuAffinity.Reactor; empty disables pinning.")
+    ("Hypertable.RangeServer.CpuAffinity.Maintenance", str()->default_value(""),
+        "CPUs the maintenance queue worker threads are confined to.  Same "
+        "syntax as CpuAffinity.Reactor; empty disables pinning.")
+    ("Hypertable.RangeServer.CpuAffinity.UpdatePipeline", str()->default_value(""),
+        "CPUs the update pipeline threads are pinned to.  Same syntax as "
+        "CpuAffinity.Reactor; empty disables pinning.")
     ("Hypertable.RangeServer.MaintenanceThreads", i32(),
         "Number of maintenance threads.  Default is min(2, number-of-cores).")
     ("Hypertable.RangeServer.UpdateDelay", i32()->default_value(0),
@@ -544,6 +865,12 @@ void DefaultPolicy::init_options() {
         "threshold for (size of cell data) for thrift broker next calls")
     ("ThriftBroker.API.Logging", boo()->default_value(false), "Enable or "
         "disable Thrift API logging")
+    ("ThriftBroker.Client.PoolSize", i32()->default_value(1), "Number of "
+        "pooled Hypertable client sessions that Thrift connections "
+        "multiplex over")
+    ("ThriftBroker.Scanner.PrefetchWindow", i32()->default_value(0),
+        "Number of serialized scan result batches to prefetch ahead of "
+        "client polls (0 disables prefetching)")
     ("ThriftBroker.Mutator.FlushInterval", i32()->default_value(1000),
         "Maximum flush interval in milliseconds")
     ("ThriftBroker.Workers", i32()->default_value(50), "Number of "
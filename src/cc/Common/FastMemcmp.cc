@@ -0,0 +1,115 @@
+/*
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 3 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/** @file
+ * Vectorized memory comparison.
+ * This file implements the runtime-dispatched comparison kernels declared
+ * in FastMemcmp.h.
+ */
+
+#include "Common/Compat.h"
+#include "Common/FastMemcmp.h"
+
+#include <cstring>
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#include <immintrin.h>
+#define HT_FASTMEMCMP_X86 1
+#endif
+
+namespace {
+
+  using namespace Hypertable;
+
+  int scalar_memcmp(const void *lhs, const void *rhs, size_t len) {
+    return memcmp(lhs, rhs, len);
+  }
+
+#ifdef HT_FASTMEMCMP_X86
+
+  __attribute__((target("sse4.2")))
+  int sse42_memcmp(const void *lhs, const void *rhs, size_t len) {
+    const uint8_t *p1 = (const uint8_t *)lhs;
+    const uint8_t *p2 = (const uint8_t *)rhs;
+    while (len >= 16) {
+      __m128i v1 = _mm_loadu_si128((const __m128i *)p1);
+      __m128i v2 = _mm_loadu_si128((const __m128i *)p2);
+      uint32_t mask = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v1, v2));
+      if (mask != 0xFFFF) {
+        size_t i = __builtin_ctz(~mask);
+        return (int)p1[i] - (int)p2[i];
+      }
+      p1 += 16;
+      p2 += 16;
+      len -= 16;
+    }
+    return len ? memcmp(p1, p2, len) : 0;
+  }
+
+  __attribute__((target("avx2")))
+  int avx2_memcmp(const void *lhs, const void *rhs, size_t len) {
+    const uint8_t *p1 = (const uint8_t *)lhs;
+    const uint8_t *p2 = (const uint8_t *)rhs;
+    while (len >= 32) {
+      __m256i v1 = _mm256_loadu_si256((const __m256i *)p1);
+      __m256i v2 = _mm256_loadu_si256((const __m256i *)p2);
+      uint32_t mask = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v1, v2));
+      if (mask != 0xFFFFFFFF) {
+        size_t i = __builtin_ctz(~mask);
+        _mm256_zeroupper();
+        return (int)p1[i] - (int)p2[i];
+      }
+      p1 += 32;
+      p2 += 32;
+      len -= 32;
+    }
+    _mm256_zeroupper();
+    return len ? sse42_memcmp(p1, p2, len) : 0;
+  }
+
+#endif // HT_FASTMEMCMP_X86
+
+  /* First call probes the CPU, installs the best kernel and tail-calls it;
+   * all subsequent calls bypass this resolver entirely.
+   */
+  int resolve_memcmp(const void *lhs, const void *rhs, size_t len) {
+#ifdef HT_FASTMEMCMP_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+      fast_memcmp = avx2_memcmp;
+    else if (__builtin_cpu_supports("sse4.2"))
+      fast_memcmp = sse42_memcmp;
+    else
+      fast_memcmp = scalar_memcmp;
+#else
+    fast_memcmp = scalar_memcmp;
+#endif
+    return fast_memcmp(lhs, rhs, len);
+  }
+
+}
+
+namespace Hypertable {
+
+  int (*fast_memcmp)(const void *lhs, const void *rhs, size_t len) =
+    resolve_memcmp;
+
+}
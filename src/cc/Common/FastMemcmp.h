@@ -0,0 +1,60 @@
+/* -*- c++ -*-
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 3 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/** @file
+ * Vectorized memory comparison.
+ * This file declares a memcmp-compatible comparison routine which is
+ * dispatched at runtime to an SSE4.2 or AVX2 kernel when the host CPU
+ * supports one.  It exists primarily to accelerate serialized key
+ * comparisons on the scan path (see Hypertable/Lib/SerializedKey.h).
+ */
+
+#ifndef Common_FastMemcmp_h
+#define Common_FastMemcmp_h
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Hypertable {
+
+  /** @addtogroup Common
+   *  @{
+   */
+
+  /** Compares two memory regions, like memcmp().
+   * The first call probes the host CPU and installs the widest available
+   * vector kernel (AVX2, then SSE4.2, then plain memcmp); subsequent calls
+   * go straight through a function pointer.  Return value carries only the
+   * sign of the difference of the first mismatching byte pair, which is
+   * all the key comparators require.
+   *
+   * @param lhs Pointer to first memory region
+   * @param rhs Pointer to second memory region
+   * @param len Number of bytes to compare
+   * @return Negative, zero or positive, as memcmp()
+   */
+  extern int (*fast_memcmp)(const void *lhs, const void *rhs, size_t len);
+
+  /** @} */
+
+}
+
+#endif // Common_FastMemcmp_h
@@ -114,6 +114,17 @@ namespace Hypertable {
       
     };
 
+    /// File range for vectored pread
+    struct ReadRange {
+      ReadRange() : offset(0), amount(0) { }
+      ReadRange(uint64_t offset, uint32_t amount)
+        : offset(offset), amount(amount) { }
+      /// File offset
+      uint64_t offset;
+      /// Amount of data to read
+      uint32_t amount;
+    };
+
     virtual ~Filesystem() { }
 
     /** Opens a file asynchronously.  Issues an open file request.  The caller
@@ -380,6 +391,45 @@ namespace Hypertable {
     virtual void decode_response_pread(EventPtr &event, const void **buffer,
                                        uint64_t *offset, uint32_t *length) = 0;
 
+    /** Reads data from a file at several positions asynchronously.
+     * Issues a preadv request, which reads all of the given ranges in one
+     * round-trip and returns them packed back-to-back, in order, in a single
+     * response.  The caller will get notified of successful completion or
+     * error via the given dispatch handler.  EOF is indicated by a short
+     * read.
+     *
+     * @param fd The open file descriptor
+     * @param ranges The ranges (offset and amount) to read
+     * @param verify_checksum Tells filesystem to perform checksum verification
+     * @param handler The dispatch handler
+     */
+    virtual void preadv(int fd, const std::vector<ReadRange> &ranges,
+                        bool verify_checksum, DispatchHandler *handler) = 0;
+
+    /** Reads data from a file at several positions.  Issues a preadv request
+     * and waits for it to complete, returning the read data packed
+     * back-to-back in range order.  EOF is indicated by a short read.
+     *
+     * @param fd The open file descriptor
+     * @param dst The destination buffer for read data
+     * @param len The size of the destination buffer; must be at least the
+     *      sum of the range amounts
+     * @param ranges The ranges (offset and amount) to read
+     * @param verify_checksum Tells filesystem to perform checksum verification
+     * @return The amount of data read (in bytes)
+     */
+    virtual size_t preadv(int fd, void *dst, size_t len,
+                          const std::vector<ReadRange> &ranges,
+                          bool verify_checksum = true) = 0;
+
+    /// Decodes the response from a preadv request.
+    /// @param event A reference to the response event
+    /// @param buffer Address of buffer pointer
+    /// @param offset Address of offset variable (offset of first range)
+    /// @param length Address of length variable (total amount read)
+    virtual void decode_response_preadv(EventPtr &event, const void **buffer,
+                                        uint64_t *offset, uint32_t *length) = 0;
+
     /** Creates a directory asynchronously.  Issues a mkdirs request which
      * creates a directory, including all its missing parents.  The caller
      * will get notified of successful completion or error via the given
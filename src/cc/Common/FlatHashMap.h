@@ -0,0 +1,419 @@
+/*
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/// @file
+/// Open-addressing hash map with SIMD control byte probing.
+/// Drop-in replacement for std::unordered_map in hot paths where the
+/// pointer chasing of chained hashing dominates lookup cost.
+
+#ifndef Common_FlatHashMap_h
+#define Common_FlatHashMap_h
+
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <new>
+#include <utility>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace Hypertable {
+
+  /// @addtogroup Common
+  /// @{
+
+  /**
+   * Open-addressing hash map storing entries inline in a flat array.
+   *
+   * A separate control byte array holds one byte of metadata per slot
+   * (empty, deleted, or the low seven bits of the entry's hash), so a probe
+   * scans 16 candidate slots with a single 16-byte comparison &mdash; via
+   * SSE2 when available, a scalar loop otherwise &mdash; and only touches
+   * the entry array on a tag match.  Compared with std::unordered_map this
+   * eliminates the per-entry node allocation and the pointer chase per
+   * probe, at the cost of iterator and reference invalidation on insert
+   * (erase invalidates nothing; the erased slot is tombstoned in place,
+   * which keeps the erase-while-iterating idiom valid).
+   *
+   * Entries are stored as std::pair<KeyT, ValueT> with a <i>non-const</i>
+   * key; callers must not modify the key of a stored entry.  The table
+   * grows by doubling at 7/8 occupancy and never shrinks.  Not thread-safe.
+   */
+  template <class KeyT, class ValueT, class HashT = std::hash<KeyT>,
+            class EqualT = std::equal_to<KeyT> >
+  class FlatHashMap {
+
+    /// Number of control bytes matched per probe
+    static const size_t GROUP_SIZE = 16;
+
+    /// Control byte for a slot that has never held an entry
+    static const uint8_t EMPTY = 0x80;
+
+    /// Control byte for an erased slot (probe sequences continue past it)
+    static const uint8_t DELETED = 0xfe;
+
+    /// Checks if a control byte marks an occupied slot (high bit clear).
+    static bool is_full(uint8_t ctrl) { return (ctrl & 0x80) == 0; }
+
+  public:
+
+    typedef KeyT key_type;
+    typedef ValueT mapped_type;
+    typedef std::pair<KeyT, ValueT> value_type;
+
+    /// Forward iterator over occupied slots (unspecified order).
+    class iterator {
+    public:
+      iterator() { }
+      value_type &operator*() const { return m_map->m_slots[m_index]; }
+      value_type *operator->() const { return &m_map->m_slots[m_index]; }
+      iterator &operator++() {
+        m_map->skip_to_full(++m_index);
+        return *this;
+      }
+      bool operator==(const iterator &other) const {
+        return m_index == other.m_index;
+      }
+      bool operator!=(const iterator &other) const {
+        return m_index != other.m_index;
+      }
+    private:
+      friend class FlatHashMap;
+      friend class const_iterator;
+      iterator(FlatHashMap *map, size_t index)
+        : m_map(map), m_index(index) { }
+      FlatHashMap *m_map {};
+      size_t m_index {};
+    };
+
+    /// Forward iterator over occupied slots of a const map.
+    class const_iterator {
+    public:
+      const_iterator() { }
+      const_iterator(const iterator &other)
+        : m_map(other.m_map), m_index(other.m_index) { }
+      const value_type &operator*() const { return m_map->m_slots[m_index]; }
+      const value_type *operator->() const { return &m_map->m_slots[m_index]; }
+      const_iterator &operator++() {
+        m_map->skip_to_full(++m_index);
+        return *this;
+      }
+      bool operator==(const const_iterator &other) const {
+        return m_index == other.m_index;
+      }
+      bool operator!=(const const_iterator &other) const {
+        return m_index != other.m_index;
+      }
+    private:
+      friend class FlatHashMap;
+      const_iterator(const FlatHashMap *map, size_t index)
+        : m_map(map), m_index(index) { }
+      const FlatHashMap *m_map {};
+      size_t m_index {};
+    };
+
+    FlatHashMap() { }
+
+    FlatHashMap(const FlatHashMap &other) {
+      reserve(other.m_size);
+      for (const_iterator iter = other.begin(); iter != other.end(); ++iter)
+        insert(*iter);
+    }
+
+    FlatHashMap &operator=(const FlatHashMap &other) {
+      if (this != &other) {
+        clear();
+        reserve(other.m_size);
+        for (const_iterator iter = other.begin(); iter != other.end(); ++iter)
+          insert(*iter);
+      }
+      return *this;
+    }
+
+    ~FlatHashMap() {
+      clear();
+      delete [] m_ctrl;
+      ::operator delete(m_slots);
+    }
+
+    iterator begin() {
+      size_t index = 0;
+      skip_to_full(index);
+      return iterator(this, index);
+    }
+    const_iterator begin() const {
+      size_t index = 0;
+      skip_to_full(index);
+      return const_iterator(this, index);
+    }
+    iterator end() { return iterator(this, m_capacity); }
+    const_iterator end() const { return const_iterator(this, m_capacity); }
+
+    size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+
+    /** Looks up an entry by key.
+     * @param key Search key
+     * @return Iterator to matching entry, or end() if not found
+     */
+    iterator find(const KeyT &key) {
+      return iterator(this, find_index(key, m_hasher(key)));
+    }
+    const_iterator find(const KeyT &key) const {
+      return const_iterator(this, find_index(key, m_hasher(key)));
+    }
+
+    size_t count(const KeyT &key) const {
+      return find_index(key, m_hasher(key)) == m_capacity ? 0 : 1;
+    }
+
+    /** Inserts an entry if no entry with an equal key exists.
+     * @param value Key/value pair to insert
+     * @return Iterator to the inserted or blocking entry, and <i>true</i>
+     * if the insert took place
+     */
+    std::pair<iterator, bool> insert(const value_type &value) {
+      size_t h = m_hasher(value.first);
+      size_t slot = find_index(value.first, h);
+      if (slot != m_capacity)
+        return std::make_pair(iterator(this, slot), false);
+      slot = prepare_insert(h);
+      new (m_slots + slot) value_type(value);
+      occupy(slot, h);
+      return std::make_pair(iterator(this, slot), true);
+    }
+
+    /** Returns a reference to the value mapped to <code>key</code>,
+     * default-constructing the entry if it does not exist.
+     */
+    ValueT &operator[](const KeyT &key) {
+      size_t h = m_hasher(key);
+      size_t slot = find_index(key, h);
+      if (slot == m_capacity) {
+        slot = prepare_insert(h);
+        new (m_slots + slot) value_type(key, ValueT());
+        occupy(slot, h);
+      }
+      return m_slots[slot].second;
+    }
+
+    /** Erases the entry at <code>iter</code>; the slot is tombstoned, so
+     * no other iterator is invalidated.
+     * @return Iterator to the next occupied slot
+     */
+    iterator erase(iterator iter) {
+      destroy_slot(iter.m_index);
+      ++iter;
+      return iter;
+    }
+
+    /** Erases the entry with key equal to <code>key</code> if it exists.
+     * @return Number of entries erased (0 or 1)
+     */
+    size_t erase(const KeyT &key) {
+      size_t slot = find_index(key, m_hasher(key));
+      if (slot == m_capacity)
+        return 0;
+      destroy_slot(slot);
+      return 1;
+    }
+
+    /// Erases all entries, retaining table memory.
+    void clear() {
+      for (size_t i = 0; i < m_capacity; i++) {
+        if (is_full(m_ctrl[i]))
+          m_slots[i].~value_type();
+      }
+      if (m_capacity) {
+        memset(m_ctrl, EMPTY, m_capacity);
+        m_growth_left = m_capacity - m_capacity / 8;
+      }
+      m_size = 0;
+    }
+
+    /// Grows the table so <code>n</code> entries fit without rehashing.
+    void reserve(size_t n) {
+      size_t capacity = GROUP_SIZE;
+      while (capacity - capacity / 8 < n)
+        capacity *= 2;
+      if (capacity > m_capacity)
+        rehash(capacity);
+    }
+
+  private:
+
+    /// Upper hash bits select the start group, low seven bits form the tag
+    size_t hash1(size_t h) const { return h >> 7; }
+    uint8_t hash2(size_t h) const { return (uint8_t)(h & 0x7f); }
+
+    /** Returns a bitmask with bit <i>i</i> set for each control byte in the
+     * 16-byte group at <code>group</code> that equals <code>byte</code>.
+     */
+    static uint32_t match_byte(const uint8_t *group, uint8_t byte) {
+#if defined(__SSE2__)
+      __m128i ctrl = _mm_loadu_si128((const __m128i *)group);
+      __m128i dup = _mm_set1_epi8((char)byte);
+      return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, dup));
+#else
+      uint32_t mask = 0;
+      for (size_t i = 0; i < GROUP_SIZE; i++) {
+        if (group[i] == byte)
+          mask |= (1u << i);
+      }
+      return mask;
+#endif
+    }
+
+    static size_t lowest_bit(uint32_t mask) {
+#if defined(__GNUC__)
+      return (size_t)__builtin_ctz(mask);
+#else
+      size_t i = 0;
+      while ((mask & 1) == 0) {
+        mask >>= 1;
+        i++;
+      }
+      return i;
+#endif
+    }
+
+    /** Locates the slot holding <code>key</code>, probing group-by-group
+     * with triangular increments (visits every group when the group count
+     * is a power of two).
+     * @return Slot index, or #m_capacity if not found
+     */
+    size_t find_index(const KeyT &key, size_t h) const {
+      if (m_size == 0)
+        return m_capacity;
+      size_t group_count = m_capacity / GROUP_SIZE;
+      size_t g = hash1(h) & (group_count - 1);
+      uint8_t tag = hash2(h);
+      for (size_t probe = 0; probe < group_count; probe++) {
+        const uint8_t *group = m_ctrl + g * GROUP_SIZE;
+        uint32_t mask = match_byte(group, tag);
+        while (mask) {
+          size_t slot = g * GROUP_SIZE + lowest_bit(mask);
+          if (m_equal(m_slots[slot].first, key))
+            return slot;
+          mask &= mask - 1;
+        }
+        // An empty slot terminates the probe sequence; deleted slots do not
+        if (match_byte(group, EMPTY))
+          return m_capacity;
+        g = (g + probe + 1) & (group_count - 1);
+      }
+      return m_capacity;
+    }
+
+    /** Finds the first reusable (empty or deleted) slot along the probe
+     * sequence of hash <code>h</code>; the table must have room.
+     */
+    size_t find_insert_slot(size_t h) const {
+      size_t group_count = m_capacity / GROUP_SIZE;
+      size_t g = hash1(h) & (group_count - 1);
+      for (size_t probe = 0; ; probe++) {
+        const uint8_t *group = m_ctrl + g * GROUP_SIZE;
+        uint32_t mask = match_byte(group, EMPTY) | match_byte(group, DELETED);
+        if (mask)
+          return g * GROUP_SIZE + lowest_bit(mask);
+        g = (g + probe + 1) & (group_count - 1);
+      }
+    }
+
+    /// Grows if necessary and returns the target slot for hash
+    /// <code>h</code>; the caller constructs the entry, then calls occupy().
+    size_t prepare_insert(size_t h) {
+      if (m_growth_left == 0)
+        rehash(m_capacity ? m_capacity * 2 : GROUP_SIZE);
+      return find_insert_slot(h);
+    }
+
+    /// Publishes a newly constructed entry by tagging its control byte.
+    void occupy(size_t slot, size_t h) {
+      if (m_ctrl[slot] == EMPTY)
+        m_growth_left--;
+      m_ctrl[slot] = hash2(h);
+      m_size++;
+    }
+
+    void destroy_slot(size_t slot) {
+      m_slots[slot].~value_type();
+      m_ctrl[slot] = DELETED;
+      m_size--;
+    }
+
+    /// Allocates a table of <code>new_capacity</code> slots (power of two,
+    /// multiple of #GROUP_SIZE) and re-inserts all entries, dropping
+    /// tombstones.
+    void rehash(size_t new_capacity) {
+      uint8_t *old_ctrl = m_ctrl;
+      value_type *old_slots = m_slots;
+      size_t old_capacity = m_capacity;
+
+      m_ctrl = new uint8_t [new_capacity];
+      memset(m_ctrl, EMPTY, new_capacity);
+      m_slots = (value_type *)::operator new(new_capacity*sizeof(value_type));
+      m_capacity = new_capacity;
+      m_growth_left = new_capacity - new_capacity / 8;
+      m_size = 0;
+
+      for (size_t i = 0; i < old_capacity; i++) {
+        if (is_full(old_ctrl[i])) {
+          size_t h = m_hasher(old_slots[i].first);
+          size_t slot = find_insert_slot(h);
+          new (m_slots + slot) value_type(std::move(old_slots[i]));
+          occupy(slot, h);
+          old_slots[i].~value_type();
+        }
+      }
+      delete [] old_ctrl;
+      ::operator delete(old_slots);
+    }
+
+    /// Advances <code>index</code> to the next occupied slot (or capacity).
+    void skip_to_full(size_t &index) const {
+      while (index < m_capacity && !is_full(m_ctrl[index]))
+        index++;
+    }
+
+    /// Control byte per slot (#EMPTY, #DELETED, or seven-bit hash tag)
+    uint8_t *m_ctrl {};
+    /// Flat entry array; slots are constructed only while occupied
+    value_type *m_slots {};
+    /// Slot count (power of two, multiple of #GROUP_SIZE; 0 until first
+    /// insert)
+    size_t m_capacity {};
+    /// Number of occupied slots
+    size_t m_size {};
+    /// Empty slots that may be consumed before the table must grow
+    size_t m_growth_left {};
+    HashT m_hasher;
+    EqualT m_equal;
+  };
+
+  /// @}
+
+}
+
+#endif // Common_FlatHashMap_h
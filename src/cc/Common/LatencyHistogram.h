@@ -0,0 +1,236 @@
+/* -*- c++ -*-
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/** @file
+ * Declarations for LatencyHistogram.
+ * This file contains the type declarations for LatencyHistogram, a
+ * fixed-size log-linear histogram for latency percentile estimation.
+ */
+
+#ifndef Common_LatencyHistogram_h
+#define Common_LatencyHistogram_h
+
+#include <atomic>
+#include <cstdint>
+
+namespace Hypertable {
+
+  /** @addtogroup Common
+   *  @{
+   */
+
+  /** Log-linear latency histogram in the style of the HDR histogram.
+   * Values (microseconds) are bucketed into power-of-two ranges, each
+   * subdivided into 32 linear sub-buckets, giving roughly 3% relative
+   * error over a range of 1 usec to over an hour with a small fixed
+   * footprint.  Samples are recorded with relaxed atomics, so hot request
+   * paths never take a lock; readers that race with writers may miss a
+   * handful of in-flight samples, which is acceptable for metrics.
+   */
+  class LatencyHistogram {
+  public:
+
+    /** Adds a latency sample.
+     * @param usec Latency in microseconds
+     */
+    void add(int64_t usec) {
+      if (usec < 0)
+        usec = 0;
+      m_counts[bucket_index((uint64_t)usec)]
+        .fetch_add(1, std::memory_order_relaxed);
+      m_total.fetch_add((uint64_t)usec, std::memory_order_relaxed);
+      m_count.fetch_add(1, std::memory_order_relaxed);
+      uint64_t observed = m_max.load(std::memory_order_relaxed);
+      while ((uint64_t)usec > observed &&
+             !m_max.compare_exchange_weak(observed, (uint64_t)usec,
+                                          std::memory_order_relaxed))
+        ;
+      observed = m_min.load(std::memory_order_relaxed);
+      while ((uint64_t)usec < observed &&
+             !m_min.compare_exchange_weak(observed, (uint64_t)usec,
+                                          std::memory_order_relaxed))
+        ;
+    }
+
+    /** Merges counts from another histogram into this one.
+     * @param other Histogram whose samples are added to this one
+     */
+    void merge(const LatencyHistogram &other) {
+      for (size_t i = 0; i < BUCKETS; i++) {
+        uint64_t count = other.m_counts[i].load(std::memory_order_relaxed);
+        if (count)
+          m_counts[i].fetch_add(count, std::memory_order_relaxed);
+      }
+      m_total.fetch_add(other.m_total.load(std::memory_order_relaxed),
+                        std::memory_order_relaxed);
+      m_count.fetch_add(other.m_count.load(std::memory_order_relaxed),
+                        std::memory_order_relaxed);
+      uint64_t other_max = other.m_max.load(std::memory_order_relaxed);
+      uint64_t observed = m_max.load(std::memory_order_relaxed);
+      while (other_max > observed &&
+             !m_max.compare_exchange_weak(observed, other_max,
+                                          std::memory_order_relaxed))
+        ;
+      uint64_t other_min = other.m_min.load(std::memory_order_relaxed);
+      observed = m_min.load(std::memory_order_relaxed);
+      while (other_min < observed &&
+             !m_min.compare_exchange_weak(observed, other_min,
+                                          std::memory_order_relaxed))
+        ;
+    }
+
+    /** Returns the latency at quantile <code>q</code> (e.g. 0.99).
+     * The returned value is the upper bound of the bucket holding the
+     * quantile, so it over-reports by at most the bucket width.
+     * @param q Quantile in the range (0, 1]
+     * @return Latency in microseconds, or 0 if no samples were recorded
+     */
+    uint64_t quantile(double q) const {
+      uint64_t count = m_count.load(std::memory_order_relaxed);
+      if (count == 0)
+        return 0;
+      uint64_t target = (uint64_t)(q * (double)count);
+      if (target >= count)
+        target = count - 1;
+      uint64_t seen = 0;
+      for (size_t i = 0; i < BUCKETS; i++) {
+        seen += m_counts[i].load(std::memory_order_relaxed);
+        if (seen > target)
+          return bucket_upper_bound(i);
+      }
+      return m_max.load(std::memory_order_relaxed);
+    }
+
+    /// Returns the number of samples recorded
+    uint64_t count() const { return m_count.load(std::memory_order_relaxed); }
+
+    /// Returns the smallest sample recorded, or 0 if there are none
+    uint64_t min() const {
+      return count() ? m_min.load(std::memory_order_relaxed) : 0;
+    }
+
+    /// Returns the largest sample recorded
+    uint64_t max() const { return m_max.load(std::memory_order_relaxed); }
+
+    /// Returns the mean latency in microseconds
+    uint64_t mean() const {
+      uint64_t count = m_count.load(std::memory_order_relaxed);
+      return count ? m_total.load(std::memory_order_relaxed) / count : 0;
+    }
+
+    /** Resets the histogram to its initial empty state. */
+    void clear() {
+      for (size_t i = 0; i < BUCKETS; i++)
+        m_counts[i].store(0, std::memory_order_relaxed);
+      m_total.store(0, std::memory_order_relaxed);
+      m_count.store(0, std::memory_order_relaxed);
+      m_min.store((uint64_t)-1, std::memory_order_relaxed);
+      m_max.store(0, std::memory_order_relaxed);
+    }
+
+    /** Estimates a latency percentile and resets the histogram.
+     * Drains the buckets with exchange operations and returns the latency
+     * value at or below which <code>fraction</code> of the accumulated
+     * samples fall.  Samples that race with the drain may be lost, which
+     * is acceptable for metrics.
+     * @param fraction Percentile to estimate, in the range (0, 1]
+     * @return Estimated latency in <i>milliseconds</i>, or 0.0 if no
+     * samples were accumulated
+     */
+    double estimate_and_reset(double fraction) {
+      uint64_t counts[BUCKETS];
+      uint64_t total = 0;
+      for (size_t i = 0; i < BUCKETS; i++) {
+        counts[i] = m_counts[i].exchange(0, std::memory_order_relaxed);
+        total += counts[i];
+      }
+      m_total.store(0, std::memory_order_relaxed);
+      m_count.store(0, std::memory_order_relaxed);
+      m_min.store((uint64_t)-1, std::memory_order_relaxed);
+      uint64_t max = m_max.exchange(0, std::memory_order_relaxed);
+      if (total == 0)
+        return 0.0;
+      uint64_t target = (uint64_t)(fraction * (double)total);
+      if (target >= total)
+        target = total - 1;
+      uint64_t seen = 0;
+      for (size_t i = 0; i < BUCKETS; i++) {
+        seen += counts[i];
+        if (seen > target)
+          return (double)bucket_upper_bound(i) / 1000.0;
+      }
+      return (double)max / 1000.0;
+    }
+
+  private:
+
+    /// Number of linear sub-bucket index bits per power-of-two range
+    static const size_t SUB_BUCKET_BITS = 5;
+
+    /// Linear sub-buckets per power-of-two range
+    static const size_t SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+
+    /// Number of power-of-two ranges
+    static const size_t RANGES = 64 - SUB_BUCKET_BITS;
+
+    /// Total bucket count
+    static const size_t BUCKETS = RANGES * SUB_BUCKETS;
+
+    /// Returns the bucket index holding <code>usec</code>
+    static size_t bucket_index(uint64_t usec) {
+      if (usec < SUB_BUCKETS)
+        return (size_t)usec;
+      size_t range = 63 - __builtin_clzll(usec) - (SUB_BUCKET_BITS - 1);
+      if (range >= RANGES)
+        range = RANGES - 1;
+      return (range * SUB_BUCKETS)
+        + (size_t)((usec >> range) & (SUB_BUCKETS - 1));
+    }
+
+    /// Returns the largest value mapping to bucket <code>index</code>
+    static uint64_t bucket_upper_bound(size_t index) {
+      size_t range = index >> SUB_BUCKET_BITS;
+      uint64_t sub = index & (SUB_BUCKETS - 1);
+      if (range == 0)
+        return sub;
+      return ((sub + 1) << range) - 1;
+    }
+
+    /// Per-bucket sample counts
+    std::atomic<uint64_t> m_counts[BUCKETS] {};
+
+    /// Sum of all samples, for mean()
+    std::atomic<uint64_t> m_total {0};
+
+    /// Number of samples recorded
+    std::atomic<uint64_t> m_count {0};
+
+    /// Smallest sample recorded
+    std::atomic<uint64_t> m_min {(uint64_t)-1};
+
+    /// Largest sample recorded
+    std::atomic<uint64_t> m_max {0};
+  };
+
+  /** @} */
+}
+
+#endif // Common_LatencyHistogram_h
@@ -100,6 +100,18 @@ class PageArena : boost::noncopyable {
     }
   };
 
+  /** Slab size class parameters for the optional freed chunk reuse mode */
+  enum {
+    SLAB_GRANULARITY = 8,
+    SLAB_MAX = 1024,
+    NUM_SLAB_CLASSES = SLAB_MAX / SLAB_GRANULARITY
+  };
+
+  /** Freed chunk banked for reuse; the chunk's own memory holds the link */
+  struct FreeChunk {
+    FreeChunk *next;
+  };
+
  private: // data
   Page *m_cur_page;
   size_t m_used;        /** total number of bytes allocated by users */
@@ -107,8 +119,13 @@ class PageArena : boost::noncopyable {
   size_t m_page_size;   /** page size in number of bytes */
   size_t m_pages;       /** number of pages allocated */
   size_t m_total;       /** total number of bytes occupied by pages */
+  size_t m_freed;       /** bytes banked in slab free lists */
+  bool m_reuse_freed;   /** slab-class reuse of freed chunks enabled */
   PageAllocatorT m_page_allocator;
 
+  /** per-class free lists of chunks returned with free_chunk() */
+  FreeChunk *m_free_lists[NUM_SLAB_CLASSES + 1];
+
   /** predicate which sorts by size */
   struct LtPageRemain {
     bool operator()(const Page* p1, const Page*p2) const {
@@ -180,6 +197,71 @@ class PageArena : boost::noncopyable {
     return p->alloc(sz);
   }
 
+  /** Size class of a chunk of @a sz bytes (valid for sz <= SLAB_MAX) */
+  static size_t slab_class(size_t sz) {
+    return (sz + SLAB_GRANULARITY - 1) / SLAB_GRANULARITY;
+  }
+
+  /** Chunk capacity of size class @a k */
+  static size_t slab_size(size_t k) {
+    return k * SLAB_GRANULARITY;
+  }
+
+  /** Allocates @a sz bytes from the pages, bypassing the tiny buffer */
+  CharT *alloc_from_pages(size_t sz) {
+    ensure_cur_page();
+
+    if (m_gappy_limit >= sz) {
+      Page f((const char*)sz);
+      f.alloc_end = 0;
+      typename GappyPages::iterator it = m_gappy_pages.lower_bound(&f);
+      Page* page = *it;
+      CharT *p = page->alloc(sz);
+      m_gappy_pages.erase(it);
+      if (page->remain() >= TinyBuffer::SIZE) {
+        m_gappy_pages.insert(page);
+      }
+      m_gappy_limit = m_gappy_pages.size()
+          ? (*m_gappy_pages.rbegin())->remain()
+          : 0;
+      return p;
+    }
+
+    // common case
+    if (HT_LIKELY(sz <= m_cur_page->remain()))
+      return m_cur_page->alloc(sz);
+
+    if (is_normal_overflow(sz)) {
+      if (m_cur_page->remain() >= TinyBuffer::SIZE) {
+        m_gappy_pages.insert(m_cur_page);
+        m_gappy_limit = (*m_gappy_pages.rbegin())->remain();
+      }
+      m_cur_page = alloc_page(m_page_size);
+      return m_cur_page->alloc(sz);
+    }
+    return alloc_big(sz);
+  }
+
+  /** Allocates @a sz bytes in reuse mode.  Requests are rounded up to a
+   * size class so that a chunk banked by free_chunk() has the full
+   * capacity of its class; a banked chunk is reused when available,
+   * otherwise the class-sized chunk comes from the pages.  The tiny
+   * buffer is bypassed since its chunks are not class sized.
+   */
+  CharT *alloc_slab(size_t sz) {
+    m_used += sz;
+    if (HT_UNLIKELY(sz > SLAB_MAX))
+      return alloc_from_pages(sz);
+    size_t k = slab_class(sz);
+    if (m_free_lists[k]) {
+      FreeChunk *chunk = m_free_lists[k];
+      m_free_lists[k] = chunk->next;
+      m_freed -= slab_size(k);
+      return (CharT *)chunk;
+    }
+    return alloc_from_pages(slab_size(k));
+  }
+
  public:
   /** Constructor; creates a new PageArena
    *
@@ -189,9 +271,13 @@ class PageArena : boost::noncopyable {
   PageArena(size_t page_size = DEFAULT_PAGE_SIZE,
           const PageAllocatorT &alloc = PageAllocatorT())
     : m_cur_page(0), m_used(0), m_page_limit(0), m_page_size(page_size),
-      m_pages(0), m_total(0), m_page_allocator(alloc), m_gappy_limit(0) {
+      m_pages(0), m_total(0), m_freed(0), m_reuse_freed(false),
+      m_page_allocator(alloc), m_gappy_limit(0) {
     BOOST_STATIC_ASSERT(sizeof(CharT) == 1);
+    BOOST_STATIC_ASSERT(SLAB_GRANULARITY >= sizeof(FreeChunk));
     HT_ASSERT(page_size > sizeof(Page));
+    std::fill(m_free_lists, m_free_lists + NUM_SLAB_CLASSES + 1,
+              (FreeChunk *)0);
   }
 
   /** Destructor releases the whole memory and invalidates all allocated
@@ -214,41 +300,45 @@ class PageArena : boost::noncopyable {
 
   /** Allocate sz bytes */
   CharT *alloc(size_t sz) {
+    if (HT_UNLIKELY(m_reuse_freed))
+      return alloc_slab(sz);
     CharT *tiny;
     if ((tiny = m_tinybuf.alloc(sz)))
       return tiny;
     m_used += sz;
-    ensure_cur_page();
-
-    if (m_gappy_limit >= sz) {
-      Page f((const char*)sz);
-      f.alloc_end = 0;
-      typename GappyPages::iterator it = m_gappy_pages.lower_bound(&f);
-      Page* page = *it;
-      CharT *p = page->alloc(sz);
-      m_gappy_pages.erase(it);
-      if (page->remain() >= TinyBuffer::SIZE) {
-        m_gappy_pages.insert(page);
-      }
-      m_gappy_limit = m_gappy_pages.size()
-          ? (*m_gappy_pages.rbegin())->remain()
-          : 0;
-      return p;
-    }
+    return alloc_from_pages(sz);
+  }
 
-    // common case
-    if (HT_LIKELY(sz <= m_cur_page->remain()))
-      return m_cur_page->alloc(sz);
+  /** Enables slab-class reuse of freed chunks.  In this mode allocations
+   * are rounded up to a small size class and chunks returned with
+   * free_chunk() are banked on per-class free lists and handed out again
+   * by subsequent allocations, instead of remaining unreachable until
+   * the whole arena drops.  Must be enabled before chunks that will
+   * later be freed are allocated; chunks allocated before enabling the
+   * mode must never be passed to free_chunk().
+   */
+  void set_reuse_freed(bool reuse_freed = true) {
+    m_reuse_freed = reuse_freed;
+  }
 
-    if (is_normal_overflow(sz)) {
-      if (m_cur_page->remain() >= TinyBuffer::SIZE) {
-        m_gappy_pages.insert(m_cur_page);
-        m_gappy_limit = (*m_gappy_pages.rbegin())->remain();
-      }
-      m_cur_page = alloc_page(m_page_size);
-      return m_cur_page->alloc(sz);
-    }
-    return alloc_big(sz);
+  /** Returns a chunk previously obtained from alloc() in reuse mode to
+   * the arena for reuse.  The caller must pass the same size it
+   * allocated and must guarantee no other reference to the chunk
+   * remains.  A no-op when reuse mode is off or the chunk is larger
+   * than the largest size class.
+   *
+   * @param p Pointer to the chunk
+   * @param sz Size the chunk was allocated with
+   */
+  void free_chunk(void *p, size_t sz) {
+    if (!m_reuse_freed || sz > SLAB_MAX)
+      return;
+    size_t k = slab_class(sz);
+    FreeChunk *chunk = (FreeChunk *)p;
+    chunk->next = m_free_lists[k];
+    m_free_lists[k] = chunk;
+    m_used -= sz;
+    m_freed += slab_size(k);
   }
 
   /** Realloc for newsz bytes */
@@ -318,11 +408,13 @@ class PageArena : boost::noncopyable {
       m_page_allocator.deallocate(page);
     }
     m_page_allocator.freed(m_total);
-    m_pages = m_total = m_used = 0;
+    m_pages = m_total = m_used = m_freed = 0;
 
     m_tinybuf = TinyBuffer();
     m_gappy_pages.clear();
     m_gappy_limit = 0;
+    std::fill(m_free_lists, m_free_lists + NUM_SLAB_CLASSES + 1,
+              (FreeChunk *)0);
   }
 
   /** Efficiently swaps the state with another allocator */
@@ -333,9 +425,13 @@ class PageArena : boost::noncopyable {
     std::swap(m_pages, other.m_pages);
     std::swap(m_total, other.m_total);
     std::swap(m_used, other.m_used);
+    std::swap(m_freed, other.m_freed);
+    std::swap(m_reuse_freed, other.m_reuse_freed);
     std::swap(m_tinybuf, other.m_tinybuf);
     std::swap(m_gappy_pages, other.m_gappy_pages);
     std::swap(m_gappy_limit, other.m_gappy_limit);
+    std::swap_ranges(m_free_lists, m_free_lists + NUM_SLAB_CLASSES + 1,
+                     other.m_free_lists);
   }
 
  /// Write allocator statistics to output stream.
@@ -344,12 +440,17 @@ class PageArena : boost::noncopyable {
   std::ostream& dump_stat(std::ostream& out) const {
     out << "pages=" << m_pages << ", total=" << m_total << ", used=" << m_used
         << "(" << m_used * 100. / m_total << "%)";
+    if (m_reuse_freed)
+      out << ", freed=" << m_freed;
     return out;
   }
 
   /** Statistic accessors - returns used bytes */
   size_t used() const { return m_used + m_tinybuf.fill; }
 
+  /** Statistic accessors - returns bytes banked in slab free lists */
+  size_t freed() const { return m_freed; }
+
   /** Statistic accessors - returns number of allocated pages */
   size_t pages() const { return m_pages; }
 
@@ -0,0 +1,76 @@
+/*
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/** @file
+ * Sampled request tracing.
+ * This file contains the method definitions of the RequestTracer class.
+ */
+
+#include "Common/Compat.h"
+#include "Common/RequestTracer.h"
+#include "Common/Time.h"
+
+using namespace Hypertable;
+
+RequestTracer *RequestTracer::instance = 0;
+
+RequestTracer::RequestTracer(uint32_t sampling_period, size_t capacity)
+  : m_ring(capacity), m_sampling_period(sampling_period) {
+}
+
+uint32_t RequestTracer::sample() {
+  if (m_sampling_period == 0)
+    return 0;
+  if (m_request_count.fetch_add(1, std::memory_order_relaxed)
+      % m_sampling_period)
+    return 0;
+  uint32_t id = ++m_next_id;
+  if (id == 0)  // 0 means "not traced"
+    id = ++m_next_id;
+  return id;
+}
+
+void RequestTracer::record(uint32_t trace_id, const char *span,
+                           int64_t duration_us) {
+  if (trace_id == 0)
+    return;
+  // A record being overwritten concurrently with dump() can produce a torn
+  // line in the output; tolerated in exchange for lock-free recording
+  SpanRecord &rec =
+    m_ring[m_next_slot.fetch_add(1, std::memory_order_relaxed)
+           % m_ring.size()];
+  rec.timestamp_ns = get_ts64();
+  rec.duration_us = duration_us;
+  rec.span = span;
+  rec.trace_id = trace_id;
+}
+
+void RequestTracer::dump(std::ostream &os) {
+  uint64_t end = m_next_slot.load();
+  uint64_t start = (end > m_ring.size()) ? end - m_ring.size() : 0;
+  for (uint64_t slot = start; slot < end; slot++) {
+    SpanRecord &rec = m_ring[slot % m_ring.size()];
+    if (rec.span == 0)
+      continue;
+    os << rec.timestamp_ns << "\ttrace=" << rec.trace_id << "\t" << rec.span
+       << "\t" << rec.duration_us << " us\n";
+  }
+}
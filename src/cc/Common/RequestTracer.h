@@ -0,0 +1,121 @@
+/* -*- c++ -*-
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/** @file
+ * Sampled request tracing.
+ * A low overhead mechanism for recording timestamped span records for a
+ * sampled subset of requests into a fixed-size in-memory ring buffer.
+ */
+
+#ifndef Common_RequestTracer_h
+#define Common_RequestTracer_h
+
+#include <atomic>
+#include <iostream>
+#include <vector>
+
+namespace Hypertable {
+
+  /** @addtogroup Common
+   *  @{
+   */
+
+  /** Records timestamped span durations for sampled requests.
+   * Every Nth request (see sample()) is assigned a trace ID, and code along
+   * the request path records named spans against that ID with record().
+   * Span records land in a fixed-size ring buffer with a single atomic
+   * fetch-add per record, so recording is cheap enough to leave enabled in
+   * production; unsampled requests pay only a counter increment.  The ring
+   * contents can be written out with dump(), typically wired to an
+   * administrative dump command.
+   */
+  class RequestTracer {
+  public:
+
+    /** This is a singleton class; when tracing is enabled the instance is
+     * allocated at startup:
+     *
+     *     if (RequestTracer::instance == 0)
+     *       RequestTracer::instance = new RequestTracer(sampling_period);
+     */
+    static RequestTracer *instance;
+
+    /** Returns true if tracing is enabled (= if an instance was allocated) */
+    static bool enabled() { return instance != 0; }
+
+    /** Constructor.
+     * @param sampling_period Trace one request out of this many (0 disables
+     * sampling; requests carrying a trace ID assigned elsewhere are still
+     * recorded)
+     * @param capacity Number of span records held in the ring buffer
+     */
+    RequestTracer(uint32_t sampling_period, size_t capacity = 65536);
+
+    /** Samples the request stream.
+     * @return A fresh non-zero trace ID for one request out of every
+     * sampling period, 0 otherwise
+     */
+    uint32_t sample();
+
+    /** Records a span against a trace.
+     * @param trace_id Trace ID the span belongs to (no-op if 0)
+     * @param span Span name; must point to a string literal or other
+     * storage that outlives the tracer
+     * @param duration_us Span duration in microseconds
+     */
+    void record(uint32_t trace_id, const char *span, int64_t duration_us);
+
+    /** Writes the ring buffer contents to <code>os</code>, oldest record
+     * first, one span per line.
+     */
+    void dump(std::ostream &os);
+
+  private:
+
+    /** A single timestamped span record */
+    struct SpanRecord {
+      int64_t timestamp_ns {};   //!< Wall clock time the span ended
+      int64_t duration_us {};    //!< Span duration in microseconds
+      const char *span {};       //!< Span name
+      uint32_t trace_id {};      //!< Owning trace ID
+    };
+
+    /// Ring buffer of span records
+    std::vector<SpanRecord> m_ring;
+
+    /// Next ring buffer slot to overwrite (monotonic, taken modulo capacity)
+    std::atomic<uint64_t> m_next_slot {0};
+
+    /// Requests seen by sample()
+    std::atomic<uint64_t> m_request_count {0};
+
+    /// Last trace ID handed out
+    std::atomic<uint32_t> m_next_id {0};
+
+    /// Trace one request out of this many (0 = never)
+    uint32_t m_sampling_period {};
+  };
+
+  /** @}*/
+
+}
+
+#endif // Common_RequestTracer_h
@@ -173,7 +173,12 @@ namespace Hypertable { namespace Serialization {
    * @return The number of bytes required for serializing this number
    */
   inline int encoded_length_vi32(uint32_t val) {
+#ifdef __GNUC__
+    // branch-free: one 7-bit group per significant 7 bits
+    return (38 - __builtin_clz(val | 1)) / 7;
+#else
     return HT_ENCODED_LEN_VI32(val);
+#endif
   }
 
   /**
@@ -183,7 +188,12 @@ namespace Hypertable { namespace Serialization {
    * @return The number of bytes required for serializing this number
    */
   inline int encoded_length_vi64(uint64_t val) {
+#ifdef __GNUC__
+    // branch-free: one 7-bit group per significant 7 bits
+    return (70 - __builtin_clzll(val | 1)) / 7;
+#else
     return HT_ENCODED_LEN_VI64(val);
+#endif
   }
 
   /**
@@ -193,6 +203,11 @@ namespace Hypertable { namespace Serialization {
    * @param val The value to encode
    */
   inline void encode_vi32(uint8_t **bufp, uint32_t val) {
+    // Nearly all length prefixes fit in one byte
+    if (HT_LIKELY(val <= 0x7f)) {
+      *(*bufp)++ = (uint8_t)val;
+      return;
+    }
     HT_ENCODE_VI32(*bufp, val, return);
   }
 
@@ -203,6 +218,11 @@ namespace Hypertable { namespace Serialization {
    * @param val The value to encode
    */
   inline void encode_vi64(uint8_t **bufp, uint64_t val) {
+    // Nearly all length prefixes fit in one byte
+    if (HT_LIKELY(val <= 0x7f)) {
+      *(*bufp)++ = (uint8_t)val;
+      return;
+    }
     HT_ENCODE_VI64(*bufp, val, return);
   }
 
@@ -214,6 +234,34 @@ namespace Hypertable { namespace Serialization {
    * @return The decoded value
    */
   inline uint32_t decode_vi32(const uint8_t **bufp, size_t *remainp) {
+    const uint8_t *ptr = *bufp;
+    // Nearly all length prefixes fit in one byte
+    if (HT_LIKELY(*remainp >= 1 && !(ptr[0] & 0x80))) {
+      *bufp = ptr + 1;
+      (*remainp)--;
+      return ptr[0];
+    }
+#ifdef HT_LITTLE_ENDIAN
+    // Word-at-a-time path: a single unaligned load followed by in-register
+    // extraction replaces the byte-loop's per-byte loads and branches
+    if (*remainp >= 8) {
+      uint64_t word;
+      memcpy(&word, ptr, 8);
+      uint32_t val = word & 0x7f;
+      size_t len = 1;
+      while ((word & 0x80) && len < 5) {
+        word >>= 8;
+        val |= (uint32_t)(word & 0x7f) << (7 * len);
+        len++;
+      }
+      if (HT_LIKELY(!(word & 0x80))) {
+        *bufp = ptr + len;
+        *remainp -= len;
+        return val;
+      }
+      // oversized encoding; fall through to the byte-loop
+    }
+#endif
     uint32_t n;
     HT_DECODE_VI32(*bufp, *remainp, n, return n);
   }
@@ -226,6 +274,33 @@ namespace Hypertable { namespace Serialization {
    * @return The decoded value
    */
   inline uint64_t decode_vi64(const uint8_t **bufp, size_t *remainp) {
+    const uint8_t *ptr = *bufp;
+    // Nearly all length prefixes fit in one byte
+    if (HT_LIKELY(*remainp >= 1 && !(ptr[0] & 0x80))) {
+      *bufp = ptr + 1;
+      (*remainp)--;
+      return ptr[0];
+    }
+#ifdef HT_LITTLE_ENDIAN
+    // Word-at-a-time path covering values up to 56 bits (8 encoded bytes);
+    // longer encodings fall through to the byte-loop
+    if (*remainp >= 8) {
+      uint64_t word;
+      memcpy(&word, ptr, 8);
+      uint64_t val = word & 0x7f;
+      size_t len = 1;
+      while ((word & 0x80) && len < 8) {
+        word >>= 8;
+        val |= (word & 0x7f) << (7 * len);
+        len++;
+      }
+      if (HT_LIKELY(!(word & 0x80))) {
+        *bufp = ptr + len;
+        *remainp -= len;
+        return val;
+      }
+    }
+#endif
     uint64_t n;
     HT_DECODE_VI64(*bufp, *remainp, n, return n);
   }
@@ -57,6 +57,11 @@ namespace Hypertable {
     class SockAddrMap : public std::unordered_map<addr, TypeT, SockAddrHash, SockAddrEqual> {
   };
 
+  /// Unordered multimap specialization for InetAddr keys.
+  template<typename TypeT, typename addr = InetAddr>
+    class SockAddrMultiMap : public std::unordered_multimap<addr, TypeT, SockAddrHash, SockAddrEqual> {
+  };
+
   /// @}
 
 } // namespace Hypertable
@@ -27,6 +27,7 @@
 #ifndef Common_StaticBuffer_h
 #define Common_StaticBuffer_h
 
+#include "AlignedBufferPool.h"
 #include "DynamicBuffer.h"
 #include "Logger.h"
 
@@ -51,8 +52,8 @@ namespace Hypertable {
 
     /** Constructor.
      * Allocates a new buffer of size <code>len</code>. If
-     * <code>alignment</code> is non-zero, then the posix_memalign() function
-     * will be called to obtain memory and #alignment is set to
+     * <code>alignment</code> is non-zero, then aligned memory is obtained
+     * from the AlignedBufferPool and #alignment is set to
      * <code>alignment</code>.  Memory will be released when going out of scope.
      *
      * @param len The size of the new buffer, in bytes
@@ -60,13 +61,9 @@ namespace Hypertable {
      */
     explicit StaticBuffer(size_t len, size_t alignment=0)
       : alignment(alignment), size(len), own(true) {
-      if (alignment > 0) {
-        void *vptr = 0;
-        size_t aligned_len = (len % alignment) == 0 ? len :
-          ((len / alignment)+1)*alignment;
-        HT_ASSERT(posix_memalign(&vptr, alignment, aligned_len) == 0);
-        base = (uint8_t *)vptr;
-      }
+      if (alignment > 0)
+        base = (uint8_t *)AlignedBufferPool::instance().allocate(alignment,
+                                                                 len);
       else
         base = new uint8_t[len];
     }
@@ -180,12 +177,13 @@ namespace Hypertable {
       alignment = 0;
     }
 
-    /** Clears the data; if this object is owner of the data then the allocated
-     * buffer is delete[]d */
+    /** Clears the data; if this object is owner of the data then the
+     * allocated buffer is returned to the AlignedBufferPool (if aligned) or
+     * delete[]d */
     void free() {
       if (own && base) {
         if (alignment > 0)
-          ::free(base);
+          AlignedBufferPool::instance().release(base);
         else
           delete [] base;
       }
@@ -0,0 +1,156 @@
+/*
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 3 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/// @file
+/// Definitions for ThreadActivity.
+/// This file contains definitions for ThreadActivity, a registry of named
+/// worker threads and their current activity.
+
+#include <Common/Compat.h>
+
+#include "ThreadActivity.h"
+
+#include <Common/Logger.h>
+#include <Common/Time.h>
+
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+
+#include <pthread.h>
+#include <unistd.h>
+
+using namespace Hypertable;
+
+ThreadActivity::Slot ThreadActivity::ms_slots[ThreadActivity::MAX_SLOTS];
+std::atomic<int> ThreadActivity::ms_slot_count {0};
+
+namespace {
+  thread_local ThreadActivity::Slot *my_slot;
+}
+
+void ThreadActivity::register_self(const char *name) {
+  char buf[16];
+
+  strncpy(buf, name, sizeof(buf)-1);
+  buf[sizeof(buf)-1] = '\0';
+#if defined(__APPLE__)
+  pthread_setname_np(buf);
+#elif defined(__linux__)
+  pthread_setname_np(pthread_self(), buf);
+#endif
+
+  int index = ms_slot_count.fetch_add(1);
+  if (index >= MAX_SLOTS) {
+    HT_WARNF("Thread activity registry full (%d slots); thread '%s' will "
+             "not be tracked", (int)MAX_SLOTS, name);
+    return;
+  }
+  Slot &slot = ms_slots[index];
+  memcpy(slot.name, buf, sizeof(slot.name));
+  slot.detail[0] = '\0';
+  slot.activity = 0;
+  slot.start_ns = 0;
+  slot.in_use.store(true, std::memory_order_release);
+  my_slot = &slot;
+}
+
+void ThreadActivity::set(const char *activity, const char *detail) {
+  if (my_slot == 0)
+    return;
+  if (detail) {
+    strncpy(my_slot->detail, detail, DETAIL_MAX-1);
+    my_slot->detail[DETAIL_MAX-1] = '\0';
+  }
+  else
+    my_slot->detail[0] = '\0';
+  my_slot->start_ns = get_ts64();
+  my_slot->activity = activity;
+}
+
+void ThreadActivity::clear() {
+  if (my_slot)
+    my_slot->activity = 0;
+}
+
+void ThreadActivity::dump(std::ostream &out) {
+  int64_t now_ns = get_ts64();
+  int count = ms_slot_count.load();
+
+  if (count > MAX_SLOTS)
+    count = MAX_SLOTS;
+  for (int i=0; i<count; i++) {
+    Slot &slot = ms_slots[i];
+    if (!slot.in_use.load(std::memory_order_acquire))
+      continue;
+    const char *activity = slot.activity;
+    if (activity)
+      out << "  " << slot.name << " " << activity << " " << slot.detail
+          << " (" << (now_ns - slot.start_ns) / 1000000LL << " ms)\n";
+    else
+      out << "  " << slot.name << " idle\n";
+  }
+}
+
+void ThreadActivity::signal_handler(int signo) {
+  // Runs in signal context; restricted to snprintf() and write() so a dump
+  // can be taken even when the process is wedged
+  char line[128];
+  struct timespec ts;
+  int n;
+
+  (void)signo;
+  clock_gettime(CLOCK_REALTIME, &ts);
+  int64_t now_ns = (int64_t)ts.tv_sec * 1000000000LL + (int64_t)ts.tv_nsec;
+
+  n = snprintf(line, sizeof(line), "Thread activity dump:\n");
+  if (write(1, line, n) < 0)
+    return;
+
+  int count = ms_slot_count.load();
+  if (count > MAX_SLOTS)
+    count = MAX_SLOTS;
+  for (int i=0; i<count; i++) {
+    Slot &slot = ms_slots[i];
+    if (!slot.in_use.load(std::memory_order_acquire))
+      continue;
+    const char *activity = slot.activity;
+    if (activity)
+      n = snprintf(line, sizeof(line), "  %-15s %s %s (%lld ms)\n",
+                   slot.name, activity, slot.detail,
+                   (long long)((now_ns - slot.start_ns) / 1000000LL));
+    else
+      n = snprintf(line, sizeof(line), "  %-15s idle\n", slot.name);
+    if (write(1, line, n) < 0)
+      return;
+  }
+}
+
+void ThreadActivity::install_signal_handler() {
+  struct sigaction sa;
+
+  memset(&sa, 0, sizeof(sa));
+  sa.sa_handler = ThreadActivity::signal_handler;
+  sigemptyset(&sa.sa_mask);
+  sa.sa_flags = SA_RESTART;
+  sigaction(SIGUSR1, &sa, 0);
+}
@@ -0,0 +1,115 @@
+/* -*- c++ -*-
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 3 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/// @file
+/// Declarations for ThreadActivity.
+/// This file contains declarations for ThreadActivity, a registry of named
+/// worker threads and their current activity.
+
+#ifndef Common_ThreadActivity_h
+#define Common_ThreadActivity_h
+
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+
+namespace Hypertable {
+
+  /// @addtogroup Common
+  /// @{
+
+  /// Registry of named worker threads and their current activity.
+  /// Worker threads call register_self() once at startup, which names the
+  /// calling thread for sampling profilers (pthread_setname_np) and claims a
+  /// slot in a fixed-size registry, and then bracket each unit of work with
+  /// set() and clear().  A signal handler installed with
+  /// install_signal_handler() walks the registry and writes one line per
+  /// thread (name, current activity, detail and elapsed time) to the server
+  /// log, so a production stall can be attributed without attaching a
+  /// debugger.  Slot fields are written without synchronization by their
+  /// owning thread; a dump taken concurrently can observe a torn record,
+  /// which is tolerated since dumps are diagnostic only.
+  class ThreadActivity {
+  public:
+
+    /// Maximum number of threads tracked
+    static const int MAX_SLOTS = 256;
+
+    /// Maximum activity detail length, including terminating null
+    static const int DETAIL_MAX = 64;
+
+    /// Per-thread activity record.
+    struct Slot {
+      /// Thread name as passed to register_self()
+      char name[16];
+      /// Description of current unit of work (e.g. range name)
+      char detail[DETAIL_MAX];
+      /// Current activity (string literal), or 0 if thread is idle
+      const char *activity;
+      /// Start time of current activity (nanoseconds since Epoch)
+      int64_t start_ns;
+      /// <i>true</i> if slot has been claimed by a thread
+      std::atomic<bool> in_use;
+    };
+
+    /// Names the calling thread and claims an activity slot for it.
+    /// The name is truncated to 15 characters, the kernel limit for
+    /// pthread_setname_np().  If the registry is full, the thread is still
+    /// named but its activity is not tracked.
+    /// @param name Thread name
+    static void register_self(const char *name);
+
+    /// Marks the calling thread busy with <code>activity</code>.
+    /// @param activity Activity description; must be a string literal (or
+    /// otherwise outlive the activity) since only the pointer is stored
+    /// @param detail Optional detail, copied and truncated to #DETAIL_MAX
+    static void set(const char *activity, const char *detail = 0);
+
+    /// Marks the calling thread idle.
+    static void clear();
+
+    /// Writes one line per registered thread to <code>out</code>.
+    /// @param out Output stream
+    static void dump(std::ostream &out);
+
+    /// Installs a SIGUSR1 handler that dumps per-thread activity.
+    /// The handler writes to file descriptor 1 (where the server log goes
+    /// when run under the standard start scripts) using only snprintf() and
+    /// write(), so a dump can be taken even when the process is wedged.
+    static void install_signal_handler();
+
+  private:
+
+    /// SIGUSR1 handler; writes one line per registered thread.
+    /// @param signo Signal number (unused)
+    static void signal_handler(int signo);
+
+    /// Thread activity slots
+    static Slot ms_slots[MAX_SLOTS];
+
+    /// Number of slots claimed so far
+    static std::atomic<int> ms_slot_count;
+  };
+
+  /// @}
+}
+
+#endif // Common_ThreadActivity_h
@@ -0,0 +1,145 @@
+/*
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 3 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/// @file
+/// Definitions for ThreadAffinity.
+/// This file contains definitions for ThreadAffinity, a registry mapping
+/// thread pool roles to the CPU cores their threads are pinned to.
+
+#include <Common/Compat.h>
+
+#include "ThreadAffinity.h"
+
+#include <Common/Error.h>
+#include <Common/Logger.h>
+
+#include <cstdlib>
+#include <cstring>
+
+#include <pthread.h>
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
+using namespace Hypertable;
+
+std::vector<ThreadAffinity::Role> ThreadAffinity::ms_roles;
+std::mutex ThreadAffinity::ms_mutex;
+
+
+std::vector<int> ThreadAffinity::parse_cpu_list(const String &spec) {
+  std::vector<int> cpus;
+  const char *ptr = spec.c_str();
+  char *end;
+
+  while (*ptr) {
+    long first = strtol(ptr, &end, 10);
+    if (end == ptr || first < 0)
+      HT_THROWF(Error::CONFIG_BAD_VALUE, "Invalid CPU list '%s'",
+                spec.c_str());
+    long last = first;
+    ptr = end;
+    if (*ptr == '-') {
+      ptr++;
+      last = strtol(ptr, &end, 10);
+      if (end == ptr || last < first)
+        HT_THROWF(Error::CONFIG_BAD_VALUE, "Invalid CPU list '%s'",
+                  spec.c_str());
+      ptr = end;
+    }
+    for (long cpu = first; cpu <= last; cpu++)
+      cpus.push_back((int)cpu);
+    if (*ptr == ',')
+      ptr++;
+    else if (*ptr)
+      HT_THROWF(Error::CONFIG_BAD_VALUE, "Invalid CPU list '%s'",
+                spec.c_str());
+  }
+  if (cpus.empty())
+    HT_THROWF(Error::CONFIG_BAD_VALUE, "Empty CPU list '%s'", spec.c_str());
+  return cpus;
+}
+
+
+void ThreadAffinity::add_role(const char *prefix, const String &spec) {
+  if (spec.empty())
+    return;
+
+#if !defined(__linux__)
+  HT_WARNF("CPU affinity configured for '%s' but thread pinning is not "
+           "supported on this platform", prefix);
+  return;
+#endif
+
+  Role role;
+  role.prefix = prefix;
+
+  size_t base = 0;
+  while (base <= spec.length()) {
+    size_t sep = spec.find(';', base);
+    if (sep == String::npos)
+      sep = spec.length();
+    role.groups.push_back(parse_cpu_list(spec.substr(base, sep - base)));
+    base = sep + 1;
+  }
+
+  ms_roles.push_back(role);
+}
+
+
+void ThreadAffinity::bind_self(const char *name) {
+#if defined(__linux__)
+  std::vector<int> *cpus = 0;
+
+  {
+    std::lock_guard<std::mutex> lock(ms_mutex);
+    for (auto &role : ms_roles) {
+      if (!strncmp(name, role.prefix.c_str(), role.prefix.length())) {
+        cpus = &role.groups[role.next_group % role.groups.size()];
+        role.next_group++;
+        break;
+      }
+    }
+  }
+
+  if (cpus == 0)
+    return;
+
+  cpu_set_t cpu_set;
+  String printable;
+
+  CPU_ZERO(&cpu_set);
+  for (int cpu : *cpus) {
+    CPU_SET(cpu, &cpu_set);
+    printable += printable.empty() ? format("%d", cpu) : format(",%d", cpu);
+  }
+
+  int error = pthread_setaffinity_np(pthread_self(), sizeof(cpu_set),
+                                     &cpu_set);
+  if (error)
+    HT_WARNF("Unable to pin thread '%s' to CPUs %s - %s", name,
+             printable.c_str(), strerror(error));
+  else
+    HT_INFOF("Pinned thread '%s' to CPUs %s", name, printable.c_str());
+#else
+  (void)name;
+#endif
+}
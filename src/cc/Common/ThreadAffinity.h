@@ -0,0 +1,104 @@
+/* -*- c++ -*-
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 3 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/// @file
+/// Declarations for ThreadAffinity.
+/// This file contains declarations for ThreadAffinity, a registry mapping
+/// thread pool roles to the CPU cores their threads are pinned to.
+
+#ifndef Common_ThreadAffinity_h
+#define Common_ThreadAffinity_h
+
+#include <Common/String.h>
+
+#include <mutex>
+#include <vector>
+
+namespace Hypertable {
+
+  /// @addtogroup Common
+  /// @{
+
+  /// Registry mapping thread pool roles to CPU cores.
+  /// The server configures the registry once at startup, before any thread
+  /// pools are created, by calling add_role() with a role name prefix and a
+  /// CPU list specification.  Pool threads then call bind_self() with their
+  /// thread name (the same name passed to ThreadActivity::register_self())
+  /// as they start, and are pinned to the CPUs of the matching role.
+  ///
+  /// A CPU list specification is a comma-separated list of CPU numbers and
+  /// ranges (e.g. <code>"0-3,8"</code>), optionally split into groups with
+  /// <code>';'</code>.  Threads of a role are assigned to its groups round
+  /// robin, so <code>"2;3"</code> pins each of two reactor threads to its
+  /// own core while <code>"0-7;8-15"</code> partitions a worker pool across
+  /// two sockets.  A single group confines the whole pool to that CPU set.
+  ///
+  /// Pinning is only supported on Linux; on other platforms a configured
+  /// role logs a warning and bind_self() is a no-op.
+  class ThreadAffinity {
+  public:
+
+    /// Registers a role and the CPUs its threads are pinned to.
+    /// An empty <code>spec</code> is ignored, so unset configuration
+    /// properties can be passed through directly.  Must be called before
+    /// the role's threads start; not thread-safe against bind_self().
+    /// @param prefix Role name prefix matched against thread names
+    /// @param spec CPU list specification (see class description)
+    /// @throws Exception with Error::CONFIG_BAD_VALUE if <code>spec</code>
+    /// cannot be parsed
+    static void add_role(const char *prefix, const String &spec);
+
+    /// Pins the calling thread to the CPUs of the role matching
+    /// <code>name</code>.
+    /// Does nothing if no registered role prefix matches.
+    /// @param name Thread name
+    static void bind_self(const char *name);
+
+  private:
+
+    /// Parses a comma-separated list of CPU numbers and ranges.
+    /// @param spec CPU list (e.g. <code>"0-3,8"</code>)
+    /// @return Vector of CPU numbers
+    /// @throws Exception with Error::CONFIG_BAD_VALUE if <code>spec</code>
+    /// cannot be parsed
+    static std::vector<int> parse_cpu_list(const String &spec);
+
+    /// Role registered with add_role()
+    struct Role {
+      /// Role name prefix
+      String prefix;
+      /// CPU groups; threads are assigned to groups round robin
+      std::vector<std::vector<int>> groups;
+      /// Next group to assign
+      size_t next_group {};
+    };
+
+    /// Registered roles
+    static std::vector<Role> ms_roles;
+
+    /// Protects #ms_roles group assignment in bind_self()
+    static std::mutex ms_mutex;
+  };
+
+  /// @}
+}
+
+#endif // Common_ThreadAffinity_h
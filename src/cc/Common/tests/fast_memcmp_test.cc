@@ -0,0 +1,62 @@
+/*
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 3 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include <Common/Compat.h>
+#include <Common/FastMemcmp.h>
+#include <Common/Logger.h>
+#include <Common/Random.h>
+
+#include <cstring>
+
+using namespace Hypertable;
+
+namespace {
+
+  int sign(int n) {
+    return (n > 0) - (n < 0);
+  }
+
+}
+
+int main(int argc, char **argv) {
+  uint8_t buf1[256], buf2[256];
+
+  Random::seed(1);
+
+  // Random buffers of every length, equal and with a single byte flipped
+  // at every offset, must agree with memcmp
+  for (size_t len = 0; len <= sizeof(buf1); len++) {
+    for (size_t i = 0; i < len; i++)
+      buf1[i] = (uint8_t)Random::number32(256);
+    memcpy(buf2, buf1, len);
+    HT_ASSERT(fast_memcmp(buf1, buf2, len) == 0);
+    for (size_t off = 0; off < len; off++) {
+      buf2[off] ^= 0x55;
+      HT_ASSERT(sign(fast_memcmp(buf1, buf2, len)) ==
+                sign(memcmp(buf1, buf2, len)));
+      HT_ASSERT(sign(fast_memcmp(buf2, buf1, len)) ==
+                sign(memcmp(buf2, buf1, len)));
+      buf2[off] ^= 0x55;
+    }
+  }
+
+  return 0;
+}
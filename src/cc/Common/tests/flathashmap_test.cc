@@ -0,0 +1,172 @@
+/*
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 3 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include <Common/Compat.h>
+#include <Common/FlatHashMap.h>
+#include <Common/Logger.h>
+#include <Common/Random.h>
+#include <Common/String.h>
+
+#include <map>
+#include <string>
+#include <utility>
+
+using namespace Hypertable;
+using namespace std;
+
+namespace {
+
+  typedef FlatHashMap<uint32_t, uint32_t> TestMap;
+  typedef map<uint32_t, uint32_t> ReferenceMap;
+
+  /// Checks that <code>fmap</code> holds exactly the entries of
+  /// <code>reference</code>, both by iteration and by lookup.
+  void verify(TestMap &fmap, ReferenceMap &reference) {
+    HT_ASSERT(fmap.size() == reference.size());
+    HT_ASSERT(fmap.empty() == reference.empty());
+    size_t count = 0;
+    for (auto &entry : fmap) {
+      auto iter = reference.find(entry.first);
+      HT_ASSERT(iter != reference.end());
+      HT_ASSERT(iter->second == entry.second);
+      count++;
+    }
+    HT_ASSERT(count == reference.size());
+    for (auto &entry : reference) {
+      auto iter = fmap.find(entry.first);
+      HT_ASSERT(iter != fmap.end());
+      HT_ASSERT(iter->first == entry.first);
+      HT_ASSERT(iter->second == entry.second);
+      HT_ASSERT(fmap.count(entry.first) == 1);
+    }
+  }
+
+}
+
+int main(int argc, char **argv) {
+  Random::seed(1);
+
+  {
+    TestMap fmap;
+    ReferenceMap reference;
+
+    // 200k random insert/erase/find operations against a std::map reference
+    // model; a small key space forces heavy tombstone reuse, and the
+    // verifying find after each mutation catches corrupted probe sequences
+    // immediately
+    for (size_t op = 0; op < 200000; op++) {
+      uint32_t key = Random::number32(4096);
+      switch (Random::number32(3)) {
+      case 0: {
+        uint32_t value = Random::number32(1000000);
+        pair<TestMap::iterator, bool> result =
+          fmap.insert(make_pair(key, value));
+        pair<ReferenceMap::iterator, bool> ref_result =
+          reference.insert(make_pair(key, value));
+        HT_ASSERT(result.second == ref_result.second);
+        HT_ASSERT(result.first->first == key);
+        HT_ASSERT(result.first->second == ref_result.first->second);
+        break;
+      }
+      case 1: {
+        uint32_t value = Random::number32(1000000);
+        fmap[key] = value;
+        reference[key] = value;
+        break;
+      }
+      case 2:
+        HT_ASSERT(fmap.erase(key) == reference.erase(key));
+        break;
+      }
+      uint32_t probe = Random::number32(4096);
+      auto iter = fmap.find(probe);
+      auto ref_iter = reference.find(probe);
+      if (ref_iter == reference.end()) {
+        HT_ASSERT(iter == fmap.end());
+        HT_ASSERT(fmap.count(probe) == 0);
+      }
+      else {
+        HT_ASSERT(iter != fmap.end());
+        HT_ASSERT(iter->first == probe);
+        HT_ASSERT(iter->second == ref_iter->second);
+      }
+    }
+
+    verify(fmap, reference);
+
+    // Copy construction and assignment
+    TestMap copied(fmap);
+    verify(copied, reference);
+    TestMap assigned;
+    assigned[1] = 1;
+    assigned = fmap;
+    verify(assigned, reference);
+
+    // Erase-while-iterating; tombstoning in place must keep the iteration
+    // valid and visit every remaining entry
+    for (auto iter = fmap.begin(); iter != fmap.end(); ) {
+      if (iter->first & 1)
+        iter = fmap.erase(iter);
+      else
+        ++iter;
+    }
+    for (auto iter = reference.begin(); iter != reference.end(); ) {
+      if (iter->first & 1)
+        reference.erase(iter++);
+      else
+        ++iter;
+    }
+    verify(fmap, reference);
+
+    // clear() retains table memory but must leave a usable empty map
+    fmap.clear();
+    HT_ASSERT(fmap.empty());
+    HT_ASSERT(fmap.begin() == fmap.end());
+    fmap[42] = 7;
+    HT_ASSERT(fmap.size() == 1);
+    HT_ASSERT(fmap.find(42)->second == 7);
+  }
+
+  // String keys and values exercise non-trivial construction and
+  // destruction of slot entries across rehashes and erases
+  {
+    FlatHashMap<string, string> fmap;
+    map<string, string> reference;
+
+    for (size_t i = 0; i < 10000; i++) {
+      string key = format("key-%u", (unsigned)Random::number32(500));
+      string value = format("value-%u", (unsigned)i);
+      fmap[key] = value;
+      reference[key] = value;
+    }
+    HT_ASSERT(fmap.size() == reference.size());
+    for (auto &entry : reference) {
+      auto iter = fmap.find(entry.first);
+      HT_ASSERT(iter != fmap.end());
+      HT_ASSERT(iter->second == entry.second);
+    }
+    for (auto &entry : reference)
+      HT_ASSERT(fmap.erase(entry.first) == 1);
+    HT_ASSERT(fmap.empty());
+  }
+
+  return 0;
+}
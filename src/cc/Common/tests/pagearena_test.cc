@@ -164,6 +164,27 @@ void test_pagearena_alloc_frag(int n, int sz) {
   HT_BENCH1(Hypertable::format("arena alloc %d free", sz), arena.free(), n);
 }
 
+void test_slab_reuse() {
+  CharArena arena;
+  arena.set_reuse_freed();
+
+  char *p = arena.alloc(40);
+  memset(p, 0xab, 40);
+  arena.free_chunk(p, 40);
+  HT_ASSERT(arena.freed() > 0);
+
+  // 37 rounds up to the same size class, so the freed chunk is reused
+  char *q = arena.alloc(37);
+  HT_ASSERT(q == p);
+  HT_ASSERT(arena.freed() == 0);
+  HT_ASSERT(arena.alloc(40) != p);
+
+  // chunks above the largest size class are not banked
+  char *big = arena.alloc(4096);
+  arena.free_chunk(big, 4096);
+  HT_ASSERT(arena.freed() == 0);
+}
+
 void test_strings_frag(int n) {
   Strings v;
   random_strings_test(v, n);
@@ -208,8 +229,10 @@ int main(int ac, char *av[]) {
           cout <<"Unknown component: "<< co << endl;
       }
     }
-    else
+    else {
+      run_test(test_slab_reuse, true);
       run_test(bind(random_test, n), true);
+    }
   }
   catch (Exception &e) {
     HT_ERROR_OUT << e << HT_END;
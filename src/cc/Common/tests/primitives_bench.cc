@@ -0,0 +1,169 @@
+/*
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/**
+ * Microbenchmarks for the Common primitives on every hot path: varint
+ * coding, ByteString scanning, DynamicBuffer growth and PageArena
+ * allocation.  Each section verifies its round trip, so besides printing
+ * throughput numbers the program fails if a primitive is broken.  Run with
+ * a small iteration count from the test harness for a quick sanity pass,
+ * or with the default count when comparing against recorded baselines.
+ */
+
+#include <Common/Compat.h>
+#include <Common/ByteString.h>
+#include <Common/DynamicBuffer.h>
+#include <Common/PageArena.h>
+#include <Common/Serialization.h>
+#include <Common/Stopwatch.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+using namespace Hypertable;
+using namespace std;
+
+namespace {
+
+#define MEASURE(_label_, _code_, _n_) do { \
+  Stopwatch w; _code_; w.stop(); \
+  cout << _label_ <<": "<< (int64_t)((_n_) / w.elapsed()) <<"/s" << endl; \
+} while (0)
+
+  void verify(bool expr, const char *label) {
+    if (!expr) {
+      cout << "verification failed: " << label << endl;
+      exit(EXIT_FAILURE);
+    }
+  }
+
+  void bench_varint(size_t n) {
+    DynamicBuffer buf(n * 5);
+    uint8_t *ptr = buf.base;
+    uint64_t sum = 0, check = 0;
+
+    MEASURE("encode_vi32", for (size_t i = 0; i < n; ++i) {
+        Serialization::encode_vi32(&ptr, (uint32_t)(i * 2654435761UL));
+        sum += (uint32_t)(i * 2654435761UL);
+      }, n);
+
+    const uint8_t *rptr = buf.base;
+    MEASURE("decode_vi32", for (size_t i = 0; i < n; ++i)
+        check += Serialization::decode_vi32(&rptr), n);
+    verify(check == sum, "vi32 round trip");
+
+    DynamicBuffer buf64(n * 10);
+    ptr = buf64.base;
+    sum = check = 0;
+
+    MEASURE("encode_vi64", for (size_t i = 0; i < n; ++i) {
+        Serialization::encode_vi64(&ptr, (uint64_t)i * 6364136223846793005ULL);
+        sum += (uint64_t)i * 6364136223846793005ULL;
+      }, n);
+
+    rptr = buf64.base;
+    MEASURE("decode_vi64", for (size_t i = 0; i < n; ++i)
+        check += Serialization::decode_vi64(&rptr), n);
+    verify(check == sum, "vi64 round trip");
+  }
+
+  void bench_byte_string(size_t n) {
+    DynamicBuffer buf;
+    char item[32];
+    size_t total_len = 0;
+
+    MEASURE("append_as_byte_string", for (size_t i = 0; i < n; ++i) {
+        int len = sprintf(item, "item-%09d", (int)i);
+        append_as_byte_string(buf, item, len);
+        total_len += len;
+      }, n);
+
+    ByteString bs(buf.base);
+    size_t scanned_len = 0;
+    MEASURE("ByteString scan", for (size_t i = 0; i < n; ++i) {
+        const uint8_t *dptr;
+        scanned_len += bs.decode_length(&dptr);
+        bs.next();
+      }, n);
+    verify(scanned_len == total_len, "byte string scan");
+  }
+
+  void bench_dynamic_buffer(size_t n) {
+    const char chunk[16] = "0123456789abcde";
+
+    MEASURE("DynamicBuffer growth", {
+        DynamicBuffer buf;
+        for (size_t i = 0; i < n; ++i)
+          buf.add(chunk, sizeof(chunk));
+        verify(buf.fill() == n * sizeof(chunk), "buffer fill");
+      }, n);
+
+    MEASURE("DynamicBuffer preallocated", {
+        DynamicBuffer buf(n * sizeof(chunk));
+        for (size_t i = 0; i < n; ++i)
+          buf.add_unchecked(chunk, sizeof(chunk));
+        verify(buf.fill() == n * sizeof(chunk), "buffer fill");
+      }, n);
+  }
+
+  void bench_page_arena(size_t n) {
+    char item[32];
+    int len = sprintf(item, "arena-payload-string");
+
+    MEASURE("CharArena dup", {
+        CharArena arena;
+        const char *last = 0;
+        for (size_t i = 0; i < n; ++i)
+          last = arena.dup(item);
+        verify(last && !strcmp(last, item), "arena dup");
+      }, n);
+
+    MEASURE("malloc/free dup", {
+        char *last = 0;
+        for (size_t i = 0; i < n; ++i) {
+          if (last)
+            free(last);
+          last = (char *)malloc(len + 1);
+          memcpy(last, item, len + 1);
+        }
+        verify(last && !strcmp(last, item), "malloc dup");
+        free(last);
+      }, n);
+  }
+
+} // local namespace
+
+
+int main(int argc, char *argv[]) {
+  size_t n = 1000000;
+
+  if (argc > 1)
+    n = (size_t)strtoul(argv[1], 0, 0);
+
+  bench_varint(n);
+  bench_byte_string(n);
+  bench_dynamic_buffer(n);
+  bench_page_arena(n);
+
+  cout << "primitives_bench PASSED" << endl;
+  return 0;
+}
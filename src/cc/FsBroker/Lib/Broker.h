@@ -22,6 +22,7 @@
 #ifndef FsBroker_Lib_Broker_h
 #define FsBroker_Lib_Broker_h
 
+#include "MetricsHandler.h"
 #include "OpenFileMap.h"
 #include "Response/Callback/Open.h"
 #include "Response/Callback/Read.h"
@@ -31,9 +32,11 @@
 #include "Response/Callback/Status.h"
 #include "Response/Callback/Exists.h"
 
+#include <Common/Filesystem.h>
 #include <Common/StaticBuffer.h>
 
 #include <memory>
+#include <vector>
 
 namespace Hypertable {
 
@@ -51,6 +54,12 @@ namespace Lib {
   class Broker {
   public:
     virtual ~Broker() { return; }
+
+    /** Returns the broker's metrics handler, if it has one.
+     *
+     * @return Pointer to metrics handler, or 0
+     */
+    virtual MetricsHandler *metrics_handler() { return 0; }
     /**
      * Open a file and pass the fd to the callback on success.
      *
@@ -140,6 +149,19 @@ namespace Lib {
     virtual void pread(Response::Callback::Read *cb, uint32_t fd, uint64_t offset,
                        uint32_t amount, bool verify_checksum) = 0;
 
+    /**
+     * Read from file at several positions.  The requested ranges are read
+     * into a single buffer, packed back-to-back in the order given, and
+     * returned in one response whose offset is that of the first range.
+     * @param fd Open fd to read from.
+     * @param ranges Ranges (offset and amount) to read.
+     * @param verify_checksum Verify checksum of data read
+     * @param cb
+     */
+    virtual void preadv(Response::Callback::Read *cb, uint32_t fd,
+                        const std::vector<Filesystem::ReadRange> &ranges,
+                        bool verify_checksum) = 0;
+
 
     /**
      * Make a directory hierarcy, If the parent dirs are not,
@@ -39,6 +39,7 @@
 #include "Request/Parameters/Mkdirs.h"
 #include "Request/Parameters/Open.h"
 #include "Request/Parameters/Pread.h"
+#include "Request/Parameters/Preadv.h"
 #include "Request/Parameters/Readdir.h"
 #include "Request/Parameters/Read.h"
 #include "Request/Parameters/Remove.h"
@@ -59,11 +60,15 @@
 #include <AsyncComm/CommBuf.h>
 #include <AsyncComm/CommHeader.h>
 #include <AsyncComm/Protocol.h>
+#include <AsyncComm/ShmPayload.h>
 
+#include <Common/Config.h>
 #include <Common/Error.h>
 #include <Common/Filesystem.h>
 #include <Common/Logger.h>
 #include <Common/Serialization.h>
+#include <Common/System.h>
+#include <Common/SystemInfo.h>
 
 using namespace Hypertable;
 using namespace Serialization;
@@ -144,6 +149,13 @@ int
 Client::open(const String &name, uint32_t flags) {
   DispatchHandlerSynchronizer sync_handler;
   EventPtr event;
+
+  {
+    int32_t fd = handle_cache()->acquire(name, flags);
+    if (fd != -1)
+      return fd;
+  }
+
   CommHeader header(Request::Handler::Factory::FUNCTION_OPEN);
   Request::Parameters::Open params(name, flags, 0);
   CommBufPtr cbuf( new CommBuf(header, params.encoded_length()) );
@@ -158,6 +170,7 @@ Client::open(const String &name, uint32_t flags) {
 
     int32_t fd;
     decode_response_open(event, &fd);
+    handle_cache()->register_handle(fd, name, flags);
     return fd;
   }
   catch (Exception &e) {
@@ -210,6 +223,7 @@ void
 Client::create(const String &name, uint32_t flags, int32_t bufsz,
                int32_t replication, int64_t blksz,
                DispatchHandler *handler) {
+  invalidate_cached_handles(name);
   CommHeader header(Request::Handler::Factory::FUNCTION_CREATE);
   Request::Parameters::Create params(name, flags, bufsz, replication, blksz);
   CommBufPtr cbuf( new CommBuf(header, params.encoded_length()) );
@@ -227,6 +241,7 @@ Client::create(const String &name, uint32_t flags, int32_t bufsz,
 int
 Client::create(const String &name, uint32_t flags, int32_t bufsz,
                int32_t replication, int64_t blksz) {
+  invalidate_cached_handles(name);
   DispatchHandlerSynchronizer sync_handler;
   EventPtr event;
   CommHeader header(Request::Handler::Factory::FUNCTION_CREATE);
@@ -259,6 +274,7 @@ void Client::decode_response_create(EventPtr &event, int32_t *fd) {
 void
 Client::close(int32_t fd, DispatchHandler *handler) {
   ClientBufferedReaderHandler *reader_handler = 0;
+  handle_cache()->forget(fd);
   CommHeader header(Request::Handler::Factory::FUNCTION_CLOSE);
   header.gid = fd;
   Request::Parameters::Close params(fd);
@@ -289,6 +305,17 @@ Client::close(int32_t fd) {
   ClientBufferedReaderHandler *reader_handler = 0;
   DispatchHandlerSynchronizer sync_handler;
   EventPtr event;
+
+  {
+    vector<int32_t> evicted;
+    if (handle_cache()->release(fd, evicted)) {
+      // Handle parked for reuse; close any handles evicted to make room
+      for (int32_t evicted_fd : evicted)
+        close(evicted_fd);
+      return;
+    }
+  }
+
   CommHeader header(Request::Handler::Factory::FUNCTION_CLOSE);
   header.gid = fd;
   Request::Parameters::Close params(fd);
@@ -317,10 +344,46 @@ Client::close(int32_t fd) {
 }
 
 
+bool Client::shm_payload_ok() {
+  static bool enabled = Config::properties &&
+    Config::properties->get_bool("FsBroker.Client.ShmReads");
+  if (!enabled)
+    return false;
+  if ((ntohl(m_addr.sin_addr.s_addr) >> 24) == 127)
+    return true;
+  return InetAddr::format_ipaddress(m_addr) == System::net_info().primary_addr;
+}
+
+
+ClientHandleCache *Client::handle_cache() {
+  lock_guard<mutex> lock(m_mutex);
+  if (!m_handle_cache) {
+    int32_t capacity = 0;
+    if (Config::properties &&
+        Config::properties->has("FsBroker.Client.HandleCacheSize"))
+      capacity = Config::properties->get_i32("FsBroker.Client.HandleCacheSize");
+    m_handle_cache =
+      make_shared<ClientHandleCache>(capacity > 0 ? capacity : 0);
+  }
+  return m_handle_cache.get();
+}
+
+
+void Client::invalidate_cached_handles(const String &name) {
+  vector<int32_t> closed;
+  handle_cache()->invalidate(name, closed);
+  for (int32_t fd : closed)
+    close(fd);
+}
+
+
 void
 Client::read(int32_t fd, size_t len, DispatchHandler *handler) {
+  handle_cache()->forget(fd);
   CommHeader header(Request::Handler::Factory::FUNCTION_READ);
   header.gid = fd;
+  if (shm_payload_ok())
+    header.flags |= CommHeader::FLAGS_BIT_SHM_PAYLOAD_OK;
   Request::Parameters::Read params(fd, len);
   CommBufPtr cbuf( new CommBuf(header, params.encoded_length()) );
   params.encode(cbuf->get_data_ptr_address());
@@ -337,6 +400,7 @@ Client::read(int32_t fd, size_t len, DispatchHandler *handler) {
 
 size_t
 Client::read(int32_t fd, void *dst, size_t len) {
+  handle_cache()->forget(fd);
   ClientBufferedReaderHandler *reader_handler = 0;
   {
     lock_guard<mutex> lock(m_mutex);
@@ -352,6 +416,8 @@ Client::read(int32_t fd, void *dst, size_t len) {
     EventPtr event;
     CommHeader header(Request::Handler::Factory::FUNCTION_READ);
     header.gid = fd;
+    if (shm_payload_ok())
+      header.flags |= CommHeader::FLAGS_BIT_SHM_PAYLOAD_OK;
     Request::Parameters::Read params(fd, len);
     CommBufPtr cbuf( new CommBuf(header, params.encoded_length()) );
     params.encode(cbuf->get_data_ptr_address());
@@ -377,7 +443,11 @@ Client::read(int32_t fd, void *dst, size_t len) {
 
 void Client::decode_response_read(EventPtr &event, const void **buffer,
                                   uint64_t *offset, uint32_t *length) {
-  int error = Protocol::response_code(event);
+  int error = shm_payload_translate(event);
+  if (error != Error::OK)
+    HT_THROW(error, "Translating shared memory read payload");
+
+  error = Protocol::response_code(event);
   if (error != Error::OK)
     HT_THROW(error, Protocol::string_format_message(event));
 
@@ -486,6 +556,7 @@ void Client::decode_response_append(EventPtr &event, uint64_t *offset,
 
 void
 Client::seek(int32_t fd, uint64_t offset, DispatchHandler *handler) {
+  handle_cache()->forget(fd);
   CommHeader header(Request::Handler::Factory::FUNCTION_SEEK);
   header.gid = fd;
   Request::Parameters::Seek params(fd, offset);
@@ -502,6 +573,7 @@ Client::seek(int32_t fd, uint64_t offset, DispatchHandler *handler) {
 
 void
 Client::seek(int32_t fd, uint64_t offset) {
+  handle_cache()->forget(fd);
   DispatchHandlerSynchronizer sync_handler;
   EventPtr event;
   CommHeader header(Request::Handler::Factory::FUNCTION_SEEK);
@@ -526,6 +598,7 @@ Client::seek(int32_t fd, uint64_t offset) {
 
 void
 Client::remove(const String &name, DispatchHandler *handler) {
+  invalidate_cached_handles(name);
   CommHeader header(Request::Handler::Factory::FUNCTION_REMOVE);
   Request::Parameters::Remove params(name);
   CommBufPtr cbuf( new CommBuf(header, params.encoded_length()) );
@@ -540,6 +613,7 @@ Client::remove(const String &name, DispatchHandler *handler) {
 
 void
 Client::remove(const String &name, bool force) {
+  invalidate_cached_handles(name);
   DispatchHandlerSynchronizer sync_handler;
   EventPtr event;
   CommHeader header(Request::Handler::Factory::FUNCTION_REMOVE);
@@ -669,6 +743,8 @@ Client::pread(int32_t fd, size_t len, uint64_t offset,
               bool verify_checksum, DispatchHandler *handler) {
   CommHeader header(Request::Handler::Factory::FUNCTION_PREAD);
   header.gid = fd;
+  if (shm_payload_ok())
+    header.flags |= CommHeader::FLAGS_BIT_SHM_PAYLOAD_OK;
   Request::Parameters::Pread params(fd, offset, len, verify_checksum);
   CommBufPtr cbuf( new CommBuf(header, params.encoded_length()) );
   params.encode(cbuf->get_data_ptr_address());
@@ -687,6 +763,8 @@ Client::pread(int32_t fd, void *dst, size_t len, uint64_t offset, bool verify_ch
   EventPtr event;
   CommHeader header(Request::Handler::Factory::FUNCTION_PREAD);
   header.gid = fd;
+  if (shm_payload_ok())
+    header.flags |= CommHeader::FLAGS_BIT_SHM_PAYLOAD_OK;
   Request::Parameters::Pread params(fd, offset, len, verify_checksum);
   CommBufPtr cbuf( new CommBuf(header, params.encoded_length()) );
   params.encode(cbuf->get_data_ptr_address());
@@ -717,6 +795,66 @@ void Client::decode_response_pread(EventPtr &event, const void **buffer,
   decode_response_read(event, buffer, offset, length);
 }
 
+
+void
+Client::preadv(int32_t fd, const std::vector<Filesystem::ReadRange> &ranges,
+               bool verify_checksum, DispatchHandler *handler) {
+  CommHeader header(Request::Handler::Factory::FUNCTION_PREADV);
+  header.gid = fd;
+  if (shm_payload_ok())
+    header.flags |= CommHeader::FLAGS_BIT_SHM_PAYLOAD_OK;
+  Request::Parameters::Preadv params(fd, ranges, verify_checksum);
+  CommBufPtr cbuf( new CommBuf(header, params.encoded_length()) );
+  params.encode(cbuf->get_data_ptr_address());
+
+  try { send_message(cbuf, handler); }
+  catch (Exception &e) {
+    HT_THROW2F(e.code(), e, "Error sending preadv request (%d ranges) "
+               "on FS fd %d", (int)ranges.size(), (int)fd);
+  }
+}
+
+
+size_t
+Client::preadv(int32_t fd, void *dst, size_t len,
+               const std::vector<Filesystem::ReadRange> &ranges,
+               bool verify_checksum) {
+  DispatchHandlerSynchronizer sync_handler;
+  EventPtr event;
+  CommHeader header(Request::Handler::Factory::FUNCTION_PREADV);
+  header.gid = fd;
+  if (shm_payload_ok())
+    header.flags |= CommHeader::FLAGS_BIT_SHM_PAYLOAD_OK;
+  Request::Parameters::Preadv params(fd, ranges, verify_checksum);
+  CommBufPtr cbuf( new CommBuf(header, params.encoded_length()) );
+  params.encode(cbuf->get_data_ptr_address());
+
+  try {
+    send_message(cbuf, &sync_handler);
+
+    if (!sync_handler.wait_for_reply(event))
+      HT_THROW(Protocol::response_code(event.get()),
+               Protocol::string_format_message(event).c_str());
+
+    uint32_t length;
+    uint64_t off;
+    const void *data;
+    decode_response_preadv(event, &data, &off, &length);
+    HT_ASSERT(length <= len);
+    memcpy(dst, data, length);
+    return length;
+  }
+  catch (Exception &e) {
+    HT_THROW2F(e.code(), e, "Error preading %d ranges on FS fd %d",
+               (int)ranges.size(), (int)fd);
+  }
+}
+
+void Client::decode_response_preadv(EventPtr &event, const void **buffer,
+                                    uint64_t *offset, uint32_t *length) {
+  decode_response_read(event, buffer, offset, length);
+}
+
 void Client::mkdirs(const String &name, DispatchHandler *handler) {
   CommHeader header(Request::Handler::Factory::FUNCTION_MKDIRS);
   Request::Parameters::Mkdirs params(name);
@@ -961,6 +1099,8 @@ bool Client::decode_response_exists(EventPtr &event) {
 
 void
 Client::rename(const String &src, const String &dst, DispatchHandler *handler) {
+  invalidate_cached_handles(src);
+  invalidate_cached_handles(dst);
   CommHeader header(Request::Handler::Factory::FUNCTION_RENAME);
   Request::Parameters::Rename params(src, dst);
   CommBufPtr cbuf( new CommBuf(header, params.encoded_length()) );
@@ -976,6 +1116,8 @@ Client::rename(const String &src, const String &dst, DispatchHandler *handler) {
 
 void
 Client::rename(const String &src, const String &dst) {
+  invalidate_cached_handles(src);
+  invalidate_cached_handles(dst);
   DispatchHandlerSynchronizer sync_handler;
   EventPtr event;
   CommHeader header(Request::Handler::Factory::FUNCTION_RENAME);
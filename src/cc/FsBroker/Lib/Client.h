@@ -28,6 +28,7 @@
 #define FsBroker_Lib_Client_h
 
 #include <FsBroker/Lib/ClientBufferedReaderHandler.h>
+#include <FsBroker/Lib/ClientHandleCache.h>
 
 #include <AsyncComm/Comm.h>
 #include <AsyncComm/ConnectionManager.h>
@@ -159,6 +160,14 @@ namespace Lib {
     void decode_response_pread(EventPtr &event, const void **buffer,
                                uint64_t *offset, uint32_t *length) override;
 
+    void preadv(int32_t fd, const std::vector<Filesystem::ReadRange> &ranges,
+                bool verify_checksum, DispatchHandler *handler) override;
+    size_t preadv(int32_t fd, void *dst, size_t len,
+                  const std::vector<Filesystem::ReadRange> &ranges,
+                  bool verify_checksum = true) override;
+    void decode_response_preadv(EventPtr &event, const void **buffer,
+                                uint64_t *offset, uint32_t *length) override;
+
     void mkdirs(const String &name, DispatchHandler *handler) override;
     void mkdirs(const String &name) override;
 
@@ -221,12 +230,26 @@ namespace Lib {
     /// @param timer Deadline timer
     void send_message(CommBufPtr &cbuf, DispatchHandler *handler, Timer *timer=0);
 
+    /// Checks if read payloads may be delivered via shared memory.
+    /// @return <i>true</i> if shared memory reads are enabled and the broker
+    /// is on the local host
+    bool shm_payload_ok();
+
+    /// Returns the open file handle cache, creating it on first use.
+    /// @return Pointer to handle cache
+    ClientHandleCache *handle_cache();
+
+    /// Invalidates and closes cached handles of a file.
+    /// @param name File name
+    void invalidate_cached_handles(const String &name);
+
     std::mutex m_mutex;
     Comm *m_comm;
     ConnectionManagerPtr m_conn_mgr;
     InetAddr m_addr;
     uint32_t m_timeout_ms;
     std::unordered_map<uint32_t, ClientBufferedReaderHandler *> m_buffered_reader_map;
+    ClientHandleCachePtr m_handle_cache;
   };
 
   /// Smart pointer to Client
@@ -43,17 +43,8 @@ ClientBufferedReaderHandler::ClientBufferedReaderHandler(
   m_outstanding_offset = start_offset;
   m_actual_offset = start_offset;
 
-  /**
-   * Seek to initial offset
-   */
-  if (start_offset > 0) {
-    try { m_client->seek(m_fd, start_offset); }
-    catch (...) {
-      m_eof = true;
-      throw;
-    }
-  }
-
+  // Positional reads carry the offset in the request, so no initial seek
+  // round-trip is needed
   {
     lock_guard<mutex> lock(m_mutex);
     uint32_t toread;
@@ -66,7 +57,7 @@ ClientBufferedReaderHandler::ClientBufferedReaderHandler(
       else
         toread = m_read_size;
 
-      try { m_client->read(m_fd, toread, this); }
+      try { m_client->pread(m_fd, toread, m_outstanding_offset, false, this); }
       catch (...) {
         m_eof = true;
         throw;
@@ -116,7 +107,17 @@ void ClientBufferedReaderHandler::handle(EventPtr &event) {
       uint32_t amount;
       uint64_t offset;
       const void *data;
-      m_client->decode_response_read(event, &data, &offset, &amount);
+      m_client->decode_response_pread(event, &data, &offset, &amount);
+      if (offset != m_actual_offset) {
+        m_error = Error::FAILED_EXPECTATION;
+        m_error_msg = format("FS pread response out of sequence (fd=%d, "
+                             "expected offset=%llu, got %llu)", m_fd,
+                             (Llu)m_actual_offset, (Llu)offset);
+        HT_ERRORF("%s", m_error_msg.c_str());
+        m_eof = true;
+        m_cond.notify_all();
+        return;
+      }
       m_actual_offset += amount;
       if (amount < m_read_size)
         m_eof = true;
@@ -161,7 +162,7 @@ ClientBufferedReaderHandler::read(void *buf, size_t len) {
       uint64_t offset;
       uint32_t amount;
       EventPtr &event = m_queue.front();
-      m_client->decode_response_read(event, (const void **)&m_ptr, &offset, &amount);
+      m_client->decode_response_pread(event, (const void **)&m_ptr, &offset, &amount);
       m_end_ptr = m_ptr + amount;
     }
 
@@ -220,7 +221,7 @@ void ClientBufferedReaderHandler::read_ahead() {
     else
       toread = m_read_size;
 
-    try { m_client->read(m_fd, toread, this); }
+    try { m_client->pread(m_fd, toread, m_outstanding_offset, false, this); }
     catch(...) {
       m_eof = true;
       throw;
@@ -0,0 +1,108 @@
+/*
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include <Common/Compat.h>
+
+#include "ClientBufferedWriterHandler.h"
+
+#include <AsyncComm/Protocol.h>
+
+#include <Common/Error.h>
+
+using namespace Hypertable;
+using namespace Hypertable::FsBroker::Lib;
+using namespace std;
+
+ClientBufferedWriterHandler::ClientBufferedWriterHandler(
+    Filesystem *fs, uint32_t fd, uint32_t outstanding) :
+    m_fs(fs), m_fd(fd), m_max_outstanding(outstanding), m_outstanding(0),
+    m_error(Error::OK) {
+}
+
+
+
+ClientBufferedWriterHandler::~ClientBufferedWriterHandler() {
+  try {
+    unique_lock<mutex> lock(m_mutex);
+
+    m_cond.wait(lock, [this](){ return m_outstanding == 0; });
+  }
+  catch (...) {
+    HT_ERROR("synchronization error");
+  }
+}
+
+
+
+/**
+ *
+ */
+void ClientBufferedWriterHandler::handle(EventPtr &event) {
+  lock_guard<mutex> lock(m_mutex);
+
+  m_outstanding--;
+
+  if (event->type == Event::MESSAGE) {
+    int error = (int)Protocol::response_code(event);
+    if (error != Error::OK && m_error == Error::OK) {
+      m_error = error;
+      m_error_msg = Protocol::string_format_message(event);
+      HT_ERRORF("FS append error (fd=%d) : %s", (int)m_fd,
+                m_error_msg.c_str());
+    }
+  }
+  else if (m_error == Error::OK) {
+    m_error_msg = event->to_str();
+    HT_ERRORF("%s", m_error_msg.c_str());
+    m_error = (event->type == Event::ERROR) ? event->error
+                                            : Error::FAILED_EXPECTATION;
+  }
+
+  m_cond.notify_all();
+}
+
+
+
+void
+ClientBufferedWriterHandler::append(StaticBuffer &buffer,
+                                    Filesystem::Flags flags) {
+  unique_lock<mutex> lock(m_mutex);
+
+  m_cond.wait(lock, [this](){
+      return m_outstanding < m_max_outstanding || m_error != Error::OK; });
+
+  if (m_error != Error::OK)
+    HT_THROW(m_error, m_error_msg);
+
+  m_fs->append(m_fd, buffer, flags, this);
+  m_outstanding++;
+}
+
+
+
+void ClientBufferedWriterHandler::flush() {
+  unique_lock<mutex> lock(m_mutex);
+
+  m_cond.wait(lock, [this](){ return m_outstanding == 0; });
+
+  if (m_error != Error::OK)
+    HT_THROW(m_error, m_error_msg);
+}
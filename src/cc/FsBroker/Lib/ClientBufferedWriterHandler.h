@@ -0,0 +1,84 @@
+/* -*- c++ -*-
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#ifndef FsBroker_Lib_ClientBufferedWriterHandler_h
+#define FsBroker_Lib_ClientBufferedWriterHandler_h
+
+#include <AsyncComm/DispatchHandler.h>
+
+#include <Common/Filesystem.h>
+#include <Common/String.h>
+
+#include <condition_variable>
+#include <mutex>
+
+namespace Hypertable {
+namespace FsBroker {
+namespace Lib {
+
+  /// @addtogroup FsBrokerLib
+  /// @{
+
+  /** Pipelines appends to a file opened for writing.  Writers that issue one
+   * append at a time stall on a broker round-trip per buffer; this handler
+   * keeps a window of appends in flight (the write-side counterpart of
+   * ClientBufferedReaderHandler) so the caller can prepare the next buffer
+   * while earlier ones are still being written.  Appends complete in order
+   * on the broker connection.  An error reported for any outstanding append
+   * is thrown from the next call to append() or flush().
+   */
+  class ClientBufferedWriterHandler : public DispatchHandler {
+
+  public:
+    ClientBufferedWriterHandler(Filesystem *fs, uint32_t fd,
+        uint32_t outstanding);
+
+    virtual ~ClientBufferedWriterHandler();
+
+    virtual void handle(EventPtr &event);
+
+    /** Appends a buffer to the file, blocking while the window of
+     * outstanding appends is full.
+     * @param buffer Buffer to append (ownership is transferred)
+     * @param flags Append flags (Filesystem::Flags)
+     */
+    void append(StaticBuffer &buffer, Filesystem::Flags flags);
+
+    /** Waits for all outstanding appends to complete. */
+    void flush();
+
+  private:
+
+    std::mutex m_mutex;
+    std::condition_variable m_cond;
+    Filesystem *m_fs;
+    uint32_t             m_fd;
+    uint32_t             m_max_outstanding;
+    uint32_t             m_outstanding;
+    int                  m_error;
+    std::string          m_error_msg;
+  };
+
+  /// @}
+
+}}}
+
+#endif // FsBroker_Lib_ClientBufferedWriterHandler_h
@@ -0,0 +1,144 @@
+/*
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/// @file
+/// Definitions for ClientHandleCache.
+/// This file contains definitions for ClientHandleCache, a cache of open
+/// broker file handles keyed by file name.
+
+#include <Common/Compat.h>
+
+#include "ClientHandleCache.h"
+
+#include <Common/Logger.h>
+
+using namespace Hypertable;
+using namespace Hypertable::FsBroker::Lib;
+using namespace std;
+
+int32_t ClientHandleCache::acquire(const String &name, uint32_t flags) {
+  lock_guard<mutex> lock(m_mutex);
+
+  auto index_iter = m_idle_index.find(make_pair(name, flags));
+  if (index_iter == m_idle_index.end())
+    return -1;
+
+  int32_t fd = index_iter->second;
+  auto handle_iter = m_handle_map.find(fd);
+  HT_ASSERT(handle_iter != m_handle_map.end());
+
+  remove_idle(fd);
+
+  // Stale idle handles are dropped on invalidation, so a generation
+  // mismatch here should not happen; be defensive anyway
+  auto generation_iter = m_generation_map.find(name);
+  uint64_t generation =
+    (generation_iter == m_generation_map.end()) ? 0 : generation_iter->second;
+  if (handle_iter->second.generation != generation) {
+    m_handle_map.erase(handle_iter);
+    return -1;
+  }
+
+  return fd;
+}
+
+void ClientHandleCache::register_handle(int32_t fd, const String &name,
+                                        uint32_t flags) {
+  lock_guard<mutex> lock(m_mutex);
+
+  if (m_max_idle == 0)
+    return;
+
+  Handle handle;
+  handle.name = name;
+  handle.flags = flags;
+  auto generation_iter = m_generation_map.find(name);
+  if (generation_iter != m_generation_map.end())
+    handle.generation = generation_iter->second;
+
+  m_handle_map[fd] = handle;
+}
+
+bool ClientHandleCache::release(int32_t fd, std::vector<int32_t> &evicted) {
+  lock_guard<mutex> lock(m_mutex);
+
+  auto handle_iter = m_handle_map.find(fd);
+  if (handle_iter == m_handle_map.end())
+    return false;
+
+  Handle &handle = handle_iter->second;
+
+  auto generation_iter = m_generation_map.find(handle.name);
+  uint64_t generation =
+    (generation_iter == m_generation_map.end()) ? 0 : generation_iter->second;
+  if (handle.generation != generation) {
+    m_handle_map.erase(handle_iter);
+    return false;
+  }
+
+  m_idle.push_front(fd);
+  m_idle_index.insert(
+      make_pair(make_pair(handle.name, handle.flags), fd));
+
+  while (m_idle.size() > m_max_idle) {
+    int32_t evict_fd = m_idle.back();
+    remove_idle(evict_fd);
+    m_handle_map.erase(evict_fd);
+    evicted.push_back(evict_fd);
+  }
+
+  return true;
+}
+
+void ClientHandleCache::forget(int32_t fd) {
+  lock_guard<mutex> lock(m_mutex);
+  m_handle_map.erase(fd);
+}
+
+void ClientHandleCache::invalidate(const String &name,
+                                   std::vector<int32_t> &closed) {
+  lock_guard<mutex> lock(m_mutex);
+
+  if (m_max_idle == 0)
+    return;
+
+  m_generation_map[name]++;
+
+  auto index_iter = m_idle_index.lower_bound(make_pair(name, (uint32_t)0));
+  while (index_iter != m_idle_index.end() &&
+         index_iter->first.first == name) {
+    int32_t fd = index_iter->second;
+    index_iter = m_idle_index.erase(index_iter);
+    m_idle.remove(fd);
+    m_handle_map.erase(fd);
+    closed.push_back(fd);
+  }
+}
+
+void ClientHandleCache::remove_idle(int32_t fd) {
+  m_idle.remove(fd);
+  for (auto iter = m_idle_index.begin(); iter != m_idle_index.end(); ++iter) {
+    if (iter->second == fd) {
+      m_idle_index.erase(iter);
+      break;
+    }
+  }
+}
@@ -0,0 +1,154 @@
+/* -*- c++ -*-
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/// @file
+/// Declarations for ClientHandleCache.
+/// This file contains declarations for ClientHandleCache, a cache of open
+/// broker file handles keyed by file name.
+
+#ifndef FsBroker_Lib_ClientHandleCache_h
+#define FsBroker_Lib_ClientHandleCache_h
+
+#include <Common/String.h>
+
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace Hypertable {
+namespace FsBroker {
+namespace Lib {
+
+  /// @addtogroup FsBrokerLib
+  /// @{
+
+  /** Cache of open broker file handles keyed by file name.  CellStores are
+   * opened and closed repeatedly by scanners and maintenance tasks, paying
+   * an open round-trip per access.  When this cache is enabled, closing a
+   * handle that was obtained through the synchronous open() call parks it
+   * here instead of issuing a close, and a subsequent open of the same file
+   * with the same flags reuses it.  Idle handles are evicted in
+   * least-recently-used order beyond the configured capacity, and each file
+   * name carries a generation that is bumped when the file is removed,
+   * renamed, or overwritten, so handles from a prior incarnation of a path
+   * are never reused.  Cached reuse is only sound for positional (pread)
+   * access; the client drops a handle from the cache as soon as it is used
+   * for a seek or a sequential read.
+   */
+  class ClientHandleCache {
+  public:
+
+    /** Constructor.
+     * @param max_idle Maximum number of idle handles retained (zero
+     * disables the cache)
+     */
+    ClientHandleCache(uint32_t max_idle) : m_max_idle(max_idle) {}
+
+    /** Checks if the cache is enabled.
+     * @return <i>true</i> if the idle handle capacity is greater than zero
+     */
+    bool enabled() { return m_max_idle > 0; }
+
+    /** Acquires an idle handle for a file.
+     * @param name File name
+     * @param flags Open flags the handle was opened with
+     * @return Cached file descriptor, or -1 on a miss
+     */
+    int32_t acquire(const String &name, uint32_t flags);
+
+    /** Registers a freshly opened handle so a later release can park it.
+     * @param fd File descriptor
+     * @param name File name
+     * @param flags Open flags
+     */
+    void register_handle(int32_t fd, const String &name, uint32_t flags);
+
+    /** Releases a handle on close.  If the handle is registered and its
+     * generation is current, it is parked for reuse and <i>true</i> is
+     * returned; idle handles evicted to make room are appended to
+     * <code>evicted</code> and must be closed by the caller.
+     * @param fd File descriptor being closed
+     * @param evicted Filled in with evicted descriptors to close
+     * @return <i>true</i> if the handle was retained, <i>false</i> if the
+     * caller should close it
+     */
+    bool release(int32_t fd, std::vector<int32_t> &evicted);
+
+    /** Drops a handle from the cache (e.g. after sequential access).  A
+     * subsequent release will tell the caller to really close it.
+     * @param fd File descriptor
+     */
+    void forget(int32_t fd);
+
+    /** Invalidates all handles of a file, bumping its generation.  Idle
+     * handles are appended to <code>closed</code> and must be closed by the
+     * caller; in-use handles fail the generation check on release.
+     * @param name File name
+     * @param closed Filled in with idle descriptors to close
+     */
+    void invalidate(const String &name, std::vector<int32_t> &closed);
+
+  private:
+
+    /// Registered handle
+    struct Handle {
+      String name;
+      uint32_t flags {};
+      uint64_t generation {};
+    };
+
+    typedef std::list<int32_t> IdleList;
+
+    /** Removes a descriptor from the idle structures.
+     * @param fd File descriptor
+     */
+    void remove_idle(int32_t fd);
+
+    /// %Mutex for serializing access to cache state
+    std::mutex m_mutex;
+
+    /// Registered handles (in use and idle) by descriptor
+    std::map<int32_t, Handle> m_handle_map;
+
+    /// Idle descriptors in most-recently-released order
+    IdleList m_idle;
+
+    /// Index of idle descriptors by (file name, open flags)
+    std::multimap<std::pair<String, uint32_t>, int32_t> m_idle_index;
+
+    /// Current generation of each file name
+    std::map<String, uint64_t> m_generation_map;
+
+    /// Maximum number of idle handles retained
+    uint32_t m_max_idle {};
+  };
+
+  /// Smart pointer to ClientHandleCache
+  typedef std::shared_ptr<ClientHandleCache> ClientHandleCachePtr;
+
+  /// @}
+
+}}}
+
+#endif // FsBroker_Lib_ClientHandleCache_h
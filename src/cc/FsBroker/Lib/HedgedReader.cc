@@ -0,0 +1,167 @@
+/*
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/// @file
+/// Definitions for HedgedReader.
+/// This file contains definitions for HedgedReader, a helper that issues a
+/// second read when the first exceeds an adaptive latency threshold.
+
+#include <Common/Compat.h>
+
+#include "HedgedReader.h"
+
+#include <Common/Logger.h>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <thread>
+
+using namespace Hypertable;
+using namespace Hypertable::FsBroker::Lib;
+using namespace std;
+
+namespace {
+
+  /// Number of latency samples retained
+  const size_t SAMPLE_CAPACITY = 256;
+
+  /// Minimum number of samples before hedging kicks in
+  const uint64_t MIN_SAMPLES = 32;
+
+  /// Shared state of the read attempts racing for one request
+  struct HedgeState {
+    std::mutex mutex;
+    std::condition_variable cond;
+    /// Number of attempts that have finished
+    int finished {};
+    /// Number of attempts launched
+    int launched {};
+    /// <i>true</i> once a winner has been chosen
+    bool have_result {};
+    /// Winning result (bytes read or negative error)
+    int64_t result {};
+    /// Winning attempt's buffer
+    shared_ptr<vector<uint8_t>> buf;
+  };
+
+  typedef shared_ptr<HedgeState> HedgeStatePtr;
+
+  void launch_attempt(HedgeStatePtr state, size_t len,
+                      HedgedReader::ReadFunc func) {
+    state->launched++;
+    shared_ptr<vector<uint8_t>> buf = make_shared<vector<uint8_t>>(len);
+    thread([state, buf, func]() {
+        int64_t nread = func(buf->data());
+        {
+          lock_guard<mutex> lock(state->mutex);
+          state->finished++;
+          // First completion wins; a later success also replaces an
+          // earlier failure
+          if (!state->have_result || (state->result < 0 && nread >= 0)) {
+            state->have_result = true;
+            state->result = nread;
+            state->buf = buf;
+          }
+        }
+        state->cond.notify_all();
+      }).detach();
+  }
+
+}
+
+HedgedReader::HedgedReader(PropertiesPtr &cfg) {
+  m_enabled = cfg->get_bool("FsBroker.HedgedReads.Enabled");
+  m_percentile = cfg->get_i32("FsBroker.HedgedReads.Percentile");
+  m_min_timeout_millis = cfg->get_i32("FsBroker.HedgedReads.MinTimeout");
+  if (m_percentile < 50 || m_percentile > 100) {
+    HT_WARNF("Invalid FsBroker.HedgedReads.Percentile %d, using 95",
+             (int)m_percentile);
+    m_percentile = 95;
+  }
+}
+
+int64_t HedgedReader::read(size_t len, uint8_t *dst, ReadFunc func) {
+  auto start_time = chrono::steady_clock::now();
+
+  if (!m_enabled) {
+    int64_t nread = func(dst);
+    if (nread >= 0)
+      record(chrono::duration_cast<chrono::milliseconds>(
+                 chrono::steady_clock::now() - start_time).count());
+    return nread;
+  }
+
+  HedgeStatePtr state = make_shared<HedgeState>();
+  launch_attempt(state, len, func);
+
+  int64_t threshold = threshold_millis();
+
+  unique_lock<mutex> lock(state->mutex);
+
+  if (threshold > 0) {
+    if (!state->cond.wait_for(lock, chrono::milliseconds(threshold),
+                              [&state](){ return state->finished > 0; })) {
+      launch_attempt(state, len, func);
+    }
+  }
+
+  // Wait for a success, or for all attempts to finish
+  state->cond.wait(lock, [&state](){
+      return (state->have_result && state->result >= 0) ||
+        state->finished == state->launched; });
+
+  int64_t nread = state->result;
+  if (nread >= 0) {
+    memcpy(dst, state->buf->data(), std::min((size_t)nread, len));
+    record(chrono::duration_cast<chrono::milliseconds>(
+               chrono::steady_clock::now() - start_time).count());
+  }
+  return nread;
+}
+
+int64_t HedgedReader::threshold_millis() {
+  lock_guard<mutex> lock(m_mutex);
+
+  if (m_sample_count < MIN_SAMPLES)
+    return 0;
+
+  vector<int64_t> samples(m_samples);
+  size_t position = (samples.size() * m_percentile) / 100;
+  if (position >= samples.size())
+    position = samples.size() - 1;
+  nth_element(samples.begin(), samples.begin() + position, samples.end());
+
+  return std::max(samples[position], (int64_t)m_min_timeout_millis);
+}
+
+void HedgedReader::record(int64_t latency_millis) {
+  lock_guard<mutex> lock(m_mutex);
+
+  if (m_samples.size() < SAMPLE_CAPACITY)
+    m_samples.push_back(latency_millis);
+  else {
+    m_samples[m_next_sample] = latency_millis;
+    m_next_sample = (m_next_sample + 1) % SAMPLE_CAPACITY;
+  }
+  m_sample_count++;
+}
@@ -0,0 +1,130 @@
+/* -*- c++ -*-
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/// @file
+/// Declarations for HedgedReader.
+/// This file contains declarations for HedgedReader, a helper that issues a
+/// second read when the first exceeds an adaptive latency threshold.
+
+#ifndef FsBroker_Lib_HedgedReader_h
+#define FsBroker_Lib_HedgedReader_h
+
+#include <Common/Properties.h>
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace Hypertable {
+namespace FsBroker {
+namespace Lib {
+
+  /// @addtogroup FsBrokerLib
+  /// @{
+
+  /** Hedges positioned reads against slow storage targets.  Brokers backed
+   * by a replicated file system (qfs, ceph) read from whichever replica the
+   * underlying client selects, so one degraded disk inflates tail latency
+   * for the whole pool.  This helper tracks recent read latencies and, when
+   * a read exceeds a configured percentile of them, issues a second
+   * identical read; the file system client resolves its target again, so
+   * the hedge usually lands on a different replica, and the first read to
+   * complete wins.  The losing read finishes in the background into its own
+   * buffer and is discarded.
+   *
+   * Hedging is controlled by the <code>FsBroker.HedgedReads.Enabled</code>,
+   * <code>FsBroker.HedgedReads.Percentile</code>, and
+   * <code>FsBroker.HedgedReads.MinTimeout</code> properties and is off by
+   * default.  Each read is executed on its own thread while enabled, so it
+   * is intended for remote brokers where network and disk latency dominate.
+   */
+  class HedgedReader {
+  public:
+
+    /** Read function executed (possibly twice) by read(); takes the
+     * destination buffer and returns the number of bytes read or a
+     * negative error code. */
+    typedef std::function<int64_t(uint8_t *dst)> ReadFunc;
+
+    /** Constructor.
+     * @param cfg Configuration properties
+     */
+    HedgedReader(PropertiesPtr &cfg);
+
+    /** Checks if hedged reads are enabled.
+     * @return <i>true</i> if enabled
+     */
+    bool enabled() { return m_enabled; }
+
+    /** Executes a read, hedging it with a second attempt if the first
+     * exceeds the adaptive latency threshold.  The winning attempt's data
+     * is copied into <code>dst</code>.
+     * @param len Buffer length (maximum amount read)
+     * @param dst Destination buffer
+     * @param func Read function
+     * @return Number of bytes read, or negative error code
+     */
+    int64_t read(size_t len, uint8_t *dst, ReadFunc func);
+
+  private:
+
+    /** Computes the hedge threshold from recent read latencies.
+     * @return Threshold in milliseconds, or 0 if too few samples exist
+     */
+    int64_t threshold_millis();
+
+    /** Records the latency of a completed read.
+     * @param latency_millis Latency in milliseconds
+     */
+    void record(int64_t latency_millis);
+
+    /// %Mutex for serializing access to the latency samples
+    std::mutex m_mutex;
+
+    /// Ring of recent read latencies (milliseconds)
+    std::vector<int64_t> m_samples;
+
+    /// Next slot in #m_samples to overwrite
+    size_t m_next_sample {};
+
+    /// Total number of samples recorded
+    uint64_t m_sample_count {};
+
+    /// <i>true</i> if hedged reads are enabled
+    bool m_enabled {};
+
+    /// Latency percentile that triggers a hedge
+    int32_t m_percentile {};
+
+    /// Lower bound on the hedge threshold (milliseconds)
+    int32_t m_min_timeout_millis {};
+  };
+
+  /// Smart pointer to HedgedReader
+  typedef std::shared_ptr<HedgedReader> HedgedReaderPtr;
+
+  /// @}
+
+}}}
+
+#endif // FsBroker_Lib_HedgedReader_h
@@ -0,0 +1,64 @@
+/*
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/// @file
+/// Definitions for LatencyHistogram.
+/// This file contains definitions for LatencyHistogram, a logarithmically
+/// bucketed histogram of operation latencies.
+
+#include <Common/Compat.h>
+
+#include "LatencyHistogram.h"
+
+#include <cstring>
+
+using namespace Hypertable::FsBroker::Lib;
+
+void LatencyHistogram::add(int64_t latency_nsec) {
+  uint64_t micros = (latency_nsec < 0) ? 0 : (uint64_t)(latency_nsec / 1000);
+  int bucket = 0;
+  while (bucket < BUCKET_COUNT-1 && micros >= ((uint64_t)1 << bucket))
+    bucket++;
+  m_buckets[bucket]++;
+  m_total++;
+}
+
+double LatencyHistogram::percentile_millis(int32_t percentile) const {
+  if (m_total == 0)
+    return 0.0;
+
+  uint64_t rank = (m_total * (uint64_t)percentile) / 100;
+  if (rank >= m_total)
+    rank = m_total - 1;
+
+  uint64_t cumulative = 0;
+  for (int bucket = 0; bucket < BUCKET_COUNT; bucket++) {
+    cumulative += m_buckets[bucket];
+    if (cumulative > rank)
+      return ((double)((uint64_t)1 << bucket)) / 1000.0;
+  }
+  return ((double)((uint64_t)1 << (BUCKET_COUNT-1))) / 1000.0;
+}
+
+void LatencyHistogram::clear() {
+  memset(m_buckets, 0, sizeof(m_buckets));
+  m_total = 0;
+}
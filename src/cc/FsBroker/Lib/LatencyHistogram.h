@@ -0,0 +1,84 @@
+/* -*- c++ -*-
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/// @file
+/// Declarations for LatencyHistogram.
+/// This file contains declarations for LatencyHistogram, a logarithmically
+/// bucketed histogram of operation latencies.
+
+#ifndef FsBroker_Lib_LatencyHistogram_h
+#define FsBroker_Lib_LatencyHistogram_h
+
+#include <cstdint>
+
+namespace Hypertable {
+namespace FsBroker {
+namespace Lib {
+
+  /// @addtogroup FsBrokerLib
+  /// @{
+
+  /** Logarithmically bucketed histogram of operation latencies.  Latencies
+   * are recorded into power-of-two microsecond buckets, so the histogram
+   * covers nanoseconds through minutes in a fixed, small footprint while
+   * preserving relative precision at every magnitude, and percentiles can
+   * be extracted without retaining samples.  Not thread safe; callers
+   * serialize access.
+   */
+  class LatencyHistogram {
+  public:
+
+    /** Adds a latency sample.
+     * @param latency_nsec Latency in nanoseconds
+     */
+    void add(int64_t latency_nsec);
+
+    /** Returns the number of samples recorded.
+     * @return Sample count
+     */
+    uint64_t total() const { return m_total; }
+
+    /** Computes an approximate latency percentile.
+     * @param percentile Percentile to compute (0-100)
+     * @return Latency in milliseconds, or 0.0 if the histogram is empty
+     */
+    double percentile_millis(int32_t percentile) const;
+
+    /// Removes all samples.
+    void clear();
+
+  private:
+
+    /// Number of power-of-two microsecond buckets (covers up to ~17 minutes)
+    static const int BUCKET_COUNT = 31;
+
+    /// Sample counts per bucket
+    uint64_t m_buckets[BUCKET_COUNT] {};
+
+    /// Total number of samples
+    uint64_t m_total {};
+  };
+
+  /// @}
+
+}}}
+
+#endif // FsBroker_Lib_LatencyHistogram_h
@@ -45,6 +45,7 @@ MetricsHandler::MetricsHandler(PropertiesPtr &props, const std::string &type)
   : m_type(type) {
   m_ganglia_collector = std::make_shared<MetricsCollectorGanglia>("fsbroker", props);
   m_collection_interval = props->get_i32("Hypertable.Monitoring.Interval");
+  m_slow_threshold_millis = props->get_i32("FsBroker.SlowOpThreshold");
   m_last_timestamp = Hypertable::get_ts64();
   m_comm = Comm::instance();
 }
@@ -87,6 +88,20 @@ void MetricsHandler::handle(Hypertable::EventPtr &event) {
         m_ganglia_collector->update("writeThroughput", (int)mbps);
       }
 
+      static const char *op_names[OP_COUNT] = {"open", "read", "append",
+                                               "sync"};
+      for (int op = 0; op < OP_COUNT; op++) {
+        if (m_op_histograms[op].total() > 0) {
+          m_ganglia_collector->update(format("%sLatencyP50", op_names[op]),
+                                      m_op_histograms[op].percentile_millis(50));
+          m_ganglia_collector->update(format("%sLatencyP95", op_names[op]),
+                                      m_op_histograms[op].percentile_millis(95));
+          m_ganglia_collector->update(format("%sLatencyP99", op_names[op]),
+                                      m_op_histograms[op].percentile_millis(99));
+        }
+        m_op_histograms[op].clear();
+      }
+
       m_last_timestamp = now;
       m_errors = 0;
       m_syncs = 0;
@@ -27,6 +27,8 @@
 #ifndef FsBroker_Lib_MetricsHandler_h
 #define FsBroker_Lib_MetricsHandler_h
 
+#include "LatencyHistogram.h"
+
 #include <AsyncComm/Comm.h>
 #include <AsyncComm/DispatchHandler.h>
 
@@ -114,6 +116,41 @@ namespace Lib {
       m_errors++;
     }
 
+    /// Operation types tracked by per-operation latency histograms
+    enum OperationType {
+      /// Open (and create)
+      OP_OPEN = 0,
+      /// Read (read, pread, preadv)
+      OP_READ,
+      /// Append
+      OP_APPEND,
+      /// Sync (and flush)
+      OP_SYNC,
+      /// Number of operation types
+      OP_COUNT
+    };
+
+    /// Records an operation latency.
+    /// Adds <code>latency_nsec</code> to the histogram of operation type
+    /// <code>op</code>.
+    /// @param op Operation type
+    /// @param latency_nsec Latency of operation in nanoseconds
+    void add_operation(OperationType op, int64_t latency_nsec) {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_op_histograms[op].add(latency_nsec);
+    }
+
+    /// Checks an operation latency against the slow operation threshold.
+    /// The threshold comes from the
+    /// <code>FsBroker.SlowOpThreshold</code> property; a value of zero
+    /// disables slow operation logging.
+    /// @param latency_nsec Latency of operation in nanoseconds
+    /// @return <i>true</i> if the operation should be logged as slow
+    bool slow_operation(int64_t latency_nsec) {
+      return m_slow_threshold_millis > 0 &&
+        (latency_nsec / 1000000LL) >= m_slow_threshold_millis;
+    }
+
   private:
     /// %Mutex for serializing access to members
     std::mutex m_mutex;
@@ -151,6 +188,12 @@ namespace Lib {
     /// Error count since last metrics collection
     int32_t m_errors {};
 
+    /// Per-operation latency histograms since last metrics collection
+    LatencyHistogram m_op_histograms[OP_COUNT];
+
+    /// Slow operation log threshold (milliseconds, zero disables)
+    int32_t m_slow_threshold_millis {};
+
   };
 
   /// Smart pointer to MetricsHandler
@@ -0,0 +1,116 @@
+/*
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/// @file
+/// Definitions for ReadCache.
+/// This file contains definitions for ReadCache, a broker-side read-through
+/// cache of file regions served by positioned reads.
+
+#include <Common/Compat.h>
+
+#include "ReadCache.h"
+
+#include <Common/Logger.h>
+
+#include <cstring>
+
+using namespace Hypertable;
+using namespace Hypertable::FsBroker::Lib;
+using namespace std;
+
+ReadCache::~ReadCache() {
+  for (auto &entry : m_lru)
+    delete [] entry.data;
+}
+
+bool ReadCache::lookup(const String &fname, uint64_t offset, uint32_t amount,
+                       StaticBuffer &buf) {
+  lock_guard<mutex> lock(m_mutex);
+
+  m_accesses++;
+
+  auto iter = m_entry_map.find(make_pair(fname, offset));
+  if (iter == m_entry_map.end() || iter->second->amount != amount)
+    return false;
+
+  m_lru.splice(m_lru.begin(), m_lru, iter->second);
+
+  Entry &entry = *iter->second;
+  StaticBuffer copy((size_t)entry.length);
+  memcpy(copy.base, entry.data, entry.length);
+  buf = copy;
+
+  m_hits++;
+  return true;
+}
+
+void ReadCache::insert(const String &fname, uint64_t offset, uint32_t amount,
+                       const uint8_t *data, uint32_t length) {
+  lock_guard<mutex> lock(m_mutex);
+
+  if (m_limit == 0 || (int64_t)length > m_limit)
+    return;
+
+  if (m_entry_map.find(make_pair(fname, offset)) != m_entry_map.end())
+    return;
+
+  while (m_available < (int64_t)length)
+    evict();
+
+  Entry entry;
+  entry.fname = fname;
+  entry.offset = offset;
+  entry.amount = amount;
+  entry.data = new uint8_t [length];
+  entry.length = length;
+  memcpy(entry.data, data, length);
+
+  m_lru.push_front(entry);
+  m_entry_map[make_pair(fname, offset)] = m_lru.begin();
+  m_available -= length;
+}
+
+void ReadCache::invalidate(const String &fname) {
+  lock_guard<mutex> lock(m_mutex);
+
+  auto iter = m_entry_map.lower_bound(make_pair(fname, 0));
+  while (iter != m_entry_map.end() && iter->first.first == fname) {
+    m_available += iter->second->length;
+    delete [] iter->second->data;
+    m_lru.erase(iter->second);
+    iter = m_entry_map.erase(iter);
+  }
+}
+
+void ReadCache::get_stats(uint64_t *accessesp, uint64_t *hitsp) {
+  lock_guard<mutex> lock(m_mutex);
+  *accessesp = m_accesses;
+  *hitsp = m_hits;
+}
+
+void ReadCache::evict() {
+  HT_ASSERT(!m_lru.empty());
+  Entry &entry = m_lru.back();
+  m_available += entry.length;
+  m_entry_map.erase(make_pair(entry.fname, entry.offset));
+  delete [] entry.data;
+  m_lru.pop_back();
+}
@@ -0,0 +1,157 @@
+/* -*- c++ -*-
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/// @file
+/// Declarations for ReadCache.
+/// This file contains declarations for ReadCache, a broker-side read-through
+/// cache of file regions served by positioned reads.
+
+#ifndef FsBroker_Lib_ReadCache_h
+#define FsBroker_Lib_ReadCache_h
+
+#include <Common/StaticBuffer.h>
+#include <Common/String.h>
+
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+namespace Hypertable {
+namespace FsBroker {
+namespace Lib {
+
+  /// @addtogroup FsBrokerLib
+  /// @{
+
+  /** Broker-side read-through cache of file regions.  Brokers that fetch
+   * data from a remote distributed file system (qfs, ceph) pay a network
+   * round-trip for every positioned read, so hot CellStore blocks read by
+   * multiple scanners amplify load on the backing store.  This cache keeps
+   * the most recently served (file, offset) regions in broker memory, bounded
+   * by the <code>FsBroker.ReadCache.MaxMemory</code> property; a limit of
+   * zero disables caching.  Entries are keyed by file name and offset and
+   * only hit when the requested amount matches, which is the common case for
+   * fixed-size CellStore block reads.  Hypertable files are written once,
+   * but entries are invalidated on remove and rename to stay safe when a
+   * path is reused.
+   */
+  class ReadCache {
+  public:
+
+    /** Constructor.
+     * @param max_memory Maximum amount of memory used by cached regions,
+     * in bytes (zero disables the cache)
+     */
+    ReadCache(int64_t max_memory)
+      : m_limit(max_memory), m_available(max_memory) {}
+
+    ~ReadCache();
+
+    /** Checks if the cache is enabled.
+     * @return <i>true</i> if the memory limit is greater than zero
+     */
+    bool enabled() { return m_limit > 0; }
+
+    /** Looks up a cached file region.  On a hit, the cached data is copied
+     * into a freshly allocated buffer assigned to <code>buf</code> and the
+     * entry is moved to the most-recently-used position.
+     * @param fname File name
+     * @param offset File offset
+     * @param amount Amount requested
+     * @param buf Buffer to hold copy of cached data
+     * @return <i>true</i> on a hit, <i>false</i> otherwise
+     */
+    bool lookup(const String &fname, uint64_t offset, uint32_t amount,
+                StaticBuffer &buf);
+
+    /** Inserts a file region, copying <code>data</code> and evicting
+     * least-recently-used entries as needed to stay within the memory
+     * limit.  Regions larger than the limit and duplicate keys are ignored.
+     * @param fname File name
+     * @param offset File offset
+     * @param amount Amount that was requested
+     * @param data Pointer to region data
+     * @param length Length of region data
+     */
+    void insert(const String &fname, uint64_t offset, uint32_t amount,
+                const uint8_t *data, uint32_t length);
+
+    /** Drops all cached regions of a file.
+     * @param fname File name
+     */
+    void invalidate(const String &fname);
+
+    /** Gets cache statistics.
+     * @param accessesp Address of variable to hold access count
+     * @param hitsp Address of variable to hold hit count
+     */
+    void get_stats(uint64_t *accessesp, uint64_t *hitsp);
+
+  private:
+
+    /// Cached file region
+    struct Entry {
+      String fname;
+      uint64_t offset {};
+      uint32_t amount {};
+      uint8_t *data {};
+      uint32_t length {};
+    };
+
+    typedef std::list<Entry> EntryList;
+    typedef std::map<std::pair<String, uint64_t>, EntryList::iterator>
+      EntryMap;
+
+    /// Removes the least-recently-used entry
+    void evict();
+
+    /// %Mutex for serializing access to cache state
+    std::mutex m_mutex;
+
+    /// Cached regions in most-recently-used order
+    EntryList m_lru;
+
+    /// Index of cached regions by (file name, offset)
+    EntryMap m_entry_map;
+
+    /// Maximum amount of memory used by cached regions
+    int64_t m_limit {};
+
+    /// Memory still available for cached regions
+    int64_t m_available {};
+
+    /// Number of lookups
+    uint64_t m_accesses {};
+
+    /// Number of lookups that hit
+    uint64_t m_hits {};
+  };
+
+  /// Smart pointer to ReadCache
+  typedef std::shared_ptr<ReadCache> ReadCachePtr;
+
+  /// @}
+
+}}}
+
+#endif // FsBroker_Lib_ReadCache_h
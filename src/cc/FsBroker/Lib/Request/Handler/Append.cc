@@ -37,6 +37,7 @@
 #include <Common/Filesystem.h>
 #include <Common/Logger.h>
 #include <Common/Serialization.h>
+#include <Common/Time.h>
 
 using namespace Hypertable;
 using namespace Hypertable::FsBroker::Lib;
@@ -61,8 +62,16 @@ void Append::run() {
     if (remain < params.get_size())
       HT_THROW_INPUT_OVERRUN(remain, params.get_size());
 
+    int64_t start_time = get_ts64();
     m_broker->append(&cb, params.get_fd(), params.get_size(),
 		     ptr, static_cast<Filesystem::Flags>(params.get_flags()));
+    MetricsHandler *metrics = m_broker->metrics_handler();
+    if (metrics) {
+      int64_t latency = get_ts64() - start_time;
+      metrics->add_operation(MetricsHandler::OP_APPEND, latency);
+      if (metrics->slow_operation(latency))
+        HT_WARNF("Slow append (fd=%d, amount=%u): %lld ms", (int)params.get_fd(), (unsigned)params.get_size(), (Lld)(latency/1000000LL));
+    }
 
   }
   catch (Exception &e) {
@@ -35,6 +35,7 @@
 #include <Common/Error.h>
 #include <Common/Logger.h>
 #include <Common/Serialization.h>
+#include <Common/Time.h>
 
 using namespace Hypertable::FsBroker;
 using namespace Hypertable::FsBroker::Lib;
@@ -48,9 +49,17 @@ void Create::run() {
   try {
     Request::Parameters::Create params;
     params.decode(&ptr, &remain);
+    int64_t start_time = get_ts64();
     m_broker->create(&cb, params.get_name(), params.get_flags(),
 		     params.get_buffer_size(), params.get_replication(),
 		     params.get_block_size());
+    MetricsHandler *metrics = m_broker->metrics_handler();
+    if (metrics) {
+      int64_t latency = get_ts64() - start_time;
+      metrics->add_operation(MetricsHandler::OP_OPEN, latency);
+      if (metrics->slow_operation(latency))
+        HT_WARNF("Slow create (file=%s): %lld ms", params.get_name(), (Lld)(latency/1000000LL));
+    }
   }
   catch (Exception &e) {
     HT_ERROR_OUT << e << HT_END;
@@ -39,6 +39,7 @@
 #include "Mkdirs.h"
 #include "Open.h"
 #include "Pread.h"
+#include "Preadv.h"
 #include "Readdir.h"
 #include "Read.h"
 #include "Remove.h"
@@ -77,6 +78,8 @@ ApplicationHandler *Factory::create(Comm *comm, Broker *broker,
     return new Length(comm, broker, event);
   case FUNCTION_PREAD:
     return new Pread(comm, broker, event);
+  case FUNCTION_PREADV:
+    return new Preadv(comm, broker, event);
   case FUNCTION_MKDIRS:
     return new Mkdirs(comm, broker, event);
   case FUNCTION_STATUS:
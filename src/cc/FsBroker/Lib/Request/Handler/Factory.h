@@ -68,6 +68,7 @@ namespace Handler {
       FUNCTION_RENAME,   ///< Rename
       FUNCTION_DEBUG,    ///< Debug
       FUNCTION_SYNC,     ///< Sync
+      FUNCTION_PREADV,   ///< Preadv
       FUNCTION_MAX       ///< Maximum code marker
     };
 
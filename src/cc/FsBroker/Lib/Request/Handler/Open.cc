@@ -35,6 +35,7 @@
 #include <Common/Error.h>
 #include <Common/Logger.h>
 #include <Common/Serialization.h>
+#include <Common/Time.h>
 
 using namespace Hypertable;
 using namespace Hypertable::FsBroker::Lib;
@@ -48,8 +49,16 @@ void Open::run() {
   try {
     Request::Parameters::Open params;
     params.decode(&ptr, &remain);
+    int64_t start_time = get_ts64();
     m_broker->open(&cb, params.get_fname(), params.get_flags(),
 		   params.get_buffer_size());
+    MetricsHandler *metrics = m_broker->metrics_handler();
+    if (metrics) {
+      int64_t latency = get_ts64() - start_time;
+      metrics->add_operation(MetricsHandler::OP_OPEN, latency);
+      if (metrics->slow_operation(latency))
+        HT_WARNF("Slow open (file=%s): %lld ms", params.get_fname(), (Lld)(latency/1000000LL));
+    }
   }
   catch (Exception &e) {
     HT_ERROR_OUT << e << HT_END;
@@ -36,6 +36,7 @@
 #include <Common/Error.h>
 #include <Common/Logger.h>
 #include <Common/Serialization.h>
+#include <Common/Time.h>
 
 using namespace Hypertable;
 using namespace Hypertable::FsBroker::Lib;
@@ -49,8 +50,16 @@ void Pread::run() {
   try {
     Request::Parameters::Pread params;
     params.decode(&ptr, &remain);
+    int64_t start_time = get_ts64();
     m_broker->pread(&cb, params.get_fd(), params.get_offset(),
 		    params.get_amount(), params.get_verify_checksum());
+    MetricsHandler *metrics = m_broker->metrics_handler();
+    if (metrics) {
+      int64_t latency = get_ts64() - start_time;
+      metrics->add_operation(MetricsHandler::OP_READ, latency);
+      if (metrics->slow_operation(latency))
+        HT_WARNF("Slow pread (fd=%d, offset=%llu, amount=%u): %lld ms", (int)params.get_fd(), (Llu)params.get_offset(), (unsigned)params.get_amount(), (Lld)(latency/1000000LL));
+    }
   }
   catch (Exception &e) {
     HT_ERROR_OUT << e << HT_END;
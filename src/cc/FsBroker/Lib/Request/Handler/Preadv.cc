@@ -0,0 +1,68 @@
+/*
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/// @file
+/// Definitions for Preadv request handler.
+/// This file contains definitions for Preadv, a server-side request handler
+/// used to invoke the <i>preadv</i> function of a file system broker.
+
+#include <Common/Compat.h>
+
+#include "Preadv.h"
+
+#include <FsBroker/Lib/Request/Parameters/Preadv.h>
+#include <FsBroker/Lib/Response/Callback/Read.h>
+
+#include <AsyncComm/ResponseCallback.h>
+
+#include <Common/Error.h>
+#include <Common/Logger.h>
+#include <Common/Serialization.h>
+#include <Common/Time.h>
+
+using namespace Hypertable;
+using namespace Hypertable::FsBroker::Lib;
+using namespace Hypertable::FsBroker::Lib::Request::Handler;
+
+void Preadv::run() {
+  Response::Callback::Read cb(m_comm, m_event);
+  const uint8_t *ptr = m_event->payload;
+  size_t remain = m_event->payload_len;
+
+  try {
+    Request::Parameters::Preadv params;
+    params.decode(&ptr, &remain);
+    int64_t start_time = get_ts64();
+    m_broker->preadv(&cb, params.get_fd(), params.get_ranges(),
+		     params.get_verify_checksum());
+    MetricsHandler *metrics = m_broker->metrics_handler();
+    if (metrics) {
+      int64_t latency = get_ts64() - start_time;
+      metrics->add_operation(MetricsHandler::OP_READ, latency);
+      if (metrics->slow_operation(latency))
+        HT_WARNF("Slow preadv (fd=%d, ranges=%d): %lld ms", (int)params.get_fd(), (int)params.get_ranges().size(), (Lld)(latency/1000000LL));
+    }
+  }
+  catch (Exception &e) {
+    HT_ERROR_OUT << e << HT_END;
+    cb.error(e.code(), "Error handling PREADV message");
+  }
+}
@@ -35,6 +35,7 @@
 #include <Common/Error.h>
 #include <Common/Logger.h>
 #include <Common/Serialization.h>
+#include <Common/Time.h>
 
 using namespace Hypertable;
 using namespace Hypertable::FsBroker::Lib;
@@ -48,7 +49,15 @@ void Sync::run() {
   try {
     Request::Parameters::Sync params;
     params.decode(&ptr, &remain);
+    int64_t start_time = get_ts64();
     m_broker->sync(&cb, params.get_fd());
+    MetricsHandler *metrics = m_broker->metrics_handler();
+    if (metrics) {
+      int64_t latency = get_ts64() - start_time;
+      metrics->add_operation(MetricsHandler::OP_SYNC, latency);
+      if (metrics->slow_operation(latency))
+        HT_WARNF("Slow sync (fd=%d): %lld ms", (int)params.get_fd(), (Lld)(latency/1000000LL));
+    }
   }
   catch (Exception &e) {
     HT_ERROR_OUT << e << HT_END;
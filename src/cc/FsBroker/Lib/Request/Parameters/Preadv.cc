@@ -0,0 +1,70 @@
+/* -*- c++ -*-
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/// @file
+/// Definitions for Preadv request parameters.
+/// This file contains definitions for Preadv, a class for encoding and
+/// decoding paramters to the <i>preadv</i> file system broker function.
+
+#include <Common/Compat.h>
+
+#include "Preadv.h"
+
+#include <Common/Logger.h>
+#include <Common/Serialization.h>
+
+using namespace Hypertable;
+using namespace Hypertable::FsBroker::Lib::Request::Parameters;
+
+uint8_t Preadv::encoding_version() const {
+  return 1;
+}
+
+size_t Preadv::encoded_length_internal() const {
+  return 5 + Serialization::encoded_length_vi32(m_ranges.size()) +
+    (12 * m_ranges.size());
+}
+
+void Preadv::encode_internal(uint8_t **bufp) const {
+  Serialization::encode_i32(bufp, m_fd);
+  Serialization::encode_bool(bufp, m_verify_checksum);
+  Serialization::encode_vi32(bufp, m_ranges.size());
+  for (auto &range : m_ranges) {
+    Serialization::encode_i64(bufp, range.offset);
+    Serialization::encode_i32(bufp, range.amount);
+  }
+}
+
+void Preadv::decode_internal(uint8_t version, const uint8_t **bufp,
+			     size_t *remainp) {
+  (void)version;
+  m_fd = (int32_t)Serialization::decode_i32(bufp, remainp);
+  m_verify_checksum = Serialization::decode_bool(bufp, remainp);
+  size_t count = Serialization::decode_vi32(bufp, remainp);
+  m_ranges.clear();
+  m_ranges.reserve(count);
+  for (size_t i=0; i<count; i++) {
+    Filesystem::ReadRange range;
+    range.offset = Serialization::decode_i64(bufp, remainp);
+    range.amount = Serialization::decode_i32(bufp, remainp);
+    m_ranges.push_back(range);
+  }
+}
@@ -31,16 +31,44 @@
 #include <FsBroker/Lib/Response/Parameters/Read.h>
 
 #include <AsyncComm/CommBuf.h>
+#include <AsyncComm/ShmPayload.h>
 
+#include <Common/Config.h>
 #include <Common/Error.h>
 
 using namespace Hypertable;
 using namespace FsBroker::Lib::Response;
 
+namespace {
+
+  /// Minimum read size transferred via shared memory
+  uint32_t shm_min_payload() {
+    static uint32_t min_payload = Config::properties->get_i32(
+        "FsBroker.ShmPayload.MinSize");
+    return min_payload;
+  }
+
+}
+
 int Callback::Read::response(uint64_t offset, StaticBuffer &buffer) {
   CommHeader header;
   header.initialize_from_request_header(m_event->header);
   Parameters::Read params(offset, buffer.size);
+  // Colocated requesters that set FLAGS_BIT_SHM_PAYLOAD_OK receive the read
+  // payload through a shared memory segment, bypassing the network stack
+  if ((m_event->header.flags & CommHeader::FLAGS_BIT_SHM_PAYLOAD_OK) &&
+      buffer.size >= shm_min_payload()) {
+    uint8_t shm_ref[SHM_PAYLOAD_REF_LENGTH];
+    if (shm_payload_write(buffer.base, buffer.size, shm_ref)) {
+      header.flags |= CommHeader::FLAGS_BIT_SHM_PAYLOAD;
+      CommBufPtr cbuf( new CommBuf(header, 4+params.encoded_length()
+                                   + SHM_PAYLOAD_REF_LENGTH) );
+      cbuf->append_i32(Error::OK);
+      params.encode(cbuf->get_data_ptr_address());
+      cbuf->append_bytes(shm_ref, SHM_PAYLOAD_REF_LENGTH);
+      return m_comm->send_response(m_event->addr, cbuf);
+    }
+  }
   CommBufPtr cbuf( new CommBuf(header, 4+params.encoded_length(), buffer) );
   cbuf->append_i32(Error::OK);
   params.encode(cbuf->get_data_ptr_address());
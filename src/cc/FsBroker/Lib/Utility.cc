@@ -51,14 +51,16 @@ void FsBroker::Lib::copy(ClientPtr &client, const std::string &from,
   try {
 
     from_fd = client->open(from, 0);
-    if (offset > 0)
-      client->seek(from_fd, offset);
 
-    to_fd = client->create(to, Filesystem::OPEN_FLAG_OVERWRITE, -1, -1, -1);    
+    to_fd = client->create(to, Filesystem::OPEN_FLAG_OVERWRITE, -1, -1, -1);
 
-    client->read(from_fd, BUFFER_SIZE, &sync_handler);
-    client->read(from_fd, BUFFER_SIZE, &sync_handler);
-    client->read(from_fd, BUFFER_SIZE, &sync_handler);
+    uint64_t next_offset = (offset > 0) ? (uint64_t)offset : 0;
+    client->pread(from_fd, BUFFER_SIZE, next_offset, false, &sync_handler);
+    next_offset += BUFFER_SIZE;
+    client->pread(from_fd, BUFFER_SIZE, next_offset, false, &sync_handler);
+    next_offset += BUFFER_SIZE;
+    client->pread(from_fd, BUFFER_SIZE, next_offset, false, &sync_handler);
+    next_offset += BUFFER_SIZE;
 
     EventPtr event;
     uint8_t *dst;
@@ -79,7 +81,8 @@ void FsBroker::Lib::copy(ClientPtr &client, const std::string &from,
         break;
       }
 
-      client->read(from_fd, BUFFER_SIZE, &sync_handler);
+      client->pread(from_fd, BUFFER_SIZE, next_offset, false, &sync_handler);
+      next_offset += BUFFER_SIZE;
     }
 
     client->close(from_fd);
@@ -159,12 +162,13 @@ void FsBroker::Lib::copy_to_local(ClientPtr &client, const string &from, const s
 
     int32_t fd = client->open(from, 0);
 
-    if (offset > 0)
-      client->seek(fd, offset);
-
-    client->read(fd, BUFFER_SIZE, &sync_handler);
-    client->read(fd, BUFFER_SIZE, &sync_handler);
-    client->read(fd, BUFFER_SIZE, &sync_handler);
+    uint64_t next_offset = (offset > 0) ? (uint64_t)offset : 0;
+    client->pread(fd, BUFFER_SIZE, next_offset, false, &sync_handler);
+    next_offset += BUFFER_SIZE;
+    client->pread(fd, BUFFER_SIZE, next_offset, false, &sync_handler);
+    next_offset += BUFFER_SIZE;
+    client->pread(fd, BUFFER_SIZE, next_offset, false, &sync_handler);
+    next_offset += BUFFER_SIZE;
 
     EventPtr event;
     const uint8_t *dst;
@@ -184,7 +188,8 @@ void FsBroker::Lib::copy_to_local(ClientPtr &client, const string &from, const s
         break;
       }
 
-      client->read(fd, BUFFER_SIZE, &sync_handler);
+      client->pread(fd, BUFFER_SIZE, next_offset, false, &sync_handler);
+      next_offset += BUFFER_SIZE;
     }
 
     client->close(fd);
@@ -65,6 +65,9 @@ CephBroker::CephBroker(PropertiesPtr& cfg) {
   ceph_initialize(argc, argv);
   HT_INFO("Calling ceph_mount");
   ceph_mount();
+  m_read_cache = std::make_shared<Lib::ReadCache>(
+      cfg->get_i64("FsBroker.ReadCache.MaxMemory"));
+  m_hedged_reader = std::make_shared<Lib::HedgedReader>(cfg);
   HT_INFO("Returning from constructor");
 }
 
@@ -262,6 +265,8 @@ void CephBroker::remove(ResponseCallback *cb, const char *fname) {
   
   make_abs_path(fname, abspath);
   
+  m_read_cache->invalidate(abspath);
+  
   int r;
   if ((r = ceph_unlink(abspath.c_str())) < 0) {
     HT_ERRORF("unlink failed: file='%s' - %s", abspath.c_str(), strerror(-r));
@@ -305,7 +310,25 @@ void CephBroker::pread(Response::Callback::Read *cb, uint32_t fd, uint64_t offse
     return;
   }
 
-  if ((nread = ceph_read(fdata->fd, (char *)buf.base, amount, offset)) < 0) {
+  if (m_read_cache->enabled()) {
+    StaticBuffer cached;
+    if (m_read_cache->lookup(fdata->filename, offset, amount, cached)) {
+      cb->response(offset, cached);
+      return;
+    }
+  }
+
+  if (m_hedged_reader->enabled()) {
+    int ceph_fd = fdata->fd;
+    nread = (ssize_t)m_hedged_reader->read((size_t)amount, buf.base,
+        [ceph_fd, amount, offset](uint8_t *dst) -> int64_t {
+          return ceph_read(ceph_fd, (char *)dst, amount, offset);
+        });
+  }
+  else
+    nread = ceph_read(fdata->fd, (char *)buf.base, amount, offset);
+
+  if (nread < 0) {
     HT_ERRORF("pread failed: fd=%d ceph_fd=%d amount=%d offset=%llu - %s", fd, fdata->fd,
               amount, (Llu)offset, strerror(-nread));
     report_error(cb, nread);
@@ -314,9 +337,52 @@ void CephBroker::pread(Response::Callback::Read *cb, uint32_t fd, uint64_t offse
 
   buf.size = nread;
 
+  if (m_read_cache->enabled() && buf.size == amount)
+    m_read_cache->insert(fdata->filename, offset, amount, buf.base, buf.size);
+
   cb->response(offset, buf);
 }
 
+void CephBroker::preadv(Response::Callback::Read *cb, uint32_t fd,
+			const std::vector<Filesystem::ReadRange> &ranges,
+			bool) {
+  OpenFileDataCephPtr fdata;
+  ssize_t nread;
+  uint64_t total {};
+
+  for (auto &range : ranges)
+    total += range.amount;
+
+  StaticBuffer buf(new uint8_t [total], total);
+
+  HT_DEBUGF("preadv fd=%d ranges=%d amount=%llu", fd, (int)ranges.size(),
+            (Llu)total);
+
+  if (!m_open_file_map.get(fd, fdata)) {
+    char errbuf[32];
+    sprintf(errbuf, "%d", fd);
+    cb->error(Error::FSBROKER_BAD_FILE_HANDLE, errbuf);
+    return;
+  }
+
+  buf.size = 0;
+  for (auto &range : ranges) {
+    if ((nread = ceph_read(fdata->fd, (char *)buf.base + buf.size,
+			   range.amount, range.offset)) < 0) {
+      HT_ERRORF("preadv failed: fd=%d ceph_fd=%d amount=%d offset=%llu - %s",
+		fd, fdata->fd, range.amount, (Llu)range.offset,
+		strerror(-nread));
+      report_error(cb, nread);
+      return;
+    }
+    buf.size += nread;
+    if (nread < (ssize_t)range.amount)
+      break;
+  }
+
+  cb->response(ranges.empty() ? 0 : ranges.front().offset, buf);
+}
+
 void CephBroker::mkdirs(ResponseCallback *cb, const char *dname) {
   String absdir;
 
@@ -466,6 +532,8 @@ void CephBroker::rename(ResponseCallback *cb, const char *src, const char *dst)
 
   make_abs_path(src, src_abs);
   make_abs_path(dst, dest_abs);
+  m_read_cache->invalidate(src_abs);
+  m_read_cache->invalidate(dest_abs);
   if ((r = ceph_rename(src_abs.c_str(), dest_abs.c_str())) <0 ) {
     report_error(cb, r);
     return;
@@ -21,6 +21,8 @@
 #define FsBroker_ceph_CephBroker_h
 
 #include <FsBroker/Lib/Broker.h>
+#include <FsBroker/Lib/HedgedReader.h>
+#include <FsBroker/Lib/ReadCache.h>
 
 #include <Common/Properties.h>
 #include <Common/Status.h>
@@ -75,6 +77,9 @@ namespace FsBroker {
                         bool accurate = true);
     virtual void pread(Response::Callback::Read *cb, uint32_t fd, uint64_t offset,
                        uint32_t amount, bool verify_checksum);
+    virtual void preadv(Response::Callback::Read *cb, uint32_t fd,
+                        const std::vector<Filesystem::ReadRange> &ranges,
+                        bool verify_checksum);
     virtual void mkdirs(ResponseCallback *cb, const char *dname);
     virtual void rmdir(ResponseCallback *cb, const char *dname);
     virtual void flush(ResponseCallback *cb, uint32_t fd);
@@ -104,6 +109,12 @@ namespace FsBroker {
     /// Server status information
     Hypertable::Status m_status;
 
+    /// Read-through cache of file regions
+    Lib::ReadCachePtr m_read_cache;
+
+    /// Hedged read helper
+    Lib::HedgedReaderPtr m_hedged_reader;
+
     bool m_verbose;
     String m_root_dir;
   };
@@ -32,6 +32,7 @@
 
 #include <AsyncComm/ReactorFactory.h>
 
+#include <algorithm>
 #include <cerrno>
 #include <chrono>
 #include <cstdio>
@@ -66,6 +67,7 @@ LocalBroker::LocalBroker(PropertiesPtr &cfg) {
     m_directio = cfg->get_bool("DfsBroker.Local.DirectIO");
   else
     m_directio = cfg->get_bool("FsBroker.Local.DirectIO");
+  m_mmap_reads = cfg->get_bool("FsBroker.Local.MmapReads");
 
   m_metrics_handler = std::make_shared<MetricsHandler>(cfg, "local");
   m_metrics_handler->start_collecting();
@@ -124,7 +126,9 @@ LocalBroker::open(Response::Callback::Open *cb, const char *fname,
 
   int oflags = O_RDONLY;
 
-  if (m_directio && flags & Filesystem::OPEN_FLAG_DIRECTIO) {
+  // In mmap read mode positioned reads are served from the page cache via a
+  // read-only mapping, which supersedes direct I/O
+  if (!m_mmap_reads && m_directio && flags & Filesystem::OPEN_FLAG_DIRECTIO) {
 #ifdef O_DIRECT
     oflags |= O_DIRECT;
 #endif
@@ -154,6 +158,25 @@ LocalBroker::open(Response::Callback::Open *cb, const char *fname,
     struct sockaddr_in addr;
     OpenFileDataLocalPtr fdata(new OpenFileDataLocal(fname, local_fd, O_RDONLY));
 
+    if (m_mmap_reads) {
+      struct stat statbuf;
+      if (fstat(local_fd, &statbuf) == 0 && statbuf.st_size > 0) {
+        void *base = mmap(0, statbuf.st_size, PROT_READ, MAP_SHARED,
+                          local_fd, 0);
+        if (base == MAP_FAILED)
+          HT_WARNF("mmap failed: file='%s' length=%llu - %s", abspath.c_str(),
+                   (Llu)statbuf.st_size, strerror(errno));
+        else {
+          fdata->mapbase = (uint8_t *)base;
+          fdata->maplen = statbuf.st_size;
+          // Buffered opens imply a sequential scan, otherwise assume random
+          // block reads
+          madvise(base, statbuf.st_size,
+                  bufsz ? MADV_SEQUENTIAL : MADV_RANDOM);
+        }
+      }
+    }
+
     cb->get_address(addr);
 
     m_open_file_map.create(fd, addr, fdata);
@@ -442,8 +465,6 @@ LocalBroker::pread(Response::Callback::Read *cb, uint32_t fd, uint64_t offset,
 
   HT_DEBUGF("pread fd=%d offset=%llu amount=%d", fd, (Llu)offset, amount);
 
-  StaticBuffer buf((size_t)amount, (size_t)HT_DIRECT_IO_ALIGNMENT);
-
   if (!m_open_file_map.get(fd, fdata)) {
     char errbuf[32];
     sprintf(errbuf, "%d", fd);
@@ -452,6 +473,25 @@ LocalBroker::pread(Response::Callback::Read *cb, uint32_t fd, uint64_t offset,
     return;
   }
 
+  if (fdata->mapbase) {
+    // Respond with a direct reference into the mapping; the mapping stays
+    // alive until the file is closed
+    StaticBuffer mbuf;
+    mbuf.size = (offset >= fdata->maplen) ? 0
+      : (uint32_t)std::min((uint64_t)amount, fdata->maplen - offset);
+    mbuf.base = fdata->mapbase + (mbuf.size ? offset : 0);
+    mbuf.own = false;
+    m_metrics_handler->add_bytes_read(mbuf.size);
+    m_status_manager.clear_status();
+    if ((error = cb->response(offset, mbuf)) != Error::OK)
+      HT_ERRORF("Problem sending response for pread(%u, %llu, %u) - %s",
+                (unsigned)fd, (Llu)offset, (unsigned)amount,
+                Error::get_text(error));
+    return;
+  }
+
+  StaticBuffer buf((size_t)amount, (size_t)HT_DIRECT_IO_ALIGNMENT);
+
   nread = FileUtils::pread(fdata->fd, buf.base, buf.aligned_size(), (off_t)offset);
   if (nread != (ssize_t)buf.aligned_size()) {
     int error = errno;
@@ -472,6 +512,83 @@ LocalBroker::pread(Response::Callback::Read *cb, uint32_t fd, uint64_t offset,
 }
 
 
+void
+LocalBroker::preadv(Response::Callback::Read *cb, uint32_t fd,
+                    const std::vector<Filesystem::ReadRange> &ranges, bool) {
+  OpenFileDataLocalPtr fdata;
+  ssize_t nread;
+  uint64_t total {};
+  int error;
+
+  for (auto &range : ranges)
+    total += range.amount;
+
+  HT_DEBUGF("preadv fd=%d ranges=%d amount=%llu", fd, (int)ranges.size(),
+            (Llu)total);
+
+  StaticBuffer buf((size_t)total, (size_t)HT_DIRECT_IO_ALIGNMENT);
+
+  if (!m_open_file_map.get(fd, fdata)) {
+    char errbuf[32];
+    sprintf(errbuf, "%d", fd);
+    cb->error(Error::FSBROKER_BAD_FILE_HANDLE, errbuf);
+    m_metrics_handler->increment_error_count();
+    return;
+  }
+
+  uint8_t *ptr = buf.base;
+
+  if (fdata->mapbase) {
+    buf.size = 0;
+    for (auto &range : ranges) {
+      if (range.offset >= fdata->maplen)
+        break;
+      uint32_t navail = (uint32_t)std::min((uint64_t)range.amount,
+                                           fdata->maplen - range.offset);
+      memcpy(ptr, fdata->mapbase + range.offset, navail);
+      ptr += navail;
+      buf.size += navail;
+      if (navail < range.amount)
+        break;
+    }
+    m_metrics_handler->add_bytes_read(buf.size);
+    m_status_manager.clear_status();
+    uint64_t response_offset = ranges.empty() ? 0 : ranges.front().offset;
+    if ((error = cb->response(response_offset, buf)) != Error::OK)
+      HT_ERRORF("Problem sending response for preadv(%u, %d ranges) - %s",
+                (unsigned)fd, (int)ranges.size(), Error::get_text(error));
+    return;
+  }
+
+  // Each range is read through its own aligned bounce buffer since the
+  // packed destination offsets are not necessarily aligned for direct I/O
+  for (auto &range : ranges) {
+    StaticBuffer rbuf((size_t)range.amount, (size_t)HT_DIRECT_IO_ALIGNMENT);
+    nread = FileUtils::pread(fdata->fd, rbuf.base, rbuf.aligned_size(),
+                             (off_t)range.offset);
+    if (nread != (ssize_t)rbuf.aligned_size()) {
+      int error = errno;
+      report_error(cb);
+      m_status_manager.set_read_error(error);
+      HT_ERRORF("preadv failed: fd=%d amount=%d aligned_size=%d offset=%llu "
+                "- %s", fdata->fd, (int)range.amount,
+                (int)rbuf.aligned_size(), (Llu)range.offset, strerror(errno));
+      return;
+    }
+    memcpy(ptr, rbuf.base, range.amount);
+    ptr += range.amount;
+  }
+
+  m_metrics_handler->add_bytes_read(total);
+  m_status_manager.clear_status();
+
+  uint64_t offset = ranges.empty() ? 0 : ranges.front().offset;
+  if ((error = cb->response(offset, buf)) != Error::OK)
+    HT_ERRORF("Problem sending response for preadv(%u, %d ranges) - %s",
+              (unsigned)fd, (int)ranges.size(), Error::get_text(error));
+}
+
+
 void LocalBroker::mkdirs(ResponseCallback *cb, const char *dname) {
   String absdir;
   int error;
@@ -33,6 +33,7 @@
 #include <string>
 
 extern "C" {
+#include <sys/mman.h>
 #include <unistd.h>
 }
 
@@ -45,11 +46,17 @@ namespace FsBroker {
   public:
   OpenFileDataLocal(const String &fname, int _fd, int _flags) : fd(_fd), flags(_flags), filename(fname) { }
     virtual ~OpenFileDataLocal() {
+      if (mapbase)
+        munmap(mapbase, maplen);
       close(fd);
     }
     int  fd;
     int  flags;
     String filename;
+    /// Read-only mapping of the file (mmap read mode)
+    uint8_t *mapbase {};
+    /// Length of mapping
+    uint64_t maplen {};
   };
 
   class OpenFileDataLocalPtr : public OpenFileDataPtr {
@@ -67,6 +74,8 @@ namespace FsBroker {
     LocalBroker(PropertiesPtr &props);
     virtual ~LocalBroker();
 
+    virtual MetricsHandler *metrics_handler() { return m_metrics_handler.get(); }
+
     virtual void open(Response::Callback::Open *cb, const char *fname,
                       uint32_t flags, uint32_t bufsz);
     virtual void create(Response::Callback::Open *cb, const char *fname, uint32_t flags,
@@ -81,6 +90,9 @@ namespace FsBroker {
                     bool accurate = true);
     virtual void pread(Response::Callback::Read *cb, uint32_t fd, uint64_t offset,
                        uint32_t amount, bool verify_checksum);
+    virtual void preadv(Response::Callback::Read *cb, uint32_t fd,
+                        const std::vector<Filesystem::ReadRange> &ranges,
+                        bool verify_checksum);
     virtual void mkdirs(ResponseCallback *cb, const char *dname);
     virtual void rmdir(ResponseCallback *cb, const char *dname);
     virtual void readdir(Response::Callback::Readdir *cb, const char *dname);
@@ -108,6 +120,7 @@ namespace FsBroker {
     String m_rootdir;
     bool m_verbose;
     bool m_directio;
+    bool m_mmap_reads;
     bool m_no_removal;
   };
 
@@ -394,6 +394,63 @@ MaprBroker::pread(Response::Callback::Read *cb, uint32_t fd, uint64_t offset,
 }
 
 
+void
+MaprBroker::preadv(Response::Callback::Read *cb, uint32_t fd,
+		   const std::vector<Filesystem::ReadRange> &ranges, bool) {
+  OpenFileDataMaprPtr fdata;
+  ssize_t nread;
+  uint8_t *readbuf;
+  uint64_t total {};
+  int error;
+
+  for (auto &range : ranges)
+    total += range.amount;
+
+  HT_DEBUGF("preadv fd=%d ranges=%d amount=%llu", fd, (int)ranges.size(),
+            (Llu)total);
+
+#if defined(__linux__)
+  void *vptr = 0;
+  HT_ASSERT(posix_memalign(&vptr, HT_DIRECT_IO_ALIGNMENT, total) == 0);
+  readbuf = (uint8_t *)vptr;
+#else
+  readbuf = new uint8_t [total];
+#endif
+
+  StaticBuffer buf(readbuf, total);
+
+  if (!m_open_file_map.get(fd, fdata)) {
+    char errbuf[32];
+    sprintf(errbuf, "%d", fd);
+    cb->error(Error::FSBROKER_BAD_FILE_HANDLE, errbuf);
+    m_metrics_handler->increment_error_count();
+    return;
+  }
+
+  buf.size = 0;
+  for (auto &range : ranges) {
+    if ((nread = hdfsPread(m_filesystem, fdata->file, (tOffset)range.offset,
+                           buf.base + buf.size, (tSize)range.amount)) == -1) {
+      report_error(cb);
+      HT_ERRORF("preadv failed: fd=%d amount=%d offset=%llu - %s", fd,
+                range.amount, (Llu)range.offset, strerror(errno));
+      return;
+    }
+    buf.size += nread;
+    if (nread < (ssize_t)range.amount)
+      break;
+  }
+
+  m_metrics_handler->add_bytes_read(buf.size);
+
+  if ((error = cb->response(ranges.empty() ? 0 : ranges.front().offset, buf))
+      != Error::OK)
+    HT_ERRORF("Problem sending response for preadv(%u, %d ranges) - %s",
+              (unsigned)fd, (int)ranges.size(), Error::get_text(error));
+
+}
+
+
 void MaprBroker::mkdirs(ResponseCallback *cb, const char *dname) {
   int error;
 
@@ -73,6 +73,8 @@ namespace FsBroker {
     MaprBroker(PropertiesPtr &props);
     virtual ~MaprBroker();
 
+    virtual MetricsHandler *metrics_handler() { return m_metrics_handler.get(); }
+
     virtual void open(Response::Callback::Open *cb, const char *fname,
                       uint32_t flags, uint32_t bufsz);
     virtual void create(Response::Callback::Open *cb, const char *fname, uint32_t flags,
@@ -87,6 +89,9 @@ namespace FsBroker {
                         bool accurate = true);
     virtual void pread(Response::Callback::Read *cb, uint32_t fd, uint64_t offset,
                        uint32_t amount, bool verify_checksum);
+    virtual void preadv(Response::Callback::Read *cb, uint32_t fd,
+                        const std::vector<Filesystem::ReadRange> &ranges,
+                        bool verify_checksum);
     virtual void mkdirs(ResponseCallback *cb, const char *dname);
     virtual void rmdir(ResponseCallback *cb, const char *dname);
     virtual void readdir(Response::Callback::Readdir *cb, const char *dname);
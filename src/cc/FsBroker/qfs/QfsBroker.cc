@@ -57,6 +57,9 @@ QfsBroker::QfsBroker(PropertiesPtr &cfg)
     m_client(KFS::Connect(m_host, m_port)) {
   m_metrics_handler = std::make_shared<MetricsHandler>(cfg, "qfs");
   m_metrics_handler->start_collecting();
+  m_read_cache =
+    std::make_shared<ReadCache>(cfg->get_i64("FsBroker.ReadCache.MaxMemory"));
+  m_hedged_reader = std::make_shared<HedgedReader>(cfg);
 }
 
 QfsBroker::~QfsBroker() {
@@ -212,6 +215,7 @@ void QfsBroker::append(Response::Callback::Append *cb, uint32_t fd, uint32_t amo
 }
 
 void QfsBroker::remove(ResponseCallback *cb, const char *fname) {
+  m_read_cache->invalidate(fname);
   int status = m_client->Remove(fname);
   if(status == 0)
     cb->response_ok();
@@ -249,10 +253,29 @@ void QfsBroker::pread(Response::Callback::Read *cb, uint32_t fd, uint64_t offset
       HT_WARNF("Checksum verification of fd=%d (qfsFd=%d) failed - %s", fd,
                fdata->fd, KFS::ErrorCodeToStr(status).c_str());
   }
+  else if (m_read_cache->enabled()) {
+    StaticBuffer cached;
+    if (m_read_cache->lookup(fdata->fname, offset, amount, cached)) {
+      m_metrics_handler->add_bytes_read(cached.size);
+      cb->response(offset, cached);
+      return;
+    }
+  }
 
   StaticBuffer buf((size_t)amount, (size_t)HT_DIRECT_IO_ALIGNMENT);
-  ssize_t status = m_client->PRead(fdata->fd, offset,
-                                   reinterpret_cast<char*>(buf.base), amount);
+  ssize_t status;
+  if (m_hedged_reader->enabled()) {
+    KFS::KfsClient *client = m_client;
+    int qfs_fd = fdata->fd;
+    status = (ssize_t)m_hedged_reader->read((size_t)amount, buf.base,
+        [client, qfs_fd, offset, amount](uint8_t *dst) -> int64_t {
+          return client->PRead(qfs_fd, offset,
+                               reinterpret_cast<char *>(dst), amount);
+        });
+  }
+  else
+    status = m_client->PRead(fdata->fd, offset,
+                             reinterpret_cast<char*>(buf.base), amount);
   if(status < 0) {
     m_status_manager.set_read_status(Status::Code::CRITICAL,
                                      KFS::ErrorCodeToStr(status));
@@ -263,11 +286,59 @@ void QfsBroker::pread(Response::Callback::Read *cb, uint32_t fd, uint64_t offset
   }
   else {
     buf.size = (uint32_t)status;
+    if (m_read_cache->enabled() && buf.size == amount)
+      m_read_cache->insert(fdata->fname, offset, amount, buf.base, buf.size);
     m_metrics_handler->add_bytes_read(buf.size);
     cb->response(offset, buf);
   }
 }
 
+void QfsBroker::preadv(Response::Callback::Read *cb, uint32_t fd,
+                       const std::vector<Filesystem::ReadRange> &ranges,
+                       bool verify_checksum) {
+
+  OpenFileDataQfsPtr fdata;
+  if (!m_open_file_map.get(fd, fdata)) {
+    cb->error(Error::FSBROKER_BAD_FILE_HANDLE, format("%d", (int)fd));
+    m_metrics_handler->increment_error_count();
+    return;
+  }
+
+  if (verify_checksum) {
+    int status = m_client->VerifyDataChecksums(fdata->fd);
+    if (status < 0)
+      HT_WARNF("Checksum verification of fd=%d (qfsFd=%d) failed - %s", fd,
+               fdata->fd, KFS::ErrorCodeToStr(status).c_str());
+  }
+
+  uint64_t total {};
+  for (auto &range : ranges)
+    total += range.amount;
+
+  StaticBuffer buf((size_t)total, (size_t)HT_DIRECT_IO_ALIGNMENT);
+  buf.size = 0;
+  for (auto &range : ranges) {
+    ssize_t status = m_client->PRead(fdata->fd, range.offset,
+                                     reinterpret_cast<char*>(buf.base + buf.size),
+                                     range.amount);
+    if (status < 0) {
+      m_status_manager.set_read_status(Status::Code::CRITICAL,
+                                       KFS::ErrorCodeToStr(status));
+      HT_ERRORF("preadv(fd=%d,qfsFd=%d,%lld,%lld) failure (%d) - %s", (int)fd,
+                (int)fdata->fd, (Lld)range.offset, (Lld)range.amount,
+                (int)-status, KFS::ErrorCodeToStr(status).c_str());
+      report_error(cb, status);
+      return;
+    }
+    buf.size += (uint32_t)status;
+    if (status < (ssize_t)range.amount)
+      break;
+  }
+
+  m_metrics_handler->add_bytes_read(buf.size);
+  cb->response(ranges.empty() ? 0 : ranges.front().offset, buf);
+}
+
 void QfsBroker::mkdirs(ResponseCallback *cb, const char *dname) {
   int status = m_client->Mkdirs(dname);
   if(status < 0) {
@@ -347,6 +418,8 @@ void QfsBroker::exists(Response::Callback::Exists *cb, const char *fname) {
 }
 
 void QfsBroker::rename(ResponseCallback *cb, const char *src, const char *dst) {
+  m_read_cache->invalidate(src);
+  m_read_cache->invalidate(dst);
   int err = m_client->Rename(src, dst);
   if(err == 0)
     cb->response_ok();
@@ -24,6 +24,8 @@
 
 #include <FsBroker/Lib/Broker.h>
 #include <FsBroker/Lib/MetricsHandler.h>
+#include <FsBroker/Lib/HedgedReader.h>
+#include <FsBroker/Lib/ReadCache.h>
 #include <FsBroker/Lib/StatusManager.h>
 
 #include <Common/Properties.h>
@@ -71,6 +73,8 @@ namespace FsBroker {
     QfsBroker(PropertiesPtr& cfg);
     virtual ~QfsBroker();
 
+    virtual MetricsHandler *metrics_handler() { return m_metrics_handler.get(); }
+
     virtual void open(Response::Callback::Open *cb, const char *fname, uint32_t flags, uint32_t bufsz);
     virtual void close(ResponseCallback *cb, uint32_t fd);
 
@@ -83,6 +87,9 @@ namespace FsBroker {
                         bool accurate = true);
     virtual void pread(Response::Callback::Read *cb, uint32_t fd, uint64_t offset,
                        uint32_t amount, bool verify_checksum);
+    virtual void preadv(Response::Callback::Read *cb, uint32_t fd,
+                        const std::vector<Filesystem::ReadRange> &ranges,
+                        bool verify_checksum);
     virtual void mkdirs(ResponseCallback *cb, const char *dname);
     virtual void rmdir(ResponseCallback *cb, const char *dname);
     virtual void flush(ResponseCallback *cb, uint32_t fd);
@@ -105,6 +112,12 @@ namespace FsBroker {
     /// Server status manager
     StatusManager m_status_manager;
 
+    /// Read-through cache of file regions
+    ReadCachePtr m_read_cache;
+
+    /// Hedged read helper
+    HedgedReaderPtr m_hedged_reader;
+
     std::string m_host;
     int m_port;
     void report_error(ResponseCallback *cb, int error);
@@ -40,6 +40,7 @@
 #include <cstdlib>
 #include <ostream>
 #include <sstream>
+#include <thread>
 #include <vector>
 
 using namespace boost::algorithm;
@@ -80,6 +81,7 @@ BerkeleyDbFilesystem::BerkeleyDbFilesystem(PropertiesPtr &props,
   m_max_unused_logs = props->get_i32("Hyperspace.LogGc.MaxUnusedLogs");
   m_log_gc_interval = std::chrono::milliseconds(props->get_i32("Hyperspace.LogGc.Interval"));
   m_last_log_gc_time = std::chrono::steady_clock::now();
+  m_group_commit_interval = props->get_i32("Hyperspace.GroupCommit.Interval");
 
   u_int32_t env_flags =
     DB_CREATE |      // If the environment does not exist, create it
@@ -361,12 +363,29 @@ BerkeleyDbFilesystem::BerkeleyDbFilesystem(PropertiesPtr &props,
 
   // initialize per thread DB handles
   init_db_handles(thread_ids);
+
+  if (m_group_commit_interval > 0) {
+    m_group_commit_thread = Thread([this]() { group_commit_flusher(); });
+    HT_INFOF("Group commit enabled, interval=%u ms", m_group_commit_interval);
+  }
+
   HT_DEBUG_OUT <<"namespace initialized"<< HT_END;
 }
 
 /*
  */
 BerkeleyDbFilesystem::~BerkeleyDbFilesystem() {
+
+  // shut down the group commit flush thread before closing the environment
+  if (m_group_commit_thread.joinable()) {
+    {
+      std::lock_guard<std::mutex> lock(m_group_commit_mutex);
+      m_group_commit_shutdown = true;
+    }
+    m_group_commit_cond.notify_all();
+    m_group_commit_thread.join();
+  }
+
   /*
    * Close Berkeley DB "namespace" database and environment
    */
@@ -605,6 +624,65 @@ void BerkeleyDbFilesystem::start_transaction(BDbTxn &txn) {
   return;
 }
 
+void BerkeleyDbFilesystem::group_commit(BDbTxn &txn) {
+
+  if (m_group_commit_interval == 0) {
+    txn.commit();
+    return;
+  }
+
+  // Commit without flushing the transaction log; the commit record sits in
+  // the log buffer until the flush thread makes it durable
+  txn.commit(DB_TXN_NOSYNC);
+
+  std::unique_lock<std::mutex> lock(m_group_commit_mutex);
+  uint64_t seq = ++m_group_commit_seq;
+  m_group_commit_cond.notify_one();
+  m_group_commit_flush_cond.wait(lock, [this, seq]() {
+      return m_group_commit_flushed >= seq || m_group_commit_shutdown; });
+}
+
+void BerkeleyDbFilesystem::group_commit_flusher() {
+  bool shutdown = false;
+
+  while (!shutdown) {
+    uint64_t batch;
+
+    {
+      std::unique_lock<std::mutex> lock(m_group_commit_mutex);
+      m_group_commit_cond.wait(lock, [this]() {
+          return m_group_commit_shutdown ||
+                 m_group_commit_seq > m_group_commit_flushed; });
+      shutdown = m_group_commit_shutdown;
+      if (shutdown && m_group_commit_seq == m_group_commit_flushed)
+        break;
+    }
+
+    // Bounded delay so that concurrent commits can join this flush
+    if (!shutdown)
+      std::this_thread::sleep_for(
+          std::chrono::milliseconds(m_group_commit_interval));
+
+    {
+      std::lock_guard<std::mutex> lock(m_group_commit_mutex);
+      batch = m_group_commit_seq;
+    }
+
+    try {
+      m_env.log_flush(0);
+    }
+    catch (DbException &e) {
+      HT_FATALF("Group commit log flush error - %s", e.what());
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(m_group_commit_mutex);
+      m_group_commit_flushed = batch;
+    }
+    m_group_commit_flush_cond.notify_all();
+  }
+}
+
 
 /*
  */
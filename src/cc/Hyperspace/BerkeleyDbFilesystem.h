@@ -275,6 +275,18 @@ namespace Hyperspace {
      */
     void start_transaction(BDbTxn &txn);
 
+    /** Commits a transaction through the group commit mechanism.
+     * If group commit is enabled
+     * (<code>Hyperspace.GroupCommit.Interval</code> is non-zero), the
+     * transaction is committed without flushing the transaction log and the
+     * calling thread blocks until the group commit thread has flushed it to
+     * disk, amortizing one log flush over all transactions committed within
+     * the same interval.  Otherwise this method is equivalent to
+     * <code>txn.commit()</code>.
+     * @param txn Transaction to commit
+     */
+    void group_commit(BDbTxn &txn);
+
     bool get_xattr_i32(BDbTxn &txn, const String &fname,
                        const String &aname, uint32_t *valuep);
     void set_xattr_i32(BDbTxn &txn, const String &fname,
@@ -793,6 +805,11 @@ namespace Hyperspace {
      */
     void init_db_handles(const std::vector<Thread::id> &thread_ids);
     BDbHandlesPtr get_db_handles();
+    /*
+     * Group commit flush thread function; flushes the transaction log once
+     * per interval while commits are pending and wakes up waiting committers
+     */
+    void group_commit_flusher();
     void build_attr_key(BDbTxn &, String &keystr,
                         const String &aname, Dbt &key);
     static void db_event_callback(DbEnv *dbenv, uint32_t which, void *info);
@@ -813,6 +830,21 @@ namespace Hyperspace {
     uint32_t m_max_unused_logs;
     std::chrono::steady_clock::duration m_log_gc_interval;
     std::chrono::steady_clock::time_point m_last_log_gc_time;
+
+    /// Group commit flush thread
+    Thread m_group_commit_thread;
+    std::mutex m_group_commit_mutex;
+    /// Signals the flush thread that commits are pending
+    std::condition_variable m_group_commit_cond;
+    /// Signals waiting committers that their commit has been flushed
+    std::condition_variable m_group_commit_flush_cond;
+    /// Group commit window in milliseconds (zero disables group commit)
+    uint32_t m_group_commit_interval {};
+    /// Sequence number of most recently committed transaction
+    uint64_t m_group_commit_seq {};
+    /// Sequence number of most recently flushed transaction
+    uint64_t m_group_commit_flushed {};
+    bool m_group_commit_shutdown {};
   };
 
   /** @} */
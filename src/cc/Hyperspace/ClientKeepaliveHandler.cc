@@ -292,6 +292,8 @@ void ClientKeepaliveHandler::handle(Hypertable::EventPtr &event) {
               if (!m_delivered_events.insert(event_id).second)
                 continue;
 
+              m_session->invalidate_read_cache(handle_state->normal_name);
+
               if (handle_state->callback) {
                 if (event_mask == EVENT_MASK_ATTR_SET)
                   handle_state->callback->attr_set(name);
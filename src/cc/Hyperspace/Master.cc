@@ -277,7 +277,7 @@ uint64_t Hyperspace::Master::create_session(struct sockaddr_in &addr) {
     m_session_map[session_id] = session_data;
     m_session_heap.push_back(session_data);
 
-    txn.commit();
+    m_bdb_fs->group_commit(txn);
     HT_INFOF("created session %llu", (Llu)session_id);
   }
   HT_BDBTXN_END(0);
@@ -335,7 +335,7 @@ void Hyperspace::Master::initialize_session(uint64_t session_id, const String &n
   // set session name in BDB and mem
   HT_BDBTXN_BEGIN() {
     m_bdb_fs->set_session_name(txn, session_id, name);
-    txn.commit();
+    m_bdb_fs->group_commit(txn);
     session_data->set_name(name);
   }
   HT_BDBTXN_END(BOOST_PP_EMPTY());
@@ -368,7 +368,7 @@ int Hyperspace::Master::renew_session_lease(uint64_t session_id) {
     // if renew failed then delete from BDB
     HT_BDBTXN_BEGIN() {
       m_bdb_fs->expire_session(txn, session_id);
-      txn.commit();
+      m_bdb_fs->group_commit(txn);
       commited = true;
     }
     HT_BDBTXN_END(Error::HYPERSPACE_EXPIRED_SESSION);
@@ -440,7 +440,7 @@ void Hyperspace::Master::remove_expired_sessions() {
     HT_BDBTXN_BEGIN() {
       m_bdb_fs->get_session_handles(txn, session_data->get_id(), handles);
       m_bdb_fs->expire_session(txn, session_data->get_id());
-      txn.commit();
+      m_bdb_fs->group_commit(txn);
       commited = true;
       expired_sessions.push_back(session_data->get_id());
     }
@@ -465,7 +465,7 @@ void Hyperspace::Master::remove_expired_sessions() {
       for (auto expired_session : expired_sessions) {
         m_bdb_fs->delete_session(txn, expired_session);
       }
-      txn.commit();
+      m_bdb_fs->group_commit(txn);
     }
     HT_BDBTXN_END(BOOST_PP_EMPTY());
   }
@@ -494,7 +494,7 @@ Hyperspace::Master::mkdir(ResponseCallback *cb, uint64_t session_id, const char
     if (ctx.aborted)
       txn.abort();
     else {
-      txn.commit();
+      m_bdb_fs->group_commit(txn);
       commited = true;
     }
   }
@@ -557,7 +557,7 @@ Hyperspace::Master::mkdirs(ResponseCallback *cb, uint64_t session_id, const char
     if (ctx.aborted)
       txn.abort();
     else {
-      txn.commit();
+      m_bdb_fs->group_commit(txn);
       commited = true;
     }
   }
@@ -608,7 +608,7 @@ Hyperspace::Master::unlink(ResponseCallback *cb, uint64_t session_id, const char
     if (ctx.aborted)
       txn.abort();
     else {
-      txn.commit();
+      m_bdb_fs->group_commit(txn);
       commited = true;
     }
   }
@@ -654,7 +654,7 @@ Hyperspace::Master::open(ResponseCallbackOpen *cb, uint64_t session_id, const ch
     if (ctx.aborted)
       txn.abort();
     else {
-      txn.commit();
+      m_bdb_fs->group_commit(txn);
       commited = true;
     }
   }
@@ -692,7 +692,7 @@ void Hyperspace::Master::close(ResponseCallback *cb, uint64_t session_id, uint64
     if (ctx.aborted)
       txn.abort();
     else
-      txn.commit();
+      m_bdb_fs->group_commit(txn);
   }
   HT_BDBTXN_END_CB(cb);
 
@@ -785,7 +785,7 @@ Hyperspace::Master::attr_set(ResponseCallback *cb, uint64_t session_id, uint64_t
     if (ctx.aborted)
       txn.abort();
     else {
-      txn.commit();
+      m_bdb_fs->group_commit(txn);
       commited = true;
     }
   }
@@ -892,7 +892,7 @@ Hyperspace::Master::attr_incr(ResponseCallbackAttrIncr *cb, uint64_t session_id,
     if (ctx.aborted)
       txn.abort();
     else
-      txn.commit();
+      m_bdb_fs->group_commit(txn);
   }
   HT_BDBTXN_END_CB(cb);
 
@@ -931,7 +931,7 @@ Hyperspace::Master::attr_del(ResponseCallback *cb, uint64_t session_id, uint64_t
     if (ctx.aborted)
       txn.abort();
     else {
-      txn.commit();
+      m_bdb_fs->group_commit(txn);
       commited = true;
     }
   }
@@ -1335,7 +1335,7 @@ Hyperspace::Master::lock(ResponseCallbackLock *cb, uint64_t session_id, uint64_t
         HT_INFOF("%s", sout.str().c_str());
       }
       else {
-        txn.commit();
+        m_bdb_fs->group_commit(txn);
         commited = true;
         std::stringstream sout;
         sout << "lock txn=" << txn << " commited " << " handle=" << handle << " node="
@@ -1459,7 +1459,7 @@ Hyperspace::Master::release(ResponseCallback *cb, uint64_t session_id, uint64_t
       if (aborted)
         txn.abort();
       else {
-        txn.commit();
+        m_bdb_fs->group_commit(txn);
         commited = true;
       }
   }
@@ -1480,7 +1480,7 @@ Hyperspace::Master::release(ResponseCallback *cb, uint64_t session_id, uint64_t
   HT_BDBTXN_BEGIN() {
     grant_pending_lock_reqs(txn, node, lock_granted_event, lock_granted_notifications,
         lock_acquired_event, lock_acquired_notifications);
-    txn.commit();
+    m_bdb_fs->group_commit(txn);
   }
   HT_BDBTXN_END_CB(cb);
 
@@ -1760,7 +1760,7 @@ Hyperspace::Master::destroy_handle(uint64_t handle, int &error, String &errmsg,
     release_lock(txn, handle, node, lock_release_event, lock_release_notifications);
 
     txn_commit:
-      txn.commit();
+      m_bdb_fs->group_commit(txn);
   }
   HT_BDBTXN_END(false);
 
@@ -1775,7 +1775,7 @@ Hyperspace::Master::destroy_handle(uint64_t handle, int &error, String &errmsg,
   HT_BDBTXN_BEGIN() {
     grant_pending_lock_reqs(txn, node, lock_granted_event, lock_granted_notifications,
         lock_acquired_event, lock_acquired_notifications);
-    txn.commit();
+    m_bdb_fs->group_commit(txn);
   }
   HT_BDBTXN_END(false);
 
@@ -1807,7 +1807,7 @@ Hyperspace::Master::destroy_handle(uint64_t handle, int &error, String &errmsg,
         node_removed = true;
       }
     }
-    txn.commit();
+    m_bdb_fs->group_commit(txn);
   }
   HT_BDBTXN_END(false);
   // deliver node removed notifications
@@ -1819,7 +1819,7 @@ Hyperspace::Master::destroy_handle(uint64_t handle, int &error, String &errmsg,
   // txn 4: delete handle data from BDB
   HT_BDBTXN_BEGIN() {
     m_bdb_fs->delete_handle(txn, handle);
-    txn.commit();
+    m_bdb_fs->group_commit(txn);
   }
   HT_BDBTXN_END(false);
 
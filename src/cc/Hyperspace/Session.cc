@@ -61,7 +61,9 @@ Session::Session(Comm *comm, PropertiesPtr &cfg)
     m_grace_period = cfg->get_i32("Hyperspace.GracePeriod");
     m_lease_interval = cfg->get_i32("Hyperspace.Lease.Interval");
     m_hyperspace_port = cfg->get_i16("Hyperspace.Replica.Port");
-    m_reconnect = cfg->get_bool("Hyperspace.Session.Reconnect"));
+    m_reconnect = cfg->get_bool("Hyperspace.Session.Reconnect");
+    m_cache_reads = cfg->get_bool("Hyperspace.Client.ReadCache");
+    m_cache_max_age = cfg->get_i32("Hyperspace.Client.ReadCache.MaxAge"));
 
   if (m_reconnect)
     HT_INFO("Hyperspace session setup to reconnect");
@@ -189,6 +191,10 @@ Session::open(ClientHandleStatePtr &handle_state, CommBufPtr &cbuf_ptr,
       decode_byte(&decode_ptr, &decode_remain);
       handle_state->lock_generation = decode_i64(&decode_ptr, &decode_remain);
       /** if (createdp) *createdp = cbyte ? true : false; **/
+      // The open may have added a child to the parent directory; drop any
+      // cached listing of it
+      if (open_flags & OPEN_FLAG_CREATE)
+        invalidate_read_cache(handle_state->normal_name);
       m_keepalive_handler_ptr->register_handle(handle_state);
       HT_DEBUG_OUT << "Open succeeded session="
                   << m_keepalive_handler_ptr->get_session_id()
@@ -323,6 +329,7 @@ void Session::unlink(const std::string &name, Timer *timer) {
     if (!sync_handler.wait_for_reply(event_ptr))
       HT_THROWF((int)Protocol::response_code(event_ptr.get()),
                 "Hyperspace 'unlink' error, name=%s", normal_name.c_str());
+    invalidate_read_cache(normal_name);
   }
   else {
     state_transition(Session::STATE_JEOPARDY);
@@ -388,6 +395,10 @@ void Session::attr_set(uint64_t handle, const std::string &attr,
                 "Problem setting attribute '%s' of hyperspace file '%s'",
                 attr.c_str(), fname.c_str());
     }
+    ClientHandleStatePtr handle_state;
+    if (m_cache_reads &&
+        m_keepalive_handler_ptr->get_handle_state(handle, handle_state))
+      invalidate_read_cache(handle_state->normal_name);
     return;
   }
 
@@ -417,6 +428,10 @@ void Session::attr_set(uint64_t handle, const std::vector<Attribute> &attrs,
       HT_THROWF((int)Protocol::response_code(event_ptr.get()),
                 "Problem setting attributes of hyperspace file '%s'", fname.c_str());
     }
+    ClientHandleStatePtr handle_state;
+    if (m_cache_reads &&
+        m_keepalive_handler_ptr->get_handle_state(handle, handle_state))
+      invalidate_read_cache(handle_state->normal_name);
     return;
   }
 
@@ -449,6 +464,11 @@ void Session::attr_set(const std::string &name, uint32_t oflags, const std::stri
                 "Problem setting attribute '%s' of hyperspace file '%s'",
                 attr.c_str(), name.c_str());
     }
+    if (m_cache_reads) {
+      String normal_name;
+      normalize_name(name, normal_name);
+      invalidate_read_cache(normal_name);
+    }
     return;
   }
 
@@ -473,6 +493,11 @@ void Session::attr_set(const std::string &name, uint32_t oflags,
       HT_THROWF((int)Protocol::response_code(event_ptr.get()),
                 "Problem setting attributes of hyperspace file '%s'", name.c_str());
     }
+    if (m_cache_reads) {
+      String normal_name;
+      normalize_name(name, normal_name);
+      invalidate_read_cache(normal_name);
+    }
     return;
   }
 
@@ -507,6 +532,11 @@ uint64_t Session::attr_incr(uint64_t handle, const std::string &attr, Timer *tim
       size_t decode_remain = event_ptr->payload_len - 4;
       uint64_t attr_val = decode_i64(&decode_ptr, &decode_remain);
 
+      ClientHandleStatePtr handle_state;
+      if (m_cache_reads &&
+          m_keepalive_handler_ptr->get_handle_state(handle, handle_state))
+        invalidate_read_cache(handle_state->normal_name);
+
       return attr_val;
     }
   }
@@ -540,6 +570,12 @@ uint64_t Session::attr_incr(const std::string &name, const std::string &attr, Ti
       size_t decode_remain = event_ptr->payload_len - 4;
       uint64_t attr_val = decode_i64(&decode_ptr, &decode_remain);
 
+      if (m_cache_reads) {
+        String normal_name;
+        normalize_name(name, normal_name);
+        invalidate_read_cache(normal_name);
+      }
+
       return attr_val;
     }
   }
@@ -555,6 +591,18 @@ Session::attr_get(uint64_t handle, const std::string &attr,
                   DynamicBuffer &value, Timer *timer) {
   DispatchHandlerSynchronizer sync_handler;
   Hypertable::EventPtr event_ptr;
+  String normal_name;
+
+  {
+    ClientHandleStatePtr handle_state;
+    if (m_cache_reads &&
+        m_keepalive_handler_ptr->get_handle_state(handle, handle_state))
+      normal_name = handle_state->normal_name;
+  }
+
+  if (!normal_name.empty() && cached_attr_get(normal_name, attr, value))
+    return;
+
   CommBufPtr cbuf_ptr(Protocol::create_attr_get_request(handle, 0, attr));
 
  try_again:
@@ -572,8 +620,11 @@ Session::attr_get(uint64_t handle, const std::string &attr,
                 "Problem getting attribute '%s' of hyperspace file '%s'",
                 attr.c_str(), fname.c_str());
     }
-    else
+    else {
       decode_value(event_ptr, value);
+      if (!normal_name.empty())
+        cache_attr(normal_name, attr, value);
+    }
   }
   else {
     state_transition(Session::STATE_JEOPARDY);
@@ -586,6 +637,13 @@ Session::attr_get(const std::string &name, const std::string &attr,
                   DynamicBuffer &value, Timer *timer) {
   DispatchHandlerSynchronizer sync_handler;
   Hypertable::EventPtr event_ptr;
+  String normal_name;
+
+  normalize_name(name, normal_name);
+
+  if (cached_attr_get(normal_name, attr, value))
+    return;
+
   CommBufPtr cbuf_ptr(Protocol::create_attr_get_request(0, &name, attr));
 
  try_again:
@@ -599,8 +657,10 @@ Session::attr_get(const std::string &name, const std::string &attr,
                 "Problem getting attribute '%s' of hyperspace file '%s'",
                 attr.c_str(), name.c_str());
     }
-    else
+    else {
       decode_value(event_ptr, value);
+      cache_attr(normal_name, attr, value);
+    }
   }
   else {
     state_transition(Session::STATE_JEOPARDY);
@@ -764,6 +824,10 @@ void Session::attr_del(uint64_t handle, const std::string &name, Timer *timer) {
                 "Problem deleting attribute '%s' of hyperspace file '%s'",
                 name.c_str(), fname.c_str());
     }
+    ClientHandleStatePtr handle_state;
+    if (m_cache_reads &&
+        m_keepalive_handler_ptr->get_handle_state(handle, handle_state))
+      invalidate_read_cache(handle_state->normal_name);
   }
   else {
     state_transition(Session::STATE_JEOPARDY);
@@ -818,6 +882,18 @@ Session::readdir(uint64_t handle, std::vector<DirEntry> &listing,
                  Timer *timer) {
   DispatchHandlerSynchronizer sync_handler;
   Hypertable::EventPtr event_ptr;
+  String normal_name;
+
+  {
+    ClientHandleStatePtr handle_state;
+    if (m_cache_reads &&
+        m_keepalive_handler_ptr->get_handle_state(handle, handle_state))
+      normal_name = handle_state->normal_name;
+  }
+
+  if (!normal_name.empty() && cached_readdir(normal_name, listing))
+    return;
+
   CommBufPtr cbuf_ptr(Protocol::create_readdir_request(handle));
 
  try_again:
@@ -852,6 +928,8 @@ Session::readdir(uint64_t handle, std::vector<DirEntry> &listing,
         }
         listing.push_back(dentry);
       }
+      if (!normal_name.empty())
+        cache_readdir(normal_name, listing);
     }
   }
   else {
@@ -1182,6 +1260,10 @@ int Session::state_transition(int state) {
   lock_guard<mutex> lock(m_mutex);
   int old_state = m_state;
   m_state = state;
+  // Change notifications are not delivered outside of SAFE state, so drop
+  // cached reads when leaving it
+  if (old_state == STATE_SAFE && m_state != STATE_SAFE)
+    purge_read_cache();
   if (m_state == STATE_SAFE) {
     m_cond.notify_all();
     if (old_state == STATE_JEOPARDY) {
@@ -1266,6 +1348,7 @@ void Session::mkdir(const std::string &name, bool create_intermediate, const std
     if (!sync_handler.wait_for_reply(event_ptr))
       HT_THROWF((int)Protocol::response_code(event_ptr.get()),
                 "Hyperspace 'mkdir' error, name=%s", normal_name.c_str());
+    invalidate_read_cache(normal_name);
   }
   else {
     state_transition(Session::STATE_JEOPARDY);
@@ -1273,6 +1356,90 @@ void Session::mkdir(const std::string &name, bool create_intermediate, const std
   }
 }
 
+bool Session::cached_attr_get(const std::string &normal_name,
+                              const std::string &attr, DynamicBuffer &value) {
+  if (!m_cache_reads)
+    return false;
+  lock_guard<mutex> lock(m_cache_mutex);
+  auto iter = m_attr_cache.find(make_pair(normal_name, attr));
+  if (iter == m_attr_cache.end())
+    return false;
+  if (chrono::steady_clock::now() >= iter->second.expiry) {
+    m_attr_cache.erase(iter);
+    return false;
+  }
+  DynamicBuffer &cached = *iter->second.value;
+  value.clear();
+  value.ensure(cached.fill() + 1);
+  value.add_unchecked(cached.base, cached.fill());
+  // nul-terminate to make caller's lives easier
+  *value.ptr = 0;
+  return true;
+}
+
+void Session::cache_attr(const std::string &normal_name,
+                         const std::string &attr, const DynamicBuffer &value) {
+  if (!m_cache_reads)
+    return;
+  CachedAttr entry;
+  entry.value = make_shared<DynamicBuffer>(value.fill() + 1);
+  entry.value->add_unchecked(value.base, value.fill());
+  *entry.value->ptr = 0;
+  entry.expiry = chrono::steady_clock::now() +
+    chrono::milliseconds(m_cache_max_age);
+  lock_guard<mutex> lock(m_cache_mutex);
+  m_attr_cache[make_pair(normal_name, attr)] = entry;
+}
+
+bool Session::cached_readdir(const std::string &normal_name,
+                             std::vector<DirEntry> &listing) {
+  if (!m_cache_reads)
+    return false;
+  lock_guard<mutex> lock(m_cache_mutex);
+  auto iter = m_dir_cache.find(normal_name);
+  if (iter == m_dir_cache.end())
+    return false;
+  if (chrono::steady_clock::now() >= iter->second.expiry) {
+    m_dir_cache.erase(iter);
+    return false;
+  }
+  listing = iter->second.listing;
+  return true;
+}
+
+void Session::cache_readdir(const std::string &normal_name,
+                            const std::vector<DirEntry> &listing) {
+  if (!m_cache_reads)
+    return;
+  CachedListing entry;
+  entry.listing = listing;
+  entry.expiry = chrono::steady_clock::now() +
+    chrono::milliseconds(m_cache_max_age);
+  lock_guard<mutex> lock(m_cache_mutex);
+  m_dir_cache[normal_name] = entry;
+}
+
+void Session::invalidate_read_cache(const std::string &name) {
+  if (!m_cache_reads)
+    return;
+  lock_guard<mutex> lock(m_cache_mutex);
+  auto iter = m_attr_cache.lower_bound(make_pair(name, string()));
+  while (iter != m_attr_cache.end() && iter->first.first == name)
+    iter = m_attr_cache.erase(iter);
+  m_dir_cache.erase(name);
+  size_t offset = name.find_last_of('/');
+  if (offset != string::npos)
+    m_dir_cache.erase(offset > 0 ? name.substr(0, offset) : string("/"));
+}
+
+void Session::purge_read_cache() {
+  if (!m_cache_reads)
+    return;
+  lock_guard<mutex> lock(m_cache_mutex);
+  m_attr_cache.clear();
+  m_dir_cache.clear();
+}
+
 void Session::decode_value(Hypertable::EventPtr& event_ptr, DynamicBuffer &value) {
   uint32_t attr_val_len = 0;
   const uint8_t *decode_ptr = event_ptr->payload + 8;
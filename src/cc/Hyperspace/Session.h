@@ -43,9 +43,11 @@
 
 #include <chrono>
 #include <condition_variable>
+#include <map>
 #include <memory>
 #include <mutex>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 namespace Hypertable {
@@ -693,10 +695,33 @@ namespace Hyperspace {
      */
     void shutdown(Timer *timer=0);
 
+    /** Invalidates read cache entries for a file or directory.
+     * Removes the cached attributes of <code>name</code>, the cached
+     * directory listing of <code>name</code>, and the cached listing of
+     * its parent directory.  Called internally by mutating operations and
+     * by change notification delivery; a no-op unless
+     * <code>Hyperspace.Client.ReadCache</code> is enabled.
+     *
+     * @param name Normalized pathname of modified file or directory
+     */
+    void invalidate_read_cache(const std::string &name);
+
   private:
 
     typedef std::unordered_map<uint64_t, SessionCallback *> CallbackMap;
 
+    /// Read cache entry holding an attribute value
+    struct CachedAttr {
+      DynamicBufferPtr value;
+      std::chrono::steady_clock::time_point expiry;
+    };
+
+    /// Read cache entry holding a directory listing
+    struct CachedListing {
+      std::vector<DirEntry> listing;
+      std::chrono::steady_clock::time_point expiry;
+    };
+
     void mkdir(const std::string &name, bool create_intermediate, const std::vector<Attribute> *init_attrs, Timer *timer);
     void decode_listing(Hypertable::EventPtr& event_ptr, std::vector<DirEntryAttr> &listing);
     void decode_value(Hypertable::EventPtr& event_ptr, DynamicBuffer &value);
@@ -705,6 +730,15 @@ namespace Hyperspace {
     int send_message(CommBufPtr &, DispatchHandler *, Timer *timer);
     void normalize_name(const std::string &name, std::string &normal);
     uint64_t open(ClientHandleStatePtr &, CommBufPtr &, Timer *timer);
+    bool cached_attr_get(const std::string &normal_name,
+                         const std::string &attr, DynamicBuffer &value);
+    void cache_attr(const std::string &normal_name, const std::string &attr,
+                    const DynamicBuffer &value);
+    bool cached_readdir(const std::string &normal_name,
+                        std::vector<DirEntry> &listing);
+    void cache_readdir(const std::string &normal_name,
+                       const std::vector<DirEntry> &listing);
+    void purge_read_cache();
 
     std::mutex m_mutex;
     std::condition_variable m_cond;
@@ -726,6 +760,11 @@ namespace Hyperspace {
     std::mutex m_callback_mutex;
     vector<String>            m_hyperspace_replicas;
     String                    m_hyperspace_master;
+    bool                      m_cache_reads {};
+    uint32_t                  m_cache_max_age {};
+    std::mutex m_cache_mutex;
+    std::map<std::pair<std::string, std::string>, CachedAttr> m_attr_cache;
+    std::map<std::string, CachedListing> m_dir_cache;
 
     /// Delivers suspend/resume notifications (e.g. laptop close/open).
     SleepWakeNotifier *m_sleep_wake_notifier;
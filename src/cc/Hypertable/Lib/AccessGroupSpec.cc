@@ -28,6 +28,7 @@
 #include "AccessGroupSpec.h"
 
 #include <Common/Config.h>
+#include <Common/Serialization.h>
 #include <Common/XmlParser.h>
 
 #include <boost/algorithm/string.hpp>
@@ -48,7 +49,7 @@ namespace {
   PropertiesDesc
   compressor_desc("  bmz|lzo|quicklz|zlib|snappy|none [compressor_options]\n\n"
                   "compressor_options"),
-    bloomfilter_desc("  rows|rows+cols|none [bloomfilter_options]\n\n"
+    bloomfilter_desc("  rows|rows+cols|rows+cols+prefix|none [bloomfilter_options]\n\n"
                       "  Default bloom filter is defined by the config property:\n"
                       "  Hypertable.RangeServer.CellStore.DefaultBloomFilter.\n\n"
                       "bloomfilter_options");
@@ -83,9 +84,12 @@ namespace {
        "probability for the Bloom filter")
       ("max-approx-items", i32()->default_value(1000), "Number of cell store "
        "items used to guess the number of actual Bloom filter entries")
+      ("prefix-length", i32()->default_value(16), "Number of leading column "
+       "qualifier bytes hashed into each rows+cols+prefix Bloom filter entry")
       ;
     bloomfilter_hidden_desc.add_options()
-      ("bloom-filter-mode", str(), "Bloom filter mode (rows|rows+cols|none)")
+      ("bloom-filter-mode", str(),
+       "Bloom filter mode (rows|rows+cols|rows+cols+prefix|none)")
       ;
     bloomfilter_pos_desc.add("bloom-filter-mode", 1);
     desc_inited = true;
@@ -130,6 +134,16 @@ namespace {
     }
   }
 
+  void validate_compaction_strategy(const std::string &strategy) {
+    if (strategy.empty())
+      return;
+
+    if (strcasecmp(strategy.c_str(), "size-tiered") &&
+        strcasecmp(strategy.c_str(), "leveled"))
+      HT_THROWF(Error::SCHEMA_PARSE_ERROR,
+                "Invalid compaction strategy - %s", strategy.c_str());
+  }
+
 } // local namespace
 
 
@@ -180,6 +194,25 @@ bool AccessGroupOptions::is_set_in_memory() const {
   return m_isset.test(IN_MEMORY);
 }
 
+void AccessGroupOptions::set_pax_layout(bool value) {
+  m_pax_layout = value;
+  m_isset.set(PAX_LAYOUT);
+}
+
+bool AccessGroupOptions::is_set_pax_layout() const {
+  return m_isset.test(PAX_LAYOUT);
+}
+
+void AccessGroupOptions::set_compaction_strategy(const std::string &strategy) {
+  validate_compaction_strategy(strategy);
+  m_compaction_strategy = strategy;
+  m_isset.set(COMPACTION_STRATEGY);
+}
+
+bool AccessGroupOptions::is_set_compaction_strategy() const {
+  return m_isset.test(COMPACTION_STRATEGY);
+}
+
 void AccessGroupOptions::merge(const AccessGroupOptions &other) {
   if (!is_set_replication() && other.is_set_replication())
     set_replication(other.get_replication());
@@ -191,6 +224,10 @@ void AccessGroupOptions::merge(const AccessGroupOptions &other) {
     set_bloom_filter(other.get_bloom_filter());
   if (!is_set_in_memory() && other.is_set_in_memory())
     set_in_memory(other.get_in_memory());
+  if (!is_set_pax_layout() && other.is_set_pax_layout())
+    set_pax_layout(other.get_pax_layout());
+  if (!is_set_compaction_strategy() && other.is_set_compaction_strategy())
+    set_compaction_strategy(other.get_compaction_strategy());
 }
 
 namespace {
@@ -211,6 +248,10 @@ namespace {
         m_options->set_bloom_filter(content);
       else if (!strcasecmp(name, "InMemory"))
         m_options->set_in_memory(content_to_bool(name, content));
+      else if (!strcasecmp(name, "PaxLayout"))
+        m_options->set_pax_layout(content_to_bool(name, content));
+      else if (!strcasecmp(name, "CompactionStrategy"))
+        m_options->set_compaction_strategy(content);
       else if (!m_element_stack.empty())
         HT_THROWF(Error::SCHEMA_PARSE_ERROR,
                   "Unrecognized AccessGroup option element (%s)", name);
@@ -243,6 +284,12 @@ const std::string AccessGroupOptions::render_xml(const std::string &line_prefix)
   if (is_set_in_memory())
     xstr += format("%s<InMemory>%s</InMemory>\n",
                    line_prefix.c_str(), m_in_memory ? "true" : "false");
+  if (is_set_pax_layout())
+    xstr += format("%s<PaxLayout>%s</PaxLayout>\n",
+                   line_prefix.c_str(), m_pax_layout ? "true" : "false");
+  if (is_set_compaction_strategy())
+    xstr += format("%s<CompactionStrategy>%s</CompactionStrategy>\n",
+                   line_prefix.c_str(), m_compaction_strategy.c_str());
   return xstr;
 }
 
@@ -258,6 +305,11 @@ const std::string AccessGroupOptions::render_hql() const {
     hstr += format(" BLOOMFILTER \"%s\"", m_bloomfilter.c_str());
   if (is_set_in_memory())
     hstr += format(" IN_MEMORY %s", m_in_memory ? "true" : "false");
+  if (is_set_pax_layout())
+    hstr += format(" PAX_LAYOUT %s", m_pax_layout ? "true" : "false");
+  if (is_set_compaction_strategy())
+    hstr += format(" COMPACTION_STRATEGY \"%s\"",
+                   m_compaction_strategy.c_str());
   return hstr;
 }
 
@@ -267,7 +319,9 @@ bool AccessGroupOptions::operator==(const AccessGroupOptions &other) const {
           m_blocksize == other.m_blocksize &&
           m_compressor == other.m_compressor &&
           m_bloomfilter == other.m_bloomfilter &&
-          m_in_memory == other.m_in_memory);
+          m_in_memory == other.m_in_memory &&
+          m_pax_layout == other.m_pax_layout &&
+          m_compaction_strategy == other.m_compaction_strategy);
 }
 
 
@@ -291,6 +345,10 @@ void AccessGroupOptions::parse_bloom_filter(const std::string &spec, PropertiesP
            || mode == "rows-cols" || mode == "row-col"
            || mode == "rows_cols" || mode == "row_col")
     props->set("bloom-filter-mode", BLOOM_FILTER_ROWS_COLS);
+  else if (mode == "rows+cols+prefix" || mode == "row+col+prefix"
+           || mode == "rows-cols-prefix" || mode == "row-col-prefix"
+           || mode == "rows_cols_prefix" || mode == "row_col_prefix")
+    props->set("bloom-filter-mode", BLOOM_FILTER_ROWS_COLS_PREFIX);
   else
     HT_THROWF(Error::BAD_SCHEMA, "unknown bloom filter mode: '%s'",
                  mode.c_str());
@@ -406,6 +464,28 @@ bool AccessGroupSpec::get_option_in_memory() const {
   return m_options.get_in_memory();
 }
 
+void AccessGroupSpec::set_option_pax_layout(bool value) {
+  if (!m_options.is_set_pax_layout() ||
+      m_options.get_pax_layout() != value)
+    m_generation = 0;
+  m_options.set_pax_layout(value);
+}
+
+bool AccessGroupSpec::get_option_pax_layout() const {
+  return m_options.get_pax_layout();
+}
+
+void AccessGroupSpec::set_option_compaction_strategy(const std::string &strategy) {
+  if (!m_options.is_set_compaction_strategy() ||
+      m_options.get_compaction_strategy() != strategy)
+    m_generation = 0;
+  m_options.set_compaction_strategy(strategy);
+}
+
+const std::string AccessGroupSpec::get_option_compaction_strategy() const {
+  return m_options.get_compaction_strategy();
+}
+
 void AccessGroupSpec::set_default_max_versions(int32_t max_versions) {
   if (!m_defaults.is_set_max_versions() ||
       m_defaults.get_max_versions() != max_versions)
@@ -448,6 +528,17 @@ bool AccessGroupSpec::get_default_counter() const {
   return m_defaults.get_counter();
 }
 
+void AccessGroupSpec::set_default_value_dictionary(bool value) {
+  if (!m_defaults.is_set_value_dictionary() ||
+      m_defaults.get_value_dictionary() != value)
+    m_generation = 0;
+  m_defaults.set_value_dictionary(value);
+}
+
+bool AccessGroupSpec::get_default_value_dictionary() const {
+  return m_defaults.get_value_dictionary();
+}
+
 void AccessGroupSpec::add_column(ColumnFamilySpec *cf) {
   cf->merge_options(m_defaults);
   if (cf->get_access_group().empty())
@@ -643,3 +734,98 @@ const std::string AccessGroupSpec::render_hql() const {
   output += m_defaults.render_hql();    
   return output;
 }
+
+uint8_t AccessGroupOptions::encoding_version() const {
+  return 1;
+}
+
+size_t AccessGroupOptions::encoded_length_internal() const {
+  return 12 + Serialization::encoded_length_vstr(m_compressor) +
+    Serialization::encoded_length_vstr(m_bloomfilter) +
+    Serialization::encoded_length_vstr(m_compaction_strategy);
+}
+
+/// @details
+/// Encoding is as follows:
+/// <table>
+/// <tr><th>Encoding</th><th>Description</th></tr>
+/// <tr><td>i16</td><td>Replication</td></tr>
+/// <tr><td>i32</td><td>Block size</td></tr>
+/// <tr><td>vstr</td><td>Compressor specification</td></tr>
+/// <tr><td>vstr</td><td>Bloom filter specification</td></tr>
+/// <tr><td>bool</td><td>In memory flag</td></tr>
+/// <tr><td>bool</td><td>PAX layout flag</td></tr>
+/// <tr><td>vstr</td><td>Compaction strategy</td></tr>
+/// <tr><td>i32</td><td><i>isset</i> bits</td></tr>
+/// </table>
+void AccessGroupOptions::encode_internal(uint8_t **bufp) const {
+  Serialization::encode_i16(bufp, m_replication);
+  Serialization::encode_i32(bufp, m_blocksize);
+  Serialization::encode_vstr(bufp, m_compressor);
+  Serialization::encode_vstr(bufp, m_bloomfilter);
+  Serialization::encode_bool(bufp, m_in_memory);
+  Serialization::encode_bool(bufp, m_pax_layout);
+  Serialization::encode_vstr(bufp, m_compaction_strategy);
+  Serialization::encode_i32(bufp, (uint32_t)m_isset.to_ulong());
+}
+
+void AccessGroupOptions::decode_internal(uint8_t version, const uint8_t **bufp,
+                                         size_t *remainp) {
+  m_replication = Serialization::decode_i16(bufp, remainp);
+  m_blocksize = Serialization::decode_i32(bufp, remainp);
+  m_compressor = Serialization::decode_vstr(bufp, remainp);
+  m_bloomfilter = Serialization::decode_vstr(bufp, remainp);
+  m_in_memory = Serialization::decode_bool(bufp, remainp);
+  m_pax_layout = Serialization::decode_bool(bufp, remainp);
+  m_compaction_strategy = Serialization::decode_vstr(bufp, remainp);
+  m_isset = bitset<MAX>(Serialization::decode_i32(bufp, remainp));
+}
+
+uint8_t AccessGroupSpec::encoding_version() const {
+  return 1;
+}
+
+size_t AccessGroupSpec::encoded_length_internal() const {
+  size_t length = Serialization::encoded_length_vstr(m_name) + 12 +
+    m_options.encoded_length() + m_defaults.encoded_length();
+  for (auto cf : m_columns)
+    length += cf->encoded_length();
+  return length;
+}
+
+/// @details
+/// Encoding is as follows:
+/// <table>
+/// <tr><th>Encoding</th><th>Description</th></tr>
+/// <tr><td>vstr</td><td>Name</td></tr>
+/// <tr><td>i64</td><td>Generation</td></tr>
+/// <tr><td>AccessGroupOptions</td><td>Options</td></tr>
+/// <tr><td>ColumnFamilyOptions</td><td>Column family defaults</td></tr>
+/// <tr><td>i32</td><td>Column family count</td></tr>
+/// <tr><td>For each column family ...</td><td></td></tr>
+/// <tr><td>ColumnFamilySpec</td><td>Column family specification</td></tr>
+/// </table>
+void AccessGroupSpec::encode_internal(uint8_t **bufp) const {
+  Serialization::encode_vstr(bufp, m_name);
+  Serialization::encode_i64(bufp, m_generation);
+  m_options.encode(bufp);
+  m_defaults.encode(bufp);
+  Serialization::encode_i32(bufp, m_columns.size());
+  for (auto cf : m_columns)
+    cf->encode(bufp);
+}
+
+void AccessGroupSpec::decode_internal(uint8_t version, const uint8_t **bufp,
+                                      size_t *remainp) {
+  m_name = Serialization::decode_vstr(bufp, remainp);
+  m_generation = Serialization::decode_i64(bufp, remainp);
+  m_options.decode(bufp, remainp);
+  m_defaults.decode(bufp, remainp);
+  int32_t count = Serialization::decode_i32(bufp, remainp);
+  while (count-- > 0) {
+    ColumnFamilySpec *cf = new ColumnFamilySpec();
+    try { cf->decode(bufp, remainp); }
+    catch (Exception &) { delete cf; throw; }
+    m_columns.push_back(cf);
+  }
+}
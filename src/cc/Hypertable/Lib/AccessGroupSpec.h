@@ -30,6 +30,7 @@
 #include <Hypertable/Lib/ColumnFamilySpec.h>
 
 #include <Common/Properties.h>
+#include <Common/Serializable.h>
 
 #include <bitset>
 #include <unordered_map>
@@ -47,11 +48,13 @@ namespace Hypertable {
     /// Rows only
     BLOOM_FILTER_ROWS,
     /// Rows plus columns
-    BLOOM_FILTER_ROWS_COLS
+    BLOOM_FILTER_ROWS_COLS,
+    /// Rows plus columns plus column qualifier prefix
+    BLOOM_FILTER_ROWS_COLS_PREFIX
   };
 
   /// Specification for access group options.
-  class AccessGroupOptions {
+  class AccessGroupOptions : public Serializable {
   public:
 
     /// Enumeration for <i>isset</i> bits
@@ -66,6 +69,10 @@ namespace Hypertable {
       BLOOMFILTER,
       /// <i>in memory</i> bit
       IN_MEMORY,
+      /// <i>pax layout</i> bit
+      PAX_LAYOUT,
+      /// <i>compaction strategy</i> bit
+      COMPACTION_STRATEGY,
       /// Total bit count
       MAX
     };
@@ -139,6 +146,7 @@ namespace Hypertable {
     /// mode:
     ///   rows [options]
     ///   rows+cols [options]
+    ///   rows+cols+prefix [options]
     ///   none
     ///
     /// options:
@@ -146,6 +154,7 @@ namespace Hypertable {
     ///   --num-hashes &lt;int&gt;
     ///   --false-positive &lt;float&gt;
     ///   --max-approx-items &lt;int&gt;
+    ///   --prefix-length &lt;int&gt;
     /// </pre>
     /// @param bloomfilter Bloom filter specification
     /// @throws Exception with code set to Error::SCHEMA_PARSE_ERROR
@@ -178,6 +187,56 @@ namespace Hypertable {
     /// otherwise.
     bool is_set_in_memory() const;
 
+    /// Sets <i>pax layout</i> option.
+    /// Sets the PAX_LAYOUT bit of #m_isset and sets #m_pax_layout to
+    /// <code>value</code>.  When enabled, cell store data blocks segregate
+    /// keys and values into separate regions (PAX layout) so that
+    /// value-skipping scans only touch the key region.
+    /// @param value New value for <i>pax layout</i> option
+    void set_pax_layout(bool value);
+
+    /// Gets <i>pax layout</i> option.
+    /// @return <i>pax layout</i> option.
+    bool get_pax_layout() const { return m_pax_layout; }
+
+    /// Checks if <i>pax layout</i> option is set.
+    /// This method returns the value of the PAX_LAYOUT bit of #m_isset.
+    /// @return <i>true</i> if <i>pax layout</i> option is set, <i>false</i>
+    /// otherwise.
+    bool is_set_pax_layout() const;
+
+    /// Sets <i>compaction strategy</i> option.
+    /// Sets the COMPACTION_STRATEGY bit of #m_isset, validates the
+    /// specification given in the <code>strategy</code> argument, and if it
+    /// is valid, sets #m_compaction_strategy to <code>strategy</code>.  The
+    /// following compaction strategies are valid:
+    /// <pre>
+    ///   size-tiered
+    ///   leveled
+    /// </pre>
+    /// The <i>size-tiered</i> strategy merges runs of similarly sized cell
+    /// stores, minimizing write amplification at the cost of wider scan
+    /// fan-in.  The <i>leveled</i> strategy keeps the cell store count low
+    /// by merging small adjacent pairs, minimizing scan fan-in at the cost
+    /// of additional write amplification.
+    /// @param strategy Compaction strategy specification
+    /// @throws Exception with code set to Error::SCHEMA_PARSE_ERROR
+    /// if compaction strategy specification is invalid
+    void set_compaction_strategy(const std::string &strategy);
+
+    /// Gets <i>compaction strategy</i> option.
+    /// @return <i>compaction strategy</i> option.
+    const std::string &get_compaction_strategy() const {
+      return m_compaction_strategy;
+    }
+
+    /// Checks if <i>compaction strategy</i> option is set.
+    /// This method returns the value of the COMPACTION_STRATEGY bit of
+    /// #m_isset.
+    /// @return <i>true</i> if <i>compaction strategy</i> option is set,
+    /// <i>false</i> otherwise.
+    bool is_set_compaction_strategy() const;
+
     /// Merges options from another AccessGroupOptions object.
     /// For each option that is not set, if the corresponding option in the
     /// <code>other</code> parameter is set, then the option is set to
@@ -256,7 +315,7 @@ namespace Hypertable {
     /// <td>bloom-filter-mode</td>
     /// <td>string</td>
     /// <td><i>none</i></td>
-    /// <td>Mode (rows|rows+cols|none)</td>
+    /// <td>Mode (rows|rows+cols|rows+cols+prefix|none)</td>
     /// </tr>
     /// <tr>
     /// <td>bits-per-item</td>
@@ -283,6 +342,13 @@ namespace Hypertable {
     /// <td>Number of cell store items used to estimate the number of actual
     /// entries</td>
     /// </tr>
+    /// <tr>
+    /// <td>prefix-length</td>
+    /// <td>int</td>
+    /// <td>16</td>
+    /// <td>Number of leading column qualifier bytes hashed into each
+    /// <i>rows+cols+prefix</i> filter entry</td>
+    /// </tr>
     /// </table>
     /// @param spec Bloom filter specification
     /// @param props Properties object to populate
@@ -294,6 +360,30 @@ namespace Hypertable {
     /// <i>false</i> otherwise.
     bool operator==(const AccessGroupOptions &other) const;
 
+  protected:
+
+    /// Returns encoding version.
+    /// @return Encoding version
+    uint8_t encoding_version() const override;
+
+    /// Returns internal serialized length.
+    /// @return Internal serialized length
+    /// @see encode_internal() for encoding format
+    size_t encoded_length_internal() const override;
+
+    /// Writes serialized representation of object to a buffer.
+    /// @param bufp Address of destination buffer pointer (advanced by call)
+    void encode_internal(uint8_t **bufp) const override;
+
+    /// Reads serialized representation of object from a buffer.
+    /// @param version Encoding version
+    /// @param bufp Address of destination buffer pointer (advanced by call)
+    /// @param remainp Address of integer holding amount of serialized object
+    /// remaining
+    /// @see encode_internal() for encoding format
+    void decode_internal(uint8_t version, const uint8_t **bufp,
+                         size_t *remainp) override;
+
   private:
 
     /// Replication
@@ -311,12 +401,18 @@ namespace Hypertable {
     /// In memory
     bool m_in_memory {};
 
+    /// <i>pax layout</i> option
+    bool m_pax_layout {};
+
+    /// Compaction strategy specification
+    std::string m_compaction_strategy;
+
     /// Bit mask describing which options are set
     std::bitset<MAX> m_isset;
   };
 
   /// Access group specification
-  class AccessGroupSpec {
+  class AccessGroupSpec : public Serializable {
   public:
 
     /// Default constructor.
@@ -418,6 +514,29 @@ namespace Hypertable {
     /// @return <i>in memory</i> option.
     bool get_option_in_memory() const;
 
+    /// Sets <i>pax layout</i> option.
+    /// Sets the <i>pax layout</i> option of the #m_options member to
+    /// <code>value</code>.
+    /// @param value New value for <i>pax layout</i> option
+    void set_option_pax_layout(bool value);
+
+    /// Gets <i>pax layout</i> option.
+    /// @return <i>pax layout</i> option.
+    bool get_option_pax_layout() const;
+
+    /// Sets <i>compaction strategy</i> option.
+    /// Sets the <i>compaction strategy</i> option of the #m_options member to
+    /// <code>strategy</code> by calling
+    /// AccessGroupOptions::set_compaction_strategy().
+    /// @param strategy Compaction strategy specification
+    /// @throws Exception with code set to Error::SCHEMA_PARSE_ERROR
+    /// if compaction strategy specification is invalid
+    void set_option_compaction_strategy(const std::string &strategy);
+
+    /// Gets <i>compaction strategy</i> option.
+    /// @return <i>compaction strategy</i> option.
+    const std::string get_option_compaction_strategy() const;
+
     /// Sets default <i>max versions</i> column family option.
     /// Sets <i>max versions</i> option in the column family default structure,
     /// #m_defaults, to <code>max_versions</code>
@@ -468,6 +587,19 @@ namespace Hypertable {
     /// @return Default <i>counter</i> column family option.
     bool get_default_counter() const;
 
+    /// Sets default <i>value dictionary</i> column family option.
+    /// Sets <i>value dictionary</i> option in the column family default
+    /// structure, #m_defaults, to <code>value</code>
+    /// @param value New <i>value dictionary</i> column family default
+    /// @throws Exception if supplied <code>value</code> is <i>true</i> and the
+    /// <i>counter</i> default option is set, which is incompatible with the
+    /// <i>value dictionary</i> default option.
+    void set_default_value_dictionary(bool value);
+
+    /// Gets default <i>value dictionary</i> column family option.
+    /// @return Default <i>value dictionary</i> column family option.
+    bool get_default_value_dictionary() const;
+
     /// Adds column family specification.
     /// Merges column family defaults, #m_defaults, into <code>cf</code>
     /// options, sets the <code>cf</code> access group to #m_name, and then
@@ -614,6 +746,30 @@ namespace Hypertable {
     /// @return Reference to column family defaults structure.
     const ColumnFamilyOptions &defaults() const { return m_defaults; }
 
+  protected:
+
+    /// Returns encoding version.
+    /// @return Encoding version
+    uint8_t encoding_version() const override;
+
+    /// Returns internal serialized length.
+    /// @return Internal serialized length
+    /// @see encode_internal() for encoding format
+    size_t encoded_length_internal() const override;
+
+    /// Writes serialized representation of object to a buffer.
+    /// @param bufp Address of destination buffer pointer (advanced by call)
+    void encode_internal(uint8_t **bufp) const override;
+
+    /// Reads serialized representation of object from a buffer.
+    /// @param version Encoding version
+    /// @param bufp Address of destination buffer pointer (advanced by call)
+    /// @param remainp Address of integer holding amount of serialized object
+    /// remaining
+    /// @see encode_internal() for encoding format
+    void decode_internal(uint8_t version, const uint8_t **bufp,
+                         size_t *remainp) override;
+
   private:
 
     /// Name
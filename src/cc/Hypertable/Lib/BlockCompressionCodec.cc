@@ -37,7 +37,9 @@ namespace {
     "zlib",
     "lzo",
     "quicklz",
-    "snappy"
+    "snappy",
+    "zlibstream",
+    "zstd"
   };
 }
 
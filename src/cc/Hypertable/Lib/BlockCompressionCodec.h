@@ -56,7 +56,9 @@ namespace Hypertable {
       LZO=3,      ///< LZO compression
       QUICKLZ=4,  ///< QuickLZ 1.5 compession
       SNAPPY=5,   ///< Snappy compression
-      COMPRESSION_TYPE_LIMIT=6  ///< Limit of compression types
+      ZLIBSTREAM=6,  ///< Streaming ZLIB compression with rolling dictionary
+      ZSTD=7,     ///< Zstandard compression
+      COMPRESSION_TYPE_LIMIT=8  ///< Limit of compression types
     };
 
     /// Compression codec argument vector.
@@ -97,6 +99,31 @@ namespace Hypertable {
                   arg.c_str());
     }
 
+    /// Resets compression state carried across blocks.
+    /// Most codecs compress each block independently, so the default
+    /// implementation does nothing.  Codecs that maintain a rolling
+    /// dictionary across blocks (see BlockCompressionCodecZlibStream)
+    /// override this method; callers must invoke it at stream boundaries
+    /// (e.g. commit log fragment boundaries) to keep the compressor and
+    /// decompressor dictionaries in sync.
+    virtual void reset() { }
+
+    /// Supplies a pre-trained dictionary to prime (de)compression.
+    /// Most codecs do not support trained dictionaries, so the default
+    /// implementation does nothing.  Codecs that do (see
+    /// BlockCompressionCodecZstd) retain a copy and apply it to every block;
+    /// the same dictionary bytes must be supplied to the decompressing codec,
+    /// so containers persist them alongside the compressed blocks (see
+    /// CellStoreV8).
+    /// @param base Pointer to dictionary
+    /// @param len Length of dictionary
+    virtual void set_dictionary(const void *base, size_t len) { }
+
+    /// Returns the pre-trained dictionary in use.
+    /// @return Pointer to dictionary buffer, or nullptr if the codec has no
+    /// dictionary
+    virtual const DynamicBuffer *dictionary() { return 0; }
+
     /// Returns compression type enum.
     /// Returns the enum value that represents the compressoion type
     /// @see BlockCompressionCodec::Type
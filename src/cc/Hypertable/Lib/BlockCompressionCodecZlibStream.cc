@@ -0,0 +1,197 @@
+/* -*- c++ -*-
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 3 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include <Common/Compat.h>
+
+#include "BlockCompressionCodecZlibStream.h"
+
+#include <Common/DynamicBuffer.h>
+#include <Common/Logger.h>
+#include <Common/Checksum.h>
+
+using namespace Hypertable;
+
+
+BlockCompressionCodecZlibStream::BlockCompressionCodecZlibStream(const Args &args)
+  : m_inflate_initialized(false), m_deflate_initialized(false),
+    m_level(Z_BEST_SPEED) {
+  set_args(args);
+}
+
+
+BlockCompressionCodecZlibStream::~BlockCompressionCodecZlibStream() {
+  if (m_deflate_initialized)
+    deflateEnd(&m_stream_deflate);
+  if (m_inflate_initialized)
+    inflateEnd(&m_stream_inflate);
+}
+
+void BlockCompressionCodecZlibStream::set_args(const Args &args) {
+  Args::const_iterator it = args.begin(), arg_end = args.end();
+
+  for (; it != arg_end; ++it) {
+    if (*it == "--best" || *it == "-9") {
+      m_level = Z_BEST_COMPRESSION;
+      if (m_deflate_initialized) {
+        deflateEnd(&m_stream_deflate);
+        m_deflate_initialized = false;
+      }
+    }
+    else if (*it == "--normal") {
+      m_level = Z_DEFAULT_COMPRESSION;
+      if (m_deflate_initialized) {
+        deflateEnd(&m_stream_deflate);
+        m_deflate_initialized = false;
+      }
+    }
+    else {
+      HT_THROWF(Error::BLOCK_COMPRESSOR_INVALID_ARG, "Unrecognized argument "
+                "to ZlibStream codec: '%s'", (*it).c_str());
+    }
+  }
+}
+
+void
+BlockCompressionCodecZlibStream::deflate(const DynamicBuffer &input,
+    DynamicBuffer &output, BlockHeader &header, size_t reserve) {
+  // worst-case deflate expansion (see http://www.zlib.net/zlib_tech.html)
+  // plus the sync flush marker
+  uint32_t avail_out = input.fill() + 6 + (((input.fill() / 16000) + 1) * 5) + 11;
+
+  if (!m_deflate_initialized) {
+    memset(&m_stream_deflate, 0, sizeof(m_stream_deflate));
+    m_stream_deflate.zalloc = Z_NULL;
+    m_stream_deflate.zfree = Z_NULL;
+    m_stream_deflate.opaque = Z_NULL;
+    int ret = deflateInit(&m_stream_deflate, m_level);
+    assert(ret == Z_OK);
+    (void)ret;
+    m_deflate_initialized = true;
+  }
+
+  output.clear();
+  output.reserve(header.encoded_length() + avail_out + reserve);
+
+  m_stream_deflate.avail_in = input.fill();
+  m_stream_deflate.next_in = input.base;
+
+  m_stream_deflate.avail_out = avail_out;
+  m_stream_deflate.next_out = output.base + header.encoded_length();
+
+  // A sync flush emits all pending output on a byte boundary but leaves
+  // the stream open, carrying the dictionary over to the next block
+  int ret = ::deflate(&m_stream_deflate, Z_SYNC_FLUSH);
+  assert(ret == Z_OK && m_stream_deflate.avail_in == 0);
+  (void)ret;
+
+  uint32_t zlen = avail_out - m_stream_deflate.avail_out;
+
+  // The decompressor's dictionary window must see every block, so there
+  // is no stored-uncompressed fallback for incompressible blocks
+  header.set_compression_type(ZLIBSTREAM);
+  header.set_data_length(input.fill());
+  header.set_data_zlength(zlen);
+
+  header.set_data_checksum(
+      header.compute_data_checksum(output.base + header.encoded_length(),
+                                   header.get_data_zlength()));
+
+  output.ptr = output.base;
+  header.encode(&output.ptr);
+  output.ptr += header.get_data_zlength();
+}
+
+
+void
+BlockCompressionCodecZlibStream::inflate(const DynamicBuffer &input,
+    DynamicBuffer &output, BlockHeader &header) {
+  int ret;
+  const uint8_t *msg_ptr = input.base;
+  size_t remaining = input.fill();
+
+  if (!m_inflate_initialized) {
+    memset(&m_stream_inflate, 0, sizeof(m_stream_inflate));
+    m_stream_inflate.zalloc = Z_NULL;
+    m_stream_inflate.zfree = Z_NULL;
+    m_stream_inflate.opaque = Z_NULL;
+    m_stream_inflate.avail_in = 0;
+    m_stream_inflate.next_in = Z_NULL;
+    int ret = inflateInit(&m_stream_inflate);
+    assert(ret == Z_OK);
+    (void)ret;
+    m_inflate_initialized = true;
+  }
+
+  header.decode(&msg_ptr, &remaining);
+
+  if (header.get_data_zlength() > remaining)
+    HT_THROWF(Error::BLOCK_COMPRESSOR_BAD_HEADER, "Block decompression error, "
+              "header zlength = %lu, actual = %lu",
+              (Lu)header.get_data_zlength(), (Lu)remaining);
+
+  uint32_t checksum =
+      header.compute_data_checksum(msg_ptr, header.get_data_zlength());
+
+  if (checksum != header.get_data_checksum())
+    HT_THROWF(Error::BLOCK_COMPRESSOR_CHECKSUM_MISMATCH, "Compressed block "
+              "checksum mismatch header=%lx, computed=%lx",
+              (Lu)header.get_data_checksum(), (Lu)checksum);
+
+  try {
+    output.reserve(header.get_data_length());
+
+    m_stream_inflate.avail_in = header.get_data_zlength();
+    m_stream_inflate.next_in = (Bytef *)msg_ptr;
+
+    m_stream_inflate.avail_out = header.get_data_length();
+    m_stream_inflate.next_out = output.base;
+
+    // The stream stays open across blocks; a sync-flushed block inflates
+    // completely with Z_OK rather than Z_STREAM_END
+    ret = ::inflate(&m_stream_inflate, Z_NO_FLUSH);
+    if (ret != Z_OK)
+      HT_THROWF(Error::BLOCK_COMPRESSOR_INFLATE_ERROR, "Compressed block "
+                "inflate error (return value = %d)", ret);
+
+    if (m_stream_inflate.avail_out != 0)
+      HT_THROWF(Error::BLOCK_COMPRESSOR_INFLATE_ERROR, "Compressed block "
+                "inflate error, expected %lu but only inflated to %lu bytes",
+                (Lu)header.get_data_length(),
+                (Lu)header.get_data_length() - m_stream_inflate.avail_out);
+
+    output.ptr = output.base + header.get_data_length();
+  }
+  catch (Exception &e) {
+    // The dictionary is out of sync after a failed block; subsequent
+    // blocks from the same stream cannot be decoded until reset()
+    reset();
+    output.free();
+    throw;
+  }
+}
+
+
+void BlockCompressionCodecZlibStream::reset() {
+  if (m_deflate_initialized)
+    ::deflateReset(&m_stream_deflate);
+  if (m_inflate_initialized)
+    ::inflateReset(&m_stream_inflate);
+}
@@ -0,0 +1,153 @@
+/* -*- c++ -*-
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 3 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/// @file
+/// Declarations for BlockCompressionCodecZlibStream.
+/// This file contains declarations for BlockCompressionCodecZlibStream, a
+/// class for compressing blocks using the ZLIB compression algorithm with a
+/// rolling dictionary carried across blocks.
+
+#ifndef HYPERTABLE_BLOCKCOMPRESSIONCODECZLIBSTREAM_H
+#define HYPERTABLE_BLOCKCOMPRESSIONCODECZLIBSTREAM_H
+
+#include <Hypertable/Lib/BlockCompressionCodec.h>
+
+extern "C" {
+#include <zlib.h>
+}
+
+namespace Hypertable {
+
+  /// @addtogroup libHypertable
+  /// @{
+
+  /// Block compressor that uses the ZLIB algorithm with a rolling dictionary.
+  /// Unlike BlockCompressionCodecZlib, which compresses each block
+  /// independently, this codec keeps the deflate (and inflate) stream open
+  /// across blocks, so the dictionary accumulated from earlier blocks raises
+  /// the compression ratio of subsequent small blocks (e.g. group commit
+  /// batches in the commit log).  Because each block can only be decompressed
+  /// after every preceding block since the last reset() has been fed to the
+  /// decompressor, this codec is only suitable for streams that are written
+  /// and replayed strictly sequentially, such as commit log fragments; it
+  /// must not be used for randomly accessed blocks like those in cell
+  /// stores.  Callers reset() the codec at stream (fragment) boundaries so
+  /// each fragment remains independently decodable.
+  class BlockCompressionCodecZlibStream : public BlockCompressionCodec {
+
+  public:
+    BlockCompressionCodecZlibStream(const Args &args);
+    virtual ~BlockCompressionCodecZlibStream();
+
+    /// Sets arguments to control compression behavior.
+    /// The arguments accepted by this method are described in the following
+    /// table.
+    /// <table>
+    /// <tr>
+    /// <th>Argument</th><th>Description</th>
+    /// </tr>
+    /// <tr>
+    /// <td><code>--best</code> or <code>--9</code> </td><td>Best compression
+    /// ratio</td>
+    /// </tr>
+    /// <tr>
+    /// <td><code>--normal</code> </td><td>Normal compression ratio</td>
+    /// </tr>
+    /// </table>
+    /// @param args Vector of arguments
+    virtual void set_args(const Args &args);
+
+    /// Compresses a buffer using the ZLIB algorithm with dictionary reuse.
+    /// This method first checks #m_deflate_initialized.  If is <i>false</i> it
+    /// initializes #m_stream_deflate and sets #m_deflate_initialized to
+    /// <i>true</i>.  It then reserves enough space in <code>output</code> to
+    /// hold the serialized <code>header</code> followed by the compressed
+    /// input followed by <code>reserve</code> bytes, and deflates the input
+    /// with a sync flush, leaving the stream (and therefore the dictionary
+    /// window) open for the next block.  Unlike the non-streaming codecs,
+    /// incompressible blocks are <b>not</b> stored uncompressed, since the
+    /// decompressor's dictionary window must see every block.  Before
+    /// serailizing <code>header</code>, the <i>data_length</i>,
+    /// <i>data_zlength</i>, <i>data_checksum</i>, and
+    /// <i>compression_type</i> fields are set appropriately.  The output
+    /// buffer is formatted as follows:
+    /// <table>
+    /// <tr>
+    /// <td>header</td><td>compressed data</td><td>reserve</td>
+    /// </tr>
+    /// </table>
+    /// @param input Input buffer
+    /// @param output Output buffer
+    /// @param header Block header populated by function
+    /// @param reserve Additional space to reserve at end of <code>output</code>
+    ///   buffer
+    virtual void deflate(const DynamicBuffer &input, DynamicBuffer &output,
+                         BlockHeader &header, size_t reserve=0);
+
+    /// Decompresses a buffer compressed with the streaming ZLIB codec.
+    /// This method first checks #m_inflate_initialized.  If is <i>false</i> it
+    /// initializes #m_stream_inflate and sets #m_inflate_initialized to
+    /// <i>true</i>.  It then decompresses the <code>input</code> buffer,
+    /// leaving the inflate stream open so the dictionary carries over to the
+    /// next block.  Blocks must be presented in the order they were
+    /// compressed, starting from the last reset().
+    /// @see deflate() for description of input buffer format
+    /// @param input Input buffer
+    /// @param output Output buffer
+    /// @param header Block header
+    virtual void inflate(const DynamicBuffer &input, DynamicBuffer &output,
+                         BlockHeader &header);
+
+    /// Resets the rolling dictionary.
+    /// Resets the deflate and inflate streams, discarding the dictionary
+    /// accumulated from previous blocks.  Called at stream (fragment)
+    /// boundaries.
+    virtual void reset();
+
+    /// Returns enum value representing compression type ZLIBSTREAM.
+    /// Returns the enum value ZLIBSTREAM
+    /// @see BlockCompressionCodec::ZLIBSTREAM
+    /// @return Compression type (ZLIBSTREAM)
+    virtual int get_type() { return ZLIBSTREAM; }
+
+  private:
+
+    /// Inflate state, carried across blocks
+    z_stream m_stream_inflate;
+
+    /// Flag indicating that inflate state has been initialized
+    bool m_inflate_initialized;
+
+    /// Deflate state, carried across blocks
+    z_stream m_stream_deflate;
+
+    /// Flag indicating that deflate state has been initialized
+    bool m_deflate_initialized;
+
+    /// Compression level
+    int m_level;
+  };
+
+  /// @}
+
+}
+
+#endif // HYPERTABLE_BLOCKCOMPRESSIONCODECZLIBSTREAM_H
@@ -0,0 +1,178 @@
+/* -*- c++ -*-
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 3 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include <Common/Compat.h>
+
+#include "BlockCompressionCodecZstd.h"
+
+#include <Common/Checksum.h>
+#include <Common/FileUtils.h>
+#include <Common/Logger.h>
+
+#include <cstdlib>
+
+using namespace Hypertable;
+
+
+BlockCompressionCodecZstd::BlockCompressionCodecZstd(const Args &args) {
+  m_cctx = ZSTD_createCCtx();
+  m_dctx = ZSTD_createDCtx();
+  HT_ASSERT(m_cctx && m_dctx);
+  set_args(args);
+}
+
+
+BlockCompressionCodecZstd::~BlockCompressionCodecZstd() {
+  ZSTD_freeCCtx(m_cctx);
+  ZSTD_freeDCtx(m_dctx);
+}
+
+void BlockCompressionCodecZstd::set_args(const Args &args) {
+  Args::const_iterator it = args.begin(), arg_end = args.end();
+
+  for (; it != arg_end; ++it) {
+    if (*it == "--best")
+      m_level = ZSTD_maxCLevel();
+    else if (*it == "--level") {
+      if (++it == arg_end)
+        HT_THROW(Error::BLOCK_COMPRESSOR_INVALID_ARG, "Zstd codec argument "
+                 "--level requires a value");
+      m_level = atoi((*it).c_str());
+      if (m_level < 1 || m_level > ZSTD_maxCLevel())
+        HT_THROWF(Error::BLOCK_COMPRESSOR_INVALID_ARG, "Invalid Zstd "
+                  "compression level: '%s'", (*it).c_str());
+    }
+    else if (*it == "--dict") {
+      if (++it == arg_end)
+        HT_THROW(Error::BLOCK_COMPRESSOR_INVALID_ARG, "Zstd codec argument "
+                 "--dict requires a value");
+      off_t len {};
+      char *base = FileUtils::file_to_buffer(*it, &len);
+      if (base == 0 || len == 0)
+        HT_THROWF(Error::BLOCK_COMPRESSOR_INVALID_ARG, "Unable to load Zstd "
+                  "dictionary from file '%s'", (*it).c_str());
+      set_dictionary(base, len);
+      delete [] base;
+    }
+    else {
+      HT_THROWF(Error::BLOCK_COMPRESSOR_INVALID_ARG, "Unrecognized argument "
+                "to Zstd codec: '%s'", (*it).c_str());
+    }
+  }
+}
+
+void BlockCompressionCodecZstd::set_dictionary(const void *base, size_t len) {
+  m_dict.clear();
+  m_dict.add(base, len);
+}
+
+void
+BlockCompressionCodecZstd::deflate(const DynamicBuffer &input,
+    DynamicBuffer &output, BlockHeader &header, size_t reserve) {
+  size_t avail_out = ZSTD_compressBound(input.fill());
+
+  output.clear();
+  output.reserve(header.encoded_length() + avail_out + reserve);
+
+  size_t zlen =
+    ZSTD_compress_usingDict(m_cctx, output.base + header.encoded_length(),
+                            avail_out, input.base, input.fill(),
+                            m_dict.base, m_dict.fill(), m_level);
+  if (ZSTD_isError(zlen))
+    HT_THROWF(Error::BLOCK_COMPRESSOR_DEFLATE_ERROR, "Compressed block "
+              "deflate error: %s", ZSTD_getErrorName(zlen));
+
+  /* check for an incompressible block */
+  if (zlen >= input.fill()) {
+    header.set_compression_type(NONE);
+    memcpy(output.base+header.encoded_length(), input.base, input.fill());
+    header.set_data_length(input.fill());
+    header.set_data_zlength(input.fill());
+  }
+  else {
+    header.set_compression_type(ZSTD);
+    header.set_data_length(input.fill());
+    header.set_data_zlength(zlen);
+  }
+
+  header.set_data_checksum(
+      header.compute_data_checksum(output.base + header.encoded_length(),
+                                   header.get_data_zlength()));
+
+  output.ptr = output.base;
+  header.encode(&output.ptr);
+  output.ptr += header.get_data_zlength();
+}
+
+
+/**
+ *
+ */
+void
+BlockCompressionCodecZstd::inflate(const DynamicBuffer &input,
+    DynamicBuffer &output, BlockHeader &header) {
+  const uint8_t *msg_ptr = input.base;
+  size_t remaining = input.fill();
+
+  header.decode(&msg_ptr, &remaining);
+
+  if (header.get_data_zlength() > remaining)
+    HT_THROWF(Error::BLOCK_COMPRESSOR_BAD_HEADER, "Block decompression error, "
+              "header zlength = %lu, actual = %lu",
+              (Lu)header.get_data_zlength(), (Lu)remaining);
+
+  uint32_t checksum =
+      header.compute_data_checksum(msg_ptr, header.get_data_zlength());
+
+  if (checksum != header.get_data_checksum())
+    HT_THROWF(Error::BLOCK_COMPRESSOR_CHECKSUM_MISMATCH, "Compressed block "
+              "checksum mismatch header=%lx, computed=%lx",
+              (Lu)header.get_data_checksum(), (Lu)checksum);
+
+  try {
+    output.reserve(header.get_data_length());
+
+     // check compress bit
+    if (header.get_compression_type() == NONE)
+      memcpy(output.base, msg_ptr, header.get_data_length());
+    else {
+      size_t len =
+        ZSTD_decompress_usingDict(m_dctx, output.base,
+                                  header.get_data_length(), msg_ptr,
+                                  header.get_data_zlength(),
+                                  m_dict.base, m_dict.fill());
+      if (ZSTD_isError(len))
+        HT_THROWF(Error::BLOCK_COMPRESSOR_INFLATE_ERROR, "Compressed block "
+                  "inflate error: %s", ZSTD_getErrorName(len));
+
+      if (len != header.get_data_length())
+        HT_THROWF(Error::BLOCK_COMPRESSOR_INFLATE_ERROR, "Compressed block "
+                  "inflate error, expected %lu but only inflated to %lu bytes",
+                  (Lu)header.get_data_length(), (Lu)len);
+    }
+
+    output.ptr = output.base + header.get_data_length();
+  }
+  catch (Exception &e) {
+    output.free();
+    throw;
+  }
+}
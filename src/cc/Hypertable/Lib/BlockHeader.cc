@@ -42,7 +42,7 @@ using namespace Hypertable;
 using namespace Serialization;
 
 namespace {
-  const size_t VersionLengths[BlockHeader::LatestVersion+1] = { 26, 28 };
+  const size_t VersionLengths[BlockHeader::LatestVersion+1] = { 26, 28, 28 };
 }
 
 const uint16_t BlockHeader::LatestVersion;
@@ -73,6 +73,13 @@ BlockHeader::write_header_checksum(uint8_t *base) {
 }
 
 
+uint32_t BlockHeader::compute_data_checksum(const void *data, size_t len) {
+  if (m_version >= 2)
+    return crc32c(data, len);
+  return fletcher32(data, len);
+}
+
+
 size_t BlockHeader::encoded_length() {
   return VersionLengths[m_version];
 }
@@ -49,7 +49,7 @@ namespace Hypertable {
 
   public:
 
-    static const uint16_t LatestVersion = 1;    
+    static const uint16_t LatestVersion = 2;
 
     /** Constructor.
      * Initializes #m_version to <code>version</code>, #m_magic with the first
@@ -150,6 +150,18 @@ namespace Hypertable {
      */
     void write_header_checksum(uint8_t *base);
 
+    /** Computes the data checksum for the header's version.
+     * Version 2 headers checksum block data with CRC32C, which is computed
+     * in hardware on modern processors; older versions use fletcher32 so
+     * that existing files continue to verify.  Compression codecs call this
+     * method rather than a checksum function directly so that the algorithm
+     * is negotiated by the block header version.
+     * @param data Pointer to (possibly compressed) block data
+     * @param len Length of data in bytes
+     * @return The calculated checksum
+     */
+    uint32_t compute_data_checksum(const void *data, size_t len);
+
     /** Returns length of serizlized block header.
      * @see encode() for layout
      * @return Length of serialized block header.
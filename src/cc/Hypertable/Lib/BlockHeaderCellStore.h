@@ -48,7 +48,7 @@ namespace Hypertable {
 
   public:
 
-    static const uint16_t LatestVersion = 1;
+    static const uint16_t LatestVersion = 2;
 
     /** Constructor with version and magic string initializers.
      * Initializes #m_version to to <code>version</code> and passes
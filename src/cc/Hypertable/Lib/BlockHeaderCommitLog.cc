@@ -37,8 +37,8 @@ using namespace Hypertable;
 using namespace Serialization;
 
 namespace {
-  const size_t EncodedLengths[BlockHeaderCommitLog::LatestVersion+1] = { 8, 16 };
-  const uint16_t BaseVersions[BlockHeaderCommitLog::LatestVersion+1] = { 0, 1 };
+  const size_t EncodedLengths[BlockHeaderCommitLog::LatestVersion+1] = { 8, 16, 16 };
+  const uint16_t BaseVersions[BlockHeaderCommitLog::LatestVersion+1] = { 0, 1, 2 };
 }
 
 const uint16_t BlockHeaderCommitLog::LatestVersion;
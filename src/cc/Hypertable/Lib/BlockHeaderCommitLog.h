@@ -48,7 +48,7 @@ namespace Hypertable {
 
   public:
 
-    static const uint16_t LatestVersion = 1;
+    static const uint16_t LatestVersion = 2;
 
     /** Constructor with version number.
      * Initializes #m_version to <code>version</code> and initializes all other
@@ -181,6 +181,11 @@ namespace Hypertable {
       patterns.push_back(std::make_shared<CellPattern>(column_predicate, id));
     }
 
+    /// Checks if any patterns were supplied for this predicate.
+    /// @return <i>true</i> if the predicate has patterns, otherwise
+    /// <i>false</i> (matches() trivially returns <i>true</i>)
+    bool has_patterns() const { return !patterns.empty(); }
+
     /// TTL cutoff time
     int64_t cutoff_time;
 
@@ -47,6 +47,8 @@
 
 #include <cassert>
 #include <cstdlib>
+#include <mutex>
+#include <thread>
 
 extern "C" {
 #include <poll.h>
@@ -229,25 +231,56 @@ void Client::initialize() {
     wait_time = (remaining < interval) ? remaining : interval;
   }
 
-  // Initialize cluster ID from Hyperspace, enabling ClusterId::get()
-  ClusterId cluster_id(m_hyperspace);
-
   m_namemap = make_shared<NameIdMapper>(m_hyperspace, m_toplevel_dir);
 
   m_app_queue =
     make_shared<ApplicationQueue>(m_props->get_i32("Hypertable.Client.Workers"));
 
-  m_master_client =
-    make_shared<Lib::Master::Client>(m_conn_manager, m_hyperspace, m_toplevel_dir,
-                            m_timeout_ms, m_app_queue,
-                            DispatchHandlerPtr(), ConnectionInitializerPtr());
+  // The Master location lookup plus connect, and the cluster ID fetch plus
+  // root METADATA discovery in the RangeLocator constructor, are
+  // independent sequences of Hyperspace lookups; overlapping them brings
+  // client cold start close to the slowest of the two instead of their sum
+  std::exception_ptr init_error;
+  std::mutex error_mutex;
+
+  auto capture_error = [&]() {
+    lock_guard<std::mutex> lock(error_mutex);
+    if (!init_error)
+      init_error = std::current_exception();
+  };
+
+  std::thread master_init([&]() {
+    try {
+      m_master_client =
+        make_shared<Lib::Master::Client>(m_conn_manager, m_hyperspace,
+                              m_toplevel_dir, m_timeout_ms, m_app_queue,
+                              DispatchHandlerPtr(), ConnectionInitializerPtr());
+
+      if (!m_master_client->wait_for_connection(timer))
+        HT_THROW(Error::REQUEST_TIMEOUT, "Waiting for Master connection");
+    }
+    catch (...) {
+      capture_error();
+    }
+  });
+
+  try {
+    // Initialize cluster ID from Hyperspace, enabling ClusterId::get()
+    // (the RangeLocator consults it when warming its location cache)
+    ClusterId cluster_id(m_hyperspace);
+
+    m_range_locator =
+      make_shared<RangeLocator>(m_props, m_conn_manager,
+                                m_hyperspace, m_timeout_ms);
+  }
+  catch (...) {
+    capture_error();
+  }
 
-  if (!m_master_client->wait_for_connection(timer))
-    HT_THROW(Error::REQUEST_TIMEOUT, "Waiting for Master connection");
+  master_init.join();
 
-  m_range_locator =
-    make_shared<RangeLocator>(m_props, m_conn_manager,
-                              m_hyperspace, m_timeout_ms);
+  if (init_error)
+    std::rethrow_exception(init_error);
 
   m_table_cache =
     make_shared<TableCache>(m_props, m_range_locator, m_conn_manager,
@@ -28,6 +28,7 @@
 #include "ColumnFamilySpec.h"
 
 #include <Common/Error.h>
+#include <Common/Serialization.h>
 #include <Common/XmlParser.h>
 
 #include <algorithm>
@@ -106,6 +107,9 @@ bool ColumnFamilyOptions::set_counter(bool value) {
     if (m_time_order_desc)
       HT_THROW(Error::INCOMPATIBLE_OPTIONS,
                 "COUNTER and TIME_ORDER_DESC are incompatible");
+    if (m_value_dictionary)
+      HT_THROW(Error::INCOMPATIBLE_OPTIONS,
+                "COUNTER and VALUE_DICTIONARY are incompatible");
   }
   m_isset.set(COUNTER);
   if (m_counter != value) {
@@ -120,6 +124,25 @@ bool ColumnFamilyOptions::is_set_counter() const {
 }
 
 
+bool ColumnFamilyOptions::set_value_dictionary(bool value) {
+  if (value) {
+    if (m_counter)
+      HT_THROW(Error::INCOMPATIBLE_OPTIONS,
+                "COUNTER and VALUE_DICTIONARY are incompatible");
+  }
+  m_isset.set(VALUE_DICTIONARY);
+  if (m_value_dictionary != value) {
+    m_value_dictionary = value;
+    return true;
+  }
+  return false;
+}
+
+bool ColumnFamilyOptions::is_set_value_dictionary() const {
+  return m_isset.test(VALUE_DICTIONARY);
+}
+
+
 void ColumnFamilyOptions::merge(const ColumnFamilyOptions &other) {
   if (!is_set_max_versions() && other.is_set_max_versions())
     set_max_versions(other.get_max_versions());
@@ -129,6 +152,8 @@ void ColumnFamilyOptions::merge(const ColumnFamilyOptions &other) {
     set_time_order_desc(other.get_time_order_desc());
   if (!is_set_counter() && other.is_set_counter())
     set_counter(other.get_counter());
+  if (!is_set_value_dictionary() && other.is_set_value_dictionary())
+    set_value_dictionary(other.get_value_dictionary());
 }
 
 namespace {
@@ -148,6 +173,8 @@ namespace {
                                                        {"asc","desc"})=="desc");
       else if (!strcasecmp(name, "Counter"))
         m_options->set_counter(content_to_bool(name, content));
+      else if (!strcasecmp(name, "ValueDictionary"))
+        m_options->set_value_dictionary(content_to_bool(name, content));
       else if (!m_element_stack.empty())
         HT_THROWF(Error::SCHEMA_PARSE_ERROR,
                   "Unrecognized ColumnFamily option element (%s)", name);
@@ -176,6 +203,10 @@ const std::string ColumnFamilyOptions::render_xml(const std::string &line_prefix
   if (is_set_counter())
     xstr += format("%s<Counter>%s</Counter>\n", line_prefix.c_str(),
                    m_counter ? "true" : "false");
+  if (is_set_value_dictionary())
+    xstr += format("%s<ValueDictionary>%s</ValueDictionary>\n",
+                   line_prefix.c_str(),
+                   m_value_dictionary ? "true" : "false");
   return xstr;
 }
 
@@ -189,6 +220,9 @@ const std::string ColumnFamilyOptions::render_hql() const {
     hstr += format(" TIME_ORDER %s", m_time_order_desc ? "desc" : "asc");
   if (is_set_counter())
     hstr += format(" COUNTER %s", m_counter ? "true" : "false");
+  if (is_set_value_dictionary())
+    hstr += format(" VALUE_DICTIONARY %s",
+                   m_value_dictionary ? "true" : "false");
   return hstr;
 }
 
@@ -197,7 +231,8 @@ bool ColumnFamilyOptions::operator==(const ColumnFamilyOptions &other) const {
           m_max_versions == other.m_max_versions &&
           m_ttl == other.m_ttl &&
           m_time_order_desc == other.m_time_order_desc &&
-          m_counter == other.m_counter);
+          m_counter == other.m_counter &&
+          m_value_dictionary == other.m_value_dictionary);
 }
 
 void ColumnFamilySpec::set_name(const std::string &name) {
@@ -253,6 +288,11 @@ void ColumnFamilySpec::set_option_counter(bool value) {
     m_generation = 0;
 }
 
+void ColumnFamilySpec::set_option_value_dictionary(bool value) {
+  if (m_options.set_value_dictionary(value))
+    m_generation = 0;
+}
+
 void ColumnFamilySpec::set_value_index(bool value) {
   if (value && m_options.get_counter())
     HT_THROW(Error::INCOMPATIBLE_OPTIONS,
@@ -335,6 +375,8 @@ namespace {
         }
         else if (!strcasecmp(name, "Counter"))
           m_spec->set_option_counter(content_to_bool(name, content));
+        else if (!strcasecmp(name, "ValueDictionary"))
+          m_spec->set_option_value_dictionary(content_to_bool(name, content));
         else if (!strcasecmp(name, "Renamed") || !strcasecmp(name, "NewName"))
           ;
         else
@@ -422,3 +464,87 @@ const std::string ColumnFamilySpec::render_hql() const {
 
   return output;
 }
+
+uint8_t ColumnFamilyOptions::encoding_version() const {
+  return 1;
+}
+
+size_t ColumnFamilyOptions::encoded_length_internal() const {
+  return 15;
+}
+
+/// @details
+/// Encoding is as follows:
+/// <table>
+/// <tr><th>Encoding</th><th>Description</th></tr>
+/// <tr><td>i32</td><td>Max versions</td></tr>
+/// <tr><td>i32</td><td>TTL</td></tr>
+/// <tr><td>bool</td><td>Time order "desc" flag</td></tr>
+/// <tr><td>bool</td><td>Counter flag</td></tr>
+/// <tr><td>bool</td><td>Value dictionary flag</td></tr>
+/// <tr><td>i32</td><td><i>isset</i> bits</td></tr>
+/// </table>
+void ColumnFamilyOptions::encode_internal(uint8_t **bufp) const {
+  Serialization::encode_i32(bufp, m_max_versions);
+  Serialization::encode_i32(bufp, (int32_t)m_ttl);
+  Serialization::encode_bool(bufp, m_time_order_desc);
+  Serialization::encode_bool(bufp, m_counter);
+  Serialization::encode_bool(bufp, m_value_dictionary);
+  Serialization::encode_i32(bufp, (uint32_t)m_isset.to_ulong());
+}
+
+void ColumnFamilyOptions::decode_internal(uint8_t version, const uint8_t **bufp,
+                                          size_t *remainp) {
+  m_max_versions = Serialization::decode_i32(bufp, remainp);
+  m_ttl = (time_t)Serialization::decode_i32(bufp, remainp);
+  m_time_order_desc = Serialization::decode_bool(bufp, remainp);
+  m_counter = Serialization::decode_bool(bufp, remainp);
+  m_value_dictionary = Serialization::decode_bool(bufp, remainp);
+  m_isset = bitset<MAX>(Serialization::decode_i32(bufp, remainp));
+}
+
+uint8_t ColumnFamilySpec::encoding_version() const {
+  return 1;
+}
+
+size_t ColumnFamilySpec::encoded_length_internal() const {
+  return Serialization::encoded_length_vstr(m_name) +
+    Serialization::encoded_length_vstr(m_ag) + 15 +
+    m_options.encoded_length();
+}
+
+/// @details
+/// Encoding is as follows:
+/// <table>
+/// <tr><th>Encoding</th><th>Description</th></tr>
+/// <tr><td>vstr</td><td>Name</td></tr>
+/// <tr><td>vstr</td><td>Access group</td></tr>
+/// <tr><td>i64</td><td>Generation</td></tr>
+/// <tr><td>i32</td><td>ID</td></tr>
+/// <tr><td>bool</td><td>Value index flag</td></tr>
+/// <tr><td>bool</td><td>Qualifier index flag</td></tr>
+/// <tr><td>bool</td><td>Deleted flag</td></tr>
+/// <tr><td>ColumnFamilyOptions</td><td>Options</td></tr>
+/// </table>
+void ColumnFamilySpec::encode_internal(uint8_t **bufp) const {
+  Serialization::encode_vstr(bufp, m_name);
+  Serialization::encode_vstr(bufp, m_ag);
+  Serialization::encode_i64(bufp, m_generation);
+  Serialization::encode_i32(bufp, m_id);
+  Serialization::encode_bool(bufp, m_value_index);
+  Serialization::encode_bool(bufp, m_qualifier_index);
+  Serialization::encode_bool(bufp, m_deleted);
+  m_options.encode(bufp);
+}
+
+void ColumnFamilySpec::decode_internal(uint8_t version, const uint8_t **bufp,
+                                       size_t *remainp) {
+  m_name = Serialization::decode_vstr(bufp, remainp);
+  m_ag = Serialization::decode_vstr(bufp, remainp);
+  m_generation = Serialization::decode_i64(bufp, remainp);
+  m_id = Serialization::decode_i32(bufp, remainp);
+  m_value_index = Serialization::decode_bool(bufp, remainp);
+  m_qualifier_index = Serialization::decode_bool(bufp, remainp);
+  m_deleted = Serialization::decode_bool(bufp, remainp);
+  m_options.decode(bufp, remainp);
+}
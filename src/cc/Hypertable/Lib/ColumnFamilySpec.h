@@ -27,6 +27,8 @@
 #ifndef Hypertable_Lib_ColumnFamilySpec_h
 #define Hypertable_Lib_ColumnFamilySpec_h
 
+#include <Common/Serializable.h>
+
 #include <bitset>
 #include <unordered_map>
 #include <vector>
@@ -37,7 +39,7 @@ namespace Hypertable {
   /// @{
 
   /// Specification for column family options.
-  class ColumnFamilyOptions {
+  class ColumnFamilyOptions : public Serializable {
   public:
 
     /// Enumeration for <i>isset</i> bits
@@ -50,6 +52,8 @@ namespace Hypertable {
       TIME_ORDER_DESC,
       /// <i>counter</i> bit
       COUNTER,
+      /// <i>value dictionary</i> bit
+      VALUE_DICTIONARY,
       /// Total bit count
       MAX
     };
@@ -138,6 +142,31 @@ namespace Hypertable {
     /// otherwise.
     bool is_set_counter() const;
 
+    /// Sets <i>value dictionary</i> option.
+    /// Sets the VALUE_DICTIONARY bit of #m_isset and sets #m_value_dictionary
+    /// to <code>value</code>.  When set, cell stores build a per-file
+    /// dictionary of the column family's values during compaction and store
+    /// dictionary codes in place of repeated values.
+    /// @param value New value for <i>value dictionary</i> option.
+    /// @return <i>true</i> if <i>value dictionary</i> option was set,
+    /// otherwise <i>false</i> if <i>value dictionary</i> option was not set
+    /// because the supplied <code>value</code> was equal to the existing
+    /// value.
+    /// @throws Exception if supplied <code>value</code> is <i>true</i> and the
+    /// <i>counter</i> option is set, which is incompatible with the
+    /// <i>value dictionary</i> option.
+    bool set_value_dictionary(bool value);
+
+    /// Gets the <i>value dictionary</i> option.
+    /// @return <i>value dictionary</i> option.
+    bool get_value_dictionary() const { return m_value_dictionary; }
+
+    /// Checks if <i>value dictionary</i> option is set.
+    /// This method returns the value of the VALUE_DICTIONARY bit of #m_isset.
+    /// @return <i>true</i> if <i>value dictionary</i> option is set,
+    /// <i>false</i> otherwise.
+    bool is_set_value_dictionary() const;
+
     /// Merges options from another ColumnFamilyOptions object.
     /// For each option that is not set, if the corresponding option in the
     /// <code>other</code> parameter is set, then the option is set to
@@ -203,6 +232,30 @@ namespace Hypertable {
     /// <i>false</i> otherwise.
     bool operator==(const ColumnFamilyOptions &other) const;
 
+  protected:
+
+    /// Returns encoding version.
+    /// @return Encoding version
+    uint8_t encoding_version() const override;
+
+    /// Returns internal serialized length.
+    /// @return Internal serialized length
+    /// @see encode_internal() for encoding format
+    size_t encoded_length_internal() const override;
+
+    /// Writes serialized representation of object to a buffer.
+    /// @param bufp Address of destination buffer pointer (advanced by call)
+    void encode_internal(uint8_t **bufp) const override;
+
+    /// Reads serialized representation of object from a buffer.
+    /// @param version Encoding version
+    /// @param bufp Address of destination buffer pointer (advanced by call)
+    /// @param remainp Address of integer holding amount of serialized object
+    /// remaining
+    /// @see encode_internal() for encoding format
+    void decode_internal(uint8_t version, const uint8_t **bufp,
+                         size_t *remainp) override;
+
   private:
 
     /// Max version
@@ -217,12 +270,15 @@ namespace Hypertable {
     /// Counter
     bool m_counter {};
 
+    /// Value dictionary flag
+    bool m_value_dictionary {};
+
     /// Bit mask describing which options are set
     std::bitset<MAX> m_isset;
   };
 
   /// %Column family specification.
-  class ColumnFamilySpec {
+  class ColumnFamilySpec : public Serializable {
   public:
 
     /// Default constructor.
@@ -348,6 +404,21 @@ namespace Hypertable {
     /// @return <i>counter</i> option.
     bool get_option_counter() const { return m_options.get_counter(); }
 
+    /// Sets <i>value dictionary</i> option.
+    /// Sets the <i>value dictionary</i> option of the #m_options member to
+    /// <code>value</code>.
+    /// @param value New value for <i>value dictionary</i> option.
+    /// @throws Exception if supplied <code>value</code> is <i>true</i> and the
+    /// <i>counter</i> option is set, which is incompatible with the
+    /// <i>value dictionary</i> option.
+    void set_option_value_dictionary(bool value);
+
+    /// Gets the <i>value dictionary</i> option.
+    /// @return <i>value dictionary</i> option.
+    bool get_option_value_dictionary() const {
+      return m_options.get_value_dictionary();
+    }
+
     /// Merges options from another ColumnFamilyOptions object.
     /// Merges options from <code>other</code> int #m_options.
     /// @param other ColumnFamilyOptions object with which to merge
@@ -411,6 +482,30 @@ namespace Hypertable {
     /// @return Reference to options structure.
     const ColumnFamilyOptions &options() const { return m_options; }
 
+  protected:
+
+    /// Returns encoding version.
+    /// @return Encoding version
+    uint8_t encoding_version() const override;
+
+    /// Returns internal serialized length.
+    /// @return Internal serialized length
+    /// @see encode_internal() for encoding format
+    size_t encoded_length_internal() const override;
+
+    /// Writes serialized representation of object to a buffer.
+    /// @param bufp Address of destination buffer pointer (advanced by call)
+    void encode_internal(uint8_t **bufp) const override;
+
+    /// Reads serialized representation of object from a buffer.
+    /// @param version Encoding version
+    /// @param bufp Address of destination buffer pointer (advanced by call)
+    /// @param remainp Address of integer holding amount of serialized object
+    /// remaining
+    /// @see encode_internal() for encoding format
+    void decode_internal(uint8_t version, const uint8_t **bufp,
+                         size_t *remainp) override;
+
   private:
 
     /// %Column family name
@@ -30,6 +30,7 @@
 
 #include <Hypertable/Lib/BlockCompressionCodec.h>
 #include <Hypertable/Lib/BlockHeaderCommitLog.h>
+#include <Hypertable/Lib/CommitLogArchiver.h>
 #include <Hypertable/Lib/CommitLogReader.h>
 #include <Hypertable/Lib/CompressorFactory.h>
 
@@ -70,10 +71,10 @@ void
 CommitLog::initialize(const string &log_dir, PropertiesPtr &props,
                       CommitLogBase *init_log, bool is_meta) {
   string compressor;
+  int32_t partitions = 1;
 
   m_log_dir = log_dir;
-  m_cur_fragment_num = 0;
-  m_needs_roll = false;
+  m_next_fragment_num = 0;
   m_replication = -1;
 
   if (is_meta)
@@ -85,9 +86,22 @@ CommitLog::initialize(const string &log_dir, PropertiesPtr &props,
 
   HT_TRY("getting commit log properites",
     m_max_fragment_size = cfg.get_i64("RollLimit");
-    compressor = cfg.get_str("Compressor"));
+    compressor = cfg.get_str("Compressor");
+    partitions = cfg.get_i32("Partitions"));
 
-  m_compressor.reset(CompressorFactory::create_block_codec(compressor));
+  if (partitions < 1)
+    partitions = 1;
+
+  m_compressor_spec = compressor;
+  {
+    BlockCompressionCodec::Args codec_args;
+    m_compressor_streaming =
+      CompressorFactory::parse_block_codec_spec(m_compressor_spec, codec_args)
+      == BlockCompressionCodec::ZLIBSTREAM;
+  }
+  if (!m_compressor_streaming)
+    m_compressor_pool.push(unique_ptr<BlockCompressionCodec>(
+        CompressorFactory::create_block_codec(m_compressor_spec)));
 
   boost::trim_right_if(m_log_dir, boost::is_any_of("/"));
 
@@ -98,8 +112,8 @@ CommitLog::initialize(const string &log_dir, PropertiesPtr &props,
       m_range_reference_required = init_log->range_reference_required();
     stitch_in(init_log);
     for (const auto frag : m_fragment_queue) {
-      if (frag->num >= m_cur_fragment_num)
-        m_cur_fragment_num = frag->num + 1;
+      if (frag->num >= m_next_fragment_num)
+        m_next_fragment_num = frag->num + 1;
     }
   }
   else {  // chose one past the max one found in the directory
@@ -108,8 +122,8 @@ CommitLog::initialize(const string &log_dir, PropertiesPtr &props,
     m_fs->readdir(m_log_dir, listing);
     for (size_t i=0; i<listing.size(); i++) {
       num = atoi(listing[i].name.c_str());
-      if (num >= m_cur_fragment_num)
-        m_cur_fragment_num = num + 1;
+      if (num >= m_next_fragment_num)
+        m_next_fragment_num = num + 1;
     }
   }
 
@@ -118,89 +132,235 @@ CommitLog::initialize(const string &log_dir, PropertiesPtr &props,
   else
     HT_INFOF("Range reference for '%s' is NOT required", m_log_dir.c_str());
 
-  m_cur_fragment_fname = m_log_dir + "/" + m_cur_fragment_num;
-
   try {
     m_fs->mkdirs(m_log_dir);
-    m_fd = m_fs->create(m_cur_fragment_fname, Filesystem::OPEN_FLAG_OVERWRITE,
-                        -1, m_replication, -1);
-    CommitLogBlockStream::write_header(m_fs, m_fd);
-    m_cur_fragment_length = CommitLogBlockStream::header_size();
+    for (int32_t i=0; i<partitions; i++) {
+      m_partitions.push_back(unique_ptr<LogPartition>(new LogPartition()));
+      if (m_compressor_streaming)
+        m_partitions.back()->compressor.reset(
+            CompressorFactory::create_block_codec(m_compressor_spec));
+      create_next_fragment(*m_partitions.back());
+    }
   }
   catch (Hypertable::Exception &e) {
     HT_ERRORF("Problem initializing commit log '%s' - %s (%s)",
               m_log_dir.c_str(), e.what(), Error::get_text(e.code()));
-    m_fd = -1;
+    m_closed = true;
     throw;
   }
 }
 
 
+void CommitLog::create_next_fragment(LogPartition &partition) {
+  {
+    lock_guard<mutex> lock(m_mutex);
+    partition.cur_fragment_num = m_next_fragment_num++;
+  }
+  partition.cur_fragment_fname = m_log_dir + "/" + partition.cur_fragment_num;
+  partition.fd = m_fs->create(partition.cur_fragment_fname,
+                              Filesystem::OPEN_FLAG_OVERWRITE, -1,
+                              m_replication, -1);
+  CommitLogBlockStream::write_header(m_fs, partition.fd);
+  partition.cur_fragment_length = CommitLogBlockStream::header_size();
+}
+
+
 int64_t CommitLog::get_timestamp() {
   return get_ts64();
 }
 
 int CommitLog::flush() {
-  lock_guard<mutex> lock(m_mutex);
   int error {};
 
-  try {
-    if (m_fd == -1)
-      return Error::CLOSED;
-    m_fs->flush(m_fd);
-  }
-  catch (Exception &e) {
-    HT_ERRORF("Problem flushing commit log: %s: %s",
-              m_cur_fragment_fname.c_str(), e.what());
-    error = e.code();
+  for (auto &partition : m_partitions) {
+    lock_guard<mutex> lock(partition->mutex);
+    try {
+      if (partition->fd == -1)
+        return Error::CLOSED;
+      m_fs->flush(partition->fd);
+    }
+    catch (Exception &e) {
+      HT_ERRORF("Problem flushing commit log: %s: %s",
+                partition->cur_fragment_fname.c_str(), e.what());
+      error = e.code();
+    }
   }
 
   return error;
 }
 
 int CommitLog::sync() {
-  lock_guard<mutex> lock(m_mutex);
   int error {};
 
-  try {
-    if (m_fd == -1)
+  for (auto &partition : m_partitions) {
+    int partition_error = sync_partition(*partition);
+    if (partition_error != Error::OK)
+      error = partition_error;
+  }
+
+  return error;
+}
+
+
+int CommitLog::sync_partition(LogPartition &partition) {
+  unique_lock<mutex> lock(partition.mutex);
+  uint64_t target = partition.append_seqno;
+  int error {};
+
+  while (true) {
+    // A sync that completed while this thread was waiting may already
+    // cover its appends
+    if (partition.synced_seqno >= target)
+      return Error::OK;
+    if (partition.fd == -1)
       return Error::CLOSED;
-    m_fs->sync(m_fd);
+    if (!partition.sync_in_progress)
+      break;
+    partition.sync_cond.wait(lock);
+  }
+
+  // Issue one sync covering every block appended so far; the lock is
+  // released so that writers keep appending while the sync is in flight
+  uint64_t covering = partition.append_seqno;
+  int32_t fd = partition.fd;
+  string fragment_fname = partition.cur_fragment_fname;
+  partition.sync_in_progress = true;
+  lock.unlock();
+
+  int64_t start_time = get_ts64();
+
+  try {
+    m_fs->sync(fd);
   }
   catch (Exception &e) {
     HT_ERRORF("Problem syncing commit log: %s: %s",
-              m_cur_fragment_fname.c_str(), e.what());
+              fragment_fname.c_str(), e.what());
     error = e.code();
   }
 
+  int64_t elapsed_millis = (get_ts64() - start_time) / 1000000LL;
+
+  lock.lock();
+  partition.sync_in_progress = false;
+  if (error == Error::OK) {
+    if (covering > partition.synced_seqno)
+      partition.synced_seqno = covering;
+    lock_guard<mutex> stats_lock(m_mutex);
+    m_sync_latency = (m_sync_latency + elapsed_millis) / 2;
+  }
+  partition.sync_cond.notify_all();
+
   return error;
 }
 
 
 int
 CommitLog::write(uint64_t cluster_id, DynamicBuffer &buffer, int64_t revision,
-                 Filesystem::Flags flags) {
+                 Filesystem::Flags flags, size_t partition_hint) {
   int error;
   BlockHeaderCommitLog header(MAGIC_DATA, revision, cluster_id);
+  LogPartition &partition = *m_partitions[partition_hint % m_partitions.size()];
 
-  if (m_needs_roll) {
-    lock_guard<mutex> lock(m_mutex);
-    if ((error = roll()) != Error::OK)
+  if (partition.needs_roll) {
+    unique_lock<mutex> lock(partition.mutex);
+    if ((error = roll(partition, lock)) != Error::OK)
       return error;
   }
 
   /**
    * Compress and write the commit block
    */
-  if ((error = compress_and_write(buffer, &header, revision, flags)) != Error::OK)
+  if ((error = compress_and_write(partition, buffer, &header, revision, flags)) != Error::OK)
     return error;
 
   /**
    * Roll the log
    */
-  if (m_cur_fragment_length > m_max_fragment_size) {
-    lock_guard<mutex> lock(m_mutex);
-    if ((error = roll()) != Error::OK)
+  if (partition.cur_fragment_length > m_max_fragment_size) {
+    unique_lock<mutex> lock(partition.mutex);
+    if ((error = roll(partition, lock)) != Error::OK)
+      return error;
+  }
+
+  return Error::OK;
+}
+
+
+size_t CommitLog::header_reserve() {
+  if (boost::istarts_with(m_compressor_spec, "none"))
+    return BlockHeaderCommitLog().encoded_length();
+  return 0;
+}
+
+
+int
+CommitLog::write_framed(uint64_t cluster_id, DynamicBuffer &buffer,
+                        int64_t revision, Filesystem::Flags flags,
+                        size_t partition_hint) {
+  size_t reserve = header_reserve();
+  int error;
+
+  if (reserve == 0)
+    return write(cluster_id, buffer, revision, flags, partition_hint);
+
+  BlockHeaderCommitLog header(MAGIC_DATA, revision, cluster_id);
+  LogPartition &partition = *m_partitions[partition_hint % m_partitions.size()];
+
+  if (partition.needs_roll) {
+    unique_lock<mutex> lock(partition.mutex);
+    if ((error = roll(partition, lock)) != Error::OK)
+      return error;
+  }
+
+  HT_ASSERT(buffer.fill() >= reserve);
+
+  /**
+   * Frame the block header into the reserved space; the appended bytes are
+   * identical to what the copying path produces with the "none" codec
+   */
+  size_t data_length = buffer.fill() - reserve;
+  header.set_compression_type(BlockCompressionCodec::NONE);
+  header.set_data_length(data_length);
+  header.set_data_zlength(data_length);
+  header.set_data_checksum(
+      header.compute_data_checksum(buffer.base + reserve, data_length));
+
+  uint8_t *ptr = buffer.base;
+  header.encode(&ptr);
+  HT_ASSERT(ptr == buffer.base + reserve);
+
+  try {
+    lock_guard<mutex> lock(partition.mutex);
+
+    if (partition.fd == -1)
+      return Error::CLOSED;
+
+    // The caller retains ownership of the buffer; append is synchronous
+    StaticBuffer send_buf(buffer.base, buffer.fill(), false);
+
+    m_fs->append(partition.fd, send_buf, flags);
+    assert(revision != 0);
+    if (revision > partition.latest_revision)
+      partition.latest_revision = revision;
+    partition.cur_fragment_length += buffer.fill();
+    partition.append_seqno++;
+
+    lock_guard<mutex> rev_lock(m_mutex);
+    if (revision > m_latest_revision)
+      m_latest_revision = revision;
+  }
+  catch (Exception &e) {
+    HT_ERRORF("Problem writing commit log: %s: %s",
+              partition.cur_fragment_fname.c_str(), e.what());
+    return e.code();
+  }
+
+  /**
+   * Roll the log
+   */
+  if (partition.cur_fragment_length > m_max_fragment_size) {
+    unique_lock<mutex> lock(partition.mutex);
+    if ((error = roll(partition, lock)) != Error::OK)
       return error;
   }
 
@@ -209,31 +369,43 @@ CommitLog::write(uint64_t cluster_id, DynamicBuffer &buffer, int64_t revision,
 
 
 int CommitLog::link_log(uint64_t cluster_id, CommitLogBase *log_base) {
-  lock_guard<mutex> lock(m_mutex);
   int error;
   int64_t link_revision = log_base->get_latest_revision();
   BlockHeaderCommitLog header(MAGIC_LINK, link_revision, cluster_id);
+  LogPartition &partition = *m_partitions[0];
 
   DynamicBuffer input;
   string &log_dir = log_base->get_log_dir();
 
-  if (m_linked_log_hashes.count(md5_hash(log_dir.c_str())) > 0) {
-    HT_WARNF("Skipping log %s because it is already linked in", log_dir.c_str());
-    return Error::OK;
+  {
+    lock_guard<mutex> lock(m_mutex);
+    if (m_linked_log_hashes.count(md5_hash(log_dir.c_str())) > 0) {
+      HT_WARNF("Skipping log %s because it is already linked in", log_dir.c_str());
+      return Error::OK;
+    }
   }
 
-  if (m_needs_roll) {
-    if ((error = roll()) != Error::OK)
+  unique_lock<mutex> plock(partition.mutex);
+
+  if (partition.needs_roll) {
+    if ((error = roll(partition, plock)) != Error::OK)
       return error;
   }
 
   HT_INFOF("clgc Linking log %s into fragment %d; link_rev=%lld latest_rev=%lld",
-           log_dir.c_str(), m_cur_fragment_num, (Lld)link_revision, (Lld)m_latest_revision);
+           log_dir.c_str(), partition.cur_fragment_num, (Lld)link_revision,
+           (Lld)partition.latest_revision);
 
   HT_ASSERT(link_revision > 0);
 
-  if (link_revision > m_latest_revision)
-    m_latest_revision = link_revision;
+  if (link_revision > partition.latest_revision)
+    partition.latest_revision = link_revision;
+
+  {
+    lock_guard<mutex> lock(m_mutex);
+    if (link_revision > m_latest_revision)
+      m_latest_revision = link_revision;
+  }
 
   input.ensure(header.encoded_length());
 
@@ -241,7 +413,8 @@ int CommitLog::link_log(uint64_t cluster_id, CommitLogBase *log_base) {
   header.set_compression_type(BlockCompressionCodec::NONE);
   header.set_data_length(log_dir.length() + 1);
   header.set_data_zlength(log_dir.length() + 1);
-  header.set_data_checksum(fletcher32(log_dir.c_str(), log_dir.length()+1));
+  header.set_data_checksum(
+      header.compute_data_checksum(log_dir.c_str(), log_dir.length()+1));
 
   header.encode(&input.ptr);
   input.add(log_dir.c_str(), log_dir.length() + 1);
@@ -251,18 +424,21 @@ int CommitLog::link_log(uint64_t cluster_id, CommitLogBase *log_base) {
     StaticBuffer send_buf(input);
     CommitLogFileInfo *file_info = 0;
 
-    if (m_fd == -1)
+    if (partition.fd == -1)
       return Error::CLOSED;
 
-    m_fs->append(m_fd, send_buf);
-    m_cur_fragment_length += amount;
+    m_fs->append(partition.fd, send_buf);
+    partition.cur_fragment_length += amount;
+    partition.append_seqno++;
 
-    if ((error = roll(&file_info)) != Error::OK)
+    if ((error = roll(partition, plock, &file_info)) != Error::OK)
       return error;
 
     file_info->verify();
     file_info->purge_dirs.insert(log_dir);
 
+    lock_guard<mutex> lock(m_mutex);
+
     for (auto fi : log_base->fragment_queue()) {
       if (fi->parent == 0) {
         fi->parent = file_info;
@@ -281,6 +457,7 @@ int CommitLog::link_log(uint64_t cluster_id, CommitLogBase *log_base) {
     return e.code();
   }
 
+  lock_guard<mutex> lock(m_mutex);
   m_linked_log_hashes.insert(md5_hash(log_dir.c_str()));
 
   return Error::OK;
@@ -288,21 +465,32 @@ int CommitLog::link_log(uint64_t cluster_id, CommitLogBase *log_base) {
 
 
 int CommitLog::close() {
-  lock_guard<mutex> lock(m_mutex);
 
-  try {
-    if (m_fd >= 0) {
-      m_fs->close(m_fd);
-      m_fd = -1;
+  for (auto &partition_ptr : m_partitions) {
+    LogPartition &partition = *partition_ptr;
+    unique_lock<mutex> lock(partition.mutex);
+
+    // Let any in-flight sync drain before closing the fragment
+    while (partition.sync_in_progress)
+      partition.sync_cond.wait(lock);
+
+    try {
+      if (partition.fd >= 0) {
+        m_fs->close(partition.fd);
+        partition.fd = -1;
+      }
+    }
+    catch (Hypertable::Exception &e) {
+      HT_ERRORF("Problem closing commit log file '%s' - %s (%s)",
+                partition.cur_fragment_fname.c_str(), e.what(),
+                Error::get_text(e.code()));
+      return e.code();
     }
-  }
-  catch (Hypertable::Exception &e) {
-    HT_ERRORF("Problem closing commit log file '%s' - %s (%s)",
-              m_cur_fragment_fname.c_str(), e.what(),
-              Error::get_text(e.code()));
-    return e.code();
   }
 
+  lock_guard<mutex> lock(m_mutex);
+  m_closed = true;
+
   return Error::OK;
 }
 
@@ -311,7 +499,7 @@ int CommitLog::purge(int64_t revision, StringSet &remove_ok_logs,
                      StringSet &removed_logs, string *trace) {
   lock_guard<mutex> lock(m_mutex);
 
-  if (m_fd == -1)
+  if (m_closed)
     return Error::CLOSED;
 
   if (trace) {
@@ -365,9 +553,23 @@ int CommitLog::purge(int64_t revision, StringSet &remove_ok_logs,
 
 void CommitLog::remove_file_info(CommitLogFileInfo *fi, StringSet &removed_logs) {
   string fname;
+  bool remove_fragment = true;
 
   fi->verify();
 
+  // Tier the fragment to archive storage before removing it
+  if (CommitLogArchiver::instance) {
+    try {
+      CommitLogArchiver::instance->archive_fragment(m_fs, fi);
+    }
+    catch (Exception &e) {
+      HT_ERRORF("Problem archiving log fragment '%s/%u' (%s - %s); "
+                "leaving fragment in place", fi->log_dir.c_str(), fi->num,
+                Error::get_text(e.code()), e.what());
+      remove_fragment = false;
+    }
+  }
+
   // Remove linked log directores
   for (const auto &logdir : fi->purge_dirs) {
     try {
@@ -382,17 +584,19 @@ void CommitLog::remove_file_info(CommitLogFileInfo *fi, StringSet &removed_logs)
   }
 
   // Remove fragment file
-  try {
-    fname = fi->log_dir + "/" + fi->num;
-    HT_INFOF("Removing log fragment '%s' revision=%lld, parent=%lld",
-             fname.c_str(), (Lld)fi->revision, (Lld)fi->parent);
-    m_fs->remove(fname);
-  }
-  catch (Exception &e) {
-    if (e.code() != Error::FSBROKER_BAD_FILENAME &&
-        e.code() != Error::FSBROKER_FILE_NOT_FOUND)
-      HT_ERRORF("Problem removing log fragment '%s' (%s - %s)",
-                fname.c_str(), Error::get_text(e.code()), e.what());
+  if (remove_fragment) {
+    try {
+      fname = fi->log_dir + "/" + fi->num;
+      HT_INFOF("Removing log fragment '%s' revision=%lld, parent=%lld",
+               fname.c_str(), (Lld)fi->revision, (Lld)fi->parent);
+      m_fs->remove(fname);
+    }
+    catch (Exception &e) {
+      if (e.code() != Error::FSBROKER_BAD_FILENAME &&
+          e.code() != Error::FSBROKER_FILE_NOT_FOUND)
+        HT_ERRORF("Problem removing log fragment '%s' (%s - %s)",
+                  fname.c_str(), Error::get_text(e.code()), e.what());
+    }
   }
 
   // Decrement parent reference count
@@ -403,42 +607,51 @@ void CommitLog::remove_file_info(CommitLogFileInfo *fi, StringSet &removed_logs)
 
 }
 
-int CommitLog::roll(CommitLogFileInfo **clfip) {
+int CommitLog::roll(LogPartition &partition, unique_lock<mutex> &lock,
+                    CommitLogFileInfo **clfip) {
   CommitLogFileInfo *file_info;
 
-  if (m_fd == -1)
+  // Let any in-flight sync drain before closing the fragment
+  while (partition.sync_in_progress)
+    partition.sync_cond.wait(lock);
+
+  if (partition.fd == -1)
     return Error::CLOSED;
 
-  if (m_latest_revision == TIMESTAMP_MIN)
+  if (partition.latest_revision == TIMESTAMP_MIN)
     return Error::OK;
 
-  m_needs_roll = true;
+  partition.needs_roll = true;
 
   if (clfip)
     *clfip = 0;
 
-  if (m_fd >= 0) {
-    try {
-      m_fs->close(m_fd);
-    }
-    catch (Exception &e) {
-      HT_ERRORF("Problem closing commit log fragment: %s: %s",
-		m_cur_fragment_fname.c_str(), e.what());
-      return e.code();
-    }
+  try {
+    m_fs->close(partition.fd);
+  }
+  catch (Exception &e) {
+    HT_ERRORF("Problem closing commit log fragment: %s: %s",
+              partition.cur_fragment_fname.c_str(), e.what());
+    return e.code();
+  }
 
-    m_fd = -1;
+  partition.fd = -1;
 
-    file_info = new CommitLogFileInfo();
-    if (clfip)
-      *clfip = file_info;
-    file_info->log_dir = m_log_dir;
-    file_info->log_dir_hash = md5_hash(m_log_dir.c_str());
-    file_info->num = m_cur_fragment_num;
-    file_info->size = m_cur_fragment_length;
-    assert(m_latest_revision != TIMESTAMP_MIN);
-    file_info->revision = m_latest_revision;
+  // Closing the fragment made every outstanding append durable
+  partition.synced_seqno = partition.append_seqno;
 
+  file_info = new CommitLogFileInfo();
+  if (clfip)
+    *clfip = file_info;
+  file_info->log_dir = m_log_dir;
+  file_info->log_dir_hash = md5_hash(m_log_dir.c_str());
+  file_info->num = partition.cur_fragment_num;
+  file_info->size = partition.cur_fragment_length;
+  assert(partition.latest_revision != TIMESTAMP_MIN);
+  file_info->revision = partition.latest_revision;
+
+  {
+    lock_guard<mutex> qlock(m_mutex);
     if (m_fragment_queue.empty() || m_fragment_queue.back()->revision
         < file_info->revision)
       m_fragment_queue.push_back(file_info);
@@ -447,59 +660,84 @@ int CommitLog::roll(CommitLogFileInfo **clfip) {
       struct LtClfip swo;
       sort(m_fragment_queue.begin(), m_fragment_queue.end(), swo);
     }
-
-    m_latest_revision = TIMESTAMP_MIN;
-
-    m_cur_fragment_num++;
-    m_cur_fragment_fname = m_log_dir + "/" + m_cur_fragment_num;
-
   }
 
+  partition.latest_revision = TIMESTAMP_MIN;
+
   try {
-    m_fd = m_fs->create(m_cur_fragment_fname, Filesystem::OPEN_FLAG_OVERWRITE,
-                        -1, m_replication, -1);
-    CommitLogBlockStream::write_header(m_fs, m_fd);
-    m_cur_fragment_length = CommitLogBlockStream::header_size();
+    create_next_fragment(partition);
   }
   catch (Exception &e) {
     HT_ERRORF("Problem rolling commit log: %s: %s",
-              m_cur_fragment_fname.c_str(), e.what());
+              partition.cur_fragment_fname.c_str(), e.what());
     return e.code();
   }
 
-  m_needs_roll = false;
+  // Each fragment starts with a fresh dictionary so it remains
+  // independently decodable
+  if (partition.compressor)
+    partition.compressor->reset();
+
+  partition.needs_roll = false;
 
   return Error::OK;
 }
 
 
 int
-CommitLog::compress_and_write(DynamicBuffer &input, BlockHeader *header,
-                              int64_t revision, Filesystem::Flags flags) {
-  lock_guard<mutex> lock(m_mutex);
+CommitLog::compress_and_write(LogPartition &partition, DynamicBuffer &input,
+                              BlockHeader *header, int64_t revision,
+                              Filesystem::Flags flags) {
   int error = Error::OK;
   DynamicBuffer zblock;
+  unique_ptr<BlockCompressionCodec> compressor;
+
+  if (!m_compressor_streaming) {
+    // Compress outside the lock; concurrent writers compress in parallel
+    // and the lock below orders the resulting appends
+    compressor = acquire_compressor();
+
+    try {
+      compressor->deflate(input, zblock, *header);
+    }
+    catch (Exception &e) {
+      // codec state is suspect after a failed deflate; don't pool it
+      HT_ERRORF("Problem compressing commit log block: %s", e.what());
+      return e.code();
+    }
+
+    release_compressor(std::move(compressor));
+  }
 
-  // Compress block and kick off log write (protected by lock)
+  // Append the compressed block (protected by partition lock)
   try {
+    lock_guard<mutex> lock(partition.mutex);
 
-    if (m_fd == -1)
+    if (partition.fd == -1)
       return Error::CLOSED;
 
-    m_compressor->deflate(input, zblock, *header);
+    // A streaming codec carries its dictionary across blocks, so blocks
+    // must be compressed serially in append order under the partition lock
+    if (m_compressor_streaming)
+      partition.compressor->deflate(input, zblock, *header);
 
     size_t amount = zblock.fill();
     StaticBuffer send_buf(zblock);
 
-    m_fs->append(m_fd, send_buf, flags);
+    m_fs->append(partition.fd, send_buf, flags);
     assert(revision != 0);
+    if (revision > partition.latest_revision)
+      partition.latest_revision = revision;
+    partition.cur_fragment_length += amount;
+    partition.append_seqno++;
+
+    lock_guard<mutex> rev_lock(m_mutex);
     if (revision > m_latest_revision)
       m_latest_revision = revision;
-    m_cur_fragment_length += amount;
   }
   catch (Exception &e) {
     HT_ERRORF("Problem writing commit log: %s: %s",
-              m_cur_fragment_fname.c_str(), e.what());
+              partition.cur_fragment_fname.c_str(), e.what());
     error = e.code();
   }
 
@@ -507,23 +745,50 @@ CommitLog::compress_and_write(DynamicBuffer &input, BlockHeader *header,
 }
 
 
+unique_ptr<BlockCompressionCodec> CommitLog::acquire_compressor() {
+  {
+    lock_guard<mutex> lock(m_compressor_mutex);
+    if (!m_compressor_pool.empty()) {
+      unique_ptr<BlockCompressionCodec> compressor
+        = std::move(m_compressor_pool.top());
+      m_compressor_pool.pop();
+      return compressor;
+    }
+  }
+  return unique_ptr<BlockCompressionCodec>(
+      CompressorFactory::create_block_codec(m_compressor_spec));
+}
+
+
+void CommitLog::release_compressor(unique_ptr<BlockCompressionCodec> compressor) {
+  lock_guard<mutex> lock(m_compressor_mutex);
+  m_compressor_pool.push(std::move(compressor));
+}
+
+
 void CommitLog::load_cumulative_size_map(CumulativeSizeMap &cumulative_size_map) {
-  lock_guard<mutex> lock(m_mutex);
   int64_t cumulative_total = 0;
   uint32_t distance = 0;
   CumulativeFragmentData frag_data;
 
-  if (m_fd == -1)
-    HT_THROWF(Error::CLOSED, "Commit log '%s' has been closed", m_log_dir.c_str());
-
   memset(&frag_data, 0, sizeof(frag_data));
 
-  if (m_latest_revision != TIMESTAMP_MIN) {
-    frag_data.size = m_cur_fragment_length;
-    frag_data.fragno = m_cur_fragment_num;
-    cumulative_size_map[m_latest_revision] = frag_data;
+  // Partition locks are taken before m_mutex to preserve lock order
+  for (auto &partition_ptr : m_partitions) {
+    LogPartition &partition = *partition_ptr;
+    lock_guard<mutex> plock(partition.mutex);
+    if (partition.latest_revision != TIMESTAMP_MIN) {
+      frag_data.size = partition.cur_fragment_length;
+      frag_data.fragno = partition.cur_fragment_num;
+      cumulative_size_map[partition.latest_revision] = frag_data;
+    }
   }
 
+  lock_guard<mutex> lock(m_mutex);
+
+  if (m_closed)
+    HT_THROWF(Error::CLOSED, "Commit log '%s' has been closed", m_log_dir.c_str());
+
   for (std::deque<CommitLogFileInfo *>::reverse_iterator iter
        = m_fragment_queue.rbegin(); iter != m_fragment_queue.rend(); ++iter) {
     frag_data.size = (*iter)->size;
@@ -542,9 +807,20 @@ void CommitLog::load_cumulative_size_map(CumulativeSizeMap &cumulative_size_map)
 
 
 void CommitLog::get_stats(const string &prefix, string &result) {
+  string partition_stats;
+
+  // Partition locks are taken before m_mutex to preserve lock order
+  for (auto &partition_ptr : m_partitions) {
+    LogPartition &partition = *partition_ptr;
+    lock_guard<mutex> plock(partition.mutex);
+    partition_stats += prefix + String("-log-fragment[") + partition.cur_fragment_num + "]\tsize\t" + partition.cur_fragment_length + "\n";
+    partition_stats += prefix + String("-log-fragment]") + partition.cur_fragment_num + "]\trevision\t" + partition.latest_revision + "\n";
+    partition_stats += prefix + String("-log-fragment]") + partition.cur_fragment_num + "]\tdir\t" + m_log_dir + "\n";
+  }
+
   lock_guard<mutex> lock(m_mutex);
 
-  if (m_fd == -1)
+  if (m_closed)
     HT_THROWF(Error::CLOSED, "Commit log '%s' has been closed", m_log_dir.c_str());
 
   try {
@@ -553,9 +829,7 @@ void CommitLog::get_stats(const string &prefix, string &result) {
       result += prefix + String("-log-fragment[") + frag->num + "]\trevision\t" + frag->revision + "\n";
       result += prefix + String("-log-fragment[") + frag->num + "]\tdir\t" + frag->log_dir + "\n";
     }
-    result += prefix + String("-log-fragment[") + m_cur_fragment_num + "]\tsize\t" + m_cur_fragment_length + "\n";
-    result += prefix + String("-log-fragment]") + m_cur_fragment_num + "]\trevision\t" + m_latest_revision + "\n";
-    result += prefix + String("-log-fragment]") + m_cur_fragment_num + "]\tdir\t" + m_log_dir + "\n";
+    result += partition_stats;
   }
   catch (Hypertable::Exception &e) {
     HT_ERROR_OUT << "Problem getting stats for log fragments" << HT_END;
@@ -36,10 +36,12 @@
 #include <Common/Properties.h>
 #include <Common/Filesystem.h>
 
+#include <condition_variable>
 #include <deque>
 #include <map>
 #include <memory>
 #include <stack>
+#include <vector>
 
 namespace Hypertable {
 
@@ -58,6 +60,12 @@ namespace Hypertable {
    *<pre>
    * Hypertable.RangeServer.CommitLog.RollLimit
    *</pre>
+   * The log can be split into multiple partitions (independent fragment
+   * streams in the same directory, each with its own open fragment, lock and
+   * sync state) via the <code>Hypertable.CommitLog.Partitions</code>
+   * property, allowing concurrent writers to append and sync in parallel.
+   * Fragment numbers are allocated from a shared counter, so readers replay
+   * a partitioned log exactly like an unpartitioned one.
    */
 
   class CommitLog : public CommitLogBase {
@@ -113,9 +121,42 @@ namespace Hypertable {
      * @param buffer block of updates to commit
      * @param revision most recent revision in buffer
      * @param flags Flags to pass to underlying append operation
+     * @param partition_hint Hint used to select the log partition the block
+     * is appended to (modulo the partition count); callers that spread
+     * writes across partitions should supply a stable hash of the data
+     * source
      * @return Error::OK on success or error code on failure
      */
-    int write(uint64_t cluster_id, DynamicBuffer &buffer, int64_t revision, Filesystem::Flags flags);
+    int write(uint64_t cluster_id, DynamicBuffer &buffer, int64_t revision,
+              Filesystem::Flags flags, size_t partition_hint = 0);
+
+    /** Returns the number of bytes callers should reserve at the head of
+     * buffers passed to write_framed().  Non-zero only when the log does
+     * not compress blocks, in which case the block header can be framed
+     * directly into the reserved space and the buffer appended without
+     * copying the payload.
+     *
+     * @return Reserve size in bytes (0 when blocks are compressed)
+     */
+    size_t header_reserve();
+
+    /** Writes a block of updates to the commit log, framing the block
+     * header into space the caller reserved at the head of
+     * <code>buffer</code> (see header_reserve()) so the payload is
+     * appended without an intermediate copy.  Falls back to write() when
+     * the log compresses blocks, so callers must reserve exactly
+     * header_reserve() bytes.
+     *
+     * @param cluster_id Originating cluster ID
+     * @param buffer block of updates with header_reserve() leading pad
+     * @param revision most recent revision in buffer
+     * @param flags Flags to pass to underlying append operation
+     * @param partition_hint Hint used to select the log partition
+     * @return Error::OK on success or error code on failure
+     */
+    int write_framed(uint64_t cluster_id, DynamicBuffer &buffer,
+                     int64_t revision, Filesystem::Flags flags,
+                     size_t partition_hint = 0);
 
     /** Flushes previous updates written to commit log.
      *
@@ -123,12 +164,27 @@ namespace Hypertable {
      */
     int flush();
 
-    /** Sync previous updates written to commit log.
+    /** Sync previous updates written to commit log.  Concurrent sync
+     * requests are coalesced:  a single sync call to the filesystem broker
+     * acknowledges every block appended before it was issued, and callers
+     * whose appends are covered by an already completed sync return without
+     * issuing another one.
      *
      * @return Error::OK on success or error code on failure
      */
     int sync();
 
+    /** Returns a running average of recent sync latencies.  The average is
+     * updated by each sync call issued to the filesystem broker and allows
+     * callers to adapt their batching to current storage conditions.
+     *
+     * @return Average sync latency in milliseconds
+     */
+    int64_t sync_latency() {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      return m_sync_latency;
+    }
+
     /** Links an external log into this log.
      *
      * @param cluster_id Originating cluster ID
@@ -192,31 +248,105 @@ namespace Hypertable {
     }
 
     const std::string& get_current_fragment_file() {
-      std::lock_guard<std::mutex>lock(m_mutex);
-      return m_cur_fragment_fname;
+      std::lock_guard<std::mutex>lock(m_partitions[0]->mutex);
+      return m_partitions[0]->cur_fragment_fname;
     }
 
     static const char MAGIC_DATA[10];
     static const char MAGIC_LINK[10];
 
   private:
+
+    /// State for one log partition, an independent fragment stream with its
+    /// own open fragment, lock and sync state
+    struct LogPartition {
+      /// %Mutex protecting partition state
+      std::mutex mutex;
+      /// Signalled when an in-flight sync completes
+      std::condition_variable sync_cond;
+      /// Current fragment file name
+      std::string cur_fragment_fname;
+      /// Amount of data written to current fragment
+      int64_t cur_fragment_length {};
+      /// Current fragment number
+      uint32_t cur_fragment_num {};
+      /// Current fragment file descriptor (-1 = closed)
+      int32_t fd {-1};
+      /// Set to <i>true</i> when the partition needs to be rolled
+      bool needs_roll {};
+      /// Number of blocks successfully appended to this partition
+      uint64_t append_seqno {};
+      /// Append sequence number covered by the last successful sync
+      uint64_t synced_seqno {};
+      /// <i>true</i> if a thread is syncing with #mutex released
+      bool sync_in_progress {};
+      /// Most recent revision appended to the current fragment
+      int64_t latest_revision {TIMESTAMP_MIN};
+      /// Streaming codec carrying a dictionary across blocks within the
+      /// current fragment (only set for streaming compressors; blocks are
+      /// then compressed under #mutex in append order)
+      std::unique_ptr<BlockCompressionCodec> compressor;
+    };
+
     void initialize(const std::string &log_dir,
                     PropertiesPtr &, CommitLogBase *init_log, bool is_meta);
-    int roll(CommitLogFileInfo **clfip=0);
-    int compress_and_write(DynamicBuffer &input, BlockHeader *header,
-                           int64_t revision, Filesystem::Flags flags);
+
+    /** Allocates the next fragment number from the shared counter and
+     * creates the partition's next fragment file.  Throws an Exception on
+     * failure.
+     */
+    void create_next_fragment(LogPartition &partition);
+
+    int roll(LogPartition &partition, std::unique_lock<std::mutex> &lock,
+             CommitLogFileInfo **clfip=0);
+    int compress_and_write(LogPartition &partition, DynamicBuffer &input,
+                           BlockHeader *header, int64_t revision,
+                           Filesystem::Flags flags);
+
+    /** Syncs one partition, coalescing with any in-flight sync on it.
+     * @return Error::OK on success or error code on failure
+     */
+    int sync_partition(LogPartition &partition);
+
     void remove_file_info(CommitLogFileInfo *fi, StringSet &removed_logs);
 
+    /** Checks a compression codec out of #m_compressor_pool, creating a new
+     * one if the pool is empty.  Writers compress outside of #m_mutex so
+     * that block compression from concurrent writers proceeds in parallel
+     * and overlaps in-flight appends and syncs.
+     *
+     * @return compression codec
+     */
+    std::unique_ptr<BlockCompressionCodec> acquire_compressor();
+
+    /** Returns a compression codec to #m_compressor_pool.
+     *
+     * @param compressor codec obtained from acquire_compressor()
+     */
+    void release_compressor(std::unique_ptr<BlockCompressionCodec> compressor);
+
     FilesystemPtr           m_fs;
     std::set<CommitLogFileInfo *> m_reap_set;
-    std::unique_ptr<BlockCompressionCodec> m_compressor;
-    std::string                  m_cur_fragment_fname;
-    int64_t                 m_cur_fragment_length;
+    /// %Mutex for serializing access to #m_compressor_pool
+    std::mutex              m_compressor_mutex;
+    /// Pool of compression codecs checked out by writers
+    std::stack<std::unique_ptr<BlockCompressionCodec>> m_compressor_pool;
+    /// Compressor specification used to create pool codecs
+    std::string             m_compressor_spec;
+    /// <i>true</i> when the compressor carries a dictionary across blocks
+    /// (see BlockCompressionCodecZlibStream); such codecs are per partition
+    /// rather than pooled
+    bool                    m_compressor_streaming {};
+    /// Running average of recent sync latencies (milliseconds)
+    int64_t                 m_sync_latency {};
+    /// Log partitions; writes are routed by partition hint
+    std::vector<std::unique_ptr<LogPartition>> m_partitions;
+    /// Next available fragment number, shared across partitions
+    uint32_t                m_next_fragment_num {};
     int64_t                 m_max_fragment_size;
-    uint32_t                m_cur_fragment_num;
-    int32_t                 m_fd;
     int32_t                 m_replication;
-    bool                    m_needs_roll;
+    /// Set to <i>true</i> by close()
+    bool                    m_closed {};
   };
 
   /// Smart pointer to CommitLog
@@ -0,0 +1,96 @@
+/*
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 3 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/// @file
+/// Definitions for CommitLogArchiver.
+/// This file contains definitions for CommitLogArchiver, a class for
+/// tiering removed commit log fragments to archive storage.
+
+#include <Common/Compat.h>
+
+#include "CommitLogArchiver.h"
+
+#include <Common/Error.h>
+#include <Common/Logger.h>
+#include <Common/StaticBuffer.h>
+#include <Common/StringExt.h>
+
+#include <boost/algorithm/string.hpp>
+
+using namespace Hypertable;
+using namespace std;
+
+CommitLogArchiver *CommitLogArchiver::instance = 0;
+
+namespace {
+  const size_t COPY_BUFFER_SIZE = 4194304;
+}
+
+CommitLogArchiver::CommitLogArchiver(FilesystemPtr fs, const String &root)
+  : m_fs(fs), m_root(root) {
+  boost::trim_right_if(m_root, boost::is_any_of("/"));
+  HT_ASSERT(!m_root.empty());
+}
+
+
+void CommitLogArchiver::archive_fragment(FilesystemPtr &src_fs,
+                                         CommitLogFileInfo *fi) {
+  String src_fname = fi->log_dir + "/" + fi->num;
+  String dst_dir = archive_dir(fi->log_dir);
+  String dst_fname = dst_dir + "/" + fi->num;
+  String tmp_fname = dst_fname + ".tmp";
+  int32_t src_fd = -1;
+  int32_t dst_fd = -1;
+
+  try {
+    m_fs->mkdirs(dst_dir);
+
+    src_fd = src_fs->open(src_fname, 0);
+    dst_fd = m_fs->create(tmp_fname, Filesystem::OPEN_FLAG_OVERWRITE,
+                          -1, -1, -1);
+
+    StaticBuffer buf(COPY_BUFFER_SIZE);
+    size_t nread;
+
+    while ((nread = src_fs->read(src_fd, buf.base, COPY_BUFFER_SIZE)) > 0) {
+      StaticBuffer send_buf(buf.base, (uint32_t)nread, false);
+      m_fs->append(dst_fd, send_buf);
+    }
+
+    src_fs->close(src_fd);
+    src_fd = -1;
+    m_fs->close(dst_fd);
+    dst_fd = -1;
+
+    m_fs->rename(tmp_fname, dst_fname);
+  }
+  catch (Exception &e) {
+    if (src_fd != -1)
+      try { src_fs->close(src_fd); } catch (Exception &) { }
+    if (dst_fd != -1)
+      try { m_fs->close(dst_fd); } catch (Exception &) { }
+    HT_THROW2F(e.code(), e, "Problem archiving log fragment '%s' to '%s'",
+               src_fname.c_str(), dst_fname.c_str());
+  }
+
+  HT_INFOF("Archived log fragment '%s' to '%s'", src_fname.c_str(),
+           dst_fname.c_str());
+}
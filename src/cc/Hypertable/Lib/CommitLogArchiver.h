@@ -0,0 +1,94 @@
+/* -*- c++ -*-
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 3 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/// @file
+/// Declarations for CommitLogArchiver.
+/// This file contains declarations for CommitLogArchiver, a class for
+/// tiering removed commit log fragments to archive storage.
+
+#ifndef Hypertable_Lib_CommitLogArchiver_h
+#define Hypertable_Lib_CommitLogArchiver_h
+
+#include <Hypertable/Lib/CommitLogBase.h>
+
+#include <Common/Filesystem.h>
+#include <Common/String.h>
+
+namespace Hypertable {
+
+  /// @addtogroup libHypertable
+  /// @{
+
+  /// Tiers removed commit log fragments to archive storage.
+  /// When the maintenance logic determines that a commit log fragment is no
+  /// longer needed for recovery it normally just deletes it.  If an archiver
+  /// instance has been installed, CommitLog instead copies each fragment to
+  /// an archive filesystem before removing it, preserving the fragment's
+  /// original pathname underneath a configured archive root.  The archive
+  /// filesystem may be a secondary FS broker fronting cheap storage (for
+  /// example a cold pool), so retaining the log history for point-in-time
+  /// restore does not consume primary storage.  CommitLogReader can be asked
+  /// to read through to the archive, merging archived fragments back into
+  /// the replay stream for deep recovery or restore.
+  class CommitLogArchiver {
+  public:
+
+    /// Constructor.
+    /// @param fs Archive filesystem
+    /// @param root Archive root directory; fragments from log directory
+    /// <i>dir</i> are archived under <i>root</i>+<i>dir</i>
+    CommitLogArchiver(FilesystemPtr fs, const String &root);
+
+    /// Returns the archive directory corresponding to
+    /// <code>log_dir</code>
+    String archive_dir(const String &log_dir) { return m_root + log_dir; }
+
+    /// Copies a fragment file into the archive.
+    /// The fragment is copied from <code>src_fs</code> into the archive
+    /// directory corresponding to its log directory.  The copy is written
+    /// to a <i>.tmp</i> file, which readers skip, and renamed into place
+    /// once complete so the archive never exposes a partial fragment.
+    /// @param src_fs Filesystem holding the live fragment
+    /// @param fi Fragment to archive
+    /// @throws Exception on any filesystem error; the caller is expected
+    /// to leave the live fragment in place in that case
+    void archive_fragment(FilesystemPtr &src_fs, CommitLogFileInfo *fi);
+
+    /// Returns the archive filesystem
+    FilesystemPtr &fs() { return m_fs; }
+
+    /// Installed archiver, or 0 if commit log archival is disabled
+    static CommitLogArchiver *instance;
+
+  private:
+
+    /// Archive filesystem
+    FilesystemPtr m_fs;
+
+    /// Archive root directory (no trailing slash)
+    String m_root;
+  };
+
+  /// @}
+
+}
+
+#endif // Hypertable_Lib_CommitLogArchiver_h
@@ -59,6 +59,8 @@ namespace Hypertable {
     std::string log_dir;
     uint32_t num {};
     uint64_t size {};
+    /// Fragment resides in the commit log archive (see CommitLogArchiver)
+    bool archived {};
     int64_t revision {};
     int64_t log_dir_hash {};
     size_t references {};
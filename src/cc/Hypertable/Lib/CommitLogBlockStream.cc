@@ -46,8 +46,8 @@ using namespace std;
 
 namespace {
   const uint32_t READAHEAD_BUFFER_SIZE = 131072;
-  const uint32_t LatestVersion = 1;
-  const uint32_t BlockHeaderVersions[LatestVersion+1] = { 0, 1 };
+  const uint32_t LatestVersion = 2;
+  const uint32_t BlockHeaderVersions[LatestVersion+1] = { 0, 1, 2 };
 }
 
 bool CommitLogBlockStream::ms_assert_on_error = true;
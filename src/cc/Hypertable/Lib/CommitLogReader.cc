@@ -37,6 +37,7 @@
 
 #include <Hypertable/Lib/BlockCompressionCodec.h>
 #include <Hypertable/Lib/CommitLog.h>
+#include <Hypertable/Lib/CommitLogArchiver.h>
 #include <Hypertable/Lib/CommitLogBlockStream.h>
 #include <Hypertable/Lib/CompressorFactory.h>
 
@@ -70,11 +71,14 @@ namespace {
   };
 }
 
-CommitLogReader::CommitLogReader(FilesystemPtr &fs, const string &log_dir)
+CommitLogReader::CommitLogReader(FilesystemPtr &fs, const string &log_dir,
+                                 bool include_archive)
   : CommitLogBase(log_dir), m_fs(fs), m_block_buffer(256),
-    m_revision(TIMESTAMP_MIN), m_last_fragment_id(-1) {
+    m_revision(TIMESTAMP_MIN), m_last_fragment_id(-1),
+    m_include_archive(include_archive) {
   if (get_bool("Hypertable.CommitLog.SkipErrors"))
     CommitLogBlockStream::ms_assert_on_error = false;
+  m_prefetch_thread_count = get_i32("Hypertable.CommitLog.Reader.ParallelReplay");
   load_fragments(m_log_dir, 0);
   reset();
 }
@@ -87,10 +91,29 @@ CommitLogReader::CommitLogReader(FilesystemPtr &fs, const string &log_dir,
     m_last_fragment_id(-1) {
   if (get_bool("Hypertable.CommitLog.SkipErrors"))
     CommitLogBlockStream::ms_assert_on_error = false;
+  m_prefetch_thread_count = get_i32("Hypertable.CommitLog.Reader.ParallelReplay");
   load_fragments(log_dir, 0);
   reset();
 }
 
+CommitLogReader::~CommitLogReader() {
+  if (m_prefetch_thread_count)
+    stop_prefetch();
+}
+
+void CommitLogReader::reset() {
+  if (m_prefetch_thread_count)
+    stop_prefetch();
+  m_fragment_queue_offset = 0;
+  m_block_buffer.clear();
+  m_revision = TIMESTAMP_MIN;
+  m_latest_revision = TIMESTAMP_MIN;
+  m_error_map.clear();
+  m_prefetch_block_offset = 0;
+  if (m_prefetch_thread_count)
+    schedule_prefetch(0);
+}
+
 bool
 CommitLogReader::next_raw_block(CommitLogBlockInfo *infop,
                                 BlockHeaderCommitLog *header) {
@@ -102,11 +125,17 @@ CommitLogReader::next_raw_block(CommitLogBlockInfo *infop,
     return false;
 
   if ((*fragment_queue_iter)->block_stream == 0) {
+    FilesystemPtr &fs =
+      ((*fragment_queue_iter)->archived && CommitLogArchiver::instance)
+      ? CommitLogArchiver::instance->fs() : m_fs;
     (*fragment_queue_iter)->block_stream =
-      new CommitLogBlockStream(m_fs, (*fragment_queue_iter)->log_dir,
+      new CommitLogBlockStream(fs, (*fragment_queue_iter)->log_dir,
                                format("%u", (*fragment_queue_iter)->num));
     m_last_fragment_fname = (*fragment_queue_iter)->block_stream->get_fname();
     m_last_fragment_id = (int32_t)toplevel_fragment_id(*fragment_queue_iter);
+    // Streaming codecs reset their rolling dictionary at fragment boundaries
+    for (auto &entry : m_compressor_map)
+      entry.second->reset();
   }
 
   if (!(*fragment_queue_iter)->block_stream->next(infop, header)) {
@@ -160,6 +189,9 @@ CommitLogReader::next(const uint8_t **blockp, size_t *lenp,
                       BlockHeaderCommitLog *header) {
   CommitLogBlockInfo binfo;
 
+  if (m_prefetch_thread_count)
+    return next_prefetched(blockp, lenp, header);
+
   while (next_raw_block(&binfo, header)) {
 
     if (binfo.error == Error::OK) {
@@ -209,10 +241,238 @@ CommitLogReader::next(const uint8_t **blockp, size_t *lenp,
 }
 
 
+bool
+CommitLogReader::next_prefetched(const uint8_t **blockp, size_t *lenp,
+                                 BlockHeaderCommitLog *header) {
+
+  while (m_fragment_queue_offset < m_fragment_queue.size()) {
+    CommitLogFileInfo *fi = m_fragment_queue[m_fragment_queue_offset];
+    PrefetchedFragment *frag;
+
+    {
+      unique_lock<mutex> lock(m_prefetch_mutex);
+      auto iter = m_prefetched.find(fi);
+      while (iter == m_prefetched.end() || !iter->second->ready) {
+        m_prefetch_cond.wait(lock);
+        iter = m_prefetched.find(fi);
+      }
+      frag = iter->second;
+    }
+
+    if (m_prefetch_block_offset == 0) {
+      m_last_fragment_fname = frag->fname;
+      m_last_fragment_id = (int32_t)toplevel_fragment_id(fi);
+    }
+
+    if (m_prefetch_block_offset >= frag->blocks.size()) {
+      {
+        lock_guard<mutex> lock(m_prefetch_mutex);
+        m_prefetched.erase(fi);
+      }
+      m_prefetch_cond.notify_all();
+      delete frag;
+      m_prefetch_block_offset = 0;
+
+      if (m_revision == TIMESTAMP_MIN) {
+        if (m_verbose)
+          HT_INFOF("Skipping log fragment '%s/%u' because unable to read any "
+                   " valid blocks", fi->log_dir.c_str(), fi->num);
+        m_fragment_queue.erase(m_fragment_queue.begin() + m_fragment_queue_offset);
+      }
+      else {
+        fi->revision = m_revision;
+        m_fragment_queue_offset++;
+      }
+      m_revision = TIMESTAMP_MIN;
+      continue;
+    }
+
+    PrefetchedBlock *block = frag->blocks[m_prefetch_block_offset++];
+    *header = block->header;
+
+    if (block->error == Error::OK &&
+        header->check_magic(CommitLog::MAGIC_LINK)) {
+      assert(header->get_compression_type() == BlockCompressionCodec::NONE);
+      string log_dir = (const char *)(block->data.base + header->encoded_length());
+      boost::trim_right_if(log_dir, boost::is_any_of("/"));
+      m_linked_log_hashes.insert(md5_hash(log_dir.c_str()));
+      m_linked_logs.insert(log_dir);
+      size_t prior_size = m_fragment_queue.size();
+      load_fragments(log_dir, fi);
+      schedule_prefetch(prior_size);
+      if (header->get_revision() > m_latest_revision)
+        m_latest_revision = header->get_revision();
+      if (header->get_revision() > m_revision)
+        m_revision = header->get_revision();
+      continue;
+    }
+
+    if (block->error != Error::OK) {
+      HT_WARNF("Corruption or inflate error detected in CommitLog fragment "
+               "%s starting at postion %lld for %lld bytes - %s",
+               frag->fname.c_str(), (Lld)block->start_offset,
+               (Lld)(block->end_offset - block->start_offset),
+               Error::get_text(block->error));
+      continue;
+    }
+
+    if (m_verbose)
+      HT_INFOF("Replaying commit log fragment %s/%u", fi->log_dir.c_str(),
+               fi->num);
+
+    if (header->get_revision() > m_latest_revision)
+      m_latest_revision = header->get_revision();
+
+    if (header->get_revision() > m_revision)
+      m_revision = header->get_revision();
+
+    *blockp = block->data.base;
+    *lenp = block->data.fill();
+    return true;
+  }
+
+  struct LtClfip swo;
+  sort(m_fragment_queue.begin(), m_fragment_queue.end(), swo);
+
+  return false;
+}
+
+
+void CommitLogReader::schedule_prefetch(size_t offset) {
+  {
+    lock_guard<mutex> lock(m_prefetch_mutex);
+    for (size_t i = offset; i < m_fragment_queue.size(); i++)
+      m_prefetch_work.push_back(m_fragment_queue[i]);
+  }
+  m_prefetch_cond.notify_all();
+  while ((int32_t)m_prefetch_threads.size() < m_prefetch_thread_count)
+    m_prefetch_threads.push_back(thread(&CommitLogReader::prefetch_worker, this));
+}
+
+
+void CommitLogReader::prefetch_worker() {
+  CompressorMap compressor_map;
+  uint16_t compressor_type {};
+  BlockCompressionCodecPtr compressor;
+
+  while (true) {
+    CommitLogFileInfo *fi;
+    PrefetchedFragment *frag;
+
+    {
+      unique_lock<mutex> lock(m_prefetch_mutex);
+      // Bound read-ahead to a small window of unconsumed fragments so a
+      // large log set doesn't get buffered in memory all at once
+      m_prefetch_cond.wait(lock, [this]() {
+          return m_prefetch_shutdown ||
+            (!m_prefetch_work.empty() &&
+             m_prefetched.size() < (size_t)(2 * m_prefetch_thread_count));
+        });
+      if (m_prefetch_shutdown)
+        return;
+      fi = m_prefetch_work.front();
+      m_prefetch_work.pop_front();
+      frag = new PrefetchedFragment();
+      m_prefetched[fi] = frag;
+    }
+
+    vector<PrefetchedBlock *> blocks;
+
+    try {
+      FilesystemPtr &fs = (fi->archived && CommitLogArchiver::instance)
+        ? CommitLogArchiver::instance->fs() : m_fs;
+      CommitLogBlockStream stream(fs, fi->log_dir, format("%u", fi->num));
+      CommitLogBlockInfo binfo;
+      BlockHeaderCommitLog header;
+
+      frag->fname = stream.get_fname();
+
+      // Streaming codecs reset their rolling dictionary at fragment
+      // boundaries; each fragment is inflated wholly by one worker
+      for (auto &entry : compressor_map)
+        entry.second->reset();
+
+      while (stream.next(&binfo, &header)) {
+        PrefetchedBlock *block = new PrefetchedBlock();
+        block->header = header;
+        block->start_offset = binfo.start_offset;
+        block->end_offset = binfo.end_offset;
+
+        if (binfo.error == Error::OK &&
+            !header.check_magic(CommitLog::MAGIC_LINK)) {
+          DynamicBuffer zblock(0, false);
+          zblock.base = binfo.block_ptr;
+          zblock.ptr = binfo.block_ptr + binfo.block_len;
+          try {
+            uint16_t ztype = header.get_compression_type();
+            if (ztype >= BlockCompressionCodec::COMPRESSION_TYPE_LIMIT)
+              HT_THROWF(Error::BLOCK_COMPRESSOR_UNSUPPORTED_TYPE,
+                        "Invalid compression type '%d'", (int)ztype);
+            if (!compressor || ztype != compressor_type) {
+              compressor = compressor_map[ztype];
+              if (!compressor) {
+                compressor.reset(CompressorFactory::create_block_codec(
+                    (BlockCompressionCodec::Type)ztype));
+                compressor_map[ztype] = compressor;
+              }
+              compressor_type = ztype;
+            }
+            compressor->inflate(zblock, block->data, header);
+          }
+          catch (Exception &e) {
+            block->error = e.code();
+            block->data.clear();
+            block->data.add(binfo.block_ptr, binfo.block_len);
+          }
+        }
+        else {
+          // link blocks and corrupt blocks carry the raw block so the
+          // consumer can process them in replay order
+          block->error = binfo.error;
+          block->data.add(binfo.block_ptr, binfo.block_len);
+        }
+        blocks.push_back(block);
+      }
+    }
+    catch (Exception &e) {
+      HT_ERRORF("Problem prefetching commit log fragment %s/%u - %s",
+                fi->log_dir.c_str(), fi->num, Error::get_text(e.code()));
+    }
+
+    {
+      lock_guard<mutex> lock(m_prefetch_mutex);
+      frag->blocks.swap(blocks);
+      frag->ready = true;
+    }
+    m_prefetch_cond.notify_all();
+  }
+}
+
+
+void CommitLogReader::stop_prefetch() {
+  {
+    lock_guard<mutex> lock(m_prefetch_mutex);
+    m_prefetch_shutdown = true;
+  }
+  m_prefetch_cond.notify_all();
+  for (auto &worker : m_prefetch_threads)
+    worker.join();
+  m_prefetch_threads.clear();
+  m_prefetch_shutdown = false;
+  m_prefetch_work.clear();
+  for (auto &entry : m_prefetched)
+    delete entry.second;
+  m_prefetched.clear();
+}
+
+
 void CommitLogReader::load_fragments(String log_dir, CommitLogFileInfo *parent) {
   vector<Filesystem::Dirent> listing;
   CommitLogFileInfo *fi;
   int mark = -1;
+  size_t initial_size = m_fragment_queue.size();
+  std::set<int32_t> live_fragments;
+  bool archive_readthrough = m_include_archive && CommitLogArchiver::instance;
 
 #if 0
   HT_DEBUG_OUT << "Reading fragments in " << log_dir 
@@ -228,12 +488,17 @@ void CommitLogReader::load_fragments(String log_dir, CommitLogFileInfo *parent)
       if (m_verbose)
         HT_INFOF("Skipping directory '%s' because it does not exist",
                  log_dir.c_str());
-      return;
+      // The live directory may have been removed after all of its
+      // fragments were tiered to the archive
+      if (!archive_readthrough)
+        return;
+      listing.clear();
     }
-    HT_THROW2(e.code(), e, e.what());
+    else
+      HT_THROW2(e.code(), e, e.what());
   }
 
-  if (listing.size() == 0)
+  if (listing.size() == 0 && !archive_readthrough)
     return;
 
   sort(listing.begin(), listing.end(), ByFragmentNumber());
@@ -267,6 +532,7 @@ void CommitLogReader::load_fragments(String log_dir, CommitLogFileInfo *parent)
                listing[i].name.c_str(), log_dir.c_str());
     }
     else {
+      live_fragments.insert(num);
       fi = new CommitLogFileInfo();
       fi->num = (uint32_t)num;
       fi->log_dir = log_dir;
@@ -285,6 +551,16 @@ void CommitLogReader::load_fragments(String log_dir, CommitLogFileInfo *parent)
     }
   }
 
+  if (archive_readthrough) {
+    load_archived_fragments(log_dir, parent, live_fragments);
+    // Keep this directory's fragments in fragment number order after the
+    // merge; archived fragments are older than any still-live fragment
+    sort(m_fragment_queue.begin() + initial_size, m_fragment_queue.end(),
+         [](CommitLogFileInfo *x, CommitLogFileInfo *y) {
+           return x->num < y->num;
+         });
+  }
+
   if (mark != -1) {
     if (m_fragment_queue.empty() || mark < (int)m_fragment_queue.front()->num) {
       string mark_filename;
@@ -313,6 +589,65 @@ void CommitLogReader::load_fragments(String log_dir, CommitLogFileInfo *parent)
 
 }
 
+void CommitLogReader::load_archived_fragments(const String &log_dir,
+    CommitLogFileInfo *parent, const std::set<int32_t> &live_fragments) {
+  String archive_dir = CommitLogArchiver::instance->archive_dir(log_dir);
+  FilesystemPtr &archive_fs = CommitLogArchiver::instance->fs();
+  vector<Filesystem::Dirent> listing;
+  CommitLogFileInfo *fi;
+
+  try {
+    archive_fs->readdir(archive_dir, listing);
+  }
+  catch (Hypertable::Exception &e) {
+    if (e.code() == Error::FSBROKER_BAD_FILENAME ||
+        e.code() == Error::FSBROKER_FILE_NOT_FOUND)
+      return;
+    HT_THROW2(e.code(), e, e.what());
+  }
+
+  sort(listing.begin(), listing.end(), ByFragmentNumber());
+
+  for (size_t i = 0; i < listing.size(); i++) {
+    if (boost::ends_with(listing[i].name, ".tmp"))
+      continue;
+
+    char *endptr;
+    int32_t num = (int32_t)strtol(listing[i].name.c_str(), &endptr, 10);
+    if (*endptr != 0) {
+      HT_WARNF("Invalid file '%s' found in commit log archive directory '%s'",
+               listing[i].name.c_str(), archive_dir.c_str());
+      continue;
+    }
+
+    // A fragment still present in the live log directory shadows its
+    // archived copy
+    if (live_fragments.count(num))
+      continue;
+
+    if (m_verbose)
+      HT_INFOF("Merging archived log fragment %s/%d into replay stream",
+               archive_dir.c_str(), num);
+
+    fi = new CommitLogFileInfo();
+    fi->num = (uint32_t)num;
+    fi->log_dir = archive_dir;
+    fi->log_dir_hash = md5_hash(archive_dir.c_str());
+    fi->archived = true;
+    fi->size = archive_fs->length(archive_dir + "/" + listing[i].name);
+    fi->parent = parent;
+    if (fi->size > CommitLogBlockStream::header_size()) {
+      if (parent)
+        parent->references++;
+      m_fragment_queue.push_back(fi);
+    }
+    else {
+      delete fi;
+      fi = 0;
+    }
+  }
+}
+
 void CommitLogReader::load_compressor(uint16_t ztype) {
 
   if (m_compressor && ztype == m_compressor_type)
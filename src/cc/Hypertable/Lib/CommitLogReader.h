@@ -38,8 +38,13 @@
 
 #include <boost/thread/mutex.hpp>
 
+#include <condition_variable>
+#include <deque>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <stack>
+#include <thread>
 #include <unordered_map>
 #include <vector>
 
@@ -52,12 +57,21 @@ namespace Hypertable {
   class CommitLogReader : public CommitLogBase {
 
   public:
-    CommitLogReader(FilesystemPtr &fs, const std::string &log_dir);
+
+    /// Constructor.
+    /// @param fs Filesystem holding the log
+    /// @param log_dir Log directory
+    /// @param include_archive If <i>true</i> and a CommitLogArchiver has
+    /// been installed, fragments previously tiered to the commit log
+    /// archive are merged back into the replay stream in fragment order;
+    /// used for deep recovery and point-in-time restore
+    CommitLogReader(FilesystemPtr &fs, const std::string &log_dir,
+                    bool include_archive = false);
 
     CommitLogReader(FilesystemPtr &fs, const std::string &log_dir,
                     const std::vector<int32_t> &fragment_filter);
 
-    virtual ~CommitLogReader() { }
+    virtual ~CommitLogReader();
 
     void get_init_fragment_ids(std::vector<uint32_t> &ids);
 
@@ -66,13 +80,7 @@ namespace Hypertable {
     bool next(const uint8_t **blockp, size_t *lenp,
               BlockHeaderCommitLog *);
 
-    void reset() {
-      m_fragment_queue_offset = 0;
-      m_block_buffer.clear();
-      m_revision = TIMESTAMP_MIN;
-      m_latest_revision = TIMESTAMP_MIN;
-      m_error_map.clear();
-    }
+    void reset();
 
     void get_linked_logs(StringSet &linked_logs) {
       linked_logs.insert(m_linked_logs.begin(), m_linked_logs.end());
@@ -86,9 +94,69 @@ namespace Hypertable {
 
   private:
 
+    /// Block read ahead and inflated by a prefetch worker.  For link
+    /// blocks and blocks that failed verification or inflation, #data
+    /// holds the raw block so the consumer can process it.
+    struct PrefetchedBlock {
+      /// Block header
+      BlockHeaderCommitLog header;
+      /// Inflated block data (raw block for link/error blocks)
+      DynamicBuffer data;
+      /// Error encountered reading or inflating the block
+      int error {};
+      /// Starting fragment file offset of block
+      uint64_t start_offset {};
+      /// Ending fragment file offset of block
+      uint64_t end_offset {};
+    };
+
+    /// Fragment contents produced by a prefetch worker
+    struct PrefetchedFragment {
+      /// Blocks in fragment file order
+      std::vector<PrefetchedBlock *> blocks;
+      /// Fragment file name
+      std::string fname;
+      /// Set to <i>true</i> once the worker has read the whole fragment
+      bool ready {};
+
+      ~PrefetchedFragment() {
+        for (auto block : blocks)
+          delete block;
+      }
+    };
+
     void load_fragments(String log_dir, CommitLogFileInfo *parent);
+
+    /** Merges archived fragments of <code>log_dir</code> into
+     * #m_fragment_queue.  Fragments whose numbers appear in
+     * <code>live_fragments</code> still exist in the live log directory
+     * and are skipped.
+     */
+    void load_archived_fragments(const String &log_dir,
+                                 CommitLogFileInfo *parent,
+                                 const std::set<int32_t> &live_fragments);
+
     void load_compressor(uint16_t ztype);
 
+    /** Prefetched-mode implementation of next().  Consumes blocks that the
+     * prefetch workers have read and inflated ahead of time, preserving
+     * the fragment order and revision accounting of the sequential path.
+     */
+    bool next_prefetched(const uint8_t **blockp, size_t *lenp,
+                         BlockHeaderCommitLog *header);
+
+    /** Queues fragments starting at <code>offset</code> in
+     * #m_fragment_queue for prefetching, starting worker threads if
+     * necessary.
+     */
+    void schedule_prefetch(size_t offset);
+
+    /// Prefetch worker loop; reads and inflates one fragment at a time
+    void prefetch_worker();
+
+    /// Stops prefetch workers and discards unconsumed prefetched fragments
+    void stop_prefetch();
+
     FilesystemPtr     m_fs;
     uint64_t          m_fragment_queue_offset {};
     DynamicBuffer     m_block_buffer;
@@ -106,6 +174,25 @@ namespace Hypertable {
     std::string                 m_last_fragment_fname;
     int32_t                m_last_fragment_id {};
     bool                   m_verbose {};
+    /// Merge archived fragments into the replay stream
+    bool                   m_include_archive {};
+
+    /// Number of prefetch worker threads (0 = sequential replay)
+    int32_t                m_prefetch_thread_count {};
+    /// %Mutex protecting prefetch state
+    std::mutex             m_prefetch_mutex;
+    /// Signalled when work is queued or a fragment becomes ready
+    std::condition_variable m_prefetch_cond;
+    /// Fragments awaiting prefetch, in replay order
+    std::deque<CommitLogFileInfo *> m_prefetch_work;
+    /// Fragments being or already prefetched
+    std::map<CommitLogFileInfo *, PrefetchedFragment *> m_prefetched;
+    /// Prefetch worker threads
+    std::vector<std::thread> m_prefetch_threads;
+    /// Consumer index into the current fragment's prefetched blocks
+    size_t                 m_prefetch_block_offset {};
+    /// Set to <i>true</i> to shut down prefetch workers
+    bool                   m_prefetch_shutdown {};
   };
 
   /// Smart pointer to CommitLogReader
@@ -28,9 +28,11 @@
 #include <Hypertable/Lib/BlockCompressionCodecBmz.h>
 #include <Hypertable/Lib/BlockCompressionCodecNone.h>
 #include <Hypertable/Lib/BlockCompressionCodecZlib.h>
+#include <Hypertable/Lib/BlockCompressionCodecZlibStream.h>
 #include <Hypertable/Lib/BlockCompressionCodecLzo.h>
 #include <Hypertable/Lib/BlockCompressionCodecQuicklz.h>
 #include <Hypertable/Lib/BlockCompressionCodecSnappy.h>
+#include <Hypertable/Lib/BlockCompressionCodecZstd.h>
 
 #include <boost/algorithm/string.hpp>
 
@@ -59,6 +61,9 @@ CompressorFactory::parse_block_codec_spec(const std::string &spec,
   if (name == "zlib")
     return BlockCompressionCodec::ZLIB;
 
+  if (name == "zlibstream")
+    return BlockCompressionCodec::ZLIBSTREAM;
+
   if (name == "lzo")
     return BlockCompressionCodec::LZO;
 
@@ -68,6 +73,9 @@ CompressorFactory::parse_block_codec_spec(const std::string &spec,
   if (name == "snappy")
     return BlockCompressionCodec::SNAPPY;
 
+  if (name == "zstd")
+    return BlockCompressionCodec::ZSTD;
+
   HT_ERRORF("unknown codec type: %s", name.c_str());
   return BlockCompressionCodec::UNKNOWN;
 }
@@ -82,12 +90,16 @@ CompressorFactory::create_block_codec(BlockCompressionCodec::Type type,
     return new BlockCompressionCodecNone(args);
   case BlockCompressionCodec::ZLIB:
     return new BlockCompressionCodecZlib(args);
+  case BlockCompressionCodec::ZLIBSTREAM:
+    return new BlockCompressionCodecZlibStream(args);
   case BlockCompressionCodec::LZO:
     return new BlockCompressionCodecLzo(args);
   case BlockCompressionCodec::QUICKLZ:
     return new BlockCompressionCodecQuicklz(args);
   case BlockCompressionCodec::SNAPPY:
     return new BlockCompressionCodecSnappy(args);
+  case BlockCompressionCodec::ZSTD:
+    return new BlockCompressionCodecZstd(args);
   default:
     HT_THROWF(Error::BLOCK_COMPRESSOR_UNSUPPORTED_TYPE, "Invalid compression "
               "type: '%d'", (int)type);
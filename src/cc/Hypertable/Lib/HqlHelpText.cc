@@ -384,6 +384,7 @@ namespace {
     "    bloom_filter_spec:",
     "      rows [ bloom_filter_options ]",
     "      | rows+cols [ bloom_filter_options ]",
+    "      | rows+cols+prefix [ bloom_filter_options ]",
     "      | none ",
     "",
     "    bloom_filter_options:",
@@ -391,6 +392,7 @@ namespace {
     "      --bits-per-item float",
     "      --num-hashes int",
     "      --max-approx-items int",
+    "      --prefix-length int",
     "",
     "Description",
     "-----------",
@@ -554,6 +556,7 @@ namespace {
     "    bloom_filter_spec:",
     "      rows [ bloom_filter_options ]",
     "      | rows+cols [ bloom_filter_options ]",
+    "      | rows+cols+prefix [ bloom_filter_options ]",
     "      | none ",
     "",
     "    bloom_filter_options:",
@@ -561,6 +564,7 @@ namespace {
     "      --bits-per-item float",
     "      --num-hashes int",
     "      --max-approx-items int",
+    "      --prefix-length int",
     "",
     "    table_option:",
     "      access_group_option",
@@ -811,11 +815,15 @@ namespace {
     "The bloom filter specification can take one of the following forms.  The rows",
     "form, which is the default, causes only row keys to be inserted into the bloom",
     "filter.  The rows+cols form causes the row key concatenated with the column",
-    "family to be inserted into the bloom filter.  none disables the bloom",
+    "family to be inserted into the bloom filter.  The rows+cols+prefix form",
+    "additionally inserts the row key concatenated with the column family and the",
+    "leading bytes of the column qualifier, allowing qualified point lookups with",
+    "time-bucketed qualifiers to skip cell stores.  none disables the bloom",
     "filter.",
     "",
     "  * rows [ bloom_filter_options ]",
     "  * rows+cols [ bloom_filter_options ]",
+    "  * rows+cols+prefix [ bloom_filter_options ]",
     "  * none",
     "",
     "The following describes the bloom filter options:",
@@ -838,6 +846,10 @@ namespace {
     "  --max-approx-items arg  Number of cell store items used to guess the number",
     "                          of actual bloom filter entries (default = 1000)",
     "",
+    "  --prefix-length arg     Number of leading column qualifier bytes inserted",
+    "                          into each rows+cols+prefix bloom filter entry",
+    "                          (default = 16)",
+    "",
     "Compressors",
     "-----------",
     "",
@@ -240,6 +240,7 @@ cmd_select(NamespacePtr &ns, ConnectionManagerPtr &conn_manager,
   char fs = state.field_separator ? state.field_separator : '\t';
 
   table = ns->open_table(state.table_name);
+  state.scan.builder.optimize_row_regexp();
   TableScannerPtr scanner( table->create_scanner(state.scan.builder.get(), 0, true) );
 
   // whether it's select into file
@@ -959,6 +960,120 @@ HqlInterpreter::HqlInterpreter(Client *client, ConnectionManagerPtr &conn_manage
 
 }
 
+HqlInterpreter::PreparedStatement::PreparedStatement(HqlInterpreter *interp,
+    const string &hql) : m_interp(interp) {
+  string stripped_hql = hql;
+
+  boost::trim(stripped_hql);
+
+  m_state = std::make_shared<ParserState>(interp->m_namespace);
+  Hql::Parser parser(*m_state);
+  parse_info<> info = parse(stripped_hql.c_str(), parser, space_p);
+
+  if (!info.full)
+    HT_THROW(Error::HQL_PARSE_ERROR, String("parse error at: ") + info.stop
+             + " (" + stripped_hql + ")");
+
+  if (m_state->command != COMMAND_INSERT)
+    HT_THROW(Error::HQL_BAD_COMMAND,
+             "Only INSERT statements can be prepared");
+
+  if (!interp->m_namespace)
+    HT_THROW(Error::BAD_NAMESPACE, "Null namespace");
+
+  m_table = interp->m_namespace->open_table(m_state->table_name);
+
+  // Locate the '?' placeholders; parameters are numbered in the order
+  // they appear within the statement
+  const Cells &cells = m_state->inserts.get();
+  for (size_t i = 0; i < cells.size(); i++) {
+    if (cells[i].row_key && !strcmp(cells[i].row_key, "?"))
+      m_params.push_back({i, ROW});
+    if (cells[i].column_qualifier && !strcmp(cells[i].column_qualifier, "?"))
+      m_params.push_back({i, QUALIFIER});
+    if (cells[i].value_len == 1 && *cells[i].value == (uint8_t)'?')
+      m_params.push_back({i, VALUE});
+  }
+  m_bindings.resize(m_params.size());
+  m_bound.resize(m_params.size(), false);
+}
+
+HqlInterpreter::PreparedStatement::~PreparedStatement() {
+}
+
+void HqlInterpreter::PreparedStatement::set_parameter(size_t index,
+                                                      const string &value) {
+  if (index >= m_params.size())
+    HT_THROWF(Error::INVALID_ARGUMENT,
+              "Parameter index %d out of range (statement has %d parameters)",
+              (int)index, (int)m_params.size());
+  m_bindings[index] = value;
+  m_bound[index] = true;
+}
+
+int HqlInterpreter::PreparedStatement::execute(Callback &cb) {
+  for (size_t i = 0; i < m_params.size(); i++) {
+    if (!m_bound[i])
+      HT_THROWF(Error::INVALID_ARGUMENT, "Parameter %d is not bound", (int)i);
+  }
+
+  // The parsed cells act as a template; only the bound fields change
+  Cells cells = m_state->inserts.get();
+  for (size_t i = 0; i < m_params.size(); i++) {
+    Cell &cell = cells[m_params[i].cell];
+    switch (m_params[i].field) {
+    case ROW:
+      cell.row_key = m_bindings[i].c_str();
+      break;
+    case QUALIFIER:
+      cell.column_qualifier = m_bindings[i].c_str();
+      break;
+    case VALUE:
+      cell.value = (const ::uint8_t *)m_bindings[i].data();
+      cell.value_len = m_bindings[i].length();
+      break;
+    }
+  }
+
+  TableMutatorPtr mutator( m_table->create_mutator() );
+
+  try {
+    mutator->set_cells(cells);
+  }
+  catch (Exception &e) {
+    do {
+      mutator->show_failed(e);
+    } while (!mutator->retry());
+
+    if (mutator->get_last_error())
+      HT_THROW(mutator->get_last_error(),
+              Error::get_text(mutator->get_last_error()));
+  }
+  if (cb.normal_mode) {
+    cb.total_cells = cells.size();
+
+    for (const auto &cell : cells) {
+      cb.total_keys_size += cell.column_qualifier
+          ? (strlen(cell.column_qualifier) + 1) : 0;
+      cb.total_values_size += cell.value_len;
+    }
+  }
+
+  // flush the mutator
+  cb.on_finish(mutator);
+
+  // report errors during mutator->flush
+  if (mutator->get_last_error())
+    HT_THROW(mutator->get_last_error(),
+            Error::get_text(mutator->get_last_error()));
+  return 0;
+}
+
+HqlInterpreter::PreparedStatementPtr
+HqlInterpreter::prepare(const string &str) {
+  return PreparedStatementPtr(new PreparedStatement(this, str));
+}
+
 void HqlInterpreter::set_namespace(const string &ns) {
   if (m_namespace && m_immutable_namespace)
     HT_THROW(Error::BAD_NAMESPACE, (String)"Attempting to modify immutable namespace " +
@@ -118,6 +118,56 @@ namespace Hypertable {
       void on_dump(TableDumper &dumper) override { copy(dumper, cells); }
     };
 
+    /** An INSERT statement that is parsed once and re-executed with new
+     * parameter bindings.  Any row key, column qualifier or value given
+     * as the literal string '?' becomes a positional parameter, numbered
+     * from 0 in the order the placeholders appear in the statement.
+     * Re-execution skips the Spirit parser entirely, which dominates the
+     * cost of small repeated inserts.
+     */
+    class PreparedStatement {
+    public:
+      ~PreparedStatement();
+
+      /** Number of '?' placeholders found at prepare time */
+      size_t parameter_count() const { return m_params.size(); }
+
+      /** Binds the <code>index</code>th placeholder.  Bindings persist
+       * across executions until overwritten.
+       */
+      void set_parameter(size_t index, const std::string &value);
+
+      /** Executes the statement with the current bindings */
+      int execute(Callback &cb);
+
+      /** Convenience method that flushes and discards results */
+      int execute() {
+        Callback cb;
+        return execute(cb);
+      }
+
+    private:
+      friend class HqlInterpreter;
+
+      enum Field { ROW, QUALIFIER, VALUE };
+      struct Parameter {
+        size_t cell;
+        Field field;
+      };
+
+      PreparedStatement(HqlInterpreter *interp, const std::string &hql);
+
+      HqlInterpreter *m_interp;
+      std::shared_ptr<Hql::ParserState> m_state;
+      TablePtr m_table;
+      std::vector<Parameter> m_params;
+      std::vector<std::string> m_bindings;
+      std::vector<bool> m_bound;
+    };
+
+    /// Smart pointer to PreparedStatement
+    typedef std::shared_ptr<PreparedStatement> PreparedStatementPtr;
+
     /** Construct from hypertable client */
     HqlInterpreter(Client *client, ConnectionManagerPtr &conn_mgr,
                    bool immutable_namespace=true);
@@ -138,6 +188,11 @@ namespace Hypertable {
       return execute(cmd, cb, res);
     }
 
+    /** Parses <code>str</code> into a re-executable statement.  Only
+     * INSERT statements can be prepared.
+     */
+    PreparedStatementPtr prepare(const std::string &str);
+
     void set_namespace(const std::string &ns);
 
   private:
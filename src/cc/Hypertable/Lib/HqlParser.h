@@ -118,6 +118,7 @@ namespace Hypertable {
       COMMAND_SET,
       COMMAND_REBUILD_INDICES,
       COMMAND_STATUS,
+      COMMAND_LIVESTATE,
       COMMAND_MAX
     };
 
@@ -308,6 +309,12 @@ namespace Hypertable {
       std::string header_file;
       int header_file_src {};
       ::uint32_t group_commit_interval {};
+      bool deferred_log_sync {};
+      ::uint32_t query_cache_ttl {};
+      bool query_cache_disabled {};
+      ::int64_t query_cache_max_entry_size {};
+      ::int64_t split_size {};
+      bool split_size_adaptive {};
       ColumnFamilyOptions table_cf_defaults;
       AccessGroupOptions table_ag_defaults;
       std::vector<String> columns;
@@ -729,6 +736,12 @@ namespace Hypertable {
         else if (state.input_file.empty()) {
 
           state.create_schema->set_group_commit_interval(state.group_commit_interval);
+          state.create_schema->set_deferred_log_sync(state.deferred_log_sync);
+          state.create_schema->set_query_cache_ttl(state.query_cache_ttl);
+          state.create_schema->set_query_cache_disabled(state.query_cache_disabled);
+          state.create_schema->set_query_cache_max_entry_size(state.query_cache_max_entry_size);
+          state.create_schema->set_split_size(state.split_size);
+          state.create_schema->set_split_size_adaptive(state.split_size_adaptive);
           state.create_schema->set_access_group_defaults(state.table_ag_defaults);
           state.create_schema->set_column_family_defaults(state.table_cf_defaults);
 
@@ -1020,6 +1033,28 @@ namespace Hypertable {
       ParserState &state;
     };
 
+    struct set_value_dictionary {
+      set_value_dictionary(ParserState &state) : state(state) { }
+      void operator()(char const *str, char const *end) const {
+        string value(str, end-str);
+        bool bval {};
+        if (!strcasecmp(value.c_str(), "value_dictionary") ||
+            !strcasecmp(value.c_str(), "true"))
+          bval = true;
+        if (state.cf_spec) {
+          state.check_and_set_column_option(state.cf_spec->get_name(), "VALUE_DICTIONARY");
+          state.cf_spec->set_option_value_dictionary(bval);
+        }
+        else if (state.ag_spec) {
+          state.check_and_set_access_group_option(state.ag_spec->get_name(), "VALUE_DICTIONARY");
+          state.ag_spec->set_default_value_dictionary(bval);
+        }
+        else
+          state.table_cf_defaults.set_value_dictionary(bval);
+      }
+      ParserState &state;
+    };
+
     struct set_max_versions {
       set_max_versions(ParserState &state) : state(state) { }
       void operator()(char const *str, char const *end) const {
@@ -1414,6 +1449,61 @@ namespace Hypertable {
       ParserState &state;
     };
 
+    struct set_deferred_log_sync {
+      set_deferred_log_sync(ParserState &state) : state(state) { }
+      void operator()(char const *, char const *) const {
+        state.deferred_log_sync = true;
+      }
+      ParserState &state;
+    };
+
+    struct set_query_cache_ttl {
+      set_query_cache_ttl(ParserState &state) : state(state) { }
+      void operator()(size_t ttl) const {
+        if (state.query_cache_ttl != 0)
+          HT_THROW(Error::HQL_PARSE_ERROR, "QUERY_CACHE_TTL multiply defined");
+        state.query_cache_ttl = (::uint32_t)ttl;
+      }
+      ParserState &state;
+    };
+
+    struct set_query_cache_disabled {
+      set_query_cache_disabled(ParserState &state) : state(state) { }
+      void operator()(char const *, char const *) const {
+        state.query_cache_disabled = true;
+      }
+      ParserState &state;
+    };
+
+    struct set_query_cache_max_entry_size {
+      set_query_cache_max_entry_size(ParserState &state) : state(state) { }
+      void operator()(size_t size) const {
+        if (state.query_cache_max_entry_size != 0)
+          HT_THROW(Error::HQL_PARSE_ERROR,
+                   "QUERY_CACHE_MAX_ENTRY_SIZE multiply defined");
+        state.query_cache_max_entry_size = (::int64_t)size;
+      }
+      ParserState &state;
+    };
+
+    struct set_split_size {
+      set_split_size(ParserState &state) : state(state) { }
+      void operator()(::uint64_t size) const {
+        if (state.split_size != 0)
+          HT_THROW(Error::HQL_PARSE_ERROR, "SPLIT_SIZE multiply defined");
+        state.split_size = (::int64_t)size;
+      }
+      ParserState &state;
+    };
+
+    struct set_split_size_adaptive {
+      set_split_size_adaptive(ParserState &state) : state(state) { }
+      void operator()(char const *, char const *) const {
+        state.split_size_adaptive = true;
+      }
+      ParserState &state;
+    };
+
     struct set_help {
       set_help(ParserState &state) : state(state) { }
       void operator()(char const *str, char const *end) const {
@@ -2509,6 +2599,7 @@ namespace Hypertable {
           Token TTL          = as_lower_d["ttl"];
           Token TYPE         = as_lower_d["type"];
           Token COUNTER      = as_lower_d["counter"];
+          Token VALUE_DICTIONARY = as_lower_d["value_dictionary"];
           Token MONTHS       = as_lower_d["months"];
           Token MONTH        = as_lower_d["month"];
           Token WEEKS        = as_lower_d["weeks"];
@@ -2578,6 +2669,12 @@ namespace Hypertable {
           Token VALUES       = as_lower_d["values"];
           Token COMPRESSOR   = as_lower_d["compressor"];
           Token GROUP_COMMIT_INTERVAL   = as_lower_d["group_commit_interval"];
+          Token DEFERRED_LOG_SYNC       = as_lower_d["deferred_log_sync"];
+          Token QUERY_CACHE_TTL         = as_lower_d["query_cache_ttl"];
+          Token QUERY_CACHE_DISABLED    = as_lower_d["query_cache_disabled"];
+          Token QUERY_CACHE_MAX_ENTRY_SIZE = as_lower_d["query_cache_max_entry_size"];
+          Token SPLIT_SIZE              = as_lower_d["split_size"];
+          Token SPLIT_SIZE_ADAPTIVE     = as_lower_d["split_size_adaptive"];
           Token DUMP         = as_lower_d["dump"];
           Token PSEUDO       = as_lower_d["pseudo"];
           Token STATS        = as_lower_d["stats"];
@@ -2641,6 +2738,7 @@ namespace Hypertable {
           Token REBUILD      = as_lower_d["rebuild"];
           Token INDICES      = as_lower_d["indices"];
           Token STATUS       = as_lower_d["status"];
+          Token LIVESTATE    = as_lower_d["livestate"];
 
           /**
            * Start grammar definition
@@ -2723,6 +2821,7 @@ namespace Hypertable {
             | shutdown_statement[set_command(self.state, COMMAND_SHUTDOWN)]
             | shutdown_master_statement[set_command(self.state, COMMAND_SHUTDOWN_MASTER)]
             | status_statement[set_command(self.state, COMMAND_STATUS)]
+            | livestate_statement[set_command(self.state, COMMAND_LIVESTATE)]
             | drop_range_statement[set_command(self.state, COMMAND_DROP_RANGE)]
             | replay_start_statement[set_command(self.state,
                 COMMAND_REPLAY_BEGIN)]
@@ -2853,6 +2952,10 @@ namespace Hypertable {
             = STATUS
             ;
 
+          livestate_statement
+            = LIVESTATE
+            ;
+
           fetch_scanblock_statement
             = FETCH >> SCANBLOCK >> !(lexeme_d[(+digit_p)[
                 set_scanner_id(self.state)]])
@@ -3032,6 +3135,15 @@ namespace Hypertable {
 
           table_option
             = GROUP_COMMIT_INTERVAL >> *EQUAL >> uint_p[set_group_commit_interval(self.state)]
+            | DEFERRED_LOG_SYNC[set_deferred_log_sync(self.state)]
+            | QUERY_CACHE_TTL >> *EQUAL >> uint_p[set_query_cache_ttl(self.state)]
+            | QUERY_CACHE_DISABLED[set_query_cache_disabled(self.state)]
+            | QUERY_CACHE_MAX_ENTRY_SIZE >> *EQUAL
+              >> uint_p[set_query_cache_max_entry_size(self.state)]
+            | SPLIT_SIZE_ADAPTIVE[set_split_size_adaptive(self.state)]
+            | SPLIT_SIZE >> *EQUAL
+              >> uint_parser<::uint64_t, 10, 1, -1>()[
+                  set_split_size(self.state)]
             | access_group_option
             | column_option
             ;
@@ -3093,6 +3205,7 @@ namespace Hypertable {
             | time_order_option
             | ttl_option
             | counter_option
+            | value_dictionary_option
             ;
 
           max_versions_option
@@ -3114,6 +3227,12 @@ namespace Hypertable {
             | COUNTER[set_counter(self.state)]
             ;
 
+          value_dictionary_option
+            = VALUE_DICTIONARY
+              >> boolean_literal[set_value_dictionary(self.state)]
+            | VALUE_DICTIONARY[set_value_dictionary(self.state)]
+            ;
+
           duration
             = ureal_p >> !(MONTHS | MONTH | WEEKS | WEEK | DAYS | DAY | HOURS |
                 HOUR | MINUTES | MINUTE | SECONDS | SECOND)
@@ -3433,6 +3552,7 @@ namespace Hypertable {
           BOOST_SPIRIT_DEBUG_RULE(regexp_literal);
           BOOST_SPIRIT_DEBUG_RULE(ttl_option);
           BOOST_SPIRIT_DEBUG_RULE(counter_option);
+          BOOST_SPIRIT_DEBUG_RULE(value_dictionary_option);
           BOOST_SPIRIT_DEBUG_RULE(access_group_definition);
           BOOST_SPIRIT_DEBUG_RULE(index_definition);
           BOOST_SPIRIT_DEBUG_RULE(access_group_option);
@@ -3490,6 +3610,7 @@ namespace Hypertable {
           BOOST_SPIRIT_DEBUG_RULE(shutdown_statement);
           BOOST_SPIRIT_DEBUG_RULE(shutdown_master_statement);
           BOOST_SPIRIT_DEBUG_RULE(status_statement);
+          BOOST_SPIRIT_DEBUG_RULE(livestate_statement);
           BOOST_SPIRIT_DEBUG_RULE(drop_range_statement);
           BOOST_SPIRIT_DEBUG_RULE(replay_start_statement);
           BOOST_SPIRIT_DEBUG_RULE(replay_log_statement);
@@ -3530,7 +3651,8 @@ namespace Hypertable {
           drop_namespace_statement, identifier, user_identifier, 
           max_versions_option, time_order_option, statement,
           single_string_literal, double_string_literal, string_literal, 
-          parameter_list, regexp_literal, ttl_option, counter_option, 
+          parameter_list, regexp_literal, ttl_option, counter_option,
+          value_dictionary_option,
           access_group_definition, index_definition, access_group_option,
           bloom_filter_option, in_memory_option,
           blocksize_option, replication_option, help_statement,
@@ -3559,7 +3681,8 @@ namespace Hypertable {
           metadata_sync_statement, metadata_sync_option_spec, stop_statement,
           range_type, table_identifier, pseudo_table_reference,
           dump_pseudo_table_statement, set_statement, set_variable_spec,
-          rebuild_indices_statement, index_type_spec, status_statement;
+          rebuild_indices_statement, index_type_spec, status_statement,
+          livestate_statement;
       };
 
       ParserState &state;
@@ -689,8 +689,14 @@ void IntervalScannerAsync::restart_scan(bool refresh) {
     m_create_event_saved = false;
     m_create_event = 0;
 
-    if (m_last_key.row)
+    if (m_last_key.row) {
       m_create_scanner_row = m_last_key.row;
+      // Pass the last delivered key as a resume cursor so the server picks
+      // up exactly where the interrupted scan left off instead of
+      // re-delivering the cells of the restart row
+      m_scan_spec_builder.set_resume_cursor(m_last_key_buf.base,
+                                            m_last_key.length);
+    }
 
     m_state = 0;
     find_range_and_start_scan(m_create_scanner_row.c_str(), true);
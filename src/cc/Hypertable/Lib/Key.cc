@@ -38,24 +38,24 @@ namespace {
             uint8_t column_family_code, const char *column_qualifier, uint32_t column_qualifier_len) {
     uint8_t *ptr = buf;
     *ptr++ = control;
-    strcpy((char *)ptr, row);
-    ptr += row_len + 1;
+    memcpy(ptr, row, row_len);
+    ptr += row_len;
+    *ptr++ = 0;
     *ptr++ = column_family_code;
-    if (column_qualifier) {
-      strcpy((char *)ptr, column_qualifier);
-      ptr += column_qualifier_len + 1;
+    if (column_qualifier_len) {
+      memcpy(ptr, column_qualifier, column_qualifier_len);
+      ptr += column_qualifier_len;
     }
-    else
-      *ptr++ = 0;
+    *ptr++ = 0;
     *ptr++ = flag;
     return ptr-buf;
   }
 
   void
-  create_key_and_append(DynamicBuffer &dst_buf, uint8_t flag, const char *row,
+  do_create_key_and_append(DynamicBuffer &dst_buf, uint8_t flag, const char *row,
       uint32_t row_len, uint8_t column_family_code, const char *column_qualifier,
       uint32_t column_qualifier_len, int64_t timestamp, int64_t revision,
-      bool time_order_asc) {
+      bool time_order_asc, size_t value_space = 0) {
     size_t len = 1 + row_len + 4 + column_qualifier_len;
     uint8_t control = 0;
 
@@ -77,8 +77,8 @@ namespace {
       control |= Key::HAVE_REVISION;
     }
 
-    if (dst_buf.remaining() < len + 6)
-      dst_buf.grow(dst_buf.fill() + len + 6);
+    if (dst_buf.remaining() < len + 6 + value_space)
+      dst_buf.grow(dst_buf.fill() + len + 6 + value_space);
     Serialization::encode_vi32(&dst_buf.ptr, len);
     dst_buf.ptr += write_key(dst_buf.ptr, control, flag, row, row_len,
                              column_family_code, column_qualifier, column_qualifier_len);
@@ -103,7 +103,7 @@ namespace Hypertable {
 
   void
   create_key_and_append(DynamicBuffer &dst_buf, const Key& key, bool time_order_asc) {
-    ::create_key_and_append(
+    do_create_key_and_append(
       dst_buf,
       key.flag,
       key.row,
@@ -120,7 +120,7 @@ namespace Hypertable {
   create_key_and_append(DynamicBuffer &dst_buf, uint8_t flag, const char *row,
       uint8_t column_family_code, const char *column_qualifier,
       int64_t timestamp, int64_t revision, bool time_order_asc) {
-    ::create_key_and_append(
+    do_create_key_and_append(
       dst_buf,
       flag,
       row,
@@ -133,6 +133,48 @@ namespace Hypertable {
       time_order_asc);
   }
 
+  void
+  create_key_and_append(DynamicBuffer &dst_buf, uint8_t flag, const char *row,
+      uint32_t row_len, uint8_t column_family_code,
+      const char *column_qualifier, uint32_t column_qualifier_len,
+      int64_t timestamp, int64_t revision, bool time_order_asc) {
+    do_create_key_and_append(
+      dst_buf,
+      flag,
+      row,
+      row_len,
+      column_family_code,
+      column_qualifier,
+      column_qualifier_len,
+      timestamp,
+      revision,
+      time_order_asc);
+  }
+
+  void
+  create_key_value_and_append(DynamicBuffer &dst_buf, const Key &key,
+      const void *value, uint32_t value_len, bool time_order_asc) {
+    do_create_key_and_append(
+      dst_buf,
+      key.flag,
+      key.row,
+      key.row_len,
+      key.column_family_code,
+      key.column_qualifier,
+      key.column_qualifier_len,
+      key.timestamp,
+      AUTO_ASSIGN,//key.revision,
+      time_order_asc,
+      value_len + 7);
+    Serialization::encode_vi32(&dst_buf.ptr, value_len);
+    if (value_len > 0) {
+      memcpy(dst_buf.ptr, value, value_len);
+      dst_buf.ptr += value_len;
+      *dst_buf.ptr = 0;
+    }
+    assert(dst_buf.fill() <= dst_buf.size);
+  }
+
   void create_key_and_append(DynamicBuffer &dst_buf, const char *row, bool time_order_asc) {
     uint8_t control = Key::HAVE_REVISION
         | Key::HAVE_TIMESTAMP | Key::REV_IS_TS;
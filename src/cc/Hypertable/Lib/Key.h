@@ -165,9 +165,35 @@ namespace Hypertable {
                              int64_t revision = AUTO_ASSIGN,
                              bool time_order_asc = true);
 
+  /**
+   * Length-carrying variant of create_key_and_append.  Callers that already
+   * know the row and qualifier lengths (e.g. from a KeySpec) avoid the
+   * strlen calls made by the variant above.
+   */
+  void create_key_and_append(DynamicBuffer &dst_buf, uint8_t flag,
+                             const char *row, uint32_t row_len,
+                             uint8_t column_family_code,
+                             const char *column_qualifier,
+                             uint32_t column_qualifier_len,
+                             int64_t timestamp = AUTO_ASSIGN,
+                             int64_t revision = AUTO_ASSIGN,
+                             bool time_order_asc = true);
+
   void create_key_and_append(DynamicBuffer &dst_buf, const Key& key,
                              bool time_order_asc = true);
 
+  /**
+   * Appends a serialized key followed by its byte string value with a single
+   * buffer reservation, writing both in one pass.  Equivalent to
+   * create_key_and_append(dst_buf, key) followed by
+   * append_as_byte_string(dst_buf, value, value_len), but amortizes the
+   * buffer capacity check across the key/value pair, which matters on the
+   * per-cell mutator send path.
+   */
+  void create_key_value_and_append(DynamicBuffer &dst_buf, const Key &key,
+                                   const void *value, uint32_t value_len,
+                                   bool time_order_asc = true);
+
 } // namespace Hypertable
 
 #endif // HYPERTABLE_KEY_H
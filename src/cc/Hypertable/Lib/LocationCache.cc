@@ -23,10 +23,15 @@
 
 #include "LocationCache.h"
 
+#include <Common/DynamicBuffer.h>
+#include <Common/FileUtils.h>
 #include <Common/InetAddr.h>
+#include <Common/Logger.h>
+#include <Common/Serialization.h>
 
 #include <cassert>
 #include <cstring>
+#include <ctime>
 #include <fstream>
 #include <iostream>
 
@@ -278,6 +283,120 @@ void LocationCache::remove(Value *cacheval) {
 }
 
 
+namespace {
+  const uint32_t SNAPSHOT_MAGIC = 0x48544c43;  // 'HTLC'
+  const uint16_t SNAPSHOT_VERSION = 1;
+  enum { ADDR_TYPE_PROXY = 0, ADDR_TYPE_INET = 1 };
+}
+
+size_t LocationCache::load_snapshot(const String &fname, uint64_t epoch,
+                                    time_t max_age) {
+  off_t len;
+  char *data;
+  size_t count = 0;
+
+  if (!FileUtils::exists(fname))
+    return 0;
+
+  if ((data = FileUtils::file_to_buffer(fname, &len)) == 0)
+    return 0;
+
+  try {
+    const uint8_t *ptr = (const uint8_t *)data;
+    size_t remain = (size_t)len;
+
+    if (Serialization::decode_i32(&ptr, &remain) != SNAPSHOT_MAGIC ||
+        Serialization::decode_i16(&ptr, &remain) != SNAPSHOT_VERSION)
+      HT_THROW(Error::BAD_FORMAT, "bad magic or version");
+
+    if (Serialization::decode_i64(&ptr, &remain) != epoch)
+      HT_THROW(Error::BAD_FORMAT, "cluster epoch mismatch");
+
+    int64_t save_time = (int64_t)Serialization::decode_i64(&ptr, &remain);
+    if ((int64_t)time(0) - save_time > (int64_t)max_age)
+      HT_THROW(Error::BAD_FORMAT, "snapshot too old");
+
+    size_t entries = Serialization::decode_i32(&ptr, &remain);
+
+    for (size_t i=0; i<entries; i++) {
+      RangeLocationInfo range_loc_info;
+      const char *table_name = Serialization::decode_vstr(&ptr, &remain);
+      range_loc_info.start_row = Serialization::decode_vstr(&ptr, &remain);
+      range_loc_info.end_row = Serialization::decode_vstr(&ptr, &remain);
+      uint8_t addr_type = Serialization::decode_i8(&ptr, &remain);
+      if (addr_type == ADDR_TYPE_PROXY)
+        range_loc_info.addr.set_proxy(Serialization::decode_vstr(&ptr, &remain));
+      else {
+        InetAddr iaddr;
+        memset(&iaddr, 0, sizeof(iaddr));
+        iaddr.sin_family = AF_INET;
+        iaddr.sin_addr.s_addr = Serialization::decode_i32(&ptr, &remain);
+        iaddr.sin_port = Serialization::decode_i16(&ptr, &remain);
+        range_loc_info.addr.set_inet(iaddr);
+      }
+      insert(table_name, range_loc_info);
+      count++;
+    }
+  }
+  catch (Exception &e) {
+    HT_WARNF("Discarding location cache snapshot %s - %s (%s)",
+             fname.c_str(), Error::get_text(e.code()), e.what());
+    count = 0;
+  }
+
+  delete [] data;
+  return count;
+}
+
+size_t LocationCache::save_snapshot(const String &fname, uint64_t epoch) {
+  lock_guard<mutex> lock(m_mutex);
+  DynamicBuffer dbuf(65536);
+  size_t count = m_location_map.size();
+
+  dbuf.ensure(26);
+  Serialization::encode_i32(&dbuf.ptr, SNAPSHOT_MAGIC);
+  Serialization::encode_i16(&dbuf.ptr, SNAPSHOT_VERSION);
+  Serialization::encode_i64(&dbuf.ptr, epoch);
+  Serialization::encode_i64(&dbuf.ptr, (uint64_t)time(0));
+  Serialization::encode_i32(&dbuf.ptr, count);
+
+  for (LocationMap::iterator iter = m_location_map.begin();
+       iter != m_location_map.end(); ++iter) {
+    Value *val = (*iter).second;
+    const CommAddress *addrp = val->addrp;
+    size_t len = Serialization::encoded_length_vstr((*iter).first.table_name)
+      + Serialization::encoded_length_vstr(val->start_row)
+      + Serialization::encoded_length_vstr(val->end_row) + 1;
+    if (addrp->is_proxy())
+      len += Serialization::encoded_length_vstr(addrp->proxy);
+    else
+      len += 6;
+    dbuf.ensure(len);
+    Serialization::encode_vstr(&dbuf.ptr, (*iter).first.table_name);
+    Serialization::encode_vstr(&dbuf.ptr, val->start_row);
+    Serialization::encode_vstr(&dbuf.ptr, val->end_row);
+    if (addrp->is_proxy()) {
+      Serialization::encode_i8(&dbuf.ptr, ADDR_TYPE_PROXY);
+      Serialization::encode_vstr(&dbuf.ptr, addrp->proxy);
+    }
+    else {
+      Serialization::encode_i8(&dbuf.ptr, ADDR_TYPE_INET);
+      Serialization::encode_i32(&dbuf.ptr, addrp->inet.sin_addr.s_addr);
+      Serialization::encode_i16(&dbuf.ptr, addrp->inet.sin_port);
+    }
+  }
+
+  String tmp_fname = fname + ".tmp";
+  if (FileUtils::write(tmp_fname,
+                       std::string((char *)dbuf.base, dbuf.fill())) < 0)
+    return 0;
+  if (!FileUtils::rename(tmp_fname, fname))
+    return 0;
+
+  return count;
+}
+
+
 const CommAddress *LocationCache::get_constant_address(const CommAddress &addr) {
   AddressSet::iterator iter = m_addresses.find(&addr);
 
@@ -111,6 +111,31 @@ namespace Hypertable {
 
     void display(std::ostream &);
 
+    /**
+     * Loads cache entries from a snapshot file previously written with
+     * save_snapshot().  The snapshot is rejected (and 0 returned) if the
+     * file is missing or corrupt, was written for a different cluster
+     * (epoch mismatch), or is older than <code>max_age</code> seconds.
+     * Entries loaded from a snapshot are location hints like any others;
+     * stale ones get invalidated and re-fetched on first use.
+     *
+     * @param fname pathname of snapshot file
+     * @param epoch cluster epoch (cluster ID) the snapshot must match
+     * @param max_age maximum snapshot age in seconds
+     * @return number of entries loaded
+     */
+    size_t load_snapshot(const String &fname, uint64_t epoch, time_t max_age);
+
+    /**
+     * Writes all cache entries to a snapshot file.  The snapshot is
+     * written to a temporary file and atomically renamed into place.
+     *
+     * @param fname pathname of snapshot file
+     * @param epoch cluster epoch (cluster ID) to record in the snapshot
+     * @return number of entries written
+     */
+    size_t save_snapshot(const String &fname, uint64_t epoch);
+
   private:
     bool lookup(const char *table_name, const char *rowkey,
                 Value*& cacheval, bool inclusive);
@@ -41,6 +41,7 @@
 #include "Request/Parameters/DropTable.h"
 #include "Request/Parameters/FetchResult.h"
 #include "Request/Parameters/MoveRange.h"
+#include "Request/Parameters/NamespaceListing.h"
 #include "Request/Parameters/PhantomCommitComplete.h"
 #include "Request/Parameters/PhantomPrepareComplete.h"
 #include "Request/Parameters/RecreateIndexTables.h"
@@ -48,8 +49,10 @@
 #include "Request/Parameters/RenameTable.h"
 #include "Request/Parameters/ReplayComplete.h"
 #include "Request/Parameters/ReplayStatus.h"
+#include "Request/Parameters/ReportSuspect.h"
 #include "Request/Parameters/SetState.h"
 #include "Request/Parameters/Stop.h"
+#include "Response/Parameters/NamespaceListing.h"
 #include "Response/Parameters/Status.h"
 #include "Response/Parameters/SystemStatus.h"
 
@@ -557,6 +560,44 @@ Master::Client::drop_table(const String &name, bool if_exists, Timer *timer) {
 
 }
 
+void
+Master::Client::namespace_listing(const String &name, bool include_schemas,
+    std::vector<Response::Parameters::NamespaceListing::Entry> &listing,
+    Timer *timer) {
+  Timer tmp_timer(m_timeout_ms);
+  EventPtr event;
+  String label = format("namespace_listing('%s', include_schemas=%s)",
+                        name.c_str(), include_schemas ? "true" : "false");
+
+  initialize(timer, tmp_timer);
+
+  while (!timer->expired()) {
+
+    {
+      CommHeader header(Protocol::COMMAND_NAMESPACE_LISTING);
+      Request::Parameters::NamespaceListing params(name, include_schemas);
+      CommBufPtr cbuf( new CommBuf(header, params.encoded_length()) );
+      params.encode(cbuf->get_data_ptr_address());
+      if (!send_message(cbuf, timer, event, label))
+        continue;
+    }
+    const uint8_t *ptr = event->payload + 4;
+    size_t remain = event->payload_len - 4;
+    Response::Parameters::NamespaceListing params;
+    params.decode(&ptr, &remain);
+    listing.swap(params.entries());
+    return;
+  }
+
+  {
+    lock_guard<mutex> lock(m_mutex);
+    HT_THROWF(Error::REQUEST_TIMEOUT,
+              "Client operation %s to master %s failed", label.c_str(),
+              m_master_addr.format().c_str());
+  }
+
+}
+
 void Master::Client::recreate_index_tables(const std::string &name,
                                    TableParts parts, Timer *timer) {
   Timer tmp_timer(m_timeout_ms);
@@ -866,6 +907,37 @@ Master::Client::replay_status(int64_t op_id, const String &location,
 }
 
 
+void
+Master::Client::report_suspect(const String &location, const String &reporter) {
+  Timer timer(m_timeout_ms, true);
+  EventPtr event;
+  String label = format("report_suspect location=%s reporter=%s",
+                        location.c_str(), reporter.c_str());
+
+  while (!timer.expired()) {
+
+    {
+      CommHeader header(Protocol::COMMAND_REPORT_SUSPECT);
+      Request::Parameters::ReportSuspect params(location, reporter);
+      CommBufPtr cbuf( new CommBuf(header, params.encoded_length()) );
+      params.encode(cbuf->get_data_ptr_address());
+      if (!send_message(cbuf, &timer, event, label)) {
+        this_thread::sleep_for(chrono::milliseconds(std::min(timer.remaining(), Random::number32(3000))));
+        continue;
+      }
+    }
+    return;
+  }
+
+  {
+    lock_guard<mutex> lock(m_mutex);
+    HT_THROWF(Error::REQUEST_TIMEOUT,
+        "Client operation %s to master %s failed", label.c_str(),
+        m_master_addr.format().c_str());
+  }
+}
+
+
 void
 Master::Client::replay_complete(int64_t op_id, const String &location,
                         int32_t plan_generation, int32_t error,
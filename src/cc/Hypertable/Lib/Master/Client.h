@@ -28,6 +28,7 @@
 #define Hypertable_Lib_Master_Client_h
 
 #include <Hypertable/Lib/BalancePlan.h>
+#include <Hypertable/Lib/Master/Response/Parameters/NamespaceListing.h>
 #include <Hypertable/Lib/RangeSpec.h>
 #include <Hypertable/Lib/SystemVariable.h>
 #include <Hypertable/Lib/TableIdentifier.h>
@@ -122,6 +123,20 @@ namespace Master {
 
     void drop_table(const String &name, bool if_exists, Timer *timer=0);
 
+    /// Carries out a <i>namespace listing</i> %Master operation.
+    /// Fetches the name, ID and (optionally) schema generation and binary
+    /// schema of every table and sub-namespace beneath <code>name</code> in a
+    /// single round trip.
+    /// @param name Namespace pathname
+    /// @param include_schemas Include binary schemas of listed tables
+    /// @param listing Filled in with listing entries
+    /// @param timer Deadline timer
+    /// @throws Exception with code set to Error::REQUEST_TIMEOUT if deadline
+    /// is reached before operation completes.
+    void namespace_listing(const String &name, bool include_schemas,
+                           std::vector<Response::Parameters::NamespaceListing::Entry> &listing,
+                           Timer *timer=0);
+
     /// Carries out a <i>recreate index tables</i> %Master operation.
     /// @param name Name of table for which to recreate index tables
     /// @param parts Specifies which index tables to recreate
@@ -151,6 +166,16 @@ namespace Master {
     void replay_status(int64_t op_id, const String &location,
                        int32_t plan_generation);
 
+    /** Reports a suspected %RangeServer failure.
+     * Used by the gossip-based liveness detector to report a peer that has
+     * stopped answering liveness probes.  The master aggregates reports from
+     * independent reporters and begins speculative recovery preparation once
+     * a quorum concurs.
+     * @param location Proxy name of suspected server
+     * @param reporter Proxy name of reporting server
+     */
+    void report_suspect(const String &location, const String &reporter);
+
     void replay_complete(int64_t op_id, const String &location,
                          int32_t plan_generation, int32_t error, const String message);
 
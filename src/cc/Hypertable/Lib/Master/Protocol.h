@@ -61,6 +61,8 @@ namespace Master {
       COMMAND_SET_STATE,
       COMMAND_RECREATE_INDEX_TABLES,
       COMMAND_SYSTEM_STATUS,
+      COMMAND_REPORT_SUSPECT,
+      COMMAND_NAMESPACE_LISTING,
       COMMAND_MAX
     };
   };
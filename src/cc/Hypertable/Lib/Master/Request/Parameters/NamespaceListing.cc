@@ -0,0 +1,80 @@
+/*
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/// @file
+/// Definitions for NamespaceListing request parameters.
+/// This file contains definitions for NamespaceListing, a class for encoding
+/// and decoding paramters to the <i>namespace listing</i> %Master operation.
+
+#include <Common/Compat.h>
+
+#include "NamespaceListing.h"
+
+#include <Hypertable/Lib/Canonicalize.h>
+
+#include <Common/Logger.h>
+#include <Common/Serialization.h>
+
+using namespace Hypertable;
+using namespace Hypertable::Lib::Master::Request::Parameters;
+
+NamespaceListing::NamespaceListing(const std::string &name,
+                                   bool include_schemas)
+  : m_name(name), m_include_schemas(include_schemas) {
+  Canonicalize::namespace_path(m_name);
+}
+
+
+uint8_t NamespaceListing::encoding_version() const {
+  return 1;
+}
+
+size_t NamespaceListing::encoded_length_internal() const {
+  return 1 + Serialization::encoded_length_vstr(m_name);
+}
+
+/// @details
+/// Encoding is as follows:
+/// <table>
+/// <tr>
+/// <th>Encoding</th>
+/// <th>Description</th>
+/// </tr>
+/// <tr>
+/// <td>vstr</td>
+/// <td>Pathname of namespace to list</td>
+/// </tr>
+/// <tr>
+/// <td>bool</td>
+/// <td>Include binary table schemas in the listing</td>
+/// </tr>
+/// </table>
+void NamespaceListing::encode_internal(uint8_t **bufp) const {
+  Serialization::encode_vstr(bufp, m_name);
+  Serialization::encode_bool(bufp, m_include_schemas);
+}
+
+void NamespaceListing::decode_internal(uint8_t version, const uint8_t **bufp,
+			     size_t *remainp) {
+  m_name.clear();
+  m_name.append(Serialization::decode_vstr(bufp, remainp));
+  m_include_schemas = Serialization::decode_bool(bufp, remainp);
+}
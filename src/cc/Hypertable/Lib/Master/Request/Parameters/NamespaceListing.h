@@ -0,0 +1,104 @@
+/* -*- c++ -*-
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/// @file
+/// Declarations for NamespaceListing request parameters.
+/// This file contains declarations for NamespaceListing, a class for encoding
+/// and decoding paramters to the <i>namespace listing</i> %Master operation.
+
+#ifndef Hypertable_Lib_Master_Request_Parameters_NamespaceListing_h
+#define Hypertable_Lib_Master_Request_Parameters_NamespaceListing_h
+
+#include <Common/Serializable.h>
+
+#include <string>
+
+using namespace std;
+
+namespace Hypertable {
+namespace Lib {
+namespace Master {
+namespace Request {
+namespace Parameters {
+
+  /// @addtogroup libHypertableMasterRequestParameters
+  /// @{
+
+  /// %Request parameters for <i>namespace listing</i> operation.
+  class NamespaceListing : public Serializable {
+  public:
+
+    /// Constructor.
+    /// Empty initialization for decoding.
+    NamespaceListing() {}
+
+    /// Constructor.
+    /// Initializes with parameters for encoding.  Sets #m_name to
+    /// <code>name</code> and #m_include_schemas to
+    /// <code>include_schemas</code>.
+    /// @param name Pathname of namespace to list
+    /// @param include_schemas Include binary table schemas in the listing
+    NamespaceListing(const std::string &name, bool include_schemas);
+
+    /// Gets pathname of namespace to list.
+    /// @return Pathname of namespace to list
+    const string& name() const { return m_name; }
+
+    /// Gets include schemas flag.
+    /// @return <i>true</i> if binary table schemas should be included
+    bool include_schemas() const { return m_include_schemas; }
+
+  private:
+
+    /// Returns encoding version.
+    /// @return Encoding version
+    uint8_t encoding_version() const override;
+
+    /// Returns internal serialized length.
+    /// @return Internal serialized length
+    /// @see encode_internal() for encoding format
+    size_t encoded_length_internal() const override;
+
+    /// Writes serialized representation of object to a buffer.
+    /// @param bufp Address of destination buffer pointer (advanced by call)
+    void encode_internal(uint8_t **bufp) const override;
+
+    /// Reads serialized representation of object from a buffer.
+    /// @param version Encoding version
+    /// @param bufp Address of destination buffer pointer (advanced by call)
+    /// @param remainp Address of integer holding amount of serialized object
+    /// remaining
+    /// @see encode_internal() for encoding format
+    void decode_internal(uint8_t version, const uint8_t **bufp,
+			 size_t *remainp) override;
+
+    /// Pathname of namespace to list
+    std::string m_name;
+
+    /// Include binary table schemas in the listing
+    bool m_include_schemas {};
+  };
+
+  /// @}
+
+}}}}}
+
+#endif // Hypertable_Lib_Master_Request_Parameters_NamespaceListing_h
@@ -0,0 +1,114 @@
+/*
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/// @file
+/// Definitions for NamespaceListing response parameters.
+/// This file contains definitions for NamespaceListing, a class for encoding
+/// and decoding paramters returned by the <i>namespace listing</i> %Master
+/// operation.
+
+#include <Common/Compat.h>
+
+#include "NamespaceListing.h"
+
+#include <Common/Logger.h>
+#include <Common/Serialization.h>
+
+using namespace Hypertable;
+using namespace Hypertable::Lib::Master::Response::Parameters;
+
+uint8_t NamespaceListing::encoding_version() const {
+  return 1;
+}
+
+size_t NamespaceListing::encoded_length_internal() const {
+  size_t length = 4;
+  for (auto &entry : m_entries)
+    length += Serialization::encoded_length_vstr(entry.name)
+      + Serialization::encoded_length_vstr(entry.id)
+      + 9 + Serialization::encoded_length_vstr(entry.schema);
+  return length;
+}
+
+/// @details
+/// Encoding is as follows:
+/// <table>
+/// <tr>
+/// <th>Encoding</th>
+/// <th>Description</th>
+/// </tr>
+/// <tr>
+/// <td>i32</td>
+/// <td>Entry count</td>
+/// </tr>
+/// <tr>
+/// <td colspan="2">For each entry ...</td>
+/// </tr>
+/// <tr>
+/// <td>vstr</td>
+/// <td>Pathname relative to the listed namespace</td>
+/// </tr>
+/// <tr>
+/// <td>vstr</td>
+/// <td>Table or namespace ID pathname</td>
+/// </tr>
+/// <tr>
+/// <td>i64</td>
+/// <td>Schema generation</td>
+/// </tr>
+/// <tr>
+/// <td>bool</td>
+/// <td><i>true</i> if entry is a namespace</td>
+/// </tr>
+/// <tr>
+/// <td>vstr</td>
+/// <td>Binary schema encoding</td>
+/// </tr>
+/// </table>
+void NamespaceListing::encode_internal(uint8_t **bufp) const {
+  Serialization::encode_i32(bufp, m_entries.size());
+  for (auto &entry : m_entries) {
+    Serialization::encode_vstr(bufp, entry.name);
+    Serialization::encode_vstr(bufp, entry.id);
+    Serialization::encode_i64(bufp, entry.generation);
+    Serialization::encode_bool(bufp, entry.is_namespace);
+    Serialization::encode_vstr(bufp, entry.schema.data(),
+                               entry.schema.length());
+  }
+}
+
+void NamespaceListing::decode_internal(uint8_t version, const uint8_t **bufp,
+			     size_t *remainp) {
+  int32_t count = Serialization::decode_i32(bufp, remainp);
+  m_entries.clear();
+  m_entries.resize(count);
+  for (int32_t i=0; i<count; i++) {
+    Entry &entry = m_entries[i];
+    entry.name = Serialization::decode_vstr(bufp, remainp);
+    entry.id = Serialization::decode_vstr(bufp, remainp);
+    entry.generation = Serialization::decode_i64(bufp, remainp);
+    entry.is_namespace = Serialization::decode_bool(bufp, remainp);
+    uint32_t schema_len {};
+    const char *schema = Serialization::decode_vstr(bufp, remainp,
+                                                    &schema_len);
+    entry.schema.assign(schema, schema_len);
+  }
+}
@@ -0,0 +1,108 @@
+/* -*- c++ -*-
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/// @file
+/// Declarations for NamespaceListing response parameters.
+/// This file contains declarations for NamespaceListing, a class for encoding
+/// and decoding paramters returned by the <i>namespace listing</i> %Master
+/// operation.
+
+#ifndef Hypertable_Lib_Master_Response_Parameters_NamespaceListing_h
+#define Hypertable_Lib_Master_Response_Parameters_NamespaceListing_h
+
+#include <Common/Serializable.h>
+
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace Hypertable {
+namespace Lib {
+namespace Master {
+namespace Response {
+namespace Parameters {
+
+  /// @addtogroup libHypertableMasterResponseParameters
+  /// @{
+
+  /// %Response parameters for <i>namespace listing</i> operation.
+  class NamespaceListing : public Serializable {
+  public:
+
+    /// Single entry (table or sub-namespace) in a namespace listing.
+    class Entry {
+    public:
+      /// Pathname relative to the listed namespace (e.g. "sub/Sensor")
+      std::string name;
+      /// Table or namespace ID pathname (e.g. "3/1/2")
+      std::string id;
+      /// Schema generation (0 unless binary schemas were requested)
+      int64_t generation {};
+      /// <i>true</i> if entry is a namespace
+      bool is_namespace {};
+      /// Binary schema encoding (empty for namespaces and when binary
+      /// schemas were not requested); see Schema::decode()
+      std::string schema;
+    };
+
+    /// Constructor.
+    /// Empty initialization for decoding.
+    NamespaceListing() {}
+
+    /// Gets listing entries.
+    /// @return Reference to vector of listing entries
+    std::vector<Entry> &entries() { return m_entries; }
+
+  private:
+
+    /// Returns encoding version.
+    /// @return Encoding version
+    uint8_t encoding_version() const override;
+
+    /// Returns internal serialized length.
+    /// @return Internal serialized length
+    /// @see encode_internal() for encoding format
+    size_t encoded_length_internal() const override;
+
+    /// Writes serialized representation of object to a buffer.
+    /// @param bufp Address of destination buffer pointer (advanced by call)
+    void encode_internal(uint8_t **bufp) const override;
+
+    /// Reads serialized representation of object from a buffer.
+    /// @param version Encoding version
+    /// @param bufp Address of destination buffer pointer (advanced by call)
+    /// @param remainp Address of integer holding amount of serialized object
+    /// remaining
+    /// @see encode_internal() for encoding format
+    void decode_internal(uint8_t version, const uint8_t **bufp,
+			 size_t *remainp) override;
+
+    /// Listing entries
+    std::vector<Entry> m_entries;
+
+  };
+
+  /// @}
+
+}}}}}
+
+#endif // Hypertable_Lib_Master_Response_Parameters_NamespaceListing_h
@@ -30,6 +30,7 @@
 #include "MetaLog.h"
 #include "MetaLogWriter.h"
 
+#include <Common/AllocationTracker.h>
 #include <Common/Config.h>
 #include <Common/FileUtils.h>
 #include <Common/Path.h>
@@ -56,6 +57,7 @@ using namespace std;
 namespace {
   const int32_t FS_BUFFER_SIZE = -1;
   const int64_t FS_BLOCK_SIZE = -1;
+  const int32_t MIN_COMPACTION_SIZE = 1048576;
 }
 
 bool Writer::skip_recover_entry = false;
@@ -86,6 +88,8 @@ Writer::Writer(FilesystemPtr &fs, DefinitionPtr &definition, const string &path,
 
   m_max_file_size = Config::properties->get_i64("Hypertable.MetaLog.MaxFileSize");
 
+  m_compaction_factor = Config::properties->get_i32("Hypertable.MetaLog.CompactionFactor");
+
   // get replication
   m_replication = Config::properties->get_i32("Hypertable.Metadata.Replication");
 
@@ -239,9 +243,21 @@ void Writer::service_write_queue() {
     m_fs->append(m_fd, buf, m_flush_method);
 
     m_write_queue.clear();
+    AllocationTracker::add(AllocationTracker::METALOG, -(int64_t)total);
 
     if (m_offset > m_max_file_size)
       roll();
+    else if (m_compaction_factor > 0 && m_offset > MIN_COMPACTION_SIZE) {
+      // Fold the live entity map into a fresh snapshot once superseded
+      // records dominate the file.  This bounds failover replay to roughly
+      // m_compaction_factor times the live entity state regardless of how
+      // much churn the log has absorbed.
+      int64_t live_size = EntityHeader::LENGTH;  // Recover entity
+      for (auto &entry : m_entity_map)
+        live_size += entry.second.first;
+      if (m_offset > live_size * m_compaction_factor)
+        roll();
+    }
   }
 
 }
@@ -344,6 +360,7 @@ void Writer::record_state(EntityPtr entity) {
       m_entity_map[entity->header.id] = SerializedEntityT(length, backup_buf);
   }
 
+  AllocationTracker::add(AllocationTracker::METALOG, buf->size);
   m_write_queue.push_back(buf);
 
   m_write_scheduler->schedule();
@@ -399,6 +416,7 @@ void Writer::record_state(std::vector<EntityPtr> &entities) {
   }
   HT_ASSERT((ptr-buf->base) == (ptrdiff_t)buf->size);
 
+  AllocationTracker::add(AllocationTracker::METALOG, buf->size);
   m_write_queue.push_back(buf);
 
   m_write_scheduler->schedule();
@@ -428,6 +446,7 @@ void Writer::record_removal(EntityPtr entity) {
   // Remove from entity map
   m_entity_map.erase(entity->header.id);
 
+  AllocationTracker::add(AllocationTracker::METALOG, buf->size);
   m_write_queue.push_back(buf);
 
   m_write_scheduler->schedule();
@@ -462,6 +481,7 @@ void Writer::record_removal(std::vector<EntityPtr> &entities) {
 
   HT_ASSERT((ptr-buf->base) == (ptrdiff_t)buf->size);
 
+  AllocationTracker::add(AllocationTracker::METALOG, buf->size);
   m_write_queue.push_back(buf);
 
   m_write_scheduler->schedule();
@@ -250,6 +250,11 @@ namespace Hypertable {
       /// Maximum file size
       int64_t m_max_file_size {};
 
+      /// Snapshot compaction factor; the log is rolled into a fresh
+      /// snapshot when the current file exceeds this multiple of the live
+      /// entity state (0 disables ratio-triggered compaction)
+      int32_t m_compaction_factor {};
+
       /// Number of old MetaLog files to retain for historical purposes
       size_t m_history_size {};
 
@@ -36,11 +36,11 @@ using namespace Hypertable::Serialization;
 using namespace std;
 
 uint8_t ProfileDataScanner::encoding_version() const {
-  return 1;
+  return 2;
 }
 
 size_t ProfileDataScanner::encoded_length_internal() const {
-  size_t length = 52;
+  size_t length = 108;
   if (!servers.empty()) {
     for (auto & str : servers)
       length += encoded_length_vstr(str);
@@ -56,6 +56,13 @@ void ProfileDataScanner::encode_internal(uint8_t **bufp) const {
   encode_i64(bufp, (uint64_t)bytes_scanned);
   encode_i64(bufp, (uint64_t)bytes_returned);
   encode_i64(bufp, (uint64_t)disk_read);
+  encode_i64(bufp, (uint64_t)blocks_read);
+  encode_i64(bufp, (uint64_t)block_cache_hits);
+  encode_i64(bufp, (uint64_t)bloom_filter_misses);
+  encode_i64(bufp, (uint64_t)cells_filtered_predicates);
+  encode_i64(bufp, (uint64_t)cells_filtered_row_regexp);
+  encode_i64(bufp, (uint64_t)cells_filtered_value_regexp);
+  encode_i64(bufp, (uint64_t)bytes_decompressed);
   encode_i32(bufp, (uint32_t)servers.size());
   if (!servers.empty()) {
     for (auto & str : servers)
@@ -65,7 +72,6 @@ void ProfileDataScanner::encode_internal(uint8_t **bufp) const {
 
 void ProfileDataScanner::decode_internal(uint8_t version, const uint8_t **bufp,
 					 size_t *remainp) {
-  (void)version;
   subscanners = (int32_t)decode_i32(bufp, remainp);
   scanblocks = (int32_t)decode_i32(bufp, remainp);
   cells_scanned = (int64_t)decode_i64(bufp, remainp);
@@ -73,6 +79,15 @@ void ProfileDataScanner::decode_internal(uint8_t version, const uint8_t **bufp,
   bytes_scanned = (int64_t)decode_i64(bufp, remainp);
   bytes_returned = (int64_t)decode_i64(bufp, remainp);
   disk_read = (int64_t)decode_i64(bufp, remainp);
+  if (version >= 2) {
+    blocks_read = (int64_t)decode_i64(bufp, remainp);
+    block_cache_hits = (int64_t)decode_i64(bufp, remainp);
+    bloom_filter_misses = (int64_t)decode_i64(bufp, remainp);
+    cells_filtered_predicates = (int64_t)decode_i64(bufp, remainp);
+    cells_filtered_row_regexp = (int64_t)decode_i64(bufp, remainp);
+    cells_filtered_value_regexp = (int64_t)decode_i64(bufp, remainp);
+    bytes_decompressed = (int64_t)decode_i64(bufp, remainp);
+  }
   size_t count = (size_t)decode_i32(bufp, remainp);
   for (size_t i=0; i<count; i++)
     servers.insert( decode_vstr(bufp, remainp) );
@@ -87,6 +102,13 @@ ProfileDataScanner &ProfileDataScanner::operator+=(const ProfileDataScanner &oth
   bytes_scanned += other.bytes_scanned;
   bytes_returned += other.bytes_returned;
   disk_read += other.disk_read;
+  blocks_read += other.blocks_read;
+  block_cache_hits += other.block_cache_hits;
+  bloom_filter_misses += other.bloom_filter_misses;
+  cells_filtered_predicates += other.cells_filtered_predicates;
+  cells_filtered_row_regexp += other.cells_filtered_row_regexp;
+  cells_filtered_value_regexp += other.cells_filtered_value_regexp;
+  bytes_decompressed += other.bytes_decompressed;
   servers.insert(other.servers.begin(), other.servers.end());
   return *this;
 }
@@ -99,6 +121,13 @@ ProfileDataScanner &ProfileDataScanner::operator-=(const ProfileDataScanner &oth
   bytes_scanned -= other.bytes_scanned;
   bytes_returned -= other.bytes_returned;
   disk_read -= other.disk_read;
+  blocks_read -= other.blocks_read;
+  block_cache_hits -= other.block_cache_hits;
+  bloom_filter_misses -= other.bloom_filter_misses;
+  cells_filtered_predicates -= other.cells_filtered_predicates;
+  cells_filtered_row_regexp -= other.cells_filtered_row_regexp;
+  cells_filtered_value_regexp -= other.cells_filtered_value_regexp;
+  bytes_decompressed -= other.bytes_decompressed;
   for (auto &server : other.servers)
     servers.erase(server);
   return *this;
@@ -111,6 +140,13 @@ string ProfileDataScanner::to_string() {
   str += string("bytes_scanned=") + bytes_scanned + " ";
   str += string("bytes_returned=") + bytes_returned + " ";
   str += string("disk_read=") + disk_read + " ";
+  str += string("blocks_read=") + blocks_read + " ";
+  str += string("block_cache_hits=") + block_cache_hits + " ";
+  str += string("bloom_filter_misses=") + bloom_filter_misses + " ";
+  str += string("cells_filtered_predicates=") + cells_filtered_predicates + " ";
+  str += string("cells_filtered_row_regexp=") + cells_filtered_row_regexp + " ";
+  str += string("cells_filtered_value_regexp=") + cells_filtered_value_regexp + " ";
+  str += string("bytes_decompressed=") + bytes_decompressed + " ";
   str += string("subscanners=") + subscanners + " ";
   str += string("scanblocks=") + scanblocks + " ";
   str += string("servers=");
@@ -78,6 +78,27 @@ namespace Hypertable {
     /// Number of bytes read from disk while executing scan
     int64_t disk_read {};
 
+    /// Number of cell store blocks read from the file system
+    int64_t blocks_read {};
+
+    /// Number of cell store blocks satisfied from the block caches
+    int64_t block_cache_hits {};
+
+    /// Number of cell stores excluded by a bloom filter lookup
+    int64_t bloom_filter_misses {};
+
+    /// Number of cells dropped by a column predicate
+    int64_t cells_filtered_predicates {};
+
+    /// Number of cells dropped by the row regexp
+    int64_t cells_filtered_row_regexp {};
+
+    /// Number of cells dropped by the value regexp
+    int64_t cells_filtered_value_regexp {};
+
+    /// Number of bytes produced by block decompression
+    int64_t bytes_decompressed {};
+
     /// Set of server proxy names participating in scan
     std::set<std::string> servers;
 
@@ -64,6 +64,24 @@ void RangeMeasurement::parse_measurement(const char *measurement, size_t len) {
                format("Measurement string '%s' has %d components, expected 12.",
                       str.c_str(), (int)splits.size()));
   }
+  else if (version == 4) {
+    if (splits.size() != 14)
+      HT_THROW(Error::PROTOCOL_ERROR,
+               format("Measurement string '%s' has %d components, expected 14.",
+                      str.c_str(), (int)splits.size()));
+  }
+  else if (version == 5) {
+    if (splits.size() != 17)
+      HT_THROW(Error::PROTOCOL_ERROR,
+               format("Measurement string '%s' has %d components, expected 17.",
+                      str.c_str(), (int)splits.size()));
+  }
+  else if (version == 6) {
+    if (splits.size() != 20)
+      HT_THROW(Error::PROTOCOL_ERROR,
+               format("Measurement string '%s' has %d components, expected 20.",
+                      str.c_str(), (int)splits.size()));
+  }
   else
     HT_THROW(Error::NOT_IMPLEMENTED,
              format("ServerMetrics version=%d expected 2", (int)version));
@@ -73,7 +91,7 @@ void RangeMeasurement::parse_measurement(const char *measurement, size_t len) {
   timestamp             = strtoll(splits[i++].c_str(), 0, 0);
   disk_used             = strtoll(splits[i++].c_str(), 0, 0);
   memory_used           = strtoll(splits[i++].c_str(), 0, 0);
-  if (version == 3)
+  if (version >= 3)
     compression_ratio   = strtod(splits[i++].c_str(), 0);
   disk_byte_read_rate   = strtod(splits[i++].c_str(), 0);
   byte_write_rate       = strtod(splits[i++].c_str(), 0);
@@ -82,6 +100,20 @@ void RangeMeasurement::parse_measurement(const char *measurement, size_t len) {
   scan_rate             = strtod(splits[i++].c_str(), 0);
   cell_write_rate       = strtod(splits[i++].c_str(), 0);
   cell_read_rate        = strtod(splits[i++].c_str(), 0);
+  if (version >= 4) {
+    scan_latency_p99    = strtod(splits[i++].c_str(), 0);
+    update_latency_p99  = strtod(splits[i++].c_str(), 0);
+  }
+  if (version >= 5) {
+    cell_count          = strtoll(splits[i++].c_str(), 0, 0);
+    key_bytes           = strtoll(splits[i++].c_str(), 0, 0);
+    value_bytes         = strtoll(splits[i++].c_str(), 0, 0);
+  }
+  if (version >= 6) {
+    block_cache_hit_rate  = strtod(splits[i++].c_str(), 0);
+    block_cache_miss_rate = strtod(splits[i++].c_str(), 0);
+    working_set           = strtoll(splits[i++].c_str(), 0, 0);
+  }
 }
 
 RangeMetrics::RangeMetrics(const char *server_id, const char *table_id,
@@ -59,6 +59,14 @@ namespace RS_METRICS {
     double scan_rate;
     double cell_write_rate;
     double cell_read_rate;
+    double scan_latency_p99;
+    double update_latency_p99;
+    int64_t cell_count;
+    int64_t key_bytes;
+    int64_t value_bytes;
+    double block_cache_hit_rate;
+    double block_cache_miss_rate;
+    int64_t working_set;
   }; // RangeMeasurement
 
 
@@ -23,6 +23,7 @@
 
 #include "Hyperspace/Session.h"
 
+#include <Hypertable/Lib/ClusterId.h>
 #include <Hypertable/Lib/Key.h>
 #include <Hypertable/Lib/NameIdMapper.h>
 #include <Hypertable/Lib/RootFileHandler.h>
@@ -32,6 +33,7 @@
 
 #include <Common/Error.h>
 #include <Common/ScopeGuard.h>
+#include <Common/Serialization.h>
 
 #include <boost/algorithm/string.hpp>
 
@@ -132,6 +134,20 @@ RangeLocator::RangeLocator(PropertiesPtr &cfg, ConnectionManagerPtr &conn_mgr,
   m_toplevel_dir = String("/") + m_toplevel_dir;
 
   m_cache = make_shared<LocationCache>(cache_size);
+
+  // Optionally warm the cache from an on-disk snapshot so that short-lived
+  // processes don't pay a METADATA scan storm at startup
+  m_cache_snapshot_file = cfg->get_str("Hypertable.LocationCache.SnapshotFile");
+  if (!m_cache_snapshot_file.empty() && ClusterId::get() != 0) {
+    time_t max_age =
+      (time_t)cfg->get_i32("Hypertable.LocationCache.Snapshot.MaxAge");
+    size_t loaded = m_cache->load_snapshot(m_cache_snapshot_file,
+                                           ClusterId::get(), max_age);
+    if (loaded)
+      HT_INFOF("Loaded %u range locations from %s", (unsigned)loaded,
+               m_cache_snapshot_file.c_str());
+  }
+
   // register hyperspace session callback
   m_hyperspace_session_callback.m_rangelocator = this;
   m_hyperspace->add_callback(&m_hyperspace_session_callback);
@@ -223,6 +239,15 @@ void RangeLocator::initialize() {
 
 
 RangeLocator::~RangeLocator() {
+  if (!m_cache_snapshot_file.empty() && ClusterId::get() != 0) {
+    try {
+      m_cache->save_snapshot(m_cache_snapshot_file, ClusterId::get());
+    }
+    catch (Exception &e) {
+      HT_WARN_OUT << "Problem saving location cache snapshot to "
+                  << m_cache_snapshot_file << " - " << e << HT_END;
+    }
+  }
   m_hyperspace->close_nowait(m_root_file_handle);
   m_hyperspace->remove_callback(&m_hyperspace_session_callback);
 }
@@ -637,6 +662,46 @@ int RangeLocator::read_root_location(Timer &timer) {
     addr = m_root_range_info.addr;
   }
 
+  /**
+   * Warm the METADATA location cache from the root range contents
+   * published in Hyperspace (see
+   * Hypertable.RangeServer.Root.PublishLocations).  This satisfies the
+   * second-level range lookup for most location cache misses without
+   * scanning the root METADATA range, whose server is otherwise crushed
+   * when a mass client restart empties every location cache at once.  A
+   * stale entry is corrected by the normal invalidate-and-hard-lookup
+   * path, which still scans the root range directly.
+   */
+  try {
+    DynamicBuffer toc(0);
+    {
+      lock_guard<mutex> lock(m_hyperspace_mutex);
+      if (m_hyperspace_init)
+        m_hyperspace->attr_get(m_root_file_handle, "RangeLocations", toc);
+    }
+    const uint8_t *ptr = toc.base;
+    size_t remain = toc.fill();
+    if (remain) {
+      RangeLocationInfo range_loc_info;
+      int32_t count = Serialization::decode_i32(&ptr, &remain);
+      for (int32_t i=0; i<count; i++) {
+        range_loc_info.end_row = Serialization::decode_vstr(&ptr, &remain);
+        range_loc_info.start_row = Serialization::decode_vstr(&ptr, &remain);
+        range_loc_info.addr.set_proxy(
+            Serialization::decode_vstr(&ptr, &remain));
+        if (m_conn_manager)
+          m_conn_manager->add(range_loc_info.addr, m_metadata_retry_interval,
+                              "RangeServer");
+        m_cache->insert(TableIdentifier::METADATA_ID, range_loc_info);
+      }
+    }
+  }
+  catch (Exception &e) {
+    if (e.code() != Error::HYPERSPACE_ATTR_NOT_FOUND)
+      HT_WARNF("Problem reading published METADATA range locations - %s",
+               Error::get_text(e.code()));
+  }
+
   if (m_conn_manager) {
 
     /**
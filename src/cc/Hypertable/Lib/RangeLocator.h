@@ -188,6 +188,7 @@ namespace Hypertable {
     uint32_t               m_timeout_ms;
     RangeLocatorHyperspaceSessionCallback m_hyperspace_session_callback;
     std::string                 m_toplevel_dir;
+    std::string            m_cache_snapshot_file;
     uint32_t               m_metadata_readahead_count;
     uint32_t               m_max_error_queue_length;
     uint32_t               m_metadata_retry_interval;
@@ -30,8 +30,10 @@
 #include "Client.h"
 #include "Protocol.h"
 #include "Request/Parameters/AcknowledgeLoad.h"
+#include "Request/Parameters/AdoptCellstore.h"
 #include "Request/Parameters/CommitLogSync.h"
 #include "Request/Parameters/Compact.h"
+#include "Request/Parameters/CompareAndUpdate.h"
 #include "Request/Parameters/CreateScanner.h"
 #include "Request/Parameters/DestroyScanner.h"
 #include "Request/Parameters/DropRange.h"
@@ -55,6 +57,7 @@
 #include "Request/Parameters/UpdateSchema.h"
 #include "Response/Parameters/AcknowledgeLoad.h"
 #include "Response/Parameters/CreateScanner.h"
+#include "Response/Parameters/GetLiveState.h"
 #include "Response/Parameters/GetStatistics.h"
 #include "Response/Parameters/Status.h"
 
@@ -67,15 +70,128 @@
 #include <Common/Error.h>
 #include <Common/StringExt.h>
 #include <Common/Serialization.h>
+#include <Common/SystemInfo.h>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
 
 using namespace Hypertable;
 using namespace Hypertable::Config;
 using namespace std;
 
+namespace {
+
+  /// Number of latency samples kept for hedge delay computation
+  const size_t LATENCY_SAMPLE_CAPACITY = 256;
+
+  /// Number of samples between hedge delay recomputations
+  const size_t HEDGE_DELAY_RECOMPUTE_INTERVAL = 64;
+
+  /** Dispatch handler for hedged read requests.
+   * Collects the first response event for delivery to the waiting client
+   * thread, like DispatchHandlerSynchronizer, but additionally keeps count
+   * of the attempts issued against it and deletes itself once every attempt
+   * has produced an event (the Comm layer guarantees a response or timeout
+   * error event per request).  This way the client thread can return with
+   * the winning response while the losing attempt is still outstanding,
+   * without its late response ever touching freed memory.
+   */
+  class HedgedReadHandler : public DispatchHandler {
+  public:
+
+    virtual void handle(EventPtr &event) {
+      bool destroy;
+      {
+        lock_guard<mutex> lock(m_mutex);
+        m_received++;
+        if (!m_first_event) {
+          m_first_event = event;
+          m_cond.notify_one();
+        }
+        destroy = m_abandoned && m_received == m_expected;
+      }
+      if (destroy)
+        delete this;
+    }
+
+    /// Registers another issued attempt (call after a successful send)
+    void expect_another() {
+      lock_guard<mutex> lock(m_mutex);
+      m_expected++;
+    }
+
+    /** Waits up to <code>timeout_ms</code> for the first response event.
+     * @param event Reference to returned event
+     * @param timeout_ms Milliseconds to wait
+     * @return <i>false</i> if the wait timed out, <i>true</i> otherwise
+     */
+    bool wait_first(EventPtr &event, int32_t timeout_ms) {
+      unique_lock<mutex> lock(m_mutex);
+      if (!m_cond.wait_for(lock, chrono::milliseconds(timeout_ms),
+                           [this](){ return (bool)m_first_event; }))
+        return false;
+      event = m_first_event;
+      return true;
+    }
+
+    /// Waits for the first response event
+    void wait_first(EventPtr &event) {
+      unique_lock<mutex> lock(m_mutex);
+      m_cond.wait(lock, [this](){ return (bool)m_first_event; });
+      event = m_first_event;
+    }
+
+    /// Relinquishes ownership; the handler deletes itself once all issued
+    /// attempts have produced an event
+    void abandon() {
+      bool destroy;
+      {
+        lock_guard<mutex> lock(m_mutex);
+        m_abandoned = true;
+        destroy = m_received == m_expected;
+      }
+      if (destroy)
+        delete this;
+    }
+
+  private:
+    std::mutex m_mutex;
+    std::condition_variable m_cond;
+    EventPtr m_first_event;
+    size_t m_expected {};
+    size_t m_received {};
+    bool m_abandoned {};
+  };
+
+}
+
 Lib::RangeServer::Client::Client(Comm *comm, int32_t timeout_ms)
   : m_comm(comm), m_default_timeout_ms(timeout_ms) {
   if (timeout_ms == 0)
     m_default_timeout_ms = get_i32("Hypertable.Request.Timeout");
+  m_shm_scan_results = get_bool("Hypertable.Client.ShmScanResults");
+  m_hedged_reads = get_bool("Hypertable.Client.HedgedReads");
+  int32_t format = get_i32("Hypertable.Scanner.ScanblockFormat");
+  HT_ASSERT(format == 1 || format == 2);
+  m_scan_block_format = (uint8_t)format;
+}
+
+
+bool Lib::RangeServer::Client::shm_payload_ok(const CommAddress &addr) {
+  if (!m_shm_scan_results)
+    return false;
+  InetAddr inet;
+  if (addr.is_proxy()) {
+    if (!m_comm->translate_proxy(addr.proxy, &inet))
+      return false;
+  }
+  else
+    inet = addr.inet;
+  if ((ntohl(inet.sin_addr.s_addr) >> 24) == 127)
+    return true;
+  return InetAddr::format_ipaddress(inet) == System::net_info().primary_addr;
 }
 
 
@@ -120,6 +236,37 @@ void Lib::RangeServer::Client::compact(const CommAddress &addr, const TableIdent
   send_message(addr, cbuf, handler, timer.remaining());
 }
 
+void Lib::RangeServer::Client::adopt_cellstore(const CommAddress &addr,
+                     const TableIdentifier &table, const RangeSpec &range_spec,
+                     const String &ag_name, const String &source_file) {
+  DispatchHandlerSynchronizer sync_handler;
+  EventPtr event;
+  CommHeader header(Protocol::COMMAND_ADOPT_CELLSTORE);
+  Request::Parameters::AdoptCellstore params(table, range_spec, ag_name,
+                                             source_file);
+  CommBufPtr cbuf(new CommBuf(header, params.encoded_length()));
+  params.encode(cbuf->get_data_ptr_address());
+
+  send_message(addr, cbuf, &sync_handler, m_default_timeout_ms);
+
+  if (!sync_handler.wait_for_reply(event))
+    HT_THROW(Hypertable::Protocol::response_code(event),
+             String("RangeServer adopt_cellstore() failure : ")
+             + Hypertable::Protocol::string_format_message(event));
+}
+
+void Lib::RangeServer::Client::adopt_cellstore(const CommAddress &addr,
+                     const TableIdentifier &table, const RangeSpec &range_spec,
+                     const String &ag_name, const String &source_file,
+                     DispatchHandler *handler) {
+  CommHeader header(Protocol::COMMAND_ADOPT_CELLSTORE);
+  Request::Parameters::AdoptCellstore params(table, range_spec, ag_name,
+                                             source_file);
+  CommBufPtr cbuf(new CommBuf(header, params.encoded_length()));
+  params.encode(cbuf->get_data_ptr_address());
+  send_message(addr, cbuf, handler, m_default_timeout_ms);
+}
+
 
 void
 Lib::RangeServer::Client::load_range(const CommAddress &addr,
@@ -213,15 +360,62 @@ void Lib::RangeServer::Client::update(const CommAddress &addr, uint64_t cluster_
   send_message(addr, cbuf, handler, m_default_timeout_ms);
 }
 
+void Lib::RangeServer::Client::compare_and_update(const CommAddress &addr,
+                    uint64_t cluster_id, const TableIdentifier &table,
+                    const String &row, const String &column_family,
+                    const String &column_qualifier, bool expect_missing,
+                    const String &expected_value, int32_t count,
+                    StaticBuffer &buffer, int32_t flags,
+                    DispatchHandler *handler) {
+  do_compare_and_update(addr, cluster_id, table, row, column_family,
+                        column_qualifier, expect_missing, expected_value,
+                        count, buffer, flags, handler, m_default_timeout_ms);
+}
+
+void Lib::RangeServer::Client::compare_and_update(const CommAddress &addr,
+                    uint64_t cluster_id, const TableIdentifier &table,
+                    const String &row, const String &column_family,
+                    const String &column_qualifier, bool expect_missing,
+                    const String &expected_value, int32_t count,
+                    StaticBuffer &buffer, int32_t flags,
+                    DispatchHandler *handler, Timer &timer) {
+  do_compare_and_update(addr, cluster_id, table, row, column_family,
+                        column_qualifier, expect_missing, expected_value,
+                        count, buffer, flags, handler, timer.remaining());
+}
+
+void Lib::RangeServer::Client::do_compare_and_update(const CommAddress &addr,
+                    uint64_t cluster_id, const TableIdentifier &table,
+                    const String &row, const String &column_family,
+                    const String &column_qualifier, bool expect_missing,
+                    const String &expected_value, int32_t count,
+                    StaticBuffer &buffer, int32_t flags,
+                    DispatchHandler *handler, int32_t timeout_ms) {
+  CommHeader header(Protocol::COMMAND_COMPARE_AND_UPDATE);
+  if (table.is_system())
+    header.flags |= CommHeader::FLAGS_BIT_URGENT;
+  Request::Parameters::CompareAndUpdate params(cluster_id, table, row,
+                                               column_family,
+                                               column_qualifier,
+                                               expect_missing, expected_value,
+                                               count, flags);
+  CommBufPtr cbuf(new CommBuf(header, params.encoded_length(), buffer));
+  params.encode(cbuf->get_data_ptr_address());
+  send_message(addr, cbuf, handler, timeout_ms);
+}
+
 void
 Lib::RangeServer::Client::create_scanner(const CommAddress &addr,
     const TableIdentifier &table, const RangeSpec &range,
     const ScanSpec &scan_spec, DispatchHandler *handler) {
   CommHeader header(Protocol::COMMAND_CREATE_SCANNER);
   header.flags |= CommHeader::FLAGS_BIT_PROFILE;
+  if (shm_payload_ok(addr))
+    header.flags |= CommHeader::FLAGS_BIT_SHM_PAYLOAD_OK;
   if (table.is_system())
     header.flags |= CommHeader::FLAGS_BIT_URGENT;
-  Request::Parameters::CreateScanner params(table, range, scan_spec);
+  Request::Parameters::CreateScanner params(table, range, scan_spec,
+                                            m_scan_block_format);
   CommBufPtr cbuf(new CommBuf(header, params.encoded_length()));
   params.encode(cbuf->get_data_ptr_address());
   send_message(addr, cbuf, handler, m_default_timeout_ms);
@@ -234,9 +428,12 @@ Lib::RangeServer::Client::create_scanner(const CommAddress &addr,
     Timer &timer) {
   CommHeader header(Protocol::COMMAND_CREATE_SCANNER);
   header.flags |= CommHeader::FLAGS_BIT_PROFILE;
+  if (shm_payload_ok(addr))
+    header.flags |= CommHeader::FLAGS_BIT_SHM_PAYLOAD_OK;
   if (table.is_system())
     header.flags |= CommHeader::FLAGS_BIT_URGENT;
-  Request::Parameters::CreateScanner params(table, range, scan_spec);
+  Request::Parameters::CreateScanner params(table, range, scan_spec,
+                                            m_scan_block_format);
   CommBufPtr cbuf(new CommBuf(header, params.encoded_length()));
   params.encode(cbuf->get_data_ptr_address());
   send_message(addr, cbuf, handler, timer.remaining());
@@ -264,24 +461,106 @@ Lib::RangeServer::Client::do_create_scanner(const CommAddress &addr,
     const TableIdentifier &table, const RangeSpec &range,
     const ScanSpec &scan_spec, ScanBlock &scan_block,
     int32_t timeout_ms) {
-  DispatchHandlerSynchronizer sync_handler;
   EventPtr event;
   CommHeader header(Protocol::COMMAND_CREATE_SCANNER);
   header.flags |= CommHeader::FLAGS_BIT_PROFILE;
+  if (shm_payload_ok(addr))
+    header.flags |= CommHeader::FLAGS_BIT_SHM_PAYLOAD_OK;
   if (table.is_system())
     header.flags |= CommHeader::FLAGS_BIT_URGENT;
-  Request::Parameters::CreateScanner params(table, range, scan_spec);
+  Request::Parameters::CreateScanner params(table, range, scan_spec,
+                                            m_scan_block_format);
   CommBufPtr cbuf(new CommBuf(header, params.encoded_length()));
   params.encode(cbuf->get_data_ptr_address());
 
-  send_message(addr, cbuf, &sync_handler, timeout_ms);
+  if (!m_hedged_reads) {
+    DispatchHandlerSynchronizer sync_handler;
 
-  if (!sync_handler.wait_for_reply(event))
+    send_message(addr, cbuf, &sync_handler, timeout_ms);
+
+    if (!sync_handler.wait_for_reply(event))
+      HT_THROW(Hypertable::Protocol::response_code(event),
+               String("RangeServer create_scanner() failure : ")
+               + Hypertable::Protocol::string_format_message(event));
+    else {
+      HT_ASSERT(scan_block.load(event) == Error::OK);
+    }
+    return;
+  }
+
+  // Hedged read:  if no response arrives within the adaptive hedge delay,
+  // issue a duplicate request and take whichever response arrives first.
+  // A losing duplicate creates an orphan scanner on the server that is
+  // reclaimed when Hypertable.RangeServer.Scanner.Ttl expires.
+  HedgedReadHandler *handler = new HedgedReadHandler();
+  auto start_time = chrono::steady_clock::now();
+
+  try {
+    send_message(addr, cbuf, handler, timeout_ms);
+  }
+  catch (Exception &) {
+    // send_message() throws only when no callback will be delivered
+    delete handler;
+    throw;
+  }
+  handler->expect_another();
+
+  if (!handler->wait_first(event, hedge_delay(timeout_ms))) {
+    try {
+      CommBufPtr hedge_cbuf(new CommBuf(header, params.encoded_length()));
+      params.encode(hedge_cbuf->get_data_ptr_address());
+      send_message(addr, hedge_cbuf, handler, timeout_ms);
+      handler->expect_another();
+    }
+    catch (Exception &e) {
+      // The original attempt is still outstanding
+      HT_WARNF("Hedged create_scanner to %s failed - %s",
+               addr.to_str().c_str(), e.what());
+    }
+    handler->wait_first(event);
+  }
+
+  record_read_latency((int32_t)chrono::duration_cast<chrono::milliseconds>
+                      (chrono::steady_clock::now() - start_time).count());
+
+  bool ok = event->type == Event::MESSAGE &&
+    Hypertable::Protocol::response_code(event.get()) == Error::OK;
+
+  handler->abandon();
+
+  if (!ok)
     HT_THROW(Hypertable::Protocol::response_code(event),
              String("RangeServer create_scanner() failure : ")
              + Hypertable::Protocol::string_format_message(event));
+
+  HT_ASSERT(scan_block.load(event) == Error::OK);
+}
+
+int32_t Lib::RangeServer::Client::hedge_delay(int32_t timeout_ms) {
+  int32_t delay;
+  {
+    lock_guard<mutex> lock(m_latency_mutex);
+    delay = m_hedge_delay_ms;
+  }
+  if (delay == 0)
+    delay = timeout_ms / 4;
+  return std::max((int32_t)10, std::min(delay, timeout_ms / 2));
+}
+
+void Lib::RangeServer::Client::record_read_latency(int32_t latency_ms) {
+  lock_guard<mutex> lock(m_latency_mutex);
+  if (m_latency_samples.size() < LATENCY_SAMPLE_CAPACITY)
+    m_latency_samples.push_back(latency_ms);
   else {
-    HT_ASSERT(scan_block.load(event) == Error::OK);
+    m_latency_samples[m_latency_next] = latency_ms;
+    m_latency_next = (m_latency_next + 1) % LATENCY_SAMPLE_CAPACITY;
+  }
+  if (++m_samples_since_recompute >= HEDGE_DELAY_RECOMPUTE_INTERVAL) {
+    m_samples_since_recompute = 0;
+    std::vector<int32_t> sorted(m_latency_samples);
+    size_t p99_index = (sorted.size() * 99) / 100;
+    std::nth_element(sorted.begin(), sorted.begin() + p99_index, sorted.end());
+    m_hedge_delay_ms = sorted[p99_index];
   }
 }
 
@@ -345,6 +624,8 @@ Lib::RangeServer::Client::fetch_scanblock(const CommAddress &addr, int32_t scann
                         DispatchHandler *handler) {
   CommHeader header(Protocol::COMMAND_FETCH_SCANBLOCK);
   header.flags |= CommHeader::FLAGS_BIT_PROFILE;
+  if (shm_payload_ok(addr))
+    header.flags |= CommHeader::FLAGS_BIT_SHM_PAYLOAD_OK;
   header.gid = scanner_id;
   Request::Parameters::FetchScanblock params(scanner_id);
   CommBufPtr cbuf(new CommBuf(header, params.encoded_length()));
@@ -357,6 +638,8 @@ Lib::RangeServer::Client::fetch_scanblock(const CommAddress &addr, int32_t scann
                         DispatchHandler *handler, Timer &timer) {
   CommHeader header(Protocol::COMMAND_FETCH_SCANBLOCK);
   header.flags |= CommHeader::FLAGS_BIT_PROFILE;
+  if (shm_payload_ok(addr))
+    header.flags |= CommHeader::FLAGS_BIT_SHM_PAYLOAD_OK;
   header.gid = scanner_id;
   Request::Parameters::FetchScanblock params(scanner_id);
   CommBufPtr cbuf(new CommBuf(header, params.encoded_length()));
@@ -383,6 +666,8 @@ Lib::RangeServer::Client::do_fetch_scanblock(const CommAddress &addr, int32_t sc
   DispatchHandlerSynchronizer sync_handler;
   CommHeader header(Protocol::COMMAND_FETCH_SCANBLOCK);
   header.flags |= CommHeader::FLAGS_BIT_PROFILE;
+  if (shm_payload_ok(addr))
+    header.flags |= CommHeader::FLAGS_BIT_SHM_PAYLOAD_OK;
   header.gid = scanner_id;
   Request::Parameters::FetchScanblock params(scanner_id);
   CommBufPtr cbuf(new CommBuf(header, params.encoded_length()));
@@ -566,6 +851,29 @@ void Lib::RangeServer::Client::dump(const CommAddress &addr, String &outfile, bo
 
 }
 
+void Lib::RangeServer::Client::get_live_state(const CommAddress &addr,
+                                              String &output) {
+  DispatchHandlerSynchronizer sync_handler;
+  CommHeader header(Protocol::COMMAND_GET_LIVE_STATE);
+  header.flags |= CommHeader::FLAGS_BIT_URGENT;
+  CommBufPtr cbuf(new CommBuf(header));
+  send_message(addr, cbuf, &sync_handler, m_default_timeout_ms);
+
+  EventPtr event;
+  if (!sync_handler.wait_for_reply(event))
+    HT_THROW(Hypertable::Protocol::response_code(event),
+             String("RangeServer get_live_state() failure : ")
+             + Hypertable::Protocol::string_format_message(event));
+
+  {
+    size_t remaining = event->payload_len - 4;
+    const uint8_t *ptr = event->payload + 4;
+    Response::Parameters::GetLiveState params;
+    params.decode(&ptr, &remaining);
+    output = params.output();
+  }
+}
+
 void
 Lib::RangeServer::Client::dump_pseudo_table(const CommAddress &addr, const TableIdentifier &table,
                           const String &pseudo_table_name,
@@ -48,6 +48,8 @@
 
 #include <map>
 #include <memory>
+#include <mutex>
+#include <vector>
 
 namespace Hypertable {
 namespace Lib {
@@ -108,6 +110,34 @@ namespace RangeServer {
                  const String &row, int32_t flags,
                  DispatchHandler *handler, Timer &timer);
 
+    /** Issues a synchronous "adopt cellstore" request.
+     * Links a bulk loaded CellStore file into an access group of the range
+     * identified by <code>range_spec</code>.  The file must have been
+     * written with the CellStore writer and must only contain cells
+     * belonging to the access group's column families and the range's row
+     * interval.
+     * @param addr address of RangeServer
+     * @param table %Table identifier
+     * @param range_spec %Range specification
+     * @param ag_name Access group name
+     * @param source_file Pathname of bulk loaded CellStore file
+     */
+    void adopt_cellstore(const CommAddress &addr, const TableIdentifier &table,
+                         const RangeSpec &range_spec, const String &ag_name,
+                         const String &source_file);
+
+    /** Issues an "adopt cellstore" request asynchronously.
+     * @param addr address of RangeServer
+     * @param table %Table identifier
+     * @param range_spec %Range specification
+     * @param ag_name Access group name
+     * @param source_file Pathname of bulk loaded CellStore file
+     * @param handler Dispatch handler
+     */
+    void adopt_cellstore(const CommAddress &addr, const TableIdentifier &table,
+                         const RangeSpec &range_spec, const String &ag_name,
+                         const String &source_file, DispatchHandler *handler);
+
     /** Issues a synchronous "load range" request.
      * @param addr address of RangeServer
      * @param table table identifier
@@ -157,6 +187,45 @@ namespace RangeServer {
                 StaticBuffer &buffer, int32_t flags,
                 DispatchHandler *handler);
 
+    /** Issues a "compare and update" request asynchronously.  The update
+     * buffer holds key/value pairs encoded as for update() and is applied
+     * only if the compare cell identified by <code>row</code>,
+     * <code>column_family</code> and <code>column_qualifier</code> holds
+     * <code>expected_value</code> (or is absent, if
+     * <code>expect_missing</code> is set).  A failed comparison is reported
+     * as Error::RANGESERVER_COMPARE_FAILED.
+     * @param addr address of RangeServer
+     * @param cluster_id Originating cluster ID
+     * @param table table identifier
+     * @param row row key of compare cell
+     * @param column_family column family of compare cell
+     * @param column_qualifier column qualifier of compare cell
+     * @param expect_missing expect the compare cell to be absent
+     * @param expected_value expected value of compare cell
+     * @param count number of key/value pairs in buffer
+     * @param buffer buffer holding key/value pairs
+     * @param flags update flags
+     * @param handler response handler
+     */
+    void compare_and_update(const CommAddress &addr, uint64_t cluster_id,
+                            const TableIdentifier &table, const String &row,
+                            const String &column_family,
+                            const String &column_qualifier,
+                            bool expect_missing, const String &expected_value,
+                            int32_t count, StaticBuffer &buffer, int32_t flags,
+                            DispatchHandler *handler);
+
+    /** Issues a "compare and update" request asynchronously with timer.
+     * @see compare_and_update
+     */
+    void compare_and_update(const CommAddress &addr, uint64_t cluster_id,
+                            const TableIdentifier &table, const String &row,
+                            const String &column_family,
+                            const String &column_qualifier,
+                            bool expect_missing, const String &expected_value,
+                            int32_t count, StaticBuffer &buffer, int32_t flags,
+                            DispatchHandler *handler, Timer &timer);
+
     /** Issues a "create scanner" request asynchronously.
      * @param addr address of RangeServer
      * @param table table identifier
@@ -377,6 +446,15 @@ namespace RangeServer {
 
     void dump(const CommAddress &addr, String &outfile, bool nokeys);
 
+    /** Issues a synchronous "get_live_state" request.  Returns a formatted
+     * report of live server state (block and query cache statistics,
+     * outstanding scanners, maintenance queue backlog and per-range memory
+     * usage) suitable for interactive display.
+     * @param addr address of RangeServer
+     * @param output reference to string filled in with live state report
+     */
+    void get_live_state(const CommAddress &addr, String &output);
+
     /** @deprecated
      */
     void dump_pseudo_table(const CommAddress &addr, const TableIdentifier &table,
@@ -569,6 +647,14 @@ namespace RangeServer {
                            const TableIdentifier &table, const RangeSpec &range,
                            const ScanSpec &scan_spec, ScanBlock &scan_block,
                            int32_t timeout_ms);
+    void do_compare_and_update(const CommAddress &addr, uint64_t cluster_id,
+                               const TableIdentifier &table, const String &row,
+                               const String &column_family,
+                               const String &column_qualifier,
+                               bool expect_missing,
+                               const String &expected_value, int32_t count,
+                               StaticBuffer &buffer, int32_t flags,
+                               DispatchHandler *handler, int32_t timeout_ms);
     void do_destroy_scanner(const CommAddress &addr, int32_t scanner_id,
                             int32_t timeout_ms);
     void do_fetch_scanblock(const CommAddress &addr, int32_t scanner_id,
@@ -586,8 +672,55 @@ namespace RangeServer {
     void send_message(const CommAddress &addr, CommBufPtr &cbp,
                       DispatchHandler *handler, int32_t timeout_ms);
 
+    /** Checks if scan results may be delivered via shared memory.
+     * Shared memory delivery is possible when it has been enabled with the
+     * <code>Hypertable.Client.ShmScanResults</code> property and
+     * <code>addr</code> resolves to an address on the local host.
+     * @param addr address of RangeServer
+     * @return <i>true</i> if shared memory delivery may be requested
+     */
+    bool shm_payload_ok(const CommAddress &addr);
+
+    /** Returns the delay before a hedged read attempt is issued.
+     * The delay is the cached 99th percentile of recently observed read
+     * latencies (see record_read_latency()), falling back to a quarter of
+     * <code>timeout_ms</code> until enough samples have accumulated, and is
+     * clamped to the range [10, <code>timeout_ms</code>/2] milliseconds.
+     * @param timeout_ms Request timeout in milliseconds
+     * @return Hedge delay in milliseconds
+     */
+    int32_t hedge_delay(int32_t timeout_ms);
+
+    /** Records an observed read latency sample.
+     * Samples are kept in a fixed size ring buffer and the 99th percentile
+     * used by hedge_delay() is recomputed periodically, so the hedge delay
+     * adapts to the current latency profile of the servers.
+     * @param latency_ms Observed latency in milliseconds
+     */
+    void record_read_latency(int32_t latency_ms);
+
     Comm *m_comm;
     int32_t m_default_timeout_ms;
+    bool m_shm_scan_results {};
+    uint8_t m_scan_block_format {1};
+
+    /// Flag indicating if hedged reads are enabled
+    bool m_hedged_reads {};
+
+    /// %Mutex protecting the read latency state
+    std::mutex m_latency_mutex;
+
+    /// Ring buffer of recently observed read latencies (milliseconds)
+    std::vector<int32_t> m_latency_samples;
+
+    /// Next slot to overwrite in #m_latency_samples once it is full
+    size_t m_latency_next {};
+
+    /// Samples recorded since the hedge delay was last recomputed
+    size_t m_samples_since_recompute {};
+
+    /// Cached 99th percentile read latency (0 until enough samples)
+    int32_t m_hedge_delay_ms {};
   };
 
   /// Smart pointer to Client
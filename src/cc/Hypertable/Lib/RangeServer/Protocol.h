@@ -85,6 +85,9 @@ namespace RangeServer {
       COMMAND_SET_STATE,
       COMMAND_TABLE_MAINTENANCE_ENABLE,
       COMMAND_TABLE_MAINTENANCE_DISABLE,
+      COMMAND_ADOPT_CELLSTORE,
+      COMMAND_COMPARE_AND_UPDATE,
+      COMMAND_GET_LIVE_STATE,
       COMMAND_MAX
     };
 
@@ -99,7 +102,9 @@ namespace RangeServer {
     enum {
       /* Don't force a commit log sync on update */
       UPDATE_FLAG_NO_LOG_SYNC        = 0x0001,
-      UPDATE_FLAG_NO_LOG             = 0x0004
+      UPDATE_FLAG_NO_LOG             = 0x0004,
+      /* Batch must apply all-or-nothing to a single range */
+      UPDATE_FLAG_ATOMIC             = 0x0008
     };
 
     // Compaction flags
@@ -0,0 +1,169 @@
+/* -*- c++ -*-
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/// @file
+/// Declarations for CompareAndUpdate request parameters.
+/// This file contains declarations for CompareAndUpdate, a class for encoding
+/// and decoding paramters to the <i>compare_and_update</i> %RangeServer
+/// function.
+
+#ifndef Hypertable_Lib_RangeServer_Request_Parameters_CompareAndUpdate_h
+#define Hypertable_Lib_RangeServer_Request_Parameters_CompareAndUpdate_h
+
+#include <Hypertable/Lib/TableIdentifier.h>
+
+#include <Common/Serializable.h>
+
+#include <string>
+
+using namespace std;
+
+namespace Hypertable {
+namespace Lib {
+namespace RangeServer {
+namespace Request {
+namespace Parameters {
+
+  /// @addtogroup libHypertableRangeServerRequestParameters
+  /// @{
+
+  /// %Request parameters for <i>compare_and_update</i> function.
+  class CompareAndUpdate : public Serializable {
+  public:
+
+    /// Constructor.
+    /// Empty initialization for decoding.
+    CompareAndUpdate() {}
+
+    /// Constructor.
+    /// Initializes with parameters for encoding.
+    /// @param cluster_id Cluster ID
+    /// @param table %Table identifier
+    /// @param row Row key of the compare cell
+    /// @param column_family Column family of the compare cell
+    /// @param column_qualifier Column qualifier of the compare cell
+    /// @param expect_missing Expect the compare cell to be absent
+    /// @param expected_value Expected value of the compare cell
+    /// @param count %Update count
+    /// @param flags Flags
+    CompareAndUpdate(uint64_t cluster_id, const TableIdentifier &table,
+                     const string &row, const string &column_family,
+                     const string &column_qualifier, bool expect_missing,
+                     const string &expected_value, int32_t count,
+                     int32_t flags)
+      : m_cluster_id(cluster_id), m_table(table), m_row(row),
+        m_column_family(column_family), m_column_qualifier(column_qualifier),
+        m_expected_value(expected_value), m_expect_missing(expect_missing),
+        m_count(count), m_flags(flags) {}
+
+    /// Gets cluster ID
+    /// @return Cluster ID
+    uint64_t cluster_id() { return m_cluster_id; }
+
+    /// Gets table identifier
+    /// @return %Table identifier
+    const TableIdentifier &table() { return m_table; }
+
+    /// Gets row key of the compare cell
+    /// @return Row key of the compare cell
+    const string &row() { return m_row; }
+
+    /// Gets column family of the compare cell
+    /// @return Column family of the compare cell
+    const string &column_family() { return m_column_family; }
+
+    /// Gets column qualifier of the compare cell
+    /// @return Column qualifier of the compare cell
+    const string &column_qualifier() { return m_column_qualifier; }
+
+    /// Gets expect missing flag
+    /// @return <i>true</i> if the compare cell is expected to be absent
+    bool expect_missing() { return m_expect_missing; }
+
+    /// Gets expected value of the compare cell
+    /// @return Expected value of the compare cell
+    const string &expected_value() { return m_expected_value; }
+
+    /// Gets update count
+    /// @return %Update count
+    int32_t count() { return m_count; }
+
+    /// Gets flags
+    /// @return Flags
+    int32_t flags() { return m_flags; }
+
+  private:
+
+    /// Returns encoding version.
+    /// @return Encoding version
+    uint8_t encoding_version() const override;
+
+    /// Returns internal serialized length.
+    /// @return Internal serialized length
+    /// @see encode_internal() for encoding format
+    size_t encoded_length_internal() const override;
+
+    /// Writes serialized representation of object to a buffer.
+    /// @param bufp Address of destination buffer pointer (advanced by call)
+    void encode_internal(uint8_t **bufp) const override;
+
+    /// Reads serialized representation of object from a buffer.
+    /// @param version Encoding version
+    /// @param bufp Address of destination buffer pointer (advanced by call)
+    /// @param remainp Address of integer holding amount of serialized object
+    /// remaining
+    /// @see encode_internal() for encoding format
+    void decode_internal(uint8_t version, const uint8_t **bufp,
+			 size_t *remainp) override;
+
+    /// Cluster ID
+    uint64_t m_cluster_id {};
+
+    /// %Table identifier
+    TableIdentifier m_table;
+
+    /// Row key of the compare cell
+    string m_row;
+
+    /// Column family of the compare cell
+    string m_column_family;
+
+    /// Column qualifier of the compare cell
+    string m_column_qualifier;
+
+    /// Expected value of the compare cell
+    string m_expected_value;
+
+    /// Expect the compare cell to be absent
+    bool m_expect_missing {};
+
+    /// %Update count
+    int32_t m_count {};
+
+    /// Flags
+    int32_t m_flags {};
+  };
+
+  /// @}
+
+}}}}}
+
+#endif // Hypertable_Lib_RangeServer_Request_Parameters_CompareAndUpdate_h
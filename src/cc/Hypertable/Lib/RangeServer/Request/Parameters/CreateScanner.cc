@@ -35,12 +35,12 @@ using namespace Hypertable;
 using namespace Hypertable::Lib::RangeServer::Request::Parameters;
 
 uint8_t CreateScanner::encoding_version() const {
-  return 1;
+  return 2;
 }
 
 size_t CreateScanner::encoded_length_internal() const {
   return m_table.encoded_length() + m_range_spec.encoded_length() +
-    m_scan_spec.encoded_length();
+    m_scan_spec.encoded_length() + 1;
 }
 
 /// @details
@@ -62,11 +62,16 @@ size_t CreateScanner::encoded_length_internal() const {
 /// <td>ScanSpec</td>
 /// <td>Scan specification</td>
 /// </tr>
+/// <tr>
+/// <td>i8</td>
+/// <td>Requested scan block format version (encoding version 2)</td>
+/// </tr>
 /// </table>
 void CreateScanner::encode_internal(uint8_t **bufp) const {
   m_table.encode(bufp);
   m_range_spec.encode(bufp);
   m_scan_spec.encode(bufp);
+  Serialization::encode_i8(bufp, m_scan_block_format);
 }
 
 void CreateScanner::decode_internal(uint8_t version, const uint8_t **bufp,
@@ -74,6 +79,10 @@ void CreateScanner::decode_internal(uint8_t version, const uint8_t **bufp,
   m_table.decode(bufp, remainp);
   m_range_spec.decode(bufp, remainp);
   m_scan_spec.decode(bufp, remainp);
+  if (version >= 2)
+    m_scan_block_format = Serialization::decode_i8(bufp, remainp);
+  else
+    m_scan_block_format = 1;
 }
 
 
@@ -59,9 +59,11 @@ namespace Parameters {
     /// @param table %Table identifier
     /// @param range_spec %Range specification
     /// @param scan_spec Scan specification
+    /// @param scan_block_format Requested scan block format version
     CreateScanner(const TableIdentifier &table, const RangeSpec &range_spec,
-                  const ScanSpec &scan_spec)
-      : m_table(table), m_range_spec(range_spec), m_scan_spec(scan_spec) {}
+                  const ScanSpec &scan_spec, uint8_t scan_block_format = 1)
+      : m_table(table), m_range_spec(range_spec), m_scan_spec(scan_spec),
+        m_scan_block_format(scan_block_format) {}
 
     /// Gets table identifier
     /// @return %Table identifier
@@ -75,6 +77,10 @@ namespace Parameters {
     /// @return Scan specification
     const ScanSpec &scan_spec() { return m_scan_spec; }
 
+    /// Gets requested scan block format version
+    /// @return Requested scan block format version
+    uint8_t scan_block_format() { return m_scan_block_format; }
+
   private:
 
     /// Returns encoding version.
@@ -108,6 +114,9 @@ namespace Parameters {
     /// Scan specification
     ScanSpec m_scan_spec;
 
+    /// Requested scan block format version
+    uint8_t m_scan_block_format {1};
+
   };
 
   /// @}
@@ -36,11 +36,11 @@ using namespace Hypertable;
 using namespace Hypertable::Lib::RangeServer::Response::Parameters;
 
 uint8_t CreateScanner::encoding_version() const {
-  return 1;
+  return 2;
 }
 
 size_t CreateScanner::encoded_length_internal() const {
-  return 13 + m_profile_data.encoded_length();
+  return 14 + m_profile_data.encoded_length();
 }
 
 /// @details
@@ -70,6 +70,10 @@ size_t CreateScanner::encoded_length_internal() const {
 /// <td>ProfileDataScanner</td>
 /// <td>Profile data</td>
 /// </tr>
+/// <tr>
+/// <td>i8</td>
+/// <td>Scan block format version (encoding version 2)</td>
+/// </tr>
 /// </table>
 void CreateScanner::encode_internal(uint8_t **bufp) const {
   Serialization::encode_i32(bufp, m_id);
@@ -77,6 +81,7 @@ void CreateScanner::encode_internal(uint8_t **bufp) const {
   Serialization::encode_i32(bufp, m_skipped_cells);
   Serialization::encode_bool(bufp, m_more);
   m_profile_data.encode(bufp);
+  Serialization::encode_i8(bufp, m_scan_block_format);
 }
 
 void CreateScanner::decode_internal(uint8_t version, const uint8_t **bufp,
@@ -86,6 +91,10 @@ void CreateScanner::decode_internal(uint8_t version, const uint8_t **bufp,
   m_skipped_cells = Serialization::decode_i32(bufp, remainp);
   m_more = Serialization::decode_bool(bufp, remainp);
   m_profile_data.decode(bufp, remainp);
+  if (version >= 2)
+    m_scan_block_format = Serialization::decode_i8(bufp, remainp);
+  else
+    m_scan_block_format = 1;
 }
 
 
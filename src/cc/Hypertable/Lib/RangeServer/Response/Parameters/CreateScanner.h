@@ -61,10 +61,13 @@ namespace Parameters {
     /// @param skipped_cells Count of cells skipped
     /// @param more Flag indicating more data to follow
     /// @param profile_data Profile data
+    /// @param scan_block_format Scan block format version
     CreateScanner(int32_t id, int32_t skipped_rows, int32_t skipped_cells,
-                  bool more, ProfileDataScanner &profile_data)
+                  bool more, ProfileDataScanner &profile_data,
+                  uint8_t scan_block_format = 1)
       : m_id(id), m_skipped_rows(skipped_rows), m_skipped_cells(skipped_cells),
-        m_more(more), m_profile_data(profile_data) {}
+        m_more(more), m_profile_data(profile_data),
+        m_scan_block_format(scan_block_format) {}
     
     /// Gets scanner ID
     /// @return Scanner ID
@@ -86,6 +89,10 @@ namespace Parameters {
     /// @return <i>more</i> flag
     bool more() { return m_more; }
 
+    /// Gets scan block format version
+    /// @return Scan block format version
+    uint8_t scan_block_format() { return m_scan_block_format; }
+
   private:
 
     /// Returns encoding version.
@@ -125,6 +132,9 @@ namespace Parameters {
     /// Profile data
     ProfileDataScanner m_profile_data;
 
+    /// Scan block format version
+    uint8_t m_scan_block_format {1};
+
   };
 
   /// @}
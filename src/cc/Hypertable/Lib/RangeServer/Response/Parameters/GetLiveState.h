@@ -0,0 +1,97 @@
+/* -*- c++ -*-
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/// @file
+/// Declarations for GetLiveState response parameters.
+/// This file contains declarations for GetLiveState, a class for encoding and
+/// decoding response paramters from the <i>get_live_state</i>
+/// %RangeServer function.
+
+#ifndef Hypertable_Lib_RangeServer_Response_Parameters_GetLiveState_h
+#define Hypertable_Lib_RangeServer_Response_Parameters_GetLiveState_h
+
+#include <Common/Serializable.h>
+
+#include <string>
+
+using namespace std;
+
+namespace Hypertable {
+namespace Lib {
+namespace RangeServer {
+namespace Response {
+namespace Parameters {
+
+  /// @addtogroup libHypertableRangeServerResponseParameters
+  /// @{
+
+  /// %Response parameters for <i>get_live_state</i> requests.
+  class GetLiveState : public Serializable {
+  public:
+
+    /// Constructor.
+    /// Empty initialization for decoding.
+    GetLiveState() {}
+
+    /// Constructor.
+    /// Initializes with parameters for encoding.  Initializes #m_output with
+    /// <code>output</code>.
+    /// @param output Live state report
+    GetLiveState(const string &output) : m_output(output) {}
+
+    /// Gets live state report
+    /// @return Live state report
+    const string &output() const { return m_output; }
+
+  private:
+
+    /// Returns encoding version.
+    /// @return Encoding version
+    uint8_t encoding_version() const override;
+
+    /// Returns internal serialized length.
+    /// @return Internal serialized length
+    /// @see encode_internal() for encoding format
+    size_t encoded_length_internal() const override;
+
+    /// Writes serialized representation of object to a buffer.
+    /// @param bufp Address of destination buffer pointer (advanced by call)
+    void encode_internal(uint8_t **bufp) const override;
+
+    /// Reads serialized representation of object from a buffer.
+    /// @param version Encoding version
+    /// @param bufp Address of destination buffer pointer (advanced by call)
+    /// @param remainp Address of integer holding amount of serialized object
+    /// remaining
+    /// @see encode_internal() for encoding format
+    void decode_internal(uint8_t version, const uint8_t **bufp,
+			 size_t *remainp) override;
+
+    /// Live state report
+    string m_output;
+
+  };
+
+  /// @}
+
+}}}}}
+
+#endif // Hypertable_Lib_RangeServer_Response_Parameters_GetLiveState_h
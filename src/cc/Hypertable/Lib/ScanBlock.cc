@@ -28,7 +28,10 @@
 
 #include "ScanBlock.h"
 
+#include <Hypertable/Lib/Key.h>
+
 #include <AsyncComm/Protocol.h>
+#include <AsyncComm/ShmPayload.h>
 
 #include <Common/Error.h>
 #include <Common/Logger.h>
@@ -44,6 +47,10 @@ ScanBlock::ScanBlock() {
 
 
 int ScanBlock::load(EventPtr &event) {
+
+  if ((m_error = shm_payload_translate(event)) != Error::OK)
+    return m_error;
+
   const uint8_t *decode_ptr = event->payload + 4;
   size_t decode_remain = event->payload_len - 4;
   uint32_t len;
@@ -68,6 +75,17 @@ int ScanBlock::load(EventPtr &event) {
   SerializedKey key;
   ByteString value;
 
+  // Reserve the cell vector from the payload size (heuristic average cell
+  // size) so a typical block is parsed with a single allocation instead of
+  // a reallocation per doubling
+  m_vec.reserve(len / 32 + 8);
+
+  if (m_response.scan_block_format() >= 2) {
+    load_v2(p, endp);
+    m_iter = m_vec.begin();
+    return m_error;
+  }
+
   while (p < endp) {
     key.ptr = p;
     p += key.length();
@@ -81,6 +99,95 @@ int ScanBlock::load(EventPtr &event) {
 }
 
 
+void ScanBlock::load_v2(const uint8_t *p, const uint8_t *endp) {
+  std::vector<std::pair<const uint8_t *, size_t>> dictionary;
+  std::vector<std::pair<size_t, ByteString>> cells;
+  const uint8_t *prev_row = (const uint8_t *)"";
+  size_t prev_row_len = 0;
+  ByteString value;
+
+  m_buffer.clear();
+  // Expanded keys are usually a little larger than their delta encoding;
+  // start with twice the payload so regrowth is rare.  Cells record key
+  // offsets rather than pointers, so regrowth stays safe.
+  m_buffer.ensure(2 * (endp - p));
+  cells.reserve((endp - p) / 32 + 8);
+
+  // Expand each delta-encoded cell back into a format 1 serialized key.
+  // Inline rows and qualifiers reside in the event payload, which outlives
+  // this object, so the previous row and the qualifier dictionary can point
+  // at the payload directly.  Key offsets into m_buffer are recorded and
+  // converted to pointers only after the buffer has reached its final size.
+  while (p < endp) {
+    uint8_t dflags = *p++;
+    uint8_t control = *p++;
+    const uint8_t *row = prev_row;
+    size_t row_len = prev_row_len;
+
+    if ((dflags & ScanBlockFormatV2::ROW_SHARED) == 0) {
+      row = p;
+      row_len = strlen((const char *)p);
+      p += row_len + 1;
+      prev_row = row;
+      prev_row_len = row_len;
+    }
+
+    uint8_t column_family_code = *p++;
+
+    const uint8_t *qualifier;
+    size_t qualifier_len;
+    if (dflags & ScanBlockFormatV2::QUALIFIER_INDEX) {
+      size_t remain = endp - p;
+      uint32_t index = decode_vi32(&p, &remain);
+      HT_ASSERT(index < dictionary.size());
+      qualifier = dictionary[index].first;
+      qualifier_len = dictionary[index].second;
+    }
+    else {
+      qualifier = p;
+      qualifier_len = strlen((const char *)p);
+      p += qualifier_len + 1;
+      if (qualifier_len >= ScanBlockFormatV2::DICTIONARY_MIN_QUALIFIER_LENGTH
+          && dictionary.size() < ScanBlockFormatV2::DICTIONARY_MAX_ENTRIES)
+        dictionary.push_back(std::make_pair(qualifier, qualifier_len));
+    }
+
+    uint8_t flag = *p++;
+
+    size_t trailing_len = 0;
+    if (control & Key::HAVE_TIMESTAMP)
+      trailing_len += 8;
+    if ((control & Key::HAVE_REVISION) && (control & Key::REV_IS_TS) == 0)
+      trailing_len += 8;
+    const uint8_t *trailing = p;
+    p += trailing_len;
+
+    size_t key_len = row_len + qualifier_len + 5 + trailing_len;
+    m_buffer.ensure(5 + key_len);
+    cells.push_back(std::make_pair(m_buffer.fill(), ByteString()));
+    encode_vi32(&m_buffer.ptr, key_len);
+    *m_buffer.ptr++ = control;
+    m_buffer.add_unchecked(row, row_len);
+    *m_buffer.ptr++ = 0;
+    *m_buffer.ptr++ = column_family_code;
+    m_buffer.add_unchecked(qualifier, qualifier_len);
+    *m_buffer.ptr++ = 0;
+    *m_buffer.ptr++ = flag;
+    m_buffer.add_unchecked(trailing, trailing_len);
+
+    value.ptr = p;
+    p += value.length();
+    cells.back().second = value;
+  }
+
+  SerializedKey key;
+  for (auto &cell : cells) {
+    key.ptr = m_buffer.base + cell.first;
+    m_vec.push_back(std::make_pair(key, cell.second));
+  }
+}
+
+
 bool ScanBlock::next(SerializedKey &key, ByteString &value) {
 
   assert(m_error == Error::OK);
@@ -33,6 +33,7 @@
 #include <AsyncComm/Event.h>
 
 #include <Common/ByteString.h>
+#include <Common/DynamicBuffer.h>
 
 #include <memory>
 #include <vector>
@@ -42,6 +43,26 @@ namespace Hypertable {
   /// @addtogroup libHypertable
   /// @{
 
+  /** Constants for the delta-encoded (version 2) scan block format.  In
+   * format 2 each cell begins with a <i>delta flags</i> byte instead of the
+   * format 1 length-prefixed serialized key.  Cells sharing the row of the
+   * preceding cell omit the row, and column qualifiers that repeat within a
+   * block are replaced by an index into a dictionary that both sides build
+   * deterministically from the inline qualifiers seen so far.
+   */
+  namespace ScanBlockFormatV2 {
+    /// Cell shares the row of the preceding cell
+    const uint8_t ROW_SHARED = 0x01;
+    /// Column qualifier is encoded as a dictionary index
+    const uint8_t QUALIFIER_INDEX = 0x02;
+    /// Minimum qualifier length admitted to the dictionary (shorter
+    /// qualifiers are always inlined so a format 2 cell never exceeds its
+    /// format 1 encoding)
+    const size_t DICTIONARY_MIN_QUALIFIER_LENGTH = 3;
+    /// Maximum number of dictionary entries per block
+    const size_t DICTIONARY_MAX_ENTRIES = 65536;
+  }
+
   /** Encapsulates a block of scan results.  The CREATE_SCANNER and
    * FETCH_SCANBLOCK RangeServer methods return a block of scan results
    * and this class parses and provides easy access to the key/value
@@ -119,11 +140,22 @@ namespace Hypertable {
     const ProfileDataScanner &profile_data() { return m_response.profile_data(); }
 
   private:
+
+    /** Expands a format 2 (delta-encoded) scanblock into format 1 serialized
+     * keys held in #m_buffer and populates #m_vec.  Values continue to point
+     * into the event payload.
+     * @param p Pointer to start of encoded key/value data
+     * @param endp Pointer to end of encoded key/value data
+     */
+    void load_v2(const uint8_t *p, const uint8_t *endp);
+
     int m_error {};
     Vector m_vec;
     Vector::iterator m_iter;
     EventPtr m_event;
     Lib::RangeServer::Response::Parameters::CreateScanner m_response;
+    /// Holds serialized keys rebuilt from a format 2 scanblock
+    DynamicBuffer m_buffer;
   };
 
   /// Smart pointer to ScanBlock.
@@ -25,6 +25,7 @@
 
 #include <Hypertable/Lib/KeySpec.h>
 
+#include <Common/Regex.h>
 #include <Common/Serialization.h>
 
 #include <boost/algorithm/string.hpp>
@@ -37,7 +38,7 @@ using namespace Hypertable::Lib;
 using namespace std;
 
 uint8_t ScanSpec::encoding_version() const {
-  return 1;
+  return 4;
 }
 
 size_t ScanSpec::encoded_length_internal() const {
@@ -51,8 +52,10 @@ size_t ScanSpec::encoded_length_internal() const {
     Serialization::encoded_length_vi32(row_intervals.size()) +
     Serialization::encoded_length_vi32(cell_intervals.size()) +
     Serialization::encoded_length_vi32(column_predicates.size()) +
+    Serialization::encoded_length_vi32(block_sample_period) +
     Serialization::encoded_length_vstr(row_regexp) +
     Serialization::encoded_length_vstr(value_regexp) +
+    Serialization::encoded_length_vstr(resume_cursor_len) +
     rebuild_indices.encoded_length();
   for (auto c : columns)
     len += Serialization::encoded_length_vstr(c);
@@ -62,7 +65,7 @@ size_t ScanSpec::encoded_length_internal() const {
     len += ci.encoded_length();
   for (auto &cp : column_predicates)
     len += cp.encoded_length();
-  return len + 8 + 8 + 5;
+  return len + 8 + 8 + 6;
 }
 
 /// @details
@@ -97,6 +100,9 @@ size_t ScanSpec::encoded_length_internal() const {
 /// <tr><td>bool</td><td><i>scan and filter rows</i> flag</td></tr>
 /// <tr><td>bool</td><td><i>do not cache</i> flag</td></tr>
 /// <tr><td>bool</td><td><i>and column predicates</i> flag</td></tr>
+/// <tr><td>i8</td><td>Aggregation operator</td></tr>
+/// <tr><td>i32</td><td>Block sample period</td></tr>
+/// <tr><td>vstr</td><td>Resume cursor (serialized key)</td></tr>
 /// </table>
 void ScanSpec::encode_internal(uint8_t **bufp) const {
   Serialization::encode_vi32(bufp, row_offset);
@@ -122,6 +128,9 @@ void ScanSpec::encode_internal(uint8_t **bufp) const {
   Serialization::encode_bool(bufp, scan_and_filter_rows);
   Serialization::encode_bool(bufp, do_not_cache);
   Serialization::encode_bool(bufp, and_column_predicates);
+  Serialization::encode_i8(bufp, aggregation);
+  Serialization::encode_vi32(bufp, block_sample_period);
+  Serialization::encode_vstr(bufp, resume_cursor, resume_cursor_len);
   rebuild_indices.encode(bufp);
 }
 
@@ -160,6 +169,16 @@ void ScanSpec::decode_internal(uint8_t version, const uint8_t **bufp,
          scan_and_filter_rows = Serialization::decode_bool(bufp, remainp);
          do_not_cache = Serialization::decode_bool(bufp, remainp);
          and_column_predicates = Serialization::decode_bool(bufp, remainp);
+         if (version >= 2)
+           aggregation = Serialization::decode_i8(bufp, remainp);
+         if (version >= 3)
+           block_sample_period = Serialization::decode_vi32(bufp, remainp);
+         if (version >= 4) {
+           resume_cursor = (const uint8_t *)
+             Serialization::decode_vstr(bufp, remainp, &resume_cursor_len);
+           if (resume_cursor_len == 0)
+             resume_cursor = 0;
+         }
          rebuild_indices.decode(bufp, remainp));
 }
 
@@ -380,6 +399,12 @@ ostream &Hypertable::Lib::operator<<(ostream &os, const ScanSpec &scan_spec) {
   if (scan_spec.and_column_predicates)
     os << " and_column_predicates";
 
+  if (scan_spec.aggregation)
+    os << " aggregation=" << (int)scan_spec.aggregation;
+
+  if (scan_spec.block_sample_period)
+    os << " block_sample_period=" << scan_spec.block_sample_period;
+
   if (scan_spec.rebuild_indices)
     os << " rebuild_indices=" << scan_spec.rebuild_indices.to_string();
 
@@ -402,7 +427,13 @@ ScanSpec::ScanSpec(CharArena &arena, const ScanSpec &ss)
     return_deletes(ss.return_deletes), keys_only(ss.keys_only),
     scan_and_filter_rows(ss.scan_and_filter_rows),
     do_not_cache(ss.do_not_cache), and_column_predicates(ss.and_column_predicates),
+    aggregation(ss.aggregation), block_sample_period(ss.block_sample_period),
     rebuild_indices(ss.rebuild_indices) {
+  if (ss.resume_cursor) {
+    resume_cursor =
+      (const uint8_t *)arena.dup(ss.resume_cursor, ss.resume_cursor_len);
+    resume_cursor_len = ss.resume_cursor_len;
+  }
   columns.reserve(ss.columns.size());
   row_intervals.reserve(ss.row_intervals.size());
   cell_intervals.reserve(ss.cell_intervals.size());
@@ -424,8 +455,49 @@ ScanSpec::ScanSpec(CharArena &arena, const ScanSpec &ss)
                          cp.operation, cp.value, cp.value_len);
 }
 
+void ScanSpec::optimize_row_regexp(CharArena &arena) {
+  const char *prefix;
+  size_t prefix_len;
+  DynamicBuffer buf;
+
+  if (row_regexp == 0 || *row_regexp == 0 ||
+      !row_intervals.empty() || !cell_intervals.empty())
+    return;
+
+  if (!Regex::extract_prefix(row_regexp, strlen(row_regexp),
+                             &prefix, &prefix_len, buf) || prefix_len == 0)
+    return;
+
+  RowInterval ri;
+  char *start = (char *)arena.alloc(prefix_len+1);
+  memcpy(start, prefix, prefix_len);
+  start[prefix_len] = '\0';
+  ri.start = start;
+  ri.start_inclusive = true;
+
+  // End row is the successor of the prefix:  increment the last byte that
+  // can be incremented and truncate the rest
+  const char *ptr;
+  for (ptr = prefix + (prefix_len-1); ptr >= prefix; --ptr) {
+    if (::uint8_t(*ptr) < 0xffu) {
+      string end(prefix, ptr-prefix);
+      end.append(1, (*ptr) + 1);
+      ri.end = arena.dup(end);
+      ri.end_inclusive = false;
+      break;
+    }
+  }
+  if (ptr < prefix) {
+    // prefix is all 0xff bytes; leave the interval open-ended
+    ri.end = Key::END_ROW_MARKER;
+    ri.end_inclusive = false;
+  }
+
+  row_intervals.push_back(ri);
+}
+
 void
-ScanSpec::parse_column(const char *column_str, string &family, 
+ScanSpec::parse_column(const char *column_str, string &family,
                        const char **qualifier, size_t *qualifier_len,
                        bool *has_qualifier, bool *is_regexp, bool *is_prefix)
 {
@@ -55,6 +55,17 @@ namespace Lib {
   /// Scan predicate and control specification.
   class ScanSpec : public Serializable {
   public:
+
+    /// Server-side aggregation operators (see #aggregation).
+    enum Aggregation {
+      AGGREGATION_NONE = 0,
+      AGGREGATION_COUNT = 1,
+      AGGREGATION_COUNT_ROWS = 2,
+      AGGREGATION_SUM = 3,
+      AGGREGATION_MIN = 4,
+      AGGREGATION_MAX = 5
+    };
+
     ScanSpec() : time_interval(TIMESTAMP_MIN, TIMESTAMP_MAX) { }
     ScanSpec(CharArena &arena)
       : columns(CstrAlloc(arena)),
@@ -91,6 +102,10 @@ namespace Lib {
       scan_and_filter_rows = false;
       do_not_cache = false;
       and_column_predicates = false;
+      aggregation = AGGREGATION_NONE;
+      block_sample_period = 0;
+      resume_cursor = 0;
+      resume_cursor_len = 0;
     }
 
     /// Initialize another ScanSpec object with this copy sans the intervals.
@@ -117,11 +132,13 @@ namespace Lib {
       other.do_not_cache = do_not_cache;
       other.column_predicates = column_predicates;
       other.and_column_predicates = and_column_predicates;
+      other.aggregation = aggregation;
+      other.block_sample_period = block_sample_period;
       other.rebuild_indices = rebuild_indices;
     }
 
     bool cacheable() const {
-      if (do_not_cache || rebuild_indices)
+      if (do_not_cache || rebuild_indices || aggregation != AGGREGATION_NONE)
         return false;
       else if (row_intervals.size() == 1) {
         HT_ASSERT(row_intervals[0].start && row_intervals[0].end);
@@ -187,6 +204,19 @@ namespace Lib {
       value_regexp = arena.dup(regexp);
     }
 
+    /** Derives a row interval from an anchored #row_regexp.
+     * If #row_regexp begins with the '^' character followed by a literal
+     * prefix (see Regex::extract_prefix) and neither row nor cell intervals
+     * have been specified, this method adds a row interval covering exactly
+     * the rows that start with the prefix, so the scan is dispatched only to
+     * the ranges that can contain matching rows instead of broadcasting to
+     * every range of the table.  #row_regexp is left in place and is still
+     * applied by the RangeServers.  Non-anchored regexps and scan
+     * specifications that already contain intervals are left untouched.
+     * @param arena Memory arena from which interval strings are allocated
+     */
+    void optimize_row_regexp(CharArena &arena);
+
     void add_row_interval(CharArena &arena,
                           const string &start, bool start_inclusive,
                           const string &end, bool end_inclusive) {
@@ -283,6 +313,22 @@ namespace Lib {
     bool scan_and_filter_rows {};
     bool do_not_cache {};
     bool and_column_predicates {};
+    /// Aggregation operator (see Aggregation) evaluated by the RangeServer
+    /// over the cells matching the scan; the scan then returns a single
+    /// aggregate cell per range instead of the cell stream
+    uint8_t aggregation {};
+    /// Block sampling period; when greater than 1, the RangeServer visits
+    /// only every Nth CellStore block of the scanned interval, so the scan
+    /// returns an approximate row sample at roughly 1/N of the I/O cost
+    int32_t block_sample_period {};
+    /// Resume cursor; serialized key (see SerializedKey) of the last cell
+    /// already delivered to the application.  When set, the RangeServer
+    /// returns only cells that sort strictly after this key, allowing an
+    /// interrupted scan to resume where it left off instead of re-scanning
+    /// the interval from the beginning
+    const uint8_t *resume_cursor {};
+    /// Length of #resume_cursor in bytes
+    uint32_t resume_cursor_len {};
     TableParts rebuild_indices;
 
   private:
@@ -400,6 +446,14 @@ namespace Lib {
      */
     void set_value_regexp(const char* regexp) { m_scan_spec.set_value_regexp(m_arena, regexp); }
 
+    /**
+     * Converts an anchored row regexp into a row interval.
+     * Should be called after the scan specification has been fully
+     * populated and before it is passed to Table::create_scanner (see
+     * ScanSpec::optimize_row_regexp).
+     */
+    void optimize_row_regexp() { m_scan_spec.optimize_row_regexp(m_arena); }
+
     /**
      * Adds a column family to be returned by the scan.
      *
@@ -549,6 +603,51 @@ namespace Lib {
       m_scan_spec.and_column_predicates = val;
     }
 
+    /**
+     * Requests server-side aggregation of the scan.  Instead of streaming
+     * the matching cells back, each RangeServer reduces them to a single
+     * cell holding the ASCII-encoded aggregate (cell count, distinct row
+     * count, sum, minimum or maximum of the cell values).  SUM, MIN and MAX
+     * interpret counter column values natively and other values as ASCII
+     * numbers.  A scan spanning multiple ranges returns one partial
+     * aggregate cell per range; the caller combines them (COUNT and SUM by
+     * adding, MIN and MAX by comparing).
+     *
+     * @param aggregation one of the ScanSpec::Aggregation operators
+     */
+    void set_aggregation(uint8_t aggregation) {
+      m_scan_spec.aggregation = aggregation;
+    }
+
+    /**
+     * Requests block-level row sampling.  The RangeServers visit only every
+     * <code>period</code>'th CellStore block of the scanned row interval,
+     * returning the rows those blocks contain, so a sample of a large table
+     * costs roughly 1/<code>period</code> of the scan I/O.  The sample is
+     * approximate:  cells resident only in the in-memory cell cache are all
+     * returned, and deletes recorded in skipped blocks are not applied.
+     * Intended for statistics gathering and UI previews.
+     *
+     * @param period sampling period (values less than 2 disable sampling)
+     */
+    void set_block_sample_period(int32_t period) {
+      m_scan_spec.block_sample_period = period;
+    }
+
+    /**
+     * Sets the resume cursor to the serialized key of the last cell already
+     * delivered to the application.  The servers will deliver only cells
+     * that sort strictly after this key, so a scan that was interrupted
+     * (e.g. by a RangeServer restart) resumes exactly where it left off.
+     *
+     * @param cursor serialized key of last delivered cell
+     * @param len length of <code>cursor</code> in bytes
+     */
+    void set_resume_cursor(const void *cursor, uint32_t len) {
+      m_scan_spec.resume_cursor = (const uint8_t *)m_arena.dup(cursor, len);
+      m_scan_spec.resume_cursor_len = len;
+    }
+
     /**
      * Clears the state.
      */
@@ -30,6 +30,7 @@
 #include <Common/Config.h>
 #include <Common/FileUtils.h>
 #include <Common/Logger.h>
+#include <Common/Serialization.h>
 #include <Common/StringExt.h>
 #include <Common/System.h>
 #include <Common/XmlParser.h>
@@ -84,6 +85,12 @@ Schema::Schema(const Schema &other)
   m_generation = other.m_generation;
   m_version = other.m_version;
   m_group_commit_interval = other.m_group_commit_interval;
+  m_deferred_log_sync = other.m_deferred_log_sync;
+  m_query_cache_ttl = other.m_query_cache_ttl;
+  m_query_cache_disabled = other.m_query_cache_disabled;
+  m_query_cache_max_entry_size = other.m_query_cache_max_entry_size;
+  m_split_size = other.m_split_size;
+  m_split_size_adaptive = other.m_split_size_adaptive;
 
   // Create access groups
   for (auto src_ag : other.m_access_groups) {
@@ -108,6 +115,8 @@ Schema::Schema(const Schema &other)
       ag->set_default_time_order_desc(src_ag->get_default_time_order_desc());
     if (src_ag->defaults().is_set_counter())
       ag->set_default_counter(src_ag->get_default_counter());
+    if (src_ag->defaults().is_set_value_dictionary())
+      ag->set_default_value_dictionary(src_ag->get_default_value_dictionary());
 
     ag->set_generation(src_ag->get_generation());
 
@@ -150,6 +159,18 @@ namespace {
             m_schema->set_version(content_to_i32(atts[i], atts[i+1]));
           else if (!strcasecmp(atts[i], "group_commit_interval"))
             m_schema->set_group_commit_interval(content_to_i32(atts[i], atts[i+1]));
+          else if (!strcasecmp(atts[i], "deferred_log_sync"))
+            m_schema->set_deferred_log_sync(content_to_bool(atts[i], atts[i+1]));
+          else if (!strcasecmp(atts[i], "query_cache_ttl"))
+            m_schema->set_query_cache_ttl(content_to_i32(atts[i], atts[i+1]));
+          else if (!strcasecmp(atts[i], "query_cache_disabled"))
+            m_schema->set_query_cache_disabled(content_to_bool(atts[i], atts[i+1]));
+          else if (!strcasecmp(atts[i], "query_cache_max_entry_size"))
+            m_schema->set_query_cache_max_entry_size(content_to_i64(atts[i], atts[i+1]));
+          else if (!strcasecmp(atts[i], "split_size"))
+            m_schema->set_split_size(content_to_i64(atts[i], atts[i+1]));
+          else if (!strcasecmp(atts[i], "split_size_adaptive"))
+            m_schema->set_split_size_adaptive(content_to_bool(atts[i], atts[i+1]));
           else if (!strcasecmp(atts[i], "compressor"))
             m_schema->access_group_defaults().set_compressor(atts[i+1]);
           else
@@ -158,7 +179,13 @@ namespace {
         }
       }
       else if (strcasecmp(name, "Generation") &&
-               strcasecmp(name, "GroupCommitInterval"))
+               strcasecmp(name, "GroupCommitInterval") &&
+               strcasecmp(name, "DeferredLogSync") &&
+               strcasecmp(name, "QueryCacheTTL") &&
+               strcasecmp(name, "QueryCacheDisabled") &&
+               strcasecmp(name, "QueryCacheMaxEntrySize") &&
+               strcasecmp(name, "SplitSize") &&
+               strcasecmp(name, "SplitSizeAdaptive"))
         HT_THROWF(Error::SCHEMA_PARSE_ERROR,
                   "Unrecognized Schema element (%s)", name);
     }
@@ -168,6 +195,18 @@ namespace {
         m_schema->set_generation(content_to_i64(name, content));
       else if (!strcasecmp(name, "GroupCommitInterval"))
         m_schema->set_group_commit_interval(content_to_i32(name, content));
+      else if (!strcasecmp(name, "DeferredLogSync"))
+        m_schema->set_deferred_log_sync(content_to_bool(name, content));
+      else if (!strcasecmp(name, "QueryCacheTTL"))
+        m_schema->set_query_cache_ttl(content_to_i32(name, content));
+      else if (!strcasecmp(name, "QueryCacheDisabled"))
+        m_schema->set_query_cache_disabled(content_to_bool(name, content));
+      else if (!strcasecmp(name, "QueryCacheMaxEntrySize"))
+        m_schema->set_query_cache_max_entry_size(content_to_i64(name, content));
+      else if (!strcasecmp(name, "SplitSize"))
+        m_schema->set_split_size(content_to_i64(name, content));
+      else if (!strcasecmp(name, "SplitSizeAdaptive"))
+        m_schema->set_split_size_adaptive(content_to_bool(name, content));
       else if (!m_element_stack.empty())
         HT_THROWF(Error::SCHEMA_PARSE_ERROR,
                   "Unrecognized Schema element (%s)", name);
@@ -213,6 +252,19 @@ Schema *Schema::new_instance(const string &buf) {
   return schema;
 }
 
+Schema *Schema::new_instance(const uint8_t *buf, size_t len) {
+  Schema *schema = new Schema();
+  try {
+    schema->decode(&buf, &len);
+    schema->validate();
+  }
+  catch (Exception &) {
+    delete schema;
+    throw;
+  }
+  return schema;
+}
+
 void Schema::clear_generation() {
   m_generation = 0;
   for (auto ag : m_access_groups)
@@ -274,6 +326,25 @@ const string Schema::render_xml(bool with_ids) {
   if (m_group_commit_interval > 0)
     output += format("  <GroupCommitInterval>%u</GroupCommitInterval>\n", m_group_commit_interval);
 
+  if (m_deferred_log_sync)
+    output += "  <DeferredLogSync>true</DeferredLogSync>\n";
+
+  if (m_query_cache_ttl > 0)
+    output += format("  <QueryCacheTTL>%u</QueryCacheTTL>\n", m_query_cache_ttl);
+
+  if (m_query_cache_disabled)
+    output += "  <QueryCacheDisabled>true</QueryCacheDisabled>\n";
+
+  if (m_query_cache_max_entry_size > 0)
+    output += format("  <QueryCacheMaxEntrySize>%lld</QueryCacheMaxEntrySize>\n",
+                     (Lld)m_query_cache_max_entry_size);
+
+  if (m_split_size > 0)
+    output += format("  <SplitSize>%lld</SplitSize>\n", (Lld)m_split_size);
+
+  if (m_split_size_adaptive)
+    output += "  <SplitSizeAdaptive>true</SplitSizeAdaptive>\n";
+
   output += "  <AccessGroupDefaults>\n";
   output += m_ag_defaults.render_xml("    ");
   output += "  </AccessGroupDefaults>\n";
@@ -314,6 +385,25 @@ const string Schema::render_hql(const string &table_name) {
   if (m_group_commit_interval > 0)
     output += format(" GROUP_COMMIT_INTERVAL %u", m_group_commit_interval);
 
+  if (m_deferred_log_sync)
+    output += " DEFERRED_LOG_SYNC";
+
+  if (m_query_cache_ttl > 0)
+    output += format(" QUERY_CACHE_TTL %u", m_query_cache_ttl);
+
+  if (m_query_cache_disabled)
+    output += " QUERY_CACHE_DISABLED";
+
+  if (m_query_cache_max_entry_size > 0)
+    output += format(" QUERY_CACHE_MAX_ENTRY_SIZE %lld",
+                     (Lld)m_query_cache_max_entry_size);
+
+  if (m_split_size > 0)
+    output += format(" SPLIT_SIZE %lld", (Lld)m_split_size);
+
+  if (m_split_size_adaptive)
+    output += " SPLIT_SIZE_ADAPTIVE";
+
   output += m_ag_defaults.render_hql();
   output += m_cf_defaults.render_hql();
   return output;
@@ -556,3 +646,76 @@ void Schema::merge_table_defaults(AccessGroupSpec *ag_spec) {
               ag_spec->get_name().c_str(), e.what());
   }
 }
+
+uint8_t Schema::encoding_version() const {
+  return 2;
+}
+
+size_t Schema::encoded_length_internal() const {
+  size_t length = 35 + m_ag_defaults.encoded_length() +
+    m_cf_defaults.encoded_length();
+  for (auto ag_spec : m_access_groups)
+    length += ag_spec->encoded_length();
+  return length;
+}
+
+/// @details
+/// Encoding is as follows:
+/// <table>
+/// <tr><th>Encoding</th><th>Description</th></tr>
+/// <tr><td>i64</td><td>Generation</td></tr>
+/// <tr><td>i32</td><td>Version number</td></tr>
+/// <tr><td>i32</td><td>Group commit interval</td></tr>
+/// <tr><td>bool</td><td>Deferred log sync flag</td></tr>
+/// <tr><td>i32</td><td>Query cache TTL</td></tr>
+/// <tr><td>bool</td><td>Query cache disabled flag</td></tr>
+/// <tr><td>i64</td><td>Query cache maximum entry size</td></tr>
+/// <tr><td>i64</td><td>Split size (version 2 and later)</td></tr>
+/// <tr><td>bool</td><td>Split size adaptive flag (version 2 and
+/// later)</td></tr>
+/// <tr><td>AccessGroupOptions</td><td>Access group defaults</td></tr>
+/// <tr><td>ColumnFamilyOptions</td><td>Column family defaults</td></tr>
+/// <tr><td>i32</td><td>Access group count</td></tr>
+/// <tr><td>For each access group ...</td><td></td></tr>
+/// <tr><td>AccessGroupSpec</td><td>Access group specification</td></tr>
+/// </table>
+void Schema::encode_internal(uint8_t **bufp) const {
+  Serialization::encode_i64(bufp, m_generation);
+  Serialization::encode_i32(bufp, m_version);
+  Serialization::encode_i32(bufp, m_group_commit_interval);
+  Serialization::encode_bool(bufp, m_deferred_log_sync);
+  Serialization::encode_i32(bufp, m_query_cache_ttl);
+  Serialization::encode_bool(bufp, m_query_cache_disabled);
+  Serialization::encode_i64(bufp, m_query_cache_max_entry_size);
+  Serialization::encode_i64(bufp, m_split_size);
+  Serialization::encode_bool(bufp, m_split_size_adaptive);
+  m_ag_defaults.encode(bufp);
+  m_cf_defaults.encode(bufp);
+  Serialization::encode_i32(bufp, m_access_groups.size());
+  for (auto ag_spec : m_access_groups)
+    ag_spec->encode(bufp);
+}
+
+void Schema::decode_internal(uint8_t version, const uint8_t **bufp,
+                             size_t *remainp) {
+  m_generation = Serialization::decode_i64(bufp, remainp);
+  m_version = Serialization::decode_i32(bufp, remainp);
+  m_group_commit_interval = Serialization::decode_i32(bufp, remainp);
+  m_deferred_log_sync = Serialization::decode_bool(bufp, remainp);
+  m_query_cache_ttl = Serialization::decode_i32(bufp, remainp);
+  m_query_cache_disabled = Serialization::decode_bool(bufp, remainp);
+  m_query_cache_max_entry_size = Serialization::decode_i64(bufp, remainp);
+  if (version >= 2) {
+    m_split_size = Serialization::decode_i64(bufp, remainp);
+    m_split_size_adaptive = Serialization::decode_bool(bufp, remainp);
+  }
+  m_ag_defaults.decode(bufp, remainp);
+  m_cf_defaults.decode(bufp, remainp);
+  int32_t count = Serialization::decode_i32(bufp, remainp);
+  while (count-- > 0) {
+    AccessGroupSpec *ag_spec = new AccessGroupSpec();
+    try { ag_spec->decode(bufp, remainp); }
+    catch (Exception &) { delete ag_spec; throw; }
+    add_access_group(ag_spec);
+  }
+}
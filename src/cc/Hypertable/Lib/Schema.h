@@ -27,8 +27,10 @@
 #ifndef Hypertable_Lib_Schema_h
 #define Hypertable_Lib_Schema_h
 
+#include <Common/FlyweightString.h>
 #include <Common/Properties.h>
 #include "Common/PageArenaAllocator.h"
+#include <Common/Serializable.h>
 #include <Common/StringExt.h>
 
 #include <Hypertable/Lib/AccessGroupSpec.h>
@@ -40,6 +42,7 @@
 #include <bitset>
 #include <list>
 #include <memory>
+#include <mutex>
 #include <unordered_map>
 #include <vector>
 
@@ -49,7 +52,7 @@ namespace Hypertable {
   /// @{
 
   /// %Schema specification.
-  class Schema {
+  class Schema : public Serializable {
   public:
 
     /// Default constructor.
@@ -269,6 +272,19 @@ namespace Hypertable {
       return nullptr;
     }
 
+    /// Returns a schema-lifetime interned copy of <code>str</code>.
+    /// Scan setup uses this to avoid copying the low cardinality strings
+    /// that accompany every scan (column specifications and family names)
+    /// into per-scan storage; repeat scans hit the interned set and
+    /// allocate nothing.  The returned pointer remains valid as long as
+    /// this schema object (one table generation).  Thread-safe.
+    /// @param str String to intern
+    /// @return Interned copy of <code>str</code>
+    const char *intern(const char *str) {
+      std::lock_guard<std::mutex> lock(m_intern_mutex);
+      return m_intern_strings.get(str);
+    }
+
     /// Removes column family.
     /// Removes column family named <code>name</code> from #m_column_family_map.
     /// If column family ID is non-zero, then the column family is removed from
@@ -369,6 +385,93 @@ namespace Hypertable {
     /// @return Group commit interval
     int32_t get_group_commit_interval() { return m_group_commit_interval; }
 
+    /// Sets deferred log sync flag.
+    /// Sets #m_deferred_log_sync to <code>value</code>.
+    /// @param value New value for deferred log sync flag
+    void set_deferred_log_sync(bool value) {
+      m_deferred_log_sync = value;
+    }
+
+    /// Gets deferred log sync flag.
+    /// When set, the range server acknowledges updates to this table after
+    /// cell cache insertion, without waiting for a commit log sync; the sync
+    /// happens in a subsequent batch, so a server crash can lose the most
+    /// recently acknowledged updates.
+    /// @return <i>true</i> if commit log syncs are deferred for this table
+    bool get_deferred_log_sync() { return m_deferred_log_sync; }
+
+    /// Sets query cache TTL.
+    /// Sets #m_query_cache_ttl to <code>ttl</code>
+    /// @param ttl New query cache TTL in seconds (0 implies no expiration)
+    void set_query_cache_ttl(int32_t ttl) {
+      m_query_cache_ttl = ttl;
+    }
+
+    /// Gets query cache TTL.
+    /// Query results for this table cached by the range server query cache
+    /// expire this many seconds after insertion; 0 implies no expiration.
+    /// @return Query cache TTL in seconds
+    int32_t get_query_cache_ttl() { return m_query_cache_ttl; }
+
+    /// Sets query cache disabled flag.
+    /// Sets #m_query_cache_disabled to <code>value</code>
+    /// @param value New value for query cache disabled flag
+    void set_query_cache_disabled(bool value) {
+      m_query_cache_disabled = value;
+    }
+
+    /// Gets query cache disabled flag.
+    /// When set, query results for this table are never admitted to the
+    /// range server query cache, dedicating the cache to other tables.
+    /// @return <i>true</i> if query caching is disabled for this table
+    bool get_query_cache_disabled() { return m_query_cache_disabled; }
+
+    /// Sets query cache maximum entry size.
+    /// Sets #m_query_cache_max_entry_size to <code>size</code>
+    /// @param size Maximum cacheable result size in bytes (0 implies no
+    /// table-specific limit)
+    void set_query_cache_max_entry_size(int64_t size) {
+      m_query_cache_max_entry_size = size;
+    }
+
+    /// Gets query cache maximum entry size.
+    /// Query results for this table larger than this many bytes are not
+    /// admitted to the range server query cache; 0 implies no
+    /// table-specific limit.
+    /// @return Maximum cacheable result size in bytes
+    int64_t get_query_cache_max_entry_size() {
+      return m_query_cache_max_entry_size;
+    }
+
+    /// Sets split size.
+    /// Sets #m_split_size to <code>size</code>
+    /// @param size New split size in bytes (0 implies the
+    /// <code>Hypertable.RangeServer.Range.SplitSize</code> server default)
+    void set_split_size(int64_t size) {
+      m_split_size = size;
+    }
+
+    /// Gets split size.
+    /// Ranges of this table split when their disk usage reaches this many
+    /// bytes; 0 implies the
+    /// <code>Hypertable.RangeServer.Range.SplitSize</code> server default.
+    /// @return Split size in bytes
+    int64_t get_split_size() { return m_split_size; }
+
+    /// Sets split size adaptive flag.
+    /// Sets #m_split_size_adaptive to <code>value</code>
+    /// @param value New value for split size adaptive flag
+    void set_split_size_adaptive(bool value) {
+      m_split_size_adaptive = value;
+    }
+
+    /// Gets split size adaptive flag.
+    /// When set, the range server scales each range's split threshold by
+    /// its observed growth velocity, so fast-growing ranges split earlier
+    /// and static ranges defer splitting.
+    /// @return <i>true</i> if split thresholds adapt to growth velocity
+    bool get_split_size_adaptive() { return m_split_size_adaptive; }
+
     /// Sets default access group options.
     /// Sets #m_ag_defaults to <code>defaults</code>
     /// @param defaults Access group options to use as table defaults
@@ -409,6 +512,40 @@ namespace Hypertable {
     /// @return Pointer to newly allocated Schema object.
     static Schema *new_instance(const std::string &buf);
 
+    /// Creates schema object from binary schema encoding.
+    /// Constructs a new schema by decoding the binary encoding produced by
+    /// encode() and then calls validate().  The binary encoding is a compact
+    /// alternative to the XML representation that avoids the XML parse on hot
+    /// paths (e.g. range server recovery and client table opens).
+    /// @param buf Buffer holding binary schema encoding.
+    /// @param len Length of binary schema encoding.
+    /// @return Pointer to newly allocated Schema object.
+    static Schema *new_instance(const uint8_t *buf, size_t len);
+
+  protected:
+
+    /// Returns encoding version.
+    /// @return Encoding version
+    uint8_t encoding_version() const override;
+
+    /// Returns internal serialized length.
+    /// @return Internal serialized length
+    /// @see encode_internal() for encoding format
+    size_t encoded_length_internal() const override;
+
+    /// Writes serialized representation of object to a buffer.
+    /// @param bufp Address of destination buffer pointer (advanced by call)
+    void encode_internal(uint8_t **bufp) const override;
+
+    /// Reads serialized representation of object from a buffer.
+    /// @param version Encoding version
+    /// @param bufp Address of destination buffer pointer (advanced by call)
+    /// @param remainp Address of integer holding amount of serialized object
+    /// remaining
+    /// @see encode_internal() for encoding format
+    void decode_internal(uint8_t version, const uint8_t **bufp,
+                         size_t *remainp) override;
+
   private:
 
     /// Merges default column family options into a column family spec.
@@ -425,6 +562,12 @@ namespace Hypertable {
     typedef PageArenaAllocator<const char*> CstrAlloc;
     CharArena m_arena;
 
+    /// Protects #m_intern_strings
+    std::mutex m_intern_mutex;
+
+    /// Interned strings returned by intern()
+    FlyweightString m_intern_strings;
+
     /// Generation
     int64_t m_generation {};
 
@@ -434,6 +577,24 @@ namespace Hypertable {
     /// Group commit interval
     int32_t m_group_commit_interval {};
 
+    /// Deferred log sync flag
+    bool m_deferred_log_sync {};
+
+    /// Query cache TTL in seconds (0 implies no expiration)
+    int32_t m_query_cache_ttl {};
+
+    /// Query cache disabled flag
+    bool m_query_cache_disabled {};
+
+    /// Query cache maximum entry size in bytes (0 implies no limit)
+    int64_t m_query_cache_max_entry_size {};
+
+    /// Split size in bytes (0 implies the server default)
+    int64_t m_split_size {};
+
+    /// Split size adaptive flag
+    bool m_split_size_adaptive {};
+
     /// Default access group options
     AccessGroupOptions m_ag_defaults;
 
@@ -0,0 +1,133 @@
+/*
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 3 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include <Common/Compat.h>
+
+#include "SchemaCache.h"
+
+#include <Common/Error.h>
+#include <Common/Logger.h>
+
+using namespace Hypertable;
+using namespace Hyperspace;
+using namespace std;
+
+std::mutex SchemaCache::ms_mutex;
+std::unordered_map<String, SchemaCache::Entry> SchemaCache::ms_map;
+
+namespace {
+
+  /** Marks a table's cache entry stale when its schema attribute is set. */
+  class SchemaFileHandler : public HandleCallback {
+  public:
+    SchemaFileHandler(const String &table_id)
+      : HandleCallback(EVENT_MASK_ATTR_SET), m_table_id(table_id) { }
+
+    virtual void attr_set(const std::string &name) {
+      if (name == "schema")
+        SchemaCache::invalidate(m_table_id);
+    }
+
+  private:
+    String m_table_id;
+  };
+
+}
+
+bool SchemaCache::get(const String &table_id, SchemaPtr &schema) {
+  lock_guard<mutex> lock(ms_mutex);
+  auto it = ms_map.find(table_id);
+  if (it == ms_map.end() || it->second.stale || !it->second.schema)
+    return false;
+  schema = it->second.schema;
+  return true;
+}
+
+void SchemaCache::put(const String &table_id, SchemaPtr &schema,
+                      Hyperspace::SessionPtr &hyperspace,
+                      const String &tablefile) {
+  bool need_watch {};
+
+  {
+    lock_guard<mutex> lock(ms_mutex);
+    Entry &entry = ms_map[table_id];
+    if (!entry.schema ||
+        entry.schema->get_generation() <= schema->get_generation()) {
+      entry.schema = schema;
+      entry.stale = false;
+    }
+    need_watch = (entry.handle == 0);
+  }
+
+  if (!need_watch)
+    return;
+
+  // Register the watch outside the lock; the notification path acquires
+  // ms_mutex and must not be able to block behind the open() round trip
+  uint64_t handle = 0;
+  try {
+    HandleCallbackPtr callback = make_shared<SchemaFileHandler>(table_id);
+    handle = hyperspace->open(tablefile, OPEN_FLAG_READ, callback);
+  }
+  catch (Exception &e) {
+    // Without a watch the entry cannot be push-invalidated; drop it and
+    // fall back to fetching the schema on each Table::initialize()
+    HT_WARNF("Unable to register schema watch on '%s' for table %s - %s",
+             tablefile.c_str(), table_id.c_str(), e.what());
+    lock_guard<mutex> lock(ms_mutex);
+    ms_map.erase(table_id);
+    return;
+  }
+
+  {
+    lock_guard<mutex> lock(ms_mutex);
+    Entry &entry = ms_map[table_id];
+    if (entry.handle == 0) {
+      entry.handle = handle;
+      handle = 0;
+    }
+  }
+
+  // Another thread raced us registering the watch; keep theirs
+  if (handle)
+    hyperspace->close_nowait(handle);
+}
+
+void SchemaCache::invalidate(const String &table_id, bool drop_watch) {
+  lock_guard<mutex> lock(ms_mutex);
+  auto it = ms_map.find(table_id);
+  if (it == ms_map.end())
+    return;
+  it->second.stale = true;
+  if (drop_watch)
+    it->second.handle = 0;
+}
+
+void SchemaCache::invalidate_generation(const String &table_id,
+                                        int64_t generation) {
+  lock_guard<mutex> lock(ms_mutex);
+  auto it = ms_map.find(table_id);
+  if (it == ms_map.end())
+    return;
+  if (it->second.schema &&
+      it->second.schema->get_generation() <= generation)
+    it->second.stale = true;
+}
@@ -0,0 +1,116 @@
+/* -*- c++ -*-
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 3 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#ifndef Hypertable_Lib_SchemaCache_h
+#define Hypertable_Lib_SchemaCache_h
+
+#include <Hypertable/Lib/Schema.h>
+
+#include <Hyperspace/Session.h>
+
+#include <Common/String.h>
+
+#include <mutex>
+#include <unordered_map>
+
+namespace Hypertable {
+
+  /** Process-wide cache of parsed Schema objects, keyed by table ID.
+   *
+   * Each Table instance used to fetch the <i>schema</i> attribute from
+   * Hyperspace and run it through the XML parser, even when many Table
+   * objects for the same table are created by connection-pooled clients.
+   * This cache keeps one parsed Schema per table and registers a
+   * Hyperspace ATTR_SET watch on the table file so that a schema change
+   * marks the entry stale, making schema access a map lookup plus a
+   * shared_ptr copy with no Hyperspace round trip in steady state.
+   *
+   * Entries are never removed and a registered watch handle stays open
+   * for the lifetime of the process.  A notification can race a
+   * concurrent fetch and briefly leave a just-superseded schema
+   * installed as fresh; the existing generation mismatch handling
+   * (Table::refresh) repairs that on first use.
+   */
+  class SchemaCache {
+  public:
+
+    /** Fetches the cached schema for a table.
+     * @param table_id Table ID string
+     * @param schema Filled in with the cached schema on success
+     * @return <i>true</i> if a fresh entry was found, <i>false</i> otherwise
+     */
+    static bool get(const String &table_id, SchemaPtr &schema);
+
+    /** Installs a freshly parsed schema.
+     * The schema is installed only if its generation is at least that of
+     * the cached one.  On the first insertion for a table, a Hyperspace
+     * watch is registered on <code>tablefile</code> so that subsequent
+     * schema changes mark the entry stale.  If the watch cannot be
+     * registered the entry is dropped, falling back to a fetch per
+     * Table::initialize() call.
+     * @param table_id Table ID string
+     * @param schema Parsed schema
+     * @param hyperspace Hyperspace session (used to register the watch)
+     * @param tablefile Pathname of the table file in Hyperspace
+     */
+    static void put(const String &table_id, SchemaPtr &schema,
+                    Hyperspace::SessionPtr &hyperspace,
+                    const String &tablefile);
+
+    /** Marks the entry for a table stale.
+     * @param table_id Table ID string
+     * @param drop_watch If <i>true</i>, also forgets the watch handle so
+     * a subsequent put() re-registers it (used after a Hyperspace session
+     * reconnect, which invalidates all handles)
+     */
+    static void invalidate(const String &table_id, bool drop_watch = false);
+
+    /** Marks the entry for a table stale if its generation is out of date.
+     * Used on a server-reported generation mismatch; an entry that was
+     * already refreshed past <code>generation</code> is left intact.
+     * @param table_id Table ID string
+     * @param generation Generation known to be out of date
+     */
+    static void invalidate_generation(const String &table_id,
+                                      int64_t generation);
+
+  private:
+
+    /// Cache entry
+    struct Entry {
+      /// Parsed schema (null until the first put())
+      SchemaPtr schema;
+      /// Hyperspace watch handle (0 if not registered)
+      uint64_t handle {};
+      /// Set by invalidate(); cleared when a schema is installed
+      bool stale {};
+    };
+
+    /// %Mutex for serializing access to #ms_map
+    static std::mutex ms_mutex;
+
+    /// Table ID to cache entry map
+    static std::unordered_map<String, Entry> ms_map;
+  };
+
+}
+
+#endif // Hypertable_Lib_SchemaCache_h
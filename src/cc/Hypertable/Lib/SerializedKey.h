@@ -23,6 +23,7 @@
 #define HYPERTABLE_SERIALIZEDKEY_H
 
 #include "Common/ByteString.h"
+#include "Common/FastMemcmp.h"
 #include "Common/Logger.h"
 
 namespace Hypertable {
@@ -46,7 +47,7 @@ namespace Hypertable {
           len2 -= 8;
       }
       int len = (len1 < len2) ? len1 : len2;
-      int cmp = memcmp(ptr1+1, ptr2+1, len-1);
+      int cmp = fast_memcmp(ptr1+1, ptr2+1, len-1);
       return (cmp==0) ? len1 - len2 : cmp;
     }
 
@@ -34,7 +34,8 @@ using namespace std;
 
 namespace {
   enum Group {
-    PRIMARY_GROUP = 0
+    PRIMARY_GROUP = 0,
+    SELFTEST_GROUP = 1
   };
 }
 
@@ -95,10 +96,21 @@ StatsRangeServer::StatsRangeServer(const StatsRangeServer &other) : StatsSeriali
   cpu_user = other.cpu_user;
   cpu_sys = other.cpu_sys;
   live = other.live;
+  selftest_write_rate = other.selftest_write_rate;
+  selftest_read_rate = other.selftest_read_rate;
+  selftest_scan_rate = other.selftest_scan_rate;
   system = other.system;
   tables = other.tables;
 }
 
+void StatsRangeServer::enable_selftest_group() {
+  for (uint8_t i=0; i<group_count; i++) {
+    if (group_ids[i] == SELFTEST_GROUP)
+      return;
+  }
+  group_ids[group_count++] = SELFTEST_GROUP;
+}
+
 bool StatsRangeServer::operator==(const StatsRangeServer &other) const {
   if (location != other.location ||
       version != other.version ||
@@ -125,6 +137,9 @@ bool StatsRangeServer::operator==(const StatsRangeServer &other) const {
       !Serialization::equal(cpu_user, other.cpu_user) ||
       !Serialization::equal(cpu_sys, other.cpu_sys) ||
       live != other.live ||
+      selftest_write_rate != other.selftest_write_rate ||
+      selftest_read_rate != other.selftest_read_rate ||
+      selftest_scan_rate != other.selftest_scan_rate ||
       system != other.system)
     return false;
   if (tables.size() != other.tables.size())
@@ -149,6 +164,8 @@ size_t StatsRangeServer::encoded_length_group(int group) const {
       len += tables[i].encoded_length();
     return len;
   }
+  else if (group == SELFTEST_GROUP)
+    return 8*3;
   else
     HT_FATALF("Invalid group number (%d)", group);
   return 0;
@@ -186,6 +203,11 @@ void StatsRangeServer::encode_group(int group, uint8_t **bufp) const {
     for (size_t i=0; i<tables.size(); i++)
       tables[i].encode(bufp);
   }
+  else if (group == SELFTEST_GROUP) {
+    Serialization::encode_i64(bufp, selftest_write_rate);
+    Serialization::encode_i64(bufp, selftest_read_rate);
+    Serialization::encode_i64(bufp, selftest_scan_rate);
+  }
   else
     HT_FATALF("Invalid group number (%d)", group);
 }
@@ -226,6 +248,11 @@ void StatsRangeServer::decode_group(int group, uint16_t len, const uint8_t **buf
       tables.push_back(table);
     }
   }
+  else if (group == SELFTEST_GROUP) {
+    selftest_write_rate = Serialization::decode_i64(bufp, remainp);
+    selftest_read_rate = Serialization::decode_i64(bufp, remainp);
+    selftest_scan_rate = Serialization::decode_i64(bufp, remainp);
+  }
   else {
     HT_WARNF("Unrecognized StatsRangeServer group %d, skipping...", group);
     (*bufp) += len;
@@ -57,6 +57,11 @@ namespace Hypertable {
       if (ver != version)
         version = ver;
     }
+    /// Adds the self-test group to the set of serialized groups.
+    /// Called once the startup self-test has run; decoders that predate
+    /// the group skip it.
+    void enable_selftest_group();
+
     bool operator==(const StatsRangeServer &other) const;
     bool operator!=(const StatsRangeServer &other) const {
       return !(*this == other);
@@ -87,6 +92,9 @@ namespace Hypertable {
     double   cpu_user {};
     double   cpu_sys {};
     bool     live {};
+    int64_t  selftest_write_rate {};
+    int64_t  selftest_read_rate {};
+    int64_t  selftest_scan_rate {};
 
     StatsSystem system;
     std::vector<StatsTable> tables;
@@ -64,6 +64,9 @@ void StatsTable::clear() {
   bloom_filter_memory = 0;
   bloom_filter_accesses = 0;
   bloom_filter_maybes = 0;
+  query_cache_hits = 0;
+  query_cache_misses = 0;
+  query_cache_evictions = 0;
 }
 
 size_t StatsTable::encoded_length_group(int group) const {
@@ -93,7 +96,10 @@ size_t StatsTable::encoded_length_group(int group) const {
       Serialization::encoded_length_vi64(block_index_memory) + \
       Serialization::encoded_length_vi64(bloom_filter_memory) + \
       Serialization::encoded_length_vi64(bloom_filter_accesses) + \
-      Serialization::encoded_length_vi64(bloom_filter_maybes);
+      Serialization::encoded_length_vi64(bloom_filter_maybes) + \
+      Serialization::encoded_length_vi64(query_cache_hits) + \
+      Serialization::encoded_length_vi64(query_cache_misses) + \
+      Serialization::encoded_length_vi64(query_cache_evictions);
   }
   else
     HT_FATALF("Invalid group number (%d)", group);
@@ -127,6 +133,9 @@ void StatsTable::encode_group(int group, uint8_t **bufp) const {
     Serialization::encode_vi64(bufp, bloom_filter_memory);
     Serialization::encode_vi64(bufp, bloom_filter_accesses);
     Serialization::encode_vi64(bufp, bloom_filter_maybes);
+    Serialization::encode_vi64(bufp, query_cache_hits);
+    Serialization::encode_vi64(bufp, query_cache_misses);
+    Serialization::encode_vi64(bufp, query_cache_evictions);
   }
   else
     HT_FATALF("Invalid group number (%d)", group);
@@ -159,6 +168,9 @@ void StatsTable::decode_group(int group, uint16_t len, const uint8_t **bufp, siz
     bloom_filter_memory = Serialization::decode_vi64(bufp, remainp);
     bloom_filter_accesses = Serialization::decode_vi64(bufp, remainp);
     bloom_filter_maybes = Serialization::decode_vi64(bufp, remainp);
+    query_cache_hits = Serialization::decode_vi64(bufp, remainp);
+    query_cache_misses = Serialization::decode_vi64(bufp, remainp);
+    query_cache_evictions = Serialization::decode_vi64(bufp, remainp);
   }
   else
     HT_FATALF("Invalid group number (%d)", group);
@@ -191,7 +203,10 @@ bool StatsTable::operator==(const StatsTable &other) const {
       block_index_memory == other.block_index_memory &&
       bloom_filter_memory == other.bloom_filter_memory &&
       bloom_filter_accesses == other.bloom_filter_accesses &&
-      bloom_filter_maybes == other.bloom_filter_maybes)
+      bloom_filter_maybes == other.bloom_filter_maybes &&
+      query_cache_hits == other.query_cache_hits &&
+      query_cache_misses == other.query_cache_misses &&
+      query_cache_evictions == other.query_cache_evictions)
     return true;
   return false;
 }
@@ -60,6 +60,9 @@ namespace Hypertable {
       bloom_filter_memory = other.bloom_filter_memory;
       bloom_filter_accesses = other.bloom_filter_accesses;
       bloom_filter_maybes = other.bloom_filter_maybes;
+      query_cache_hits = other.query_cache_hits;
+      query_cache_misses = other.query_cache_misses;
+      query_cache_evictions = other.query_cache_evictions;
     }
     void clear();
     bool operator==(const StatsTable &other) const;
@@ -92,6 +95,9 @@ namespace Hypertable {
     uint64_t bloom_filter_memory;
     uint64_t bloom_filter_accesses;
     uint64_t bloom_filter_maybes;
+    uint64_t query_cache_hits;
+    uint64_t query_cache_misses;
+    uint64_t query_cache_evictions;
 
   protected:
     virtual size_t encoded_length_group(int group) const;
@@ -49,6 +49,7 @@ namespace {
 
   VariableInfo variable_info[] = {
     { SystemVariable::READONLY, "READONLY", false },
+    { SystemVariable::UPDATE_THROTTLE, "UPDATE_THROTTLE", false },
     { 0, 0, false }
   };
 
@@ -43,8 +43,9 @@ namespace Hypertable {
     /** Enumeration for variable codes.
      */
     enum Code {
-      READONLY = 0,   /**< Read-only */
-      COUNT    = 1    /**< Valid code count */
+      READONLY = 0,        /**< Read-only */
+      UPDATE_THROTTLE = 1, /**< Per-client update admission control */
+      COUNT    = 2         /**< Valid code count */
     };
 
     /// Holds a variable code and boolean value.
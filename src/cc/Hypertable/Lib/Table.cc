@@ -23,12 +23,20 @@
 
 #include "Table.h"
 #include "TableScanner.h"
+#include "TableStreamScanner.h"
 #include "TableMutator.h"
 #include "TableMutatorShared.h"
 #include "TableMutatorAsync.h"
 #include "ScanSpec.h"
 
+#include <Hypertable/Lib/ClusterId.h>
+#include <Hypertable/Lib/Key.h>
+#include <Hypertable/Lib/RangeServer/Client.h>
+#include <Hypertable/Lib/SchemaCache.h>
+
 #include <AsyncComm/ApplicationQueue.h>
+#include <AsyncComm/DispatchHandlerSynchronizer.h>
+#include <AsyncComm/Protocol.h>
 
 #include <Common/String.h>
 #include <Common/DynamicBuffer.h>
@@ -40,7 +48,9 @@
 
 #include <boost/algorithm/string.hpp>
 
+#include <chrono>
 #include <cstring>
+#include <thread>
 
 using namespace Hypertable;
 using namespace Hyperspace;
@@ -86,6 +96,13 @@ void Table::initialize() {
   m_scanner_queue_size = m_props->get_i32("Hypertable.Scanner.QueueSize");
   HT_ASSERT(m_scanner_queue_size > 0);
 
+  m_stream_buffer_bytes =
+    (size_t)m_props->get_i64("Hypertable.Scanner.StreamBufferBytes");
+  HT_ASSERT(m_stream_buffer_bytes > 0);
+
+  m_scanner_range_fanout = m_props->get_i32("Hypertable.Scanner.RangeFanout");
+  HT_ASSERT(m_scanner_range_fanout > 0);
+
 
   // Convert table name to ID string
 
@@ -99,21 +116,33 @@ void Table::initialize() {
   tablefile = m_toplevel_dir + "/tables/" + m_table.id;
 
   /**
-   * Get schema attribute
+   * Get schema attribute (from the process-wide cache when fresh)
    */
-  value_buf.clear();
-  // TODO: issue 11
-  try {
-    m_hyperspace->attr_get(tablefile, "schema", value_buf);
-  }
-  catch (Exception &e) {
-    if (e.code() == Error::HYPERSPACE_BAD_PATHNAME)
-      HT_THROW2(Error::TABLE_NOT_FOUND, e, m_name);
-    HT_THROW2F(e.code(), e, "Unable to open Hyperspace table file '%s'",
-               tablefile.c_str());
-  }
+  if (!SchemaCache::get(m_table.id, m_schema)) {
+    bool bin_exists {};
+    value_buf.clear();
+    // TODO: issue 11
+    try {
+      // Prefer the binary schema encoding; tables created before it was
+      // introduced carry only the XML attribute
+      m_hyperspace->attr_get(tablefile, "schema_bin", bin_exists, value_buf);
+      if (!bin_exists)
+        m_hyperspace->attr_get(tablefile, "schema", value_buf);
+    }
+    catch (Exception &e) {
+      if (e.code() == Error::HYPERSPACE_BAD_PATHNAME)
+        HT_THROW2(Error::TABLE_NOT_FOUND, e, m_name);
+      HT_THROW2F(e.code(), e, "Unable to open Hyperspace table file '%s'",
+                 tablefile.c_str());
+    }
+
+    if (bin_exists)
+      m_schema.reset( Schema::new_instance(value_buf.base, value_buf.fill()) );
+    else
+      m_schema.reset( Schema::new_instance((const char *)value_buf.base) );
 
-  m_schema.reset( Schema::new_instance((const char *)value_buf.base) );
+    SchemaCache::put(m_table.id, m_schema, m_hyperspace, tablefile);
+  }
 
   if (is_index && m_schema->get_version() < 1)
     HT_THROW(Error::BAD_FORMAT, "Unsupported index format.  Indexes must be "
@@ -133,10 +162,20 @@ void Table::refresh() {
   std::lock_guard<std::mutex> lock(m_mutex);
   HT_ASSERT(m_name != "");
   m_stale = true;
+  SchemaCache::invalidate_generation(m_table.id, m_table.generation);
   initialize();
 }
 
 
+void Table::invalidate() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_stale = true;
+  // Called on Hyperspace session reconnect; any schema watch registered
+  // with the old session died with it, so force re-registration
+  SchemaCache::invalidate(m_table.id, true);
+}
+
+
 void Table::get(TableIdentifierManaged &ident_copy, SchemaPtr &schema_copy) {
   std::lock_guard<std::mutex> lock(m_mutex);
   refresh_if_required();
@@ -150,6 +189,7 @@ Table::refresh(TableIdentifierManaged &ident_copy, SchemaPtr &schema_copy) {
   std::lock_guard<std::mutex> lock(m_mutex);
   HT_ASSERT(m_name != "");
   m_stale = true;
+  SchemaCache::invalidate_generation(m_table.id, m_table.generation);
   initialize();
   ident_copy = m_table;
   schema_copy = m_schema;
@@ -209,6 +249,145 @@ Table::create_scanner(const ScanSpec &scan_spec, uint32_t timeout_ms,
                           timeout_ms ? timeout_ms : m_timeout_ms);
 }
 
+TableStreamScanner *
+Table::create_stream_scanner(const ScanSpec &scan_spec, uint32_t timeout_ms,
+                             size_t buffer_bytes, int32_t flags) {
+
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    refresh_if_required();
+  }
+
+  return new TableStreamScanner(m_comm, m_app_queue, this, m_range_locator,
+                                scan_spec,
+                                timeout_ms ? timeout_ms : m_timeout_ms,
+                                buffer_bytes ? buffer_bytes
+                                             : m_stream_buffer_bytes,
+                                flags);
+}
+
+bool Table::compare_and_set(const KeySpec &key, const void *expected_value,
+                            uint32_t expected_value_len, const void *value,
+                            uint32_t value_len, uint32_t timeout_ms) {
+  key.sanity_check();
+
+  if (!key.column_family || !*((const char *)key.column_family))
+    HT_THROW(Error::BAD_KEY, "Column family not specified");
+
+  Timer timer(timeout_ms ? timeout_ms : m_timeout_ms, true);
+  TableIdentifierManaged table_identifier;
+  SchemaPtr schema;
+
+  get(table_identifier, schema);
+
+  ColumnFamilySpec *cf = schema->get_column_family((const char *)key.column_family);
+  if (!cf) {
+    if (auto_refresh()) {
+      refresh(table_identifier, schema);
+      cf = schema->get_column_family((const char *)key.column_family);
+    }
+    if (!cf)
+      HT_THROWF(Error::BAD_KEY, "Bad column family '%s'",
+                (const char *)key.column_family);
+  }
+
+  Key full_key;
+  full_key.row = (const char *)key.row;
+  full_key.row_len = key.row_len ? key.row_len : strlen(full_key.row);
+  full_key.column_family_code = (uint8_t)cf->get_id();
+  if (key.column_qualifier) {
+    full_key.column_qualifier = (const char *)key.column_qualifier;
+    full_key.column_qualifier_len = key.column_qualifier_len;
+  }
+  else {
+    full_key.column_qualifier = "";
+    full_key.column_qualifier_len = 0;
+  }
+  full_key.timestamp = key.timestamp;
+  full_key.revision = key.revision;
+  full_key.flag = FLAG_INSERT;
+
+  DynamicBuffer dbuf;
+  create_key_and_append(dbuf, full_key);
+  append_as_byte_string(dbuf, value, value_len);
+
+  string row(full_key.row, full_key.row_len);
+  string column_family((const char *)key.column_family);
+  string column_qualifier(full_key.column_qualifier,
+                          full_key.column_qualifier_len);
+  bool expect_missing = (expected_value == 0);
+  string expected;
+  if (!expect_missing)
+    expected = string((const char *)expected_value, expected_value_len);
+
+  RangeLocationInfo range_info;
+  m_range_locator->find_loop(&table_identifier, row.c_str(), &range_info,
+                             timer, false);
+
+  Lib::RangeServer::Client range_server(m_comm, m_timeout_ms);
+
+  while (true) {
+    DispatchHandlerSynchronizer sync_handler;
+    EventPtr event;
+    StaticBuffer send_buf(dbuf.base, dbuf.fill(), false);
+
+    range_server.compare_and_update(range_info.addr, ClusterId::get(),
+                                    table_identifier, row, column_family,
+                                    column_qualifier, expect_missing,
+                                    expected, 1, send_buf, 0, &sync_handler,
+                                    timer);
+
+    if (sync_handler.wait_for_reply(event)) {
+      // A non-empty response extension means the server rejected the cell
+      if (event->payload_len > 4) {
+        const uint8_t *ptr = event->payload + 4;
+        size_t remaining = event->payload_len - 4;
+        int32_t error = Serialization::decode_i32(&ptr, &remaining);
+        HT_THROWF(error, "Problem applying compare_and_set update to %s",
+                  m_name.c_str());
+      }
+      return true;
+    }
+
+    int error = Hypertable::Protocol::response_code(event);
+
+    if (error == Error::RANGESERVER_COMPARE_FAILED)
+      return false;
+
+    if (error == Error::RANGESERVER_GENERATION_MISMATCH) {
+      refresh(table_identifier, schema);
+      cf = schema->get_column_family((const char *)key.column_family);
+      if (!cf)
+        HT_THROWF(Error::BAD_KEY, "Bad column family '%s'",
+                  (const char *)key.column_family);
+      full_key.column_family_code = (uint8_t)cf->get_id();
+      dbuf.clear();
+      create_key_and_append(dbuf, full_key);
+      append_as_byte_string(dbuf, value, value_len);
+      continue;
+    }
+
+    if (error != Error::RANGESERVER_RANGE_NOT_FOUND &&
+        error != Error::RANGESERVER_OUT_OF_RANGE &&
+        error != Error::TABLE_NOT_FOUND &&
+        error != Error::COMM_NOT_CONNECTED &&
+        error != Error::COMM_BROKEN_CONNECTION)
+      HT_THROWF(error, "Problem sending compare_and_set update to %s - %s",
+                m_name.c_str(),
+                Hypertable::Protocol::string_format_message(event).c_str());
+
+    if (timer.expired())
+      HT_THROWF(Error::REQUEST_TIMEOUT,
+                "Problem sending compare_and_set update to %s", m_name.c_str());
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(1000));
+
+    // try again, the hard way
+    m_range_locator->find_loop(&table_identifier, row.c_str(), &range_info,
+                               timer, true);
+  }
+}
+
 TableScannerAsync *
 Table::create_scanner_async(ResultCallback *cb, const ScanSpec &scan_spec, uint32_t timeout_ms,
                             int32_t flags) {
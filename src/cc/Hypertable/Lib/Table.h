@@ -23,6 +23,7 @@
 #define Hypertable_Lib_Table_h
 
 #include <Hypertable/Lib/ClientObject.h>
+#include <Hypertable/Lib/KeySpec.h>
 #include <Hypertable/Lib/NameIdMapper.h>
 #include <Hypertable/Lib/ScanSpec.h>
 #include <Hypertable/Lib/Schema.h>
@@ -46,6 +47,7 @@ namespace Hypertable {
   class ResultCallback;
   class TableScannerAsync;
   class TableScanner;
+  class TableStreamScanner;
   class TableMutator;
   class TableMutatorAsync;
   class Namespace;
@@ -130,6 +132,58 @@ namespace Hypertable {
                                             uint32_t timeout_ms = 0,
                                             int32_t flags = 0);
 
+    /**
+     * Creates a streaming scanner on this table
+     *
+     * Streaming scanners pull results synchronously like the scanners
+     * returned by #create_scanner, but process RangeServer responses on the
+     * client application queue so scanblock fetches are pipelined with
+     * consumption, and buffer at most <code>buffer_bytes</code> of results
+     * on the client.  Intended for large exports where the result set far
+     * exceeds client memory.
+     *
+     * @param scan_spec scan specification
+     * @param timeout_ms maximum time in milliseconds to allow
+     *        scanner methods to execute before throwing an exception
+     * @param buffer_bytes client-side result buffer budget in bytes (0 for
+     *        the <code>Hypertable.Scanner.StreamBufferBytes</code> default)
+     * @param flags scanner flags
+     * @return pointer to scanner object
+     */
+    TableStreamScanner *create_stream_scanner(const ScanSpec &scan_spec,
+                                              uint32_t timeout_ms = 0,
+                                              size_t buffer_bytes = 0,
+                                              int32_t flags = 0);
+
+    /**
+     * Atomically compares and sets a cell
+     *
+     * The cell identified by <code>key</code> is written with
+     * <code>value</code> only if it currently holds
+     * <code>expected_value</code>, or is absent when
+     * <code>expected_value</code> is NULL.  The comparison and write are
+     * performed in a single RangeServer round trip and concurrent
+     * compare_and_set calls on the same row are serialized by the server,
+     * making this suitable for read-modify-write workloads that would
+     * otherwise need a scan followed by a mutator flush.  Note that plain
+     * mutator writes are not held back by an in-flight compare_and_set and
+     * retain last-writer-wins semantics.
+     *
+     * @param key key of the cell to compare and set
+     * @param expected_value expected current value of the cell (NULL means
+     *        the cell is expected to be absent)
+     * @param expected_value_len length of expected value
+     * @param value new value to write if the comparison succeeds
+     * @param value_len length of new value
+     * @param timeout_ms maximum time in milliseconds to allow the call
+     *        to execute before throwing an exception
+     * @return <i>true</i> if the value was written, <i>false</i> if the
+     *         comparison failed
+     */
+    bool compare_and_set(const KeySpec &key, const void *expected_value,
+                         uint32_t expected_value_len, const void *value,
+                         uint32_t value_len, uint32_t timeout_ms = 0);
+
     void get_identifier(TableIdentifier *table_id_p) {
       std::lock_guard<std::mutex> lock(m_mutex);
       refresh_if_required();
@@ -147,6 +201,11 @@ namespace Hypertable {
       return m_schema;
     }
 
+    /// Returns the value of <code>Hypertable.Scanner.RangeFanout</code>,
+    /// the number of range scans kept in flight for each row interval
+    /// of a table scan.
+    int32_t scanner_range_fanout() const { return m_scanner_range_fanout; }
+
     /**
      * Refresh schema etc.
      */
@@ -170,10 +229,7 @@ namespace Hypertable {
       return m_stale;
     }
 
-    void invalidate() {
-      std::lock_guard<std::mutex> lock(m_mutex);
-      m_stale = true;
-    }
+    void invalidate();
 
     bool auto_refresh() {
       return (m_flags & OPEN_FLAG_NO_AUTO_TABLE_REFRESH) == 0;
@@ -271,6 +327,8 @@ namespace Hypertable {
     bool                   m_stale;
     std::string                 m_toplevel_dir;
     size_t                 m_scanner_queue_size;
+    size_t                 m_stream_buffer_bytes;
+    int32_t                m_scanner_range_fanout;
     TablePtr               m_index_table;
     TablePtr               m_qualifier_index_table;
     Namespace             *m_namespace;
@@ -65,6 +65,8 @@ TableMutator::TableMutator(PropertiesPtr &props, Comm *comm, Table *table, Range
   ApplicationQueueInterfacePtr app_queue = m_queue;
 
   m_flush_delay = props->get_i32("Hypertable.Mutator.FlushDelay");
+  m_pipeline_depth = props->get_i32("Hypertable.Mutator.PipelineDepth");
+  HT_ASSERT(m_pipeline_depth > 0);
   m_mutator =
     make_shared<TableMutatorAsync>(m_queue_mutex, m_cond, props, comm, app_queue,
                                    table, range_locator, timeout_ms, &m_callback, 
@@ -152,7 +154,7 @@ void TableMutator::auto_flush() {
     if (!m_mutator->needs_flush())
       return;
 
-    wait_for_flush_completion(m_mutator.get());
+    wait_for_window(m_mutator.get());
 
     if (m_flush_delay)
       this_thread::sleep_for(chrono::milliseconds(m_flush_delay));
@@ -220,6 +222,34 @@ void TableMutator::wait_for_flush_completion(TableMutatorAsync *mutator) {
   }
 }
 
+void TableMutator::wait_for_window(TableMutatorAsync *mutator) {
+  int last_error = 0;
+  ApplicationHandler *app_handler = 0;
+  while (true) {
+    {
+      unique_lock<mutex> lock(m_queue_mutex);
+      if (mutator->outstanding_buffer_count_unlocked() >= m_pipeline_depth) {
+        m_queue->wait_for_buffer(lock, &app_handler);
+        {
+          lock_guard<mutex> lock(m_mutex);
+          last_error = m_last_error;
+        }
+      }
+      else {
+        lock_guard<mutex> lock(m_mutex);
+        if (m_last_error != Error::OK)
+          HT_THROW(m_last_error, "");
+        return;
+      }
+    }
+    app_handler->run();
+    delete app_handler;
+
+    if (last_error != Error::OK)
+      HT_THROW(m_last_error, "");
+  }
+}
+
 bool TableMutator::retry(uint32_t timeout_ms) {
   uint32_t save_timeout = m_timeout_ms;
 
@@ -193,6 +193,18 @@ namespace Hypertable {
     friend class TableMutatorAsync;
     void wait_for_flush_completion(TableMutatorAsync *mutator);
 
+    /**
+     * Drains update completions until fewer than
+     * <code>m_pipeline_depth</code> scatter buffers remain in flight,
+     * throwing if any completed buffer reported an error.  Automatic
+     * flushes use this instead of wait_for_flush_completion() so that a
+     * single-threaded loader keeps multiple update RPCs outstanding per
+     * range server instead of ping-ponging on round-trip latency.
+     *
+     * @param mutator pointer to async mutator
+     */
+    void wait_for_window(TableMutatorAsync *mutator);
+
     void set_last_error(int32_t error) {
       std::lock_guard<std::mutex> lock(m_mutex);
       m_last_error = error;
@@ -239,6 +251,7 @@ namespace Hypertable {
     uint32_t             m_timeout_ms;
     uint32_t             m_flags;
     uint32_t             m_flush_delay;
+    uint32_t             m_pipeline_depth;
     int32_t     m_last_error;
     int         m_last_op;
     KeySpec     m_last_key;
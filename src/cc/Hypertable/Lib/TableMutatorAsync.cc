@@ -90,6 +90,20 @@ void TableMutatorAsync::initialize(PropertiesPtr &props) {
 
   m_max_memory = props->get_i64("Hypertable.Mutator.ScatterBuffer.FlushLimit.Aggregate");
 
+  // With adaptive batching the configured aggregate limit becomes the
+  // ceiling; start at the floor and grow while flushes meet the latency
+  // target
+  m_adaptive_batching = props->get_bool("Hypertable.Mutator.AdaptiveBatching");
+  if (m_adaptive_batching) {
+    m_latency_target_ms =
+      props->get_i32("Hypertable.Mutator.AdaptiveBatching.LatencyTarget");
+    m_adaptive_min_memory =
+      props->get_i64("Hypertable.Mutator.AdaptiveBatching.MinBytes");
+    HT_ASSERT(m_latency_target_ms > 0 && m_adaptive_min_memory > 0);
+    m_adaptive_max_memory = m_max_memory;
+    m_max_memory = std::min(m_adaptive_min_memory, m_adaptive_max_memory);
+  }
+
   uint32_t buffer_id = ++m_next_buffer_id;
   m_current_buffer = make_shared<TableMutatorAsyncScatterBuffer>(m_comm, m_app_queue, 
           this, &m_table_identifier, m_schema, m_range_locator, 
@@ -132,6 +146,7 @@ void TableMutatorAsync::initialize_indices(PropertiesPtr &props)
   }
 
   m_use_index = true;
+  m_async_index = props->get_bool("Hypertable.Mutator.Index.Async");
 
   m_imc = make_shared<IndexMutatorCallback>(this, m_cb, m_max_memory);
   m_cb = &(*m_imc);
@@ -398,8 +413,9 @@ void TableMutatorAsync::set_delete(const KeySpec &key) {
 }
 
 void
-TableMutatorAsync::to_full_key(const void *row, const char *column_family, 
-        const void *column_qualifier, int64_t timestamp, int64_t revision, 
+TableMutatorAsync::to_full_key(const void *row, const char *column_family,
+        const void *column_qualifier, size_t column_qualifier_len,
+        int64_t timestamp, int64_t revision,
         uint8_t flag, Key &full_key, ColumnFamilySpec **pcf) {
   ColumnFamilySpec *cf;
 
@@ -432,7 +448,8 @@ TableMutatorAsync::to_full_key(const void *row, const char *column_family,
   full_key.row = (const char *)row;
   if (column_qualifier) {
     full_key.column_qualifier = (const char *)column_qualifier;
-    full_key.column_qualifier_len = strlen((const char *)column_qualifier);
+    full_key.column_qualifier_len = column_qualifier_len ? column_qualifier_len
+      : strlen((const char *)column_qualifier);
   }
   else {
     full_key.column_qualifier = "";
@@ -471,28 +488,38 @@ void TableMutatorAsync::flush(bool sync) {
 
 void TableMutatorAsync::flush_with_tablequeue(TableMutator *mutator, bool sync) {
   // if an index is used: make sure that the index is updated
-  // BEFORE the primary table is flushed!
+  // BEFORE the primary table is flushed!  In asynchronous index mode the
+  // index mutators are flushed concurrently with the primary table
+  // instead; index entries then lag the primary by at most one flush and
+  // missing entries are detected by the scan-side verification against
+  // the primary table (see IndexScannerCallback)
   if (m_use_index) {
     if (m_index_mutator) {
       m_index_mutator->flush();
-      if (mutator)
-        mutator->wait_for_flush_completion(m_index_mutator.get());
-      m_index_mutator->wait_for_completion();
+      if (!m_async_index) {
+        if (mutator)
+          mutator->wait_for_flush_completion(m_index_mutator.get());
+        m_index_mutator->wait_for_completion();
+      }
     }
     if (m_qualifier_index_mutator) {
       m_qualifier_index_mutator->flush();
-      if (mutator)
-        mutator->wait_for_flush_completion(m_qualifier_index_mutator.get());
-      m_qualifier_index_mutator->wait_for_completion();
+      if (!m_async_index) {
+        if (mutator)
+          mutator->wait_for_flush_completion(m_qualifier_index_mutator.get());
+        m_qualifier_index_mutator->wait_for_completion();
+      }
     }
 
     if (is_cancelled())
       return;
 
-    // propagate all index failures to the original callback
+    // propagate all index failures to the original callback; in
+    // asynchronous index mode these are the failures that completed in
+    // earlier rounds
     m_imc->propagate_failures();
 
-    // now copy all regular cells to this mutator's buffers 
+    // now copy all regular cells to this mutator's buffers
     m_imc->consume_keybuffer(this);
 
     // then fall through
@@ -720,6 +747,7 @@ void TableMutatorAsync::buffer_finish(uint32_t id, int error, bool retry) {
     }
     else {
       HT_ASSERT(redo);
+      adapt_flush_limit(buffer->elapsed_send_time_ms(), true);
       m_resends += buffer->get_resend_count();
       m_outstanding_buffers.erase(it);
       redo->send(buffer->get_send_flags());
@@ -732,8 +760,20 @@ void TableMutatorAsync::buffer_finish(uint32_t id, int error, bool retry) {
       lock_guard<mutex> lock(m_member_mutex);
       m_mutated = true;
     }
+    adapt_flush_limit(buffer->elapsed_send_time_ms(), false);
     if (m_cb != 0)
       m_cb->update_ok(this);
     update_outstanding(buffer);
   }
 }
+
+void TableMutatorAsync::adapt_flush_limit(int64_t elapsed_ms,
+                                          bool backpressure) {
+  if (!m_adaptive_batching)
+    return;
+  lock_guard<mutex> lock(m_member_mutex);
+  if (backpressure || elapsed_ms > m_latency_target_ms)
+    m_max_memory = std::max(m_max_memory / 2, m_adaptive_min_memory);
+  else if (elapsed_ms < m_latency_target_ms / 2)
+    m_max_memory = std::min(m_max_memory * 2, m_adaptive_max_memory);
+}
@@ -195,6 +195,9 @@ namespace Hypertable {
     bool has_outstanding_unlocked() {
       return !m_outstanding_buffers.empty();
     }
+    size_t outstanding_buffer_count_unlocked() {
+      return m_outstanding_buffers.size();
+    }
     bool needs_flush();
 
     SchemaPtr schema() { std::lock_guard<std::mutex> lock(m_mutex); return m_schema; }
@@ -231,24 +234,43 @@ namespace Hypertable {
      */
     void do_sync();
 
+    /** Fills in a full Key from key components.  A non-zero
+     * <code>cq_len</code> is trusted as the column qualifier length,
+     * avoiding a strlen on the per-cell send path; pass 0 when the
+     * length is unknown.
+     */
     void to_full_key(const void *row, const char *cf, const void *cq,
-                     int64_t ts, int64_t rev, uint8_t flag, Key &full_key,
-                     ColumnFamilySpec **pcf = 0);
+                     size_t cq_len, int64_t ts, int64_t rev, uint8_t flag,
+                     Key &full_key, ColumnFamilySpec **pcf = 0);
 
     void to_full_key(const KeySpec &key, Key &full_key,
                      ColumnFamilySpec **cf = 0) {
       to_full_key(key.row, key.column_family, key.column_qualifier,
-                  key.timestamp, key.revision, key.flag, full_key, cf);
+                  key.column_qualifier_len, key.timestamp, key.revision,
+                  key.flag, full_key, cf);
     }
 
     void to_full_key(const Cell &cell, Key &full_key,
                      ColumnFamilySpec **cf = 0) {
-      to_full_key(cell.row_key, cell.column_family, cell.column_qualifier,
+      to_full_key(cell.row_key, cell.column_family, cell.column_qualifier, 0,
                   cell.timestamp, cell.revision, cell.flag, full_key, cf);
     }
 
     void update_unsynced_rangeservers(const CommAddressSet &unsynced);
 
+    /**
+     * Adjusts the aggregate flush limit when adaptive batching is enabled.
+     * The limit is halved when the server signals backpressure (a buffer
+     * had to be retried or timed out) or the flush round-trip exceeded the
+     * latency target, and doubled when the round-trip came in under half
+     * the target, bounded by the adaptive floor and the configured
+     * aggregate flush limit.
+     *
+     * @param elapsed_ms round-trip time of the completed buffer
+     * @param backpressure <i>true</i> if the buffer was retried or timed out
+     */
+    void adapt_flush_limit(int64_t elapsed_ms, bool backpressure);
+
     void handle_send_exceptions(const String& info);
 
     bool mutated() {
@@ -273,7 +295,11 @@ namespace Hypertable {
     RangeLocatorPtr m_range_locator;
     TableIdentifierManaged m_table_identifier;    // needs mutex
     uint64_t m_memory_used {};  // protected by buffer_mutex
-    uint64_t m_max_memory {};
+    uint64_t m_max_memory {};   // needs member mutex when adaptive
+    bool m_adaptive_batching {};
+    int32_t m_latency_target_ms {};
+    uint64_t m_adaptive_min_memory {};
+    uint64_t m_adaptive_max_memory {};
     ScatterBufferAsyncMap  m_outstanding_buffers;  // protected by buffer mutex
     TableMutatorAsyncScatterBufferPtr m_current_buffer; // needs mutex
     uint64_t m_resends {};  // needs mutex
@@ -296,6 +322,7 @@ namespace Hypertable {
     bool m_cancelled {};
     bool m_mutated {};      // needs mutex
     bool m_use_index {};
+    bool m_async_index {};
 
   };
 
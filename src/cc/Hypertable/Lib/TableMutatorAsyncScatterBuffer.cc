@@ -124,20 +124,24 @@ TableMutatorAsyncScatterBuffer::set(const Key &key, const ColumnFamilySpec *cf,
       (*iter).second->addr = range_info.addr;
     }
 
+    track_atomicity((*iter).second.get(), key.row);
+
     (*iter).second->key_offsets.push_back((*iter).second->accum.fill());
-    create_key_and_append((*iter).second->accum, key);
 
-    // now append the counter
+    // counters get their re-encoded value appended, everything else gets
+    // key and value written with a single buffer reservation
     if (is_counter) {
       if (counter_reset) {
         *m_counter_value.ptr++ = '=';
-        append_as_byte_string((*iter).second->accum, m_counter_value.base, 9);
+        create_key_value_and_append((*iter).second->accum, key,
+                                    m_counter_value.base, 9);
       }
       else
-        append_as_byte_string((*iter).second->accum, m_counter_value.base, 8);
+        create_key_value_and_append((*iter).second->accum, key,
+                                    m_counter_value.base, 8);
     }
     else
-      append_as_byte_string((*iter).second->accum, value, value_len);
+      create_key_value_and_append((*iter).second->accum, key, value, value_len);
 
     if ((*iter).second->accum.fill() > m_server_flush_limit)
       m_full = true;
@@ -170,6 +174,8 @@ void TableMutatorAsyncScatterBuffer::set_delete(const Key &key, size_t incr_mem)
     (*iter).second->addr = range_info.addr;
   }
 
+  track_atomicity((*iter).second.get(), key.row);
+
   (*iter).second->key_offsets.push_back((*iter).second->accum.fill());
   if (key.flag == FLAG_DELETE_COLUMN_FAMILY ||
       key.flag == FLAG_DELETE_CELL || key.flag == FLAG_DELETE_CELL_VERSION) {
@@ -182,8 +188,7 @@ void TableMutatorAsyncScatterBuffer::set_delete(const Key &key, size_t incr_mem)
     }
   }
 
-  create_key_and_append((*iter).second->accum, key);
-  append_as_byte_string((*iter).second->accum, 0, 0);
+  create_key_value_and_append((*iter).second->accum, key, 0, 0);
   if ((*iter).second->accum.fill() > m_server_flush_limit)
     m_full = true;
   m_memory_used += incr_mem;
@@ -216,6 +221,8 @@ TableMutatorAsyncScatterBuffer::set(SerializedKey key, ByteString value, size_t
     (*iter).second->addr = range_info.addr;
   }
 
+  track_atomicity((*iter).second.get(), (const char *)ptr+1);
+
   (*iter).second->key_offsets.push_back((*iter).second->accum.fill());
   (*iter).second->accum.add(key.ptr, (ptr-key.ptr)+len);
   (*iter).second->accum.add(value.ptr, value.length());
@@ -239,11 +246,30 @@ namespace {
 }
 
 
+void
+TableMutatorAsyncScatterBuffer::track_atomicity(
+    TableMutatorAsyncSendBuffer *send_buffer, const char *row) {
+  if (send_buffer->multi_range)
+    return;
+  if (!send_buffer->range_tracked) {
+    RangeLocationInfo range_loc_info;
+    if (m_location_cache->lookup(m_table_identifier.id, row, &range_loc_info))
+      send_buffer->track_range(range_loc_info.start_row,
+                               range_loc_info.end_row);
+    else
+      send_buffer->multi_range = true;
+  }
+  else
+    send_buffer->track_row(row);
+}
+
+
 void TableMutatorAsyncScatterBuffer::send(uint32_t flags) {
   lock_guard<mutex> lock(m_mutex);
   bool outstanding=false;
 
   m_timer.start();
+  m_send_time = chrono::steady_clock::now();
   TableMutatorAsyncSendBufferPtr send_buffer;
   std::vector<SendRec> send_vec;
   uint8_t *ptr;
@@ -305,12 +331,20 @@ void TableMutatorAsyncScatterBuffer::send(uint32_t flags) {
     /**
      * Send update
      */
+    // A fresh batch that lands wholly in one range is applied
+    // all-or-nothing by the range server through a single commit log
+    // record; a rejected atomic batch comes back in its entirety and is
+    // redone through the normal retry path
+    uint32_t buffer_flags = flags;
+    if (!send_buffer->resend() && send_buffer->single_range())
+      buffer_flags |= Lib::RangeServer::Protocol::UPDATE_FLAG_ATOMIC;
+
     try {
       m_send_flags = flags;
       send_buffer->pending_updates.own = false;
       m_range_server.update(send_buffer->addr, ClusterId::get(),
                             m_table_identifier, send_buffer->send_count,
-                            send_buffer->pending_updates, flags,
+                            send_buffer->pending_updates, buffer_flags,
                             send_buffer->dispatch_handler.get());
 
       outstanding = true;
@@ -46,6 +46,7 @@
 #include <Common/Timer.h>
 #include <Common/InetAddr.h>
 
+#include <chrono>
 #include <condition_variable>
 #include <memory>
 #include <mutex>
@@ -92,6 +93,16 @@ namespace Hypertable {
 
     uint32_t get_id() const { return m_id; }
     uint32_t get_send_flags() const { return m_send_flags; }
+
+    /**
+     * Returns the number of milliseconds elapsed since send() was called.
+     *
+     * @return milliseconds since this buffer was sent
+     */
+    int64_t elapsed_send_time_ms() const {
+      return std::chrono::duration_cast<std::chrono::milliseconds>(
+          std::chrono::steady_clock::now() - m_send_time).count();
+    }
     const CommAddressSet &get_unsynced_rangeservers() { return m_unsynced_rangeservers; }
     /**
      * Returns the amount of memory used by the collected mutations.
@@ -104,6 +115,14 @@ namespace Hypertable {
     void set_retries_to_fail(int error);
 
   private:
+
+    /** Maintains single-range tracking for <code>send_buffer</code> as
+     * keys are buffered.  Batches whose keys all fall in one range are
+     * sent with Protocol::UPDATE_FLAG_ATOMIC so the server applies them
+     * all-or-nothing.
+     */
+    void track_atomicity(TableMutatorAsyncSendBuffer *send_buffer,
+                         const char *row);
     int set_failed_mutations();
     typedef CommAddressMap<TableMutatorAsyncSendBufferPtr> TableMutatorAsyncSendBufferMap;
 
@@ -133,6 +152,7 @@ namespace Hypertable {
     std::condition_variable m_cond;
     bool                 m_outstanding {};
     uint32_t             m_send_flags {};
+    std::chrono::steady_clock::time_point m_send_time;
     uint32_t             m_wait_time;
     const static uint32_t ms_init_redo_wait_time=1000;
     bool dead {};
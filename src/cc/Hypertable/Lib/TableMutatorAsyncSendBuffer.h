@@ -24,7 +24,9 @@
 
 #include "TableMutatorAsyncCompletionCounter.h"
 
+#include <cstring>
 #include <memory>
+#include <string>
 
 namespace Hypertable {
 
@@ -106,6 +108,29 @@ namespace Hypertable {
 
     bool resend() { return retry_count > 0; }
 
+    /** Records the boundary rows of the range covering the first
+     * buffered key, for single-range detection.
+     */
+    void track_range(const std::string &start_row, const std::string &end_row) {
+      atomic_start_row = start_row;
+      atomic_end_row = end_row;
+      range_tracked = true;
+    }
+
+    /** Checks whether <code>row</code> falls within the range recorded by
+     * track_range(), marking the buffer multi-range if not.  Comparing
+     * against the recorded interval avoids a second location cache lookup
+     * per key.
+     */
+    void track_row(const char *row) {
+      if (strcmp(row, atomic_start_row.c_str()) <= 0 ||
+          strcmp(row, atomic_end_row.c_str()) > 0)
+        multi_range = true;
+    }
+
+    /// Returns <i>true</i> if all buffered keys belong to a single range
+    bool single_range() const { return range_tracked && !multi_range; }
+
     std::vector<uint64_t> key_offsets;
     DynamicBuffer accum;
     StaticBuffer pending_updates;
@@ -115,6 +140,14 @@ namespace Hypertable {
     std::vector<FailedRegionAsync> failed_regions;
     uint32_t send_count;
     uint32_t retry_count;
+    /// Start row (exclusive) of the range covering the first buffered key
+    std::string atomic_start_row;
+    /// End row (inclusive) of the range covering the first buffered key
+    std::string atomic_end_row;
+    /// Set once a covering range has been recorded
+    bool range_tracked {};
+    /// Set when buffered keys are known to span more than one range
+    bool multi_range {};
 
   private:
     const TableIdentifier *m_table_identifier;
@@ -404,8 +404,98 @@ void TableScannerAsync::add_index_row(ScanSpecBuilder &ssb, const char *row)
                     ri.end, ri.end_inclusive);
 }
 
-void TableScannerAsync::init(Comm *comm, ApplicationQueueInterfacePtr &app_queue, 
-        Table *table, RangeLocatorPtr &range_locator, 
+void TableScannerAsync::get_split_rows(Table *table,
+        RangeLocatorPtr &range_locator, const char *start_row,
+        const char *end_row, int32_t fanout, uint32_t timeout_ms,
+        std::vector<std::string> &split_rows)
+{
+  const size_t max_boundaries = 4096;
+  vector<String> boundaries;
+  TableIdentifierManaged table_id;
+  SchemaPtr schema;
+  RangeLocationInfo range_info;
+  Timer timer(timeout_ms, true);
+  String probe_row = start_row;
+
+  table->get(table_id, schema);
+
+  try {
+    while (boundaries.size() < max_boundaries) {
+      if (range_locator->find(&table_id, probe_row.c_str(), &range_info,
+                              timer, false) != Error::OK)
+        return;
+      if (range_info.end_row.empty()
+          || !strcmp(range_info.end_row.c_str(), Key::END_ROW_MARKER)
+          || strcmp(range_info.end_row.c_str(), end_row) >= 0)
+        break;
+      boundaries.push_back(range_info.end_row);
+      probe_row = range_info.end_row;
+      probe_row.append(1,1);  // construct row key in next range
+    }
+  }
+  catch (Exception &e) {
+    // splitting is an optimization; fall back to a single interval scanner
+    HT_WARN_OUT << "Problem fetching range boundaries for parallel scan - "
+                << e << HT_END;
+    return;
+  }
+
+  if (boundaries.empty())
+    return;
+
+  // pick up to fanout-1 evenly spaced boundary rows
+  size_t nsplits = std::min((size_t)(fanout - 1), boundaries.size());
+  split_rows.reserve(nsplits);
+  for (size_t i = 1; i <= nsplits; i++)
+    split_rows.push_back(boundaries[((i * boundaries.size()) / (nsplits + 1))]);
+}
+
+void TableScannerAsync::create_interval_scanners(Comm *comm,
+        ApplicationQueueInterfacePtr &app_queue, Table *table,
+        RangeLocatorPtr &range_locator, const ScanSpec &scan_spec,
+        const RowInterval &interval,
+        const std::vector<std::string> &split_rows, uint32_t timeout_ms,
+        bool &current_set, int &scanner_id)
+{
+  ScanSpec interval_scan_spec;
+  IntervalScannerAsyncPtr ri_scanner;
+  const char *sub_start = interval.start;
+  bool sub_start_inclusive = interval.start_inclusive;
+
+  m_interval_scanners.reserve(m_interval_scanners.size()
+                              + split_rows.size() + 1);
+  for (size_t i = 0; i <= split_rows.size(); i++) {
+    RowInterval sub_interval;
+    sub_interval.start = sub_start;
+    sub_interval.start_inclusive = sub_start_inclusive;
+    if (i < split_rows.size()) {
+      // ranges are (start, end], so the sub-interval ends at the range
+      // boundary inclusive and the next one starts there exclusive
+      sub_interval.end = split_rows[i].c_str();
+      sub_interval.end_inclusive = true;
+    }
+    else {
+      sub_interval.end = interval.end;
+      sub_interval.end_inclusive = interval.end_inclusive;
+    }
+    scan_spec.base_copy(interval_scan_spec);
+    interval_scan_spec.row_intervals.push_back(sub_interval);
+    ri_scanner =
+      make_shared<IntervalScannerAsync>(comm, app_queue, table, range_locator,
+                                        interval_scan_spec, timeout_ms,
+                                        !current_set, this, scanner_id++);
+    current_set = true;
+    m_interval_scanners.push_back(ri_scanner);
+    m_outstanding++;
+    if (i < split_rows.size()) {
+      sub_start = split_rows[i].c_str();
+      sub_start_inclusive = false;
+    }
+  }
+}
+
+void TableScannerAsync::init(Comm *comm, ApplicationQueueInterfacePtr &app_queue,
+        Table *table, RangeLocatorPtr &range_locator,
         const ScanSpec &scan_spec, uint32_t timeout_ms, ResultCallback *cb)
 {
   int scanner_id = 0;
@@ -414,20 +504,43 @@ void TableScannerAsync::init(Comm *comm, ApplicationQueueInterfacePtr &app_queue
   Timer timer(timeout_ms);
   bool current_set = false;
 
+  // Full-table and single-interval scans without limits or offsets can be
+  // split at range boundaries so that multiple ranges are fetched in
+  // parallel; limited/offset scans stay unsplit because their limits are
+  // global to the interval.
+  int32_t fanout = table->scanner_range_fanout();
+  bool split_ranges = fanout > 1 && !m_use_index
+    && scan_spec.cell_intervals.empty() && !scan_spec.scan_and_filter_rows
+    && scan_spec.row_intervals.size() <= 1
+    && scan_spec.row_limit == 0 && scan_spec.cell_limit == 0
+    && scan_spec.row_offset == 0 && scan_spec.cell_offset == 0;
+
   m_cb->increment_outstanding();
   m_cb->register_scanner(this);
 
   try {
     if (scan_spec.row_intervals.empty()) {
       if (scan_spec.cell_intervals.empty()) {
-        ri_scanner =
-          make_shared<IntervalScannerAsync>(comm, app_queue, table, range_locator,
-                                            scan_spec, timeout_ms, !current_set,
-                                            this, scanner_id++);
+        std::vector<String> split_rows;
+        if (split_ranges)
+          get_split_rows(table, range_locator, "", Key::END_ROW_MARKER,
+                         fanout, timeout_ms, split_rows);
+        if (!split_rows.empty()) {
+          RowInterval whole_table;
+          create_interval_scanners(comm, app_queue, table, range_locator,
+                                   scan_spec, whole_table, split_rows,
+                                   timeout_ms, current_set, scanner_id);
+        }
+        else {
+          ri_scanner =
+            make_shared<IntervalScannerAsync>(comm, app_queue, table, range_locator,
+                                              scan_spec, timeout_ms, !current_set,
+                                              this, scanner_id++);
 
-        current_set = true;
-        m_interval_scanners.push_back(ri_scanner);
-        m_outstanding++;
+          current_set = true;
+          m_interval_scanners.push_back(ri_scanner);
+          m_outstanding++;
+        }
       }
       else {
         m_interval_scanners.reserve(scan_spec.cell_intervals.size());
@@ -476,17 +589,31 @@ void TableScannerAsync::init(Comm *comm, ApplicationQueueInterfacePtr &app_queue
       }
     }
     else {
-      m_interval_scanners.reserve(scan_spec.row_intervals.size());
-      for (size_t i=0; i<scan_spec.row_intervals.size(); i++) {
-        scan_spec.base_copy(interval_scan_spec);
-        interval_scan_spec.row_intervals.push_back(scan_spec.row_intervals[i]);
-        ri_scanner =
-          make_shared<IntervalScannerAsync>(comm, app_queue, table, range_locator,
-                                            interval_scan_spec, timeout_ms, 
-                                            !current_set, this, scanner_id++);
-        current_set = true;
-        m_interval_scanners.push_back(ri_scanner);
-        m_outstanding++;
+      std::vector<String> split_rows;
+      if (split_ranges) {
+        const RowInterval &ri = scan_spec.row_intervals[0];
+        get_split_rows(table, range_locator, ri.start ? ri.start : "",
+                       (ri.end && *ri.end) ? ri.end : Key::END_ROW_MARKER,
+                       fanout, timeout_ms, split_rows);
+      }
+      if (!split_rows.empty())
+        create_interval_scanners(comm, app_queue, table, range_locator,
+                                 scan_spec, scan_spec.row_intervals[0],
+                                 split_rows, timeout_ms, current_set,
+                                 scanner_id);
+      else {
+        m_interval_scanners.reserve(scan_spec.row_intervals.size());
+        for (size_t i=0; i<scan_spec.row_intervals.size(); i++) {
+          scan_spec.base_copy(interval_scan_spec);
+          interval_scan_spec.row_intervals.push_back(scan_spec.row_intervals[i]);
+          ri_scanner =
+            make_shared<IntervalScannerAsync>(comm, app_queue, table, range_locator,
+                                              interval_scan_spec, timeout_ms,
+                                              !current_set, this, scanner_id++);
+          current_set = true;
+          m_interval_scanners.push_back(ri_scanner);
+          m_outstanding++;
+        }
       }
     }
   }
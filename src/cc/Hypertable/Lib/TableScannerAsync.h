@@ -155,6 +155,52 @@ namespace Hypertable {
     void transform_primary_scan_spec(ScanSpecBuilder &primary_spec);
     void add_index_row(ScanSpecBuilder &ssb, const char *row);
 
+    /**
+     * Computes rows at which to split a row interval so that up to
+     * <code>fanout</code> interval scanners can fetch ranges in parallel.
+     * Walks the range boundaries covered by [start_row, end_row] with the
+     * location cache and picks up to <code>fanout - 1</code> evenly spaced
+     * boundary rows.  On any location lookup failure the rows collected so
+     * far are discarded, leaving the interval unsplit.
+     *
+     * @param table pointer to the table object
+     * @param range_locator smart pointer to range locator
+     * @param start_row start row of the interval
+     * @param end_row end row of the interval
+     * @param fanout number of range scans to keep in flight
+     * @param timeout_ms maximum time in milliseconds to spend on lookups
+     * @param split_rows filled in with split rows (empty for no split)
+     */
+    void get_split_rows(Table *table, RangeLocatorPtr &range_locator,
+            const char *start_row, const char *end_row, int32_t fanout,
+            uint32_t timeout_ms, std::vector<std::string> &split_rows);
+
+    /**
+     * Creates one eager IntervalScannerAsync per sub-interval obtained by
+     * splitting <code>interval</code> at <code>split_rows</code>.  Results
+     * are still delivered in interval order through the current scanner
+     * machinery; the split only lets the sub-intervals fetch their ranges
+     * in parallel.
+     *
+     * @param comm pointer to the Comm layer
+     * @param app_queue pointer to ApplicationQueueInterface
+     * @param table pointer to the table object
+     * @param range_locator smart pointer to range locator
+     * @param scan_spec reference to scan specification object
+     * @param interval row interval being split
+     * @param split_rows rows at which to split the interval
+     * @param timeout_ms maximum time in milliseconds to allow scanner
+     *        methods to execute before throwing an exception
+     * @param current_set set to <i>true</i> once a current scanner exists
+     * @param scanner_id id to assign to the next interval scanner
+     */
+    void create_interval_scanners(Comm *comm,
+            ApplicationQueueInterfacePtr &app_queue, Table *table,
+            RangeLocatorPtr &range_locator, const ScanSpec &scan_spec,
+            const RowInterval &interval,
+            const std::vector<std::string> &split_rows, uint32_t timeout_ms,
+            bool &current_set, int &scanner_id);
+
     std::vector<IntervalScannerAsyncPtr>  m_interval_scanners;
     uint32_t            m_timeout_ms;
     int64_t             m_bytes_scanned;
@@ -0,0 +1,147 @@
+/*
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 3 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include <Common/Compat.h>
+
+#include "Table.h"
+#include "TableStreamScanner.h"
+
+#include <Common/Error.h>
+#include <Common/Logger.h>
+
+using namespace Hypertable;
+using namespace std;
+
+
+void TableStreamScannerCallback::scan_ok(TableScannerAsync *scanner,
+                                         ScanCellsPtr &cells) {
+  m_scanner->buffer_cells(cells);
+}
+
+void TableStreamScannerCallback::scan_error(TableScannerAsync *scanner,
+                                            int error,
+                                            const std::string &error_msg,
+                                            bool eos) {
+  m_scanner->set_error(error, error_msg);
+}
+
+
+TableStreamScanner::TableStreamScanner(Comm *comm,
+    ApplicationQueueInterfacePtr &app_queue, Table *table,
+    RangeLocatorPtr &range_locator, const ScanSpec &scan_spec,
+    uint32_t timeout_ms, size_t buffer_bytes, int32_t flags)
+  : m_callback(this), m_buffer_bytes(buffer_bytes) {
+  HT_ASSERT(m_buffer_bytes > 0);
+  m_scanner =
+    make_shared<TableScannerAsync>(comm, app_queue, table, range_locator,
+                                   scan_spec, timeout_ms, &m_callback, flags);
+}
+
+
+TableStreamScanner::~TableStreamScanner() {
+  try {
+    {
+      lock_guard<mutex> lock(m_mutex);
+      m_cancelled = true;
+      m_producer_cond.notify_all();
+    }
+    m_scanner->cancel();
+    m_callback.wait_for_completion();
+  }
+  catch (Exception &e) {
+    HT_ERROR_OUT << e << HT_END;
+  }
+}
+
+
+void TableStreamScanner::buffer_cells(ScanCellsPtr &cells) {
+  unique_lock<mutex> lock(m_mutex);
+  m_producer_cond.wait(lock, [this](){
+      return m_buffered_bytes < m_buffer_bytes || m_cancelled; });
+  if (m_cancelled)
+    return;
+  m_buffered_bytes += cells->memory_used();
+  m_buffer.push_back(cells);
+  m_consumer_cond.notify_one();
+}
+
+
+void TableStreamScanner::set_error(int error, const std::string &error_msg) {
+  lock_guard<mutex> lock(m_mutex);
+  if (m_error == Error::OK) {
+    m_error = error;
+    m_error_msg = error_msg;
+  }
+  m_consumer_cond.notify_one();
+}
+
+
+bool TableStreamScanner::next(Cell &cell) {
+
+  if (m_ungot.row_key) {
+    cell = m_ungot;
+    m_ungot.row_key = 0;
+    return true;
+  }
+
+  if (m_eos)
+    return false;
+
+  while (true) {
+
+    // serve out ready results
+    if (m_cur_cells_index < m_cur_cells_size) {
+      m_cur_cells->get_cell_unchecked(cell, m_cur_cells_index);
+      m_cur_cells_index++;
+      return true;
+    }
+
+    if (m_cur_cells != 0) {
+      m_eos = m_cur_cells->get_eos();
+      if (m_eos)
+        return false;
+    }
+
+    {
+      unique_lock<mutex> lock(m_mutex);
+      m_consumer_cond.wait(lock, [this](){
+          return !m_buffer.empty() || m_error != Error::OK; });
+      if (m_error != Error::OK) {
+        m_eos = true;
+        HT_THROW(m_error, m_error_msg);
+      }
+      m_cur_cells = m_buffer.front();
+      m_buffer.pop_front();
+      m_buffered_bytes -= m_cur_cells->memory_used();
+      m_producer_cond.notify_all();
+    }
+
+    m_cur_cells_index = 0;
+    m_cur_cells_size = m_cur_cells->size();
+  }
+}
+
+
+void TableStreamScanner::unget(const Cell &cell) {
+  if (m_ungot.row_key)
+    HT_THROW_(Error::DOUBLE_UNGET);
+  m_ungot = cell;
+}
@@ -0,0 +1,157 @@
+/* -*- c++ -*-
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 3 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#ifndef Hypertable_Lib_TableStreamScanner_h
+#define Hypertable_Lib_TableStreamScanner_h
+
+#include <Hypertable/Lib/ClientObject.h>
+#include <Hypertable/Lib/ResultCallback.h>
+#include <Hypertable/Lib/ScanCells.h>
+#include <Hypertable/Lib/TableScannerAsync.h>
+
+#include <condition_variable>
+#include <list>
+#include <mutex>
+
+namespace Hypertable {
+
+  /// @addtogroup libHypertable
+  /// @{
+
+  class TableStreamScanner;
+
+  /** Bounded-buffer result callback for TableStreamScanner. */
+  class TableStreamScannerCallback : public ResultCallback {
+  public:
+    TableStreamScannerCallback(TableStreamScanner *scanner)
+      : m_scanner(scanner) { }
+    void scan_ok(TableScannerAsync *scanner, ScanCellsPtr &cells) override;
+    void scan_error(TableScannerAsync *scanner, int error,
+                    const std::string &error_msg, bool eos) override;
+    void update_ok(TableMutatorAsync *mutator) override { }
+    void update_error(TableMutatorAsync *mutator, int error,
+                      FailedMutations &failures) override { }
+  private:
+    TableStreamScanner *m_scanner;
+  };
+
+  /** Synchronous table scanner with bounded client-side buffering.
+   *
+   * Unlike TableScanner, which processes RangeServer responses on the
+   * consumer thread and therefore stalls the scan pipeline between
+   * scanblocks, this scanner runs the underlying TableScannerAsync against
+   * the client's real application queue, so scanblock fetches are issued
+   * and processed while the application is consuming earlier results.  Flow
+   * control is provided by a fixed byte budget: result sets delivered by
+   * the async scanner are held in an internal buffer and, once the buffer
+   * exceeds the budget, delivering threads block until the consumer drains
+   * it.  This bounds client memory for large exports while keeping the
+   * fetch window open.
+   */
+  class TableStreamScanner : public ClientObject {
+
+  public:
+
+    /** Constructor.
+     * @param comm Comm layer object
+     * @param app_queue Application queue for response processing
+     * @param table Table object
+     * @param range_locator Smart pointer to range locator
+     * @param scan_spec Scan specification
+     * @param timeout_ms Timeout (deadline) milliseconds
+     * @param buffer_bytes Buffered result budget in bytes
+     * @param flags Scanner flags
+     */
+    TableStreamScanner(Comm *comm, ApplicationQueueInterfacePtr &app_queue,
+                       Table *table, RangeLocatorPtr &range_locator,
+                       const ScanSpec &scan_spec, uint32_t timeout_ms,
+                       size_t buffer_bytes, int32_t flags = 0);
+
+    /** Destructor.
+     * Unblocks any delivering threads, cancels the asynchronous scanner,
+     * and waits for outstanding RangeServer responses to drain.
+     */
+    virtual ~TableStreamScanner();
+
+    /** Gets the next cell.
+     * Blocks until a result set is available if the buffer is empty.
+     * @param cell The cell object to contain the result
+     * @return <i>true</i> on success, <i>false</i> on end of scan
+     */
+    bool next(Cell &cell);
+
+    /** Ungets one cell.
+     * Only one cell that's previously obtained from #next can be unget.
+     * @param cell the cell object to unget
+     * @throws exception if unget is called twice without intervening next
+     */
+    void unget(const Cell &cell);
+
+    /// Gets profile data.
+    /// @param profile_data Reference to profile data object populated by this
+    /// method
+    void get_profile_data(ProfileDataScanner &profile_data) {
+      m_scanner->get_profile_data(profile_data);
+    }
+
+  private:
+
+    friend class TableStreamScannerCallback;
+
+    /** Buffers a result set, blocking while the buffer is over budget.
+     * Called by TableStreamScannerCallback on a response processing thread.
+     * If the scanner has been cancelled the result set is dropped.
+     * @param cells Result set to buffer
+     */
+    void buffer_cells(ScanCellsPtr &cells);
+
+    /** Records a scan error and wakes the consumer.
+     * @param error Error code
+     * @param error_msg Error message
+     */
+    void set_error(int error, const std::string &error_msg);
+
+    TableStreamScannerCallback m_callback;
+    TableScannerAsyncPtr m_scanner;
+    std::mutex m_mutex;
+    std::condition_variable m_producer_cond;
+    std::condition_variable m_consumer_cond;
+    std::list<ScanCellsPtr> m_buffer;
+    size_t m_buffered_bytes {};
+    size_t m_buffer_bytes;
+    std::string m_error_msg;
+    int m_error {};
+    bool m_cancelled {};
+    ScanCellsPtr m_cur_cells;
+    size_t m_cur_cells_index {};
+    size_t m_cur_cells_size {};
+    bool m_eos {};
+    Cell m_ungot;
+  };
+
+  /// Smart pointer to TableStreamScanner.
+  typedef std::shared_ptr<TableStreamScanner> TableStreamScannerPtr;
+
+  /// @}
+
+}
+
+#endif // Hypertable_Lib_TableStreamScanner_h
@@ -23,6 +23,7 @@
 
 #include <Hypertable/Lib/Schema.h>
 
+#include <Common/DynamicBuffer.h>
 #include <Common/FileUtils.h>
 #include <Common/Logger.h>
 #include <Common/TestHarness.h>
@@ -81,6 +82,15 @@ int main(int argc, char **argv) {
     try {
       schema.reset( Schema::new_instance(schema_str) );
       schema_str = schema->render_xml(true);
+
+      // The binary encoding round trip should reproduce the schema exactly
+      DynamicBuffer dbuf(schema->encoded_length());
+      uint8_t *encode_ptr = dbuf.base;
+      schema->encode(&encode_ptr);
+      SchemaPtr decoded_schema(
+        Schema::new_instance(dbuf.base, encode_ptr - dbuf.base));
+      HT_ASSERT(decoded_schema->render_xml(true) == schema_str);
+
       FileUtils::write(harness.get_log_file_descriptor(), schema_str);
     }
     catch (Exception &e) {
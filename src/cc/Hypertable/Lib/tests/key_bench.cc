@@ -0,0 +1,119 @@
+/*
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 3 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/**
+ * Microbenchmarks for serialized key handling: Key::load() parsing and
+ * SerializedKey comparison, the two primitives every scan and merge pass
+ * through once per cell.  Parsing results are verified, so the program
+ * fails if the key format handling is broken.  Run with a small iteration
+ * count from the test harness for a quick sanity pass, or with the
+ * default count when comparing against recorded baselines.
+ */
+
+#include <Common/Compat.h>
+
+#include <Hypertable/Lib/Key.h>
+#include <Hypertable/Lib/SerializedKey.h>
+
+#include <Common/DynamicBuffer.h>
+#include <Common/Stopwatch.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+using namespace Hypertable;
+using namespace std;
+
+namespace {
+
+#define MEASURE(_label_, _code_, _n_) do { \
+  Stopwatch w; _code_; w.stop(); \
+  cout << _label_ <<": "<< (int64_t)((_n_) / w.elapsed()) <<"/s" << endl; \
+} while (0)
+
+  void verify(bool expr, const char *label) {
+    if (!expr) {
+      cout << "verification failed: " << label << endl;
+      exit(EXIT_FAILURE);
+    }
+  }
+
+} // local namespace
+
+
+int main(int argc, char *argv[]) {
+  size_t n = 1000000;
+
+  if (argc > 1)
+    n = (size_t)strtoul(argv[1], 0, 0);
+
+  DynamicBuffer buf;
+  std::vector<SerializedKey> keys;
+  char row[32];
+
+  keys.reserve(n);
+
+  // Preallocate the key buffer; create_key_and_append() grows it to exactly
+  // the needed size, which is quadratic when appending keys in bulk
+  buf.reserve(n * 48);
+
+  MEASURE("create_key_and_append", for (size_t i = 0; i < n; ++i) {
+      sprintf(row, "row-%09d", (int)i);
+      create_key_and_append(buf, FLAG_INSERT, row, (uint8_t)(i % 200) + 1,
+                            "qualifier", (int64_t)i, (int64_t)i);
+    }, n);
+
+  {
+    SerializedKey serkey(buf.base);
+    const uint8_t *end = buf.base + buf.fill();
+    while (serkey.ptr < end) {
+      keys.push_back(serkey);
+      serkey.ptr += serkey.length();
+    }
+    verify(keys.size() == n, "key count");
+  }
+
+  {
+    Key key;
+    size_t row_bytes = 0;
+    MEASURE("Key::load", for (size_t i = 0; i < n; ++i) {
+        verify(key.load(keys[i]), "Key::load");
+        row_bytes += key.row_len;
+      }, n);
+    verify(row_bytes == n * 13, "row length sum");
+  }
+
+  {
+    // Adjacent keys differ only in the trailing row digits, exercising the
+    // common long-shared-prefix comparison path
+    size_t less = 0;
+    MEASURE("SerializedKey::compare", for (size_t i = 0; i + 1 < n; ++i) {
+        if (keys[i].compare(keys[i + 1]) < 0)
+          less++;
+      }, n);
+    verify(less == n - 1, "comparison ordering");
+  }
+
+  cout << "key_bench PASSED" << endl;
+  return 0;
+}
@@ -228,61 +228,26 @@ void BalanceAlgorithmEvenRanges::compute_plan(BalancePlanPtr &plan,
   }
   
   /**
-   * Now scan thru METADATA Location and StartRow and come up with balance plan
+   * Now run thru the METADATA range inventory and come up with balance plan
    */
   {
-    ScanSpec scan_spec;
-    Cell cell;
-    String last_key, last_location, last_start_row;
-    bool read_start_row = false;
-    String location("Location"), start_row("StartRow");
-
-    scan_spec.columns.push_back(location.c_str());
-    scan_spec.columns.push_back(start_row.c_str());
-    scan_spec.max_versions = 1;
-
-    TableScannerPtr scanner(m_context->metadata_table->create_scanner(scan_spec));
-    while (scanner->next(cell)) {
-      // don't move root METADATA range
-      if (!strcmp(cell.row_key, Key::END_ROOT_ROW)) {
-        HT_DEBUG_OUT << "Skipping METADATA root range " << cell.row_key << HT_END;
-        continue;
-      }
+    Context::RangeInventory inventory;
 
-      if (last_key == cell.row_key) {
-        if (location == cell.column_family)
-          last_location = String((const char *)cell.value, cell.value_len);
-        else {
-          read_start_row = true;
-          last_start_row = String((const char *)cell.value, cell.value_len);
-        }
-      }
-      else {
-        last_key = cell.row_key;
-        if (location == cell.column_family) {
-          last_start_row.clear();
-          read_start_row = false;
-          last_location = String((const char *)cell.value, cell.value_len);
-        }
-        else {
-          last_location.clear();
-          read_start_row = true;
-          last_start_row = String((const char *)cell.value, cell.value_len);
-        }
-      }
+    m_context->scan_metadata_inventory(inventory);
 
-      HT_DEBUG_OUT << "last_key=" << last_key << ", last_location="
-                   << last_location << ", last_start_row=" << last_start_row << HT_END;
-
-      if (last_location.size() > 0 && read_start_row) {
-        size_t pos = last_key.find(':');
-        HT_ASSERT(pos != string::npos);
-        String table(last_key, 0, pos);
-        String end_row(last_key, pos+1);
-        if (maybe_add_to_plan(table, last_location, last_start_row, end_row, state, plan)) {
-          HT_DEBUG_OUT << "Added move for range " << table << ":" << end_row
-                       << ", start_row=" << last_start_row << ", location="
-                       << last_location << HT_END;
+    for (auto &entry : inventory) {
+      for (auto &range : entry.second) {
+        // don't move root METADATA range
+        if (range.table_id == TableIdentifier::METADATA_ID &&
+            range.end_row == Key::END_ROW_MARKER) {
+          HT_DEBUG_OUT << "Skipping METADATA root range" << HT_END;
+          continue;
+        }
+        if (maybe_add_to_plan(range.table_id, range.location, range.start_row,
+                              range.end_row, state, plan)) {
+          HT_DEBUG_OUT << "Added move for range " << range.table_id << ":"
+                       << range.end_row << ", start_row=" << range.start_row
+                       << ", location=" << range.location << HT_END;
         }
       }
     }
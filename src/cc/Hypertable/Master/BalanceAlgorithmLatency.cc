@@ -0,0 +1,259 @@
+/*
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 3 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include <Common/Compat.h>
+
+#include "BalanceAlgorithmLatency.h"
+
+#include <Hypertable/Lib/RS_METRICS/ReaderTable.h>
+
+using namespace Hypertable;
+using namespace Hypertable::Lib;
+using namespace Hypertable::Lib::RS_METRICS;
+using namespace std;
+
+namespace {
+  inline double weighted_mean(double weighted_latency, double request_rate) {
+    return (request_rate > 0) ? weighted_latency / request_rate : 0;
+  }
+}
+
+BalanceAlgorithmLatency::BalanceAlgorithmLatency(ContextPtr &context,
+                                                 std::vector<RangeServerStatistics> &statistics)
+  : m_context(context) {
+
+  m_latency_deviation_threshold = m_context->props->get_f64("Hypertable.LoadBalancer.LatencyThreshold");
+
+  for (auto &rs : statistics)
+    m_rsstats[rs.location] = rs;
+}
+
+
+void BalanceAlgorithmLatency::compute_plan(BalancePlanPtr &plan,
+                                           std::vector<RangeServerConnectionPtr> &balanced) {
+  vector<ServerMetrics> server_metrics;
+  RS_METRICS::ReaderTable rs_metrics(m_context->rs_metrics_table);
+  rs_metrics.get_server_metrics(server_metrics);
+
+  // Per-server range metrics must outlive the summaries, which hold
+  // pointers into them
+  map<String, RangeMetricsMap> server_ranges;
+
+  ServerLatencySummary ss;
+  ServerSetDescLatency servers_desc_latency;
+  int num_servers;
+  int num_loaded_servers=0;
+  double mean_latency=0;
+
+  for (const auto &sm : server_metrics) {
+    // only assign ranges if this RangeServer is connected
+    RangeServerConnectionPtr rsc;
+    if (m_context->rsc_manager &&
+        (!m_context->rsc_manager->find_server_by_location(sm.get_id(), rsc)
+         || !rsc->connected() || rsc->get_removed() || rsc->is_recovering())) {
+      HT_INFOF("RangeServer %s not connected, skipping", sm.get_id().c_str());
+      continue;
+    }
+
+    RangeMetricsMap &range_metrics = server_ranges[sm.get_id()];
+    rs_metrics.get_range_metrics(sm.get_id().c_str(), range_metrics);
+
+    ss.clear();
+    ss.server_id = sm.get_id().c_str();
+    calculate_server_summary(range_metrics, ss);
+
+    StatisticsSet::iterator it = m_rsstats.find(sm.get_id());
+    if (it != m_rsstats.end())
+      ss.disk_full = !m_context->can_accept_ranges(it->second);
+
+    servers_desc_latency.insert(ss);
+    mean_latency += ss.latency;
+    if (ss.request_rate > 0)
+      num_loaded_servers++;
+  }
+  num_servers = servers_desc_latency.size();
+
+  if (num_servers < 2 || num_loaded_servers < 1) {
+    HT_INFOF("No balancing required, num_servers=%d, num_loaded_servers=%d",
+             num_servers, num_loaded_servers);
+    return;
+  }
+
+  mean_latency /= num_servers;
+
+  HT_INFOF("mean_latency=%f ms, num_servers=%u, num_loaded_servers=%u, "
+           "latency_deviation_threshold=%f",
+           mean_latency, (unsigned)num_servers, (unsigned)num_loaded_servers,
+           m_latency_deviation_threshold);
+
+  while (servers_desc_latency.size() >= 2) {
+    ServerLatencySummary slowest = *(servers_desc_latency.begin());
+    ServerLatencySummary fastest = *(servers_desc_latency.rbegin());
+
+    HT_DEBUG_OUT << "slowest_server=" << slowest << ", fastest_server="
+        << fastest << HT_END;
+
+    // the slowest server's tail latency is within the acceptable deviation
+    // from the mean, so we're done
+    if (slowest.latency < m_latency_deviation_threshold + mean_latency) {
+      HT_DEBUG_OUT << "Slowest server now has estimated latency of "
+          << slowest.latency << " ms which is within the acceptable threshold ("
+          << m_latency_deviation_threshold << ") of the mean_latency "
+          << mean_latency << HT_END;
+      break;
+    }
+
+    RangeSetDescLatency ranges_desc_latency;
+    populate_range_latency_set(server_ranges[slowest.server_id],
+                               ranges_desc_latency);
+
+    RangeSetDescLatency::iterator ranges_desc_latency_it = ranges_desc_latency.begin();
+
+    while (slowest.latency > m_latency_deviation_threshold + mean_latency &&
+           ranges_desc_latency_it != ranges_desc_latency.end()) {
+      if (ranges_desc_latency_it->request_rate > 0 &&
+          check_move(fastest, *ranges_desc_latency_it, mean_latency)) {
+        // add move to balance plan
+        RangeMoveSpecPtr move = make_shared<RangeMoveSpec>(slowest.server_id,
+            fastest.server_id, ranges_desc_latency_it->table_id,
+            ranges_desc_latency_it->start_row, ranges_desc_latency_it->end_row);
+        HT_DEBUG_OUT << "Added move to plan: " << *(move.get()) << HT_END;
+        plan->moves.push_back(move);
+
+        // Recompute latency estimates.  Moving a range shifts its share of
+        // the request mix, so remove its contribution from the source and
+        // charge it to the destination.  The range's p99 on the destination
+        // will settle lower than it was on the saturated source, which makes
+        // these estimates conservative.
+        slowest.weighted_latency -= ranges_desc_latency_it->contribution();
+        slowest.request_rate -= ranges_desc_latency_it->request_rate;
+        if (slowest.weighted_latency < 0)
+          slowest.weighted_latency = 0;
+        if (slowest.request_rate < 0)
+          slowest.request_rate = 0;
+        slowest.latency = weighted_mean(slowest.weighted_latency,
+                                        slowest.request_rate);
+        fastest.weighted_latency += ranges_desc_latency_it->contribution();
+        fastest.request_rate += ranges_desc_latency_it->request_rate;
+        fastest.latency = weighted_mean(fastest.weighted_latency,
+                                        fastest.request_rate);
+
+        // erase old fastest server and reinsert with new latency estimate
+        ServerSetDescLatency::iterator it = servers_desc_latency.end();
+        --it;
+        servers_desc_latency.erase(it);
+        servers_desc_latency.insert(fastest);
+        fastest = *(servers_desc_latency.rbegin());
+      }
+      else {
+        HT_DEBUG_OUT << "Moving range " << *ranges_desc_latency_it
+            << " is not viable." << HT_END;
+      }
+      ranges_desc_latency_it++;
+    }
+
+    // erase old slowest server, since it won't be a source or destination
+    // for balancing anymore
+    servers_desc_latency.erase(servers_desc_latency.begin());
+  }
+}
+
+void
+BalanceAlgorithmLatency::calculate_server_summary(const RangeMetricsMap &range_metrics,
+    ServerLatencySummary &summary) {
+  for (const auto &vv : range_metrics) {
+    RangeLatencySummary range_summary;
+    calculate_range_summary(vv.second, range_summary);
+    summary.weighted_latency += range_summary.contribution();
+    summary.request_rate += range_summary.request_rate;
+  }
+  summary.latency = weighted_mean(summary.weighted_latency,
+                                  summary.request_rate);
+}
+
+void BalanceAlgorithmLatency::calculate_range_summary(const RangeMetrics &metrics,
+    RangeLatencySummary &summary) {
+
+  bool start_row_set;
+  summary.table_id  = metrics.get_table_id().c_str();
+  summary.start_row = metrics.get_start_row(&start_row_set).c_str();
+  summary.end_row   = metrics.get_end_row().c_str();
+
+  // blend the per-measurement scan and update p99s, weighting each by its
+  // request rate
+  double weighted_latency = 0;
+  double request_rate = 0;
+  const vector<RangeMeasurement> &measurements = metrics.get_measurements();
+  if (measurements.size() > 0) {
+    for (const auto &measurement : measurements) {
+      weighted_latency += measurement.scan_rate * measurement.scan_latency_p99
+          + measurement.update_rate * measurement.update_latency_p99;
+      request_rate += measurement.scan_rate + measurement.update_rate;
+    }
+    summary.latency_p99 = weighted_mean(weighted_latency, request_rate);
+    summary.request_rate = request_rate / measurements.size();
+  }
+}
+
+
+void BalanceAlgorithmLatency::populate_range_latency_set(const RangeMetricsMap &range_metrics, RangeSetDescLatency &ranges_desc_latency) {
+
+  ranges_desc_latency.clear();
+  for (const auto &vv : range_metrics) {
+    // don't consider ranges that can't be moved
+    if (!vv.second.is_moveable())
+      continue;
+    RangeLatencySummary summary;
+    calculate_range_summary(vv.second, summary);
+    ranges_desc_latency.insert(summary);
+  }
+}
+
+bool BalanceAlgorithmLatency::check_move(const ServerLatencySummary &destination,
+    const RangeLatencySummary &range, double mean_latency) {
+  if (destination.disk_full)
+    return false;
+  // make sure that this move doesn't push the latency of the target beyond
+  // the acceptable deviation from the mean
+  double latency_destination =
+      weighted_mean(destination.weighted_latency + range.contribution(),
+                    destination.request_rate + range.request_rate);
+  return (latency_destination < m_latency_deviation_threshold + mean_latency);
+}
+
+/** @relates BalanceAlgorithmLatency::ServerLatencySummary */
+ostream &Hypertable::operator<<(ostream &out,
+    const BalanceAlgorithmLatency::ServerLatencySummary &summary) {
+  out << "{ServerLatencySummary: server_id=" << summary.server_id
+      << ", latency=" << summary.latency << ", request_rate="
+      << summary.request_rate << "}";
+  return out;
+}
+
+/** @relates BalanceAlgorithmLatency::RangeLatencySummary */
+ostream &Hypertable::operator<<(ostream &out,
+    const BalanceAlgorithmLatency::RangeLatencySummary &summary) {
+  out << "{RangeLatencySummary: table_id=" << summary.table_id << ", start_row="
+      << summary.start_row  << ", end_row=" << summary.end_row
+      << ", latency_p99=" << summary.latency_p99 << ", request_rate="
+      << summary.request_rate << "}";
+  return out;
+}
@@ -0,0 +1,141 @@
+/* -*- c++ -*-
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 3 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#ifndef Hypertable_Master_BalanceAlgorithmLatency_h
+#define Hypertable_Master_BalanceAlgorithmLatency_h
+
+
+#include <Hypertable/Lib/RS_METRICS/RangeMetrics.h>
+#include <Hypertable/Lib/RS_METRICS/ServerMetrics.h>
+
+#include <set>
+#include <map>
+#include <iostream>
+#include <vector>
+
+#include "BalanceAlgorithm.h"
+#include "RangeServerStatistics.h"
+#include "Context.h"
+
+
+namespace Hypertable {
+
+  /// Balance algorithm that equalizes tail latency across servers.
+  /// Whereas BalanceAlgorithmLoad weighs ranges by byte and request rates, a
+  /// server can be "balanced" by those measures and still be saturated on
+  /// latency.  This algorithm characterizes each server by its
+  /// request-rate-weighted mean of per-range p99 scan and update latencies
+  /// (from the <i>sys/RS_METRICS</i> table) and moves the ranges contributing
+  /// most to the tail off of servers whose latency deviates from the mean by
+  /// more than <code>Hypertable.LoadBalancer.LatencyThreshold</code>.
+  class BalanceAlgorithmLatency : public BalanceAlgorithm {
+    public:
+
+    BalanceAlgorithmLatency(ContextPtr &context,
+                            std::vector<RangeServerStatistics> &statistics);
+
+    virtual void compute_plan(BalancePlanPtr &plan,
+                              std::vector<RangeServerConnectionPtr> &balanced);
+
+    public:
+      class ServerLatencySummary {
+      public:
+        ServerLatencySummary() { clear(); }
+
+        void clear() {
+          latency = weighted_latency = request_rate = 0;
+          server_id = 0;
+          disk_full = false;
+        }
+
+        /// Request-rate-weighted mean p99 latency (milliseconds)
+        double latency;
+        /// Sum over ranges of request rate times p99 latency
+        double weighted_latency;
+        /// Sum over ranges of scan plus update rate
+        double request_rate;
+        const char *server_id;
+        bool disk_full;
+      };
+
+      struct GtServerLatencySummary {
+        bool operator() (const ServerLatencySummary &x,
+            const ServerLatencySummary &y) const {
+          return x.latency > y.latency;
+        }
+      };
+
+      typedef std::multiset<ServerLatencySummary, GtServerLatencySummary> ServerSetDescLatency;
+
+      class RangeLatencySummary {
+      public:
+        RangeLatencySummary() { clear(); }
+        void clear() {
+          latency_p99 = request_rate = 0;
+          table_id = start_row = end_row = 0;
+        }
+        /// Contribution of this range to its server's weighted latency
+        double contribution() const { return latency_p99 * request_rate; }
+
+        /// Rate-blended p99 of scan and update latency (milliseconds)
+        double latency_p99;
+        /// Scan plus update rate
+        double request_rate;
+        const char *table_id;
+        const char *start_row;
+        const char *end_row;
+      };
+      struct GtRangeLatencySummary {
+        bool operator() (const RangeLatencySummary &x,
+            const RangeLatencySummary &y) const {
+          return x.contribution() > y.contribution();
+        }
+      };
+      typedef std::multiset<RangeLatencySummary, GtRangeLatencySummary> RangeSetDescLatency;
+
+    private:
+
+      void
+      calculate_server_summary(const Lib::RS_METRICS::RangeMetricsMap &range_metrics,
+                               ServerLatencySummary &summary);
+
+      void calculate_range_summary(const Lib::RS_METRICS::RangeMetrics &metrics,
+                                   RangeLatencySummary &summary);
+
+      void populate_range_latency_set(const Lib::RS_METRICS::RangeMetricsMap &range_metrics,
+                                      RangeSetDescLatency &ranges_desc_latency);
+
+      bool check_move(const ServerLatencySummary &destination,
+                      const RangeLatencySummary &range, double mean_latency);
+
+      typedef std::map<String, RangeServerStatistics> StatisticsSet;
+      StatisticsSet m_rsstats;
+      double m_latency_deviation_threshold;
+      ContextPtr m_context;
+  };
+
+  std::ostream &operator<<(std::ostream &out,
+                const BalanceAlgorithmLatency::ServerLatencySummary &summary);
+  std::ostream &operator<<(std::ostream &out,
+                const BalanceAlgorithmLatency::RangeLatencySummary &summary);
+} // namespace Hypertable
+
+#endif // Hypertable_Master_BalanceAlgorithmLatency_h
@@ -63,12 +63,6 @@ void BalanceAlgorithmOffload::compute_plan(BalancePlanPtr &plan,
 
   locations_it = locations.begin();
 
-  ScanSpec scan_spec;
-  Cell cell;
-  String last_key, last_location, last_start_row;
-  bool read_start_row = false;
-  String location("Location"), start_row("StartRow");
-
   // check if we need to move root range
   if (m_offload_servers.find(root_location) != m_offload_servers.end()) {
     String new_location = *locations_it;
@@ -86,57 +80,29 @@ void BalanceAlgorithmOffload::compute_plan(BalancePlanPtr &plan,
           << new_location << HT_END;
   }
 
-  scan_spec.columns.push_back(location.c_str());
-  scan_spec.columns.push_back(start_row.c_str());
-  scan_spec.max_versions = 1;
-
-  TableScannerPtr scanner(m_context->metadata_table->create_scanner(scan_spec));
-  while (scanner->next(cell)) {
-    if (last_key == cell.row_key) {
-      if (location == cell.column_family)
-        last_location = String((const char *)cell.value, cell.value_len);
-      else {
-        read_start_row = true;
-        last_start_row = String((const char *)cell.value, cell.value_len);
-      }
-    }
-    else {
-      last_key = cell.row_key;
-      if (location == cell.column_family) {
-        last_start_row.clear();
-        read_start_row = false;
-        last_location = String((const char *)cell.value, cell.value_len);
-      }
-      else {
-        last_location.clear();
-        read_start_row = true;
-        last_start_row = String((const char *)cell.value, cell.value_len);
-      }
-    }
-
-    HT_DEBUG_OUT << "last_key=" << last_key << ", last_location="
-        << last_location << ", last_start_row=" << last_start_row << HT_END;
+  Context::RangeInventory inventory;
+  m_context->scan_metadata_inventory(inventory);
 
-    // check if this range is on one of the offload servers
-    if (last_location.size() > 0 && read_start_row &&
-        m_offload_servers.find(last_location) != m_offload_servers.end()) {
-      size_t pos = last_key.find(':');
-      HT_ASSERT(pos != string::npos);
-      String table(last_key, 0, pos);
-      String end_row(last_key, pos+1);
+  for (auto &entry : inventory) {
+    // only move ranges that live on one of the offload servers
+    if (m_offload_servers.find(entry.first) == m_offload_servers.end())
+      continue;
+    for (auto &range : entry.second) {
       String new_location = *locations_it;
       locations_it++;
       if (locations_it == locations.end())
         locations_it = locations.begin();
 
-      RangeMoveSpecPtr move = make_shared<RangeMoveSpec>(last_location.c_str(),
+      RangeMoveSpecPtr move = make_shared<RangeMoveSpec>(range.location.c_str(),
                                     new_location.c_str(),
-                                    table.c_str(), last_start_row.c_str(),
-                                    end_row.c_str());
+                                    range.table_id.c_str(),
+                                    range.start_row.c_str(),
+                                    range.end_row.c_str());
       plan->moves.push_back(move);
 
-      HT_DEBUG_OUT << table << "[" << last_start_row << ".." << end_row << "] "
-          << last_location << "->" << new_location << HT_END;
+      HT_DEBUG_OUT << range.table_id << "[" << range.start_row << ".."
+          << range.end_row << "] " << range.location << "->" << new_location
+          << HT_END;
     }
   }
 }
@@ -39,6 +39,7 @@
 #include "OperationDropTable.h"
 #include "OperationGatherStatistics.h"
 #include "OperationMoveRange.h"
+#include "OperationNamespaceListing.h"
 #include "OperationProcessor.h"
 #include "OperationRecover.h"
 #include "OperationRecreateIndexTables.h"
@@ -120,6 +121,11 @@ void ConnectionHandler::handle(EventPtr &event) {
         m_context->response_manager->add_delivery_info(operation->id(), event);
         m_context->op->add_operation(operation);
         return;
+      case Lib::Master::Protocol::COMMAND_NAMESPACE_LISTING:
+        operation = make_shared<OperationNamespaceListing>(m_context, event);
+        m_context->response_manager->add_delivery_info(operation->id(), event);
+        m_context->op->add_operation(operation);
+        return;
       case Lib::Master::Protocol::COMMAND_COMPACT:
         operation = make_shared<OperationCompact>(m_context, event);
         break;
@@ -188,6 +194,10 @@ void ConnectionHandler::handle(EventPtr &event) {
           m_context->response_manager->add_delivery_info(params.get_id(), event);
         }
         return;
+      case Lib::Master::Protocol::COMMAND_REPORT_SUSPECT:
+        m_context->report_suspect(event);
+        send_ok_response(event);
+        return;
       case Lib::Master::Protocol::COMMAND_REPLAY_STATUS:
         m_context->replay_status(event);
         send_ok_response(event);
@@ -33,13 +33,17 @@
 #include "Operation.h"
 #include "OperationProcessor.h"
 #include "OperationRecover.h"
+#include "OperationRecoverPrepare.h"
 #include "OperationTimedBarrier.h"
 #include "ReferenceManager.h"
 
+#include <Hypertable/Lib/Future.h>
+#include <Hypertable/Lib/TableScannerAsync.h>
 #include <Hypertable/Lib/Master/Request/Parameters/PhantomCommitComplete.h>
 #include <Hypertable/Lib/Master/Request/Parameters/PhantomPrepareComplete.h>
 #include <Hypertable/Lib/Master/Request/Parameters/ReplayComplete.h>
 #include <Hypertable/Lib/Master/Request/Parameters/ReplayStatus.h>
+#include <Hypertable/Lib/Master/Request/Parameters/ReportSuspect.h>
 
 #include <FsBroker/Lib/Client.h>
 
@@ -202,6 +206,133 @@ TablePtr Context::new_table(const std::string &name) {
                             hyperspace, aq, namemap, name);
 }
 
+void Context::scan_metadata_inventory(RangeInventory &inventory) {
+  ScanSpec scan_spec;
+
+  scan_spec.columns.push_back("Location");
+  scan_spec.columns.push_back("StartRow");
+  scan_spec.max_versions = 1;
+
+  Future ff;
+  TableScannerAsyncPtr scanner(
+      metadata_table->create_scanner_async(&ff, scan_spec));
+
+  inventory.clear();
+
+  String last_key, last_location, last_start_row;
+  bool location_set {}, start_row_set {};
+
+  // Emits the accumulated row once both columns have been seen; rows with
+  // no assigned location (or the "!" placeholder) are dropped
+  auto emit_row = [&]() {
+    if (!location_set || !start_row_set)
+      return;
+    boost::trim(last_location);
+    if (last_location.empty() || last_location == "!")
+      return;
+    size_t pos = last_key.find(':');
+    HT_ASSERT(pos != string::npos);
+    inventory[last_location].push_back(
+        InventoryRange(String(last_key, 0, pos), last_start_row,
+                       String(last_key, pos+1), last_location));
+  };
+
+  ResultPtr result;
+  Cells cells;
+  while (ff.get(result)) {
+    if (result->is_error()) {
+      int error;
+      String error_msg;
+      result->get_error(error, error_msg);
+      HT_THROW(error, error_msg);
+    }
+    result->get_cells(cells);
+    for (auto &cell : cells) {
+      if (last_key != cell.row_key) {
+        emit_row();
+        last_key = cell.row_key;
+        location_set = start_row_set = false;
+      }
+      if (!strcmp(cell.column_family, "Location")) {
+        last_location = String((const char *)cell.value, cell.value_len);
+        location_set = true;
+      }
+      else {
+        last_start_row = String((const char *)cell.value, cell.value_len);
+        start_row_set = true;
+      }
+    }
+  }
+  emit_row();
+}
+
+void Context::report_suspect(EventPtr &event) {
+  Lib::Master::Request::Parameters::ReportSuspect params;
+  const uint8_t *decode_ptr = event->payload;
+  size_t decode_remain = event->payload_len;
+
+  params.decode(&decode_ptr, &decode_remain);
+
+  const String &suspect = params.location();
+  const String &reporter = params.reporter();
+
+  {
+    lock_guard<std::mutex> lock(mutex);
+    if (available_servers.count(suspect) == 0) {
+      HT_DEBUG_OUT << "Ignoring suspicion report for " << suspect
+                   << " (not available)" << HT_END;
+      return;
+    }
+  }
+
+  // Majority of available servers, not counting the suspect itself
+  size_t quorum = ((available_server_count() - 1) / 2) + 1;
+  size_t reporter_count = 0;
+  bool quorum_confirmed = false;
+  auto now = chrono::steady_clock::now();
+  int32_t window = props->get_i32("Hypertable.Master.Gossip.Suspicion.Window");
+
+  {
+    lock_guard<std::mutex> lock(m_suspicion_mutex);
+    SuspicionRecord &record = m_suspicions[suspect];
+    if (record.reporters.empty() ||
+        now - record.first_report > chrono::milliseconds(window)) {
+      record.reporters.clear();
+      record.first_report = now;
+      record.prepare_dispatched = false;
+    }
+    record.reporters.insert(reporter);
+    reporter_count = record.reporters.size();
+    if (reporter_count >= quorum && !record.prepare_dispatched) {
+      record.prepare_dispatched = true;
+      quorum_confirmed = true;
+    }
+  }
+
+  HT_INFOF("report_suspect(%s) from %s (%d of %d reports)", suspect.c_str(),
+           reporter.c_str(), (int)reporter_count, (int)quorum);
+
+  if (quorum_confirmed) {
+    String subject = format("NOTICE: %s suspected down by gossip quorum",
+                            suspect.c_str());
+    String message = format("Failure of range server %s has been reported by "
+                            "%d of its peers.  Starting speculative recovery "
+                            "preparation.", suspect.c_str(),
+                            (int)reporter_count);
+    HT_WARNF("%s", message.c_str());
+    notification_hook(subject, message);
+    try {
+      ContextPtr context = shared_from_this();
+      OperationPtr operation =
+        make_shared<OperationRecoverPrepare>(context, suspect);
+      op->add_operation(operation);
+    }
+    catch (Exception &e) {
+      HT_INFOF("%s - %s", Error::get_text(e.code()), e.what());
+    }
+  }
+}
+
 void Context::replay_status(EventPtr &event) {
   Lib::Master::Request::Parameters::ReplayStatus params;
   const uint8_t *decode_ptr = event->payload;
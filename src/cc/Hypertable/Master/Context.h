@@ -61,9 +61,11 @@
 #include <boost/thread/condition.hpp>
 
 #include <condition_variable>
+#include <map>
 #include <memory>
 #include <mutex>
 #include <set>
+#include <vector>
 #include <unordered_map>
 
 using namespace Hypertable::Master;
@@ -218,6 +220,18 @@ namespace Hypertable {
     void get_available_servers(StringSet &servers);
 
     bool can_accept_ranges(const RangeServerStatistics &stats);
+
+    /// Processes a gossip failure suspicion report.
+    /// Decodes a <i>report suspect</i> request and records the reporter
+    /// against the suspected server.  Reports older than
+    /// <code>Hypertable.Master.Gossip.Suspicion.Window</code> milliseconds
+    /// are discarded.  Once a majority of the available servers concur on a
+    /// suspect, an OperationRecoverPrepare is added to the operation
+    /// processor to speculatively begin recovery preparation while the
+    /// suspect's Hyperspace lease clock still runs.
+    /// @param event %Event object holding <i>report suspect</i> request
+    void report_suspect(EventPtr &event);
+
     void replay_status(EventPtr &event);
     void replay_complete(EventPtr &event);
     void prepare_complete(EventPtr &event);
@@ -241,10 +255,56 @@ namespace Hypertable {
     // Instantiate a new table object
     TablePtr new_table(const std::string &name);
 
+    /// Single METADATA range inventory entry.
+    /// @see scan_metadata_inventory()
+    class InventoryRange {
+    public:
+      InventoryRange(const String &table_id, const String &start_row,
+                     const String &end_row, const String &location)
+        : table_id(table_id), start_row(start_row), end_row(end_row),
+          location(location) { }
+      String table_id;
+      String start_row;
+      String end_row;
+      String location;
+    };
+
+    /// Range inventory indexed by server location.
+    typedef std::map<String, std::vector<InventoryRange>> RangeInventory;
+
+    /// Bulk-reads the range inventory from the METADATA table.
+    /// Fetches the <i>Location</i> and <i>StartRow</i> columns for every
+    /// range in a single pass with one asynchronous scanner and indexes the
+    /// results by server location, so callers that need a cluster-wide view
+    /// (balance planning, recovery planning) avoid issuing one synchronous
+    /// METADATA scan per table or server.  Rows without an assigned location
+    /// are omitted; the root METADATA range is included and it is up to the
+    /// caller to exclude it where it must not be moved.
+    /// @param inventory Output map from server location to the ranges it
+    /// holds
+    void scan_metadata_inventory(RangeInventory &inventory);
+
   private:
 
+    /// Accumulated suspicion reports for one server.
+    /// @see report_suspect()
+    struct SuspicionRecord {
+      /// Distinct reporters concurring on the suspicion
+      StringSet reporters;
+      /// Time of first report in the current window
+      std::chrono::steady_clock::time_point first_report;
+      /// Flag indicating recovery preparation has been dispatched
+      bool prepare_dispatched {};
+    };
+
     RecoveryState m_recovery_state;
 
+    /// %Mutex for serializing access to #m_suspicions
+    std::mutex m_suspicion_mutex;
+
+    /// Suspicion reports indexed by suspected server location
+    std::map<String, SuspicionRecord> m_suspicions;
+
     /// BalancePlanAuthority entity
     MetaLog::EntityPtr m_balance_plan_authority {};
 
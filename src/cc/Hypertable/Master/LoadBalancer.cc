@@ -21,6 +21,7 @@
 #include <Common/Compat.h>
 
 #include "BalanceAlgorithmEvenRanges.h"
+#include "BalanceAlgorithmLatency.h"
 #include "BalanceAlgorithmLoad.h"
 #include "BalanceAlgorithmOffload.h"
 #include "LoadBalancer.h"
@@ -156,6 +157,8 @@ void LoadBalancer::create_plan(BalancePlanPtr &plan,
       algo = make_shared<BalanceAlgorithmEvenRanges>(m_context, m_statistics);
     else if (name == "load")
       algo = make_shared<BalanceAlgorithmLoad>(m_context, m_statistics);
+    else if (name == "latency")
+      algo = make_shared<BalanceAlgorithmLatency>(m_context, m_statistics);
     else
       HT_THROWF(Error::MASTER_BALANCE_PREVENTED,
                 "Unrecognized algorithm - %s", name.c_str());
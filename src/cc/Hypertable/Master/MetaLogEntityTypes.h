@@ -97,7 +97,8 @@ namespace Hypertable {
         OPERATION_REGISTER_SERVER_BLOCKER    = 0x0003001D,
         OPERATION_TOGGLE_TABLE_MAINTENANCE   = 0x0003001E,
         OPERATION_RECREATE_INDEX_TABLES      = 0x0003001F,
-        RECOVERED_SERVERS                    = 0x00030020
+        RECOVERED_SERVERS                    = 0x00030020,
+        OPERATION_RECOVER_SERVER_PREPARE     = 0x00030021
       };
     }
   }
@@ -79,6 +79,13 @@ void MetricsHandler::handle(Hypertable::EventPtr &event) {
     m_ganglia_collector->update("operations", m_operations.rate(elapsed_secs));
     m_operations.reset();
 
+    {
+      lock_guard<mutex> lock(m_queue_depth_mutex);
+      for (auto &entry : m_queue_depths)
+        m_ganglia_collector->update("operationQueue." + entry.first,
+                                    (int32_t)entry.second);
+    }
+
     try {
       m_ganglia_collector->publish();
     }
@@ -35,8 +35,10 @@
 #include <Common/Properties.h>
 #include <Common/metrics>
 
+#include <map>
 #include <memory>
 #include <mutex>
+#include <string>
 
 namespace Hypertable {
 
@@ -79,6 +81,17 @@ namespace Hypertable {
       m_operations.current++;
     }
 
+    /// Adjusts an operation queue depth gauge.
+    /// Adjusts the queue depth gauge for the admission class
+    /// <code>name</code> by <code>delta</code>.  The gauge is published as
+    /// <code>operationQueue.&lt;name&gt;</code>.
+    /// @param name Admission class name
+    /// @param delta Amount by which to adjust the queue depth
+    void queue_depth_adjust(const std::string &name, int64_t delta) {
+      std::lock_guard<std::mutex> lock(m_queue_depth_mutex);
+      m_queue_depths[name] += delta;
+    }
+
   private:
 
     /// Comm layer
@@ -99,6 +112,12 @@ namespace Hypertable {
     /// %Master operations
     interval_metric<int64_t> m_operations {};
 
+    /// %Mutex protecting #m_queue_depths
+    std::mutex m_queue_depth_mutex;
+
+    /// Operation queue depth per admission class
+    std::map<std::string, int64_t> m_queue_depths;
+
     /// Collection has started
     bool m_started {};
   };
@@ -38,6 +38,8 @@
 #include <cstdlib>
 
 extern "C" {
+#include <sys/resource.h>
+#include <sys/syscall.h>
 #include <unistd.h>
 }
 
@@ -63,6 +65,17 @@ Monitoring::Monitoring(Context *context)
   m_namemap_ptr = m_context->namemap;
 
   memset(m_last_server_set_digest, 0, 16);
+
+  m_emission_thread = Thread([this]() { emission_loop(); });
+}
+
+Monitoring::~Monitoring() {
+  {
+    lock_guard<mutex> lock(m_mutex);
+    m_shutdown = true;
+    m_emission_cond.notify_one();
+  }
+  m_emission_thread.join();
 }
 
 void Monitoring::create_dir(const String &dir) {
@@ -98,6 +111,9 @@ void Monitoring::drop_server(const String &location) {
   RangeServerMap::iterator iter = m_server_map.find(location);
   if (iter != m_server_map.end())
     m_server_map.erase(iter);
+
+  // Remove the server's contribution from the table stats aggregate
+  apply_table_stats_delta(location, 0, 0);
 }
 
 namespace {
@@ -122,13 +138,14 @@ void Monitoring::add(std::vector<RangeServerStatistics> &stats) {
   double numerator, denominator;
   int32_t server_count = 0;
   CstrSet server_set;
+  EmissionWorkloadPtr workload = make_shared<EmissionWorkload>();
 
   // to keep track max timestamp across rangeserver
   // this value is used to update table rrds
   table_stats_timestamp = 0;
-  // copy to previous hashmap to calculate read rates
+  // snapshot the aggregate before this sweep's deltas are applied so that
+  // read and write rates can be derived below
   m_prev_table_stat_map = m_table_stat_map;
-  m_table_stat_map.clear(); // clear the previous contents
 
   for (size_t i = 0; i < stats.size(); i++) {
     memset(&rrd_data, 0, sizeof(rrd_data));
@@ -230,16 +247,12 @@ void Monitoring::add(std::vector<RangeServerStatistics> &stats) {
 
     compute_clock_skew(stats[i].stats->timestamp, &stats[i]);
 
-    String rrd_file = m_monitoring_rs_dir + "/" + stats[i].location + "_stats_v0.rrd";
-
-    if (!FileUtils::exists(rrd_file))
-      create_rangeserver_rrd(rrd_file);
-
     if (rrd_data.timestamp > table_stats_timestamp) {
       table_stats_timestamp = rrd_data.timestamp;
     }
-    update_rangeserver_rrd(rrd_file, rrd_data);
-    add_table_stats(stats[i].stats->tables,stats[i].fetch_timestamp);
+    workload->server_updates.push_back(make_pair(stats[i].location, rrd_data));
+    apply_table_stats_delta(stats[i].location, &stats[i].stats->tables,
+                            stats[i].fetch_timestamp);
 
     (*iter).second->stats = stats[i].stats;
     (*iter).second->fetch_error = stats[i].fetch_error;
@@ -256,41 +269,10 @@ void Monitoring::add(std::vector<RangeServerStatistics> &stats) {
   unsigned char server_set_digest[16];
   md5_finish(&md5_ctx, server_set_digest);
 
-  // calcualte read rates from previous table stats map
-
-  // finish compression ratio aggregation
-  for (TableStatMap::iterator iter = m_table_stat_map.begin();
-       iter != m_table_stat_map.end(); ++iter) {
-    if (iter->second.disk_used != 0)
-      iter->second.compression_ratio =
-	(double)iter->second.disk_used / iter->second.compression_ratio;
-    else
-      iter->second.compression_ratio = 1.0;
-    if (iter->second.cell_count != 0) {
-      iter->second.average_key_size /= iter->second.cell_count;
-      iter->second.average_value_size /= iter->second.cell_count;
-    }
-    else {
-      iter->second.average_key_size = 0.0;
-      iter->second.average_value_size = 0.0;
-    }
-  }
-
-  // Dump RangeServer summary data
-  std::vector<RangeServerStatistics> stats_vec;
-  struct LtRangeServerStatistics comp;
-  stats_vec.reserve(m_server_map.size());
-  for (iter = m_server_map.begin(); iter != m_server_map.end(); ++iter)
-    stats_vec.push_back(*(*iter).second);
-  sort(stats_vec.begin(), stats_vec.end(), comp);
-  dump_rangeserver_summary_json(stats_vec);
-
-  // create Table rrd data
+  // calculate read rates and write rates from previous table stats map
   TableStatMap::iterator ts_iter;
   TableStatMap::iterator prev_iter;
   for(ts_iter = m_table_stat_map.begin();ts_iter != m_table_stat_map.end(); ++ts_iter) {
-
-    // calculate read rates and write rates
     prev_iter = m_prev_table_stat_map.find(ts_iter->first);
     if (prev_iter != m_prev_table_stat_map.end()) {
       if (server_count != m_last_server_count ||
@@ -310,79 +292,255 @@ void Monitoring::add(std::vector<RangeServerStatistics> &stats) {
       }
       else {
         double elapsed_time = (double)(ts_iter->second.fetch_timestamp - prev_iter->second.fetch_timestamp) / 1000000000.0;
-        ts_iter->second.scan_rate = (ts_iter->second.scans - prev_iter->second.scans) / elapsed_time;
-        ts_iter->second.update_rate = (ts_iter->second.updates - prev_iter->second.updates) / elapsed_time;
-        ts_iter->second.cell_read_rate = (ts_iter->second.cells_read - prev_iter->second.cells_read) / elapsed_time;
-        ts_iter->second.cell_write_rate = (ts_iter->second.cells_written - prev_iter->second.cells_written) / elapsed_time;
-        ts_iter->second.byte_read_rate = (ts_iter->second.bytes_read - prev_iter->second.bytes_read) / elapsed_time;
-        ts_iter->second.byte_write_rate = (ts_iter->second.bytes_written - prev_iter->second.bytes_written) / elapsed_time;
-        ts_iter->second.disk_read_rate = (ts_iter->second.disk_bytes_read - prev_iter->second.disk_bytes_read) / elapsed_time;
+        // a table whose servers all failed to report this sweep retains its
+        // previous counters and timestamp; leave its rates alone
+        if (elapsed_time > 0.0) {
+          ts_iter->second.scan_rate = (ts_iter->second.scans - prev_iter->second.scans) / elapsed_time;
+          ts_iter->second.update_rate = (ts_iter->second.updates - prev_iter->second.updates) / elapsed_time;
+          ts_iter->second.cell_read_rate = (ts_iter->second.cells_read - prev_iter->second.cells_read) / elapsed_time;
+          ts_iter->second.cell_write_rate = (ts_iter->second.cells_written - prev_iter->second.cells_written) / elapsed_time;
+          ts_iter->second.byte_read_rate = (ts_iter->second.bytes_read - prev_iter->second.bytes_read) / elapsed_time;
+          ts_iter->second.byte_write_rate = (ts_iter->second.bytes_written - prev_iter->second.bytes_written) / elapsed_time;
+          ts_iter->second.disk_read_rate = (ts_iter->second.disk_bytes_read - prev_iter->second.disk_bytes_read) / elapsed_time;
+        }
       }
     }
+  }
 
-    String table_file_name = ts_iter->first;
-    String rrd_file = m_monitoring_table_dir + "/" + table_file_name + "_table_stats_v0.rrd";
-    if (!FileUtils::exists(rrd_file)) {
-        String dir;
-        size_t slash_pos;
-        slash_pos = table_file_name.rfind("/");
-        if (slash_pos != string::npos) {
-            dir = table_file_name.substr(0,slash_pos+1);
-        }
-        String table_dir = m_monitoring_table_dir + "/"+dir;
-        if (!FileUtils::exists(table_dir)) {
-            if (!FileUtils::mkdirs(table_dir)) {
-                HT_THROW(Error::LOCAL_IO_ERROR, "Unable to create table dir");
-            }
-        }
-        create_table_rrd(rrd_file);
+  // Snapshot the table stats aggregate for emission, finishing compression
+  // ratio and average key/value size aggregation in the copy so the running
+  // aggregates stay in raw form
+  workload->table_stats = m_table_stat_map;
+  for (ts_iter = workload->table_stats.begin();
+       ts_iter != workload->table_stats.end(); ++ts_iter) {
+    if (ts_iter->second.disk_used != 0)
+      ts_iter->second.compression_ratio =
+	(double)ts_iter->second.disk_used / ts_iter->second.compression_ratio;
+    else
+      ts_iter->second.compression_ratio = 1.0;
+    if (ts_iter->second.cell_count != 0) {
+      ts_iter->second.average_key_size /= ts_iter->second.cell_count;
+      ts_iter->second.average_value_size /= ts_iter->second.cell_count;
+    }
+    else {
+      ts_iter->second.average_key_size = 0.0;
+      ts_iter->second.average_value_size = 0.0;
     }
-    update_table_rrd(rrd_file,ts_iter->second);
   }
-  dump_table_summary_json();
 
-  dump_master_summary_json();
+  // Snapshot RangeServer summary data
+  struct LtRangeServerStatistics comp;
+  workload->server_summary.reserve(m_server_map.size());
+  for (iter = m_server_map.begin(); iter != m_server_map.end(); ++iter)
+    workload->server_summary.push_back(*(*iter).second);
+  sort(workload->server_summary.begin(), workload->server_summary.end(), comp);
+
+  workload->table_stats_timestamp = table_stats_timestamp;
+
+  // Hand the workload to the emission thread.  If the previous sweep's
+  // workload is still pending, replace it rather than letting the queue
+  // grow behind a slow rrdtool
+  if (!m_workload_queue.empty()) {
+    HT_WARNF("Monitoring emission thread falling behind; dropping %d "
+             "queued workload(s)", (int)m_workload_queue.size());
+    m_workload_queue.clear();
+  }
+  m_workload_queue.push_back(workload);
+  m_emission_cond.notify_one();
 
   m_last_server_count = server_count;
 
 }
 
-void Monitoring::add_table_stats(std::vector<StatsTable> &table_stats,int64_t fetch_timestamp) {
+void Monitoring::accumulate_table_stats(table_rrd_data &aggregate,
+                                        const table_rrd_data &delta,
+                                        bool subtract) {
+  if (subtract) {
+    aggregate.range_count -= delta.range_count;
+    aggregate.scanner_count -= delta.scanner_count;
+    aggregate.cell_count -= delta.cell_count;
+    aggregate.file_count -= delta.file_count;
+    aggregate.scans -= delta.scans;
+    aggregate.cells_read -= delta.cells_read;
+    aggregate.bytes_read -= delta.bytes_read;
+    aggregate.disk_bytes_read -= delta.disk_bytes_read;
+    aggregate.updates -= delta.updates;
+    aggregate.cells_written -= delta.cells_written;
+    aggregate.bytes_written -= delta.bytes_written;
+    aggregate.disk_used -= delta.disk_used;
+    aggregate.average_key_size -= delta.average_key_size;
+    aggregate.average_value_size -= delta.average_value_size;
+    aggregate.compression_ratio -= delta.compression_ratio;
+    aggregate.memory_used -= delta.memory_used;
+    aggregate.memory_allocated -= delta.memory_allocated;
+    aggregate.shadow_cache_memory -= delta.shadow_cache_memory;
+    aggregate.block_index_memory -= delta.block_index_memory;
+    aggregate.bloom_filter_memory -= delta.bloom_filter_memory;
+    aggregate.bloom_filter_accesses -= delta.bloom_filter_accesses;
+    aggregate.bloom_filter_maybes -= delta.bloom_filter_maybes;
+  }
+  else {
+    aggregate.range_count += delta.range_count;
+    aggregate.scanner_count += delta.scanner_count;
+    aggregate.cell_count += delta.cell_count;
+    aggregate.file_count += delta.file_count;
+    aggregate.scans += delta.scans;
+    aggregate.cells_read += delta.cells_read;
+    aggregate.bytes_read += delta.bytes_read;
+    aggregate.disk_bytes_read += delta.disk_bytes_read;
+    aggregate.updates += delta.updates;
+    aggregate.cells_written += delta.cells_written;
+    aggregate.bytes_written += delta.bytes_written;
+    aggregate.disk_used += delta.disk_used;
+    aggregate.average_key_size += delta.average_key_size;
+    aggregate.average_value_size += delta.average_value_size;
+    aggregate.compression_ratio += delta.compression_ratio;
+    aggregate.memory_used += delta.memory_used;
+    aggregate.memory_allocated += delta.memory_allocated;
+    aggregate.shadow_cache_memory += delta.shadow_cache_memory;
+    aggregate.block_index_memory += delta.block_index_memory;
+    aggregate.bloom_filter_memory += delta.bloom_filter_memory;
+    aggregate.bloom_filter_accesses += delta.bloom_filter_accesses;
+    aggregate.bloom_filter_maybes += delta.bloom_filter_maybes;
+  }
+}
+
+void Monitoring::apply_table_stats_delta(const String &location,
+                                         std::vector<StatsTable> *table_stats,
+                                         int64_t fetch_timestamp) {
+  TableStatMap &old_contribution = m_server_table_stats[location];
+  TableStatMap new_contribution;
+  TableStatMap::iterator agg_iter;
+
+  if (table_stats) {
+    for (size_t i=0; i<table_stats->size(); i++) {
+      StatsTable &stats = (*table_stats)[i];
+      struct table_rrd_data table_data;
+      memset(&table_data, 0, sizeof(table_data));
+      table_data.range_count = stats.range_count;
+      table_data.scanner_count = stats.scanner_count;
+      table_data.cell_count = stats.cell_count;
+      table_data.file_count = stats.file_count;
+      table_data.scans = stats.scans;
+      table_data.cells_read = stats.cells_scanned;
+      table_data.bytes_read = stats.bytes_scanned;
+      table_data.disk_bytes_read = stats.disk_bytes_read;
+      table_data.updates = stats.updates;
+      table_data.cells_written = stats.cells_written;
+      table_data.bytes_written = stats.bytes_written;
+      table_data.disk_used = stats.disk_used;
+      table_data.average_key_size = stats.key_bytes;
+      table_data.average_value_size = stats.value_bytes;
+      table_data.compression_ratio = (double)stats.disk_used / stats.compression_ratio;
+      table_data.memory_used = stats.memory_used;
+      table_data.memory_allocated = stats.memory_allocated;
+      table_data.shadow_cache_memory = stats.shadow_cache_memory;
+      table_data.block_index_memory = stats.block_index_memory;
+      table_data.bloom_filter_memory = stats.bloom_filter_memory;
+      table_data.bloom_filter_accesses = stats.bloom_filter_accesses;
+      table_data.bloom_filter_maybes = stats.bloom_filter_maybes;
+      new_contribution[stats.table_id] = table_data;
+    }
+  }
 
-  TableStatMap::iterator iter;
+  // Subtract the server's previous contribution; aggregate entries no
+  // longer referenced by any server are dropped
+  for (TableStatMap::iterator iter = old_contribution.begin();
+       iter != old_contribution.end(); ++iter) {
+    agg_iter = m_table_stat_map.find(iter->first);
+    if (agg_iter == m_table_stat_map.end())
+      continue;
+    accumulate_table_stats(agg_iter->second, iter->second, true);
+    if (new_contribution.find(iter->first) == new_contribution.end()) {
+      if (--m_table_refcounts[iter->first] <= 0) {
+        m_table_refcounts.erase(iter->first);
+        m_table_stat_map.erase(agg_iter);
+      }
+    }
+  }
 
-  for (size_t i=0; i<table_stats.size(); i++) {
-    iter = m_table_stat_map.find(table_stats[i].table_id);
-    struct table_rrd_data table_data;
-    if (iter != m_table_stat_map.end()) {
-      table_data = iter->second;
-    } else {
+  // Add the new contribution
+  for (TableStatMap::iterator iter = new_contribution.begin();
+       iter != new_contribution.end(); ++iter) {
+    agg_iter = m_table_stat_map.find(iter->first);
+    if (agg_iter == m_table_stat_map.end()) {
+      struct table_rrd_data table_data;
       memset(&table_data, 0, sizeof(table_data));
+      agg_iter = m_table_stat_map.insert(make_pair(iter->first, table_data)).first;
+    }
+    if (old_contribution.find(iter->first) == old_contribution.end())
+      m_table_refcounts[iter->first]++;
+    accumulate_table_stats(agg_iter->second, iter->second, false);
+    agg_iter->second.fetch_timestamp = fetch_timestamp;
+  }
+
+  if (table_stats)
+    old_contribution.swap(new_contribution);
+  else
+    m_server_table_stats.erase(location);
+}
+
+void Monitoring::emission_loop() {
+
+#if defined(__linux__)
+  // rrdtool invocations and summary dumps are best-effort background work;
+  // lower the thread priority so they don't compete with operation dispatch
+  setpriority(PRIO_PROCESS, (id_t)syscall(SYS_gettid), 10);
+#endif
+
+  while (true) {
+    EmissionWorkloadPtr workload;
+
+    {
+      unique_lock<mutex> lock(m_mutex);
+      m_emission_cond.wait(lock, [this]() {
+          return m_shutdown || !m_workload_queue.empty(); });
+      if (m_shutdown)
+        return;
+      workload = m_workload_queue.front();
+      m_workload_queue.pop_front();
+    }
+
+    try {
+
+      for (auto &entry : workload->server_updates) {
+        String rrd_file = m_monitoring_rs_dir + "/" + entry.first + "_stats_v0.rrd";
+        if (!FileUtils::exists(rrd_file))
+          create_rangeserver_rrd(rrd_file);
+        update_rangeserver_rrd(rrd_file, entry.second);
+      }
+
+      dump_rangeserver_summary_json(workload->server_summary);
+
+      // update Table rrd data
+      for (auto &entry : workload->table_stats) {
+        String table_file_name = entry.first;
+        String rrd_file = m_monitoring_table_dir + "/" + table_file_name + "_table_stats_v0.rrd";
+        if (!FileUtils::exists(rrd_file)) {
+          String dir;
+          size_t slash_pos;
+          slash_pos = table_file_name.rfind("/");
+          if (slash_pos != string::npos) {
+            dir = table_file_name.substr(0,slash_pos+1);
+          }
+          String table_dir = m_monitoring_table_dir + "/"+dir;
+          if (!FileUtils::exists(table_dir)) {
+            if (!FileUtils::mkdirs(table_dir)) {
+              HT_THROW(Error::LOCAL_IO_ERROR, "Unable to create table dir");
+            }
+          }
+          create_table_rrd(rrd_file);
+        }
+        update_table_rrd(rrd_file, entry.second,
+                         workload->table_stats_timestamp);
+      }
+      dump_table_summary_json(workload->table_stats);
+
+      dump_master_summary_json();
+    }
+    catch (Exception &e) {
+      HT_ERROR_OUT << e << HT_END;
     }
-    table_data.fetch_timestamp = fetch_timestamp;
-    table_data.range_count += table_stats[i].range_count;
-    table_data.scanner_count += table_stats[i].scanner_count;
-    table_data.cell_count += table_stats[i].cell_count;
-    table_data.file_count += table_stats[i].file_count;
-    table_data.scans += table_stats[i].scans;
-    table_data.cells_read += table_stats[i].cells_scanned;
-    table_data.bytes_read += table_stats[i].bytes_scanned;
-    table_data.disk_bytes_read += table_stats[i].disk_bytes_read;
-    table_data.updates += table_stats[i].updates;
-    table_data.cells_written += table_stats[i].cells_written;
-    table_data.bytes_written += table_stats[i].bytes_written;
-    table_data.disk_used += table_stats[i].disk_used;
-    table_data.average_key_size += table_stats[i].key_bytes;
-    table_data.average_value_size += table_stats[i].value_bytes;
-    table_data.compression_ratio += (double)table_stats[i].disk_used / table_stats[i].compression_ratio;
-    table_data.memory_used += table_stats[i].memory_used;
-    table_data.memory_allocated += table_stats[i].memory_allocated;
-    table_data.shadow_cache_memory += table_stats[i].shadow_cache_memory;
-    table_data.block_index_memory += table_stats[i].block_index_memory;
-    table_data.bloom_filter_memory += table_stats[i].bloom_filter_memory;
-    table_data.bloom_filter_accesses += table_stats[i].bloom_filter_accesses;
-    table_data.bloom_filter_maybes += table_stats[i].bloom_filter_maybes;
-    m_table_stat_map[table_stats[i].table_id] = table_data;
   }
 }
 
@@ -525,7 +683,7 @@ void Monitoring::create_table_rrd(const String &filename) {
   run_rrdtool(args);
 }
 
-void Monitoring::update_table_rrd(const String &filename, struct table_rrd_data &rrd_data) {
+void Monitoring::update_table_rrd(const String &filename, struct table_rrd_data &rrd_data, int64_t timestamp) {
   std::vector<String> args;
   String update;
 
@@ -533,7 +691,7 @@ void Monitoring::update_table_rrd(const String &filename, struct table_rrd_data
   args.push_back(filename);
 
   update = format("%llu:%d:%d:%.2f:%.2f:%.2f:%.2f:%.2f:%.2f:%.2f:%lld:%.2f:%lld:%lld:%lld:%lld:%lld:%lld:%lld",
-		  (Llu)table_stats_timestamp,
+		  (Llu)timestamp,
 		  rrd_data.range_count,
 		  rrd_data.scanner_count,
 		  rrd_data.scan_rate,
@@ -743,7 +901,7 @@ void Monitoring::dump_rangeserver_summary_json(std::vector<RangeServerStatistics
 
 }
 
-void Monitoring::dump_table_summary_json() {
+void Monitoring::dump_table_summary_json(TableStatMap &table_stats) {
   String str = String(table_json_header);
   String entry;
   struct table_rrd_data table_data;
@@ -751,16 +909,24 @@ void Monitoring::dump_table_summary_json() {
   String table_name;
   TableStatMap::iterator ts_iter;
   int i = 0;
-  for (ts_iter = m_table_stat_map.begin();
-      ts_iter != m_table_stat_map.end(); ++ts_iter) {
+  for (ts_iter = table_stats.begin();
+      ts_iter != table_stats.end(); ++ts_iter) {
     table_id = ts_iter->first;
     table_data = ts_iter->second;
-    TableNameMap::iterator tn_iter = m_table_name_map.find(table_id);
-    if (tn_iter != m_table_name_map.end()) {
-      table_name = tn_iter->second;
+    bool found_name = false;
+    {
+      lock_guard<mutex> lock(m_mutex);
+      TableNameMap::iterator tn_iter = m_table_name_map.find(table_id);
+      if (tn_iter != m_table_name_map.end()) {
+        table_name = tn_iter->second;
+        found_name = true;
+      }
     }
-    else {
+    if (!found_name) {
+      // id_to_name can involve a hyperspace round trip, so resolve the name
+      // outside of m_mutex
       m_namemap_ptr->id_to_name(table_id,table_name);
+      lock_guard<mutex> lock(m_mutex);
       m_table_name_map[table_id] = table_name;
     }
     entry = format(table_entry_format,
@@ -793,6 +959,7 @@ void Monitoring::dump_table_summary_json() {
 }
 
 void Monitoring::change_id_mapping(const String &table_id, const String &table_name) {
+  lock_guard<mutex> lock(m_mutex);
   String s_table_id(table_id);
   String s_table_name(table_name);
   boost::trim_if(s_table_name, boost::is_any_of("/"));
@@ -800,6 +967,7 @@ void Monitoring::change_id_mapping(const String &table_id, const String &table_n
 }
 
 void Monitoring::invalidate_id_mapping(const String &table_id) {
+  lock_guard<mutex> lock(m_mutex);
   m_table_name_map.erase(table_id);
 }
 
@@ -31,7 +31,10 @@
 
 #include <Common/StatsSystem.h>
 #include <Common/String.h>
+#include <Common/Thread.h>
 
+#include <condition_variable>
+#include <list>
 #include <map>
 #include <memory>
 #include <mutex>
@@ -52,6 +55,12 @@ namespace Hypertable {
      */
     Monitoring(Context *context);
 
+    /**
+     * Destructor.
+     * Signals the emission thread to shut down and joins it.
+     */
+    ~Monitoring();
+
     void add_server(const String &location, const StatsSystem &system_info);
 
     void drop_server(const String &location);
@@ -134,6 +143,24 @@ namespace Hypertable {
       double disk_read_rate;
     };
 
+    typedef std::map<String, RangeServerStatistics *> RangeServerMap;
+    typedef std::map<String, table_rrd_data> TableStatMap;
+    typedef std::map<String, TableStatMap> ServerTableStatMap;
+    typedef std::map<String, int32_t> TableRefCountMap;
+    typedef std::map<String, String> TableNameMap;
+
+    /** Snapshot of one statistics sweep handed off to the emission thread.
+     * All members are copies, so the emission thread can run rrdtool and
+     * write summary files without holding #m_mutex.
+     */
+    struct EmissionWorkload {
+      int64_t table_stats_timestamp {};
+      std::vector<std::pair<String, rangeserver_rrd_data>> server_updates;
+      std::vector<RangeServerStatistics> server_summary;
+      TableStatMap table_stats;
+    };
+    typedef std::shared_ptr<EmissionWorkload> EmissionWorkloadPtr;
+
     void create_dir(const String &dir);
     void compute_clock_skew(int64_t server_timestamp, RangeServerStatistics *stats);
     void create_rangeserver_rrd(const String &filename);
@@ -144,21 +171,51 @@ namespace Hypertable {
     void dump_master_summary_json();
 
     void create_table_rrd(const String &filename);
-    void update_table_rrd(const String &filename, struct table_rrd_data &rrd_data);
-    void add_table_stats(std::vector<StatsTable> &table_stats,int64_t fetch_timestamp);
-    void dump_table_summary_json();
+    void update_table_rrd(const String &filename, struct table_rrd_data &rrd_data, int64_t timestamp);
+
+    /** Adds (or subtracts) a per-server table stats contribution to the
+     * running aggregate in #m_table_stat_map.
+     * @param aggregate Running aggregate entry
+     * @param delta Per-server contribution
+     * @param subtract If <i>true</i>, removes the contribution
+     */
+    void accumulate_table_stats(table_rrd_data &aggregate,
+                                const table_rrd_data &delta, bool subtract);
+
+    /** Replaces a server's table stats contribution in the running aggregate.
+     * Subtracts the contribution previously recorded for <code>location</code>
+     * in #m_server_table_stats and adds the one derived from
+     * <code>table_stats</code>.  Aggregate entries no longer referenced by
+     * any server are dropped.  Passing 0 for <code>table_stats</code> just
+     * removes the server's contribution (server dropped).
+     * @param location Proxy name of server
+     * @param table_stats New per-table statistics for server (can be 0)
+     * @param fetch_timestamp Timestamp of statistics fetch
+     */
+    void apply_table_stats_delta(const String &location,
+                                 std::vector<StatsTable> *table_stats,
+                                 int64_t fetch_timestamp);
+
+    void dump_table_summary_json(TableStatMap &table_stats);
     void dump_table_id_name_map();
-    
 
-    typedef std::map<String, RangeServerStatistics *> RangeServerMap;
-    typedef std::map<String, table_rrd_data> TableStatMap;
-    typedef std::map<String, String> TableNameMap;
+    /** Emission thread function.
+     * Pulls workloads off #m_workload_queue and performs the rrdtool
+     * invocations and summary file writes, keeping them off the
+     * GatherStatistics critical path.
+     */
+    void emission_loop();
 
     Context *m_context;
     std::mutex m_mutex;
+    std::condition_variable m_emission_cond;
+    Thread m_emission_thread;
+    std::list<EmissionWorkloadPtr> m_workload_queue;
     RangeServerMap m_server_map;
     TableStatMap m_table_stat_map;
     TableStatMap m_prev_table_stat_map;
+    ServerTableStatMap m_server_table_stats;
+    TableRefCountMap m_table_refcounts;
     TableNameMap m_table_name_map;
     String m_monitoring_dir;
     String m_monitoring_table_dir;
@@ -170,6 +227,7 @@ namespace Hypertable {
     uint64_t table_stats_timestamp;
     NameIdMapperPtr m_namemap_ptr;
     bool m_disable_rrdtool;
+    bool m_shutdown {};
   };
 
   typedef std::shared_ptr<Monitoring> MonitoringPtr;
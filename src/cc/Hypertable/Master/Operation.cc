@@ -613,4 +613,16 @@ namespace Hypertable {
       return text;
     }
   }
+  namespace OperationClass {
+    const char *get_text(int admission_class) {
+      switch (admission_class) {
+      case RECOVERY: return "recovery";
+      case MOVE:     return "move";
+      case BALANCE:  return "balance";
+      case DDL:      return "ddl";
+      case OTHER:    return "other";
+      }
+      return "CLASS NOT REGISTERED";
+    }
+  }
 }
@@ -90,6 +90,28 @@ namespace Hypertable {
     const char *get_text(int state);
   }
 
+  /// %Master operation admission scheduling classes.
+  /// The OperationProcessor uses these classes to prioritize runnable
+  /// operations and to bound the number of operations of each class that
+  /// execute concurrently.  Constants are ordered by decreasing priority.
+  namespace OperationClass {
+
+    /// Enumeration for admission scheduling classes.
+    enum {
+      RECOVERY = 0,
+      MOVE = 1,
+      BALANCE = 2,
+      DDL = 3,
+      OTHER = 4,
+      COUNT = 5
+    };
+    /// Converts admission class constant to human readable string.
+    /// @param admission_class Admission class constant
+    /// @return Human readable string representation for
+    /// <code>admission_class</code>.
+    const char *get_text(int admission_class);
+  }
+
   /// %Master dependency strings
   namespace Dependency {
     extern const char *INIT;
@@ -472,6 +494,13 @@ namespace Hypertable {
     int32_t get_state() { std::lock_guard<std::mutex> lock(m_mutex); return m_state; }
     void set_state(int32_t state) { std::lock_guard<std::mutex> lock(m_mutex); m_state = state; }
     virtual bool is_perpetual() { return false; }
+
+    /// Returns the admission scheduling class of this operation.
+    /// The OperationProcessor uses the admission class to order runnable
+    /// operations and to bound per-class execution concurrency (see
+    /// OperationClass).
+    /// @return Admission class constant
+    virtual int32_t admission_class() { return OperationClass::OTHER; }
     bool block();
     bool unblock();
     bool is_blocked() { std::lock_guard<std::mutex> lock(m_mutex); return m_blocked; }
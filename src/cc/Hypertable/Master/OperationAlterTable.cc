@@ -332,8 +332,15 @@ void OperationAlterTable::execute() {
     m_parts = get_drop_index_parts(original_schema, alter_schema);
     {
       filename = m_context->toplevel_dir + "/tables/" + m_id;
+      DynamicBuffer schema_bin(alter_schema->encoded_length());
+      uint8_t *encode_ptr = schema_bin.base;
+      alter_schema->encode(&encode_ptr);
+      vector<Attribute> attrs;
+      attrs.push_back(Attribute("schema", m_schema.c_str(), m_schema.length()));
+      attrs.push_back(Attribute("schema_bin", schema_bin.base,
+                                encode_ptr - schema_bin.base));
       m_context->hyperspace->attr_set(filename, OPEN_FLAG_READ|OPEN_FLAG_WRITE|OPEN_FLAG_LOCK_EXCLUSIVE,
-                                      "schema", m_schema.c_str(), m_schema.length());
+                                      attrs);
     }
     if (m_parts.value_index() || m_parts.qualifier_index()) {
       set_state(OperationState::SUSPEND_TABLE_MAINTENANCE);
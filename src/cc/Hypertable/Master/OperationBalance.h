@@ -39,6 +39,7 @@ namespace Hypertable {
     void execute() override;
     const String name() override;
     const String label() override;
+    int32_t admission_class() override { return OperationClass::BALANCE; }
     void display_state(std::ostream &os) override;
     bool exclusive() override { return true; }
 
@@ -60,8 +60,24 @@ OperationCompact::OperationCompact(ContextPtr &context, EventPtr &event)
   const uint8_t *ptr = event->payload;
   size_t remaining = event->payload_len;
   m_params.decode(&ptr, &remaining);
-  if (!m_params.table_name().empty())
-    m_exclusivities.insert(m_params.table_name());
+  if (!m_params.table_name().empty()) {
+    // A single-row compact only touches the range containing the row, so
+    // take a row-scoped exclusivity and let unrelated compactions of the
+    // same table proceed concurrently.  Whole-table compactions retain the
+    // table-level exclusivity; the shared "<name> compact row" key makes
+    // the two forms wait for one another.
+    if (!m_params.row().empty()) {
+      m_exclusivities.insert(format("%s compact %s",
+                                    m_params.table_name().c_str(),
+                                    m_params.row().c_str()));
+      m_obstructions.insert(m_params.table_name() + " compact row");
+      m_dependencies.insert(m_params.table_name());
+    }
+    else {
+      m_exclusivities.insert(m_params.table_name());
+      m_dependencies.insert(m_params.table_name() + " compact row");
+    }
+  }
   add_dependency(Dependency::INIT);
 }
 
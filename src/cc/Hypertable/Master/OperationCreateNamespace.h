@@ -38,6 +38,7 @@ namespace Hypertable {
     void execute() override;
     const std::string name() override;
     const std::string label() override;
+    int32_t admission_class() override { return OperationClass::DDL; }
     void display_state(std::ostream &os) override;
     uint8_t encoding_version_state() const override;
     size_t encoded_length_state() const override;
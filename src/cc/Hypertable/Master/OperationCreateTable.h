@@ -88,6 +88,7 @@ namespace Hypertable {
     /// Returns string "CreateTable <tablename>" 
     /// Label for operation
     const String label() override;
+    int32_t admission_class() override { return OperationClass::DDL; }
 
     /// Writes human readable representation of object to output stream.
     /// @param os Output stream
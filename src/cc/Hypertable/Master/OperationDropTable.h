@@ -87,6 +87,7 @@ namespace Hypertable {
     /// table being dropped.
     /// @return Descriptive label for operation
     const String label() override;
+    int32_t admission_class() override { return OperationClass::DDL; }
 
     /// Writes human readable representation of object to output stream.
     /// The string returned has the following format:
@@ -44,6 +44,7 @@ namespace Hypertable {
     const String name() override;
     const String label() override;
     const String graphviz_label() override;
+    int32_t admission_class() override { return OperationClass::MOVE; }
     void display_state(std::ostream &os) override;
     uint8_t encoding_version_state() const override;
     size_t encoded_length_state() const override;
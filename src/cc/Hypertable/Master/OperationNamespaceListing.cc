@@ -0,0 +1,144 @@
+/*
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 3 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include <Common/Compat.h>
+
+#include "OperationNamespaceListing.h"
+
+#include <Hypertable/Lib/Schema.h>
+
+#include <Common/Error.h>
+#include <Common/Serialization.h>
+
+using namespace Hypertable;
+using namespace Hypertable::Lib::Master;
+using namespace std;
+
+OperationNamespaceListing::OperationNamespaceListing(ContextPtr &context,
+                                                     EventPtr &event)
+  : OperationEphemeral(context, event, MetaLog::EntityType::OPERATION_STATUS) {
+  const uint8_t *ptr = event->payload;
+  size_t remaining = event->payload_len;
+  m_params.decode(&ptr, &remaining);
+  HT_INFOF("NamespaceListing-%lld ('%s', include_schemas=%s)",
+           (Lld)header.id, m_params.name().c_str(),
+           m_params.include_schemas() ? "true" : "false");
+}
+
+void OperationNamespaceListing::execute() {
+  string id;
+  bool is_namespace {};
+
+  if (!m_context->namemap->name_to_id(m_params.name(), id, &is_namespace) ||
+      !is_namespace) {
+    complete_error(Error::NAMESPACE_DOES_NOT_EXIST, m_params.name());
+    return;
+  }
+
+  vector<NamespaceListing> listing;
+  m_context->namemap->id_to_sublisting(id, true, listing);
+
+  add_entries(listing, "", id);
+  complete_ok();
+}
+
+void
+OperationNamespaceListing::add_entries(const vector<NamespaceListing> &listing,
+                                       const String &name_prefix,
+                                       const String &id_prefix) {
+  for (auto &nl : listing) {
+    Response::Parameters::NamespaceListing::Entry entry;
+    entry.name = name_prefix + nl.name;
+    entry.id = id_prefix.empty() ? nl.id : id_prefix + "/" + nl.id;
+    entry.is_namespace = nl.is_namespace;
+
+    if (!nl.is_namespace && m_params.include_schemas()) {
+      String tablefile = m_context->toplevel_dir + "/tables/" + entry.id;
+      DynamicBuffer value_buf;
+      bool bin_exists {};
+      try {
+        // Prefer the binary schema encoding; tables created before it was
+        // introduced carry only the XML attribute
+        m_context->hyperspace->attr_get(tablefile, "schema_bin", bin_exists,
+                                        value_buf);
+        SchemaPtr schema;
+        if (bin_exists) {
+          entry.schema.assign((const char *)value_buf.base, value_buf.fill());
+          schema.reset( Schema::new_instance(value_buf.base,
+                                             value_buf.fill()) );
+        }
+        else {
+          m_context->hyperspace->attr_get(tablefile, "schema", value_buf);
+          schema.reset( Schema::new_instance((const char *)value_buf.base) );
+          DynamicBuffer schema_bin(schema->encoded_length());
+          uint8_t *encode_ptr = schema_bin.base;
+          schema->encode(&encode_ptr);
+          entry.schema.assign((const char *)schema_bin.base,
+                              encode_ptr - schema_bin.base);
+        }
+        entry.generation = schema->get_generation();
+      }
+      catch (Exception &e) {
+        // Table dropped while the listing was being assembled
+        HT_WARNF("Problem fetching schema for table %s (%s) - %s",
+                 entry.name.c_str(), entry.id.c_str(),
+                 Error::get_text(e.code()));
+        continue;
+      }
+    }
+
+    m_response.entries().push_back(entry);
+
+    if (!nl.sub_entries.empty())
+      add_entries(nl.sub_entries, entry.name + "/", entry.id);
+  }
+}
+
+const String OperationNamespaceListing::name() {
+  return "OperationNamespaceListing";
+}
+
+const String OperationNamespaceListing::label() {
+  return String("NamespaceListing ") + m_params.name();
+}
+
+size_t OperationNamespaceListing::encoded_result_length() const {
+  return 4 + m_response.encoded_length();
+}
+
+/// @details
+/// Encoding is as follows:
+/// <table>
+///   <tr>
+///   <th>Encoding</th><th>Description</th>
+///   </tr>
+///   <tr>
+///   <td>i32</td><td>Error code (Error::OK)</td>
+///   </tr>
+///   <tr>
+///   <td>Response::Parameters::NamespaceListing</td><td>Response
+///   parameters</td>
+///   </tr>
+/// </table>
+void OperationNamespaceListing::encode_result(uint8_t **bufp) const {
+  Serialization::encode_i32(bufp, Error::OK);
+  m_response.encode(bufp);
+}
@@ -0,0 +1,80 @@
+/* -*- c++ -*-
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 3 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#ifndef Hypertable_Master_OperationNamespaceListing_h
+#define Hypertable_Master_OperationNamespaceListing_h
+
+#include "OperationEphemeral.h"
+
+#include <Hypertable/Lib/Master/Request/Parameters/NamespaceListing.h>
+#include <Hypertable/Lib/Master/Response/Parameters/NamespaceListing.h>
+#include <Hypertable/Lib/NamespaceListing.h>
+
+#include <vector>
+
+namespace Hypertable {
+
+  using namespace Lib::Master;
+
+  /// Carries out a bulk namespace listing.
+  /// Walks a namespace subtree with a single Hyperspace directory listing
+  /// and returns the name, ID and (optionally) schema generation and binary
+  /// schema of every entry in one response, so catalog enumeration costs a
+  /// client one round trip instead of a Hyperspace walk per table.
+  class OperationNamespaceListing : public OperationEphemeral {
+  public:
+    OperationNamespaceListing(ContextPtr &context, EventPtr &event);
+    virtual ~OperationNamespaceListing() { }
+
+    void execute() override;
+    const String name() override;
+    const String label() override;
+    void display_state(std::ostream &os) override { }
+
+    /// Length of encoded operation result.
+    /// @return length of encoded result
+    /// @see encode_result() for encoding format.
+    size_t encoded_result_length() const override;
+
+    /// Encode operation result.
+    /// @param bufp Address of pointer to destination buffer
+    void encode_result(uint8_t **bufp) const override;
+
+  private:
+
+    /// Recursively flattens <code>listing</code> into the response.
+    /// @param listing Namespace listing subtree
+    /// @param name_prefix Pathname prefix of entries in <code>listing</code>
+    /// @param id_prefix ID pathname prefix of entries in <code>listing</code>
+    void add_entries(const std::vector<NamespaceListing> &listing,
+                     const String &name_prefix, const String &id_prefix);
+
+    /// Request parameters
+    Request::Parameters::NamespaceListing m_params;
+
+    /// Response parameters
+    Response::Parameters::NamespaceListing m_response;
+
+  };
+
+}
+
+#endif // Hypertable_Master_OperationNamespaceListing_h
@@ -68,6 +68,22 @@ OperationProcessor::OperationProcessor(ContextPtr &context, size_t thread_count)
     m_graphviz_out = make_unique<std::ofstream>(filename.c_str(), ofstream::out|ofstream::app);
   }
 
+  // Admission class limits (0 = automatic: recovery runs unconstrained,
+  // the remaining classes are capped at 3/4 of the worker threads)
+  size_t automatic_limit = (thread_count * 3) / 4;
+  if (automatic_limit == 0)
+    automatic_limit = 1;
+  int32_t limit = context->props->get_i32("Hypertable.Master.Admission.RecoveryLimit");
+  m_context.class_limit[OperationClass::RECOVERY] = limit > 0 ? (size_t)limit : 0;
+  limit = context->props->get_i32("Hypertable.Master.Admission.MoveLimit");
+  m_context.class_limit[OperationClass::MOVE] = limit > 0 ? (size_t)limit : automatic_limit;
+  limit = context->props->get_i32("Hypertable.Master.Admission.BalanceLimit");
+  m_context.class_limit[OperationClass::BALANCE] = limit > 0 ? (size_t)limit : automatic_limit;
+  limit = context->props->get_i32("Hypertable.Master.Admission.DdlLimit");
+  m_context.class_limit[OperationClass::DDL] = limit > 0 ? (size_t)limit : automatic_limit;
+  limit = context->props->get_i32("Hypertable.Master.Admission.OtherLimit");
+  m_context.class_limit[OperationClass::OTHER] = limit > 0 ? (size_t)limit : automatic_limit;
+
   m_context.execution_order_iter = m_context.execution_order.end();
   m_context.op = this;
   Worker worker(m_context);
@@ -147,6 +163,7 @@ void OperationProcessor::add_operation_internal(OperationPtr &operation) {
   m_context.operation_hash[operation->hash_code()]=OperationVertex(operation,v);
   add_dependencies(v, operation);
   HT_ASSERT(m_context.op_ids.insert(operation->id()).second);
+  queue_depth_adjust(operation, 1);
 }
 
 OperationPtr OperationProcessor::remove_operation(int64_t hash_code) {
@@ -287,11 +304,29 @@ void OperationProcessor::Worker::operator()() {
     while (true) {
       {
         std::unique_lock<std::mutex> lock(m_context.mutex);
+        ExecutionList::iterator chosen;
 
         if (m_context.shutdown)
           return;
 
-        while (m_context.current_iter == m_context.current.end()) {
+        while (true) {
+
+          // Advance past entries that have already been dispatched
+          while (m_context.current_iter != m_context.current.end() &&
+                 m_context.current_iter->taken)
+            ++m_context.current_iter;
+
+          if (m_context.current_iter != m_context.current.end()) {
+            chosen = m_context.op->select_next();
+            if (chosen != m_context.current.end())
+              break;
+            // Every remaining entry is held back by an admission class
+            // limit; wait for a running operation to complete
+            m_context.cond.wait(lock);
+            if (m_context.shutdown)
+              return;
+            continue;
+          }
 
           if (m_context.need_order_recompute) {
             m_context.op->recompute_order();
@@ -322,11 +357,12 @@ void OperationProcessor::Worker::operator()() {
             return;
         }
 
-        vertex = m_context.current_iter->vertex;
-        ++m_context.current_iter;
+        vertex = chosen->vertex;
+        chosen->taken = true;
         operation = m_context.ops[vertex];
         m_context.busy[vertex] = true;
         m_context.busy_count++;
+        m_context.class_running[operation->admission_class()]++;
       }
 
       try {
@@ -340,7 +376,9 @@ void OperationProcessor::Worker::operator()() {
           std::lock_guard<std::mutex> lock(m_context.mutex);
           m_context.busy[vertex] = false;
           m_context.busy_count--;
+          m_context.class_running[operation->admission_class()]--;
           m_context.current_active.erase(vertex);
+          m_context.cond.notify_all();
           if (operation->is_complete())
             m_context.op->retire_operation(vertex, operation);
           else if (operation->is_blocked())
@@ -353,7 +391,9 @@ void OperationProcessor::Worker::operator()() {
         std::lock_guard<std::mutex> lock(m_context.mutex);
         m_context.busy[vertex] = false;
         m_context.busy_count--;
+        m_context.class_running[operation->admission_class()]--;
         m_context.current_active.erase(vertex);
+        m_context.cond.notify_all();
         if (e.code() == Error::INDUCED_FAILURE) {
           m_context.shutdown = true;
           m_context.cond.notify_all();
@@ -684,6 +724,7 @@ void OperationProcessor::retire_operation(Vertex v, OperationPtr &operation) {
 
   if (m_context.master_context->metrics_handler)
     m_context.master_context->metrics_handler->operation_increment();
+  queue_depth_adjust(operation, -1);
 
   if (operation->is_perpetual())
     m_context.perpetual_ops.insert(operation);
@@ -826,3 +867,25 @@ bool OperationProcessor::load_current() {
   return false;
 }
 
+
+OperationProcessor::ExecutionList::iterator OperationProcessor::select_next() {
+  for (ExecutionList::iterator iter = m_context.current_iter;
+       iter != m_context.current.end(); ++iter) {
+    if (iter->taken)
+      continue;
+    int32_t op_class = m_context.ops[iter->vertex]->admission_class();
+    if (m_context.class_limit[op_class] == 0 ||
+        m_context.class_running[op_class] < m_context.class_limit[op_class])
+      return iter;
+  }
+  return m_context.current.end();
+}
+
+
+void OperationProcessor::queue_depth_adjust(OperationPtr &operation,
+                                            int64_t delta) {
+  if (m_context.master_context->metrics_handler)
+    m_context.master_context->metrics_handler->queue_depth_adjust(
+        OperationClass::get_text(operation->admission_class()), delta);
+}
+
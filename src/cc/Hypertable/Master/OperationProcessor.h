@@ -129,6 +129,18 @@ namespace Hypertable {
 
     typedef std::multimap<const String, Vertex> DependencyIndex;
 
+    /** Selects the next dispatchable entry from the current set.
+     * Scans forward from <code>m_context.current_iter</code>, skipping
+     * entries that have already been dispatched and entries whose admission
+     * class has reached its concurrency limit.
+     * @return Iterator to selected entry, or
+     * <code>m_context.current.end()</code> if every remaining entry is
+     * taken or held back by an admission class limit
+     * @note <code>m_context.mutex</code> must be locked when calling this
+     * method
+     */
+    ExecutionList::iterator select_next();
+
     void add_dependencies(Vertex v, OperationPtr &operation);
     void add_exclusivity(Vertex v, const String &name);
     void add_dependency(Vertex v, const String &name);
@@ -166,6 +178,14 @@ namespace Hypertable {
      */
     bool load_current();
 
+    /** Adjusts the queue depth metric for an operation's admission class.
+     * @param operation Reference to operation smart pointer
+     * @param delta Amount by which to adjust the queue depth
+     * @note <code>m_context.mutex</code> must be locked when calling this
+     * method
+     */
+    void queue_depth_adjust(OperationPtr &operation, int64_t delta);
+
     typedef std::set<OperationPtr> PerpetualSet;
     
     class OperationVertex {
@@ -201,6 +221,10 @@ namespace Hypertable {
       DependencyIndex obstruction_index;
       PerpetualSet perpetual_ops;
       size_t busy_count;
+      /// Count of currently executing operations per admission class
+      size_t class_running[OperationClass::COUNT] {};
+      /// Concurrent execution limit per admission class (0 = unlimited)
+      size_t class_limit[OperationClass::COUNT] {};
       bool need_order_recompute;
       bool shutdown;
       bool paused;
@@ -224,8 +248,14 @@ namespace Hypertable {
     struct ltvertexinfo {
       ltvertexinfo(ThreadContext &context) : m_context(context) { }
       inline bool operator() (const vertex_info &vi1, const vertex_info &vi2) {
-        if (m_context.exec_time[vi1.vertex] == m_context.exec_time[vi2.vertex])
-          return vi1.taken && !vi2.taken;
+        if (m_context.exec_time[vi1.vertex] == m_context.exec_time[vi2.vertex]) {
+          if (vi1.taken != vi2.taken)
+            return vi1.taken;
+          // Workers dispatch in list order, so higher priority (lower
+          // valued) admission classes sort first within a time slot
+          return m_context.ops[vi1.vertex]->admission_class() <
+            m_context.ops[vi2.vertex]->admission_class();
+        }
         return m_context.exec_time[vi1.vertex] < m_context.exec_time[vi2.vertex];
       }
       ThreadContext &m_context;
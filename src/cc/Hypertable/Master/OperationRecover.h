@@ -70,6 +70,7 @@ namespace Hypertable {
     void execute() override;
     const String name() override;
     const String label() override;
+    int32_t admission_class() override { return OperationClass::RECOVERY; }
     const String& location() const { return m_location; }
 
     void display_state(std::ostream &os) override;
@@ -0,0 +1,100 @@
+/*
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 3 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include <Common/Compat.h>
+
+#include "OperationRecoverPrepare.h"
+
+#include <Hypertable/RangeServer/MetaLogDefinitionRangeServer.h>
+
+#include <Hypertable/Lib/MetaLogReader.h>
+
+#include <Common/Error.h>
+
+using namespace Hypertable;
+using namespace std;
+
+OperationRecoverPrepare::OperationRecoverPrepare(ContextPtr &context,
+                                                 const String &location)
+  : OperationEphemeral(context,
+                       MetaLog::EntityType::OPERATION_RECOVER_SERVER_PREPARE),
+    m_location(location) {
+  m_exclusivities.insert(m_location);
+}
+
+
+void OperationRecoverPrepare::execute() {
+  HT_INFOF("Entering RecoverPrepare %s", m_location.c_str());
+
+  warm_log_directory("root");
+  warm_log_directory("metadata");
+  warm_log_directory("system");
+  warm_log_directory("user");
+
+  // Advisory RSML read.  The suspect may still be appending to its RSML, so
+  // the result is discarded; the point is to pull the log into the broker's
+  // cache so the authoritative read in OperationRecover is fast.
+  try {
+    MetaLog::DefinitionPtr rsml_definition =
+      make_shared<MetaLog::DefinitionRangeServer>(m_location.c_str());
+    String logfile = m_context->toplevel_dir + "/servers/" + m_location
+      + "/log/" + rsml_definition->name();
+    vector<MetaLog::EntityPtr> entities;
+    MetaLog::ReaderPtr rsml_reader =
+      make_shared<MetaLog::Reader>(m_context->dfs, rsml_definition, logfile);
+    rsml_reader->get_entities(entities);
+    HT_INFOF("RecoverPrepare %s - advisory RSML read returned %d entities",
+             m_location.c_str(), (int)entities.size());
+  }
+  catch (Exception &e) {
+    HT_INFOF("RecoverPrepare %s - advisory RSML read failed (%s - %s)",
+             m_location.c_str(), Error::get_text(e.code()), e.what());
+  }
+
+  complete_ok();
+  HT_INFOF("Leaving RecoverPrepare %s", m_location.c_str());
+}
+
+void OperationRecoverPrepare::warm_log_directory(const String &logname) {
+  String logdir = m_context->toplevel_dir + "/servers/" + m_location
+    + "/log/" + logname;
+  try {
+    if (m_context->dfs->exists(logdir)) {
+      std::vector<Filesystem::Dirent> listing;
+      m_context->dfs->readdir(logdir, listing);
+      HT_INFOF("RecoverPrepare %s - %d fragments in %s", m_location.c_str(),
+               (int)listing.size(), logdir.c_str());
+    }
+  }
+  catch (Exception &e) {
+    HT_INFOF("RecoverPrepare %s - problem enumerating %s (%s - %s)",
+             m_location.c_str(), logdir.c_str(), Error::get_text(e.code()),
+             e.what());
+  }
+}
+
+const String OperationRecoverPrepare::name() {
+  return "OperationRecoverPrepare";
+}
+
+const String OperationRecoverPrepare::label() {
+  return format("RecoverPrepare %s", m_location.c_str());
+}
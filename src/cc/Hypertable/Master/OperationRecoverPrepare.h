@@ -0,0 +1,73 @@
+/* -*- c++ -*-
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 3 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#ifndef Hypertable_Master_OperationRecoverPrepare_h
+#define Hypertable_Master_OperationRecoverPrepare_h
+
+#include "OperationEphemeral.h"
+
+namespace Hypertable {
+
+  /** @addtogroup Master
+   *  @{
+   */
+
+  /** Speculatively prepares for recovery of a suspected range server.
+   * This operation is created when a gossip quorum of range servers reports
+   * a peer as unresponsive (see Context::report_suspect()).  The suspect's
+   * Hyperspace lease has typically not yet expired at that point, so actual
+   * recovery cannot begin; instead this operation walks the read-only
+   * portions of the recovery critical path (commit log fragment enumeration
+   * and an advisory RSML read) so that the filesystem broker metadata is hot
+   * when OperationRecover starts.  It performs no mutations and completes
+   * unconditionally.
+   */
+  class OperationRecoverPrepare : public OperationEphemeral {
+  public:
+
+    /** Constructor.
+     * @param context %Master context
+     * @param location Proxy name of suspected server
+     */
+    OperationRecoverPrepare(ContextPtr &context, const String &location);
+
+    virtual ~OperationRecoverPrepare() { }
+
+    void execute() override;
+    const String name() override;
+    const String label() override;
+    int32_t admission_class() override { return OperationClass::RECOVERY; }
+
+    void display_state(std::ostream &os) override { }
+
+  private:
+
+    /// Enumerates the fragments of one of the suspect's commit logs
+    void warm_log_directory(const String &logname);
+
+    /// Proxy name of suspected server
+    String m_location;
+  };
+
+  /** @} */
+}
+
+#endif // Hypertable_Master_OperationRecoverPrepare_h
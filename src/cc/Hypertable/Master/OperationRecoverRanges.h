@@ -44,6 +44,7 @@ namespace Hypertable {
     void execute() override;
     const String name() override;
     const String label() override;
+    int32_t admission_class() override { return OperationClass::RECOVERY; }
     void display_state(std::ostream &os) override;
     uint8_t encoding_version_state() const override;
     size_t encoded_length_state() const override;
@@ -34,6 +34,7 @@ namespace Hypertable {
     virtual void execute();
     virtual const String name();
     virtual const String label();
+    int32_t admission_class() override { return OperationClass::RECOVERY; }
     virtual bool is_perpetual() { return true; }
     virtual void display_state(std::ostream &os) { }
   };
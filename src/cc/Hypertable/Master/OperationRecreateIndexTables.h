@@ -81,6 +81,7 @@ namespace Hypertable {
     /// Returns descriptive label for operation
     /// @return Descriptive label for operation
     const String label() override;
+    int32_t admission_class() override { return OperationClass::DDL; }
 
     /// Writes human readable representation of object to output stream.
     /// @param os Output stream
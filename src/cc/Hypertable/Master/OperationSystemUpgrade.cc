@@ -65,8 +65,15 @@ bool OperationSystemUpgrade::update_schema(const String &name, const String &sch
   new_schema.reset( Schema::new_instance(schema_str) );
 
   if (old_schema->get_generation() < new_schema->get_generation()) {
-    m_context->hyperspace->attr_set(handle, "schema", schema_str.c_str(),
-                           schema_str.length());
+    DynamicBuffer schema_bin(new_schema->encoded_length());
+    uint8_t *encode_ptr = schema_bin.base;
+    new_schema->encode(&encode_ptr);
+    std::vector<Attribute> attrs;
+    attrs.push_back(Attribute("schema", schema_str.c_str(),
+                              schema_str.length()));
+    attrs.push_back(Attribute("schema_bin", schema_bin.base,
+                              encode_ptr - schema_bin.base));
+    m_context->hyperspace->attr_set(handle, attrs);
     HT_INFOF("Upgraded schema for '%s' from generation %lld to %lld", name.c_str(),
              (Lld)old_schema->get_generation(), (Lld)new_schema->get_generation());
     return true;
@@ -204,9 +204,21 @@ void create_table_in_hyperspace(ContextPtr &context, const String &name,
   String tablefile = context->toplevel_dir + "/tables/" + table_id;
   int oflags = OPEN_FLAG_READ|OPEN_FLAG_WRITE|OPEN_FLAG_CREATE;
 
-  // Write schema attribute
-  context->hyperspace->attr_set(tablefile, oflags, "schema", schema_str.c_str(),
-                                schema_str.length());
+  SchemaPtr schema(Schema::new_instance(schema_str));
+
+  // Write schema attributes (XML and binary encodings, in one call so
+  // they can never be observed out of sync)
+  DynamicBuffer schema_bin(schema->encoded_length());
+  uint8_t *encode_ptr = schema_bin.base;
+  schema->encode(&encode_ptr);
+  {
+    std::vector<Attribute> attrs;
+    attrs.push_back(Attribute("schema", schema_str.c_str(),
+                              schema_str.length()));
+    attrs.push_back(Attribute("schema_bin", schema_bin.base,
+                              encode_ptr - schema_bin.base));
+    context->hyperspace->attr_set(tablefile, oflags, attrs);
+  }
 
   HT_MAYBE_FAIL("Utility-create-table-in-hyperspace-2");
 
@@ -214,8 +226,6 @@ void create_table_in_hyperspace(ContextPtr &context, const String &name,
   // for this table in DFS
   String table_basedir = context->toplevel_dir + "/tables/" + table_id + "/";
 
-  SchemaPtr schema(Schema::new_instance(schema_str));
-
   for (auto ag_spec : schema->get_access_groups()) {
     String agdir = table_basedir + ag_spec->get_name();
     context->dfs->mkdirs(agdir);
@@ -248,6 +258,8 @@ void prepare_index(ContextPtr &context, const String &name,
   index_schema->add_access_group(ag_spec);
   index_schema->set_group_commit_interval(
           primary_schema->get_group_commit_interval());
+  index_schema->set_deferred_log_sync(
+          primary_schema->get_deferred_log_sync());
   index_schema->set_version(1);
   int64_t generation = get_ts64();
   index_schema->update_generation(generation);
@@ -28,10 +28,13 @@
 #include "AccessGroup.h"
 
 #include <Hypertable/RangeServer/CellCache.h>
+#include <Hypertable/RangeServer/CellCacheCheckpoint.h>
+#include <Hypertable/RangeServer/CellCacheCompact.h>
 #include <Hypertable/RangeServer/CellCacheScanner.h>
 #include <Hypertable/RangeServer/CellStoreFactory.h>
 #include <Hypertable/RangeServer/CellStoreReleaseCallback.h>
-#include <Hypertable/RangeServer/CellStoreV7.h>
+#include <Hypertable/RangeServer/CellStoreTrailerV7.h>
+#include <Hypertable/RangeServer/CellStoreV8.h>
 #include <Hypertable/RangeServer/Config.h>
 #include <Hypertable/RangeServer/Global.h>
 #include <Hypertable/RangeServer/MaintenanceFlag.h>
@@ -42,6 +45,7 @@
 #include <Common/DynamicBuffer.h>
 #include <Common/Error.h>
 #include <Common/FailureInducer.h>
+#include <Common/FileUtils.h>
 #include <Common/md5.h>
 
 #include <algorithm>
@@ -49,11 +53,35 @@
 #include <cstdlib>
 #include <cstring>
 #include <iterator>
+#include <thread>
 #include <vector>
 
 using namespace Hypertable;
 using namespace std;
 
+namespace {
+  void split_file_list(const String &str, vector<String> &files) {
+    size_t base = 0, offset;
+    while ((offset = str.find(';', base)) != String::npos) {
+      if (offset > base)
+        files.push_back(str.substr(base, offset-base));
+      base = offset + 1;
+    }
+    if (base < str.length())
+      files.push_back(str.substr(base));
+  }
+
+  String join_file_list(const vector<String> &files) {
+    String str;
+    for (const auto &file : files) {
+      if (!str.empty())
+        str += ";";
+      str += file;
+    }
+    return str;
+  }
+}
+
 AccessGroup::AccessGroup(const TableIdentifier *identifier,
                          SchemaPtr &schema, AccessGroupSpec *ag_spec,
                          const RangeSpec *range, const Hints *hints)
@@ -84,6 +112,10 @@ AccessGroup::AccessGroup(const TableIdentifier *identifier,
     m_latest_stored_revision = hints->latest_stored_revision;
     m_latest_stored_revision_hint = hints->latest_stored_revision;
     m_disk_usage = hints->disk_usage;
+    m_prewarm_bytes = hints->prewarm_bytes;
+    m_compaction_watermark = hints->compaction_watermark;
+    split_file_list(hints->compaction_slices, m_sweep_slice_files);
+    split_file_list(hints->compaction_inputs, m_sweep_input_files);
   }
 }
 
@@ -105,9 +137,14 @@ void AccessGroup::update_schema(SchemaPtr &schema,
 
     m_garbage_tracker.update_schema(ag_spec);
 
+    m_compaction_policy =
+      CompactionPolicy::create(ag_spec->get_option_compaction_strategy());
+
     m_cellstore_props = make_shared<Properties>();
     m_cellstore_props->set("compressor", ag_spec->get_option_compressor());
     m_cellstore_props->set("blocksize", ag_spec->get_option_blocksize());
+    if (ag_spec->get_option_pax_layout())
+      m_cellstore_props->set("pax-layout", true);
     if (ag_spec->get_option_replication() != -1)
       m_cellstore_props->set("replication",
                              (int32_t)ag_spec->get_option_replication());
@@ -146,14 +183,21 @@ void AccessGroup::update_schema(SchemaPtr &schema,
 }
 
 /**
- * This should be called with the CellCache locked Also, at the end of
- * compaction processing, when m_cell_cache gets reset to a new value, the
- * CellCache should be locked as well.
+ * This should be called with the access group locked (see lock()) so that
+ * the active cache is not swapped out from under the insert at the end of
+ * compaction processing.  The cache itself accepts concurrent inserts.
  */
-void AccessGroup::add(const Key &key, const ByteString value) {
+void AccessGroup::add(const Key &key, const ByteString value,
+                      const StaticBufferPtr &buffer) {
 
   assert(m_start_row.compare(key.row) < 0 && m_end_row.compare(key.row) >= 0);
 
+  // Cells at or below the checkpoint revision were restored from the cell
+  // cache checkpoint and are already present in the cache, so drop them
+  // when they come around again during commit log replay
+  if (m_recovering && key.revision <= m_restored_revision)
+    return;
+
   if (!m_dirty)
     m_dirty = true;
 
@@ -163,7 +207,7 @@ void AccessGroup::add(const Key &key, const ByteString value) {
     if (m_schema->column_is_counter(key.column_family_code))
       return m_cell_cache_manager->add_counter(key, value);
     else
-      return m_cell_cache_manager->add(key, value);
+      return m_cell_cache_manager->add(key, value, buffer);
   }
   else if (!m_recovering) {
     if (!Global::ignore_cells_with_clock_skew) {
@@ -172,15 +216,99 @@ void AccessGroup::add(const Key &key, const ByteString value) {
       if (m_schema->column_is_counter(key.column_family_code))
         return m_cell_cache_manager->add_counter(key, value);
       else
-        return m_cell_cache_manager->add(key, value);
+        return m_cell_cache_manager->add(key, value, buffer);
     }
   }
   else if (m_in_memory) {
     if (m_schema->column_is_counter(key.column_family_code))
       return m_cell_cache_manager->add_counter(key, value);
     else
-      return m_cell_cache_manager->add(key, value);
+      return m_cell_cache_manager->add(key, value, buffer);
+  }
+}
+
+
+int64_t AccessGroup::recovery_initialize() {
+  m_recovering = true;
+  if (!Global::cell_cache_checkpoint_dir.empty())
+    return restore_cell_cache_checkpoint();
+  return TIMESTAMP_MIN;
+}
+
+
+/**
+ * Restores the cell caches from the checkpoint file written by
+ * write_cell_cache_checkpoint() at the last clean shutdown.  Only
+ * checkpoints listed in the handoff manifest are considered; an unlisted
+ * file is a stale leftover from an earlier incarnation and is removed.  On
+ * success the largest restored revision is recorded in m_restored_revision
+ * so that add() drops the replayed copies of the restored cells during
+ * commit log replay.  A failed restore of a listed checkpoint bumps
+ * Global::cell_cache_restore_failures, which forces local_recover() to
+ * replay the commit logs rather than skim them; the replay then
+ * repopulates the cache.
+ */
+int64_t AccessGroup::restore_cell_cache_checkpoint() {
+  CellCacheCheckpoint checkpoint(Global::cell_cache_checkpoint_dir,
+                                 m_full_name);
+  int64_t latest_revision, earliest_revision;
+  int64_t cell_count {};
+  bool restored {};
+
+  if (Global::cell_cache_checkpoint_manifest.count(checkpoint.pathname())
+      == 0) {
+    if (FileUtils::exists(checkpoint.pathname()))
+      FileUtils::unlink(checkpoint.pathname());
+    return TIMESTAMP_MIN;
+  }
+
+  try {
+    restored = checkpoint.restore(m_cell_cache_manager, m_schema,
+                                  &latest_revision, &earliest_revision,
+                                  &cell_count);
+  }
+  catch (Exception &e) {
+    HT_WARNF("Problem restoring cell cache checkpoint for %s (%s), falling "
+             "back to commit log replay", m_full_name.c_str(),
+             Error::get_text(e.code()));
+  }
+
+  if (!restored) {
+    Global::cell_cache_restore_failures++;
+    return TIMESTAMP_MIN;
+  }
+
+  {
+    lock_guard<mutex> lock(m_mutex);
+    m_restored_revision = latest_revision;
+    if (earliest_revision < m_earliest_cached_revision)
+      m_earliest_cached_revision = earliest_revision;
+    if (cell_count > 0)
+      m_dirty = true;
   }
+
+  HT_INFOF("Restored %lld cells from cell cache checkpoint for %s",
+           (Lld)cell_count, m_full_name.c_str());
+
+  return latest_revision;
+}
+
+
+bool AccessGroup::write_cell_cache_checkpoint(std::vector<String> &written) {
+  lock_guard<mutex> lock(m_mutex);
+
+  CellCacheCheckpoint checkpoint(Global::cell_cache_checkpoint_dir,
+                                 m_full_name);
+  try {
+    if (checkpoint.write(m_cell_cache_manager))
+      written.push_back(checkpoint.pathname());
+  }
+  catch (Exception &e) {
+    HT_WARNF("Problem writing cell cache checkpoint for %s - %s",
+             m_full_name.c_str(), Error::get_text(e.code()));
+    return false;
+  }
+  return true;
 }
 
 
@@ -189,7 +317,8 @@ MergeScannerAccessGroup *AccessGroup::create_scanner(ScanContext *scan_ctx) {
     MergeScannerAccessGroup::RETURN_DELETES : 0;
   MergeScannerAccessGroup *scanner = 
     new MergeScannerAccessGroup(m_table_name, scan_ctx,
-                                flags | MergeScannerAccessGroup::ACCUMULATE_COUNTERS);
+                                flags | MergeScannerAccessGroup::ACCUMULATE_COUNTERS,
+                                &m_garbage_tracker);
 
   CellStoreReleaseCallback callback(this);
 
@@ -200,54 +329,117 @@ MergeScannerAccessGroup *AccessGroup::create_scanner(ScanContext *scan_ctx) {
 
   try {
     lock_guard<mutex> lock(m_mutex);
-    uint64_t initial_bytes_read;
 
     m_cell_cache_manager->add_scanners(scanner, scan_ctx);
 
+    vector<size_t> candidates;
+
     if (!m_in_memory) {
-      bool bloom_filter_disabled;
 
       for (size_t i=0; i<m_stores.size(); ++i) {
-
         if (scan_ctx->time_interval.first > m_stores[i].timestamp_max ||
             scan_ctx->time_interval.second < m_stores[i].timestamp_min)
           continue;
+        candidates.push_back(i);
+      }
 
-        bloom_filter_disabled = boost::any_cast<uint8_t>(m_stores[i].cs->get_trailer()->get("bloom_filter_mode")) == BLOOM_FILTER_DISABLED;
-
-        initial_bytes_read = m_stores[i].cs->bytes_read();
+      /**
+       * Open a scanner on each candidate store concurrently.  Each store
+       * scanner performs a synchronous block index seek and first-block
+       * read through the FsBroker when constructed, so opening them in
+       * parallel makes scan-start latency track the slowest read rather
+       * than the sum.  Each task touches only its own store's statistics
+       * and m_mutex is held by this thread for the duration.
+       */
+      vector<CellListScannerPtr> store_scanners(candidates.size());
+      vector<uint64_t> store_disk_read(candidates.size(), 0);
+      vector<std::exception_ptr> store_errors(candidates.size());
 
-        // Query bloomfilter only if it is enabled and a start row has been specified
-        // (ie query is not something like select bar from foo;)
-        if (bloom_filter_disabled ||
-            !scan_ctx->single_row ||
-            scan_ctx->start_row == "") {
-          if (m_stores[i].shadow_cache) {
-            scanner->add_scanner(m_stores[i].shadow_cache->create_scanner(scan_ctx));
-            m_stores[i].shadow_cache_hits++;
+      auto open_store_scanner = [&](size_t slot) {
+        CellStoreInfo &store = m_stores[candidates[slot]];
+        try {
+          bool bloom_filter_disabled = boost::any_cast<uint8_t>(
+              store.cs->get_trailer()->get("bloom_filter_mode"))
+            == BLOOM_FILTER_DISABLED;
+          uint64_t store_initial_bytes_read = store.cs->bytes_read();
+
+          // Query bloomfilter only if it is enabled and a start row has been
+          // specified (ie query is not something like select bar from foo;)
+          if (bloom_filter_disabled ||
+              !scan_ctx->single_row ||
+              scan_ctx->start_row == "") {
+            if (store.shadow_cache) {
+              store_scanners[slot] = store.shadow_cache->create_scanner(scan_ctx);
+              store.shadow_cache_hits++;
+            }
+            else
+              store_scanners[slot] = store.cs->create_scanner(scan_ctx);
           }
-          else
-            scanner->add_scanner(m_stores[i].cs->create_scanner(scan_ctx));
-          callback.add_file(m_stores[i].cs->get_filename());
-        }
-        else {
-          m_stores[i].bloom_filter_accesses++;
-          if (m_stores[i].cs->may_contain(scan_ctx)) {
-            m_stores[i].bloom_filter_maybes++;
-            if (m_stores[i].shadow_cache) {
-              scanner->add_scanner(m_stores[i].shadow_cache->create_scanner(scan_ctx));
-              m_stores[i].shadow_cache_hits++;
+          else {
+            store.bloom_filter_accesses++;
+            if (store.cs->may_contain(scan_ctx)) {
+              store.bloom_filter_maybes++;
+              if (store.shadow_cache) {
+                store_scanners[slot] = store.shadow_cache->create_scanner(scan_ctx);
+                store.shadow_cache_hits++;
+              }
+              else
+                store_scanners[slot] = store.cs->create_scanner(scan_ctx);
             }
             else
-              scanner->add_scanner(m_stores[i].cs->create_scanner(scan_ctx));
-            callback.add_file(m_stores[i].cs->get_filename());
+              scan_ctx->bloom_filter_misses++;
           }
-        }
-
-        if (m_stores[i].cs->bytes_read() > initial_bytes_read)
-          scanner->add_disk_read(m_stores[i].cs->bytes_read() - initial_bytes_read);
 
+          if (store.cs->bytes_read() > store_initial_bytes_read)
+            store_disk_read[slot] = store.cs->bytes_read() - store_initial_bytes_read;
+        }
+        catch (...) {
+          store_errors[slot] = std::current_exception();
+        }
+      };
+
+      if (candidates.size() > 1) {
+        vector<std::thread> threads;
+        threads.reserve(candidates.size()-1);
+        for (size_t slot=1; slot<candidates.size(); ++slot)
+          threads.emplace_back(open_store_scanner, slot);
+        open_store_scanner(0);
+        for (auto &t : threads)
+          t.join();
       }
+      else if (!candidates.empty())
+        open_store_scanner(0);
+
+      for (size_t slot=0; slot<candidates.size(); ++slot) {
+        if (store_errors[slot])
+          std::rethrow_exception(store_errors[slot]);
+        if (store_scanners[slot]) {
+          scanner->add_scanner(store_scanners[slot]);
+          callback.add_file(m_stores[candidates[slot]].cs->get_filename());
+        }
+        if (store_disk_read[slot])
+          scanner->add_disk_read(store_disk_read[slot]);
+      }
+    }
+
+    // Classify the scanner's sources against the scan's time window;
+    // when every source lies entirely inside it the per-cell window
+    // checks cannot fail and the merge scanner drops them from its
+    // forward loop.  Stores entirely outside the window were already
+    // pruned from the candidate list above
+    if (scan_ctx->time_interval.first != TIMESTAMP_MIN ||
+        scan_ctx->time_interval.second != TIMESTAMP_MAX) {
+      int64_t ts_min, ts_max;
+      m_cell_cache_manager->get_timestamp_range(&ts_min, &ts_max);
+      bool inside = ts_min >= scan_ctx->time_interval.first &&
+        ts_max < scan_ctx->time_interval.second;
+      for (size_t i=0; inside && i<candidates.size(); ++i)
+        inside = m_stores[candidates[i]].timestamp_min >=
+                   scan_ctx->time_interval.first &&
+                 m_stores[candidates[i]].timestamp_max <
+                   scan_ctx->time_interval.second;
+      if (inside)
+        scanner->set_sources_inside_time_window();
     }
   }
   catch (Exception &e) {
@@ -415,6 +607,16 @@ AccessGroup::get_maintenance_data(ByteArena &arena, time_t now, int flags) {
     (*tailp)->next = 0;
 
     mdata->shadow_cache_memory += (*tailp)->shadow_cache_size;
+
+    if (!m_in_memory && Global::block_cache) {
+      int file_id = m_stores[i].cs->get_file_id();
+      uint64_t accesses, hits;
+      mdata->block_cache_memory +=
+        Global::block_cache->memory_used_by_file(file_id);
+      Global::block_cache->get_file_stats(file_id, &accesses, &hits);
+      mdata->block_cache_accesses += accesses;
+      mdata->block_cache_hits += hits;
+    }
   }
   mdata->file_count = m_stores.size();
 
@@ -445,7 +647,18 @@ void AccessGroup::load_cellstore(CellStorePtr &cellstore) {
     HT_ASSERT(m_stores.empty());
     ScanContextPtr scan_ctx = make_shared<ScanContext>(m_schema);
     CellListScannerPtr scanner = cellstore->create_scanner(scan_ctx.get());
-    m_cell_cache_manager->add(scanner);
+    CellCacheCompactPtr compact_cache = make_shared<CellCacheCompact>();
+    ByteString value;
+    Key key;
+    // The store scanner returns cells in sorted order, so the flushed
+    // cells can be loaded directly into the compact representation
+    // instead of the cell cache map
+    while (scanner->get(key, value)) {
+      compact_cache->add(key, value);
+      scanner->forward();
+    }
+    compact_cache->finalize();
+    m_cell_cache_manager->install_compact_cache(compact_cache);
   }
 
   m_stores.push_back(cellstore);
@@ -455,6 +668,56 @@ void AccessGroup::load_cellstore(CellStorePtr &cellstore) {
   m_file_tracker.add_live_noupdate(cellstore->get_filename(), total_index_entries);
 }
 
+void AccessGroup::adopt_cellstore(const String &source_file) {
+  String cs_file, start_row, end_row;
+
+  if (m_in_memory)
+    HT_THROWF(Error::NOT_ALLOWED, "Cannot bulk load in-memory access group %s",
+              m_full_name.c_str());
+
+  {
+    lock_guard<mutex> lock(m_mutex);
+    cs_file = format("%s/tables/%s/%s/%s/cs%d",
+                     Global::toplevel_dir.c_str(),
+                     m_identifier.id, m_name.c_str(),
+                     m_range_dir.c_str(),
+                     m_next_cs_id++);
+    start_row = m_start_row;
+    end_row = m_end_row;
+  }
+
+  // Move the file into the range directory before opening it so the store
+  // vector never references a file outside the access group's directory
+  Global::dfs->rename(source_file, cs_file);
+
+  CellStorePtr cellstore = CellStoreFactory::open(cs_file, start_row.c_str(),
+                                                  end_row.c_str());
+
+  int64_t total_index_entries = 0;
+  {
+    lock_guard<mutex> lock(m_mutex);
+
+    int64_t revision = boost::any_cast<int64_t>
+      (cellstore->get_trailer()->get("revision"));
+    if (revision > m_latest_stored_revision)
+      m_latest_stored_revision = revision;
+
+    m_stores.push_back(cellstore);
+
+    m_garbage_tracker.update_cellstore_info(m_stores, time(0), false);
+    get_merge_info(m_needs_merging, m_end_merge);
+    recompute_compression_ratio(&total_index_entries);
+  }
+
+  vector<String> removed_files;
+  m_file_tracker.update_live(cellstore->get_filename(), removed_files,
+                             m_next_cs_id, total_index_entries);
+  m_file_tracker.update_files_column();
+
+  HT_INFOF("Adopted bulk loaded CellStore %s into %s", cs_file.c_str(),
+           m_full_name.c_str());
+}
+
 void AccessGroup::measure_garbage(double *total, double *garbage) {
   ScanContextPtr scan_ctx = make_shared<ScanContext>(m_schema);
   MergeScannerAccessGroupPtr mscanner 
@@ -468,6 +731,8 @@ void AccessGroup::measure_garbage(double *total, double *garbage) {
   if (immutable_scanner)
     mscanner->add_scanner(immutable_scanner);
 
+  m_cell_cache_manager->add_compact_scanner(mscanner.get(), scan_ctx.get());
+
   if (!m_in_memory) {
     for (size_t i=0; i<m_stores.size(); i++) {
       HT_ASSERT(m_stores[i].cs);
@@ -484,23 +749,77 @@ void AccessGroup::measure_garbage(double *total, double *garbage) {
 
 
 
-void AccessGroup::run_compaction(int maintenance_flags, Hints *hints) {
+size_t AccessGroup::purge_expired_stores(time_t now) {
+  vector<String> removed_files;
+  int64_t total_index_entries = 0;
+
+  {
+    lock_guard<mutex> lock(m_mutex);
+    time_t ttl_max = m_garbage_tracker.expirable_ttl_max();
+
+    if (m_in_memory || ttl_max == 0 || m_stores.empty())
+      return 0;
+
+    int64_t expire_cutoff = ((int64_t)(now - ttl_max)) * 1000000000LL;
+    vector<CellStoreInfo> new_stores;
+
+    for (auto &csi : m_stores) {
+      if (csi.timestamp_max > TIMESTAMP_MIN &&
+          csi.timestamp_max < expire_cutoff)
+        removed_files.push_back(csi.cs->get_filename());
+      else
+        new_stores.push_back(csi);
+    }
+
+    if (removed_files.empty())
+      return 0;
+
+    m_stores.swap(new_stores);
+    m_garbage_tracker.update_cellstore_info(m_stores, now, false);
+    get_merge_info(m_needs_merging, m_end_merge);
+    recompute_compression_ratio(&total_index_entries);
+  }
+
+  m_file_tracker.update_live("", removed_files, m_next_cs_id,
+                             total_index_entries);
+  m_file_tracker.update_files_column();
+
+  HT_INFOF("Dropped %d fully expired CellStore(s) from %s without compaction",
+           (int)removed_files.size(), m_full_name.c_str());
+
+  return removed_files.size();
+}
+
+
+void AccessGroup::run_compaction(int maintenance_flags, Hints *hints,
+                                 const char *split_row) {
   ByteString bskey;
   ByteString value;
   Key key;
   CellStorePtr cellstore;
-  CellCachePtr filtered_cache, shadow_cache;
+  CellStorePtr split_store;
+  CellCachePtr shadow_cache;
+  CellCacheCompactPtr new_compact_cache;
   String metadata_key_str;
   bool abort_loop = true;
   bool minor = false;
   bool merging = false;
   bool major = false;
   bool gc = false;
+  bool slice = false;
+  bool slice_truncated = false;
   bool cellstore_created = false;
   size_t merge_offset=0, merge_length=0;
+  int64_t slice_size = 0;
+  String slice_boundary_row;
   String added_file;
 
   hints->ag_name = m_name;
+
+  // Drop stores whose entire content has expired before considering what to
+  // compact; they can be reclaimed at metadata level without being read
+  purge_expired_stores(time(0));
+
   m_file_tracker.get_file_list(hints->files);
 
   while (abort_loop) {
@@ -519,9 +838,77 @@ void AccessGroup::run_compaction(int maintenance_flags, Hints *hints) {
            !MaintenanceFlag::move_compaction(maintenance_flags) &&
            !MaintenanceFlag::gc_compaction(maintenance_flags)))
         break;
-      major = true;
-      HT_INFOF("Starting Major Compaction of %s", m_full_name.c_str());
-      Global::load_statistics->increment_compactions_major();
+      slice_size =
+        Config::get_i64("Hypertable.RangeServer.AccessGroup."
+                        "IncrementalCompaction.SliceSize");
+      if (!MaintenanceFlag::split(maintenance_flags) &&
+          !MaintenanceFlag::move_compaction(maintenance_flags) &&
+          !MaintenanceFlag::gc_compaction(maintenance_flags) &&
+          !m_in_memory && !m_stores.empty() && slice_size > 0 &&
+          (sweep_in_progress() ||
+           m_disk_usage > (uint64_t)(slice_size + slice_size/2))) {
+        // Groom the access group one bounded sub-interval at a time; the
+        // sweep state (watermark, input set and slice outputs) is persisted
+        // in the hints file, so resume or abandon a sweep interrupted by a
+        // server restart
+        if (!m_sweep_slice_files.empty() &&
+            m_sweep_slices.size() != m_sweep_slice_files.size()) {
+          bool resumable = true;
+          for (const auto &fname : m_sweep_input_files) {
+            bool found = false;
+            for (const auto &csi : m_stores) {
+              if (csi.cs->get_filename() == fname) {
+                found = true;
+                break;
+              }
+            }
+            if (!found) {
+              resumable = false;
+              break;
+            }
+          }
+          if (resumable) {
+            try {
+              m_sweep_slices.clear();
+              for (const auto &fname : m_sweep_slice_files) {
+                CellStorePtr slice_store =
+                  CellStoreFactory::open(fname, m_start_row.c_str(),
+                                         m_end_row.c_str());
+                m_sweep_slices.push_back(slice_store);
+              }
+            }
+            catch (Exception &e) {
+              HT_WARNF("Problem re-opening compaction slice for %s - %s",
+                       m_full_name.c_str(), Error::get_text(e.code()));
+              resumable = false;
+            }
+          }
+          if (!resumable)
+            abandon_sweep();
+        }
+        // Fix the input store set on the first slice; stores flushed while
+        // the sweep is running contain rows below the watermark and must
+        // survive the final swap
+        if (m_sweep_input_files.empty()) {
+          m_compaction_watermark.clear();
+          for (const auto &csi : m_stores)
+            m_sweep_input_files.push_back(csi.cs->get_filename());
+        }
+        slice = true;
+        HT_INFOF("Starting Incremental Major Compaction of %s (watermark=%s)",
+                 m_full_name.c_str(), m_compaction_watermark.c_str());
+        Global::load_statistics->increment_compactions_major();
+        // The slice scan excludes the cell cache; merge any frozen cache
+        // back into the active one
+        merge_caches();
+      }
+      else {
+        if (sweep_in_progress())
+          abandon_sweep();
+        major = true;
+        HT_INFOF("Starting Major Compaction of %s", m_full_name.c_str());
+        Global::load_statistics->increment_compactions_major();
+      }
     }
     else {
       if (MaintenanceFlag::merging_compaction(maintenance_flags)) {
@@ -561,16 +948,26 @@ void AccessGroup::run_compaction(int maintenance_flags, Hints *hints) {
     merge_caches();
     hints->latest_stored_revision = m_latest_stored_revision;
     hints->disk_usage = m_disk_usage;
+    hints->prewarm_bytes = block_cache_memory();
+    load_sweep_hints(hints);
     return;
   }
 
   String cs_file;
+  String cs_file_upper;
   PropertiesPtr cellstore_props;
   {
     lock_guard<mutex> lock(m_schema_mutex);
     cellstore_props = m_cellstore_props;
   }
 
+  // For a split-driven major compaction, divide the output at the split row
+  // so each post-split range gets a store it owns outright, avoiding the
+  // follow-up major compaction both halves would otherwise need to shed the
+  // other half's data from a shared, SPLIT-flagged store
+  bool split_output = split_row && *split_row && major && !m_in_memory &&
+    MaintenanceFlag::split(maintenance_flags);
+
   try {
     time_t now = time(0);
     int64_t max_num_entries {};
@@ -580,7 +977,20 @@ void AccessGroup::run_compaction(int maintenance_flags, Hints *hints) {
 
     {
       lock_guard<mutex> lock(m_mutex);
-      scan_ctx = make_shared<ScanContext>(m_schema);
+
+      if (slice) {
+        // Restrict the merge scan to the rows beyond the watermark; the
+        // block indexes position the store scanners at the slice start
+        ScanSpecBuilder ssb;
+        ssb.add_row_interval(m_compaction_watermark,
+                             m_compaction_watermark.empty(), m_end_row, true);
+        RangeSpec rspec(m_start_row.c_str(), m_end_row.c_str());
+        scan_ctx = make_shared<ScanContext>(TIMESTAMP_MAX, &ssb.get(), &rspec,
+                                            m_schema);
+        scan_ctx->deep_copy_specs();
+      }
+      else
+        scan_ctx = make_shared<ScanContext>(m_schema);
 
       cs_file = format("%s/tables/%s/%s/%s/cs%d",
                        Global::toplevel_dir.c_str(),
@@ -588,6 +998,13 @@ void AccessGroup::run_compaction(int maintenance_flags, Hints *hints) {
                        m_range_dir.c_str(),
                        m_next_cs_id++);
 
+      if (split_output)
+        cs_file_upper = format("%s/tables/%s/%s/%s/cs%d",
+                               Global::toplevel_dir.c_str(),
+                               m_identifier.id, m_name.c_str(),
+                               m_range_dir.c_str(),
+                               m_next_cs_id++);
+
       /**
        * Check for garbage and if threshold reached, change minor to major
        * compaction.  If GC compaction was requested and garbage threshold
@@ -595,7 +1012,10 @@ void AccessGroup::run_compaction(int maintenance_flags, Hints *hints) {
        */
       if (gc || (minor && m_garbage_tracker.check_needed(now))) {
         double total, garbage;
-        measure_garbage(&total, &garbage);
+        // Use the garbage ratio observed by live scans, if enough scan data
+        // has been seen, to avoid a measurement-only merge scan
+        if (!m_garbage_tracker.get_scan_estimate(&total, &garbage))
+          measure_garbage(&total, &garbage);
         m_garbage_tracker.adjust_targets(now, total, garbage);
         if (m_garbage_tracker.collection_needed(total, garbage)) {
           if (minor || merging)
@@ -611,11 +1031,13 @@ void AccessGroup::run_compaction(int maintenance_flags, Hints *hints) {
           merge_caches();
           hints->latest_stored_revision = m_latest_stored_revision;
           hints->disk_usage = m_disk_usage;
+          hints->prewarm_bytes = block_cache_memory();
+          load_sweep_hints(hints);
           return;
         }
       }
 
-      cellstore = make_shared<CellStoreV7>(Global::dfs.get(), m_schema);
+      cellstore = make_shared<CellStoreV8>(Global::dfs.get(), m_schema);
 
       max_num_entries = m_cell_cache_manager->immutable_items();
 
@@ -624,9 +1046,29 @@ void AccessGroup::run_compaction(int maintenance_flags, Hints *hints) {
                                                         MergeScannerAccessGroup::IS_COMPACTION |
                                                         MergeScannerAccessGroup::ACCUMULATE_COUNTERS);
         m_cell_cache_manager->add_immutable_scanner(mscanner.get(), scan_ctx.get());
-        filtered_cache = make_shared<CellCache>();
+        m_cell_cache_manager->add_compact_scanner(mscanner.get(), scan_ctx.get());
+        max_num_entries += m_cell_cache_manager->compact_items();
+        new_compact_cache = make_shared<CellCacheCompact>();
       }
       else if (merging) {
+        // If the stores in the merge run cover disjoint row ranges, the
+        // merge would simply concatenate them; leave them in place as a
+        // trivial move and remember the run so it is not selected again
+        if (!m_end_merge &&
+            merge_run_is_trivial(merge_offset, merge_length, scan_ctx.get())) {
+          HT_INFOF("Aborting Merging Compaction of %s (trivial move: stores "
+                   "%d-%d cover disjoint row ranges)", m_full_name.c_str(),
+                   (int)merge_offset, (int)(merge_offset + merge_length - 1));
+          m_trivial_merge_run.clear();
+          for (size_t i = merge_offset; i < merge_offset + merge_length; i++)
+            m_trivial_merge_run.push_back(m_stores[i].cs.get());
+          merge_caches();
+          hints->latest_stored_revision = m_latest_stored_revision;
+          hints->disk_usage = m_disk_usage;
+          hints->prewarm_bytes = block_cache_memory();
+          load_sweep_hints(hints);
+          return;
+        }
         mscanner = make_shared<MergeScannerAccessGroup>(m_table_name, scan_ctx.get(),
                                                              MergeScannerAccessGroup::IS_COMPACTION |
                                                              MergeScannerAccessGroup::RETURN_DELETES);
@@ -645,8 +1087,26 @@ void AccessGroup::run_compaction(int maintenance_flags, Hints *hints) {
               (m_stores[i].cs->get_trailer()->get("total_entries")))/divisor;
         }
       }
+      else if (slice) {
+        // Like a non-end merge, the cell cache is not included, so delete
+        // records must be carried through to the slice outputs
+        mscanner = make_shared<MergeScannerAccessGroup>(m_table_name, scan_ctx.get(),
+                                                        MergeScannerAccessGroup::IS_COMPACTION |
+                                                        MergeScannerAccessGroup::RETURN_DELETES);
+        max_num_entries = 0;
+        for (size_t i=0; i<m_stores.size(); i++) {
+          HT_ASSERT(m_stores[i].cs);
+          if (find(m_sweep_input_files.begin(), m_sweep_input_files.end(),
+                   m_stores[i].cs->get_filename()) == m_sweep_input_files.end())
+            continue;
+          mscanner->add_scanner(m_stores[i].cs->create_scanner(scan_ctx.get()));
+          int divisor = (boost::any_cast<uint32_t>(m_stores[i].cs->get_trailer()->get("flags")) & CellStoreTrailerV7::SPLIT) ? 2: 1;
+          max_num_entries += (boost::any_cast<int64_t>
+              (m_stores[i].cs->get_trailer()->get("total_entries")))/divisor;
+        }
+      }
       else if (major) {
-        mscanner = make_shared<MergeScannerAccessGroup>(m_table_name, scan_ctx.get(), 
+        mscanner = make_shared<MergeScannerAccessGroup>(m_table_name, scan_ctx.get(),
                                                         MergeScannerAccessGroup::IS_COMPACTION |
                                                         MergeScannerAccessGroup::ACCUMULATE_COUNTERS);
         m_cell_cache_manager->add_immutable_scanner(mscanner.get(), scan_ctx.get());
@@ -664,13 +1124,51 @@ void AccessGroup::run_compaction(int maintenance_flags, Hints *hints) {
       }
     }
 
-    cellstore->create(cs_file.c_str(), max_num_entries, cellstore_props, &m_identifier);
+    cellstore->create(cs_file.c_str(),
+                      split_output ? (max_num_entries/2)+1 : max_num_entries,
+                      cellstore_props, &m_identifier);
+
+    // Draw on the maintenance byte rate budget in block-sized chunks so
+    // that foreground scans are not starved by the compaction
+    uint64_t throttle_bytes {};
+
+    int64_t slice_bytes = 0;
 
     if (mscanner) {
       while (mscanner->get(key, value)) {
+        if (slice) {
+          // Once the slice byte budget is exhausted, finish the current row
+          // and stop; the boundary row becomes the new watermark
+          if (!slice_boundary_row.empty() &&
+              strcmp(key.row, slice_boundary_row.c_str())) {
+            slice_truncated = true;
+            break;
+          }
+          slice_bytes += key.length + value.length();
+          if (slice_bytes >= slice_size && slice_boundary_row.empty())
+            slice_boundary_row = key.row;
+        }
+        else if (split_output && !split_store &&
+                 strcmp(key.row, split_row) > 0) {
+          // Crossed the split row; seal the lower store and switch the
+          // output to the upper store
+          CellStoreTrailerV7 *lower_trailer =
+            dynamic_cast<CellStoreTrailerV7 *>(cellstore->get_trailer());
+          lower_trailer->flags |= CellStoreTrailerV6::MAJOR_COMPACTION;
+          cellstore->finalize(&m_identifier);
+          split_store = cellstore;
+          cellstore = make_shared<CellStoreV8>(Global::dfs.get(), m_schema);
+          cellstore->create(cs_file_upper.c_str(), (max_num_entries/2)+1,
+                            cellstore_props, &m_identifier);
+        }
         cellstore->add(key, value);
         if (m_in_memory)
-          filtered_cache->add(key, value);
+          new_compact_cache->add(key, value);
+        throttle_bytes += key.length + value.length();
+        if (throttle_bytes >= 65536 && Global::maintenance_throttle) {
+          Global::maintenance_throttle->throttle(throttle_bytes);
+          throttle_bytes = 0;
+        }
         mscanner->forward();
       }
       m_garbage_tracker.adjust_targets(now, mscanner.get());
@@ -679,7 +1177,12 @@ void AccessGroup::run_compaction(int maintenance_flags, Hints *hints) {
       while (scanner->get(key, value)) {
         cellstore->add(key, value);
         if (m_in_memory)
-          filtered_cache->add(key, value);
+          new_compact_cache->add(key, value);
+        throttle_bytes += key.length + value.length();
+        if (throttle_bytes >= 65536 && Global::maintenance_throttle) {
+          Global::maintenance_throttle->throttle(throttle_bytes);
+          throttle_bytes = 0;
+        }
         scanner->forward();
       }
     }
@@ -692,7 +1195,9 @@ void AccessGroup::run_compaction(int maintenance_flags, Hints *hints) {
     if (major)
       trailer->flags |= CellStoreTrailerV6::MAJOR_COMPACTION;
 
-    if (maintenance_flags & MaintenanceFlag::SPLIT)
+    // When the split output was divided at the split row, neither store
+    // straddles the split, so the estimate-halving SPLIT flag is not needed
+    if ((maintenance_flags & MaintenanceFlag::SPLIT) && !split_output)
       trailer->flags |= CellStoreTrailerV7::SPLIT;
 
     cellstore->finalize(&m_identifier);
@@ -709,10 +1214,22 @@ void AccessGroup::run_compaction(int maintenance_flags, Hints *hints) {
 
     cellstore_created = true;
 
+    /**
+     * Release the drain scanners now that the new CellStore is finalized.
+     * The frozen cache cannot be freed page-by-page as it drains, because
+     * concurrent scans share it and its arena pages interleave key ranges,
+     * but dropping these references here lets its memory go the moment the
+     * immutable cache is uninstalled below instead of surviving the live
+     * file bookkeeping at the end of compaction.
+     */
+    mscanner.reset();
+    scanner.reset();
+
     /**
      * Install new CellCache and CellStore and update Live file tracker
      */
     vector<String> removed_files;
+    vector<String> extra_files_added;
     int64_t total_index_entries = 0;
     {
       lock_guard<mutex> lock(m_mutex);
@@ -737,11 +1254,48 @@ void AccessGroup::run_compaction(int maintenance_flags, Hints *hints) {
           m_cell_cache_manager->drop_immutable_cache();
 
       }
+      else if (slice) {
+        // Slice outputs stay invisible (out of the live store set and the
+        // Files column) until the whole sweep completes; a restart before
+        // completion must come back up on the unmodified input stores
+        if (cellstore->get_total_entries() > 0) {
+          m_sweep_slices.push_back(cellstore);
+          m_sweep_slice_files.push_back(cellstore->get_filename());
+        }
+        if (slice_truncated)
+          m_compaction_watermark = slice_boundary_row;
+        else {
+          // Sweep complete; atomically swap the input stores for the
+          // accumulated slices.  Slices are ordered by row, so they precede
+          // any stores flushed while the sweep was running.
+          vector<CellStoreInfo> new_stores;
+          for (auto &sweep_csi : m_sweep_slices)
+            new_stores.push_back(sweep_csi);
+          for (auto &csi : m_stores) {
+            if (find(m_sweep_input_files.begin(), m_sweep_input_files.end(),
+                     csi.cs->get_filename()) != m_sweep_input_files.end())
+              removed_files.push_back(csi.cs->get_filename());
+            else
+              new_stores.push_back(csi);
+          }
+          m_stores.swap(new_stores);
+          for (auto &fname : m_sweep_slice_files)
+            extra_files_added.push_back(fname);
+          m_sweep_slices.clear();
+          m_sweep_slice_files.clear();
+          m_sweep_input_files.clear();
+          m_compaction_watermark.clear();
+        }
+      }
       else {
 
         if (m_in_memory) {
-          m_cell_cache_manager->install_new_immutable_cache(filtered_cache);
-          m_cell_cache_manager->merge_caches(m_schema);
+          // The compaction output is the complete flushed data set, so it
+          // replaces both the frozen cache and the previous compact cache;
+          // post-freeze updates remain in the active cache
+          new_compact_cache->finalize();
+          m_cell_cache_manager->drop_immutable_cache();
+          m_cell_cache_manager->install_compact_cache(new_compact_cache);
           for (size_t i=0; i<m_stores.size(); i++)
             removed_files.push_back(m_stores[i].cs->get_filename());
           m_stores.clear();
@@ -762,6 +1316,13 @@ void AccessGroup::run_compaction(int maintenance_flags, Hints *hints) {
           }
         }
 
+        // Lower half of a split-divided output; the upper half is added
+        // below as the primary output
+        if (split_store && split_store->get_total_entries() > 0) {
+          m_stores.push_back(split_store);
+          extra_files_added.push_back(split_store->get_filename());
+        }
+
         /** Add the new cell store to the table vector, or delete it if
          * it contains no entries
          */
@@ -774,12 +1335,19 @@ void AccessGroup::run_compaction(int maintenance_flags, Hints *hints) {
         }
       }
 
-      m_garbage_tracker.update_cellstore_info(m_stores, now, major||m_in_memory);
+      m_garbage_tracker.update_cellstore_info(m_stores, now,
+          major || m_in_memory || (slice && !slice_truncated));
 
       // If compaction included CellCache, recompute latest stored revision
-      if (!merging || m_end_merge) {
+      if (!slice && (!merging || m_end_merge)) {
         m_latest_stored_revision = boost::any_cast<int64_t>
           (cellstore->get_trailer()->get("revision"));
+        if (split_store) {
+          int64_t lower_revision = boost::any_cast<int64_t>
+            (split_store->get_trailer()->get("revision"));
+          if (lower_revision > m_latest_stored_revision)
+            m_latest_stored_revision = lower_revision;
+        }
         if (m_latest_stored_revision >= m_earliest_cached_revision)
           HT_ERROR("Revision (clock) skew detected! May result in data loss.");
         m_cellcache_needs_compaction = false;
@@ -789,6 +1357,8 @@ void AccessGroup::run_compaction(int maintenance_flags, Hints *hints) {
       recompute_compression_ratio(&total_index_entries);
       hints->latest_stored_revision = m_latest_stored_revision;
       hints->disk_usage = m_disk_usage;
+      hints->prewarm_bytes = block_cache_memory();
+      load_sweep_hints(hints);
     }
 
     if (cellstore->get_total_entries() == 0) {
@@ -802,6 +1372,24 @@ void AccessGroup::run_compaction(int maintenance_flags, Hints *hints) {
       }
     }
 
+    if (split_store && split_store->get_total_entries() == 0) {
+      String fname = split_store->get_filename();
+      split_store = 0;
+      try {
+        Global::dfs->remove(fname);
+      }
+      catch (Hypertable::Exception &e) {
+        HT_WARN_OUT << "Problem removing empty CellStore '" << fname << "' " << e << HT_END;
+      }
+    }
+
+    for (const auto &fname : extra_files_added) {
+      if (added_file.empty())
+        added_file = fname;
+      else
+        m_file_tracker.add_live_noupdate(fname, total_index_entries);
+    }
+
     m_file_tracker.update_live(added_file, removed_files, m_next_cs_id, total_index_entries);
     m_file_tracker.update_files_column();
     m_file_tracker.get_file_list(hints->files);
@@ -835,6 +1423,13 @@ void AccessGroup::run_compaction(int maintenance_flags, Hints *hints) {
         catch (Hypertable::Exception &e) {
         }
       }
+      if (!cs_file_upper.empty()) {
+        try {
+          Global::dfs->remove(cs_file_upper);
+        }
+        catch (Hypertable::Exception &e) {
+        }
+      }
       HT_ERROR_OUT << m_full_name << " " << e << HT_END;
       throw;
     }
@@ -849,6 +1444,77 @@ void AccessGroup::load_hints(Hints *hints) {
   lock_guard<mutex> lock(m_mutex);
   hints->latest_stored_revision = m_latest_stored_revision;
   hints->disk_usage = m_disk_usage;
+  hints->prewarm_bytes = block_cache_memory();
+  load_sweep_hints(hints);
+}
+
+void AccessGroup::load_sweep_hints(Hints *hints) {
+  hints->compaction_watermark = m_compaction_watermark;
+  hints->compaction_slices = join_file_list(m_sweep_slice_files);
+  hints->compaction_inputs = join_file_list(m_sweep_input_files);
+}
+
+uint64_t AccessGroup::block_cache_memory() {
+  uint64_t total = 0;
+  if (Global::block_cache) {
+    for (auto &csi : m_stores)
+      total += Global::block_cache->memory_used_by_file(csi.cs->get_file_id());
+  }
+  return total;
+}
+
+void AccessGroup::prewarm_block_cache() {
+  vector<CellStorePtr> stores;
+  int64_t budget;
+
+  {
+    lock_guard<mutex> lock(m_mutex);
+    budget = (int64_t)m_prewarm_bytes;
+    // Even with no hint budget the stores are given a chance to claim
+    // exact warmup extents persisted by the previous process
+    if (Global::block_cache == 0 ||
+        (budget == 0 && !Global::block_cache->warmup_pending()))
+      return;
+    for (auto &csi : m_stores)
+      stores.push_back(csi.cs);
+  }
+
+  // Walk the stores newest-first since recently written data is the most
+  // likely to be hot
+  int64_t inserted = 0;
+  for (auto iter = stores.rbegin(); iter != stores.rend(); ++iter) {
+    if (budget > 0 && inserted >= budget)
+      break;
+    inserted += (*iter)->prewarm_blocks(budget - inserted);
+  }
+
+  if (inserted > 0)
+    HT_INFOF("Prewarmed %lld bytes of block cache for %s",
+             (Lld)inserted, m_full_name.c_str());
+}
+
+void AccessGroup::get_file_ids(std::set<int> &file_ids) {
+  lock_guard<mutex> lock(m_mutex);
+  for (auto &csi : m_stores)
+    file_ids.insert(csi.cs->get_file_id());
+}
+
+void AccessGroup::abandon_sweep() {
+  HT_INFOF("Abandoning incremental compaction sweep of %s (watermark=%s)",
+           m_full_name.c_str(), m_compaction_watermark.c_str());
+  m_sweep_slices.clear();
+  for (const auto &fname : m_sweep_slice_files) {
+    try {
+      Global::dfs->remove(fname);
+    }
+    catch (Exception &e) {
+      HT_WARNF("Problem removing compaction slice '%s' - %s", fname.c_str(),
+               Error::get_text(e.code()));
+    }
+  }
+  m_sweep_slice_files.clear();
+  m_sweep_input_files.clear();
+  m_compaction_watermark.clear();
 }
 
 String AccessGroup::describe() {
@@ -908,7 +1574,12 @@ AccessGroup::shrink(String &split_row, bool drop_high, Hints *hints) {
   hints->ag_name = m_name;
   m_file_tracker.get_file_list(hints->files);
 
+  // The row interval is changing underneath the sweep's fixed input set
+  if (sweep_in_progress())
+    abandon_sweep();
+
   CellCachePtr old_cell_cache = m_cell_cache_manager->active_cache();
+  CellCacheCompactPtr old_compact_cache = m_cell_cache_manager->compact_cache();
 
   m_recovering = true;
 
@@ -930,6 +1601,14 @@ AccessGroup::shrink(String &split_row, bool drop_high, Hints *hints) {
     m_file_tracker.change_range(m_start_row, m_end_row);
 
     m_cell_cache_manager->install_new_active_cache(make_shared<CellCache>());
+
+    /**
+     * Shrink the compact cache (in-memory access groups)
+     */
+    if (m_cell_cache_manager->compact_cache())
+      m_cell_cache_manager->install_compact_cache(
+          m_cell_cache_manager->compact_cache()->shrink(split_row, drop_high));
+
     {
       lock_guard<CellCacheManager> ccm_lock(*m_cell_cache_manager);
 
@@ -987,6 +1666,8 @@ AccessGroup::shrink(String &split_row, bool drop_high, Hints *hints) {
     recompute_compression_ratio();
     hints->latest_stored_revision = m_latest_stored_revision;
     hints->disk_usage = m_disk_usage;
+    hints->prewarm_bytes = block_cache_memory();
+    load_sweep_hints(hints);
     m_garbage_tracker.update_cellstore_info(m_stores);
 
     m_earliest_cached_revision_saved = TIMESTAMP_MAX;
@@ -996,6 +1677,7 @@ AccessGroup::shrink(String &split_row, bool drop_high, Hints *hints) {
   catch (Exception &e) {
     m_recovering = false;
     m_cell_cache_manager->install_new_active_cache(old_cell_cache);
+    m_cell_cache_manager->install_compact_cache(old_compact_cache);
     m_earliest_cached_revision = m_earliest_cached_revision_saved;
     m_earliest_cached_revision_saved = TIMESTAMP_MAX;
     throw;
@@ -1124,85 +1806,74 @@ void AccessGroup::recompute_compression_ratio(int64_t *total_index_entriesp) {
 
 
 bool AccessGroup::find_merge_run(size_t *indexp, size_t *lenp) {
-  size_t index = 0;
-  size_t i = 0;
-  size_t count;
-  int64_t running_total = 0;
 
-  if (m_in_memory || m_stores.size() <= 1)
+  // Merging would invalidate the fixed input set of an in-progress
+  // incremental major compaction sweep
+  if (m_in_memory || m_stores.size() <= 1 || sweep_in_progress())
     return false;
 
   vector<int64_t> disk_usage(m_stores.size());
+  for (size_t i = 0; i < m_stores.size(); i++)
+    disk_usage[i] = m_stores[i].cs->disk_usage();
 
-  // If in "low activity" window, first try to be more aggresive
-  if (Global::low_activity_time.within_window()) {
-    bool run_found = false;
-    for (int64_t target = Global::cellstore_target_size_min*2;
-         target <= Global::cellstore_target_size_max;
-         target += Global::cellstore_target_size_min) {
-      index = 0;
-      i = 0;
-      running_total = 0;
-
-      do {
-        disk_usage[i] = m_stores[i].cs->disk_usage();
-        running_total += disk_usage[i];
-
-        if (running_total >= target) {
-          count = (i - index) + 1;
-          if (count >= (size_t)2) {
-            if (indexp)
-              *indexp = index;
-            if (lenp)
-              *lenp = count;
-            run_found = true;
-            break;
-          }
-          // Otherwise, move the index forward by one and try again
-          running_total -= disk_usage[index];
-          index++;
-        }
-        i++;
-      } while (i < m_stores.size());
-      if (i == m_stores.size())
-        break;
-    }
-    if (run_found)
-      return true;
+  CompactionPolicyPtr policy;
+  {
+    lock_guard<mutex> lock(m_schema_mutex);
+    policy = m_compaction_policy;
   }
 
-  index = 0;
-  i = 0;
-  running_total = 0;
-  do {
-    disk_usage[i] = m_stores[i].cs->disk_usage();
-    running_total += disk_usage[i];
-
-    if (running_total >= Global::cellstore_target_size_min) {
-      count = (i - index) + 1;
-      if (count >= (size_t)Global::merge_cellstore_run_length_threshold) {
-        if (indexp)
-          *indexp = index;
-        if (lenp)
-          *lenp = count;
-        return true;
-      }
-      // Otherwise, move the index forward by one and try again
-      running_total -= disk_usage[index];
-      index++;
-    }
-    i++;
-  } while (i < m_stores.size());
-
-  if ((i-index) >= (size_t)Global::merge_cellstore_run_length_threshold) {
-    if (indexp)
-      *indexp = index;
-    if (lenp)
-      *lenp = i-index;
-    return true;
+  size_t index = 0;
+  size_t length = 0;
+
+  if (!policy->find_merge_run(disk_usage,
+                              Global::low_activity_time.within_window(),
+                              &index, &length))
+    return false;
+
+  // Suppress re-selection of a run that was skipped as a trivial move.  The
+  // comparison fails naturally once the store set changes.
+  if (length == m_trivial_merge_run.size()) {
+    size_t i = 0;
+    while (i < length &&
+           m_stores[index + i].cs.get() == m_trivial_merge_run[i])
+      i++;
+    if (i == length)
+      return false;
   }
 
-  return false;
+  if (indexp)
+    *indexp = index;
+  if (lenp)
+    *lenp = length;
+  return true;
+}
+
+bool AccessGroup::merge_run_is_trivial(size_t offset, size_t len,
+                                       ScanContext *scan_ctx) {
+  String prev_max_row;
+  bool have_prev = false;
+
+  for (size_t i = offset; i < offset + len; i++) {
+    String max_row;
+    Key key;
+    ByteString value;
+
+    HT_ASSERT(m_stores[i].cs);
+
+    if (!m_stores[i].cs->get_max_row(max_row))
+      return false;
+
+    CellListScannerPtr scanner = m_stores[i].cs->create_scanner(scan_ctx);
+    if (!scanner->get(key, value))
+      continue;  // an empty store overlaps nothing
+
+    if (have_prev && strcmp(key.row, prev_max_row.c_str()) <= 0)
+      return false;
+
+    prev_max_row = max_row;
+    have_prev = true;
+  }
+  return true;
 }
 
 namespace {
@@ -1273,6 +1944,9 @@ ostream &Hypertable::operator<<(ostream &os, const AccessGroup::MaintenanceData
   os << "bloom_filter_maybes=" << mdata.bloom_filter_maybes << "\n";
   os << "bloom_filter_fps=" << mdata.bloom_filter_fps << "\n";
   os << "shadow_cache_memory=" << mdata.shadow_cache_memory << "\n";
+  os << "block_cache_memory=" << mdata.block_cache_memory << "\n";
+  os << "block_cache_accesses=" << mdata.block_cache_accesses << "\n";
+  os << "block_cache_hits=" << mdata.block_cache_hits << "\n";
   os << "in_memory=" << (mdata.in_memory ? "true" : "false") << "\n";
   os << "gc_needed=" << (mdata.gc_needed ? "true" : "false") << "\n";
   os << "needs_merging=" << (mdata.needs_merging ? "true" : "false") << "\n";
@@ -31,6 +31,7 @@
 #include <Hypertable/RangeServer/CellCacheManager.h>
 #include <Hypertable/RangeServer/CellStore.h>
 #include <Hypertable/RangeServer/CellStoreInfo.h>
+#include <Hypertable/RangeServer/CompactionPolicy.h>
 #include <Hypertable/RangeServer/LiveFileTracker.h>
 #include <Hypertable/RangeServer/MaintenanceFlag.h>
 #include <Hypertable/RangeServer/MergeScannerAccessGroup.h>
@@ -105,6 +106,9 @@ namespace Hypertable {
       uint32_t bloom_filter_maybes;
       uint32_t bloom_filter_fps;
       uint64_t shadow_cache_memory;
+      uint64_t block_cache_memory;
+      uint64_t block_cache_accesses;
+      uint64_t block_cache_hits;
       bool     in_memory;
       bool     gc_needed;
       bool     needs_merging;
@@ -113,23 +117,43 @@ namespace Hypertable {
 
     class Hints {
     public:
-      Hints() : latest_stored_revision(TIMESTAMP_MIN), disk_usage(0) { }
+      Hints() : latest_stored_revision(TIMESTAMP_MIN), disk_usage(0),
+                prewarm_bytes(0) { }
       void clear() {
         ag_name.clear();
         latest_stored_revision = TIMESTAMP_MIN;
         disk_usage = 0;
         files.clear();
+        prewarm_bytes = 0;
+        compaction_watermark.clear();
+        compaction_slices.clear();
+        compaction_inputs.clear();
       }
       bool operator==(const Hints &other) const {
         return ag_name == other.ag_name &&
           latest_stored_revision == other.latest_stored_revision &&
           disk_usage == other.disk_usage &&
-          files == other.files;
+          files == other.files &&
+          prewarm_bytes == other.prewarm_bytes &&
+          compaction_watermark == other.compaction_watermark &&
+          compaction_slices == other.compaction_slices &&
+          compaction_inputs == other.compaction_inputs;
       }
       String ag_name;
       int64_t latest_stored_revision;
       uint64_t disk_usage;
       String files;
+      /// Bytes of this access group's block data resident in the block
+      /// cache, used to size cache prewarming after a range move
+      uint64_t prewarm_bytes;
+      /// Last row covered by an in-progress incremental major compaction
+      String compaction_watermark;
+      /// ';'-separated slice output files of in-progress incremental
+      /// major compaction
+      String compaction_slices;
+      /// ';'-separated input files of in-progress incremental major
+      /// compaction
+      String compaction_inputs;
     };
 
     AccessGroup(const TableIdentifier *identifier, SchemaPtr &schema,
@@ -139,7 +163,10 @@ namespace Hypertable {
     /// Adds a key/value pair
     /// @param key Key
     /// @param value Value
-    void add(const Key &key, const ByteString value);
+    /// @param buffer Buffer holding the serialized cell, passed through to
+    /// the cell cache for zero-copy insertion, or 0 to force a copy
+    void add(const Key &key, const ByteString value,
+             const StaticBufferPtr &buffer = StaticBufferPtr());
 
     void split_row_estimate_data_cached(CellList::SplitRowDataMapT &split_row_data);
 
@@ -156,15 +183,12 @@ namespace Hypertable {
 
     void update_schema(SchemaPtr &schema, AccessGroupSpec *ag_spec);
 
-    void lock() {
-      m_mutex.lock();
-      m_cell_cache_manager->lock();
-    }
+    // Cell cache inserts are safe under concurrent scanners, so the
+    // update path only needs to serialize against access group state
+    // changes (compactions, splits, schema updates)
+    void lock() { m_mutex.lock(); }
 
-    void unlock() {
-      m_cell_cache_manager->unlock();
-      m_mutex.unlock();
-    }
+    void unlock() { m_mutex.unlock(); }
 
     MergeScannerAccessGroup *create_scanner(ScanContext *scan_ctx);
 
@@ -175,6 +199,18 @@ namespace Hypertable {
 
     void load_cellstore(CellStorePtr &cellstore);
 
+    /// Atomically links a bulk loaded CellStore file into the access group.
+    /// Renames <code>source_file</code> into the access group's range
+    /// directory, opens it, adds it to the live store vector and updates the
+    /// <i>Files</i> METADATA column.  The file must contain keys sorted in
+    /// the standard CellStore order and restricted to this access group's
+    /// column families and row interval.
+    /// @param source_file Pathname of bulk loaded CellStore file
+    /// @throws Exception with code Error::NOT_ALLOWED if the access group is
+    /// <i>in memory</i>, or Error::RANGESERVER_CORRUPT_CELLSTORE if the file
+    /// cannot be opened
+    void adopt_cellstore(const String &source_file);
+
     void pre_load_cellstores() {
       std::lock_guard<std::mutex> lock(m_mutex);
       m_latest_stored_revision = TIMESTAMP_MIN;
@@ -191,7 +227,16 @@ namespace Hypertable {
 
     void measure_garbage(double *total, double *garbage);
 
-    void run_compaction(int maintenance_flags, Hints *hints);
+    /** Runs a compaction.
+     * @param maintenance_flags Maintenance flags (see MaintenanceFlag)
+     * @param hints Pointer to hints structure to be filled in
+     * @param split_row Split row of a pending split; when supplied for a
+     * split-driven major compaction, the output is written as two CellStores
+     * divided at this row so that each post-split range owns its half
+     * outright instead of sharing a straddling store
+     */
+    void run_compaction(int maintenance_flags, Hints *hints,
+                        const char *split_row = 0);
 
     uint64_t purge_memory(MaintenanceFlag::Map &subtask_map);
 
@@ -214,9 +259,27 @@ namespace Hypertable {
 
     void release_files(const std::vector<String> &files);
 
-    void recovery_initialize() { m_recovering = true; }
+    /// Prepares the access group for commit log replay.
+    /// Sets the recovering flag and, if cell cache checkpoints are enabled,
+    /// restores the caches from the checkpoint written at the last clean
+    /// shutdown.
+    /// @return Largest cell revision restored from the checkpoint, or
+    /// TIMESTAMP_MIN if nothing was restored
+    int64_t recovery_initialize();
     void recovery_finalize() { m_recovering = false; }
 
+    /// Writes the cell caches to a local checkpoint file.
+    /// Serializes the active and immutable caches to a checkpoint file in
+    /// Global::cell_cache_checkpoint_dir so that a subsequent clean restart
+    /// can restore them instead of re-inserting their cells during commit
+    /// log replay.  Problems are logged and swallowed; a missing checkpoint
+    /// merely costs the restarted server a log replay.
+    /// @param written Vector to which the checkpoint pathname is appended
+    /// if a file was written
+    /// @return <i>true</i> if the caches were serialized (or were empty),
+    /// <i>false</i> if the checkpoint could not be written
+    bool write_cell_cache_checkpoint(std::vector<String> &written);
+
     void dump_keys(std::ofstream &out);
 
     /// Prints human-readable representation of garbage tracker state to an
@@ -236,6 +299,23 @@ namespace Hypertable {
 
     void load_hints(Hints *hints);
 
+    /// Reads this access group's hottest block data into the block cache.
+    /// Reads up to the <i>prewarm bytes</i> hint (the amount of this access
+    /// group's block data that was cache-resident on the server that last
+    /// wrote the hints file) of data blocks from the cell stores into the
+    /// global block cache.  Called from a prewarm maintenance task after a
+    /// range move so the range is served warm.
+    void prewarm_block_cache();
+
+    /// Returns the amount of this access group's block data that was
+    /// cache-resident on the server that last wrote the hints file; a
+    /// proxy for the range's recent read activity.
+    uint64_t prewarm_bytes() { return m_prewarm_bytes; }
+
+    /// Collects the block cache file IDs of this access group's cell stores.
+    /// @param file_ids Set to which the file IDs are added
+    void get_file_ids(std::set<int> &file_ids);
+
     String describe();
 
   private:
@@ -243,10 +323,68 @@ namespace Hypertable {
     void purge_stored_cells_from_cache();
     void merge_caches();
     void range_dir_initialize();
+    int64_t restore_cell_cache_checkpoint();
     void recompute_compression_ratio(int64_t *total_index_entriesp=0);
 
+    /** Drops CellStores whose entire content has expired.
+     * If every live column family in the access group carries a TTL, a
+     * store whose maximum cell timestamp lies before <code>now</code> minus
+     * the largest of those TTLs contains nothing but garbage, so it is
+     * removed from the live store set and the METADATA <i>Files</i> column
+     * without being read.  Relies on the timestamp range persisted in the
+     * CellStore trailer; stores written by formats that lack it are never
+     * dropped.  Expired delete markers go with the store, which is safe
+     * because any cell they cover is older still and therefore also
+     * expired.
+     * @param now Current time
+     * @return Count of stores dropped
+     */
+    size_t purge_expired_stores(time_t now);
+
     bool find_merge_run(size_t *indexp=0, size_t *lenp=0);
 
+    /** Checks if a merge run is a trivial move.
+     * A merge run is a trivial move if the row ranges of the stores in the
+     * run are pairwise disjoint, in which case merging them would produce
+     * the same cells in the same order and the rewrite can be skipped.  The
+     * largest row of each store is taken from its block index and the
+     * smallest row from a single-block read.
+     * @param offset Offset of first store in merge run
+     * @param len Length of merge run
+     * @param scan_ctx Scan context for probing the smallest row
+     * @return <i>true</i> if the stores in the run cover disjoint row ranges
+     * @note <code>m_mutex</code> must be locked when calling this method
+     */
+    bool merge_run_is_trivial(size_t offset, size_t len,
+                              ScanContext *scan_ctx);
+
+    /** Checks if an incremental major compaction sweep is in progress.
+     * @return <i>true</i> if a sweep has fixed its input store set
+     * @note <code>m_mutex</code> must be locked when calling this method
+     */
+    bool sweep_in_progress() { return !m_sweep_input_files.empty(); }
+
+    /** Abandons an in-progress incremental major compaction sweep.
+     * Removes any slice output files from the DFS and clears the sweep
+     * state (watermark, input file set and slice stores).  Called when the
+     * input store set is about to be invalidated, e.g. by a full major
+     * compaction or a shrink.
+     * @note <code>m_mutex</code> must be locked when calling this method
+     */
+    void abandon_sweep();
+
+    /** Copies incremental compaction sweep state into <code>hints</code>.
+     * @param hints Hints structure to populate
+     * @note <code>m_mutex</code> must be locked when calling this method
+     */
+    void load_sweep_hints(Hints *hints);
+
+    /** Returns bytes of this access group's block data resident in the
+     * global block cache.
+     * @note <code>m_mutex</code> must be locked when calling this method
+     */
+    uint64_t block_cache_memory();
+
     /** Gets merging compaction information.
      * Determines whether or not a merging compaction is needed, and if so,
      * whether or not the "merge run" includes the end cell store (the one
@@ -280,6 +418,13 @@ namespace Hypertable {
     String m_end_row;
     String m_range_name;
     std::vector<CellStoreInfo> m_stores;
+    std::vector<CellStore *> m_trivial_merge_run;
+    std::vector<CellStoreInfo> m_sweep_slices;
+    std::vector<String> m_sweep_slice_files;
+    std::vector<String> m_sweep_input_files;
+    String m_compaction_watermark;
+    uint64_t m_prewarm_bytes {};
+    CompactionPolicyPtr m_compaction_policy;
     PropertiesPtr m_cellstore_props;
     CellCacheManagerPtr m_cell_cache_manager;
     uint32_t m_next_cs_id {};
@@ -289,6 +434,9 @@ namespace Hypertable {
     int64_t m_earliest_cached_revision_saved {TIMESTAMP_MAX};
     int64_t m_latest_stored_revision {TIMESTAMP_MIN};
     int64_t m_latest_stored_revision_hint {TIMESTAMP_MIN};
+    /// Largest cell revision restored from the cell cache checkpoint;
+    /// replayed cells at or below this revision are already in the cache
+    int64_t m_restored_revision {TIMESTAMP_MIN};
     LiveFileTracker m_file_tracker;
     AccessGroupGarbageTracker m_garbage_tracker;
     bool m_is_root {};
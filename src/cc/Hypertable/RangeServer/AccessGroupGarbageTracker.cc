@@ -54,8 +54,11 @@ AccessGroupGarbageTracker::AccessGroupGarbageTracker(PropertiesPtr &props,
 
 void AccessGroupGarbageTracker::update_schema(AccessGroupSpec *ag_spec) {
   lock_guard<mutex> lock(m_mutex);
+  bool have_live_family = false;
   m_have_max_versions = false;
   m_min_ttl = 0;
+  m_max_ttl = 0;
+  m_all_families_ttl = true;
   m_in_memory = ag_spec->get_option_in_memory();
   for (auto cf_spec : ag_spec->columns()) {
     if (cf_spec->get_option_max_versions() > 0)
@@ -65,11 +68,27 @@ void AccessGroupGarbageTracker::update_schema(AccessGroupSpec *ag_spec) {
         m_min_ttl = (time_t)cf_spec->get_option_ttl();
       else if (cf_spec->get_option_ttl() < m_min_ttl)
         m_min_ttl = cf_spec->get_option_ttl();
+      if ((time_t)cf_spec->get_option_ttl() > m_max_ttl)
+        m_max_ttl = (time_t)cf_spec->get_option_ttl();
+    }
+    // Cells of deleted families are garbage regardless of age, so only
+    // live families count against full-store expirability
+    if (!cf_spec->get_deleted()) {
+      have_live_family = true;
+      if (cf_spec->get_option_ttl() == 0)
+        m_all_families_ttl = false;
     }
   }
+  if (!have_live_family)
+    m_all_families_ttl = false;
   m_elapsed_target_minimum = m_elapsed_target = m_min_ttl/10;
 }
 
+time_t AccessGroupGarbageTracker::expirable_ttl_max() {
+  lock_guard<mutex> lock(m_mutex);
+  return m_all_families_ttl ? m_max_ttl : 0;
+}
+
 void
 AccessGroupGarbageTracker::update_cellstore_info(vector<CellStoreInfo> &stores,
                                                  time_t t,
@@ -88,9 +107,28 @@ AccessGroupGarbageTracker::update_cellstore_info(vector<CellStoreInfo> &stores,
   if (collection_performed) {
     m_last_collection_time = (t==0) ? time(0) : t;
     m_last_collection_disk_usage = m_current_disk_usage;
+    m_scan_sample_total = 0;
+    m_scan_sample_garbage = 0;
   }
 }
 
+void AccessGroupGarbageTracker::add_scan_sample(int64_t total,
+                                                int64_t garbage) {
+  lock_guard<mutex> lock(m_mutex);
+  m_scan_sample_total += total;
+  m_scan_sample_garbage += garbage;
+}
+
+bool AccessGroupGarbageTracker::get_scan_estimate(double *totalp,
+                                                  double *garbagep) {
+  lock_guard<mutex> lock(m_mutex);
+  if (m_scan_sample_total < m_accum_data_target_minimum)
+    return false;
+  *totalp = (double)m_scan_sample_total;
+  *garbagep = (double)m_scan_sample_garbage;
+  return true;
+}
+
 void AccessGroupGarbageTracker::output_state(std::ofstream &out,
                                              const std::string &label) {
   lock_guard<mutex> lock(m_mutex);
@@ -114,9 +152,14 @@ void AccessGroupGarbageTracker::output_state(std::ofstream &out,
 
 bool AccessGroupGarbageTracker::check_needed(time_t now) {
   lock_guard<mutex> lock(m_mutex);
-  if (m_last_collection_time)
-    return check_needed_deletes() || check_needed_ttl(now);
-  return false;
+  if (m_last_collection_time == 0)
+    return false;
+  // When live scans have seen enough data for their observed garbage ratio
+  // to be representative, trust it instead of the accumulation heuristics
+  if (m_scan_sample_total >= m_accum_data_target_minimum)
+    return ((double)m_scan_sample_garbage / (double)m_scan_sample_total)
+      >= m_garbage_threshold;
+  return check_needed_deletes() || check_needed_ttl(now);
 }
 
 
@@ -132,7 +132,17 @@ namespace Hypertable {
     /// should be called whenever the access group's schema changes.
     /// @param ag_spec Access group specification
     void update_schema(AccessGroupSpec *ag_spec);
-    
+
+    /// Returns the TTL beyond which an entire store is expirable.
+    /// If every live column family in the access group has a TTL option,
+    /// returns the largest of those TTLs; a cell older than that is garbage
+    /// no matter which column it belongs to, so a CellStore whose maximum
+    /// timestamp is older can be dropped whole.  Returns 0 if some live
+    /// family has no TTL, in which case no store can be proven fully
+    /// expired from timestamps alone.
+    /// @return Largest TTL, or 0 if full-store expiry cannot be inferred
+    time_t expirable_ttl_max();
+
     /// Signals if garbage collection is likely needed.
     /// Returns <i>true</i> if check_needed_deletes() or check_needed_ttl()
     /// returns <i>true</i>, <i>false</i> otherwise.  This function
@@ -204,6 +214,29 @@ namespace Hypertable {
     /// @param garbage Measured amount of garbage in access group
     void adjust_targets(time_t now, double total, double garbage);
 
+    /// Feeds a garbage sample observed by a live scan into the tracker.
+    /// Accumulates <code>total</code> into #m_scan_sample_total and
+    /// <code>garbage</code> into #m_scan_sample_garbage.  Samples accumulate
+    /// until the next garbage collection, at which point they are discarded
+    /// by update_cellstore_info().  This function is called by the
+    /// MergeScannerAccessGroup destructor with the garbage it observed
+    /// during a scan (expired, deleted, or superseded cells, and the delete
+    /// records themselves).
+    /// @param total Number of bytes seen by the scan
+    /// @param garbage Number of garbage bytes seen by the scan
+    void add_scan_sample(int64_t total, int64_t garbage);
+
+    /// Gets the garbage estimate accumulated from live scans.
+    /// If the scans performed since the last collection have seen at least
+    /// #m_accum_data_target_minimum bytes, then the accumulated sample is
+    /// considered representative and can take the place of an explicit
+    /// garbage measurement compaction.
+    /// @param totalp Filled in with number of bytes seen by live scans
+    /// @param garbagep Filled in with garbage bytes seen by live scans
+    /// @return <i>true</i> if enough scan data has been observed for the
+    /// estimate to be representative, <i>false</i> otherwise
+    bool get_scan_estimate(double *totalp, double *garbagep);
+
     /// Adjusts targets using statistics from a merge scanner used in a GC
     /// compaction.  This member function first checks mscanner to see if it
     /// was a GC compaction by checking its flags for the absence of the
@@ -327,6 +360,12 @@ namespace Hypertable {
     /// Disk usage at the time the last garbage collection was performed
     int64_t m_last_collection_disk_usage {};
 
+    /// Bytes seen by live scans since the last collection
+    int64_t m_scan_sample_total {};
+
+    /// Garbage bytes seen by live scans since the last collection
+    int64_t m_scan_sample_garbage {};
+
     /// Current disk usage, updated by update_cellstore_info()
     int64_t m_current_disk_usage {};
 
@@ -340,6 +379,12 @@ namespace Hypertable {
     /// Minimum TTL found in access group schema
     time_t m_min_ttl {};
 
+    /// Maximum TTL found in access group schema
+    time_t m_max_ttl {};
+
+    /// <i>true</i> if every live column family has a TTL option
+    bool m_all_families_ttl {};
+
     /// <i>true</i> if any column families have non-zero MAX_VERSIONS
     bool m_have_max_versions {};
 
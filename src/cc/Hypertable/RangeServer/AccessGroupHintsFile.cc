@@ -42,7 +42,7 @@
 
 #include <boost/tokenizer.hpp>
 
-#define HINTS_FILE_VERSION 3
+#define HINTS_FILE_VERSION 4
 
 using namespace Hypertable;
 
@@ -71,7 +71,14 @@ void AccessGroupHintsFile::change_end_row(const String &end_row) {
 namespace {
   const char *ag_hint_format = "  %s: {\n"
     "    LatestStoredRevision: %lld,\n"
-    "    DiskUsage: %llu,\n"
+    "    DiskUsage: %llu,\n";
+  const char *ag_prewarm_hint_format =
+    "    PrewarmBytes: %llu,\n";
+  const char *ag_sweep_hint_format =
+    "    CompactionWatermark: %s,\n"
+    "    CompactionSlices: %s,\n"
+    "    CompactionInputs: %s,\n";
+  const char *ag_files_hint_format =
     "    Files: %s\n  }\n";
 }
 
@@ -90,10 +97,25 @@ void AccessGroupHintsFile::write(String location) {
     format("Version: %d\nStart Row: %s\nEnd Row: %s\nLocation: %s\n"
            "Access Groups: {\n", HINTS_FILE_VERSION, m_start_row.c_str(),
            m_end_row.c_str(), location.c_str());
-  for (const auto &h : m_hints)
+  for (const auto &h : m_hints) {
     contents += format(ag_hint_format, h.ag_name.c_str(),
                        (Llu)h.latest_stored_revision,
-                       (Lld)h.disk_usage, h.files.c_str());
+                       (Lld)h.disk_usage);
+    if (h.prewarm_bytes > 0)
+      contents += format(ag_prewarm_hint_format, (Llu)h.prewarm_bytes);
+    // Sweep state is only written while an incremental major compaction
+    // is in progress
+    if (!h.compaction_inputs.empty()) {
+      LoadDataEscape escaper;
+      String watermark;
+      escaper.escape(h.compaction_watermark.c_str(),
+                     h.compaction_watermark.length(), watermark);
+      contents += format(ag_sweep_hint_format, watermark.c_str(),
+                         h.compaction_slices.c_str(),
+                         h.compaction_inputs.c_str());
+    }
+    contents += format(ag_files_hint_format, h.files.c_str());
+  }
   contents += "}\n";
 
  try_again:
@@ -190,6 +212,23 @@ void AccessGroupHintsFile::read() {
             if (value.empty() || *end != 0)
               HT_THROW(Error::BAD_FORMAT, "");
           }
+          else if (key == "PrewarmBytes") {
+            h.prewarm_bytes = strtoull(value.c_str(), &end, 0);
+            if (value.empty() || *end != 0)
+              HT_THROW(Error::BAD_FORMAT, "");
+          }
+          else if (key == "CompactionWatermark") {
+            LoadDataEscape escaper;
+            const char *unescaped;
+            size_t unescaped_len;
+            escaper.unescape(value.c_str(), value.length(), &unescaped,
+                             &unescaped_len);
+            h.compaction_watermark = String(unescaped, unescaped_len);
+          }
+          else if (key == "CompactionSlices")
+            h.compaction_slices = value;
+          else if (key == "CompactionInputs")
+            h.compaction_inputs = value;
           else if (key == "Files")
             h.files = value;
           else {
@@ -265,7 +304,7 @@ void AccessGroupHintsFile::parse_header(const char *input, const char **ag_base)
   }
 
   int version = atoi(value);
-  if (version > 3)
+  if (version > 4)
     HT_THROWF(Error::BAD_FORMAT,
               "Unrecognized hints file version (%d)", version);
 
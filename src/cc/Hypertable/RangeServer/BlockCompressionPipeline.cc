@@ -0,0 +1,158 @@
+/*
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/// @file
+/// Definitions for BlockCompressionPipeline.
+/// This file contains definitions for BlockCompressionPipeline, a worker
+/// pool that compresses cell store blocks in the background during writes.
+
+#include <Common/Compat.h>
+
+#include "BlockCompressionPipeline.h"
+
+#include <Hypertable/Lib/BlockHeaderCellStore.h>
+#include <Hypertable/Lib/CompressorFactory.h>
+
+#include <Common/Error.h>
+#include <Common/Filesystem.h>
+#include <Common/Logger.h>
+
+#include <cstring>
+
+using namespace Hypertable;
+using namespace std;
+
+namespace {
+
+  void swap_buffers(DynamicBuffer &a, DynamicBuffer &b) {
+    std::swap(a.base, b.base);
+    std::swap(a.ptr, b.ptr);
+    std::swap(a.mark, b.mark);
+    std::swap(a.size, b.size);
+    std::swap(a.own, b.own);
+  }
+
+}
+
+BlockCompressionPipeline::BlockCompressionPipeline(
+    BlockCompressionCodec::Type type, const BlockCompressionCodec::Args &args,
+    uint16_t header_version, const char *magic, size_t worker_count)
+  : m_codec_type(type), m_codec_args(args), m_header_version(header_version),
+    m_magic(magic), m_capacity(worker_count * 2) {
+  HT_ASSERT(worker_count > 0);
+  for (size_t i = 0; i < worker_count; i++)
+    m_threads.push_back(thread(&BlockCompressionPipeline::worker_loop, this));
+}
+
+BlockCompressionPipeline::~BlockCompressionPipeline() {
+  {
+    lock_guard<mutex> lock(m_mutex);
+    m_shutdown = true;
+  }
+  m_submit_cond.notify_all();
+  for (auto &t : m_threads)
+    t.join();
+}
+
+bool BlockCompressionPipeline::submit(DynamicBuffer &buffer,
+                                      DynamicBuffer &key,
+                                      CompressedBlock &completed) {
+  BlockPtr block = make_shared<Block>();
+  swap_buffers(block->input, buffer);
+  swap_buffers(block->data.key, key);
+  block->data.uncompressed_len = block->input.fill();
+
+  unique_lock<mutex> lock(m_mutex);
+
+  m_blocks.push_back(block);
+  m_submit_cond.notify_one();
+
+  if (m_blocks.size() <= m_capacity)
+    return false;
+
+  m_finished_cond.wait(lock, [this](){ return m_blocks.front()->finished; });
+  swap_buffers(completed.key, m_blocks.front()->data.key);
+  swap_buffers(completed.zbuf, m_blocks.front()->data.zbuf);
+  completed.uncompressed_len = m_blocks.front()->data.uncompressed_len;
+  completed.compressed_len = m_blocks.front()->data.compressed_len;
+  m_blocks.pop_front();
+  return true;
+}
+
+bool BlockCompressionPipeline::retrieve(CompressedBlock &completed) {
+  unique_lock<mutex> lock(m_mutex);
+
+  if (m_blocks.empty())
+    return false;
+
+  m_finished_cond.wait(lock, [this](){ return m_blocks.front()->finished; });
+  swap_buffers(completed.key, m_blocks.front()->data.key);
+  swap_buffers(completed.zbuf, m_blocks.front()->data.zbuf);
+  completed.uncompressed_len = m_blocks.front()->data.uncompressed_len;
+  completed.compressed_len = m_blocks.front()->data.compressed_len;
+  m_blocks.pop_front();
+  return true;
+}
+
+void BlockCompressionPipeline::worker_loop() {
+  unique_ptr<BlockCompressionCodec>
+    codec(CompressorFactory::create_block_codec(m_codec_type, m_codec_args));
+
+  unique_lock<mutex> lock(m_mutex);
+
+  while (true) {
+    BlockPtr block;
+
+    for (auto &candidate : m_blocks) {
+      if (!candidate->taken) {
+        block = candidate;
+        block->taken = true;
+        break;
+      }
+    }
+
+    if (!block) {
+      if (m_shutdown)
+        return;
+      m_submit_cond.wait(lock);
+      continue;
+    }
+
+    lock.unlock();
+
+    BlockHeaderCellStore header(m_header_version, m_magic);
+    codec->deflate(block->input, block->data.zbuf, header,
+                   HT_DIRECT_IO_ALIGNMENT);
+    block->data.compressed_len = block->data.zbuf.fill();
+    block->input.free();
+
+    // Pad to the direct I/O alignment
+    if (!HT_IO_ALIGNED(block->data.zbuf.fill())) {
+      memset(block->data.zbuf.ptr, 0,
+             HT_IO_ALIGNMENT_PADDING(block->data.zbuf.fill()));
+      block->data.zbuf.ptr += HT_IO_ALIGNMENT_PADDING(block->data.zbuf.fill());
+    }
+
+    lock.lock();
+    block->finished = true;
+    m_finished_cond.notify_all();
+  }
+}
@@ -0,0 +1,169 @@
+/* -*- c++ -*-
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/// @file
+/// Declarations for BlockCompressionPipeline.
+/// This file contains declarations for BlockCompressionPipeline, a worker
+/// pool that compresses cell store blocks in the background during writes.
+
+#ifndef Hypertable_RangeServer_BlockCompressionPipeline_h
+#define Hypertable_RangeServer_BlockCompressionPipeline_h
+
+#include <Hypertable/Lib/BlockCompressionCodec.h>
+
+#include <Common/DynamicBuffer.h>
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Hypertable {
+
+  /// @addtogroup RangeServer
+  /// @{
+
+  /// Background compression stage for cell store writes.
+  /// A compaction traditionally runs merge, block compression, and file
+  /// writes serially on one thread, leaving compression as the dominant CPU
+  /// stage.  This class maintains a pool of worker threads, each with its
+  /// own compression codec, that compress submitted blocks concurrently
+  /// while the caller keeps merging.  Completed blocks are handed back to
+  /// the caller <i>in submission order</i> so that index entries and file
+  /// offsets can be recorded exactly as in the synchronous path; all
+  /// bookkeeping therefore stays on the calling thread and no other state
+  /// needs locking.  The number of blocks in flight is bounded, so a slow
+  /// consumer applies backpressure to the merge stage rather than
+  /// accumulating buffers.
+  class BlockCompressionPipeline {
+  public:
+
+    /// Compressed block handed back to the caller.
+    class CompressedBlock {
+    public:
+      /// Uncompressed last key of the block (index entry key)
+      DynamicBuffer key;
+      /// Compressed block, padded to the direct I/O alignment
+      DynamicBuffer zbuf;
+      /// Uncompressed size of the block
+      size_t uncompressed_len {};
+      /// Compressed size of the block, excluding alignment padding
+      size_t compressed_len {};
+    };
+
+    /** Constructor.  Starts <code>worker_count</code> compression threads.
+     * @param type Block compression codec type
+     * @param args Block compression codec arguments
+     * @param header_version Block header version written by the codec
+     * @param magic Block header magic string
+     * @param worker_count Number of compression worker threads
+     */
+    BlockCompressionPipeline(BlockCompressionCodec::Type type,
+                             const BlockCompressionCodec::Args &args,
+                             uint16_t header_version, const char *magic,
+                             size_t worker_count);
+
+    /// Destructor.  Shuts down the worker threads, discarding any blocks
+    /// still in the pipeline.
+    ~BlockCompressionPipeline();
+
+    /** Submits a block for compression.  The contents of
+     * <code>buffer</code> and <code>key</code> are taken over (swapped
+     * out), leaving both arguments empty.  If the pipeline is full, blocks
+     * until the oldest submitted block has been compressed and returns it
+     * in <code>completed</code>.
+     * @param buffer Uncompressed block data
+     * @param key Uncompressed last key of the block
+     * @param completed Filled in with the oldest completed block when the
+     * pipeline was full
+     * @return <i>true</i> if <code>completed</code> was filled in
+     */
+    bool submit(DynamicBuffer &buffer, DynamicBuffer &key,
+                CompressedBlock &completed);
+
+    /** Retrieves the oldest block in the pipeline, blocking until its
+     * compression has finished.
+     * @param completed Filled in with the oldest completed block
+     * @return <i>true</i> if <code>completed</code> was filled in,
+     * <i>false</i> if the pipeline is empty
+     */
+    bool retrieve(CompressedBlock &completed);
+
+  private:
+
+    /// Block state tracked while in the pipeline
+    class Block {
+    public:
+      CompressedBlock data;
+      /// Uncompressed input, swapped in by submit()
+      DynamicBuffer input;
+      /// <i>true</i> once a worker has picked up the block
+      bool taken {};
+      /// <i>true</i> once a worker has finished compressing the block
+      bool finished {};
+    };
+
+    typedef std::shared_ptr<Block> BlockPtr;
+
+    /// Worker thread function
+    void worker_loop();
+
+    /// %Mutex for serializing access to the pipeline state
+    std::mutex m_mutex;
+
+    /// Condition variable signalling newly submitted blocks and shutdown
+    std::condition_variable m_submit_cond;
+
+    /// Condition variable signalling compressed blocks
+    std::condition_variable m_finished_cond;
+
+    /// Blocks in the pipeline, in submission order
+    std::deque<BlockPtr> m_blocks;
+
+    /// Worker threads
+    std::vector<std::thread> m_threads;
+
+    /// Block compression codec type
+    BlockCompressionCodec::Type m_codec_type;
+
+    /// Block compression codec arguments
+    BlockCompressionCodec::Args m_codec_args;
+
+    /// Block header version
+    uint16_t m_header_version;
+
+    /// Block header magic string
+    const char *m_magic;
+
+    /// Maximum number of blocks in the pipeline
+    size_t m_capacity;
+
+    /// Set to <i>true</i> to shut down the worker threads
+    bool m_shutdown {};
+  };
+
+  /// @}
+
+}
+
+#endif // Hypertable_RangeServer_BlockCompressionPipeline_h
@@ -29,6 +29,7 @@
 #include <Hypertable/Lib/Key.h>
 
 #include <Common/Logger.h>
+#include <Common/MurmurHash.h>
 #include <Common/Serialization.h>
 
 #include <algorithm>
@@ -39,35 +40,96 @@ using namespace Hypertable;
 using namespace std;
 
 CellCache::CellCache()
-  : m_cell_map(std::less<const SerializedKey>(), Alloc(m_arena)) {
+  : m_cell_map(m_arena, m_alloc_mutex) {
   assert(Config::properties); // requires Config::init* first
   m_arena.set_page_size((size_t)
       Config::get_i32("Hypertable.RangeServer.AccessGroup.CellCache.PageSize"));
+  if (Config::get_bool("Hypertable.RangeServer.AccessGroup.CellCache.SlabReuse"))
+    m_arena.set_reuse_freed();
+  m_zero_copy_threshold = (size_t)Config::get_i32(
+      "Hypertable.RangeServer.AccessGroup.CellCache.ZeroCopyThreshold");
+  m_inline_threshold = (size_t)Config::get_i32(
+      "Hypertable.RangeServer.AccessGroup.CellCache.InlineThreshold");
 }
 
 
 /**
  */
 void CellCache::add(const Key &key, const ByteString value) {
+  add(key, value, StaticBufferPtr());
+}
+
+
+/**
+ */
+void CellCache::add(const Key &key, const ByteString value,
+                    const StaticBufferPtr &buffer) {
   SerializedKey new_key;
-  uint8_t *ptr;
   size_t total_len = key.length + value.length();
 
   m_key_bytes += key.length;
   m_value_bytes += value.length();
 
-  new_key.ptr = ptr = m_arena.alloc(total_len);
+  update_timestamp_bounds(key.timestamp);
+
+  // Publish the row filter bits before the entry becomes visible so a
+  // scanner that can see the entry never skips the cache
+  filter_add(key.row, key.row_len);
+
+  if (buffer && m_zero_copy_threshold && total_len >= m_zero_copy_threshold
+      && value.ptr == key.serial.ptr + key.length) {
+    // Reference the cell in place and pin the buffer holding it
+    new_key.ptr = key.serial.ptr;
+    lock_guard<mutex> lock(m_alloc_mutex);
+    if (m_pinned_buffers.empty() || m_pinned_buffers.back() != buffer) {
+      m_pinned_buffers.push_back(buffer);
+      m_pinned_bytes += buffer->size;
+    }
+  }
+  else {
+    if (m_inline_threshold && total_len <= m_inline_threshold) {
+      // Store small cells inline in their skip list node, saving the
+      // separate arena allocation and the node-to-cell dereference.  A
+      // null ByteString serializes as a zero length prefix
+      static const uint8_t zero_length_value = 0;
+      const uint8_t *value_ptr = value.ptr ? value.ptr : &zero_length_value;
+      std::pair<CellMap::iterator, bool> r
+        = m_cell_map.insert_inline(key.serial.ptr, key.length, value_ptr,
+                                   value.length());
+      if (r.second) {
+        {
+          lock_guard<mutex> lock(m_alloc_mutex);
+          m_arena_usage.update(m_arena.total());
+        }
+        if (key.flag <= FLAG_DELETE_CELL_VERSION)
+          m_deletes++;
+        return;
+      }
+      // Existing entry with an equal key; fall through to the copy path,
+      // which repoints it at a fresh copy of the cell
+    }
+
+    uint8_t *ptr;
+
+    {
+      lock_guard<mutex> lock(m_alloc_mutex);
+      new_key.ptr = ptr = m_arena.alloc(total_len);
+      m_arena_usage.update(m_arena.total());
+    }
 
-  memcpy(ptr, key.serial.ptr, key.length);
-  ptr += key.length;
+    memcpy(ptr, key.serial.ptr, key.length);
+    ptr += key.length;
 
-  value.write(ptr);
+    value.write(ptr);
+  }
 
   CellMap::value_type v(new_key, key.length);
   std::pair<CellMap::iterator, bool> r = m_cell_map.insert(v);
   if (!r.second) {
-    m_cell_map.erase(r.first);
-    m_cell_map.insert(v);
+    // Identical serialized keys carry identical bytes, so repointing the
+    // existing entry at the fresh copy is safe under concurrent readers
+    r.first->first = new_key;
+    r.first->second = key.length;
     m_collisions++;
     HT_WARNF("Collision detected key insert (row = %s)", new_key.row());
   }
@@ -81,6 +143,7 @@ void CellCache::add(const Key &key, const ByteString value) {
 /**
  */
 void CellCache::add_counter(const Key &key, const ByteString value) {
+  lock_guard<mutex> lock(m_mutex);
 
   // Check for counter reset
   if (*value.ptr == 9) {
@@ -151,6 +214,8 @@ void CellCache::add_counter(const Key &key, const ByteString value) {
   // Copy timestamp/revision info from insert key to the one in the map
   memcpy(((uint8_t *)(*iter).first.ptr) + offset, key.flag_ptr+1, len);
 
+  update_timestamp_bounds(key.timestamp);
+
   // read old value
   ptr = old_value.ptr+1;
   size_t remaining = 8;
@@ -171,8 +236,16 @@ void CellCache::split_row_estimate_data(SplitRowDataMapT &split_row_data) {
   lock_guard<mutex> lock(m_mutex);
   const char *row, *last_row = 0;
   int64_t last_count = 0;
+  // Sample the cell map at a stride chosen to yield a bounded number of
+  // samples, attributing the weight of the whole stride to the sampled
+  // row, so that accumulation cost does not grow with the cache size
+  size_t stride = (m_cell_map.size() / 1000) + 1;
+  size_t countdown = 1;
   for (CellMap::iterator iter = m_cell_map.begin();
        iter != m_cell_map.end(); ++iter) {
+    if (--countdown > 0)
+      continue;
+    countdown = stride;
     row = iter->first.row();
     if (last_row == 0)
       last_row = row;
@@ -185,7 +258,7 @@ void CellCache::split_row_estimate_data(SplitRowDataMapT &split_row_data) {
       last_row = row;
       last_count = 0;
     }
-    last_count++;
+    last_count += stride;
   }
   if (last_count > 0) {
     CstrToInt64MapT::iterator iter = split_row_data.find(last_row);
@@ -201,3 +274,36 @@ void CellCache::split_row_estimate_data(SplitRowDataMapT &split_row_data) {
 CellListScannerPtr CellCache::create_scanner(ScanContext *scan_ctx) {
   return make_shared<CellCacheScanner>(shared_from_this(), scan_ctx);
 }
+
+
+bool CellCache::may_contain(ScanContext *scan_ctx) {
+  if (!scan_ctx->single_row)
+    return true;
+  return filter_may_contain(scan_ctx->start_row.data(),
+                            scan_ctx->start_row.size());
+}
+
+
+void CellCache::filter_add(const char *row, size_t len) {
+  uint32_t h1 = murmurhash2(row, len, 0x9747b28c);
+  uint32_t h2 = murmurhash2(row, len, 0x5bd1e995);
+  uint32_t bit = h1 & (ROW_FILTER_BITS - 1);
+  m_row_filter[bit >> 6].fetch_or(1ULL << (bit & 63),
+                                  std::memory_order_relaxed);
+  bit = (h1 + h2) & (ROW_FILTER_BITS - 1);
+  m_row_filter[bit >> 6].fetch_or(1ULL << (bit & 63),
+                                  std::memory_order_relaxed);
+}
+
+
+bool CellCache::filter_may_contain(const char *row, size_t len) {
+  uint32_t h1 = murmurhash2(row, len, 0x9747b28c);
+  uint32_t h2 = murmurhash2(row, len, 0x5bd1e995);
+  uint32_t bit = h1 & (ROW_FILTER_BITS - 1);
+  if ((m_row_filter[bit >> 6].load(std::memory_order_relaxed)
+       & (1ULL << (bit & 63))) == 0)
+    return false;
+  bit = (h1 + h2) & (ROW_FILTER_BITS - 1);
+  return (m_row_filter[bit >> 6].load(std::memory_order_relaxed)
+          & (1ULL << (bit & 63))) != 0;
+}
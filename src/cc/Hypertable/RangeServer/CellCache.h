@@ -23,15 +23,20 @@
 #define Hypertable_RangeServer_CellCache_h
 
 #include <Hypertable/RangeServer/CellCacheAllocator.h>
+#include <Hypertable/RangeServer/CellCacheSkipList.h>
 #include <Hypertable/RangeServer/CellListScanner.h>
 #include <Hypertable/RangeServer/CellList.h>
 
 #include <Hypertable/Lib/SerializedKey.h>
 
-#include <map>
+#include <Common/AllocationTracker.h>
+#include <Common/StaticBuffer.h>
+
+#include <atomic>
 #include <memory>
 #include <mutex>
 #include <set>
+#include <vector>
 
 namespace Hypertable {
 
@@ -67,15 +72,43 @@ namespace Hypertable {
     CellCache(CellCacheArena &arena);
     virtual ~CellCache() { m_cell_map.clear(); }
     /**
-     * Adds a key/value pair to the CellCache.  This method assumes that
-     * the CellCache has been locked by a call to #lock.  Copies of
-     * the key and value are created and inserted into the underlying cell map
+     * Adds a key/value pair to the CellCache.  Copies of the key and value
+     * are created and inserted into the underlying cell map.  This method
+     * is safe to call from concurrent threads; the cell map is a
+     * concurrent skip list and the arena allocation is internally
+     * serialized, so callers no longer need to hold the cache lock.
      *
      * @param key key to be inserted
      * @param value value to inserted
      */
     void add(const Key &key, const ByteString value) override;
 
+    /**
+     * Adds a key/value pair to the CellCache, referencing the cell in
+     * place inside <code>buffer</code> when it is at least
+     * <code>Hypertable.RangeServer.AccessGroup.CellCache.ZeroCopyThreshold</code>
+     * bytes long.  In that case only a map entry pointing at the cell's
+     * bytes is created and <code>buffer</code> is pinned until the cache
+     * is dropped, so large-value ingest avoids the copy into the arena.
+     * Cells below the threshold, or whose value does not immediately
+     * follow the key in memory, are copied as with #add.
+     *
+     * @param key key to be inserted
+     * @param value value to inserted
+     * @param buffer Buffer holding the serialized cell, or 0 to force a copy
+     */
+    void add(const Key &key, const ByteString value,
+             const StaticBufferPtr &buffer);
+
+    /**
+     * Adds a key/value pair for a counter column to the CellCache.
+     * Unlike #add, counter accumulation does a read-modify-write of the
+     * existing entry's value, so this method serializes itself on the
+     * cache lock against scanners and other counter updates.
+     *
+     * @param key key to be inserted
+     * @param value value to inserted
+     */
     virtual void add_counter(const Key &key, const ByteString value);
 
     void split_row_estimate_data(SplitRowDataMapT &split_row_data) override;
@@ -85,46 +118,67 @@ namespace Hypertable {
      */
     CellListScannerPtr create_scanner(ScanContext *scan_ctx) override;
 
+    /** Checks whether the cache may contain cells for the scan's row.
+     * For single-row scans, consults a small bloom filter over the rows
+     * inserted into this cache so that point reads which miss the cache
+     * skip the cell map walk entirely.  Multi-row scans always return
+     * <i>true</i>.  False positives merely cost the map seek this filter
+     * exists to avoid; false negatives cannot occur.
+     * @param scan_ctx Scan context
+     * @return <i>true</i> if the cache may contain the scan's row
+     */
+    bool may_contain(ScanContext *scan_ctx);
+
     void lock()   { m_mutex.lock(); }
     void unlock() { m_mutex.unlock(); }
 
-    size_t size() { std::lock_guard<std::mutex> lock(m_mutex); return m_cell_map.size(); }
+    size_t size() { return m_cell_map.size(); }
 
-    bool empty() { std::lock_guard<std::mutex> lock(m_mutex); return m_cell_map.empty(); }
+    bool empty() { return m_cell_map.empty(); }
 
     /** Returns the amount of memory used by the CellCache.  This is the
      * summation of the lengths of all the keys and values in the map.
      */
     int64_t memory_used() {
-      std::lock_guard<std::mutex> lock(m_mutex);
-      return m_arena.used();
+      std::lock_guard<std::mutex> lock(m_alloc_mutex);
+      return m_arena.used() + m_pinned_bytes;
     }
 
     /**
      * Returns the amount of memory allocated by the CellCache.
      */
     uint64_t memory_allocated() {
-      std::lock_guard<std::mutex> lock(m_mutex);
-      return m_arena.total();
+      std::lock_guard<std::mutex> lock(m_alloc_mutex);
+      return m_arena.total() + m_pinned_bytes;
     }
 
     int64_t logical_size() {
-      std::lock_guard<std::mutex> lock(m_mutex);
       return m_key_bytes + m_value_bytes;
     }
 
+    /// Returns the smallest cell timestamp added to the cache, or
+    /// INT64_MAX if the cache is empty.
+    int64_t timestamp_min() {
+      return m_ts_min.load(std::memory_order_relaxed);
+    }
+
+    /// Returns the largest cell timestamp added to the cache, or
+    /// INT64_MIN if the cache is empty.
+    int64_t timestamp_max() {
+      return m_ts_max.load(std::memory_order_relaxed);
+    }
+
     void add_statistics(Statistics &stats) {
-      std::lock_guard<std::mutex> lock(m_mutex);
+      std::lock_guard<std::mutex> lock(m_alloc_mutex);
       stats.size += m_cell_map.size();
       stats.deletes += m_deletes;
-      stats.memory_used += m_arena.used();
-      stats.memory_allocated += m_arena.total();
+      stats.memory_used += m_arena.used() + m_pinned_bytes;
+      stats.memory_allocated += m_arena.total() + m_pinned_bytes;
       stats.key_bytes += m_key_bytes;
       stats.value_bytes += m_value_bytes;
     }
 
     int32_t delete_count() {
-      std::lock_guard<std::mutex> lock(m_mutex);
       return m_deletes;
     }
 
@@ -139,24 +193,74 @@ namespace Hypertable {
 
     CellCacheArena &arena() { return m_arena; }
 
+    friend class CellCacheCheckpoint;
     friend class CellCacheScanner;
 
-    typedef std::pair<const SerializedKey, uint32_t> Value;
-    typedef CellCacheAllocator<Value> Alloc;
-    typedef std::map<const SerializedKey, uint32_t,
-                     std::less<const SerializedKey>, Alloc> CellMap;
+    typedef CellCacheSkipList CellMap;
+    typedef CellMap::value_type Value;
 
   protected:
 
+    /// Number of bits in the row bloom filter (power of two)
+    static const uint32_t ROW_FILTER_BITS = 65536;
+
+    /// Sets the row filter bits for <code>row</code>
+    void filter_add(const char *row, size_t len);
+
+    /// Folds <code>timestamp</code> into the cache's cell timestamp
+    /// bounds (see timestamp_min() / timestamp_max())
+    void update_timestamp_bounds(int64_t timestamp) {
+      int64_t observed = m_ts_min.load(std::memory_order_relaxed);
+      while (timestamp < observed &&
+             !m_ts_min.compare_exchange_weak(observed, timestamp,
+                                             std::memory_order_relaxed))
+        ;
+      observed = m_ts_max.load(std::memory_order_relaxed);
+      while (timestamp > observed &&
+             !m_ts_max.compare_exchange_weak(observed, timestamp,
+                                             std::memory_order_relaxed))
+        ;
+    }
+
+    /// Tests the row filter bits for <code>row</code>
+    bool filter_may_contain(const char *row, size_t len);
+
     std::mutex m_mutex;
+    std::mutex m_alloc_mutex;
     CellCacheArena m_arena;
+
+    /// Charges arena growth to the CellCache allocation subsystem
+    /// (guarded by #m_alloc_mutex)
+    TrackedArenaUsage m_arena_usage {AllocationTracker::CELL_CACHE};
     CellMap m_cell_map;
-    int32_t m_deletes {};
-    int32_t m_collisions {};
-    int64_t m_key_bytes {};
-    int64_t m_value_bytes {};
+    std::atomic<int32_t> m_deletes {0};
+    std::atomic<int32_t> m_collisions {0};
+    std::atomic<int64_t> m_key_bytes {0};
+    std::atomic<int64_t> m_value_bytes {0};
     bool m_have_counter_deletes {};
 
+    /// Cell timestamp bounds, used to classify the cache against scan
+    /// time windows
+    std::atomic<int64_t> m_ts_min {INT64_MAX};
+    std::atomic<int64_t> m_ts_max {INT64_MIN};
+
+    /// Bloom filter over inserted rows (two probes per row)
+    std::atomic<uint64_t> m_row_filter[ROW_FILTER_BITS/64] {};
+
+    /// Update buffers pinned by zero-copy entries (guarded by
+    /// #m_alloc_mutex); released when the cache is dropped
+    std::vector<StaticBufferPtr> m_pinned_buffers;
+
+    /// Bytes held by pinned update buffers
+    std::atomic<int64_t> m_pinned_bytes {0};
+
+    /// Minimum cell size for insertion by reference (0 disables)
+    size_t m_zero_copy_threshold {};
+
+    /// Maximum cell size for inline storage in the skip list node
+    /// (0 disables)
+    size_t m_inline_threshold {};
+
   };
 
   /// Shared smart pointer to CellCache
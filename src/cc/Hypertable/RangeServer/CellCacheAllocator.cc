@@ -21,13 +21,76 @@
 // Global.h cannot be used in headers as it'll cause circular inclusion
 #include "Global.h"
 
+#include "Config.h"
+
+#include <sys/mman.h>
+
 namespace Hypertable {
 
+namespace {
+
+  /*
+   * Cell cache pages are written by the update thread that fills them, so
+   * freshly mapped pages are placed on that thread's NUMA node by the
+   * kernel's first-touch policy.  malloc() gives no such guarantee since
+   * it recycles pages that may have been faulted on any node.  Each
+   * mapping is prefixed with its length so it can be unmapped on free.
+   */
+  const size_t MMAP_HEADER_SIZE = 16;
+
+  bool numa_local_pages() {
+    static bool enabled = Config::get_bool(
+        "Hypertable.RangeServer.AccessGroup.CellCache.NumaLocalPages");
+    return enabled;
+  }
+
+  bool huge_pages() {
+    static bool enabled = Config::get_bool(
+        "Hypertable.RangeServer.Memory.HugePages");
+    return enabled;
+  }
+
+}
+
 void *CellCachePageAllocator::allocate(size_t sz) {
   Global::memory_tracker->add(sz);
+  if (numa_local_pages() || huge_pages()) {
+    size_t length = sz + MMAP_HEADER_SIZE;
+    void *base = mmap(0, length, PROT_READ|PROT_WRITE,
+                      MAP_PRIVATE|MAP_ANONYMOUS, -1, 0);
+    if (base == MAP_FAILED) {
+      // address space exhausted; a zero header marks the page malloc'd
+      base = std::malloc(length);
+      *(size_t *)base = 0;
+    }
+    else {
+#ifdef MADV_HUGEPAGE
+      // Advisory only; silently degrades to normal pages when transparent
+      // huge pages are unavailable or disabled on the host
+      if (huge_pages())
+        madvise(base, length, MADV_HUGEPAGE);
+#endif
+      *(size_t *)base = length;
+    }
+    return (uint8_t *)base + MMAP_HEADER_SIZE;
+  }
   return std::malloc(sz);
 }
 
+void CellCachePageAllocator::deallocate(void *p) {
+  if (!p)
+    return;
+  if (numa_local_pages() || huge_pages()) {
+    void *base = (uint8_t *)p - MMAP_HEADER_SIZE;
+    if (*(size_t *)base)
+      munmap(base, *(size_t *)base);
+    else
+      std::free(base);
+    return;
+  }
+  std::free(p);
+}
+
 void CellCachePageAllocator::freed(size_t sz) {
   Global::memory_tracker->subtract(sz);
 }
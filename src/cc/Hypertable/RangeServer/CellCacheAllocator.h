@@ -24,8 +24,21 @@
 
 namespace Hypertable {
 
+/** Page allocator for the cell cache.  When the
+ * <code>Hypertable.RangeServer.AccessGroup.CellCache.NumaLocalPages</code>
+ * property is <i>true</i> (the default), pages are obtained with mmap()
+ * rather than malloc() so that every cache page is freshly faulted by the
+ * update thread that first writes it, placing it on that thread's NUMA
+ * node under the kernel's first-touch policy.  When
+ * <code>Hypertable.RangeServer.Memory.HugePages</code> is <i>true</i> the
+ * mapped pages are additionally flagged with madvise(MADV_HUGEPAGE) so the
+ * kernel can back them with transparent huge pages, shrinking the TLB
+ * footprint of large caches; the hint is ignored on hosts without THP
+ * support.
+ */
 struct CellCachePageAllocator : DefaultPageAllocator {
   void *allocate(size_t sz);
+  void deallocate(void *p);
   void freed(size_t sz);
 };
 
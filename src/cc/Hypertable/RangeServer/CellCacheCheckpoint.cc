@@ -0,0 +1,287 @@
+/*
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 3 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/// @file
+/// Definitions for CellCacheCheckpoint.
+/// This file contains method definitions for CellCacheCheckpoint, a class for
+/// serializing an access group's cell caches to a local file on clean
+/// shutdown and restoring them at startup.
+
+#include <Common/Compat.h>
+
+#include "CellCacheCheckpoint.h"
+
+#include <Hypertable/Lib/Key.h>
+
+#include <Common/Checksum.h>
+#include <Common/Error.h>
+#include <Common/FileUtils.h>
+#include <Common/Logger.h>
+#include <Common/Serialization.h>
+#include <Common/md5.h>
+
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <memory>
+
+extern "C" {
+#include <fcntl.h>
+#include <unistd.h>
+}
+
+using namespace Hypertable;
+using namespace std;
+
+CellCacheCheckpoint::CellCacheCheckpoint(const String &directory,
+                                         const String &full_name)
+  : m_full_name(full_name) {
+  char hash_str[33];
+  md5_trunc_modified_base64(full_name.c_str(), hash_str);
+  hash_str[16] = 0;
+  m_pathname = directory + "/" + hash_str + ".cckp";
+}
+
+
+bool CellCacheCheckpoint::write(CellCacheManagerPtr &manager) {
+  DynamicBuffer payload;
+  int64_t latest_revision = TIMESTAMP_MIN;
+  int64_t cell_count = 0;
+
+  serialize_cache(manager->active_cache(), payload, &latest_revision,
+                  &cell_count);
+  serialize_cache(manager->immutable_cache(), payload, &latest_revision,
+                  &cell_count);
+
+  // Nothing is cached, so remove any leftover checkpoint to keep a
+  // subsequent restart from restoring stale cells
+  if (cell_count == 0) {
+    if (FileUtils::exists(m_pathname))
+      FileUtils::unlink(m_pathname);
+    return false;
+  }
+
+  DynamicBuffer header(4 + 2 + Serialization::encoded_length_vstr(m_full_name)
+                       + 8 + 8 + 8 + 4);
+  Serialization::encode_i32(&header.ptr, MAGIC);
+  Serialization::encode_i16(&header.ptr, VERSION);
+  Serialization::encode_vstr(&header.ptr, m_full_name);
+  Serialization::encode_i64(&header.ptr, (uint64_t)latest_revision);
+  Serialization::encode_i64(&header.ptr, (uint64_t)cell_count);
+  Serialization::encode_i64(&header.ptr, (uint64_t)payload.fill());
+  Serialization::encode_i32(&header.ptr, fletcher32(payload.base,
+                                                   payload.fill()));
+
+  String tmp_pathname = m_pathname + ".tmp";
+  int fd = ::open(tmp_pathname.c_str(), O_WRONLY|O_CREAT|O_TRUNC, 0644);
+  if (fd < 0)
+    HT_THROWF(Error::EXTERNAL, "Unable to create cell cache checkpoint file "
+              "'%s' - %s", tmp_pathname.c_str(), strerror(errno));
+
+  if (FileUtils::write(fd, header.base, header.fill()) == (ssize_t)-1 ||
+      FileUtils::write(fd, payload.base, payload.fill()) == (ssize_t)-1) {
+    ::close(fd);
+    FileUtils::unlink(tmp_pathname);
+    HT_THROWF(Error::EXTERNAL, "Error writing cell cache checkpoint file "
+              "'%s' - %s", tmp_pathname.c_str(), strerror(errno));
+  }
+  ::close(fd);
+
+  if (!FileUtils::rename(tmp_pathname, m_pathname))
+    HT_THROWF(Error::EXTERNAL, "Unable to rename '%s' to '%s'",
+              tmp_pathname.c_str(), m_pathname.c_str());
+
+  return true;
+}
+
+
+namespace {
+  const char MANIFEST_HEADER[] = "CellCacheCheckpointManifest\t1";
+
+  String manifest_pathname(const String &directory) {
+    return directory + "/manifest";
+  }
+}
+
+
+void CellCacheCheckpoint::write_manifest(const String &directory,
+                                         const vector<String> &pathnames) {
+  String pathname = manifest_pathname(directory);
+  String tmp_pathname = pathname + ".tmp";
+
+  ofstream out(tmp_pathname.c_str(), ios::out | ios::trunc);
+  if (!out.is_open()) {
+    HT_WARNF("Unable to open cell cache checkpoint manifest '%s' for "
+             "writing", tmp_pathname.c_str());
+    return;
+  }
+
+  out << MANIFEST_HEADER << "\n";
+  for (auto &checkpoint_pathname : pathnames)
+    out << checkpoint_pathname << "\n";
+  out.close();
+
+  if (!FileUtils::rename(tmp_pathname, pathname))
+    HT_WARNF("Unable to rename '%s' to '%s'", tmp_pathname.c_str(),
+             pathname.c_str());
+}
+
+
+bool CellCacheCheckpoint::load_manifest(const String &directory,
+                                        StringSet &pathnames) {
+  String pathname = manifest_pathname(directory);
+  String line;
+
+  ifstream in(pathname.c_str());
+  if (!in.is_open())
+    return false;
+
+  bool valid = getline(in, line) && line == MANIFEST_HEADER;
+  if (valid) {
+    while (getline(in, line)) {
+      if (!line.empty())
+        pathnames.insert(line);
+    }
+  }
+  else
+    HT_WARNF("Invalid cell cache checkpoint manifest '%s'",
+             pathname.c_str());
+  in.close();
+
+  // The manifest authorizes exactly one restore pass
+  FileUtils::unlink(pathname);
+
+  if (!valid)
+    pathnames.clear();
+
+  return valid;
+}
+
+
+void CellCacheCheckpoint::serialize_cache(CellCachePtr &cache,
+                                          DynamicBuffer &payload,
+                                          int64_t *latest_revisionp,
+                                          int64_t *cell_countp) {
+  Key key;
+
+  if (!cache)
+    return;
+
+  for (auto iter = cache->m_cell_map.begin();
+       iter != cache->m_cell_map.end(); ++iter) {
+    ByteString value((*iter).first.ptr + (*iter).second);
+    size_t length = (*iter).second + value.length();
+    payload.ensure(length);
+    payload.add_unchecked((*iter).first.ptr, length);
+    key.load((*iter).first);
+    if (key.revision > *latest_revisionp)
+      *latest_revisionp = key.revision;
+    (*cell_countp)++;
+  }
+}
+
+
+bool CellCacheCheckpoint::restore(CellCacheManagerPtr &manager,
+                                  SchemaPtr &schema,
+                                  int64_t *latest_revisionp,
+                                  int64_t *earliest_revisionp,
+                                  int64_t *cell_countp) {
+  off_t file_length {};
+
+  if (!FileUtils::exists(m_pathname))
+    return false;
+
+  unique_ptr<char[]> contents(FileUtils::file_to_buffer(m_pathname,
+                                                        &file_length));
+  if (!contents) {
+    FileUtils::unlink(m_pathname);
+    return false;
+  }
+
+  const uint8_t *ptr = (const uint8_t *)contents.get();
+  size_t remain = file_length;
+  int64_t latest_revision {}, cell_count {}, payload_length {};
+  bool valid {};
+
+  try {
+    if (Serialization::decode_i32(&ptr, &remain) == MAGIC &&
+        Serialization::decode_i16(&ptr, &remain) == VERSION &&
+        m_full_name == Serialization::decode_vstr(&ptr, &remain)) {
+      latest_revision = (int64_t)Serialization::decode_i64(&ptr, &remain);
+      cell_count = (int64_t)Serialization::decode_i64(&ptr, &remain);
+      payload_length = (int64_t)Serialization::decode_i64(&ptr, &remain);
+      uint32_t checksum = Serialization::decode_i32(&ptr, &remain);
+      valid = payload_length == (int64_t)remain &&
+        checksum == fletcher32(ptr, remain);
+    }
+  }
+  catch (Exception &) {
+  }
+
+  // Checkpoints are consume-once; unlink before restoring so the file can
+  // never be applied to a cache that has since diverged from it
+  FileUtils::unlink(m_pathname);
+
+  if (!valid) {
+    HT_WARNF("Cell cache checkpoint file '%s' is invalid or stale, falling "
+             "back to commit log replay", m_pathname.c_str());
+    return false;
+  }
+
+  Key key;
+  ByteString value;
+  int64_t earliest_revision = TIMESTAMP_MAX;
+
+  for (int64_t i=0; i<cell_count; i++) {
+    SerializedKey serial((uint8_t *)ptr);
+    if (remain == 0 || !key.load(serial) || (size_t)key.length > remain)
+      HT_THROWF(Error::SERIALIZATION_INPUT_OVERRUN,
+                "Corrupt cell cache checkpoint file '%s' (cell %lld of %lld)",
+                m_pathname.c_str(), (Lld)i, (Lld)cell_count);
+    ptr += key.length;
+    remain -= key.length;
+    value.ptr = (uint8_t *)ptr;
+    size_t value_length = value.length();
+    if (value_length > remain)
+      HT_THROWF(Error::SERIALIZATION_INPUT_OVERRUN,
+                "Corrupt cell cache checkpoint file '%s' (cell %lld of %lld)",
+                m_pathname.c_str(), (Lld)i, (Lld)cell_count);
+    ptr += value_length;
+    remain -= value_length;
+
+    if (key.revision < earliest_revision)
+      earliest_revision = key.revision;
+
+    // Cells are reproduced verbatim (the accumulated value of a counter
+    // entry must not be folded into a neighbor), so deletes in counter
+    // columns re-arm the cache's counter-delete tracking by hand
+    manager->add(key, value);
+    if (key.flag != FLAG_INSERT &&
+        schema->column_is_counter(key.column_family_code))
+      manager->active_cache()->m_have_counter_deletes = true;
+  }
+
+  *latest_revisionp = latest_revision;
+  *earliest_revisionp = earliest_revision;
+  *cell_countp = cell_count;
+
+  return true;
+}
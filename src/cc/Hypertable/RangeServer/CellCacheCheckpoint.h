@@ -0,0 +1,162 @@
+/* -*- c++ -*-
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 3 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/// @file
+/// Declarations for CellCacheCheckpoint.
+/// This file contains type declarations for CellCacheCheckpoint, a class for
+/// serializing an access group's cell caches to a local file on clean
+/// shutdown and restoring them at startup.
+
+#ifndef Hypertable_RangeServer_CellCacheCheckpoint_h
+#define Hypertable_RangeServer_CellCacheCheckpoint_h
+
+#include <Hypertable/RangeServer/CellCacheManager.h>
+
+#include <Hypertable/Lib/Schema.h>
+
+#include <Common/DynamicBuffer.h>
+#include <Common/String.h>
+#include <Common/StringExt.h>
+
+#include <vector>
+
+namespace Hypertable {
+
+  /// @addtogroup RangeServer
+  /// @{
+
+  /// Serializes an access group's cell caches to a local checkpoint file.
+  /// On a clean shutdown the commit logs are closed before the checkpoint is
+  /// written, so the file holds a complete snapshot of the cells that commit
+  /// log replay would otherwise re-insert at the next startup.  The restore
+  /// path reproduces the cache verbatim and reports the largest cell revision
+  /// restored, allowing AccessGroup::add() to drop the replayed copies.  A
+  /// checkpoint is consumed (unlinked) by the first restore attempt, whether
+  /// or not it validates, so a cache that subsequently diverges from the
+  /// file can never be restored from it; commit log replay remains the
+  /// fallback in all failure scenarios.
+  class CellCacheCheckpoint {
+  public:
+
+    /// Constructor.
+    /// Initializes #m_pathname to <code>directory</code> plus a filename
+    /// derived from the MD5 digest of <code>full_name</code>, mirroring the
+    /// way cell store range directory names are derived from the range's end
+    /// row.
+    /// @param directory Local checkpoint directory
+    /// @param full_name Fully qualified access group name
+    CellCacheCheckpoint(const String &directory, const String &full_name);
+
+    /// Writes caches managed by <code>manager</code> to the checkpoint file.
+    /// Serializes the active and immutable caches into a payload buffer,
+    /// prepends a header recording the access group name, the largest cell
+    /// revision contained, the cell count, and a payload checksum, and then
+    /// writes the result to a temporary file which is renamed to
+    /// #m_pathname.  If both caches are empty, any leftover checkpoint file
+    /// is removed instead.
+    /// @param manager %Cell cache manager holding the caches to serialize
+    /// @return <i>true</i> if a checkpoint file was written, <i>false</i> if
+    /// the caches were empty and no file was produced
+    /// @throws Exception with code Error::EXTERNAL on filesystem errors
+    bool write(CellCacheManagerPtr &manager);
+
+    /// Restores cells from the checkpoint file into the active cache.
+    /// If #m_pathname exists, its header is validated against
+    /// #m_full_name and the payload checksum; on any mismatch the file is
+    /// removed and <i>false</i> is returned.  Otherwise the file is unlinked
+    /// and each serialized cell is added back to the active cache managed by
+    /// <code>manager</code>.  Counter delete cells re-arm the cache's
+    /// counter-delete tracking so post-restart increments accumulate exactly
+    /// as they would have into the original cache.
+    /// @param manager %Cell cache manager into which cells are restored
+    /// @param schema %Schema used to identify counter columns
+    /// @param latest_revisionp Address of variable filled in with largest
+    /// restored cell revision
+    /// @param earliest_revisionp Address of variable filled in with smallest
+    /// restored cell revision
+    /// @param cell_countp Address of variable filled in with number of cells
+    /// restored
+    /// @return <i>true</i> if cells were restored from a valid checkpoint,
+    /// <i>false</i> if no checkpoint exists or it failed validation
+    /// @throws Exception with code Error::SERIALIZATION_INPUT_OVERRUN if the
+    /// payload is internally inconsistent
+    bool restore(CellCacheManagerPtr &manager, SchemaPtr &schema,
+                 int64_t *latest_revisionp, int64_t *earliest_revisionp,
+                 int64_t *cell_countp);
+
+    /// Returns the checkpoint file pathname.
+    /// @return Checkpoint file pathname
+    const String &pathname() { return m_pathname; }
+
+    /// Writes the handoff manifest.
+    /// The manifest lists the pathnames of the checkpoint files written by a
+    /// complete clean shutdown.  A successor process only restores
+    /// checkpoints listed in the manifest, which fences off stale files left
+    /// behind by earlier incarnations, and may skip commit log replay
+    /// entirely once every listed checkpoint has been restored.  The
+    /// manifest is written to a temporary file and renamed into place after
+    /// all the checkpoint files it lists exist.
+    /// @param directory Local checkpoint directory
+    /// @param pathnames Pathnames of the checkpoint files written
+    void static write_manifest(const String &directory,
+                               const std::vector<String> &pathnames);
+
+    /// Loads and consumes the handoff manifest.
+    /// If a manifest exists in <code>directory</code>, its listed pathnames
+    /// are inserted into <code>pathnames</code> and the file is unlinked so
+    /// that it can only ever authorize one restore pass.
+    /// @param directory Local checkpoint directory
+    /// @param pathnames Set filled in with the listed checkpoint pathnames
+    /// @return <i>true</i> if a valid manifest was loaded, <i>false</i>
+    /// otherwise
+    static bool load_manifest(const String &directory, StringSet &pathnames);
+
+  private:
+
+    /// Appends the cells of <code>cache</code> to <code>payload</code>.
+    /// Each cell is appended as its serialized key followed by its value,
+    /// the same layout the cells occupy in the cache arena.
+    /// @param cache %Cell cache to serialize (nullptr is a no-op)
+    /// @param payload Buffer to which cells are appended
+    /// @param latest_revisionp Address of variable folded with largest cell
+    /// revision seen
+    /// @param cell_countp Address of variable incremented per cell
+    void serialize_cache(CellCachePtr &cache, DynamicBuffer &payload,
+                         int64_t *latest_revisionp, int64_t *cell_countp);
+
+    /// Magic number identifying checkpoint files
+    static const uint32_t MAGIC = 0x43634b70;
+
+    /// Checkpoint file format version
+    static const uint16_t VERSION = 1;
+
+    /// Fully qualified access group name
+    String m_full_name;
+
+    /// Checkpoint file pathname
+    String m_pathname;
+  };
+
+  /// @}
+
+}
+
+#endif // Hypertable_RangeServer_CellCacheCheckpoint_h
@@ -0,0 +1,168 @@
+/*
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 3 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/// @file
+/// Definitions for CellCacheCompact.
+/// This file contains definitions for CellCacheCompact, a compacted
+/// read-optimized cell list used for in-memory access groups.
+
+#include <Common/Compat.h>
+
+#include "CellCacheCompact.h"
+#include "CellCacheCompactScanner.h"
+#include "Config.h"
+
+#include <Hypertable/Lib/Key.h>
+
+#include <Common/Logger.h>
+
+#include <cstring>
+
+using namespace Hypertable;
+using namespace std;
+
+CellCacheCompact::CellCacheCompact() {
+  HT_ASSERT(Config::properties); // requires Config::init* first
+  m_arena.set_page_size((size_t)
+      Config::get_i32("Hypertable.RangeServer.AccessGroup.CellCache.PageSize"));
+}
+
+
+void CellCacheCompact::add(const Key &key, const ByteString value) {
+  HT_ASSERT(m_eytzinger.empty());  // finalize() has not been called
+  HT_ASSERT(m_cells.size() < UINT32_MAX);
+
+  size_t value_len = value.length();
+  uint8_t *ptr = m_arena.alloc(key.length + value_len);
+
+  memcpy(ptr, key.serial.ptr, key.length);
+  value.write(ptr + key.length);
+  m_arena_usage.update(m_arena.total());
+
+  m_cells.push_back(ptr);
+
+  m_key_bytes += key.length;
+  m_value_bytes += value_len;
+  if (key.flag <= FLAG_DELETE_CELL_VERSION)
+    m_deletes++;
+  if (key.timestamp < m_ts_min)
+    m_ts_min = key.timestamp;
+  if (key.timestamp > m_ts_max)
+    m_ts_max = key.timestamp;
+}
+
+
+void CellCacheCompact::finalize() {
+  size_t i {};
+  m_eytzinger.resize(m_cells.size());
+  if (!m_cells.empty())
+    fill_eytzinger(&i, 1);
+  m_arena_usage.update(m_arena.total());
+}
+
+
+void CellCacheCompact::fill_eytzinger(size_t *ip, size_t k) {
+  if (k > m_cells.size())
+    return;
+  fill_eytzinger(ip, 2*k);
+  m_eytzinger[k-1] = (uint32_t)(*ip)++;
+  fill_eytzinger(ip, 2*k + 1);
+}
+
+
+size_t CellCacheCompact::lower_bound(const SerializedKey serkey) const {
+  size_t n = m_cells.size();
+  size_t k = 1;
+  while (k <= n) {
+    SerializedKey probe(m_cells[m_eytzinger[k-1]]);
+    k = 2*k + (probe.compare(serkey) < 0 ? 1 : 0);
+  }
+  // Undo the trailing right turns to recover the last left-turn node,
+  // which holds the smallest cell not less than the search key
+  k >>= __builtin_ffs(~(unsigned)k);
+  return (k == 0) ? n : m_eytzinger[k-1];
+}
+
+
+CellListScannerPtr CellCacheCompact::create_scanner(ScanContext *scan_ctx) {
+  return make_shared<CellCacheCompactScanner>(shared_from_this(), scan_ctx);
+}
+
+
+void CellCacheCompact::split_row_estimate_data(SplitRowDataMapT &split_row_data) {
+  const char *row, *last_row = 0;
+  int64_t last_count = 0;
+  // Sample the cell index at a stride chosen to yield a bounded number of
+  // samples, attributing the weight of the whole stride to the sampled
+  // row, so that accumulation cost does not grow with the list size
+  size_t stride = (m_cells.size() / 1000) + 1;
+  for (size_t i=0; i<m_cells.size(); i+=stride) {
+    row = SerializedKey(m_cells[i]).row();
+    if (last_row == 0)
+      last_row = row;
+    if (strcmp(row, last_row) != 0) {
+      SplitRowDataMapT::iterator iter = split_row_data.find(last_row);
+      if (iter == split_row_data.end())
+        split_row_data[last_row] = last_count;
+      else
+        iter->second += last_count;
+      last_row = row;
+      last_count = 0;
+    }
+    last_count += stride;
+  }
+  if (last_count > 0) {
+    SplitRowDataMapT::iterator iter = split_row_data.find(last_row);
+    if (iter == split_row_data.end())
+      split_row_data[last_row] = last_count;
+    else
+      iter->second += last_count;
+  }
+}
+
+
+CellCacheCompactPtr CellCacheCompact::shrink(const String &split_row,
+                                             bool drop_high) {
+  CellCacheCompactPtr shrunk = make_shared<CellCacheCompact>();
+  Key key;
+  ByteString value;
+  int cmp;
+
+  for (auto cell : m_cells) {
+    key.load(SerializedKey(cell));
+    cmp = strcmp(key.row, split_row.c_str());
+    if ((cmp > 0 && !drop_high) || (cmp <= 0 && drop_high)) {
+      value.ptr = cell + key.length;
+      shrunk->add(key, value);
+    }
+  }
+  shrunk->finalize();
+  return shrunk;
+}
+
+
+void CellCacheCompact::populate_key_set(KeySet &keys) {
+  Key key;
+  for (auto cell : m_cells) {
+    key.load(SerializedKey(cell));
+    keys.insert(key);
+  }
+}
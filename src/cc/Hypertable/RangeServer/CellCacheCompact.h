@@ -0,0 +1,183 @@
+/* -*- c++ -*-
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 3 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/// @file
+/// Declarations for CellCacheCompact.
+/// This file contains type declarations for CellCacheCompact, a compacted
+/// read-optimized cell list used for in-memory access groups.
+
+#ifndef Hypertable_RangeServer_CellCacheCompact_h
+#define Hypertable_RangeServer_CellCacheCompact_h
+
+#include <Hypertable/RangeServer/CellCache.h>
+#include <Hypertable/RangeServer/CellList.h>
+#include <Hypertable/RangeServer/CellListScanner.h>
+
+#include <Hypertable/Lib/SerializedKey.h>
+
+#include <Common/AllocationTracker.h>
+#include <Common/PageArena.h>
+
+#include <memory>
+#include <vector>
+
+namespace Hypertable {
+
+  /// @addtogroup RangeServer
+  /// @{
+
+  /// Compacted read-optimized cell list for in-memory access groups.
+  /// An in-memory access group traditionally keeps its entire data set in
+  /// the CellCache map, paying the map's per-cell node overhead and
+  /// pointer-chasing seeks for cells that will never be mutated again.
+  /// This class holds the flushed portion of such an access group instead:
+  /// cells are appended in sorted order into a page arena during a
+  /// compaction (whose merge output is already sorted) and indexed by a
+  /// flat pointer array, costing twelve bytes of overhead per cell instead
+  /// of the map's node.  Seeks binary-search an Eytzinger-layout copy of
+  /// the index, which touches a cache line per level near the root instead
+  /// of scattering probes across the whole array, and scans from the seek
+  /// point walk the arena linearly.  The structure is immutable once
+  /// finalize() has been called; updates arriving after the flush go to
+  /// the access group's active CellCache as usual and the two are merged
+  /// at scan time, until the next in-memory compaction rebuilds this list.
+  class CellCacheCompact
+    : public CellList, public std::enable_shared_from_this<CellCacheCompact> {
+
+  public:
+
+    CellCacheCompact();
+
+    virtual ~CellCacheCompact() { }
+
+    /// Appends a cell to the list.
+    /// The serialized key and value are copied end-to-end into the arena
+    /// and the cell is appended to the index.  Cells must be added in
+    /// sorted order; may only be called before finalize().
+    /// @param key key to be inserted
+    /// @param value value to be inserted
+    void add(const Key &key, const ByteString value) override;
+
+    /// Builds the Eytzinger seek index.
+    /// Must be called once, after the last add() and before the list is
+    /// published to scanners.
+    void finalize();
+
+    /// Creates a CellCacheCompactScanner on this list.
+    CellListScannerPtr create_scanner(ScanContext *scan_ctx) override;
+
+    void split_row_estimate_data(SplitRowDataMapT &split_row_data) override;
+
+    /// Builds a copy of this list restricted to one side of a split row.
+    /// Cells are visited in order, so the copy is sorted by construction
+    /// and is returned already finalized.
+    /// @param split_row Split row
+    /// @param drop_high If <i>true</i> keep cells with row less than or
+    /// equal to <code>split_row</code>, otherwise keep cells with row
+    /// greater than it
+    /// @return Newly allocated restricted copy
+    std::shared_ptr<CellCacheCompact> shrink(const String &split_row,
+                                             bool drop_high);
+
+    /// Returns the index of the first cell not less than
+    /// <code>serkey</code> via Eytzinger binary search, or size() if all
+    /// cells compare less.
+    size_t lower_bound(const SerializedKey serkey) const;
+
+    /// Returns a pointer to the serialized cell at <code>ix</code>
+    const uint8_t *cell(size_t ix) const { return m_cells[ix]; }
+
+    size_t size() const { return m_cells.size(); }
+
+    bool empty() const { return m_cells.empty(); }
+
+    int64_t memory_used() const {
+      return m_arena.used() + index_memory();
+    }
+
+    int64_t memory_allocated() const {
+      return m_arena.total() + index_memory();
+    }
+
+    int64_t logical_size() const { return m_key_bytes + m_value_bytes; }
+
+    /// Returns the smallest cell timestamp added, or INT64_MAX if empty
+    int64_t timestamp_min() const { return m_ts_min; }
+
+    /// Returns the largest cell timestamp added, or INT64_MIN if empty
+    int64_t timestamp_max() const { return m_ts_max; }
+
+    int32_t delete_count() const { return m_deletes; }
+
+    void add_statistics(CellCache::Statistics &stats) {
+      stats.size += m_cells.size();
+      stats.deletes += m_deletes;
+      stats.memory_used += memory_used();
+      stats.memory_allocated += memory_allocated();
+      stats.key_bytes += m_key_bytes;
+      stats.value_bytes += m_value_bytes;
+    }
+
+    /// Populates <code>keys</code> with all keys in the list
+    void populate_key_set(KeySet &keys);
+
+  private:
+
+    /// Recursively fills #m_eytzinger at heap position <code>k</code>
+    /// (1-based) from the in-order index counter <code>*ip</code>
+    void fill_eytzinger(size_t *ip, size_t k);
+
+    /// Bytes held by the pointer and Eytzinger indexes
+    int64_t index_memory() const {
+      return (int64_t)(m_cells.capacity() * sizeof(const uint8_t *) +
+                       m_eytzinger.capacity() * sizeof(uint32_t));
+    }
+
+    /// Arena holding the serialized cells
+    ByteArena m_arena;
+
+    /// Charges arena growth to the CellCache allocation subsystem
+    TrackedArenaUsage m_arena_usage {AllocationTracker::CELL_CACHE};
+
+    /// Cells in sorted order
+    std::vector<const uint8_t *> m_cells;
+
+    /// Eytzinger-layout permutation of cell indexes, built by finalize()
+    std::vector<uint32_t> m_eytzinger;
+
+    int32_t m_deletes {};
+    int64_t m_key_bytes {};
+    int64_t m_value_bytes {};
+
+    /// Cell timestamp bounds, used to classify the list against scan
+    /// time windows
+    int64_t m_ts_min {INT64_MAX};
+    int64_t m_ts_max {INT64_MIN};
+  };
+
+  /// Shared smart pointer to CellCacheCompact
+  typedef std::shared_ptr<CellCacheCompact> CellCacheCompactPtr;
+
+  /// @}
+
+}
+
+#endif // Hypertable_RangeServer_CellCacheCompact_h
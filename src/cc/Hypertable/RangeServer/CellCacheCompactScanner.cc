@@ -0,0 +1,130 @@
+/*
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 3 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include <Common/Compat.h>
+
+#include "CellCacheCompactScanner.h"
+
+#include <Hypertable/Lib/Key.h>
+
+#include <Common/Logger.h>
+
+#include <cstring>
+
+using namespace Hypertable;
+using namespace std;
+
+CellCacheCompactScanner::CellCacheCompactScanner(CellCacheCompactPtr cache,
+                                                 ScanContext *scan_ctx)
+  : CellListScanner(scan_ctx), m_cache(cache) {
+  DynamicBuffer current_buf;
+  Key current;
+
+  m_keys_only = (scan_ctx->spec) ?
+    (scan_ctx->spec->keys_only && !scan_ctx->spec->value_regexp) : false;
+
+  /**
+   * When the scan starts in the middle of a row, replay any DELETE_ROW
+   * records for the start row (and DELETE_COLUMN_FAMILY records when it
+   * starts in the middle of a column family) ahead of the main walk; see
+   * CellCacheScanner for the rationale.
+   */
+  if (scan_ctx->has_cell_interval) {
+    size_t ix;
+
+    create_key_and_append(current_buf, FLAG_DELETE_ROW,
+                          scan_ctx->start_key.row, 0,
+                          "", TIMESTAMP_MAX, 0);
+
+    for (ix = m_cache->lower_bound(SerializedKey(current_buf.base));
+         ix < m_cache->size(); ix++) {
+      current.load(SerializedKey(m_cache->cell(ix)));
+      if (current.flag != FLAG_DELETE_ROW ||
+          strcmp(current.row, scan_ctx->start_key.row))
+        break;
+      m_deletes.push_back(m_cache->cell(ix));
+    }
+
+    if (scan_ctx->has_start_cf_qualifier) {
+
+      current_buf.clear();
+      create_key_and_append(current_buf, FLAG_DELETE_COLUMN_FAMILY,
+                            scan_ctx->start_key.row,
+                            scan_ctx->start_key.column_family_code,
+                            "", TIMESTAMP_MAX, 0);
+
+      for (ix = m_cache->lower_bound(SerializedKey(current_buf.base));
+           ix < m_cache->size(); ix++) {
+        current.load(SerializedKey(m_cache->cell(ix)));
+        if (current.flag != FLAG_DELETE_COLUMN_FAMILY ||
+            current.column_family_code !=
+              scan_ctx->start_key.column_family_code ||
+            strcmp(current.row, scan_ctx->start_key.row))
+          break;
+        m_deletes.push_back(m_cache->cell(ix));
+      }
+    }
+  }
+
+  m_cur = m_cache->lower_bound(scan_ctx->start_serkey);
+  position();
+}
+
+
+bool CellCacheCompactScanner::get(Key &key, ByteString &value) {
+
+  if (m_delete_next < m_deletes.size()) {
+    key.load(SerializedKey(m_deletes[m_delete_next]));
+    value.ptr = m_deletes[m_delete_next] + key.length;
+    return true;
+  }
+
+  if (m_eos)
+    return false;
+
+  key = m_cur_key;
+  value = m_keys_only ? ByteString(0) : m_cur_value;
+  return true;
+}
+
+
+void CellCacheCompactScanner::forward() {
+  if (m_delete_next < m_deletes.size()) {
+    m_delete_next++;
+    return;
+  }
+  m_cur++;
+  position();
+}
+
+
+void CellCacheCompactScanner::position() {
+  while (m_cur < m_cache->size()) {
+    m_cur_key.load(SerializedKey(m_cache->cell(m_cur)));
+    if (m_cur_key.flag == FLAG_DELETE_ROW ||
+        m_scan_context_ptr->family_mask[m_cur_key.column_family_code]) {
+      m_cur_value.ptr = m_cache->cell(m_cur) + m_cur_key.length;
+      return;
+    }
+    m_cur++;
+  }
+  m_eos = true;
+}
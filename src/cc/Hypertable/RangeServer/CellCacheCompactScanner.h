@@ -0,0 +1,97 @@
+/* -*- c++ -*-
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 3 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/// @file
+/// Declarations for CellCacheCompactScanner.
+/// This file contains type declarations for CellCacheCompactScanner, a
+/// scanner over a CellCacheCompact.
+
+#ifndef Hypertable_RangeServer_CellCacheCompactScanner_h
+#define Hypertable_RangeServer_CellCacheCompactScanner_h
+
+#include <Hypertable/RangeServer/CellCacheCompact.h>
+#include <Hypertable/RangeServer/CellListScanner.h>
+#include <Hypertable/RangeServer/ScanContext.h>
+
+#include <vector>
+
+namespace Hypertable {
+
+  /// @addtogroup RangeServer
+  /// @{
+
+  /// Scanner over a CellCacheCompact.
+  /// The underlying list is immutable, so unlike CellCacheScanner no
+  /// locking or entry batching is needed; the scanner seeks to the scan
+  /// start key with one Eytzinger binary search and then walks the cell
+  /// index linearly.  Like CellCacheScanner, a scan starting in the middle
+  /// of a row first replays any DELETE_ROW (and, when the scan starts in
+  /// the middle of a column family, DELETE_COLUMN_FAMILY) records for the
+  /// start row so delete semantics are preserved across the seek.
+  class CellCacheCompactScanner : public CellListScanner {
+  public:
+
+    CellCacheCompactScanner(CellCacheCompactPtr cache, ScanContext *scan_ctx);
+
+    virtual ~CellCacheCompactScanner() { }
+
+    void forward() override;
+
+    bool get(Key &key, ByteString &value) override;
+
+    int64_t get_disk_read() override { return 0; }
+
+  private:
+
+    /// Advances #m_cur to the next cell passing the column family mask
+    /// and loads it into #m_cur_key / #m_cur_value
+    void position();
+
+    /// Scanned list
+    CellCacheCompactPtr m_cache;
+
+    /// Delete records for the start row replayed ahead of the main walk
+    std::vector<const uint8_t *> m_deletes;
+
+    /// Next entry to replay from #m_deletes
+    size_t m_delete_next {};
+
+    /// Index of the current cell in the list
+    size_t m_cur;
+
+    /// Current cell's key
+    Key m_cur_key;
+
+    /// Current cell's value
+    ByteString m_cur_value;
+
+    /// <i>true</i> if the main walk is exhausted
+    bool m_eos {};
+
+    /// <i>true</i> for keys-only scans, which return a null value
+    bool m_keys_only {};
+  };
+
+  /// @}
+
+}
+
+#endif // Hypertable_RangeServer_CellCacheCompactScanner_h
@@ -83,15 +83,22 @@ void CellCacheManager::add(CellListScannerPtr &scanner) {
 
 void CellCacheManager::add_immutable_scanner(MergeScannerAccessGroup *mscanner,
                                              ScanContext *scan_ctx) {
-  if (m_immutable_cache)
+  if (m_immutable_cache && m_immutable_cache->may_contain(scan_ctx))
     mscanner->add_scanner(m_immutable_cache->create_scanner(scan_ctx));
 }
 
+void CellCacheManager::add_compact_scanner(MergeScannerAccessGroup *mscanner,
+                                           ScanContext *scan_ctx) {
+  if (m_compact_cache && !m_compact_cache->empty())
+    mscanner->add_scanner(m_compact_cache->create_scanner(scan_ctx));
+}
+
 void CellCacheManager::add_scanners(MergeScannerAccessGroup *scanner,
                                     ScanContext *scan_ctx) {
-  if (!m_active_cache->empty())
+  if (!m_active_cache->empty() && m_active_cache->may_contain(scan_ctx))
     scanner->add_scanner(m_active_cache->create_scanner(scan_ctx));
   add_immutable_scanner(scanner, scan_ctx);
+  add_compact_scanner(scanner, scan_ctx);
 }
 
 
@@ -99,29 +106,36 @@ void
 CellCacheManager::split_row_estimate_data(CellList::SplitRowDataMapT &split_row_data) {
   if (m_immutable_cache)
     m_immutable_cache->split_row_estimate_data(split_row_data);
+  if (m_compact_cache)
+    m_compact_cache->split_row_estimate_data(split_row_data);
   m_active_cache->split_row_estimate_data(split_row_data);
 }
 
 
 int64_t CellCacheManager::memory_used() {
   return m_active_cache->memory_used() +
-    (m_immutable_cache ? m_immutable_cache->memory_used() : 0);
+    (m_immutable_cache ? m_immutable_cache->memory_used() : 0) +
+    (m_compact_cache ? m_compact_cache->memory_used() : 0);
 }
 
 int64_t CellCacheManager::logical_size() {
   return m_active_cache->logical_size() +
-    (m_immutable_cache ? m_immutable_cache->logical_size() : 0);
+    (m_immutable_cache ? m_immutable_cache->logical_size() : 0) +
+    (m_compact_cache ? m_compact_cache->logical_size() : 0);
 }
 
 void CellCacheManager::get_cache_statistics(CellCache::Statistics &stats) {
   m_active_cache->add_statistics(stats);
   if (m_immutable_cache)
     m_immutable_cache->add_statistics(stats);
+  if (m_compact_cache)
+    m_compact_cache->add_statistics(stats);
 }
 
 int32_t CellCacheManager::delete_count() {
   return m_active_cache->delete_count() +
-    (m_immutable_cache ? m_immutable_cache->delete_count() : 0);
+    (m_immutable_cache ? m_immutable_cache->delete_count() : 0) +
+    (m_compact_cache ? m_compact_cache->delete_count() : 0);
 }
 
 void CellCacheManager::freeze() {
@@ -132,5 +146,7 @@ void CellCacheManager::freeze() {
 void CellCacheManager::populate_key_set(KeySet &keys) {
   if (m_immutable_cache)
     m_immutable_cache->populate_key_set(keys);
+  if (m_compact_cache)
+    m_compact_cache->populate_key_set(keys);
   m_active_cache->populate_key_set(keys);
 }
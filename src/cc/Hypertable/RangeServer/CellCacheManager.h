@@ -28,6 +28,7 @@
 #define Hypertable_RangeServer_CellCacheManager_h
 
 #include <Hypertable/RangeServer/CellCache.h>
+#include <Hypertable/RangeServer/CellCacheCompact.h>
 #include <Hypertable/RangeServer/CellList.h>
 #include <Hypertable/RangeServer/CellListScanner.h>
 #include <Hypertable/RangeServer/MergeScannerAccessGroup.h>
@@ -76,23 +77,47 @@ namespace Hypertable {
       m_immutable_cache = new_cache;
     }
 
+    /// Installs a new compact cache.
+    /// This function replaces #m_compact_cache with <code>new_cache</code>.
+    /// The compact cache holds the flushed (read-only) portion of an
+    /// in-memory access group and is rebuilt by each in-memory compaction;
+    /// see CellCacheCompact.
+    /// @param new_cache New compact cache
+    void install_compact_cache(CellCacheCompactPtr new_cache) {
+      m_compact_cache = new_cache;
+    }
+
     /// Merges immutable cache into active cache.
     void merge_caches(SchemaPtr &schema);
 
     /// Inserts a key/value pair to the active cache.
     /// Adds <code>key</code> and <code>value</code> directly into
-    /// #m_active_cache.
-    /// @note lock() must be called before calling this function.
+    /// #m_active_cache.  Safe to call from concurrent threads; see
+    /// CellCache::add().
     /// @param key key to be inserted
     /// @param value value to inserted
     void add(const Key &key, const ByteString value) {
       m_active_cache->add(key, value);
     }
 
+    /// Inserts a key/value pair to the active cache, by reference when
+    /// possible.
+    /// Adds <code>key</code> and <code>value</code> directly into
+    /// #m_active_cache, allowing the cache to reference the cell in place
+    /// inside <code>buffer</code>; see
+    /// CellCache::add(const Key &, const ByteString, const StaticBufferPtr &).
+    /// @param key key to be inserted
+    /// @param value value to inserted
+    /// @param buffer Buffer holding the serialized cell, or 0 to force a copy
+    void add(const Key &key, const ByteString value,
+             const StaticBufferPtr &buffer) {
+      m_active_cache->add(key, value, buffer);
+    }
+
     /// Inserts a key/value pair for a counter column into the active cache.
     /// Adds <code>key</code> and <code>value</code> directly into
-    /// #m_active_cache.
-    /// @note lock() must be called before calling this function.
+    /// #m_active_cache, which internally serializes counter accumulation;
+    /// see CellCache::add_counter().
     /// @param key key to be inserted
     /// @param value value to inserted
     void add_counter(const Key &key, const ByteString value) {
@@ -114,6 +139,15 @@ namespace Hypertable {
     void add_immutable_scanner(MergeScannerAccessGroup *mscanner,
                                ScanContext *scan_ctx);
 
+    /// Creates a scanner on the compact cache and adds it to a merge scanner.
+    /// If a non-empty compact cache is installed, a scanner is created on it
+    /// and added to <code>mscanner</code>.
+    /// @param mscanner Merge scanner to which compact cache scanner should be
+    /// added
+    /// @param scan_ctx Scan context for initializing compact cache scanner
+    void add_compact_scanner(MergeScannerAccessGroup *mscanner,
+                             ScanContext *scan_ctx);
+
     /// Creates scanners on the active and immutable caches and adds them to a
     /// merge scanner.  If the active cache is not empty, a scanner is
     /// created on it and added to <code>scanner</code>.  If an immutable cache
@@ -163,6 +197,23 @@ namespace Hypertable {
     /// Drops the immutable cache.
     void drop_immutable_cache() { m_immutable_cache = nullptr; }
 
+    /// Returns a pointer to the compact cache.
+    /// Returns a pointer to the compact cache if one is installed, otherwise
+    /// nullptr.
+    /// @return Pointer to the compact cache.
+    CellCacheCompactPtr &compact_cache() {
+      return m_compact_cache;
+    }
+
+    /// Drops the compact cache.
+    void drop_compact_cache() { m_compact_cache = nullptr; }
+
+    /// Returns the number of cells in the compact cache.
+    /// @return Number of cells in the compact cache.
+    size_t compact_items() {
+      return m_compact_cache ? m_compact_cache->size() : 0;
+    }
+
     /// Returns the number of cells in the immutable cache.
     /// @return Number of cells in the immutable cache.
     size_t immutable_items() {
@@ -173,7 +224,8 @@ namespace Hypertable {
     /// @return <i>true</i> if active cache is empty and immutable cache is not
     /// installed or is empty, <i>false</i> otherwise.
     bool empty() {
-      return m_active_cache->empty() && immutable_cache_empty();
+      return m_active_cache->empty() && immutable_cache_empty() &&
+        (!m_compact_cache || m_compact_cache->empty());
     }
 
     /// Checks if immutable cache is not installed or is empty.
@@ -201,6 +253,28 @@ namespace Hypertable {
     /// @param stats Reference to cell cache statistics structure
     void get_cache_statistics(CellCache::Statistics &stats);
 
+    /// Gets the union of the cell timestamp bounds of the active and
+    /// immutable caches.  If both caches are empty, <code>*minp</code> is
+    /// set to INT64_MAX and <code>*maxp</code> to INT64_MIN.
+    /// @param minp Address of variable to hold smallest cell timestamp
+    /// @param maxp Address of variable to hold largest cell timestamp
+    void get_timestamp_range(int64_t *minp, int64_t *maxp) {
+      *minp = m_active_cache->timestamp_min();
+      *maxp = m_active_cache->timestamp_max();
+      if (m_immutable_cache) {
+        if (m_immutable_cache->timestamp_min() < *minp)
+          *minp = m_immutable_cache->timestamp_min();
+        if (m_immutable_cache->timestamp_max() > *maxp)
+          *maxp = m_immutable_cache->timestamp_max();
+      }
+      if (m_compact_cache) {
+        if (m_compact_cache->timestamp_min() < *minp)
+          *minp = m_compact_cache->timestamp_min();
+        if (m_compact_cache->timestamp_max() > *maxp)
+          *maxp = m_compact_cache->timestamp_max();
+      }
+    }
+
     /// Returns the number of deletes present in the caches.
     /// This function returns the sum of the delete counts from the active and
     /// immutable caches.
@@ -225,6 +299,10 @@ namespace Hypertable {
 
     /// Immutable cache
     CellCachePtr m_immutable_cache;
+
+    /// Compact cache holding the flushed portion of an in-memory access
+    /// group (see CellCacheCompact)
+    CellCacheCompactPtr m_compact_cache;
   };
 
   /// Smart pointer to CellCacheManager
@@ -43,6 +43,8 @@ CellCacheScanner::CellCacheScanner(CellCachePtr cellcache,
   Key current;
   String tmp_str;
 
+  // Key-iteration mode:  value pointers are never materialized, so the
+  // scan touches only the serialized keys of each cache entry
   m_keys_only = (scan_ctx->spec) ? (scan_ctx->spec->keys_only && !scan_ctx->spec->value_regexp) : false;
 
   current_buf.grow(scan_ctx->start_key.row_len +
@@ -103,10 +105,6 @@ CellCacheScanner::CellCacheScanner(CellCachePtr cellcache,
   }
 
   m_start_iter = m_cell_cache_ptr->m_cell_map.lower_bound(scan_ctx->start_serkey);
-  if (m_start_iter != m_cell_cache_ptr->m_cell_map.end())
-    m_end_iter = m_cell_cache_ptr->m_cell_map.lower_bound(scan_ctx->end_serkey);
-  else
-    m_end_iter = m_cell_cache_ptr->m_cell_map.end();
   m_cur_iter = m_start_iter;
 
   if (!m_deletes.empty()) {
@@ -114,11 +112,12 @@ CellCacheScanner::CellCacheScanner(CellCachePtr cellcache,
     m_delete_iter = m_deletes.begin();
   }
 
-  while (m_cur_iter != m_end_iter) {
+  while (!cur_at_end()) {
     m_cur_entry.key.load( (*m_cur_iter).first );
     if (m_cur_entry.key.flag == FLAG_DELETE_ROW
         || m_scan_context_ptr->family_mask[m_cur_entry.key.column_family_code]) {
-      m_cur_entry.value.ptr = m_cur_entry.key.serial.ptr + (*m_cur_iter).second;
+      if (!m_keys_only)
+        m_cur_entry.value.ptr = m_cur_entry.key.serial.ptr + (*m_cur_iter).second;
       return;
     }
     ++m_cur_iter;
@@ -155,17 +154,12 @@ bool CellCacheScanner::internal_get() {
 
   if (m_in_deletes) {
     m_cur_entry.key.load( (*m_delete_iter).first );
-    m_cur_entry.value.ptr = m_cur_entry.key.serial.ptr + (*m_delete_iter).second;
-    return true;
-  }
-
-  if (!m_eos) {
-    if (m_keys_only)
-      m_cur_entry.value = (ByteString)0;
+    if (!m_keys_only)
+      m_cur_entry.value.ptr = m_cur_entry.key.serial.ptr + (*m_delete_iter).second;
     return true;
   }
 
-  return false;
+  return !m_eos;
 }
 
 
@@ -176,10 +170,11 @@ void CellCacheScanner::internal_forward() {
     ++m_delete_iter;
     if (m_delete_iter == m_deletes.end()) {
       m_in_deletes = false;
-      if (m_cur_iter != m_end_iter) {
+      if (!cur_at_end()) {
         // reset current entry since its loaded with the last entry in m_deletes
         m_cur_entry.key.load( (*m_cur_iter).first );
-        m_cur_entry.value.ptr = m_cur_entry.key.serial.ptr + (*m_cur_iter).second;
+        if (!m_keys_only)
+          m_cur_entry.value.ptr = m_cur_entry.key.serial.ptr + (*m_cur_iter).second;
       }
       else
         m_eos = true;
@@ -188,12 +183,13 @@ void CellCacheScanner::internal_forward() {
   }
 
   ++m_cur_iter;
-  while (m_cur_iter != m_end_iter) {
+  while (!cur_at_end()) {
 
     m_cur_entry.key.load( (*m_cur_iter).first );
     if (m_cur_entry.key.flag == FLAG_DELETE_ROW
         || m_scan_context_ptr->family_mask[m_cur_entry.key.column_family_code]) {
-      m_cur_entry.value.ptr = m_cur_entry.key.serial.ptr + (*m_cur_iter).second;
+      if (!m_keys_only)
+        m_cur_entry.value.ptr = m_cur_entry.key.serial.ptr + (*m_cur_iter).second;
       return;
     }
     ++m_cur_iter;
@@ -48,6 +48,15 @@ namespace Hypertable {
     void internal_forward();
     void load_entry_cache();
 
+    /// Checks whether #m_cur_iter has reached the end of the scan range.
+    /// The end is determined by key comparison rather than a captured end
+    /// iterator because entries may be inserted concurrently behind any
+    /// iterator obtained at scanner construction time.
+    bool cur_at_end() {
+      return m_cur_iter == m_cell_cache_ptr->m_cell_map.end() ||
+        !(m_cur_iter->first < m_scan_context_ptr->end_serkey);
+    }
+
     class CellCacheEntry {
     public:
       CellCacheEntry() : value(0) { };
@@ -56,7 +65,6 @@ namespace Hypertable {
     };
 
     CellCache::CellMap::iterator   m_start_iter;
-    CellCache::CellMap::iterator   m_end_iter;
     CellCache::CellMap::iterator   m_cur_iter;
     CellCacheMap::iterator         m_delete_iter;
     CellCachePtr                   m_cell_cache_ptr;
@@ -0,0 +1,348 @@
+/* -*- c++ -*-
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 3 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/// @file
+/// Declarations for CellCacheSkipList.
+/// This file contains the type declarations for CellCacheSkipList, a
+/// concurrent sorted map from SerializedKey to value offset used as the
+/// backing structure of CellCache.
+
+#ifndef Hypertable_RangeServer_CellCacheSkipList_h
+#define Hypertable_RangeServer_CellCacheSkipList_h
+
+#include <Hypertable/RangeServer/CellCacheAllocator.h>
+
+#include <Hypertable/Lib/SerializedKey.h>
+
+#include <atomic>
+#include <cstring>
+#include <mutex>
+#include <utility>
+
+namespace Hypertable {
+
+  /// @addtogroup RangeServer
+  /// @{
+
+  /// Concurrent skip list mapping SerializedKey to value offset.
+  /// Replaces the mutex-protected std::map that previously backed
+  /// CellCache so that update threads can insert into the same cache
+  /// while scanners iterate it.  Nodes are linked with atomic pointers
+  /// and inserted with compare-and-swap, so writers never block readers
+  /// and concurrent writers only retry the splice of a contended level.
+  /// Nodes are never unlinked; all node memory is drawn from the cache's
+  /// arena and reclaimed when the arena is freed, which makes iteration
+  /// safe without reference counting or hazard pointers.  Readers that
+  /// follow an acquire-loaded link are guaranteed to see the key and
+  /// value bytes the writer copied into the arena before publishing the
+  /// node.
+  class CellCacheSkipList {
+  public:
+
+    /// Map entry; <i>first</i> points at the serialized key (with the
+    /// value appended) and <i>second</i> holds the value's byte offset
+    typedef std::pair<SerializedKey, uint32_t> value_type;
+
+  private:
+
+    /// Maximum tower height (1/4 branching covers billions of entries)
+    enum { MAX_HEIGHT = 12 };
+
+    /// Skip list node; the tower of next pointers is allocated inline
+    /// with a length determined at insert time
+    struct Node {
+      value_type item;
+      std::atomic<Node *> next[1];
+    };
+
+  public:
+
+    /// Forward iterator over the level-0 linked list.
+    /// Remains valid under concurrent insertion since nodes are never
+    /// unlinked or moved.
+    class iterator {
+    public:
+      iterator() : m_node(0) { }
+      explicit iterator(Node *node) : m_node(node) { }
+      value_type &operator*() const { return m_node->item; }
+      value_type *operator->() const { return &m_node->item; }
+      iterator &operator++() {
+        m_node = m_node->next[0].load(std::memory_order_acquire);
+        return *this;
+      }
+      bool operator==(const iterator &other) const {
+        return m_node == other.m_node;
+      }
+      bool operator!=(const iterator &other) const {
+        return m_node != other.m_node;
+      }
+    private:
+      Node *m_node;
+    };
+
+    typedef iterator const_iterator;
+
+    /// Constructor.
+    /// @param arena Arena from which node memory is allocated
+    /// @param alloc_mutex %Mutex serializing allocations from
+    /// <code>arena</code>
+    CellCacheSkipList(CellCacheArena &arena, std::mutex &alloc_mutex)
+      : m_arena(arena), m_alloc_mutex(alloc_mutex) {
+      m_head = new_node(value_type(), MAX_HEIGHT);
+    }
+
+    /// Inserts an entry if no entry with an equal key exists.
+    /// @param v Entry to insert
+    /// @return Iterator to the inserted or existing entry, and
+    /// <i>true</i> if the insert took place
+    std::pair<iterator, bool> insert(const value_type &v) {
+      Node *preds[MAX_HEIGHT];
+      Node *succ = find_greater_or_equal(v.first, preds);
+
+      if (succ && !(v.first < succ->item.first))
+        return std::make_pair(iterator(succ), false);
+
+      int height = raise_height();
+      Node *node = new_node(v, height);
+      return splice(node, height, node_length(height), preds, succ);
+    }
+
+    /// Inserts an entry whose cell bytes are copied into the node
+    /// allocation itself, so small cells cost a single arena allocation
+    /// and key comparisons against the entry never leave the node's
+    /// cache lines.  The key and value bytes are copied back to back,
+    /// matching the layout #insert entries reference.
+    /// @param key_ptr Serialized key bytes
+    /// @param key_len Length of serialized key
+    /// @param value_ptr Serialized value bytes
+    /// @param value_len Length of serialized value
+    /// @return Iterator to the inserted or existing entry, and
+    /// <i>true</i> if the insert took place; on <i>false</i> no memory
+    /// was consumed
+    std::pair<iterator, bool> insert_inline(const uint8_t *key_ptr,
+                                            uint32_t key_len,
+                                            const uint8_t *value_ptr,
+                                            size_t value_len) {
+      Node *preds[MAX_HEIGHT];
+      SerializedKey key(key_ptr);
+      Node *succ = find_greater_or_equal(key, preds);
+
+      if (succ && !(key < succ->item.first))
+        return std::make_pair(iterator(succ), false);
+
+      int height = raise_height();
+      size_t length = node_length(height) + key_len + value_len;
+      Node *node;
+      {
+        std::lock_guard<std::mutex> lock(m_alloc_mutex);
+        node = (Node *)m_arena.alloc(length);
+      }
+      uint8_t *cell = (uint8_t *)node + node_length(height);
+      memcpy(cell, key_ptr, key_len);
+      if (value_len)
+        memcpy(cell + key_len, value_ptr, value_len);
+      new (&node->item) value_type(SerializedKey(cell), key_len);
+      for (int i = 0; i < height; i++)
+        new (&node->next[i]) std::atomic<Node *>((Node *)0);
+      return splice(node, height, length, preds, succ);
+    }
+
+    /// Returns an iterator to the first entry not less than
+    /// <code>key</code>.
+    /// @param key Search key
+    /// @return Iterator to first entry not less than <code>key</code>,
+    /// or end() if no such entry exists
+    iterator lower_bound(const SerializedKey &key) {
+      return iterator(find_greater_or_equal(key, 0));
+    }
+
+    iterator begin() {
+      return iterator(m_head->next[0].load(std::memory_order_acquire));
+    }
+
+    iterator end() { return iterator(); }
+
+    const_iterator begin() const {
+      return const_cast<CellCacheSkipList *>(this)->begin();
+    }
+
+    const_iterator end() const { return const_iterator(); }
+
+    size_t size() const { return m_size.load(std::memory_order_relaxed); }
+
+    bool empty() const { return size() == 0; }
+
+    /// Unlinks all entries.  Node memory remains in the arena; this
+    /// merely resets the list for destruction.
+    void clear() {
+      for (int i = 0; i < MAX_HEIGHT; i++)
+        m_head->next[i].store(0, std::memory_order_relaxed);
+      m_height.store(1, std::memory_order_relaxed);
+      m_size.store(0, std::memory_order_relaxed);
+    }
+
+  private:
+
+    /// Draws a tower height and raises the list height to cover it.
+    int raise_height() {
+      int height = random_height();
+      int list_height = m_height.load(std::memory_order_relaxed);
+      while (height > list_height &&
+             !m_height.compare_exchange_weak(list_height, height,
+                                             std::memory_order_relaxed))
+        ;
+      return height;
+    }
+
+    /// Links a fully constructed node into the list.
+    /// @param node Node to link
+    /// @param height Tower height of <code>node</code>
+    /// @param alloc_length Allocation length of <code>node</code>,
+    /// returned to the arena if the insert loses to an equal key
+    /// @param preds Per-level predecessors from the preceding search
+    /// @param succ Base-level successor from the preceding search
+    std::pair<iterator, bool> splice(Node *node, int height,
+                                     size_t alloc_length, Node **preds,
+                                     Node *succ) {
+      const SerializedKey &key = node->item.first;
+
+      // Splice into the base level; a failed compare-and-swap means a
+      // concurrent insert landed between pred and succ, so re-search.
+      // If the re-search finds an equal key, the node was never
+      // published, so its memory can safely go back to the arena
+      while (true) {
+        node->next[0].store(succ, std::memory_order_relaxed);
+        if (preds[0]->next[0].compare_exchange_strong(
+                succ, node, std::memory_order_release,
+                std::memory_order_relaxed))
+          break;
+        succ = find_greater_or_equal(key, preds);
+        if (succ && !(key < succ->item.first)) {
+          {
+            std::lock_guard<std::mutex> lock(m_alloc_mutex);
+            m_arena.free_chunk(node, alloc_length);
+          }
+          return std::make_pair(iterator(succ), false);
+        }
+      }
+      m_size.fetch_add(1, std::memory_order_relaxed);
+
+      // Splice the upper levels; these only affect search speed, so each
+      // level is retried independently on contention
+      for (int level = 1; level < height; level++) {
+        while (true) {
+          Node *pred = preds[level];
+          Node *next = pred->next[level].load(std::memory_order_acquire);
+          while (next && next->item.first < key) {
+            pred = next;
+            next = pred->next[level].load(std::memory_order_acquire);
+          }
+          node->next[level].store(next, std::memory_order_relaxed);
+          if (pred->next[level].compare_exchange_strong(
+                  next, node, std::memory_order_release,
+                  std::memory_order_relaxed))
+            break;
+          preds[level] = pred;
+        }
+      }
+      return std::make_pair(iterator(node), true);
+    }
+
+    /// Returns the allocation length of a node with a tower of
+    /// <code>height</code> next pointers.
+    static size_t node_length(int height) {
+      return sizeof(Node) + (height - 1) * sizeof(std::atomic<Node *>);
+    }
+
+    /// Allocates and initializes a node with a tower of
+    /// <code>height</code> next pointers.
+    Node *new_node(const value_type &v, int height) {
+      size_t length = node_length(height);
+      Node *node;
+      {
+        std::lock_guard<std::mutex> lock(m_alloc_mutex);
+        node = (Node *)m_arena.alloc(length);
+      }
+      new (&node->item) value_type(v);
+      for (int i = 0; i < height; i++)
+        new (&node->next[i]) std::atomic<Node *>((Node *)0);
+      return node;
+    }
+
+    /// Returns the first node whose key is not less than
+    /// <code>key</code>, recording the rightmost node preceding it at
+    /// each level in <code>preds</code> when non-null.
+    Node *find_greater_or_equal(const SerializedKey &key, Node **preds) {
+      Node *node = m_head;
+      int level = m_height.load(std::memory_order_relaxed) - 1;
+      if (preds) {
+        for (int i = level + 1; i < MAX_HEIGHT; i++)
+          preds[i] = m_head;
+      }
+      while (true) {
+        Node *next = node->next[level].load(std::memory_order_acquire);
+        if (next && next->item.first < key)
+          node = next;
+        else {
+          if (preds)
+            preds[level] = node;
+          if (level == 0)
+            return next;
+          level--;
+        }
+      }
+    }
+
+    /// Draws a tower height with 1/4 branching from a thread-local
+    /// xorshift generator.
+    int random_height() {
+      static thread_local uint32_t state = 0x9E3779B9;
+      state ^= state << 13;
+      state ^= state >> 17;
+      state ^= state << 5;
+      int height = 1;
+      for (uint32_t bits = state;
+           height < MAX_HEIGHT && (bits & 3) == 0; bits >>= 2)
+        height++;
+      return height;
+    }
+
+    /// Arena from which node memory is allocated
+    CellCacheArena &m_arena;
+
+    /// %Mutex serializing arena allocations
+    std::mutex &m_alloc_mutex;
+
+    /// Sentinel head node with a full-height tower
+    Node *m_head;
+
+    /// Current maximum tower height
+    std::atomic<int> m_height {1};
+
+    /// Number of entries
+    std::atomic<size_t> m_size {0};
+  };
+
+  /// @}
+
+} // namespace Hypertable
+
+#endif // Hypertable_RangeServer_CellCacheSkipList_h
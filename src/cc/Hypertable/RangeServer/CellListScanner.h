@@ -31,6 +31,41 @@
 
 namespace Hypertable {
 
+  /** Holds a run of consecutive cells returned by
+   * CellListScanner::next_run().  Cells are laid out end-to-end in #buf as
+   * (serialized key, value) pairs with the same encoding used within a
+   * CellStore block, allowing consumers to walk them with SerializedKey and
+   * ByteString without re-entering the scanner.
+   */
+  class ScanRun {
+  public:
+
+    /** Appends a cell to the run, copying key and value into #buf.
+     * @param key Serialized key
+     * @param value ByteString pointer to value (0 for keys-only scans)
+     */
+    void add(const SerializedKey key, const ByteString value) {
+      size_t key_len = key.length();
+      size_t value_len = value.ptr ? value.length() : 1;
+      buf.ensure(key_len + value_len);
+      buf.add_unchecked(key.ptr, key_len);
+      if (value.ptr)
+        buf.add_unchecked(value.ptr, value_len);
+      else
+        buf.add_unchecked("", 1);  // encodes a zero-length value
+      count++;
+    }
+
+    /// Drops accumulated cells, retaining the underlying buffer
+    void clear() { buf.clear(); count = 0; }
+
+    /// Cell data, parseable like an uncompressed CellStore block
+    DynamicBuffer buf {0};
+
+    /// Number of cells in the run
+    size_t count {};
+  };
+
   class CellListScanner {
   public:
     CellListScanner() { }
@@ -40,6 +75,30 @@ namespace Hypertable {
     virtual void forward() = 0;
     virtual bool get(Key &key, ByteString &value) = 0;
 
+    /** Retrieves a batch of consecutive cells and advances past them.
+     * Appends up to <code>limit</code> cells to <code>run</code>.  Callers
+     * may only use this entry point when they know no merge competitor can
+     * interleave with this scanner (e.g. single-store scans); cells arrive
+     * in scanner order with the usual filtering applied.  The default
+     * implementation drives get()/forward() a cell at a time; scanners with
+     * direct access to the underlying block layout override it to amortize
+     * the per-cell virtual dispatch.
+     * @param run Run to which cells are appended
+     * @param limit Maximum number of cells to append
+     * @return Number of cells appended, 0 if the scan is exhausted
+     */
+    virtual size_t next_run(ScanRun &run, size_t limit) {
+      Key key;
+      ByteString value;
+      size_t count {};
+      while (count < limit && get(key, value)) {
+        run.add(key.serial, value);
+        forward();
+        count++;
+      }
+      return count;
+    }
+
     ScanContext *scan_context() { return m_scan_context_ptr; }
 
     virtual int64_t get_disk_read() = 0;
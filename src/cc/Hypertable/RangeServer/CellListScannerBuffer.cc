@@ -55,7 +55,8 @@ void CellListScannerBuffer::add(const SerializedKey key, const ByteString value)
   memcpy(value_data, value.ptr, value_length);
 
   m_cells.push_back( make_pair(SerializedKey(key_data), ByteString(value_data)) );
-  
+
+  m_arena_usage.update(m_arena.total());
 }
 
 void CellListScannerBuffer::forward() {
@@ -31,6 +31,7 @@
 
 #include "CellListScanner.h"
 
+#include <Common/AllocationTracker.h>
 #include <Common/PageArena.h>
 #include <Common/StlAllocator.h>
 
@@ -100,6 +101,9 @@ namespace Hypertable {
     /// Memory arena to hold serialized keys and values
     ByteArena m_arena;
 
+    /// Charges arena growth to the Scanner allocation subsystem
+    TrackedArenaUsage m_arena_usage {AllocationTracker::SCANNER};
+
     /// Flag indicating if #initialize_for_scan has been called
     bool m_initialized_for_scan {};
   };
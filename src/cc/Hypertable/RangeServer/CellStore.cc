@@ -38,6 +38,10 @@ const char CellStore::INDEX_FIXED_BLOCK_MAGIC[10]    =
     { 'I','d','x','F','i','x','-','-','-','-' };
 const char CellStore::INDEX_VARIABLE_BLOCK_MAGIC[10] =
     { 'I','d','x','V','a','r','-','-','-','-' };
+const char CellStore::INDEX_LEAF_BLOCK_MAGIC[10]     =
+    { 'I','d','x','L','e','a','f','-','-','-' };
+const char CellStore::INDEX_ROOT_BLOCK_MAGIC[10]     =
+    { 'I','d','x','R','o','o','t','-','-','-' };
 
 KeyDecompressor *CellStore::create_key_decompressor() {
   return new KeyDecompressorNone();
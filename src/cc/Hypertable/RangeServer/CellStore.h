@@ -322,9 +322,76 @@ namespace Hypertable {
 
     virtual uint16_t block_header_format() = 0;
 
+    /** Indicates whether data blocks carry a restart-point trailer.
+     * Version 8+ data blocks end with the offsets of their restart points
+     * (keys written without prefix compression) followed by a count, each
+     * a fixed 32-bit integer.  Scanners strip the trailer before iterating
+     * and may binary search the restarts to locate a key within the block.
+     * @return <i>true</i> if data blocks carry a restart-point trailer
+     */
+    virtual bool block_restarts() { return false; }
+
+    /** Indicates whether data blocks use the PAX layout.
+     * PAX-layout blocks begin with the length of the key region followed by
+     * the prefix-compressed keys and then the values, in cell order, rather
+     * than interleaving each key with its value.  Scans that discard values
+     * only touch the key region.
+     * @return <i>true</i> if data blocks use the PAX layout
+     */
+    virtual bool pax_layout() { return false; }
+
+    /** Indicates whether the store holds a value dictionary.
+     * Stores written for column families with the VALUE_DICTIONARY schema
+     * option replace repeated values with codes into a per-store dictionary
+     * (see CellStoreV8::add).  Scanners must translate coded values back
+     * with value_dict_families() and value_dict_entry() before returning
+     * them.
+     * @return <i>true</i> if the store holds a value dictionary
+     */
+    virtual bool has_value_dictionary() { return false; }
+
+    /** Gets the bitmap of dictionary-coded column families.
+     * This method loads the value dictionary if it is not already loaded.
+     * @return Pointer to a 256-bit bitmap, indexed by column family code,
+     * with the bit set for each family whose values are dictionary coded,
+     * or nullptr if the store holds no value dictionary
+     */
+    virtual const uint8_t *value_dict_families() { return nullptr; }
+
+    /** Looks up a value dictionary entry.
+     * @param code Dictionary code
+     * @return Entry value in ByteString format, valid for the lifetime of
+     * the store
+     * @throws Exception with code Error::RANGESERVER_CORRUPT_CELLSTORE if
+     * <code>code</code> is out of range
+     */
+    virtual ByteString value_dict_entry(uint32_t code) { return ByteString(); }
+
+    /** Gets the row of the largest key in the store's current scope.
+     * The row is obtained from the last block index entry, loading the
+     * index if necessary.
+     * @param row Filled in with the largest row
+     * @return <i>true</i> if the row was obtained, <i>false</i> if the
+     * store version does not support this query or the index is empty
+     */
+    virtual bool get_max_row(String &row) { return false; }
+
+    /** Loads the block index and bloom filter and reads data blocks into
+     * the global block cache until <code>max_bytes</code> of cache memory
+     * have been populated.  Used to warm the cache for a freshly loaded
+     * range before it starts taking traffic.  Blocks are read in file
+     * order and blocks already cached are skipped.  This method is best
+     * effort; read errors terminate the prewarm without throwing.
+     * @param max_bytes Maximum bytes of cache memory to populate
+     * @return Bytes of cache memory populated
+     */
+    virtual int64_t prewarm_blocks(int64_t max_bytes) { return 0; }
+
     static const char DATA_BLOCK_MAGIC[10];
     static const char INDEX_FIXED_BLOCK_MAGIC[10];
     static const char INDEX_VARIABLE_BLOCK_MAGIC[10];
+    static const char INDEX_LEAF_BLOCK_MAGIC[10];
+    static const char INDEX_ROOT_BLOCK_MAGIC[10];
 
   protected:
 
@@ -41,6 +41,8 @@
 #include <cassert>
 #include <iostream>
 #include <map>
+#include <utility>
+#include <vector>
 
 namespace Hypertable {
 
@@ -56,6 +58,10 @@ namespace Hypertable {
 
     SerializedKey key;
     OffsetT offset;
+    /// Minimum cell timestamp in block (TIMESTAMP_MIN if unknown)
+    int64_t timestamp_min {TIMESTAMP_MIN};
+    /// Maximum cell timestamp in block (TIMESTAMP_MAX if unknown)
+    int64_t timestamp_max {TIMESTAMP_MAX};
   };
 
   template <typename OffsetT>
@@ -78,6 +84,8 @@ namespace Hypertable {
     CellStoreBlockIndexIteratorArray(ArrayIteratorT iter) : m_iter(iter) { }
     SerializedKey key() { return (*m_iter).key; }
     int64_t value() { return (int64_t)(*m_iter).offset; }
+    int64_t timestamp_min() { return (*m_iter).timestamp_min; }
+    int64_t timestamp_max() { return (*m_iter).timestamp_max; }
     CellStoreBlockIndexIteratorArray &operator++() { ++m_iter; return *this; }
     CellStoreBlockIndexIteratorArray operator++(int) {
       CellStoreBlockIndexIteratorArray<OffsetT> copy(*this);
@@ -108,13 +116,30 @@ namespace Hypertable {
 
   CellStoreBlockIndexArray() : m_disk_used(0), m_maximum_entries((OffsetT)-1) { }
 
+    /** Sets the total index entry count used for fraction_covered()
+     * calculations.  Used by cell store versions that demand-load a subset
+     * of the index, where the first load() call no longer sees the entire
+     * index.
+     * @param max_entries Total number of entries in the on-disk index
+     */
+    void set_maximum_entries(OffsetT max_entries) {
+      m_maximum_entries = max_entries;
+    }
+
     void load(DynamicBuffer &fixed, DynamicBuffer &variable,int64_t end_of_data,
-              const String &start_row="", const String &end_row="") {
+              const String &start_row="", const String &end_row="",
+              DynamicBuffer *timestamps=0) {
       size_t total_entries = fixed.fill() / sizeof(OffsetT);
       SerializedKey key;
       OffsetT offset;
       ElementT ee;
       const uint8_t *key_ptr;
+      const uint8_t *ts_ptr = 0;
+      size_t ts_remain = 0;
+      if (timestamps && timestamps->fill() == total_entries*16) {
+        ts_ptr = timestamps->base;
+        ts_remain = timestamps->fill();
+      }
       bool in_scope = (start_row == "") ? true : false;
       bool check_for_end_row = end_row != "";
       const uint8_t *variable_start = variable.base;
@@ -137,6 +162,12 @@ namespace Hypertable {
         memcpy(&offset, fixed.ptr, sizeof(offset));
         fixed.ptr += sizeof(offset);
 
+        // per-block timestamp range, if supplied
+        if (ts_ptr) {
+          ee.timestamp_min = (int64_t)Serialization::decode_i64(&ts_ptr, &ts_remain);
+          ee.timestamp_max = (int64_t)Serialization::decode_i64(&ts_ptr, &ts_remain);
+        }
+
         if (!in_scope) {
           if (strcmp(key.row(), start_row.c_str()) <= 0)
             continue;
@@ -199,6 +230,7 @@ namespace Hypertable {
     void rescope(const String &start_row="", const String &end_row="") {
       DynamicBuffer fixed(m_array.size() * sizeof(OffsetT));
       DynamicBuffer variable;
+      DynamicBuffer timestamps(m_array.size() * 16);
 
       // Transfer ownership of m_keydata buffer to variable
       m_keydata.own = false;
@@ -206,13 +238,17 @@ namespace Hypertable {
       variable.size = m_keydata.size;
       variable.ptr = variable.base + variable.size;
 
-      // Populate fixed array
-      for (auto &element : m_array)
+      // Populate fixed array and timestamp ranges
+      for (auto &element : m_array) {
         fixed.add_unchecked(&element.offset, sizeof(OffsetT));
+        Serialization::encode_i64(&timestamps.ptr, (uint64_t)element.timestamp_min);
+        Serialization::encode_i64(&timestamps.ptr, (uint64_t)element.timestamp_max);
+      }
       m_array.clear();
 
       // Perform normal load
-      load(fixed, variable, m_end_of_last_block, start_row, end_row);
+      load(fixed, variable, m_end_of_last_block, start_row, end_row,
+           &timestamps);
     }
 
 
@@ -267,6 +303,61 @@ namespace Hypertable {
       // larger than end_row
     }
 
+    /** Populates <code>blocks</code> with (offset, zlength) pairs for each
+     * in-scope block, in file order.  The compressed length of each block
+     * is derived from the offset of the next index entry (or the end of
+     * the last block for the final entry).
+     * @param blocks Reference to output vector of (offset, zlength) pairs
+     */
+    void get_block_offsets(std::vector<std::pair<int64_t, int64_t>> &blocks) {
+      for (ArrayIteratorT iter = m_array.begin(); iter != m_array.end(); ++iter) {
+        ArrayIteratorT next = iter + 1;
+        int64_t end = (next == m_array.end()) ? m_end_of_last_block
+                                              : (int64_t)(*next).offset;
+        blocks.push_back(std::make_pair((int64_t)(*iter).offset,
+                                        end - (int64_t)(*iter).offset));
+      }
+    }
+
+    /** Accumulates unique row estimates from block index entries, weighted
+     * by per-block disk usage.  Like unique_row_count_estimate(), except
+     * that each index entry contributes a key count proportional to the
+     * size of its block, derived from the block offsets, instead of a
+     * uniform per-block estimate.  Rows backed by more data therefore
+     * weigh more heavily in split point selection.
+     * @param split_row_data Reference to accumulator map holding unique
+     * row and count estimates
+     * @param keys_per_byte Key count to add for each byte of block data
+     */
+    void disk_weighted_row_count_estimate(CellList::SplitRowDataMapT &split_row_data,
+                                          double keys_per_byte) {
+      const char *row, *last_row = 0;
+      int64_t last_count = 0;
+      int64_t block_size;
+      for (ArrayIteratorT iter = m_array.begin(); iter != m_array.end(); ++iter) {
+        ArrayIteratorT next = iter + 1;
+        if (next == m_array.end())
+          block_size = m_end_of_last_block - (*iter).offset;
+        else
+          block_size = (*next).offset - (*iter).offset;
+        row = (*iter).key.row();
+        if (last_row == 0)
+          last_row = row;
+        if (strcmp(row, last_row) != 0) {
+          CstrToInt64MapT::iterator smi = split_row_data.find(last_row);
+          if (smi == split_row_data.end())
+            split_row_data[last_row] = last_count;
+          else
+            smi->second += last_count;
+          last_row = row;
+          last_count = 0;
+        }
+        last_count += (int64_t)(block_size * keys_per_byte);
+      }
+      // Deliberately skipping last entry in m_array because it is
+      // larger than end_row
+    }
+
     /** Populates <code>scanner</code> with data for <i>.cellstore.index</i>
      * pseudo table.  This method synthesizes the following
      * <i>.cellstore.index</i> pseudo-table cells, for each in-scope block
@@ -387,6 +478,12 @@ namespace Hypertable {
 
     int64_t index_entries() { return m_array.size(); }
 
+    /** Returns the last key in the index (the largest key in the store's
+     * current scope), or a null SerializedKey if the index is empty. */
+    SerializedKey last_key() {
+      return m_array.empty() ? SerializedKey() : m_array.back().key;
+    }
+
     iterator begin() {
       return iterator(m_array.begin());
     }
@@ -35,6 +35,7 @@
 #include <Hypertable/RangeServer/CellStoreTrailerV5.h>
 #include <Hypertable/RangeServer/CellStoreTrailerV6.h>
 #include <Hypertable/RangeServer/CellStoreTrailerV7.h>
+#include <Hypertable/RangeServer/CellStoreTrailerV8.h>
 #include <Hypertable/RangeServer/CellStoreV0.h>
 #include <Hypertable/RangeServer/CellStoreV1.h>
 #include <Hypertable/RangeServer/CellStoreV2.h>
@@ -43,6 +44,7 @@
 #include <Hypertable/RangeServer/CellStoreV5.h>
 #include <Hypertable/RangeServer/CellStoreV6.h>
 #include <Hypertable/RangeServer/CellStoreV7.h>
+#include <Hypertable/RangeServer/CellStoreV8.h>
 #include <Hypertable/RangeServer/Global.h>
 
 #include <Common/Filesystem.h>
@@ -102,7 +104,36 @@ CellStorePtr CellStoreFactory::open(const String &name,
     fd = Global::dfs->open(name, 0);
   }
 
-  if (version == 7) {
+  if (version == 8) {
+    CellStoreTrailerV8 trailer_v8;
+
+    if (amount < trailer_v8.size())
+      HT_THROWF(Error::RANGESERVER_CORRUPT_CELLSTORE,
+                "Bad length of CellStoreV8 file '%s' - %llu",
+                name.c_str(), (Llu)file_length);
+
+    try {
+      trailer_v8.deserialize(trailer_buf.get() + (amount - trailer_v8.size()));
+    }
+    catch (Exception &e) {
+      Global::dfs->close(fd);
+      if (!second_try && e.code() == Error::CHECKSUM_MISMATCH) {
+	fd = Global::dfs->open(name, oflags|Filesystem::OPEN_FLAG_VERIFY_CHECKSUM);
+        second_try = true;
+        goto try_again;
+      }
+      HT_ERRORF("Problem deserializing trailer of %s", name.c_str());
+      throw;
+    }
+
+    cellstore = make_shared<CellStoreV8>(Global::dfs.get());
+    cellstore->open(name, start, end, fd, file_length, &trailer_v8);
+    if (!cellstore)
+      HT_ERRORF("Failed to open CellStore %s [%s..%s], length=%llu",
+              name.c_str(), start.c_str(), end.c_str(), (Llu)file_length);
+    return cellstore;
+  }
+  else if (version == 7) {
     CellStoreTrailerV7 trailer_v7;
 
     if (amount < trailer_v7.size())
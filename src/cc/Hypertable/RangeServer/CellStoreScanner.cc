@@ -35,6 +35,7 @@
 #include <Hypertable/Lib/BlockHeader.h>
 
 #include <Common/Error.h>
+#include <Common/Serialization.h>
 #include <Common/System.h>
 
 using namespace Hypertable;
@@ -47,6 +48,9 @@ CellStoreScanner<IndexT>::CellStoreScanner(CellStorePtr &&cellstore, ScanContext
 
   m_keys_only = (scan_ctx->spec) ? (scan_ctx->spec->keys_only && !scan_ctx->spec->value_regexp) : false;
 
+  if (m_cellstore->has_value_dictionary())
+    m_value_dict_families = m_cellstore->value_dict_families();
+
   if (scan_ctx->has_cell_interval) {
 
     // maybe assert that there isn't more restrictive cellstore start/end row ?
@@ -138,6 +142,11 @@ CellStoreScanner<IndexT>::CellStoreScanner(CellStorePtr &&cellstore, ScanContext
     if (scan_ctx->single_row)
       readahead = false;
 
+    // block sampling hops through the index, so sequential readahead
+    // does not apply
+    if (scan_ctx->block_sample_period)
+      readahead = false;
+
     if (readahead)
       m_interval_scanners[m_interval_max++] = make_unique<CellStoreScannerIntervalReadahead<IndexT>>(cellstore, index, start_key, end_key, scan_ctx);
     else {
@@ -166,6 +175,8 @@ bool CellStoreScanner<IndexT>::get(Key &key, ByteString &value) {
   if (m_interval_scanners[m_interval_index]->get(key, value)) {
     if (m_keys_only)
       value = 0;
+    else if (m_value_dict_families)
+      value_dict_translate(key, value);
     return true;
   }
 
@@ -175,6 +186,8 @@ bool CellStoreScanner<IndexT>::get(Key &key, ByteString &value) {
     if (m_interval_scanners[m_interval_index]->get(key, value)) {
       if (m_keys_only)
         value = 0;
+      else if (m_value_dict_families)
+        value_dict_translate(key, value);
       return true;
     }
     m_interval_index++;
@@ -184,6 +197,61 @@ bool CellStoreScanner<IndexT>::get(Key &key, ByteString &value) {
   return false;
 }
 
+template <typename IndexT>
+void CellStoreScanner<IndexT>::value_dict_translate(const Key &key,
+                                                    ByteString &value) {
+  if (key.flag != FLAG_INSERT ||
+      (m_value_dict_families[key.column_family_code>>3] &
+       (1 << (key.column_family_code & 0x07))) == 0)
+    return;
+  const uint8_t *ptr;
+  size_t len = value.decode_length(&ptr);
+  if (len == 0)
+    HT_THROWF(Error::RANGESERVER_CORRUPT_CELLSTORE,
+              "Empty dictionary-coded value in CellStore '%s'",
+              m_cellstore->get_filename().c_str());
+  if (*ptr) {
+    size_t remain = len - 1;
+    ptr++;
+    value = m_cellstore->value_dict_entry(Serialization::decode_i16(&ptr,
+                                                                    &remain));
+  }
+  else {
+    // Raw fallback (dictionary was full when the value was written); strip
+    // the tag byte.  The buffer is only overwritten on the next translation
+    // and callers copy the value before forwarding the scanner.
+    m_value_buf.clear();
+    append_as_byte_string(m_value_buf, ptr+1, len-1);
+    value.ptr = m_value_buf.base;
+  }
+}
+
+template <typename IndexT>
+size_t CellStoreScanner<IndexT>::next_run(ScanRun &run, size_t limit) {
+
+  if (m_eos)
+    return 0;
+
+  // Keys-only scans null out values in get() and dictionary-coded values
+  // are translated there, so batching must go through the generic
+  // cell-at-a-time path
+  if (m_keys_only || m_value_dict_families)
+    return CellListScanner::next_run(run, limit);
+
+  size_t count = m_interval_scanners[m_interval_index]->next_run(run, limit);
+
+  while (count == 0) {
+    m_interval_index++;
+    if (m_interval_index >= m_interval_max) {
+      m_eos = true;
+      return 0;
+    }
+    count = m_interval_scanners[m_interval_index]->next_run(run, limit);
+  }
+
+  return count;
+}
+
 template <typename IndexT>
 int64_t CellStoreScanner<IndexT>::get_disk_read() {
   int64_t amount = 0;
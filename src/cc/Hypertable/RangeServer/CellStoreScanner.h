@@ -51,14 +51,30 @@ namespace Hypertable {
     virtual ~CellStoreScanner();
     void forward() override;
     bool get(Key &key, ByteString &value) override;
+    size_t next_run(ScanRun &run, size_t limit) override;
     int64_t get_disk_read() override;
 
   private:
+
+    /// Translates a dictionary-coded value back to its cleartext form.
+    /// Coded values are resolved against the store's value dictionary and
+    /// raw-fallback values have their tag byte stripped into #m_value_buf.
+    /// @param key Key of the cell whose value is to be translated
+    /// @param value Value to translate (in/out)
+    void value_dict_translate(const Key &key, ByteString &value);
+
     CellStorePtr m_cellstore;
     std::unique_ptr<CellStoreScannerInterval> m_interval_scanners[3];
     size_t m_interval_index {};
     size_t m_interval_max {};
     DynamicBuffer m_key_buf;
+
+    /// Scratch buffer backing the most recently translated raw-fallback value
+    DynamicBuffer m_value_buf;
+
+    /// Bitmap of dictionary-coded column families (nullptr when none)
+    const uint8_t *m_value_dict_families {};
+
     bool m_keys_only {};
     bool m_eos {};
     bool m_decrement_blockindex_refcount {};
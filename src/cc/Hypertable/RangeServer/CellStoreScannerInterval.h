@@ -22,6 +22,8 @@
 #ifndef HYPERTABLE_CELLSTORESCANNERINTERVAL_H
 #define HYPERTABLE_CELLSTORESCANNERINTERVAL_H
 
+#include "CellListScanner.h"
+
 #include "Common/ByteString.h"
 #include "Hypertable/Lib/Key.h"
 
@@ -32,6 +34,21 @@ namespace Hypertable {
     CellStoreScannerInterval() : m_disk_read(0) { }
     virtual void forward() = 0;
     virtual bool get(Key &key, ByteString &value) = 0;
+
+    /// Batched counterpart to get()/forward(), see
+    /// CellListScanner::next_run().
+    virtual size_t next_run(ScanRun &run, size_t limit) {
+      Key key;
+      ByteString value;
+      size_t count {};
+      while (count < limit && get(key, value)) {
+        run.add(key.serial, value);
+        forward();
+        count++;
+      }
+      return count;
+    }
+
     virtual ~CellStoreScannerInterval() { }
     int64_t get_disk_read() { return m_disk_read; }
 
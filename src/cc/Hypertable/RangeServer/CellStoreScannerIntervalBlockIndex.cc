@@ -39,6 +39,7 @@
 #include <AsyncComm/Protocol.h>
 
 #include <Common/Error.h>
+#include <Common/Serialization.h>
 #include <Common/System.h>
 
 #include <cassert>
@@ -56,6 +57,14 @@ CellStoreScannerIntervalBlockIndex<IndexT>::CellStoreScannerIntervalBlockIndex(C
   m_file_id = m_cellstore->get_file_id();
   m_zcodec = m_cellstore->create_block_compression_codec();
   m_key_decompressor = m_cellstore->create_key_decompressor();
+  m_pax = m_cellstore->pax_layout();
+  // PAX blocks segregate keys from values, so a keys-only scan can iterate
+  // the key region alone and never touch the value bytes
+  m_keys_only = m_pax && scan_ctx->spec && scan_ctx->spec->keys_only &&
+    !scan_ctx->spec->value_regexp;
+  m_prune_timestamps = scan_ctx->time_interval.first > TIMESTAMP_MIN ||
+    scan_ctx->time_interval.second < TIMESTAMP_MAX;
+  m_sample_period = scan_ctx->block_sample_period;
 
   m_end_row = (m_end_key) ? m_end_key.row() : Key::END_ROW_MARKER;
   m_fd = m_cellstore->get_fd();
@@ -70,16 +79,43 @@ CellStoreScannerIntervalBlockIndex<IndexT>::CellStoreScannerIntervalBlockIndex(C
 
   if (m_start_key) {
     const uint8_t *ptr;
+
+    /**
+     * Binary search restart points for the last one whose key is less than
+     * the start key, then resume the linear scan from there.  Restart 0 is
+     * the block's first key, which the decompressor is already positioned on.
+     */
+    if (m_restart_count > 1 && !m_pax) {
+      uint32_t lo = 0, hi = m_restart_count;
+      while (hi - lo > 1) {
+        uint32_t mid = (lo + hi) / 2;
+        ptr = m_restarts_base + (mid * 4);
+        size_t remain = 4;
+        uint32_t offset = Serialization::decode_i32(&ptr, &remain);
+        m_key_decompressor->reset();
+        m_key_decompressor->add(m_block.base + offset);
+        if (m_key_decompressor->less_than(m_start_key))
+          lo = mid;
+        else
+          hi = mid;
+      }
+      ptr = m_restarts_base + (lo * 4);
+      size_t remain = 4;
+      uint32_t offset = Serialization::decode_i32(&ptr, &remain);
+      m_key_decompressor->reset();
+      m_cur_value.ptr = m_key_decompressor->add(m_block.base + offset);
+    }
+
     while (m_key_decompressor->less_than(m_start_key)) {
-      ptr = m_cur_value.ptr + m_cur_value.length();
-      if (ptr >= m_block.end) {
+      ptr = m_keys_only ? 0 : m_cur_value.ptr + m_cur_value.length();
+      if (at_block_end(ptr)) {
         if (!fetch_next_block(true)) {
           m_iter = m_index->end();
           return;
         }
       }
       else
-        m_cur_value.ptr = m_key_decompressor->add(ptr);
+        advance_in_block(ptr);
     }
   }
 
@@ -137,9 +173,9 @@ void CellStoreScannerIntervalBlockIndex<IndexT>::forward() {
     if (m_iter == m_index->end())
       return;
 
-    ptr = m_cur_value.ptr + m_cur_value.length();
+    ptr = m_keys_only ? 0 : m_cur_value.ptr + m_cur_value.length();
 
-    if (ptr >= m_block.end) {
+    if (at_block_end(ptr)) {
       if (!fetch_next_block(true)) {
         m_iter = m_index->end();
         return;
@@ -150,7 +186,7 @@ void CellStoreScannerIntervalBlockIndex<IndexT>::forward() {
       }
     }
     else {
-      m_cur_value.ptr = m_key_decompressor->add(ptr);
+      advance_in_block(ptr);
       if (m_check_for_range_end && !m_key_decompressor->less_than(m_end_key)) {
         m_iter = m_index->end();
         return;
@@ -170,6 +206,108 @@ void CellStoreScannerIntervalBlockIndex<IndexT>::forward() {
 }
 
 
+/**
+ * Batched counterpart to get()/forward().  Runs the block-local advance
+ * loop inline, appending each qualifying cell to <code>run</code>, and
+ * falls back to forward() whenever the scan leaves the current block or a
+ * cell fails the filter checks, so a run never pays more than one virtual
+ * call per block transition.
+ */
+template <typename IndexT>
+size_t
+CellStoreScannerIntervalBlockIndex<IndexT>::next_run(ScanRun &run,
+                                                     size_t limit) {
+  const uint8_t *ptr;
+  size_t count {};
+
+  while (count < limit) {
+
+    if (m_iter == m_index->end())
+      break;
+
+    run.add(m_key.serial, m_cur_value);
+    count++;
+
+    ptr = m_cur_value.ptr + m_cur_value.length();
+
+    if (ptr >= m_block.end) {
+      forward();
+      break;
+    }
+
+    advance_in_block(ptr);
+    if (m_check_for_range_end && !m_key_decompressor->less_than(m_end_key)) {
+      m_iter = m_index->end();
+      break;
+    }
+
+    m_key_decompressor->load(m_key);
+    if ((m_key.flag != FLAG_DELETE_ROW &&
+         !m_scan_ctx->family_mask[m_key.column_family_code]) ||
+        (!m_rowset.empty() && strcmp(m_key.row, *m_rowset.begin()) < 0)) {
+      // Current cell is filtered out; let forward() skip past it
+      forward();
+      break;
+    }
+  }
+  return count;
+}
+
+
+
+/**
+ * Appends the file ranges of the blocks following m_iter to
+ * <code>ranges</code>, up to a total of Global::cellstore_preadv_blocks
+ * blocks, so that a sequential scan fetches several blocks from the broker
+ * in one vectored pread.  Blocks pruned by the scan's time interval or
+ * already present in the block cache are skipped, and look-ahead stops at
+ * the first block lying entirely past the end of the scan interval.  Row
+ * set scans and block-sampling scans jump around the file, so no look-ahead
+ * is performed for them.
+ */
+template <typename IndexT>
+void
+CellStoreScannerIntervalBlockIndex<IndexT>::add_prefetch_ranges(
+    std::vector<Filesystem::ReadRange> &ranges) {
+  int32_t limit = Global::cellstore_preadv_blocks;
+
+  if (limit < 2 || !m_rowset.empty() || m_sample_period > 1)
+    return;
+
+  IndexIteratorT it = m_iter;
+  IndexIteratorT it_next = m_iter;
+  ++it_next;
+
+  while ((int32_t)ranges.size() < limit && it_next != m_index->end()) {
+
+    // The index key is the last key of the block, so once it reaches the
+    // end row, subsequent blocks fall entirely past the scan interval
+    if (strcmp(it.key().row(), m_end_row) >= 0)
+      break;
+
+    uint64_t offset = it_next.value();
+    it = it_next;
+    ++it_next;
+
+    // Skip blocks whose cells all fall outside the scan's time interval
+    if (m_prune_timestamps &&
+        (it.timestamp_min() >= m_scan_ctx->time_interval.second ||
+         it.timestamp_max() < m_scan_ctx->time_interval.first))
+      continue;
+
+    // Skip blocks already present in the block cache
+    if (Global::block_cache &&
+        Global::block_cache->contains(m_file_id, offset))
+      continue;
+
+    uint32_t zlength = (it_next == m_index->end()) ?
+      (uint32_t)(m_index->end_of_last_block() - offset) :
+      (uint32_t)(it_next.value() - offset);
+
+    ranges.push_back({offset, zlength});
+  }
+}
+
 
 /**
  * This method fetches the 'next' compressed block of key/value pairs from the
@@ -195,11 +333,28 @@ bool CellStoreScannerIntervalBlockIndex<IndexT>::fetch_next_block(bool eob) {
     memset(&m_block, 0, sizeof(m_block));
     ++m_iter;
 
+    // Block sampling:  hop over the blocks between the sampled ones
+    if (m_sample_period > 1) {
+      for (int32_t i=1; i<m_sample_period && m_iter != m_index->end(); i++)
+        ++m_iter;
+    }
+
     // find next block requested by scan and filter rows
     if (m_rowset.size()) {
       while (m_iter != m_index->end() && strcmp(*m_rowset.begin(), m_iter.key().row()) > 0)
         ++m_iter;
     }
+
+    // Skip blocks whose cells all fall outside the scan's time interval.
+    // Blocks containing deletes or timestamp-less cells carry an unbounded
+    // range and are never skipped, as are entries from index formats that
+    // lack per-block timestamps.
+    if (m_prune_timestamps) {
+      while (m_iter != m_index->end() &&
+             (m_iter.timestamp_min() >= m_scan_ctx->time_interval.second ||
+              m_iter.timestamp_max() < m_scan_ctx->time_interval.first))
+        ++m_iter;
+    }
   }
 
   if (m_block.base == 0 && m_iter != m_index->end()) {
@@ -229,6 +384,7 @@ bool CellStoreScannerIntervalBlockIndex<IndexT>::fetch_next_block(bool eob) {
 				       (uint8_t **)&m_block.base, &len)) {
       bool second_try {};
       bool checked_out {};
+      bool tier_checked_out {};
 
     try_again:
       try {
@@ -239,19 +395,67 @@ bool CellStoreScannerIntervalBlockIndex<IndexT>::fetch_next_block(bool eob) {
             !Global::block_cache->checkout(m_file_id, m_block.offset,
 				           (uint8_t **)&buf.base, &len)) {
 
-	  /** Read compressed block **/
-          DispatchHandlerSynchronizer sync_handler;
-	  Global::dfs->pread(m_fd, m_block.zlength, m_block.offset, second_try, &sync_handler);
-          if (!sync_handler.wait_for_reply(event))
-            HT_THROW(Protocol::response_code(event.get()),
-                     Protocol::string_format_message(event).c_str());
-          {
-            uint32_t length;
-            uint64_t off;
-            const void *data;
-            Global::dfs->decode_response_read(event, &data, &off, &length);
-            buf.base = (uint8_t *)data;
+          auto prefetch_it = m_prefetch.find(m_block.offset);
+
+          if (!second_try && Global::compressed_block_cache &&
+              Global::compressed_block_cache->checkout(m_file_id,
+                  m_block.offset, (uint8_t **)&buf.base, &len)) {
+            /** Use compressed block from the second-tier cache **/
+            HT_ASSERT(len == m_block.zlength);
             buf.own = false;
+            tier_checked_out = true;
+          }
+          else if (!second_try && prefetch_it != m_prefetch.end() &&
+              prefetch_it->second.second == m_block.zlength) {
+            /** Use block prefetched by a previous vectored read **/
+            buf.base = (uint8_t *)prefetch_it->second.first;
+            buf.own = false;
+            event = m_prefetch_event;
+            m_prefetch.erase(prefetch_it);
+          }
+          else {
+            /** Read compressed block(s) **/
+            std::vector<Filesystem::ReadRange> ranges;
+            ranges.push_back({m_block.offset, m_block.zlength});
+            if (!second_try)
+              add_prefetch_ranges(ranges);
+
+            DispatchHandlerSynchronizer sync_handler;
+            if (ranges.size() > 1)
+              Global::dfs->preadv(m_fd, ranges, second_try, &sync_handler);
+            else
+              Global::dfs->pread(m_fd, m_block.zlength, m_block.offset,
+                                 second_try, &sync_handler);
+            if (!sync_handler.wait_for_reply(event))
+              HT_THROW(Protocol::response_code(event.get()),
+                       Protocol::string_format_message(event).c_str());
+            {
+              uint32_t length;
+              uint64_t off;
+              const void *data;
+              Global::dfs->decode_response_read(event, &data, &off, &length);
+              if (ranges.size() > 1) {
+                uint64_t total {};
+                for (auto &range : ranges)
+                  total += range.amount;
+                if (length != total)
+                  HT_THROWF(Error::FSBROKER_IO_ERROR, "Short vectored read "
+                            "(expected %llu bytes, got %u)", (Llu)total,
+                            (unsigned)length);
+                /** Stash trailing blocks for upcoming fetches **/
+                m_prefetch.clear();
+                m_prefetch_event = event;
+                const uint8_t *slice =
+                  (const uint8_t *)data + ranges.front().amount;
+                for (size_t i=1; i<ranges.size(); i++) {
+                  m_prefetch[ranges[i].offset] =
+                    std::make_pair(slice, ranges[i].amount);
+                  slice += ranges[i].amount;
+                }
+              }
+              buf.base = (uint8_t *)data;
+              buf.own = false;
+            }
           }
 
 	  checked_out = false;
@@ -268,10 +472,20 @@ bool CellStoreScannerIntervalBlockIndex<IndexT>::fetch_next_block(bool eob) {
         /** inflate compressed block **/
         BlockHeaderCellStore header(m_cellstore->block_header_format());
 
-        m_zcodec->inflate(buf, expand_buf, header);
+        if (Global::decompression_pool)
+          Global::decompression_pool->inflate(m_zcodec, buf, expand_buf,
+                                              header);
+        else
+          m_zcodec->inflate(buf, expand_buf, header);
 
-        if (!checked_out)
+        m_scan_ctx->bytes_decompressed += expand_buf.fill();
+        if (!checked_out && !tier_checked_out) {
           m_disk_read += expand_buf.fill();
+          m_blocks_loaded++;
+          m_scan_ctx->blocks_read++;
+        }
+        else
+          m_scan_ctx->block_cache_hits++;
 
         if (!header.check_magic(CellStore::DATA_BLOCK_MAGIC))
           HT_THROW(Error::BLOCK_COMPRESSOR_BAD_MAGIC,
@@ -284,7 +498,16 @@ bool CellStoreScannerIntervalBlockIndex<IndexT>::fetch_next_block(bool eob) {
           else
             Global::block_cache->insert(m_file_id, m_block.offset,
                                         (uint8_t *)buf.base, m_block.zlength,
-                                        event, false);
+                                        event, false, m_blocks_loaded > 2);
+        }
+        else if (Global::compressed_block_cache) {
+          if (tier_checked_out)
+            Global::compressed_block_cache->checkin(m_file_id, m_block.offset);
+          else
+            Global::compressed_block_cache->insert(m_file_id, m_block.offset,
+                                                   (uint8_t *)buf.base,
+                                                   m_block.zlength, event,
+                                                   false, m_blocks_loaded > 2);
         }
       }
       catch (Exception &e) {
@@ -307,17 +530,44 @@ bool CellStoreScannerIntervalBlockIndex<IndexT>::fetch_next_block(bool eob) {
       m_block.base = expand_buf.release(&fill);
       len = fill;
 
-      /** Insert uncompressed block into cache  **/
+      /** Insert uncompressed block into cache.  After a few block loads
+       * this interval is clearly a sequential scan, so admit further
+       * blocks on probation to avoid flushing the point-read hot set **/
       m_cached = Global::block_cache && !Global::block_cache->compressed() &&
           Global::block_cache->insert(m_file_id, m_block.offset,
-				      (uint8_t *)m_block.base, len, EventPtr(), true);
+				      (uint8_t *)m_block.base, len, EventPtr(),
+                                      true, m_blocks_loaded > 2);
     }
-    else
+    else {
       m_cached = true;
+      m_scan_ctx->block_cache_hits++;
+    }
+
+    /** Strip restart-point trailer **/
+    m_restarts_base = 0;
+    m_restart_count = 0;
+    if (m_cellstore->block_restarts() && len >= 8) {
+      const uint8_t *trailer = m_block.base + len - 4;
+      size_t remain = 4;
+      m_restart_count = Serialization::decode_i32(&trailer, &remain);
+      m_restarts_base = m_block.base + len - ((m_restart_count + 1) * 4);
+      len -= (m_restart_count + 1) * 4;
+    }
 
     m_key_decompressor->reset();
     m_block.end = m_block.base + len;
-    m_cur_value.ptr = m_key_decompressor->add(m_block.base);
+    if (m_pax) {
+      /** Key region length prefix, then keys, then values **/
+      const uint8_t *base = m_block.base;
+      size_t remain = 4;
+      uint32_t key_region_length = Serialization::decode_i32(&base, &remain);
+      m_key_ptr = m_key_decompressor->add(base);
+      m_key_end = base + key_region_length;
+      if (!m_keys_only)
+        m_cur_value.ptr = base + key_region_length;
+    }
+    else
+      m_cur_value.ptr = m_key_decompressor->add(m_block.base);
 
     return true;
   }
@@ -32,7 +32,14 @@
 #include <Hypertable/RangeServer/CellStoreScannerInterval.h>
 #include <Hypertable/RangeServer/ScanContext.h>
 
+#include <AsyncComm/Event.h>
+
 #include <Common/DynamicBuffer.h>
+#include <Common/Filesystem.h>
+
+#include <map>
+#include <utility>
+#include <vector>
 
 namespace Hypertable {
 
@@ -54,11 +61,38 @@ namespace Hypertable {
     virtual ~CellStoreScannerIntervalBlockIndex();
     virtual void forward();
     virtual bool get(Key &key, ByteString &value);
+    virtual size_t next_run(ScanRun &run, size_t limit);
 
   private:
 
     bool fetch_next_block(bool eob=false);
 
+    /// Appends the file ranges of upcoming in-interval blocks to
+    /// <code>ranges</code> so they can be fetched together with the current
+    /// block in a single vectored pread.
+    void add_prefetch_ranges(std::vector<Filesystem::ReadRange> &ranges);
+
+    /// Advances the key decompressor and value cursor to the next cell in
+    /// the current block, handling both interleaved and PAX layouts.  In
+    /// key-iteration mode the value cursor is left untouched (null).
+    void advance_in_block(const uint8_t *ptr) {
+      if (m_pax) {
+        m_key_ptr = m_key_decompressor->add(m_key_ptr);
+        if (!m_keys_only)
+          m_cur_value.ptr = ptr;
+      }
+      else
+        m_cur_value.ptr = m_key_decompressor->add(ptr);
+    }
+
+    /// Indicates if the current cell is the last one in the block.
+    /// <code>ptr</code> points just past the current cell's value; in
+    /// key-iteration mode the scan walks the key region alone, so the key
+    /// cursor is tested against the end of the key region instead.
+    bool at_block_end(const uint8_t *ptr) const {
+      return m_keys_only ? m_key_ptr >= m_key_end : ptr >= m_block.end;
+    }
+
     CellStorePtr          m_cellstore;
     IndexT               *m_index {};
     IndexIteratorT        m_iter;
@@ -73,11 +107,36 @@ namespace Hypertable {
     BlockCompressionCodec *m_zcodec {};
     KeyDecompressor      *m_key_decompressor {};
     int32_t               m_fd {-1};
+    const uint8_t        *m_restarts_base {};
+    uint32_t              m_restart_count {};
+    const uint8_t        *m_key_ptr {};
+    /// End of the current block's key region (PAX layout only)
+    const uint8_t        *m_key_end {};
+    bool                  m_pax {};
+    /// Key-iteration mode; set for keys-only scans over PAX blocks, in
+    /// which case the value region of each block is never touched
+    bool                  m_keys_only {};
+    bool                  m_prune_timestamps {};
     bool                  m_cached {};
     bool                  m_check_for_range_end {};
     int                   m_file_id {};
+    /// Block sampling period; when greater than 1 fetch_next_block() skips
+    /// period-1 blocks between visited blocks
+    int32_t               m_sample_period {};
     ScanContext          *m_scan_ctx {};
     ScanContext::CstrRowSet& m_rowset;
+
+    /// Compressed blocks prefetched by the last vectored pread, keyed by
+    /// file offset; the slices point into #m_prefetch_event's payload
+    std::map<uint64_t, std::pair<const uint8_t *, uint32_t>> m_prefetch;
+
+    /// Event holding the payload of the last vectored pread
+    EventPtr              m_prefetch_event;
+
+    /// Count of blocks loaded from disk by this scanner; once it exceeds a
+    /// small threshold the interval is treated as a sequential scan and
+    /// further blocks are admitted to the block cache on probation
+    uint32_t              m_blocks_loaded {};
   };
 
   /// @}
@@ -35,6 +35,7 @@
 
 #include <Common/Error.h>
 #include <Common/Filesystem.h>
+#include <Common/Serialization.h>
 #include <Common/System.h>
 
 #include <cassert>
@@ -55,6 +56,11 @@ CellStoreScannerIntervalReadahead<IndexT>::CellStoreScannerIntervalReadahead(Cel
   memset(&m_block, 0, sizeof(m_block));
   m_zcodec = m_cellstore->create_block_compression_codec();
   m_key_decompressor = m_cellstore->create_key_decompressor();
+  m_pax = m_cellstore->pax_layout();
+  // PAX blocks segregate keys from values, so a keys-only scan can iterate
+  // the key region alone and never touch the value bytes
+  m_keys_only = m_pax && scan_ctx->spec && scan_ctx->spec->keys_only &&
+    !scan_ctx->spec->value_regexp;
 
   uint16_t csversion = boost::any_cast<uint16_t>(cellstore->get_trailer()->get("version"));
   if (csversion >= 4)
@@ -92,6 +98,15 @@ CellStoreScannerIntervalReadahead<IndexT>::CellStoreScannerIntervalReadahead(Cel
   if (buf_size < MINIMUM_READAHEAD_AMOUNT)
     buf_size = MINIMUM_READAHEAD_AMOUNT;
 
+  // Reserve an allowance from the server-wide readahead budget; under
+  // heavy concurrency the grant shrinks toward a single block so that
+  // aggregate in-flight readahead stays bounded
+  if (Global::readahead_budget) {
+    m_readahead_grant =
+      Global::readahead_budget->acquire(buf_size, cellstore->get_blocksize());
+    buf_size = (uint32_t)m_readahead_grant;
+  }
+
   try {
     m_fd = Global::dfs->open_buffered(cellstore->get_filename(), m_oflags,
                                       buf_size, 5, start_offset, m_end_offset);
@@ -114,15 +129,15 @@ CellStoreScannerIntervalReadahead<IndexT>::CellStoreScannerIntervalReadahead(Cel
   if (start_key) {
     const uint8_t *ptr;
     while (m_key_decompressor->less_than(start_key)) {
-      ptr = m_cur_value.ptr + m_cur_value.length();
-      if (ptr >= m_block.end) {
+      ptr = m_keys_only ? 0 : m_cur_value.ptr + m_cur_value.length();
+      if (at_block_end(ptr)) {
         if (!fetch_next_block_readahead(true)) {
           m_eos = true;
           return;
         }
       }
       else
-        m_cur_value.ptr = m_key_decompressor->add(ptr);
+        advance_in_block(ptr);
     }
   }
 
@@ -147,6 +162,8 @@ CellStoreScannerIntervalReadahead<IndexT>::CellStoreScannerIntervalReadahead(Cel
 template <typename IndexT>
 CellStoreScannerIntervalReadahead<IndexT>::~CellStoreScannerIntervalReadahead() {
   try {
+    if (m_readahead_grant)
+      Global::readahead_budget->release(m_readahead_grant);
     if (m_fd != -1)
       Global::dfs->close(m_fd);
     delete [] m_block.base;
@@ -186,9 +203,9 @@ void CellStoreScannerIntervalReadahead<IndexT>::forward() {
     if (m_eos)
       return;
 
-    ptr = m_cur_value.ptr + m_cur_value.length();
+    ptr = m_keys_only ? 0 : m_cur_value.ptr + m_cur_value.length();
 
-    if (ptr >= m_block.end) {
+    if (at_block_end(ptr)) {
       if (!fetch_next_block_readahead(true)) {
         m_eos = true;
         return;
@@ -199,7 +216,7 @@ void CellStoreScannerIntervalReadahead<IndexT>::forward() {
       }
     }
     else {
-      m_cur_value.ptr = m_key_decompressor->add(ptr);
+      advance_in_block(ptr);
       if (m_check_for_range_end && !m_key_decompressor->less_than(m_end_key)) {
         m_eos = true;
         return;
@@ -217,6 +234,53 @@ void CellStoreScannerIntervalReadahead<IndexT>::forward() {
 }
 
 
+/**
+ * Batched counterpart to get()/forward().  Runs the block-local advance
+ * loop inline, appending each qualifying cell to <code>run</code>, and
+ * falls back to forward() whenever the scan leaves the current block or a
+ * cell fails the filter checks, so a run never pays more than one virtual
+ * call per block transition.
+ */
+template <typename IndexT>
+size_t
+CellStoreScannerIntervalReadahead<IndexT>::next_run(ScanRun &run,
+                                                    size_t limit) {
+  const uint8_t *ptr;
+  size_t count {};
+
+  while (count < limit) {
+
+    if (m_eos)
+      break;
+
+    run.add(m_key.serial, m_cur_value);
+    count++;
+
+    ptr = m_cur_value.ptr + m_cur_value.length();
+
+    if (ptr >= m_block.end) {
+      forward();
+      break;
+    }
+
+    advance_in_block(ptr);
+    if (m_check_for_range_end && !m_key_decompressor->less_than(m_end_key)) {
+      m_eos = true;
+      break;
+    }
+
+    m_key_decompressor->load(m_key);
+    if (m_key.flag != FLAG_DELETE_ROW &&
+        !m_scan_ctx->family_mask[m_key.column_family_code]) {
+      // Current cell is filtered out; let forward() skip past it
+      forward();
+      break;
+    }
+  }
+  return count;
+}
+
+
 
 
 /**
@@ -279,9 +343,15 @@ bool CellStoreScannerIntervalReadahead<IndexT>::fetch_next_block_readahead(bool
         m_check_for_range_end = true;
       m_offset += input_buf.fill();
 
-      m_zcodec->inflate(input_buf, expand_buf, header);
+      if (Global::decompression_pool)
+        Global::decompression_pool->inflate(m_zcodec, input_buf, expand_buf,
+                                            header);
+      else
+        m_zcodec->inflate(input_buf, expand_buf, header);
 
       m_disk_read += expand_buf.fill();
+      m_scan_ctx->bytes_decompressed += expand_buf.fill();
+      m_scan_ctx->blocks_read++;
 
       if (!header.check_magic(CellStore::DATA_BLOCK_MAGIC))
         HT_THROW(Error::BLOCK_COMPRESSOR_BAD_MAGIC,
@@ -299,9 +369,28 @@ bool CellStoreScannerIntervalReadahead<IndexT>::fetch_next_block_readahead(bool
     m_block.base = expand_buf.release(&fill);
     len = fill;
 
+    /** Strip restart-point trailer **/
+    if (m_cellstore->block_restarts() && len >= 8) {
+      const uint8_t *trailer = m_block.base + len - 4;
+      size_t remain = 4;
+      uint32_t restart_count = Serialization::decode_i32(&trailer, &remain);
+      len -= (restart_count + 1) * 4;
+    }
+
     m_key_decompressor->reset();
     m_block.end = m_block.base + len;
-    m_cur_value.ptr = m_key_decompressor->add(m_block.base);
+    if (m_pax) {
+      /** Key region length prefix, then keys, then values **/
+      const uint8_t *base = m_block.base;
+      size_t remain = 4;
+      uint32_t key_region_length = Serialization::decode_i32(&base, &remain);
+      m_key_ptr = m_key_decompressor->add(base);
+      m_key_end = base + key_region_length;
+      if (!m_keys_only)
+        m_cur_value.ptr = base + key_region_length;
+    }
+    else
+      m_cur_value.ptr = m_key_decompressor->add(m_block.base);
 
     return true;
   }
@@ -54,11 +54,33 @@ namespace Hypertable {
     virtual ~CellStoreScannerIntervalReadahead();
     virtual void forward();
     virtual bool get(Key &key, ByteString &value);
+    virtual size_t next_run(ScanRun &run, size_t limit);
 
   private:
 
     bool fetch_next_block_readahead(bool eob=false);
 
+    /// Advances the key decompressor and value cursor to the next cell in
+    /// the current block, handling both interleaved and PAX layouts.  In
+    /// key-iteration mode the value cursor is left untouched (null).
+    void advance_in_block(const uint8_t *ptr) {
+      if (m_pax) {
+        m_key_ptr = m_key_decompressor->add(m_key_ptr);
+        if (!m_keys_only)
+          m_cur_value.ptr = ptr;
+      }
+      else
+        m_cur_value.ptr = m_key_decompressor->add(ptr);
+    }
+
+    /// Indicates if the current cell is the last one in the block.
+    /// <code>ptr</code> points just past the current cell's value; in
+    /// key-iteration mode the scan walks the key region alone, so the key
+    /// cursor is tested against the end of the key region instead.
+    bool at_block_end(const uint8_t *ptr) const {
+      return m_keys_only ? m_key_ptr >= m_key_end : ptr >= m_block.end;
+    }
+
     CellStorePtr           m_cellstore;
     BlockInfo              m_block;
     Key                    m_key;
@@ -69,6 +91,14 @@ namespace Hypertable {
     int32_t                m_fd {-1};
     int64_t                m_offset {};
     int64_t                m_end_offset {};
+    int64_t                m_readahead_grant {};
+    const uint8_t         *m_key_ptr {};
+    /// End of the current block's key region (PAX layout only)
+    const uint8_t         *m_key_end {};
+    bool                   m_pax {};
+    /// Key-iteration mode; set for keys-only scans over PAX blocks, in
+    /// which case the value region of each block is never touched
+    bool                   m_keys_only {};
     bool                   m_check_for_range_end {};
     bool                   m_eos {};
     ScanContext           *m_scan_ctx {};
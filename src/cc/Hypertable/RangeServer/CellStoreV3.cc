@@ -99,7 +99,8 @@ KeyDecompressor *CellStoreV3::create_key_decompressor() {
 
 
 CellListScannerPtr CellStoreV3::create_scanner(ScanContext *scan_ctx) {
-  bool need_index =  m_restricted_range || scan_ctx->restricted_range || scan_ctx->single_row;
+  bool need_index =  m_restricted_range || scan_ctx->restricted_range ||
+    scan_ctx->single_row || scan_ctx->block_sample_period;
 
   if (need_index) {
     m_index_stats.block_index_access_counter = ++Global::access_counter;
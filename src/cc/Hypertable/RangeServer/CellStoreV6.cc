@@ -142,7 +142,8 @@ void CellStoreV6::populate_index_pseudo_table_scanner(CellListScannerBuffer *sca
 
 CellListScannerPtr CellStoreV6::create_scanner(ScanContext *scan_ctx) {
   bool need_index =  m_restricted_range || scan_ctx->restricted_range ||
-    scan_ctx->single_row || scan_ctx->has_cell_interval;
+    scan_ctx->single_row || scan_ctx->has_cell_interval ||
+    scan_ctx->block_sample_period;
 
   if (need_index) {
     lock_guard<mutex> lock(m_mutex);
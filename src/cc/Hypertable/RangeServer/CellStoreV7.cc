@@ -26,6 +26,7 @@
  */
 
 #include "Common/Compat.h"
+#include <algorithm>
 #include <cassert>
 
 #include <boost/algorithm/string.hpp>
@@ -80,6 +81,8 @@ CellStoreV7::CellStoreV7(Filesystem *filesys, SchemaPtr &schema)
 
 CellStoreV7::~CellStoreV7() {
   try {
+    delete m_pipeline;
+    delete m_writer;
     delete m_compressor;
     delete m_bloom_filter;
     delete m_bloom_filter_items;
@@ -91,6 +94,9 @@ CellStoreV7::~CellStoreV7() {
     HT_ERROR_OUT << e << HT_END;
   }
 
+  if (Global::block_cache)
+    Global::block_cache->unregister_file(m_file_id);
+
   Global::memory_tracker->subtract( sizeof(CellStoreV7) + sizeof(CellStoreInfo) + m_index_stats.bloom_filter_memory + m_index_stats.block_index_memory );
 
 }
@@ -105,6 +111,118 @@ KeyDecompressor *CellStoreV7::create_key_decompressor() {
   return new KeyDecompressorPrefix();
 }
 
+bool CellStoreV7::get_max_row(String &row) {
+  lock_guard<mutex> lock(m_mutex);
+  if (m_index_stats.block_index_memory == 0)
+    load_block_index();
+  SerializedKey key = m_64bit_index ? m_index_map64.last_key()
+                                    : m_index_map32.last_key();
+  if (!key.ptr)
+    return false;
+  row = key.row();
+  return true;
+}
+
+int64_t CellStoreV7::prewarm_blocks(int64_t max_bytes) {
+  vector<pair<int64_t, int64_t>> blocks;
+  vector<pair<int64_t, int64_t>> extents;
+  int64_t inserted = 0;
+
+  if (Global::block_cache == 0)
+    return 0;
+
+  // Extents persisted by the previous process (see
+  // FileBlockCache::persist_index) reconstruct the exact resident set and
+  // are already bounded by the old cache limit, so the byte budget only
+  // constrains the sequential fallback walk
+  bool exact = Global::block_cache->get_warmup_extents(m_filename, extents);
+
+  if (!exact && max_bytes <= 0)
+    return 0;
+
+  {
+    lock_guard<mutex> lock(m_mutex);
+    if (m_index_stats.block_index_memory == 0)
+      load_block_index();
+    if (m_bloom_filter_mode != BLOOM_FILTER_DISABLED &&
+        m_index_stats.bloom_filter_memory == 0)
+      load_bloom_filter();
+    if (m_64bit_index)
+      m_index_map64.get_block_offsets(blocks);
+    else
+      m_index_map32.get_block_offsets(blocks);
+  }
+
+  if (exact) {
+    // Keep only the blocks that were resident at shutdown.  Offsets are
+    // validated against the current block index, which also supplies the
+    // on-disk length (the persisted length is the in-cache length and
+    // differs when the cache stores inflated blocks)
+    vector<int64_t> offsets;
+    offsets.reserve(extents.size());
+    for (auto &extent : extents)
+      offsets.push_back(extent.first);
+    sort(offsets.begin(), offsets.end());
+    vector<pair<int64_t, int64_t>> resident;
+    for (auto &block : blocks) {
+      if (binary_search(offsets.begin(), offsets.end(), block.first))
+        resident.push_back(block);
+    }
+    blocks.swap(resident);
+  }
+
+  BlockCompressionCodec *codec = 0;
+
+  try {
+    for (auto &block : blocks) {
+      if (!exact && inserted >= max_bytes)
+        break;
+      if (Global::block_cache->contains(m_file_id, block.first))
+        continue;
+      DynamicBuffer buf(block.second);
+      size_t nread = m_filesys->pread(m_fd, buf.base, block.second,
+                                      block.first, false);
+      if ((int64_t)nread != block.second)
+        break;
+      buf.ptr = buf.base + block.second;
+      if (Global::block_cache->compressed()) {
+        size_t fill;
+        uint8_t *base = buf.release(&fill);
+        if (!Global::block_cache->insert(m_file_id, block.first, base,
+                                         block.second, EventPtr(), false)) {
+          delete [] base;
+          break;
+        }
+        inserted += block.second;
+      }
+      else {
+        DynamicBuffer expand_buf;
+        BlockHeaderCellStore header(block_header_format());
+        if (codec == 0)
+          codec = create_block_compression_codec();
+        codec->inflate(buf, expand_buf, header);
+        if (!header.check_magic(DATA_BLOCK_MAGIC))
+          HT_THROW(Error::BLOCK_COMPRESSOR_BAD_MAGIC,
+                   "Error inflating cell store block - magic string mismatch");
+        size_t fill;
+        uint8_t *base = expand_buf.release(&fill);
+        if (!Global::block_cache->insert(m_file_id, block.first, base,
+                                         (uint32_t)fill, EventPtr(), false)) {
+          delete [] base;
+          break;
+        }
+        inserted += fill;
+      }
+    }
+  }
+  catch (Exception &e) {
+    HT_WARNF("Problem prewarming block cache from %s - %s",
+             m_filename.c_str(), Error::get_text(e.code()));
+  }
+  delete codec;
+  return inserted;
+}
+
 void CellStoreV7::split_row_estimate_data(SplitRowDataMapT &split_row_data) {
   lock_guard<mutex> lock(m_mutex);
   if (m_index_stats.block_index_memory == 0)
@@ -113,11 +231,14 @@ void CellStoreV7::split_row_estimate_data(SplitRowDataMapT &split_row_data) {
     HT_WARNF("%s has 0 index entries", m_filename.c_str());
     return;
   }
-  int32_t keys_per_block = (int32_t)(m_trailer.total_entries / m_trailer.index_entries);
+  // Weight each index sample by the disk usage of its block so that the
+  // split point lands at the midpoint of the data, not of the block count
+  double keys_per_byte =
+    (double)m_trailer.total_entries / (double)m_trailer.fix_index_offset;
   if (m_64bit_index)
-    m_index_map64.unique_row_count_estimate(split_row_data, keys_per_block);
+    m_index_map64.disk_weighted_row_count_estimate(split_row_data, keys_per_byte);
   else
-    m_index_map32.unique_row_count_estimate(split_row_data, keys_per_block);
+    m_index_map32.disk_weighted_row_count_estimate(split_row_data, keys_per_byte);
 }
 
 void CellStoreV7::populate_index_pseudo_table_scanner(CellListScannerBuffer *scanner) {
@@ -142,7 +263,8 @@ void CellStoreV7::populate_index_pseudo_table_scanner(CellListScannerBuffer *sca
 
 CellListScannerPtr CellStoreV7::create_scanner(ScanContext *scan_ctx) {
   bool need_index =  m_restricted_range || scan_ctx->restricted_range ||
-    scan_ctx->single_row || scan_ctx->has_cell_interval;
+    scan_ctx->single_row || scan_ctx->has_cell_interval ||
+    scan_ctx->block_sample_period;
 
   if (need_index) {
     lock_guard<mutex> lock(m_mutex);
@@ -230,6 +352,9 @@ CellStoreV7::create(const char *fname, size_t max_entries,
 
   m_filename = fname;
 
+  if (Global::block_cache)
+    Global::block_cache->register_file(m_file_id, m_filename);
+
   m_start_row = "";
   m_end_row = Key::END_ROW_MARKER;
 
@@ -243,6 +368,17 @@ CellStoreV7::create(const char *fname, size_t max_entries,
   uint32_t oflags = Filesystem::OPEN_FLAG_DIRECTIO|Filesystem::OPEN_FLAG_OVERWRITE;
   m_fd = m_filesys->create(m_filename, oflags, -1, replication, -1);
 
+  m_writer = new FsBroker::Lib::ClientBufferedWriterHandler(m_filesys, m_fd,
+                                                            MAX_APPENDS_OUTSTANDING);
+
+  int32_t compression_workers =
+    Config::get_i32("Hypertable.RangeServer.CellStore.CompressionWorkers");
+  if (compression_workers > 0)
+    m_pipeline = new BlockCompressionPipeline(
+        (BlockCompressionCodec::Type)m_trailer.compression_type,
+        m_compressor_args, BLOCK_HEADER_VERSION, DATA_BLOCK_MAGIC,
+        (size_t)compression_workers);
+
   m_bloom_filter_mode = props->get<BloomFilterMode>("bloom-filter-mode");
   m_max_approx_items = props->get_i32("max-approx-items");
 
@@ -443,8 +579,30 @@ uint64_t CellStoreV7::purge_indexes() {
 
 
 
+void CellStoreV7::write_compressed_block(BlockCompressionPipeline::CompressedBlock &block) {
+
+  m_index_builder.add_entry(block.key, m_offset);
+
+  m_uncompressed_data += (float)block.uncompressed_len;
+  m_compressed_data += (float)block.compressed_len;
+
+  uint64_t llval = ((uint64_t)m_trailer.blocksize
+      * (uint64_t)m_uncompressed_data) / (uint64_t)m_compressed_data;
+  m_uncompressed_blocksize = (int64_t)llval;
+
+  size_t zlen = block.zbuf.fill();
+  StaticBuffer send_buf(block.zbuf);
+
+  try { m_writer->append(send_buf, Filesystem::Flags::NONE); }
+  catch (Exception &e) {
+    HT_THROW2F(e.code(), e, "Problem writing to FS file '%s'",
+               m_filename.c_str());
+  }
+  m_offset += zlen;
+}
+
+
 void CellStoreV7::add(const Key &key, const ByteString value) {
-  EventPtr event_ptr;
   DynamicBuffer zbuf;
 
   if (key.revision > m_trailer.revision)
@@ -458,46 +616,51 @@ void CellStoreV7::add(const Key &key, const ByteString value) {
   }
 
   if (m_buffer.fill() > (size_t)m_uncompressed_blocksize) {
-    BlockHeaderCellStore header(BLOCK_HEADER_VERSION, DATA_BLOCK_MAGIC);
-
-    m_index_builder.add_entry(m_key_compressor, m_offset);
 
-    m_uncompressed_data += (float)m_buffer.fill();
-    m_compressor->deflate(m_buffer, zbuf, header, HT_DIRECT_IO_ALIGNMENT);
-    m_compressed_data += (float)zbuf.fill();
-    m_buffer.clear();
-
-    uint64_t llval = ((uint64_t)m_trailer.blocksize
-        * (uint64_t)m_uncompressed_data) / (uint64_t)m_compressed_data;
-    m_uncompressed_blocksize = (int64_t)llval;
-
-    if (m_outstanding_appends >= MAX_APPENDS_OUTSTANDING) {
-      if (!m_sync_handler.wait_for_reply(event_ptr)) {
-        if (event_ptr->type == Event::MESSAGE)
-          HT_THROWF(Hypertable::Protocol::response_code(event_ptr),
-             "Problem writing to FS file '%s' : %s", m_filename.c_str(),
-             Hypertable::Protocol::string_format_message(event_ptr).c_str());
-        HT_THROWF(event_ptr->error,
-                  "Problem writing to FS file '%s'", m_filename.c_str());
-      }
-      m_outstanding_appends--;
+    if (m_pipeline) {
+      // Snapshot the index key and hand the block to the compression
+      // workers; index entries, stats, and appends happen in
+      // write_compressed_block() as blocks come back in submission order
+      DynamicBuffer key_buf(m_key_compressor->length_uncompressed());
+      m_key_compressor->write_uncompressed(key_buf.ptr);
+      key_buf.ptr += m_key_compressor->length_uncompressed();
+
+      BlockCompressionPipeline::CompressedBlock completed;
+      if (m_pipeline->submit(m_buffer, key_buf, completed))
+        write_compressed_block(completed);
+      m_buffer.reserve((size_t)m_uncompressed_blocksize + 4096);
     }
+    else {
+      BlockHeaderCellStore header(BLOCK_HEADER_VERSION, DATA_BLOCK_MAGIC);
 
-    if (!HT_IO_ALIGNED(zbuf.fill())) {
-      memset(zbuf.ptr, 0, HT_IO_ALIGNMENT_PADDING(zbuf.fill()));
-      zbuf.ptr += HT_IO_ALIGNMENT_PADDING(zbuf.fill());
-    }
+      m_index_builder.add_entry(m_key_compressor, m_offset);
 
-    size_t zlen = zbuf.fill();
-    StaticBuffer send_buf(zbuf);
+      m_uncompressed_data += (float)m_buffer.fill();
+      m_compressor->deflate(m_buffer, zbuf, header, HT_DIRECT_IO_ALIGNMENT);
+      m_compressed_data += (float)zbuf.fill();
+      m_buffer.clear();
 
-    try { m_filesys->append(m_fd, send_buf, Filesystem::Flags::NONE, &m_sync_handler); }
-    catch (Exception &e) {
-      HT_THROW2F(e.code(), e, "Problem writing to FS file '%s'",
-                 m_filename.c_str());
+      uint64_t llval = ((uint64_t)m_trailer.blocksize
+          * (uint64_t)m_uncompressed_data) / (uint64_t)m_compressed_data;
+      m_uncompressed_blocksize = (int64_t)llval;
+
+      if (!HT_IO_ALIGNED(zbuf.fill())) {
+        memset(zbuf.ptr, 0, HT_IO_ALIGNMENT_PADDING(zbuf.fill()));
+        zbuf.ptr += HT_IO_ALIGNMENT_PADDING(zbuf.fill());
+      }
+
+      size_t zlen = zbuf.fill();
+      StaticBuffer send_buf(zbuf);
+
+      // The writer keeps a window of appends in flight, so compression of
+      // the next block overlaps the write of this one
+      try { m_writer->append(send_buf, Filesystem::Flags::NONE); }
+      catch (Exception &e) {
+        HT_THROW2F(e.code(), e, "Problem writing to FS file '%s'",
+                   m_filename.c_str());
+      }
+      m_offset += zlen;
     }
-    m_outstanding_appends++;
-    m_offset += zlen;
     m_key_compressor->reset();
   }
 
@@ -555,13 +718,22 @@ void CellStoreV7::add(const Key &key, const ByteString value) {
 
 
 void CellStoreV7::finalize(TableIdentifier *table_identifier) {
-  EventPtr event_ptr;
   size_t zlen;
   DynamicBuffer zbuf(0);
   SerializedKey key;
   StaticBuffer send_buf;
   int64_t index_memory = 0;
 
+  // Drain any blocks still making their way through the compression
+  // pipeline so that the final partial block lands after them
+  if (m_pipeline) {
+    BlockCompressionPipeline::CompressedBlock completed;
+    while (m_pipeline->retrieve(completed))
+      write_compressed_block(completed);
+    delete m_pipeline;
+    m_pipeline = 0;
+  }
+
   if (m_buffer.fill() > 0) {
     BlockHeaderCellStore header(BLOCK_HEADER_VERSION, DATA_BLOCK_MAGIC);
 
@@ -578,18 +750,11 @@ void CellStoreV7::finalize(TableIdentifier *table_identifier) {
     zlen = zbuf.fill();
     send_buf = zbuf;
 
-    if (m_outstanding_appends >= MAX_APPENDS_OUTSTANDING) {
-      if (!m_sync_handler.wait_for_reply(event_ptr))
-        HT_THROWF(Protocol::response_code(event_ptr),
-                  "Problem finalizing CellStore file '%s' : %s",
-                  m_filename.c_str(),
-                  Protocol::string_format_message(event_ptr).c_str());
-      m_outstanding_appends--;
+    try { m_writer->append(send_buf, Filesystem::Flags::NONE); }
+    catch (Exception &e) {
+      HT_THROW2F(e.code(), e, "Problem finalizing CellStore file '%s'",
+                 m_filename.c_str());
     }
-
-    m_filesys->append(m_fd, send_buf, Filesystem::Flags::NONE, &m_sync_handler);
-
-    m_outstanding_appends++;
     m_offset += zlen;
   }
 
@@ -625,9 +790,8 @@ void CellStoreV7::finalize(TableIdentifier *table_identifier) {
   zlen = zbuf.fill();
   send_buf = zbuf;
 
-  m_filesys->append(m_fd, send_buf, Filesystem::Flags::NONE, &m_sync_handler);
+  m_writer->append(send_buf, Filesystem::Flags::NONE);
 
-  m_outstanding_appends++;
   m_offset += zlen;
 
   /**
@@ -649,9 +813,8 @@ void CellStoreV7::finalize(TableIdentifier *table_identifier) {
   zlen = zbuf.fill();
   send_buf = zbuf;
 
-  m_filesys->append(m_fd, send_buf, Filesystem::Flags::NONE, &m_sync_handler);
+  m_writer->append(send_buf, Filesystem::Flags::NONE);
 
-  m_outstanding_appends++;
   m_offset += zlen;
 
   // write filter_offset
@@ -672,8 +835,7 @@ void CellStoreV7::finalize(TableIdentifier *table_identifier) {
       m_trailer.bloom_filter_mode = m_bloom_filter_mode;
       m_trailer.bloom_filter_hash_count = m_bloom_filter->get_num_hashes();
       m_bloom_filter->serialize(send_buf);
-      m_filesys->append(m_fd, send_buf, Filesystem::Flags::NONE, &m_sync_handler);
-      m_outstanding_appends++;
+      m_writer->append(send_buf, Filesystem::Flags::NONE);
       m_offset += m_bloom_filter->total_size();
     }
   }
@@ -713,8 +875,7 @@ void CellStoreV7::finalize(TableIdentifier *table_identifier) {
       zbuf.ptr += HT_IO_ALIGNMENT_PADDING(zbuf.fill());
     }
     send_buf = zbuf;
-    m_filesys->append(m_fd, send_buf, Filesystem::Flags::NONE, &m_sync_handler);
-    m_outstanding_appends++;
+    m_writer->append(send_buf, Filesystem::Flags::NONE);
     zlen = zbuf.fill();
     m_offset += zlen;
   }
@@ -774,9 +935,14 @@ void CellStoreV7::finalize(TableIdentifier *table_identifier) {
   zlen = zbuf.fill();
   send_buf = zbuf;
 
+  // Drain the append window so any pending write error surfaces before the
+  // trailer is written
+  m_writer->flush();
+  delete m_writer;
+  m_writer = 0;
+
   m_filesys->append(m_fd, send_buf);
 
-  m_outstanding_appends++;
   m_offset += zlen;
 
   /** close file for writing **/
@@ -803,33 +969,24 @@ void CellStoreV7::finalize(TableIdentifier *table_identifier) {
 }
 
 
-void CellStoreV7::IndexBuilder::add_entry(KeyCompressorPtr &key_compressor,
-                                          int64_t offset) {
-
-  // switch to 64-bit offsets if offset being added is >= 2^32
-  if (!m_bigint && offset >= 4294967296LL) {
-    DynamicBuffer tmp_buf(m_fixed.size*2);
-    const uint8_t *src = m_fixed.base;
-    uint8_t *dst = tmp_buf.base;
-    size_t remaining = m_fixed.fill();
-    while (src < m_fixed.ptr)
-      Serialization::encode_i64(&dst, (uint64_t)Serialization::decode_i32(&src, &remaining));
-    delete [] m_fixed.release();
-    m_fixed.base = tmp_buf.base;
-    m_fixed.ptr = dst;
-    m_fixed.size = tmp_buf.size;
-    m_fixed.own = true;
-    tmp_buf.release();
-    m_bigint = true;
-  }
-
-  // Add key to variable buffer
-  size_t key_len = key_compressor->length_uncompressed();
-  m_variable.ensure(key_len);
-  key_compressor->write_uncompressed(m_variable.ptr);
-  m_variable.ptr += key_len;
+void CellStoreV7::IndexBuilder::widen_offsets() {
+  DynamicBuffer tmp_buf(m_fixed.size*2);
+  const uint8_t *src = m_fixed.base;
+  uint8_t *dst = tmp_buf.base;
+  size_t remaining = m_fixed.fill();
+  while (src < m_fixed.ptr)
+    Serialization::encode_i64(&dst, (uint64_t)Serialization::decode_i32(&src, &remaining));
+  delete [] m_fixed.release();
+  m_fixed.base = tmp_buf.base;
+  m_fixed.ptr = dst;
+  m_fixed.size = tmp_buf.size;
+  m_fixed.own = true;
+  tmp_buf.release();
+  m_bigint = true;
+}
 
-    // Serialize offset into fix index buffer
+void CellStoreV7::IndexBuilder::append_offset(int64_t offset) {
+  // Serialize offset into fix index buffer
   if (m_bigint) {
     m_fixed.ensure(8);
     memcpy(m_fixed.ptr, &offset, 8);
@@ -842,6 +999,36 @@ void CellStoreV7::IndexBuilder::add_entry(KeyCompressorPtr &key_compressor,
   }
 }
 
+void CellStoreV7::IndexBuilder::add_entry(KeyCompressorPtr &key_compressor,
+                                          int64_t offset) {
+
+  // switch to 64-bit offsets if offset being added is >= 2^32
+  if (!m_bigint && offset >= 4294967296LL)
+    widen_offsets();
+
+  // Add key to variable buffer
+  size_t key_len = key_compressor->length_uncompressed();
+  m_variable.ensure(key_len);
+  key_compressor->write_uncompressed(m_variable.ptr);
+  m_variable.ptr += key_len;
+
+  append_offset(offset);
+}
+
+void CellStoreV7::IndexBuilder::add_entry(const DynamicBuffer &key_buf,
+                                          int64_t offset) {
+
+  // switch to 64-bit offsets if offset being added is >= 2^32
+  if (!m_bigint && offset >= 4294967296LL)
+    widen_offsets();
+
+  // Add key to variable buffer
+  m_variable.ensure(key_buf.fill());
+  m_variable.add_unchecked(key_buf.base, key_buf.fill());
+
+  append_offset(offset);
+}
+
 
 void CellStoreV7::IndexBuilder::chop() {
   uint8_t *base;
@@ -870,6 +1057,9 @@ CellStoreV7::open(const String &fname, const String &start_row,
   m_fd = fd;
   m_file_length = file_length;
 
+  if (Global::block_cache)
+    Global::block_cache->register_file(m_file_id, m_filename);
+
   m_restricted_range = !(m_start_row == "" && m_end_row == Key::END_ROW_MARKER);
 
   m_trailer = *static_cast<CellStoreTrailerV7 *>(trailer);
@@ -28,6 +28,7 @@
 #ifndef Hypertable_RangeServer_CellStoreV7_h
 #define Hypertable_RangeServer_CellStoreV7_h
 
+#include "BlockCompressionPipeline.h"
 #include "CellStore.h"
 #include "CellStoreBlockIndexArray.h"
 #include "CellStoreTrailerV7.h"
@@ -36,7 +37,7 @@
 #include <Hypertable/Lib/BlockCompressionCodec.h>
 #include <Hypertable/Lib/SerializedKey.h>
 
-#include <AsyncComm/DispatchHandlerSynchronizer.h>
+#include <FsBroker/Lib/ClientBufferedWriterHandler.h>
 
 #include <Common/BlobHashSet.h>
 #include <Common/BloomFilterWithChecksum.h>
@@ -64,12 +65,15 @@ namespace Hypertable {
     public:
       IndexBuilder() : m_bigint(false) { }
       void add_entry(KeyCompressorPtr &key_compressor, int64_t offset);
+      void add_entry(const DynamicBuffer &key_buf, int64_t offset);
       DynamicBuffer &fixed_buf() { return m_fixed; }
       DynamicBuffer &variable_buf() { return m_variable; }
       bool big_int() { return m_bigint; }
       void chop();
       void release_fixed_buf() { delete [] m_fixed.release(); }
     private:
+      void widen_offsets();
+      void append_offset(int64_t offset);
       DynamicBuffer m_fixed;
       DynamicBuffer m_variable;
       bool m_bigint;
@@ -93,6 +97,8 @@ namespace Hypertable {
     uint64_t disk_usage() override { return m_disk_usage; }
     float compression_ratio() override { return m_trailer.compression_ratio; }
     void split_row_estimate_data(SplitRowDataMapT &split_row_data) override;
+    bool get_max_row(String &row) override;
+    int64_t prewarm_blocks(int64_t max_bytes) override;
 
     /** Populates <code>scanner</code> with key/value pairs generated from
      * CellStore index.  This method will first load the CellStore block 
@@ -155,6 +161,7 @@ namespace Hypertable {
     void load_bloom_filter();
     void load_block_index();
     void load_replaced_files();
+    void write_compressed_block(BlockCompressionPipeline::CompressedBlock &block);
 
     typedef BlobHashSet<> BloomFilterItems;
 
@@ -167,8 +174,8 @@ namespace Hypertable {
     BlockCompressionCodec *m_compressor {};
     DynamicBuffer m_buffer;
     IndexBuilder m_index_builder;
-    DispatchHandlerSynchronizer m_sync_handler;
-    uint32_t m_outstanding_appends {};
+    FsBroker::Lib::ClientBufferedWriterHandler *m_writer {};
+    BlockCompressionPipeline *m_pipeline {};
     int64_t m_offset {};
     int64_t m_file_length {};
     int64_t m_disk_usage {};
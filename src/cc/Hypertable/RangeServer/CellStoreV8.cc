@@ -0,0 +1,1802 @@
+/*
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 3 of the
+ * License.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/** @file
+ * Definitions for CellStoreV8.
+ * This file contains the variable and method definitions for CellStoreV8, a
+ * class for creating and loading version 8 cell store files.
+ */
+
+#include "Common/Compat.h"
+#include <algorithm>
+#include <cassert>
+
+#include <boost/algorithm/string.hpp>
+#include <boost/scoped_array.hpp>
+
+#include "Common/Config.h"
+#include "Common/Error.h"
+#include "Common/Logger.h"
+#include "Common/System.h"
+#include "Common/StringCompressorPrefix.h"
+#include "Common/StringDecompressorPrefix.h"
+#include "Common/Time.h"
+
+#include "AsyncComm/Protocol.h"
+
+#include "Hypertable/Lib/BlockHeaderCellStore.h"
+#include "Hypertable/Lib/CompressorFactory.h"
+#include "Hypertable/Lib/Key.h"
+#include "Hypertable/Lib/ScanSpec.h"
+#include "Hypertable/Lib/Schema.h"
+
+#include "CellStoreV8.h"
+#include "CellStoreInfo.h"
+#include "CellStoreTrailerV8.h"
+#include "CellStoreScanner.h"
+
+#include "FileBlockCache.h"
+#include "Global.h"
+#include "Config.h"
+#include "KeyCompressorPrefix.h"
+#include "KeyDecompressorPrefix.h"
+
+using namespace std;
+using namespace Hypertable;
+
+namespace {
+  const uint32_t MAX_APPENDS_OUTSTANDING = 3;
+  const uint16_t BLOCK_HEADER_VERSION = 2;
+
+  /// Maximum number of value dictionary entries (codes are 16 bits)
+  const size_t VALUE_DICT_MAX_ENTRIES = 65536;
+}
+
+
+CellStoreV8::CellStoreV8(Filesystem *filesys)
+  : m_filesys(filesys) {
+  m_file_id = FileBlockCache::get_next_file_id();
+  assert(sizeof(float) == 4);
+}
+
+CellStoreV8::CellStoreV8(Filesystem *filesys, SchemaPtr &schema)
+  : m_filesys(filesys), m_schema(schema) {
+  m_file_id = FileBlockCache::get_next_file_id();
+  assert(sizeof(float) == 4);
+}
+
+CellStoreV8::~CellStoreV8() {
+  try {
+    delete m_compressor;
+    delete m_bloom_filter;
+    delete m_bloom_filter_items;
+    if (m_fd != -1)
+      m_filesys->close(m_fd);
+    delete [] m_column_ttl;
+  }
+  catch (Exception &e) {
+    HT_ERROR_OUT << e << HT_END;
+  }
+
+  if (Global::block_cache)
+    Global::block_cache->unregister_file(m_file_id);
+
+  Global::memory_tracker->subtract( sizeof(CellStoreV8) + sizeof(CellStoreInfo) + m_index_stats.bloom_filter_memory + m_index_stats.block_index_memory );
+
+}
+
+
+BlockCompressionCodec *CellStoreV8::create_block_compression_codec() {
+  BlockCompressionCodec *codec = CompressorFactory::create_block_codec(
+      (BlockCompressionCodec::Type)m_trailer.compression_type);
+  if (m_trailer.codec_dict_length > 0) {
+    lock_guard<mutex> lock(m_mutex);
+    if (m_codec_dict_buf.fill() == 0)
+      load_codec_dictionary();
+    codec->set_dictionary(m_codec_dict_buf.base, m_codec_dict_buf.fill());
+  }
+  return codec;
+}
+
+KeyDecompressor *CellStoreV8::create_key_decompressor() {
+  return new KeyDecompressorPrefix();
+}
+
+bool CellStoreV8::get_max_row(String &row) {
+  lock_guard<mutex> lock(m_mutex);
+  if (m_index_stats.block_index_memory == 0)
+    load_block_index();
+  SerializedKey key = m_64bit_index ? m_index_map64.last_key()
+                                    : m_index_map32.last_key();
+  if (!key.ptr)
+    return false;
+  row = key.row();
+  return true;
+}
+
+int64_t CellStoreV8::prewarm_blocks(int64_t max_bytes) {
+  vector<pair<int64_t, int64_t>> blocks;
+  vector<pair<int64_t, int64_t>> extents;
+  int64_t inserted = 0;
+
+  if (Global::block_cache == 0)
+    return 0;
+
+  // Extents persisted by the previous process (see
+  // FileBlockCache::persist_index) reconstruct the exact resident set and
+  // are already bounded by the old cache limit, so the byte budget only
+  // constrains the sequential fallback walk
+  bool exact = Global::block_cache->get_warmup_extents(m_filename, extents);
+
+  if (!exact && max_bytes <= 0)
+    return 0;
+
+  {
+    lock_guard<mutex> lock(m_mutex);
+    if (m_index_stats.block_index_memory == 0)
+      load_block_index();
+    if (m_bloom_filter_mode != BLOOM_FILTER_DISABLED &&
+        m_index_stats.bloom_filter_memory == 0)
+      load_bloom_filter();
+    if (m_64bit_index)
+      m_index_map64.get_block_offsets(blocks);
+    else
+      m_index_map32.get_block_offsets(blocks);
+  }
+
+  if (exact) {
+    // Keep only the blocks that were resident at shutdown.  Offsets are
+    // validated against the current block index, which also supplies the
+    // on-disk length (the persisted length is the in-cache length and
+    // differs when the cache stores inflated blocks)
+    vector<int64_t> offsets;
+    offsets.reserve(extents.size());
+    for (auto &extent : extents)
+      offsets.push_back(extent.first);
+    sort(offsets.begin(), offsets.end());
+    vector<pair<int64_t, int64_t>> resident;
+    for (auto &block : blocks) {
+      if (binary_search(offsets.begin(), offsets.end(), block.first))
+        resident.push_back(block);
+    }
+    blocks.swap(resident);
+  }
+
+  BlockCompressionCodec *codec = 0;
+
+  try {
+    for (auto &block : blocks) {
+      if (!exact && inserted >= max_bytes)
+        break;
+      if (Global::block_cache->contains(m_file_id, block.first))
+        continue;
+      DynamicBuffer buf(block.second);
+      size_t nread = m_filesys->pread(m_fd, buf.base, block.second,
+                                      block.first, false);
+      if ((int64_t)nread != block.second)
+        break;
+      buf.ptr = buf.base + block.second;
+      if (Global::block_cache->compressed()) {
+        size_t fill;
+        uint8_t *base = buf.release(&fill);
+        if (!Global::block_cache->insert(m_file_id, block.first, base,
+                                         block.second, EventPtr(), false)) {
+          delete [] base;
+          break;
+        }
+        inserted += block.second;
+      }
+      else {
+        DynamicBuffer expand_buf;
+        BlockHeaderCellStore header(block_header_format());
+        if (codec == 0)
+          codec = create_block_compression_codec();
+        codec->inflate(buf, expand_buf, header);
+        if (!header.check_magic(DATA_BLOCK_MAGIC))
+          HT_THROW(Error::BLOCK_COMPRESSOR_BAD_MAGIC,
+                   "Error inflating cell store block - magic string mismatch");
+        size_t fill;
+        uint8_t *base = expand_buf.release(&fill);
+        if (!Global::block_cache->insert(m_file_id, block.first, base,
+                                         (uint32_t)fill, EventPtr(), false)) {
+          delete [] base;
+          break;
+        }
+        inserted += fill;
+      }
+    }
+  }
+  catch (Exception &e) {
+    HT_WARNF("Problem prewarming block cache from %s - %s",
+             m_filename.c_str(), Error::get_text(e.code()));
+  }
+  delete codec;
+  return inserted;
+}
+
+void CellStoreV8::split_row_estimate_data(SplitRowDataMapT &split_row_data) {
+  lock_guard<mutex> lock(m_mutex);
+  if (m_index_stats.block_index_memory == 0)
+    load_block_index();
+  if (m_trailer.index_entries == 0) {
+    HT_WARNF("%s has 0 index entries", m_filename.c_str());
+    return;
+  }
+  // Weight each index sample by the disk usage of its block so that the
+  // split point lands at the midpoint of the data, not of the block count
+  double keys_per_byte =
+    (double)m_trailer.total_entries / (double)m_trailer.fix_index_offset;
+  if (m_64bit_index)
+    m_index_map64.disk_weighted_row_count_estimate(split_row_data, keys_per_byte);
+  else
+    m_index_map32.disk_weighted_row_count_estimate(split_row_data, keys_per_byte);
+}
+
+void CellStoreV8::populate_index_pseudo_table_scanner(CellListScannerBuffer *scanner) {
+  lock_guard<mutex> lock(m_mutex);
+  if (m_index_stats.block_index_memory == 0) {
+    load_block_index();
+    scanner->add_disk_read(m_trailer.filter_offset-m_trailer.fix_index_offset);
+  }
+  if (m_trailer.index_entries == 0) {
+    HT_WARNF("%s has 0 index entries", m_filename.c_str());
+    return;
+  }
+  int32_t keys_per_block = m_trailer.total_entries / m_trailer.index_entries;
+  if (m_64bit_index)
+    m_index_map64.populate_pseudo_table_scanner(scanner, m_filename,
+                             keys_per_block, m_trailer.compression_ratio);
+  else
+    m_index_map32.populate_pseudo_table_scanner(scanner, m_filename,
+                             keys_per_block, m_trailer.compression_ratio);
+}
+
+
+CellListScannerPtr CellStoreV8::create_scanner(ScanContext *scan_ctx) {
+  bool need_index =  m_restricted_range || scan_ctx->restricted_range ||
+    scan_ctx->single_row || scan_ctx->has_cell_interval ||
+    scan_ctx->block_sample_period;
+
+  if (need_index) {
+    lock_guard<mutex> lock(m_mutex);
+    m_index_stats.block_index_access_counter = ++Global::access_counter;
+    if (m_index_stats.block_index_memory == 0)
+      load_block_index();
+    m_index_refcount++;
+  }
+
+  if (m_64bit_index)
+    return make_shared<CellStoreScanner<CellStoreBlockIndexArray<int64_t>>>(shared_from_this(), scan_ctx, need_index ? &m_index_map64 : 0);
+  return make_shared<CellStoreScanner<CellStoreBlockIndexArray<uint32_t>>>(shared_from_this(), scan_ctx, need_index ? &m_index_map32 : 0);
+}
+
+namespace {
+  int get_replication(PropertiesPtr &props, const TableIdentifier *table_id) {
+
+    int32_t replication = props->get_i32("replication", int32_t(-1));
+
+    if (replication == -1 && table_id) {
+      if (table_id->is_user()) {
+	if (Config::has("Hypertable.RangeServer.Data.DefaultReplication"))
+	  replication = Config::get_i32("Hypertable.RangeServer.Data.DefaultReplication");
+      }
+      else if (Config::has("Hypertable.Metadata.Replication"))
+	replication = Config::get_i32("Hypertable.Metadata.Replication");
+    }
+
+    return replication;
+  }
+}
+
+void
+CellStoreV8::create(const char *fname, size_t max_entries,
+                    PropertiesPtr &props, const TableIdentifier *table_id) {
+  int64_t blocksize = props->get("blocksize", 0);
+  String compressor = props->get("compressor", String());
+
+  m_key_compressor = make_shared<KeyCompressorPrefix>();
+
+  assert(Config::properties); // requires Config::init* first
+  int32_t replication = get_replication(props, table_id);
+
+  if (blocksize == 0)
+    blocksize = Config::get_i32("Hypertable.RangeServer.CellStore"
+                                ".DefaultBlockSize");
+  if (compressor.empty())
+    compressor = Config::get_str("Hypertable.RangeServer.CellStore"
+                                 ".DefaultCompressor");
+  if (!props->has("bloom-filter-mode")) {
+    // probably not called from AccessGroup
+    AccessGroupOptions::parse_bloom_filter(Config::get_str("Hypertable.RangeServer"
+        ".CellStore.DefaultBloomFilter"), props);
+  }
+
+  m_buffer.reserve(blocksize*4);
+
+  m_max_entries = max_entries;
+
+  m_fd = -1;
+  m_offset = 0;
+
+  m_index_builder.fixed_buf().reserve(4*4096);
+  m_index_builder.variable_buf().reserve(1024*1024);
+
+  m_uncompressed_data = 0.0;
+  m_compressed_data = 0.0;
+
+  m_trailer.clear();
+  m_trailer.blocksize = blocksize;
+  m_uncompressed_blocksize = blocksize;
+  m_index_leaf_blocksize = Config::get_i32("Hypertable.RangeServer.CellStore"
+                                           ".IndexLeafBlockSize");
+  m_restart_interval = Config::get_i32("Hypertable.RangeServer.CellStore"
+                                       ".BlockRestartInterval");
+  m_restarts.clear();
+  m_restarts.push_back(0);
+  m_restart_count = 0;
+
+  m_block_timestamp_min = TIMESTAMP_MAX;
+  m_block_timestamp_max = TIMESTAMP_MIN;
+
+  if (props->has("pax-layout") && props->get_bool("pax-layout")) {
+    m_trailer.flags |= CellStoreTrailerV8::PAX_LAYOUT;
+    m_value_buffer.reserve(blocksize*2);
+  }
+
+  // set up the "column_ttl" vector
+  HT_ASSERT(m_schema);
+  ColumnFamilySpecs &column_family_specs = m_schema->get_column_families();
+  for (size_t i=0; i<column_family_specs.size(); i++) {
+    if (column_family_specs[i]->get_option_ttl()) {
+      if (m_column_ttl == 0) {
+        m_column_ttl = new int64_t[256];
+        memset(m_column_ttl, 0, 256*8);
+      }
+      m_column_ttl[ column_family_specs[i]->get_id() ] = column_family_specs[i]->get_option_ttl() * 1000000000LL;
+    }
+  }
+
+  // set up the value dictionary family bitmap
+  for (size_t i=0; i<column_family_specs.size(); i++) {
+    if (column_family_specs[i]->get_option_value_dictionary() &&
+        !column_family_specs[i]->get_deleted()) {
+      uint8_t id = (uint8_t)column_family_specs[i]->get_id();
+      m_value_dict_family_bitmap[id>>3] |= (1 << (id & 0x07));
+      m_value_dict_enabled = true;
+    }
+  }
+
+  m_filename = fname;
+
+  if (Global::block_cache)
+    Global::block_cache->register_file(m_file_id, m_filename);
+
+  m_start_row = "";
+  m_end_row = Key::END_ROW_MARKER;
+
+  m_trailer.compression_type = CompressorFactory::parse_block_codec_spec(
+      compressor, m_compressor_args);
+
+  m_compressor = CompressorFactory::create_block_codec(
+      (BlockCompressionCodec::Type)m_trailer.compression_type,
+      m_compressor_args);
+
+  uint32_t oflags = Filesystem::OPEN_FLAG_DIRECTIO|Filesystem::OPEN_FLAG_OVERWRITE;
+  m_fd = m_filesys->create(m_filename, oflags, -1, replication, -1);
+
+  m_bloom_filter_mode = props->get<BloomFilterMode>("bloom-filter-mode");
+  m_max_approx_items = props->get_i32("max-approx-items");
+
+  if (m_bloom_filter_mode != BLOOM_FILTER_DISABLED) {
+    bool has_num_hashes = props->has("num-hashes");
+    bool has_bits_per_item = props->has("bits-per-item");
+
+    if (has_num_hashes || has_bits_per_item) {
+      if (!(has_num_hashes && has_bits_per_item)) {
+        HT_WARN("Bloom filter option --bits-per-item must be used with "
+                "--num-hashes, defaulting to false probability of 0.01");
+        m_filter_false_positive_prob = 0.1;
+      }
+      else {
+        m_trailer.bloom_filter_hash_count = props->get_i32("num-hashes");
+        m_bloom_bits_per_item = props->get_f64("bits-per-item");
+      }
+    }
+    else
+      m_filter_false_positive_prob = props->get_f64("false-positive");
+    if (m_bloom_filter_mode == BLOOM_FILTER_ROWS_COLS_PREFIX) {
+      int32_t prefix_len = props->get_i32("prefix-length");
+      if (prefix_len < 1 || prefix_len > 255) {
+        HT_WARNF("Bloom filter option --prefix-length %d out of range, "
+                 "clamping to [1,255]", (int)prefix_len);
+        prefix_len = (prefix_len < 1) ? 1 : 255;
+      }
+      m_bloom_filter_prefix_len = (uint32_t)prefix_len;
+      m_trailer.bloom_filter_prefix_len = (uint8_t)prefix_len;
+    }
+    m_bloom_filter_items = new BloomFilterItems(); // aproximator items
+  }
+  HT_DEBUG_OUT <<"bloom-filter-mode="<< m_bloom_filter_mode
+      <<" max-approx-items="<< m_max_approx_items <<" false-positive="
+      << m_filter_false_positive_prob << HT_END;
+}
+
+
+void CellStoreV8::create_bloom_filter(bool is_approx) {
+  assert(!m_bloom_filter && m_bloom_filter_items);
+
+  HT_DEBUG_OUT << "Creating new BloomFilter for CellStore '"
+    << m_filename <<"' for "<< (is_approx ? "estimated " : "")
+    << m_trailer.filter_items_estimate << " items"<< HT_END;
+  try {
+    if (m_filter_false_positive_prob != 0.0)
+      m_bloom_filter = new BloomFilterWithChecksum(m_trailer.filter_items_estimate,
+                                                   m_filter_false_positive_prob);
+    else
+      m_bloom_filter = new BloomFilterWithChecksum(m_trailer.filter_items_estimate,
+                                                   m_bloom_bits_per_item,
+                                                   m_trailer.bloom_filter_hash_count);
+  }
+  catch(Exception &e) {
+    HT_FATAL_OUT << "Error creating new BloomFilter for CellStore '"
+                 << m_filename <<"' for "<< (is_approx ? "estimated " : "")
+                 << m_trailer.filter_items_estimate << " items - "<< e << HT_END;
+  }
+
+  for (const auto &blob : *m_bloom_filter_items)
+    m_bloom_filter->insert(blob.start, blob.size);
+
+  delete m_bloom_filter_items;
+  m_bloom_filter_items = 0;
+
+  HT_DEBUG_OUT << "Created new BloomFilter for CellStore '"
+    << m_filename <<"'"<< HT_END;
+}
+
+const std::vector<String> &CellStoreV8::get_replaced_files() {
+  lock_guard<mutex> lock(m_mutex);
+  if (!m_replaced_files_loaded)
+    load_replaced_files();
+  return m_replaced_files;
+}
+
+void CellStoreV8::load_replaced_files() {
+ bool second_try = false;
+ int64_t amount = m_trailer.replaced_files_length;
+ int64_t len = 0;
+
+ try_again:
+
+  try {
+    DynamicBuffer buf(amount);
+
+    /** Read index data **/
+    len = m_filesys->pread(m_fd, buf.ptr, amount, m_trailer.replaced_files_offset, second_try);
+
+    if (len != amount)
+      HT_THROWF(Error::FSBROKER_IO_ERROR, "Error loading replaced files for "
+                "CellStore '%s' : tried to read %lld but only got %lld",
+                m_filename.c_str(), (Lld)amount, (Lld)len);
+    /** inflate replaced files **/
+
+    StringDecompressorPrefix decompressor;
+    String filename;
+    const uint8_t *ptr = buf.base;
+    for (uint32_t ii=0; ii < m_trailer.replaced_files_entries; ++ii) {
+      if (ptr - buf.base >= (ptrdiff_t) m_trailer.replaced_files_length)
+        HT_THROWF(Error::RANGESERVER_CORRUPT_CELLSTORE,
+            "Bad replaced_files_offset in CellStore trailer fd=%u replaced_files_offset=%lld, "
+            "length=%llu, entries=%u, file='%s'", (unsigned)m_fd,
+            (Lld)m_trailer.replaced_files_offset, (Lld)m_trailer.replaced_files_length,
+            (unsigned)m_trailer.replaced_files_entries, m_filename.c_str());
+      ptr = decompressor.add(ptr);
+      decompressor.load(filename);
+      m_replaced_files.push_back(filename);
+    }
+  }
+  catch (Exception &e) {
+    String msg;
+    HT_ERROR_OUT << "pread(fd=" << m_fd << ", len=" << len << ", amount="
+        << amount << ")\n" << HT_END;
+    HT_ERROR_OUT << m_trailer << HT_END;
+    if (second_try)
+      HT_THROW2(e.code(), e, msg);
+    second_try = true;
+    goto try_again;
+  }
+  m_replaced_files_loaded = true;
+}
+
+
+void CellStoreV8::load_value_dictionary() {
+  bool second_try = false;
+  int64_t amount = m_trailer.value_dict_length;
+  int64_t len = 0;
+
+ try_again:
+
+  try {
+    m_value_dict.clear();
+    m_value_dict_buf.clear();
+    m_value_dict_buf.reserve(amount);
+
+    /** Read dictionary data **/
+    len = m_filesys->pread(m_fd, m_value_dict_buf.base, amount,
+                           m_trailer.value_dict_offset, second_try);
+
+    if (len != amount)
+      HT_THROWF(Error::FSBROKER_IO_ERROR, "Error loading value dictionary for "
+                "CellStore '%s' : tried to read %lld but only got %lld",
+                m_filename.c_str(), (Lld)amount, (Lld)len);
+
+    /** Parse family bitmap and entries **/
+    const uint8_t *ptr = m_value_dict_buf.base
+      + sizeof(m_value_dict_family_bitmap);
+    const uint8_t *end = m_value_dict_buf.base + amount;
+    m_value_dict.reserve(m_trailer.value_dict_entries);
+    for (uint32_t ii=0; ii < m_trailer.value_dict_entries; ++ii) {
+      if (ptr >= end)
+        HT_THROWF(Error::RANGESERVER_CORRUPT_CELLSTORE,
+            "Bad value_dict_offset in CellStore trailer fd=%u "
+            "value_dict_offset=%lld, length=%lld, entries=%u, file='%s'",
+            (unsigned)m_fd, (Lld)m_trailer.value_dict_offset,
+            (Lld)m_trailer.value_dict_length,
+            (unsigned)m_trailer.value_dict_entries, m_filename.c_str());
+      ByteString entry(ptr);
+      ptr += entry.length();
+      m_value_dict.push_back(entry);
+    }
+    memcpy(m_value_dict_family_bitmap, m_value_dict_buf.base,
+           sizeof(m_value_dict_family_bitmap));
+  }
+  catch (Exception &e) {
+    String msg;
+    HT_ERROR_OUT << "pread(fd=" << m_fd << ", len=" << len << ", amount="
+        << amount << ")\n" << HT_END;
+    HT_ERROR_OUT << m_trailer << HT_END;
+    if (second_try)
+      HT_THROW2(e.code(), e, msg);
+    second_try = true;
+    goto try_again;
+  }
+}
+
+
+void CellStoreV8::load_codec_dictionary() {
+  bool second_try = false;
+  int64_t amount = m_trailer.codec_dict_length;
+  int64_t len = 0;
+
+ try_again:
+
+  try {
+    m_codec_dict_buf.clear();
+    m_codec_dict_buf.reserve(amount);
+
+    /** Read dictionary data **/
+    len = m_filesys->pread(m_fd, m_codec_dict_buf.base, amount,
+                           m_trailer.codec_dict_offset, second_try);
+
+    if (len != amount)
+      HT_THROWF(Error::FSBROKER_IO_ERROR, "Error loading codec dictionary for "
+                "CellStore '%s' : tried to read %lld but only got %lld",
+                m_filename.c_str(), (Lld)amount, (Lld)len);
+
+    m_codec_dict_buf.ptr = m_codec_dict_buf.base + amount;
+  }
+  catch (Exception &e) {
+    String msg;
+    HT_ERROR_OUT << "pread(fd=" << m_fd << ", len=" << len << ", amount="
+        << amount << ")\n" << HT_END;
+    HT_ERROR_OUT << m_trailer << HT_END;
+    if (second_try)
+      HT_THROW2(e.code(), e, msg);
+    second_try = true;
+    goto try_again;
+  }
+}
+
+
+const uint8_t *CellStoreV8::value_dict_families() {
+  lock_guard<mutex> lock(m_mutex);
+  if (m_trailer.value_dict_entries == 0)
+    return nullptr;
+  if (m_value_dict.empty())
+    load_value_dictionary();
+  return m_value_dict_family_bitmap;
+}
+
+
+ByteString CellStoreV8::value_dict_entry(uint32_t code) {
+  if (code >= m_value_dict.size())
+    HT_THROWF(Error::RANGESERVER_CORRUPT_CELLSTORE,
+              "Bad value dictionary code %u (dictionary holds %u entries) "
+              "in CellStore '%s'", (unsigned)code,
+              (unsigned)m_value_dict.size(), m_filename.c_str());
+  return m_value_dict[code];
+}
+
+void CellStoreV8::load_bloom_filter() {
+  size_t len;
+
+  HT_ASSERT(m_index_stats.bloom_filter_memory == 0);
+
+  HT_DEBUG_OUT << "Loading BloomFilter for CellStore '"
+               << m_filename <<"' with "<< m_trailer.filter_items_estimate
+               << " items"<< HT_END;
+  try {
+    m_bloom_filter = new BloomFilterWithChecksum(m_trailer.filter_items_actual,
+                                                 m_trailer.filter_items_actual,
+                                                 m_trailer.filter_length,
+                                                 m_trailer.bloom_filter_hash_count);
+  }
+  catch(Exception &e) {
+    HT_FATAL_OUT << "Error loading BloomFilter for CellStore '"
+                 << m_filename <<"' with "<< m_trailer.filter_items_estimate
+                 << " items -"<< e << HT_END;
+  }
+
+  if (m_bloom_filter->total_size() > 0) {
+
+    bool second_try = false;
+
+    while (true) {
+      try {
+	len = m_filesys->pread(m_fd, m_bloom_filter->base(), m_bloom_filter->total_size(),
+			       m_trailer.filter_offset, second_try);
+      }
+      catch (Exception &e) {
+	if (!second_try) {
+	  second_try=true;
+	  continue;
+	}
+	HT_THROW2(e.code(), e, format("Error loading BloomFilter for CellStore '%s'",
+				      m_filename.c_str()));
+      }
+      break;
+    }
+
+    if (len != m_bloom_filter->total_size())
+      HT_THROWF(Error::FSBROKER_IO_ERROR, "Problem loading bloomfilter for"
+                "CellStore '%s' : tried to read %lld but only got %lld",
+                m_filename.c_str(), (Lld)m_bloom_filter->total_size(), (Lld)len);
+
+    m_bytes_read += len;
+
+    m_bloom_filter->validate(m_filename);
+  }
+
+  m_index_stats.bloom_filter_memory = sizeof(BloomFilterWithChecksum) + m_bloom_filter->total_size();
+  Global::memory_tracker->add(m_index_stats.bloom_filter_memory);
+
+}
+
+
+
+uint64_t CellStoreV8::purge_indexes() {
+  uint64_t memory_purged = 0;
+
+  {
+    lock_guard<mutex> lock(m_mutex);
+
+    if (m_index_stats.bloom_filter_memory > 0) {
+      memory_purged = m_index_stats.bloom_filter_memory;
+      delete m_bloom_filter;
+      m_bloom_filter = 0;
+      m_index_stats.bloom_filter_memory = 0;
+    }
+
+    if (m_index_refcount == 0 && m_index_stats.block_index_memory > 0) {
+      memory_purged += m_index_stats.block_index_memory;
+      if (m_64bit_index)
+        m_index_map64.clear();
+      else
+        m_index_map32.clear();
+      m_root_index.clear();
+      m_root_keys.free();
+      m_index_stats.block_index_memory = 0;
+    }
+  }
+
+  Global::memory_tracker->subtract( memory_purged );
+
+  return memory_purged;
+}
+
+
+
+/**
+ * Appends the restart-point trailer to the data block under construction:
+ * the offsets of all restart points followed by their count, each encoded
+ * as a fixed 32-bit integer.  Readers strip the trailer before iterating
+ * cells and use the restarts to binary search within the block.
+ */
+void CellStoreV8::append_restart_trailer() {
+  m_buffer.ensure(4 * (m_restarts.size() + 1));
+  for (auto restart : m_restarts)
+    Serialization::encode_i32(&m_buffer.ptr, restart);
+  Serialization::encode_i32(&m_buffer.ptr, m_restarts.size());
+}
+
+
+/**
+ * Completes a PAX-layout data block: patches the key-region length recorded
+ * at the front of the block and appends the value region accumulated in
+ * #m_value_buffer behind the keys.
+ */
+void CellStoreV8::finish_pax_block() {
+  uint8_t *patch = m_buffer.base;
+  Serialization::encode_i32(&patch, m_buffer.fill() - 4);
+  m_buffer.ensure(m_value_buffer.fill());
+  m_buffer.add_unchecked(m_value_buffer.base, m_value_buffer.fill());
+  m_value_buffer.clear();
+}
+
+
+void CellStoreV8::add(const Key &key, const ByteString value) {
+  EventPtr event_ptr;
+  DynamicBuffer zbuf;
+  ByteString value_written(value);
+
+  if (m_value_dict_enabled && key.flag == FLAG_INSERT &&
+      (m_value_dict_family_bitmap[key.column_family_code>>3] &
+       (1 << (key.column_family_code & 0x07))))
+    value_written = value_dict_encode(value);
+
+  if (key.revision > m_trailer.revision)
+    m_trailer.revision = key.revision;
+
+  if (key.timestamp != TIMESTAMP_NULL) {
+    if (key.timestamp < m_trailer.timestamp_min)
+      m_trailer.timestamp_min = key.timestamp;
+    if (key.timestamp > m_trailer.timestamp_max)
+      m_trailer.timestamp_max = key.timestamp;
+  }
+
+  // Track the timestamp range of the block under construction.  Deletes can
+  // affect cells in other blocks and cells without a timestamp have no
+  // position in the range, so either makes the block unprunable.
+  if (key.timestamp == TIMESTAMP_NULL || key.flag != FLAG_INSERT) {
+    m_block_timestamp_min = TIMESTAMP_MIN;
+    m_block_timestamp_max = TIMESTAMP_MAX;
+  }
+  else {
+    if (key.timestamp < m_block_timestamp_min)
+      m_block_timestamp_min = key.timestamp;
+    if (key.timestamp > m_block_timestamp_max)
+      m_block_timestamp_max = key.timestamp;
+  }
+
+  if (m_buffer.fill() + m_value_buffer.fill() > (size_t)m_uncompressed_blocksize) {
+    BlockHeaderCellStore header(BLOCK_HEADER_VERSION, DATA_BLOCK_MAGIC);
+
+    m_index_builder.add_entry(m_key_compressor, m_offset,
+                              m_block_timestamp_min, m_block_timestamp_max);
+    m_block_timestamp_min = TIMESTAMP_MAX;
+    m_block_timestamp_max = TIMESTAMP_MIN;
+
+    if (pax_layout())
+      finish_pax_block();
+    append_restart_trailer();
+
+    m_uncompressed_data += (float)m_buffer.fill();
+    m_compressor->deflate(m_buffer, zbuf, header, HT_DIRECT_IO_ALIGNMENT);
+    m_compressed_data += (float)zbuf.fill();
+    m_buffer.clear();
+
+    uint64_t llval = ((uint64_t)m_trailer.blocksize
+        * (uint64_t)m_uncompressed_data) / (uint64_t)m_compressed_data;
+    m_uncompressed_blocksize = (int64_t)llval;
+
+    if (m_outstanding_appends >= MAX_APPENDS_OUTSTANDING) {
+      if (!m_sync_handler.wait_for_reply(event_ptr)) {
+        if (event_ptr->type == Event::MESSAGE)
+          HT_THROWF(Hypertable::Protocol::response_code(event_ptr),
+             "Problem writing to FS file '%s' : %s", m_filename.c_str(),
+             Hypertable::Protocol::string_format_message(event_ptr).c_str());
+        HT_THROWF(event_ptr->error,
+                  "Problem writing to FS file '%s'", m_filename.c_str());
+      }
+      m_outstanding_appends--;
+    }
+
+    if (!HT_IO_ALIGNED(zbuf.fill())) {
+      memset(zbuf.ptr, 0, HT_IO_ALIGNMENT_PADDING(zbuf.fill()));
+      zbuf.ptr += HT_IO_ALIGNMENT_PADDING(zbuf.fill());
+    }
+
+    size_t zlen = zbuf.fill();
+    StaticBuffer send_buf(zbuf);
+
+    try { m_filesys->append(m_fd, send_buf, Filesystem::Flags::NONE, &m_sync_handler); }
+    catch (Exception &e) {
+      HT_THROW2F(e.code(), e, "Problem writing to FS file '%s'",
+                 m_filename.c_str());
+    }
+    m_outstanding_appends++;
+    m_offset += zlen;
+    m_key_compressor->reset();
+    m_restarts.clear();
+    m_restarts.push_back(0);
+    m_restart_count = 0;
+  }
+  else if (m_restart_count >= m_restart_interval && m_buffer.fill() > 0) {
+    // Restart point: write the next key in full so readers can binary
+    // search restarts within the block (see block_restarts())
+    m_key_compressor->reset();
+    m_restarts.push_back(m_buffer.fill());
+    m_restart_count = 0;
+  }
+
+  if (pax_layout() && m_buffer.fill() == 0) {
+    // Reserve space at the front of the block for the key-region length,
+    // patched in finish_pax_block()
+    m_buffer.ensure(4);
+    Serialization::encode_i32(&m_buffer.ptr, 0);
+  }
+
+  m_key_compressor->add(key);
+  m_restart_count++;
+
+  size_t key_len = m_key_compressor->length();
+  size_t value_len = value_written.length();
+
+  m_trailer.key_bytes += key.length;
+  m_trailer.value_bytes += value_len;
+
+  if (m_column_ttl && m_column_ttl[key.column_family_code] != 0) {
+    m_trailer.expirable_data += key_len + value_len;
+    if ((key.timestamp + m_column_ttl[key.column_family_code]) > m_trailer.expiration_time)
+      m_trailer.expiration_time = key.timestamp + m_column_ttl[key.column_family_code];
+  }
+
+  if (key.flag <= FLAG_DELETE_CELL_VERSION)
+    m_trailer.delete_count++;
+
+  m_buffer.ensure(key_len + value_len);
+
+  m_key_compressor->write(m_buffer.ptr);
+  m_buffer.ptr += key_len;
+
+  if (pax_layout())
+    m_value_buffer.add(value_written.ptr, value_len);
+  else
+    m_buffer.add_unchecked(value_written.ptr, value_len);
+
+  if (m_bloom_filter_mode != BLOOM_FILTER_DISABLED) {
+    if (m_trailer.total_entries < m_max_approx_items) {
+      m_bloom_filter_items->insert(key.row, key.row_len);
+
+      if (m_bloom_filter_mode == BLOOM_FILTER_ROWS_COLS)
+        m_bloom_filter_items->insert(key.row, key.row_len + 2);
+      else if (m_bloom_filter_mode == BLOOM_FILTER_ROWS_COLS_PREFIX) {
+        // Qualifier bytes follow the row and column family byte in the
+        // serialized key, so the prefix entry is a contiguous extension
+        m_bloom_filter_items->insert(key.row, key.row_len + 2);
+        m_bloom_filter_items->insert(key.row, key.row_len + 2 +
+            min(m_bloom_filter_prefix_len, key.column_qualifier_len));
+      }
+
+      if (m_trailer.total_entries == m_max_approx_items - 1) {
+        m_trailer.filter_items_estimate = (size_t)(((double)m_max_entries
+            / (double)m_max_approx_items) * m_bloom_filter_items->size());
+        if (m_trailer.filter_items_estimate == 0)
+          m_trailer.filter_items_estimate = 1;
+        create_bloom_filter(true);
+      }
+    }
+    else {
+      assert(!m_bloom_filter_items && m_bloom_filter);
+
+      m_bloom_filter->insert(key.row);
+
+      if (m_bloom_filter_mode == BLOOM_FILTER_ROWS_COLS)
+        m_bloom_filter->insert(key.row, key.row_len + 2);
+      else if (m_bloom_filter_mode == BLOOM_FILTER_ROWS_COLS_PREFIX) {
+        m_bloom_filter->insert(key.row, key.row_len + 2);
+        m_bloom_filter->insert(key.row, key.row_len + 2 +
+            min(m_bloom_filter_prefix_len, key.column_qualifier_len));
+      }
+    }
+  }
+
+  m_trailer.total_entries++;
+}
+
+
+ByteString CellStoreV8::value_dict_encode(const ByteString value) {
+  const uint8_t *raw;
+  size_t raw_len = value.decode_length(&raw);
+  uint8_t *ptr;
+  ByteString coded;
+
+  auto iter = m_value_dict_codes.find(string((const char *)raw, raw_len));
+  if (iter == m_value_dict_codes.end() &&
+      m_value_dict_codes.size() < VALUE_DICT_MAX_ENTRIES) {
+    m_value_dict_values.push_back(string((const char *)raw, raw_len));
+    iter = m_value_dict_codes.insert(
+        make_pair(m_value_dict_values.back(),
+                  (uint32_t)(m_value_dict_values.size()-1))).first;
+  }
+
+  m_value_dict_scratch.clear();
+  if (iter != m_value_dict_codes.end()) {
+    m_value_dict_scratch.ensure(4);
+    ptr = m_value_dict_scratch.ptr;
+    Serialization::encode_vi32(&ptr, 3);
+    *ptr++ = 1;
+    Serialization::encode_i16(&ptr, (uint16_t)iter->second);
+    m_value_dict_scratch.ptr = ptr;
+  }
+  else {
+    // Dictionary is full and the value is not in it; store the value raw
+    // behind a zero tag byte
+    m_value_dict_scratch.ensure(Serialization::encoded_length_vi32(raw_len+1)
+                                + raw_len + 1);
+    ptr = m_value_dict_scratch.ptr;
+    Serialization::encode_vi32(&ptr, raw_len+1);
+    *ptr++ = 0;
+    m_value_dict_scratch.ptr = ptr;
+    m_value_dict_scratch.add_unchecked(raw, raw_len);
+  }
+  coded.ptr = m_value_dict_scratch.base;
+  return coded;
+}
+
+
+void CellStoreV8::finalize(TableIdentifier *table_identifier) {
+  EventPtr event_ptr;
+  size_t zlen;
+  DynamicBuffer zbuf(0);
+  DynamicBuffer codec_dict;
+  SerializedKey key;
+  StaticBuffer send_buf;
+  int64_t index_memory = 0;
+
+  if (m_buffer.fill() > 0) {
+    BlockHeaderCellStore header(BLOCK_HEADER_VERSION, DATA_BLOCK_MAGIC);
+
+    m_index_builder.add_entry(m_key_compressor, m_offset,
+                              m_block_timestamp_min, m_block_timestamp_max);
+
+    if (pax_layout())
+      finish_pax_block();
+    append_restart_trailer();
+
+    m_uncompressed_data += (float)m_buffer.fill();
+    m_compressor->deflate(m_buffer, zbuf, header, HT_DIRECT_IO_ALIGNMENT);
+    m_compressed_data += (float)zbuf.fill();
+
+    if (!HT_IO_ALIGNED(zbuf.fill())) {
+      memset(zbuf.ptr, 0, HT_IO_ALIGNMENT_PADDING(zbuf.fill()));
+      zbuf.ptr += HT_IO_ALIGNMENT_PADDING(zbuf.fill());
+    }
+    zlen = zbuf.fill();
+    send_buf = zbuf;
+
+    if (m_outstanding_appends >= MAX_APPENDS_OUTSTANDING) {
+      if (!m_sync_handler.wait_for_reply(event_ptr))
+        HT_THROWF(Protocol::response_code(event_ptr),
+                  "Problem finalizing CellStore file '%s' : %s",
+                  m_filename.c_str(),
+                  Protocol::string_format_message(event_ptr).c_str());
+      m_outstanding_appends--;
+    }
+
+    m_filesys->append(m_fd, send_buf, Filesystem::Flags::NONE, &m_sync_handler);
+
+    m_outstanding_appends++;
+    m_offset += zlen;
+  }
+
+  m_key_compressor = 0;
+
+  m_buffer.free();
+  m_value_buffer.free();
+
+  m_trailer.fix_index_offset = m_offset;
+  if (m_uncompressed_data == 0)
+    m_trailer.compression_ratio = 1.0;
+  else
+    m_trailer.compression_ratio = m_compressed_data / m_uncompressed_data;
+
+  m_trailer.key_compression_scheme = KeyCompressionType::PREFIX;
+
+  /**
+   * Chop the Index buffers down to the exact length
+   */
+  m_index_builder.chop();
+
+  /**
+   * Write partitioned block index: a sequence of leaf blocks, each holding
+   * a contiguous slice of the (fixed, variable) index entries, followed by
+   * a single root block mapping the last key of each leaf to its file
+   * offset.  Readers keep only the root resident and fault leaves in on
+   * demand (see load_block_index).
+   */
+  {
+    size_t fixed_entry_size = m_index_builder.big_int() ? 8 : 4;
+    size_t total_index_entries
+      = m_index_builder.fixed_buf().fill() / fixed_entry_size;
+    const uint8_t *fix_ptr = m_index_builder.fixed_buf().base;
+    const uint8_t *var_ptr = m_index_builder.variable_buf().base;
+    const uint8_t *ts_ptr = m_index_builder.timestamps_buf().base;
+    DynamicBuffer root_buf;
+    DynamicBuffer leaf_buf(0);
+    size_t entry = 0;
+    uint32_t root_entries = 0;
+
+    while (entry < total_index_entries) {
+      const uint8_t *leaf_fix_base = fix_ptr;
+      const uint8_t *leaf_var_base = var_ptr;
+      size_t leaf_entries = 0;
+      SerializedKey last_key;
+
+      while (entry < total_index_entries) {
+        last_key.ptr = var_ptr;
+        var_ptr += last_key.length();
+        fix_ptr += fixed_entry_size;
+        leaf_entries++;
+        entry++;
+        if ((size_t)(var_ptr - leaf_var_base) + (leaf_entries * fixed_entry_size)
+            >= (size_t)m_index_leaf_blocksize)
+          break;
+      }
+
+      size_t fixed_len = leaf_entries * fixed_entry_size;
+      size_t var_len = var_ptr - leaf_var_base;
+      size_t ts_len = leaf_entries * 16;
+
+      leaf_buf.clear();
+      leaf_buf.ensure(8 + fixed_len + ts_len + var_len);
+      Serialization::encode_i32(&leaf_buf.ptr, leaf_entries);
+      Serialization::encode_i32(&leaf_buf.ptr, fixed_len);
+      leaf_buf.add_unchecked(leaf_fix_base, fixed_len);
+      leaf_buf.add_unchecked(ts_ptr, ts_len);
+      leaf_buf.add_unchecked(leaf_var_base, var_len);
+      ts_ptr += ts_len;
+
+      {
+        BlockHeaderCellStore header(BLOCK_HEADER_VERSION, INDEX_LEAF_BLOCK_MAGIC);
+        m_compressor->deflate(leaf_buf, zbuf, header, HT_DIRECT_IO_ALIGNMENT);
+      }
+
+      if (!HT_IO_ALIGNED(zbuf.fill())) {
+        memset(zbuf.ptr, 0, HT_IO_ALIGNMENT_PADDING(zbuf.fill()));
+        zbuf.ptr += HT_IO_ALIGNMENT_PADDING(zbuf.fill());
+      }
+      zlen = zbuf.fill();
+
+      // Root entry: leaf offset, compressed length, entry count, last key
+      root_buf.ensure(16 + last_key.length());
+      Serialization::encode_i64(&root_buf.ptr, m_offset);
+      Serialization::encode_i32(&root_buf.ptr, zlen);
+      Serialization::encode_i32(&root_buf.ptr, leaf_entries);
+      root_buf.add_unchecked(last_key.ptr, last_key.length());
+      root_entries++;
+
+      send_buf = zbuf;
+      m_filesys->append(m_fd, send_buf, Filesystem::Flags::NONE, &m_sync_handler);
+      m_outstanding_appends++;
+      m_offset += zlen;
+    }
+
+    /**
+     * Write root index
+     */
+    m_trailer.root_index_offset = m_offset;
+    m_trailer.var_index_offset = m_offset;
+    m_trailer.index_root_entries = root_entries;
+    {
+      BlockHeaderCellStore header(BLOCK_HEADER_VERSION, INDEX_ROOT_BLOCK_MAGIC);
+      m_compressor->deflate(root_buf, zbuf, header, HT_DIRECT_IO_ALIGNMENT);
+    }
+
+    // Keep a copy of the codec's trained dictionary (if any) so it can be
+    // persisted for readers after the compressor is destroyed
+    if (m_compressor->dictionary())
+      codec_dict.add(m_compressor->dictionary()->base,
+                     m_compressor->dictionary()->fill());
+
+    delete m_compressor;
+    m_compressor = 0;
+
+    if (!HT_IO_ALIGNED(zbuf.fill())) {
+      memset(zbuf.ptr, 0, HT_IO_ALIGNMENT_PADDING(zbuf.fill()));
+      zbuf.ptr += HT_IO_ALIGNMENT_PADDING(zbuf.fill());
+    }
+    zlen = zbuf.fill();
+    send_buf = zbuf;
+
+    m_filesys->append(m_fd, send_buf, Filesystem::Flags::NONE, &m_sync_handler);
+
+    m_outstanding_appends++;
+    m_offset += zlen;
+  }
+
+  // write filter_offset
+  m_trailer.filter_offset = m_offset;
+
+  // if bloom_items haven't been spilled to create a bloom filter yet, do it
+  m_trailer.bloom_filter_mode = BLOOM_FILTER_DISABLED;
+  if (m_bloom_filter_mode != BLOOM_FILTER_DISABLED) {
+
+    if (m_bloom_filter_items && m_bloom_filter_items->size() > 0) {
+      m_trailer.filter_items_estimate = m_bloom_filter_items->size();
+      create_bloom_filter();
+    }
+
+    if (m_bloom_filter) {
+      m_trailer.filter_length = m_bloom_filter->get_length_bits();
+      m_trailer.filter_items_actual = m_bloom_filter->get_items_actual();
+      m_trailer.bloom_filter_mode = m_bloom_filter_mode;
+      m_trailer.bloom_filter_hash_count = m_bloom_filter->get_num_hashes();
+      m_bloom_filter->serialize(send_buf);
+      m_filesys->append(m_fd, send_buf, Filesystem::Flags::NONE, &m_sync_handler);
+      m_outstanding_appends++;
+      m_offset += m_bloom_filter->total_size();
+    }
+  }
+
+  // Write value dictionary
+  if (m_value_dict_enabled && !m_value_dict_values.empty()) {
+    size_t dict_len = sizeof(m_value_dict_family_bitmap);
+    for (auto &entry : m_value_dict_values)
+      dict_len += Serialization::encoded_length_vi32(entry.length())
+        + entry.length();
+    m_trailer.value_dict_offset = m_offset;
+    m_trailer.value_dict_length = dict_len;
+    m_trailer.value_dict_entries = m_value_dict_values.size();
+    zbuf.clear();
+    zbuf.reserve(dict_len + HT_IO_ALIGNMENT_PADDING(dict_len));
+    zbuf.add_unchecked(m_value_dict_family_bitmap,
+                       sizeof(m_value_dict_family_bitmap));
+    for (auto &entry : m_value_dict_values)
+      append_as_byte_string(zbuf, entry.data(), entry.length());
+    if (!HT_IO_ALIGNED(zbuf.fill())) {
+      memset(zbuf.ptr, 0, HT_IO_ALIGNMENT_PADDING(zbuf.fill()));
+      zbuf.ptr += HT_IO_ALIGNMENT_PADDING(zbuf.fill());
+    }
+    zlen = zbuf.fill();
+    send_buf = zbuf;
+    m_filesys->append(m_fd, send_buf, Filesystem::Flags::NONE, &m_sync_handler);
+    m_outstanding_appends++;
+    m_offset += zlen;
+  }
+
+  // Write block codec dictionary
+  if (codec_dict.fill() > 0) {
+    m_trailer.codec_dict_offset = m_offset;
+    m_trailer.codec_dict_length = codec_dict.fill();
+    codec_dict.ensure(HT_IO_ALIGNMENT_PADDING(codec_dict.fill()));
+    if (!HT_IO_ALIGNED(codec_dict.fill())) {
+      memset(codec_dict.ptr, 0, HT_IO_ALIGNMENT_PADDING(codec_dict.fill()));
+      codec_dict.ptr += HT_IO_ALIGNMENT_PADDING(codec_dict.fill());
+    }
+    zlen = codec_dict.fill();
+    send_buf = codec_dict;
+    m_filesys->append(m_fd, send_buf, Filesystem::Flags::NONE, &m_sync_handler);
+    m_outstanding_appends++;
+    m_offset += zlen;
+  }
+
+  // Write compressed replaced_file lists
+  // Coalesce with trailer block if possible
+  zbuf.clear();
+  size_t compressed_len = 0;
+  StringCompressorPrefix compressor;
+  bool coalesce_with_trailer =false;
+  for (size_t ii=0; ii < m_replaced_files.size();++ii) {
+    compressor.add(m_replaced_files[ii].c_str());
+    compressed_len += compressor.length();
+  }
+
+  if (HT_IO_ALIGNMENT_PADDING(compressed_len) >= m_trailer.size()) {
+    coalesce_with_trailer = true;
+    zbuf.reserve(compressed_len + m_trailer.size() +
+                 HT_IO_ALIGNMENT_PADDING(compressed_len+m_trailer.size()));
+  }
+  else
+    zbuf.reserve(compressed_len + HT_IO_ALIGNMENT_PADDING(compressed_len));
+  m_trailer.replaced_files_offset = m_offset;
+  m_trailer.replaced_files_entries = m_replaced_files.size();
+  m_trailer.replaced_files_length = compressed_len;
+
+  compressor.reset();
+  for (size_t ii=0; ii < m_replaced_files.size();++ii) {
+    compressor.add(m_replaced_files[ii].c_str());
+    compressor.write(zbuf.ptr);
+    zbuf.ptr += compressor.length();
+  }
+
+  if (!coalesce_with_trailer) {
+    if (!HT_IO_ALIGNED(zbuf.fill())) {
+      memset(zbuf.ptr, 0, HT_IO_ALIGNMENT_PADDING(zbuf.fill()));
+      zbuf.ptr += HT_IO_ALIGNMENT_PADDING(zbuf.fill());
+    }
+    send_buf = zbuf;
+    m_filesys->append(m_fd, send_buf, Filesystem::Flags::NONE, &m_sync_handler);
+    m_outstanding_appends++;
+    zlen = zbuf.fill();
+    m_offset += zlen;
+  }
+
+  m_64bit_index = m_index_builder.big_int();
+
+  /** Set up index **/
+  double fraction_covered;
+  if (m_64bit_index) {
+    m_index_map64.load(m_index_builder.fixed_buf(),
+                       m_index_builder.variable_buf(),
+                       m_trailer.fix_index_offset);
+    m_trailer.index_entries = m_index_map64.index_entries();
+    index_memory = m_index_map64.memory_used();
+    m_trailer.flags |= CellStoreTrailerV8::INDEX_64BIT;
+    m_disk_usage = m_index_map64.disk_used();
+    fraction_covered = m_index_map64.fraction_covered();
+    m_block_count = m_index_map64.index_entries();
+  }
+  else {
+    m_index_map32.load(m_index_builder.fixed_buf(),
+                       m_index_builder.variable_buf(),
+                       m_trailer.fix_index_offset);
+    m_trailer.index_entries = m_index_map32.index_entries();
+    index_memory = m_index_map32.memory_used();
+    m_disk_usage = m_index_map32.disk_used();
+    fraction_covered = m_index_map32.fraction_covered();
+    m_block_count = m_index_map32.index_entries();
+  }
+
+  // deallocate fix index data
+  m_index_builder.release_fixed_buf();
+
+  // Add table information
+  m_trailer.table_id = table_identifier->index();
+  m_trailer.table_generation = table_identifier->generation;
+  m_trailer.create_time = get_ts64();
+
+  m_trailer.block_header_version = BLOCK_HEADER_VERSION;
+
+  // write trailer
+  if (!coalesce_with_trailer) {
+    zbuf.clear();
+    assert(m_trailer.size() <= HT_DIRECT_IO_ALIGNMENT);
+    zbuf.reserve(HT_DIRECT_IO_ALIGNMENT);
+    memset(zbuf.base, 0, HT_DIRECT_IO_ALIGNMENT);
+    zbuf.ptr = zbuf.base + (HT_DIRECT_IO_ALIGNMENT-m_trailer.size());
+  }
+  else {
+    size_t padding = HT_IO_ALIGNMENT_PADDING(m_trailer.replaced_files_length) - m_trailer.size();
+    memset(zbuf.ptr, 0, padding);
+    zbuf.ptr += padding;
+  }
+  m_trailer.serialize(zbuf.ptr);
+  zbuf.ptr += m_trailer.size();
+
+  zlen = zbuf.fill();
+  send_buf = zbuf;
+
+  m_filesys->append(m_fd, send_buf);
+
+  m_outstanding_appends++;
+  m_offset += zlen;
+
+  /** close file for writing **/
+  m_filesys->close(m_fd);
+
+  /** Set file length **/
+  m_file_length = m_offset;
+
+  m_disk_usage +=
+    (int64_t)((double)(m_offset-m_trailer.fix_index_offset) * fraction_covered);
+
+  /** Re-open file for reading **/
+  m_fd = m_filesys->open(m_filename, Filesystem::OPEN_FLAG_DIRECTIO);
+
+  m_index_stats.block_index_memory = index_memory;
+
+  if (m_bloom_filter)
+    m_index_stats.bloom_filter_memory = sizeof(BloomFilterWithChecksum) + m_bloom_filter->total_size();
+
+  delete [] m_column_ttl;
+  m_column_ttl = 0;
+
+  Global::memory_tracker->add( sizeof(CellStoreV8) + sizeof(CellStoreInfo) + m_index_stats.block_index_memory + m_index_stats.bloom_filter_memory );
+}
+
+
+void CellStoreV8::IndexBuilder::add_entry(KeyCompressorPtr &key_compressor,
+                                          int64_t offset,
+                                          int64_t timestamp_min,
+                                          int64_t timestamp_max) {
+
+  // switch to 64-bit offsets if offset being added is >= 2^32
+  if (!m_bigint && offset >= 4294967296LL) {
+    DynamicBuffer tmp_buf(m_fixed.size*2);
+    const uint8_t *src = m_fixed.base;
+    uint8_t *dst = tmp_buf.base;
+    size_t remaining = m_fixed.fill();
+    while (src < m_fixed.ptr)
+      Serialization::encode_i64(&dst, (uint64_t)Serialization::decode_i32(&src, &remaining));
+    delete [] m_fixed.release();
+    m_fixed.base = tmp_buf.base;
+    m_fixed.ptr = dst;
+    m_fixed.size = tmp_buf.size;
+    m_fixed.own = true;
+    tmp_buf.release();
+    m_bigint = true;
+  }
+
+  // Add key to variable buffer
+  size_t key_len = key_compressor->length_uncompressed();
+  m_variable.ensure(key_len);
+  key_compressor->write_uncompressed(m_variable.ptr);
+  m_variable.ptr += key_len;
+
+    // Serialize offset into fix index buffer
+  if (m_bigint) {
+    m_fixed.ensure(8);
+    memcpy(m_fixed.ptr, &offset, 8);
+    m_fixed.ptr += 8;
+  }
+  else {
+    m_fixed.ensure(4);
+    memcpy(m_fixed.ptr, &offset, 4);
+    m_fixed.ptr += 4;
+  }
+
+  // Serialize block timestamp range
+  m_timestamps.ensure(16);
+  Serialization::encode_i64(&m_timestamps.ptr, (uint64_t)timestamp_min);
+  Serialization::encode_i64(&m_timestamps.ptr, (uint64_t)timestamp_max);
+}
+
+
+void CellStoreV8::IndexBuilder::chop() {
+  uint8_t *base;
+  size_t len;
+
+  base = m_fixed.release(&len);
+  m_fixed.reserve(len);
+  m_fixed.add_unchecked(base, len);
+  delete [] base;
+
+  base = m_variable.release(&len);
+  m_variable.reserve(len);
+  m_variable.add_unchecked(base, len);
+  delete [] base;
+
+  base = m_timestamps.release(&len);
+  m_timestamps.reserve(len);
+  m_timestamps.add_unchecked(base, len);
+  delete [] base;
+}
+
+
+
+void
+CellStoreV8::open(const String &fname, const String &start_row,
+                  const String &end_row, int32_t fd, int64_t file_length,
+                  CellStoreTrailer *trailer) {
+  m_filename = fname;
+  m_start_row = start_row;
+  m_end_row = end_row;
+  m_fd = fd;
+  m_file_length = file_length;
+
+  if (Global::block_cache)
+    Global::block_cache->register_file(m_file_id, m_filename);
+
+  m_restricted_range = !(m_start_row == "" && m_end_row == Key::END_ROW_MARKER);
+
+  m_trailer = *static_cast<CellStoreTrailerV8 *>(trailer);
+
+  m_bloom_filter_mode = (BloomFilterMode)m_trailer.bloom_filter_mode;
+  m_bloom_filter_prefix_len = m_trailer.bloom_filter_prefix_len;
+
+  /** Sanity check trailer **/
+  HT_ASSERT(m_trailer.version == 8);
+
+  if (m_trailer.flags & CellStoreTrailerV8::INDEX_64BIT)
+    m_64bit_index = true;
+
+  if (!(m_trailer.fix_index_offset < m_trailer.root_index_offset &&
+        m_trailer.root_index_offset < m_file_length))
+    HT_THROWF(Error::RANGESERVER_CORRUPT_CELLSTORE,
+              "Bad index offsets in CellStore trailer fd=%u fix=%lld, root=%lld, "
+              "length=%llu, file='%s'", (unsigned)m_fd, (Lld)m_trailer.fix_index_offset,
+           (Lld)m_trailer.root_index_offset, (Llu)m_file_length, fname.c_str());
+
+  // This is necessary to get m_disk_usage and m_block_count set properly
+  load_block_index();
+
+  Global::memory_tracker->add( sizeof(CellStoreV8) + sizeof(CellStoreInfo) );
+
+}
+
+
+
+void
+CellStoreV8::rescope(const String &start_row, const String &end_row) {
+  lock_guard<mutex> lock(m_mutex);
+  HT_ASSERT(m_start_row.compare(start_row)<0 || m_end_row.compare(end_row)>0);
+  m_start_row = start_row;
+  m_end_row = end_row;
+  m_restricted_range = true;
+  if (m_index_stats.block_index_memory != 0) {
+    Global::memory_tracker->subtract( m_index_stats.block_index_memory );
+    if (m_64bit_index) {
+      m_index_map64.rescope(m_start_row, m_end_row);
+      m_index_stats.block_index_memory = m_index_map64.memory_used();
+      m_disk_usage = m_index_map64.disk_used() + 
+        (int64_t)((double)(m_file_length-m_trailer.fix_index_offset) *
+		  m_index_map64.fraction_covered());
+      m_block_count = m_index_map64.index_entries();
+    }
+    else {
+      m_index_map32.rescope(m_start_row, m_end_row);
+      m_index_stats.block_index_memory = m_index_map32.memory_used();
+      m_disk_usage = m_index_map32.disk_used() + 
+        (int64_t)((double)(m_file_length-m_trailer.fix_index_offset) *
+		  m_index_map32.fraction_covered());
+      m_block_count = m_index_map32.index_entries();
+    }
+    Global::memory_tracker->add( m_index_stats.block_index_memory );
+  }
+  else
+    load_block_index();
+}
+
+
+
+/**
+ * Loads the root tier of the partitioned block index, leaving the leaf
+ * directory in #m_root_index with keys backed by #m_root_keys.
+ */
+void CellStoreV8::load_root_index(BlockCompressionCodec *compressor) {
+  int64_t amount = m_trailer.filter_offset - m_trailer.root_index_offset;
+  int64_t len = 0;
+  BlockHeaderCellStore header(BLOCK_HEADER_VERSION);
+  bool second_try = false;
+
+ try_again:
+
+  try {
+    DynamicBuffer buf(amount);
+
+    /** Read root index block **/
+    len = m_filesys->pread(m_fd, buf.ptr, amount, m_trailer.root_index_offset,
+                           second_try);
+
+    if (len != amount)
+      HT_THROWF(Error::FSBROKER_IO_ERROR, "Error loading root index for "
+                "CellStore '%s' : tried to read %lld but only got %lld",
+                m_filename.c_str(), (Lld)amount, (Lld)len);
+
+    buf.ptr += amount;
+    m_root_keys.clear();
+    compressor->inflate(buf, m_root_keys, header);
+
+    m_bytes_read += m_root_keys.fill();
+
+    if (!header.check_magic(INDEX_ROOT_BLOCK_MAGIC))
+      HT_THROW(Error::BLOCK_COMPRESSOR_BAD_MAGIC, m_filename);
+  }
+  catch (Exception &e) {
+    String msg = String("Error inflating ROOT index for cellstore '")
+      + m_filename + "'";
+    HT_ERROR_OUT << msg << ": " << e << HT_END;
+    HT_ERROR_OUT << m_trailer << HT_END;
+    if (second_try)
+      HT_THROW2(e.code(), e, msg);
+    second_try = true;
+    goto try_again;
+  }
+
+  /** Parse leaf directory **/
+  const uint8_t *ptr = m_root_keys.base;
+  size_t remaining = m_root_keys.fill();
+  m_root_index.clear();
+  m_root_index.reserve(m_trailer.index_root_entries);
+  for (uint32_t i=0; i<m_trailer.index_root_entries; i++) {
+    RootIndexEntry entry;
+    entry.offset = Serialization::decode_i64(&ptr, &remaining);
+    entry.zlength = Serialization::decode_i32(&ptr, &remaining);
+    entry.entries = Serialization::decode_i32(&ptr, &remaining);
+    entry.last_key.ptr = ptr;
+    size_t key_len = entry.last_key.length();
+    if (key_len > remaining)
+      HT_THROWF(Error::RANGESERVER_CORRUPT_CELLSTORE,
+                "Truncated root index in CellStore '%s'", m_filename.c_str());
+    ptr += key_len;
+    remaining -= key_len;
+    m_root_index.push_back(entry);
+  }
+}
+
+
+/**
+ * Fetches a single leaf index block through the block cache and appends
+ * its fixed and variable index slices to the index builder buffers.
+ */
+void CellStoreV8::load_index_leaf(BlockCompressionCodec *compressor,
+                                  const RootIndexEntry &leaf) {
+  uint8_t *base {};
+  uint32_t len {};
+  bool checked_out {};
+  bool cached {};
+
+  if (Global::block_cache && !Global::block_cache->compressed() &&
+      Global::block_cache->checkout(m_file_id, leaf.offset, &base, &len))
+    checked_out = cached = true;
+  else {
+    DynamicBuffer expand_buf(0);
+    BlockHeaderCellStore header(BLOCK_HEADER_VERSION);
+    bool second_try = false;
+
+  try_again:
+
+    try {
+      DynamicBuffer buf(leaf.zlength);
+      int64_t nread = m_filesys->pread(m_fd, buf.ptr, leaf.zlength,
+                                       leaf.offset, second_try);
+      if (nread != (int64_t)leaf.zlength)
+        HT_THROWF(Error::FSBROKER_IO_ERROR, "Error loading index leaf for "
+                  "CellStore '%s' : tried to read %lld but only got %lld",
+                  m_filename.c_str(), (Lld)leaf.zlength, (Lld)nread);
+      buf.ptr += leaf.zlength;
+      compressor->inflate(buf, expand_buf, header);
+      if (!header.check_magic(INDEX_LEAF_BLOCK_MAGIC))
+        HT_THROW(Error::BLOCK_COMPRESSOR_BAD_MAGIC, m_filename);
+    }
+    catch (Exception &e) {
+      HT_ERROR_OUT << "Error inflating LEAF index for cellstore '"
+                   << m_filename << "': " << e << HT_END;
+      if (second_try)
+        throw;
+      second_try = true;
+      goto try_again;
+    }
+
+    m_bytes_read += expand_buf.fill();
+
+    size_t fill;
+    base = expand_buf.release(&fill);
+    len = fill;
+
+    cached = Global::block_cache && !Global::block_cache->compressed() &&
+      Global::block_cache->insert(m_file_id, leaf.offset, base, len,
+                                  EventPtr(), true);
+    checked_out = cached;
+  }
+
+  /** Parse leaf payload and append index slices **/
+  const uint8_t *ptr = base;
+  size_t remaining = len;
+  uint32_t entries = Serialization::decode_i32(&ptr, &remaining);
+  uint32_t fixed_len = Serialization::decode_i32(&ptr, &remaining);
+  size_t fixed_entry_size = m_64bit_index ? 8 : 4;
+  size_t ts_len = entries * 16;
+
+  if (entries != leaf.entries || fixed_len != entries*fixed_entry_size ||
+      fixed_len + ts_len > remaining)
+    HT_THROWF(Error::RANGESERVER_CORRUPT_CELLSTORE,
+              "Bad index leaf block in CellStore '%s' (offset=%lld)",
+              m_filename.c_str(), (Lld)leaf.offset);
+
+  m_index_builder.fixed_buf().add(ptr, fixed_len);
+  m_index_builder.timestamps_buf().add(ptr+fixed_len, ts_len);
+  m_index_builder.variable_buf().add(ptr+fixed_len+ts_len,
+                                     remaining-fixed_len-ts_len);
+
+  if (checked_out)
+    Global::block_cache->checkin(m_file_id, leaf.offset);
+  else
+    delete [] base;
+}
+
+
+void CellStoreV8::load_block_index() {
+
+  HT_ASSERT(m_index_stats.block_index_memory == 0);
+
+  unique_ptr<BlockCompressionCodec> compressor(create_block_compression_codec());
+
+  if (m_root_index.empty())
+    load_root_index(compressor.get());
+
+  /**
+   * Determine the contiguous run of leaf blocks covering
+   * [m_start_row, m_end_row]; leaves outside the run are never
+   * materialized.  The extra leaf past the end of the run supplies the
+   * offset of the block following the last covered block, which
+   * CellStoreBlockIndexArray needs to compute block lengths.
+   */
+  size_t first = 0;
+  size_t last = 0;
+  if (!m_root_index.empty()) {
+    if (m_start_row != "") {
+      while (first < m_root_index.size()-1 &&
+             strcmp(m_root_index[first].last_key.row(),
+                    m_start_row.c_str()) <= 0)
+        first++;
+    }
+    last = first;
+    while (last < m_root_index.size()-1 &&
+           strcmp(m_root_index[last].last_key.row(), m_end_row.c_str()) <= 0)
+      last++;
+    if (last < m_root_index.size()-1)
+      last++;
+  }
+
+  m_index_builder.fixed_buf().clear();
+  m_index_builder.variable_buf().clear();
+  m_index_builder.timestamps_buf().clear();
+
+  if (!m_root_index.empty()) {
+    for (size_t i=first; i<=last; i++)
+      load_index_leaf(compressor.get(), m_root_index[i]);
+  }
+
+  /** Set up index **/
+  if (m_64bit_index) {
+    m_index_map64.set_maximum_entries((int64_t)m_trailer.index_entries);
+    m_index_map64.load(m_index_builder.fixed_buf(),
+                       m_index_builder.variable_buf(),
+                       m_trailer.fix_index_offset, m_start_row, m_end_row,
+                       &m_index_builder.timestamps_buf());
+    m_index_stats.block_index_memory = m_index_map64.memory_used();
+    m_disk_usage = m_index_map64.disk_used() + 
+      (int64_t)((double)(m_file_length-m_trailer.fix_index_offset) *
+		m_index_map64.fraction_covered());
+    m_block_count = m_index_map64.index_entries();
+  }
+  else {
+    m_index_map32.set_maximum_entries((uint32_t)m_trailer.index_entries);
+    m_index_map32.load(m_index_builder.fixed_buf(),
+                       m_index_builder.variable_buf(),
+                       m_trailer.fix_index_offset, m_start_row, m_end_row,
+                       &m_index_builder.timestamps_buf());
+    m_index_stats.block_index_memory = m_index_map32.memory_used();
+    m_disk_usage = m_index_map32.disk_used() + 
+      (int64_t)((double)(m_file_length-m_trailer.fix_index_offset) *
+		m_index_map32.fraction_covered());
+    m_block_count = m_index_map32.index_entries();
+  }
+
+  m_index_builder.release_fixed_buf();
+
+  /** Root tier stays resident alongside the scoped leaf entries **/
+  m_index_stats.block_index_memory += m_root_keys.fill() +
+    m_root_index.capacity() * sizeof(RootIndexEntry);
+
+  Global::memory_tracker->add( m_index_stats.block_index_memory );
+}
+
+
+bool CellStoreV8::may_contain(ScanContext *scan_ctx) {
+
+  if (m_bloom_filter_mode == BLOOM_FILTER_DISABLED)
+    return true;
+  else if (m_trailer.filter_length == 0) // bloom filter is empty
+    return false;
+
+  {
+    lock_guard<mutex> lock(m_mutex);
+    if (m_bloom_filter == 0)
+      load_bloom_filter();
+
+    m_index_stats.bloom_filter_access_counter = ++Global::access_counter;
+
+    switch (m_bloom_filter_mode) {
+    case BLOOM_FILTER_ROWS:
+      m_index_stats.bloom_filter_access_counter = ++Global::access_counter;
+      return m_bloom_filter->may_contain(scan_ctx->start_row.data(),
+                                         scan_ctx->start_row.size());
+    case BLOOM_FILTER_ROWS_COLS:
+      m_index_stats.bloom_filter_access_counter = ++Global::access_counter;
+      if (m_bloom_filter->may_contain(scan_ctx->start_row.data(),
+                                      scan_ctx->start_row.size())) {
+        SchemaPtr &schema = scan_ctx->schema;
+        size_t rowlen = scan_ctx->start_row.length();
+        uint8_t column_family_id;
+        const char *ptr;
+        boost::scoped_array<char> rowcol(new char[rowlen + 2]);
+        memcpy(rowcol.get(), scan_ctx->start_row.c_str(), rowlen + 1);
+
+        for (auto col : scan_ctx->spec->columns) {
+          if ((ptr = strchr(col, ':')) != 0) {
+            String family(col, (size_t)(ptr-col));
+            column_family_id = schema->get_column_family(family.c_str())->get_id();
+          }
+          else
+            column_family_id = schema->get_column_family(col)->get_id();
+
+          rowcol[rowlen + 1] = column_family_id;
+
+          m_index_stats.bloom_filter_access_counter = ++Global::access_counter;
+          if (m_bloom_filter->may_contain(rowcol.get(), rowlen + 2))
+            return true;
+        }
+      }
+      return false;
+    case BLOOM_FILTER_ROWS_COLS_PREFIX:
+      m_index_stats.bloom_filter_access_counter = ++Global::access_counter;
+      if (m_bloom_filter->may_contain(scan_ctx->start_row.data(),
+                                      scan_ctx->start_row.size())) {
+        SchemaPtr &schema = scan_ctx->schema;
+        size_t rowlen = scan_ctx->start_row.length();
+        const char *qualifier;
+        size_t qualifier_len;
+        bool has_qualifier, is_regexp, is_prefix;
+        String family;
+        boost::scoped_array<char>
+          rowcol(new char[rowlen + 2 + m_bloom_filter_prefix_len]);
+        memcpy(rowcol.get(), scan_ctx->start_row.c_str(), rowlen + 1);
+
+        for (auto col : scan_ctx->spec->columns) {
+          ScanSpec::parse_column(col, family, &qualifier, &qualifier_len,
+                                 &has_qualifier, &is_regexp, &is_prefix);
+          rowcol[rowlen + 1] =
+            schema->get_column_family(family.c_str())->get_id();
+
+          m_index_stats.bloom_filter_access_counter = ++Global::access_counter;
+
+          // Literal qualifiers, and qualifier prefixes at least as long as
+          // the filter's prefix length, check the row+column+prefix entry;
+          // everything else falls back to the row+column entry
+          if (has_qualifier && !is_regexp &&
+              (!is_prefix || qualifier_len >= m_bloom_filter_prefix_len)) {
+            size_t prefix_len =
+              min((size_t)m_bloom_filter_prefix_len, qualifier_len);
+            memcpy(rowcol.get() + rowlen + 2, qualifier, prefix_len);
+            if (m_bloom_filter->may_contain(rowcol.get(),
+                                            rowlen + 2 + prefix_len))
+              return true;
+          }
+          else if (m_bloom_filter->may_contain(rowcol.get(), rowlen + 2))
+            return true;
+        }
+      }
+      return false;
+    default:
+      HT_ASSERT(!"unpossible bloom filter mode!");
+    }
+  }
+  return false; // silence stupid compilers
+}
+
+
+
+void CellStoreV8::display_block_info() {
+  lock_guard<mutex> lock(m_mutex);
+  if (m_index_stats.block_index_memory == 0)
+    load_block_index();
+  if (m_64bit_index)
+    m_index_map64.display();
+  else
+    m_index_map32.display();
+}
+
+
+uint16_t CellStoreV8::block_header_format() {
+  return BLOCK_HEADER_VERSION;
+}
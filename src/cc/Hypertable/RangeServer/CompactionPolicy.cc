@@ -0,0 +1,156 @@
+/*
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/// @file
+/// Definitions for CompactionPolicy.
+/// This file contains definitions for CompactionPolicy, an abstract merge
+/// run selection policy, and its size-tiered and leveled implementations.
+
+#include <Common/Compat.h>
+
+#include "CompactionPolicy.h"
+#include "Global.h"
+
+#include <Common/StringExt.h>
+
+using namespace Hypertable;
+using namespace std;
+
+CompactionPolicyPtr CompactionPolicy::create(const String &strategy) {
+  if (!strcasecmp(strategy.c_str(), "leveled"))
+    return make_shared<LeveledCompactionPolicy>();
+  return make_shared<SizeTieredCompactionPolicy>();
+}
+
+bool
+SizeTieredCompactionPolicy::find_merge_run(const vector<int64_t> &disk_usage,
+                                           bool low_activity, size_t *indexp,
+                                           size_t *lenp) {
+  size_t index = 0;
+  size_t i = 0;
+  size_t count;
+  int64_t running_total = 0;
+
+  // If in "low activity" window, first try to be more aggresive
+  if (low_activity) {
+    bool run_found = false;
+    for (int64_t target = Global::cellstore_target_size_min*2;
+         target <= Global::cellstore_target_size_max;
+         target += Global::cellstore_target_size_min) {
+      index = 0;
+      i = 0;
+      running_total = 0;
+
+      do {
+        running_total += disk_usage[i];
+
+        if (running_total >= target) {
+          count = (i - index) + 1;
+          if (count >= (size_t)2) {
+            if (indexp)
+              *indexp = index;
+            if (lenp)
+              *lenp = count;
+            run_found = true;
+            break;
+          }
+          // Otherwise, move the index forward by one and try again
+          running_total -= disk_usage[index];
+          index++;
+        }
+        i++;
+      } while (i < disk_usage.size());
+      if (i == disk_usage.size())
+        break;
+    }
+    if (run_found)
+      return true;
+  }
+
+  index = 0;
+  i = 0;
+  running_total = 0;
+  do {
+    running_total += disk_usage[i];
+
+    if (running_total >= Global::cellstore_target_size_min) {
+      count = (i - index) + 1;
+      if (count >= (size_t)Global::merge_cellstore_run_length_threshold) {
+        if (indexp)
+          *indexp = index;
+        if (lenp)
+          *lenp = count;
+        return true;
+      }
+      // Otherwise, move the index forward by one and try again
+      running_total -= disk_usage[index];
+      index++;
+    }
+    i++;
+  } while (i < disk_usage.size());
+
+  if ((i-index) >= (size_t)Global::merge_cellstore_run_length_threshold) {
+    if (indexp)
+      *indexp = index;
+    if (lenp)
+      *lenp = i-index;
+    return true;
+  }
+
+  return false;
+}
+
+bool
+LeveledCompactionPolicy::find_merge_run(const vector<int64_t> &disk_usage,
+                                        bool low_activity, size_t *indexp,
+                                        size_t *lenp) {
+  if (disk_usage.size() < 2)
+    return false;
+
+  // Merging is triggered by the store count exceeding the run length
+  // threshold; during the low activity window, merge opportunistically to
+  // drive the count down further
+  if (!low_activity &&
+      disk_usage.size() <= (size_t)Global::merge_cellstore_run_length_threshold)
+    return false;
+
+  // Merge the adjacent pair with the smallest combined size, which keeps
+  // the per-merge rewrite cost minimal
+  size_t best_index = 0;
+  int64_t best_total = disk_usage[0] + disk_usage[1];
+  for (size_t i = 1; i + 1 < disk_usage.size(); i++) {
+    int64_t total = disk_usage[i] + disk_usage[i+1];
+    if (total < best_total) {
+      best_total = total;
+      best_index = i;
+    }
+  }
+
+  // Don't merge beyond the maximum target size
+  if (best_total > Global::cellstore_target_size_max)
+    return false;
+
+  if (indexp)
+    *indexp = best_index;
+  if (lenp)
+    *lenp = 2;
+  return true;
+}
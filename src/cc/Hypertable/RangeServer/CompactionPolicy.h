@@ -0,0 +1,106 @@
+/* -*- c++ -*-
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/// @file
+/// Declarations for CompactionPolicy.
+/// This file contains declarations for CompactionPolicy, an abstract merge
+/// run selection policy, and its size-tiered and leveled implementations.
+
+#ifndef Hypertable_RangeServer_CompactionPolicy_h
+#define Hypertable_RangeServer_CompactionPolicy_h
+
+#include <Common/String.h>
+
+#include <memory>
+#include <vector>
+
+namespace Hypertable {
+
+  /// @addtogroup RangeServer
+  /// @{
+
+  /// Abstract merge run selection policy.
+  /// Each access group holds a policy object chosen by the
+  /// <i>compaction strategy</i> option of its schema specification.  The
+  /// policy decides which run of adjacent cell stores, if any, the next
+  /// merging compaction should combine, and is consulted by the maintenance
+  /// scheduling logic (via AccessGroup::find_merge_run) both when
+  /// prioritizing maintenance and when carrying out a merging compaction.
+  class CompactionPolicy {
+  public:
+
+    /// Destructor.
+    virtual ~CompactionPolicy() { }
+
+    /// Finds a run of adjacent cell stores to merge.
+    /// @param disk_usage Disk usage of each cell store, ordered oldest to
+    /// newest
+    /// @param low_activity <i>true</i> if currently within the low activity
+    /// window
+    /// @param indexp Address of variable to hold index of first store in run
+    /// @param lenp Address of variable to hold length of run
+    /// @return <i>true</i> if a merge run was found, <i>false</i> otherwise
+    virtual bool find_merge_run(const std::vector<int64_t> &disk_usage,
+                                bool low_activity, size_t *indexp,
+                                size_t *lenp) = 0;
+
+    /// Creates a policy from a compaction strategy specification.
+    /// @param strategy Compaction strategy specification ("size-tiered",
+    /// "leveled", or empty for the default size-tiered policy)
+    /// @return Newly created policy object
+    static std::shared_ptr<CompactionPolicy> create(const String &strategy);
+  };
+
+  /// Smart pointer to CompactionPolicy
+  typedef std::shared_ptr<CompactionPolicy> CompactionPolicyPtr;
+
+  /// Size-tiered merge run selection policy (default).
+  /// Merges runs of adjacent cell stores whose combined size reaches the
+  /// target cell store size, requiring runs of at least
+  /// <code>Hypertable.RangeServer.CellStore.Merge.RunLengthThreshold</code>
+  /// stores (two during the low activity window).  Stores are rewritten
+  /// infrequently, minimizing write amplification, at the cost of a larger
+  /// store count and therefore wider scan fan-in.
+  class SizeTieredCompactionPolicy : public CompactionPolicy {
+  public:
+    virtual bool find_merge_run(const std::vector<int64_t> &disk_usage,
+                                bool low_activity, size_t *indexp,
+                                size_t *lenp);
+  };
+
+  /// Leveled merge run selection policy.
+  /// Keeps the cell store count at or below
+  /// <code>Hypertable.RangeServer.CellStore.Merge.RunLengthThreshold</code>
+  /// by merging the smallest adjacent pair of stores whenever the count is
+  /// exceeded (or opportunistically during the low activity window).  Scans
+  /// touch few stores, at the cost of rewriting data more often.
+  class LeveledCompactionPolicy : public CompactionPolicy {
+  public:
+    virtual bool find_merge_run(const std::vector<int64_t> &disk_usage,
+                                bool low_activity, size_t *indexp,
+                                size_t *lenp);
+  };
+
+  /// @}
+
+}
+
+#endif // Hypertable_RangeServer_CompactionPolicy_h
@@ -25,8 +25,10 @@
 
 #include <Hypertable/RangeServer/RangeServer.h>
 #include <Hypertable/RangeServer/Request/Handler/AcknowledgeLoad.h>
+#include <Hypertable/RangeServer/Request/Handler/AdoptCellstore.h>
 #include <Hypertable/RangeServer/Request/Handler/CommitLogSync.h>
 #include <Hypertable/RangeServer/Request/Handler/Compact.h>
+#include <Hypertable/RangeServer/Request/Handler/CompareAndUpdate.h>
 #include <Hypertable/RangeServer/Request/Handler/CreateScanner.h>
 #include <Hypertable/RangeServer/Request/Handler/DestroyScanner.h>
 #include <Hypertable/RangeServer/Request/Handler/DropRange.h>
@@ -34,6 +36,7 @@
 #include <Hypertable/RangeServer/Request/Handler/Dump.h>
 #include <Hypertable/RangeServer/Request/Handler/DumpPseudoTable.h>
 #include <Hypertable/RangeServer/Request/Handler/FetchScanblock.h>
+#include <Hypertable/RangeServer/Request/Handler/GetLiveState.h>
 #include <Hypertable/RangeServer/Request/Handler/GetStatistics.h>
 #include <Hypertable/RangeServer/Request/Handler/Heapcheck.h>
 #include <Hypertable/RangeServer/Request/Handler/LoadRange.h>
@@ -101,6 +104,10 @@ void ConnectionHandler::handle(EventPtr &event) {
         handler = new Request::Handler::Compact(m_comm, m_range_server,
                                             event);
         break;
+      case Lib::RangeServer::Protocol::COMMAND_ADOPT_CELLSTORE:
+        handler = new Request::Handler::AdoptCellstore(m_comm, m_range_server,
+                                                   event);
+        break;
       case Lib::RangeServer::Protocol::COMMAND_LOAD_RANGE:
         handler = new Request::Handler::LoadRange(m_comm, m_range_server,
                                               event);
@@ -109,6 +116,10 @@ void ConnectionHandler::handle(EventPtr &event) {
         handler = new Request::Handler::Update(m_comm, m_range_server,
                                            event);
         break;
+      case Lib::RangeServer::Protocol::COMMAND_COMPARE_AND_UPDATE:
+        handler = new Request::Handler::CompareAndUpdate(m_comm,
+            m_range_server, event);
+        break;
       case Lib::RangeServer::Protocol::COMMAND_CREATE_SCANNER:
         handler = new Request::Handler::CreateScanner(m_comm,
             m_range_server, event);
@@ -157,6 +168,10 @@ void ConnectionHandler::handle(EventPtr &event) {
         handler = new Request::Handler::GetStatistics(m_comm,
             m_range_server, event);
         break;
+      case Lib::RangeServer::Protocol::COMMAND_GET_LIVE_STATE:
+        handler = new Request::Handler::GetLiveState(m_comm,
+            m_range_server, event);
+        break;
       case Lib::RangeServer::Protocol::COMMAND_UPDATE_SCHEMA:
         handler = new Request::Handler::UpdateSchema(m_comm,
             m_range_server, event);
@@ -215,6 +230,35 @@ void ConnectionHandler::handle(EventPtr &event) {
         HT_THROWF(Error::PROTOCOL_ERROR, "Unimplemented command (%llu)",
                   (Llu)event->header.command);
       }
+
+      // Map the command to a priority lane.  Scanner creation carries the
+      // latency-sensitive point reads and goes in the high priority lane,
+      // ahead of bulk scanblock fetches and updates; background and
+      // diagnostic operations go in the low priority lane.
+      switch (event->header.command) {
+      case Lib::RangeServer::Protocol::COMMAND_CREATE_SCANNER:
+      case Lib::RangeServer::Protocol::COMMAND_DESTROY_SCANNER:
+        handler->set_priority(ApplicationHandler::PRIORITY_HIGH);
+        break;
+      case Lib::RangeServer::Protocol::COMMAND_COMPACT:
+      case Lib::RangeServer::Protocol::COMMAND_DUMP:
+      case Lib::RangeServer::Protocol::COMMAND_DUMP_PSEUDO_TABLE:
+      case Lib::RangeServer::Protocol::COMMAND_GET_LIVE_STATE:
+      case Lib::RangeServer::Protocol::COMMAND_HEAPCHECK:
+        handler->set_priority(ApplicationHandler::PRIORITY_LOW);
+        break;
+      default:
+        break;
+      }
+
+      // Requests that can be completed without blocking (e.g. query cache
+      // hits) are carried out right here on the reactor thread, skipping
+      // the application queue round trip
+      if (handler->run_inline()) {
+        delete handler;
+        return;
+      }
+
       m_app_queue->add(handler);
     }
     catch (Exception &e) {
@@ -0,0 +1,116 @@
+/*
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 3 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/// @file
+/// Definitions for DecompressionPool.
+/// This file contains definitions for DecompressionPool, a worker pool
+/// to which scanners hand off cell store block decompression.
+
+#include <Common/Compat.h>
+
+#include "DecompressionPool.h"
+
+#include <Common/Error.h>
+#include <Common/Logger.h>
+
+using namespace Hypertable;
+using namespace std;
+
+DecompressionPool::DecompressionPool(size_t worker_count) {
+  HT_ASSERT(worker_count > 0);
+  for (size_t i=0; i<worker_count; i++)
+    m_threads.push_back(thread(&DecompressionPool::worker_loop, this));
+}
+
+DecompressionPool::~DecompressionPool() {
+  {
+    lock_guard<mutex> lock(m_mutex);
+    m_shutdown = true;
+  }
+  m_submit_cond.notify_all();
+  for (auto &t : m_threads)
+    t.join();
+}
+
+void DecompressionPool::inflate(BlockCompressionCodec *codec,
+                                const DynamicBuffer &input,
+                                DynamicBuffer &output, BlockHeader &header) {
+  JobPtr job = make_shared<Job>();
+  job->codec = codec;
+  job->input = &input;
+  job->output = &output;
+  job->header = &header;
+
+  {
+    unique_lock<mutex> lock(m_mutex);
+
+    // With the workers busy and a backlog already queued, waiting in line
+    // costs more than the inflate itself; degrade to the traditional
+    // inline behavior under saturation
+    if (m_jobs.size() >= m_threads.size() * 2) {
+      lock.unlock();
+      codec->inflate(input, output, header);
+      return;
+    }
+
+    m_jobs.push_back(job);
+    m_submit_cond.notify_one();
+
+    while (!job->finished)
+      m_finished_cond.wait(lock);
+  }
+
+  if (job->error != Error::OK)
+    HT_THROW(job->error, job->error_msg);
+}
+
+void DecompressionPool::worker_loop() {
+  while (true) {
+    JobPtr job;
+    {
+      unique_lock<mutex> lock(m_mutex);
+      while (m_jobs.empty() && !m_shutdown)
+        m_submit_cond.wait(lock);
+      if (m_jobs.empty())
+        return;
+      job = m_jobs.front();
+      m_jobs.pop_front();
+    }
+
+    int error = Error::OK;
+    String error_msg;
+    try {
+      job->codec->inflate(*job->input, *job->output, *job->header);
+    }
+    catch (Exception &e) {
+      error = e.code();
+      error_msg = e.what();
+    }
+
+    {
+      lock_guard<mutex> lock(m_mutex);
+      job->error = error;
+      job->error_msg = error_msg;
+      job->finished = true;
+    }
+    m_finished_cond.notify_all();
+  }
+}
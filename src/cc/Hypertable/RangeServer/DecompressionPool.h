@@ -0,0 +1,133 @@
+/* -*- c++ -*-
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 3 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/// @file
+/// Declarations for DecompressionPool.
+/// This file contains declarations for DecompressionPool, a worker pool
+/// to which scanners hand off cell store block decompression.
+
+#ifndef Hypertable_RangeServer_DecompressionPool_h
+#define Hypertable_RangeServer_DecompressionPool_h
+
+#include <Hypertable/Lib/BlockCompressionCodec.h>
+#include <Hypertable/Lib/BlockHeader.h>
+
+#include <Common/DynamicBuffer.h>
+#include <Common/String.h>
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Hypertable {
+
+  /// @addtogroup RangeServer
+  /// @{
+
+  /// Worker pool for scan-time block decompression.
+  /// Block decompression during scans traditionally runs inline on the
+  /// application queue thread serving the scan, so a handful of
+  /// decompression-heavy scans (e.g. zlib --best archival tables) can tie
+  /// every request worker up in the codec at once.  This class maintains a
+  /// fixed pool of worker threads to which scanners hand off inflate calls,
+  /// capping the number of blocks being decompressed concurrently at the
+  /// pool size regardless of how many scans are in flight; the calling
+  /// thread sleeps until its block is ready instead of competing for the
+  /// CPU.  When the pool is saturated beyond a small backlog the inflate is
+  /// performed inline instead, so the pool degrades to the traditional
+  /// behavior rather than queueing up latency.
+  ///
+  /// A job references the caller's buffers and codec and the caller always
+  /// waits for completion, so no data is copied and each scanner's codec
+  /// (which is not thread-safe) has at most one user at a time.
+  class DecompressionPool {
+  public:
+
+    /// Constructor.  Starts <code>worker_count</code> decompression threads.
+    /// @param worker_count Number of decompression worker threads
+    DecompressionPool(size_t worker_count);
+
+    /// Destructor.  Shuts down the worker threads.  Jobs already queued are
+    /// completed first, so no caller is left waiting.
+    ~DecompressionPool();
+
+    /** Decompresses a block on a pool worker, blocking until done.
+     * If the pool backlog already exceeds twice the worker count, the
+     * block is instead decompressed inline on the calling thread.  Errors
+     * raised by the codec are re-thrown on the calling thread.
+     * @param codec Block compression codec with which to inflate (owned by
+     * the caller, which must not use it until this call returns)
+     * @param input Compressed block
+     * @param output Filled in with the uncompressed block
+     * @param header Filled in with the decoded block header
+     */
+    void inflate(BlockCompressionCodec *codec, const DynamicBuffer &input,
+                 DynamicBuffer &output, BlockHeader &header);
+
+  private:
+
+    /// Decompression job state, referencing the caller's arguments
+    class Job {
+    public:
+      BlockCompressionCodec *codec {};
+      const DynamicBuffer *input {};
+      DynamicBuffer *output {};
+      BlockHeader *header {};
+      /// <i>true</i> once a worker has finished (or failed) the job
+      bool finished {};
+      /// %Error staged by the worker (Error::OK on success)
+      int error {};
+      /// %Error message staged by the worker
+      String error_msg;
+    };
+
+    typedef std::shared_ptr<Job> JobPtr;
+
+    /// Worker thread function
+    void worker_loop();
+
+    /// %Mutex for serializing access to the job queue
+    std::mutex m_mutex;
+
+    /// Condition variable signalling newly submitted jobs and shutdown
+    std::condition_variable m_submit_cond;
+
+    /// Condition variable signalling finished jobs
+    std::condition_variable m_finished_cond;
+
+    /// Queued jobs, in submission order
+    std::deque<JobPtr> m_jobs;
+
+    /// Worker threads
+    std::vector<std::thread> m_threads;
+
+    /// Set to <i>true</i> to shut down the worker threads
+    bool m_shutdown {};
+  };
+
+  /// @}
+
+}
+
+#endif // Hypertable_RangeServer_DecompressionPool_h
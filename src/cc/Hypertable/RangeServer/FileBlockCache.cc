@@ -22,11 +22,18 @@
 #include <Common/Compat.h>
 
 #include "FileBlockCache.h"
+#include "FlashBlockCache.h"
 
 #include <cassert>
+#include <fstream>
 #include <iostream>
+#include <sstream>
 #include <utility>
 
+extern "C" {
+#include <unistd.h>
+}
+
 using namespace Hypertable;
 using namespace std;
 
@@ -49,9 +56,48 @@ FileBlockCache::checkout(int file_id, uint64_t file_offset, uint8_t **blockp,
   HashIndex::iterator iter;
 
   m_accesses++;
-
-  if ((iter = hash_index.find(make_key(file_id, file_offset))) == hash_index.end())
+  FileStats &file_stats = m_file_stats[file_id];
+  file_stats.accesses++;
+
+  if ((iter = hash_index.find(make_key(file_id, file_offset))) == hash_index.end()) {
+
+    // Probe the flash tier.  The flash read happens under the cache mutex,
+    // but it is a single local flash read, still far cheaper than the
+    // remote storage round-trip a miss would otherwise cost.
+    if (m_flash_cache) {
+      uint8_t *block {};
+      uint32_t length {};
+      if (m_flash_cache->load(file_id, file_offset, &block, &length)) {
+        if (m_available < length)
+          make_room(length);
+        if (m_available < length) {
+          if ((length-m_available) <= (m_max_memory-m_limit)) {
+            m_limit += (length-m_available);
+            m_available += (length-m_available);
+          }
+          else {
+            delete [] block;
+            return false;
+          }
+        }
+        BlockCacheEntry entry(file_id, file_offset, EventPtr());
+        entry.block = block;
+        entry.length = length;
+        entry.ref_count = 1;
+        pair<Sequence::iterator, bool> insert_result = m_cache.push_back(entry);
+        assert(insert_result.second);
+        (void)insert_result;
+        m_available -= length;
+        m_file_memory[file_id] += length;
+        *blockp = block;
+        *lengthp = length;
+        m_hits++;
+        file_stats.hits++;
+        return true;
+      }
+    }
     return false;
+  }
 
   BlockCacheEntry entry = *iter;
   entry.ref_count++;
@@ -65,6 +111,7 @@ FileBlockCache::checkout(int file_id, uint64_t file_offset, uint8_t **blockp,
   *lengthp = (*insert_result.first).length;
 
   m_hits++;
+  file_stats.hits++;
   return true;
 }
 
@@ -85,7 +132,8 @@ void FileBlockCache::checkin(int file_id, uint64_t file_offset) {
 bool
 FileBlockCache::insert(int file_id, uint64_t file_offset,
 		       uint8_t *block, uint32_t length,
-                       const EventPtr &event, bool checkout) {
+                       const EventPtr &event, bool checkout,
+                       bool probationary) {
   lock_guard<mutex> lock(m_mutex);
   HashIndex &hash_index = m_cache.get<1>();
 
@@ -109,11 +157,15 @@ FileBlockCache::insert(int file_id, uint64_t file_offset,
   entry.length = length;
   entry.ref_count = checkout ? 1 : 0;
 
-  pair<Sequence::iterator, bool> insert_result = m_cache.push_back(entry);
+  // Probationary blocks enter at the eviction end of the LRU list;
+  // checkout() promotes them to the protected end on re-reference
+  pair<Sequence::iterator, bool> insert_result = probationary ?
+    m_cache.push_front(entry) : m_cache.push_back(entry);
   assert(insert_result.second);
   (void)insert_result;
 
   m_available -= length;
+  m_file_memory[file_id] += length;
 
   return true;
 }
@@ -164,8 +216,15 @@ int64_t FileBlockCache::make_room(int64_t amount) {
   int64_t amount_freed = 0;
   while (iter != m_cache.end()) {
     if ((*iter).ref_count == 0) {
+      if (m_flash_cache)
+        m_flash_cache->store((*iter).file_id, (*iter).file_offset,
+                             (*iter).block, (*iter).length);
       m_available += (*iter).length;
       amount_freed += (*iter).length;
+      map<int, int64_t>::iterator fm_iter = m_file_memory.find((*iter).file_id);
+      if (fm_iter != m_file_memory.end() &&
+          (fm_iter->second -= (*iter).length) <= 0)
+        m_file_memory.erase(fm_iter);
       if (!iter->event)
         delete [] iter->block;
       iter = m_cache.erase(iter);
@@ -178,6 +237,112 @@ int64_t FileBlockCache::make_room(int64_t amount) {
   return amount_freed;
 }
 
+void FileBlockCache::persist_index(const String &path) {
+  lock_guard<mutex> lock(m_mutex);
+  size_t count {};
+
+  ofstream out(path.c_str(), ios::out | ios::trunc);
+  if (!out.is_open()) {
+    HT_WARNF("Unable to open block cache index file '%s' for writing",
+             path.c_str());
+    return;
+  }
+
+  out << "BlockCacheIndex\t1\n";
+
+  // Walk LRU to MRU so that a reload which runs out of cache space drops
+  // the coldest blocks
+  for (auto &entry : m_cache) {
+    map<int, String>::iterator iter = m_file_names.find(entry.file_id);
+    if (iter == m_file_names.end())
+      continue;
+    out << iter->second << "\t" << entry.file_offset << "\t"
+        << entry.length << "\n";
+    count++;
+  }
+  out.close();
+
+  HT_INFOF("Persisted block cache index (%d blocks) to '%s'",
+           (int)count, path.c_str());
+}
+
+void FileBlockCache::load_index(const String &path) {
+  ifstream in(path.c_str());
+
+  if (!in.is_open())
+    return;
+
+  stringstream ss;
+  ss << in.rdbuf();
+  in.close();
+
+  import_index(ss.str(), path);
+
+  // The index only describes the process that wrote it; remove it so a
+  // subsequent unclean restart does not warm from stale data
+  ::unlink(path.c_str());
+}
+
+String FileBlockCache::export_index(const std::set<int> &file_ids) {
+  lock_guard<mutex> lock(m_mutex);
+  String text = "BlockCacheIndex\t1\n";
+  size_t count {};
+
+  // Walk LRU to MRU, matching persist_index()
+  for (auto &entry : m_cache) {
+    if (file_ids.count(entry.file_id) == 0)
+      continue;
+    map<int, String>::iterator iter = m_file_names.find(entry.file_id);
+    if (iter == m_file_names.end())
+      continue;
+    text += format("%s\t%lld\t%lld\n", iter->second.c_str(),
+                   (Lld)entry.file_offset, (Lld)entry.length);
+    count++;
+  }
+  return count ? text : String();
+}
+
+void FileBlockCache::import_index(const String &text, const String &origin) {
+  lock_guard<mutex> lock(m_mutex);
+  istringstream in(text);
+  String line;
+  size_t count {};
+
+  if (!getline(in, line) || line != "BlockCacheIndex\t1") {
+    HT_WARNF("Skipping block cache index from '%s' - unrecognized header",
+             origin.c_str());
+    return;
+  }
+
+  while (getline(in, line)) {
+    String filename;
+    int64_t offset, length;
+    istringstream iss(line);
+    if (!(iss >> filename >> offset >> length)) {
+      HT_WARNF("Skipping malformed block cache index entry '%s'",
+               line.c_str());
+      continue;
+    }
+    m_warmup_map[filename].push_back(make_pair(offset, length));
+    count++;
+  }
+
+  HT_INFOF("Loaded block cache index (%d blocks) from '%s'",
+           (int)count, origin.c_str());
+}
+
+bool
+FileBlockCache::get_warmup_extents(const String &filename,
+                                   std::vector<std::pair<int64_t, int64_t>> &extents) {
+  lock_guard<mutex> lock(m_mutex);
+  auto iter = m_warmup_map.find(filename);
+  if (iter == m_warmup_map.end())
+    return false;
+  extents.swap(iter->second);
+  m_warmup_map.erase(iter);
+  return true;
+}
+
 void FileBlockCache::get_stats(uint64_t *max_memoryp, uint64_t *available_memoryp,
                                uint64_t *accessesp, uint64_t *hitsp) {
   lock_guard<mutex> lock(m_mutex);
@@ -25,6 +25,7 @@
 #include <AsyncComm/Event.h>
 
 #include <Common/Logger.h>
+#include <Common/String.h>
 
 #include <boost/multi_index_container.hpp>
 #include <boost/multi_index/hashed_index.hpp>
@@ -32,11 +33,17 @@
 #include <boost/multi_index/sequenced_index.hpp>
 
 #include <atomic>
+#include <map>
 #include <mutex>
+#include <set>
+#include <utility>
+#include <vector>
 
 namespace Hypertable {
   using namespace boost::multi_index;
 
+  class FlashBlockCache;
+
   class FileBlockCache {
 
     static std::atomic<int> ms_next_file_id;
@@ -50,12 +57,33 @@ namespace Hypertable {
 
     bool compressed() { return m_compressed; }
 
+    /**
+     * Attaches a flash-backed second tier.  Blocks evicted by make_room()
+     * are spilled to <code>flash_cache</code> and a checkout() miss probes
+     * it before giving up, turning a remote storage round-trip into a local
+     * flash read.
+     */
+    void set_flash_cache(FlashBlockCache *flash_cache) {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_flash_cache = flash_cache;
+    }
+
     bool checkout(int file_id, uint64_t file_offset, uint8_t **blockp,
                   uint32_t *lengthp);
     void checkin(int file_id, uint64_t file_offset);
+
+    /**
+     * Inserts a block into the cache.  When <code>probationary</code> is set
+     * (supplied by scanners that have detected sequential access), the block
+     * is admitted at the eviction end of the LRU list, so a long scan evicts
+     * its own blocks under memory pressure instead of flushing the
+     * re-referenced hot set.  A subsequent checkout promotes a probationary
+     * block to the protected end like any other entry.
+     */
     bool insert(int file_id, uint64_t file_offset,
-		uint8_t *block, uint32_t length, 
-                const EventPtr &event, bool checkout);
+		uint8_t *block, uint32_t length,
+                const EventPtr &event, bool checkout,
+                bool probationary = false);
     bool contains(int file_id, uint64_t file_offset);
 
     void increase_limit(int64_t amount);
@@ -97,6 +125,45 @@ namespace Hypertable {
       return (int64_t)(m_limit - m_available);
     }
 
+    /**
+     * Returns the amount of cached block data belonging to a file
+     *
+     * @param file_id File ID of the associated CellStore
+     * @return bytes of block data cached for 'file_id'
+     */
+    int64_t memory_used_by_file(int file_id) {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      std::map<int, int64_t>::iterator iter = m_file_memory.find(file_id);
+      return (iter == m_file_memory.end()) ? 0 : iter->second;
+    }
+
+    /// Cumulative block access and hit counts for one file
+    class FileStats {
+    public:
+      uint64_t accesses {};
+      uint64_t hits {};
+    };
+
+    /**
+     * Returns the block access and hit counts for a file.  Counts are
+     * cumulative over the life of the associated CellStore and are used to
+     * derive per-range block cache hit rates for <code>sys/RS_METRICS</code>.
+     *
+     * @param file_id File ID of the associated CellStore
+     * @param accessesp Filled in with block access count for 'file_id'
+     * @param hitsp Filled in with block hit count for 'file_id'
+     */
+    void get_file_stats(int file_id, uint64_t *accessesp, uint64_t *hitsp) {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      std::map<int, FileStats>::iterator iter = m_file_stats.find(file_id);
+      if (iter == m_file_stats.end())
+        *accessesp = *hitsp = 0;
+      else {
+        *accessesp = iter->second.accesses;
+        *hitsp = iter->second.hits;
+      }
+    }
+
     int64_t available() {
       std::lock_guard<std::mutex> lock(m_mutex);
       return m_available;
@@ -105,6 +172,99 @@ namespace Hypertable {
     static int get_next_file_id() {
       return ++ms_next_file_id;
     }
+
+    /**
+     * Associates a cellstore pathname with a file ID.  File IDs are
+     * assigned at runtime and do not survive a restart, so the index
+     * persisted by persist_index() is keyed by pathname; only blocks
+     * belonging to registered files can be persisted.
+     *
+     * @param file_id File ID of the associated CellStore
+     * @param filename Pathname of the associated CellStore
+     */
+    void register_file(int file_id, const String &filename) {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_file_names[file_id] = filename;
+    }
+
+    /**
+     * Removes a file ID to pathname association.  Called from the CellStore
+     * destructor; once the store is gone its cached blocks are dead weight
+     * and should not be carried into the persisted index.
+     *
+     * @param file_id File ID of the associated CellStore
+     */
+    void unregister_file(int file_id) {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_file_names.erase(file_id);
+      m_file_stats.erase(file_id);
+    }
+
+    /**
+     * Persists the cache index to a local file.  Writes one line per
+     * resident block (cellstore pathname, file offset, in-cache length) in
+     * LRU-to-MRU order.  Called from the clean shutdown path so that a
+     * restarted server can re-warm itself via load_index() and the prewarm
+     * maintenance tasks instead of taking cache misses for tens of minutes.
+     *
+     * @param path Pathname of local index file
+     */
+    void persist_index(const String &path);
+
+    /**
+     * Loads a persisted cache index written by persist_index().  The
+     * parsed extents are held until the corresponding cellstores are
+     * opened and claim them via get_warmup_extents() from a prewarm
+     * maintenance task.  The index file is removed after a successful
+     * load since it only describes the process that wrote it.
+     *
+     * @param path Pathname of local index file
+     */
+    void load_index(const String &path);
+
+    /**
+     * Exports a cache index covering a subset of files.  Produces the same
+     * text format as persist_index() (header plus one line per resident
+     * block in LRU-to-MRU order), restricted to the given file IDs.  Used
+     * by the range relinquish path to stage a hot-block manifest for the
+     * destination server of a range move.
+     *
+     * @param file_ids File IDs whose resident blocks should be exported
+     * @return Index text, or an empty string if none of the files have
+     * resident blocks
+     */
+    String export_index(const std::set<int> &file_ids);
+
+    /**
+     * Imports a cache index from text produced by persist_index() or
+     * export_index().  The parsed extents are added to the pending warmup
+     * set, to be claimed via get_warmup_extents() from a prewarm
+     * maintenance task.
+     *
+     * @param text Index text
+     * @param origin Description of where the index came from, for logging
+     */
+    void import_index(const String &text, const String &origin);
+
+    /**
+     * Claims the warmup extents for a cellstore.  Returns the (offset,
+     * length) pairs recorded for <code>filename</code> by a previous
+     * process and removes them from the pending set; each store's extents
+     * can be claimed only once.
+     *
+     * @param filename Pathname of the associated CellStore
+     * @param extents Filled in with (file offset, length) pairs
+     * @return <i>true</i> if extents were recorded for <code>filename</code>
+     */
+    bool get_warmup_extents(const String &filename,
+                            std::vector<std::pair<int64_t, int64_t>> &extents);
+
+    /// Checks if any loaded warmup extents remain unclaimed.
+    bool warmup_pending() {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      return !m_warmup_map.empty();
+    }
+
     void get_stats(uint64_t *max_memoryp, uint64_t *available_memoryp,
                    uint64_t *accessesp, uint64_t *hitsp);
   private:
@@ -158,6 +318,10 @@ namespace Hypertable {
 
     std::mutex m_mutex;
     BlockCache    m_cache;
+    std::map<int, int64_t> m_file_memory;
+    std::map<int, FileStats> m_file_stats;
+    std::map<int, String> m_file_names;
+    std::map<String, std::vector<std::pair<int64_t, int64_t>>> m_warmup_map;
     int64_t      m_min_memory;
     int64_t      m_max_memory;
     int64_t      m_limit;
@@ -165,6 +329,7 @@ namespace Hypertable {
     uint64_t     m_accesses;
     uint64_t     m_hits;
     bool         m_compressed;
+    FlashBlockCache *m_flash_cache {};
   };
 
 }
@@ -22,11 +22,33 @@
 #include "Common/Compat.h"
 #include "FillScanBlock.h"
 
+#include <Hypertable/Lib/ScanBlock.h>
+
+#include <Common/BlobHashTraits.h>
+#include <Common/Error.h>
+#include <Common/Time.h>
+
+#include <cstdlib>
+#include <unordered_map>
+
+namespace {
+
+  /// Qualifier dictionary for the format 2 encoder.  Keys are Blobs
+  /// pointing at the inline qualifier bytes already written to the scan
+  /// block buffer, which is reserved once and never reallocated, so no
+  /// per-cell string copies are needed.
+  typedef std::unordered_map<Hypertable::Blob, uint32_t,
+                             Hypertable::BlobHashTraits<>::hasher,
+                             Hypertable::BlobHashTraits<>::key_equal>
+    QualifierIndexMap;
+}
+
 namespace Hypertable {
 
   bool
   FillScanBlock(MergeScannerRangePtr &scanner, DynamicBuffer &dbuf,
-                uint32_t *cell_count, int64_t buffer_size) {
+                uint32_t *cell_count, int64_t buffer_size,
+                uint8_t scan_block_format, size_t tail_reserve) {
     Key key;
     ByteString value;
     size_t value_len;
@@ -39,7 +61,9 @@ namespace Hypertable {
     char numbuf[24];
     DynamicBuffer counter_value;
     bool counter;
-    String empty_value("");
+    const char *prev_row = "";
+    size_t prev_row_len = 0;
+    QualifierIndexMap qualifier_index;
 
     assert(dbuf.base == 0);
 
@@ -81,7 +105,7 @@ namespace Hypertable {
       }
 
       if (value.ptr == 0) {
-        value.ptr = (const uint8_t *)empty_value.c_str();
+        value.ptr = (const uint8_t *)"";
         value_len = 1;
       }
 
@@ -90,13 +114,69 @@ namespace Hypertable {
           limit = key.length + value_len;
           remaining = limit;
         }
-        dbuf.reserve(4 + limit);
+        dbuf.reserve(4 + limit + tail_reserve);
         // skip encoded length
         dbuf.ptr = dbuf.base + 4;
       }
+      // Buffer accounting is always done with the format 1 encoded size; a
+      // format 2 cell is never larger than its format 1 encoding (the delta
+      // flags byte replaces the key length vint, row sharing and qualifier
+      // indices only shrink cells), so the initial reservation remains valid.
       if (key.length + value_len <= remaining) {
 
-        dbuf.add_unchecked(key.serial.ptr, key.length);
+        if (scan_block_format >= 2) {
+          size_t trailing_len
+            = (key.serial.ptr + key.length) - (key.flag_ptr + 1);
+          size_t qualifier_len = key.column_qualifier_len;
+          uint8_t dflags = 0;
+          uint32_t index = 0;
+          bool use_index = false;
+
+          if (prev_row_len == key.row_len &&
+              !memcmp(prev_row, key.row, key.row_len))
+            dflags |= ScanBlockFormatV2::ROW_SHARED;
+
+          if (qualifier_len
+              >= ScanBlockFormatV2::DICTIONARY_MIN_QUALIFIER_LENGTH) {
+            auto iter = qualifier_index.find(
+                Blob(key.column_qualifier, qualifier_len));
+            if (iter != qualifier_index.end()) {
+              dflags |= ScanBlockFormatV2::QUALIFIER_INDEX;
+              index = iter->second;
+              use_index = true;
+            }
+          }
+
+          dbuf.add_unchecked(&dflags, 1);
+          dbuf.add_unchecked(&key.control, 1);
+          if ((dflags & ScanBlockFormatV2::ROW_SHARED) == 0) {
+            // track the previous row via the copy just written to the scan
+            // block buffer; the buffer is reserved once so the pointer is
+            // stable for the remainder of the fill
+            prev_row = (const char *)dbuf.add_unchecked(key.row,
+                                                        key.row_len + 1);
+            prev_row_len = key.row_len;
+          }
+          dbuf.add_unchecked(&key.column_family_code, 1);
+          if (use_index)
+            Serialization::encode_vi32(&dbuf.ptr, index);
+          else {
+            uint8_t *inline_qualifier =
+              dbuf.add_unchecked(key.column_qualifier, qualifier_len + 1);
+            if (qualifier_len
+                >= ScanBlockFormatV2::DICTIONARY_MIN_QUALIFIER_LENGTH
+                && qualifier_index.size()
+                   < ScanBlockFormatV2::DICTIONARY_MAX_ENTRIES) {
+              uint32_t next_index = (uint32_t)qualifier_index.size();
+              qualifier_index[Blob(inline_qualifier, qualifier_len)] =
+                next_index;
+            }
+          }
+          dbuf.add_unchecked(&key.flag, 1);
+          dbuf.add_unchecked(key.flag_ptr + 1, trailing_len);
+        }
+        else
+          dbuf.add_unchecked(key.serial.ptr, key.length);
 
         if (counter)
           dbuf.add_unchecked(counter_value.base, value_len);
@@ -111,7 +191,7 @@ namespace Hypertable {
     }
 
     if (dbuf.base == 0) {
-      dbuf.reserve(4);
+      dbuf.reserve(4 + tail_reserve);
       dbuf.ptr = dbuf.base + 4;
     }
 
@@ -121,4 +201,106 @@ namespace Hypertable {
     return more;
   }
 
+  bool
+  FillScanBlockAggregate(MergeScannerRangePtr &scanner, DynamicBuffer &dbuf,
+                         uint32_t *cell_count) {
+    Key key;
+    ByteString value;
+    ScanContext *scan_context = scanner->scan_context();
+    uint8_t aggregation = scan_context->spec->aggregation;
+    int64_t count = 0;
+    int64_t sum = 0;
+    int64_t extreme = 0;
+    bool have_cell = false;
+    String first_row, prev_row;
+    uint8_t family_code = 0;
+    char numbuf[24];
+    uint8_t *ptr;
+
+    assert(dbuf.base == 0);
+
+    while (scanner->get(key, value)) {
+
+      if (!have_cell) {
+        have_cell = true;
+        first_row.assign(key.row, key.row_len);
+        family_code = key.column_family_code;
+      }
+
+      if (aggregation == ScanSpec::AGGREGATION_COUNT)
+        count++;
+      else if (aggregation == ScanSpec::AGGREGATION_COUNT_ROWS) {
+        if (prev_row.length() != key.row_len ||
+            memcmp(prev_row.c_str(), key.row, key.row_len)) {
+          count++;
+          prev_row.assign(key.row, key.row_len);
+        }
+      }
+      else {
+        int64_t number;
+        const uint8_t *decode;
+        size_t remain = value.decode_length(&decode);
+
+        if (scan_context->cell_predicates[key.column_family_code].counter &&
+            key.flag == FLAG_INSERT && remain == 9)
+          number = Serialization::decode_i64(&decode, &remain);
+        else {
+          String text((const char *)decode, remain);
+          char *endptr;
+          number = strtoll(text.c_str(), &endptr, 0);
+          if (endptr == text.c_str())
+            HT_THROWF(Error::RANGESERVER_BAD_SCAN_SPEC,
+                      "Non-numeric value for aggregation at key %s:%s",
+                      key.row, key.column_qualifier ? key.column_qualifier : "");
+        }
+
+        if (aggregation == ScanSpec::AGGREGATION_SUM)
+          sum += number;
+        else if (aggregation == ScanSpec::AGGREGATION_MIN) {
+          if (count == 0 || number < extreme)
+            extreme = number;
+        }
+        else {
+          if (count == 0 || number > extreme)
+            extreme = number;
+        }
+        count++;
+      }
+
+      scanner->forward();
+    }
+
+    if (have_cell) {
+      int64_t result;
+      if (aggregation == ScanSpec::AGGREGATION_SUM)
+        result = sum;
+      else if (aggregation == ScanSpec::AGGREGATION_MIN ||
+               aggregation == ScanSpec::AGGREGATION_MAX)
+        result = extreme;
+      else
+        result = count;
+      sprintf(numbuf, "%lld", (Lld)result);
+      size_t value_len = strlen(numbuf);
+      int64_t timestamp = get_ts64();
+      dbuf.reserve(4 + first_row.length() + value_len + 64);
+      dbuf.ptr = dbuf.base + 4;
+      create_key_and_append(dbuf, FLAG_INSERT, first_row.c_str(), family_code,
+                            "", timestamp, timestamp);
+      append_as_byte_string(dbuf, numbuf, value_len);
+      if (cell_count)
+        *cell_count = 1;
+    }
+    else {
+      dbuf.reserve(4);
+      dbuf.ptr = dbuf.base + 4;
+      if (cell_count)
+        *cell_count = 0;
+    }
+
+    ptr = dbuf.base;
+    Serialization::encode_i32(&ptr, dbuf.fill() - 4);
+
+    return false;
+  }
+
 }
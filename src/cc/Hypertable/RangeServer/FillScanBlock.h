@@ -49,10 +49,36 @@ namespace Hypertable {
   /// @param cell_count Address of variable to hold number of cells in the scan
   /// block.
   /// @param buffer_size Target size of scan block
+  /// @param scan_block_format Scan block format version; 1 produces
+  /// length-prefixed serialized keys, 2 produces the delta encoding
+  /// described in ScanBlockFormatV2
+  /// @param tail_reserve Extra bytes of capacity to reserve in
+  /// <code>dbuf</code> beyond the encoded results, allowing the caller to
+  /// append trailing data (e.g. query cache key strings) without
+  /// reallocating the buffer
   /// @return <i>true</i> if there are more results to be pulled from the
   /// scanner when this function returns, <i>false</i> otherwise.
   bool FillScanBlock(MergeScannerRangePtr &scanner, DynamicBuffer &dbuf,
-                     uint32_t *cell_count, int64_t buffer_size);
+                     uint32_t *cell_count, int64_t buffer_size,
+                     uint8_t scan_block_format = 1, size_t tail_reserve = 0);
+
+  /// Reduces scan results to a single aggregate cell.
+  /// Drains <code>scanner</code> completely, evaluating the aggregation
+  /// operator given in the scan specification (see ScanSpec::Aggregation)
+  /// over the matching cells, and serializes a single result cell into
+  /// <code>dbuf</code> in scan block format 1.  The result cell carries the
+  /// row key and column family of the first matching cell and its value is
+  /// the ASCII representation of the aggregate.  Values of COUNTER columns
+  /// are interpreted natively; other values must be ASCII numbers or the
+  /// scan fails with Error::RANGESERVER_BAD_SCAN_SPEC.  If the scan matches
+  /// no cells, an empty scan block is produced.
+  /// @param scanner Scanner from which results are to be obtained
+  /// @param dbuf Buffer to hold encoded result
+  /// @param cell_count Address of variable to hold number of cells in the
+  /// scan block.
+  /// @return <i>false</i> always, since the scanner is drained.
+  bool FillScanBlockAggregate(MergeScannerRangePtr &scanner,
+                              DynamicBuffer &dbuf, uint32_t *cell_count);
 
   /// @}
 
@@ -0,0 +1,154 @@
+/*
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 3 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/// @file
+/// Definitions for FlashBlockCache.
+/// This file contains type definitions for FlashBlockCache, a second-tier
+/// block cache backed by a local flash file.
+
+#include <Common/Compat.h>
+
+#include "FlashBlockCache.h"
+
+#include <Common/Checksum.h>
+#include <Common/FileUtils.h>
+
+#include <cerrno>
+#include <cstring>
+
+extern "C" {
+#include <fcntl.h>
+#include <unistd.h>
+}
+
+using namespace Hypertable;
+using namespace std;
+
+FlashBlockCache::FlashBlockCache(const String &path, int64_t max_size)
+  : m_path(path), m_max_size(max_size) {
+  HT_ASSERT(max_size > 0);
+  if ((m_fd = ::open(path.c_str(), O_CREAT|O_TRUNC|O_RDWR, 0644)) < 0)
+    HT_ERRORF("Unable to create flash block cache file '%s' - %s",
+              path.c_str(), strerror(errno));
+}
+
+FlashBlockCache::~FlashBlockCache() {
+  lock_guard<mutex> lock(m_mutex);
+  if (m_fd != -1) {
+    ::close(m_fd);
+    ::unlink(m_path.c_str());
+    m_fd = -1;
+  }
+}
+
+void FlashBlockCache::store(int file_id, uint64_t file_offset,
+                            const uint8_t *block, uint32_t length) {
+  lock_guard<mutex> lock(m_mutex);
+
+  if (m_fd == -1 || (int64_t)length > m_max_size)
+    return;
+
+  int64_t key = make_key(file_id, file_offset);
+
+  if (m_index.find(key) != m_index.end())
+    return;
+
+  // Blocks never span the end of the cache file; wrap the log instead
+  if (m_write_offset + (int64_t)length > m_max_size)
+    m_write_offset = 0;
+
+  int64_t end = m_write_offset + (int64_t)length;
+
+  // Drop entries overwritten by this write.  The log is written
+  // contiguously from the beginning of the file after each wrap, so no
+  // surviving extent can start below the write offset and span into it.
+  auto iter = m_extent_map.lower_bound(m_write_offset);
+  while (iter != m_extent_map.end() && iter->first < end) {
+    m_index.erase(iter->second);
+    iter = m_extent_map.erase(iter);
+  }
+
+  if (::pwrite(m_fd, block, length, m_write_offset) != (ssize_t)length) {
+    HT_ERRORF("Error writing block to flash block cache file '%s' - %s",
+              m_path.c_str(), strerror(errno));
+    ::close(m_fd);
+    m_fd = -1;
+    m_index.clear();
+    m_extent_map.clear();
+    return;
+  }
+
+  IndexEntry entry;
+  entry.extent_offset = m_write_offset;
+  entry.length = length;
+  entry.checksum = fletcher32(block, length);
+  m_index[key] = entry;
+  m_extent_map[m_write_offset] = key;
+
+  m_write_offset = end;
+  if (end > m_fill)
+    m_fill = end;
+}
+
+bool FlashBlockCache::load(int file_id, uint64_t file_offset,
+                           uint8_t **blockp, uint32_t *lengthp) {
+  lock_guard<mutex> lock(m_mutex);
+
+  m_accesses++;
+
+  if (m_fd == -1)
+    return false;
+
+  auto iter = m_index.find(make_key(file_id, file_offset));
+
+  if (iter == m_index.end())
+    return false;
+
+  const IndexEntry &entry = iter->second;
+  uint8_t *block = new uint8_t [entry.length];
+
+  if (FileUtils::pread(m_fd, block, entry.length, entry.extent_offset)
+          != (ssize_t)entry.length ||
+      fletcher32(block, entry.length) != entry.checksum) {
+    HT_WARNF("Dropping corrupt or unreadable block at offset %lld of flash "
+             "block cache file '%s'", (Lld)entry.extent_offset,
+             m_path.c_str());
+    delete [] block;
+    m_extent_map.erase(entry.extent_offset);
+    m_index.erase(iter);
+    return false;
+  }
+
+  *blockp = block;
+  *lengthp = entry.length;
+
+  m_hits++;
+  return true;
+}
+
+void FlashBlockCache::get_stats(uint64_t *max_sizep, uint64_t *fillp,
+                                uint64_t *accessesp, uint64_t *hitsp) {
+  lock_guard<mutex> lock(m_mutex);
+  *max_sizep = m_max_size;
+  *fillp = m_fill;
+  *accessesp = m_accesses;
+  *hitsp = m_hits;
+}
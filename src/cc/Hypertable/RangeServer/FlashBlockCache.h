@@ -0,0 +1,157 @@
+/* -*- c++ -*-
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 3 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/// @file
+/// Declarations for FlashBlockCache.
+/// This file contains type declarations for FlashBlockCache, a second-tier
+/// block cache backed by a local flash file.
+
+#ifndef Hypertable_RangeServer_FlashBlockCache_h
+#define Hypertable_RangeServer_FlashBlockCache_h
+
+#include <Common/Logger.h>
+#include <Common/String.h>
+
+#include <map>
+#include <mutex>
+#include <unordered_map>
+
+namespace Hypertable {
+
+  /// @addtogroup RangeServer
+  /// @{
+
+  /// Second-tier block cache backed by a local flash file.
+  /// Blocks evicted from the in-memory block cache are spilled to a
+  /// preallocated file on local flash, so that on deployments where cell
+  /// store data lives in remote storage a subsequent miss becomes a local
+  /// read instead of a network round-trip.  The file is managed as a
+  /// circular log:  blocks are appended at the write offset and the log
+  /// wraps when it reaches the configured maximum size, dropping whatever
+  /// entries get overwritten.  The index is held in memory and each entry
+  /// carries a fletcher32 checksum which is verified on load, so nothing
+  /// needs to survive a restart and torn writes are detected and dropped.
+  class FlashBlockCache {
+
+  public:
+
+    /// Constructor.
+    /// Creates (truncating if present) the cache file at <code>path</code>.
+    /// If the file cannot be created, an error is logged and the cache
+    /// remains permanently empty.
+    /// @param path Pathname of cache file
+    /// @param max_size Maximum size of cache file
+    FlashBlockCache(const String &path, int64_t max_size);
+
+    /// Destructor.
+    /// Closes and unlinks the cache file.
+    ~FlashBlockCache();
+
+    /// Stores a block in the cache.
+    /// The block is written at the current write offset, wrapping the log
+    /// first if it does not fit, and any existing entries overwritten by the
+    /// write are dropped from the index.  Blocks larger than the cache file
+    /// and blocks already present are ignored.  On a write error the cache
+    /// disables itself.
+    /// @param file_id File ID of the associated CellStore
+    /// @param file_offset Offset of block within CellStore file
+    /// @param block Pointer to block data
+    /// @param length Length of block data
+    void store(int file_id, uint64_t file_offset, const uint8_t *block,
+               uint32_t length);
+
+    /// Loads a block from the cache.
+    /// If an entry for the block exists, the block is read from the cache
+    /// file into a newly allocated buffer (returned in <code>blockp</code>,
+    /// owned by the caller) and its checksum verified.  An entry that fails
+    /// the checksum is dropped and reported as a miss.
+    /// @param file_id File ID of the associated CellStore
+    /// @param file_offset Offset of block within CellStore file
+    /// @param blockp Address of pointer to hold allocated block data
+    /// @param lengthp Address of variable to hold block length
+    /// @return <i>true</i> if block was loaded, <i>false</i> otherwise
+    bool load(int file_id, uint64_t file_offset, uint8_t **blockp,
+              uint32_t *lengthp);
+
+    /// Gets cache statistics.
+    /// @param max_sizep Address of variable to hold maximum cache file size
+    /// @param fillp Address of variable to hold high-water cache file fill
+    /// @param accessesp Address of variable to hold access count
+    /// @param hitsp Address of variable to hold hit count
+    void get_stats(uint64_t *max_sizep, uint64_t *fillp, uint64_t *accessesp,
+                   uint64_t *hitsp);
+
+  private:
+
+    inline static int64_t make_key(int file_id, uint64_t file_offset) {
+      HT_ASSERT(file_id < 268435456LL);        // Can't be larger than 2^28
+      HT_ASSERT(file_offset < 68719476736LL);  // Can't be larger than 2^36
+      return ((int64_t)file_id << 36) | (int64_t)file_offset;
+    }
+
+    /// In-memory index entry describing one block in the cache file
+    class IndexEntry {
+    public:
+      /// Offset of block within cache file
+      int64_t extent_offset {};
+      /// Length of block
+      uint32_t length {};
+      /// Fletcher32 checksum of block data
+      uint32_t checksum {};
+    };
+
+    /// %Mutex to serialize concurrent access
+    std::mutex m_mutex;
+
+    /// Pathname of cache file
+    String m_path;
+
+    /// Cache file descriptor (-1 if creation failed or cache disabled)
+    int m_fd {-1};
+
+    /// Maximum size of cache file
+    int64_t m_max_size;
+
+    /// Offset in cache file where the next block is written
+    int64_t m_write_offset {};
+
+    /// High-water fill of cache file
+    int64_t m_fill {};
+
+    /// Block index, keyed by file ID and file offset
+    std::unordered_map<int64_t, IndexEntry> m_index;
+
+    /// Extent map (cache file offset to index key) used to drop entries
+    /// overwritten when the log wraps
+    std::map<int64_t, int64_t> m_extent_map;
+
+    /// Access count
+    uint64_t m_accesses {};
+
+    /// Hit count
+    uint64_t m_hits {};
+  };
+
+  /// @}
+
+}
+
+#endif // Hypertable_RangeServer_FlashBlockCache_h
@@ -40,6 +40,7 @@ namespace Hypertable {
   PseudoTables          *Global::pseudo_tables = 0;
   MetaLogEntityRemoveOkLogsPtr Global::remove_ok_logs;
   LoadStatisticsPtr      Global::load_statistics;
+  MaintenanceThrottlePtr Global::maintenance_throttle;
   RangesPtr              Global::ranges;
   bool                   Global::verbose = false;
   bool                   Global::row_size_unlimited = false;
@@ -59,6 +60,11 @@ namespace Hypertable {
   int32_t                Global::access_group_max_mem = 0;
   int32_t                Global::cell_cache_scanner_cache_size = 0;
   FileBlockCache        *Global::block_cache = 0;
+  FileBlockCache        *Global::compressed_block_cache = 0;
+  FlashBlockCache       *Global::flash_block_cache = 0;
+  ReadaheadBudget       *Global::readahead_budget = 0;
+  DecompressionPool     *Global::decompression_pool = 0;
+  HotKeyDetector        *Global::hot_key_detector = 0;
   TablePtr               Global::metadata_table = 0;
   TablePtr               Global::rs_metrics_table = 0;
   int64_t                Global::range_metadata_split_size = 0;
@@ -73,8 +79,13 @@ namespace Hypertable {
   uint64_t               Global::access_counter = 0;
   bool                   Global::enable_shadow_cache = true;
   std::string            Global::toplevel_dir;
+  std::string            Global::cell_cache_checkpoint_dir;
+  StringSet              Global::cell_cache_checkpoint_manifest;
+  bool                   Global::cell_cache_handoff_valid = false;
+  std::atomic<int32_t>   Global::cell_cache_restore_failures {0};
   int32_t                Global::metrics_interval = 0;
   int32_t                Global::merge_cellstore_run_length_threshold = 0;
+  int32_t                Global::cellstore_preadv_blocks = 0;
   bool                   Global::ignore_clock_skew_errors = false;
   ConnectionManagerPtr   Global::conn_manager;
   std::vector<MetaLog::EntityTaskPtr>  Global::work_queue;
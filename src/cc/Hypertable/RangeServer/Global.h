@@ -22,6 +22,7 @@
 #ifndef HYPERTABLE_RANGESERVER_GLOBAL_H
 #define HYPERTABLE_RANGESERVER_GLOBAL_H
 
+#include <atomic>
 #include <string>
 
 #include <boost/thread/thread.hpp>
@@ -42,11 +43,16 @@
 #include "Hypertable/Lib/RangeSpec.h"
 #include "Hypertable/Lib/TableIdentifier.h"
 
+#include "DecompressionPool.h"
 #include "FileBlockCache.h"
+#include "FlashBlockCache.h"
+#include "HotKeyDetector.h"
 #include "LoadStatistics.h"
 #include "LocationInitializer.h"
 #include "MaintenanceQueue.h"
+#include "MaintenanceThrottle.h"
 #include "MemoryTracker.h"
+#include "ReadaheadBudget.h"
 #include "MetaLogEntityTask.h"
 #include "MetaLogEntityRemoveOkLogs.h"
 #include "TableInfo.h"
@@ -70,6 +76,7 @@ namespace Hypertable {
     static Hypertable::PseudoTables *pseudo_tables;
     static MetaLogEntityRemoveOkLogsPtr remove_ok_logs;
     static LoadStatisticsPtr load_statistics;
+    static MaintenanceThrottlePtr maintenance_throttle;
     static RangesPtr      ranges;
     static bool           verbose;
     static bool           row_size_unlimited;
@@ -88,6 +95,11 @@ namespace Hypertable {
     static int32_t        access_group_max_mem;
     static int32_t        cell_cache_scanner_cache_size;
     static Hypertable::FileBlockCache *block_cache;
+    static Hypertable::FileBlockCache *compressed_block_cache;
+    static Hypertable::FlashBlockCache *flash_block_cache;
+    static Hypertable::ReadaheadBudget *readahead_budget;
+    static Hypertable::DecompressionPool *decompression_pool;
+    static Hypertable::HotKeyDetector *hot_key_detector;
     static TablePtr       metadata_table;
     static TablePtr       rs_metrics_table;
     static int64_t        range_metadata_split_size;
@@ -106,8 +118,18 @@ namespace Hypertable {
     static uint64_t       access_counter;
     static bool           enable_shadow_cache;
     static std::string    toplevel_dir;
+    /// Local directory holding cell cache checkpoint files (empty disables)
+    static std::string    cell_cache_checkpoint_dir;
+    /// Checkpoint files listed in the handoff manifest written at the last
+    /// clean shutdown (loaded once in local_recover(), read-only afterwards)
+    static StringSet      cell_cache_checkpoint_manifest;
+    /// <i>true</i> if a valid handoff manifest was loaded
+    static bool           cell_cache_handoff_valid;
+    /// Number of manifest-listed checkpoints that failed to restore
+    static std::atomic<int32_t> cell_cache_restore_failures;
     static int32_t        metrics_interval;
     static int32_t        merge_cellstore_run_length_threshold;
+    static int32_t        cellstore_preadv_blocks;
     static bool           ignore_clock_skew_errors;
     static bool           range_initialization_complete;
     static ConnectionManagerPtr conn_manager;
@@ -21,10 +21,13 @@
 #include <Common/Compat.h>
 #include "GroupCommit.h"
 
+#include <Hypertable/RangeServer/Global.h>
 #include <Hypertable/RangeServer/RangeServer.h>
 #include <Hypertable/RangeServer/UpdateRecTable.h>
 #include <Hypertable/RangeServer/UpdateRequest.h>
 
+#include <Hypertable/Lib/RangeServer/Protocol.h>
+
 #include <Common/Config.h>
 
 using namespace Hypertable;
@@ -34,6 +37,7 @@ using namespace std;
 GroupCommit::GroupCommit(Apps::RangeServer *range_server) : m_range_server(range_server) {
 
   m_commit_interval = get_i32("Hypertable.RangeServer.CommitInterval");
+  m_max_latency = get_i32("Hypertable.RangeServer.GroupCommit.MaxLatency");
 
 }
 
@@ -60,7 +64,14 @@ GroupCommit::add(EventPtr &event, uint64_t cluster_id, SchemaPtr &schema,
     tu->cluster_id = cluster_id;
     tu->id = key.second;
     tu->commit_interval = schema->get_group_commit_interval();
+    if (tu->commit_interval == 0) {
+      // Deferred sync tables without an explicit group commit interval
+      // batch at the base commit interval
+      tu->commit_interval = m_commit_interval;
+    }
     tu->commit_iteration = (tu->commit_interval+(m_commit_interval-1)) / m_commit_interval;
+    if (schema->get_deferred_log_sync())
+      tu->flags |= Lib::RangeServer::Protocol::UPDATE_FLAG_NO_LOG_SYNC;
     tu->total_count = count;
     tu->total_buffer_size = buffer.size;
     tu->expire_time = expire_time;
@@ -85,9 +96,21 @@ void GroupCommit::trigger() {
 
   m_counter++;
 
+  // When adaptive batching is enabled, stretch the flush interval to
+  // roughly two observed sync latencies so each sync amortizes over a
+  // full batch, bounded by the configured latency ceiling
+  uint32_t dynamic_interval {};
+  if (m_max_latency && Global::user_log) {
+    int64_t latency = Global::user_log->sync_latency();
+    dynamic_interval = (uint32_t)min((int64_t)m_max_latency, latency * 2);
+  }
+
   auto iter = m_table_map.begin();
   while (iter != m_table_map.end()) {
-    if ((m_counter % (*iter).second->commit_iteration) == 0) {
+    uint32_t commit_iteration = (*iter).second->commit_iteration;
+    if (dynamic_interval > (*iter).second->commit_interval)
+      commit_iteration = (dynamic_interval+(m_commit_interval-1)) / m_commit_interval;
+    if ((m_counter % commit_iteration) == 0) {
       auto remove_iter = iter;
       if (iter->second->expire_time > expire_time)
 	expire_time = iter->second->expire_time;
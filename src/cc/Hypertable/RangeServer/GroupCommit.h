@@ -25,9 +25,9 @@
 #include "GroupCommitInterface.h"
 #include "RangeServer.h"
 
+#include <Common/FlatHashMap.h>
 #include <Common/FlyweightString.h>
 
-#include <map>
 #include <mutex>
 
 namespace Hypertable {
@@ -38,20 +38,27 @@ namespace Hypertable {
   /// Structure for holding cluster ID / table identifier pair
   typedef std::pair<uint64_t, TableIdentifier> ClusterTableIdPair;
 
-  /// Comparison functor for ClusterTableIdPair objects.
-  struct lt_ctip {
+  /// Hash functor for ClusterTableIdPair objects.
+  struct hash_ctip {
+    size_t operator()(const ClusterTableIdPair &key) const {
+      size_t hval = (size_t)key.first * 31 + (size_t)key.second.generation;
+      if (key.second.id) {
+        for (const char *ptr = key.second.id; *ptr; ptr++)
+          hval = hval * 131 + (size_t)(uint8_t)*ptr;
+      }
+      return hval;
+    }
+  };
+
+  /// Equality functor for ClusterTableIdPair objects.
+  struct eq_ctip {
     bool operator()(const ClusterTableIdPair &key1, const ClusterTableIdPair &key2) const {
-      if (key1.first != key2.first)
-        return false;
-      if (key1.second.id == 0 || key2.second.id == 0) {
-        if (key1.second.id == 0)
-          return true;
+      if (key1.first != key2.first ||
+          key1.second.generation != key2.second.generation)
         return false;
-      }
-      int cmpval = strcmp(key1.second.id, key2.second.id);
-      if (cmpval != 0)
-        return cmpval < 0;
-      return key1.second.generation < key2.second.generation;
+      if (key1.second.id == 0 || key2.second.id == 0)
+        return key1.second.id == key2.second.id;
+      return strcmp(key1.second.id, key2.second.id) == 0;
     }
   };
 
@@ -61,8 +68,9 @@ namespace Hypertable {
   public:
 
     /// Constructor.
-    /// Initializes #m_commit_interval to value of
-    /// <code>Hypertable.RangeServer.CommitInterval</code> property.
+    /// Initializes #m_commit_interval and #m_max_latency from the
+    /// <code>Hypertable.RangeServer.CommitInterval</code> and
+    /// <code>Hypertable.RangeServer.GroupCommit.MaxLatency</code> properties.
     /// @param range_server Pointer to RangeServer object
     GroupCommit(Apps::RangeServer *range_server);
     virtual void add(EventPtr &event, uint64_t cluster_id, SchemaPtr &schema,
@@ -78,12 +86,16 @@ namespace Hypertable {
     /// Cached copy of <code>Hypertable.RangeServer.CommitInterval</code>
     /// property
     uint32_t m_commit_interval {};
+    /// Cached copy of <code>Hypertable.RangeServer.GroupCommit.MaxLatency</code>
+    /// property; upper bound for the adaptive flush interval (0 = disabled)
+    uint32_t m_max_latency {};
     /// Trigger iteration counter
     int m_counter {};
     /// %String cache for holding table IDs
     FlyweightString m_flyweight_strings;
 
-    std::map<ClusterTableIdPair, UpdateRecTable *, lt_ctip> m_table_map;
+    FlatHashMap<ClusterTableIdPair, UpdateRecTable *, hash_ctip,
+                eq_ctip> m_table_map;
   };
   /// @}
 }
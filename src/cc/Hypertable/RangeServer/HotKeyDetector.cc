@@ -0,0 +1,116 @@
+/*
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 3 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/// @file
+/// Definitions for HotKeyDetector.
+/// This file contains type definitions for HotKeyDetector, a class for
+/// identifying the hottest row keys in the update stream.
+
+#include <Common/Compat.h>
+
+#include "HotKeyDetector.h"
+
+#include <algorithm>
+
+using namespace Hypertable;
+using namespace std;
+
+HotKeyDetector::HotKeyDetector(size_t top_k)
+  : m_top_k(top_k), m_capacity(top_k * 8) {
+  for (size_t i = 0; i < DEPTH * WIDTH; i++)
+    m_sketch[i].store(0, memory_order_relaxed);
+}
+
+void HotKeyDetector::record(const char *row) {
+  // FNV-1a, split into two hashes for Kirsch-Mitzenmacher indexing
+  uint64_t hash = 14695981039346656037ULL;
+  for (const char *ptr = row; *ptr; ptr++) {
+    hash ^= (uint8_t)*ptr;
+    hash *= 1099511628211ULL;
+  }
+  uint32_t h1 = (uint32_t)hash;
+  uint32_t h2 = (uint32_t)(hash >> 32) | 1;
+
+  uint32_t estimate = UINT32_MAX;
+  for (size_t i = 0; i < DEPTH; i++) {
+    size_t index = i*WIDTH + ((h1 + (uint32_t)i*h2) & (WIDTH-1));
+    uint32_t count = m_sketch[index].fetch_add(1, memory_order_relaxed) + 1;
+    estimate = min(estimate, count);
+  }
+
+  if (estimate >= m_threshold.load(memory_order_relaxed))
+    note_candidate(row, estimate);
+}
+
+void HotKeyDetector::note_candidate(const char *row, uint32_t count) {
+  lock_guard<mutex> lock(m_mutex);
+  uint64_t &current = m_candidates[row];
+  current = max(current, (uint64_t)count);
+  if (m_candidates.size() > m_capacity) {
+    // Prune candidates below the median count and raise the promotion
+    // threshold so the survivors aren't immediately re-joined
+    vector<uint64_t> counts;
+    counts.reserve(m_candidates.size());
+    for (auto &entry : m_candidates)
+      counts.push_back(entry.second);
+    nth_element(counts.begin(), counts.begin() + counts.size()/2,
+                counts.end());
+    uint64_t median = counts[counts.size()/2];
+    for (auto iter = m_candidates.begin(); iter != m_candidates.end(); ) {
+      if (iter->second < median)
+        iter = m_candidates.erase(iter);
+      else
+        ++iter;
+    }
+    m_threshold.store((uint32_t)min(median, (uint64_t)UINT32_MAX),
+                      memory_order_relaxed);
+  }
+}
+
+void HotKeyDetector::harvest(std::vector<HotRow> &top) {
+  lock_guard<mutex> lock(m_mutex);
+
+  top.clear();
+  top.reserve(m_candidates.size());
+  for (auto &entry : m_candidates)
+    top.push_back( {entry.first, entry.second} );
+  sort(top.begin(), top.end(),
+       [](const HotRow &lhs, const HotRow &rhs) {
+         return lhs.count > rhs.count; });
+  if (top.size() > m_top_k)
+    top.resize(m_top_k);
+
+  // Age all counts so the next harvest reflects current traffic
+  for (size_t i = 0; i < DEPTH * WIDTH; i++) {
+    uint32_t count = m_sketch[i].load(memory_order_relaxed);
+    if (count)
+      m_sketch[i].store(count / 2, memory_order_relaxed);
+  }
+  for (auto iter = m_candidates.begin(); iter != m_candidates.end(); ) {
+    iter->second /= 2;
+    if (iter->second == 0)
+      iter = m_candidates.erase(iter);
+    else
+      ++iter;
+  }
+  uint32_t threshold = m_threshold.load(memory_order_relaxed);
+  m_threshold.store(max(threshold / 2, MIN_THRESHOLD), memory_order_relaxed);
+}
@@ -0,0 +1,112 @@
+/* -*- c++ -*-
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 3 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/// @file
+/// Declarations for HotKeyDetector.
+/// This file contains type declarations for HotKeyDetector, a class for
+/// identifying the hottest row keys in the update stream.
+
+#ifndef Hypertable_RangeServer_HotKeyDetector_h
+#define Hypertable_RangeServer_HotKeyDetector_h
+
+#include <Common/String.h>
+
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <vector>
+
+namespace Hypertable {
+
+  /// @addtogroup RangeServer
+  /// @{
+
+  /// Identifies the hottest row keys in the update stream.
+  /// Row keys passing through the update pipeline's qualify stage are
+  /// counted in a count-min sketch, a fixed-size array of counters indexed
+  /// by multiple hashes of the key whose minimum gives an estimate that can
+  /// overcount (hash collisions) but never undercount.  Rows whose estimate
+  /// crosses a threshold are promoted into a small bounded candidate set,
+  /// from which harvest() reports the top-K rows once per load statistics
+  /// period and then halves all counts, so the report tracks current
+  /// traffic rather than all-time totals.  Sketch updates are relaxed
+  /// atomic increments and impose no locking on the qualify stage; only
+  /// candidate promotion takes a mutex.
+  class HotKeyDetector {
+  public:
+
+    /// Row key and its estimated update count for the current period
+    struct HotRow {
+      String row;
+      uint64_t count;
+    };
+
+    /// Constructor.
+    /// @param top_k Number of rows reported by harvest()
+    HotKeyDetector(size_t top_k);
+
+    /// Counts one update to <code>row</code>
+    void record(const char *row);
+
+    /// Reports the top-K hottest rows and ages all counts.
+    /// @param top Cleared and filled with up to top-K rows in descending
+    /// count order
+    void harvest(std::vector<HotRow> &top);
+
+  private:
+
+    /// Promotes <code>row</code> into the candidate set, pruning the
+    /// coldest half when the set outgrows its capacity
+    void note_candidate(const char *row, uint32_t count);
+
+    /// Number of independent counter rows in the sketch
+    static const size_t DEPTH = 4;
+
+    /// Counters per sketch row; must be a power of two
+    static const size_t WIDTH = 16384;
+
+    /// Counter estimate a row must reach to become a candidate
+    static const uint32_t MIN_THRESHOLD = 8;
+
+    /// Count-min sketch counters (DEPTH x WIDTH)
+    std::atomic<uint32_t> m_sketch[DEPTH * WIDTH];
+
+    /// Number of rows reported per harvest
+    size_t m_top_k;
+
+    /// Maximum candidate set size before pruning
+    size_t m_capacity;
+
+    /// Current candidate promotion threshold
+    std::atomic<uint32_t> m_threshold {MIN_THRESHOLD};
+
+    /// %Mutex protecting #m_candidates
+    std::mutex m_mutex;
+
+    /// Hot row candidates and their latest count estimates
+    std::map<String, uint64_t> m_candidates;
+  };
+
+  /// @}
+
+}
+
+#endif // Hypertable_RangeServer_HotKeyDetector_h
@@ -39,6 +39,9 @@ HyperspaceTableCache::HyperspaceTableCache(Hyperspace::SessionPtr &hyperspace,
 
   try {
     std::vector<Hyperspace::DirEntryAttr> listing;
+    hyperspace->readdir_attr(toplevel_dir + "/tables", "schema_bin", true, listing);
+    map_binary_table_schemas("", listing);
+    listing.clear();
     hyperspace->readdir_attr(toplevel_dir + "/tables", "schema", true, listing);
     map_table_schemas("", listing);
     listing.clear();
@@ -59,12 +62,33 @@ bool HyperspaceTableCache::get(const String &table_id, Entry &entry) {
 }
 
 
+void HyperspaceTableCache::map_binary_table_schemas(const String &parent,
+                                         const std::vector<Hyperspace::DirEntryAttr> &listing) {
+  String prefix = !parent.empty() ? parent + "/" : ""; // avoid leading slash
+  for (auto &e : listing) {
+    String name = prefix + e.name;
+    if (e.has_attr && e.attr.size > 0) {
+      Entry entry;
+      try {
+        // e.attr.size includes the nul terminator appended at decode
+        entry.schema.reset( Schema::new_instance(e.attr.base, e.attr.size-1) );
+        m_map.insert(TableEntryMap::value_type(name, entry));
+      }
+      catch (Exception &ex) {
+        HT_WARNF("Corrupt binary schema for table %s (%s), falling back "
+                 "to XML", name.c_str(), ex.what());
+      }
+    }
+    map_binary_table_schemas(name, e.sub_entries);
+  }
+}
+
 void HyperspaceTableCache::map_table_schemas(const String &parent,
                                          const std::vector<Hyperspace::DirEntryAttr> &listing) {
   String prefix = !parent.empty() ? parent + "/" : ""; // avoid leading slash
   for (auto &e : listing) {
     String name = prefix + e.name;
-    if (e.has_attr) {
+    if (e.has_attr && m_map.find(name) == m_map.end()) {
       Entry entry;
       entry.schema.reset( Schema::new_instance((const char *)e.attr.base) );
       m_map.insert(TableEntryMap::value_type(name, entry));
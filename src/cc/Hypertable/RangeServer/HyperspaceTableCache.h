@@ -75,7 +75,17 @@ namespace Hypertable {
 
   private:
 
+    /// Recursively populates map with binary-encoded table schemas.
+    /// Entries whose binary encoding fails to decode are skipped and picked
+    /// up by the subsequent XML pass in map_table_schemas().
+    /// @param parent Parent ID pathname
+    /// @param listing Vector of directory entries within <code>parent</code>
+    void map_binary_table_schemas(const String &parent,
+                                  const std::vector<Hyperspace::DirEntryAttr> &listing);
+
     /// Recursively populates map with table schemas.
+    /// Tables already loaded from the binary encoding by
+    /// map_binary_table_schemas() are left untouched, avoiding the XML parse.
     /// @param parent Parent ID pathname
     /// @param listing Vector of directory entries within <code>parent</code>
     void map_table_schemas(const String &parent,
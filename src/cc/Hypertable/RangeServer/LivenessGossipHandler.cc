@@ -0,0 +1,231 @@
+/*
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 3 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/** @file
+ * Definitions for LivenessGossipHandler.
+ * This file contains definitions for LivenessGossipHandler, a class
+ * implementing UDP liveness gossip among range servers for fast failure
+ * suspicion.
+ */
+
+#include <Common/Compat.h>
+
+#include "LivenessGossipHandler.h"
+
+#include <AsyncComm/CommBuf.h>
+
+#include <Common/Error.h>
+#include <Common/Logger.h>
+#include <Common/Serialization.h>
+#include <Common/StringExt.h>
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+using namespace Hypertable;
+using namespace Hyperspace;
+using namespace std;
+
+LivenessGossipHandler::LivenessGossipHandler(PropertiesPtr &props, Comm *comm,
+    Hyperspace::SessionPtr &hyperspace, Lib::Master::ClientPtr &master_client,
+    const String &location, const String &toplevel_dir)
+  : m_comm(comm), m_hyperspace(hyperspace), m_master_client(master_client),
+    m_location(location), m_toplevel_dir(toplevel_dir) {
+  m_port = props->get_i16("Hypertable.RangeServer.Port");
+  m_interval = props->get_i32("Hypertable.RangeServer.Gossip.Interval");
+  m_suspect_timeout =
+    props->get_i32("Hypertable.RangeServer.Gossip.SuspectTimeout");
+  // Re-read the peer set from hyperspace roughly every 30 seconds
+  m_refresh_ticks = std::max(1, 30000 / m_interval);
+}
+
+
+void LivenessGossipHandler::start() {
+  m_local_addr.set_inet(InetAddr(INADDR_ANY, m_port));
+  m_comm->create_datagram_receive_socket(m_local_addr, 0x10,
+                                         shared_from_this());
+  m_thread = Thread([this]() { gossip_loop(); });
+  m_started = true;
+  HT_INFOF("Liveness gossip started (interval=%d, suspect timeout=%d)",
+           (int)m_interval, (int)m_suspect_timeout);
+}
+
+
+void LivenessGossipHandler::handle(EventPtr &event) {
+
+  if (event->type == Event::MESSAGE) {
+    try {
+      const uint8_t *ptr = event->payload;
+      size_t remain = event->payload_len;
+      String sender = Serialization::decode_vstr(&ptr, &remain);
+
+      if (event->header.command == COMMAND_PING)
+        send_packet(InetAddr(event->addr), COMMAND_ACK);
+      else if (event->header.command == COMMAND_ACK) {
+        lock_guard<mutex> lock(m_mutex);
+        auto iter = m_peers.find(sender);
+        if (iter != m_peers.end()) {
+          iter->second.last_heard = chrono::steady_clock::now();
+          if (iter->second.suspected) {
+            HT_INFOF("Peer %s answering again; clearing suspicion",
+                     sender.c_str());
+            iter->second.suspected = false;
+          }
+        }
+      }
+      else
+        HT_WARNF("Unrecognized gossip command (%llu)",
+                 (Llu)event->header.command);
+    }
+    catch (Exception &e) {
+      HT_ERROR_OUT << e << HT_END;
+    }
+  }
+  else if (event->type != Event::DISCONNECT)
+    HT_WARNF("%s", event->to_str().c_str());
+}
+
+
+void LivenessGossipHandler::shutdown() {
+  {
+    lock_guard<mutex> lock(m_mutex);
+    m_shutdown = true;
+    m_cond.notify_all();
+  }
+  if (m_started)
+    m_thread.join();
+}
+
+
+void LivenessGossipHandler::gossip_loop() {
+  int32_t ticks = 0;
+  vector<pair<String, InetAddr>> suspects;
+
+  while (true) {
+
+    {
+      unique_lock<mutex> lock(m_mutex);
+      m_cond.wait_for(lock, chrono::milliseconds(m_interval),
+                      [this]() { return m_shutdown; });
+      if (m_shutdown)
+        return;
+    }
+
+    if ((ticks++ % m_refresh_ticks) == 0)
+      refresh_peers();
+
+    suspects.clear();
+    auto now = chrono::steady_clock::now();
+
+    {
+      lock_guard<mutex> lock(m_mutex);
+      for (auto &entry : m_peers) {
+        Peer &peer = entry.second;
+        if (!peer.suspected &&
+            now - peer.last_heard > chrono::milliseconds(m_suspect_timeout)) {
+          peer.suspected = true;
+          suspects.push_back(make_pair(entry.first, peer.addr));
+        }
+        send_packet(peer.addr, COMMAND_PING);
+      }
+    }
+
+    // Suspicion reports go to the master outside of m_mutex since the report
+    // RPC can block
+    for (auto &suspect : suspects) {
+      HT_WARNF("Peer %s (%s) unresponsive for %d ms; reporting suspicion "
+               "to master", suspect.first.c_str(),
+               suspect.second.format().c_str(), (int)m_suspect_timeout);
+      try {
+        m_master_client->report_suspect(suspect.first, m_location);
+      }
+      catch (Exception &e) {
+        HT_ERRORF("Problem reporting suspicion of %s to master - %s",
+                  suspect.first.c_str(), e.what());
+      }
+    }
+  }
+}
+
+
+void LivenessGossipHandler::refresh_peers() {
+  vector<DirEntryAttr> listing;
+
+  try {
+    m_hyperspace->readdir_attr(m_toplevel_dir + "/servers", "gossip_address",
+                               false, listing);
+  }
+  catch (Exception &e) {
+    HT_WARNF("Problem reading gossip addresses from hyperspace - %s",
+             e.what());
+    return;
+  }
+
+  auto now = chrono::steady_clock::now();
+  lock_guard<mutex> lock(m_mutex);
+  StringSet seen;
+
+  for (auto &entry : listing) {
+    if (entry.name == m_location || !entry.has_attr)
+      continue;
+    String addr_str((const char *)entry.attr.base, entry.attr.size);
+    if (!addr_str.empty() && addr_str.back() == '\0')
+      addr_str.resize(addr_str.size()-1);
+    InetAddr addr;
+    if (!InetAddr::initialize(&addr, addr_str.c_str())) {
+      HT_WARNF("Invalid gossip address '%s' published by %s",
+               addr_str.c_str(), entry.name.c_str());
+      continue;
+    }
+    seen.insert(entry.name);
+    auto iter = m_peers.find(entry.name);
+    if (iter == m_peers.end()) {
+      Peer peer;
+      peer.addr = addr;
+      peer.last_heard = now;
+      m_peers[entry.name] = peer;
+    }
+    else
+      iter->second.addr = addr;
+  }
+
+  // Drop peers that have been recovered or removed
+  auto iter = m_peers.begin();
+  while (iter != m_peers.end()) {
+    if (seen.count(iter->first) == 0)
+      iter = m_peers.erase(iter);
+    else
+      ++iter;
+  }
+}
+
+
+void LivenessGossipHandler::send_packet(const InetAddr &addr,
+                                        uint64_t command) {
+  CommHeader header(command);
+  CommBufPtr cbuf(new CommBuf(header,
+                              Serialization::encoded_length_vstr(m_location)));
+  cbuf->append_vstr(m_location);
+  int error = m_comm->send_datagram(addr, m_local_addr, cbuf);
+  if (error != Error::OK)
+    HT_ERRORF("Comm::send_datagram returned %s", Error::get_text(error));
+}
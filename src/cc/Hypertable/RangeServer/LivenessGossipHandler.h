@@ -0,0 +1,155 @@
+/* -*- c++ -*-
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 3 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/** @file
+ * Declarations for LivenessGossipHandler.
+ * This file contains declarations for LivenessGossipHandler, a class
+ * implementing UDP liveness gossip among range servers for fast failure
+ * suspicion.
+ */
+
+#ifndef Hypertable_RangeServer_LivenessGossipHandler_h
+#define Hypertable_RangeServer_LivenessGossipHandler_h
+
+#include <Hypertable/Lib/Master/Client.h>
+
+#include <Hyperspace/Session.h>
+
+#include <AsyncComm/Comm.h>
+#include <AsyncComm/DispatchHandler.h>
+
+#include <Common/InetAddr.h>
+#include <Common/Properties.h>
+#include <Common/Thread.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace Hypertable {
+
+  /** @addtogroup RangeServer
+   *  @{
+   */
+
+  /** Gossips liveness with peer range servers over UDP.
+   * Each range server publishes its datagram address in the
+   * <i>gossip_address</i> attribute of its Hyperspace lock file and
+   * periodically pings the published addresses of its peers.  A peer that
+   * fails to answer pings for <code>Hypertable.RangeServer.Gossip.SuspectTimeout</code>
+   * milliseconds is reported to the master as a failure suspect; the master
+   * waits for a quorum of independent reports before acting (see
+   * Context::report_suspect()), so this detector can be aggressive without
+   * risking spurious recoveries.  This provides sub-second failure detection
+   * independent of the (much longer) Hyperspace session lease, allowing the
+   * master to begin recovery preparation before the lease expires.
+   */
+  class LivenessGossipHandler : public DispatchHandler {
+
+  public:
+
+    /** Constructor.
+     * Creates the datagram receive socket on the range server port and reads
+     * the gossip configuration properties.  Probing does not begin until
+     * start() is called.
+     * @param props Configuration properties
+     * @param comm Comm layer
+     * @param hyperspace %Hyperspace session (used for peer discovery)
+     * @param master_client %Master client (used for suspicion reports)
+     * @param location Proxy name of this server
+     * @param toplevel_dir Toplevel hyperspace directory
+     */
+    LivenessGossipHandler(PropertiesPtr &props, Comm *comm,
+                          Hyperspace::SessionPtr &hyperspace,
+                          Lib::Master::ClientPtr &master_client,
+                          const String &location, const String &toplevel_dir);
+
+    /** Starts the gossip thread. */
+    void start();
+
+    /** Handles incoming gossip datagrams.
+     * Answers <i>ping</i> datagrams with an <i>ack</i> and records the
+     * receipt time of <i>ack</i> datagrams against the sending peer.
+     * @param event %Comm layer event
+     */
+    virtual void handle(EventPtr &event);
+
+    /** Stops the gossip thread and joins it. */
+    void shutdown();
+
+  private:
+
+    /// Gossip datagram commands
+    enum {
+      COMMAND_PING = 0,
+      COMMAND_ACK  = 1
+    };
+
+    /// Liveness state for one peer
+    struct Peer {
+      /// Datagram address published by the peer
+      InetAddr addr;
+      /// Time an ack was last received from the peer
+      std::chrono::steady_clock::time_point last_heard;
+      /// Flag indicating the peer has been reported as a suspect
+      bool suspected {};
+    };
+
+    /// Probe and suspicion-check loop run by #m_thread
+    void gossip_loop();
+
+    /// Refreshes #m_peers from the <i>gossip_address</i> attributes in
+    /// hyperspace
+    void refresh_peers();
+
+    /// Sends a gossip datagram to <code>addr</code>
+    void send_packet(const InetAddr &addr, uint64_t command);
+
+    std::mutex m_mutex;
+    std::condition_variable m_cond;
+    Comm *m_comm {};
+    Hyperspace::SessionPtr m_hyperspace;
+    Lib::Master::ClientPtr m_master_client;
+    String m_location;
+    String m_toplevel_dir;
+    CommAddress m_local_addr;
+    Thread m_thread;
+    /// Peer liveness state indexed by location
+    std::map<String, Peer> m_peers;
+    uint16_t m_port {};
+    int32_t m_interval {};
+    int32_t m_suspect_timeout {};
+    /// Loop iterations between peer refreshes
+    int32_t m_refresh_ticks {};
+    bool m_started {};
+    bool m_shutdown {};
+  };
+
+  /// Shared smart pointer to LivenessGossipHandler
+  typedef std::shared_ptr<LivenessGossipHandler> LivenessGossipHandlerPtr;
+
+  /** @} */
+}
+
+#endif // Hypertable_RangeServer_LivenessGossipHandler_h
@@ -32,23 +32,42 @@ using namespace Hypertable;
 using namespace std;
 
 LoadMetricsRange::LoadMetricsRange(const String &table_id, const String &start_row, const String &end_row)
-  : m_new_rows(false), m_timestamp(time(0)) {
+  : m_new_rows(false), m_timestamp(time(0)), m_block_cache_accesses(0),
+    m_block_cache_hits(0) {
   initialize(table_id, start_row, end_row);
 }
 
 
 /**
- *  Value format for version 1:
+ *  Value format for version 6:
  *
  * @verbatim
- * v2:<ts>,<disk>,<memory>,<disk-bytes-read-rate>,<byte-write-rate>,<byte-read-rate>,<update-rate>,<scan-rate>,<cell-write-rate>,<cell-read-rate>
+ * 6:<ts>,<disk>,<memory>,<compression-ratio>,<disk-bytes-read-rate>,<byte-write-rate>,<byte-read-rate>,<update-rate>,<scan-rate>,<cell-write-rate>,<cell-read-rate>,<scan-latency-p99>,<update-latency-p99>,<cell-count>,<key-bytes>,<value-bytes>,<block-cache-hit-rate>,<block-cache-miss-rate>,<working-set>
  * @endverbatim
+ *
+ * The latency fields hold estimated 99th percentile scan and update request
+ * latencies, in milliseconds, over the metrics interval.  The cell count and
+ * key/value byte fields are materialized size statistics (cell store totals
+ * maintained by compactions plus the current cell cache contents), published
+ * so that table size questions can be answered with a scan of
+ * <code>sys/RS_METRICS</code> instead of a COUNT scan of the table itself.
+ * The block cache hit and miss rates (blocks per second over the metrics
+ * interval) and the working set estimate (cell cache bytes plus block cache
+ * bytes resident for the range's cell stores) describe the range's observed
+ * working set, giving placement tooling the per-range heat signal needed for
+ * storage tiering decisions.
  */
 
 void LoadMetricsRange::compute_and_store(TableMutator *mutator, time_t now,
                                          LoadFactors &load_factors,
+                                         LatencyHistogram &scan_latency,
+                                         LatencyHistogram &update_latency,
                                          uint64_t disk_used, uint64_t memory_used,
-                                         double compression_ratio) {
+                                         double compression_ratio, uint64_t cell_count,
+                                         int64_t key_bytes, int64_t value_bytes,
+                                         uint64_t block_cache_memory,
+                                         uint64_t block_cache_accesses,
+                                         uint64_t block_cache_hits) {
   bool update_start_row = false;
   String old_start_row, old_end_row;
 
@@ -75,12 +94,29 @@ void LoadMetricsRange::compute_and_store(TableMutator *mutator, time_t now,
   double byte_read_rate = (double)(load_factors.bytes_scanned-m_load_factors.bytes_scanned) / time_interval;
   double byte_write_rate = (double)(load_factors.bytes_written-m_load_factors.bytes_written) / time_interval;
   double disk_byte_read_rate = (double)(load_factors.disk_bytes_read-m_load_factors.disk_bytes_read) / time_interval;
-
-  String value = format("3:%ld,%llu,%llu,%.6f,%.6f,%.6f,%.6f,%.6f,%.6f,%.6f,%.6f",
+  double scan_latency_p99 = scan_latency.estimate_and_reset(0.99);
+  double update_latency_p99 = update_latency.estimate_and_reset(0.99);
+
+  // Block cache counters are accumulated per cell store and vanish when a
+  // compaction replaces the store set, so a decrease means the counters
+  // were reset; fall back to the raw values in that case
+  uint64_t cache_accesses = (block_cache_accesses >= m_block_cache_accesses)
+    ? block_cache_accesses - m_block_cache_accesses : block_cache_accesses;
+  uint64_t cache_hits = (block_cache_hits >= m_block_cache_hits)
+    ? block_cache_hits - m_block_cache_hits : block_cache_hits;
+  uint64_t cache_misses = (cache_accesses > cache_hits)
+    ? cache_accesses - cache_hits : 0;
+  double cache_hit_rate = (double)cache_hits / time_interval;
+  double cache_miss_rate = (double)cache_misses / time_interval;
+  uint64_t working_set = memory_used + block_cache_memory;
+
+  String value = format("6:%ld,%llu,%llu,%.6f,%.6f,%.6f,%.6f,%.6f,%.6f,%.6f,%.6f,%.3f,%.3f,%llu,%lld,%lld,%.6f,%.6f,%llu",
                         rounded_time, (Llu)disk_used, (Llu)memory_used,
                         compression_ratio, disk_byte_read_rate, byte_write_rate,
                         byte_read_rate, update_rate, scan_rate, cell_write_rate,
-                        cell_read_rate);
+                        cell_read_rate, scan_latency_p99, update_latency_p99,
+                        (Llu)cell_count, (Lld)key_bytes, (Lld)value_bytes,
+                        cache_hit_rate, cache_miss_rate, (Llu)working_set);
 
   KeySpec key;
   String row = Global::location_initializer->get() + ":" + m_table_id;
@@ -131,6 +167,8 @@ void LoadMetricsRange::compute_and_store(TableMutator *mutator, time_t now,
 
   m_timestamp = now;
   m_load_factors = load_factors;
+  m_block_cache_accesses = block_cache_accesses;
+  m_block_cache_hits = block_cache_hits;
 }
 
 
@@ -27,6 +27,7 @@
 #include <Hypertable/Lib/TableMutator.h>
 
 #include <Common/DynamicBuffer.h>
+#include <Common/LatencyHistogram.h>
 #include <Common/String.h>
 
 #include <mutex>
@@ -46,8 +47,14 @@ namespace Hypertable {
 
     void compute_and_store(TableMutator *mutator, time_t now,
                            LoadFactors &load_factors,
+                           LatencyHistogram &scan_latency,
+                           LatencyHistogram &update_latency,
                            uint64_t disk_used, uint64_t memory_used,
-                           double compression_ratio);
+                           double compression_ratio, uint64_t cell_count,
+                           int64_t key_bytes, int64_t value_bytes,
+                           uint64_t block_cache_memory,
+                           uint64_t block_cache_accesses,
+                           uint64_t block_cache_hits);
 
   private:
 
@@ -63,6 +70,8 @@ namespace Hypertable {
     bool m_new_rows;
     time_t m_timestamp;
     LoadFactors m_load_factors;
+    uint64_t m_block_cache_accesses;
+    uint64_t m_block_cache_hits;
   };
 }
 
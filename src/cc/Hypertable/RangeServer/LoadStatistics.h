@@ -28,12 +28,16 @@
 #ifndef Hypertable_RangeServer_LoadStatistics_h
 #define Hypertable_RangeServer_LoadStatistics_h
 
+#include "HotKeyDetector.h"
+
+#include <Common/LatencyHistogram.h>
 #include <Common/Logger.h>
 #include <Common/Time.h>
 
 #include <chrono>
 #include <memory>
 #include <mutex>
+#include <vector>
 
 namespace Hypertable {
 
@@ -52,6 +56,14 @@ namespace Hypertable {
   class LoadStatistics {
   public:
 
+    /// Update pipeline stage indices used with add_pipeline_data()
+    enum PipelineStage {
+      STAGE_QUALIFY = 0, //!< Qualify and transform stage
+      STAGE_COMMIT = 1,  //!< Commit stage
+      STAGE_ADD = 2,     //!< Add and respond stage
+      PIPELINE_STAGES = 3
+    };
+
     /** POD-style structure to hold statistics.
      */
     struct Bundle {
@@ -67,6 +79,14 @@ namespace Hypertable {
         period_millis = 0;
         compactions_major = compactions_minor =
           compactions_merging = compactions_gc = 0;
+        for (int stage = 0; stage < PIPELINE_STAGES; stage++) {
+          pipeline_ops[stage] = pipeline_max_depth[stage] = 0;
+          pipeline_wait_millis[stage] = pipeline_service_millis[stage] = 0;
+        }
+        scan_latency_p50 = scan_latency_p99 = scan_latency_max = 0;
+        update_latency_p50 = update_latency_p99 = update_latency_max = 0;
+        sync_latency_p50 = sync_latency_p99 = sync_latency_max = 0;
+        hot_rows.clear();
       }
       uint32_t scan_count;     //!< Scan count
       uint32_t cells_scanned;  //!< Cells scanned
@@ -86,6 +106,21 @@ namespace Hypertable {
       int32_t compactions_minor;
       int32_t compactions_merging;
       int32_t compactions_gc;
+      uint32_t pipeline_ops[PIPELINE_STAGES]; //!< Contexts processed per pipeline stage
+      int64_t pipeline_wait_millis[PIPELINE_STAGES]; //!< Total input queue wait per pipeline stage
+      int64_t pipeline_service_millis[PIPELINE_STAGES]; //!< Total processing time per pipeline stage
+      uint32_t pipeline_max_depth[PIPELINE_STAGES]; //!< Maximum input queue depth observed per pipeline stage
+      uint64_t scan_latency_p50;   //!< Median scan latency (microseconds)
+      uint64_t scan_latency_p99;   //!< 99th percentile scan latency (microseconds)
+      uint64_t scan_latency_max;   //!< Maximum scan latency (microseconds)
+      uint64_t update_latency_p50; //!< Median update latency (microseconds)
+      uint64_t update_latency_p99; //!< 99th percentile update latency (microseconds)
+      uint64_t update_latency_max; //!< Maximum update latency (microseconds)
+      uint64_t sync_latency_p50;   //!< Median commit log sync latency (microseconds)
+      uint64_t sync_latency_p99;   //!< 99th percentile commit log sync latency (microseconds)
+      uint64_t sync_latency_max;   //!< Maximum commit log sync latency (microseconds)
+      /// Hottest rows by update count (descending), empty if no detector
+      std::vector<HotKeyDetector::HotRow> hot_rows;
     };
 
     /** Constructor.
@@ -99,6 +134,16 @@ namespace Hypertable {
       m_computed.clear();
     }
 
+    /** Registers a hot key detector.
+     * Once registered, each recompute() harvests the detector's top rows
+     * into the <code>hot_rows</code> member of #m_computed.
+     * @param detector Hot key detector (not owned)
+     */
+    void set_hot_key_detector(HotKeyDetector *detector) {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_hot_key_detector = detector;
+    }
+
     /** Locks #m_mutex */
     void lock() { m_mutex.lock(); }
 
@@ -150,6 +195,44 @@ namespace Hypertable {
       m_running.sync_count += syncs;
     }
 
+    /** Adds update pipeline stage measurements to #m_running statistics
+     * bundle.  Called by each pipeline stage once per processed context,
+     * allowing the per-period summary to show which stage updates queue
+     * behind.
+     * @param stage Pipeline stage (see PipelineStage)
+     * @param wait_millis Time context waited on the stage's input queue
+     * @param service_millis Time the stage spent processing the context
+     * @param depth Stage input queue depth observed at dequeue
+     * @warning This method must be called with #m_mutex locked
+     */
+    void add_pipeline_data(int stage, int64_t wait_millis,
+                           int64_t service_millis, size_t depth) {
+      HT_ASSERT(stage >= 0 && stage < PIPELINE_STAGES);
+      m_running.pipeline_ops[stage]++;
+      m_running.pipeline_wait_millis[stage] += wait_millis;
+      m_running.pipeline_service_millis[stage] += service_millis;
+      if ((uint32_t)depth > m_running.pipeline_max_depth[stage])
+        m_running.pipeline_max_depth[stage] = (uint32_t)depth;
+    }
+
+    /** Returns the server-wide scan latency histogram.
+     * Recording into the histogram is lock-free; #m_mutex need not be held.
+     * @return Reference to scan latency histogram
+     */
+    LatencyHistogram &scan_latency() { return m_scan_latency; }
+
+    /** Returns the server-wide update latency histogram.
+     * Recording into the histogram is lock-free; #m_mutex need not be held.
+     * @return Reference to update latency histogram
+     */
+    LatencyHistogram &update_latency() { return m_update_latency; }
+
+    /** Returns the server-wide commit log sync latency histogram.
+     * Recording into the histogram is lock-free; #m_mutex need not be held.
+     * @return Reference to sync latency histogram
+     */
+    LatencyHistogram &sync_latency() { return m_sync_latency; }
+
     void increment_compactions_major() {
       std::lock_guard<std::mutex> lock(m_mutex);
       m_running.compactions_major++;
@@ -200,6 +283,26 @@ namespace Hypertable {
           m_computed.scan_mbps = 0.0;
           m_computed.update_mbps = 0.0;
         }
+        m_computed.scan_latency_p50 = m_scan_latency.quantile(0.50);
+        m_computed.scan_latency_p99 = m_scan_latency.quantile(0.99);
+        m_computed.scan_latency_max = m_scan_latency.max();
+        m_scan_latency.clear();
+        m_computed.update_latency_p50 = m_update_latency.quantile(0.50);
+        m_computed.update_latency_p99 = m_update_latency.quantile(0.99);
+        m_computed.update_latency_max = m_update_latency.max();
+        m_update_latency.clear();
+        m_computed.sync_latency_p50 = m_sync_latency.quantile(0.50);
+        m_computed.sync_latency_p99 = m_sync_latency.quantile(0.99);
+        m_computed.sync_latency_max = m_sync_latency.max();
+        m_sync_latency.clear();
+
+        if (m_hot_key_detector) {
+          m_hot_key_detector->harvest(m_computed.hot_rows);
+          for (auto &hot_row : m_computed.hot_rows)
+            HT_INFOF("hot row '%s' updates=%llu", hot_row.row.c_str(),
+                     (Llu)hot_row.count);
+        }
+
         m_start_time = now;
         m_running.clear();
 
@@ -209,6 +312,37 @@ namespace Hypertable {
                  m_computed.update_count, m_computed.update_cells,
                  (Llu)m_computed.update_bytes, m_computed.update_mbps,
                  m_computed.sync_count);
+
+        if (m_computed.pipeline_ops[STAGE_QUALIFY] ||
+            m_computed.pipeline_ops[STAGE_COMMIT] ||
+            m_computed.pipeline_ops[STAGE_ADD])
+          HT_INFOF("pipeline qualify=(%u %lld %lld %u) commit=(%u %lld %lld %u)"
+                   " add=(%u %lld %lld %u)",
+                   m_computed.pipeline_ops[STAGE_QUALIFY],
+                   (Lld)m_computed.pipeline_wait_millis[STAGE_QUALIFY],
+                   (Lld)m_computed.pipeline_service_millis[STAGE_QUALIFY],
+                   m_computed.pipeline_max_depth[STAGE_QUALIFY],
+                   m_computed.pipeline_ops[STAGE_COMMIT],
+                   (Lld)m_computed.pipeline_wait_millis[STAGE_COMMIT],
+                   (Lld)m_computed.pipeline_service_millis[STAGE_COMMIT],
+                   m_computed.pipeline_max_depth[STAGE_COMMIT],
+                   m_computed.pipeline_ops[STAGE_ADD],
+                   (Lld)m_computed.pipeline_wait_millis[STAGE_ADD],
+                   (Lld)m_computed.pipeline_service_millis[STAGE_ADD],
+                   m_computed.pipeline_max_depth[STAGE_ADD]);
+
+        if (m_computed.scan_count || m_computed.update_count)
+          HT_INFOF("latency usec scan=(%llu %llu %llu) update=(%llu %llu %llu)"
+                   " sync=(%llu %llu %llu)",
+                   (Llu)m_computed.scan_latency_p50,
+                   (Llu)m_computed.scan_latency_p99,
+                   (Llu)m_computed.scan_latency_max,
+                   (Llu)m_computed.update_latency_p50,
+                   (Llu)m_computed.update_latency_p99,
+                   (Llu)m_computed.update_latency_max,
+                   (Llu)m_computed.sync_latency_p50,
+                   (Llu)m_computed.sync_latency_p99,
+                   (Llu)m_computed.sync_latency_max);
       }
       if (stats)
         *stats = m_computed;
@@ -236,6 +370,18 @@ namespace Hypertable {
 
     // Computed statistics for last completed time period
     Bundle m_computed;
+
+    // Server-wide scan latency histogram (lock-free recording)
+    LatencyHistogram m_scan_latency;
+
+    // Server-wide update latency histogram (lock-free recording)
+    LatencyHistogram m_update_latency;
+
+    // Server-wide commit log sync latency histogram (lock-free recording)
+    LatencyHistogram m_sync_latency;
+
+    // Hot key detector harvested each period (not owned, may be NULL)
+    HotKeyDetector *m_hot_key_detector {};
   };
 
   /// Shared smart pointer to LoadStatistics
@@ -23,6 +23,7 @@
 #include "Common/ScopeGuard.h"
 #include "Common/StringExt.h"
 
+#include <algorithm>
 #include <cassert>
 #include <iostream>
 
@@ -91,14 +92,29 @@ MaintenancePrioritizer::schedule_initialization_operations(
   if (m_initialization_complete)
     return;
 
+  std::vector<size_t> candidates;
+
   for (size_t i=0; i<range_data.size(); i++) {
     if (!range_data[i].data->initialized)
       m_uninitialized_ranges_seen = true;
     if (range_data[i].data->busy || range_data[i].data->priority)
       continue;
     if (!range_data[i].data->initialized)
-      range_data[i].data->priority = priority++;
+      candidates.push_back(i);
   }
+
+  // Initialize the ranges that were serving the most cache-resident
+  // block data before the restart first (recorded in the access group
+  // hints files), so background initialization opens the stores of
+  // recently busy ranges ahead of cold ones
+  std::stable_sort(candidates.begin(), candidates.end(),
+                   [&range_data](size_t x, size_t y) {
+                     return range_data[x].data->prewarm_bytes >
+                       range_data[y].data->prewarm_bytes;
+                   });
+
+  for (size_t i : candidates)
+    range_data[i].data->priority = priority++;
 }
 
 
@@ -333,7 +349,8 @@ MaintenancePrioritizer::schedule_necessary_compactions(std::vector<RangeData> &r
 
       }
       // Compact LARGE CellCaches
-      else if (!ag_data->in_memory && ag_data->mem_used > Global::access_group_max_mem) {
+      else if (!ag_data->in_memory &&
+               ag_data->mem_used > range_data[i].data->cellcache_budget) {
         if (memory_state.need_more()) {
           range_data[i].data->maintenance_flags |= MaintenanceFlag::COMPACT|MaintenanceFlag::MEMORY_PURGE;
           ag_data->maintenance_flags |= MaintenanceFlag::COMPACT_MINOR|MaintenanceFlag::MEMORY_PURGE_SHADOW_CACHE;
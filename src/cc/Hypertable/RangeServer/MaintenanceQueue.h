@@ -34,6 +34,8 @@
 #include <Common/Error.h>
 #include <Common/Logger.h>
 #include <Common/Thread.h>
+#include <Common/ThreadActivity.h>
+#include <Common/ThreadAffinity.h>
 
 #include <cassert>
 #include <condition_variable>
@@ -78,8 +80,10 @@ namespace Hypertable {
         return;
       }
       TaskQueue queue;
+      TaskQueue fast_queue;
       std::mutex mutex;
       std::condition_variable cond;
+      std::condition_variable fast_cond;
       std::condition_variable empty_cond;
       bool shutdown {};
       std::set<Range *>  ranges;
@@ -92,44 +96,76 @@ namespace Hypertable {
 
     public:
 
-      Worker(MaintenanceQueueState &state) : m_state(state) { return; }
+      Worker(MaintenanceQueueState &state, bool fast_lane=false)
+        : m_state(state), m_fast_lane(fast_lane) { return; }
 
       void operator()() {
         MaintenanceTask *task = 0;
 
+        const char *name = m_fast_lane ? "maint-fast" : "maint-queue";
+        ThreadActivity::register_self(name);
+        ThreadAffinity::bind_self(name);
+
         while (true) {
 
           {
             std::unique_lock<std::mutex> lock(m_state.mutex);
-            uint32_t inflight_level = lowest_inflight_level();
 
-            auto now = std::chrono::steady_clock::now();
+            if (m_fast_lane) {
+
+              auto now = std::chrono::steady_clock::now();
+
+              // Fast lane workers only service small urgent tasks and are
+              // not subject to the level gating applied to the main queue
 
-	    // Block in the following circumstances:
-	    // 1. Queue is empty
-	    // 2. Level of task on front of queue is greater than (e.g. lower
-	    //    priority) the level of the tasks currently being executed
-	    // 3. Start time of task on front of queue is in the future
+              while (m_state.fast_queue.empty() ||
+                     (m_state.fast_queue.top())->start_time > now) {
 
-            while (m_state.queue.empty() || 
-		   (m_state.inflight && ((m_state.queue.top())->level > inflight_level)) ||
-                   (m_state.queue.top())->start_time > now) {
+                if (m_state.shutdown)
+                  return;
 
-              if (m_state.shutdown)
-                return;
+                if (m_state.fast_queue.empty())
+                  m_state.fast_cond.wait(lock);
+                else
+                  m_state.fast_cond.wait_until(lock, (m_state.fast_queue.top())->start_time);
 
-              if (m_state.queue.empty() || 
-		  (m_state.inflight && (m_state.queue.top())->level > inflight_level))
-                m_state.cond.wait(lock);
-              else
-                m_state.cond.wait_until(lock, (m_state.queue.top())->start_time);
+                now = std::chrono::steady_clock::now();
+              }
 
-              inflight_level = lowest_inflight_level();
-              now = std::chrono::steady_clock::now();
+              task = m_state.fast_queue.top();
+              m_state.fast_queue.pop();
             }
+            else {
+              uint32_t inflight_level = lowest_inflight_level();
+
+              auto now = std::chrono::steady_clock::now();
+
+	      // Block in the following circumstances:
+	      // 1. Queue is empty
+	      // 2. Level of task on front of queue is greater than (e.g. lower
+	      //    priority) the level of the tasks currently being executed
+	      // 3. Start time of task on front of queue is in the future
 
-            task = m_state.queue.top();
-	    m_state.queue.pop();
+              while (m_state.queue.empty() ||
+		     (m_state.inflight && ((m_state.queue.top())->level > inflight_level)) ||
+                     (m_state.queue.top())->start_time > now) {
+
+                if (m_state.shutdown)
+                  return;
+
+                if (m_state.queue.empty() ||
+		    (m_state.inflight && (m_state.queue.top())->level > inflight_level))
+                  m_state.cond.wait(lock);
+                else
+                  m_state.cond.wait_until(lock, (m_state.queue.top())->start_time);
+
+                inflight_level = lowest_inflight_level();
+                now = std::chrono::steady_clock::now();
+              }
+
+              task = m_state.queue.top();
+	      m_state.queue.pop();
+            }
 
             HT_ASSERT(task->level < MAX_LEVELS);
 
@@ -148,10 +184,13 @@ namespace Hypertable {
             if (m_state.shutdown)
               return;
 
+            ThreadActivity::set("maintenance", task->description().c_str());
             task->execute();
+            ThreadActivity::clear();
 
           }
           catch(Hypertable::Exception &e) {
+            ThreadActivity::clear();
             if (e.code() != Error::RANGESERVER_RANGE_NOT_ACTIVE &&
                 dynamic_cast<MaintenanceTaskMemoryPurge *>(task) == 0) {
               bool message_logged = false;
@@ -166,11 +205,17 @@ namespace Hypertable {
                         task->get_retry_delay());
                 task->start_time = std::chrono::steady_clock::now();
                 task->start_time += std::chrono::milliseconds(task->get_retry_delay());
-                m_state.queue.push(task);
+                if (task->get_fast_lane()) {
+                  m_state.fast_queue.push(task);
+                  m_state.fast_cond.notify_one();
+                }
+                else {
+                  m_state.queue.push(task);
+                  m_state.cond.notify_one();
+                }
                 HT_ASSERT(m_state.inflight_levels[task->level] > 0);
                 m_state.inflight_levels[task->level]--;
 		m_state.inflight--;
-                m_state.cond.notify_one();
                 continue;
               }
               if (!message_logged)
@@ -187,12 +232,13 @@ namespace Hypertable {
 	    m_state.generation++;
 	    if (task->get_range())
 	      m_state.ranges.erase(task->get_range());
-	    if (m_state.queue.empty()) {
+	    if (m_state.queue.empty() && m_state.fast_queue.empty()) {
               if (m_state.inflight == 0)
                 m_state.empty_cond.notify_all();
             }
-            else if ((m_state.queue.top())->level > task->level)
-              m_state.cond.notify_all();              
+            else if (!m_state.queue.empty() &&
+                     (m_state.queue.top())->level > task->level)
+              m_state.cond.notify_all();
           }
 
           delete task;
@@ -216,26 +262,36 @@ namespace Hypertable {
       }
 
       MaintenanceQueueState &m_state;
+      bool m_fast_lane;
     };
 
     MaintenanceQueueState  m_state;
     ThreadGroup m_threads;
     int  m_worker_count;
+    int  m_fast_worker_count;
     bool joined;
 
   public:
 
     /** Constructor to set up the maintenance queue.  It creates a number
-     * of worker threads specified by the worker_count argument.
+     * of worker threads specified by the worker_count argument, plus an
+     * optional set of <i>fast lane</i> worker threads which are reserved
+     * for small urgent tasks (see MaintenanceTask#set_fast_lane) so that
+     * they never queue behind long-running compactions.
      *
      * @param worker_count number of worker threads to create
+     * @param fast_worker_count number of fast lane worker threads to create
      */
-    MaintenanceQueue(int worker_count) : m_worker_count(worker_count),
-					 joined(false) {
+    MaintenanceQueue(int worker_count, int fast_worker_count=0)
+      : m_worker_count(worker_count), m_fast_worker_count(fast_worker_count),
+        joined(false) {
+      Worker FastWorker(m_state, true);
       Worker Worker(m_state);
       assert (worker_count > 0);
       for (int i=0; i<worker_count; ++i)
         m_threads.create_thread(Worker);
+      for (int i=0; i<fast_worker_count; ++i)
+        m_threads.create_thread(FastWorker);
       //threads
     }
 
@@ -246,6 +302,7 @@ namespace Hypertable {
     void shutdown() {
       m_state.shutdown = true;
       m_state.cond.notify_all();
+      m_state.fast_cond.notify_all();
     }
 
     /** Waits for a shutdown to complete.  This method returns when all
@@ -299,6 +356,19 @@ namespace Hypertable {
 	  filtered_queue.push(task);
       }
       m_state.queue = filtered_queue;
+      TaskQueue filtered_fast_queue;
+      while (!m_state.fast_queue.empty()) {
+	task = m_state.fast_queue.top();
+        m_state.fast_queue.pop();
+	if (task->get_range() && __f(task->get_range())) {
+          m_state.ranges.erase(task->get_range());
+	  delete task;
+          m_state.generation++;
+        }
+	else
+	  filtered_fast_queue.push(task);
+      }
+      m_state.fast_queue = filtered_fast_queue;
     }
 
     /** Returns <i>true</i> if queue contains a maintenance task for
@@ -318,10 +388,18 @@ namespace Hypertable {
      */
     void add(MaintenanceTask *task) {
       std::lock_guard<std::mutex> lock(m_state.mutex);
-      m_state.queue.push(task);
+      if (m_fast_worker_count == 0)
+        task->set_fast_lane(false);
+      if (task->get_fast_lane()) {
+        m_state.fast_queue.push(task);
+        m_state.fast_cond.notify_one();
+      }
+      else {
+        m_state.queue.push(task);
+        m_state.cond.notify_one();
+      }
       if (task->get_range())
 	m_state.ranges.insert(task->get_range());
-      m_state.cond.notify_one();
     }
 
     /** Returns the size of the queue.
@@ -331,7 +409,8 @@ namespace Hypertable {
      */
     size_t size() {
       std::lock_guard<std::mutex> lock(m_state.mutex);
-      return (size_t)m_state.queue.size() + (size_t)m_state.inflight;
+      return (size_t)m_state.queue.size() + (size_t)m_state.fast_queue.size()
+        + (size_t)m_state.inflight;
     }
 
     /** Returns queue generation number.
@@ -351,8 +430,9 @@ namespace Hypertable {
      */
     bool full() {
       std::lock_guard<std::mutex> lock(m_state.mutex);
-      return (m_state.queue.size() + (size_t)m_state.inflight) >=
-        (size_t)m_worker_count;
+      return (m_state.queue.size() + m_state.fast_queue.size() +
+              (size_t)m_state.inflight) >=
+        (size_t)(m_worker_count + m_fast_worker_count);
     }
 
     /** Returns <i>true</i> if maintenance queue is empty.
@@ -360,7 +440,8 @@ namespace Hypertable {
      */
     bool empty() {
       std::lock_guard<std::mutex> lock(m_state.mutex);
-      return m_state.queue.empty() && m_state.inflight == 0;
+      return m_state.queue.empty() && m_state.fast_queue.empty() &&
+        m_state.inflight == 0;
     }
 
     /** Waits for queue to become empty
@@ -368,7 +449,8 @@ namespace Hypertable {
     void wait_for_empty() {
       std::unique_lock<std::mutex> lock(m_state.mutex);
       m_state.empty_cond.wait(lock, [this](){
-          return m_state.queue.empty() && m_state.inflight == 0; });
+          return m_state.queue.empty() && m_state.fast_queue.empty() &&
+            m_state.inflight == 0; });
     }
 
     /** Waits for queue to become empty with deadline
@@ -378,7 +460,8 @@ namespace Hypertable {
     bool wait_for_empty(ClockT::time_point deadline) {
       std::unique_lock<std::mutex> lock(m_state.mutex);
       return m_state.empty_cond.wait_until(lock, deadline, [this](){
-          return m_state.queue.empty() && m_state.inflight == 0; });
+          return m_state.queue.empty() && m_state.fast_queue.empty() &&
+            m_state.inflight == 0; });
     }
 
     /** Returns the number of worker threads configured for the queue.
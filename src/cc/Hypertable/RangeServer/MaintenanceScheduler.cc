@@ -65,25 +65,30 @@ namespace {
 
 
 MaintenanceScheduler::MaintenanceScheduler(MaintenanceQueuePtr &queue,
-                                           TableInfoMapPtr &live_map)
+                                           TableInfoMapPtr &live_map,
+                                           QueryCachePtr query_cache)
   : m_queue(queue), m_live_map(live_map), m_start_offset(0),
-    m_initialized(false), m_low_memory_mode(false) {
+    m_initialized(false), m_low_memory_mode(false), m_query_cache(query_cache) {
   m_prioritizer = &m_prioritizer_log_cleanup;
   m_maintenance_interval = get_i32("Hypertable.RangeServer.Maintenance.Interval");
   m_query_cache_memory = get_i64("Hypertable.RangeServer.QueryCache.MaxMemory");
   m_low_memory_prioritization = get_bool("Hypertable.RangeServer.Maintenance.LowMemoryPrioritization");
+  m_adaptive_cellcache_budget = get_bool("Hypertable.RangeServer.Maintenance.AdaptiveCellCacheBudget");
+  m_cache_governor = get_bool("Hypertable.RangeServer.Maintenance.CacheMemoryGovernor");
 
   // Setup to immediately schedule maintenance
   m_last_low_memory = chrono::steady_clock::now();
   m_last_check = m_last_low_memory;
 
   m_low_memory_limit_percentage = get_i32("Hypertable.RangeServer.LowMemoryLimit.Percentage");
+  m_emergency_floor_percentage = get_i32("Hypertable.RangeServer.MemoryLimit.EmergencyFloor.Percentage");
   m_merging_delay = get_i32("Hypertable.RangeServer.Maintenance.MergingCompaction.Delay");
   m_merges_per_interval = get_i32("Hypertable.RangeServer.Maintenance.MergesPerInterval",
                                   std::numeric_limits<int32_t>::max());
   m_move_compactions_per_interval = get_i32("Hypertable.RangeServer.Maintenance.MoveCompactionsPerInterval");
   m_initialization_per_interval = get_i32("Hypertable.RangeServer.Maintenance.InitializationPerInterval",
                                           std::numeric_limits<int32_t>::max());
+  m_fast_lane_max_size = get_i64("Hypertable.RangeServer.Maintenance.FastLaneMaxSize");
 
   m_maintenance_queue_worker_count = 
     (int32_t)Global::maintenance_queue->worker_count();
@@ -133,6 +138,15 @@ void MaintenanceScheduler::schedule() {
   memory_state.balance = Global::memory_tracker->balance();
   memory_state.limit = Global::memory_limit;
 
+  // The memory tracker accounts for what we allocated, but arena slack,
+  // heap fragmentation and mmap'd indexes cause the resident set to drift
+  // above it.  Size maintenance decisions off whichever is larger so we
+  // react to what the kernel actually sees.
+  int64_t resident_memory =
+    (int64_t)(System::proc_stat().vm_resident * Property::MiB);
+  if (resident_memory > memory_state.balance)
+    memory_state.balance = resident_memory;
+
   // adjust limit if it makes sense
   if (Global::memory_limit_ensure_unused_current &&
       memory_state.balance - m_query_cache_memory > Global::memory_limit_ensure_unused_current) {
@@ -149,6 +163,34 @@ void MaintenanceScheduler::schedule() {
     memory_state.needed = ((memory_state.limit * m_low_memory_limit_percentage) / 100) + excess;
   }
 
+  // Emergency purge:  if free physical memory has fallen below the hard
+  // floor, the kernel OOM killer is the next one to act.  Force low memory
+  // prioritization for this pass regardless of mode and demand enough
+  // releasable memory to climb back above the floor.
+  MaintenancePrioritizer *prioritizer = m_prioritizer;
+  if (m_emergency_floor_percentage) {
+    const MemStat &mem_stat = System::mem_stat();
+    int64_t free_memory = (int64_t)(mem_stat.actual_free * Property::MiB);
+    int64_t emergency_floor = ((int64_t)(mem_stat.ram * Property::MiB)
+                               * m_emergency_floor_percentage) / 100;
+    if (free_memory < emergency_floor) {
+      HT_WARNF("Emergency memory purge: free physical memory %.2fMB below "
+               "floor %.2fMB (RSS %.2fMB, tracked %.2fMB)",
+               free_memory / (double)Property::MiB,
+               emergency_floor / (double)Property::MiB,
+               resident_memory / (double)Property::MiB,
+               (double)Global::memory_tracker->balance() / (double)Property::MiB);
+      prioritizer = &m_prioritizer_low_memory;
+      low_memory = true;
+      do_scheduling = true;
+      int64_t deficit = emergency_floor - free_memory;
+      memory_state.needed =
+        std::max(memory_state.needed,
+                 ((memory_state.limit * m_low_memory_limit_percentage) / 100)
+                 + deficit);
+    }
+  }
+
   if (debug) {
     trace_str += String("low_memory\t") + (low_memory ? "true" : "false") + "\n";
     trace_str += format("Global::memory_tracker->balance()\t%lld\n", (Lld)Global::memory_tracker->balance());
@@ -178,6 +220,9 @@ void MaintenanceScheduler::schedule() {
     }
   }
 
+  if (m_cache_governor)
+    rebalance_cache_memory();
+
   if (!do_scheduling)
     return;
 
@@ -204,6 +249,9 @@ void MaintenanceScheduler::schedule() {
   for (auto &rd : ranges.array)
     rd.data = rd.range->get_maintenance_data(ranges.arena, current_time, flags);
 
+  if (m_adaptive_cellcache_budget)
+    compute_cellcache_budgets(ranges.array);
+
   if (ranges.array.empty()) {
     if (!Global::range_initialization_complete)
       Global::range_initialization_complete = true;
@@ -245,7 +293,7 @@ void MaintenanceScheduler::schedule() {
       ranges.remove_if(in_blacklist);
   }
 
-  HT_ASSERT(m_prioritizer);
+  HT_ASSERT(prioritizer);
 
   int64_t block_index_memory = 0;
   int64_t bloom_filter_memory = 0;
@@ -361,8 +409,8 @@ void MaintenanceScheduler::schedule() {
   if (debug)
     trace_str += "\nScheduling Decisions:\n";
 
-  m_prioritizer->prioritize(ranges.array, memory_state, priority,
-                            debug ? &trace_str : 0);
+  prioritizer->prioritize(ranges.array, memory_state, priority,
+                          debug ? &trace_str : 0);
 
   if (debug)
     write_debug_output(now, ranges, trace_str);
@@ -441,20 +489,32 @@ void MaintenanceScheduler::schedule() {
         level = get_level(rd);
         task = new MaintenanceTaskCompaction(level, rd.data->priority,
                                              schedule_time, rd.range);
+        bool flushes_only = !rd.data->needs_major_compaction;
+        int64_t flush_memory = 0;
         if (!rd.data->needs_major_compaction) {
           for (AccessGroup::MaintenanceData *ag_data=rd.data->agdata; ag_data; ag_data=ag_data->next) {
             if (MaintenanceFlag::minor_compaction(ag_data->maintenance_flags) ||
                 MaintenanceFlag::major_compaction(ag_data->maintenance_flags) ||
-                MaintenanceFlag::gc_compaction(ag_data->maintenance_flags))
+                MaintenanceFlag::gc_compaction(ag_data->maintenance_flags)) {
               task->add_subtask(ag_data->ag, ag_data->maintenance_flags);
+              if (MaintenanceFlag::minor_compaction(ag_data->maintenance_flags))
+                flush_memory += ag_data->mem_used;
+              else
+                flushes_only = false;
+            }
             else if (MaintenanceFlag::merging_compaction(ag_data->maintenance_flags)) {
               if (merges_created < m_merges_per_interval) {
                 task->add_subtask(ag_data->ag, ag_data->maintenance_flags);
                 merges_created++;
+                flushes_only = false;
               }
             }
           }
         }
+        // Route small pure-flush compactions to the fast lane so they
+        // don't queue behind long-running merging or major compactions
+        if (flushes_only && flush_memory <= m_fast_lane_max_size)
+          task->set_fast_lane(true);
         Global::maintenance_queue->add(task);
       }
       else if (rd.data->maintenance_flags & MaintenanceFlag::MEMORY_PURGE) {
@@ -502,6 +562,158 @@ int MaintenanceScheduler::get_level(RangeData &rd) {
 }
 
 
+void MaintenanceScheduler::compute_cellcache_budgets(std::vector<RangeData> &range_data) {
+  map<Range *, WriteRateState> state;
+  double max_rate = 0.0;
+
+  // Exponentially smoothed growth of each range's bytes_written since the
+  // previous pass; the map is rebuilt every pass so dropped ranges age out
+  for (auto &rd : range_data) {
+    WriteRateState wrs;
+    wrs.bytes_written = rd.data->load_factors.bytes_written;
+    auto iter = m_write_rate_state.find(rd.range.get());
+    if (iter != m_write_rate_state.end()) {
+      wrs.rate = (iter->second.rate +
+                  (double)(wrs.bytes_written - iter->second.bytes_written)) / 2.0;
+      wrs.seeded = true;
+    }
+    if (wrs.rate > max_rate)
+      max_rate = wrs.rate;
+    state[rd.range.get()] = wrs;
+  }
+  m_write_rate_state.swap(state);
+
+  // Budget each range proportional to its share of the hottest range's
+  // write rate, clamped to [max/8, max].  With no write activity, or for
+  // ranges seen for the first time, fall back to the configured maximum.
+  for (auto &rd : range_data) {
+    int64_t budget = Global::access_group_max_mem;
+    auto iter = m_write_rate_state.find(rd.range.get());
+    HT_ASSERT(iter != m_write_rate_state.end());
+    if (max_rate > 0.0 && iter->second.seeded) {
+      budget = (int64_t)((double)Global::access_group_max_mem *
+                         (iter->second.rate / max_rate));
+      if (budget < Global::access_group_max_mem / 8)
+        budget = Global::access_group_max_mem / 8;
+    }
+    rd.range->set_cellcache_budget(budget);
+    rd.data->cellcache_budget = budget;
+  }
+}
+
+
+void MaintenanceScheduler::rebalance_cache_memory() {
+  uint64_t bc_size {}, bc_avail {}, bc_accesses {}, bc_hits {};
+  uint64_t qc_size {}, qc_avail {}, qc_lookups {}, qc_hits {};
+  int32_t qc_waiters {};
+
+  if (Global::block_cache == 0 && !m_query_cache)
+    return;
+
+  if (Global::block_cache)
+    Global::block_cache->get_stats(&bc_size, &bc_avail, &bc_accesses, &bc_hits);
+  if (m_query_cache)
+    m_query_cache->get_stats(&qc_size, &qc_avail, &qc_lookups, &qc_hits,
+                             &qc_waiters);
+
+  if (!m_cache_governor_state.seeded) {
+    // First pass establishes the combined budget and counter baselines
+    m_cache_budget_total = (int64_t)bc_size + (int64_t)qc_size;
+    m_cache_governor_state.bc_accesses = bc_accesses;
+    m_cache_governor_state.bc_hits = bc_hits;
+    m_cache_governor_state.qc_lookups = qc_lookups;
+    m_cache_governor_state.qc_hits = qc_hits;
+    m_cache_governor_state.seeded = true;
+    return;
+  }
+
+  uint64_t bc_recent_hits = bc_hits - m_cache_governor_state.bc_hits;
+  uint64_t qc_recent_hits = qc_hits - m_cache_governor_state.qc_hits;
+  m_cache_governor_state.bc_accesses = bc_accesses;
+  m_cache_governor_state.bc_hits = bc_hits;
+  m_cache_governor_state.qc_lookups = qc_lookups;
+  m_cache_governor_state.qc_hits = qc_hits;
+
+  if (m_cache_budget_total == 0)
+    return;
+
+  // Marginal utility estimate:  hits delivered per byte of cache since the
+  // previous pass
+  double bc_utility = bc_size ? (double)bc_recent_hits / (double)bc_size : 0.0;
+  double qc_utility = qc_size ? (double)qc_recent_hits / (double)qc_size : 0.0;
+
+  int64_t balance = Global::memory_tracker->balance();
+  int64_t excess = balance - Global::memory_limit;
+  int64_t total = (int64_t)bc_size + (int64_t)qc_size;
+  int64_t min_size = m_cache_budget_total / 10;
+  int64_t step = m_cache_budget_total / 20;
+
+  if (excess > 0) {
+    // Shrink the caches to make room for pools the governor cannot shrink
+    // directly (cell caches, block indexes, bloom filters), taking from
+    // the cache with the lower marginal utility first
+    int64_t shed = excess;
+    bool bc_first = bc_utility <= qc_utility;
+    for (int pass=0; pass<2 && shed>0; pass++) {
+      if ((pass == 0) == bc_first) {
+        if (Global::block_cache && (int64_t)bc_size > min_size) {
+          int64_t amount = std::min(shed, (int64_t)bc_size - min_size);
+          Global::block_cache->decrease_limit(amount);
+          HT_INFOF("Cache governor: shrinking block cache by %lld bytes "
+                   "(memory balance over limit by %lld)",
+                   (Lld)amount, (Lld)excess);
+          shed -= amount;
+        }
+      }
+      else if (m_query_cache && (int64_t)qc_size > min_size) {
+        int64_t amount = std::min(shed, (int64_t)qc_size - min_size);
+        m_query_cache->set_max_memory(qc_size - amount);
+        HT_INFOF("Cache governor: shrinking query cache by %lld bytes "
+                 "(memory balance over limit by %lld)",
+                 (Lld)amount, (Lld)excess);
+        shed -= amount;
+      }
+    }
+    return;
+  }
+
+  int64_t headroom = -excess;
+  int64_t deficit = m_cache_budget_total - total;
+
+  if (deficit > 0 && headroom > 0) {
+    // Pressure has subsided; grow back toward the combined budget, giving
+    // the new memory to the cache with the higher marginal utility
+    int64_t amount = std::min(std::min(deficit, headroom), step);
+    if (Global::block_cache && (bc_utility >= qc_utility || !m_query_cache)) {
+      Global::block_cache->increase_limit(amount);
+      HT_INFOF("Cache governor: growing block cache by %lld bytes",
+               (Lld)amount);
+    }
+    else if (m_query_cache) {
+      m_query_cache->set_max_memory(qc_size + amount);
+      HT_INFOF("Cache governor: growing query cache by %lld bytes",
+               (Lld)amount);
+    }
+  }
+  else if (Global::block_cache && m_query_cache) {
+    // Steady state; shift budget from the cache with substantially lower
+    // marginal utility to the other
+    if (bc_utility > 2.0*qc_utility && (int64_t)qc_size - step > min_size) {
+      m_query_cache->set_max_memory(qc_size - step);
+      Global::block_cache->increase_limit(step);
+      HT_INFOF("Cache governor: shifting %lld bytes from query cache to "
+               "block cache", (Lld)step);
+    }
+    else if (qc_utility > 2.0*bc_utility && (int64_t)bc_size - step > min_size) {
+      Global::block_cache->decrease_limit(step);
+      m_query_cache->set_max_memory(qc_size + step);
+      HT_INFOF("Cache governor: shifting %lld bytes from block cache to "
+               "query cache", (Lld)step);
+    }
+  }
+}
+
+
 bool MaintenanceScheduler::debug_signal_file_exists(chrono::steady_clock::time_point now) {
   if (now - m_last_check >= chrono::milliseconds(60000)) {
     m_last_check = now;
@@ -31,9 +31,11 @@
 #include <Hypertable/RangeServer/MaintenancePrioritizerLogCleanup.h>
 #include <Hypertable/RangeServer/MaintenancePrioritizerLowMemory.h>
 #include <Hypertable/RangeServer/LoadStatistics.h>
+#include <Hypertable/RangeServer/QueryCache.h>
 #include <Hypertable/RangeServer/TableInfoMap.h>
 
 #include <chrono>
+#include <map>
 #include <memory>
 #include <mutex>
 #include <set>
@@ -49,7 +51,8 @@ namespace Hypertable {
 
     /// Constructor.
     MaintenanceScheduler(MaintenanceQueuePtr &queue,
-                         TableInfoMapPtr &live_map);
+                         TableInfoMapPtr &live_map,
+                         QueryCachePtr query_cache = QueryCachePtr());
 
     /// Schedules maintenance.
     void schedule();
@@ -96,6 +99,29 @@ namespace Hypertable {
     void write_debug_output(std::chrono::steady_clock::time_point now, Ranges &ranges,
                             const String &header_str);
 
+    /// Computes adaptive cell cache budgets from per-range write rates.
+    /// Derives each range's recent write rate from the growth of its
+    /// <i>bytes written</i> load factor since the previous scheduler pass
+    /// (exponentially smoothed) and installs a cell cache budget
+    /// proportional to the range's share of the hottest range's rate,
+    /// clamped between 1/8th of and the full
+    /// <code>Hypertable.RangeServer.AccessGroup.MaxMemory</code>.  Hot
+    /// ranges thereby accumulate large caches (fewer, larger cellstores)
+    /// while cold ranges flush early.
+    /// @param range_data Maintenance data for all live ranges
+    void compute_cellcache_budgets(std::vector<RangeData> &range_data);
+
+    /// Rebalances memory between the block cache and the query cache.
+    /// Treats the two cache budgets as one pool.  When the memory tracker
+    /// balance exceeds the limit (e.g. cell cache growth during an ingest
+    /// burst), budget is shed from the cache with the lower marginal
+    /// utility, estimated as hits delivered per byte of cache since the
+    /// previous scheduler pass.  As pressure subsides the budget is grown
+    /// back toward its configured total, and in steady state budget is
+    /// shifted from the cache with substantially lower marginal utility to
+    /// the other, so the split tracks workload shifts without hand tuning.
+    void rebalance_cache_memory();
+
     /// %Mutex to serialize concurrent access
     std::mutex m_mutex;
 
@@ -111,8 +137,10 @@ namespace Hypertable {
     std::chrono::steady_clock::time_point m_last_low_memory;
     std::chrono::steady_clock::time_point m_last_check;
     int64_t m_query_cache_memory;
+    int64_t m_fast_lane_max_size;
     int32_t m_maintenance_interval;
     int32_t m_low_memory_limit_percentage;
+    int32_t m_emergency_floor_percentage;
     int32_t m_merging_delay;
     int32_t m_merges_per_interval;
     int32_t m_move_compactions_per_interval;
@@ -122,6 +150,41 @@ namespace Hypertable {
     bool m_initialized {};
     bool m_low_memory_prioritization;
     bool m_low_memory_mode {};
+
+    /// Flag indicating if adaptive cell cache budgets are enabled
+    bool m_adaptive_cellcache_budget {};
+
+    /// Per-range write rate state for adaptive cell cache budgets
+    struct WriteRateState {
+      uint64_t bytes_written {};
+      double rate {};
+      bool seeded {};
+    };
+
+    /// Write rate state from the previous scheduler pass, keyed by range
+    std::map<Range *, WriteRateState> m_write_rate_state;
+
+    /// Query cache (rebalanced by the cache memory governor)
+    QueryCachePtr m_query_cache;
+
+    /// Flag indicating if the cache memory governor is enabled
+    bool m_cache_governor {};
+
+    /// Combined cache budget (block cache plus query cache) the governor
+    /// grows back toward when memory pressure subsides
+    int64_t m_cache_budget_total {};
+
+    /// Cache counters from the previous scheduler pass
+    struct CacheGovernorState {
+      uint64_t bc_accesses {};
+      uint64_t bc_hits {};
+      uint64_t qc_lookups {};
+      uint64_t qc_hits {};
+      bool seeded {};
+    };
+
+    /// Cache governor state from the previous scheduler pass
+    CacheGovernorState m_cache_governor_state;
   };
 
   /// Smart pointer to MaintenanceScheduler
@@ -60,6 +60,9 @@ namespace Hypertable {
     int get_priority() { return priority; }
     void set_priority(int p) { priority = p; }
 
+    bool get_fast_lane() { return m_fast_lane; }
+    void set_fast_lane(bool fast_lane) { m_fast_lane = fast_lane; }
+
     Range *get_range() { return m_range.get(); }
 
     void add_subtask(const void *obj, int flags) {
@@ -76,6 +79,7 @@ namespace Hypertable {
 
   private:
     bool m_retry {};
+    bool m_fast_lane {};
     uint32_t m_retry_delay_millis;
     String m_description;
   };
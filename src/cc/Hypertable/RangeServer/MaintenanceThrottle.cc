@@ -0,0 +1,148 @@
+/*
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/// @file
+/// Definitions for MaintenanceThrottle.
+/// This file contains definitions for MaintenanceThrottle, a byte rate
+/// budget for maintenance work driven by foreground scan latency.
+
+#include <Common/Compat.h>
+
+#include "MaintenanceThrottle.h"
+
+#include <Common/Logger.h>
+
+#include <algorithm>
+
+using namespace Hypertable;
+using namespace std;
+
+MaintenanceThrottle::MaintenanceThrottle(PropertiesPtr &props) {
+  m_enabled =
+    props->get_bool("Hypertable.RangeServer.Maintenance.Throttle.Enabled");
+  m_percentile =
+    props->get_i32("Hypertable.RangeServer.Maintenance.Throttle.Percentile");
+  m_latency_threshold_millis =
+    props->get_i32("Hypertable.RangeServer.Maintenance.Throttle"
+                   ".ScanLatencyThreshold");
+  m_min_rate =
+    props->get_i64("Hypertable.RangeServer.Maintenance.Throttle.MinRate");
+  m_max_rate =
+    props->get_i64("Hypertable.RangeServer.Maintenance.Throttle.MaxRate");
+  if (m_percentile < 50 || m_percentile > 100) {
+    HT_WARNF("Invalid Hypertable.RangeServer.Maintenance.Throttle.Percentile "
+             "%d, using 99", (int)m_percentile);
+    m_percentile = 99;
+  }
+  m_last_refill = chrono::steady_clock::now();
+}
+
+void MaintenanceThrottle::record_scan_latency(int64_t latency_nsec) {
+  if (!m_enabled)
+    return;
+  lock_guard<mutex> lock(m_mutex);
+  m_samples.push_back(latency_nsec);
+}
+
+void MaintenanceThrottle::update() {
+  if (!m_enabled)
+    return;
+
+  lock_guard<mutex> lock(m_mutex);
+
+  // No foreground scans since the last update; the server is idle, so open
+  // the throttle completely
+  if (m_samples.empty()) {
+    if (m_current_rate != 0) {
+      HT_INFO("Maintenance throttle opened (no scan activity)");
+      m_current_rate = 0;
+      m_cond.notify_all();
+    }
+    return;
+  }
+
+  size_t position = (m_samples.size() * m_percentile) / 100;
+  if (position >= m_samples.size())
+    position = m_samples.size() - 1;
+  nth_element(m_samples.begin(), m_samples.begin() + position,
+              m_samples.end());
+  int64_t latency_millis = m_samples[position] / 1000000LL;
+  m_samples.clear();
+
+  if (latency_millis > (int64_t)m_latency_threshold_millis) {
+    // Degraded; shrink the budget
+    int64_t new_rate = (m_current_rate == 0) ? m_max_rate : m_current_rate / 2;
+    new_rate = std::max(new_rate, m_min_rate);
+    if (new_rate != m_current_rate) {
+      HT_INFOF("Maintenance throttle reduced to %lld bytes/s (p%d scan "
+               "latency %lld ms)", (Lld)new_rate, (int)m_percentile,
+               (Lld)latency_millis);
+      m_current_rate = new_rate;
+    }
+  }
+  else if (m_current_rate != 0) {
+    // Healthy; grow the budget, opening completely past the ceiling
+    int64_t new_rate = m_current_rate * 2;
+    if (new_rate > m_max_rate) {
+      HT_INFOF("Maintenance throttle opened (p%d scan latency %lld ms)",
+               (int)m_percentile, (Lld)latency_millis);
+      m_current_rate = 0;
+    }
+    else
+      m_current_rate = new_rate;
+    m_cond.notify_all();
+  }
+}
+
+void MaintenanceThrottle::throttle(uint64_t bytes) {
+  if (!m_enabled)
+    return;
+
+  unique_lock<mutex> lock(m_mutex);
+
+  if (m_current_rate == 0) {
+    m_last_refill = chrono::steady_clock::now();
+    return;
+  }
+
+  refill_tokens();
+  m_tokens -= (int64_t)bytes;
+
+  while (m_tokens < 0 && m_current_rate != 0) {
+    int64_t wait_millis = ((-m_tokens) * 1000) / m_current_rate + 1;
+    m_cond.wait_for(lock, chrono::milliseconds(wait_millis));
+    if (m_current_rate == 0)
+      break;
+    refill_tokens();
+  }
+}
+
+void MaintenanceThrottle::refill_tokens() {
+  auto now = chrono::steady_clock::now();
+  int64_t elapsed_millis =
+    chrono::duration_cast<chrono::milliseconds>(now - m_last_refill).count();
+  if (elapsed_millis > 0) {
+    m_tokens += (m_current_rate * elapsed_millis) / 1000;
+    // Cap the burst at one second's worth of budget
+    m_tokens = std::min(m_tokens, m_current_rate);
+    m_last_refill = now;
+  }
+}
@@ -0,0 +1,127 @@
+/* -*- c++ -*-
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/// @file
+/// Declarations for MaintenanceThrottle.
+/// This file contains declarations for MaintenanceThrottle, a byte rate
+/// budget for maintenance work driven by foreground scan latency.
+
+#ifndef Hypertable_RangeServer_MaintenanceThrottle_h
+#define Hypertable_RangeServer_MaintenanceThrottle_h
+
+#include <Common/Properties.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace Hypertable {
+
+  /// @addtogroup RangeServer
+  /// @{
+
+  /// Byte rate budget for maintenance work, driven by scan latency.
+  /// Compactions compete with foreground scans for disk bandwidth and CPU.
+  /// This class maintains a token bucket that compaction tasks draw from as
+  /// they write, and adjusts the bucket's fill rate from observed scan
+  /// latency:  when the recent 99th percentile scan latency exceeds a
+  /// configured threshold the rate is halved (down to a floor), when
+  /// latency is healthy the rate is doubled, and when no scans were
+  /// observed at all the throttle opens completely.  This closes the loop
+  /// that operators previously approximated by adjusting maintenance
+  /// thread counts from cron.
+  ///
+  /// The throttle is controlled by the
+  /// <code>Hypertable.RangeServer.Maintenance.Throttle.*</code> properties
+  /// and is disabled by default, in which case all methods are no-ops.
+  class MaintenanceThrottle {
+  public:
+
+    /** Constructor.
+     * @param props Configuration properties
+     */
+    MaintenanceThrottle(PropertiesPtr &props);
+
+    /** Records the latency of a foreground scan request.
+     * @param latency_nsec Latency in nanoseconds
+     */
+    void record_scan_latency(int64_t latency_nsec);
+
+    /** Adjusts the budget from scan latencies observed since the last
+     * call.  Called periodically from the statistics gathering timer.
+     */
+    void update();
+
+    /** Draws <code>bytes</code> from the budget, blocking while the budget
+     * is exhausted.  Called from compaction write loops.
+     * @param bytes Number of bytes written
+     */
+    void throttle(uint64_t bytes);
+
+  private:
+
+    /// Refills #m_tokens from the elapsed time (#m_mutex must be held)
+    void refill_tokens();
+
+    /// %Mutex for serializing access to members
+    std::mutex m_mutex;
+
+    /// Condition variable for waking throttled tasks on budget changes
+    std::condition_variable m_cond;
+
+    /// Scan latencies observed since the last update() (nanoseconds)
+    std::vector<int64_t> m_samples;
+
+    /// Current rate in bytes/s; 0 means unthrottled
+    int64_t m_current_rate {};
+
+    /// Available bytes in the token bucket
+    int64_t m_tokens {};
+
+    /// Time of last token refill
+    std::chrono::steady_clock::time_point m_last_refill;
+
+    /// <i>true</i> if the throttle is enabled
+    bool m_enabled {};
+
+    /// Scan latency percentile compared against the threshold
+    int32_t m_percentile {};
+
+    /// p99 scan latency above which the budget shrinks (milliseconds)
+    int32_t m_latency_threshold_millis {};
+
+    /// Budget floor in bytes/s
+    int64_t m_min_rate {};
+
+    /// Budget ceiling in bytes/s; growing past it opens the throttle
+    int64_t m_max_rate {};
+  };
+
+  /// Smart pointer to MaintenanceThrottle
+  typedef std::shared_ptr<MaintenanceThrottle> MaintenanceThrottlePtr;
+
+  /// @}
+
+}
+
+#endif // Hypertable_RangeServer_MaintenanceThrottle_h
@@ -45,8 +45,11 @@ namespace Hypertable {
     /// Constructor.
     /// @param block_cache Pointer to block cache
     /// @param query_cache Pointer to query cache
-    MemoryTracker(FileBlockCache *block_cache, QueryCachePtr query_cache) 
-      : m_block_cache(block_cache), m_query_cache(query_cache) { }
+    /// @param compressed_block_cache Pointer to compressed block cache tier
+    MemoryTracker(FileBlockCache *block_cache, QueryCachePtr query_cache,
+                  FileBlockCache *compressed_block_cache = 0)
+      : m_block_cache(block_cache), m_query_cache(query_cache),
+        m_compressed_block_cache(compressed_block_cache) { }
 
     /// Add to memory used.
     /// @param amount Amount of memory to add
@@ -70,6 +73,7 @@ namespace Hypertable {
     int64_t balance() {
       std::lock_guard<std::mutex> lock(m_mutex);
       return m_memory_used + (m_block_cache ? m_block_cache->memory_used() : 0) +
+        (m_compressed_block_cache ? m_compressed_block_cache->memory_used() : 0) +
         (m_query_cache ? m_query_cache->memory_used() : 0);
     }
 
@@ -86,6 +90,9 @@ namespace Hypertable {
 
     /// Pointer to query cache
     QueryCachePtr m_query_cache;
+
+    /// Pointer to compressed block cache tier
+    FileBlockCache *m_compressed_block_cache;
   };
 
   /// @}
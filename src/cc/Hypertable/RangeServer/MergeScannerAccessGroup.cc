@@ -26,6 +26,7 @@
 
 #include <Common/Compat.h>
 
+#include "AccessGroupGarbageTracker.h"
 #include "MergeScannerAccessGroup.h"
 
 #include <Hypertable/Lib/Key.h>
@@ -38,14 +39,17 @@ using namespace Hypertable;
 
 MergeScannerAccessGroup::MergeScannerAccessGroup(String &table_name,
                                                  ScanContext *scan_ctx,
-                                                 uint32_t flags)
+                                                 uint32_t flags,
+                                        AccessGroupGarbageTracker *garbage_tracker)
   : m_flags(flags), m_return_deletes(flags & RETURN_DELETES),
     m_accumulate_counters(flags & ACCUMULATE_COUNTERS), m_prev_cf(-1),
-    m_counted_value(12), m_scan_context(scan_ctx)
+    m_counted_value(12), m_scan_context(scan_ctx),
+    m_garbage_tracker(garbage_tracker)
 { 
   m_start_timestamp = scan_ctx->time_interval.first;
   m_end_timestamp = scan_ctx->time_interval.second;
   m_revision = scan_ctx->revision;
+  m_schema_versions = scan_ctx->spec == 0 || scan_ctx->spec->max_versions == 0;
 
   bool has_index = false;
   bool has_qualifier_index = false;
@@ -72,10 +76,68 @@ MergeScannerAccessGroup::MergeScannerAccessGroup(String &table_name,
   if (has_index || has_qualifier_index)
     m_index_updater = IndexUpdaterFactory::create(table_name, scan_ctx->schema,
                                 has_index, has_qualifier_index);
+
+  select_forward_path();
+}
+
+void MergeScannerAccessGroup::set_sources_inside_time_window() {
+  m_sources_inside_window = true;
+  select_forward_path();
+}
+
+void MergeScannerAccessGroup::select_forward_path() {
+  ScanContext *scan_ctx = m_scan_context;
+
+  // Select the forward() instantiation for this scan.  The scan context is
+  // inspected once here so the per-cell loop runs without the filters the
+  // scan cannot exercise (see forward_impl()).
+  int needed = 0;
+
+  // A time interval is dead weight if every source was classified as
+  // lying entirely inside it (see set_sources_inside_time_window())
+  if (((m_start_timestamp != TIMESTAMP_MIN
+        || m_end_timestamp != TIMESTAMP_MAX) && !m_sources_inside_window)
+      || m_revision != TIMESTAMP_MAX)
+    needed |= NEED_TIME_FILTER;
+
+  for (int cf = 0; cf < 256; cf++) {
+    if (!scan_ctx->family_mask[cf])
+      continue;
+    CellPredicate &cp = scan_ctx->cell_predicates[cf];
+    // A default constructed predicate (cutoff_time of 0) carries no TTL;
+    // families included in the scan get TIMESTAMP_MIN when TTL is unset
+    if (cp.cutoff_time != TIMESTAMP_MIN && cp.cutoff_time != 0)
+      needed |= NEED_TIME_FILTER;
+    if (cp.max_versions > 0)
+      needed |= NEED_VERSION_TRACKING;
+    if (cp.has_patterns())
+      needed |= NEED_PREDICATE_FILTER;
+    if (m_accumulate_counters && cp.counter)
+      needed |= NEED_COUNTER_HANDLING;
+  }
+
+  if (scan_ctx->row_regexp || scan_ctx->value_regexp
+      || !scan_ctx->rowset.empty())
+    needed |= NEED_PREDICATE_FILTER;
+
+  // Scans returning deletes, compaction scans and scans feeding index
+  // maintenance exercise branches interleaved with the filters, so they
+  // always take the general path
+  if ((m_flags & (RETURN_DELETES|IS_COMPACTION)) || m_index_updater)
+    needed = NEED_ALL;
+
+  if (needed == 0)
+    m_forward = &MergeScannerAccessGroup::forward_impl<0>;
+  else if ((needed & ~NEED_TIME_FILTER) == 0)
+    m_forward = &MergeScannerAccessGroup::forward_impl<NEED_TIME_FILTER>;
+  else
+    m_forward = &MergeScannerAccessGroup::forward_impl<NEED_ALL>;
 }
 
 MergeScannerAccessGroup::~MergeScannerAccessGroup() {
   try {
+    if (m_garbage_tracker)
+      m_garbage_tracker->add_scan_sample(m_bytes_input, m_bytes_garbage);
     if (m_release_callback)
       m_release_callback();
   }
@@ -85,11 +147,12 @@ MergeScannerAccessGroup::~MergeScannerAccessGroup() {
   }
 }
 
-void MergeScannerAccessGroup::forward() {
+template <int FilterMask>
+void MergeScannerAccessGroup::forward_impl() {
   ScannerState sstate;
   Key key;
-  bool counter;
-  int64_t cell_cutoff, cur_bytes = 0;
+  bool counter = false;
+  int64_t cur_bytes = 0;
 
   if (m_queue.empty()) {
     if (m_count_present)
@@ -132,36 +195,37 @@ void MergeScannerAccessGroup::forward() {
       cur_bytes = sstate.key.length + sstate.value.length();
       io_add_input_cell(cur_bytes);
 
-      CellPredicate &cp =
-        m_scan_context->cell_predicates[sstate.key.column_family_code];
-
       // we only need to care about counters for a MergeScanner which is 
       // merging over a single access group since no counter will span 
       // multiple access groups
-      cell_cutoff = m_scan_context->cell_predicates[
-                sstate.key.column_family_code].cutoff_time;
-      counter = m_accumulate_counters &&
-        m_scan_context->cell_predicates[sstate.key.column_family_code].counter;
+      if (FilterMask & NEED_COUNTER_HANDLING)
+        counter = m_accumulate_counters && m_scan_context->cell_predicates[
+                sstate.key.column_family_code].counter;
 
       // apply the various filters...
-      if (sstate.key.timestamp < cell_cutoff) {
-        if (m_index_updater && sstate.key.flag == FLAG_INSERT)
-          purge_from_index(sstate.key, sstate.value);
-        continue;
-      }
-      else if (sstate.key.timestamp < m_start_timestamp) {
-        if (m_index_updater && sstate.key.flag == FLAG_INSERT)
-          purge_from_index(sstate.key, sstate.value);
-        continue;
-      }
-      else if (sstate.key.revision > m_revision ||
-               (sstate.key.timestamp >= m_end_timestamp &&
-                sstate.key.flag == FLAG_INSERT)) {
-        if (m_index_updater && sstate.key.flag == FLAG_INSERT)
-          purge_from_index(sstate.key, sstate.value);
-        continue;
+      if (FilterMask & NEED_TIME_FILTER) {
+        int64_t cell_cutoff = m_scan_context->cell_predicates[
+                  sstate.key.column_family_code].cutoff_time;
+        if (sstate.key.timestamp < cell_cutoff) {
+          io_add_garbage_cell(cur_bytes);
+          if (m_index_updater && sstate.key.flag == FLAG_INSERT)
+            purge_from_index(sstate.key, sstate.value);
+          continue;
+        }
+        if (sstate.key.timestamp < m_start_timestamp) {
+          if (m_index_updater && sstate.key.flag == FLAG_INSERT)
+            purge_from_index(sstate.key, sstate.value);
+          continue;
+        }
+        if (sstate.key.revision > m_revision ||
+            (sstate.key.timestamp >= m_end_timestamp &&
+             sstate.key.flag == FLAG_INSERT)) {
+          if (m_index_updater && sstate.key.flag == FLAG_INSERT)
+            purge_from_index(sstate.key, sstate.value);
+          continue;
+        }
       }
-      else if (sstate.key.flag == FLAG_DELETE_ROW) {
+      if (sstate.key.flag == FLAG_DELETE_ROW) {
         if (matches_deleted_row(sstate.key)) {
           if (m_deleted_row_timestamp < sstate.key.timestamp)
             m_deleted_row_timestamp = sstate.key.timestamp;
@@ -170,6 +234,7 @@ void MergeScannerAccessGroup::forward() {
           update_deleted_row(sstate.key);
         if (m_return_deletes)
           break;
+        io_add_garbage_cell(cur_bytes);
       }
       else if (sstate.key.flag == FLAG_DELETE_COLUMN_FAMILY) {
         if (matches_deleted_column_family(sstate.key)) {
@@ -180,6 +245,7 @@ void MergeScannerAccessGroup::forward() {
           update_deleted_column_family(sstate.key);
         if (m_return_deletes)
           break;
+        io_add_garbage_cell(cur_bytes);
       }
       else if (sstate.key.flag == FLAG_DELETE_CELL) {
         if (matches_deleted_cell(sstate.key)) {
@@ -190,6 +256,7 @@ void MergeScannerAccessGroup::forward() {
           update_deleted_cell(sstate.key);
         if (m_return_deletes)
           break;
+        io_add_garbage_cell(cur_bytes);
       }
       else if (sstate.key.flag == FLAG_DELETE_CELL_VERSION) {
         if (matches_deleted_cell_version(sstate.key)) {
@@ -199,6 +266,7 @@ void MergeScannerAccessGroup::forward() {
           update_deleted_cell_version(sstate.key);
         if (m_return_deletes)
           break;
+        io_add_garbage_cell(cur_bytes);
       }
       else if (sstate.key.flag == FLAG_INSERT) {
         // this cell is not a delete and it is within the requested 
@@ -213,6 +281,7 @@ void MergeScannerAccessGroup::forward() {
             else if (m_deleted_cell_version_set.find(sstate.key.timestamp) !=
                      m_deleted_cell_version_set.end()) {
               // apply previously seen delete cell version to this cell
+              io_add_garbage_cell(cur_bytes);
               if (m_index_updater)
                 purge_from_index(sstate.key, sstate.value);
               continue;
@@ -224,6 +293,7 @@ void MergeScannerAccessGroup::forward() {
               m_deleted_cell.clear();
             else if (sstate.key.timestamp <= m_deleted_cell_timestamp) {
               // apply previously seen delete cell to this cell
+              io_add_garbage_cell(cur_bytes);
               if (m_index_updater)
                 purge_from_index(sstate.key, sstate.value);
               continue;
@@ -235,6 +305,7 @@ void MergeScannerAccessGroup::forward() {
               m_deleted_column_family.clear();
             else if (sstate.key.timestamp <= m_deleted_column_family_timestamp){
               // apply previously seen delete column family to this cell
+              io_add_garbage_cell(cur_bytes);
               if (m_index_updater)
                 purge_from_index(sstate.key, sstate.value);
               continue;
@@ -246,6 +317,7 @@ void MergeScannerAccessGroup::forward() {
               m_deleted_row.clear();
             else if (sstate.key.timestamp <= m_deleted_row_timestamp) {
               // apply previously seen delete row family to this cell
+              io_add_garbage_cell(cur_bytes);
               if (m_index_updater)
                 purge_from_index(sstate.key, sstate.value);
               continue;
@@ -258,66 +330,85 @@ void MergeScannerAccessGroup::forward() {
             m_delete_present = false;
         }
 
-        // keep track of revisions
-        const uint8_t *latest_key = (const uint8_t *)sstate.key.row;
-        size_t latest_key_len = sstate.key.flag_ptr -
-                (const uint8_t *)sstate.key.row + 1;
+        if (FilterMask & NEED_VERSION_TRACKING) {
+          CellPredicate &cp =
+            m_scan_context->cell_predicates[sstate.key.column_family_code];
 
-        if (m_prev_key.fill()==0) {
-          m_prev_key.set(latest_key, latest_key_len);
-          m_prev_cf = sstate.key.column_family_code;
-          m_revs_count=0;
-          m_revs_limit = cp.max_versions;
-        }
-        else if (m_prev_key.fill() != latest_key_len ||
-            memcmp(latest_key, m_prev_key.base, latest_key_len)) {
+          // keep track of revisions
+          const uint8_t *latest_key = (const uint8_t *)sstate.key.row;
+          size_t latest_key_len = sstate.key.flag_ptr -
+                  (const uint8_t *)sstate.key.row + 1;
 
-          m_prev_key.set(latest_key, latest_key_len);
-          m_prev_cf = sstate.key.column_family_code;
-          m_revs_count=0;
-          m_revs_limit = cp.max_versions;
-        }
-        m_revs_count++;
-        if (m_revs_limit && m_revs_count > m_revs_limit && !counter)
-          continue;
+          if (m_prev_key.fill()==0) {
+            m_prev_key.set(latest_key, latest_key_len);
+            m_prev_cf = sstate.key.column_family_code;
+            m_revs_count=0;
+            m_revs_limit = cp.max_versions;
+          }
+          else if (m_prev_key.fill() != latest_key_len ||
+              memcmp(latest_key, m_prev_key.base, latest_key_len)) {
 
-        // row set
-        if (!m_scan_context->rowset.empty()) {
-          int cmp = 1;
-          while (!m_scan_context->rowset.empty()
-              && (cmp = strcmp(*m_scan_context->rowset.begin(),
-                                sstate.key.row)) < 0)
-            m_scan_context->rowset.erase(m_scan_context->rowset.begin());
-          if (cmp > 0)
+            m_prev_key.set(latest_key, latest_key_len);
+            m_prev_cf = sstate.key.column_family_code;
+            m_revs_count=0;
+            m_revs_limit = cp.max_versions;
+          }
+          m_revs_count++;
+          if (m_revs_limit && m_revs_count > m_revs_limit && !counter) {
+            // Superseded versions only count as garbage when the revision
+            // limit came from the schema and not the scan specification
+            if (m_schema_versions)
+              io_add_garbage_cell(cur_bytes);
             continue;
+          }
         }
-        // cell predicate match
 
-        const uint8_t *value;
-        size_t value_len = sstate.value.decode_length(&value);
-        if (!cp.matches(sstate.key.column_qualifier,
-                        (size_t)sstate.key.column_qualifier_len,
-                        (const char *)value, value_len))
-          continue;
-        // row regexp
-        if (m_scan_context->row_regexp) {
-          bool cached, match;
-          m_regexp_cache.check_rowkey(sstate.key.row, &cached, &match);
-          if (!cached) {
-            match = RE2::PartialMatch(sstate.key.row, 
-                        *(m_scan_context->row_regexp));
-            m_regexp_cache.set_rowkey(sstate.key.row, match);
+        if (FilterMask & NEED_PREDICATE_FILTER) {
+          // row set
+          if (!m_scan_context->rowset.empty()) {
+            int cmp = 1;
+            while (!m_scan_context->rowset.empty()
+                && (cmp = strcmp(*m_scan_context->rowset.begin(),
+                                  sstate.key.row)) < 0)
+              m_scan_context->rowset.erase(m_scan_context->rowset.begin());
+            if (cmp > 0)
+              continue;
           }
-          if (!match)
-            continue;
-        }
-         // filter but value regexp last since its probly the most expensive
-        if (m_scan_context->value_regexp && !counter) {
-          const uint8_t *dptr;
-          if (!RE2::PartialMatch(re2::StringPiece(sstate.value.str(),
-                            sstate.value.decode_length(&dptr)), 
-                            *(m_scan_context->value_regexp)))
+          // cell predicate match
+
+          const uint8_t *value;
+          size_t value_len = sstate.value.decode_length(&value);
+          if (!m_scan_context->cell_predicates[sstate.key.column_family_code]
+                  .matches(sstate.key.column_qualifier,
+                           (size_t)sstate.key.column_qualifier_len,
+                           (const char *)value, value_len)) {
+            m_scan_context->cells_filtered_predicates++;
             continue;
+          }
+          // row regexp
+          if (m_scan_context->row_regexp) {
+            bool cached, match;
+            m_regexp_cache.check_rowkey(sstate.key.row, &cached, &match);
+            if (!cached) {
+              match = RE2::PartialMatch(sstate.key.row, 
+                          *(m_scan_context->row_regexp));
+              m_regexp_cache.set_rowkey(sstate.key.row, match);
+            }
+            if (!match) {
+              m_scan_context->cells_filtered_row_regexp++;
+              continue;
+            }
+          }
+           // filter but value regexp last since its probly the most expensive
+          if (m_scan_context->value_regexp && !counter) {
+            const uint8_t *dptr;
+            if (!RE2::PartialMatch(re2::StringPiece(sstate.value.str(),
+                              sstate.value.decode_length(&dptr)),
+                              *(m_scan_context->value_regexp))) {
+              m_scan_context->cells_filtered_value_regexp++;
+              continue;
+            }
+          }
         }
         break;
       }
@@ -325,26 +416,28 @@ void MergeScannerAccessGroup::forward() {
         break;
     }
 
-    // deal with counters. apply row_limit but not revs/cell_limit_per_family
-    if (m_count_present) {
-      if(counter && matches_counted_key(sstate.key)) {
-        if (sstate.key.flag == FLAG_INSERT) {
-          // keep incrementing
-          increment_count(sstate.key, sstate.value);
-          continue;
+    if (FilterMask & NEED_COUNTER_HANDLING) {
+      // deal with counters. apply row_limit but not revs/cell_limit_per_family
+      if (m_count_present) {
+        if(counter && matches_counted_key(sstate.key)) {
+          if (sstate.key.flag == FLAG_INSERT) {
+            // keep incrementing
+            increment_count(sstate.key, sstate.value);
+            continue;
+          }
+        }
+        else {
+          // count done, new count seen but not started
+          finish_count();
+          break;
         }
       }
-      else {
-        // count done, new count seen but not started
-        finish_count();
-        break;
+      else if (counter && sstate.key.flag == FLAG_INSERT) {
+        // start new count and loop
+        start_count(sstate.key, sstate.value);
+        continue;
       }
     }
-    else if (counter && sstate.key.flag == FLAG_INSERT) {
-      // start new count and loop
-      start_count(sstate.key, sstate.value);
-      continue;
-    }
 
     break;
   }
@@ -527,6 +620,7 @@ void MergeScannerAccessGroup::initialize() {
       if (!cp.matches(sstate.key.column_qualifier,
                       (size_t)sstate.key.column_qualifier_len,
                       (const char *)value, value_len)) {
+        m_scan_context->cells_filtered_predicates++;
         m_queue.pop();
         sstate.scanner->forward();
         if (sstate.scanner->get(sstate.key, sstate.value))
@@ -535,8 +629,9 @@ void MergeScannerAccessGroup::initialize() {
       }
       // row regexp
       if (m_scan_context->row_regexp)
-        if (!RE2::PartialMatch(sstate.key.row, 
+        if (!RE2::PartialMatch(sstate.key.row,
             *(m_scan_context->row_regexp))) {
+          m_scan_context->cells_filtered_row_regexp++;
           m_queue.pop();
           sstate.scanner->forward();
           if (sstate.scanner->get(sstate.key, sstate.value))
@@ -548,6 +643,7 @@ void MergeScannerAccessGroup::initialize() {
         value_len = sstate.value.decode_length(&value);
         if (!RE2::PartialMatch(re2::StringPiece((const char *)value, value_len),
                                *(m_scan_context->value_regexp))) {
+          m_scan_context->cells_filtered_value_regexp++;
           m_queue.pop();
           sstate.scanner->forward();
           if (sstate.scanner->get(sstate.key, sstate.value))
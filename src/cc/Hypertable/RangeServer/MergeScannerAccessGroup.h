@@ -46,6 +46,8 @@ namespace Hypertable {
   /// @addtogroup RangeServer
   /// @{
 
+  class AccessGroupGarbageTracker;
+
   /// Merge scanner for access groups.
   class MergeScannerAccessGroup {
 
@@ -115,8 +117,11 @@ namespace Hypertable {
     /// @param table_name Table name
     /// @param scan_ctx Scan context
     /// @param flags Flags
+    /// @param garbage_tracker Garbage tracker to feed with the garbage
+    /// observed by this scan (see io_add_garbage_cell()), or 0 for none
     MergeScannerAccessGroup(String &table_name, ScanContext *scan_ctx,
-                            uint32_t flags=0);
+                            uint32_t flags=0,
+                            AccessGroupGarbageTracker *garbage_tracker=0);
 
     /// Destructor.
     /// Destroys all scanners in #m_scanners and then calls #m_release_callback
@@ -126,7 +131,16 @@ namespace Hypertable {
       m_scanners.push_back(scanner);
     }
 
-    void forward();
+    /// Informs the scanner that every added source holds only cells whose
+    /// timestamps lie inside the scan's time interval, making the per-cell
+    /// window checks dead; the forward path is re-selected accordingly.
+    /// Must be called before the first call to forward() or get().
+    void set_sources_inside_time_window();
+
+    /// Forwards to the next cell.
+    /// Dispatches to the filter path instantiation selected at construction
+    /// time (see forward_impl()).
+    void forward() { (this->*m_forward)(); }
 
     bool get(Key &key, ByteString &value);
 
@@ -146,17 +160,61 @@ namespace Hypertable {
       m_cells_output++;
     }
 
+    /// Accounts for a cell skipped as garbage.
+    /// Called for cells discarded because they were expired by a schema TTL,
+    /// masked by a delete record, superseded beyond a schema MAX_VERSIONS
+    /// limit, or were themselves delete records.  Upon destruction, the
+    /// accumulated total is fed back into the garbage tracker, if one was
+    /// supplied to the constructor.
+    /// @param cur_bytes Length of garbage cell
+    void io_add_garbage_cell(int64_t cur_bytes) {
+      m_bytes_garbage += cur_bytes;
+    }
+
     int64_t get_input_cells() { return m_cells_input; }
     int64_t get_output_cells() { return m_cells_output; }
 
     int64_t get_input_bytes() { return m_bytes_input; }
     int64_t get_output_bytes() { return m_bytes_output; }
 
+    int64_t get_garbage_bytes() { return m_bytes_garbage; }
+
     void add_disk_read(int64_t amount) { m_disk_read += amount; }
     int64_t get_disk_read();
 
   private:
 
+    /// @name Filter path specialization
+    /// The per-cell filter chain in forward_impl() is guarded by the bits of
+    /// its FilterMask template argument, so instantiations for scans that
+    /// use only a subset of the filters have the dead branches deleted by
+    /// the compiler.  The constructor inspects the scan context once and
+    /// selects the least general instantiation whose mask covers every
+    /// filter the scan can exercise.
+    /// @{
+
+    enum {
+      /// Scan carries a time interval, a revision cap or a schema TTL
+      NEED_TIME_FILTER      = 0x01,
+      /// Scan carries column predicates, regexps or a row set
+      NEED_PREDICATE_FILTER = 0x02,
+      /// A MAX_VERSIONS limit requires revision tracking per cell key
+      NEED_VERSION_TRACKING = 0x04,
+      /// Scan accumulates counter columns
+      NEED_COUNTER_HANDLING = 0x08,
+      /// Fully general filter chain
+      NEED_ALL              = 0x0f
+    };
+
+    /// Forwards to the next cell applying the filters named in FilterMask.
+    template <int FilterMask> void forward_impl();
+
+    /// Selects the least general forward_impl() instantiation whose mask
+    /// covers every filter the scan can exercise.
+    void select_forward_path();
+
+    /// @}
+
     void initialize();
 
     inline bool matches_deleted_row(const Key& key) const {
@@ -324,6 +382,7 @@ namespace Hypertable {
 
     int64_t m_bytes_input {};
     int64_t m_bytes_output {};
+    int64_t m_bytes_garbage {};
     int64_t m_cells_input {};
     int64_t m_cells_output {};
     int64_t m_disk_read {};
@@ -365,6 +424,20 @@ namespace Hypertable {
 
     ScanContext*  m_scan_context;
 
+    /// Filter path selected at construction time (see forward_impl())
+    void (MergeScannerAccessGroup::*m_forward)() {};
+
+    /// <i>true</i> if every source lies inside the scan's time interval
+    /// (see set_sources_inside_time_window())
+    bool m_sources_inside_window {};
+
+    /// Garbage tracker fed with observed garbage upon destruction
+    AccessGroupGarbageTracker *m_garbage_tracker;
+
+    /// <i>true</i> if the revision limit came from the schema and not the
+    /// scan specification, in which case superseded versions are garbage
+    bool m_schema_versions {};
+
   };
 
   /// Shared pointer to MergeScannerAccessGroup
@@ -31,6 +31,8 @@
 
 #include <Hypertable/Lib/Key.h>
 
+#include <AsyncComm/Clock.h>
+
 #include <Common/Logger.h>
 
 #include <cassert>
@@ -48,6 +50,9 @@ MergeScannerRange::MergeScannerRange(const string &table_id, ScanContextPtr &sca
     m_row_offset = scan_ctx->spec->row_offset;
     m_cell_offset = scan_ctx->spec->cell_offset;
 
+    if (scan_ctx->spec->resume_cursor)
+      m_resume_cursor = SerializedKey(scan_ctx->spec->resume_cursor);
+
     if (scan_ctx->spec->rebuild_indices) {
       bool has_index = false;
       bool has_qualifier_index = false;
@@ -104,6 +109,17 @@ forward:
     bool new_cf = false;
     bool new_cq = false;
 
+    // A highly selective scan can examine cells for a long time without
+    // producing output; periodically make sure the client driving the
+    // fill is still waiting for the answer
+    if (--m_cells_until_deadline_check <= 0) {
+      m_cells_until_deadline_check = DEADLINE_CHECK_INTERVAL;
+      if (m_scan_context->deadline != ClockT::time_point() &&
+          ClockT::now() >= m_scan_context->deadline)
+        HT_THROW(Error::REQUEST_TIMEOUT,
+                 "Scan abandoned - request deadline passed");
+    }
+
     m_queue.pop();
 
     sstate.scanner->forward();
@@ -263,6 +279,21 @@ void MergeScannerRange::initialize() {
     }
   }
 
+  // Drop cells at or before the resume cursor; they were already delivered
+  // by the scan being resumed.  The offset and limit accounting below then
+  // starts at the first undelivered cell.
+  if (m_resume_cursor.ptr) {
+    while (!m_queue.empty()) {
+      sstate = m_queue.top();
+      if (m_resume_cursor < sstate.key.serial)
+        break;
+      m_queue.pop();
+      sstate.scanner->forward();
+      if (sstate.scanner->get(sstate.key, sstate.value))
+        m_queue.push(sstate);
+    }
+  }
+
   if (m_queue.empty())
     return;
 
@@ -30,6 +30,8 @@
 #include <Hypertable/RangeServer/MergeScannerAccessGroup.h>
 #include <Hypertable/RangeServer/IndexUpdater.h>
 
+#include <Hypertable/Lib/SerializedKey.h>
+
 #include <Common/ByteString.h>
 #include <Common/DynamicBuffer.h>
 
@@ -94,6 +96,9 @@ namespace Hypertable {
 
   private:
 
+    /// Number of cells examined between request-deadline checks
+    static const int32_t DEADLINE_CHECK_INTERVAL = 1024;
+
     void initialize();
 
     struct ScannerState {
@@ -136,12 +141,17 @@ namespace Hypertable {
     int32_t m_row_limit {};
     int32_t m_cell_count_per_family {};
     int32_t m_cell_limit_per_family {};
+    int32_t m_cells_until_deadline_check {DEADLINE_CHECK_INTERVAL};
     int32_t m_prev_cf {-1};
     int64_t m_prev_timestamp {TIMESTAMP_NULL};
     int64_t m_bytes_output {};
     int64_t m_cells_output {};
     DynamicBuffer m_prev_key;
 
+    /// Resume cursor from the scan spec; when set, cells sorting at or
+    /// before this key were already delivered and are dropped up front
+    SerializedKey m_resume_cursor;
+
   };
 
   /// Smart pointer to MergeScannerRange
@@ -38,79 +38,104 @@ using namespace std;
 #define OVERHEAD 64
 
 QueryCache::QueryCache(uint64_t max_memory)
-  : m_max_memory(max_memory), m_avail_memory(max_memory) {
+  : m_max_memory(max_memory), m_max_shard_memory(max_memory / SHARD_COUNT) {
+  bool statistics_enabled {true};
   if (Config::properties)
-    m_mutex.set_statistics_enabled(properties->get_bool("Hypertable.RangeServer.QueryCache.EnableMutexStatistics"));
+    statistics_enabled = properties->get_bool("Hypertable.RangeServer.QueryCache.EnableMutexStatistics");
+  for (size_t i=0; i<SHARD_COUNT; i++) {
+    m_shards[i].avail_memory = m_max_shard_memory;
+    m_shards[i].mutex.set_statistics_enabled(statistics_enabled);
+  }
 }
 
 bool
 QueryCache::insert(Key *key, const char *tablename, const char *row,
                    std::set<uint8_t> &columns, uint32_t cell_count,
                    boost::shared_array<uint8_t> &result,
-                   uint32_t result_length) {
-  lock_guard<MutexWithStatistics> lock(m_mutex);
-  LookupHashIndex &hash_index = m_cache.get<1>();
+                   uint32_t result_length, time_t expire_time) {
+  Shard &shard = shard_for(*key);
+  lock_guard<MutexWithStatistics> lock(shard.mutex);
+  LookupHashIndex &hash_index = shard.cache.get<1>();
   LookupHashIndex::iterator lookup_iter;
   uint64_t length = result_length + OVERHEAD + strlen(row);
 
-  if (length > m_max_memory)
+  if (length > m_max_shard_memory)
     return false;
 
   if ((lookup_iter = hash_index.find(*key)) != hash_index.end()) {
-    m_avail_memory += (*lookup_iter).result_length + OVERHEAD + strlen((*lookup_iter).row_key.row);
+    shard.avail_memory += (*lookup_iter).result_length + OVERHEAD + strlen((*lookup_iter).row_key.row);
     hash_index.erase(lookup_iter);
   }
 
   // make room
-  if (m_avail_memory < length) {
-    Cache::iterator iter = m_cache.begin();
-    while (iter != m_cache.end()) {
-      m_avail_memory += (*iter).result_length + OVERHEAD + strlen((*iter).row_key.row);
-      iter = m_cache.erase(iter);
-      if (m_avail_memory >= length)
+  if (shard.avail_memory < length) {
+    Cache::iterator iter = shard.cache.begin();
+    while (iter != shard.cache.end()) {
+      shard.avail_memory += (*iter).result_length + OVERHEAD + strlen((*iter).row_key.row);
+      {
+        lock_guard<mutex> stats_lock(m_table_stats_mutex);
+        m_table_stats[(*iter).row_key.tablename].evictions++;
+      }
+      iter = shard.cache.erase(iter);
+      if (shard.avail_memory >= length)
 	break;
     }
   }
 
-  if (m_avail_memory < length)
+  if (shard.avail_memory < length)
     return false;
 
   QueryCacheEntry entry(*key, tablename, row, columns, cell_count,
-                        result, result_length);
+                        result, result_length, expire_time);
 
-  auto insert_result = m_cache.push_back(entry);
+  auto insert_result = shard.cache.push_back(entry);
   assert(insert_result.second);
   (void)insert_result;
 
-  m_avail_memory -= length;
+  shard.avail_memory -= length;
 
   return true;
 }
 
 
-bool QueryCache::lookup(Key *key, boost::shared_array<uint8_t> &result,
+bool QueryCache::lookup(Key *key, const char *tablename,
+                        boost::shared_array<uint8_t> &result,
 			uint32_t *lenp, uint32_t *cell_count) {
-  lock_guard<MutexWithStatistics> lock(m_mutex);
-  LookupHashIndex &hash_index = m_cache.get<1>();
-  LookupHashIndex::iterator iter;
+  uint64_t lookup_count = m_total_lookup_count.fetch_add(1) + 1;
 
-  if (m_total_lookup_count > 0 && (m_total_lookup_count % 1000) == 0) {
+  if ((lookup_count % 1000) == 0) {
+    uint32_t recent_hit_count = m_recent_hit_count.exchange(0);
     HT_INFOF("QueryCache hit rate over last 1000 lookups, cumulative = %f, %f",
-             ((double)m_recent_hit_count / (double)1000)*100.0,
-             ((double)m_total_hit_count / (double)m_total_lookup_count)*100.0);
-    m_recent_hit_count = 0;
+             ((double)recent_hit_count / (double)1000)*100.0,
+             ((double)m_total_hit_count / (double)lookup_count)*100.0);
   }
 
-  m_total_lookup_count++;
+  Shard &shard = shard_for(*key);
+  lock_guard<MutexWithStatistics> lock(shard.mutex);
+  LookupHashIndex &hash_index = shard.cache.get<1>();
+  LookupHashIndex::iterator iter;
+
+  if ((iter = hash_index.find(*key)) == hash_index.end()) {
+    lock_guard<mutex> stats_lock(m_table_stats_mutex);
+    m_table_stats[tablename].misses++;
+    return false;
+  }
 
-  if ((iter = hash_index.find(*key)) == hash_index.end())
+  // TTL expiry:  a stale entry is removed and reported as a miss
+  if ((*iter).expire_time != 0 && (*iter).expire_time <= time(0)) {
+    shard.avail_memory += (*iter).result_length + OVERHEAD + strlen((*iter).row_key.row);
+    hash_index.erase(iter);
+    lock_guard<mutex> stats_lock(m_table_stats_mutex);
+    m_table_stats[tablename].evictions++;
+    m_table_stats[tablename].misses++;
     return false;
+  }
 
   QueryCacheEntry entry = *iter;
 
   hash_index.erase(iter);
 
-  pair<Sequence::iterator, bool> insert_result = m_cache.push_back(entry);
+  pair<Sequence::iterator, bool> insert_result = shard.cache.push_back(entry);
   assert(insert_result.second);
 
   result = (*insert_result.first).result;
@@ -119,74 +144,131 @@ bool QueryCache::lookup(Key *key, boost::shared_array<uint8_t> &result,
 
   m_total_hit_count++;
   m_recent_hit_count++;
+  {
+    lock_guard<mutex> stats_lock(m_table_stats_mutex);
+    m_table_stats[tablename].hits++;
+  }
   return true;
 }
 
+void QueryCache::set_max_memory(uint64_t max_memory) {
+  uint64_t old_shard_budget = m_max_shard_memory;
+  uint64_t new_shard_budget = max_memory / SHARD_COUNT;
+
+  m_max_memory = max_memory;
+  m_max_shard_memory = new_shard_budget;
+
+  for (size_t i=0; i<SHARD_COUNT; i++) {
+    Shard &shard = m_shards[i];
+    lock_guard<MutexWithStatistics> lock(shard.mutex);
+    uint64_t used = old_shard_budget - shard.avail_memory;
+    if (used > new_shard_budget) {
+      Cache::iterator iter = shard.cache.begin();
+      while (iter != shard.cache.end() && used > new_shard_budget) {
+        uint64_t length = (*iter).result_length + OVERHEAD + strlen((*iter).row_key.row);
+        used -= (length > used) ? used : length;
+        {
+          lock_guard<mutex> stats_lock(m_table_stats_mutex);
+          m_table_stats[(*iter).row_key.tablename].evictions++;
+        }
+        iter = shard.cache.erase(iter);
+      }
+    }
+    shard.avail_memory = new_shard_budget - used;
+  }
+}
+
+QueryCache::TableStatsMap QueryCache::get_table_stats() {
+  lock_guard<mutex> lock(m_table_stats_mutex);
+  return m_table_stats;
+}
+
 void QueryCache::get_stats(uint64_t *max_memoryp, uint64_t *available_memoryp,
                            uint64_t *total_lookupsp, uint64_t *total_hitsp,
                            int32_t *total_waiters)
 {
-  lock_guard<MutexWithStatistics> lock(m_mutex);
   *total_lookupsp = m_total_lookup_count;
   *total_hitsp = m_total_hit_count;
   *max_memoryp = m_max_memory;
-  *available_memoryp = m_avail_memory;
-  *total_waiters = m_mutex.get_waiting_threads();  
+  *available_memoryp = available_memory();
+  *total_waiters = 0;
+  for (size_t i=0; i<SHARD_COUNT; i++)
+    *total_waiters += m_shards[i].mutex.get_waiting_threads();
 }
 
 void QueryCache::dump_keys(ofstream &out) {
-  lock_guard<MutexWithStatistics> lock(m_mutex);
-  Sequence &sequence_index = m_cache.get<0>();
   out << "\nQuery Cache:\n";
-  for (auto &entry : sequence_index) {
-    out << entry.row_key.tablename << "['" << entry.row_key.row << "'] cols={";
-    bool first {true};
-    for (uint8_t cf : entry.columns) {
-      if (!first)
-        out << ",";
-      else
-        first = false;
-      out << (int)cf;
-    }
-    out << "} Length=" << entry.result_length << " CellCount=" << entry.cell_count;
-    if (entry.cell_count > 0) {
-      SerializedKey serkey;
-      serkey.ptr = (uint8_t *)(entry.result.get() + 4);
-      Hypertable::Key key(serkey);
-      out << " FirstKey=(" << key << ")";
+  for (size_t i=0; i<SHARD_COUNT; i++) {
+    lock_guard<MutexWithStatistics> lock(m_shards[i].mutex);
+    Sequence &sequence_index = m_shards[i].cache.get<0>();
+    for (auto &entry : sequence_index) {
+      out << entry.row_key.tablename << "['" << entry.row_key.row << "'] cols={";
+      bool first {true};
+      for (uint8_t cf : entry.columns) {
+        if (!first)
+          out << ",";
+        else
+          first = false;
+        out << (int)cf;
+      }
+      out << "} Length=" << entry.result_length << " CellCount=" << entry.cell_count;
+      if (entry.cell_count > 0) {
+        SerializedKey serkey;
+        serkey.ptr = (uint8_t *)(entry.result.get() + 4);
+        Hypertable::Key key(serkey);
+        out << " FirstKey=(" << key << ")";
+      }
+      out << "\n";
     }
-    out << "\n";
   }
 }
 
 void QueryCache::invalidate(const char *tablename, const char *row, std::set<uint8_t> &columns) {
-  lock_guard<MutexWithStatistics> lock(m_mutex);
-  InvalidateHashIndex &hash_index = m_cache.get<2>();
-  InvalidateHashIndex::iterator iter;
-  RowKey row_key(tablename, row);
-  pair<InvalidateHashIndex::iterator, InvalidateHashIndex::iterator> p = hash_index.equal_range(row_key);
+  vector<RowInvalidation> rows;
+  std::set<uint8_t> columns_copy(columns);
+  rows.push_back(RowInvalidation(row, columns_copy));
+  invalidate(tablename, rows);
+}
+
+void QueryCache::invalidate(const char *tablename, std::vector<RowInvalidation> &rows) {
+  vector<RowKey> row_keys;
   uint64_t length;
   vector<uint8_t> intersection;
   bool do_invalidation {};
 
-  intersection.reserve(columns.size());
+  row_keys.reserve(rows.size());
+  for (auto &invalidation : rows)
+    row_keys.push_back(RowKey(tablename, invalidation.row));
 
-  while (p.first != p.second) {
-    do_invalidation = p.first->columns.empty() || columns.empty();
-    if (!do_invalidation) {
-      intersection.clear();
-      set_intersection(columns.begin(), columns.end(), p.first->columns.begin(),
-                       p.first->columns.end(), back_inserter(intersection));
-      do_invalidation = !intersection.empty();
-    }
-    if (do_invalidation) {
-      length = (*p.first).result_length + OVERHEAD + strlen((*p.first).row_key.row);
-      /** HT_ASSERT(strcmp((*p.first).row_key.tablename, tablename) == 0 &&
-          strcmp((*p.first).row_key.row.c_str(), row) == 0); **/
-      m_avail_memory += length;
-      p.first = hash_index.erase(p.first);
+  // Entries are sharded by query hash key, so each shard must be checked for
+  // every row; one pass over the shards handles the whole batch
+  for (size_t s=0; s<SHARD_COUNT; s++) {
+    Shard &shard = m_shards[s];
+    lock_guard<MutexWithStatistics> lock(shard.mutex);
+    InvalidateHashIndex &hash_index = shard.cache.get<2>();
+
+    for (size_t r=0; r<rows.size(); r++) {
+      pair<InvalidateHashIndex::iterator, InvalidateHashIndex::iterator> p = hash_index.equal_range(row_keys[r]);
+      std::set<uint8_t> &columns = rows[r].columns;
+
+      intersection.reserve(columns.size());
+
+      while (p.first != p.second) {
+        do_invalidation = p.first->columns.empty() || columns.empty();
+        if (!do_invalidation) {
+          intersection.clear();
+          set_intersection(columns.begin(), columns.end(), p.first->columns.begin(),
+                           p.first->columns.end(), back_inserter(intersection));
+          do_invalidation = !intersection.empty();
+        }
+        if (do_invalidation) {
+          length = (*p.first).result_length + OVERHEAD + strlen((*p.first).row_key.row);
+          shard.avail_memory += length;
+          p.first = hash_index.erase(p.first);
+        }
+        else
+          p.first++;
+      }
     }
-    else
-      p.first++;
   }
 }
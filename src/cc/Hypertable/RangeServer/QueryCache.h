@@ -24,6 +24,7 @@
 
 #include <Common/Checksum.h>
 #include <Common/Mutex.h>
+#include <Common/String.h>
 
 #include <boost/multi_index_container.hpp>
 #include <boost/multi_index/hashed_index.hpp>
@@ -33,9 +34,14 @@
 #include <boost/shared_array.hpp>
 
 #include <algorithm>
+#include <atomic>
 #include <cstring>
+#include <ctime>
 #include <fstream>
+#include <map>
+#include <mutex>
 #include <set>
+#include <vector>
 
 namespace Hypertable {
   using namespace boost::multi_index;
@@ -44,6 +50,11 @@ namespace Hypertable {
   /// @{
 
   /// Query cache.
+  /// The cache is partitioned into independently locked shards, selected by
+  /// the query hash key, so that concurrent lookups and inserts for different
+  /// queries do not serialize on a single mutex.  Each shard maintains its own
+  /// LRU ordering and memory budget (an equal fraction of the configured
+  /// maximum).
   class QueryCache {
 
   public:
@@ -91,22 +102,57 @@ namespace Hypertable {
       uint32_t hash;
     };
 
+    /// Row invalidation specification.
+    /// Represents one modified row of a batched invalidation (see
+    /// invalidate(const char *, std::vector<RowInvalidation> &)).
+    class RowInvalidation {
+    public:
+      /// Constructor.
+      /// Initializes #row to <code>r</code> and swaps <code>cols</code> into
+      /// #columns.  This member function assumes that <code>r</code> points to
+      /// memory that will be valid until the invalidation is carried out.
+      /// @param r Row to invalidate
+      /// @param cols Columns to invalidate (emptied by the swap)
+      RowInvalidation(const char *r, std::set<uint8_t> &cols) : row(r) {
+        columns.swap(cols);
+      }
+      /// Row to invalidate
+      const char *row;
+      /// Columns to invalidate (empty implies whole row)
+      std::set<uint8_t> columns;
+    };
+
+    /// Per-table cache statistics.
+    class TableStats {
+    public:
+      /// Lookup hits
+      uint64_t hits {};
+      /// Lookup misses (including entries found expired)
+      uint64_t misses {};
+      /// Entries evicted (LRU eviction or TTL expiry)
+      uint64_t evictions {};
+    };
+
+    /// Per-table statistics map, keyed by table ID
+    typedef std::map<String, TableStats> TableStatsMap;
+
     /// Constructor.
-    /// Initializes #m_max_memory and #m_avail_memory to
-    /// <code>max_memory</code>.
+    /// Initializes #m_max_memory to <code>max_memory</code> and divides the
+    /// memory budget evenly among the shards.
     /// @param max_memory Maximum amount of memory to be used by the cache
     QueryCache(uint64_t max_memory);
 
     /// Inserts a query result.
-    /// If the size of the entry is greater than #m_max_memory, then the
-    /// function returns without modifying the cache.  Then the old entry is
-    /// removed, if there was one.  Then room is created in the cache for the
-    /// new entry by removing the oldest entries until enough space is
+    /// The entry is inserted into the shard selected by <code>key</code>.  If
+    /// the size of the entry is greater than the shard's memory budget, then
+    /// the function returns without modifying the cache.  Then the old entry
+    /// is removed, if there was one.  Then room is created in the shard for
+    /// the new entry by removing the oldest entries until enough space is
     /// available.  Finally, a new cache entry is created and inserted into the
-    /// cache.  This function also maintains the #m_avail_memory value which
-    /// represents how much room is available in the cache.  It is computed as
-    /// #m_max_memory minus an approximation of how much space is taken up by
-    /// the existing cache entries.
+    /// shard.  This function also maintains the shard's available memory value
+    /// which represents how much room is available in the shard.  It is
+    /// computed as the shard's budget minus an approximation of how much space
+    /// is taken up by the existing cache entries.
     /// @param key Hash key for entry to be inserted
     /// @param tablename %Table name for entry to be inserted (must remain valid
     /// for lifetime of cache entry)
@@ -117,49 +163,71 @@ namespace Hypertable {
     /// @param cell_count Count of cells in entry to be inserted
     /// @param result Query result
     /// @param result_length Length of query result
+    /// @param expire_time Absolute time after which the entry is stale, or 0
+    /// for no expiry
     /// @return <i>true</i> if result was inserted, <i>false</i> otherwise.
     bool insert(Key *key, const char *tablename, const char *row,
                 std::set<uint8_t> &columns, uint32_t cell_count,
-                boost::shared_array<uint8_t> &result, uint32_t result_length);
+                boost::shared_array<uint8_t> &result, uint32_t result_length,
+                time_t expire_time = 0);
 
     /// Lookup.
-    /// Looks up the entry with key <code>key</code>, and if found, returns the
-    /// query result and associated information in <code>result</code>,
-    /// <code>lenp</code>, and <code>cell_count</code>.  Also, if a cache entry
-    /// is found, it is removed and re-inserted for LRU ordering.
+    /// Looks up the entry with key <code>key</code> in the shard it hashes to,
+    /// and if found, returns the query result and associated information in
+    /// <code>result</code>, <code>lenp</code>, and <code>cell_count</code>.
+    /// Also, if a cache entry is found, it is removed and re-inserted for LRU
+    /// ordering.  Only the one shard is locked, so lookups of different
+    /// queries proceed in parallel.  An entry whose expire time has passed is
+    /// removed and the lookup reported as a miss.  The outcome is recorded in
+    /// the per-table statistics under <code>tablename</code>.
     /// @param key Hash key
+    /// @param tablename %Table being queried (for statistics)
     /// @param result Reference to shared array to hold result
     /// @param lenp Pointer to variable to hold result length
     /// @param cell_count Pointer to variable to hold count of cells in result
     /// @return <i>true</i> if an entry was found, <i>false</i> otherwise
-    bool lookup(Key *key, boost::shared_array<uint8_t> &result, uint32_t *lenp,
+    bool lookup(Key *key, const char *tablename,
+                boost::shared_array<uint8_t> &result, uint32_t *lenp,
                 uint32_t *cell_count);
 
-    /// Invalidates cache entries.
-    /// Creates a RowKey object from <code>tablename</code> and <code>row</code>
-    /// and finds all matching entires in the cache.  For each matching cache
-    /// entry whose columns intersect with <code>columns</code>, the entry is
-    /// invalidated.  The entry is also invalidated if either
-    /// <code>columns</code> is empty or the cache entries columns are empty.
+    /// Invalidates cache entries for a single row.
+    /// Equivalent to a batched invalidation of one row; update paths that
+    /// modify many rows should accumulate them and make a single call to
+    /// invalidate(const char *, std::vector<RowInvalidation> &) instead.
     /// @param tablename %Table of entries to invalidate
     /// @param row Row entries to invalidate
     /// @param columns Columns of entries to invalidate
     void invalidate(const char * tablename, const char *row, std::set<uint8_t> &columns);
 
+    /// Invalidates cache entries for a batch of rows.
+    /// For each row in <code>rows</code>, finds all matching entries in the
+    /// cache.  For each matching cache entry whose columns intersect with the
+    /// row's columns, the entry is invalidated.  The entry is also invalidated
+    /// if either column set is empty.  Since entries are sharded by query hash
+    /// key, every shard must be examined; batching amortizes the one pass over
+    /// the shards (and their locks) across all rows modified by an update
+    /// request, instead of paying it once per row.
+    /// @param tablename %Table of entries to invalidate
+    /// @param rows Rows (with columns) to invalidate
+    void invalidate(const char *tablename, std::vector<RowInvalidation> &rows);
+
     /// Gets available memory.
-    /// Returns #m_avail_memory
+    /// Computed as #m_max_memory minus memory_used().
     /// @return Available memory
     uint64_t available_memory() {
-      std::lock_guard<MutexWithStatistics> lock(m_mutex);
-      return m_avail_memory;
+      return m_max_memory - memory_used();
     }
 
     /// Gets memory used.
-    /// Memory used is calculated as #m_max_memory minus #m_avail_memory.
+    /// Computed by summing the memory used by each shard.
     /// @return Memory used
     uint64_t memory_used() {
-      std::lock_guard<MutexWithStatistics> lock(m_mutex);
-      return m_max_memory-m_avail_memory;
+      uint64_t used {};
+      for (size_t i=0; i<SHARD_COUNT; i++) {
+        std::lock_guard<MutexWithStatistics> lock(m_shards[i].mutex);
+        used += m_max_shard_memory - m_shards[i].avail_memory;
+      }
+      return used;
     }
 
     /// Gets cache statistics.
@@ -168,11 +236,22 @@ namespace Hypertable {
     /// @param total_lookupsp Address of variable to hold <i>total lookups</i>.
     /// @param total_hitsp Address of variable to hold <i>total hits</i>.
     /// @param total_waiters Address of variable to hold number of threads
-    /// waiting on the mutex
+    /// waiting on the shard mutexes
     void get_stats(uint64_t *max_memoryp, uint64_t *available_memoryp,
                    uint64_t *total_lookupsp, uint64_t *total_hitsp,
                    int32_t *total_waiters);
 
+    /// Gets a copy of the per-table statistics.
+    /// @return Per-table statistics map
+    TableStatsMap get_table_stats();
+
+    /// Adjusts the maximum cache memory.
+    /// The new budget is divided evenly among the shards and each shard
+    /// sheds LRU entries as needed to fit its reduced budget.  Called by the
+    /// cache memory governor to move memory between caches at runtime.
+    /// @param max_memory New maximum amount of memory to be used by the cache
+    void set_max_memory(uint64_t max_memory);
+
     /// Dumps keys to output file.
     /// @param out Output file to dump keys to
     void dump_keys(std::ofstream &out);
@@ -184,8 +263,10 @@ namespace Hypertable {
     public:
       QueryCacheEntry(Key &k, const char *tname, const char *rw,
                       std::set<uint8_t> &column_ids, uint32_t cells,
-		      boost::shared_array<uint8_t> &res, uint32_t rlen) :
-	key(k), row_key(tname, rw), result(res), result_length(rlen), cell_count(cells) {
+		      boost::shared_array<uint8_t> &res, uint32_t rlen,
+                      time_t expire) :
+	key(k), row_key(tname, rw), result(res), result_length(rlen),
+        cell_count(cells), expire_time(expire) {
         columns.swap(column_ids);
       }
       Key lookup_key() const { return key; }
@@ -197,6 +278,7 @@ namespace Hypertable {
       boost::shared_array<uint8_t> result;
       uint32_t result_length;
       uint32_t cell_count;
+      time_t expire_time;
     };
 
     struct KeyHash {
@@ -226,26 +308,53 @@ namespace Hypertable {
     typedef Cache::nth_index<1>::type LookupHashIndex;
     typedef Cache::nth_index<2>::type InvalidateHashIndex;
 
-    /// %Mutex to serialize member access
-    MutexWithStatistics m_mutex;
+    /// Number of independently locked cache shards
+    static const size_t SHARD_COUNT = 16;
+
+    /// Cache shard with its own lock, LRU ordering and memory budget.
+    class Shard {
+    public:
+      /// %Mutex to serialize shard access
+      MutexWithStatistics mutex;
+      /// Shard cache data structure
+      Cache cache;
+      /// Available memory in shard
+      uint64_t avail_memory {};
+    };
+
+    /// Returns the shard responsible for <code>key</code>.
+    /// The multi-index lookup hash consumes the low digest word, so the shard
+    /// is selected with the high one.
+    /// @param key Hash key
+    /// @return Reference to shard
+    Shard &shard_for(const Key &key) {
+      return m_shards[key.digest[1] % SHARD_COUNT];
+    }
 
-    /// Internal cache data structure
-    Cache m_cache;
+    /// Cache shards
+    Shard m_shards[SHARD_COUNT];
 
     /// Maximum memory to be used by cache
     uint64_t m_max_memory {};
 
-    /// Available memory
-    uint64_t m_avail_memory {};
-    
+    /// Per-shard memory budget (#m_max_memory divided by #SHARD_COUNT)
+    uint64_t m_max_shard_memory {};
+
     /// Total lookup count
-    uint64_t m_total_lookup_count {};
+    std::atomic<uint64_t> m_total_lookup_count {0};
 
     /// Total hit count
-    uint64_t m_total_hit_count {};
+    std::atomic<uint64_t> m_total_hit_count {0};
 
     /// Recent hit count (for logging)
-    uint32_t m_recent_hit_count {};
+    std::atomic<uint32_t> m_recent_hit_count {0};
+
+    /// %Mutex protecting #m_table_stats (leaf; may be acquired while holding
+    /// a shard mutex)
+    std::mutex m_table_stats_mutex;
+
+    /// Per-table statistics
+    TableStatsMap m_table_stats;
   };
 
   /// Smart pointer to QueryCache
@@ -116,8 +116,8 @@ void Range::initialize() {
     m_split_threshold = soft_limit;
   }
   else {
-    if (soft_limit == 0 || soft_limit > (uint64_t)Global::range_split_size) {
-      soft_limit = Global::range_split_size;
+    if (soft_limit == 0 || soft_limit > (uint64_t)split_size()) {
+      soft_limit = split_size();
       m_metalog_entity->set_soft_limit(soft_limit);
     }
     {
@@ -125,6 +125,7 @@ void Range::initialize() {
       m_split_threshold = soft_limit + (Random::number64() % soft_limit);
     }
   }
+  m_split_threshold_base = m_split_threshold;
 
   /**
    * Determine split side
@@ -223,6 +224,49 @@ void Range::deferred_initialization(chrono::fast_clock::time_point expire_time)
 }
 
 
+void Range::prewarm_block_cache() {
+  AccessGroupVector ag_vector(0);
+
+  if (Global::block_cache == 0)
+    return;
+
+  try {
+    deferred_initialization();
+  }
+  catch (Exception &e) {
+    HT_WARNF("Skipping block cache prewarm of %s - %s", m_name.c_str(),
+             Error::get_text(e.code()));
+    return;
+  }
+
+  {
+    lock_guard<mutex> lock(m_schema_mutex);
+    ag_vector = m_access_group_vector;
+  }
+
+  for (auto &ag : ag_vector)
+    ag->prewarm_block_cache();
+}
+
+
+bool Range::write_cell_cache_checkpoints(std::vector<String> &written) {
+  AccessGroupVector ag_vector(0);
+  bool complete = true;
+
+  {
+    lock_guard<mutex> lock(m_schema_mutex);
+    ag_vector = m_access_group_vector;
+  }
+
+  for (auto &ag : ag_vector) {
+    if (!ag->write_cell_cache_checkpoint(written))
+      complete = false;
+  }
+
+  return complete;
+}
+
+
 void Range::split_install_log_rollback_metadata() {
   String metadata_key_str, start_row, end_row;
   KeySpec key;
@@ -257,6 +301,9 @@ namespace {
     delete *metadata;
     *metadata = 0;
   }
+
+  /// Capacity of the per-range negative result cache
+  const size_t NEGATIVE_CACHE_MAX_ENTRIES = 65536;
 }
 
 
@@ -384,6 +431,23 @@ void Range::load_cell_stores() {
 }
 
 
+void Range::adopt_cellstore(const String &ag_name, const String &source_file) {
+  AccessGroupPtr ag;
+
+  {
+    lock_guard<mutex> lock(m_schema_mutex);
+    AccessGroupMap::iterator ag_iter = m_access_group_map.find(ag_name);
+    if (ag_iter == m_access_group_map.end())
+      HT_THROWF(Error::RANGESERVER_INVALID_COLUMNFAMILY,
+                "Unrecognized access group name '%s' for table '%s'",
+                ag_name.c_str(), m_table.id);
+    ag = ag_iter->second;
+  }
+
+  ag->adopt_cellstore(source_file);
+}
+
+
 void Range::update_schema(SchemaPtr &schema) {
   lock_guard<mutex> lock(m_schema_mutex);
 
@@ -434,15 +498,74 @@ void Range::update_schema(SchemaPtr &schema) {
   }
 
   // TODO: remove deleted access groups
+  int64_t old_split_size = split_size();
   m_schema = schema;
+
+  // Re-derive the split threshold if ALTER TABLE changed the table's
+  // split size policy
+  if (!m_is_metadata && split_size() != old_split_size) {
+    uint64_t soft_limit = m_metalog_entity->get_soft_limit();
+    if (soft_limit == 0 || soft_limit > (uint64_t)split_size()) {
+      soft_limit = split_size();
+      m_metalog_entity->set_soft_limit(soft_limit);
+    }
+    {
+      lock_guard<mutex> lock(Global::mutex);
+      m_split_threshold = soft_limit + (Random::number64() % soft_limit);
+    }
+    m_split_threshold_base = m_split_threshold;
+  }
   return;
 }
 
+/** Returns the split size governing this range.
+ * @return The table schema's split size override if one is set, otherwise
+ * the <code>Hypertable.RangeServer.Range.SplitSize</code> server default
+ */
+int64_t Range::split_size() {
+  int64_t table_split_size = m_schema->get_split_size();
+  return table_split_size > 0 ? table_split_size : Global::range_split_size;
+}
+
+/** Scales the split threshold by observed growth velocity (adaptive split
+ * mode).  Successive maintenance samples of <code>disk_used</code> feed a
+ * smoothed growth rate.  A range on pace to fill half a split or more per
+ * hour splits at half the configured threshold, spreading a hot ingest
+ * across servers sooner, while a range growing less than one percent of a
+ * split per hour defers until double; everything in between splits at the
+ * configured threshold.
+ */
+void Range::adjust_split_threshold(int64_t disk_used, time_t now) {
+
+  // Splits and major compactions step disk usage backwards; restart the
+  // measurement rather than folding a negative sample into the rate
+  if (m_growth_last_time && now > m_growth_last_time &&
+      disk_used >= m_growth_last_disk) {
+    double sample = (double)(disk_used - m_growth_last_disk)
+      / (double)(now - m_growth_last_time);
+    m_growth_rate = (m_growth_rate == 0.0) ? sample
+      : (0.75 * m_growth_rate) + (0.25 * sample);
+  }
+  m_growth_last_disk = disk_used;
+  m_growth_last_time = now;
+
+  double splits_per_hour =
+    (m_growth_rate * 3600.0) / (double)m_split_threshold_base;
+
+  if (splits_per_hour >= 0.5)
+    m_split_threshold = m_split_threshold_base / 2;
+  else if (splits_per_hour <= 0.01)
+    m_split_threshold = m_split_threshold_base * 2;
+  else
+    m_split_threshold = m_split_threshold_base;
+}
+
 
 /**
  * This method must not fail.  The caller assumes that it will succeed.
  */
-void Range::add(const Key &key, const ByteString value) {
+void Range::add(const Key &key, const ByteString value,
+                const StaticBufferPtr &buffer) {
   HT_DEBUG_OUT <<"key="<< key <<" value='";
   const uint8_t *p;
   size_t len = value.decode_length(&p);
@@ -455,7 +578,7 @@ void Range::add(const Key &key, const ByteString value) {
 
   if (key.flag == FLAG_DELETE_ROW) {
     for (size_t i=0; i<m_access_group_vector.size(); ++i)
-      m_access_group_vector[i]->add(key, value);
+      m_access_group_vector[i]->add(key, value, buffer);
   }
   else {
     if (key.column_family_code >= m_column_family_vector.size() ||
@@ -464,7 +587,7 @@ void Range::add(const Key &key, const ByteString value) {
                 (int)key.column_family_code, m_table.id);
       return;
     }
-    m_column_family_vector[key.column_family_code]->add(key, value);
+    m_column_family_vector[key.column_family_code]->add(key, value, buffer);
   }
 
   if (key.flag == FLAG_INSERT)
@@ -502,6 +625,25 @@ void Range::create_scanner(ScanContextPtr &scan_ctx, MergeScannerRangePtr &scann
   // increment #scanners
 }
 
+bool Range::negative_cache_lookup(const char *row) {
+  lock_guard<mutex> lock(m_negative_cache_mutex);
+  return m_negative_row_cache.find(row) != m_negative_row_cache.end();
+}
+
+void Range::negative_cache_insert(const char *row) {
+  lock_guard<mutex> lock(m_negative_cache_mutex);
+  // A full cache is simply cleared; it repopulates from subsequent misses
+  if (m_negative_row_cache.size() >= NEGATIVE_CACHE_MAX_ENTRIES)
+    m_negative_row_cache.clear();
+  m_negative_row_cache.insert(row);
+}
+
+void Range::negative_cache_invalidate(const char *row) {
+  lock_guard<mutex> lock(m_negative_cache_mutex);
+  if (!m_negative_row_cache.empty())
+    m_negative_row_cache.erase(row);
+}
+
 CellListScanner *Range::create_scanner_pseudo_table(ScanContextPtr &scan_ctx,
                                                     const String &table_name) {
   CellListScannerBuffer *scanner = 0;
@@ -540,10 +682,11 @@ bool Range::need_maintenance() {
   int64_t mem, disk, disk_total = 0;
   if (!m_metalog_entity->get_load_acknowledged() || m_unsplittable)
     return false;
+  int64_t budget = cellcache_budget();
   for (size_t i=0; i<m_access_group_vector.size(); ++i) {
     m_access_group_vector[i]->space_usage(&mem, &disk);
     disk_total += disk;
-    if (mem >= Global::access_group_max_mem)
+    if (mem >= budget)
       needed = true;
   }
   if (disk_total >= m_split_threshold)
@@ -557,6 +700,12 @@ bool Range::cancel_maintenance() {
 }
 
 
+int64_t Range::cellcache_budget() {
+  int64_t budget = m_cellcache_budget;
+  return budget ? budget : Global::access_group_max_mem;
+}
+
+
 Range::MaintenanceData *
 Range::get_maintenance_data(ByteArena &arena, time_t now,
                             int flags, TableMutator *mutator) {
@@ -568,6 +717,8 @@ Range::get_maintenance_data(ByteArena &arena, time_t now,
 
   memset(mdata, 0, sizeof(MaintenanceData));
 
+  bool split_adaptive;
+
   {
     lock_guard<mutex> lock(m_schema_mutex);
     ag_vector = m_access_group_vector;
@@ -576,6 +727,7 @@ Range::get_maintenance_data(ByteArena &arena, time_t now,
     mdata->load_factors.bytes_written = m_bytes_written;
     mdata->load_factors.cells_written = m_cells_written;
     mdata->schema_generation = m_table.generation;
+    split_adaptive = m_schema->get_split_size_adaptive();
   }
 
   mdata->relinquish = m_relinquish;
@@ -594,12 +746,18 @@ Range::get_maintenance_data(ByteArena &arena, time_t now,
     mdata->is_system = m_table.is_system();
     mdata->state = m_metalog_entity->get_state();
     mdata->soft_limit = m_metalog_entity->get_soft_limit();
+    mdata->cellcache_budget = cellcache_budget();
     mdata->busy = m_maintenance_guard.in_progress() || !m_metalog_entity->get_load_acknowledged();
     mdata->needs_major_compaction = m_metalog_entity->get_needs_compaction();
     mdata->initialized = m_initialized;
     mdata->compaction_type_needed = m_compaction_type_needed;
   }
 
+  // Recent read activity recorded in the hints file; used to order
+  // background initialization of uninitialized ranges after a restart
+  for (auto &ag : ag_vector)
+    mdata->prewarm_bytes += ag->prewarm_bytes();
+
   for (size_t i=0; i<ag_vector.size(); i++) {
     if (mdata->agdata == 0) {
       mdata->agdata = ag_vector[i]->get_maintenance_data(arena, now, flags);
@@ -621,6 +779,9 @@ Range::get_maintenance_data(ByteArena &arena, time_t now,
     mdata->bloom_filter_maybes += (*tailp)->bloom_filter_maybes;
     mdata->bloom_filter_fps += (*tailp)->bloom_filter_fps;
     mdata->shadow_cache_memory += (*tailp)->shadow_cache_memory;
+    mdata->block_cache_memory += (*tailp)->block_cache_memory;
+    mdata->block_cache_accesses += (*tailp)->block_cache_accesses;
+    mdata->block_cache_hits += (*tailp)->block_cache_hits;
     mdata->cell_count += (*tailp)->cell_count;
     mdata->file_count += (*tailp)->file_count;
     mdata->key_bytes += (*tailp)->key_bytes;
@@ -635,6 +796,9 @@ Range::get_maintenance_data(ByteArena &arena, time_t now,
   if (tailp)
     (*tailp)->next = 0;
 
+  if (split_adaptive && !m_is_metadata)
+    adjust_split_threshold(mdata->disk_used, now);
+
   if (!m_unsplittable && size >= m_split_threshold)
     mdata->needs_split = true;
 
@@ -650,8 +814,14 @@ Range::get_maintenance_data(ByteArena &arena, time_t now,
 
   if (mutator)
     m_load_metrics.compute_and_store(mutator, now, mdata->load_factors,
+                                     m_scan_latency, m_update_latency,
                                      mdata->disk_used, mdata->memory_used,
-                                     mdata->compression_ratio);
+                                     mdata->compression_ratio,
+                                     mdata->cell_count, mdata->key_bytes,
+                                     mdata->value_bytes,
+                                     mdata->block_cache_memory,
+                                     mdata->block_cache_accesses,
+                                     mdata->block_cache_hits);
 
   return mdata;
 }
@@ -812,6 +982,34 @@ void Range::relinquish_compact() {
     }
   }
 
+  // Warm handoff: stage a manifest identifying this range's blocks that
+  // are currently resident in the block cache inside the transfer log
+  // directory.  The destination server imports it at load time and
+  // prewarms its own cache with the same blocks, so the move does not
+  // show up as a period of cold-cache latency.
+  if (Global::block_cache) {
+    std::set<int> file_ids;
+    for (size_t i=0; i<ag_vector.size(); i++)
+      ag_vector[i]->get_file_ids(file_ids);
+    String manifest = Global::block_cache->export_index(file_ids);
+    if (!manifest.empty()) {
+      String manifest_path = m_metalog_entity->get_transfer_log() + "/hotblocks";
+      try {
+        int32_t fd = Global::log_dfs->create(manifest_path,
+                                             Filesystem::OPEN_FLAG_OVERWRITE,
+                                             -1, -1, -1);
+        StaticBuffer sbuf(manifest.length());
+        memcpy(sbuf.base, manifest.c_str(), manifest.length());
+        Global::log_dfs->append(fd, sbuf);
+        Global::log_dfs->close(fd);
+      }
+      catch (Exception &e) {
+        HT_WARNF("Problem writing hot block manifest %s - %s",
+                 manifest_path.c_str(), Error::get_text(e.code()));
+      }
+    }
+  }
+
   // Mark range as "dropped" preventing further scans and updates
   drop();
 
@@ -834,6 +1032,18 @@ void Range::relinquish_finalize() {
 
   HT_INFOF("Reporting relinquished range %s to Master", m_name.c_str());
 
+  // Transfer log writes are not flushed individually, so sync the log
+  // before handing it off to the destination server
+  {
+    lock_guard<mutex> lock(m_mutex);
+    if (m_transfer_log) {
+      int error;
+      if ((error = m_transfer_log->sync()) != Error::OK)
+        HT_ERRORF("Problem syncing transfer log '%s' - %s",
+                  m_transfer_log->get_log_dir().c_str(), Error::get_text(error));
+    }
+  }
+
   RangeSpecManaged range_spec;
   m_metalog_entity->get_range_spec(range_spec);
 
@@ -1150,7 +1360,7 @@ void Range::split_compact_and_shrink() {
    */
   for (size_t i=0; i<ag_vector.size(); i++)
     ag_vector[i]->run_compaction(MaintenanceFlag::COMPACT_MAJOR|MaintenanceFlag::SPLIT,
-                                 &hints[i]);
+                                 &hints[i], split_row.c_str());
 
   m_hints_file.set(hints);
   new_hints_file.set(hints);
@@ -1253,8 +1463,14 @@ void Range::split_compact_and_shrink() {
     for (size_t i=0; i<ag_vector.size(); i++)
       ag_vector[i]->shrink(split_row, m_split_off_high, &hints[i]);
 
-    // Close and uninstall split log
+    // Sync, close and uninstall split log.  Split log writes are not
+    // flushed individually, so sync here to make sure the new range sees
+    // all of the transferring updates when it replays the log
     m_split_row = "";
+    if ((error = m_transfer_log->sync()) != Error::OK) {
+      HT_ERRORF("Problem syncing split log '%s' - %s",
+                m_transfer_log->get_log_dir().c_str(), Error::get_text(error));
+    }
     if ((error = m_transfer_log->close()) != Error::OK) {
       HT_ERRORF("Problem closing split log '%s' - %s",
                 m_transfer_log->get_log_dir().c_str(), Error::get_text(error));
@@ -1365,10 +1581,10 @@ void Range::split_notify_master() {
   HT_INFOF("Reporting newly split off range %s[%s..%s] to Master",
            m_table.id, range.start_row, range.end_row);
 
-  if (!m_is_metadata && soft_limit < Global::range_split_size) {
+  if (!m_is_metadata && soft_limit < split_size()) {
     soft_limit *= 2;
-    if (soft_limit > Global::range_split_size)
-      soft_limit = Global::range_split_size;
+    if (soft_limit > split_size())
+      soft_limit = split_size();
   }
 
   m_master_client->move_range(m_metalog_entity->get_source(),
@@ -1742,6 +1958,7 @@ std::ostream &Hypertable::operator<<(std::ostream &os, const Range::MaintenanceD
   os << "disk_bytes_read=" << mdata.load_factors.disk_bytes_read << "\n";
   os << "purgeable_index_memory=" << mdata.purgeable_index_memory << "\n";
   os << "compact_memory=" << mdata.compact_memory << "\n";
+  os << "cellcache_budget=" << mdata.cellcache_budget << "\n";
   os << "soft_limit=" << mdata.soft_limit << "\n";
   os << "schema_generation=" << mdata.schema_generation << "\n";
   os << "priority=" << mdata.priority << "\n";
@@ -1762,6 +1979,9 @@ std::ostream &Hypertable::operator<<(std::ostream &os, const Range::MaintenanceD
   os << "bloom_filter_accesses=" << mdata.bloom_filter_accesses << "\n";
   os << "bloom_filter_maybes=" << mdata.bloom_filter_maybes << "\n";
   os << "bloom_filter_fps=" << mdata.bloom_filter_fps << "\n";
+  os << "block_cache_memory=" << mdata.block_cache_memory << "\n";
+  os << "block_cache_accesses=" << mdata.block_cache_accesses << "\n";
+  os << "block_cache_hits=" << mdata.block_cache_hits << "\n";
   os << "busy=" << (mdata.busy ? "true" : "false") << "\n";
   os << "is_metadata=" << (mdata.is_metadata ? "true" : "false") << "\n";
   os << "is_system=" << (mdata.is_system ? "true" : "false") << "\n";
@@ -53,11 +53,14 @@
 
 #include <Common/Barrier.h>
 #include <Common/fast_clock.h>
+#include <Common/LatencyHistogram.h>
 #include <Common/String.h>
 
+#include <atomic>
 #include <map>
 #include <memory>
 #include <mutex>
+#include <unordered_set>
 #include <vector>
 
 namespace Hypertable {
@@ -85,6 +88,7 @@ namespace Hypertable {
       uint64_t bytes_returned;
       int64_t  purgeable_index_memory;
       int64_t  compact_memory;
+      int64_t  cellcache_budget;
       int64_t soft_limit;
       uint32_t schema_generation;
       int32_t  priority;
@@ -105,6 +109,10 @@ namespace Hypertable {
       uint32_t bloom_filter_accesses;
       uint32_t bloom_filter_maybes;
       uint32_t bloom_filter_fps;
+      uint64_t block_cache_memory;
+      uint64_t block_cache_accesses;
+      uint64_t block_cache_hits;
+      uint64_t prewarm_bytes;
       int compaction_type_needed;
       bool     busy;
       bool     is_metadata;
@@ -124,7 +132,8 @@ namespace Hypertable {
           const RangeSpec &, RangeSet *, const RangeState &, bool needs_compaction=false);
     Range(Lib::Master::ClientPtr &, SchemaPtr &, MetaLogEntityRangePtr &, RangeSet *);
     virtual ~Range() {}
-    void add(const Key &key, const ByteString value);
+    void add(const Key &key, const ByteString value,
+             const StaticBufferPtr &buffer = StaticBufferPtr());
 
     void lock();
     void unlock();
@@ -133,6 +142,24 @@ namespace Hypertable {
 
     void create_scanner(ScanContextPtr &scan_ctx, MergeScannerRangePtr &scanner);
 
+    /// Looks up a row in the negative result cache.
+    /// @param row Row key
+    /// @return <i>true</i> if <code>row</code> is cached as known-absent
+    bool negative_cache_lookup(const char *row);
+
+    /// Records a row as known absent.
+    /// Called after an unrestricted point read of <code>row</code> returned
+    /// no cells.  When the cache reaches capacity it is simply cleared and
+    /// repopulates from subsequent misses.
+    /// @param row Row key
+    void negative_cache_insert(const char *row);
+
+    /// Invalidates a row in the negative result cache.
+    /// Called from the update pipeline's qualify stage for every row written
+    /// to this range.
+    /// @param row Row key
+    void negative_cache_invalidate(const char *row);
+
     /** Creates a scanner over the pseudo-table indicated by
      * <code>table_name</code>.  The following pseudo-tables are supported:
      *
@@ -152,12 +179,30 @@ namespace Hypertable {
     CellListScanner *create_scanner_pseudo_table(ScanContextPtr &scan_ctx,
                                                  const String &table_name);
 
+    bool initialized() { return m_initialized; }
+
     void deferred_initialization();
 
     void deferred_initialization(uint32_t timeout_millis);
 
     void deferred_initialization(std::chrono::fast_clock::time_point expire_time);
 
+    /// Warms the block cache with this range's hottest block data.
+    /// Performs deferred initialization, if it has not yet happened, and
+    /// then asks each access group to read block data into the block cache
+    /// up to its <i>prewarm bytes</i> hint.  Called from a prewarm
+    /// maintenance task queued when the range is loaded.
+    void prewarm_block_cache();
+
+    /// Writes each access group's cell caches to a local checkpoint file.
+    /// Called at clean shutdown, after the commit logs have been closed, so
+    /// that a restarted server can restore the caches instead of
+    /// re-inserting their cells during commit log replay.
+    /// @param written Vector to which the written checkpoint pathnames are
+    /// appended
+    /// @return <i>true</i> if every access group was checkpointed
+    bool write_cell_cache_checkpoints(std::vector<String> &written);
+
     void get_boundary_rows(String &start, String &end) {
       m_metalog_entity->get_boundary_rows(start, end);
     }
@@ -183,6 +228,13 @@ namespace Hypertable {
 
     void update_schema(SchemaPtr &schema);
 
+    /// Atomically links a bulk loaded CellStore file into an access group.
+    /// @param ag_name Access group name
+    /// @param source_file Pathname of bulk loaded CellStore file
+    /// @throws Exception with code Error::RANGESERVER_INVALID_COLUMNFAMILY
+    /// if <code>ag_name</code> does not name an access group of this range
+    void adopt_cellstore(const String &ag_name, const String &source_file);
+
     void split();
 
     void relinquish();
@@ -194,10 +246,28 @@ namespace Hypertable {
     void schedule_relinquish() { m_relinquish = true; }
     bool get_relinquish() const { return m_relinquish; }
 
+    /// Sets the adaptive cell cache memory budget for this range.
+    /// Installed by the maintenance scheduler based on the range's
+    /// observed write rate; access groups whose cache exceeds the budget
+    /// get compacted.
+    /// @param budget Budget in bytes, or 0 to fall back to
+    /// <code>Hypertable.RangeServer.AccessGroup.MaxMemory</code>
+    void set_cellcache_budget(int64_t budget) { m_cellcache_budget = budget; }
+
+    /// Returns the cell cache memory budget for this range.
+    /// @return Adaptive budget if one has been installed, otherwise
+    /// <code>Hypertable.RangeServer.AccessGroup.MaxMemory</code>
+    int64_t cellcache_budget();
+
     void recovery_initialize() {
       std::lock_guard<std::mutex> lock(m_mutex);
-      for (size_t i=0; i<m_access_group_vector.size(); i++)
-        m_access_group_vector[i]->recovery_initialize();
+      for (size_t i=0; i<m_access_group_vector.size(); i++) {
+        // Cells restored from a cell cache checkpoint bypass add(), so
+        // fold the restored revisions into the scan revision by hand
+        int64_t revision = m_access_group_vector[i]->recovery_initialize();
+        if (revision > m_latest_revision)
+          m_latest_revision = revision;
+      }
     }
 
     void recovery_finalize();
@@ -280,6 +350,14 @@ namespace Hypertable {
       m_cells_written += n;
     }
 
+    void add_scan_latency(int64_t latency_usec) {
+      m_scan_latency.add(latency_usec);
+    }
+
+    void add_update_latency(int64_t latency_usec) {
+      m_update_latency.add(latency_usec);
+    }
+
     bool need_maintenance();
 
     bool is_root() { return m_is_root; }
@@ -337,6 +415,13 @@ namespace Hypertable {
 
     void initialize();
 
+    /// Returns the split size governing this range (see Range.cc).
+    int64_t split_size();
+
+    /// Scales #m_split_threshold by observed growth velocity (see
+    /// Range.cc).
+    void adjust_split_threshold(int64_t disk_used, time_t now);
+
     void load_cell_stores();
 
     void split_install_log_rollback_metadata();
@@ -366,6 +451,17 @@ namespace Hypertable {
 
     std::mutex m_mutex;
     std::mutex m_schema_mutex;
+
+    /// %Mutex guarding #m_negative_row_cache
+    std::mutex m_negative_cache_mutex;
+
+    /// Rows known to contain no cells.  Subject to the same insert-after-
+    /// invalidate race as the query cache (a result computed from a scanner
+    /// snapshot can be inserted after a concurrent update invalidated the
+    /// row), which is tolerated for the same reason:  cache inserts are not
+    /// synchronized with updates anywhere in the read path.
+    std::unordered_set<String> m_negative_row_cache;
+
     Lib::Master::ClientPtr  m_master_client;
     MetaLogEntityRangePtr m_metalog_entity;
     AccessGroupHintsFile m_hints_file;
@@ -379,6 +475,20 @@ namespace Hypertable {
     int64_t m_revision {TIMESTAMP_MIN};
     int64_t m_latest_revision {TIMESTAMP_MIN};
     int64_t m_split_threshold {};
+
+    /// Unscaled split threshold (soft limit plus randomization); the
+    /// adaptive split logic scales this into #m_split_threshold
+    int64_t m_split_threshold_base {};
+
+    /// Disk usage observed by the last adaptive-split sample
+    int64_t m_growth_last_disk {};
+
+    /// Time of the last adaptive-split sample (0 if none taken)
+    time_t m_growth_last_time {};
+
+    /// Smoothed growth velocity in bytes per second
+    double m_growth_rate {};
+
     String m_split_row;
     CommitLogPtr m_transfer_log;
     Barrier          m_update_barrier;
@@ -393,7 +503,10 @@ namespace Hypertable {
     int32_t          m_error {};
     int              m_compaction_type_needed {};
     int64_t          m_maintenance_generation {};
+    std::atomic<int64_t> m_cellcache_budget {0};
     LoadMetricsRange m_load_metrics;
+    LatencyHistogram m_scan_latency;
+    LatencyHistogram m_update_latency;
     bool             m_dropped {};
     bool             m_capacity_exceeded_throttle {};
     bool             m_relinquish {};
@@ -27,6 +27,7 @@
 
 #include "RangeServer.h"
 
+#include <Hypertable/RangeServer/CellCacheCheckpoint.h>
 #include <Hypertable/RangeServer/FillScanBlock.h>
 #include <Hypertable/RangeServer/Global.h>
 #include <Hypertable/RangeServer/GroupCommit.h>
@@ -37,6 +38,7 @@
 #include <Hypertable/RangeServer/MaintenanceQueue.h>
 #include <Hypertable/RangeServer/MaintenanceScheduler.h>
 #include <Hypertable/RangeServer/MaintenanceTaskCompaction.h>
+#include <Hypertable/RangeServer/MaintenanceTaskPrewarm.h>
 #include <Hypertable/RangeServer/MaintenanceTaskRelinquish.h>
 #include <Hypertable/RangeServer/MaintenanceTaskSplit.h>
 #include <Hypertable/RangeServer/MergeScannerRange.h>
@@ -45,10 +47,13 @@
 #include <Hypertable/RangeServer/MetaLogEntityRemoveOkLogs.h>
 #include <Hypertable/RangeServer/MetaLogEntityTask.h>
 #include <Hypertable/RangeServer/ReplayBuffer.h>
+#include <Hypertable/RangeServer/Request/Handler/ReadaheadScanblock.h>
 #include <Hypertable/RangeServer/ScanContext.h>
+#include <Hypertable/RangeServer/StartupSelfTest.h>
 
 #include <Hypertable/Lib/ClusterId.h>
 #include <Hypertable/Lib/CommitLog.h>
+#include <Hypertable/Lib/CommitLogArchiver.h>
 #include <Hypertable/Lib/Key.h>
 #include <Hypertable/Lib/LegacyDecoder.h>
 #include <Hypertable/Lib/MetaLogDefinition.h>
@@ -60,14 +65,18 @@
 
 #include <FsBroker/Lib/Client.h>
 
+#include <Common/AllocationTracker.h>
+#include <Common/Base64.h>
 #include <Common/FailureInducer.h>
 #include <Common/FileUtils.h>
 #include <Common/Random.h>
+#include <Common/RequestTracer.h>
 #include <Common/ScopeGuard.h>
 #include <Common/Status.h>
 #include <Common/StatusPersister.h>
 #include <Common/StringExt.h>
 #include <Common/SystemInfo.h>
+#include <Common/ThreadActivity.h>
 #include <Common/md5.h>
 
 #include <boost/algorithm/string.hpp>
@@ -83,6 +92,7 @@
 #endif
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <chrono>
 #include <cstdio>
@@ -143,8 +153,13 @@ Apps::RangeServer::RangeServer(PropertiesPtr &props, ConnectionManagerPtr &conn_
   Global::enable_shadow_cache = cfg.get_bool("AccessGroup.ShadowCache");
   Global::cellstore_target_size_min = cfg.get_i64("CellStore.TargetSize.Minimum");
   Global::cellstore_target_size_max = cfg.get_i64("CellStore.TargetSize.Maximum");
+  Global::cellstore_preadv_blocks = cfg.get_i32("CellStore.Preadv.BlockCount");
   Global::pseudo_tables = PseudoTables::instance();
   m_scanner_buffer_size = cfg.get_i64("Scanner.BufferSize");
+  m_scanner_spill_delay = cfg.get_i32("Scanner.SpillDelay");
+  m_scanner_spill_budget = cfg.get_i64("Scanner.SpillBudget");
+  m_scanner_spill_directory = cfg.get_str("Scanner.SpillDirectory");
+  m_root_publish_locations = cfg.get_bool("Root.PublishLocations");
   port = cfg.get_i16("Port");
 
   m_control_file_check_interval = cfg.get_i32("ControlFile.CheckInterval");
@@ -171,6 +186,8 @@ Apps::RangeServer::RangeServer(PropertiesPtr &props, ConnectionManagerPtr &conn_
     HT_INFOF("drive count = %d, maintenance threads = %d", disk_count, maintenance_threads);
   }
 
+  uint32_t fast_lane_threads = cfg.get_i32("Maintenance.FastLaneThreads");
+
   Global::toplevel_dir = props->get_str("Hypertable.Directory");
   boost::trim_if(Global::toplevel_dir, boost::is_any_of("/"));
   Global::toplevel_dir = String("/") + Global::toplevel_dir;
@@ -182,6 +199,16 @@ Apps::RangeServer::RangeServer(PropertiesPtr &props, ConnectionManagerPtr &conn_
 
   Global::load_statistics = make_shared<LoadStatistics>(interval);
 
+  {
+    int32_t top_k = cfg.get_i32("HotKeyDetector.TopK");
+    if (top_k > 0) {
+      Global::hot_key_detector = new HotKeyDetector((size_t)top_k);
+      Global::load_statistics->set_hot_key_detector(Global::hot_key_detector);
+    }
+  }
+
+  Global::maintenance_throttle = make_shared<MaintenanceThrottle>(m_props);
+
   m_stats = make_shared<StatsRangeServer>(m_props);
 
   m_namemap = make_shared<NameIdMapper>(m_hyperspace, Global::toplevel_dir);
@@ -245,6 +272,76 @@ Apps::RangeServer::RangeServer(PropertiesPtr &props, ConnectionManagerPtr &conn_
     Global::block_cache = new FileBlockCache(block_cache_min, block_cache_max,
                         cfg.get_bool("BlockCache.Compressed"));
 
+  // Optional second-tier cache holding compressed blocks; only meaningful
+  // when the block cache itself holds uncompressed (hot) blocks
+  int64_t compressed_tier_max = cfg.get_i64("BlockCache.CompressedTier.MaxMemory");
+  if (compressed_tier_max > 0) {
+    if (Global::block_cache && !Global::block_cache->compressed())
+      Global::compressed_block_cache =
+        new FileBlockCache(0, compressed_tier_max, true);
+    else
+      HT_WARN("Ignoring BlockCache.CompressedTier.MaxMemory because the "
+              "block cache is disabled or already stores compressed blocks");
+  }
+
+  // Optional flash tier backed by a local file; blocks evicted from the
+  // block cache are spilled there and re-read on a miss
+  String flash_tier_path = cfg.get_str("BlockCache.FlashTier.Path");
+  int64_t flash_tier_max = cfg.get_i64("BlockCache.FlashTier.MaxSize");
+  if (!flash_tier_path.empty() && flash_tier_max > 0) {
+    if (Global::block_cache) {
+      Global::flash_block_cache =
+        new FlashBlockCache(flash_tier_path, flash_tier_max);
+      Global::block_cache->set_flash_cache(Global::flash_block_cache);
+    }
+    else
+      HT_WARN("Ignoring BlockCache.FlashTier.Path because the block cache "
+              "is disabled");
+  }
+
+  // Load the block cache index persisted by the previous process (if any);
+  // the recorded blocks are re-read by prewarm tasks queued after log
+  // replay (see local_recover() and shutdown())
+  m_block_cache_index_path = cfg.get_str("BlockCache.IndexPath");
+  if (!m_block_cache_index_path.empty()) {
+    if (Global::block_cache)
+      Global::block_cache->load_index(m_block_cache_index_path);
+    else
+      HT_WARN("Ignoring BlockCache.IndexPath because the block cache "
+              "is disabled");
+  }
+
+  // Local directory in which cell cache checkpoints are written at clean
+  // shutdown and from which they are restored during local recovery (see
+  // AccessGroup::recovery_initialize() and shutdown())
+  Global::cell_cache_checkpoint_dir = cfg.get_str("CellCache.CheckpointDirectory");
+  if (!Global::cell_cache_checkpoint_dir.empty() &&
+      !FileUtils::mkdirs(Global::cell_cache_checkpoint_dir)) {
+    HT_WARNF("Unable to create cell cache checkpoint directory '%s', "
+             "disabling cell cache checkpoints",
+             Global::cell_cache_checkpoint_dir.c_str());
+    Global::cell_cache_checkpoint_dir.clear();
+  }
+
+  // Sampled scan-request log used to warm standby servers via shadow
+  // replay (see Tools/scan_replay)
+  if (cfg.get_bool("ScanAccessLog.Enable")) {
+    m_scan_access_sample_rate = cfg.get_i32("ScanAccessLog.SampleRate");
+    if (m_scan_access_sample_rate < 1)
+      m_scan_access_sample_rate = 1;
+    m_scan_access_log = new Cronolog("ScanAccess.log",
+                                     System::install_dir + "/log",
+                                     System::install_dir + "/log/archive");
+  }
+
+  int64_t readahead_budget = cfg.get_i64("Scanner.ReadaheadBudget");
+  if (readahead_budget > 0)
+    Global::readahead_budget = new ReadaheadBudget(readahead_budget);
+
+  int32_t decompression_workers = cfg.get_i32("Scanner.DecompressionWorkers");
+  if (decompression_workers > 0)
+    Global::decompression_pool = new DecompressionPool(decompression_workers);
+
   int64_t query_cache_memory = cfg.get_i64("QueryCache.MaxMemory");
   if (query_cache_memory > 0) {
     // reduce query cache if required
@@ -256,7 +353,10 @@ Apps::RangeServer::RangeServer(PropertiesPtr &props, ConnectionManagerPtr &conn_
     m_query_cache = std::make_shared<QueryCache>(query_cache_memory);
   }
 
-  Global::memory_tracker = new MemoryTracker(Global::block_cache, m_query_cache);
+  Global::memory_tracker = new MemoryTracker(Global::block_cache, m_query_cache,
+                                             Global::compressed_block_cache);
+
+  m_update_throttle = std::make_shared<UpdateThrottle>(props);
 
   FsBroker::Lib::ClientPtr dfsclient = std::make_shared<FsBroker::Lib::Client>(conn_mgr, props);
 
@@ -291,8 +391,37 @@ Apps::RangeServer::RangeServer(PropertiesPtr &props, ConnectionManagerPtr &conn_
   else
     Global::log_dfs = Global::dfs;
 
+  /**
+   * Set up commit log archival
+   */
+  {
+    String archive_dir = props->get_str("Hypertable.CommitLog.Archive.Directory");
+    if (!archive_dir.empty()) {
+      FilesystemPtr archive_fs = Global::log_dfs;
+      if (props->has("Hypertable.CommitLog.Archive.DfsBroker.Host")) {
+        String archive_host = props->get_str("Hypertable.CommitLog.Archive.DfsBroker.Host");
+        uint16_t archive_port = props->get_i16("Hypertable.CommitLog.Archive.DfsBroker.Port");
+        InetAddr addr(archive_host, archive_port);
+
+        FsBroker::Lib::ClientPtr archive_client =
+          std::make_shared<FsBroker::Lib::Client>(conn_mgr, addr, dfs_timeout);
+
+        if (!archive_client->wait_for_connection(30000))
+          HT_THROW(Error::REQUEST_TIMEOUT,
+                   "connecting to commit log archive FS broker");
+
+        archive_fs = archive_client;
+      }
+      CommitLogArchiver::instance =
+        new CommitLogArchiver(archive_fs, archive_dir);
+      HT_INFOF("Archiving removed commit log fragments under '%s'",
+               archive_dir.c_str());
+    }
+  }
+
   // Create the maintenance queue
-  Global::maintenance_queue = make_shared<MaintenanceQueue>(maintenance_threads);
+  Global::maintenance_queue =
+    make_shared<MaintenanceQueue>(maintenance_threads, fast_lane_threads);
 
   /**
    * Listen for incoming connections
@@ -334,6 +463,18 @@ Apps::RangeServer::RangeServer(PropertiesPtr &props, ConnectionManagerPtr &conn_
 
   initialize(props);
 
+  if (cfg.get_bool("StartupSelfTest")) {
+    try {
+      String selftest_dir = Global::toplevel_dir + "/servers/"
+        + Global::location_initializer->get() + "/selftest";
+      m_selftest_results =
+        StartupSelfTest::run(selftest_dir, cfg.get_i64("StartupSelfTest.Size"));
+    }
+    catch (Exception &e) {
+      HT_ERRORF("Startup self-test failed - %s", Error::get_text(e.code()));
+    }
+  }
+
   Global::log_prune_threshold_min = cfg.get_i64("CommitLog.PruneThreshold.Min");
 
   uint32_t max_memory_percentage =
@@ -356,7 +497,7 @@ Apps::RangeServer::RangeServer(PropertiesPtr &props, ConnectionManagerPtr &conn_
 
   m_maintenance_scheduler =
     std::make_shared<MaintenanceScheduler>(Global::maintenance_queue,
-                                           m_context->live_map);
+                                           m_context->live_map, m_query_cache);
 
   // Install maintenance timer
   m_timer_handler = make_shared<TimerHandler>(m_context->comm, this);
@@ -365,6 +506,15 @@ Apps::RangeServer::RangeServer(PropertiesPtr &props, ConnectionManagerPtr &conn_
 
   m_timer_handler->start();
 
+  if (props->get_bool("Hypertable.RangeServer.Gossip.Enabled")) {
+    m_liveness_gossip_handler =
+      make_shared<LivenessGossipHandler>(props, m_context->comm, m_hyperspace,
+                                         m_master_client,
+                                         Global::location_initializer->get(),
+                                         Global::toplevel_dir);
+    m_liveness_gossip_handler->start();
+  }
+
   HT_INFOF("Prune thresholds - min=%lld, max=%lld", (Lld)Global::log_prune_threshold_min,
            (Lld)Global::log_prune_threshold_max);
 
@@ -420,6 +570,9 @@ void Apps::RangeServer::shutdown() {
     if (m_group_commit_timer_handler)
       m_group_commit_timer_handler->shutdown();
 
+    if (m_liveness_gossip_handler)
+      m_liveness_gossip_handler->shutdown();
+
     // Kill update pipelines
     m_update_pipeline_user->shutdown();
     if (m_update_pipeline_system)
@@ -450,6 +603,33 @@ void Apps::RangeServer::shutdown() {
       //Global::user_log.reset();
     }
 
+    // Checkpoint the cell caches, now that the commit logs are closed, so
+    // that local_recover() can restore them instead of re-inserting their
+    // cells during commit log replay.  If every access group checkpointed
+    // cleanly, the handoff manifest authorizes a successor process on this
+    // host to skim the commit logs instead of replaying them.
+    if (!Global::cell_cache_checkpoint_dir.empty()) {
+      Ranges ranges;
+      vector<String> checkpoints;
+      bool complete = true;
+      m_context->live_map->get_ranges(ranges);
+      for (auto &rd : ranges.array) {
+        if (!rd.range->write_cell_cache_checkpoints(checkpoints))
+          complete = false;
+      }
+      if (complete)
+        CellCacheCheckpoint::write_manifest(Global::cell_cache_checkpoint_dir,
+                                            checkpoints);
+    }
+
+    // Persist the block cache index so that a restarted server can re-warm
+    // itself instead of taking cold-cache misses (see local_recover())
+    if (Global::block_cache && !m_block_cache_index_path.empty())
+      Global::block_cache->persist_index(m_block_cache_index_path);
+
+    if (m_scan_access_log)
+      m_scan_access_log->sync();
+
     /*
     if (Global::block_cache) {
       delete Global::block_cache;
@@ -497,7 +677,7 @@ void Apps::RangeServer::initialize(PropertiesPtr &props) {
                            &lock_status, &m_existence_file_sequencer);
 
     if (lock_status == LOCK_STATUS_GRANTED) {
-      Global::location_initializer->set_lock_held();      
+      Global::location_initializer->set_lock_held();
       break;
     }
 
@@ -506,6 +686,15 @@ void Apps::RangeServer::initialize(PropertiesPtr &props) {
     this_thread::sleep_for(chrono::milliseconds(5000));
   }
 
+  // Publish datagram address for peer liveness gossip
+  if (props->get_bool("Hypertable.RangeServer.Gossip.Enabled")) {
+    InetAddr gossip_addr(System::net_info().primary_addr,
+                         props->get_i16("Hypertable.RangeServer.Port"));
+    String addr_str = gossip_addr.format();
+    m_hyperspace->attr_set(m_existence_file_handle, "gossip_address",
+                           addr_str.c_str(), addr_str.length());
+  }
+
   Global::log_dir = top_dir + "/log";
 
   /**
@@ -623,6 +812,14 @@ void Apps::RangeServer::local_recover() {
 
     rsml_reader->get_entities(entities);
 
+    // Load the handoff manifest written at the last clean shutdown (if
+    // any); only the checkpoints it lists may be restored, and the commit
+    // logs are skimmed rather than replayed once all of them are
+    if (!Global::cell_cache_checkpoint_dir.empty())
+      Global::cell_cache_handoff_valid =
+        CellCacheCheckpoint::load_manifest(Global::cell_cache_checkpoint_dir,
+                                           Global::cell_cache_checkpoint_manifest);
+
     if (!entities.empty()) {
       HT_DEBUG_OUT << "Found "<< Global::log_dir << "/"
           << rsml_definition->name() <<", start recovering"<< HT_END;
@@ -678,6 +875,7 @@ void Apps::RangeServer::local_recover() {
                                      entities);
 
       replay_map.clear();
+      std::vector<MetaLogEntityRangePtr> range_entities;
       for (auto & entity : entities) {
         MetaLogEntityRangePtr range_entity = dynamic_pointer_cast<MetaLogEntityRange>(entity);
         if (range_entity) {
@@ -685,14 +883,18 @@ void Apps::RangeServer::local_recover() {
           String end_row = range_entity->get_end_row();
           range_entity->get_table_identifier(table);
           if (table.is_metadata() && !end_row.compare(Key::END_ROOT_ROW))
-            replay_load_range(replay_map, range_entity);
+            range_entities.push_back(range_entity);
         }
       }
+      replay_load_ranges(replay_map, range_entities);
 
       if (!replay_map.empty()) {
         root_log_reader = make_shared<CommitLogReader>(Global::log_dfs,
                                               Global::log_dir + "/root");
-        replay_log(replay_map, root_log_reader);
+        if (cell_cache_handoff_complete())
+          skim_log(root_log_reader);
+        else
+          replay_log(replay_map, root_log_reader);
 
         root_log_reader->get_linked_logs(transfer_logs);
 
@@ -727,6 +929,7 @@ void Apps::RangeServer::local_recover() {
       }
 
       replay_map.clear();
+      range_entities.clear();
       for (auto & entity : entities) {
         MetaLogEntityRangePtr range_entity = dynamic_pointer_cast<MetaLogEntityRange>(entity);
         if (range_entity) {
@@ -734,15 +937,19 @@ void Apps::RangeServer::local_recover() {
           String end_row = range_entity->get_end_row();
           range_entity->get_table_identifier(table);
           if (table.is_metadata() && end_row.compare(Key::END_ROOT_ROW))
-            replay_load_range(replay_map, range_entity);
+            range_entities.push_back(range_entity);
         }
       }
+      replay_load_ranges(replay_map, range_entities);
 
       if (!replay_map.empty()) {
         metadata_log_reader =
           make_shared<CommitLogReader>(Global::log_dfs, Global::log_dir + "/metadata");
 
-        replay_log(replay_map, metadata_log_reader);
+        if (cell_cache_handoff_complete())
+          skim_log(metadata_log_reader);
+        else
+          replay_log(replay_map, metadata_log_reader);
 
         metadata_log_reader->get_linked_logs(transfer_logs);
 
@@ -782,21 +989,26 @@ void Apps::RangeServer::local_recover() {
       }
 
       replay_map.clear();
+      range_entities.clear();
       for (auto & entity : entities) {
         MetaLogEntityRangePtr range_entity = dynamic_pointer_cast<MetaLogEntityRange>(entity);
         if (range_entity) {
           TableIdentifier table;
           range_entity->get_table_identifier(table);
           if (table.is_system() && !table.is_metadata())
-            replay_load_range(replay_map, range_entity);
+            range_entities.push_back(range_entity);
         }
       }
+      replay_load_ranges(replay_map, range_entities);
 
       if (!replay_map.empty()) {
         system_log_reader =
           make_shared<CommitLogReader>(Global::log_dfs, Global::log_dir + "/system");
 
-        replay_log(replay_map, system_log_reader);
+        if (cell_cache_handoff_complete())
+          skim_log(system_log_reader);
+        else
+          replay_log(replay_map, system_log_reader);
 
         system_log_reader->get_linked_logs(transfer_logs);
 
@@ -841,21 +1053,26 @@ void Apps::RangeServer::local_recover() {
         return;
 
       replay_map.clear();
+      range_entities.clear();
       for (auto & entity : entities) {
         MetaLogEntityRangePtr range_entity = dynamic_pointer_cast<MetaLogEntityRange>(entity);
         if (range_entity) {
           TableIdentifier table;
           range_entity->get_table_identifier(table);
           if (!table.is_system())
-            replay_load_range(replay_map, range_entity);
+            range_entities.push_back(range_entity);
         }
       }
+      replay_load_ranges(replay_map, range_entities);
 
       if (!replay_map.empty()) {
         user_log_reader = make_shared<CommitLogReader>(Global::log_dfs,
                                               Global::log_dir + "/user");
 
-        replay_log(replay_map, user_log_reader);
+        if (cell_cache_handoff_complete())
+          skim_log(user_log_reader);
+        else
+          replay_log(replay_map, user_log_reader);
 
         user_log_reader->get_linked_logs(transfer_logs);
 
@@ -893,6 +1110,19 @@ void Apps::RangeServer::local_recover() {
         maintenance_tasks.clear();
       }
 
+      // Queue tasks to re-populate the block cache for the recovered
+      // ranges; their cellstores claim the exact warmup extents loaded
+      // from the persisted cache index
+      if (Global::block_cache && Global::maintenance_queue &&
+          Global::block_cache->warmup_pending()) {
+        ranges.array.clear();
+        m_context->live_map->get_ranges(ranges);
+        auto schedule_time = chrono::steady_clock::now();
+        for (auto &rd : ranges.array)
+          Global::maintenance_queue->add(
+              new MaintenanceTaskPrewarm(0, 0, schedule_time, rd.range));
+      }
+
       HT_NOTICE("Replay finished");
 
     }
@@ -947,6 +1177,11 @@ void Apps::RangeServer::local_recover() {
       Global::rsml_writer->record_state(Global::remove_ok_logs);
     }
 
+    // The handoff is over; ranges initialized from here on (e.g. phantom
+    // ranges during failover) must never consult the manifest
+    Global::cell_cache_handoff_valid = false;
+    Global::cell_cache_checkpoint_manifest.clear();
+
   }
   catch (Exception &e) {
     HT_ERROR_OUT << e << HT_END;
@@ -1011,18 +1246,21 @@ Apps::RangeServer::replay_load_range(TableInfoMap &replay_map,
     HT_ASSERT(generation == table.generation);
 
     /**
-     * Lazily create sys/METADATA table pointer
+     * Lazily create sys/METADATA table pointer.  Re-checked under the
+     * lock because ranges load concurrently during local recovery.
      */
     if (!Global::metadata_table) {
       lock_guard<mutex> lock(Global::mutex);
-      uint32_t timeout_ms = m_props->get_i32("Hypertable.Request.Timeout");
-      if (!Global::range_locator)
-        Global::range_locator = make_shared<Hypertable::RangeLocator>(m_props,
-                m_conn_manager, Global::hyperspace, timeout_ms);
-      ApplicationQueueInterfacePtr aq = Global::app_queue;
-      Global::metadata_table = make_shared<Table>(m_props, Global::range_locator,
-              m_conn_manager, Global::hyperspace, aq,
-              m_namemap, TableIdentifier::METADATA_NAME, 0, timeout_ms);
+      if (!Global::metadata_table) {
+        uint32_t timeout_ms = m_props->get_i32("Hypertable.Request.Timeout");
+        if (!Global::range_locator)
+          Global::range_locator = make_shared<Hypertable::RangeLocator>(m_props,
+                  m_conn_manager, Global::hyperspace, timeout_ms);
+        ApplicationQueueInterfacePtr aq = Global::app_queue;
+        Global::metadata_table = make_shared<Table>(m_props, Global::range_locator,
+                m_conn_manager, Global::hyperspace, aq,
+                m_namemap, TableIdentifier::METADATA_NAME, 0, timeout_ms);
+      }
     }
 
     schema = table_info->get_schema();
@@ -1049,6 +1287,59 @@ Apps::RangeServer::replay_load_range(TableInfoMap &replay_map,
 }
 
 
+void
+Apps::RangeServer::replay_load_ranges(TableInfoMap &replay_map,
+                        std::vector<MetaLogEntityRangePtr> &range_entities) {
+
+  if (range_entities.size() <= 1) {
+    for (auto &range_entity : range_entities)
+      replay_load_range(replay_map, range_entity);
+    return;
+  }
+
+  /**
+   * Range loading is dominated by CellStore opens and access group hint
+   * file reads through the FsBroker, which are independent per range, so
+   * ranges are loaded by a bounded pool of workers pulling from a shared
+   * index.  The structures touched by replay_load_range (the table info
+   * maps, schema cache and maintenance scheduler blacklist) are all
+   * internally synchronized.
+   */
+  size_t worker_count = std::min(range_entities.size(),
+      (size_t)m_props->get_i32("Hypertable.RangeServer.RangeLoadWorkers"));
+
+  std::atomic<size_t> next {0};
+  std::mutex error_mutex;
+  std::exception_ptr load_error;
+
+  auto load_worker = [&]() {
+    size_t i;
+    while ((i = next.fetch_add(1)) < range_entities.size()) {
+      try {
+        replay_load_range(replay_map, range_entities[i]);
+      }
+      catch (...) {
+        lock_guard<mutex> lock(error_mutex);
+        if (!load_error)
+          load_error = std::current_exception();
+        return;
+      }
+    }
+  };
+
+  vector<std::thread> threads;
+  threads.reserve(worker_count - 1);
+  for (size_t i = 1; i < worker_count; ++i)
+    threads.emplace_back(load_worker);
+  load_worker();
+  for (auto &t : threads)
+    t.join();
+
+  if (load_error)
+    std::rethrow_exception(load_error);
+}
+
+
 void Apps::RangeServer::replay_log(TableInfoMap &replay_map,
                              CommitLogReaderPtr &log_reader) {
   BlockHeaderCommitLog header;
@@ -1127,6 +1418,65 @@ void Apps::RangeServer::replay_log(TableInfoMap &replay_map,
            log_reader->get_log_dir().c_str());
 }
 
+
+bool Apps::RangeServer::cell_cache_handoff_complete() {
+  return Global::cell_cache_handoff_valid &&
+    Global::cell_cache_restore_failures.load() == 0;
+}
+
+
+void Apps::RangeServer::skim_log(CommitLogReaderPtr &log_reader) {
+  BlockHeaderCommitLog header;
+  const uint8_t *base;
+  size_t len;
+  unsigned long block_count = 0;
+
+  while (log_reader->next(&base, &len, &header))
+    block_count++;
+
+  HT_INFOF("Skimmed %lu blocks of updates from '%s' (cells restored from "
+           "cell cache checkpoints)", block_count,
+           log_reader->get_log_dir().c_str());
+}
+
+
+void
+Apps::RangeServer::adopt_cellstore(ResponseCallback *cb,
+        const TableIdentifier &table, const RangeSpec &range_spec,
+        const char *ag_name, const char *source_file) {
+  TableInfoPtr table_info;
+  RangePtr range;
+  std::stringstream sout;
+
+  sout << "adopt_cellstore\n" << table << range_spec
+       << "AccessGroup=" << ag_name << " SourceFile=" << source_file;
+  HT_INFOF("%s", sout.str().c_str());
+
+  if (!m_log_replay_barrier->wait(cb->event()->deadline(), table, range_spec))
+    return;
+
+  try {
+
+    if (!m_context->live_map->lookup(table.id, table_info))
+      HT_THROWF(Error::TABLE_NOT_FOUND, "%s", table.id);
+
+    if (!table_info->get_range(range_spec, range))
+      HT_THROW(Error::RANGESERVER_RANGE_NOT_FOUND,
+               format("%s[%s..%s]", table.id, range_spec.start_row,
+                      range_spec.end_row));
+
+    range->adopt_cellstore(ag_name, source_file);
+
+    cb->response_ok();
+  }
+  catch (Hypertable::Exception &e) {
+    HT_ERROR_OUT << e << HT_END;
+    int error = 0;
+    if (cb && (error = cb->error(e.code(), e.what())) != Error::OK)
+      HT_ERRORF("Problem sending error response - %s", Error::get_text(error));
+  }
+}
+
 void
 Apps::RangeServer::compact(ResponseCallback *cb, const TableIdentifier &table,
                      const char *row, int32_t flags) {
@@ -1423,11 +1773,92 @@ Apps::RangeServer::metadata_sync(ResponseCallback *cb, const char *table_id,
   }
 }
 
+bool
+Apps::RangeServer::create_scanner_from_cache(
+        Response::Callback::CreateScanner *cb, const TableIdentifier &table,
+        const RangeSpec &range_spec, QueryCache::Key *cache_key) {
+  TableInfoPtr table_info;
+  RangePtr range;
+  int error;
+
+  if (!m_query_cache || table.is_metadata())
+    return false;
+
+  // Poll the replay barrier; if replay is still in progress, decline and
+  // let the queued request wait on it
+  if (!m_log_replay_barrier->wait(ClockT::now(), table, range_spec))
+    return false;
+
+  if (!m_context->live_map->lookup(table.id, table_info) ||
+      !table_info->get_range(range_spec, range))
+    return false;
+
+  // Schema changes and uninitialized ranges need the full path's error
+  // handling and blocking behavior
+  if (table_info->get_schema()->get_generation() != table.generation ||
+      !range->initialized())
+    return false;
+
+  if (!range->increment_scan_counter())
+    return false;
+
+  String start_row, end_row;
+  range->get_boundary_rows(start_row, end_row);
+
+  bool hit {};
+  boost::shared_array<uint8_t> ext_buffer;
+  uint32_t ext_len {};
+  uint32_t cell_count {};
+
+  // Only serve the cached result while the range is still live here with
+  // unchanged boundaries; otherwise the full path generates the
+  // RANGE_NOT_FOUND response that re-routes the client
+  if (!strcmp(start_row.c_str(), range_spec.start_row) &&
+      !strcmp(end_row.c_str(), range_spec.end_row))
+    hit = m_query_cache->lookup(cache_key, table.id, ext_buffer, &ext_len,
+                                &cell_count);
+
+  range->decrement_scan_counter();
+
+  if (!hit)
+    return false;
+
+  ProfileDataScanner profile_data;
+  if ((error = cb->response(0, 0, 0, false, profile_data, ext_buffer,
+                            ext_len)) != Error::OK)
+    HT_ERRORF("Problem sending OK response - %s", Error::get_text(error));
+  lock_guard<LoadStatistics> lock(*Global::load_statistics);
+  Global::load_statistics->add_cached_scan_data(1, cell_count, ext_len);
+  return true;
+}
+
+void
+Apps::RangeServer::log_scan_access(const TableIdentifier &table,
+                                   const ScanSpec &scan_spec) {
+  String name;
+
+  // The log records table names rather than IDs because IDs are mapped at
+  // runtime and would be meaningless to the replaying client
+  if (!m_namemap->id_to_name(table.id, name))
+    return;
+
+  size_t len = scan_spec.encoded_length();
+  DynamicBuffer dbuf(len);
+  uint8_t *ptr = dbuf.base;
+  scan_spec.encode(&ptr);
+
+  String line = format("%s %s", name.c_str(),
+      Base64::encode(String((const char *)dbuf.base, len)).c_str());
+  m_scan_access_log->write(time(0), line);
+}
+
 void
 Apps::RangeServer::create_scanner(Response::Callback::CreateScanner *cb,
         const TableIdentifier &table, const RangeSpec &range_spec,
-        const ScanSpec &scan_spec, QueryCache::Key *cache_key) {
+        const ScanSpec &scan_spec, QueryCache::Key *cache_key,
+        uint8_t scan_block_format) {
   int error = Error::OK;
+  int64_t scan_start_time = get_ts64();
   String errmsg;
   TableInfoPtr table_info;
   RangePtr range;
@@ -1438,6 +1869,10 @@ Apps::RangeServer::create_scanner(Response::Callback::CreateScanner *cb,
   ScanContextPtr scan_ctx;
   ProfileDataScanner profile_data;
   bool decrement_needed=false;
+  bool coalesce_leader {};
+  boost::shared_array<uint8_t> coalesce_buffer;
+  uint32_t coalesce_len {};
+  bool coalesce_shareable {};
 
   //HT_DEBUG_OUT <<"Creating scanner:\n"<< *table << *range_spec
   //<< *scan_spec << HT_END;
@@ -1463,6 +1898,10 @@ Apps::RangeServer::create_scanner(Response::Callback::CreateScanner *cb,
       HT_THROW(Error::RANGESERVER_BAD_SCAN_SPEC,
                "can only scan one cell interval");
 
+    if (scan_spec.aggregation > ScanSpec::AGGREGATION_MAX)
+      HT_THROWF(Error::RANGESERVER_BAD_SCAN_SPEC,
+                "unknown aggregation operator %d", (int)scan_spec.aggregation);
+
     if (!m_context->live_map->lookup(table.id, table_info))
       HT_THROW(Error::TABLE_NOT_FOUND, table.id);
 
@@ -1499,12 +1938,23 @@ Apps::RangeServer::create_scanner(Response::Callback::CreateScanner *cb,
       HT_THROWF(Error::RANGESERVER_RANGE_NOT_FOUND, "(b) %s[%s..%s]",
                 table.id, range_spec.start_row, range_spec.end_row);
 
+    // Log a sample of scan requests for shadow replay warming
+    if (m_scan_access_log && !table.is_system() &&
+        (m_scan_access_counter++ % m_scan_access_sample_rate) == 0)
+      log_scan_access(table, scan_spec);
+
+    // Caching can be switched off per table with the QUERY_CACHE_DISABLED
+    // schema option
+    bool cacheable = cache_key && m_query_cache && !table.is_metadata() &&
+      !schema->get_query_cache_disabled();
+
     // check query cache
-    if (cache_key && m_query_cache && !table.is_metadata()) {
+    if (cacheable) {
       boost::shared_array<uint8_t> ext_buffer;
       uint32_t ext_len;
       uint32_t cell_count;
-      if (m_query_cache->lookup(cache_key, ext_buffer, &ext_len, &cell_count)) {
+      if (m_query_cache->lookup(cache_key, table.id, ext_buffer, &ext_len,
+                                &cell_count)) {
         if ((error = cb->response(id, 0, 0, false, profile_data, ext_buffer, ext_len))
                 != Error::OK)
           HT_ERRORF("Problem sending OK response - %s", Error::get_text(error));
@@ -1514,10 +1964,52 @@ Apps::RangeServer::create_scanner(Response::Callback::CreateScanner *cb,
         return;
       }
     }
+    // Identify single-row point reads for the negative result cache
+    const char *point_row = 0;
+    if (scan_spec.row_intervals.size() == 1 && !scan_spec.scan_and_filter_rows) {
+      const RowInterval &ri = scan_spec.row_intervals[0];
+      if (ri.start && ri.end && *ri.start && ri.start_inclusive &&
+          ri.end_inclusive && !strcmp(ri.start, ri.end))
+        point_row = ri.start;
+    }
+
+    // A point read of a row known to contain no cells is answered here,
+    // without fanning out to the access groups
+    if (point_row && range->negative_cache_lookup(point_row)) {
+      range->decrement_scan_counter();
+      decrement_needed = false;
+      StaticBuffer ext;
+      if ((error = cb->response(0, 0, 0, false, profile_data, ext,
+                                scan_block_format)) != Error::OK)
+        HT_ERRORF("Problem sending OK response - %s", Error::get_text(error));
+      lock_guard<LoadStatistics> lock(*Global::load_statistics);
+      Global::load_statistics->add_cached_scan_data(1, 0, 0);
+      return;
+    }
+
+    // Coalesce identical concurrent scans:  if an identical cacheable scan
+    // is already in flight, attach this client to it instead of building a
+    // second scanner stack; the in-flight scan multicasts its result when
+    // it completes
+    if (cacheable) {
+      lock_guard<mutex> lock(m_scan_coalesce_mutex);
+      auto insert_result = m_scan_coalesce_map.insert(
+          make_pair(make_pair(cache_key->digest[0], cache_key->digest[1]),
+                    std::vector<Response::Callback::CreateScanner>()));
+      if (!insert_result.second) {
+        insert_result.first->second.push_back(*cb);
+        range->decrement_scan_counter();
+        decrement_needed = false;
+        return;
+      }
+      coalesce_leader = true;
+    }
+
     std::set<uint8_t> columns;
     scan_ctx = make_shared<ScanContext>(range->get_scan_revision(cb->event()->header.timeout_ms),
                                &scan_spec, &range_spec, schema, &columns);
     scan_ctx->timeout_ms = cb->event()->header.timeout_ms;
+    scan_ctx->deadline = cb->event()->deadline();
 
     range->create_scanner(scan_ctx, scanner);
 
@@ -1526,7 +2018,30 @@ Apps::RangeServer::create_scanner(Response::Callback::CreateScanner *cb,
 
     uint32_t cell_count {};
 
-    more = FillScanBlock(scanner, rbuf, &cell_count, m_scanner_buffer_size);
+    // Reserve room in the scan block for the query cache key strings so a
+    // cacheable result can be handed to the query cache without a copy.
+    // Cacheable results are always generated in scan block format 1 since
+    // the cached block may later be served to clients that requested a
+    // different format.
+    size_t tail_reserve = 0;
+    if (cacheable) {
+      tail_reserve = strlen(scan_spec.cache_key()) + strlen(table.id) + 2;
+      scan_block_format = 1;
+    }
+
+    if (scan_spec.aggregation != ScanSpec::AGGREGATION_NONE) {
+      // Aggregation drains the scanner and reduces the matching cells to a
+      // single scalar cell; delta encoding buys nothing for one cell
+      scan_block_format = 1;
+      more = FillScanBlockAggregate(scanner, rbuf, &cell_count);
+    }
+    else
+      more = FillScanBlock(scanner, rbuf, &cell_count, m_scanner_buffer_size,
+                           scan_block_format, tail_reserve);
+
+    // Clear the deadline so background readahead and spill fills, which
+    // have no client waiting on them, are never cut short by it
+    scan_ctx->deadline = ClockT::time_point();
 
     profile_data.cells_scanned = scanner->get_input_cells();
     profile_data.cells_returned = scanner->get_output_cells();
@@ -1534,8 +2049,24 @@ Apps::RangeServer::create_scanner(Response::Callback::CreateScanner *cb,
     profile_data.bytes_returned = scanner->get_output_bytes();
     profile_data.disk_read = scanner->get_disk_read();
 
+    {
+      ScanContext *sctx = scanner->scan_context();
+      profile_data.blocks_read = sctx->blocks_read;
+      profile_data.block_cache_hits = sctx->block_cache_hits;
+      profile_data.bloom_filter_misses = sctx->bloom_filter_misses;
+      profile_data.cells_filtered_predicates = sctx->cells_filtered_predicates;
+      profile_data.cells_filtered_row_regexp = sctx->cells_filtered_row_regexp;
+      profile_data.cells_filtered_value_regexp = sctx->cells_filtered_value_regexp;
+      profile_data.bytes_decompressed = sctx->bytes_decompressed;
+    }
+
     int64_t output_cells = scanner->get_output_cells();
 
+    int64_t scan_latency = get_ts64() - scan_start_time;
+    Global::maintenance_throttle->record_scan_latency(scan_latency);
+    range->add_scan_latency(scan_latency / 1000);
+    Global::load_statistics->scan_latency().add(scan_latency / 1000);
+
     {
       lock_guard<LoadStatistics> lock(*Global::load_statistics);
       Global::load_statistics->add_scan_data(1,
@@ -1553,9 +2084,20 @@ Apps::RangeServer::create_scanner(Response::Callback::CreateScanner *cb,
     int skipped_rows = scanner->get_skipped_rows();
     int skipped_cells = scanner->get_skipped_cells();
 
+    // An unrestricted point read that returned nothing proves the row is
+    // absent; remember that so repeated misses cost one hash probe
+    if (point_row && !more && cell_count == 0 &&
+        scan_spec.columns.empty() && scan_spec.column_predicates.empty() &&
+        !scan_spec.row_regexp && !scan_spec.value_regexp &&
+        scan_spec.row_offset == 0 && scan_spec.cell_offset == 0 &&
+        scan_spec.time_interval.first == TIMESTAMP_MIN &&
+        scan_spec.time_interval.second == TIMESTAMP_MAX)
+      range->negative_cache_insert(point_row);
+
     if (more) {
       scan_ctx->deep_copy_specs();
-      id = m_scanner_map.put(scanner, range, table, profile_data);
+      id = m_scanner_map.put(scanner, range, table, profile_data,
+                             scan_block_format);
     }
     else {
       id = 0;
@@ -1572,31 +2114,97 @@ Apps::RangeServer::create_scanner(Response::Callback::CreateScanner *cb,
     /**
      *  Send back data
      */
-    if (cache_key && m_query_cache && !table.is_metadata() && !more) {
+    // Results larger than the table's QUERY_CACHE_MAX_ENTRY_SIZE are not
+    // worth the cache space they would evict
+    if (cacheable && !more &&
+        (schema->get_query_cache_max_entry_size() == 0 ||
+         (int64_t)rbuf.fill() <= schema->get_query_cache_max_entry_size())) {
       const char *cache_row_key = scan_spec.cache_key();
       char *row_key_ptr, *tablename_ptr;
-      uint8_t *buffer = new uint8_t [ rbuf.fill() + strlen(cache_row_key) + strlen(table.id) + 2 ];
-      memcpy(buffer, rbuf.base, rbuf.fill());
-      row_key_ptr = (char *)buffer + rbuf.fill();
+      uint32_t ext_len = rbuf.fill();
+      size_t tail_len = strlen(cache_row_key) + strlen(table.id) + 2;
+      boost::shared_array<uint8_t> ext_buffer;
+      HT_ASSERT(rbuf.remaining() >= tail_len);
+      if (ext_len + tail_len >= rbuf.size / 2) {
+        // FillScanBlock reserved room for the cache key strings, so a
+        // reasonably full scan block buffer can be adopted by the query
+        // cache and handed to the network layer without a copy
+        row_key_ptr = (char *)rbuf.ptr;
+        ext_buffer.reset(rbuf.release());
+      }
+      else {
+        // Right-size mostly empty buffers so the cache doesn't pin
+        // memory beyond what it accounts for
+        uint8_t *buffer = new uint8_t [ ext_len + tail_len ];
+        memcpy(buffer, rbuf.base, ext_len);
+        row_key_ptr = (char *)buffer + ext_len;
+        ext_buffer.reset(buffer);
+      }
       strcpy(row_key_ptr, cache_row_key);
       tablename_ptr = row_key_ptr + strlen(row_key_ptr) + 1;
       strcpy(tablename_ptr, table.id);
-      boost::shared_array<uint8_t> ext_buffer(buffer);
+      time_t expire_time = schema->get_query_cache_ttl() > 0 ?
+        time(0) + schema->get_query_cache_ttl() : 0;
       m_query_cache->insert(cache_key, tablename_ptr, row_key_ptr,
-                            columns, cell_count, ext_buffer, rbuf.fill());
+                            columns, cell_count, ext_buffer, ext_len,
+                            expire_time);
+      coalesce_buffer = ext_buffer;
+      coalesce_len = ext_len;
+      coalesce_shareable = true;
       if ((error = cb->response(id, skipped_rows, skipped_cells, false,
-                                profile_data, ext_buffer, rbuf.fill())) != Error::OK) {
+                                profile_data, ext_buffer, ext_len)) != Error::OK) {
         HT_ERRORF("Problem sending OK response - %s", Error::get_text(error));
       }
     }
     else {
       StaticBuffer ext(rbuf);
       if ((error = cb->response(id, skipped_rows, skipped_cells, more,
-                                profile_data, ext)) != Error::OK) {
+                                profile_data, ext,
+                                scan_block_format)) != Error::OK) {
         HT_ERRORF("Problem sending OK response - %s", Error::get_text(error));
       }
     }
 
+    // Start filling the next scan block while this one is in flight to the
+    // client
+    if (more) {
+      ScanBlockReadaheadPtr readahead;
+      if (m_scanner_map.get_readahead(id, readahead)) {
+        readahead->schedule();
+        m_app_queue->add(new Request::Handler::ReadaheadScanblock(this, id));
+      }
+    }
+
+    // Multicast the result to identical scans that attached while this one
+    // was in flight
+    if (coalesce_leader) {
+      std::vector<Response::Callback::CreateScanner> waiters;
+      {
+        lock_guard<mutex> lock(m_scan_coalesce_mutex);
+        auto iter = m_scan_coalesce_map.find(
+            make_pair(cache_key->digest[0], cache_key->digest[1]));
+        HT_ASSERT(iter != m_scan_coalesce_map.end());
+        waiters.swap(iter->second);
+        m_scan_coalesce_map.erase(iter);
+      }
+      coalesce_leader = false;
+      for (auto &waiter : waiters) {
+        if (coalesce_shareable) {
+          if ((error = waiter.response(0, skipped_rows, skipped_cells, false,
+                                       profile_data, coalesce_buffer,
+                                       coalesce_len)) != Error::OK)
+            HT_ERRORF("Problem sending OK response - %s",
+                      Error::get_text(error));
+        }
+        else
+          // The result could not be shared (the scan spilled past one scan
+          // block or was not cacheable after all), so the waiter gets its
+          // own scan
+          create_scanner(&waiter, table, range_spec, scan_spec, cache_key,
+                         scan_block_format);
+      }
+    }
+
   }
   catch (Hypertable::Exception &e) {
     int error;
@@ -1609,6 +2217,24 @@ Apps::RangeServer::create_scanner(Response::Callback::CreateScanner *cb,
       HT_ERROR_OUT << e << HT_END;
     if ((error = cb->error(e.code(), e.what())) != Error::OK)
       HT_ERRORF("Problem sending error response - %s", Error::get_text(error));
+
+    // An identical attached scan would hit the same error
+    if (coalesce_leader) {
+      std::vector<Response::Callback::CreateScanner> waiters;
+      {
+        lock_guard<mutex> lock(m_scan_coalesce_mutex);
+        auto iter = m_scan_coalesce_map.find(
+            make_pair(cache_key->digest[0], cache_key->digest[1]));
+        if (iter != m_scan_coalesce_map.end()) {
+          waiters.swap(iter->second);
+          m_scan_coalesce_map.erase(iter);
+        }
+      }
+      for (auto &waiter : waiters)
+        if ((error = waiter.error(e.code(), e.what())) != Error::OK)
+          HT_ERRORF("Problem sending error response - %s",
+                    Error::get_text(error));
+    }
   }
 }
 
@@ -1624,6 +2250,7 @@ Apps::RangeServer::fetch_scanblock(Response::Callback::CreateScanner *cb,
                                    int32_t scanner_id) {
   String errmsg;
   int error = Error::OK;
+  int64_t scan_start_time = get_ts64();
   MergeScannerRangePtr scanner;
   RangePtr range;
   bool more = true;
@@ -1633,12 +2260,14 @@ Apps::RangeServer::fetch_scanblock(Response::Callback::CreateScanner *cb,
   SchemaPtr schema;
   ProfileDataScanner profile_data_before;
   ProfileDataScanner profile_data;
+  uint8_t scan_block_format = 1;
 
   HT_DEBUG_OUT <<"Scanner ID = " << scanner_id << HT_END;
 
   try {
 
-    if (!m_scanner_map.get(scanner_id, scanner, range, scanner_table, &profile_data_before))
+    if (!m_scanner_map.get(scanner_id, scanner, range, scanner_table,
+                           &profile_data_before, &scan_block_format))
       HT_THROW(Error::RANGESERVER_INVALID_SCANNER_ID,
                format("scanner ID %d", scanner_id));
 
@@ -1660,15 +2289,50 @@ Apps::RangeServer::fetch_scanblock(Response::Callback::CreateScanner *cb,
 
     uint32_t cell_count {};
 
-    more = FillScanBlock(scanner, rbuf, &cell_count, m_scanner_buffer_size);
+    ScanBlockReadaheadPtr readahead;
+    ScanBlockSpoolPtr spool;
 
-    profile_data.cells_scanned = scanner->get_input_cells();
-    profile_data.cells_returned = scanner->get_output_cells();
-    profile_data.bytes_scanned = scanner->get_input_bytes();
-    profile_data.bytes_returned = scanner->get_output_bytes();
-    profile_data.disk_read = scanner->get_disk_read();
+    // Serve from the spill file if this scanner stalled and its remaining
+    // results were spooled to disk (see ScannerMap::spill_stalled).  The
+    // drained results were folded into the stored profile totals at spill
+    // time, so these fetches report a zero profile delta.
+    if (m_scanner_map.get_spool(scanner_id, spool) && !spool->exhausted()) {
+      spool->next(rbuf, &cell_count, &more);
+      profile_data = profile_data_before;
+    }
+    // Otherwise consume the scan block staged by the readahead task if one
+    // is available or in progress, or fill one synchronously
+    else if (!m_scanner_map.get_readahead(scanner_id, readahead) ||
+             !readahead->take(rbuf, &cell_count, &more, profile_data)) {
 
-    int64_t output_cells = scanner->get_output_cells();
+      // The client is waiting on this fill, so let the merge scanner
+      // abandon it if the request deadline passes
+      scanner->scan_context()->deadline = cb->event()->deadline();
+
+      more = FillScanBlock(scanner, rbuf, &cell_count, m_scanner_buffer_size,
+                           scan_block_format);
+
+      scanner->scan_context()->deadline = ClockT::time_point();
+
+      profile_data.cells_scanned = scanner->get_input_cells();
+      profile_data.cells_returned = scanner->get_output_cells();
+      profile_data.bytes_scanned = scanner->get_input_bytes();
+      profile_data.bytes_returned = scanner->get_output_bytes();
+      profile_data.disk_read = scanner->get_disk_read();
+
+      {
+        ScanContext *sctx = scanner->scan_context();
+        profile_data.blocks_read = sctx->blocks_read;
+        profile_data.block_cache_hits = sctx->block_cache_hits;
+        profile_data.bloom_filter_misses = sctx->bloom_filter_misses;
+        profile_data.cells_filtered_predicates = sctx->cells_filtered_predicates;
+        profile_data.cells_filtered_row_regexp = sctx->cells_filtered_row_regexp;
+        profile_data.cells_filtered_value_regexp = sctx->cells_filtered_value_regexp;
+        profile_data.bytes_decompressed = sctx->bytes_decompressed;
+      }
+    }
+
+    int64_t output_cells = profile_data.cells_returned;
 
     if (!more) {
       m_scanner_map.remove(scanner_id);
@@ -1677,10 +2341,19 @@ Apps::RangeServer::fetch_scanblock(Response::Callback::CreateScanner *cb,
     else
       m_scanner_map.update_profile_data(scanner_id, profile_data);
 
+    // Done advancing the merge scanner; let waiting fetch requests and
+    // spill drains at it
+    m_scanner_map.release(scanner_id);
+
     profile_data -= profile_data_before;
 
     //HT_INFOF("scanner=%d cell_count=%d %s", (int)scanner_id, (int)cell_count, profile_data.to_string().c_str());
 
+    int64_t scan_latency = get_ts64() - scan_start_time;
+    Global::maintenance_throttle->record_scan_latency(scan_latency);
+    range->add_scan_latency(scan_latency / 1000);
+    Global::load_statistics->scan_latency().add(scan_latency / 1000);
+
     {
       lock_guard<LoadStatistics> lock(*Global::load_statistics);
       Global::load_statistics->add_scan_data(0,
@@ -1700,7 +2373,8 @@ Apps::RangeServer::fetch_scanblock(Response::Callback::CreateScanner *cb,
      */
     {
       StaticBuffer ext(rbuf);
-      error = cb->response(scanner_id, 0, 0, more, profile_data, ext);
+      error = cb->response(scanner_id, 0, 0, more, profile_data, ext,
+                           scan_block_format);
       if (error != Error::OK)
         HT_ERRORF("Problem sending OK response - %s", Error::get_text(error));
 
@@ -1708,14 +2382,87 @@ Apps::RangeServer::fetch_scanblock(Response::Callback::CreateScanner *cb,
                 ext.size-4, (Lld)output_cells);
     }
 
+    // Start filling the next scan block while this one is in flight to the
+    // client
+    if (more && readahead) {
+      readahead->schedule();
+      m_app_queue->add(
+          new Request::Handler::ReadaheadScanblock(this, scanner_id));
+    }
+
   }
   catch (Hypertable::Exception &e) {
     HT_ERROR_OUT << e << HT_END;
+    // A deadline abandonment tears the scanner down; the client gave up
+    // on the request and will create a new scanner if it retries
+    if (e.code() == Error::REQUEST_TIMEOUT)
+      m_scanner_map.remove(scanner_id);
+    m_scanner_map.release(scanner_id);
     if (cb && (error = cb->error(e.code(), e.what())) != Error::OK)
       HT_ERRORF("Problem sending error response - %s", Error::get_text(error));
   }
 }
 
+void
+Apps::RangeServer::readahead_scanblock(int32_t scanner_id) {
+  MergeScannerRangePtr scanner;
+  RangePtr range;
+  TableIdentifierManaged scanner_table;
+  ProfileDataScanner accumulated_profile_data;
+  ProfileDataScanner profile_data;
+  uint8_t scan_block_format = 1;
+  ScanBlockReadaheadPtr readahead;
+
+  // The scanner may have been destroyed before this task ran
+  if (!m_scanner_map.get_readahead(scanner_id, readahead))
+    return;
+
+  // Acquire the scanner entry before claiming the fill; a spill drain
+  // holding the entry busy disarms pending fills with take(), and claiming
+  // the fill first would deadlock its take() against our wait in get()
+  if (!m_scanner_map.get(scanner_id, scanner, range, scanner_table,
+                         &accumulated_profile_data, &scan_block_format))
+    return;
+
+  // A fetch request or spill drain may have disarmed the fill while we
+  // waited for the entry
+  if (!readahead->start()) {
+    m_scanner_map.release(scanner_id);
+    return;
+  }
+
+  try {
+    DynamicBuffer dbuf;
+    uint32_t cell_count {};
+
+    bool more = FillScanBlock(scanner, dbuf, &cell_count,
+                              m_scanner_buffer_size, scan_block_format);
+
+    profile_data.cells_scanned = scanner->get_input_cells();
+    profile_data.cells_returned = scanner->get_output_cells();
+    profile_data.bytes_scanned = scanner->get_input_bytes();
+    profile_data.bytes_returned = scanner->get_output_bytes();
+    profile_data.disk_read = scanner->get_disk_read();
+
+    {
+      ScanContext *sctx = scanner->scan_context();
+      profile_data.blocks_read = sctx->blocks_read;
+      profile_data.block_cache_hits = sctx->block_cache_hits;
+      profile_data.bloom_filter_misses = sctx->bloom_filter_misses;
+      profile_data.cells_filtered_predicates = sctx->cells_filtered_predicates;
+      profile_data.cells_filtered_row_regexp = sctx->cells_filtered_row_regexp;
+      profile_data.cells_filtered_value_regexp = sctx->cells_filtered_value_regexp;
+      profile_data.bytes_decompressed = sctx->bytes_decompressed;
+    }
+
+    readahead->complete(dbuf, cell_count, more, profile_data);
+  }
+  catch (Hypertable::Exception &e) {
+    readahead->complete_error(e.code(), e.what());
+  }
+  m_scanner_map.release(scanner_id);
+}
+
 void
 Apps::RangeServer::load_range(ResponseCallback *cb, const TableIdentifier &table,
                               const RangeSpec &range_spec,
@@ -1914,8 +2661,43 @@ Apps::RangeServer::load_range(ResponseCallback *cb, const TableIdentifier &table
       this_thread::sleep_for(chrono::milliseconds(diff));
     }
 
+    // Warm handoff: if the source server staged a hot-block manifest in the
+    // transfer log directory, import it so the prewarm task queued below
+    // pulls exactly the blocks that were cache-resident on the source.  The
+    // manifest is removed before the transfer log is read so the commit log
+    // reader never sees it.
+    if (Global::block_cache && range_state.transfer_log &&
+        *range_state.transfer_log) {
+      String manifest_path = format("%s/hotblocks", range_state.transfer_log);
+      try {
+        if (Global::log_dfs->exists(manifest_path)) {
+          int64_t length = Global::log_dfs->length(manifest_path);
+          DynamicBuffer dbuf(length+1);
+          int32_t fd = Global::log_dfs->open(manifest_path, 0);
+          size_t nread = Global::log_dfs->read(fd, dbuf.base, length);
+          Global::log_dfs->close(fd);
+          Global::log_dfs->remove(manifest_path);
+          Global::block_cache->import_index(String((const char *)dbuf.base,
+                                                   nread), manifest_path);
+        }
+      }
+      catch (Exception &e) {
+        HT_WARNF("Problem importing hot block manifest %s - %s",
+                 manifest_path.c_str(), Error::get_text(e.code()));
+      }
+    }
+
     m_context->live_map->promote_staged_range(table, range, range_state.transfer_log);
 
+    // Queue a task to pull the range's hottest block data (sized by the
+    // prewarm hints written by the previous server) into the block cache
+    // before the range starts taking traffic
+    if (Global::block_cache && Global::maintenance_queue) {
+      auto schedule_time = chrono::steady_clock::now();
+      Global::maintenance_queue->add(
+        new MaintenanceTaskPrewarm(0, 0, schedule_time, range));
+    }
+
     HT_MAYBE_FAIL_X("user-load-range-4", !table.is_system());
     HT_MAYBE_FAIL_X("metadata-load-range-4", table.is_metadata());
 
@@ -2104,8 +2886,25 @@ Apps::RangeServer::update(Response::Callback::Update *cb, uint64_t cluster_id,
 
   schema = table_update->table_info->get_schema();
 
-  // Check for group commit
-  if (schema->get_group_commit_interval() > 0) {
+  // Admit USER table updates through the per-client throttle so
+  // backpressure under memory pressure degrades each writer in proportion
+  // to its ingest instead of stalling all updates wholesale
+  if (table.is_user())
+    m_update_throttle->admit(cb->event()->addr, table, buffer.size,
+                             cb->event()->deadline(),
+                             (m_timer_handler && m_timer_handler->low_memory_mode())
+                             || m_context->server_state->update_throttle());
+
+  // Tables declared DEFERRED_LOG_SYNC are acknowledged without waiting for
+  // a commit log sync, as if the client had passed the NO_LOG_SYNC flag
+  if (schema->get_deferred_log_sync())
+    flags |= Lib::RangeServer::Protocol::UPDATE_FLAG_NO_LOG_SYNC;
+
+  // Check for group commit (deferred sync tables always batch through it).
+  // Atomic batches bypass group commit; they must be qualified and
+  // committed as a single unit rather than merged with other requests
+  if ((schema->get_group_commit_interval() > 0 || schema->get_deferred_log_sync())
+      && (flags & Lib::RangeServer::Protocol::UPDATE_FLAG_ATOMIC) == 0) {
     group_commit_add(cb->event(), cluster_id, schema, table, count, buffer, flags);
     delete table_update;
     return;
@@ -2143,6 +2942,189 @@ Apps::RangeServer::update(Response::Callback::Update *cb, uint64_t cluster_id,
 
 }
 
+void
+Apps::RangeServer::compare_and_update(Response::Callback::Update *cb,
+    uint64_t cluster_id, const TableIdentifier &table, const String &row,
+    const String &column_family, const String &column_qualifier,
+    bool expect_missing, const String &expected_value, uint32_t count,
+    StaticBuffer &buffer, uint32_t flags) {
+  SchemaPtr schema;
+  TableInfoPtr table_info;
+  String guard_key = format("%s:%s", table.id, row.c_str());
+  bool guard_held = false;
+  bool decrement_needed = false;
+  RangePtr range;
+
+  HT_DEBUG_OUT <<"compare_and_update: "<< table <<" row="<< row << HT_END;
+
+  if (!m_log_replay_barrier->wait(cb->event()->deadline(), table))
+    return;
+
+  try {
+
+    if (!m_context->live_map->lookup(table.id, table_info))
+      HT_THROW(Error::TABLE_NOT_FOUND, table.id);
+
+    schema = table_info->get_schema();
+
+    // verify schema
+    if (schema->get_generation() != table.generation)
+      HT_THROWF(Error::RANGESERVER_GENERATION_MISMATCH,
+                "RangeServer Schema generation for table '%s'"
+                " is %lld but supplied is %lld",
+                table.id, (Lld)schema->get_generation(),
+                (Lld)table.generation);
+
+    if (table.is_user())
+      m_update_throttle->admit(cb->event()->addr, table, buffer.size,
+                               cb->event()->deadline(),
+                               (m_timer_handler && m_timer_handler->low_memory_mode())
+                               || m_context->server_state->update_throttle());
+
+    // Serialize compare-and-update operations on the same row.  The guard
+    // is released when the winning operation's update request is
+    // destroyed, which happens after the update pipeline has committed it
+    // and sent the response, so the read below always observes the
+    // previous operation's write.
+    {
+      unique_lock<mutex> lock(m_cas_mutex);
+      if (!m_cas_cond.wait_until(lock, cb->event()->deadline(),
+                                 [this, &guard_key]() {
+                                   return m_cas_rows.count(guard_key) == 0;
+                                 })) {
+        cb->error(Error::REQUEST_TIMEOUT,
+                  format("compare_and_update %s", guard_key.c_str()));
+        return;
+      }
+      m_cas_rows.insert(guard_key);
+      guard_held = true;
+    }
+
+    String start_row, end_row;
+    if (!table_info->find_containing_range(row, range, start_row, end_row))
+      HT_THROWF(Error::RANGESERVER_RANGE_NOT_FOUND, "%s row=%s",
+                table.id, row.c_str());
+
+    range->deferred_initialization(cb->event()->header.timeout_ms);
+
+    if (!range->increment_scan_counter())
+      HT_THROWF(Error::RANGESERVER_RANGE_NOT_FOUND,
+                "Range %s[%s..%s] dropped or relinquished",
+                table.id, start_row.c_str(), end_row.c_str());
+
+    decrement_needed = true;
+
+    // Read the current compare cell through a single-cell scan of the range
+    ScanSpecBuilder ssbuilder;
+    ssbuilder.add_row(row);
+    ssbuilder.add_column(column_family);
+    ssbuilder.set_max_versions(1);
+
+    RangeSpec range_spec(start_row.c_str(), end_row.c_str());
+    std::set<uint8_t> columns;
+    ScanContextPtr scan_ctx =
+      make_shared<ScanContext>(range->get_scan_revision(cb->event()->header.timeout_ms),
+                               &ssbuilder.get(), &range_spec, schema, &columns);
+    scan_ctx->timeout_ms = cb->event()->header.timeout_ms;
+
+    MergeScannerRangePtr scanner;
+    range->create_scanner(scan_ctx, scanner);
+
+    range->decrement_scan_counter();
+    decrement_needed = false;
+
+    Key key;
+    ByteString value;
+    bool found = false;
+    bool matched = false;
+
+    while (scanner->get(key, value)) {
+      const char *qualifier = key.column_qualifier ? key.column_qualifier : "";
+      if (!strcmp(qualifier, column_qualifier.c_str())) {
+        found = true;
+        const uint8_t *vptr;
+        size_t vlen = value.decode_length(&vptr);
+        matched = !expect_missing && vlen == expected_value.length() &&
+          memcmp(vptr, expected_value.data(), vlen) == 0;
+        break;
+      }
+      scanner->forward();
+    }
+
+    if (!found)
+      matched = expect_missing;
+
+    if (!matched) {
+      {
+        lock_guard<mutex> lock(m_cas_mutex);
+        m_cas_rows.erase(guard_key);
+        m_cas_cond.notify_all();
+      }
+      guard_held = false;
+      cb->error(Error::RANGESERVER_COMPARE_FAILED,
+                format("%s[%s] %s:%s", table.id, row.c_str(),
+                       column_family.c_str(), column_qualifier.c_str()));
+      return;
+    }
+
+    if (schema->get_deferred_log_sync())
+      flags |= Lib::RangeServer::Protocol::UPDATE_FLAG_NO_LOG_SYNC;
+
+    // The comparison succeeded; push the mutations through the normal
+    // update pipeline.  Group commit is bypassed because the row guard
+    // must be held until the mutations are committed.
+
+    UpdateRecTable *table_update = new UpdateRecTable();
+    table_update->table_info = table_info;
+    table_update->id = table;
+    table_update->total_count = count;
+    table_update->total_buffer_size = buffer.size;
+    table_update->flags = flags;
+    table_update->expire_time = cb->event()->deadline();
+
+    UpdateRequest *request = new UpdateRequest();
+    request->buffer = buffer;
+    request->count = count;
+    request->event = cb->event();
+    request->completion = [this, guard_key]() {
+      lock_guard<mutex> lock(m_cas_mutex);
+      m_cas_rows.erase(guard_key);
+      m_cas_cond.notify_all();
+    };
+    guard_held = false;
+
+    table_update->requests.push_back(request);
+
+    std::vector<UpdateRecTable *> table_update_vector;
+    table_update_vector.push_back(table_update);
+
+    UpdateContext *uc = new UpdateContext(table_update_vector, table_update->expire_time);
+
+    if (table.is_user())
+      m_update_pipeline_user->add(uc);
+    else if (table.is_metadata())
+      m_update_pipeline_metadata->add(uc);
+    else {
+      HT_ASSERT(table.is_system());
+      m_update_pipeline_system->add(uc);
+    }
+
+  }
+  catch (Exception &e) {
+    int error;
+    if (decrement_needed)
+      range->decrement_scan_counter();
+    if (guard_held) {
+      lock_guard<mutex> lock(m_cas_mutex);
+      m_cas_rows.erase(guard_key);
+      m_cas_cond.notify_all();
+    }
+    HT_ERROR_OUT << "Exception caught: " << e << HT_END;
+    if ((error = cb->error(e.code(), e.what())) != Error::OK)
+      HT_ERRORF("Problem sending error response - %s", Error::get_text(error));
+  }
+}
+
 void
 Apps::RangeServer::batch_update(std::vector<UpdateRecTable *> &updates,
                                 ClockT::time_point expire_time) {
@@ -2289,6 +3271,18 @@ void Apps::RangeServer::dump(ResponseCallback *cb, const char *outfile,
 
     out << str;
 
+    // Sampled request traces
+    if (RequestTracer::enabled()) {
+      out << "\nRequest Traces:\n";
+      RequestTracer::instance->dump(out);
+    }
+
+    out << "\nThread Activity:\n";
+    ThreadActivity::dump(out);
+
+    out << "\nAllocation Breakdown:\n";
+    AllocationTracker::dump(out);
+
   }
   catch (Hypertable::Exception &e) {
     HT_ERROR_OUT << e << HT_END;
@@ -2302,6 +3296,83 @@ void Apps::RangeServer::dump(ResponseCallback *cb, const char *outfile,
   cb->response_ok();
 }
 
+void Apps::RangeServer::get_live_state(Response::Callback::GetLiveState *cb) {
+  String str;
+  uint64_t max_memory, available, accesses, hits;
+
+  HT_INFO("get_live_state");
+
+  try {
+
+    if (Global::block_cache) {
+      Global::block_cache->get_stats(&max_memory, &available, &accesses, &hits);
+      str += format("Block Cache: max=%llu available=%llu accesses=%llu "
+                    "hits=%llu (%.2f%%)\n", (Llu)max_memory, (Llu)available,
+                    (Llu)accesses, (Llu)hits,
+                    accesses ? ((double)hits/(double)accesses)*100.0 : 0.0);
+    }
+
+    if (Global::compressed_block_cache) {
+      Global::compressed_block_cache->get_stats(&max_memory, &available,
+                                                &accesses, &hits);
+      str += format("Compressed Block Cache: max=%llu available=%llu "
+                    "accesses=%llu hits=%llu (%.2f%%)\n", (Llu)max_memory,
+                    (Llu)available, (Llu)accesses, (Llu)hits,
+                    accesses ? ((double)hits/(double)accesses)*100.0 : 0.0);
+    }
+
+    if (m_query_cache) {
+      int32_t waiters;
+      m_query_cache->get_stats(&max_memory, &available, &accesses, &hits,
+                               &waiters);
+      str += format("Query Cache: max=%llu available=%llu accesses=%llu "
+                    "hits=%llu (%.2f%%) waiters=%d\n", (Llu)max_memory,
+                    (Llu)available, (Llu)accesses, (Llu)hits,
+                    accesses ? ((double)hits/(double)accesses)*100.0 : 0.0,
+                    (int)waiters);
+    }
+
+    {
+      int32_t scanner_count {};
+      CstrToInt32Map table_scanner_count_map;
+      m_scanner_map.get_counts(&scanner_count, table_scanner_count_map);
+      str += format("Outstanding Scanners: %d\n", (int)scanner_count);
+    }
+
+    if (Global::maintenance_queue)
+      str += format("Maintenance Queue Backlog: %d\n",
+                    (int)Global::maintenance_queue->size());
+
+    str += "Allocation Breakdown:\n";
+    for (int i=0; i<AllocationTracker::SUBSYSTEM_COUNT; i++) {
+      AllocationTracker::Subsystem subsystem = (AllocationTracker::Subsystem)i;
+      str += format("  %s %lld\n", AllocationTracker::subsystem_name(subsystem),
+                    (Lld)AllocationTracker::usage(subsystem));
+    }
+
+    // Per-range memory usage
+    Ranges ranges;
+    m_context->live_map->get_ranges(ranges);
+    time_t now = time(0);
+    str += format("Ranges: %d\n", (int)ranges.array.size());
+    for (auto &rd : ranges.array) {
+      rd.data = rd.range->get_maintenance_data(ranges.arena, now, 0);
+      str += format("  %s cells=%llu mem_used=%llu mem_allocated=%llu "
+                    "disk=%llu scans=%llu\n", rd.range->get_name().c_str(),
+                    (Llu)rd.data->cell_count, (Llu)rd.data->memory_used,
+                    (Llu)rd.data->memory_allocated, (Llu)rd.data->disk_used,
+                    (Llu)rd.data->load_factors.scans);
+    }
+  }
+  catch (Hypertable::Exception &e) {
+    HT_ERROR_OUT << e << HT_END;
+    cb->error(e.code(), "Problem executing get_live_state() command");
+    return;
+  }
+
+  cb->response(str);
+}
+
 void
 Apps::RangeServer::dump_pseudo_table(ResponseCallback *cb, const TableIdentifier &table,
                                const char *pseudo_table, const char *outfile) {
@@ -2486,6 +3557,7 @@ void
   m_context->server_state->set(generation, specs);
 
   Global::load_statistics->recompute(&load_stats);
+  Global::maintenance_throttle->update();
   m_stats->system.refresh();
 
   float period_seconds = (float)load_stats.period_millis / 1000.0;
@@ -2515,10 +3587,20 @@ void
   m_stats->updated_bytes = load_stats.update_bytes;
   m_stats->sync_count = load_stats.sync_count;
   m_stats->tracked_memory = Global::memory_tracker->balance();
+
+  // Sample per-subsystem allocation counters for the leak watch
+  AllocationTracker::leak_check();
   m_stats->cpu_user = m_stats->system.cpu_stat.user;
   m_stats->cpu_sys = m_stats->system.cpu_stat.sys;
   m_stats->live = m_log_replay_barrier->user_complete();
 
+  if (m_selftest_results.write_rate) {
+    m_stats->enable_selftest_group();
+    m_stats->selftest_write_rate = m_selftest_results.write_rate;
+    m_stats->selftest_read_rate = m_selftest_results.read_rate;
+    m_stats->selftest_scan_rate = m_selftest_results.scan_rate;
+  }
+
   uint64_t previous_query_cache_accesses = m_stats->query_cache_accesses;
   uint64_t previous_query_cache_hits = m_stats->query_cache_hits;
   uint64_t previous_block_cache_accesses = m_stats->block_cache_accesses;
@@ -2668,6 +3750,19 @@ void
     m_stats->file_count += m_stats->tables[i].file_count;
   }
 
+  // merge in per-table query cache statistics
+  if (m_query_cache) {
+    QueryCache::TableStatsMap qc_stats = m_query_cache->get_table_stats();
+    for (auto &table : m_stats->tables) {
+      auto iter = qc_stats.find(table.table_id);
+      if (iter != qc_stats.end()) {
+        table.query_cache_hits = iter->second.hits;
+        table.query_cache_misses = iter->second.misses;
+        table.query_cache_evictions = iter->second.evictions;
+      }
+    }
+  }
+
   /**
    * If created a mutator above, write data to sys/RS_METRICS
    */
@@ -2752,6 +3847,19 @@ void
   m_ganglia_collector->update("compactions.merging", load_stats.compactions_merging);
   m_ganglia_collector->update("compactions.gc", load_stats.compactions_gc);
 
+  m_ganglia_collector->update("latency.scan.p50",
+                            (float)load_stats.scan_latency_p50 / 1000.0);
+  m_ganglia_collector->update("latency.scan.p99",
+                            (float)load_stats.scan_latency_p99 / 1000.0);
+  m_ganglia_collector->update("latency.update.p50",
+                            (float)load_stats.update_latency_p50 / 1000.0);
+  m_ganglia_collector->update("latency.update.p99",
+                            (float)load_stats.update_latency_p99 / 1000.0);
+  m_ganglia_collector->update("latency.sync.p50",
+                            (float)load_stats.sync_latency_p50 / 1000.0);
+  m_ganglia_collector->update("latency.sync.p99",
+                            (float)load_stats.sync_latency_p99 / 1000.0);
+
   m_ganglia_collector->update("scanners",
                             m_stats->scanner_count);
   m_ganglia_collector->update("cellstores",
@@ -2999,6 +4107,7 @@ void Apps::RangeServer::replay_fragments(ResponseCallback *cb, int64_t op_id,
     }
 
     replay_buffer.flush();
+    replay_buffer.wait_for_completion();
 
     HT_MAYBE_FAIL_X("replay-fragments-user-1", type==RangeSpec::USER);
 
@@ -3648,8 +4757,14 @@ void Apps::RangeServer::verify_schema(TableInfoPtr &table_info, uint32_t generat
     if (!schema) {
       String tablefile = Global::toplevel_dir + "/tables/"
           + table_info->identifier().id;
-      m_hyperspace->attr_get(tablefile, "schema", valbuf);
-      schema.reset( Schema::new_instance((const char *)valbuf.base) );
+      bool bin_exists {};
+      m_hyperspace->attr_get(tablefile, "schema_bin", bin_exists, valbuf);
+      if (bin_exists)
+        schema.reset( Schema::new_instance(valbuf.base, valbuf.fill()) );
+      else {
+        m_hyperspace->attr_get(tablefile, "schema", valbuf);
+        schema.reset( Schema::new_instance((const char *)valbuf.base) );
+      }
     }
 
     table_info->update_schema(schema);
@@ -3676,6 +4791,17 @@ void Apps::RangeServer::do_maintenance() {
     // Purge expired scanners
     m_scanner_map.purge_expired(m_scanner_ttl);
 
+    // Spill scan blocks of stalled scanners to disk
+    if (m_scanner_spill_delay > 0)
+      m_scanner_map.spill_stalled(m_scanner_spill_delay,
+                                  m_scanner_buffer_size,
+                                  m_scanner_spill_budget,
+                                  m_scanner_spill_directory);
+
+    // Publish METADATA range locations for client cache warming
+    if (m_root_publish_locations)
+      publish_root_range_locations();
+
     // Set Low Memory mode
     bool low_memory_mode = m_timer_handler->low_memory_mode();
     m_maintenance_scheduler->set_low_memory_mode(low_memory_mode);
@@ -3716,6 +4842,104 @@ void Apps::RangeServer::do_maintenance() {
   HT_INFOF("Memory Usage: %llu bytes", (Llu)Global::memory_tracker->balance());
 }
 
+void Apps::RangeServer::publish_root_range_locations() {
+  TableInfoPtr table_info;
+  RangePtr range;
+  String start_row, end_row;
+
+  if (!m_context->live_map->lookup(TableIdentifier::METADATA_ID, table_info) ||
+      !table_info->find_containing_range(Key::END_ROOT_ROW, range,
+                                         start_row, end_row) ||
+      end_row != Key::END_ROOT_ROW)
+    return;
+
+  SchemaPtr schema = table_info->get_schema();
+  uint8_t startrow_cid = schema->get_column_family("StartRow")->get_id();
+  uint8_t location_cid = schema->get_column_family("Location")->get_id();
+
+  RangeSpec range_spec(start_row.c_str(), end_row.c_str());
+  ScanSpec scan_spec;
+  scan_spec.max_versions = 1;
+  scan_spec.columns.push_back("StartRow");
+  scan_spec.columns.push_back("Location");
+
+  MergeScannerRangePtr scanner;
+
+  if (!range->increment_scan_counter())
+    return;
+  try {
+    ScanContextPtr scan_ctx =
+      make_shared<ScanContext>(range->get_scan_revision(m_scanner_ttl),
+                               &scan_spec, &range_spec, schema);
+    range->create_scanner(scan_ctx, scanner);
+  }
+  catch (Exception &e) {
+    range->decrement_scan_counter();
+    HT_WARNF("Problem scanning root METADATA range for location publishing "
+             "- %s", Error::get_text(e.code()));
+    return;
+  }
+  range->decrement_scan_counter();
+
+  // The row keys of the root range are "0:<end row>"; collect the start
+  // row and location of each second-level METADATA range, keyed by end
+  // row so the payload is stable across scans
+  std::map<String, String> start_rows, locations;
+  Key key;
+  ByteString value;
+  while (scanner->get(key, value)) {
+    const char *stripped_key = strchr(key.row, ':');
+    if (stripped_key) {
+      stripped_key++;
+      const uint8_t *str;
+      size_t len = value.decode_length(&str);
+      if (key.column_family_code == startrow_cid)
+        start_rows[stripped_key] = String((const char *)str, len);
+      else if (key.column_family_code == location_cid)
+        locations[stripped_key] = String((const char *)str, len);
+    }
+    scanner->forward();
+  }
+
+  size_t count {};
+  size_t length = 4;
+  for (auto &entry : locations) {
+    auto iter = start_rows.find(entry.first);
+    if (iter == start_rows.end() || entry.second.empty() ||
+        entry.second[0] == '!')
+      continue;
+    count++;
+    length += Serialization::encoded_length_vstr(entry.first)
+      + Serialization::encoded_length_vstr(iter->second)
+      + Serialization::encoded_length_vstr(entry.second);
+  }
+
+  DynamicBuffer dbuf(length);
+  Serialization::encode_i32(&dbuf.ptr, count);
+  for (auto &entry : locations) {
+    auto iter = start_rows.find(entry.first);
+    if (iter == start_rows.end() || entry.second.empty() ||
+        entry.second[0] == '!')
+      continue;
+    Serialization::encode_vstr(&dbuf.ptr, entry.first);
+    Serialization::encode_vstr(&dbuf.ptr, iter->second);
+    Serialization::encode_vstr(&dbuf.ptr, entry.second);
+  }
+
+  String payload((const char *)dbuf.base, dbuf.fill());
+  if (payload == m_published_root_locations)
+    return;
+
+  uint64_t handle = 0;
+  HT_ON_SCOPE_EXIT(&Hyperspace::close_handle_ptr, Global::hyperspace, &handle);
+  String root_filename = Global::toplevel_dir + "/root";
+  handle = m_hyperspace->open(root_filename, OPEN_FLAG_READ|OPEN_FLAG_WRITE);
+  Global::hyperspace->attr_set(handle, "RangeLocations", dbuf.base,
+                               dbuf.fill());
+  m_published_root_locations = payload;
+  HT_INFOF("Published %d METADATA range locations to Hyperspace", (int)count);
+}
+
 void
 Apps::RangeServer::group_commit_add(EventPtr &event, uint64_t cluster_id,
                               SchemaPtr &schema, const TableIdentifier &table,
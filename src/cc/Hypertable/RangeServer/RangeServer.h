@@ -30,6 +30,7 @@
 #include <Hypertable/RangeServer/Global.h>
 #include <Hypertable/RangeServer/GroupCommitInterface.h>
 #include <Hypertable/RangeServer/GroupCommitTimerHandler.h>
+#include <Hypertable/RangeServer/LivenessGossipHandler.h>
 #include <Hypertable/RangeServer/LoadStatistics.h>
 #include <Hypertable/RangeServer/LogReplayBarrier.h>
 #include <Hypertable/RangeServer/MaintenanceScheduler.h>
@@ -38,15 +39,18 @@
 #include <Hypertable/RangeServer/QueryCache.h>
 #include <Hypertable/RangeServer/Response/Callback/AcknowledgeLoad.h>
 #include <Hypertable/RangeServer/Response/Callback/CreateScanner.h>
+#include <Hypertable/RangeServer/Response/Callback/GetLiveState.h>
 #include <Hypertable/RangeServer/Response/Callback/GetStatistics.h>
 #include <Hypertable/RangeServer/Response/Callback/PhantomUpdate.h>
 #include <Hypertable/RangeServer/Response/Callback/Status.h>
 #include <Hypertable/RangeServer/Response/Callback/Update.h>
 #include <Hypertable/RangeServer/ScannerMap.h>
+#include <Hypertable/RangeServer/StartupSelfTest.h>
 #include <Hypertable/RangeServer/TableInfo.h>
 #include <Hypertable/RangeServer/TableInfoMap.h>
 #include <Hypertable/RangeServer/TimerHandler.h>
 #include <Hypertable/RangeServer/UpdatePipeline.h>
+#include <Hypertable/RangeServer/UpdateThrottle.h>
 
 #include <Hypertable/Lib/Cells.h>
 #include <Hypertable/Lib/Master/Client.h>
@@ -66,15 +70,21 @@
 #include <AsyncComm/Event.h>
 #include <AsyncComm/ResponseCallback.h>
 
+#include <Common/Cronolog.h>
 #include <Common/Filesystem.h>
 #include <Common/Logger.h>
 #include <Common/MetricsCollectorGanglia.h>
 #include <Common/MetricsProcess.h>
 #include <Common/Properties.h>
 
+#include <atomic>
+#include <condition_variable>
 #include <map>
 #include <memory>
 #include <mutex>
+#include <set>
+#include <utility>
+#include <vector>
 
 using namespace Hyperspace::Lib;
 using namespace Hyperspace;
@@ -100,12 +110,34 @@ namespace Apps {
     // range server protocol implementations
     void compact(ResponseCallback *, const TableIdentifier &,
                  const char *row, int32_t flags);
+    void adopt_cellstore(ResponseCallback *, const TableIdentifier &,
+                         const RangeSpec &, const char *ag_name,
+                         const char *source_file);
     void create_scanner(Response::Callback::CreateScanner *,
                         const TableIdentifier &,
                         const  RangeSpec &, const ScanSpec &,
-                        QueryCache::Key *);
+                        QueryCache::Key *, uint8_t scan_block_format = 1);
+
+    /// Attempts to answer a scan request from the query cache without
+    /// blocking.  Used by the inline fast path that runs on the reactor
+    /// thread, so every condition that the full create_scanner() path
+    /// handles by blocking or by generating an error response (log replay
+    /// in progress, range uninitialized, schema generation mismatch, range
+    /// moved or shrunk) causes this method to decline the request instead,
+    /// leaving it for the application queue.
+    /// @return <i>true</i> if the request was answered from the cache
+    bool create_scanner_from_cache(Response::Callback::CreateScanner *,
+                                   const TableIdentifier &,
+                                   const RangeSpec &, QueryCache::Key *);
     void destroy_scanner(ResponseCallback *cb, int32_t scanner_id);
     void fetch_scanblock(Response::Callback::CreateScanner *, int32_t scanner_id);
+
+    /// Fills the next scan block for scanner <code>scanner_id</code> into
+    /// its ScanBlockReadahead staging object.  Called by the
+    /// Request::Handler::ReadaheadScanblock application queue task; does
+    /// nothing unless the fill is still armed (see
+    /// ScanBlockReadahead::start()).
+    void readahead_scanblock(int32_t scanner_id);
     void load_range(ResponseCallback *, const TableIdentifier &,
                     const RangeSpec &, const RangeState &,
                     bool needs_compaction);
@@ -119,6 +151,25 @@ namespace Apps {
     void update(Response::Callback::Update *cb, uint64_t cluster_id,
                 const TableIdentifier &table, uint32_t count,
                 StaticBuffer &buffer, uint32_t flags);
+
+    /** Conditionally inserts data into a table.  The update buffer is
+     * applied through the normal update pipeline only if the compare cell
+     * identified by <code>row</code>, <code>column_family</code> and
+     * <code>column_qualifier</code> currently holds
+     * <code>expected_value</code> (or is absent, if
+     * <code>expect_missing</code> is set).  Concurrent compare-and-update
+     * operations on the same row are serialized against one another;
+     * plain updates are not held back and retain last-writer-wins
+     * semantics.  A failed comparison is reported to the client as
+     * Error::RANGESERVER_COMPARE_FAILED.
+     */
+    void compare_and_update(Response::Callback::Update *cb,
+                            uint64_t cluster_id, const TableIdentifier &table,
+                            const String &row, const String &column_family,
+                            const String &column_qualifier,
+                            bool expect_missing, const String &expected_value,
+                            uint32_t count, StaticBuffer &buffer,
+                            uint32_t flags);
     void batch_update(std::vector<UpdateRecTable *> &updates,
                       ClockT::time_point expire_time);
 
@@ -131,6 +182,13 @@ namespace Apps {
 
     void dump(ResponseCallback *, const char *, bool);
 
+    /** Returns a formatted report of live server state.  The report
+     * summarizes the block and query caches, outstanding scanners,
+     * maintenance queue backlog and per-range memory usage, and is
+     * returned over the wire for interactive display (see ht_rsclient).
+     */
+    void get_live_state(Response::Callback::GetLiveState *cb);
+
     /** @deprecated */
     void dump_pseudo_table(ResponseCallback *cb, const TableIdentifier &table,
                            const char *pseudo_table, const char *outfile);
@@ -233,8 +291,23 @@ namespace Apps {
                                   TableSchemaMap &table_schemas);
     void replay_load_range(TableInfoMap &replay_map,
                            MetaLogEntityRangePtr &range_entity);
+    void replay_load_ranges(TableInfoMap &replay_map,
+                            std::vector<MetaLogEntityRangePtr> &range_entities);
     void replay_log(TableInfoMap &replay_map, CommitLogReaderPtr &log_reader);
 
+    /// Checks whether the cell cache handoff covers the commit logs.
+    /// @return <i>true</i> if a valid handoff manifest was loaded and every
+    /// manifest-listed checkpoint encountered so far has been restored
+    bool cell_cache_handoff_complete();
+
+    /// Reads a commit log without re-inserting its cells.
+    /// Used in place of replay_log() when cell cache checkpoints already
+    /// hold every cell the log would contribute; iterating the blocks still
+    /// assigns fragment revisions and discovers linked transfer logs, both
+    /// of which the successor commit log needs for correct pruning.
+    /// @param log_reader Commit log reader
+    void skim_log(CommitLogReaderPtr &log_reader);
+
     void verify_schema(TableInfoPtr &, uint32_t generation, const TableSchemaMap *table_schemas=0);
 
     bool live(const vector<QualifiedRangeSpec> &ranges);
@@ -244,6 +317,24 @@ namespace Apps {
                           SchemaPtr &schema, const TableIdentifier &table,
                           uint32_t count, StaticBuffer &buffer, uint32_t flags);
 
+    /// Publishes the contents of the root METADATA range to Hyperspace.
+    /// If this server holds the root METADATA range, scans it and writes
+    /// the (end row, start row, location) triplets of the second-level
+    /// METADATA ranges to the <i>RangeLocations</i> attribute of the
+    /// Hyperspace root file.  Clients warm their location cache from that
+    /// attribute when they read the root location, satisfying most
+    /// location lookups without scanning the root range (see
+    /// RangeLocator::read_root_location()).  The attribute is only
+    /// rewritten when the contents change.
+    void publish_root_range_locations();
+
+    /// Writes a sampled scan request to the scan access log.  Each record
+    /// is the table name followed by the base64-encoded binary ScanSpec,
+    /// suitable for shadow replay by ht_scan_replay to warm a standby
+    /// server's caches.
+    void log_scan_access(const TableIdentifier &table,
+                         const ScanSpec &scan_spec);
+
     /** Performs a "test and set" operation on #m_get_statistics_outstanding
      * @param value New value for #m_get_statistics_outstanding
      * @return Previous value of #m_get_statistics_outstanding
@@ -268,6 +359,9 @@ namespace Apps {
     /// Update pipeline for USER tables
     UpdatePipelinePtr m_update_pipeline_user;
 
+    /// Per-client admission control for USER table updates
+    UpdateThrottlePtr m_update_throttle;
+
     /// Flush method for METADATA commit log updates
     Filesystem::Flags m_log_flush_method_meta {};
 
@@ -309,6 +403,9 @@ namespace Apps {
     StatsRangeServerPtr    m_stats;
     LoadStatisticsPtr      m_load_statistics;
 
+    /// Rates measured by the startup self-test (zero if it did not run)
+    StartupSelfTest::Results m_selftest_results;
+
     /// Timestamp (nanoseconds) of last metrics collection
     int64_t m_stats_last_timestamp {};
 
@@ -326,8 +423,62 @@ namespace Apps {
 
     GroupCommitInterfacePtr m_group_commit;
     GroupCommitTimerHandlerPtr m_group_commit_timer_handler;
+    LivenessGossipHandlerPtr m_liveness_gossip_handler;
     QueryCachePtr m_query_cache;
+
+    /// %Mutex guarding #m_scan_coalesce_map
+    std::mutex m_scan_coalesce_mutex;
+
+    /// In-flight cacheable scans, keyed by query cache key.  Identical
+    /// concurrent scans attach their response callbacks here and the first
+    /// scan multicasts its result to them when it completes.
+    std::map<std::pair<uint64_t, uint64_t>,
+             std::vector<Response::Callback::CreateScanner>> m_scan_coalesce_map;
+
+    /// %Mutex guarding #m_cas_rows
+    std::mutex m_cas_mutex;
+
+    /// Condition variable signalling removals from #m_cas_rows
+    std::condition_variable m_cas_cond;
+
+    /// Rows (keyed by "<table-id>:<row>") with a compare-and-update
+    /// operation in flight; used to serialize compare-and-update
+    /// operations on the same row
+    std::set<String> m_cas_rows;
+
+    /// Local file in which the block cache index is persisted across
+    /// restarts (empty disables persistence)
+    String m_block_cache_index_path;
+
+    /// Sampled scan-request log used for shadow replay warming
+    Cronolog *m_scan_access_log {};
+
+    /// Count of scan requests considered for the scan access log
+    std::atomic<uint64_t> m_scan_access_counter {};
+
+    /// Log one of every this many scan requests
+    int32_t m_scan_access_sample_rate {1};
+
     int64_t m_scanner_buffer_size {};
+
+    /// Milliseconds of inactivity before a scanner's remaining results are
+    /// spilled to disk (0 disables spilling)
+    int32_t m_scanner_spill_delay {};
+
+    /// Maximum spill file size, in bytes, per stalled scanner
+    int64_t m_scanner_spill_budget {};
+
+    /// Local directory in which scanner spill files are created
+    String m_scanner_spill_directory;
+
+    /// Whether to publish METADATA range locations to Hyperspace when this
+    /// server holds the root METADATA range
+    bool m_root_publish_locations {};
+
+    /// Copy of the most recently published METADATA range location payload,
+    /// used to skip the Hyperspace write when the contents are unchanged
+    String m_published_root_locations;
+
     time_t m_last_metrics_update {};
     time_t m_next_metrics_update {};
     double m_loadavg_accum {};
@@ -0,0 +1,99 @@
+/* -*- c++ -*-
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 3 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/// @file
+/// Declarations for ReadaheadBudget.
+/// This file contains the type declarations for ReadaheadBudget, a class
+/// that apportions a server-wide readahead byte budget among concurrent
+/// readahead scanners.
+
+#ifndef Hypertable_RangeServer_ReadaheadBudget_h
+#define Hypertable_RangeServer_ReadaheadBudget_h
+
+#include <algorithm>
+#include <mutex>
+
+namespace Hypertable {
+
+  /// @addtogroup RangeServer
+  /// @{
+
+  /// Apportions a server-wide readahead byte budget among concurrent
+  /// readahead scanners.  Each readahead scanner reserves an allowance at
+  /// construction and releases it at destruction.  When many scanners run
+  /// concurrently the budget shrinks each scanner's readahead buffer rather
+  /// than letting the aggregate in-flight bytes grow with the scanner count,
+  /// which keeps broker I/O and the OS page cache from being oversubscribed
+  /// by seek storms.  Reservations never block and never fall below the
+  /// caller-supplied minimum, so scans always make progress.
+  class ReadaheadBudget {
+  public:
+
+    /// Constructor.
+    /// @param total Total readahead bytes allowed in flight server-wide
+    ReadaheadBudget(int64_t total) : m_total(total) { }
+
+    /// Reserves a readahead allowance.
+    /// Grants <code>preferred</code> bytes when the budget allows, otherwise
+    /// whatever remains of the budget, but never less than
+    /// <code>minimum</code>.
+    /// @param preferred Readahead bytes the scanner would like to use
+    /// @param minimum Smallest usable allowance (typically one block)
+    /// @return Bytes granted, to be returned via release()
+    int64_t acquire(int64_t preferred, int64_t minimum) {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      int64_t grant = std::max(std::min(preferred, m_total - m_outstanding),
+                               minimum);
+      m_outstanding += grant;
+      return grant;
+    }
+
+    /// Returns a previously acquired allowance to the budget.
+    /// @param bytes Grant returned by acquire()
+    void release(int64_t bytes) {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_outstanding -= bytes;
+    }
+
+    /// Returns readahead bytes currently reserved.
+    /// @return Outstanding reservation total
+    int64_t outstanding() {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      return m_outstanding;
+    }
+
+  private:
+
+    /// %Mutex to serialize concurrent access
+    std::mutex m_mutex;
+
+    /// Total readahead bytes allowed in flight
+    int64_t m_total;
+
+    /// Readahead bytes currently reserved
+    int64_t m_outstanding {};
+  };
+
+  /// @}
+
+} // namespace Hypertable
+
+#endif // Hypertable_RangeServer_ReadaheadBudget_h
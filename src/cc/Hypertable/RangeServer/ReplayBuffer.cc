@@ -24,6 +24,8 @@
 #include "ReplayBuffer.h"
 #include "ReplayDispatchHandler.h"
 
+#include <Common/Logger.h>
+
 using namespace std;
 using namespace Hypertable;
 using namespace Hypertable::Lib;
@@ -82,8 +84,27 @@ void ReplayBuffer::add(const TableIdentifier &table, SerializedKey &key,
   }
 }
 
+ReplayBuffer::~ReplayBuffer() {
+  try {
+    wait_for_completion();
+  }
+  catch (Exception &e) {
+    HT_ERROR_OUT << e << HT_END;
+  }
+}
+
 void ReplayBuffer::flush() {
-  ReplayDispatchHandler handler(m_comm, m_location, m_plan_generation, m_timeout_ms);
+
+  // Wait for the previously dispatched batch before sending the next one.
+  // Keeping one batch in flight overlaps fragment reading and decompression
+  // with the receiver round trips instead of stalling on every flush.
+  wait_for_completion();
+
+  if (m_memory_used == 0)
+    return;
+
+  m_outstanding.reset(new ReplayDispatchHandler(m_comm, m_location,
+                                                m_plan_generation, m_timeout_ms));
 
   for (auto &vv : m_buffer_map) {
 
@@ -93,12 +114,17 @@ void ReplayBuffer::flush() {
       QualifiedRangeSpec &range = buffer.get_range();
       StaticBuffer updates;
       buffer.get_updates(updates);
-      handler.add(addr, range, m_fragment, updates);
+      m_outstanding->add(addr, range, m_fragment, updates);
       buffer.clear();
     }
   }
 
-  handler.wait_for_completion();
-
   m_memory_used=0;
 }
+
+void ReplayBuffer::wait_for_completion() {
+  if (m_outstanding) {
+    unique_ptr<ReplayDispatchHandler> handler(m_outstanding.release());
+    handler->wait_for_completion();
+  }
+}
@@ -33,9 +33,12 @@
 #include <Common/Properties.h>
 
 #include <map>
+#include <memory>
 
 namespace Hypertable {
 
+  class ReplayDispatchHandler;
+
   using namespace Lib;
   using namespace std;
 
@@ -44,7 +47,9 @@ namespace Hypertable {
     ReplayBuffer(PropertiesPtr &props, Comm *comm,
                  const RangeServerRecovery::ReceiverPlan &plan, const String &location,
                  int32_t plan_generation);
-    
+
+    ~ReplayBuffer();
+
     void add(const TableIdentifier &table, SerializedKey &key,
              ByteString &value);
 
@@ -56,6 +61,10 @@ namespace Hypertable {
 
     void flush();
 
+    /// Waits for the batch dispatched by the last flush() call, re-throwing
+    /// any error reported by a receiver.
+    void wait_for_completion();
+
   private:
 
     Comm *m_comm;
@@ -69,6 +78,7 @@ namespace Hypertable {
     size_t m_flush_limit_per_range {};
     int32_t m_timeout_ms {};
     uint32_t m_fragment {};
+    std::unique_ptr<ReplayDispatchHandler> m_outstanding;
   };
 
 }
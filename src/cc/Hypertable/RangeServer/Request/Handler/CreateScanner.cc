@@ -32,14 +32,30 @@
 
 #include <Common/Error.h>
 #include <Common/Logger.h>
+#include <Common/RequestTracer.h>
 #include <Common/Serialization.h>
 #include <Common/md5.h>
 
+#include <chrono>
+
 using namespace Hypertable;
 using namespace Hypertable::RangeServer::Request::Handler;
 
 void CreateScanner::run() {
   Response::Callback::CreateScanner cb(m_comm, m_event);
+  uint32_t trace_id {};
+
+  if (RequestTracer::enabled()) {
+    trace_id = m_event->header.trace_id();
+    if (trace_id == 0)
+      trace_id = RequestTracer::instance->sample();
+    if (trace_id)
+      RequestTracer::instance->record(trace_id, "create scanner queue wait",
+          std::chrono::duration_cast<std::chrono::microseconds>
+          (ClockT::now() - m_event->arrival_time).count());
+  }
+
+  auto execute_start = std::chrono::steady_clock::now();
 
   try {
     const uint8_t *ptr = m_event->payload;
@@ -54,14 +70,48 @@ void CreateScanner::run() {
       md5_csum((unsigned char *)base, ptr-base,
                reinterpret_cast<unsigned char *>(key.digest));
       m_range_server->create_scanner(&cb, params.table(), params.range_spec(),
-                                     params.scan_spec(), &key);
+                                     params.scan_spec(), &key,
+                                     params.scan_block_format());
     }
     else
       m_range_server->create_scanner(&cb, params.table(), params.range_spec(),
-                                     params.scan_spec(), 0);
+                                     params.scan_spec(), 0,
+                                     params.scan_block_format());
+
+    if (trace_id)
+      RequestTracer::instance->record(trace_id, "create scanner execute",
+          std::chrono::duration_cast<std::chrono::microseconds>
+          (std::chrono::steady_clock::now() - execute_start).count());
   }
   catch (Exception &e) {
     HT_ERROR_OUT << e << HT_END;
     cb.error(e.code(), e.what());
   }
 }
+
+bool CreateScanner::run_inline() {
+  try {
+    const uint8_t *ptr = m_event->payload;
+    size_t remain = m_event->payload_len;
+    QueryCache::Key key;
+    Lib::RangeServer::Request::Parameters::CreateScanner params;
+
+    const uint8_t *base = ptr;
+    params.decode(&ptr, &remain);
+
+    if (!params.scan_spec().cacheable())
+      return false;
+
+    md5_csum((unsigned char *)base, ptr-base,
+             reinterpret_cast<unsigned char *>(key.digest));
+
+    Response::Callback::CreateScanner cb(m_comm, m_event);
+    return m_range_server->create_scanner_from_cache(&cb, params.table(),
+                                                     params.range_spec(),
+                                                     &key);
+  }
+  catch (Exception &) {
+    // Let the queued request generate the error response
+    return false;
+  }
+}
@@ -42,6 +42,13 @@ namespace Handler {
 
     virtual void run();
 
+    /** Answers the request from the query cache if possible.  Runs on the
+     * reactor thread; cache misses and non-cacheable scans are left for
+     * the application queue.
+     * @return <i>true</i> if the request was answered from the cache
+     */
+    virtual bool run_inline();
+
   private:
     Comm *m_comm;
     Apps::RangeServer *m_range_server;
@@ -31,21 +31,40 @@
 
 #include <Common/Error.h>
 #include <Common/Logger.h>
+#include <Common/RequestTracer.h>
 #include <Common/Serialization.h>
 
+#include <chrono>
+
 using namespace Hypertable;
 using namespace Hypertable::RangeServer;
 using namespace Hypertable::RangeServer::Request::Handler;
 
 void FetchScanblock::run() {
   Response::Callback::CreateScanner cb(m_comm, m_event);
+  uint32_t trace_id {};
+
+  if (RequestTracer::enabled()) {
+    trace_id = m_event->header.trace_id();
+    if (trace_id == 0)
+      trace_id = RequestTracer::instance->sample();
+    if (trace_id)
+      RequestTracer::instance->record(trace_id, "fetch scanblock queue wait",
+          std::chrono::duration_cast<std::chrono::microseconds>
+          (ClockT::now() - m_event->arrival_time).count());
+  }
 
   try {
     Lib::RangeServer::Request::Parameters::FetchScanblock params;
     const uint8_t *ptr = m_event->payload;
     size_t remain = m_event->payload_len;
     params.decode(&ptr, &remain);
+    auto execute_start = std::chrono::steady_clock::now();
     m_range_server->fetch_scanblock(&cb, params.scanner_id());
+    if (trace_id)
+      RequestTracer::instance->record(trace_id, "fetch scanblock execute",
+          std::chrono::duration_cast<std::chrono::microseconds>
+          (std::chrono::steady_clock::now() - execute_start).count());
   }
   catch (Exception &e) {
     HT_ERROR_OUT << e << HT_END;
@@ -0,0 +1,59 @@
+/* -*- c++ -*-
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 3 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#ifndef Hypertable_RangeServer_Request_Handler_ReadaheadScanblock_h
+#define Hypertable_RangeServer_Request_Handler_ReadaheadScanblock_h
+
+#include <AsyncComm/ApplicationHandler.h>
+
+namespace Hypertable {
+namespace Apps { class RangeServer; }
+namespace RangeServer {
+namespace Request {
+namespace Handler {
+
+  /// @addtogroup RangeServerRequestHandler
+  /// @{
+
+  /// Fills the next scan block for a scanner while the previous block is in
+  /// flight to the client.  Enqueued by create_scanner() and
+  /// fetch_scanblock() after a scan block has been transmitted; runs at low
+  /// priority so readahead never delays client requests.
+  class ReadaheadScanblock : public ApplicationHandler {
+  public:
+    ReadaheadScanblock(Apps::RangeServer *rs, int32_t scanner_id)
+      : ApplicationHandler(false), m_range_server(rs),
+        m_scanner_id(scanner_id) {
+      set_priority(PRIORITY_LOW);
+    }
+
+    virtual void run();
+
+  private:
+    Apps::RangeServer *m_range_server;
+    int32_t m_scanner_id;
+  };
+
+  /// @}
+
+}}}}
+
+#endif // Hypertable_RangeServer_Request_Handler_ReadaheadScanblock_h
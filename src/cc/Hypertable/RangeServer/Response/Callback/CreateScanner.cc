@@ -27,21 +27,58 @@
 
 #include <AsyncComm/CommBuf.h>
 #include <AsyncComm/CommHeader.h>
+#include <AsyncComm/ShmPayload.h>
 
+#include <Common/Config.h>
 #include <Common/Error.h>
 
 using namespace Hypertable;
 using namespace Hypertable::RangeServer::Response::Callback;
 
+namespace {
+
+  /// Minimum scan block size transferred via shared memory
+  uint32_t shm_min_payload() {
+    static uint32_t min_payload = Config::properties->get_i32(
+        "Hypertable.RangeServer.Scanner.ShmPayload.MinSize");
+    return min_payload;
+  }
+
+  /// Writes the scan block into a shared memory segment and encodes a
+  /// reference in its place when the (colocated) requester asked for it
+  bool maybe_shm_payload(const EventPtr &event, const uint8_t *ext_data,
+                         uint32_t ext_len, CommHeader &header,
+                         uint8_t *shm_ref) {
+    if ((event->header.flags & CommHeader::FLAGS_BIT_SHM_PAYLOAD_OK) == 0 ||
+        ext_len < shm_min_payload())
+      return false;
+    if (!shm_payload_write(ext_data, ext_len, shm_ref))
+      return false;
+    header.flags |= CommHeader::FLAGS_BIT_SHM_PAYLOAD;
+    return true;
+  }
+
+}
+
 int CreateScanner::response(int32_t id, int32_t skipped_rows,
                             int32_t skipped_cells, bool more,
 			    ProfileDataScanner &profile_data,
-                            StaticBuffer &ext) {
+                            StaticBuffer &ext, uint8_t scan_block_format) {
   CommHeader header;
+  uint8_t shm_ref[SHM_PAYLOAD_REF_LENGTH];
   header.initialize_from_request_header(m_event->header);
   Lib::RangeServer::Response::Parameters::CreateScanner params(id, skipped_rows,
                                                                skipped_cells, more,
-                                                               profile_data);
+                                                               profile_data,
+                                                               scan_block_format);
+  if (maybe_shm_payload(m_event, ext.base, ext.size, header, shm_ref)) {
+    CommBufPtr cbuf(new CommBuf(header, 4+params.encoded_length()
+                                + SHM_PAYLOAD_REF_LENGTH));
+    cbuf->append_i32(Error::OK);
+    params.encode(cbuf->get_data_ptr_address());
+    cbuf->append_bytes(shm_ref, SHM_PAYLOAD_REF_LENGTH);
+    return m_comm->send_response(m_event->addr, cbuf);
+  }
   CommBufPtr cbuf(new CommBuf(header, 4+params.encoded_length(), ext));
   cbuf->append_i32(Error::OK);
   params.encode(cbuf->get_data_ptr_address());
@@ -49,16 +86,26 @@ int CreateScanner::response(int32_t id, int32_t skipped_rows,
 }
 
 
-int CreateScanner::response(int32_t id, int32_t skipped_rows, 
+int CreateScanner::response(int32_t id, int32_t skipped_rows,
 			    int32_t skipped_cells, bool more,
                             ProfileDataScanner &profile_data,
 			    boost::shared_array<uint8_t> &ext_buffer,
-			    uint32_t ext_len) {
+			    uint32_t ext_len, uint8_t scan_block_format) {
   CommHeader header;
+  uint8_t shm_ref[SHM_PAYLOAD_REF_LENGTH];
   header.initialize_from_request_header(m_event->header);
   Lib::RangeServer::Response::Parameters::CreateScanner params(id, skipped_rows,
                                                                skipped_cells, more,
-                                                               profile_data);
+                                                               profile_data,
+                                                               scan_block_format);
+  if (maybe_shm_payload(m_event, ext_buffer.get(), ext_len, header, shm_ref)) {
+    CommBufPtr cbuf(new CommBuf(header, 4+params.encoded_length()
+                                + SHM_PAYLOAD_REF_LENGTH));
+    cbuf->append_i32(Error::OK);
+    params.encode(cbuf->get_data_ptr_address());
+    cbuf->append_bytes(shm_ref, SHM_PAYLOAD_REF_LENGTH);
+    return m_comm->send_response(m_event->addr, cbuf);
+  }
   CommBufPtr cbuf(new CommBuf(header, 4+params.encoded_length(),
                               ext_buffer, ext_len));
   cbuf->append_i32(Error::OK);
@@ -43,11 +43,12 @@ namespace Callback {
 
     int response(int32_t id, int32_t skipped_rows, int32_t skipped_cells,
                  bool more, ProfileDataScanner &profile_data,
-                 StaticBuffer &ext);
+                 StaticBuffer &ext, uint8_t scan_block_format = 1);
 
     int response(int32_t id, int32_t skipped_rows, int32_t skipped_cells,
                  bool more, ProfileDataScanner &profile_data,
-                 boost::shared_array<uint8_t> &ext_buffer, uint32_t ext_len);
+                 boost::shared_array<uint8_t> &ext_buffer, uint32_t ext_len,
+                 uint8_t scan_block_format = 1);
   };
 
   /// @}
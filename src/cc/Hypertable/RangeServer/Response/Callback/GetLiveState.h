@@ -0,0 +1,65 @@
+/* -*- c++ -*-
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 3 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/// @file
+/// Declarations for GetLiveState response callback.
+/// This file contains declarations for GetLiveState, a response callback
+/// class used to deliver results of the <i>get_live_state</i> function call
+/// back to the client.
+
+#ifndef Hypertable_RangeServer_Response_Callback_GetLiveState_h
+#define Hypertable_RangeServer_Response_Callback_GetLiveState_h
+
+#include <AsyncComm/ResponseCallback.h>
+
+#include <string>
+
+namespace Hypertable {
+namespace RangeServer {
+namespace Response {
+namespace Callback {
+
+  /// @addtogroup RangeServerResponseCallback
+  /// @{
+
+  /// Response callback for <i>get_live_state</i> function.
+  class GetLiveState : public ResponseCallback {
+  public:
+
+    /// Constructor.
+    /// Initializes base class constructor.
+    /// @param comm Pointer to comm layer
+    /// @param event Event object that initiated the request
+    GetLiveState(Comm *comm, EventPtr &event)
+      : ResponseCallback(comm, event) { }
+
+    /// Sends response parameters back to client.
+    /// @param output Live state report
+    /// @return Error code returned by Comm::send_result
+    int response(const std::string &output);
+
+  };
+
+  /// @}
+
+}}}}
+
+#endif // Hypertable_RangeServer_Response_Callback_GetLiveState_h
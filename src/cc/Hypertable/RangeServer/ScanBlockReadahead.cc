@@ -0,0 +1,115 @@
+/*
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 3 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/// @file
+/// Definitions for ScanBlockReadahead.
+/// This file contains the type definitions for ScanBlockReadahead, a class
+/// used to stage a pre-filled scan block between fetch_scanblock() requests.
+
+#include <Common/Compat.h>
+
+#include "ScanBlockReadahead.h"
+
+#include <Common/Error.h>
+#include <Common/Logger.h>
+
+using namespace Hypertable;
+using namespace std;
+
+namespace {
+  /// Moves buffer contents from <code>from</code> to <code>to</code>,
+  /// preserving allocation size and ownership (DynamicBuffer has no move
+  /// assignment).
+  void transfer(DynamicBuffer &from, DynamicBuffer &to) {
+    to.free();
+    to.base = from.base;
+    to.ptr = from.ptr;
+    to.mark = from.mark;
+    to.size = from.size;
+    to.own = from.own;
+    from.base = from.ptr = from.mark = 0;
+    from.size = 0;
+    from.own = true;
+  }
+}
+
+void ScanBlockReadahead::schedule() {
+  lock_guard<mutex> lock(m_mutex);
+  if (m_state == State::IDLE)
+    m_state = State::SCHEDULED;
+}
+
+bool ScanBlockReadahead::start() {
+  lock_guard<mutex> lock(m_mutex);
+  if (m_state != State::SCHEDULED)
+    return false;
+  m_state = State::RUNNING;
+  return true;
+}
+
+void ScanBlockReadahead::complete(DynamicBuffer &dbuf, uint32_t cell_count,
+                                  bool more,
+                                  const ProfileDataScanner &profile_data) {
+  lock_guard<mutex> lock(m_mutex);
+  HT_ASSERT(m_state == State::RUNNING);
+  transfer(dbuf, m_dbuf);
+  m_cell_count = cell_count;
+  m_more = more;
+  m_profile_data = profile_data;
+  m_error = Error::OK;
+  m_state = State::READY;
+  m_cond.notify_all();
+}
+
+void ScanBlockReadahead::complete_error(int error, const String &error_msg) {
+  lock_guard<mutex> lock(m_mutex);
+  HT_ASSERT(m_state == State::RUNNING);
+  m_error = error;
+  m_error_msg = error_msg;
+  m_state = State::READY;
+  m_cond.notify_all();
+}
+
+bool ScanBlockReadahead::take(DynamicBuffer &dbuf, uint32_t *cell_countp,
+                              bool *morep, ProfileDataScanner &profile_data) {
+  unique_lock<mutex> lock(m_mutex);
+  while (m_state == State::RUNNING)
+    m_cond.wait(lock);
+  if (m_state == State::SCHEDULED) {
+    // The queued task has not run yet; disarm it and let the caller fill
+    // synchronously rather than wait behind a backed-up application queue
+    m_state = State::IDLE;
+    return false;
+  }
+  if (m_state != State::READY)
+    return false;
+  m_state = State::IDLE;
+  if (m_error != Error::OK) {
+    int error = m_error;
+    m_error = Error::OK;
+    HT_THROW(error, m_error_msg);
+  }
+  transfer(m_dbuf, dbuf);
+  *cell_countp = m_cell_count;
+  *morep = m_more;
+  profile_data = m_profile_data;
+  return true;
+}
@@ -0,0 +1,173 @@
+/* -*- c++ -*-
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 3 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/// @file
+/// Declarations for ScanBlockReadahead.
+/// This file contains the type declarations for ScanBlockReadahead, a class
+/// used to stage a pre-filled scan block between fetch_scanblock() requests.
+
+#ifndef Hypertable_RangeServer_ScanBlockReadahead_h
+#define Hypertable_RangeServer_ScanBlockReadahead_h
+
+#include <Hypertable/Lib/ProfileDataScanner.h>
+
+#include <Common/DynamicBuffer.h>
+#include <Common/String.h>
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+
+namespace Hypertable {
+
+  /// @addtogroup RangeServer
+  /// @{
+
+  /// Staging area for one pre-filled scan block.
+  /// Each outstanding scanner owns one of these objects (held in its
+  /// ScannerMap entry).  After a scan block has been transmitted, the fetch
+  /// path marks the object <i>scheduled</i> and enqueues a readahead task on
+  /// the application queue; the task drains the next block from the merge
+  /// scanner into this object while the previous block is in flight to the
+  /// client.  The next fetch_scanblock() request consumes the staged block
+  /// with take(), overlapping merge CPU with network transmission.  At most
+  /// one block is staged per scanner, so readahead memory is bounded by the
+  /// scanner buffer budget.
+  ///
+  /// The object is a four-state machine (idle, scheduled, running, ready).
+  /// schedule() and start() arm and claim a fill, complete() publishes one,
+  /// and take() consumes it.  Readahead tasks are fungible:  if a fetch
+  /// request reaches the scanner before its queued task runs, take() simply
+  /// disarms the fill and the request falls back to filling synchronously; a
+  /// stale task that later finds the object re-armed performs the fill that
+  /// the newer task was enqueued for, and the newer task becomes a no-op.
+  class ScanBlockReadahead {
+
+  public:
+
+    /** Arms a readahead fill.
+     * Transitions the object from idle to scheduled.  Called by the fetch
+     * path just before it enqueues a readahead task; a task only performs a
+     * fill if it can claim a scheduled object with start().  Does nothing if
+     * a fill is already scheduled, running, or staged.
+     */
+    void schedule();
+
+    /** Claims an armed readahead fill.
+     * Transitions the object from scheduled to running.  Called by the
+     * readahead task before it touches the scanner; a <i>false</i> return
+     * means the fill was either disarmed by an intervening fetch request or
+     * already performed by an earlier task, and the task must not touch the
+     * scanner.
+     * @return <i>true</i> if the fill was claimed
+     */
+    bool start();
+
+    /** Publishes a filled scan block.
+     * Takes ownership of the contents of <code>dbuf</code>, transitions the
+     * object from running to ready and wakes any fetch request waiting in
+     * take().
+     * @param dbuf Buffer holding the encoded scan block
+     * @param cell_count Number of cells in the scan block
+     * @param more <i>true</i> if the scanner has more cells to deliver
+     * @param profile_data Accumulated profile data snapshot taken after the
+     * fill
+     */
+    void complete(DynamicBuffer &dbuf, uint32_t cell_count, bool more,
+                  const ProfileDataScanner &profile_data);
+
+    /** Publishes a failed fill.
+     * Transitions the object from running to ready and wakes any fetch
+     * request waiting in take(), which will rethrow the error to the client.
+     * @param error %Error code
+     * @param error_msg %Error message
+     */
+    void complete_error(int error, const String &error_msg);
+
+    /** Consumes the staged scan block.
+     * If a fill is running, blocks until it completes.  If a block is
+     * staged, moves it into the output arguments, resets the object to idle
+     * and returns <i>true</i>.  If a fill is merely scheduled (the queued
+     * task has not run yet), disarms it and returns <i>false</i>; the caller
+     * fills synchronously, so a fetch request never waits behind a backed-up
+     * application queue.
+     * @param dbuf Buffer to receive the encoded scan block
+     * @param cell_countp Address of variable to hold the cell count
+     * @param morep Address of variable to hold the <i>more</i> flag
+     * @param profile_data Profile data snapshot taken after the fill
+     * @return <i>true</i> if a staged block was consumed
+     * @throws Exception with the code and message recorded by
+     * complete_error()
+     */
+    bool take(DynamicBuffer &dbuf, uint32_t *cell_countp, bool *morep,
+              ProfileDataScanner &profile_data);
+
+  private:
+
+    /// Readahead states
+    enum class State {
+      /// No fill armed or staged
+      IDLE,
+      /// Fill armed; a readahead task is (or will be) queued
+      SCHEDULED,
+      /// A readahead task is draining the scanner
+      RUNNING,
+      /// A scan block (or error) is staged
+      READY
+    };
+
+    /// %Mutex for serializing member access
+    std::mutex m_mutex;
+
+    /// Condition variable signalling fill completion
+    std::condition_variable m_cond;
+
+    /// Current state
+    State m_state {State::IDLE};
+
+    /// Staged scan block
+    DynamicBuffer m_dbuf;
+
+    /// Number of cells in staged scan block
+    uint32_t m_cell_count {};
+
+    /// <i>true</i> if the scanner has more cells to deliver
+    bool m_more {};
+
+    /// Accumulated profile data snapshot taken after the fill
+    ProfileDataScanner m_profile_data;
+
+    /// %Error code recorded by a failed fill
+    int m_error {};
+
+    /// %Error message recorded by a failed fill
+    String m_error_msg;
+
+  };
+
+  /// Smart pointer to ScanBlockReadahead
+  typedef std::shared_ptr<ScanBlockReadahead> ScanBlockReadaheadPtr;
+
+  /// @}
+
+}
+
+#endif // Hypertable_RangeServer_ScanBlockReadahead_h
@@ -0,0 +1,105 @@
+/*
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 3 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/// @file
+/// Definitions for ScanBlockSpool.
+/// This file contains the type definitions for ScanBlockSpool, a class used
+/// to spill prepared scan blocks to a local temporary file.
+
+#include <Common/Compat.h>
+
+#include "ScanBlockSpool.h"
+
+#include <Common/Error.h>
+#include <Common/FileUtils.h>
+#include <Common/Logger.h>
+#include <Common/Serialization.h>
+
+#include <cerrno>
+#include <cstring>
+#include <vector>
+
+extern "C" {
+#include <stdlib.h>
+#include <unistd.h>
+}
+
+using namespace Hypertable;
+
+namespace {
+  /// On-disk record header: block length, cell count, more flag
+  const size_t RECORD_HEADER_LENGTH = 4 + 4 + 1;
+}
+
+ScanBlockSpool::ScanBlockSpool(const String &directory) {
+  String tmpl = directory + "/htScanSpool.XXXXXX";
+  std::vector<char> fname(tmpl.c_str(), tmpl.c_str() + tmpl.length() + 1);
+  if ((m_fd = mkstemp(&fname[0])) < 0)
+    HT_THROWF(Error::EXTERNAL, "Unable to create scanner spill file in "
+              "'%s' - %s", directory.c_str(), strerror(errno));
+  // Unlink immediately; the OS reclaims the space when the descriptor is
+  // closed, even if the process dies mid-scan
+  unlink(&fname[0]);
+}
+
+ScanBlockSpool::~ScanBlockSpool() {
+  if (m_fd >= 0)
+    close(m_fd);
+}
+
+void ScanBlockSpool::append(DynamicBuffer &dbuf, uint32_t cell_count,
+                            bool more) {
+  uint8_t header[RECORD_HEADER_LENGTH];
+  uint8_t *ptr = header;
+  Serialization::encode_i32(&ptr, (uint32_t)dbuf.fill());
+  Serialization::encode_i32(&ptr, cell_count);
+  Serialization::encode_bool(&ptr, more);
+  if (FileUtils::write(m_fd, header, RECORD_HEADER_LENGTH)
+      != (ssize_t)RECORD_HEADER_LENGTH ||
+      FileUtils::write(m_fd, dbuf.base, dbuf.fill()) != (ssize_t)dbuf.fill())
+    HT_THROWF(Error::EXTERNAL, "Error writing %u byte scan block to scanner "
+              "spill file - %s", (unsigned)dbuf.fill(), strerror(errno));
+  m_write_offset += RECORD_HEADER_LENGTH + dbuf.fill();
+}
+
+void ScanBlockSpool::next(DynamicBuffer &dbuf, uint32_t *cell_countp,
+                          bool *morep) {
+  HT_ASSERT(!exhausted());
+  uint8_t header[RECORD_HEADER_LENGTH];
+  if (FileUtils::pread(m_fd, header, RECORD_HEADER_LENGTH, m_read_offset)
+      != (ssize_t)RECORD_HEADER_LENGTH)
+    HT_THROWF(Error::EXTERNAL, "Error reading scan block header from "
+              "scanner spill file - %s", strerror(errno));
+  const uint8_t *ptr = header;
+  size_t remain = RECORD_HEADER_LENGTH;
+  uint32_t length = Serialization::decode_i32(&ptr, &remain);
+  *cell_countp = Serialization::decode_i32(&ptr, &remain);
+  *morep = Serialization::decode_bool(&ptr, &remain);
+  dbuf.clear();
+  dbuf.ensure(length);
+  if (FileUtils::pread(m_fd, dbuf.base, length,
+                       m_read_offset + RECORD_HEADER_LENGTH)
+      != (ssize_t)length)
+    HT_THROWF(Error::EXTERNAL, "Error reading %u byte scan block from "
+              "scanner spill file - %s", (unsigned)length, strerror(errno));
+  dbuf.ptr = dbuf.base + length;
+  m_read_offset += RECORD_HEADER_LENGTH + length;
+}
@@ -0,0 +1,115 @@
+/* -*- c++ -*-
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 3 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/// @file
+/// Declarations for ScanBlockSpool.
+/// This file contains the type declarations for ScanBlockSpool, a class used
+/// to spill prepared scan blocks to a local temporary file.
+
+#ifndef Hypertable_RangeServer_ScanBlockSpool_h
+#define Hypertable_RangeServer_ScanBlockSpool_h
+
+#include <Common/DynamicBuffer.h>
+#include <Common/String.h>
+
+#include <memory>
+
+namespace Hypertable {
+
+  /// @addtogroup RangeServer
+  /// @{
+
+  /// Spill file holding prepared scan blocks for a stalled scanner.
+  /// An outstanding scanner pins its merge scanner (and through it, cell
+  /// cache and cell store resources) until the client either drains it or
+  /// lets it expire.  When a client stalls, the remaining scan results are
+  /// drained into one of these objects (see ScannerMap::spill_stalled) so
+  /// that the merge scanner can be released; subsequent fetch_scanblock()
+  /// requests are served from the spill file instead.
+  ///
+  /// The backing file is created with mkstemp() and unlinked immediately, so
+  /// it is reclaimed by the OS if the process dies and disappears when the
+  /// object is destroyed.  Blocks are written and read back sequentially as
+  /// length-prefixed records; like the merge scanner it replaces, the object
+  /// assumes fetch requests for a given scanner arrive one at a time and
+  /// performs no locking of its own.
+  class ScanBlockSpool {
+
+  public:
+
+    /** Creates the spill file.
+     * @param directory Directory in which to create the spill file
+     * @throws Exception with code Error::EXTERNAL if the file cannot be
+     * created
+     */
+    ScanBlockSpool(const String &directory);
+
+    /// Closes the spill file.
+    ~ScanBlockSpool();
+
+    /** Appends a scan block to the spill file.
+     * @param dbuf Buffer holding the encoded scan block
+     * @param cell_count Number of cells in the scan block
+     * @param more <i>true</i> if more scan blocks follow this one
+     * @throws Exception with code Error::EXTERNAL on write failure
+     */
+    void append(DynamicBuffer &dbuf, uint32_t cell_count, bool more);
+
+    /** Reads the next scan block from the spill file.
+     * Must not be called when exhausted() returns <i>true</i>.
+     * @param dbuf Buffer to receive the encoded scan block
+     * @param cell_countp Address of variable to hold the cell count
+     * @param morep Address of variable to hold the <i>more</i> flag
+     * @throws Exception with code Error::EXTERNAL on read failure
+     */
+    void next(DynamicBuffer &dbuf, uint32_t *cell_countp, bool *morep);
+
+    /** Indicates if all appended scan blocks have been consumed.
+     * @return <i>true</i> if no unread scan blocks remain
+     */
+    bool exhausted() const { return m_read_offset >= m_write_offset; }
+
+    /** Returns the number of bytes written to the spill file.
+     * @return Bytes written (monotonic; reads do not shrink it)
+     */
+    int64_t disk_usage() const { return m_write_offset; }
+
+  private:
+
+    /// File descriptor of (unlinked) spill file
+    int m_fd {-1};
+
+    /// File offset at which the next scan block will be written
+    int64_t m_write_offset {};
+
+    /// File offset of the next unread scan block
+    int64_t m_read_offset {};
+
+  };
+
+  /// Smart pointer to ScanBlockSpool
+  typedef std::shared_ptr<ScanBlockSpool> ScanBlockSpoolPtr;
+
+  /// @}
+
+}
+
+#endif // Hypertable_RangeServer_ScanBlockSpool_h
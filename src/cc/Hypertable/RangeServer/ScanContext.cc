@@ -71,6 +71,8 @@ ScanContext::initialize(int64_t rev, const ScanSpec *ss,
 
   spec = ss;
   range = range_spec;
+  block_sample_period = (ss && ss->block_sample_period > 1)
+    ? ss->block_sample_period : 0;
 
   if (spec == 0)
     memset(family_mask, true, 256*sizeof(bool));
@@ -87,7 +89,10 @@ ScanContext::initialize(int64_t rev, const ScanSpec *ss,
 
       for (auto cfstr : spec->columns) {
 
-        cfstr = (const char *)arena.dup(cfstr);
+        // Column specifications are low cardinality schema-derived strings;
+        // interning them in the schema keeps repeat scans from copying them
+        // into per-scan storage
+        cfstr = schema->intern(cfstr);
 
         ScanSpec::parse_column(cfstr, family, &qualifier, &qualifier_len,
                                &has_qualifier, &is_regexp, &is_prefix);
@@ -286,6 +291,23 @@ ScanContext::initialize(int64_t rev, const ScanSpec *ss,
       end_row = Key::END_ROW_MARKER;
     }
 
+    // Advance the start row to the resume cursor's row so the scan seeks
+    // directly to where it left off.  Row-interval seeks are row granular,
+    // so this cannot skip undelivered cells; exact positioning within the
+    // row is enforced by MergeScannerRange.  Cell-interval scans encode a
+    // start column in start_key, so for those the cursor is applied by the
+    // merge scanner alone.
+    if (spec->resume_cursor && spec->cell_intervals.empty()) {
+      Key cursor_key;
+      if (!cursor_key.load(SerializedKey(spec->resume_cursor)))
+        HT_THROW(Error::RANGESERVER_BAD_SCAN_SPEC, "bad resume cursor");
+      if (start_row.compare(cursor_key.row) < 0 &&
+          end_row.compare(cursor_key.row) >= 0) {
+        start_row = cursor_key.row;
+        start_inclusive = true;
+      }
+    }
+
     if (start_row.compare(end_row) > 0)
       HT_THROW(Error::RANGESERVER_BAD_SCAN_SPEC, "start_row > end_row");
   }
@@ -27,6 +27,8 @@
 #ifndef Hypertable_RangeServer_ScanContext_h
 #define Hypertable_RangeServer_ScanContext_h
 
+#include <AsyncComm/Clock.h>
+
 #include <Common/ByteString.h>
 #include <Common/Error.h>
 #include <Common/StringExt.h>
@@ -37,6 +39,7 @@
 #include <Hypertable/Lib/ScanSpec.h>
 #include <Hypertable/Lib/Schema.h>
 
+#include <array>
 #include <cassert>
 #include <memory>
 #include <utility>
@@ -69,12 +72,43 @@ namespace Hypertable {
     int64_t revision;
     pair<int64_t, int64_t> time_interval;
     bool family_mask[256];
-    vector<CellPredicate> cell_predicates;
+    /// Per-family cell predicates indexed by column family code; stored
+    /// inline so scanner creation does not pay a heap allocation per scan
+    std::array<CellPredicate, 256> cell_predicates;
     RE2 *row_regexp;
     RE2 *value_regexp;
     typedef std::set<const char *, LtCstr, CstrAlloc> CstrRowSet;
     CstrRowSet rowset;
     uint32_t timeout_ms;
+    /// Block sampling period from the scan spec (0 when not sampling)
+    int32_t block_sample_period {};
+    /// Absolute deadline of the request the scanner is currently filling
+    /// a block for (see Event::deadline()).  Set around synchronous fills
+    /// only, so a fill with a client waiting on it can be abandoned when
+    /// the deadline passes; default-constructed (no deadline) otherwise
+    ClockT::time_point deadline {};
+
+    /// @name Per-scan execution statistics
+    /// Accumulated by the scanners sharing this context and returned to the
+    /// client in the scan profile data (see ProfileDataScanner)
+    /// @{
+
+    /// Cell store blocks read from the file system
+    int64_t blocks_read {};
+    /// Cell store blocks satisfied from the block caches
+    int64_t block_cache_hits {};
+    /// Cell stores excluded by a bloom filter lookup
+    int64_t bloom_filter_misses {};
+    /// Cells dropped by a column predicate
+    int64_t cells_filtered_predicates {};
+    /// Cells dropped by the row regexp
+    int64_t cells_filtered_row_regexp {};
+    /// Cells dropped by the value regexp
+    int64_t cells_filtered_value_regexp {};
+    /// Bytes produced by block decompression
+    int64_t bytes_decompressed {};
+
+    /// @}
 
     /**
      * Constructor.
@@ -87,7 +121,7 @@ namespace Hypertable {
      */
     ScanContext(int64_t rev, const ScanSpec *ss, const RangeSpec *range,
                 SchemaPtr &schema, std::set<uint8_t> *columns=0) :
-      cell_predicates(256), row_regexp(0), value_regexp(0), timeout_ms(0) {
+      row_regexp(0), value_regexp(0), timeout_ms(0) {
       initialize(rev, ss, range, schema, columns);
     }
 
@@ -98,7 +132,7 @@ namespace Hypertable {
      * @param schema smart pointer to schema object
      */
     ScanContext(int64_t rev, SchemaPtr &schema)
-      : cell_predicates(256), row_regexp(0), value_regexp(0), timeout_ms(0) {
+      : row_regexp(0), value_regexp(0), timeout_ms(0) {
       initialize(rev, 0, 0, schema);
     }
 
@@ -108,7 +142,7 @@ namespace Hypertable {
      * @param rev scan revision
      */
     ScanContext(int64_t rev=TIMESTAMP_MAX) 
-      : cell_predicates(256), row_regexp(0), value_regexp(0), timeout_ms(0) {
+      : row_regexp(0), value_regexp(0), timeout_ms(0) {
       SchemaPtr schema;
       initialize(rev, 0, 0, schema);
     }
@@ -119,7 +153,7 @@ namespace Hypertable {
      * @param schema smart pointer to schema object
      */
     ScanContext(SchemaPtr &schema) 
-      : cell_predicates(256), row_regexp(0), value_regexp(0), timeout_ms(0) {
+      : row_regexp(0), value_regexp(0), timeout_ms(0) {
       initialize(TIMESTAMP_MAX, 0, 0, schema);
     }
 
@@ -28,8 +28,12 @@
 
 #include "ScannerMap.h"
 
+#include <Hypertable/RangeServer/FillScanBlock.h>
+
 #include <Common/Time.h>
 
+#include <vector>
+
 using namespace Hypertable;
 using namespace std;
 
@@ -38,16 +42,20 @@ atomic<int> ScannerMap::ms_next_id {0};
 /**
  */
 int32_t ScannerMap::put(MergeScannerRangePtr &scanner, RangePtr &range,
-                         const TableIdentifier &table, ProfileDataScanner &profile_data) {
-  lock_guard<mutex> lock(m_mutex);
+                         const TableIdentifier &table, ProfileDataScanner &profile_data,
+                         uint8_t scan_block_format) {
   ScanInfo scaninfo;
   scaninfo.scanner = scanner;
   scaninfo.range = range;
   scaninfo.last_access_millis = get_timestamp_millis();
   scaninfo.table= table;
   scaninfo.profile_data = profile_data;
+  scaninfo.scan_block_format = scan_block_format;
+  scaninfo.readahead = make_shared<ScanBlockReadahead>();
   int32_t id = ++ms_next_id;
-  m_scanner_map[id] = scaninfo;
+  Shard &s = shard(id);
+  lock_guard<mutex> lock(s.mutex);
+  s.scanner_map[id] = scaninfo;
   return id;
 }
 
@@ -57,67 +65,271 @@ int32_t ScannerMap::put(MergeScannerRangePtr &scanner, RangePtr &range,
  */
 bool
 ScannerMap::get(int32_t id, MergeScannerRangePtr &scanner, RangePtr &range,
-                TableIdentifierManaged &table,ProfileDataScanner *profile_data){
-  lock_guard<mutex> lock(m_mutex);
-  auto iter = m_scanner_map.find(id);
-  if (iter == m_scanner_map.end())
+                TableIdentifierManaged &table,ProfileDataScanner *profile_data,
+                uint8_t *scan_block_formatp) {
+  Shard &s = shard(id);
+  unique_lock<mutex> lock(s.mutex);
+  auto iter = s.scanner_map.find(id);
+  // Wait out a spill drain or another fetch that is advancing the merge
+  // scanner (see spill_stalled()); the entry may be removed while we wait
+  while (iter != s.scanner_map.end() && (*iter).second.busy) {
+    s.cond.wait(lock);
+    iter = s.scanner_map.find(id);
+  }
+  if (iter == s.scanner_map.end())
     return false;
+  (*iter).second.busy = true;
   (*iter).second.last_access_millis = get_timestamp_millis();
   scanner = (*iter).second.scanner;
   range = (*iter).second.range;
   table = (*iter).second.table;
   *profile_data = (*iter).second.profile_data;
+  if (scan_block_formatp)
+    *scan_block_formatp = (*iter).second.scan_block_format;
   return true;
 }
 
 
 
+/**
+ */
+void ScannerMap::release(int32_t id) {
+  Shard &s = shard(id);
+  {
+    lock_guard<mutex> lock(s.mutex);
+    auto iter = s.scanner_map.find(id);
+    if (iter == s.scanner_map.end())
+      return;
+    (*iter).second.busy = false;
+  }
+  s.cond.notify_all();
+}
+
+
+
 /**
  */
 bool ScannerMap::remove(int32_t id) {
-  lock_guard<mutex> lock(m_mutex);
-  return (m_scanner_map.erase(id) == 0) ? false : true;
+  Shard &s = shard(id);
+  bool removed;
+  {
+    lock_guard<mutex> lock(s.mutex);
+    removed = s.scanner_map.erase(id) != 0;
+  }
+  if (removed)
+    s.cond.notify_all();
+  return removed;
 }
 
 
 void ScannerMap::purge_expired(int32_t max_idle_millis) {
-  lock_guard<mutex> lock(m_mutex);
   int64_t now_millis = get_timestamp_millis();
-  auto iter = m_scanner_map.begin();
-  while (iter != m_scanner_map.end()) {
-    if ((now_millis - (*iter).second.last_access_millis) > (int64_t)max_idle_millis) {
-      auto tmp_iter = iter;
-      HT_WARNF("Destroying scanner %d because it has not been used in %u "
-               "milliseconds", (*iter).first, max_idle_millis);
-      ++iter;
-      (*tmp_iter).second.scanner = 0;
-      (*tmp_iter).second.range = 0;
-      m_scanner_map.erase(tmp_iter);
+  for (Shard &s : m_shards) {
+    lock_guard<mutex> lock(s.mutex);
+    auto iter = s.scanner_map.begin();
+    while (iter != s.scanner_map.end()) {
+      // A busy entry is being advanced by a fetch or a spill drain and is
+      // not idle regardless of its last access time
+      if (!(*iter).second.busy &&
+          (now_millis - (*iter).second.last_access_millis) > (int64_t)max_idle_millis) {
+        auto tmp_iter = iter;
+        HT_WARNF("Destroying scanner %d because it has not been used in %u "
+                 "milliseconds", (*iter).first, max_idle_millis);
+        ++iter;
+        (*tmp_iter).second.scanner = 0;
+        (*tmp_iter).second.range = 0;
+        s.scanner_map.erase(tmp_iter);
+      }
+      else
+        ++iter;
     }
-    else
-      ++iter;
   }
 
 }
 
 
 void ScannerMap::get_counts(int32_t *totalp, CstrToInt32Map &table_scanner_count_map) {
-  lock_guard<mutex> lock(m_mutex);
   CstrToInt32Map::iterator tsc_iter;
 
-  *totalp = m_scanner_map.size();
+  *totalp = 0;
 
-  for (auto & entry : m_scanner_map) {
-    if ((tsc_iter = table_scanner_count_map.find(entry.second.table.id)) != table_scanner_count_map.end())
-      table_scanner_count_map[entry.second.table.id]++;
+  for (Shard &s : m_shards) {
+    lock_guard<mutex> lock(s.mutex);
+    *totalp += s.scanner_map.size();
+    for (auto & entry : s.scanner_map) {
+      if ((tsc_iter = table_scanner_count_map.find(entry.second.table.id)) != table_scanner_count_map.end())
+        table_scanner_count_map[entry.second.table.id]++;
+    }
   }
 
 }
 
+bool ScannerMap::get_spool(int32_t id, ScanBlockSpoolPtr &spool) {
+  Shard &s = shard(id);
+  lock_guard<mutex> lock(s.mutex);
+  auto iter = s.scanner_map.find(id);
+  if (iter == s.scanner_map.end() || !(*iter).second.spool)
+    return false;
+  spool = (*iter).second.spool;
+  return true;
+}
+
+
+void ScannerMap::spill_stalled(int32_t stall_ms, int64_t buffer_size,
+                               int64_t spill_budget, const String &directory) {
+  int64_t now_millis = get_timestamp_millis();
+  for (Shard &s : m_shards) {
+    vector<int32_t> candidates;
+    {
+      lock_guard<mutex> lock(s.mutex);
+      for (auto & entry : s.scanner_map) {
+        ScanInfo &info = entry.second;
+        if (info.busy || !info.scanner ||
+            (now_millis - info.last_access_millis) <= (int64_t)stall_ms ||
+            (info.spool && (!info.spool->exhausted() ||
+                            info.spool->disk_usage() >= spill_budget)))
+          continue;
+        candidates.push_back(entry.first);
+      }
+    }
+    for (int32_t id : candidates)
+      spill_one(s, id, now_millis, stall_ms, buffer_size, spill_budget,
+                directory);
+  }
+}
+
+
+void ScannerMap::spill_one(Shard &s, int32_t id, int64_t now_millis,
+                           int32_t stall_ms, int64_t buffer_size,
+                           int64_t spill_budget, const String &directory) {
+  MergeScannerRangePtr scanner;
+  ScanBlockReadaheadPtr readahead;
+  ScanBlockSpoolPtr spool;
+  uint8_t scan_block_format {};
+
+  {
+    lock_guard<mutex> lock(s.mutex);
+    auto iter = s.scanner_map.find(id);
+    if (iter == s.scanner_map.end())
+      return;
+    ScanInfo &info = iter->second;
+    // Re-check eligibility; a fetch request may have reached the scanner
+    // since the candidates were gathered
+    if (info.busy || !info.scanner ||
+        (now_millis - info.last_access_millis) <= (int64_t)stall_ms ||
+        (info.spool && (!info.spool->exhausted() ||
+                        info.spool->disk_usage() >= spill_budget)))
+      return;
+    info.busy = true;
+    scanner = info.scanner;
+    readahead = info.readahead;
+    spool = info.spool;
+    scan_block_format = info.scan_block_format;
+  }
+
+  bool more = true;
+  bool drain_ok = true;
+  String failure;
+
+  // The drain runs without the shard lock held so that requests for other
+  // scanners in the shard proceed; the busy flag parks fetch requests for
+  // this scanner in get() and keeps them from advancing the merge scanner
+  // concurrently
+  try {
+    if (!spool)
+      spool = make_shared<ScanBlockSpool>(directory);
+    DynamicBuffer dbuf;
+    uint32_t cell_count {};
+    ProfileDataScanner profile_data;
+    // Consume the block staged by the readahead task, if any; a running
+    // fill holds the entry busy, so no fill can be running here and take()
+    // returns without waiting
+    if (readahead && readahead->take(dbuf, &cell_count, &more, profile_data))
+      spool->append(dbuf, cell_count, more);
+    while (more && spool->disk_usage() < spill_budget) {
+      dbuf.clear();
+      more = FillScanBlock(scanner, dbuf, &cell_count, buffer_size,
+                           scan_block_format);
+      spool->append(dbuf, cell_count, more);
+    }
+  }
+  catch (Exception &e) {
+    drain_ok = false;
+    failure = e.what();
+  }
+
+  {
+    lock_guard<mutex> lock(s.mutex);
+    auto iter = s.scanner_map.find(id);
+    if (iter != s.scanner_map.end()) {
+      ScanInfo &info = iter->second;
+      if (!drain_ok) {
+        // Blocks were already consumed from the merge scanner but lost with
+        // the spool; resuming would silently skip them.  Destroy the scanner
+        // so the next fetch gets RANGESERVER_INVALID_SCANNER_ID and the
+        // client restarts the scan
+        s.scanner_map.erase(iter);
+      }
+      else {
+        // Fold the drained results into the stored profile totals; fetch
+        // requests served from the spill file report a zero delta
+        info.profile_data.cells_scanned = scanner->get_input_cells();
+        info.profile_data.cells_returned = scanner->get_output_cells();
+        info.profile_data.bytes_scanned = scanner->get_input_bytes();
+        info.profile_data.bytes_returned = scanner->get_output_bytes();
+        info.profile_data.disk_read = scanner->get_disk_read();
+        {
+          ScanContext *sctx = scanner->scan_context();
+          info.profile_data.blocks_read = sctx->blocks_read;
+          info.profile_data.block_cache_hits = sctx->block_cache_hits;
+          info.profile_data.bloom_filter_misses = sctx->bloom_filter_misses;
+          info.profile_data.cells_filtered_predicates =
+            sctx->cells_filtered_predicates;
+          info.profile_data.cells_filtered_row_regexp =
+            sctx->cells_filtered_row_regexp;
+          info.profile_data.cells_filtered_value_regexp =
+            sctx->cells_filtered_value_regexp;
+          info.profile_data.bytes_decompressed = sctx->bytes_decompressed;
+        }
+        info.spool = spool;
+        info.busy = false;
+        if (!more) {
+          HT_INFOF("Spilled %lld bytes of scan blocks for stalled scanner %d "
+                   "and released its merge scanner",
+                   (Lld)spool->disk_usage(), (int)id);
+          info.scanner = 0;
+        }
+        else
+          HT_WARNF("Scanner %d exceeded spill budget of %lld bytes after "
+                   "stalling; retaining merge scanner",
+                   (int)id, (Lld)spill_budget);
+      }
+    }
+  }
+  s.cond.notify_all();
+
+  if (!drain_ok)
+    HT_ERRORF("Problem spilling scan blocks for scanner %d - %s; "
+              "removing scanner, the client will restart the scan",
+              (int)id, failure.c_str());
+}
+
+
+bool ScannerMap::get_readahead(int32_t id, ScanBlockReadaheadPtr &readahead) {
+  Shard &s = shard(id);
+  lock_guard<mutex> lock(s.mutex);
+  auto iter = s.scanner_map.find(id);
+  if (iter == s.scanner_map.end())
+    return false;
+  readahead = (*iter).second.readahead;
+  return true;
+}
+
 void ScannerMap::update_profile_data(int32_t id, ProfileDataScanner &profile_data) {
-  lock_guard<mutex> lock(m_mutex);
-  auto iter = m_scanner_map.find(id);
-  if (iter == m_scanner_map.end())
+  Shard &s = shard(id);
+  lock_guard<mutex> lock(s.mutex);
+  auto iter = s.scanner_map.find(id);
+  if (iter == s.scanner_map.end())
     HT_WARNF("Unable to locate scanner ID %u in scanner map", (unsigned)id);
   else
     iter->second.profile_data = profile_data;
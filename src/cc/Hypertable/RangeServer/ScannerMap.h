@@ -29,10 +29,13 @@
 
 #include <Hypertable/RangeServer/MergeScannerRange.h>
 #include <Hypertable/RangeServer/Range.h>
+#include <Hypertable/RangeServer/ScanBlockReadahead.h>
+#include <Hypertable/RangeServer/ScanBlockSpool.h>
 
 #include <Hypertable/Lib/ProfileDataScanner.h>
 
 #include <atomic>
+#include <condition_variable>
 #include <mutex>
 #include <unordered_map>
 
@@ -54,15 +57,21 @@ namespace Hypertable {
      * @param range smart pointer to range object
      * @param table table identifier for this scanner
      * @param profile_data Scanner profile data
+     * @param scan_block_format scan block format version negotiated for this
+     * scanner
      * @return unique scanner ID
      */
     int32_t put(MergeScannerRangePtr &scanner, RangePtr &range,
-                 const TableIdentifier &table, ProfileDataScanner &profile_data);
+                 const TableIdentifier &table, ProfileDataScanner &profile_data,
+                 uint8_t scan_block_format = 1);
 
     /**
      * This method retrieves the scanner and range mapped to the given scanner
      * id.  It also updates the 'last_access_millis' member of this scanner map
-     * entry.
+     * entry.  If the entry is busy (a spill drain or another fetch is
+     * advancing the merge scanner), this method blocks until it is released;
+     * on a <i>true</i> return the entry is marked busy and the caller must
+     * release it with release() once it is done with the scanner.
      *
      * @param id scanner id
      * @param scanner smart pointer to returned scanner object
@@ -70,10 +79,21 @@ namespace Hypertable {
      * @param table reference to (managed) table identifier
      * @param profile_data Pointer to profile data structure populated by this
      * function
+     * @param scan_block_formatp Address of variable to hold the scan block
+     * format version negotiated for this scanner (may be nullptr)
      * @return true if found, false if not
      */
     bool get(int32_t id, MergeScannerRangePtr &scanner, RangePtr &range,
-             TableIdentifierManaged &table, ProfileDataScanner *profile_data);
+             TableIdentifierManaged &table, ProfileDataScanner *profile_data,
+             uint8_t *scan_block_formatp = nullptr);
+
+    /**
+     * This method releases an entry marked busy by get(), waking any
+     * requests waiting on it.  Does nothing if the entry no longer exists.
+     *
+     * @param id scanner id
+     */
+    void release(int32_t id);
 
     /**
      * This method removes the entry in the scanner map corresponding to the
@@ -110,8 +130,55 @@ namespace Hypertable {
      */
     void update_profile_data(int32_t id, ProfileDataScanner &profile_data);
 
+    /** Retrieves the readahead staging object for a scanner.
+     * Unlike get(), this method does not update the scanner's
+     * 'last_access_millis' member.
+     * @param id Scanner ID of scanner
+     * @param readahead smart pointer to returned readahead object
+     * @return true if found, false if not
+     */
+    bool get_readahead(int32_t id, ScanBlockReadaheadPtr &readahead);
+
+    /** Retrieves the spill file for a scanner, if one exists.
+     * Unlike get(), this method does not update the scanner's
+     * 'last_access_millis' member.
+     * @param id Scanner ID of scanner
+     * @param spool smart pointer to returned spool object
+     * @return true if found and a spill file exists, false otherwise
+     */
+    bool get_spool(int32_t id, ScanBlockSpoolPtr &spool);
+
+    /** Spills scan blocks of stalled scanners to disk.
+     * This method iterates through the scanner map looking for scanners that
+     * have not been referenced for stall_ms or greater milliseconds and
+     * drains their remaining scan results into a spill file (see
+     * ScanBlockSpool), releasing the merge scanner (and the cell cache and
+     * cell store resources it pins) once the drain completes.  Subsequent
+     * fetch requests for a spilled scanner are served from the spill file.
+     * If draining a scanner would push its spill file past
+     * <code>spill_budget</code> bytes, the drain stops early and the merge
+     * scanner is retained; fetch requests consume the spilled prefix first
+     * and then fall back to the scanner.  Each scanner is drained with its
+     * entry marked busy but without the shard lock held, so fetch requests
+     * for the drained scanner wait in get() while requests for other
+     * scanners in the shard proceed.  If a drain fails, the scanner is
+     * destroyed (blocks already consumed from the merge scanner were lost
+     * with the spool) and the client restarts the scan.
+     * @param stall_ms minimum idle time before a scanner is spilled
+     * @param buffer_size scan block transfer buffer size
+     * @param spill_budget maximum spill file size, in bytes, per scanner
+     * @param directory directory in which to create spill files
+     */
+    void spill_stalled(int32_t stall_ms, int64_t buffer_size,
+                       int64_t spill_budget, const String &directory);
+
   private:
 
+    /// Number of shards (power of two); scanner IDs are assigned
+    /// round-robin, so consecutive scanners land in different shards and
+    /// concurrent create/fetch requests rarely touch the same lock
+    enum { SHARD_COUNT = 64 };
+
     /** Returns the number of milliseconds since the epoch.
      * @return Milliseconds since epoch
      */
@@ -120,9 +187,6 @@ namespace Hypertable {
     /// Next available scanner ID
     static std::atomic<int> ms_next_id;
 
-    /// %Mutex for serializing access to members
-    std::mutex m_mutex;
-
     /// Holds scanner information.
     struct ScanInfo {
       /// Scanner
@@ -135,10 +199,52 @@ namespace Hypertable {
       TableIdentifierManaged table;
       /// Accumulated profile data
       ProfileDataScanner profile_data;
+      /// Scan block format version negotiated for this scanner
+      uint8_t scan_block_format {1};
+      /// Staging area for a pre-filled scan block
+      ScanBlockReadaheadPtr readahead;
+      /// Spill file holding drained scan blocks (only set once the client
+      /// has stalled, see spill_stalled())
+      ScanBlockSpoolPtr spool;
+      /// Entry is busy; a fetch request or spill drain is advancing the
+      /// merge scanner (see get() and spill_stalled())
+      bool busy {};
+    };
+
+    /// Scanner map shard with its own lock
+    struct Shard {
+      /// %Mutex for serializing access to #scanner_map
+      std::mutex mutex;
+      /// Condition variable signalling busy entries released or removed
+      std::condition_variable cond;
+      /// Scanner map
+      std::unordered_map<int32_t, ScanInfo> scanner_map;
     };
 
-    /// Scanner map
-    std::unordered_map<int32_t, ScanInfo> m_scanner_map;
+    /** Returns the shard holding scanner <code>id</code>.
+     * @param id scanner id
+     * @return Shard holding <code>id</code>
+     */
+    Shard &shard(int32_t id) { return m_shards[id & (SHARD_COUNT-1)]; }
+
+    /** Drains one stalled scanner into its spill file.
+     * Marks the entry busy, drops the shard lock for the drain, and
+     * reacquires it to publish the spool, or to destroy the scanner if the
+     * drain failed.
+     * @param s shard holding the scanner
+     * @param id scanner id
+     * @param now_millis current time in milliseconds since epoch
+     * @param stall_ms minimum idle time before a scanner is spilled
+     * @param buffer_size scan block transfer buffer size
+     * @param spill_budget maximum spill file size, in bytes, per scanner
+     * @param directory directory in which to create spill files
+     */
+    void spill_one(Shard &s, int32_t id, int64_t now_millis, int32_t stall_ms,
+                   int64_t buffer_size, int64_t spill_budget,
+                   const String &directory);
+
+    /// Scanner map shards, indexed by the low bits of the scanner ID
+    Shard m_shards[SHARD_COUNT];
 
   };
 
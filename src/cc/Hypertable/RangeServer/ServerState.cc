@@ -47,6 +47,10 @@ bool ServerState::readonly() {
   return m_specs[SystemVariable::READONLY].value;
 }
 
+bool ServerState::update_throttle() {
+  return m_specs[SystemVariable::UPDATE_THROTTLE].value;
+}
+
 void ServerState::set(int64_t generation, const std::vector<SystemVariable::Spec> &specs) {
   lock_guard<mutex> lock(m_mutex);
   if (generation > m_generation) {
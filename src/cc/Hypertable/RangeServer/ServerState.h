@@ -53,6 +53,10 @@ namespace Hypertable {
     /// @return Value of READONLY variable
     bool readonly();
 
+    /// Returns value of UPDATE_THROTTLE variable.
+    /// @return Value of UPDATE_THROTTLE variable
+    bool update_throttle();
+
     /// Sets state variables.
     /// @param generation Generation number of state variables
     /// @param specs Vector of state variables
@@ -0,0 +1,83 @@
+/* -*- c++ -*-
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 3 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/** @file
+ * Declarations for StartupSelfTest.
+ * This file contains declarations for StartupSelfTest, a startup
+ * self-benchmark which measures CellStore write, read, and scan
+ * throughput through the FS broker.
+ */
+
+#ifndef Hypertable_RangeServer_StartupSelfTest_h
+#define Hypertable_RangeServer_StartupSelfTest_h
+
+#include <Common/String.h>
+
+#include <cstdint>
+
+namespace Hypertable {
+
+  /** @addtogroup RangeServer
+   * @{
+   */
+
+  /** Startup self-benchmark measuring CellStore throughput.
+   * A server with a degraded disk or misconfigured NIC can join the
+   * cluster silently and become a tail-latency source.  When enabled via
+   * <code>Hypertable.RangeServer.StartupSelfTest</code>, this benchmark
+   * writes a synthetic %CellStore of configurable size through the real
+   * FS broker path, reads the finalized file back sequentially, and scans
+   * it with a CellStore scanner.  The measured rates are logged and
+   * reported in StatsRangeServer so that the Master's balancer can
+   * deprioritize or flag underperforming servers before they take
+   * traffic.
+   */
+  class StartupSelfTest {
+  public:
+
+    /// Transfer rates measured by run().
+    struct Results {
+      /// CellStore write rate through the FS broker (bytes/s)
+      int64_t write_rate {};
+      /// Sequential read rate through the FS broker (bytes/s)
+      int64_t read_rate {};
+      /// CellStore scan rate (cells/s)
+      int64_t scan_rate {};
+    };
+
+    /** Runs the self-benchmark.
+     * Creates a synthetic %CellStore holding approximately
+     * <code>data_size</code> bytes of cell data under <code>testdir</code>
+     * in the brokered file system, reads it back, scans it, and removes
+     * <code>testdir</code> when done.  Global::dfs must be connected
+     * before this method is called.
+     * @param testdir Scratch directory in the brokered file system
+     * @param data_size Amount of cell data to write (bytes)
+     * @return Measured transfer rates
+     */
+    static Results run(const String &testdir, int64_t data_size);
+  };
+
+  /** @} */
+
+}
+
+#endif // Hypertable_RangeServer_StartupSelfTest_h
@@ -40,28 +40,23 @@ using namespace Hypertable;
 using namespace std;
 
 TableInfoMap::~TableInfoMap() {
-  m_map.clear();
 }
 
 
 bool TableInfoMap::lookup(const String &table_id, TableInfoPtr &info) {
-  lock_guard<mutex> lock(m_mutex);
-  InfoMap::iterator iter = m_map.find(table_id);
-  if (iter == m_map.end())
+  InfoMapPtr map_snapshot = atomic_load(&m_map);
+  InfoMap::const_iterator iter = map_snapshot->find(table_id);
+  if (iter == map_snapshot->end())
     return false;
   info = (*iter).second;
   return true;
 }
 
 void TableInfoMap::get(const String &table_id, TableInfoPtr &info) {
-  lock_guard<mutex> lock(m_mutex);
   TableIdentifier table;
 
-  InfoMap::iterator iter = m_map.find(table_id);
-  if (iter != m_map.end()) {
-    info = (*iter).second;
+  if (lookup(table_id, info))
     return;
-  }
 
   HyperspaceTableCache::Entry entry;
 
@@ -75,8 +70,14 @@ void TableInfoMap::get(const String &table_id, TableInfoPtr &info) {
 
     try {
       DynamicBuffer valbuf;
-      Global::hyperspace->attr_get(tablefile, "schema", valbuf);
-      entry.schema.reset( Schema::new_instance((const char *)valbuf.base) );
+      bool bin_exists {};
+      Global::hyperspace->attr_get(tablefile, "schema_bin", bin_exists, valbuf);
+      if (bin_exists)
+        entry.schema.reset( Schema::new_instance(valbuf.base, valbuf.fill()) );
+      else {
+        Global::hyperspace->attr_get(tablefile, "schema", valbuf);
+        entry.schema.reset( Schema::new_instance((const char *)valbuf.base) );
+      }
       entry.maintenance_disabled =
         Global::hyperspace->attr_exists(tablefile, "maintenance_disabled");
     }
@@ -92,9 +93,17 @@ void TableInfoMap::get(const String &table_id, TableInfoPtr &info) {
   table.id = table_id.c_str();
   table.generation = entry.schema->get_generation();
 
+  // Publish under the writer lock, re-checking for a concurrent insert
+  lock_guard<mutex> lock(m_mutex);
+  InfoMapPtr new_map = copy_map();
+  InfoMap::iterator iter = new_map->find(table_id);
+  if (iter != new_map->end()) {
+    info = (*iter).second;
+    return;
+  }
   info = make_shared<TableInfo>(&table, entry.schema, entry.maintenance_disabled);
-
-  m_map[table_id] = info;
+  (*new_map)[table_id] = info;
+  atomic_store(&m_map, new_map);
 }
 
 
@@ -104,8 +113,9 @@ void TableInfoMap::promote_staged_range(const TableIdentifier &table, RangePtr &
   StringSet linked_logs;
   int error;
 
-  InfoMap::iterator iter = m_map.find(table.id);
-  HT_ASSERT(iter != m_map.end());
+  InfoMapPtr map_snapshot = atomic_load(&m_map);
+  InfoMap::const_iterator iter = map_snapshot->find(table.id);
+  HT_ASSERT(iter != map_snapshot->end());
 
   if (transfer_log && *transfer_log) {
     CommitLogReaderPtr commit_log_reader =
@@ -151,32 +161,40 @@ void TableInfoMap::promote_staged_range(const TableIdentifier &table, RangePtr &
 
 bool TableInfoMap::remove(const String &table_id, TableInfoPtr &info) {
   lock_guard<mutex> lock(m_mutex);
-  InfoMap::iterator iter = m_map.find(table_id);
-  if (iter == m_map.end())
+  InfoMapPtr new_map = copy_map();
+  InfoMap::iterator iter = new_map->find(table_id);
+  if (iter == new_map->end())
     return false;
   info = (*iter).second;
-  m_map.erase(iter);
+  new_map->erase(iter);
+  atomic_store(&m_map, new_map);
   return true;
 }
 
 
 void TableInfoMap::get_all(std::vector<TableInfoPtr> &tv) {
-  lock_guard<mutex> lock(m_mutex);
-  for (InfoMap::iterator iter = m_map.begin(); iter != m_map.end(); ++iter)
+  InfoMapPtr map_snapshot = atomic_load(&m_map);
+  for (InfoMap::const_iterator iter = map_snapshot->begin();
+       iter != map_snapshot->end(); ++iter)
     tv.push_back((*iter).second);
 }
 
 
 void TableInfoMap::get_ranges(Ranges &ranges, StringSet *remove_ok_logs) {
+  // Writer lock held (rather than just a map snapshot) to preserve the
+  // atomicity with promote_staged_range() described in the header
   lock_guard<mutex> lock(m_mutex);
+  InfoMapPtr map_snapshot = atomic_load(&m_map);
   int32_t count = 0;
 
   // reserve space in vector
-  for (InfoMap::iterator iter = m_map.begin(); iter != m_map.end(); iter++)
+  for (InfoMap::const_iterator iter = map_snapshot->begin();
+       iter != map_snapshot->end(); iter++)
     count += (*iter).second->get_range_count();
   ranges.array.reserve(count+10);
 
-  for (InfoMap::iterator iter = m_map.begin(); iter != m_map.end(); iter++)
+  for (InfoMap::const_iterator iter = map_snapshot->begin();
+       iter != map_snapshot->end(); iter++)
     (*iter).second->get_ranges(ranges);
 
   {
@@ -190,12 +208,12 @@ void TableInfoMap::get_ranges(Ranges &ranges, StringSet *remove_ok_logs) {
 
 void TableInfoMap::clear() {
   lock_guard<mutex> lock(m_mutex);
-  m_map.clear();
+  atomic_store(&m_map, make_shared<InfoMap>());
 }
 
 bool TableInfoMap::empty() {
-  lock_guard<mutex> lock(m_mutex);
-  return m_map.empty();
+  InfoMapPtr map_snapshot = atomic_load(&m_map);
+  return map_snapshot->empty();
 }
 
 
@@ -219,16 +237,19 @@ void TableInfoMap::merge(TableInfoMap *other,
 
 
 void TableInfoMap::merge_unlocked(TableInfoMap *other) {
-  InfoMap::iterator other_iter, iter;
+  InfoMap::iterator iter;
   Ranges ranges;
 
-  for (other_iter = other->m_map.begin();
-       other_iter != other->m_map.end(); ++other_iter) {
+  InfoMapPtr new_map = copy_map();
+  InfoMapPtr other_map = atomic_load(&other->m_map);
 
-    iter = m_map.find( (*other_iter).first );
+  for (InfoMap::const_iterator other_iter = other_map->begin();
+       other_iter != other_map->end(); ++other_iter) {
 
-    if (iter == m_map.end()) {
-      m_map[ (*other_iter).first ] = (*other_iter).second;
+    iter = new_map->find( (*other_iter).first );
+
+    if (iter == new_map->end()) {
+      (*new_map)[ (*other_iter).first ] = (*other_iter).second;
     }
     else {
       ranges.array.clear();
@@ -238,5 +259,10 @@ void TableInfoMap::merge_unlocked(TableInfoMap *other) {
     }
 
   }
+  atomic_store(&m_map, new_map);
   other->clear();
 }
+
+TableInfoMap::InfoMapPtr TableInfoMap::copy_map() {
+  return make_shared<InfoMap>(*atomic_load(&m_map));
+}
@@ -68,7 +68,7 @@ namespace Hypertable {
   public:
 
     /** Constructor. */
-    TableInfoMap() { }
+    TableInfoMap() : m_map(std::make_shared<InfoMap>()) { }
 
     /** Constructor with HyperspaceTableCache.
      * Objects constructed with this constructor will use the provided
@@ -76,7 +76,8 @@ namespace Hypertable {
      * %Hyperspace.
      * @param schema_cache Table schema cache
      */
-    TableInfoMap(HyperspaceTableCachePtr schema_cache) : m_schema_cache(schema_cache) { }
+    TableInfoMap(HyperspaceTableCachePtr schema_cache)
+      : m_schema_cache(schema_cache), m_map(std::make_shared<InfoMap>()) { }
 
     /** Destructor. */
     virtual ~TableInfoMap();
@@ -209,14 +210,27 @@ namespace Hypertable {
     /// table_id-to-TableInfoPtr map type
     typedef std::map<String, TableInfoPtr> InfoMap;
 
-    /// %Mutex for serializing access to members
+    /// Shared pointer to InfoMap
+    typedef std::shared_ptr<InfoMap> InfoMapPtr;
+
+    /** Returns copy of the currently published map.
+     * Must be called with #m_mutex held (writers copy the published map,
+     * modify the copy, and atomically publish it back to #m_map).
+     * @return Copy of currently published map
+     */
+    InfoMapPtr copy_map();
+
+    /// %Mutex for serializing writers
     std::mutex m_mutex;
     
     /// %Hyperspace table cache
     HyperspaceTableCachePtr m_schema_cache;
 
-    /// table_id-to-TableInfoPtr map
-    InfoMap m_map;
+    /// Currently published table_id-to-TableInfoPtr map.
+    /// The map pointed to is immutable once published; readers fetch it with
+    /// std::atomic_load() and traverse it without holding #m_mutex, so
+    /// writers must never modify a published map in place.
+    InfoMapPtr m_map;
   };
 
   /// Shared smart pointer to TableInfoMap
@@ -233,6 +233,13 @@ bool TimerHandler::low_memory() {
   int64_t memory_used = Global::memory_tracker->balance();
   bool low_physical_memory = false;
 
+  // The tracker under-counts when the resident set drifts above it (arena
+  // slack, heap fragmentation, mmap'd indexes), so go by whichever is larger
+  int64_t resident_memory =
+    (int64_t)(System::proc_stat().vm_resident * Property::MiB);
+  if (resident_memory > memory_used)
+    memory_used = resident_memory;
+
   // ensure unused physical memory if it makes sense
   if (Global::memory_limit_ensure_unused_current &&
       memory_used - m_query_cache_memory > Global::memory_limit_ensure_unused_current) {
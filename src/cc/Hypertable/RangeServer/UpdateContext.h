@@ -27,6 +27,7 @@
 
 #include <AsyncComm/Clock.h>
 
+#include <chrono>
 #include <vector>
 
 namespace Hypertable {
@@ -52,6 +53,9 @@ namespace Hypertable {
     }
     std::vector<UpdateRecTable *> updates;
     std::chrono::fast_clock::time_point expire_time;
+    /// Time this context was placed on a pipeline stage input queue;
+    /// reset at each handoff and used for per-stage wait time statistics
+    std::chrono::steady_clock::time_point enqueue_time;
     int64_t auto_revision;
     SendBackRec send_back;
     DynamicBuffer root_buf;
@@ -40,10 +40,14 @@
 #include <Common/FailureInducer.h>
 #include <Common/Logger.h>
 #include <Common/Serialization.h>
+#include <Common/ThreadActivity.h>
+#include <Common/ThreadAffinity.h>
+#include <Common/md5.h>
 
 #include <chrono>
 #include <set>
 #include <thread>
+#include <unordered_map>
 
 using namespace Hypertable;
 using namespace Hypertable::RangeServer;
@@ -58,20 +62,45 @@ UpdatePipeline::UpdatePipeline(ContextPtr &context, QueryCachePtr &query_cache,
   m_maintenance_pause_interval = m_context->props->get_i32("Hypertable.RangeServer.Testing.MaintenanceNeeded.PauseInterval");
   m_update_delay = m_context->props->get_i32("Hypertable.RangeServer.UpdateDelay", 0);
   m_max_clock_skew = m_context->props->get_i32("Hypertable.RangeServer.ClockSkew.Max");
-  m_threads.reserve(3);
+  m_cell_cache_zero_copy = m_context->props->get_i32(
+      "Hypertable.RangeServer.AccessGroup.CellCache.ZeroCopyThreshold") > 0;
+  m_log_header_reserve = m_log->header_reserve();
+  m_add_worker_target = m_context->props->get_i32(
+      "Hypertable.RangeServer.UpdatePipeline.AddStageWorkers");
+  if (m_add_worker_target < 1)
+    m_add_worker_target = 1;
+  m_threads.reserve(2 + m_add_worker_target);
   m_threads.push_back( thread(&UpdatePipeline::qualify_and_transform, this) );
   m_threads.push_back( thread(&UpdatePipeline::commit, this) );
-  m_threads.push_back( thread(&UpdatePipeline::add_and_respond, this) );
+  for (int32_t i=0; i<m_add_worker_target; i++) {
+    m_add_workers_active++;
+    m_threads.push_back( thread(&UpdatePipeline::add_and_respond, this) );
+  }
 }
 
 void UpdatePipeline::add(UpdateContext *uc) {
   lock_guard<mutex> lock(m_qualify_queue_mutex);
+  uc->enqueue_time = chrono::steady_clock::now();
   m_qualify_queue.push_back(uc);
   m_qualify_queue_cond.notify_all();
 }
 
 
 
+void UpdatePipeline::set_add_stage_worker_count(int32_t count) {
+  if (count < 1)
+    count = 1;
+  lock_guard<mutex> lock(m_response_queue_mutex);
+  m_add_worker_target = count;
+  while (m_add_workers_active < m_add_worker_target) {
+    m_add_workers_active++;
+    m_threads.push_back( thread(&UpdatePipeline::add_and_respond, this) );
+  }
+  if (m_add_workers_active > m_add_worker_target)
+    m_response_queue_cond.notify_all();
+}
+
+
 void UpdatePipeline::shutdown() {
   m_shutdown = true;
   m_qualify_queue_cond.notify_all();
@@ -100,12 +129,19 @@ void UpdatePipeline::qualify_and_transform() {
   CommitLogPtr transfer_log;
   UpdateRecRange range_update;
   RangePtr range;
+  chrono::steady_clock::time_point stage_start;
+  int64_t wait_millis;
+  size_t queue_depth;
   std::mutex &mutex = m_qualify_queue_mutex;
   condition_variable &cond = m_qualify_queue_cond;
   std::list<UpdateContext *> &queue = m_qualify_queue;
 
+  ThreadActivity::register_self("upd-qualify");
+  ThreadAffinity::bind_self("upd-qualify");
+
   while (true) {
 
+    ThreadActivity::clear();
     {
       unique_lock<std::mutex> lock(mutex);
       cond.wait(lock, [this, &queue](){ return !queue.empty() || m_shutdown; });
@@ -113,7 +149,13 @@ void UpdatePipeline::qualify_and_transform() {
         return;
       uc = queue.front();
       queue.pop_front();
+      queue_depth = queue.size();
     }
+    ThreadActivity::set("qualify updates");
+
+    stage_start = chrono::steady_clock::now();
+    wait_millis = chrono::duration_cast<chrono::milliseconds>(
+        stage_start - uc->enqueue_time).count();
 
     rulist = 0;
     transfer_bufp = 0;
@@ -125,6 +167,23 @@ void UpdatePipeline::qualify_and_transform() {
     if (m_update_delay)
       this_thread::sleep_for(chrono::milliseconds(m_update_delay));
 
+    // Clients abandon requests whose deadline has passed, so reject the
+    // batch up front rather than transforming and committing updates
+    // nobody is waiting for; during overload this sheds the retry's
+    // predecessors instead of executing them all.  This is the last point
+    // where abandonment is safe - once qualification stages updates
+    // against ranges and the commit log buffer, the batch has to run to
+    // completion
+    if (ClockT::now() >= uc->expire_time) {
+      HT_WARNF("Batch of %d updates expired before qualification, rejecting",
+               (int)uc->updates.size());
+      for (UpdateRecTable *table_update : uc->updates) {
+        table_update->error = Error::REQUEST_TIMEOUT;
+        table_update->error_msg = "request deadline passed before "
+          "updates were qualified";
+      }
+    }
+
     // Global commit log is only available after local recovery
     uc->auto_revision = Hypertable::get_ts64();
 
@@ -138,6 +197,9 @@ void UpdatePipeline::qualify_and_transform() {
 
       HT_DEBUG_OUT <<"Update: "<< table_update->id << HT_END;
 
+      if (table_update->error != Error::OK)
+        continue;
+
       if (!table_update->id.is_system() && m_context->server_state->readonly()) {
         table_update->error = Error::RANGESERVER_SERVER_IN_READONLY_MODE;
         continue;
@@ -167,12 +229,29 @@ void UpdatePipeline::qualify_and_transform() {
         continue;
       }
 
+      // Qualify stage boundary failure point for the
+      // update-pipeline-failure test; 'signal' specs reject the table's
+      // updates gracefully, 'pause'/'exit'/'throw' specs act on the
+      // pipeline thread itself
+      HT_MAYBE_FAIL_X("update-pipeline-qualify-1", !table_update->id.is_system());
+      if (HT_FAILURE_SIGNALLED("update-pipeline-qualify-1")) {
+        if (!table_update->id.is_system()) {
+          table_update->error = Error::INDUCED_FAILURE;
+          table_update->error_msg = "update-pipeline-qualify-1";
+          continue;
+        }
+      }
+
       // Pre-allocate the go_buf - each key could expand by 8 or 9 bytes,
       // if auto-assigned (8 for the ts or rev and maybe 1 for possible
       // increase in vint length)
-      table_update->go_buf.reserve(table_update->id.encoded_length() +
+      table_update->go_buf.reserve(m_log_header_reserve +
+                                   table_update->id.encoded_length() +
                                    table_update->total_buffer_size +
                                    (table_update->total_count * 9));
+      // Leading pad lets the commit stage frame the log block header in
+      // place and append the buffer without re-copying the payload
+      table_update->go_buf.ptr += m_log_header_reserve;
       table_update->id.encode(&table_update->go_buf.ptr);
       table_update->go_buf.set_mark();
 
@@ -184,6 +263,8 @@ void UpdatePipeline::qualify_and_transform() {
 
         go_buf_reset_offset = table_update->go_buf.fill();
         root_buf_reset_offset = uc->root_buf.fill();
+        uint32_t total_added_reset = table_update->total_added;
+        uint32_t transfer_count_reset = table_update->transfer_count;
 
         memset(&uc->send_back, 0, sizeof(uc->send_back));
 
@@ -220,6 +301,9 @@ void UpdatePipeline::qualify_and_transform() {
             continue;
           }
 
+          if (Global::hot_key_detector)
+            Global::hot_key_detector->record(row);
+
           // Look for containing range, add to stop mods if not found
           if (!table_update->table_info->find_containing_range(row, range,
                                                           start_row, end_row) ||
@@ -247,6 +331,9 @@ void UpdatePipeline::qualify_and_transform() {
             table_update->range_map[range.get()] = rulist;
           }
 
+          // A write to this row invalidates any cached negative lookup
+          range->negative_cache_invalidate(row);
+
           // See if range has some other error preventing it from receiving updates
           if ((error = rulist->range->get_error()) != Error::OK) {
             if (uc->send_back.error != error && uc->send_back.count > 0) {
@@ -311,8 +398,6 @@ void UpdatePipeline::qualify_and_transform() {
 
           HT_ASSERT(rulist->transfer_log.get() == transfer_log.get());
 
-          bool in_transferring_region = false;
-
           // Check for clock skew
           {
             ByteString tmp_key;
@@ -378,30 +463,11 @@ void UpdatePipeline::qualify_and_transform() {
           while (mod < mod_end &&
                  (end_row == "" || (strcmp(row, end_row.c_str()) <= 0))) {
 
-            if (transfer_pending) {
+            bool transferring = transfer_pending && transfer_info.transferring(row);
+            if (transferring)
+              table_update->transfer_count++;
 
-              if (transfer_info.transferring(row)) {
-                if (!in_transferring_region) {
-                  range_update.len = cur_bufp->fill() - range_update.offset;
-                  rulist->add_update(request, range_update);
-                  cur_bufp = transfer_bufp;
-                  range_update.bufp = cur_bufp;
-                  range_update.offset = cur_bufp->fill();
-                  in_transferring_region = true;
-                }
-                table_update->transfer_count++;
-              }
-              else {
-                if (in_transferring_region) {
-                  range_update.len = cur_bufp->fill() - range_update.offset;
-                  rulist->add_update(request, range_update);
-                  cur_bufp = &table_update->go_buf;
-                  range_update.bufp = cur_bufp;
-                  range_update.offset = cur_bufp->fill();
-                  in_transferring_region = false;
-                }
-              }
-            }
+            size_t cell_offset = cur_bufp->fill();
 
             try {
               SchemaPtr schema = table_update->table_info->get_schema();
@@ -450,6 +516,14 @@ void UpdatePipeline::qualify_and_transform() {
             cur_bufp->add(mod, key.ptr-mod);
             mod = key.ptr;
 
+            // Transferring cells get a side copy for the transfer log; the
+            // primary copy stays in the commit log buffer so the regular
+            // log sync covers their durability and the transfer log can be
+            // written without flushing
+            if (transferring)
+              transfer_bufp->add(cur_bufp->base + cell_offset,
+                                 cur_bufp->fill() - cell_offset);
+
             table_update->total_added++;
 
             if (mod < mod_end)
@@ -492,6 +566,43 @@ void UpdatePipeline::qualify_and_transform() {
           request->send_back_vector.push_back(uc->send_back);
           memset(&uc->send_back, 0, sizeof(uc->send_back));
         }
+
+        /*
+         * All-or-nothing enforcement for atomic batches: if any cell was
+         * rejected or the batch straddled more than one range, undo
+         * everything staged for this request and send the entire buffer
+         * back as a single unit, so the client redoes (or fails) the
+         * whole batch and no partial application ever becomes visible
+         */
+        if ((table_update->flags &
+             Lib::RangeServer::Protocol::UPDATE_FLAG_ATOMIC) &&
+            request->error == Error::OK &&
+            (!request->send_back_vector.empty() ||
+             table_update->range_map.size() > 1)) {
+          int first_error = request->send_back_vector.empty()
+            ? Error::RANGESERVER_OUT_OF_RANGE
+            : request->send_back_vector.front().error;
+          for (auto iter = table_update->range_map.begin();
+               iter != table_update->range_map.end(); ++iter)
+            (*iter).second->reset_updates(request);
+          table_update->go_buf.ptr =
+            table_update->go_buf.base + go_buf_reset_offset;
+          if (root_buf_reset_offset)
+            uc->root_buf.ptr = uc->root_buf.base + root_buf_reset_offset;
+          table_update->total_added = total_added_reset;
+          table_update->transfer_count = transfer_count_reset;
+          request->send_back_vector.clear();
+          memset(&uc->send_back, 0, sizeof(uc->send_back));
+          uc->send_back.error = first_error;
+          uc->send_back.count = request->count;
+          uc->send_back.offset = 0;
+          uc->send_back.len = request->buffer.size;
+          request->send_back_vector.push_back(uc->send_back);
+          memset(&uc->send_back, 0, sizeof(uc->send_back));
+          HT_DEBUGF("Atomic batch of %u cells rejected for table %s - %s",
+                    (unsigned)request->count, table_update->id.id,
+                    Error::get_text(first_error));
+        }
       }
 
       HT_DEBUGF("Added %d (%d transferring) updates to '%s'",
@@ -503,13 +614,24 @@ void UpdatePipeline::qualify_and_transform() {
 
     uc->last_revision = m_last_revision;
 
+    int64_t service_millis = chrono::duration_cast<chrono::milliseconds>(
+        chrono::steady_clock::now() - stage_start).count();
+
     // Enqueue update
     {
       lock_guard<std::mutex> lock(m_commit_queue_mutex);
+      uc->enqueue_time = chrono::steady_clock::now();
       m_commit_queue.push_back(uc);
       m_commit_queue_cond.notify_all();
       m_commit_queue_count++;
     }
+
+    {
+      lock_guard<LoadStatistics> lock(*Global::load_statistics);
+      Global::load_statistics->add_pipeline_data(LoadStatistics::STAGE_QUALIFY,
+                                                 wait_millis, service_millis,
+                                                 queue_depth);
+    }
   }
 }
 
@@ -521,12 +643,38 @@ void UpdatePipeline::commit() {
   int error = Error::OK;
   uint32_t committed_transfer_data;
   bool log_needs_syncing {};
+  bool deferred_unsynced {};
+  chrono::steady_clock::time_point stage_start;
+  int64_t wait_millis;
+  size_t queue_depth;
+
+  ThreadActivity::register_self("upd-commit");
+  ThreadAffinity::bind_self("upd-commit");
 
   while (true) {
 
     // Dequeue next update
+    ThreadActivity::clear();
     {
       unique_lock<std::mutex> lock(m_commit_queue_mutex);
+      // Before blocking, make data durable for deferred sync tables whose
+      // updates were acknowledged without waiting for a sync
+      if (deferred_unsynced && m_commit_queue.empty() && !m_shutdown &&
+          m_flags != Filesystem::Flags::NONE) {
+        lock.unlock();
+        if (m_flags == Filesystem::Flags::FLUSH)
+          error = m_log->flush();
+        else
+          error = m_log->sync();
+        if (error == Error::OK)
+          deferred_unsynced = false;
+        else
+          HT_ERRORF("Problem %sing log fragment (%s) - %s",
+                    (m_flags == Filesystem::Flags::FLUSH ? "flush" : "sync"),
+                    m_log->get_current_fragment_file().c_str(),
+                    Error::get_text(error));
+        lock.lock();
+      }
       m_commit_queue_cond.wait(lock, [this](){
           return !m_commit_queue.empty() || m_shutdown; });
       if (m_shutdown)
@@ -534,7 +682,13 @@ void UpdatePipeline::commit() {
       uc = m_commit_queue.front();
       m_commit_queue.pop_front();
       m_commit_queue_count--;
+      queue_depth = m_commit_queue.size();
     }
+    ThreadActivity::set("commit updates");
+
+    stage_start = chrono::steady_clock::now();
+    wait_millis = chrono::duration_cast<chrono::milliseconds>(
+        stage_start - uc->enqueue_time).count();
 
     committed_transfer_data = 0;
     log_needs_syncing = false;
@@ -549,15 +703,29 @@ void UpdatePipeline::commit() {
 
     for (UpdateRecTable *table_update : uc->updates) {
 
+      // Commit stage boundary failure point (see qualify stage note);
+      // rejects the table's updates before anything reaches the logs
+      HT_MAYBE_FAIL_X("update-pipeline-commit-1", !table_update->id.is_system());
+      if (HT_FAILURE_SIGNALLED("update-pipeline-commit-1")) {
+        if (!table_update->id.is_system() && table_update->error == Error::OK) {
+          table_update->error = Error::INDUCED_FAILURE;
+          table_update->error_msg = "update-pipeline-commit-1";
+          continue;
+        }
+      }
+
       coalesce_amount += table_update->total_buffer_size;
 
       // Iterate through all of the ranges, committing any transferring updates
       for (auto iter = table_update->range_map.begin(); iter != table_update->range_map.end(); ++iter) {
         if ((*iter).second->transfer_buf.ptr > (*iter).second->transfer_buf.mark) {
           committed_transfer_data += (*iter).second->transfer_buf.ptr - (*iter).second->transfer_buf.mark;
+          // The transfer log holds side copies of cells that are durable in
+          // the commit log, so it is written without a flush round-trip;
+          // Range syncs it once before handing it off
           if ((error = (*iter).second->transfer_log->write(ClusterId::get(), (*iter).second->transfer_buf,
                                                            (*iter).second->latest_transfer_revision,
-                                                           m_flags)) != Error::OK) {
+                                                           Filesystem::Flags::NONE)) != Error::OK) {
             table_update->error = error;
             table_update->error_msg = format("Problem writing %d bytes to transfer log",
                                              (int)(*iter).second->transfer_buf.fill());
@@ -581,7 +749,11 @@ void UpdatePipeline::commit() {
       if ((table_update->flags & Lib::RangeServer::Protocol::UPDATE_FLAG_NO_LOG) == 0 &&
           table_update->go_buf.ptr > table_update->go_buf.mark) {
 
-        if ((error = m_log->write(ClusterId::get(), table_update->go_buf, uc->last_revision, Filesystem::Flags::NONE)) != Error::OK) {
+        // Route each table's blocks to a stable log partition so writes
+        // spread across partitions when the log is partitioned
+        size_t partition_hint = (size_t)md5_hash(table_update->id.id);
+
+        if ((error = m_log->write_framed(ClusterId::get(), table_update->go_buf, uc->last_revision, Filesystem::Flags::NONE, partition_hint)) != Error::OK) {
           table_update->error_msg = format("Problem writing %d bytes to commit log (%s) - %s",
                                            (int)table_update->go_buf.fill(),
                                            m_log->get_log_dir().c_str(),
@@ -590,6 +762,9 @@ void UpdatePipeline::commit() {
           table_update->error = error;
           continue;
         }
+
+        if (table_update->flags & Lib::RangeServer::Protocol::UPDATE_FLAG_NO_LOG_SYNC)
+          deferred_unsynced = true;
       }
 
     }
@@ -597,6 +772,16 @@ void UpdatePipeline::commit() {
     bool do_sync = false;
     if (log_needs_syncing) {
       if (m_commit_queue_count > 0 && coalesce_amount < m_update_coalesce_limit) {
+        // Context is parked awaiting a coalesced sync; its stage service
+        // time ends here and the sync wait shows up in sync counts
+        int64_t service_millis = chrono::duration_cast<chrono::milliseconds>(
+            chrono::steady_clock::now() - stage_start).count();
+        {
+          lock_guard<LoadStatistics> lock(*Global::load_statistics);
+          Global::load_statistics->add_pipeline_data(
+              LoadStatistics::STAGE_COMMIT, wait_millis, service_millis,
+              queue_depth);
+        }
         coalesce_queue.push_back(uc);
         continue;
       }
@@ -609,6 +794,7 @@ void UpdatePipeline::commit() {
     if (do_sync) {
       size_t retry_count {};
       uc->total_syncs++;
+      auto sync_start = chrono::steady_clock::now();
 
       while (true) {
 
@@ -631,8 +817,19 @@ void UpdatePipeline::commit() {
         else
           break;
       }
+
+      // A successful sync also covers deferred sync table data
+      if (error == Error::OK) {
+        deferred_unsynced = false;
+        Global::load_statistics->sync_latency().add(
+            chrono::duration_cast<chrono::microseconds>
+            (chrono::steady_clock::now() - sync_start).count());
+      }
     }
 
+    int64_t service_millis = chrono::duration_cast<chrono::milliseconds>(
+        chrono::steady_clock::now() - stage_start).count();
+
     // Enqueue update
     {
       lock_guard<std::mutex> lock(m_response_queue_mutex);
@@ -640,11 +837,19 @@ void UpdatePipeline::commit() {
       while (!coalesce_queue.empty()) {
         uc = coalesce_queue.front();
         coalesce_queue.pop_front();
+        uc->enqueue_time = chrono::steady_clock::now();
         m_response_queue.push_back(uc);
       }
       coalesce_amount = 0;
       m_response_queue_cond.notify_all();
     }
+
+    {
+      lock_guard<LoadStatistics> lock(*Global::load_statistics);
+      Global::load_statistics->add_pipeline_data(LoadStatistics::STAGE_COMMIT,
+                                                 wait_millis, service_millis,
+                                                 queue_depth);
+    }
   }
 }
 
@@ -652,25 +857,68 @@ void UpdatePipeline::add_and_respond() {
   UpdateContext *uc;
   SerializedKey key;
   int error = Error::OK;
+  chrono::steady_clock::time_point stage_start;
+  int64_t wait_millis;
+  size_t queue_depth;
+
+  ThreadActivity::register_self("upd-respond");
+  ThreadAffinity::bind_self("upd-respond");
 
   while (true) {
 
     // Dequeue next update
+    ThreadActivity::clear();
     {
       unique_lock<std::mutex> lock(m_response_queue_mutex);
       m_response_queue_cond.wait(lock, [this](){
-          return !m_response_queue.empty() || m_shutdown; });
+          return !m_response_queue.empty() || m_shutdown ||
+            m_add_workers_active > m_add_worker_target; });
       if (m_shutdown)
         return;
+      if (m_add_workers_active > m_add_worker_target) {
+        m_add_workers_active--;
+        return;
+      }
       uc = m_response_queue.front();
       m_response_queue.pop_front();
+      queue_depth = m_response_queue.size();
     }
+    ThreadActivity::set("add and respond");
+
+    // Add stage boundary failure point; only 'pause' and 'exit' specs make
+    // sense here since the dequeued updates are already durable in the
+    // commit log
+    HT_MAYBE_FAIL("update-pipeline-add-1");
+
+    stage_start = chrono::steady_clock::now();
+    wait_millis = chrono::duration_cast<chrono::milliseconds>(
+        stage_start - uc->enqueue_time).count();
 
     /**
      *  Insert updates into Ranges
      */
     for (UpdateRecTable *table_update : uc->updates) {
 
+      // When cell caches insert large values by reference, ownership of
+      // the qualified update buffer moves into a shared StaticBuffer that
+      // the caches pin until they are dropped
+      StaticBufferPtr pinned;
+
+      // Counter increments get batched per row+column, so only check the
+      // schema for counter columns once per table
+      SchemaPtr schema = table_update->table_info->get_schema();
+      bool have_counters {};
+      for (auto cf_spec : schema->get_column_families()) {
+        if (cf_spec->get_option_counter()) {
+          have_counters = true;
+          break;
+        }
+      }
+
+      // Rows modified by this request, accumulated for a single batched
+      // query cache invalidation per table below
+      vector<QueryCache::RowInvalidation> invalidations;
+
       // Iterate through all of the ranges, inserting updates
       for (auto iter = table_update->range_map.begin(); iter != table_update->range_map.end(); ++iter) {
         ByteString value;
@@ -679,7 +927,39 @@ void UpdatePipeline::add_and_respond() {
         for (UpdateRecRange &update : (*iter).second->updates) {
           Range *rangep = (*iter).first;
           lock_guard<Range> lock(*rangep);
-          uint8_t *ptr = update.bufp->base + update.offset;
+
+          // Accumulated counter increments, keyed by the row+column
+          // portion of the serialized key (the same identity
+          // CellCache::add_counter merges on)
+          struct CounterUpdate {
+            SerializedKey serial;
+            int64_t total {};
+          };
+          unordered_map<String, CounterUpdate> counter_updates;
+
+          // Emits one cell per accumulated counter, carrying the
+          // serialized key of the latest increment and the summed value
+          auto flush_counters = [&]() {
+            Key counter_key;
+            ByteString counter_value;
+            uint8_t value_buf[9];
+            for (auto &entry : counter_updates) {
+              counter_key.load(entry.second.serial);
+              uint8_t *vptr = value_buf;
+              *vptr++ = 8;
+              Serialization::encode_i64(&vptr, entry.second.total);
+              counter_value.ptr = value_buf;
+              rangep->add(counter_key, counter_value);
+            }
+            counter_updates.clear();
+          };
+
+          bool zero_copy = m_cell_cache_zero_copy &&
+            update.bufp == &table_update->go_buf;
+          if (zero_copy && !pinned)
+            pinned = make_shared<StaticBuffer>(table_update->go_buf);
+          uint8_t *ptr = (zero_copy ? pinned->base : update.bufp->base)
+            + update.offset;
           uint8_t *end = ptr + update.len;
 
           if (!table_update->id.is_metadata())
@@ -705,14 +985,37 @@ void UpdatePipeline::add_and_respond() {
                         table_update->id.id, key_comps.row);
               continue;
             }
-            rangep->add(key_comps, value);
+            bool deferred {};
+            if (have_counters &&
+                schema->column_is_counter(key_comps.column_family_code)) {
+              if (key_comps.flag == FLAG_INSERT && *value.ptr == 8) {
+                // Plain increment; fold it into the running sum so N
+                // increments of a counter insert a single cell
+                const uint8_t *vptr = value.ptr + 1;
+                size_t remaining = 8;
+                String accum_key((const char *)key_comps.row,
+                                 (const char *)(key_comps.flag_ptr+1)
+                                 - key_comps.row);
+                CounterUpdate &cu = counter_updates[accum_key];
+                cu.serial = key;
+                cu.total += (int64_t)Serialization::decode_i64(&vptr, &remaining);
+                deferred = true;
+              }
+              else {
+                // Deletes and counter resets must not be reordered with
+                // increments, so emit everything accumulated so far first
+                flush_counters();
+              }
+            }
+            if (!deferred)
+              rangep->add(key_comps, value,
+                          zero_copy ? pinned : StaticBufferPtr());
             // invalidate
             if (m_query_cache) {
               if (strcmp(current_row, key_comps.row)) {
                 if (invalidate)
                   columns.clear();
-                m_query_cache->invalidate(table_update->id.id, current_row, columns);
-                columns.clear();
+                invalidations.emplace_back(current_row, columns);
                 invalidate = false;
                 current_row = key_comps.row;
               }
@@ -723,15 +1026,23 @@ void UpdatePipeline::add_and_respond() {
             }
           }
 
+          if (!counter_updates.empty())
+            flush_counters();
+
           if (m_query_cache && current_row) {
             if (invalidate)
               columns.clear();
-            m_query_cache->invalidate(table_update->id.id, current_row, columns);
+            invalidations.emplace_back(current_row, columns);
           }
 
           rangep->add_cells_written(count);
         }
       }
+
+      // One batched invalidation per request amortizes the pass over the
+      // query cache shards across all modified rows
+      if (m_query_cache && !invalidations.empty())
+        m_query_cache->invalidate(table_update->id.id, invalidations);
     }
 
     // Decrement usage counters for all referenced ranges
@@ -773,6 +1084,19 @@ void UpdatePipeline::add_and_respond() {
         }
 
         if (request->error == Error::OK) {
+
+          // Attribute the end-to-end request latency to each range the
+          // request's batch touched.  A request can carry cells for several
+          // ranges and they all pass through the same commit, so charging
+          // the full latency to each of them is the right approximation for
+          // the per-range latency metrics.
+          int64_t latency_usec = chrono::duration_cast<chrono::microseconds>
+            (ClockT::now() - request->event->arrival_time).count();
+          for (auto iter = table_update->range_map.begin();
+               iter != table_update->range_map.end(); ++iter)
+            (*iter).first->add_update_latency(latency_usec);
+          Global::load_statistics->update_latency().add(latency_usec);
+
           /**
            * Send back response
            */
@@ -808,9 +1132,15 @@ void UpdatePipeline::add_and_respond() {
 
     }
 
+    int64_t service_millis = chrono::duration_cast<chrono::milliseconds>(
+        chrono::steady_clock::now() - stage_start).count();
+
     {
       lock_guard<LoadStatistics> lock(*Global::load_statistics);
       Global::load_statistics->add_update_data(uc->total_updates, uc->total_added, uc->total_bytes_added, uc->total_syncs);
+      Global::load_statistics->add_pipeline_data(LoadStatistics::STAGE_ADD,
+                                                 wait_millis, service_millis,
+                                                 queue_depth);
     }
 
     delete uc;
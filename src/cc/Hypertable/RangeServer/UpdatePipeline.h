@@ -63,9 +63,13 @@ namespace Hypertable {
     ///     <code>Hypertable.RangeServer.UpdateDelay</code> property.
     ///   - Sets #m_max_clock_skew to the value of the
     ///     <code>Hypertable.RangeServer.ClockSkew.Max</code> property.
-    ///   - Creates and starts the three pipeline threads using
+    ///   - Creates and starts the pipeline threads using
     ///     qualify_and_transform(), commit(), and add_and_respond() as the
-    ///     thread functions, respectively.
+    ///     thread functions, respectively.  The number of add_and_respond()
+    ///     workers is given by the
+    ///     <code>Hypertable.RangeServer.UpdatePipeline.AddStageWorkers</code>
+    ///     property and can be changed at runtime with
+    ///     set_add_stage_worker_count().
     /// @param context %Range server context
     /// @param query_cache Query cache
     /// @param timer_handler Timer handler
@@ -83,6 +87,15 @@ namespace Hypertable {
     /// variables, and performs a join on each pipeline thread.
     void shutdown();
 
+    /// Changes the number of add stage (add_and_respond()) worker threads.
+    /// Additional workers are spawned immediately; when shrinking, excess
+    /// workers exit the next time they wake up.  Contexts are applied under
+    /// per-range locks and carry monotonic revisions, so concurrent workers
+    /// preserve correctness, though with more than one worker the order in
+    /// which committed contexts become scannable is no longer strictly FIFO.
+    /// @param count Desired worker count (clamped to a minimum of 1)
+    void set_add_stage_worker_count(int32_t count);
+
   private:
 
     /// Thread function for stage 1 of update pipeline.
@@ -167,6 +180,13 @@ namespace Hypertable {
     /// Update pipeline threads
     std::vector<std::thread> m_threads;
 
+    /// Target add stage worker count (protected by #m_response_queue_mutex)
+    int32_t m_add_worker_target {1};
+
+    /// Count of running add stage workers (protected by
+    /// #m_response_queue_mutex)
+    int32_t m_add_workers_active {};
+
     /// Last (largest) assigned revision number
     int64_t m_last_revision {TIMESTAMP_MIN};
 
@@ -182,6 +202,13 @@ namespace Hypertable {
     /// Maximum allowable clock skew
     int32_t m_max_clock_skew {};
 
+    /// Flag indicating if cell caches insert large values by reference
+    bool m_cell_cache_zero_copy {};
+
+    /// Bytes reserved at the head of go buffers for in-place commit log
+    /// block framing (0 when the log compresses blocks)
+    size_t m_log_header_reserve {};
+
     /// Commit log flush flag (NONE, FLUSH, or SYNC)
     Filesystem::Flags m_flags {};
 
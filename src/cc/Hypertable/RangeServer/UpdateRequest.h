@@ -31,6 +31,7 @@
 
 #include <Common/StaticBuffer.h>
 
+#include <functional>
 #include <vector>
 
 namespace Hypertable {
@@ -53,6 +54,10 @@ namespace Hypertable {
   /// Holds client update request and error state.
   class UpdateRequest {
   public:
+    ~UpdateRequest() {
+      if (completion)
+        completion();
+    }
     /// Update buffer containing serialized key/value pairs
     StaticBuffer buffer;
     /// Count of serialized key/value pairs in #buffer
@@ -63,6 +68,9 @@ namespace Hypertable {
     std::vector<SendBackRec> send_back_vector;
     /// Error code that applies to entire buffer
     uint32_t error {};
+    /// Optional hook invoked when the request is destroyed, after its
+    /// response has been sent
+    std::function<void()> completion;
   };
 
   /// @}
@@ -0,0 +1,138 @@
+/*
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/// @file
+/// Definitions for UpdateThrottle.
+/// This file contains type definitions for UpdateThrottle, a class that
+/// implements per-client token bucket admission control for updates.
+
+#include <Common/Compat.h>
+
+#include "UpdateThrottle.h"
+
+#include <Common/Logger.h>
+
+#include <algorithm>
+
+using namespace Hypertable;
+using namespace std;
+
+namespace {
+  /// Buckets idle for this long no longer count as active writers
+  const int64_t IDLE_EXPIRE_MILLIS = 10000;
+  /// Wait granularity while blocked on token refill
+  const int64_t REFILL_WAIT_MILLIS = 50;
+}
+
+UpdateThrottle::UpdateThrottle(PropertiesPtr &props) {
+  m_rate =
+    props->get_i64("Hypertable.RangeServer.UpdatePipeline.Throttle.Rate");
+
+  vector<String> specs = props->get_strs(
+      "Hypertable.RangeServer.UpdatePipeline.Throttle.TableWeights");
+  for (const auto &spec : specs) {
+    size_t offset = spec.find_last_of(':');
+    if (offset == string::npos || offset == 0 ||
+        offset == spec.length() - 1) {
+      HT_WARNF("Invalid table weight spec '%s' (expected <table-id>:<weight>)",
+               spec.c_str());
+      continue;
+    }
+    uint32_t weight = (uint32_t)atoi(spec.substr(offset + 1).c_str());
+    if (weight == 0) {
+      HT_WARNF("Invalid table weight spec '%s' (weight must be non-zero)",
+               spec.c_str());
+      continue;
+    }
+    m_table_weights[spec.substr(0, offset)] = weight;
+  }
+}
+
+
+void UpdateThrottle::admit(const InetAddr &addr, const TableIdentifier &table,
+                           uint32_t amount, ClockT::time_point deadline,
+                           bool engaged) {
+  if (!engaged || m_rate == 0)
+    return;
+
+  uint32_t weight = 1;
+  if (!m_table_weights.empty() && table.id) {
+    auto witer = m_table_weights.find(table.id);
+    if (witer != m_table_weights.end())
+      weight = witer->second;
+  }
+
+  // Higher weight tables consume proportionally fewer tokens
+  int64_t cost = std::max((int64_t)(amount / weight), (int64_t)1);
+
+  string key = addr.format();
+
+  unique_lock<mutex> lock(m_mutex);
+
+  Bucket &bucket = m_buckets[key];
+  auto now = chrono::steady_clock::now();
+  if (bucket.last_refill == chrono::steady_clock::time_point())
+    bucket.last_refill = now;
+
+  while (true) {
+
+    expire_idle(key, now);
+
+    // Each active client gets an even share of the aggregate rate, with
+    // burst capacity of one second's worth of tokens
+    int64_t per_client = m_rate / (int64_t)m_buckets.size();
+    int64_t elapsed_millis = chrono::duration_cast<chrono::milliseconds>(
+        now - bucket.last_refill).count();
+    if (elapsed_millis > 0) {
+      bucket.tokens = std::min(bucket.tokens
+                               + (per_client * elapsed_millis) / 1000,
+                               per_client);
+      bucket.last_refill = now;
+    }
+    bucket.last_used = now;
+
+    if (bucket.tokens >= cost)
+      break;
+
+    // At the deadline the update is admitted anyway, driving the bucket
+    // negative; the client pays the debt out of future refills
+    if (ClockT::now() >= deadline)
+      break;
+
+    m_cond.wait_for(lock, chrono::milliseconds(REFILL_WAIT_MILLIS));
+    now = chrono::steady_clock::now();
+  }
+
+  bucket.tokens -= cost;
+}
+
+
+void UpdateThrottle::expire_idle(const string &current,
+                                 chrono::steady_clock::time_point now) {
+  for (auto iter = m_buckets.begin(); iter != m_buckets.end(); ) {
+    if (iter->first != current &&
+        chrono::duration_cast<chrono::milliseconds>(
+            now - iter->second.last_used).count() > IDLE_EXPIRE_MILLIS)
+      iter = m_buckets.erase(iter);
+    else
+      ++iter;
+  }
+}
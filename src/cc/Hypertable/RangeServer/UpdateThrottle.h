@@ -0,0 +1,135 @@
+/* -*- c++ -*-
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/// @file
+/// Declarations for UpdateThrottle.
+/// This file contains type declarations for UpdateThrottle, a class that
+/// implements per-client token bucket admission control for updates.
+
+#ifndef Hypertable_RangeServer_UpdateThrottle_h
+#define Hypertable_RangeServer_UpdateThrottle_h
+
+#include <Hypertable/Lib/TableIdentifier.h>
+
+#include <AsyncComm/Clock.h>
+
+#include <Common/InetAddr.h>
+#include <Common/Properties.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace Hypertable {
+
+  /// @addtogroup RangeServer
+  /// @{
+
+  /// Per-client token bucket admission control for updates.
+  /// When engaged, each client connection draws tokens from its own bucket,
+  /// with the aggregate refill rate (the
+  /// <code>Hypertable.RangeServer.UpdatePipeline.Throttle.Rate</code>
+  /// property, in bytes per second) divided evenly among the clients that
+  /// have written recently.  Callers that exhaust their bucket block in
+  /// admit() until tokens refill or their request deadline arrives, so
+  /// backpressure slows each writer in proportion to its ingest instead of
+  /// stalling all updates wholesale.  Updates to tables listed in the
+  /// <code>Hypertable.RangeServer.UpdatePipeline.Throttle.TableWeights</code>
+  /// property (entries of the form <i>table-id</i>:<i>weight</i>) consume
+  /// tokens at <code>1/weight</code> of their byte count, so higher weight
+  /// tables degrade less under pressure.
+  class UpdateThrottle {
+  public:
+
+    /// Constructor.
+    /// Initializes #m_rate from the
+    /// <code>Hypertable.RangeServer.UpdatePipeline.Throttle.Rate</code>
+    /// property and #m_table_weights from the
+    /// <code>Hypertable.RangeServer.UpdatePipeline.Throttle.TableWeights</code>
+    /// property.
+    /// @param props Configuration properties
+    UpdateThrottle(PropertiesPtr &props);
+
+    /// Admits an update through the throttle.
+    /// Returns immediately when <code>engaged</code> is <i>false</i> or the
+    /// configured rate is zero.  Otherwise charges
+    /// <code>amount</code> (divided by the table's weight) against the
+    /// bucket for <code>addr</code>, blocking until enough tokens have
+    /// accumulated or <code>deadline</code> is reached.  At the deadline the
+    /// update is admitted with its bucket driven negative, so the client
+    /// pays the debt out of future refills rather than having the request
+    /// fail outright.
+    /// @param addr Originating client address
+    /// @param table %Table being updated
+    /// @param amount Size of update in bytes
+    /// @param deadline Request deadline
+    /// @param engaged <i>true</i> if admission control is currently engaged
+    void admit(const InetAddr &addr, const TableIdentifier &table,
+               uint32_t amount, ClockT::time_point deadline, bool engaged);
+
+  private:
+
+    /// Token bucket state for one client connection
+    struct Bucket {
+      /// Available tokens (bytes); negative after a deadline admission
+      int64_t tokens {};
+      /// Time of last refill
+      std::chrono::steady_clock::time_point last_refill;
+      /// Time of last admission attempt (idle buckets get expired)
+      std::chrono::steady_clock::time_point last_used;
+    };
+
+    /// Removes buckets that have been idle for several seconds.
+    /// The bucket for <code>current</code> is retained.  Expiring idle
+    /// buckets keeps the per-client share of #m_rate proportional to the
+    /// set of active writers.
+    /// @param current Key of bucket to retain
+    /// @param now Current time
+    void expire_idle(const std::string &current,
+                     std::chrono::steady_clock::time_point now);
+
+    /// %Mutex protecting #m_buckets
+    std::mutex m_mutex;
+
+    /// Condition variable used to wait for token refill
+    std::condition_variable m_cond;
+
+    /// Token buckets keyed by client address
+    std::unordered_map<std::string, Bucket> m_buckets;
+
+    /// Per-table token weights keyed by table ID
+    std::unordered_map<std::string, uint32_t> m_table_weights;
+
+    /// Aggregate admission rate in bytes per second (0 disables throttling)
+    int64_t m_rate {};
+  };
+
+  /// Smart pointer to UpdateThrottle
+  typedef std::shared_ptr<UpdateThrottle> UpdateThrottlePtr;
+
+  /// @}
+
+}
+
+#endif // Hypertable_RangeServer_UpdateThrottle_h
@@ -40,7 +40,10 @@
 #include <Common/Init.h>
 #include <Common/InetAddr.h>
 #include <Common/Logger.h>
+#include <Common/RequestTracer.h>
 #include <Common/System.h>
+#include <Common/ThreadActivity.h>
+#include <Common/ThreadAffinity.h>
 #include <Common/Usage.h>
 
 #include <cstdlib>
@@ -71,6 +74,25 @@ int main(int argc, char **argv) {
       FailureInducer::instance->parse_option(get_str("induce-failure"));
     }
 
+    int32_t trace_sampling_period
+      = get_i32("Hypertable.RangeServer.Tracing.SamplingPeriod");
+    if (trace_sampling_period > 0 && RequestTracer::instance == 0)
+      RequestTracer::instance = new RequestTracer(trace_sampling_period);
+
+    // SIGUSR1 dumps per-thread activity to the log
+    ThreadActivity::install_signal_handler();
+
+    // Thread topology; must be configured before any of the thread pools
+    // are created, the first of which start with Comm::instance() below
+    ThreadAffinity::add_role("comm-reactor",
+        get_str("Hypertable.RangeServer.CpuAffinity.Reactor"));
+    ThreadAffinity::add_role("app-queue",
+        get_str("Hypertable.RangeServer.CpuAffinity.Workers"));
+    ThreadAffinity::add_role("maint",
+        get_str("Hypertable.RangeServer.CpuAffinity.Maintenance"));
+    ThreadAffinity::add_role("upd",
+        get_str("Hypertable.RangeServer.CpuAffinity.UpdatePipeline"));
+
     // issue 851: don't start if config files are missing
     if (!FileUtils::exists(System::install_dir + "/conf/METADATA.xml"))
       HT_FATALF("%s/conf/METADATA.xml is missing, aborting...",
@@ -84,7 +106,12 @@ int main(int argc, char **argv) {
     Global::conn_manager = conn_manager;
 
     int worker_count = get_i32("Hypertable.RangeServer.Workers");
-    Global::app_queue = make_shared<ApplicationQueue>(worker_count);
+    std::vector<int32_t> lane_weights;
+    lane_weights.push_back(get_i32("Hypertable.RangeServer.AppQueue.LaneWeight.High"));
+    lane_weights.push_back(get_i32("Hypertable.RangeServer.AppQueue.LaneWeight.Normal"));
+    lane_weights.push_back(get_i32("Hypertable.RangeServer.AppQueue.LaneWeight.Low"));
+    Global::app_queue = make_shared<ApplicationQueue>(worker_count, true,
+                                                      lane_weights);
 
     /**
      * Connect to Hyperspace
@@ -176,5 +176,28 @@ int main(int argc, char **argv) {
 
   delete cache;
 
+  /**
+   * Now verify that a probationary insertion is evicted before older
+   * normally admitted entries, regardless of insertion order
+   */
+  cache = new FileBlockCache(TARGET_BUFSIZE*3, TARGET_BUFSIZE*3, false);
+  for (file_offset=0; file_offset<3; file_offset++) {
+    block = new uint8_t [ TARGET_BUFSIZE ];
+    HT_EXPECT(cache->insert(1, file_offset, block, TARGET_BUFSIZE, EventPtr(),
+                            false, file_offset == 1),
+              Error::FAILED_EXPECTATION);
+  }
+  // Cache is full; this insert must evict the probationary block (offset 1)
+  block = new uint8_t [ TARGET_BUFSIZE ];
+  HT_EXPECT(cache->insert(1, 3, block, TARGET_BUFSIZE, EventPtr(), false),
+            Error::FAILED_EXPECTATION);
+  if (!cache->contains(1, 0) || cache->contains(1, 1) ||
+      !cache->contains(1, 2) || !cache->contains(1, 3)) {
+    HT_ERROR("probationary insertion was not evicted first");
+    return 1;
+  }
+
+  delete cache;
+
   return 0;
 }
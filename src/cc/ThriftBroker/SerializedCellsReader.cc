@@ -27,6 +27,8 @@
 #include <Common/Logger.h>
 #include <Common/Serialization.h>
 
+#include <cstring>
+
 using namespace Hypertable;
 
 bool SerializedCellsReader::next() {
@@ -57,7 +59,11 @@ bool SerializedCellsReader::next() {
   else
     m_revision = TIMESTAMP_NULL;
 
+  // The three string fields are validated and skipped with memchr, which
+  // libc vectorizes, rather than a byte-at-a-time scan
+
   // row; if empty then use the previous row
+  const uint8_t *nul;
   m_row = (const char *)m_ptr;
   if (!*m_row) {
     if (m_previous_row == 0)
@@ -67,34 +73,29 @@ bool SerializedCellsReader::next() {
     m_ptr++;
   }
   else {
-    while (*m_ptr && m_ptr<m_end)
-      m_ptr++;
-    if (m_ptr == m_end)
+    if ((nul = (const uint8_t *)memchr(m_ptr, 0, m_end - m_ptr)) == 0)
       HT_THROW(Error::SERIALIZATION_INPUT_OVERRUN, "");
-    m_ptr++;
+    m_ptr = nul + 1;
     m_previous_row = m_row;
   }
 
   // column_family
   m_column_family = (const char *)m_ptr;
-  while (*m_ptr && m_ptr<m_end)
-    m_ptr++;
-  if (m_ptr == m_end)
+  if ((nul = (const uint8_t *)memchr(m_ptr, 0, m_end - m_ptr)) == 0)
     HT_THROW(Error::SERIALIZATION_INPUT_OVERRUN, "");
-  m_ptr++;
+  m_ptr = nul + 1;
 
   // column_qualifier
   m_column_qualifier = (const char *)m_ptr;
-  while (*m_ptr && m_ptr<m_end)
-    m_ptr++;
-  if (m_ptr == m_end)
+  if ((nul = (const uint8_t *)memchr(m_ptr, 0, m_end - m_ptr)) == 0)
     HT_THROW(Error::SERIALIZATION_INPUT_OVERRUN, "");
-  m_ptr++;
+  m_ptr = nul + 1;
 
   remaining = m_end - m_ptr;
   m_value_len = Serialization::decode_i32(&m_ptr, &remaining);
 
-  if (m_value_len > remaining)
+  // account for the trailing cell flag byte as well
+  if (m_value_len >= remaining)
     HT_THROW(Error::SERIALIZATION_INPUT_OVERRUN, "");
 
   m_value = m_ptr;
@@ -44,7 +44,7 @@ bool SerializedCellsWriter::add(const char *row, const char *column_family,
 
   bool need_row = false;
   if (row_length != m_previous_row_length
-      || (m_previous_row_offset >= 0 && memcmp(row, m_buf.base + m_previous_row_offset, row_length)))
+      || (m_previous_row_offset >= 0 && memcmp(row, m_buf.data() + m_previous_row_offset, row_length)))
     need_row = true;
 
   if (!value && value_length)
@@ -52,7 +52,7 @@ bool SerializedCellsWriter::add(const char *row, const char *column_family,
 
   int32_t length = 9 + column_family_length + 3
       + column_qualifier_length + value_length + 1;
-  if (m_buf.empty())  // Add version to beginning of buffer
+  if (m_fill == 0)  // Add version to beginning of buffer
     length += 4;
   if (need_row)
     length += row_length;
@@ -64,66 +64,66 @@ bool SerializedCellsWriter::add(const char *row, const char *column_family,
     length += 8;
   }
 
-  // need to leave room for the termination byte
-  if (length > (int32_t)m_buf.remaining()) {
-    if (m_grow)
-      m_buf.ensure(length);
-    else {
-      if (!m_buf.empty())
-        return false;
-      m_buf.grow(length);
-    }
-  }
+  // non-growing writers stop accepting cells at the size limit, but always
+  // make room for at least one cell
+  if (!m_grow && m_fill > 0 && m_fill + length > m_limit)
+    return false;
+
+  // leave room for the termination byte
+  uint8_t *ptr = ensure(length + 1);
+  uint8_t *base = ptr;
 
   // version
-  if (m_buf.empty())
-    Serialization::encode_i32(&m_buf.ptr, SerializedCellsVersion::SCVERSION);
+  if (m_fill == 0)
+    Serialization::encode_i32(&ptr, SerializedCellsVersion::SCVERSION);
 
   // flag byte
-  *m_buf.ptr++ = flag;
+  *ptr++ = flag;
 
   // timestamp
   if ((flag & SerializedCellsFlag::HAVE_TIMESTAMP) != 0)
-    Serialization::encode_i64(&m_buf.ptr, timestamp);
+    Serialization::encode_i64(&ptr, timestamp);
 
   // revision
   if ((flag & SerializedCellsFlag::HAVE_REVISION) &&
       (flag & SerializedCellsFlag::REV_IS_TS) == 0)
-    Serialization::encode_i64(&m_buf.ptr, 0);
+    Serialization::encode_i64(&ptr, 0);
 
   // row; only write it if it's not identical to the previous row
   if (need_row) {
-    memcpy(m_buf.ptr, row, row_length);
-    m_previous_row_offset = m_buf.ptr - m_buf.base;
-    m_buf.ptr += row_length;
+    memcpy(ptr, row, row_length);
+    m_previous_row_offset = m_fill + (ptr - base);
+    ptr += row_length;
     m_previous_row_length = row_length;
   }
-  *m_buf.ptr++ = 0;
+  *ptr++ = 0;
 
   // column_family
   if (column_family)
-    memcpy(m_buf.ptr, column_family, column_family_length);
-  m_buf.ptr += column_family_length;
-  *m_buf.ptr++ = 0;
+    memcpy(ptr, column_family, column_family_length);
+  ptr += column_family_length;
+  *ptr++ = 0;
 
   // column_qualifier
   if (column_qualifier)
-    memcpy(m_buf.ptr, column_qualifier, column_qualifier_length);
-  m_buf.ptr += column_qualifier_length;
-  *m_buf.ptr++ = 0;
+    memcpy(ptr, column_qualifier, column_qualifier_length);
+  ptr += column_qualifier_length;
+  *ptr++ = 0;
 
-  Serialization::encode_i32(&m_buf.ptr, value_length);
+  Serialization::encode_i32(&ptr, value_length);
   if (value)
-    memcpy(m_buf.ptr, value, value_length);
-  m_buf.ptr += value_length;
-  Serialization::encode_i8(&m_buf.ptr, cell_flag);
+    memcpy(ptr, value, value_length);
+  ptr += value_length;
+  Serialization::encode_i8(&ptr, cell_flag);
+
+  m_fill += ptr - base;
 
   return true;
 }
 
 
-void SerializedCellsWriter::clear() { 
-  m_buf.clear();
+void SerializedCellsWriter::clear() {
+  m_fill = 0;
   m_previous_row_offset = -1;
   m_previous_row_length = 0;
   m_finalized = false;
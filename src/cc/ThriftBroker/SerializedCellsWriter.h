@@ -20,21 +20,32 @@
 #ifndef HYPERTABLE_SERIALIZEDCELLSWRITER_H
 #define HYPERTABLE_SERIALIZEDCELLSWRITER_H
 
-#include "Common/DynamicBuffer.h"
+#include "Common/Serialization.h"
 
 #include "Hypertable/Lib/Cell.h"
 #include "Hypertable/Lib/KeySpec.h"
 
 #include "SerializedCellsFlag.h"
 
+#include <algorithm>
+#include <string>
+
 namespace Hypertable {
 
+  /** Serializes cells into a flat buffer.
+   * The buffer is built directly in a std::string so that a completed batch
+   * can be handed to the Thrift transport layer with take() without an
+   * intermediate copy.  clear() retains the underlying allocation, allowing
+   * a writer to be reused as an arena across batches.
+   */
   class SerializedCellsWriter {
   public:
- 
+
     SerializedCellsWriter(int32_t size, bool grow = false)
-      :  m_buf(size), m_finalized(false), m_grow(grow),
-         m_previous_row_offset(-1), m_previous_row_length(0) { }
+      :  m_limit(size), m_finalized(false), m_grow(grow),
+         m_previous_row_offset(-1), m_previous_row_length(0) {
+      m_buf.reserve(size);
+    }
 
     bool add(Cell &cell) {
       return add(cell.row_key, cell.column_family, cell.column_qualifier,
@@ -55,32 +66,57 @@ namespace Hypertable {
 			 uint8_t cell_flag = FLAG_INSERT);
 
     void finalize(uint8_t flag) {
-      if (m_grow)
-        m_buf.ensure(m_buf.empty() ? 5 : 1);
-      if (m_buf.empty())
-        Serialization::encode_i32(&m_buf.ptr, SerializedCellsVersion::SCVERSION);
-      *m_buf.ptr++ = SerializedCellsFlag::EOB | flag;
+      uint8_t *ptr = ensure(m_fill == 0 ? 5 : 1);
+      uint8_t *base = ptr;
+      if (m_fill == 0)
+        Serialization::encode_i32(&ptr, SerializedCellsVersion::SCVERSION);
+      *ptr++ = SerializedCellsFlag::EOB | flag;
+      m_fill += ptr - base;
       m_finalized = true;
     }
 
-    uint8_t *get_buffer() { return m_buf.base; }
-    uint8_t *get_buffer() const { return m_buf.base; }
-    int32_t get_buffer_length() { return m_buf.fill(); }
-    int32_t get_buffer_length() const { return m_buf.fill(); }
+    uint8_t *get_buffer() { return (uint8_t *)m_buf.data(); }
+    uint8_t *get_buffer() const { return (uint8_t *)m_buf.data(); }
+    int32_t get_buffer_length() { return m_fill; }
+    int32_t get_buffer_length() const { return m_fill; }
 
     void get_buffer(const uint8_t **bufp, int32_t *lenp) {
       if (!m_finalized)
         finalize(SerializedCellsFlag::EOB);
-      *bufp = m_buf.base;
-      *lenp = m_buf.fill();
+      *bufp = (const uint8_t *)m_buf.data();
+      *lenp = m_fill;
+    }
+
+    /** Hands the finalized buffer off to <code>target</code> without
+     * copying, leaving this writer cleared.
+     */
+    void take(std::string &target) {
+      if (!m_finalized)
+        finalize(SerializedCellsFlag::EOB);
+      m_buf.resize(m_fill);
+      target.swap(m_buf);
+      m_buf.clear();
+      clear();
     }
 
-    bool empty() { return m_buf.empty(); }
+    bool empty() { return m_fill == 0; }
 
     void clear();
 
   private:
-    DynamicBuffer m_buf;
+
+    /// Makes room for <code>len</code> more bytes and returns a write
+    /// pointer to the current end of the buffer
+    uint8_t *ensure(int32_t len) {
+      if (m_fill + len > (int32_t)m_buf.size())
+        m_buf.resize(std::max((size_t)(m_fill + len),
+                              m_buf.size() + m_buf.size() / 2));
+      return (uint8_t *)&m_buf[m_fill];
+    }
+
+    std::string m_buf;
+    int32_t m_fill {};
+    int32_t m_limit;
     bool m_finalized;
     bool m_grow;
     int  m_previous_row_offset;
@@ -47,6 +47,7 @@
 #include <Common/Logger.h>
 #include <Common/Random.h>
 #include <Common/System.h>
+#include <Common/Thread.h>
 #include <Common/Time.h>
 
 #include <concurrency/ThreadManager.h>
@@ -59,8 +60,11 @@
 
 #include <boost/shared_ptr.hpp>
 
+#include <atomic>
+#include <condition_variable>
 #include <iostream>
 #include <iomanip>
+#include <list>
 #include <map>
 #include <memory>
 #include <mutex>
@@ -239,17 +243,36 @@ typedef std::vector<CellAsArray> ThriftCellsAsArrays;
 class Context {
 public:
   Context() {
-    client = new Hypertable::Client();
+    int32_t pool_size = Config::get_i32("ThriftBroker.Client.PoolSize");
+    if (pool_size < 1)
+      pool_size = 1;
+    client_pool.reserve(pool_size);
+    for (int32_t i = 0; i < pool_size; i++)
+      client_pool.push_back(new Hypertable::Client());
     log_api = Config::get_bool("ThriftBroker.API.Logging");
     next_threshold = Config::get_i32("ThriftBroker.NextThreshold");
     future_capacity = Config::get_i32("ThriftBroker.Future.Capacity");
+    scanner_prefetch_window =
+      Config::get_i32("ThriftBroker.Scanner.PrefetchWindow");
   }
-  Hypertable::Client *client;
+
+  /// Returns the next pooled client session (round robin).  Handlers pick a
+  /// session once at construction; Table and Namespace objects are shared
+  /// within each session via its TableCache and NamespaceCache.
+  Hypertable::Client *get_client() {
+    return client_pool[m_next_client++ % client_pool.size()];
+  }
+
+  std::vector<Hypertable::Client *> client_pool;
   std::mutex shared_mutator_mutex;
   SharedMutatorMap shared_mutator_map;
   bool log_api;
   ::uint32_t next_threshold;
   ::uint32_t future_capacity;
+  ::int32_t scanner_prefetch_window;
+
+private:
+  std::atomic<size_t> m_next_client {0};
 };
 
 int64_t
@@ -613,7 +636,7 @@ int32_t convert_cells(Hypertable::Cells &hcells, CellsSerialized &tcells) {
     writer.add(hcells[ii]);
   }
   writer.finalize(SerializedCellsFlag::EOS);
-  tcells = String((char *)writer.get_buffer(), writer.get_buffer_length());
+  writer.take(tcells);
   amount = tcells.size();
   return amount;
 }
@@ -875,6 +898,116 @@ void convert_schema(const ThriftGen::Schema &tschema,
 
 }
 
+/** Prefetches serialized scan result batches ahead of client polls.
+ * A dedicated thread pulls cells from the scanner and keeps up to a
+ * window of finalized SerializedCells batches queued, so that each
+ * scanner_get_cells_serialized poll returns immediately instead of
+ * paying a full scan round trip.  The window bounds broker memory and
+ * acts as flow control against slow consumers.
+ */
+class SerializedCellsPrefetcher {
+public:
+  SerializedCellsPrefetcher(ClientObjectPtr scanner_obj,
+                            TableScanner *scanner, ::uint32_t batch_size,
+                            ::int32_t window)
+    : m_scanner_obj(scanner_obj), m_scanner(scanner),
+      m_batch_size(batch_size), m_window(window) {
+    m_thread = Thread([this]() { run(); });
+  }
+
+  ~SerializedCellsPrefetcher() {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_shutdown = true;
+      m_cond.notify_all();
+    }
+    m_thread.join();
+    delete m_error;
+  }
+
+  /// Hands the next prefetched batch to <code>result</code>, blocking
+  /// until one is available
+  void next_batch(std::string &result) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_cond.wait(lock, [this]() {
+        return !m_queue.empty() || m_done || m_error; });
+    if (m_queue.empty()) {
+      if (m_error)
+        throw Exception(*m_error);
+      // scan drained; hand back an empty end-of-scan buffer
+      SerializedCellsWriter writer(8);
+      writer.finalize(SerializedCellsFlag::EOS);
+      writer.take(result);
+      return;
+    }
+    result.swap(m_queue.front());
+    m_queue.pop_front();
+    m_cond.notify_all();
+  }
+
+private:
+
+  void run() {
+    SerializedCellsWriter writer(m_batch_size);
+    Hypertable::Cell cell;
+    bool eos = false;
+
+    try {
+      while (!eos) {
+        {
+          std::unique_lock<std::mutex> lock(m_mutex);
+          m_cond.wait(lock, [this]() {
+              return m_shutdown || (::int32_t)m_queue.size() < m_window; });
+          if (m_shutdown)
+            return;
+        }
+        while (true) {
+          if (m_scanner->next(cell)) {
+            if (!writer.add(cell)) {
+              writer.finalize(SerializedCellsFlag::EOB);
+              m_scanner->unget(cell);
+              break;
+            }
+          }
+          else {
+            writer.finalize(SerializedCellsFlag::EOS);
+            eos = true;
+            break;
+          }
+        }
+        std::string batch;
+        writer.take(batch);
+        {
+          std::lock_guard<std::mutex> lock(m_mutex);
+          m_queue.push_back(std::string());
+          m_queue.back().swap(batch);
+          if (eos)
+            m_done = true;
+          m_cond.notify_all();
+        }
+      }
+    }
+    catch (Exception &e) {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_error = new Exception(e);
+      m_cond.notify_all();
+    }
+  }
+
+  ClientObjectPtr m_scanner_obj;
+  TableScanner *m_scanner;
+  ::uint32_t m_batch_size;
+  ::int32_t m_window;
+  std::mutex m_mutex;
+  std::condition_variable m_cond;
+  Thread m_thread;
+  std::list<std::string> m_queue;
+  Exception *m_error {};
+  bool m_done {};
+  bool m_shutdown {};
+};
+typedef std::shared_ptr<SerializedCellsPrefetcher> SerializedCellsPrefetcherPtr;
+
 class ScannerInfo {
 public:
   ScannerInfo(int64_t ns) : ns(ns), scan_spec_builder(128) { }
@@ -885,6 +1018,7 @@ public:
   const string table;
   ScanSpecBuilder scan_spec_builder;
   int64_t latency {};
+  SerializedCellsPrefetcherPtr prefetcher;
 };
 typedef std::shared_ptr<ScannerInfo> ScannerInfoPtr;
 
@@ -953,7 +1087,7 @@ class ServerHandler : public HqlServiceIf {
 public:
 
   ServerHandler(const String& remote_peer, Context &c)
-    : m_remote_peer(remote_peer), m_context(c) {
+    : m_remote_peer(remote_peer), m_context(c), m_client(c.get_client()) {
   }
 
   virtual ~ServerHandler() {
@@ -1194,7 +1328,7 @@ public:
   void namespace_create(const String &ns) override {
     LOG_API_START("namespace=" << ns);
     try {
-      m_context.client->create_namespace(ns, NULL);
+      m_client->create_namespace(ns, NULL);
     } RETHROW("namespace=" << ns)
     LOG_API_FINISH;
   }
@@ -1387,11 +1521,24 @@ public:
     LOG_API_START("scanner="<< scanner_id);
 
     try {
+      TableScanner *scanner = get_scanner(scanner_id, scanner_info);
+
+      // With a prefetch window configured, batches are built ahead of the
+      // polls by a dedicated thread, eliminating the poll gap
+      if (m_context.scanner_prefetch_window > 0) {
+        if (!scanner_info->prefetcher)
+          scanner_info->prefetcher =
+            make_shared<SerializedCellsPrefetcher>(get_object_ptr(scanner_id),
+                scanner, m_context.next_threshold,
+                m_context.scanner_prefetch_window);
+        scanner_info->prefetcher->next_batch(result);
+        LOG_API_FINISH_E("result.size="<< result.size());
+        return;
+      }
+
       SerializedCellsWriter writer(m_context.next_threshold);
       Hypertable::Cell cell;
 
-      TableScanner *scanner = get_scanner(scanner_id, scanner_info);
-
       while (1) {
         if (scanner->next(cell)) {
           if (!writer.add(cell)) {
@@ -1406,7 +1553,7 @@ public:
         }
       }
 
-      result = String((char *)writer.get_buffer(), writer.get_buffer_length());
+      writer.take(result);
     } RETHROW("scanner="<< scanner_id);
     LOG_API_FINISH_E("result.size="<< result.size());
   }
@@ -1450,7 +1597,7 @@ public:
     LOG_API_START("scanner="<< scanner_id);
 
     try {
-      SerializedCellsWriter writer(0, true);
+      SerializedCellsWriter writer(serialized_hint(), true);
       Hypertable::Cell cell;
       std::string prev_row;
 
@@ -1479,7 +1626,8 @@ public:
         }
       }
 
-      result = String((char *)writer.get_buffer(), writer.get_buffer_length());
+      writer.take(result);
+      update_serialized_hint(result.size());
     } RETHROW("scanner="<< scanner_id)
     LOG_API_FINISH_E(" result.size="<< result.size());
   }
@@ -1531,7 +1679,7 @@ public:
     LOG_API_START("namespace=" << ns << " table="<< table <<" row"<< row);
 
     try {
-      SerializedCellsWriter writer(0, true);
+      SerializedCellsWriter writer(serialized_hint(), true);
       Hypertable::Namespace *namespace_ptr = get_namespace(ns);
       TablePtr t = namespace_ptr->open_table(table);
       Hypertable::ScanSpec ss;
@@ -1545,7 +1693,8 @@ public:
         writer.add(cell);
       writer.finalize(SerializedCellsFlag::EOS);
 
-      result = String((char *)writer.get_buffer(), writer.get_buffer_length());
+      writer.take(result);
+      update_serialized_hint(result.size());
       LOG_SLOW_QUERY_SCANNER(scanner, get_namespace(ns), table, ss);
     } RETHROW("namespace=" << ns << " table="<< table <<" row"<< row)
     LOG_API_FINISH_E(" result.size="<< result.size());
@@ -1620,7 +1769,7 @@ public:
     try {
       Hypertable::ScanSpec hss;
       convert_scan_spec(ss, hss);
-      SerializedCellsWriter writer(0, true);
+      SerializedCellsWriter writer(serialized_hint(), true);
       TableScannerPtr scanner(_open_scanner(ns, table, hss));
       Hypertable::Cell cell;
 
@@ -1628,7 +1777,8 @@ public:
         writer.add(cell);
       writer.finalize(SerializedCellsFlag::EOS);
 
-      result = String((char *)writer.get_buffer(), writer.get_buffer_length());
+      writer.take(result);
+      update_serialized_hint(result.size());
       LOG_SLOW_QUERY_SCANNER(scanner, get_namespace(ns), table, hss);
     } RETHROW("namespace=" << ns << " table="<< table <<" scan_spec="<< ss)
     LOG_API_FINISH_E(" result.size="<< result.size());
@@ -1892,10 +2042,37 @@ public:
   }
 
   ThriftGen::Namespace namespace_open(const String &ns) override {
-    ThriftGen::Namespace id;
+    ThriftGen::Namespace id = 0;
     LOG_API_START("namespace =" << ns);
     try {
-      id = get_cached_object_id( dynamic_pointer_cast<ClientObject>(m_context.client->open_namespace(ns)) );
+      String name = ns;
+      Hypertable::Namespace::canonicalize(&name);
+      {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_namespace_id_map.find(name);
+        if (it != m_namespace_id_map.end()) {
+          m_namespace_use_map[it->second].second++;
+          id = it->second;
+        }
+      }
+      if (id == 0) {
+        // The Namespace object comes out of the client session's shared
+        // NamespaceCache; the id handed to this connection is just a
+        // reference counted view onto it
+        ClientObjectPtr nsp =
+          dynamic_pointer_cast<ClientObject>(m_client->open_namespace(name));
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_namespace_id_map.find(name);
+        if (it != m_namespace_id_map.end()) {
+          m_namespace_use_map[it->second].second++;
+          id = it->second;
+        }
+        else {
+          while (!m_cached_object_map.insert(make_pair(id = Random::number32(), nsp)).second || id == 0); // no overwrite
+          m_namespace_id_map[name] = id;
+          m_namespace_use_map[id] = make_pair(name, 1);
+        }
+      }
     } RETHROW("namespace " << ns)
     LOG_API_FINISH_E(" id=" << id);
     return id;
@@ -2243,7 +2420,7 @@ public:
     bool exists;
     LOG_API_START("namespace=" << ns);
     try {
-      exists = m_context.client->exists_namespace(ns);
+      exists = m_client->exists_namespace(ns);
     } RETHROW("namespace=" << ns)
     LOG_API_FINISH_E(" exists=" << exists);
     return exists;
@@ -2402,7 +2579,7 @@ public:
   void namespace_drop(const String &ns, const bool if_exists) override {
     LOG_API_START("namespace=" << ns << " if_exists=" << if_exists);
     try {
-      m_context.client->drop_namespace(ns, NULL, if_exists);
+      m_client->drop_namespace(ns, NULL, if_exists);
     }
     RETHROW("namespace=" << ns << " if_exists=" << if_exists)
     LOG_API_FINISH;
@@ -2656,7 +2833,7 @@ public:
   void run_hql_interp(const ThriftGen::Namespace ns, const String &hql,
           HqlInterpreter::Callback &cb) {
     Hypertable::Namespace *namespace_ptr = get_namespace(ns);
-    HqlInterpreterPtr interp(m_context.client->create_hql_interpreter(true));
+    HqlInterpreterPtr interp(m_client->create_hql_interpreter(true));
     interp->set_namespace(namespace_ptr->get_name());
     interp->execute(hql, cb);
   }
@@ -2724,6 +2901,12 @@ public:
     return (it != m_object_map.end()) ? it->second.get() : 0;
   }
 
+  ClientObjectPtr get_object_ptr(int64_t id) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ObjectMap::iterator it = m_object_map.find(id);
+    return (it != m_object_map.end()) ? it->second : ClientObjectPtr();
+  }
+
   ClientObject *get_cached_object(int64_t id) {
     std::lock_guard<std::mutex> lock(m_mutex);
     ObjectMap::iterator it = m_cached_object_map.find(id);
@@ -2983,7 +3166,30 @@ public:
     }
   }
 
+  /// Returns the running size hint for grow-mode serialized result writers
+  ::uint32_t serialized_hint() {
+    return m_serialized_hint.load(std::memory_order_relaxed);
+  }
+
+  /// Folds a completed batch size into the size hint so subsequent writers
+  /// start with an arena big enough to avoid incremental reallocation
+  void update_serialized_hint(size_t size) {
+    ::uint32_t hint = m_serialized_hint.load(std::memory_order_relaxed);
+    m_serialized_hint.store((hint*3 + (::uint32_t)size) / 4,
+                            std::memory_order_relaxed);
+  }
+
   void remove_namespace(int64_t id) {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      auto it = m_namespace_use_map.find(id);
+      if (it != m_namespace_use_map.end()) {
+        if (--it->second.second > 0)
+          return;
+        m_namespace_id_map.erase(it->second.first);
+        m_namespace_use_map.erase(it);
+      }
+    }
     if (!remove_cached_object(id)) {
       HT_ERROR_OUT << "Bad namespace id - " << id << HT_END;
       THROW_TE(Error::THRIFTBROKER_BAD_NAMESPACE_ID,
@@ -3002,10 +3208,16 @@ public:
 private:
   String m_remote_peer;
   Context &m_context;
+  Hypertable::Client *m_client;
+  std::atomic< ::uint32_t> m_serialized_hint {0};
   std::mutex m_mutex;
   multimap<::int64_t, ClientObjectPtr> m_reference_map;
   ObjectMap m_object_map;
   ObjectMap m_cached_object_map;
+  /// Per-connection namespace views: canonical name to id, and id to
+  /// (canonical name, open count)
+  std::unordered_map<String, ::int64_t> m_namespace_id_map;
+  std::unordered_map< ::int64_t, std::pair<String, int> > m_namespace_use_map;
   std::unordered_map< ::int64_t, ScannerInfoPtr> m_scanner_info_map;
 };
 
@@ -375,6 +375,11 @@ int RangeServerCommandInterpreter::execute_line(const String &line) {
     else if (state.command == COMMAND_HEAPCHECK) {
       m_range_server->heapcheck(m_addr, state.output_file);
     }
+    else if (state.command == COMMAND_LIVESTATE) {
+      String output;
+      m_range_server->get_live_state(m_addr, output);
+      cout << output << flush;
+    }
     else if (state.command == COMMAND_COMPACT) {
       if (table)
         m_range_server->compact(m_addr, *table, state.str, 0);
@@ -22,6 +22,7 @@
 #include <Common/Compat.h>
 
 #include <Hypertable/Lib/CommitLog.h>
+#include <Hypertable/Lib/CommitLogArchiver.h>
 #include <Hypertable/Lib/CommitLogReader.h>
 #include <Hypertable/Lib/LegacyDecoder.h>
 #include <Hypertable/Lib/TableIdentifier.h>
@@ -55,6 +56,7 @@ struct AppPolicy : Config::Policy {
     cmdline_desc("Usage: %s [options] <log-dir>\n\n"
       "  This program dumps the given log's metadata.\n\nOptions")
       .add_options()
+      ("archive-dir", str(), "Merge in archived fragments found under this archive root (see Hypertable.CommitLog.Archive.Directory)")
       ("block-summary", boo()->zero_tokens()->default_value(false), "Display commit log block information only")
       ("display-values", boo()->zero_tokens()->default_value(false), "Display values (assumes they're printable)")
       ("linked-logs", boo()->zero_tokens()->default_value(false), "Display valid (non-deleted) linked logs")
@@ -118,7 +120,13 @@ int main(int argc, char **argv) {
 
     boost::trim_right_if(log_dir, boost::is_any_of("/"));    
 
-    CommitLogReaderPtr log_reader = make_shared<CommitLogReader>(fs, log_dir);
+    bool include_archive = has("archive-dir");
+    if (include_archive)
+      CommitLogArchiver::instance =
+        new CommitLogArchiver(fs, get_str("archive-dir"));
+
+    CommitLogReaderPtr log_reader =
+      make_shared<CommitLogReader>(fs, log_dir, include_archive);
 
     if (block_summary) {
       printf("LOG %s\n", log_dir.c_str());
@@ -31,6 +31,9 @@
 #include <Hypertable/Lib/Config.h>
 #include <Hypertable/Lib/Cells.h>
 
+#include <Common/DiscreteRandomGeneratorZipf.h>
+#include <Common/LatencyHistogram.h>
+#include <Common/Random.h>
 #include <Common/Stopwatch.h>
 #include <Common/String.h>
 #include <Common/Init.h>
@@ -41,12 +44,14 @@
 #include <boost/shared_array.hpp>
 #include <boost/thread/thread.hpp>
 
+#include <atomic>
 #include <chrono>
 #include <cmath>
 #include <cstdio>
 #include <cstdlib>
 #include <fstream>
 #include <iostream>
+#include <map>
 #include <thread>
 
 using namespace Hypertable;
@@ -61,7 +66,10 @@ namespace {
     "Description:\n"
     "  This program is used to generate load on a Hypertable\n"
     "  cluster.  The <type> argument indicates the type of load\n"
-    "  to generate ('query' or 'update').\n\n"
+    "  to generate ('query', 'update' or 'mixed').  The 'mixed'\n"
+    "  type issues a read/write mix over a Zipfian-distributed\n"
+    "  key space of --max-keys rows and reports per-operation\n"
+    "  latency percentiles.\n\n"
     "Options";
 
   struct AppPolicy : Config::Policy {
@@ -77,12 +85,38 @@ namespace {
         ("max-keys", i64(), "Maximum number of keys to generate for query load")
         ("parallel", i32()->default_value(0),
          "Spawn threads to execute requests in parallel")
+        ("pace", i32()->default_value(0),
+         "Issue operations on a fixed schedule of this many per second; "
+         "latencies are measured from the scheduled start time, so backlog "
+         "delay is included (avoids coordinated omission)")
         ("query-delay", i32(), "Delay milliseconds between each query")
+        ("column", str()->default_value("Field"),
+         "Column family written and read by 'mixed' load")
+        ("read-percentage", i32()->default_value(50),
+         "Percentage of operations that are reads in 'mixed' load")
+        ("json-output", str(),
+         "Output file to hold a machine-readable (JSON) run summary")
+        ("value-size", i32()->default_value(1024),
+         "Size of values written by 'mixed' load")
+        ("zipf-s", f64()->default_value(0.8),
+         "Skew parameter 's' of the Zipfian key distribution for 'mixed' load")
         ("query-mode", str(),
          "Whether to query 'index' or 'qualifier' index")
         ("sample-file", str(),
          "Output file to hold request latencies, one per line")
         ("seed", i32()->default_value(1), "Pseudo-random number generator seed")
+        ("tenants", i32()->default_value(0),
+         "Generate multi-tenant row keys:  a Zipf-distributed tenant prefix "
+         "drawn from this many tenants followed by a random 16-character "
+         "suffix, emulating many tenants with skewed per-tenant volume")
+        ("tenant-skew", f64()->default_value(0.8),
+         "Skew parameter 's' of the Zipfian tenant volume distribution "
+         "used with --tenants")
+        ("report-splits", boo()->zero_tokens()->default_value(false),
+         "Poll the target table's range boundaries during the run and "
+         "report splits and moves as they are observed")
+        ("report-splits-interval", i32()->default_value(10000),
+         "Interval in milliseconds between --report-splits polls")
         ("row-seed", i32()->default_value(1), "Pseudo-random number generator seed")
         ("spec-file", str(),
          "File containing the DataGenerator specification")
@@ -137,10 +171,27 @@ void generate_query_load(PropertiesPtr &props, String &tablename,
 void generate_query_load_parallel(PropertiesPtr &props, String &tablename,
         int32_t parallel);
 
+void generate_mixed_load(PropertiesPtr &props, String &tablename,
+        ::uint32_t mutator_flags, bool thrift);
+
+void report_latency_percentiles(const char *label,
+        const LatencyHistogram &histogram);
+
+void write_json_report(const String &fname, const char *load_type,
+        double elapsed, ::uint64_t total_cells, ::uint64_t total_bytes,
+        const LatencyHistogram *insert_histogram,
+        const LatencyHistogram *scan_histogram);
+
 double std_dev(::uint64_t nn, double sum, double sq_sum);
 
 void parse_command_line(int argc, char **argv, PropertiesPtr &props);
 
+void synthesize_tenant_rowkey_spec(PropertiesPtr &props, ::int32_t tenants,
+                                   double skew);
+
+void run_split_monitor(String tablename, ::int32_t interval_ms,
+                       std::atomic<bool> *stop_flag);
+
 
 int main(int argc, char **argv) {
   String table, load_type, spec_file, sample_fname;
@@ -193,6 +244,10 @@ int main(int argc, char **argv) {
 
     parse_command_line(argc, argv, generator_props);
 
+    if (get_i32("tenants") > 0)
+      synthesize_tenant_rowkey_spec(generator_props, get_i32("tenants"),
+                                    get_f64("tenant-skew"));
+
     if (generator_props->has("DataGenerator.MaxBytes") &&
         generator_props->has("DataGenerator.MaxKeys")) {
       HT_ERROR("Only one of 'DataGenerator.MaxBytes' or 'DataGenerator.MaxKeys' may be specified");
@@ -202,6 +257,13 @@ int main(int argc, char **argv) {
     if (generator_props->has("DataGenerator.DeletePercentage"))
       delete_pct = generator_props->get_i32("DataGenerator.DeletePercentage");
 
+    std::atomic<bool> monitor_stop(false);
+    std::thread monitor_thread;
+    if (get_bool("report-splits") && !to_stdout)
+      monitor_thread = std::thread(run_split_monitor, table,
+                                   get_i32("report-splits-interval"),
+                                   &monitor_stop);
+
     if (load_type == "update" && parallel > 0)
       generate_update_load_parallel(generator_props, table, parallel, flush,
                                     mutator_flags, flush_interval,
@@ -242,10 +304,24 @@ int main(int argc, char **argv) {
         generate_query_load(generator_props, table, to_stdout, query_delay,
                 sample_fname, thrift);
     }
+    else if (load_type == "mixed") {
+      if (!generator_props->has("DataGenerator.MaxKeys")
+              && !generator_props->has("max-keys")) {
+        HT_ERROR("'DataGenerator.MaxKeys' or --max-keys must be specified for "
+                "load type 'mixed'");
+        quick_exit(EXIT_FAILURE);
+      }
+      generate_mixed_load(generator_props, table, mutator_flags, thrift);
+    }
     else {
       std::cout << cmdline_desc() << std::flush;
       quick_exit(EXIT_FAILURE);
     }
+
+    if (monitor_thread.joinable()) {
+      monitor_stop = true;
+      monitor_thread.join();
+    }
   }
   catch (Exception &e) {
     HT_ERROR_OUT << e << HT_END;
@@ -303,6 +379,92 @@ void parse_command_line(int argc, char **argv, PropertiesPtr &props) {
 }
 
 
+/**
+ * Synthesizes a two-component row key specification emulating a multi-tenant
+ * workload:  component 0 is a zero-padded tenant number drawn from a Zipfian
+ * distribution over <code>tenants</code> tenants (tenant 0 receives the most
+ * volume), component 1 is a random 16-character suffix.  The fixed-width
+ * prefix keeps each tenant's rows clustered in the key space, so per-tenant
+ * volume skew translates directly into range load skew.
+ */
+void synthesize_tenant_rowkey_spec(PropertiesPtr &props, ::int32_t tenants,
+                                   double skew) {
+  int digits = 1;
+  for (::int32_t t = tenants - 1; t >= 10; t /= 10)
+    digits++;
+  props->set("rowkey.component.0.type", boost::any(String("integer")));
+  props->set("rowkey.component.0.order", boost::any(String("random")));
+  props->set("rowkey.component.0.distribution",
+             boost::any(format("zipf --s=%g", skew)));
+  props->set("rowkey.component.0.min", boost::any(String("0")));
+  props->set("rowkey.component.0.max", boost::any(format("%d", (int)tenants)));
+  props->set("rowkey.component.0.format",
+             boost::any(format("%%0%dlld-", digits)));
+  props->set("rowkey.component.1.type", boost::any(String("string")));
+  props->set("rowkey.component.1.order", boost::any(String("random")));
+  props->set("rowkey.component.1.distribution", boost::any(String("uniform")));
+  props->set("rowkey.component.1.length.min", boost::any(String("16")));
+  props->set("rowkey.component.1.length.max", boost::any(String("16")));
+}
+
+
+/**
+ * Periodically fetches the target table's range boundaries and reports
+ * splits (new end rows) and moves (end rows whose location changed) as they
+ * are observed, so split and balance behavior can be watched live while the
+ * load runs.
+ */
+void run_split_monitor(String tablename, ::int32_t interval_ms,
+                       std::atomic<bool> *stop_flag) {
+  try {
+    ClientPtr client = make_shared<Hypertable::Client>(get_str("config"));
+    NamespacePtr ht_namespace = client->open_namespace("/");
+    std::map<String, String> locations;
+    bool initial = true;
+
+    while (true) {
+      TableSplitsContainer splits;
+      ht_namespace->get_table_splits(tablename, splits);
+
+      std::map<String, String> current;
+      for (auto &split : splits)
+        current[split.end_row ? split.end_row : ""] =
+          split.location ? split.location : "";
+
+      if (initial) {
+        cout << "[split-monitor] table '" << tablename << "' starting with "
+             << current.size() << " range(s)" << endl;
+        initial = false;
+      }
+      else {
+        for (auto &entry : current) {
+          auto iter = locations.find(entry.first);
+          if (iter == locations.end())
+            cout << "[split-monitor] SPLIT:  new range ending at '"
+                 << entry.first << "' on " << entry.second << endl;
+          else if (iter->second != entry.second)
+            cout << "[split-monitor] MOVE:  range ending at '" << entry.first
+                 << "' moved " << iter->second << " -> " << entry.second
+                 << endl;
+        }
+      }
+      locations.swap(current);
+
+      if (*stop_flag)
+        break;
+      for (::int32_t waited = 0; waited < interval_ms && !*stop_flag;
+           waited += 100)
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+    cout << "[split-monitor] table '" << tablename << "' finished with "
+         << locations.size() << " range(s)" << endl;
+  }
+  catch (Exception &e) {
+    HT_ERROR_OUT << "Split monitor - " << e << HT_END;
+  }
+}
+
+
 void
 generate_update_load(PropertiesPtr &props, String &tablename, bool flush,
                      ::uint32_t mutator_flags, ::uint64_t flush_interval,
@@ -317,6 +479,7 @@ generate_update_load(PropertiesPtr &props, String &tablename, bool flush,
   double clocks_per_usec = (double)CLOCKS_PER_SEC / 1000000.0;
   bool output_samples = false;
   ofstream sample_file;
+  LatencyHistogram latency_histogram;
   DataGenerator dg(props);
   ::uint64_t unflushed_data=0;
   ::uint64_t total_bytes = 0;
@@ -442,6 +605,7 @@ generate_update_load(PropertiesPtr &props, String &tablename, bool flush,
           latency = ((std::numeric_limits<clock_t>::max() - start_clocks) + stop_clocks) / clocks_per_usec;
         else
           latency = (stop_clocks-start_clocks) / clocks_per_usec;
+        latency_histogram.add((::int64_t)latency);
         if (output_samples)
           sample_file << (unsigned long)latency << "\n";
         else {
@@ -505,9 +669,16 @@ generate_update_load(PropertiesPtr &props, String &tablename, bool flush,
     printf("  Latency avg (usec): %llu\n", (Llu)((double)cum_latency/total_cells));
     printf("Latency stddev (usec): %llu\n", (Llu)std_dev(total_cells, cum_latency, cum_sq_latency));
   }
+  if (flush)
+    report_latency_percentiles("Insert", latency_histogram);
   printf("\n");
   fflush(stdout);
 
+  if (has("json-output"))
+    write_json_report(get_str("json-output"), "update", stopwatch.elapsed(),
+                      total_cells, total_bytes,
+                      flush ? &latency_histogram : 0, 0);
+
   if (output_samples)
     sample_file.close();
 }
@@ -667,6 +838,9 @@ void generate_query_load(PropertiesPtr &props, String &tablename,
   double clocks_per_usec = (double)CLOCKS_PER_SEC / 1000000.0;
   bool output_samples = false;
   ofstream sample_file;
+  LatencyHistogram latency_histogram;
+  ::int32_t pace = get_i32("pace");
+  ::uint64_t op_number = 0;
 
   int query_mode = DEFAULT;
   if (has("query-mode")) {
@@ -723,11 +897,23 @@ void generate_query_load(PropertiesPtr &props, String &tablename,
     else
       load_client_ptr = make_shared<LoadClient>(thrift);
 
+    auto schedule_epoch = std::chrono::steady_clock::now();
+
     for (DataGenerator::iterator iter = dg.begin(); iter != dg.end(); iter++) {
 
       if (delay)
         std::this_thread::sleep_for(std::chrono::milliseconds(delay));
 
+      // When pacing, the operation is timed from its scheduled start so that
+      // a backed-up system accrues queueing delay instead of omitting it
+      auto op_start = std::chrono::steady_clock::now();
+      if (pace) {
+        op_start = schedule_epoch
+          + std::chrono::microseconds((op_number * 1000000ULL) / pace);
+        std::this_thread::sleep_until(op_start);
+      }
+      op_number++;
+
       scan_spec.clear();
       if (query_mode == INDEX) {
         scan_spec.add_column_predicate((*iter).column_family,
@@ -758,6 +944,8 @@ void generate_query_load(PropertiesPtr &props, String &tablename,
                 + stop_clocks) / clocks_per_usec;
       else
         latency = (stop_clocks-start_clocks) / clocks_per_usec;
+      latency_histogram.add(std::chrono::duration_cast<std::chrono::microseconds>
+              (std::chrono::steady_clock::now() - op_start).count());
       if (output_samples)
         sample_file << (unsigned long)latency << "\n";
       else {
@@ -795,9 +983,14 @@ void generate_query_load(PropertiesPtr &props, String &tablename,
     printf("  Latency avg (usec): %llu\n", (Llu)((double)cum_latency/total_cells));
     printf("Latency stddev (usec): %llu\n", (Llu)std_dev(total_cells, cum_latency, cum_sq_latency));
   }
+  report_latency_percentiles("Scan", latency_histogram);
   printf("\n");
   fflush(stdout);
 
+  if (has("json-output"))
+    write_json_report(get_str("json-output"), "query", stopwatch.elapsed(),
+                      total_cells, total_bytes, 0, &latency_histogram);
+
   if (output_samples)
     sample_file.close();
 }
@@ -862,6 +1055,184 @@ void generate_query_load_parallel(PropertiesPtr &props, String &tablename,
 }
 
 
+void generate_mixed_load(PropertiesPtr &props, String &tablename,
+                         ::uint32_t mutator_flags, bool thrift)
+{
+  LatencyHistogram insert_histogram, scan_histogram;
+  ::uint64_t total_cells=0;
+  ::uint64_t total_bytes=0;
+  ::int64_t max_keys = props->has("DataGenerator.MaxKeys")
+                        ? props->get_i64("DataGenerator.MaxKeys")
+                        : props->get_i64("max-keys");
+  ::int32_t read_pct = get_i32("read-percentage");
+  ::int32_t pace = get_i32("pace");
+  ::int32_t value_size = get_i32("value-size");
+  ::uint32_t seed = get_i32("seed");
+  String column = get_str("column");
+  Cells cells;
+  char row_key[32];
+
+  if (read_pct < 0 || read_pct > 100)
+    HT_FATAL("--read-percentage must be between 0 and 100");
+
+  DiscreteRandomGeneratorZipf rng_zipf(get_f64("zipf-s"));
+  rng_zipf.set_seed(seed);
+  rng_zipf.set_value_count(max_keys);
+
+  Random::seed(seed);
+  boost::shared_array<char> value(new char[value_size + 1]);
+  for (::int32_t i=0; i<value_size; i++)
+    value[i] = (char)(' ' + Random::number32(95));
+  value[value_size] = 0;
+
+  Stopwatch stopwatch;
+
+  try {
+    LoadClientPtr load_client_ptr;
+    String config_file = get_str("config");
+    boost::progress_display progress_meter(max_keys);
+
+    if (config_file != "")
+      load_client_ptr = make_shared<LoadClient>(config_file, thrift);
+    else
+      load_client_ptr = make_shared<LoadClient>(thrift);
+
+    load_client_ptr->create_mutator(tablename, mutator_flags, 0);
+
+    auto schedule_epoch = std::chrono::steady_clock::now();
+
+    for (::int64_t ii=0; ii<max_keys; ii++) {
+
+      // When pacing, the operation is timed from its scheduled start so that
+      // a backed-up system accrues queueing delay instead of omitting it
+      auto op_start = std::chrono::steady_clock::now();
+      if (pace) {
+        op_start = schedule_epoch
+          + std::chrono::microseconds(((::uint64_t)ii * 1000000ULL) / pace);
+        std::this_thread::sleep_until(op_start);
+      }
+
+      sprintf(row_key, "%020llu", (Llu)rng_zipf.get_sample());
+
+      if ((::int32_t)Random::number32(100) < read_pct) {
+        ScanSpecBuilder scan_spec;
+        scan_spec.add_column(column.c_str());
+        scan_spec.add_row(row_key);
+        load_client_ptr->create_scanner(tablename, scan_spec.get());
+        total_bytes += load_client_ptr->get_all_cells();
+        load_client_ptr->close_scanner();
+        scan_histogram.add(
+            std::chrono::duration_cast<std::chrono::microseconds>
+            (std::chrono::steady_clock::now() - op_start).count());
+      }
+      else {
+        Cell cell;
+        cell.row_key = row_key;
+        cell.column_family = column.c_str();
+        cell.value = (const ::uint8_t *)value.get();
+        cell.value_len = value_size;
+        cells.clear();
+        cells.push_back(cell);
+        load_client_ptr->set_cells(cells);
+        load_client_ptr->flush();
+        total_bytes += strlen(row_key) + value_size;
+        insert_histogram.add(
+            std::chrono::duration_cast<std::chrono::microseconds>
+            (std::chrono::steady_clock::now() - op_start).count());
+      }
+
+      ++total_cells;
+      progress_meter += 1;
+    }
+
+    load_client_ptr->flush();
+  }
+  catch (Exception &e) {
+    HT_ERROR_OUT << e << HT_END;
+    exit(EXIT_FAILURE);
+  }
+
+  stopwatch.stop();
+
+  printf("\n");
+  printf("\n");
+  printf("        Elapsed time: %.2f s\n", stopwatch.elapsed());
+  printf("    Total operations: %llu\n", (Llu) total_cells);
+  printf("  Throughput (ops/s): %.2f\n", (double)total_cells/stopwatch.elapsed());
+  printf(" Total bytes xferred: %llu\n", (Llu)total_bytes);
+  printf("Throughput (bytes/s): %.2f\n", (double)total_bytes/stopwatch.elapsed());
+  report_latency_percentiles("Insert", insert_histogram);
+  report_latency_percentiles("Scan", scan_histogram);
+  printf("\n");
+  fflush(stdout);
+
+  if (has("json-output"))
+    write_json_report(get_str("json-output"), "mixed", stopwatch.elapsed(),
+                      total_cells, total_bytes, &insert_histogram,
+                      &scan_histogram);
+}
+
+
+void report_latency_percentiles(const char *label,
+                                const LatencyHistogram &histogram)
+{
+  if (histogram.count() == 0)
+    return;
+  printf("%s latency percentiles (usec): p50=%llu p90=%llu p99=%llu "
+         "p99.9=%llu max=%llu (%llu samples)\n", label,
+         (Llu)histogram.quantile(0.50), (Llu)histogram.quantile(0.90),
+         (Llu)histogram.quantile(0.99), (Llu)histogram.quantile(0.999),
+         (Llu)histogram.max(), (Llu)histogram.count());
+}
+
+
+namespace {
+
+  void json_histogram(ofstream &out, const char *name,
+                      const LatencyHistogram &histogram) {
+    out << "  \"" << name << "\": {\n"
+        << "    \"samples\": " << histogram.count() << ",\n"
+        << "    \"min_usec\": " << histogram.min() << ",\n"
+        << "    \"mean_usec\": " << histogram.mean() << ",\n"
+        << "    \"p50_usec\": " << histogram.quantile(0.50) << ",\n"
+        << "    \"p90_usec\": " << histogram.quantile(0.90) << ",\n"
+        << "    \"p99_usec\": " << histogram.quantile(0.99) << ",\n"
+        << "    \"p999_usec\": " << histogram.quantile(0.999) << ",\n"
+        << "    \"max_usec\": " << histogram.max() << "\n"
+        << "  }";
+  }
+}
+
+void write_json_report(const String &fname, const char *load_type,
+                       double elapsed, ::uint64_t total_cells,
+                       ::uint64_t total_bytes,
+                       const LatencyHistogram *insert_histogram,
+                       const LatencyHistogram *scan_histogram)
+{
+  ofstream out(fname.c_str());
+
+  out << "{\n"
+      << "  \"type\": \"" << load_type << "\",\n"
+      << "  \"elapsed_seconds\": " << elapsed << ",\n"
+      << "  \"total_operations\": " << total_cells << ",\n"
+      << "  \"total_bytes\": " << total_bytes << ",\n"
+      << "  \"operations_per_second\": "
+      << (elapsed > 0.0 ? (double)total_cells/elapsed : 0.0) << ",\n"
+      << "  \"bytes_per_second\": "
+      << (elapsed > 0.0 ? (double)total_bytes/elapsed : 0.0);
+  if (insert_histogram && insert_histogram->count()) {
+    out << ",\n";
+    json_histogram(out, "insert_latency", *insert_histogram);
+  }
+  if (scan_histogram && scan_histogram->count()) {
+    out << ",\n";
+    json_histogram(out, "scan_latency", *scan_histogram);
+  }
+  out << "\n}\n";
+  out.close();
+}
+
+
 /**
  * @param nn Size of set of numbers
  * @param sum Sum of numbers in set
@@ -0,0 +1,99 @@
+/* -*- c++ -*-
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 3 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/** @file
+ * Declarations for EmitterReplay.
+ * This file contains declarations for EmitterReplay, a class for replaying
+ * key/value pairs into live tables through mutators.
+ */
+
+#ifndef HYPERTABLE_EMITTERREPLAY_H
+#define HYPERTABLE_EMITTERREPLAY_H
+
+#include "Hypertable/Lib/Client.h"
+#include "Hypertable/Lib/NameIdMapper.h"
+
+#include "Hyperspace/Session.h"
+
+#include "Common/LatencyHistogram.h"
+
+#include "Emitter.h"
+
+#include <chrono>
+#include <unordered_map>
+
+namespace Hypertable {
+
+  /** Replays key/value pairs into live tables.  Each cell is applied to the
+   * table it was captured from through a TableMutator, driving the target
+   * RangeServer's update pipeline with the original traffic shape.  Replay
+   * can be paced to a multiple of the original inter-update spacing (taken
+   * from the key revisions recorded in the log) and a throughput and flush
+   * latency report is written to stdout when the replay completes.
+   */
+  class EmitterReplay : public Emitter {
+  public:
+
+    /** Constructor.
+     * @param speed Speed multiplier; 1.0 replays with the original
+     * inter-update spacing, 2.0 twice as fast, 0 as fast as possible
+     * @param batch_size Number of cells applied between mutator flushes
+     */
+    EmitterReplay(double speed, int32_t batch_size);
+    virtual ~EmitterReplay();
+    virtual void add(TableIdentifier &table, Key &key,
+                     const uint8_t *value, size_t value_len);
+
+  private:
+
+    void flush_and_record();
+
+    String m_toplevel_dir;
+    Hyperspace::SessionPtr m_hyperspace;
+    NameIdMapperPtr m_name_id_mapper;
+    ClientPtr m_client;
+    NamespacePtr m_namespace;
+
+    class TableInfo {
+    public:
+      TableInfo() { }
+      TableInfo(const String &n, TablePtr t, TableMutatorPtr m)
+        : name(n), table(t), mutator(m) { }
+      String name;
+      TablePtr table;
+      TableMutatorPtr mutator;
+    };
+
+    std::unordered_map<String, TableInfo> m_table_id_map;
+    LatencyHistogram m_flush_latency;
+    std::chrono::steady_clock::time_point m_start_time;
+    double m_speed {};
+    int32_t m_batch_size {};
+    int32_t m_batched {};
+    int64_t m_first_revision {};
+    uint64_t m_cells {};
+    uint64_t m_bytes {};
+    uint64_t m_skipped {};
+  };
+
+} // namespace Hypertable
+
+#endif // HYPERTABLE_EMITTERREPLAY_H
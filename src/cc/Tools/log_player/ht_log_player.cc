@@ -38,6 +38,7 @@
 
 #include <boost/algorithm/string/predicate.hpp>
 
+#include "EmitterReplay.h"
 #include "EmitterStdout.h"
 #include "EmitterTsv.h"
 
@@ -69,7 +70,7 @@ found, for each range server, under the following paths:
 For this tool to work properly, it needs access to
 both Hyperspace and the FS broker.
 
-The tool can be run in two modes.  The first mode, specified
+The tool can be run in three modes.  The first mode, specified
 with the --tsv-output switch, causes the cells in the log to
 be written into a tree of .tsv files rooted in the current
 working directory.  The directory tree produced parallels
@@ -112,6 +113,21 @@ LoadTest  1456961038717377423  212325006        source  cartilaginous\\ncarting\
 LoadTest  1456961038717377424  212325929        source  nah\\nwinnard\\nWinne\\nWinnebago
 ...
 
+The third mode, specified with the --replay switch, replays
+the cells in the log into live tables (which must already
+exist) through table mutators, driving the receiving range
+servers' update pipelines with the captured traffic.  The
+--replay-speed multiplier paces the replay relative to the
+original update spacing recorded in the log (1.0 preserves
+it, 2.0 replays twice as fast, 0 replays as fast as
+possible), and a throughput and flush latency report is
+printed when the replay completes.  This mode can be used to
+benchmark server changes against production-shaped traffic
+offline:
+
+$ ht log_player --replay --replay-speed 1.0 \
+    /hypertable/servers/rs6/log/user
+
 Options)";
 
   struct AppPolicy : Config::Policy {
@@ -119,6 +135,13 @@ Options)";
       cmdline_desc(usage).add_options()
         ("tsv-output", "Convert log into a set of loadable .tsv files")
         ("stdout", "Write log to stdout with table name as first field")
+        ("replay", "Replay log into live tables, reporting throughput "
+         "and latency")
+        ("replay-speed", f64()->default_value(0.0), "Replay speed "
+         "multiplier; 1.0 preserves the original update spacing, 0 "
+         "replays as fast as possible")
+        ("replay-batch", i32()->default_value(10000), "Number of cells "
+         "applied between mutator flushes during replay")
         ;
       cmdline_hidden_desc().add_options()("log-dir", str(), "dfs log dir");
       cmdline_positional_desc().add("log-dir", -1);
@@ -192,9 +215,11 @@ int main(int argc, char **argv) {
     int timeout = get_i32("dfs-timeout", 15000);
     bool stdout = has("stdout");
     bool tsv_output = has("tsv-output");
+    bool replay = has("replay");
 
-    if (stdout && tsv_output)
-      HT_FATAL("Only one of --stdout and --tsv-output can be supplied.");
+    if ((int)stdout + (int)tsv_output + (int)replay > 1)
+      HT_FATAL("Only one of --stdout, --tsv-output and --replay can be "
+               "supplied.");
 
     /**
      * Check for and connect to commit log DFS broker
@@ -226,6 +251,9 @@ int main(int argc, char **argv) {
       emitter = new EmitterStdout();
     else if (tsv_output)
       emitter = new EmitterTsv();
+    else if (replay)
+      emitter = new EmitterReplay(get_f64("replay-speed"),
+                                  get_i32("replay-batch"));
 
     display_log(dfs_client, log_reader.get(), emitter);
 
@@ -0,0 +1,156 @@
+/*
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include <Common/Compat.h>
+
+#include <Hypertable/Lib/Client.h>
+#include <Hypertable/Lib/ScanSpec.h>
+
+#include <AsyncComm/Config.h>
+
+#include <Common/Base64.h>
+#include <Common/Error.h>
+#include <Common/Init.h>
+#include <Common/Logger.h>
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+
+using namespace Hypertable;
+using namespace Config;
+using namespace std;
+
+namespace {
+
+struct AppPolicy : Config::Policy {
+  static void init_options() {
+    cmdline_desc("Usage: %s [options] <log-file>\n\n"
+      "  This program replays a scan access log written by a RangeServer\n"
+      "  (Hypertable.RangeServer.ScanAccessLog.Enable) in shadow mode.  The\n"
+      "  recorded scans are re-issued and their results discarded, warming\n"
+      "  the query and block caches of the serving RangeServers before they\n"
+      "  enter rotation.\n\nOptions")
+      .add_options()
+      ("dry-run", boo()->zero_tokens()->default_value(false),
+       "Display the recorded scans as HQL without issuing them")
+      ;
+    cmdline_hidden_desc().add_options()("log-file", str(), "scan access log file");
+    cmdline_positional_desc().add("log-file", -1);
+  }
+  static void init() {
+    if (!has("log-file")) {
+      HT_ERROR_OUT <<"log-file required\n"<< cmdline_desc() << HT_END;
+      exit(EXIT_FAILURE);
+    }
+  }
+};
+
+typedef Meta::list<AppPolicy, DefaultCommPolicy> Policies;
+
+} // local namespace
+
+
+int main(int argc, char **argv) {
+  size_t replayed {}, cells {}, skipped {};
+
+  try {
+    init_with_policies<Policies>(argc, argv);
+
+    String log_file = get_str("log-file");
+    bool dry_run = get_bool("dry-run");
+
+    ifstream in(log_file.c_str());
+    if (!in.is_open()) {
+      cerr << "Unable to open '" << log_file << "'" << endl;
+      exit(EXIT_FAILURE);
+    }
+
+    ClientPtr client;
+    NamespacePtr ns;
+    if (!dry_run) {
+      client = make_shared<Hypertable::Client>();
+      ns = client->open_namespace("/");
+    }
+
+    map<String, TablePtr> tables;
+    String line;
+
+    while (getline(in, line)) {
+      istringstream iss(line);
+      time_t timestamp;
+      String name, encoded;
+
+      // Each record is "<timestamp> <table-name> <base64-scanspec>"
+      if (!(iss >> timestamp >> name >> encoded)) {
+        skipped++;
+        continue;
+      }
+
+      String decoded = Base64::decode(encoded);
+      const uint8_t *ptr = (const uint8_t *)decoded.data();
+      size_t remain = decoded.length();
+      ScanSpec scan_spec;
+      try {
+        scan_spec.decode(&ptr, &remain);
+      }
+      catch (Exception &e) {
+        HT_WARNF("Skipping malformed scan access log entry - %s",
+                 Error::get_text(e.code()));
+        skipped++;
+        continue;
+      }
+
+      if (dry_run) {
+        cout << scan_spec.render_hql(name) << "\n";
+        replayed++;
+        continue;
+      }
+
+      try {
+        TablePtr &table = tables[name];
+        if (!table)
+          table = ns->open_table(name);
+        unique_ptr<TableScanner> scanner(table->create_scanner(scan_spec));
+        Cell cell;
+        while (scanner->next(cell))
+          cells++;
+        replayed++;
+      }
+      catch (Exception &e) {
+        HT_WARNF("Problem replaying scan against '%s' - %s", name.c_str(),
+                 Error::get_text(e.code()));
+        skipped++;
+      }
+    }
+  }
+  catch (Exception &e) {
+    HT_ERROR_OUT << e << HT_END;
+    exit(EXIT_FAILURE);
+  }
+
+  cout << "Replayed " << replayed << " scans (" << cells << " cells, "
+       << skipped << " skipped)" << endl;
+  return 0;
+}
@@ -0,0 +1,161 @@
+/*
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/// @file
+/// Per-table usage report generated from the <code>sys/RS_METRICS</code>
+/// table.  Range servers publish per-range disk usage, cell counts and
+/// key/value byte totals (maintained by compactions) to
+/// <code>sys/RS_METRICS</code>, so table sizes can be reported with a scan
+/// of the metrics table instead of a COUNT scan of each table.
+
+#include <Common/Compat.h>
+
+#include <Hypertable/Lib/Client.h>
+#include <Hypertable/Lib/Config.h>
+#include <Hypertable/Lib/RS_METRICS/ReaderTable.h>
+
+#include <Common/Error.h>
+#include <Common/Init.h>
+#include <Common/System.h>
+
+#include <cstdio>
+#include <map>
+#include <vector>
+
+using namespace Hypertable;
+using namespace Hypertable::Config;
+using namespace Hypertable::Lib::RS_METRICS;
+using namespace std;
+
+namespace {
+
+  const char *usage =
+    "\n"
+    "Usage: ht_table_usage [options]\n\n"
+    "Description:\n"
+    "  This program aggregates the per-range statistics published to the\n"
+    "  'sys/RS_METRICS' table into a per-table usage report (range count,\n"
+    "  disk usage, cell count and key/value bytes).  The statistics are\n"
+    "  maintained by compactions and published on the metrics interval, so\n"
+    "  the report reflects sizes as of the last metrics snapshot of each\n"
+    "  range.\n\n"
+    "Options";
+
+  struct AppPolicy : Config::Policy {
+    static void init_options() {
+      cmdline_desc(usage).add_options()
+        ("help,h", "Show this help message and exit")
+        ("help-config", "Show help message for config properties")
+        ("ids", boo()->zero_tokens()->default_value(false),
+         "Report table IDs instead of table names")
+        ;
+    }
+  };
+
+  typedef Meta::list<AppPolicy, DefaultCommPolicy> Policies;
+
+  /// Per-table usage totals.
+  struct TableUsage {
+    size_t range_count {};
+    int64_t disk_used {};
+    int64_t cell_count {};
+    int64_t key_bytes {};
+    int64_t value_bytes {};
+  };
+
+} // local namespace
+
+int main(int argc, char **argv) {
+  System::initialize(System::locate_install_dir(argv[0]));
+
+  try {
+    init_with_policies<Policies>(argc, argv);
+
+    bool report_ids = get_bool("ids");
+
+    ClientPtr client = make_shared<Hypertable::Client>(System::install_dir);
+    NamespacePtr ns = client->open_namespace("sys");
+    TablePtr rs_metrics = ns->open_table("RS_METRICS");
+    ReaderTable reader(rs_metrics);
+
+    vector<ServerMetrics> server_metrics;
+    reader.get_server_metrics(server_metrics);
+
+    map<String, TableUsage> usage_map;
+
+    for (auto &sm : server_metrics) {
+      RangeMetricsMap range_metrics;
+      reader.get_range_metrics(sm.get_id().c_str(), range_metrics);
+      for (auto &entry : range_metrics) {
+        const vector<RangeMeasurement> &measurements =
+          entry.second.get_measurements();
+        if (measurements.empty())
+          continue;
+        // Use the most recent snapshot of each range; version 5 is the
+        // first to carry cell count and key/value bytes
+        const RangeMeasurement *latest = &measurements[0];
+        for (auto &measurement : measurements) {
+          if (measurement.timestamp > latest->timestamp)
+            latest = &measurement;
+        }
+        TableUsage &usage = usage_map[entry.second.get_table_id()];
+        usage.range_count++;
+        usage.disk_used += latest->disk_used;
+        if (latest->version >= 5) {
+          usage.cell_count += latest->cell_count;
+          usage.key_bytes += latest->key_bytes;
+          usage.value_bytes += latest->value_bytes;
+        }
+      }
+    }
+
+    NameIdMapperPtr namemap = client->get_nameid_mapper();
+    TableUsage total;
+
+    printf("%-40s %8s %14s %14s %14s %14s\n", "Table", "Ranges", "Disk",
+           "Cells", "KeyBytes", "ValueBytes");
+    for (auto &entry : usage_map) {
+      String label = entry.first;
+      if (!report_ids && !namemap->id_to_name(entry.first, label))
+        label = entry.first + " (dropped?)";
+      printf("%-40s %8u %14lld %14lld %14lld %14lld\n", label.c_str(),
+             (unsigned)entry.second.range_count,
+             (Lld)entry.second.disk_used, (Lld)entry.second.cell_count,
+             (Lld)entry.second.key_bytes, (Lld)entry.second.value_bytes);
+      total.range_count += entry.second.range_count;
+      total.disk_used += entry.second.disk_used;
+      total.cell_count += entry.second.cell_count;
+      total.key_bytes += entry.second.key_bytes;
+      total.value_bytes += entry.second.value_bytes;
+    }
+    printf("%-40s %8u %14lld %14lld %14lld %14lld\n", "TOTAL",
+           (unsigned)total.range_count, (Lld)total.disk_used,
+           (Lld)total.cell_count, (Lld)total.key_bytes,
+           (Lld)total.value_bytes);
+  }
+  catch (Exception &e) {
+    HT_ERROR_OUT << e << HT_END;
+    quick_exit(EXIT_FAILURE);
+  }
+
+  fflush(stdout);
+  quick_exit(EXIT_SUCCESS); // don't bother with static objects
+}
@@ -0,0 +1,12 @@
+[rowkey]
+        component.0.order=random
+        component.0.type=integer
+        component.0.format="%06lld"
+        component.0.max=5000
+[Field]
+        value.size=100
+        qualifier.type=STRING
+        qualifier.size=2
+        qualifier.charset=abcdef
+[Blob]
+        value.size=10000
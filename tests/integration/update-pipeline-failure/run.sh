@@ -0,0 +1,92 @@
+#!/usr/bin/env bash
+
+HT_HOME=${INSTALL_DIR:-"$HOME/hypertable/current"}
+HT_SHELL="$HT_HOME/bin/ht shell"
+SCRIPT_DIR=`dirname $0`
+SPEC_FILE="$SCRIPT_DIR/data.spec"
+MAX_KEYS=${MAX_KEYS:-20000}
+DIGEST="openssl dgst -md5"
+
+. $HT_HOME/bin/ht-env.sh
+
+# Loads the table with a deterministic mutation mix (overwrites from the
+# small rowkey space, 10K values, qualified cells, 20% deletes) and
+# reports the elapsed time so throughput degradation under injected
+# failures can be eyeballed in the test output.
+load_table() {
+  start=`date +%s`
+  $HT_HOME/bin/ht load_generator update --spec-file=$SPEC_FILE \
+      --max-keys=$MAX_KEYS --rowkey-seed=42 --delete-percentage=20
+  status=$?
+  echo "load elapsed: $((`date +%s` - start))s (status $status)"
+  return $status
+}
+
+dump_table() {
+  $HT_SHELL -l error --batch < $SCRIPT_DIR/dump-table.hql | grep -v "hypertable" > $1
+}
+
+rm -f report.txt
+
+#
+# Baseline - no failure injection; the dump is the reference for the
+# correctness checks below
+#
+echo "=== baseline ==="
+$HT_HOME/bin/ht-start-test-servers.sh --clear
+$HT_SHELL --batch < $SCRIPT_DIR/create-table.hql
+load_table || exit 1
+dump_table dump.baseline
+$DIGEST < dump.baseline > dump.baseline.md5
+
+#
+# Pause injection at each pipeline stage boundary; a pause only delays
+# the pipeline thread, so the final table contents must match the
+# baseline exactly
+#
+echo "=== pause injection ==="
+$HT_HOME/bin/ht-start-test-servers.sh --clear \
+    --"induce-failure=update-pipeline-qualify-1:pause(2000):50;update-pipeline-commit-1:pause(2000):100;update-pipeline-add-1:pause(2000):150"
+$HT_SHELL --batch < $SCRIPT_DIR/create-table.hql
+load_table || exit 1
+dump_table dump.pause
+$DIGEST < dump.pause > dump.pause.md5
+if diff dump.baseline.md5 dump.pause.md5 > /dev/null ; then
+  echo "pause injection: PASSED" >> report.txt
+else
+  echo "pause injection: FAILED (dump mismatch)" >> report.txt
+fi
+
+#
+# Signal injection at the qualify and commit stage boundaries; the
+# affected batches are rejected with Error::INDUCED_FAILURE before
+# anything reaches the commit logs, so the load may report errors but
+# the server must stay up and a clean re-load of the same deterministic
+# data must converge back to the baseline contents
+#
+echo "=== signal injection ==="
+$HT_HOME/bin/ht-start-test-servers.sh --clear \
+    --"induce-failure=update-pipeline-qualify-1:signal:50;update-pipeline-commit-1:signal:100"
+$HT_SHELL --batch < $SCRIPT_DIR/create-table.hql
+load_table
+if ! $HT_HOME/bin/ht serverup --silent rangeserver ; then
+  echo "signal injection: FAILED (range server down)" >> report.txt
+else
+  load_table || exit 1
+  dump_table dump.signal
+  $DIGEST < dump.signal > dump.signal.md5
+  if diff dump.baseline.md5 dump.signal.md5 > /dev/null ; then
+    echo "signal injection: PASSED" >> report.txt
+  else
+    echo "signal injection: FAILED (dump mismatch)" >> report.txt
+  fi
+fi
+
+echo ""
+echo "**** TEST REPORT ****"
+echo ""
+cat report.txt
+$HT_HOME/bin/ht-stop-servers.sh
+
+grep FAILED report.txt > /dev/null && exit 1
+exit 0